@@ -0,0 +1,249 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchDynamics.cpp
+ * @brief Microbenchmarks of linear forward and inverse dynamics solves.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/dynamics/BatchDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtdynamics/utils/values.h>
+
+#include <sys/resource.h>
+
+#include <set>
+#include <string>
+#include <utility>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace {
+const Robot &A1() {
+  static const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  return robot;
+}
+
+// Poses and twists from forward kinematics, and torques or accelerations,
+// the latter with a zero base acceleration.
+Values KnownValues(bool torques) {
+  Values values;
+  int k = 0;
+  for (auto &&joint : A1().joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, 0.1 * (k % 3));
+    InsertJointVel(&values, j, 0.2);
+    k++;
+  }
+  Values known = A1().forwardKinematics(values, 0, "trunk");
+  for (auto &&joint : A1().joints()) {
+    if (torques) {
+      InsertTorque(&known, joint->id(), 0, 1.0);
+    } else {
+      InsertJointAccel(&known, joint->id(), 0, 0.5);
+    }
+  }
+  if (!torques) {
+    InsertTwistAccel(&known, A1().link("trunk")->id(), 0, gtsam::Z_6x1);
+  }
+  return known;
+}
+
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Time a solve with the given solver; the first, uncached solve is excluded.
+template <class SOLVE>
+void Solve(benchmark::State &state, LinearDynamicsSolver solver,
+           const SOLVE &solve) {
+  DynamicsGraph graph_builder(kGravity);
+  graph_builder.setLinearSolver(solver);
+  solve(graph_builder);
+  for (auto _ : state) benchmark::DoNotOptimize(solve(graph_builder));
+}
+
+// Number of distinct noise models in the graph, and their approximate size,
+// counting the sigma, inverse sigma and precision vectors of diagonal models.
+std::pair<size_t, size_t> NoiseModelMemory(
+    const gtsam::NonlinearFactorGraph &graph) {
+  std::set<const gtsam::noiseModel::Base *> models;
+  size_t bytes = 0;
+  for (auto &&factor : graph) {
+    auto nm_factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (!nm_factor || !nm_factor->noiseModel()) continue;
+    const auto *model = nm_factor->noiseModel().get();
+    if (!models.insert(model).second) continue;
+    bytes += sizeof(gtsam::noiseModel::Diagonal) +
+             3 * model->dim() * sizeof(double);
+  }
+  return {models.size(), bytes};
+}
+}  // namespace
+
+/* ************************************************************************* */
+static void DynamicsGraph_LinearSolveFD(benchmark::State &state) {
+  const Values known = KnownValues(true);
+  Solve(state, static_cast<LinearDynamicsSolver>(state.range(0)),
+        [&](DynamicsGraph &graph_builder) {
+          return graph_builder.linearSolveFD(A1(), 0, known);
+        });
+}
+BENCHMARK(DynamicsGraph_LinearSolveFD)->Arg(Elimination)->Arg(Recursive);
+
+static void DynamicsGraph_LinearSolveID(benchmark::State &state) {
+  const Values known = KnownValues(false);
+  Solve(state, static_cast<LinearDynamicsSolver>(state.range(0)),
+        [&](DynamicsGraph &graph_builder) {
+          return graph_builder.linearSolveID(A1(), 0, known);
+        });
+}
+BENCHMARK(DynamicsGraph_LinearSolveID)->Arg(Elimination)->Arg(Recursive);
+
+// Build a trajectory graph with the default settings. The shared noise models
+// of OptimizerSetting are reused by all factors of all time steps.
+static void DynamicsGraph_TrajectoryFG(benchmark::State &state) {
+  const int num_steps = state.range(0);
+  DynamicsGraph graph_builder(kGravity);
+  gtsam::NonlinearFactorGraph graph;
+  for (auto _ : state) {
+    graph = graph_builder.trajectoryFG(A1(), num_steps, 0.01);
+    benchmark::DoNotOptimize(graph);
+  }
+  auto [num_models, bytes] = NoiseModelMemory(graph);
+  state.counters["factors"] = graph.size();
+  state.counters["noise_models"] = num_models;
+  state.counters["noise_model_bytes"] = bytes;
+  state.counters["interned_models"] = NumInternedNoiseModels();
+}
+BENCHMARK(DynamicsGraph_TrajectoryFG)->Arg(10)->Arg(100);
+
+// Build a trajectory graph with closed-form factors, each from the heap or all
+// from one arena per graph. Peak RSS is that of the whole process, so compare
+// it by running one variant at a time with --benchmark_filter.
+static void DynamicsGraph_TrajectoryFGArena(benchmark::State &state) {
+  const int num_steps = state.range(0);
+  const bool use_arena = state.range(1);
+  OptimizerSetting opt;
+  opt.closed_form_jacobians = true;
+  DynamicsGraph graph_builder(opt, kGravity);
+  gtsam::NonlinearFactorGraph graph;
+  size_t arena_bytes = 0;
+  for (auto _ : state) {
+    graph = gtsam::NonlinearFactorGraph();  // release the previous graph
+    if (use_arena) {
+      FactorArena arena;
+      graph_builder.setFactorArena(arena);
+      graph = graph_builder.trajectoryFG(A1(), num_steps, 0.01);
+      arena_bytes = arena.bytesAllocated();
+    } else {
+      graph = graph_builder.trajectoryFG(A1(), num_steps, 0.01);
+    }
+    benchmark::DoNotOptimize(graph);
+  }
+  graph_builder.clearFactorArena();
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  state.counters["factors"] = graph.size();
+  state.counters["arena_mb"] = arena_bytes / 1e6;
+  state.counters["peak_rss_mb"] = usage.ru_maxrss / 1e3;  // kB on Linux
+}
+BENCHMARK(DynamicsGraph_TrajectoryFGArena)
+    ->Args({100, false})
+    ->Args({100, true})
+    ->Args({1000, false})
+    ->Args({1000, true});
+
+// Eliminate the collocation factors of one phase of a joint, which all share
+// the phase duration, with COLAMD and with the duration eliminated last.
+static void DynamicsGraph_PhaseElimination(benchmark::State &state) {
+  const int num_steps = state.range(0);
+  const bool phase_last = state.range(1);
+  DynamicsGraph graph_builder(kGravity);
+  gtsam::NonlinearFactorGraph graph;
+  Values values;
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  for (int t = 0; t < num_steps; t++) {
+    graph.add(graph_builder.jointMultiPhaseCollocationFactors(
+        0, t, 0, CollocationScheme::Trapezoidal));
+  }
+  for (int t = 0; t <= num_steps; t++) {
+    graph.addPrior(JointAccelKey(0, t), 0.5, model);
+    InsertJointAngle(&values, 0, t, 0.01 * t);
+    InsertJointVel(&values, 0, t, 0.1);
+    InsertJointAccel(&values, 0, t, 0.5);
+  }
+  graph.addPrior(JointAngleKey(0, 0), 0.0, model);
+  graph.addPrior(JointVelKey(0, 0), 0.1, model);
+  graph.addPrior(PhaseKey(0), 0.01, model);
+  values.insert(PhaseKey(0), 0.01);
+
+  const auto linear = graph.linearize(values);
+  const gtsam::Ordering ordering =
+      phase_last ? DynamicsGraph::PhaseDurationsLastOrdering(graph)
+                 : gtsam::Ordering::Colamd(*linear);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(linear->eliminateMultifrontal(ordering));
+  }
+  state.counters["steps"] = num_steps;
+}
+BENCHMARK(DynamicsGraph_PhaseElimination)
+    ->ArgsProduct({{100, 1000, 10000}, {0, 1}});
+
+// Eliminate a trajectory graph of the A1 with COLAMD and with the ordering by
+// time step and kinematic tree depth.
+static void DynamicsGraph_TrajectoryElimination(benchmark::State &state) {
+  const int num_steps = state.range(0);
+  const bool structured = state.range(1);
+  DynamicsGraph graph_builder(kGravity);
+  auto graph = graph_builder.trajectoryFG(A1(), num_steps, 0.01);
+  const Values values =
+      Initializer().ZeroValuesTrajectory(A1(), num_steps, -1, 0.0);
+
+  // Damp all variables as in Levenberg-Marquardt, the graph has no priors.
+  const auto linear = graph.linearize(values);
+  for (gtsam::Key key : graph.keys()) {
+    const size_t dim = values.at(key).dim();
+    linear->add(key, gtsam::I_6x6.topLeftCorner(dim, dim),
+                gtsam::Vector::Zero(dim));
+  }
+  const gtsam::Ordering ordering =
+      structured ? DynamicsGraph::TrajectoryOrdering(A1(), graph)
+                 : gtsam::Ordering::Colamd(*linear);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(linear->eliminateMultifrontal(ordering));
+  }
+  state.counters["steps"] = num_steps;
+}
+BENCHMARK(DynamicsGraph_TrajectoryElimination)
+    ->ArgsProduct({{10, 100}, {0, 1}});
+
+// Inverse dynamics of a batch of A1 states, on the CPU and, if available, on
+// the GPU, including the transfers.
+static void BatchDynamics_InverseDynamics(benchmark::State &state) {
+  const auto backend = static_cast<BatchBackend>(state.range(1));
+  if (backend == CudaBackend && !BatchDynamics::CudaAvailable()) {
+    state.SkipWithError("no CUDA device");
+    return;
+  }
+  const BatchDynamics batch(A1(), kGravity, backend);
+  const Eigen::Index num_states = state.range(0);
+  const gtsam::Matrix q =
+      gtsam::Matrix::Random(num_states, batch.numJoints());
+  gtsam::Matrix tau;
+  for (auto _ : state) batch.inverseDynamics(q, q, q, &tau);
+  state.SetItemsProcessed(state.iterations() * num_states);
+}
+BENCHMARK(BatchDynamics_InverseDynamics)
+    ->ArgsProduct({{1000, 100000}, {CpuBackend, CudaBackend}});
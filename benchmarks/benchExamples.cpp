@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchExamples.cpp
+ * @brief Regression benchmarks of the example problems, swept over robot
+ * model, number of walk cycles and horizon. Run with
+ * --benchmark_format=json, or `make benchmarks.examples`, for results that
+ * can be tracked over time.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph, gtsam::Values;
+using gtsam::Point3, gtsam::Pose3, gtsam::Rot3;
+
+namespace {
+using gtsam::noiseModel::Isotropic;
+
+/// Legged robots of the walking examples.
+enum Model { Spider, A1, Vision60 };
+
+/// Robot, feet of the two alternating gait phases, and foot contact point.
+struct Legged {
+  Robot robot;
+  std::vector<std::string> odd_feet, even_feet;
+  Point3 contact_in_com;
+};
+
+const Legged &LeggedRobot(Model model) {
+  static const Legged spider{
+      CreateRobotFromFile(kSdfPath + std::string("spider_alt.sdf"), "spider"),
+      {"tarsus_1_L1", "tarsus_3_L3", "tarsus_5_R4", "tarsus_7_R2"},
+      {"tarsus_2_L2", "tarsus_4_L4", "tarsus_6_R3", "tarsus_8_R1"},
+      Point3(0, 0.19, 0)};
+  static const Legged a1{
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf")),
+      {"RL_lower", "FR_lower"},
+      {"RR_lower", "FL_lower"},
+      Point3(0, 0, -0.07)};
+  static const Legged vision60{
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf")),
+      {"lower0", "lower3"},
+      {"lower1", "lower2"},
+      Point3(0.14, 0, 0)};
+  switch (model) {
+    case A1:
+      return a1;
+    case Vision60:
+      return vision60;
+    default:
+      return spider;
+  }
+}
+
+/// A problem, and the wall time it took to build.
+struct Problem {
+  NonlinearFactorGraph graph;
+  Values values;
+  double build_seconds;
+};
+
+/**
+ * The walking problem of example_spider_walking, example_a1_walking and
+ * example_full_kinodynamic_walking: a walk cycle of stationary and swing
+ * phases, each swing phase with `steps` time steps, repeated `cycles` times.
+ */
+Problem Walking(Model model, size_t cycles, size_t steps) {
+  const Deadline timer;
+  const Legged &legged = LeggedRobot(model);
+  const Robot &robot = legged.robot;
+  auto links = [&](const std::vector<std::string> &names) {
+    std::vector<LinkSharedPtr> result;
+    for (auto &&name : names) result.push_back(robot.link(name));
+    return result;
+  };
+  const auto odd_feet = links(legged.odd_feet);
+  const auto even_feet = links(legged.even_feet);
+  auto all_feet = odd_feet;
+  all_feet.insert(all_feet.end(), even_feet.begin(), even_feet.end());
+
+  const Point3 &contact_in_com = legged.contact_in_com;
+  auto stationary =
+      std::make_shared<FootContactConstraintSpec>(all_feet, contact_in_com);
+  auto odd =
+      std::make_shared<FootContactConstraintSpec>(odd_feet, contact_in_com);
+  auto even =
+      std::make_shared<FootContactConstraintSpec>(even_feet, contact_in_com);
+  const WalkCycle walk_cycle({stationary, even, stationary, odd},
+                             {1, steps, 1, steps});
+  const Trajectory trajectory(walk_cycle, cycles);
+
+  const double sigma = 1e-5, dt = 1. / 240;
+  DynamicsGraph graph_builder(OptimizerSetting(sigma),
+                              gtsam::Vector3(0, 0, -9.8));
+  Problem problem;
+  problem.graph = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, 1.0);
+  problem.graph.add(trajectory.contactPointObjectives(
+      robot, Isotropic::Sigma(3, 1e-7), Point3(0, 0.4, 0), 0));
+  trajectory.addBoundaryConditions(
+      &problem.graph, robot, Isotropic::Sigma(6, sigma),
+      Isotropic::Sigma(6, sigma), Isotropic::Sigma(6, 1e-6),
+      Isotropic::Sigma(1, 1e-6), Isotropic::Sigma(1, 1e-6));
+  trajectory.addIntegrationTimeFactors(&problem.graph, dt, 1e-6);
+  trajectory.addMinimumTorqueFactors(&problem.graph, robot,
+                                     gtsam::noiseModel::Unit::Create(1));
+  problem.values =
+      trajectory.multiPhaseInitialValues(robot, Initializer(), 1e-3, dt);
+  problem.build_seconds = timer.elapsed();
+  return problem;
+}
+
+/// Counters shared by all problems.
+void SetCounters(benchmark::State &state, const Problem &problem,
+                 size_t iterations, double error) {
+  state.counters["build_s"] = problem.build_seconds;
+  state.counters["iterations"] = iterations;
+  state.counters["error"] = error;
+  state.counters["factors"] = problem.graph.size();
+  state.counters["variables"] = problem.values.size();
+  // Problem, one linearization and its Bayes tree, the bulk of the peak.
+  state.counters["memory_mb"] =
+      ReportMemory(problem.graph, problem.values).totalBytes() / 1e6;
+}
+}  // namespace
+
+/* ************************************************************************* */
+// Walking trajectory optimization with Levenberg-Marquardt, as in the
+// examples, for a bounded number of iterations.
+static void Examples_Walking(benchmark::State &state) {
+  const auto model = static_cast<Model>(state.range(0));
+  const Problem problem = Walking(model, state.range(1), state.range(2));
+  gtsam::LevenbergMarquardtParams params;
+  params.setMaxIterations(10);
+  params.setlambdaInitial(1e2);
+  size_t iterations = 0;
+  double error = 0;
+  for (auto _ : state) {
+    gtsam::LevenbergMarquardtOptimizer optimizer(problem.graph,
+                                                 problem.values, params);
+    benchmark::DoNotOptimize(optimizer.optimize());
+    iterations = optimizer.iterations();
+    error = optimizer.error();
+  }
+  SetCounters(state, problem, iterations, error);
+}
+BENCHMARK(Examples_Walking)
+    ->ArgNames({"model", "cycles", "steps"})
+    ->ArgsProduct({{Spider, A1, Vision60}, {1, 2, 4}, {2}})
+    ->ArgsProduct({{Spider}, {1}, {4, 8, 16}})
+    ->Unit(benchmark::kMillisecond);
+
+/* ************************************************************************* */
+// The per-step inverse kinematics of example_quadruped_mp: the base follows
+// a straight line and the feet stay at their nominal footholds, each step
+// warm started from the previous one.
+static void Examples_QuadrupedMP(benchmark::State &state) {
+  const size_t horizon = state.range(0);
+  const Robot &robot = LeggedRobot(Vision60).robot;
+  const DynamicsGraph builder{};
+  const Pose3 comTfoot(Rot3(), Point3(0.14, 0, 0));
+  const std::vector<std::string> legs = {"lower0", "lower1", "lower2",
+                                         "lower3"};
+  auto body = robot.link("body");
+
+  size_t iterations = 0;
+  double error = 0, build_seconds = 0;
+  for (auto _ : state) {
+    Values values;
+    for (auto &&link : robot.links()) {
+      InsertPose(&values, link->id(), link->bMcom());
+    }
+    for (auto &&joint : robot.joints()) {
+      InsertJointAngle(&values, joint->id(), 0.0);
+    }
+    iterations = 0;
+    build_seconds = 0;
+    for (size_t k = 0; k < horizon; k++) {
+      const Deadline timer;
+      NonlinearFactorGraph graph = builder.qFactors(robot, k);
+      const Pose3 wTb =
+          Pose3(Rot3(), Point3(0.0005 * k, 0, 0)) * body->bMcom();
+      graph.addPrior(PoseKey(body->id(), k), wTb,
+                     gtsam::noiseModel::Constrained::All(6));
+      for (auto &&leg : legs) {
+        const Pose3 bTfoot = robot.link(leg)->bMcom() * comTfoot;
+        graph.add(PointGoalFactor(PoseKey(robot.link(leg)->id(), k),
+                                  gtsam::noiseModel::Constrained::All(3),
+                                  comTfoot.translation(),
+                                  bTfoot.translation()));
+      }
+      build_seconds += timer.elapsed();
+
+      gtsam::GaussNewtonOptimizer optimizer(graph, values);
+      const Values result = optimizer.optimize();
+      iterations += optimizer.iterations();
+      error = graph.error(result);
+
+      values.clear();
+      for (auto &&link : robot.links()) {
+        InsertPose(&values, link->id(), k + 1, Pose(result, link->id(), k));
+      }
+      for (auto &&joint : robot.joints()) {
+        InsertJointAngle(&values, joint->id(), k + 1,
+                         JointAngle(result, joint->id(), k));
+      }
+    }
+  }
+  state.counters["build_s"] = build_seconds;
+  state.counters["iterations"] = iterations;
+  state.counters["error"] = error;
+}
+BENCHMARK(Examples_QuadrupedMP)
+    ->ArgName("horizon")
+    ->Arg(60)
+    ->Arg(240)
+    ->Unit(benchmark::kMillisecond);
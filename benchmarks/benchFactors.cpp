@@ -0,0 +1,240 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchFactors.cpp
+ * @brief Microbenchmarks of error evaluation and linearization of factors.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/ContactPointFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph, gtsam::Values;
+
+namespace {
+const Robot &A1() {
+  static const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  return robot;
+}
+
+// Random values at time steps 0 and 1, so no Jacobian is trivially zero.
+const Values &A1Values() {
+  static const Values values = [] {
+    Values values = Initializer().ZeroValues(A1(), 0, 0.1);
+    values.insert(Initializer().ZeroValues(A1(), 1, 0.1));
+    values.insert(TimeKey(0), 0.01);
+    return values;
+  }();
+  return values;
+}
+
+auto kModel6 = gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+auto kModel3 = gtsam::noiseModel::Isotropic::Sigma(3, 1e-3);
+auto kModel1 = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+
+// Time the error of all factors; counters are per factor.
+void Error(benchmark::State &state, const NonlinearFactorGraph &graph,
+           const Values &values) {
+  for (auto _ : state) {
+    for (auto &&factor : graph) {
+      auto factor_ptr =
+          std::static_pointer_cast<gtsam::NoiseModelFactor>(factor);
+      benchmark::DoNotOptimize(factor_ptr->unwhitenedError(values));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+// Time the linearization of all factors; counters are per factor.
+void Linearize(benchmark::State &state, const NonlinearFactorGraph &graph,
+               const Values &values) {
+  for (auto _ : state) {
+    for (auto &&factor : graph) {
+      benchmark::DoNotOptimize(factor->linearize(values));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph WrenchFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    std::vector<gtsam::Key> wrench_keys;
+    for (auto &&joint : link->joints()) {
+      wrench_keys.push_back(WrenchKey(link->id(), joint->id(), 0));
+    }
+    graph.add(WrenchFactor(kModel6, link, wrench_keys, 0,
+                           gtsam::Vector3(0, 0, -9.8)));
+  }
+  return graph;
+}
+
+NonlinearFactorGraph LinkWrenchFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    std::vector<gtsam::Key> wrench_keys;
+    for (auto &&joint : link->joints()) {
+      wrench_keys.push_back(WrenchKey(link->id(), joint->id(), 0));
+    }
+    graph.emplace_shared<LinkWrenchFactor>(kModel6, link, wrench_keys, 0,
+                                           gtsam::Vector3(0, 0, -9.8));
+  }
+  return graph;
+}
+
+NonlinearFactorGraph TwistAccelFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&joint : A1().joints()) {
+    graph.add(TwistAccelFactor(kModel6, joint, 0));
+  }
+  return graph;
+}
+
+NonlinearFactorGraph ContactPointFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    graph.emplace_shared<ContactPointFactor>(
+        PointOnLink(link, gtsam::Point3(0, 0, -0.1)), gtsam::Symbol('p', 0),
+        kModel3);
+  }
+  return graph;
+}
+
+NonlinearFactorGraph ContactPoseFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    graph.emplace_shared<ContactPoseFactor>(
+        PointOnLink(link, gtsam::Point3(0, 0, -0.1)), gtsam::Symbol('c', 0),
+        kModel6);
+  }
+  return graph;
+}
+
+NonlinearFactorGraph FixedContactPointFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    graph.emplace_shared<FixedContactPointFactor>(
+        PoseKey(link->id(), 0), kModel3, gtsam::Point3(0.1, 0.2, 0),
+        gtsam::Point3(0, 0, -0.1));
+  }
+  return graph;
+}
+
+Values ContactPointValues() {
+  Values values = A1Values();
+  values.insert(gtsam::Symbol('p', 0), gtsam::Point3(0.1, 0.2, 0));
+  values.insert(gtsam::Symbol('c', 0),
+                gtsam::Pose3(gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3),
+                             gtsam::Point3(0.1, 0.2, 0)));
+  return values;
+}
+
+NonlinearFactorGraph CollocationFactors() {
+  NonlinearFactorGraph graph;
+  for (auto &&link : A1().links()) {
+    const int i = link->id();
+    graph.emplace_shared<EulerPoseCollocationFactor>(
+        PoseKey(i, 0), PoseKey(i, 1), TwistKey(i, 0), TimeKey(0), kModel6);
+    graph.emplace_shared<EulerTwistCollocationFactor>(
+        TwistKey(i, 0), TwistKey(i, 1), TwistAccelKey(i, 0), TimeKey(0),
+        kModel6);
+  }
+  return graph;
+}
+
+// Keys of the pneumatic actuator factors, as in testPneumaticActuatorFactors.
+gtsam::Symbol q_key('q', 0), v_key('v', 0), f_key('f', 0), l_key('l', 0),
+    p_key('p', 0), delta_x_key('x', 0), vol_key('V', 0);
+
+NonlinearFactorGraph PneumaticActuatorFactors() {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<ForceBalanceFactor>(delta_x_key, q_key, f_key, kModel1,
+                                           8200, 0.02, 0.5, false);
+  graph.emplace_shared<JointTorqueFactor>(q_key, v_key, f_key,
+                                          gtsam::Symbol('T', 0), kModel1, 0.4,
+                                          5, 0.02, 0.6, false);
+  graph.emplace_shared<SmoothActuatorFactor>(delta_x_key, p_key, f_key,
+                                             kModel1);
+  graph.emplace_shared<ActuatorVolumeFactor>(vol_key, l_key, kModel1, 0.1875,
+                                             0.0254);
+  return graph;
+}
+
+// Hand-derived and automatically differentiated smooth actuator models.
+NonlinearFactorGraph SmoothActuatorFactors() {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<SmoothActuatorFactor>(delta_x_key, p_key, f_key,
+                                             kModel1);
+  return graph;
+}
+
+NonlinearFactorGraph AutoDiffSmoothActuatorFactors() {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<AutoDiffSmoothActuatorFactor>(
+      gtsam::KeyVector{delta_x_key, p_key, f_key}, kModel1);
+  return graph;
+}
+
+Values PneumaticActuatorValues() {
+  Values values;
+  values.insert(q_key, 0.8);
+  values.insert(v_key, 0.3);
+  values.insert(f_key, 10.0);
+  values.insert(gtsam::Symbol('T', 0), 1.0);
+  values.insert(l_key, 1.0);
+  values.insert(p_key, 200.0);
+  values.insert(delta_x_key, 0.04);
+  values.insert(vol_key, 1e-4);
+  return values;
+}
+}  // namespace
+
+/* ************************************************************************* */
+#define GTD_FACTOR_BENCHMARKS(NAME, GRAPH, VALUES)          \
+  static void NAME##_Error(benchmark::State &state) {       \
+    static const NonlinearFactorGraph graph = GRAPH();      \
+    static const Values values = VALUES();                  \
+    Error(state, graph, values);                            \
+  }                                                         \
+  BENCHMARK(NAME##_Error);                                  \
+  static void NAME##_Linearize(benchmark::State &state) {   \
+    static const NonlinearFactorGraph graph = GRAPH();      \
+    static const Values values = VALUES();                  \
+    Linearize(state, graph, values);                        \
+  }                                                         \
+  BENCHMARK(NAME##_Linearize);
+
+GTD_FACTOR_BENCHMARKS(WrenchFactor, WrenchFactors, A1Values)
+GTD_FACTOR_BENCHMARKS(LinkWrenchFactor, LinkWrenchFactors, A1Values)
+GTD_FACTOR_BENCHMARKS(TwistAccelFactor, TwistAccelFactors, A1Values)
+GTD_FACTOR_BENCHMARKS(ContactPointFactor, ContactPointFactors,
+                      ContactPointValues)
+GTD_FACTOR_BENCHMARKS(ContactPoseFactor, ContactPoseFactors,
+                      ContactPointValues)
+GTD_FACTOR_BENCHMARKS(FixedContactPointFactor, FixedContactPointFactors,
+                      ContactPointValues)
+GTD_FACTOR_BENCHMARKS(CollocationFactors, CollocationFactors, A1Values)
+GTD_FACTOR_BENCHMARKS(PneumaticActuatorFactors, PneumaticActuatorFactors,
+                      PneumaticActuatorValues)
+GTD_FACTOR_BENCHMARKS(SmoothActuatorFactor, SmoothActuatorFactors,
+                      PneumaticActuatorValues)
+GTD_FACTOR_BENCHMARKS(AutoDiffSmoothActuatorFactor,
+                      AutoDiffSmoothActuatorFactors, PneumaticActuatorValues)
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchIKFast.cpp
+ * @brief Latency of analytic (IKFast) versus optimization inverse kinematics,
+ * per robot.
+ * @author Frank Dellaert, Antoni Jubes
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/pandarobot/ikfast/IKFastSolver.h>
+#include <gtdynamics/pandarobot/ikfast/PandaAnalyticIK.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::Point3, gtsam::Pose3, gtsam::Values, gtsam::Vector;
+
+namespace {
+// A robot of the fleet, the link of its end-effector, and an IK goal on it.
+struct Arm {
+  Robot robot;
+  std::string base_name, ee_name;
+  Vector q;      // joint angles reaching the goal, by joint id
+  Pose3 wTlink;  // pose of the end-effector link frame
+  ContactGoals contact_goals;
+};
+
+Arm MakeArm(const std::string &file, const std::string &base_name,
+            const std::string &ee_name) {
+  Arm arm;
+  arm.robot = CreateRobotFromFile(kUrdfPath + file).fixLink(base_name);
+  arm.base_name = base_name;
+  arm.ee_name = ee_name;
+
+  // Goal of the end-effector CoM, from joint angles away from singularities.
+  const size_t n = arm.robot.numJoints();
+  arm.q = Vector::LinSpaced(n, 0.3, -0.6);
+  Values known;
+  for (auto &&joint : arm.robot.joints()) {
+    InsertJointAngle(&known, joint->id(), arm.q(joint->id()));
+  }
+  const Values fk = arm.robot.forwardKinematics(known, 0, base_name);
+  const auto ee = arm.robot.link(ee_name);
+  const Pose3 wTcom = Pose(fk, ee->id());
+  arm.wTlink = wTcom * ee->bMcom().inverse() * ee->bMlink();
+  arm.contact_goals = {{PointOnLink(ee, Point3(0, 0, 0)), wTcom.translation()}};
+  return arm;
+}
+
+const Arm &GetArm(const std::string &name) {
+  static const std::map<std::string, Arm> arms{
+      {"panda", MakeArm("panda/panda.urdf", "link0", "link7")},
+      {"ur5", MakeArm("ur5/ur5.urdf", "base_link", "wrist_3_link")},
+      {"fanuc", MakeArm("fanuc_lrmate200id.urdf", "base_link", "Part6")}};
+  return arms.at(name);
+}
+}  // namespace
+
+/* ************************************************************************* */
+// The registered IKFast solver alone, from the end-effector pose.
+static void IKFast_Inverse(benchmark::State &state, const std::string &name) {
+  if (!IKFastRegistry::Has(name)) {
+    state.SkipWithError("no IKFast solver registered for this robot");
+    return;
+  }
+  const auto solver = IKFastRegistry::Get(name);
+  const Vector free = Vector::Constant(solver->numFree(), 0.3);
+  const Pose3 bTe = solver->forward(Vector::LinSpaced(solver->numJoints(),
+                                                      0.3, -0.6));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(solver->inverse(bTe, free));
+  }
+}
+BENCHMARK_CAPTURE(IKFast_Inverse, panda, std::string("panda"));
+BENCHMARK_CAPTURE(IKFast_Inverse, ur5, std::string("ur5"));
+BENCHMARK_CAPTURE(IKFast_Inverse, fanuc, std::string("fanuc"));
+
+/* ************************************************************************* */
+// Inverse kinematics of a contact goal, by nonlinear optimization.
+static void Kinematics_InverseOptimization(benchmark::State &state,
+                                           const std::string &name) {
+  const Arm &arm = GetArm(name);
+  const Kinematics kinematics;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        kinematics.inverse(Slice(0), arm.robot, arm.contact_goals));
+  }
+}
+BENCHMARK_CAPTURE(Kinematics_InverseOptimization, panda, std::string("panda"))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Kinematics_InverseOptimization, ur5, std::string("ur5"))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(Kinematics_InverseOptimization, fanuc, std::string("fanuc"))
+    ->Unit(benchmark::kMillisecond);
+
+/* ************************************************************************* */
+// The same goal through Kinematics, with the closed-form solver only, and
+// refined by the optimizer.
+static void Kinematics_InverseAnalytic(benchmark::State &state, bool refine) {
+  const Arm &arm = GetArm("panda");
+  KinematicsParameters parameters;
+  const double theta7 = arm.q(arm.robot.joint("joint7")->id());
+  parameters.analytic_ik =
+      std::make_shared<PandaAnalyticIK>(arm.wTlink.rotation(), theta7);
+  parameters.refine_analytic_ik = refine;
+  const Kinematics kinematics(parameters);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        kinematics.inverse(Slice(0), arm.robot, arm.contact_goals));
+  }
+}
+BENCHMARK_CAPTURE(Kinematics_InverseAnalytic, panda, false);
+BENCHMARK_CAPTURE(Kinematics_InverseAnalytic, panda_refined, true)
+    ->Unit(benchmark::kMillisecond);
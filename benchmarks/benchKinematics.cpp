@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchKinematics.cpp
+ * @brief Microbenchmarks of forward kinematics and products of exponentials.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Pose3, gtsam::Values, gtsam::Vector;
+
+namespace {
+const Robot &A1() {
+  static const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  return robot;
+}
+
+// Joint angles and velocities of all joints, as Values and as vectors.
+Values JointValues(Vector *q, Vector *v) {
+  const size_t n = A1().numJoints();
+  *q = Vector::LinSpaced(n, -0.5, 0.5);
+  *v = Vector::LinSpaced(n, 0.2, -0.2);
+  Values values;
+  for (auto &&joint : A1().joints()) {
+    InsertJointAngle(&values, joint->id(), (*q)(joint->id()));
+    InsertJointVel(&values, joint->id(), (*v)(joint->id()));
+  }
+  return values;
+}
+
+// A serial chain with a rotated rest pose and n joints.
+Chain SerialChain(size_t n) {
+  gtsam::Vector6 screw_axis;
+  screw_axis << 0, 0.6, 0.8, 0.3, 1, 0;
+  const Chain joint(Pose3(gtsam::Rot3::Rx(0.3), gtsam::Point3(0, 0, 1)),
+                    screw_axis);
+  std::vector<Chain> chains(n, joint);
+  return Chain::compose(chains);
+}
+
+// A batch of num_configs joint configurations of A1.
+gtsam::Matrix BatchAngles(Eigen::Index num_configs) {
+  const Eigen::Index n = A1().numJoints();
+  gtsam::Matrix q(num_configs, n);
+  for (Eigen::Index k = 0; k < num_configs; ++k) {
+    for (Eigen::Index j = 0; j < n; ++j) q(k, j) = std::sin(0.37 * k + 1.3 * j);
+  }
+  return q;
+}
+}  // namespace
+
+/* ************************************************************************* */
+static void Robot_ForwardKinematicsValues(benchmark::State &state) {
+  Vector q, v;
+  const Values values = JointValues(&q, &v);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(A1().forwardKinematics(values, 0, "trunk"));
+  }
+}
+BENCHMARK(Robot_ForwardKinematicsValues);
+
+static void Robot_ForwardKinematicsVector(benchmark::State &state) {
+  Vector q, v;
+  JointValues(&q, &v);
+  LinkStates states;
+  for (auto _ : state) {
+    A1().forwardKinematics(q, v, &states, "trunk");
+    benchmark::DoNotOptimize(states);
+  }
+}
+BENCHMARK(Robot_ForwardKinematicsVector);
+
+/* ************************************************************************* */
+static void Chain_Poe(benchmark::State &state) {
+  Chain chain = SerialChain(state.range(0));
+  const Vector q = Vector::LinSpaced(state.range(0), -0.5, 0.5);
+  for (auto _ : state) benchmark::DoNotOptimize(chain.poe(q));
+}
+BENCHMARK(Chain_Poe)->Arg(3)->Arg(7)->Arg(20);
+
+static void Chain_PoeJacobian(benchmark::State &state) {
+  Chain chain = SerialChain(state.range(0));
+  const Vector q = Vector::LinSpaced(state.range(0), -0.5, 0.5);
+  gtsam::Matrix J;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chain.poe(q, {}, J));
+    benchmark::DoNotOptimize(J);
+  }
+}
+BENCHMARK(Chain_PoeJacobian)->Arg(3)->Arg(7)->Arg(20);
+
+/* ************************************************************************* */
+static void BatchFK_Double(benchmark::State &state) {
+  const BatchForwardKinematics batch_fk(A1(), std::string("trunk"));
+  const gtsam::Matrix q = BatchAngles(state.range(0));
+  BatchLinkPoses poses;
+  for (auto _ : state) batch_fk.compute(q, &poses);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BatchFK_Double)->Arg(1024)->Arg(16384);
+
+static void BatchFK_Float(benchmark::State &state) {
+  const BatchForwardKinematics batch_fk(A1(), std::string("trunk"));
+  const Eigen::MatrixXf q = BatchAngles(state.range(0)).cast<float>();
+  BatchLinkPosesF poses;
+  for (auto _ : state) batch_fk.compute(q, &poses);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BatchFK_Float)->Arg(1024)->Arg(16384);
+
+// Screen all configurations in float, and refine one in a hundred in double.
+static void BatchFK_Mixed(benchmark::State &state) {
+  const BatchForwardKinematics batch_fk(A1(), std::string("trunk"));
+  const gtsam::Matrix q = BatchAngles(state.range(0));
+  const Eigen::MatrixXf qf = q.cast<float>();
+  std::vector<Eigen::Index> kept;
+  for (Eigen::Index k = 0; k < q.rows(); k += 100) kept.push_back(k);
+  BatchLinkPosesF poses_f;
+  BatchLinkPoses poses;
+  for (auto _ : state) {
+    batch_fk.compute(qf, &poses_f);
+    batch_fk.refine(q, kept, &poses);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BatchFK_Mixed)->Arg(1024)->Arg(16384);
@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchOptimizer.cpp
+ * @brief Microbenchmarks of the linear solver backends of MutableLMOptimizer.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/linear/SubgraphSolver.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph, gtsam::Values;
+
+namespace {
+using gtsam::noiseModel::Isotropic;
+
+const Robot &Spider() {
+  static const Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider_alt.sdf"), "spider");
+  return robot;
+}
+
+// The spider walking graph of testSpiderWalking, with the given number of
+// walk cycles, and its initial values.
+std::pair<NonlinearFactorGraph, Values> SpiderWalking(size_t repeat) {
+  const Robot &robot = Spider();
+  std::vector<LinkSharedPtr> odd_feet = {
+      robot.link("tarsus_1_L1"), robot.link("tarsus_3_L3"),
+      robot.link("tarsus_5_R4"), robot.link("tarsus_7_R2")};
+  std::vector<LinkSharedPtr> even_feet = {
+      robot.link("tarsus_2_L2"), robot.link("tarsus_4_L4"),
+      robot.link("tarsus_6_R3"), robot.link("tarsus_8_R1")};
+  auto all_feet = odd_feet;
+  all_feet.insert(all_feet.end(), even_feet.begin(), even_feet.end());
+
+  const gtsam::Point3 contact_in_com(0, 0.19, 0);
+  auto stationary =
+      std::make_shared<FootContactConstraintSpec>(all_feet, contact_in_com);
+  auto odd = std::make_shared<FootContactConstraintSpec>(odd_feet,
+                                                         contact_in_com);
+  auto even = std::make_shared<FootContactConstraintSpec>(even_feet,
+                                                          contact_in_com);
+  const WalkCycle walk_cycle({stationary, even, stationary, odd},
+                             {1, 2, 1, 2});
+  const Trajectory trajectory(walk_cycle, repeat);
+
+  const double sigma = 1e-5, dt = 1. / 240;
+  DynamicsGraph graph_builder(OptimizerSetting(sigma),
+                              gtsam::Vector3(0, 0, -9.8));
+  NonlinearFactorGraph graph = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, 1.0);
+  graph.add(trajectory.contactPointObjectives(
+      robot, Isotropic::Sigma(3, 1e-7), gtsam::Point3(0, 0.4, 0), 0));
+  trajectory.addBoundaryConditions(
+      &graph, robot, Isotropic::Sigma(6, sigma), Isotropic::Sigma(6, sigma),
+      Isotropic::Sigma(6, 1e-6), Isotropic::Sigma(1, 1e-6),
+      Isotropic::Sigma(1, 1e-6));
+  trajectory.addIntegrationTimeFactors(&graph, dt, 1e-6);
+  trajectory.addMinimumTorqueFactors(&graph, robot,
+                                     gtsam::noiseModel::Unit::Create(1));
+  const Values values =
+      trajectory.multiPhaseInitialValues(robot, Initializer(), 0.0, dt);
+  return {graph, values};
+}
+
+// Sparse backends, and GTSAM's subgraph preconditioned CG last.
+enum Solver { Multifrontal, Simplicial, Cholmod, Pardiso, Subgraph };
+
+gtsam::MutableLMParams Params(Solver solver) {
+  gtsam::MutableLMParams params;
+  switch (solver) {
+    case Simplicial:
+      params.linearSolverBackend = SimplicialBackend;
+      break;
+    case Cholmod:
+      params.linearSolverBackend = CholmodBackend;
+      break;
+    case Pardiso:
+      params.linearSolverBackend = PardisoBackend;
+      break;
+    case Subgraph:
+      params.linearSolverType = gtsam::NonlinearOptimizerParams::Iterative;
+      params.iterativeParams =
+          std::make_shared<gtsam::SubgraphSolverParameters>();
+      break;
+    default:
+      break;
+  }
+  return params;
+}
+}  // namespace
+
+/* ************************************************************************* */
+// One outer Levenberg-Marquardt iteration of the spider walking problem, from
+// the initial values, with each backend.
+static void MutableLM_SpiderWalking(benchmark::State &state) {
+  const auto solver = static_cast<Solver>(state.range(0));
+  const gtsam::MutableLMParams params = Params(solver);
+  if (params.linearSolverBackend != EliminationBackend &&
+      !SparseLinearSolver::Available(params.linearSolverBackend)) {
+    state.SkipWithError("backend not compiled in");
+    return;
+  }
+  const auto [graph, values] = SpiderWalking(state.range(1));
+  gtsam::MutableLMOptimizer optimizer(graph, values, params);
+  for (auto _ : state) {
+    optimizer.setValues(values);
+    benchmark::DoNotOptimize(optimizer.iterate());
+  }
+  state.counters["factors"] = graph.size();
+  state.counters["error"] = optimizer.error();
+}
+BENCHMARK(MutableLM_SpiderWalking)
+    ->ArgsProduct({{Multifrontal, Simplicial, Cholmod, Pardiso, Subgraph},
+                   {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+// The same iteration with the wrenches and twist accelerations condensed
+// within each time step before the global solve.
+static void MutableLM_SpiderWalkingCondensed(benchmark::State &state) {
+  const auto [graph, values] = SpiderWalking(state.range(1));
+  gtsam::MutableLMParams params;
+  if (state.range(0)) {
+    params.condensed = DynamicsGraph::CondensedOrdering(Spider(), graph);
+  }
+  gtsam::MutableLMOptimizer optimizer(graph, values, params);
+  for (auto _ : state) {
+    optimizer.setValues(values);
+    benchmark::DoNotOptimize(optimizer.iterate());
+  }
+  state.counters["condensed"] = params.condensed.size();
+  state.counters["error"] = optimizer.error();
+}
+BENCHMARK(MutableLM_SpiderWalkingCondensed)
+    ->ArgsProduct({{0, 1}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
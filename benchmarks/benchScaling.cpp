@@ -0,0 +1,221 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchScaling.cpp
+ * @brief Scaling of kinematics, dynamics and trajectory optimization with the
+ * degrees of freedom and branching of synthetic robots, from 2 to 100 DoF.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace gtdynamics;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+/// Topologies of the synthetic robots.
+enum Topology { Serial, Binary, Quadruped };
+
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+/// Robot of the given topology and about `dof` joints, cached across runs.
+const Robot &Synthetic(Topology topology, size_t dof) {
+  static std::map<std::pair<Topology, size_t>, Robot> robots;
+  auto it = robots.find({topology, dof});
+  if (it != robots.end()) return it->second;
+  Robot robot;
+  switch (topology) {
+    case Binary:
+      robot = BranchedRobot(dof, 2);
+      break;
+    case Quadruped:
+      robot = LeggedRobot(4, std::max<size_t>(dof / 4, 1));
+      break;
+    default:
+      robot = SerialChainRobot(dof);
+  }
+  return robots.emplace(std::make_pair(topology, dof), robot).first->second;
+}
+
+/// Robot for the benchmark arguments {topology, dof}.
+const Robot &Synthetic(const benchmark::State &state) {
+  return Synthetic(static_cast<Topology>(state.range(0)), state.range(1));
+}
+
+// Poses and twists from forward kinematics, and torques or accelerations,
+// the latter with a zero base acceleration.
+Values KnownValues(const Robot &robot, bool torques) {
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), 0.1 * (joint->id() % 3));
+    InsertJointVel(&values, joint->id(), 0.2);
+  }
+  Values known = robot.forwardKinematics(values, 0, std::string("base"));
+  for (auto &&joint : robot.joints()) {
+    if (torques) {
+      InsertTorque(&known, joint->id(), 0, 1.0);
+    } else {
+      InsertJointAccel(&known, joint->id(), 0, 0.5);
+    }
+  }
+  if (!torques) {
+    InsertTwistAccel(&known, robot.link("base")->id(), 0, gtsam::Z_6x1);
+  }
+  return known;
+}
+
+void SetCounters(benchmark::State &state, const Robot &robot) {
+  state.counters["dof"] = robot.numJoints();
+  state.counters["links"] = robot.numLinks();
+}
+
+// Serial chains, binary trees and quadrupeds, from 2 to 100 DoF; the
+// quadrupeds have at least one joint per leg.
+void Sweep(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"topology", "dof"});
+  b->ArgsProduct({{Serial, Binary, Quadruped}, {2, 5, 10, 20, 50, 100}});
+}
+}  // namespace
+
+/* ************************************************************************* */
+// Fast forward kinematics on flat joint vectors.
+static void Scaling_ForwardKinematics(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const size_t n = RecursiveDynamics(robot).numJoints();
+  const Vector q = Vector::Constant(n, 0.1), v = Vector::Constant(n, 0.2);
+  LinkStates states;
+  for (auto _ : state) {
+    robot.forwardKinematics(q, v, &states, std::string("base"));
+    benchmark::DoNotOptimize(states);
+  }
+  SetCounters(state, robot);
+}
+BENCHMARK(Scaling_ForwardKinematics)->Apply(Sweep);
+
+/* ************************************************************************* */
+// Allocation-free forward dynamics with the Articulated Body Algorithm.
+static void Scaling_ForwardDynamicsABA(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const RecursiveDynamics dynamics(robot, kGravity);
+  const size_t n = dynamics.numJoints();
+  const Vector q = Vector::Constant(n, 0.1), v = Vector::Constant(n, 0.2),
+               tau = Vector::Constant(n, 1.0);
+  Vector qdd(n);
+  for (auto _ : state) {
+    dynamics.forwardDynamics(q, v, tau, &qdd);
+    benchmark::DoNotOptimize(qdd);
+  }
+  SetCounters(state, robot);
+}
+BENCHMARK(Scaling_ForwardDynamicsABA)->Apply(Sweep);
+
+/* ************************************************************************* */
+// Joint-space mass matrix with the Composite Rigid Body Algorithm.
+static void Scaling_MassMatrix(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const RecursiveDynamics dynamics(robot, kGravity);
+  const size_t n = dynamics.numJoints();
+  const Vector q = Vector::Constant(n, 0.1);
+  gtsam::Matrix M(n, n);
+  for (auto _ : state) {
+    dynamics.massMatrix(q, &M);
+    benchmark::DoNotOptimize(M);
+  }
+  SetCounters(state, robot);
+}
+BENCHMARK(Scaling_MassMatrix)->Apply(Sweep);
+
+/* ************************************************************************* */
+// Linear forward and inverse dynamics solves, by elimination of the dynamics
+// factor graph and recursively.
+static void Scaling_LinearSolveFD(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const Values known = KnownValues(robot, true);
+  DynamicsGraph graph_builder(kGravity);
+  graph_builder.setLinearSolver(
+      static_cast<LinearDynamicsSolver>(state.range(2)));
+  graph_builder.linearSolveFD(robot, 0, known);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.linearSolveFD(robot, 0, known));
+  }
+  SetCounters(state, robot);
+}
+BENCHMARK(Scaling_LinearSolveFD)
+    ->ArgNames({"topology", "dof", "solver"})
+    ->ArgsProduct({{Serial, Binary, Quadruped},
+                   {2, 5, 10, 20, 50, 100},
+                   {Elimination, Recursive}});
+
+static void Scaling_LinearSolveID(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const Values known = KnownValues(robot, false);
+  DynamicsGraph graph_builder(kGravity);
+  graph_builder.setLinearSolver(
+      static_cast<LinearDynamicsSolver>(state.range(2)));
+  graph_builder.linearSolveID(robot, 0, known);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph_builder.linearSolveID(robot, 0, known));
+  }
+  SetCounters(state, robot);
+}
+BENCHMARK(Scaling_LinearSolveID)
+    ->ArgNames({"topology", "dof", "solver"})
+    ->ArgsProduct({{Serial, Binary, Quadruped},
+                   {2, 5, 10, 20, 50, 100},
+                   {Elimination, Recursive}});
+
+/* ************************************************************************* */
+// One Levenberg-Marquardt iteration on a 10-step trajectory, with the initial
+// state and the torques of all steps given.
+static void Scaling_TrajectoryIteration(benchmark::State &state) {
+  const Robot &robot = Synthetic(state);
+  const int num_steps = 10;
+  const DynamicsGraph graph_builder(kGravity);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.01);
+  const auto noise = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior(JointAngleKey(j, 0), 0.0, noise);
+    graph.addPrior(JointVelKey(j, 0), 0.0, noise);
+    for (int k = 0; k <= num_steps; k++) {
+      graph.addPrior(TorqueKey(j, k), 0.0, noise);
+    }
+  }
+  const auto base = robot.link("base");
+  if (!base->isFixed()) {
+    const auto base_noise = gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+    graph.addPrior(PoseKey(base->id(), 0), base->bMcom(), base_noise);
+    graph.addPrior<gtsam::Vector6>(TwistKey(base->id(), 0), gtsam::Z_6x1,
+                                   base_noise);
+  }
+  const Values init = Initializer().ZeroValuesTrajectory(robot, num_steps);
+
+  gtsam::LevenbergMarquardtParams params;
+  params.setMaxIterations(1);
+  for (auto _ : state) {
+    gtsam::LevenbergMarquardtOptimizer optimizer(graph, init, params);
+    benchmark::DoNotOptimize(optimizer.optimize());
+  }
+  SetCounters(state, robot);
+  state.counters["factors"] = graph.size();
+}
+BENCHMARK(Scaling_TrajectoryIteration)
+    ->Apply(Sweep)
+    ->Unit(benchmark::kMillisecond);
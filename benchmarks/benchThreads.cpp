@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchThreads.cpp
+ * @brief Throughput of graph building and dynamics solves from several
+ * threads sharing one const Robot and DynamicsGraph, without copies. Items
+ * per second should scale with the number of threads.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace {
+const Robot &A1() {
+  static const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  return robot;
+}
+
+const DynamicsGraph &GraphBuilder() {
+  static const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  return graph_builder;
+}
+
+// Poses and twists from forward kinematics, and torques.
+Values KnownValues() {
+  Values values;
+  for (auto &&joint : A1().joints()) {
+    InsertJointAngle(&values, joint->id(), 0.1 * (joint->id() % 3));
+    InsertJointVel(&values, joint->id(), 0.2);
+  }
+  Values known = A1().forwardKinematics(values, 0, std::string("trunk"));
+  for (auto &&joint : A1().joints()) {
+    InsertTorque(&known, joint->id(), 0, 1.0);
+  }
+  return known;
+}
+}  // namespace
+
+/* ************************************************************************* */
+// Build the dynamics graph of one time step, a different one per thread.
+static void Threads_DynamicsFactorGraph(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GraphBuilder().dynamicsFactorGraph(A1(), state.thread_index()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Threads_DynamicsFactorGraph)->ThreadRange(1, 16)->UseRealTime();
+
+/* ************************************************************************* */
+// Linear forward dynamics solves, with the elimination ordering cache shared
+// by all threads.
+static void Threads_LinearSolveFD(benchmark::State &state) {
+  const Values known = KnownValues();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GraphBuilder().linearSolveFD(A1(), 0, known));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Threads_LinearSolveFD)->ThreadRange(1, 16)->UseRealTime();
+
+/* ************************************************************************* */
+// Build a 10-step trajectory graph.
+static void Threads_TrajectoryFG(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GraphBuilder().trajectoryFG(A1(), 10, 0.01));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Threads_TrajectoryFG)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
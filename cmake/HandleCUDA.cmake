@@ -0,0 +1,15 @@
+###############################################################################
+if (GTDYNAMICS_WITH_CUDA)
+    # The CUDAToolkit package needs CMake 3.17, and CUDA_STANDARD 17 needs
+    # CMake 3.18.
+    if(CMAKE_VERSION VERSION_LESS 3.18)
+        message(FATAL_ERROR "GTDYNAMICS_WITH_CUDA needs CMake 3.18 or newer.")
+    endif()
+    enable_language(CUDA)
+    find_package(CUDAToolkit REQUIRED)
+
+    set(GTDYNAMICS_USE_CUDA 1)  # This will go into config.h
+    if(NOT DEFINED CMAKE_CUDA_ARCHITECTURES)
+        set(CMAKE_CUDA_ARCHITECTURES 70 75 80 86)
+    endif()
+endif()
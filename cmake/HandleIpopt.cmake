@@ -0,0 +1,9 @@
+###############################################################################
+# Optional IPOPT interior point solver of IpoptOptimizer, found through the
+# ipopt.pc file that IPOPT installs.
+if (GTDYNAMICS_WITH_IPOPT)
+    find_package(PkgConfig REQUIRED)
+    pkg_check_modules(IPOPT REQUIRED IMPORTED_TARGET ipopt)
+    set(GTDYNAMICS_USE_IPOPT 1)  # This will go into config.h
+    list(APPEND GTDYNAMICS_ADDITIONAL_LIBRARIES PkgConfig::IPOPT)
+endif()
@@ -0,0 +1,20 @@
+###############################################################################
+# Optional sparse Cholesky backends of MutableLMOptimizer, used through
+# Eigen's CholmodSupport and PardisoSupport modules.
+if (GTDYNAMICS_WITH_CHOLMOD)
+    find_path(CHOLMOD_INCLUDE_DIR cholmod.h PATH_SUFFIXES suitesparse)
+    find_library(CHOLMOD_LIBRARY cholmod)
+    if(CHOLMOD_INCLUDE_DIR AND CHOLMOD_LIBRARY)
+        set(GTDYNAMICS_USE_CHOLMOD 1)  # This will go into config.h
+        list(APPEND GTDYNAMICS_ADDITIONAL_LIBRARIES ${CHOLMOD_LIBRARY})
+    else()
+        message(FATAL_ERROR "GTDYNAMICS_WITH_CHOLMOD is set but CHOLMOD was not found.")
+    endif()
+endif()
+
+if (GTDYNAMICS_WITH_PARDISO)
+    # MKL from oneAPI provides MKLConfig.cmake and the MKL::MKL target.
+    find_package(MKL CONFIG REQUIRED)
+    set(GTDYNAMICS_USE_PARDISO 1)  # This will go into config.h
+    list(APPEND GTDYNAMICS_ADDITIONAL_LIBRARIES MKL::MKL)
+endif()
@@ -233,7 +233,34 @@ void kinematic_planning() {
   std::cout << latex_os.str();
 }
 
+/** Run all methods on freshly sampled problems and write machine-readable
+ * results, e.g. `main_connected_poses --json 10`. */
+void benchmark(bool json, size_t repetitions) {
+  auto gt = get_gt_values();
+  auto build_problem = [&]() {
+    auto odo_measurements = GetOdoMeasurements(gt);
+    auto constraints = ConstraintsFromGraph(get_constraints_graph(gt));
+    return EqConsOptProblem(get_costs(gt, odo_measurements), constraints,
+                            get_init_values(gt, odo_measurements));
+  };
+  LevenbergMarquardtParams lm_params;
+  lm_params.setlambdaUpperBound(1e10);
+  auto results = RunBenchmark("connected_poses", build_problem,
+                              DefaultBenchmarkMethods(lm_params, 1e4),
+                              repetitions, constraint_unit_scale);
+  if (json) {
+    WriteBenchmarkJson(results, std::cout);
+  } else {
+    WriteBenchmarkCsv(results, std::cout);
+  }
+}
+
 int main(int argc, char **argv) {
-  kinematic_planning();
+  const std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "--csv" || mode == "--json") {
+    benchmark(mode == "--json", argc > 2 ? std::stoul(argv[2]) : 1);
+  } else {
+    kinematic_planning();
+  }
   return 0;
 }
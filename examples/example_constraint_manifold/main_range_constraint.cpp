@@ -193,6 +193,14 @@ void kinematic_planning() {
       OptimizeAugmentedLagrangian(problem, latex_os, augl_params, constraint_unit_scale);
   std::cout << "pose error: " << EvaluatePoseError(gt, augl_result) << "\n";
 
+  // optimize sequential quadratic programming
+  std::cout << "sqp:\n";
+  SQPParameters sqp_params;
+  sqp_params.damping = 1e-6;
+  auto sqp_result =
+      OptimizeSQP(problem, latex_os, sqp_params, constraint_unit_scale);
+  std::cout << "pose error: " << EvaluatePoseError(gt, sqp_result) << "\n";
+
   // for (size_t i=0; i<10; i++) {
     // optimize constraint manifold specify variables (feasbile)
     std::cout << "constraint manifold basis variables (feasible):\n";
@@ -216,7 +224,31 @@ void kinematic_planning() {
   std::cout << latex_os.str();
 }
 
+/** Run all methods on freshly sampled problems and write machine-readable
+ * results, e.g. `main_range_constraint --csv 10`. */
+void benchmark(bool json, size_t repetitions) {
+  auto gt = get_gt_values();
+  LevenbergMarquardtParams lm_params;
+  auto build_problem = [&]() {
+    auto constraints = ConstraintsFromGraph(get_constraints_graph(gt));
+    return EqConsOptProblem(get_costs(gt), constraints, get_init_values(gt));
+  };
+  auto results = RunBenchmark("range_constraint", build_problem,
+                              DefaultBenchmarkMethods(lm_params, 1e4),
+                              repetitions, constraint_unit_scale);
+  if (json) {
+    WriteBenchmarkJson(results, std::cout);
+  } else {
+    WriteBenchmarkCsv(results, std::cout);
+  }
+}
+
 int main(int argc, char **argv) {
-  kinematic_planning();
+  const std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "--csv" || mode == "--json") {
+    benchmark(mode == "--json", argc > 2 ? std::stoul(argv[2]) : 1);
+  } else {
+    kinematic_planning();
+  }
   return 0;
 }
@@ -15,6 +15,7 @@
 #include <gtdynamics/dynamics/OptimizerSetting.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/utils/Initializer.h>
@@ -283,6 +284,9 @@ int main(int argc, char** argv) {
       robot, phase_steps, transition_graph_init, dt_des, gaussian_noise,
       phase_cps);
 
+  // Memory of the problem and of one linearization, to size the horizon.
+  gtdynamics::ReportMemory(graph, init_vals).print();
+
   // Optimize!
   gtsam::LevenbergMarquardtParams params;
   params.setVerbosityLM("SUMMARY");
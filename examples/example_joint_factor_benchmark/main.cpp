@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Linearization cost of joint expression factors vs. closed-form ones.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/factors/JointFactors.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TorqueFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchEquivalenceFactor.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+
+using FactorMaker = std::function<gtsam::NoiseModelFactor::shared_ptr(
+    const JointConstSharedPtr &)>;
+
+// Linearize one factor per joint, many times, and return the time in
+// microseconds per factor linearization.
+double TimeLinearize(const Robot &robot, const FactorMaker &make,
+                     const gtsam::Values &values, size_t repetitions) {
+  gtsam::NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints()) graph.add(make(joint));
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repetitions; ++i) {
+    for (auto &&factor : graph) factor->linearize(values);
+  }
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (repetitions * graph.size());
+}
+
+int main(int argc, char **argv) {
+  const size_t repetitions = argc > 1 ? std::stoul(argv[1]) : 10000;
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+
+  // Random values, so no Jacobian is trivially zero.
+  const gtsam::Values values = Initializer().ZeroValues(robot, 0, 0.1);
+
+  auto model6 = gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+  auto model1 = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+
+  struct Case {
+    std::string name;
+    FactorMaker expression, closed_form;
+  };
+  using J = const JointConstSharedPtr &;
+  const std::vector<Case> cases{
+      {"pose", [&](J j) { return PoseFactor(model6, j, 0); },
+       [&](J j) { return std::make_shared<JointPoseFactor>(model6, j, 0); }},
+      {"twist", [&](J j) { return TwistFactor(model6, j, 0); },
+       [&](J j) { return std::make_shared<JointTwistFactor>(model6, j, 0); }},
+      {"twistAccel", [&](J j) { return TwistAccelFactor(model6, j, 0); },
+       [&](J j) {
+         return std::make_shared<JointTwistAccelFactor>(model6, j, 0);
+       }},
+      {"wrenchEquivalence",
+       [&](J j) { return WrenchEquivalenceFactor(model6, j, 0); },
+       [&](J j) {
+         return std::make_shared<JointWrenchEquivalenceFactor>(model6, j, 0);
+       }},
+      {"torque", [&](J j) { return TorqueFactor(model1, j, 0); },
+       [&](J j) {
+         return std::make_shared<JointWrenchTorqueFactor>(model1, j, 0);
+       }},
+  };
+
+  std::printf("%-20s %14s %14s %8s\n", "factor", "expression(us)",
+              "closed(us)", "speedup");
+  for (auto &&c : cases) {
+    const double t_expression =
+        TimeLinearize(robot, c.expression, values, repetitions);
+    const double t_closed_form =
+        TimeLinearize(robot, c.closed_form, values, repetitions);
+    std::printf("%-20s %14.3f %14.3f %8.2f\n", c.name.c_str(), t_expression,
+                t_closed_form, t_expression / t_closed_form);
+  }
+  return 0;
+}
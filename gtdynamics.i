@@ -109,6 +109,14 @@ class TrapezoidalPoseCollocationFactor : gtsam::NonlinearFactor {
                                    const gtsam::noiseModel::Base *cost_model);
 };
 
+class HermiteSimpsonPoseCollocationFactor : gtsam::NonlinearFactor {
+  HermiteSimpsonPoseCollocationFactor(
+      gtsam::Key pose_t0_key, gtsam::Key pose_t1_key, gtsam::Key twist_t0_key,
+      gtsam::Key twist_t1_key, gtsam::Key accel_t0_key,
+      gtsam::Key accel_t1_key, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base *cost_model);
+};
+
 class EulerTwistCollocationFactor : gtsam::NonlinearFactor {
   EulerTwistCollocationFactor(gtsam::Key twist_t0_key, gtsam::Key twist_t1_key,
                               gtsam::Key accel_key, gtsam::Key dt_key,
@@ -325,6 +333,10 @@ class KinematicsParameters : gtdynamics::OptimizationParameters {
   const gtsam::SharedNoiseModel p_cost_model; 
   const gtsam::SharedNoiseModel g_cost_model;
   const gtsam::SharedNoiseModel prior_q_cost_model;
+  bool warm_start;
+  size_t slices_per_task;
+  size_t densify_samples;
+  double densify_tolerance;
 
   KinematicsParameters();
 };
@@ -368,6 +380,7 @@ class OptimizerSetting {
   gtsam::noiseModel::SharedNoiseModel cv_cost_model;             // contact twist
   gtsam::noiseModel::SharedNoiseModel ca_cost_model;             // contact acceleration
   gtsam::noiseModel::SharedNoiseModel cm_cost_model;             // contact moment
+  gtsam::noiseModel::SharedNoiseModel ccomp_cost_model;          // contact complementarity
   gtsam::noiseModel::SharedNoiseModel planar_cost_model;         // planar factor
   gtsam::noiseModel::SharedNoiseModel linear_planar_cost_model;  // linear planar factor
   gtsam::noiseModel::SharedNoiseModel prior_q_cost_model;        // joint angle prior factor
@@ -385,6 +398,15 @@ class OptimizerSetting {
 
 #include<gtdynamics/dynamics/DynamicsGraph.h>
 enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
+enum LinearDynamicsSolver { Elimination, Recursive, Sparse };
+
+class GraphPatch {
+  GraphPatch();
+  gtsam::FactorIndices remove;
+  gtsam::NonlinearFactorGraph add;
+  bool empty() const;
+  void apply(gtsam::NonlinearFactorGraph *graph) const;
+};
 
 class DynamicsGraph {
   DynamicsGraph();
@@ -397,7 +419,7 @@ class DynamicsGraph {
 
   gtsam::GaussianFactorGraph linearDynamicsGraph(
       const gtdynamics::Robot &robot, const int t,
-      const gtsam::Values &known_values);
+      const gtsam::Values &known_values) const;
 
   gtsam::GaussianFactorGraph linearFDPriors(
       const gtdynamics::Robot &robot, const int t,
@@ -407,11 +429,18 @@ class DynamicsGraph {
       const gtdynamics::Robot &robot, const int t,
       const gtsam::Values &known_values);
 
+  void setLinearSolver(gtdynamics::LinearDynamicsSolver solver);
+  gtdynamics::LinearDynamicsSolver linearSolver() const;
+
   gtsam::Values linearSolveFD(const gtdynamics::Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+                              const gtsam::Values &known_values) const;
+  gtsam::Values linearSolveFD(
+      const gtdynamics::Robot &robot, const int t,
+      const gtsam::Values &known_values,
+      const std::optional<gtdynamics::PointOnLinks> &contact_points) const;
 
   gtsam::Values linearSolveID(const gtdynamics::Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+                              const gtsam::Values &known_values) const;
 
   gtsam::NonlinearFactorGraph qFactors(
       const gtdynamics::Robot &robot, const int t,
@@ -544,6 +573,19 @@ class DynamicsGraph {
                                             const gtsam::Values &result,
                                             const int t);
 
+  /* return joint values of all time steps as (num_steps x num_joints). */
+  static Matrix jointAccelsMatrix(const gtdynamics::Robot &robot,
+                                  const gtsam::Values &result,
+                                  size_t num_steps);
+  static Matrix jointVelsMatrix(const gtdynamics::Robot &robot,
+                                const gtsam::Values &result, size_t num_steps);
+  static Matrix jointAnglesMatrix(const gtdynamics::Robot &robot,
+                                  const gtsam::Values &result,
+                                  size_t num_steps);
+  static Matrix jointTorquesMatrix(const gtdynamics::Robot &robot,
+                                   const gtsam::Values &result,
+                                   size_t num_steps);
+
   /* print the factors of the factor graph */
   static void printGraph(const gtsam::NonlinearFactorGraph &graph);
 
@@ -617,6 +659,7 @@ std::vector<gtsam::Point3> SimpleSwingTrajectory(const gtsam::Point3 &start,
 #include <gtdynamics/utils/Initializer.h>
 class Initializer {
   Initializer();
+  Initializer(size_t seed);
 
   gtsam::Values ZeroValues(
       const gtdynamics::Robot& robot, const int t, double gaussian_noise);
@@ -666,6 +709,7 @@ gtsam::Key PoseKey(int i, int t=0);
 gtsam::Key ContactWrenchKey(int i, int k, int t=0);
 gtsam::Key PhaseKey(int k);
 gtsam::Key TimeKey(int t);
+gtsam::Key StrideKey(int c = 0);
 
 ///////////////////// Key Methods /////////////////////
 void InsertJointAngle(gtsam::Values@ values, int j, int t, double value);
@@ -733,6 +777,8 @@ gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t=0);
 /********************** Simulator **********************/
 #include <gtdynamics/dynamics/Simulator.h>
 
+enum IntegrationScheme { TaylorStep, SemiImplicitEuler, RungeKutta4 };
+
 class Simulator {
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values);
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
@@ -742,12 +788,81 @@ class Simulator {
             const gtsam::Vector3 &planar_axis);
 
   void reset(const double t);
+  void setIntegrationScheme(gtdynamics::IntegrationScheme scheme);
+  gtdynamics::IntegrationScheme integrationScheme() const;
   void forwardDynamics(const gtsam::Values &torques);
   void integration(const double dt);
   void step(const gtsam::Values &torques, const double dt);
+  void step(const gtsam::Vector &torques, const double dt);
   gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
                          const double dt);
   const gtsam::Values &getValues() const;
+  const gtsam::Vector &jointAngles() const;
+  const gtsam::Vector &jointVels() const;
+  const gtsam::Vector &jointAccels() const;
+  const gtsam::Vector &torques() const;
+  gtsam::Values jointValues() const;
+};
+
+#include <gtdynamics/dynamics/ClosedChainDynamics.h>
+class ClosedChainDynamics {
+  ClosedChainDynamics(const gtdynamics::Robot &robot);
+  ClosedChainDynamics(const gtdynamics::Robot &robot,
+                      const gtsam::Vector3 &gravity);
+  gtsam::Values forwardKinematics(int t, const gtsam::Values &known_values);
+  gtsam::Values forwardKinematics(int t, const gtsam::Values &known_values,
+                                  const gtsam::Values &initial);
+  gtsam::Values inverseDynamics(int t, const gtsam::Values &known_values);
+  gtsam::Values inverseDynamics(int t, const gtsam::Values &known_values,
+                                const std::vector<int> &actuated);
+  const gtdynamics::Robot &tree() const;
+  size_t numJoints() const;
+};
+
+#include <gtdynamics/dynamics/BatchDynamics.h>
+enum BatchBackend { CpuBackend, CudaBackend };
+
+class BatchDynamics {
+  BatchDynamics(const gtdynamics::Robot &robot);
+  BatchDynamics(const gtdynamics::Robot &robot, const gtsam::Vector3 &gravity);
+  BatchDynamics(const gtdynamics::Robot &robot, const gtsam::Vector3 &gravity,
+                gtdynamics::BatchBackend backend);
+  static bool CudaAvailable();
+  gtsam::Matrix inverseDynamics(const gtsam::Matrix &q, const gtsam::Matrix &v,
+                                const gtsam::Matrix &qdd) const;
+  gtdynamics::BatchBackend backend() const;
+  size_t numJoints() const;
+};
+
+#include <gtdynamics/dynamics/ILQROptimizer.h>
+class ILQRParams {
+  ILQRParams();
+  size_t max_iterations;
+  double relative_tolerance;
+  double regularization;
+  double max_regularization;
+  size_t line_search_steps;
+};
+
+class ILQROptimizer {
+  ILQROptimizer(const gtdynamics::Robot &robot,
+                const gtdynamics::DynamicsGraph &graph_builder, int num_steps,
+                double dt);
+  ILQROptimizer(const gtdynamics::Robot &robot,
+                const gtdynamics::DynamicsGraph &graph_builder, int num_steps,
+                double dt, const gtdynamics::ILQRParams &params);
+  gtsam::Values optimize(const gtsam::Values &state,
+                         const gtsam::NonlinearFactorGraph &objectives);
+  gtsam::Values optimize(const gtsam::Values &state,
+                         const gtsam::NonlinearFactorGraph &objectives,
+                         const gtsam::Matrix &initial_torques);
+  void reset();
+  const gtsam::Matrix &torques() const;
+  const gtsam::Matrix &gain(int k) const;
+  double cost() const;
+  size_t iterations() const;
+  int numSteps() const;
+  size_t numJoints() const;
 };
 
 /********************** Trajectory et al  **********************/
@@ -817,6 +932,11 @@ class Trajectory {
                         const gtdynamics::DynamicsGraph &graph_builder,
                         const gtdynamics::CollocationScheme collocation,
                         double mu) const;
+  gtsam::NonlinearFactorGraph
+  repeatedMultiPhaseFactorGraph(const gtdynamics::Robot& robot,
+                                const gtdynamics::DynamicsGraph &graph_builder,
+                                const gtdynamics::CollocationScheme collocation,
+                                double mu) const;
   std::vector<gtsam::Values>
   transitionPhaseInitialValues(const gtdynamics::Robot& robot, const gtdynamics::Initializer &initializer,
                                double gaussian_noise) const;
@@ -826,6 +946,11 @@ class Trajectory {
   const Phase &phase(size_t p) const;
   size_t getStartTimeStep(size_t p) const;
   size_t getEndTimeStep(size_t p) const;
+  const gtdynamics::PointOnLinks &stepContactPoints(int k) const;
+  gtdynamics::GraphPatch contactSwitchPatch(
+      const gtsam::NonlinearFactorGraph &graph, const gtdynamics::Robot &robot,
+      const gtdynamics::DynamicsGraph &graph_builder, int k_start, int k_end,
+      const gtdynamics::FootContactConstraintSpec &spec, double mu) const;
   gtsam::NonlinearFactor pointGoalFactor(const gtdynamics::Robot &robot,
                                   const string &link_name,
                                   const gtdynamics::PointOnLink &cp, size_t k,
@@ -835,10 +960,12 @@ class Trajectory {
   contactPointObjectives(const gtdynamics::Robot& robot, 
                          const gtsam::SharedNoiseModel &cost_model,
                          const gtsam::Point3 &step,
-                         double ground_height = 0) const;
+                         double ground_height = 0,
+                         bool path_factors = false) const;
   void addMinimumTorqueFactors(gtsam::NonlinearFactorGraph @graph,
                                const gtdynamics::Robot& robot, 
-                               const gtsam::SharedNoiseModel &cost_model) const;
+                               const gtsam::SharedNoiseModel &cost_model,
+                               bool per_time_step = false) const;
   void addBoundaryConditions(
       gtsam::NonlinearFactorGraph @graph,
       const gtdynamics::Robot& robot, 
@@ -847,11 +974,37 @@ class Trajectory {
       const gtsam::SharedNoiseModel &twist_acceleration_model,
       const gtsam::SharedNoiseModel &joint_velocity_model,
       const gtsam::SharedNoiseModel &joint_acceleration_model) const;
+  void addPeriodicBoundaryConditions(
+      gtsam::NonlinearFactorGraph @graph,
+      const gtdynamics::Robot& robot,
+      const gtsam::SharedNoiseModel &pose_model,
+      const gtsam::SharedNoiseModel &twist_model,
+      const gtsam::SharedNoiseModel &twist_acceleration_model,
+      const gtsam::SharedNoiseModel &joint_angle_model,
+      const gtsam::SharedNoiseModel &joint_velocity_model,
+      const gtsam::SharedNoiseModel &joint_acceleration_model,
+      gtsam::Key stride_key) const;
+  gtsam::Values periodicValues(const gtsam::Values &values, size_t repeat,
+                               gtsam::Key stride_key) const;
   void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph @graph,
                                  double desired_dt, double sigma = 0) const;
   void writeToFile(const gtdynamics::Robot &robot, const string &name, const gtsam::Values &results) const;
 };
 
+#include <gtdynamics/utils/TrajectoryValues.h>
+// NumPy views of the joint states are defined in specializations
+class TrajectoryValues {
+  TrajectoryValues(size_t num_steps, size_t num_joints, size_t num_links);
+  TrajectoryValues(const gtdynamics::Robot &robot, size_t num_steps);
+  static gtdynamics::TrajectoryValues FromValues(
+      const gtdynamics::Robot &robot, const gtsam::Values &values,
+      size_t num_steps);
+  gtsam::Values toValues() const;
+  size_t numSteps() const;
+  size_t numJoints() const;
+  size_t numLinks() const;
+};
+
 /********************** Utilities  **********************/
 #include <gtdynamics/utils/format.h>
 string GtdFormat(const gtsam::Values &t, const string &s = "");
@@ -39,4 +39,116 @@ class PriorFactor : gtsam::NonlinearFactor {
              const gtsam::KeyFormatter &keyFormatter);
 };
 
+#include <gtdynamics/cablerobot/factors/CableTensionsFactor.h>
+class CableTensionsFactor : gtsam::NonlinearFactor {
+  CableTensionsFactor(const gtsam::KeyVector &tension_keys, gtsam::Key xPose_key,
+                      gtsam::Key wrench_key,
+                      const gtsam::noiseModel::Base* cost_model,
+                      const gtsam::Matrix &wPa, const gtsam::Matrix &xPb);
+  size_t numCables() const;
+  gtsam::Vector6 computeWrench(const gtsam::Vector &tensions,
+                               const gtsam::Pose3 &wTx) const;
+  void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
+};
+
+/****************************************** Control ******************************************/
+
+#include <gtdynamics/cablerobot/control/CdprPlanar.h>
+class CdprParams {
+  CdprParams();
+  gtsam::Matrix a_locs;
+  gtsam::Matrix b_locs;
+  double mass;
+  gtsam::Matrix3 inertia;
+  gtsam::Vector3 gravity;
+};
+
+class CdprPlanar {
+  CdprPlanar();
+  CdprPlanar(const gtdynamics::CdprParams &params);
+  const gtdynamics::CdprParams &params() const;
+  const gtdynamics::Robot &robot() const;
+  int eeId() const;
+  size_t numCables() const;
+  gtsam::NonlinearFactorGraph allFactors(size_t N, double dt) const;
+  gtsam::NonlinearFactorGraph kinematicsFactors(const std::vector<int> &ks) const;
+  gtsam::NonlinearFactorGraph dynamicsFactors(const std::vector<int> &ks) const;
+  gtsam::NonlinearFactorGraph collocationFactors(const std::vector<int> &ks,
+                                                 double dt) const;
+  gtsam::NonlinearFactorGraph priorsFk(const std::vector<int> &ks,
+                                       const std::vector<gtsam::Vector> &ls,
+                                       const std::vector<gtsam::Vector> &ldots) const;
+  gtsam::NonlinearFactorGraph priorsIk(const std::vector<int> &ks,
+                                       const std::vector<gtsam::Pose3> &Ts,
+                                       const std::vector<gtsam::Vector6> &Vs) const;
+  gtsam::NonlinearFactorGraph priorsId(const std::vector<int> &ks,
+                                       const std::vector<gtsam::Vector> &torques) const;
+  gtsam::NonlinearFactorGraph priorsFd(const std::vector<int> &ks,
+                                       const std::vector<gtsam::Vector6> &VAs) const;
+  gtsam::Values zeroValues(const std::vector<int> &ks, double dt) const;
+};
+
+#include <gtdynamics/cablerobot/control/CableStatics.h>
+class CableWorkspace {
+  gtsam::Matrix tensions;
+  size_t numFeasible() const;
+};
+
+class CableStatics {
+  CableStatics(const gtdynamics::CdprParams &params, double t_min,
+               double t_max, const std::vector<int> &dofs);
+  size_t numCables() const;
+  gtsam::Matrix structureMatrix(const gtsam::Pose3 &wTx) const;
+  gtdynamics::CableWorkspace workspace(const std::vector<gtsam::Pose3> &poses,
+                                       const gtsam::Vector6 &external) const;
+};
+
+#include <gtdynamics/cablerobot/control/CdprPlanarController.h>
+virtual class CdprControllerBase {
+  gtsam::Vector tensions(const gtsam::Values &values, int k);
+};
+
+virtual class CdprPlanarController : gtdynamics::CdprControllerBase {
+  CdprPlanarController(const gtdynamics::CdprPlanar &cdpr, const gtsam::Values &x0,
+                       const std::vector<gtsam::Pose3> &pdes, double dt,
+                       const std::optional<gtsam::Vector> &Q,
+                       const gtsam::Vector &R);
+  static gtsam::NonlinearFactorGraph CreateIlqrGraph(
+      const gtdynamics::CdprPlanar &cdpr, const gtsam::Values &x0,
+      const std::vector<gtsam::Pose3> &pdes, double dt,
+      const std::optional<gtsam::Vector> &Q, const gtsam::Vector &R);
+  const gtsam::Values &update(const gtsam::Values &values, int k) const;
+  gtsam::Vector torques(int k) const;
+  const gtsam::Values &replan(const gtsam::Values &x0);
+  const gtsam::NonlinearFactorGraph &graph() const;
+  const gtsam::Values &result() const;
+};
+
+#include <gtdynamics/cablerobot/control/CdprPlanarFixedLagController.h>
+virtual class CdprPlanarFixedLagController : gtdynamics::CdprControllerBase {
+  CdprPlanarFixedLagController(const gtdynamics::CdprPlanar &cdpr,
+                               const std::vector<gtsam::Pose3> &pdes,
+                               size_t horizon, double dt, size_t iterations,
+                               const std::optional<gtsam::Vector> &Q,
+                               const gtsam::Vector &R);
+  const gtsam::NonlinearFactorGraph &graph() const;
+  const gtsam::Values &window() const;
+  size_t horizon() const;
+};
+
+#include <gtdynamics/cablerobot/control/CdprPlanarSimulator.h>
+class CdprPlanarSimulator {
+  CdprPlanarSimulator(const gtdynamics::CdprPlanar &cdpr, const gtsam::Values &x0,
+                      const gtdynamics::CdprControllerBase *controller,
+                      double dt);
+  CdprPlanarSimulator(const gtdynamics::CdprPlanar &cdpr, const gtsam::Values &x0,
+                      double dt);
+  const gtsam::Values &step();
+  const gtsam::Values &step(const gtsam::Vector &torques);
+  const gtsam::Values &run(size_t N);
+  void reset();
+  int k() const;
+  const gtsam::Values &values() const;
+};
+
 }  // namespace gtdynamics
@@ -0,0 +1,149 @@
+/**
+ * @file  CableStatics.cpp
+ * @brief Static tension distributions of a cable robot, over many poses at
+ * once, for wrench-feasible workspace maps.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CableStatics.h"
+
+#include <gtdynamics/statics/Statics.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+/// Number of poses solved together.
+constexpr size_t kChunkSize = 64;
+
+/// Relative tolerance on the wrench balance.
+constexpr double kTolerance = 1e-9;
+
+/// Placeholder keys of the tensions, the pose and the wrench.
+std::vector<Key> TensionKeys(size_t n) {
+  std::vector<Key> keys(n);
+  for (size_t j = 0; j < n; j++) keys[j] = j;
+  return keys;
+}
+}  // namespace
+
+/* ************************************************************************* */
+CableStatics::CableStatics(const CdprParams &params, double t_min,
+                           double t_max, const std::vector<int> &dofs)
+    : params_(params),
+      t_min_(t_min),
+      t_max_(t_max),
+      dofs_(dofs),
+      cables_(TensionKeys(params.a_locs.rows()), params.a_locs.rows(),
+              params.a_locs.rows() + 1, noiseModel::Unit::Create(6),
+              params.a_locs, params.b_locs) {
+  if (t_min_ > t_max_) {
+    throw std::invalid_argument("CableStatics: t_min is above t_max.");
+  }
+  for (int dof : dofs_) {
+    if (dof < 0 || dof >= 6) {
+      throw std::invalid_argument("CableStatics: dofs should be in [0, 6).");
+    }
+  }
+}
+
+/* ************************************************************************* */
+Matrix CableStatics::structureMatrix(const Pose3 &wTx) const {
+  Matrix W;
+  cables_.computeWrench(Vector::Zero(numCables()), wTx, &W);
+  return W;
+}
+
+/* ************************************************************************* */
+bool CableStatics::tensions(const Pose3 &wTx, Vector *tensions,
+                            const Vector6 &external) const {
+  const size_t n = numCables(), m = dofs_.size();
+  const Matrix W6 = structureMatrix(wTx);
+  const Vector6 load =
+      GravityWrench(params_.gravity, params_.mass, wTx) + external;
+
+  // Balanced rows: W * t = b.
+  Matrix W(m, n);
+  Vector b(m);
+  for (size_t i = 0; i < m; i++) {
+    W.row(i) = W6.row(dofs_[i]);
+    b(i) = -load(dofs_[i]);
+  }
+
+  // Closed-form method: closest to the mean tension, fixing violated cables.
+  const double t_mean = 0.5 * (t_min_ + t_max_);
+  *tensions = Vector::Constant(n, t_mean);
+  std::vector<bool> fixed(n, false);
+  std::vector<size_t> free;
+  for (size_t iteration = 0; iteration <= n; iteration++) {
+    free.clear();
+    Vector rhs = b;
+    for (size_t j = 0; j < n; j++) {
+      if (fixed[j]) {
+        rhs -= W.col(j) * (*tensions)(j);
+      } else {
+        free.push_back(j);
+      }
+    }
+    if (free.size() < m) return false;
+
+    Matrix W_free(m, free.size());
+    Vector t_free(free.size());
+    for (size_t i = 0; i < free.size(); i++) {
+      W_free.col(i) = W.col(free[i]);
+      t_free(i) = t_mean;
+    }
+    t_free += W_free.completeOrthogonalDecomposition().solve(
+        rhs - W_free * t_free);
+    if ((W_free * t_free - rhs).norm() > kTolerance * (1.0 + rhs.norm())) {
+      return false;  // the free cables cannot balance the load
+    }
+
+    // Fix the cable farthest out of bounds, if any.
+    size_t worst = n;
+    double worst_violation = 0.0;
+    for (size_t i = 0; i < free.size(); i++) {
+      const double t = t_free(i);
+      (*tensions)(free[i]) = t;
+      const double violation = std::max(t_min_ - t, t - t_max_);
+      if (violation > worst_violation) {
+        worst_violation = violation;
+        worst = free[i];
+      }
+    }
+    if (worst == n) return true;
+    fixed[worst] = true;
+    (*tensions)(worst) = std::clamp((*tensions)(worst), t_min_, t_max_);
+  }
+  return false;
+}
+
+/* ************************************************************************* */
+CableWorkspace CableStatics::workspace(
+    const std::vector<Pose3> &poses, const Vector6 &external,
+    const ExecutionContext &execution) const {
+  const size_t num_poses = poses.size();
+  CableWorkspace result;
+  result.tensions.resize(numCables(), num_poses);
+  result.feasible.resize(num_poses);
+
+  auto solveChunk = [&](size_t chunk) {
+    const size_t begin = chunk * kChunkSize;
+    const size_t end = std::min(begin + kChunkSize, num_poses);
+    Vector t;
+    for (size_t i = begin; i < end; i++) {
+      result.feasible(i) = tensions(poses[i], &t, external);
+      result.tensions.col(i) = t;
+    }
+  };
+  execution.parallelFor((num_poses + kChunkSize - 1) / kChunkSize, solveChunk);
+  return result;
+}
+
+}  // namespace gtdynamics
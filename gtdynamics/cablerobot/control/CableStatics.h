@@ -0,0 +1,90 @@
+/**
+ * @file  CableStatics.h
+ * @brief Static tension distributions of a cable robot, over many poses at
+ * once, for wrench-feasible workspace maps.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/control/CdprPlanar.h>
+#include <gtdynamics/cablerobot/factors/CableTensionsFactor.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Tension distributions of CableStatics::workspace, one column per pose.
+struct CableWorkspace {
+  gtsam::Matrix tensions;  ///< num_cables x P tensions
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> feasible;  ///< within the bounds
+
+  /// Number of wrench-feasible poses.
+  size_t numFeasible() const { return feasible.count(); }
+};
+
+/**
+ * CableStatics solves for the cable tensions holding the end-effector still
+ * at a pose, within tension bounds. The wrench of the cables is linear in the
+ * tensions, so at each pose the structure matrix W, the Jacobian of
+ * CableTensionsFactor::computeWrench in the tensions, is evaluated once, and
+ * the static balance of StaticWrenchFactor
+ *
+ *   W * t + gravity wrench + external wrench = 0,   t_min <= t <= t_max
+ *
+ * is a small linear problem, solved with the closed-form method of Pott: the
+ * tensions closest to the mean of the bounds are computed with the
+ * pseudo-inverse of W, and cables out of bounds are fixed at their bound one
+ * at a time until all tensions are feasible, or too few cables are left.
+ * Only the rows of the wrench in `dofs` are balanced, e.g. {1, 3, 5} for a
+ * planar robot in the xz plane. Chunks of poses of a workspace are solved in
+ * parallel.
+ */
+class CableStatics {
+ private:
+  CdprParams params_;
+  double t_min_, t_max_;
+  std::vector<int> dofs_;
+  CableTensionsFactor cables_;
+
+ public:
+  /**
+   * Constructor.
+   * @param params -- cable mounting points, mass and gravity of the robot
+   * @param t_min -- lower tension bound
+   * @param t_max -- upper tension bound
+   * @param dofs -- rows of the wrench [m; f] which are balanced
+   */
+  explicit CableStatics(const CdprParams &params, double t_min = 0.0,
+                        double t_max = 1e3,
+                        const std::vector<int> &dofs = {0, 1, 2, 3, 4, 5});
+
+  size_t numCables() const { return cables_.numCables(); }
+
+  /// Structure matrix: the 6 x num_cables wrench of unit tensions at wTx.
+  gtsam::Matrix structureMatrix(const gtsam::Pose3 &wTx) const;
+
+  /**
+   * Tensions balancing gravity and an external wrench at a pose.
+   * @param wTx -- end-effector pose
+   * @param tensions -- (output) the tensions, in bounds if feasible
+   * @param external -- external wrench on the end-effector, in its frame
+   * @return whether the pose is wrench-feasible
+   */
+  bool tensions(const gtsam::Pose3 &wTx, gtsam::Vector *tensions,
+                const gtsam::Vector6 &external = gtsam::Vector6::Zero()) const;
+
+  /// Tensions at many poses, e.g. a grid of the workspace, with chunks of
+  /// poses solved on the threads of the execution context.
+  CableWorkspace workspace(
+      const std::vector<gtsam::Pose3> &poses,
+      const gtsam::Vector6 &external = gtsam::Vector6::Zero(),
+      const ExecutionContext &execution = ExecutionContext::Default()) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,216 @@
+/**
+ * @file  CdprPlanar.cpp
+ * @brief Planar cable-driven parallel robot: assembles the factors of its
+ * kinematics, dynamics and collocation, as cdpr_planar.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CdprPlanar.h"
+
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/cablerobot/factors/PriorFactor.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+// Rows of the pose and twist which leave the xz plane.
+const Matrix kOutOfPlane =
+    (Matrix(3, 6) << 1, 0, 0, 0, 0, 0,  //
+     0, 0, 1, 0, 0, 0,                  //
+     0, 0, 0, 0, 1, 0)
+        .finished();
+}  // namespace
+
+/* ************************************************************************* */
+CdprPlanar::CdprPlanar(const CdprParams &params) : params_(params) {
+  auto ee = std::make_shared<Link>(1, "ee", params_.mass, params_.inertia,
+                                  Pose3(), Pose3());
+  robot_ = Robot(LinkMap{{"ee", ee}}, JointMap());
+
+  using noiseModel::Isotropic;
+  costmodel_l_ = Isotropic::Sigma(1, 0.001);
+  costmodel_ldot_ = Isotropic::Sigma(1, 0.001);
+  costmodel_wrench_ = Isotropic::Sigma(6, 0.001);
+  costmodel_torque_ = Isotropic::Sigma(6, 0.001);
+  costmodel_twistcollo_ = Isotropic::Sigma(6, 0.001);
+  costmodel_posecollo_ = Isotropic::Sigma(6, 0.001);
+  costmodel_prior_l_ = Isotropic::Sigma(1, 0.001);
+  costmodel_prior_ldot_ = Isotropic::Sigma(1, 0.001);
+  costmodel_prior_tau_ = Isotropic::Sigma(1, 0.001);
+  costmodel_prior_pose_ = Isotropic::Sigma(6, 0.001);
+  costmodel_prior_twist_ = Isotropic::Sigma(6, 0.001);
+  costmodel_prior_twistaccel_ = Isotropic::Sigma(6, 0.001);
+  costmodel_planar_pose_ = Isotropic::Sigma(3, 0.001);
+  costmodel_planar_twist_ = Isotropic::Sigma(3, 0.001);
+  costmodel_dt_ = Isotropic::Sigma(1, 0.001);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::allFactors(size_t N, double dt) const {
+  std::vector<int> ks(N);
+  for (size_t k = 0; k < N; k++) ks[k] = k;
+  NonlinearFactorGraph graph;
+  graph.push_back(kinematicsFactors(ks));
+  graph.push_back(dynamicsFactors(ks));
+  if (!ks.empty()) ks.pop_back();
+  graph.push_back(collocationFactors(ks, dt));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::kinematicsFactors(
+    const std::vector<int> &ks) const {
+  NonlinearFactorGraph graph;
+  const int ee = eeId();
+  for (int k : ks) {
+    for (size_t ji = 0; ji < numCables(); ji++) {
+      const Point3 a = params_.a_locs.row(ji).transpose(),
+                   b = params_.b_locs.row(ji).transpose();
+      graph.emplace_shared<CableLengthFactor>(
+          JointAngleKey(ji, k), PoseKey(ee, k), costmodel_l_, a, b);
+      graph.emplace_shared<CableVelocityFactor>(
+          JointVelKey(ji, k), PoseKey(ee, k), TwistKey(ee, k),
+          costmodel_ldot_, a, b);
+    }
+
+    // constrain out-of-plane movements
+    Values zeroT, zeroV;
+    InsertPose(&zeroT, ee, k, Pose3());
+    InsertTwist(&zeroV, ee, k, Vector6::Zero());
+    graph.emplace_shared<LinearContainerFactor>(
+        JacobianFactor(PoseKey(ee, k), kOutOfPlane, Vector3::Zero(),
+                       costmodel_planar_pose_),
+        zeroT);
+    graph.emplace_shared<LinearContainerFactor>(
+        JacobianFactor(TwistKey(ee, k), kOutOfPlane, Vector3::Zero(),
+                       costmodel_planar_twist_),
+        zeroV);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::dynamicsFactors(
+    const std::vector<int> &ks) const {
+  NonlinearFactorGraph graph;
+  const int ee = eeId();
+  for (int k : ks) {
+    std::vector<Key> wrench_keys;
+    for (size_t ji = 0; ji < numCables(); ji++) {
+      wrench_keys.push_back(WrenchKey(ee, ji, k));
+    }
+    graph.add(WrenchFactor(costmodel_wrench_, eeLink(), wrench_keys, k,
+                           params_.gravity));
+    for (size_t ji = 0; ji < numCables(); ji++) {
+      graph.emplace_shared<CableTensionFactor>(
+          TorqueKey(ji, k), PoseKey(ee, k), WrenchKey(ee, ji, k),
+          costmodel_torque_, params_.a_locs.row(ji).transpose(),
+          params_.b_locs.row(ji).transpose());
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::collocationFactors(const std::vector<int> &ks,
+                                                    double dt) const {
+  NonlinearFactorGraph graph;
+  const int ee = eeId();
+  for (int k : ks) {
+    graph.emplace_shared<EulerPoseCollocationFactor>(
+        PoseKey(ee, k), PoseKey(ee, k + 1), TwistKey(ee, k), kDtKey,
+        costmodel_posecollo_);
+    graph.emplace_shared<EulerTwistCollocationFactor>(
+        TwistKey(ee, k), TwistKey(ee, k + 1), TwistAccelKey(ee, k), kDtKey,
+        costmodel_twistcollo_);
+  }
+  graph.emplace_shared<PriorFactor<double>>(kDtKey, dt, costmodel_dt_);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::priorsFk(
+    const std::vector<int> &ks, const std::vector<Vector> &ls,
+    const std::vector<Vector> &ldots) const {
+  NonlinearFactorGraph graph;
+  for (size_t i = 0; i < ks.size() && i < ls.size() && i < ldots.size();
+       i++) {
+    for (int ji = 0; ji < ls[i].size() && ji < ldots[i].size(); ji++) {
+      graph.emplace_shared<PriorFactor<double>>(
+          JointAngleKey(ji, ks[i]), ls[i](ji), costmodel_prior_l_);
+      graph.emplace_shared<PriorFactor<double>>(
+          JointVelKey(ji, ks[i]), ldots[i](ji), costmodel_prior_ldot_);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::priorsIk(
+    const std::vector<int> &ks, const std::vector<Pose3> &Ts,
+    const std::vector<Vector6> &Vs) const {
+  NonlinearFactorGraph graph;
+  const int ee = eeId();
+  for (size_t i = 0; i < ks.size() && i < Ts.size() && i < Vs.size(); i++) {
+    graph.emplace_shared<PriorFactor<Pose3>>(PoseKey(ee, ks[i]), Ts[i],
+                                             costmodel_prior_pose_);
+    graph.emplace_shared<PriorFactor<Vector6>>(TwistKey(ee, ks[i]), Vs[i],
+                                               costmodel_prior_twist_);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::priorsId(
+    const std::vector<int> &ks, const std::vector<Vector> &torques) const {
+  NonlinearFactorGraph graph;
+  for (size_t i = 0; i < ks.size() && i < torques.size(); i++) {
+    for (int ji = 0; ji < torques[i].size(); ji++) {
+      graph.emplace_shared<PriorFactor<double>>(
+          TorqueKey(ji, ks[i]), torques[i](ji), costmodel_prior_tau_);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanar::priorsFd(
+    const std::vector<int> &ks, const std::vector<Vector6> &VAs) const {
+  NonlinearFactorGraph graph;
+  for (size_t i = 0; i < ks.size() && i < VAs.size(); i++) {
+    graph.emplace_shared<PriorFactor<Vector6>>(
+        TwistAccelKey(eeId(), ks[i]), VAs[i], costmodel_prior_twistaccel_);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values CdprPlanar::zeroValues(const std::vector<int> &ks, double dt) const {
+  Values zero;
+  const int ee = eeId();
+  zero.insert(kDtKey, dt);
+  for (int k : ks) {
+    for (size_t ji = 0; ji < numCables(); ji++) {
+      InsertJointAngle(&zero, ji, k, 0.0);
+      InsertJointVel(&zero, ji, k, 0.0);
+      InsertTorque(&zero, ji, k, 0.0);
+      InsertWrench(&zero, ee, ji, k, Vector6::Zero());
+    }
+    InsertPose(&zero, ee, k, Pose3(Rot3(), Point3(1.5, 0, 1.5)));
+    InsertTwist(&zero, ee, k, Vector6::Zero());
+    InsertTwistAccel(&zero, ee, k, Vector6::Zero());
+  }
+  return zero;
+}
+
+}  // namespace gtdynamics
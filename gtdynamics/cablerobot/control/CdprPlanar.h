@@ -0,0 +1,114 @@
+/**
+ * @file  CdprPlanar.h
+ * @brief Planar cable-driven parallel robot: assembles the factors of its
+ * kinematics, dynamics and collocation, as cdpr_planar.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Geometry and inertia of a cable robot, as CdprParams in cdpr_planar.py.
+struct CdprParams {
+  /// Cable mounting points on the frame, in world coordinates, one per row.
+  gtsam::Matrix a_locs = (gtsam::Matrix(4, 3) << 3, 0, 0,  //
+                          3, 0, 3,                         //
+                          0, 0, 3,                         //
+                          0, 0, 0)
+                             .finished();
+  /// Cable mounting points on the end-effector, in its frame, one per row.
+  gtsam::Matrix b_locs = (gtsam::Matrix(4, 3) << 0.15, 0, -0.15,  //
+                          0.15, 0, 0.15,                          //
+                          -0.15, 0, 0.15,                         //
+                          -0.15, 0, -0.15)
+                             .finished();
+  double mass = 1.0;
+  gtsam::Matrix3 inertia = gtsam::I_3x3;
+  gtsam::Vector3 gravity = gtsam::Vector3::Zero();
+};
+
+/**
+ * CdprPlanar is the C++ counterpart of the Cdpr class of cdpr_planar.py:
+ * the factor graphs it creates are the same, factor for factor. Time steps
+ * are given as lists of indices, and the time step duration is the variable
+ * with key kDtKey.
+ */
+class CdprPlanar {
+ public:
+  /// Key of the time step duration, as in cdpr_planar.py.
+  static constexpr gtsam::Key kDtKey = 0;
+
+ private:
+  CdprParams params_;
+  Robot robot_;
+  gtsam::SharedNoiseModel costmodel_l_, costmodel_ldot_, costmodel_wrench_,
+      costmodel_torque_, costmodel_twistcollo_, costmodel_posecollo_,
+      costmodel_prior_l_, costmodel_prior_ldot_, costmodel_prior_tau_,
+      costmodel_prior_pose_, costmodel_prior_twist_,
+      costmodel_prior_twistaccel_, costmodel_planar_pose_,
+      costmodel_planar_twist_, costmodel_dt_;
+
+ public:
+  explicit CdprPlanar(const CdprParams &params = CdprParams());
+
+  const CdprParams &params() const { return params_; }
+  const Robot &robot() const { return robot_; }
+
+  /// Link of the end-effector, and its id.
+  LinkSharedPtr eeLink() const { return robot_.link("ee"); }
+  int eeId() const { return eeLink()->id(); }
+
+  /// Number of cables, which are also the joints of the keys.
+  size_t numCables() const { return params_.a_locs.rows(); }
+
+  /// Kinematics, dynamics and collocation factors of N time steps.
+  gtsam::NonlinearFactorGraph allFactors(size_t N, double dt) const;
+
+  /// Cable length and velocity factors, and the planar constraints.
+  gtsam::NonlinearFactorGraph kinematicsFactors(
+      const std::vector<int> &ks) const;
+
+  /// Wrench balance, and the wrenches of the cable tensions.
+  gtsam::NonlinearFactorGraph dynamicsFactors(const std::vector<int> &ks) const;
+
+  /// Euler collocation from each step to the next, and the prior on dt.
+  gtsam::NonlinearFactorGraph collocationFactors(const std::vector<int> &ks,
+                                                 double dt) const;
+
+  /// Priors on the cable lengths and velocities, for forward kinematics.
+  gtsam::NonlinearFactorGraph priorsFk(
+      const std::vector<int> &ks, const std::vector<gtsam::Vector> &ls,
+      const std::vector<gtsam::Vector> &ldots) const;
+
+  /// Priors on the end-effector pose and twist, for inverse kinematics.
+  gtsam::NonlinearFactorGraph priorsIk(
+      const std::vector<int> &ks, const std::vector<gtsam::Pose3> &Ts,
+      const std::vector<gtsam::Vector6> &Vs) const;
+
+  /// Priors on the cable tensions, to solve for the twist accelerations.
+  gtsam::NonlinearFactorGraph priorsId(
+      const std::vector<int> &ks,
+      const std::vector<gtsam::Vector> &torques) const;
+
+  /// Priors on the twist accelerations, to solve for the cable tensions.
+  gtsam::NonlinearFactorGraph priorsFd(
+      const std::vector<int> &ks,
+      const std::vector<gtsam::Vector6> &VAs) const;
+
+  /// Initial values with zeros, as zerovalues in utils.py.
+  gtsam::Values zeroValues(const std::vector<int> &ks, double dt) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,94 @@
+/**
+ * @file  CdprPlanarController.cpp
+ * @brief Optimal controller for a cable robot, solved by creating a factor
+ * graph of the dynamics with state objectives and control costs, as
+ * cdpr_planar_controller.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CdprPlanarController.h"
+
+#include <gtdynamics/cablerobot/factors/PriorFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CdprPlanarController::CdprPlanarController(const CdprPlanar &cdpr,
+                                           const Values &x0,
+                                           const std::vector<Pose3> &pdes,
+                                           double dt,
+                                           const std::optional<Vector> &Q,
+                                           const Vector &R)
+    : cdpr_(cdpr), pdes_(pdes), dt_(dt) {
+  graph_ = CreateIlqrGraph(cdpr_, x0, pdes_, dt_, Q, R);
+
+  // The ordering LM would compute, kept for replanning.
+  ordering_ = Ordering::Colamd(graph_);
+  params_.setOrdering(ordering_);
+
+  std::vector<int> ks(pdes_.size());
+  for (size_t k = 0; k < ks.size(); k++) ks[k] = k;
+  result_ = LevenbergMarquardtOptimizer(graph_, cdpr_.zeroValues(ks, dt_),
+                                        params_)
+                .optimize();
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CdprPlanarController::CreateIlqrGraph(
+    const CdprPlanar &cdpr, const Values &x0, const std::vector<Pose3> &pdes,
+    double dt, const std::optional<Vector> &Q, const Vector &R) {
+  const size_t N = pdes.size();
+  const int ee = cdpr.eeId();
+
+  // initial conditions
+  NonlinearFactorGraph graph =
+      cdpr.priorsIk({0}, {Pose(x0, ee, 0)}, {Twist(x0, ee, 0)});
+  // dynamics
+  graph.push_back(cdpr.allFactors(N, dt));
+  // control costs
+  const auto cost_u = noiseModel::Diagonal::Precisions(R);
+  for (size_t k = 0; k < N; k++) {
+    for (size_t ji = 0; ji < cdpr.numCables(); ji++) {
+      graph.emplace_shared<PriorFactor<double>>(TorqueKey(ji, k), 0.0,
+                                                cost_u);
+    }
+  }
+  // state objective costs
+  const SharedNoiseModel cost_x =
+      Q ? SharedNoiseModel(noiseModel::Diagonal::Precisions(*Q))
+        : SharedNoiseModel(noiseModel::Isotropic::Sigma(6, 0.001));
+  for (size_t k = 0; k < N; k++) {
+    graph.emplace_shared<gtsam::PriorFactor<Pose3>>(PoseKey(ee, k), pdes[k],
+                                                    cost_x);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Vector CdprPlanarController::torques(int k) const {
+  Vector u(cdpr_.numCables());
+  for (size_t ji = 0; ji < cdpr_.numCables(); ji++) {
+    u(ji) = Torque(result_, ji, k);
+  }
+  return u;
+}
+
+/* ************************************************************************* */
+const Values &CdprPlanarController::replan(const Values &x0) {
+  // The first two factors are the priors on the initial state.
+  const int ee = cdpr_.eeId();
+  const NonlinearFactorGraph priors =
+      cdpr_.priorsIk({0}, {Pose(x0, ee, 0)}, {Twist(x0, ee, 0)});
+  graph_.replace(0, priors.at(0));
+  graph_.replace(1, priors.at(1));
+
+  result_ = LevenbergMarquardtOptimizer(graph_, result_, params_).optimize();
+  return result_;
+}
+
+}  // namespace gtdynamics
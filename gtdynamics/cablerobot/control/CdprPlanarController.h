@@ -0,0 +1,94 @@
+/**
+ * @file  CdprPlanarController.h
+ * @brief Optimal controller for a cable robot, solved by creating a factor
+ * graph of the dynamics with state objectives and control costs, as
+ * cdpr_planar_controller.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/control/CdprPlanar.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Interface of cable robot controllers, as CdprControllerBase in Python.
+class CdprControllerBase {
+ public:
+  virtual ~CdprControllerBase() {}
+
+  /**
+   * Cable tensions of time step k.
+   * @param values  current state, with at least the Pose and Twist at k
+   * @param k       current time step
+   */
+  virtual gtsam::Vector tensions(const gtsam::Values &values, int k) = 0;
+};
+
+/**
+ * CdprPlanarController precomputes the open-loop trajectory which tracks
+ * the desired poses, by optimizing the iLQR graph of create_ilqr_fg, and
+ * then returns it on each update.
+ *
+ * The elimination ordering of the graph is computed once, and kept for
+ * replan(), which re-solves from a new initial state warm-started from the
+ * last trajectory, without rebuilding the graph.
+ */
+class CdprPlanarController : public CdprControllerBase {
+ private:
+  CdprPlanar cdpr_;
+  std::vector<gtsam::Pose3> pdes_;
+  double dt_;
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::Ordering ordering_;
+  gtsam::LevenbergMarquardtParams params_;
+  gtsam::Values result_;
+
+ public:
+  /**
+   * Constructor, which builds and solves the iLQR graph.
+   * @param cdpr  cable robot
+   * @param x0    initial Pose and Twist, at time step 0
+   * @param pdes  desired poses, one per time step
+   * @param dt    time step duration
+   * @param Q     state objective precisions, or none for a tight prior
+   * @param R     control cost precision, as a 1-vector
+   */
+  CdprPlanarController(const CdprPlanar &cdpr, const gtsam::Values &x0,
+                       const std::vector<gtsam::Pose3> &pdes, double dt = 0.01,
+                       const std::optional<gtsam::Vector> &Q = {},
+                       const gtsam::Vector &R = gtsam::Vector1(1.0));
+
+  /// The iLQR graph of create_ilqr_fg in cdpr_planar_controller.py.
+  static gtsam::NonlinearFactorGraph CreateIlqrGraph(
+      const CdprPlanar &cdpr, const gtsam::Values &x0,
+      const std::vector<gtsam::Pose3> &pdes, double dt,
+      const std::optional<gtsam::Vector> &Q, const gtsam::Vector &R);
+
+  /// Control for time step k: the whole optimal open-loop trajectory.
+  const gtsam::Values &update(const gtsam::Values &values, int k) const {
+    return result_;
+  }
+
+  /// Cable tensions of time step k of the trajectory.
+  gtsam::Vector torques(int k) const;
+
+  /// Cable tensions of time step k of the trajectory.
+  gtsam::Vector tensions(const gtsam::Values &values, int k) override {
+    return torques(k);
+  }
+
+  /// Re-solve the trajectory from a new initial Pose and Twist.
+  const gtsam::Values &replan(const gtsam::Values &x0);
+
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+  const gtsam::Values &result() const { return result_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,117 @@
+/**
+ * @file  CdprPlanarFixedLagController.cpp
+ * @brief Receding horizon iLQR controller for a cable robot, which re-plans a
+ * fixed-lag window of the trajectory on every time step.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CdprPlanarFixedLagController.h"
+
+#include <gtdynamics/utils/KeyEncoding.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CdprPlanarFixedLagController::CdprPlanarFixedLagController(
+    const CdprPlanar &cdpr, const std::vector<Pose3> &pdes, size_t horizon,
+    double dt, size_t iterations, const std::optional<Vector> &Q,
+    const Vector &R)
+    : cdpr_(cdpr),
+      pdes_(pdes),
+      horizon_(horizon),
+      dt_(dt),
+      iterations_(iterations) {
+  if (horizon_ == 0 || pdes_.empty()) {
+    throw std::invalid_argument(
+        "CdprPlanarFixedLagController: needs a horizon and desired poses.");
+  }
+
+  // Placeholder state and objectives, replaced on each update.
+  Values x0;
+  InsertPose(&x0, cdpr_.eeId(), 0, pdes_.front());
+  InsertTwist(&x0, cdpr_.eeId(), 0, Vector6::Zero());
+  graph_ = CdprPlanarController::CreateIlqrGraph(
+      cdpr_, x0, std::vector<Pose3>(horizon_, pdes_.front()), dt_, Q, R);
+  ordering_ = Ordering::Colamd(graph_);
+
+  std::vector<int> ks(horizon_);
+  for (size_t k = 0; k < horizon_; k++) ks[k] = k;
+  window_ = cdpr_.zeroValues(ks, dt_);
+}
+
+/* ************************************************************************* */
+void CdprPlanarFixedLagController::setObjectives(const Values &values,
+                                                 int k) {
+  // The first two factors are the priors on the initial state, and the last
+  // horizon ones the state objectives, as in CreateIlqrGraph.
+  const int ee = cdpr_.eeId();
+  const NonlinearFactorGraph priors =
+      cdpr_.priorsIk({0}, {Pose(values, ee, k)}, {Twist(values, ee, k)});
+  graph_.replace(0, priors.at(0));
+  graph_.replace(1, priors.at(1));
+
+  const size_t first = graph_.size() - horizon_;
+  for (size_t i = 0; i < horizon_; i++) {
+    auto objective = std::static_pointer_cast<gtsam::PriorFactor<Pose3>>(
+        graph_.at(first + i));
+    const size_t t = std::min<size_t>(k + i, pdes_.size() - 1);
+    graph_.replace(first + i, std::make_shared<gtsam::PriorFactor<Pose3>>(
+                                  objective->key(), pdes_[t],
+                                  objective->noiseModel()));
+  }
+}
+
+/* ************************************************************************* */
+void CdprPlanarFixedLagController::shiftWindow() {
+  // Step k of the new window starts from step k+1 of the last one, and the
+  // last step is repeated.
+  Values shifted;
+  for (Key key : window_.keys()) {
+    if (key == CdprPlanar::kDtKey) {
+      shifted.insert(key, window_.at(key));
+      continue;
+    }
+    const size_t t = DynamicsKeyEncoding::Time(key);
+    const Key next = DynamicsKeyEncoding::WithTime(key, t + 1);
+    shifted.insert(key, window_.exists(next) ? window_.at(next)
+                                               : window_.at(key));
+  }
+  window_ = shifted;
+}
+
+/* ************************************************************************* */
+Vector CdprPlanarFixedLagController::tensions(const Values &values, int k) {
+  setObjectives(values, k);
+
+  if (!solved_) {
+    // Cold start: solve to convergence, as CdprPlanarController does.
+    LevenbergMarquardtParams params;
+    params.setOrdering(ordering_);
+    window_ = LevenbergMarquardtOptimizer(graph_, window_, params).optimize();
+    solved_ = true;
+  } else {
+    shiftWindow();
+    for (size_t i = 0; i < iterations_; i++) {
+      const VectorValues delta = graph_.linearize(window_)->optimize(ordering_);
+      window_ = window_.retract(delta);
+    }
+  }
+
+  Vector u(cdpr_.numCables());
+  for (size_t ji = 0; ji < cdpr_.numCables(); ji++) {
+    u(ji) = Torque(window_, ji, 0);
+  }
+  return u;
+}
+
+}  // namespace gtdynamics
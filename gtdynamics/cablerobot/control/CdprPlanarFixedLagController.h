@@ -0,0 +1,79 @@
+/**
+ * @file  CdprPlanarFixedLagController.h
+ * @brief Receding horizon iLQR controller for a cable robot, which re-plans a
+ * fixed-lag window of the trajectory on every time step.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/control/CdprPlanarController.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CdprPlanarFixedLagController re-plans the iLQR graph of a window of
+ * `horizon` steps on every update, from the current state toward the next
+ * desired poses, and returns the tensions of the first step of the window.
+ *
+ * The window graph is built once, with the keys of steps 0 to horizon-1,
+ * and so are its linearization points and its elimination ordering: since
+ * only the priors on the state and the desired poses change between
+ * updates, the Bayes net of every re-plan has the same structure. After the
+ * first solve, each update shifts the last window by one step to warm-start
+ * the next, and runs a fixed number of Gauss-Newton iterations, which bounds
+ * the time of each re-plan.
+ */
+class CdprPlanarFixedLagController : public CdprControllerBase {
+ private:
+  CdprPlanar cdpr_;
+  std::vector<gtsam::Pose3> pdes_;
+  size_t horizon_;
+  double dt_;
+  size_t iterations_;
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::Ordering ordering_;
+  gtsam::Values window_;
+  bool solved_ = false;
+
+ public:
+  /**
+   * Constructor, which builds the window graph and its ordering.
+   * @param cdpr        cable robot
+   * @param pdes        desired poses, one per time step
+   * @param horizon     number of time steps of the window
+   * @param dt          time step duration
+   * @param iterations  Gauss-Newton iterations of each warm-started re-plan
+   * @param Q           state objective precisions, or none for a tight prior
+   * @param R           control cost precision, as a 1-vector
+   */
+  CdprPlanarFixedLagController(const CdprPlanar &cdpr,
+                               const std::vector<gtsam::Pose3> &pdes,
+                               size_t horizon, double dt = 0.01,
+                               size_t iterations = 1,
+                               const std::optional<gtsam::Vector> &Q = {},
+                               const gtsam::Vector &R = gtsam::Vector1(1.0));
+
+  /// Re-plan the window from the state at time step k, and return its
+  /// first tensions.
+  gtsam::Vector tensions(const gtsam::Values &values, int k) override;
+
+  /// Window graph, with the priors and objectives of the last update.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// Trajectory of the last window, with the keys of steps 0 to horizon-1.
+  const gtsam::Values &window() const { return window_; }
+
+  size_t horizon() const { return horizon_; }
+
+ private:
+  void setObjectives(const gtsam::Values &values, int k);
+  void shiftWindow();
+};
+
+}  // namespace gtdynamics
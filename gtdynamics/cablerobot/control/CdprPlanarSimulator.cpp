@@ -0,0 +1,171 @@
+/**
+ * @file  CdprPlanarSimulator.cpp
+ * @brief Simulation for a planar cable robot, which runs the dynamics forward
+ * in time, as cdpr_planar_sim.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CdprPlanarSimulator.h"
+
+#include <gtdynamics/utils/KeyEncoding.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+/// Largest error of a converged step, as asserted in cdpr_planar_sim.py.
+constexpr double kErrorThreshold = 1e-20;
+
+/// Key of a step 0 variable at time step k; dt has no time step.
+Key AtStep(Key key, int k) {
+  if (key == CdprPlanar::kDtKey) return key;
+  return DynamicsKeyEncoding::WithTime(key,
+                                       DynamicsKeyEncoding::Time(key) + k);
+}
+
+/// Solve a step graph, throwing if it does not converge.
+Values Solve(const NonlinearFactorGraph &graph, const Values &init,
+             const LevenbergMarquardtParams &params, const std::string &name) {
+  const Values result = LevenbergMarquardtOptimizer(graph, init, params)
+                            .optimize();
+  if (std::abs(graph.error(result)) >= kErrorThreshold) {
+    throw std::runtime_error("CdprPlanarSimulator: " + name +
+                             " didn't converge.");
+  }
+  return result;
+}
+}  // namespace
+
+/* ************************************************************************* */
+CdprPlanarSimulator::CdprPlanarSimulator(
+    const CdprPlanar &cdpr, const Values &x0,
+    const std::shared_ptr<CdprControllerBase> &controller, double dt)
+    : cdpr_(cdpr), x0_(x0), controller_(controller), dt_(dt) {
+  buildGraphs();
+  reset();
+}
+
+/* ************************************************************************* */
+CdprPlanarSimulator::CdprPlanarSimulator(const CdprPlanar &cdpr,
+                                         const Values &x0, double dt)
+    : cdpr_(cdpr), x0_(x0), dt_(dt) {
+  buildGraphs();
+  reset();
+}
+
+/* ************************************************************************* */
+void CdprPlanarSimulator::buildGraphs() {
+  ik_graph_ = cdpr_.kinematicsFactors({0});
+  id_graph_ = cdpr_.dynamicsFactors({0});
+  id_graph_.push_back(cdpr_.collocationFactors({0}, dt_));
+
+  // The priors of each step have the same keys, so the orderings of the
+  // step graphs are computed once, with placeholder priors.
+  const std::vector<Vector> zero_torques{Vector::Zero(cdpr_.numCables())};
+  const NonlinearFactorGraph state_priors =
+      cdpr_.priorsIk({0}, {Pose3()}, {Vector6::Zero()});
+  NonlinearFactorGraph ik = ik_graph_, id = id_graph_;
+  ik.push_back(state_priors);
+  id.push_back(state_priors);
+  id.push_back(cdpr_.priorsId({0}, zero_torques));
+  ik_params_.setOrdering(Ordering::Colamd(ik));
+  id_params_.setOrdering(Ordering::Colamd(id));
+}
+
+/* ************************************************************************* */
+void CdprPlanarSimulator::reset() {
+  x_ = x0_;
+  k_ = 0;
+}
+
+/* ************************************************************************* */
+void CdprPlanarSimulator::updateKinematics() {
+  const int ee = cdpr_.eeId();
+  NonlinearFactorGraph graph = ik_graph_;
+  graph.push_back(
+      cdpr_.priorsIk({0}, {Pose(x_, ee, k_)}, {Twist(x_, ee, k_)}));
+
+  // IK initial estimate
+  Values init;
+  InsertPose(&init, ee, 0, Pose(x_, ee, k_));
+  InsertTwist(&init, ee, 0, Twist(x_, ee, k_));
+  for (size_t ji = 0; ji < cdpr_.numCables(); ji++) {
+    InsertJointAngle(&init, ji, 0, 0.0);
+    InsertJointVel(&init, ji, 0, 0.0);
+  }
+
+  const Values result = Solve(graph, init, ik_params_, "inverse kinematics");
+  for (Key key : result.keys()) {
+    x_.insert_or_assign(AtStep(key, k_), result.at(key));
+  }
+}
+
+/* ************************************************************************* */
+void CdprPlanarSimulator::updateDynamics(const Vector &torques) {
+  const int ee = cdpr_.eeId();
+  NonlinearFactorGraph graph = id_graph_;
+  graph.push_back(
+      cdpr_.priorsIk({0}, {Pose(x_, ee, k_)}, {Twist(x_, ee, k_)}));
+  graph.push_back(cdpr_.priorsId({0}, {torques}));
+
+  // ID initial guess
+  Values init;
+  init.insert(CdprPlanar::kDtKey, dt_);
+  InsertPose(&init, ee, 0, Pose(x_, ee, k_));
+  InsertTwist(&init, ee, 0, Twist(x_, ee, k_));
+  for (size_t ji = 0; ji < cdpr_.numCables(); ji++) {
+    InsertTorque(&init, ji, 0, torques(ji));
+    InsertWrench(&init, ee, ji, 0, Vector6::Zero());
+  }
+  InsertPose(&init, ee, 1, Pose3(Rot3(), Point3(1.5, 0, 1.5)));
+  InsertTwist(&init, ee, 1, Vector6::Zero());
+  InsertTwistAccel(&init, ee, 0, Vector6::Zero());
+
+  const Values result = Solve(graph, init, id_params_, "dynamics simulation");
+  for (Key key : result.keys()) {
+    x_.insert_or_assign(AtStep(key, k_), result.at(key));
+  }
+}
+
+/* ************************************************************************* */
+const Values &CdprPlanarSimulator::step(const Vector &torques) {
+  if (static_cast<size_t>(torques.size()) != cdpr_.numCables()) {
+    throw std::invalid_argument(
+        "CdprPlanarSimulator: needs one tension per cable.");
+  }
+  updateKinematics();
+  if (k_ == 0) x_.insert_or_assign(CdprPlanar::kDtKey, dt_);
+  updateDynamics(torques);
+  k_++;
+  return x_;
+}
+
+/* ************************************************************************* */
+const Values &CdprPlanarSimulator::step() {
+  if (!controller_) {
+    throw std::logic_error(
+        "CdprPlanarSimulator: step() needs a controller, or the tensions.");
+  }
+  // The controller sees the cable lengths and velocities of this step.
+  updateKinematics();
+  if (k_ == 0) x_.insert_or_assign(CdprPlanar::kDtKey, dt_);
+  updateDynamics(controller_->tensions(x_, k_));
+  k_++;
+  return x_;
+}
+
+/* ************************************************************************* */
+const Values &CdprPlanarSimulator::run(size_t N) {
+  for (size_t k = 0; k < N; k++) step();
+  return x_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,83 @@
+/**
+ * @file  CdprPlanarSimulator.h
+ * @brief Simulation for a planar cable robot, which runs the dynamics forward
+ * in time, as cdpr_planar_sim.py does.
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/control/CdprPlanarController.h>
+
+#include <memory>
+
+namespace gtdynamics {
+
+/**
+ * CdprPlanarSimulator simulates a cable robot forward in time:
+ *
+ *   Pose/Twist  ->  l/ldot  ->  torques  ->  Wrenches/TwistAccel  ->  next
+ *               IK       Controller       ID                   Collocation
+ *
+ * cdpr_planar_sim.py adds the factors of each step to one growing graph and
+ * solves all of it on every step. Since later steps do not change earlier
+ * ones, this class solves only the graphs of the current step, which are
+ * built once with the keys of step 0, with a fixed elimination ordering.
+ * Their solutions get the keys of the current step in values().
+ */
+class CdprPlanarSimulator {
+ private:
+  CdprPlanar cdpr_;
+  gtsam::Values x0_;
+  std::shared_ptr<CdprControllerBase> controller_;
+  double dt_;
+
+  // Graphs of one step, without priors, with the keys of step 0.
+  gtsam::NonlinearFactorGraph ik_graph_, id_graph_;
+  gtsam::LevenbergMarquardtParams ik_params_, id_params_;
+
+  gtsam::Values x_;
+  int k_ = 0;
+
+ public:
+  /**
+   * Constructor.
+   * @param cdpr        cable robot
+   * @param x0          initial state, with the Pose and Twist at step 0
+   * @param controller  controller which gives the tensions of each step
+   * @param dt          time step duration
+   */
+  CdprPlanarSimulator(const CdprPlanar &cdpr, const gtsam::Values &x0,
+                      const std::shared_ptr<CdprControllerBase> &controller,
+                      double dt = 0.01);
+
+  /// Constructor without controller, for step() with given tensions.
+  CdprPlanarSimulator(const CdprPlanar &cdpr, const gtsam::Values &x0,
+                      double dt = 0.01);
+
+  /// Simulate one step, with the tensions of the controller.
+  const gtsam::Values &step();
+
+  /// Simulate one step with the given cable tensions.
+  const gtsam::Values &step(const gtsam::Vector &torques);
+
+  /// Simulate N steps, with the tensions of the controller.
+  const gtsam::Values &run(size_t N = 100);
+
+  /// Restart from the initial state.
+  void reset();
+
+  /// Current time step.
+  int k() const { return k_; }
+
+  /// All variables of the simulated steps, and the next Pose and Twist.
+  const gtsam::Values &values() const { return x_; }
+
+ private:
+  void buildGraphs();
+  void updateKinematics();
+  void updateDynamics(const gtsam::Vector &torques);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,98 @@
+/**
+ * @file  CableTensionsFactor.cpp
+ * @brief Cable tensions factor: relates the tensions of all cables, the end
+ * effector pose, and the net wrench of the cables on the end effector
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include "CableTensionsFactor.h"
+
+#include <gtsam/nonlinear/Values.h>
+
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+/******************************************************************************/
+CableTensionsFactor::CableTensionsFactor(
+    const std::vector<Key> &tension_keys, Key xPose_key, Key wrench_key,
+    const noiseModel::Base::shared_ptr &cost_model, const Matrix &wPa,
+    const Matrix &xPb)
+    : Base(cost_model, Keys(tension_keys, xPose_key, wrench_key)),
+      wPa_(wPa),
+      xPb_(xPb) {
+  if (wPa.cols() != 3 || xPb.cols() != 3 || wPa.rows() != xPb.rows() ||
+      static_cast<size_t>(wPa.rows()) != tension_keys.size()) {
+    throw std::invalid_argument(
+        "CableTensionsFactor: needs one row of mounting points per cable.");
+  }
+}
+
+/******************************************************************************/
+Vector6 CableTensionsFactor::computeWrench(const Vector &tensions,
+                                           const Pose3 &wTx, Matrix *H_tensions,
+                                           Matrix *H_wTx) const {
+  // Shared by all cables: the rotation and translation of the end effector.
+  const Matrix3 wRx = wTx.rotation().matrix();
+  const Matrix3 xRw = wRx.transpose();
+  const Point3 &wtx = wTx.translation();
+
+  if (H_tensions) H_tensions->resize(6, numCables());
+  if (H_wTx) H_wTx->setZero(6, 6);
+
+  Vector6 F = Vector6::Zero();
+  Matrix63 H_xf;  // [xm; xf] in xf
+  H_xf.bottomRows<3>() = I_3x3;
+  for (size_t j = 0; j < numCables(); j++) {
+    const Point3 xPb = xPb_.row(j).transpose();
+    const Point3 wPa = wPa_.row(j).transpose();
+
+    // cable direction
+    const Point3 wPb = wRx * xPb + wtx;
+    const Vector3 d = wPb - wPa;
+    const double length = d.norm();
+    const Vector3 dir = d / length;
+    // force->wrench, as in CableTensionFactor
+    const Vector3 xf = -tensions(j) * (xRw * dir);
+    F.head<3>() += xPb.cross(xf);
+    F.tail<3>() += xf;
+
+    if (H_tensions || H_wTx) H_xf.topRows<3>() = skewSymmetric(xPb);
+    if (H_tensions) H_tensions->col(j) = -H_xf * (xRw * dir);
+    if (H_wTx) {
+      const Matrix33 dir_H_wPb = (I_3x3 - dir * dir.transpose()) / length;
+      Matrix36 wPb_H_wTx;
+      wPb_H_wTx << -wRx * skewSymmetric(xPb), wRx;
+      Matrix36 xf_H_wTx = -tensions(j) * xRw * dir_H_wPb * wPb_H_wTx;
+      xf_H_wTx.leftCols<3>() += skewSymmetric(xf);
+      *H_wTx += H_xf * xf_H_wTx;
+    }
+  }
+  return F;
+}
+
+/******************************************************************************/
+Vector CableTensionsFactor::unwhitenedError(const Values &x,
+                                            OptionalMatrixVecType H) const {
+  const size_t n = numCables();
+  Vector tensions(n);
+  for (size_t j = 0; j < n; j++) tensions(j) = x.at<double>(keys_[j]);
+  const Pose3 wTx = x.at<Pose3>(keys_[n]);
+  const Vector6 Fx = x.at<Vector6>(keys_[n + 1]);
+
+  Matrix H_tensions, H_wTx;
+  const Vector6 error = Fx - computeWrench(tensions, wTx,
+                                           H ? &H_tensions : nullptr,
+                                           H ? &H_wTx : nullptr);
+  if (H) {
+    for (size_t j = 0; j < n; j++) (*H)[j] = -H_tensions.col(j);
+    (*H)[n] = -H_wTx;
+    (*H)[n + 1] = I_6x6;
+  }
+  return error;
+}
+
+}  // namespace gtdynamics
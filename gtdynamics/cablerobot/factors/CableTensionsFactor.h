@@ -0,0 +1,115 @@
+/**
+ * @file  CableTensionsFactor.h
+ * @brief Cable tensions factor: relates the tensions of all cables, the end
+ * effector pose, and the net wrench of the cables on the end effector
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/** CableTensionsFactor is an n+2-way nonlinear factor which enforces relation
+ * amongst the tensions of n cables, the end effector pose, and the sum of
+ * the wrenches felt by the end effector. It replaces n CableTensionFactors and
+ * their wrench variables, so that the end effector WrenchFactor takes only
+ * the net wrench, and the pose terms shared by the cables (the rotation and
+ * its transpose) are evaluated once per linearization.
+ */
+class CableTensionsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using Pose3 = gtsam::Pose3;
+  using Vector6 = gtsam::Vector6;
+  using This = CableTensionsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix wPa_, xPb_;
+
+  static gtsam::KeyVector Keys(const std::vector<gtsam::Key> &tension_keys,
+                               gtsam::Key xPose_key, gtsam::Key wrench_key) {
+    gtsam::KeyVector keys(tension_keys.begin(), tension_keys.end());
+    keys.push_back(xPose_key);
+    keys.push_back(wrench_key);
+    return keys;
+  }
+
+ public:
+  /** Cable tensions factor
+   * @param tension_keys -- keys for the cable tensions (scalars)
+   * @param xPose_key -- key for end effector pose
+   * @param wrench_key -- key for the net wrench of the cables acting on the
+   * end-effector (in the end effector's reference frame)
+   * @param cost_model -- noise model (6 dimensional)
+   * @param wPa -- cable mounting locations on the fixed frame, in world
+   * coords, one row per cable
+   * @param xPb -- cable mounting locations on the end effector, in the
+   * end-effector frame, one row per cable
+   */
+  CableTensionsFactor(const std::vector<gtsam::Key> &tension_keys,
+                      gtsam::Key xPose_key, gtsam::Key wrench_key,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const gtsam::Matrix &wPa, const gtsam::Matrix &xPb);
+  virtual ~CableTensionsFactor() {}
+
+  /// Number of cables.
+  size_t numCables() const { return static_cast<size_t>(wPa_.rows()); }
+
+  /** Computes the net wrench acting on the end-effector due to the cable
+   * tensions at some pose.
+   * @param tensions the tensions on the cables
+   * @param wTx the pose of the end effector
+   * @param H_tensions (optional) 6 x n Jacobian in the tensions
+   * @param H_wTx (optional) 6 x 6 Jacobian in the pose
+   * @return Vector6: calculated wrench
+   */
+  Vector6 computeWrench(const gtsam::Vector &tensions, const Pose3 &wTx,
+                        gtsam::Matrix *H_tensions = nullptr,
+                        gtsam::Matrix *H_wTx = nullptr) const;
+
+  /** Cable tensions error: the net wrench minus the calculated one.
+   * @param x values with the tensions, the end effector pose (in the world
+   * frame), and the net wrench (in the end effector frame)
+   * @return Vector(6): Fx minus calculated wrench
+   */
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override;
+
+  // @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /** print contents */
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 GTDKeyFormatter) const override {
+    std::cout << s << "cable tensions factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+#endif
+};
+
+}  // namespace gtdynamics
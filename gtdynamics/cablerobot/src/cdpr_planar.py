@@ -56,6 +56,20 @@ class Cdpr:
             3, 0.001)
         self.costmodel_dt = gtsam.noiseModel.Isotropic.Sigma(1, 0.001)
 
+    def native(self):
+        """The C++ cable robot with the same parameters, which builds the same factors.
+
+        Returns:
+            gtd.CdprPlanar: The C++ cable robot
+        """
+        params = gtd.CdprParams()
+        params.a_locs = self.params.a_locs
+        params.b_locs = self.params.b_locs
+        params.mass = self.params.mass
+        params.inertia = self.params.inertia
+        params.gravity = self.params.gravity.flatten()
+        return gtd.CdprPlanar(params)
+
     def eelink(self):
         """Link object for the end-effector
 
@@ -114,3 +114,48 @@ class CdprController(CdprControllerBase):
                 gtsam.PriorFactorPose3(gtd.PoseKey(cdpr.ee_id(), k), pdes[k],
                                        cost_x))
         return fg
+
+
+class CdprNativeController(CdprControllerBase):
+    """Same as CdprController, but the iLQR graph is built and solved in C++.
+    """
+    def __init__(self, cdpr, x0, pdes=[], dt=0.01, Q=None, R=np.array([1.])):
+        """constructor, with the arguments of CdprController
+        """
+        self.cdpr = cdpr
+        self.pdes = pdes
+        self.dt = dt
+        self.controller = gtd.CdprPlanarController(cdpr.native(), x0, pdes, dt,
+                                                   Q, R)
+        self.result = self.controller.result()
+        self.fg = self.controller.graph()
+
+    def update(self, values, t):
+        """New control: returns the entire results vector, as CdprController does.
+        """
+        return self.result
+
+
+class CdprFixedLagController(CdprControllerBase):
+    """Receding horizon iLQR controller, which re-plans a window of `horizon` steps in C++ on
+    every update, reusing the graph and elimination ordering of the window.
+    """
+    def __init__(self, cdpr, pdes=[], horizon=10, dt=0.01, iterations=1, Q=None,
+                 R=np.array([1.])):
+        """constructor, with the arguments of CdprController, except that the initial state is
+        given on each update
+        """
+        self.cdpr = cdpr
+        self.pdes = pdes
+        self.dt = dt
+        self.controller = gtd.CdprPlanarFixedLagController(cdpr.native(), pdes, horizon, dt,
+                                                           iterations, Q, R)
+
+    def update(self, values, t):
+        """New control: the cable tensions of time step t, re-planned from the state at t.
+        """
+        tensions = self.controller.tensions(values, t)
+        result = gtsam.Values()
+        for ji, tension in enumerate(tensions):
+            gtd.InsertTorque(result, ji, t, tension)
+        return result
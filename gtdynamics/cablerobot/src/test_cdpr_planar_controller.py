@@ -17,7 +17,7 @@ import gtsam
 from gtsam import Pose3, Rot3
 import numpy as np
 from cdpr_planar import Cdpr
-from cdpr_planar_controller import CdprController
+from cdpr_planar_controller import CdprController, CdprNativeController
 from cdpr_planar_sim import CdprSimulator
 from gtsam.utils.test_case import GtsamTestCase
 
@@ -50,5 +50,25 @@ class TestCdprPlanar(GtsamTestCase):
         for k, (des, act) in enumerate(zip(x_des, pAct)):
             self.gtsamAssertEquals(des, act, tol=1e-2)
 
+    def testNativeController(self):
+        """Tests that the C++ controller gives the trajectory of the Python one
+        """
+        cdpr = Cdpr()
+
+        x0 = gtsam.Values()
+        gtd.InsertPose(x0, cdpr.ee_id(), 0, Pose3(Rot3(), (1.5, 0, 1.5)))
+        gtd.InsertTwist(x0, cdpr.ee_id(), 0, np.zeros(6))
+
+        x_des = [Pose3(Rot3(), (1.5+k/20.0, 0, 1.5)) for k in range(9)]
+        x_des = x_des[0:1] + x_des
+        expected = CdprController(cdpr, x0=x0, pdes=x_des, dt=0.1)
+        actual = CdprNativeController(cdpr, x0=x0, pdes=x_des, dt=0.1)
+
+        self.assertEqual(expected.fg.size(), actual.fg.size())
+        for k in range(len(x_des)):
+            for ji in range(4):
+                self.assertAlmostEqual(gtd.Torque(expected.result, ji, k),
+                                       gtd.Torque(actual.result, ji, k))
+
 if __name__ == "__main__":
     unittest.main()
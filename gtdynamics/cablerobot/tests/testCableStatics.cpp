@@ -0,0 +1,109 @@
+/**
+ * @file  testCableStatics.cpp
+ * @brief test static tension distributions of cable robots
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/control/CableStatics.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+/// Wrench balance of the tensions at a pose, on the given rows.
+static Vector Balance(const CableStatics &statics, const CdprParams &params,
+                      const Pose3 &wTx, const Vector &t,
+                      const vector<int> &dofs) {
+  const Vector6 wrench = statics.structureMatrix(wTx) * t +
+                         GravityWrench(params.gravity, params.mass, wTx);
+  Vector balance(dofs.size());
+  for (size_t i = 0; i < dofs.size(); i++) balance(i) = wrench(dofs[i]);
+  return balance;
+}
+
+/**
+ * Test the planar robot under gravity, in the xz plane. The cables of the
+ * default robot all meet in one point, so only the forces are balanced.
+ */
+TEST(CableStatics, planar) {
+  CdprParams params;
+  params.gravity = Vector3(0, 0, -9.81);
+  const vector<int> dofs{3, 5};
+  const CableStatics statics(params, 0.1, 100, dofs);
+  EXPECT_LONGS_EQUAL(4, statics.numCables());
+
+  // In the middle, the upper cables hold more.
+  const Pose3 center(Rot3(), Point3(1.5, 0, 1.5));
+  Vector t;
+  CHECK(statics.tensions(center, &t));
+  EXPECT(t.minCoeff() >= 0.1 && t.maxCoeff() <= 100);
+  EXPECT(t(1) > t(0) && t(2) > t(3));
+  EXPECT(assert_equal(Vector::Zero(2),
+                      Balance(statics, params, center, t, dofs), 1e-9));
+
+  // Above the frame, all cables pull down.
+  const Pose3 above(Rot3(), Point3(1.5, 0, 5));
+  EXPECT(!statics.tensions(above, &t));
+
+  // A grid of poses gives the same tensions as single poses.
+  vector<Pose3> grid{above};
+  for (int i = 0; i <= 8; i++) {
+    for (int k = 0; k <= 8; k++) {
+      grid.emplace_back(Rot3(), Point3(0.3 + 0.3 * i, 0, 0.3 + 0.3 * k));
+    }
+  }
+  const CableWorkspace workspace = statics.workspace(grid);
+  EXPECT_LONGS_EQUAL(4, workspace.tensions.rows());
+  EXPECT_LONGS_EQUAL(grid.size(), workspace.tensions.cols());
+  EXPECT_LONGS_EQUAL(grid.size() - 1, workspace.numFeasible());
+  for (size_t p = 0; p < grid.size(); p++) {
+    const bool feasible = statics.tensions(grid[p], &t);
+    EXPECT(feasible == workspace.feasible(p));
+    if (feasible) {
+      EXPECT(assert_equal(t, Vector(workspace.tensions.col(p)), 1e-12));
+    }
+  }
+
+  THROWS_EXCEPTION(std::make_shared<CableStatics>(params, 1, 0.5));
+  THROWS_EXCEPTION(
+      std::make_shared<CableStatics>(params, 0, 1, vector<int>{6}));
+}
+
+/**
+ * Test a spatial robot with 8 cables, balancing the full wrench.
+ */
+TEST(CableStatics, spatial) {
+  CdprParams params;
+  params.a_locs.resize(8, 3);
+  params.b_locs.resize(8, 3);
+  for (int j = 0; j < 8; j++) {
+    params.a_locs.row(j) << 3 * (j & 1), 3 * ((j >> 1) & 1),
+        3 * ((j >> 2) & 1);
+    params.b_locs.row(j) << 0.15 * (1 - 2 * ((j + 1) & 1)),
+        0.15 * (1 - 2 * ((j >> 1) & 1)), 0.1 * (1 - 2 * ((j >> 2) & 1));
+  }
+  params.gravity = Vector3(0, 0, -9.81);
+  const CableStatics statics(params, 1, 200);
+
+  const Pose3 center(Rot3::Rz(0.1), Point3(1.5, 1.5, 1.5));
+  Vector t;
+  CHECK(statics.tensions(center, &t));
+  EXPECT_LONGS_EQUAL(8, t.size());
+  EXPECT(t.minCoeff() >= 1 && t.maxCoeff() <= 200);
+  EXPECT(assert_equal(Vector::Zero(6),
+                      Balance(statics, params, center, t, {0, 1, 2, 3, 4, 5}),
+                      1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file  testCableTensionsFactor.cpp
+ * @brief test cable tensions factor
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableTensionsFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+/**
+ * Test that the factor gives the sum of the cable tension factor wrenches.
+ */
+TEST(CableTensionsFactor, error) {
+  noiseModel::Gaussian::shared_ptr cost_model =
+      noiseModel::Isotropic::Sigma(6, 1.0);
+
+  // 8 cables, on the corners of a cube frame and of the end-effector
+  const int lid = 0;
+  Matrix wPa(8, 3), xPb(8, 3);
+  for (int j = 0; j < 8; j++) {
+    wPa.row(j) << 3 * (j & 1), 3 * ((j >> 1) & 1), 3 * ((j >> 2) & 1);
+    xPb.row(j) << 0.15 * (1 - 2 * ((j + 1) & 1)),
+        0.15 * (1 - 2 * ((j >> 1) & 1)), 0.1 * (1 - 2 * ((j >> 2) & 1));
+  }
+  vector<Key> tension_keys;
+  for (int j = 0; j < 8; j++) tension_keys.push_back(TorqueKey(j));
+  const Key wrench_key = WrenchKey(lid, 0);
+  CableTensionsFactor factor(tension_keys, PoseKey(lid), wrench_key,
+                             cost_model, wPa, xPb);
+  EXPECT_LONGS_EQUAL(8, factor.numCables());
+  EXPECT_LONGS_EQUAL(10, factor.size());
+
+  Values values;
+  for (int j = 0; j < 8; j++) InsertTorque(&values, j, 1.0 + 0.3 * j);
+  InsertPose(&values, lid, Pose3(Rot3::RzRyRx(0.1, -0.2, 0.4),
+                                 Point3(1.4, 1.6, 1.5)));
+  values.insert(wrench_key,
+                (Vector6() << 0.12, 0.13, 0.14, 0.18, 0.19, 0.21).finished());
+
+  // Sum of the single cable wrenches, with zero wrenches.
+  Vector6 expected = Wrench(values, lid, 0);
+  for (int j = 0; j < 8; j++) {
+    CableTensionFactor single(TorqueKey(j), PoseKey(lid), WrenchKey(lid, 1),
+                              cost_model, wPa.row(j).transpose(),
+                              xPb.row(j).transpose());
+    expected += single.evaluateError(Torque(values, j), Pose(values, lid),
+                                     Vector6::Zero());
+  }
+  EXPECT(assert_equal(expected, factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+
+  // the other pose of testCableTensionFactor
+  values.update(PoseKey(lid), Pose3(Rot3::Ry(M_PI_2), Point3(1.5, 0, 1.2)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+
+  // mounting points must match the tensions
+  THROWS_EXCEPTION(std::make_shared<CableTensionsFactor>(
+      tension_keys, PoseKey(lid), wrench_key, cost_model, wPa.topRows(4),
+      xPb.topRows(4)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
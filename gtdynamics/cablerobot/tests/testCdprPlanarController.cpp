@@ -0,0 +1,102 @@
+/**
+ * @file  testCdprPlanarController.cpp
+ * @brief test the cable robot controller and simulator
+ * @author Frank Dellaert
+ * @author Gerry Chen
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/control/CdprPlanarFixedLagController.h>
+#include <gtdynamics/cablerobot/control/CdprPlanarSimulator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+/**
+ * Test trajectory tracking, as test_cdpr_planar_controller.py
+ */
+TEST(CdprPlanarController, TrajFollow) {
+  CdprPlanar cdpr;
+  const int ee = cdpr.eeId();
+
+  Values x0;
+  InsertPose(&x0, ee, 0, Pose3(Rot3(), Point3(1.5, 0, 1.5)));
+  InsertTwist(&x0, ee, 0, Vector6::Zero());
+
+  vector<Pose3> x_des{Pose3(Rot3(), Point3(1.5, 0, 1.5))};
+  for (int k = 0; k < 9; k++) {
+    x_des.emplace_back(Rot3(), Point3(1.5 + k / 20.0, 0, 1.5));
+  }
+  auto controller =
+      std::make_shared<CdprPlanarController>(cdpr, x0, x_des, 0.1);
+  EXPECT_LONGS_EQUAL(4, controller->torques(3).size());
+
+  CdprPlanarSimulator sim(cdpr, x0, controller, 0.1);
+  const Values result = sim.run(10);
+  EXPECT_LONGS_EQUAL(10, sim.k());
+  for (int k = 0; k < 10; k++) {
+    EXPECT(assert_equal(x_des[k], Pose(result, ee, k), 1e-2));
+    for (size_t ji = 0; ji < 4; ji++) {
+      EXPECT_DOUBLES_EQUAL(Torque(controller->result(), ji, k),
+                           Torque(result, ji, k), 1e-6);
+    }
+  }
+
+  // Given tensions give the same steps.
+  CdprPlanarSimulator open_loop(cdpr, x0, 0.1);
+  THROWS_EXCEPTION(open_loop.step());
+  for (int k = 0; k < 3; k++) open_loop.step(controller->torques(k));
+  EXPECT(assert_equal(Pose(result, ee, 3), Pose(open_loop.values(), ee, 3),
+                      1e-9));
+
+  // Replanning from the same state keeps the trajectory.
+  const Values replanned = controller->replan(x0);
+  EXPECT(assert_equal(Pose(result, ee, 5), Pose(replanned, ee, 5), 1e-2));
+}
+
+/**
+ * Test trajectory tracking by re-planning a window of 5 steps.
+ */
+TEST(CdprPlanarFixedLagController, TrajFollow) {
+  CdprPlanar cdpr;
+  const int ee = cdpr.eeId();
+
+  Values x0;
+  InsertPose(&x0, ee, 0, Pose3(Rot3(), Point3(1.5, 0, 1.5)));
+  InsertTwist(&x0, ee, 0, Vector6::Zero());
+
+  vector<Pose3> x_des{Pose3(Rot3(), Point3(1.5, 0, 1.5))};
+  for (int k = 0; k < 9; k++) {
+    x_des.emplace_back(Rot3(), Point3(1.5 + k / 20.0, 0, 1.5));
+  }
+  auto controller =
+      std::make_shared<CdprPlanarFixedLagController>(cdpr, x_des, 5, 0.1);
+  const size_t num_factors = controller->graph().size();
+  EXPECT_LONGS_EQUAL(5, controller->horizon());
+
+  CdprPlanarSimulator sim(cdpr, x0, controller, 0.1);
+  const Values result = sim.run(10);
+  for (int k = 0; k < 10; k++) {
+    EXPECT(assert_equal(x_des[k], Pose(result, ee, k), 1e-2));
+  }
+
+  // The window keeps its graph, and the keys of steps 0 to 4.
+  EXPECT_LONGS_EQUAL(num_factors, controller->graph().size());
+  EXPECT(controller->window().exists(PoseKey(ee, 4)));
+  EXPECT(!controller->window().exists(PoseKey(ee, 5)));
+
+  THROWS_EXCEPTION(
+      std::make_shared<CdprPlanarFixedLagController>(cdpr, x_des, 0, 0.1));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchDynamics.cpp
+ * @brief Forward kinematics and inverse dynamics for batches of states, on
+ * the CPU or on a CUDA device.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/BatchDynamics.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+/// Number of states processed together on the CPU.
+static constexpr Eigen::Index kChunkSize = 256;
+
+/// Append a pose in the 12-number layout of batch::TreeView.
+static void AppendPose(const Pose3 &pose, std::vector<double> *dst) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) dst->push_back(R(a, b));
+  }
+  for (int a = 0; a < 3; ++a) dst->push_back(pose.translation()(a));
+}
+
+/// Call f(begin, end) on chunks of [0, n), in parallel on the given threads.
+template <typename F>
+static void ForChunks(const ExecutionContext &execution, Eigen::Index n,
+                      const F &f) {
+  execution.parallelFor((n + kChunkSize - 1) / kChunkSize, [&](size_t chunk) {
+    const Eigen::Index begin = static_cast<Eigen::Index>(chunk) * kChunkSize;
+    f(begin, std::min(begin + kChunkSize, n));
+  });
+}
+
+/* ************************************************************************* */
+BatchDynamics::BatchDynamics(const Robot &robot,
+                             const std::optional<gtsam::Vector3> &gravity,
+                             BatchBackend backend,
+                             const ExecutionContext &execution)
+    : backend_(backend), execution_(execution) {
+  if (backend == CudaBackend && !CudaAvailable()) {
+    throw std::invalid_argument(
+        "BatchDynamics: the CUDA backend needs GTDynamics compiled with "
+        "GTDYNAMICS_WITH_CUDA and a CUDA device.");
+  }
+  if (gravity) gravity_ = *gravity;
+
+  // Flatten the spanning tree of RecursiveDynamics.
+  const RecursiveDynamics dynamics(robot, gravity);
+  num_joints_ = dynamics.numJoints();
+  const auto &links = dynamics.links();
+  for (size_t k = 0; k < links.size(); ++k) {
+    const LinkSharedPtr &link = links[k];
+    const JointSharedPtr &joint = dynamics.parentJoint(k);
+    num_link_ids_ = std::max<size_t>(num_link_ids_, link->id() + 1);
+    link_ids_.push_back(link->id());
+    parent_.push_back(dynamics.parentIndex(k));
+    joint_.push_back(joint ? joint->id() : -1);
+    if (joint) {
+      AppendPose(joint->relativePoseOf(link, 0.0), &rest_);
+    } else {
+      AppendPose(link->isFixed() ? link->getFixedPose() : Pose3(), &rest_);
+    }
+    const gtsam::Vector6 S =
+        joint ? joint->screwAxis(link) : gtsam::Vector6::Zero().eval();
+    screw_.insert(screw_.end(), S.data(), S.data() + 6);
+    const gtsam::Matrix6 G =
+        link->isFixed() ? gtsam::Matrix6::Zero().eval() : link->inertiaMatrix();
+    for (int a = 0; a < 6; ++a) {
+      for (int b = 0; b < 6; ++b) inertia_.push_back(G(a, b));
+    }
+  }
+}
+
+/* ************************************************************************* */
+bool BatchDynamics::CudaAvailable() {
+#ifdef GTDYNAMICS_USE_CUDA
+  return batch::CudaDeviceCount() > 0;
+#else
+  return false;
+#endif
+}
+
+/* ************************************************************************* */
+batch::TreeView BatchDynamics::view() const {
+  batch::TreeView tree;
+  tree.num_links = parent_.size();
+  tree.parent = parent_.data();
+  tree.joint = joint_.data();
+  tree.rest = rest_.data();
+  tree.screw = screw_.data();
+  tree.inertia = inertia_.data();
+  for (int a = 0; a < 3; ++a) tree.gravity[a] = gravity_(a);
+  return tree;
+}
+
+/* ************************************************************************* */
+void BatchDynamics::checkStates(const Matrix &x,
+                                Eigen::Index num_states) const {
+  if (static_cast<size_t>(x.cols()) != num_joints_ || x.rows() != num_states) {
+    throw std::invalid_argument(
+        "BatchDynamics: states should have " + std::to_string(num_states) +
+        " rows and " + std::to_string(num_joints_) + " columns.");
+  }
+}
+
+/* ************************************************************************* */
+void BatchDynamics::forwardKinematics(const Matrix &q,
+                                      BatchLinkPoses *poses) const {
+  const Eigen::Index num_configs = q.rows();
+  checkStates(q, num_configs);
+  poses->links.resize(num_link_ids_);
+  for (auto &block : poses->links) {
+    if (block.cols() != num_configs) block.resize(12, num_configs);
+  }
+  std::vector<double *> blocks;
+  for (int i : link_ids_) blocks.push_back(poses->links[i].data());
+  const batch::TreeView tree = view();
+
+#ifdef GTDYNAMICS_USE_CUDA
+  if (backend_ == CudaBackend) {
+    batch::CudaForwardKinematics(tree, q.data(), num_configs, q.cols(),
+                                 blocks.data());
+    return;
+  }
+#endif
+  ForChunks(execution_, num_configs, [&](Eigen::Index begin, Eigen::Index end) {
+    for (Eigen::Index c = begin; c < end; ++c) {
+      batch::ForwardKinematics(tree, q.data() + c, num_configs, blocks.data(),
+                               c);
+    }
+  });
+}
+
+/* ************************************************************************* */
+void BatchDynamics::inverseDynamics(const Matrix &q, const Matrix &v,
+                                    const Matrix &qdd, Matrix *tau) const {
+  const Eigen::Index num_states = q.rows();
+  checkStates(q, num_states);
+  checkStates(v, num_states);
+  checkStates(qdd, num_states);
+  tau->setZero(num_states, num_joints_);
+  const batch::TreeView tree = view();
+
+#ifdef GTDYNAMICS_USE_CUDA
+  if (backend_ == CudaBackend) {
+    batch::CudaInverseDynamics(tree, q.data(), v.data(), qdd.data(),
+                               num_states, q.cols(), tau->data());
+    return;
+  }
+#endif
+  ForChunks(execution_, num_states, [&](Eigen::Index begin, Eigen::Index end) {
+    std::vector<double> work(tree.workSize());
+    for (Eigen::Index c = begin; c < end; ++c) {
+      batch::InverseDynamics(tree, q.data() + c, v.data() + c, qdd.data() + c,
+                             tau->data() + c, num_states, work.data(), 1);
+    }
+  });
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchDynamics.cu
+ * @brief CUDA backend of BatchDynamics, one thread per state.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/BatchDynamicsKernels.h>
+
+#include <cuda_runtime.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace batch {
+
+/// Threads per block.
+static constexpr int kBlockSize = 128;
+
+/// Throw on a CUDA error.
+static void Check(cudaError_t error, const char *what) {
+  if (error != cudaSuccess) {
+    throw std::runtime_error(std::string("BatchDynamics: ") + what + ": " +
+                             cudaGetErrorString(error));
+  }
+}
+
+/// Device array, freed when it goes out of scope.
+template <typename T>
+class DeviceArray {
+  T *data_ = nullptr;
+
+ public:
+  explicit DeviceArray(size_t size) {
+    Check(cudaMalloc(&data_, size * sizeof(T)), "cudaMalloc");
+  }
+  DeviceArray(const T *host, size_t size) : DeviceArray(size) {
+    upload(host, size);
+  }
+  DeviceArray(const DeviceArray &) = delete;
+  DeviceArray &operator=(const DeviceArray &) = delete;
+  ~DeviceArray() { cudaFree(data_); }
+
+  void upload(const T *host, size_t size) {
+    Check(cudaMemcpy(data_, host, size * sizeof(T), cudaMemcpyHostToDevice),
+          "cudaMemcpy");
+  }
+  void download(T *host, size_t size, size_t offset = 0) const {
+    Check(cudaMemcpy(host, data_ + offset, size * sizeof(T),
+                     cudaMemcpyDeviceToHost),
+          "cudaMemcpy");
+  }
+  T *data() const { return data_; }
+};
+
+/// Copies of the arrays of a tree on the device, and a view of them.
+struct DeviceTree {
+  DeviceArray<int> parent, joint;
+  DeviceArray<double> rest, screw, inertia;
+  TreeView view;
+
+  explicit DeviceTree(const TreeView &tree)
+      : parent(tree.parent, tree.num_links),
+        joint(tree.joint, tree.num_links),
+        rest(tree.rest, 12 * tree.num_links),
+        screw(tree.screw, 6 * tree.num_links),
+        inertia(tree.inertia, 36 * tree.num_links),
+        view(tree) {
+    view.parent = parent.data();
+    view.joint = joint.data();
+    view.rest = rest.data();
+    view.screw = screw.data();
+    view.inertia = inertia.data();
+  }
+};
+
+/// Number of blocks for n threads.
+static int NumBlocks(long n) { return (n + kBlockSize - 1) / kBlockSize; }
+
+/* ************************************************************************* */
+__global__ void ForwardKinematicsKernel(TreeView tree, const double *q, long n,
+                                        double *const *poses) {
+  const long c = blockIdx.x * static_cast<long>(blockDim.x) + threadIdx.x;
+  if (c < n) ForwardKinematics(tree, q + c, n, poses, c);
+}
+
+/* ************************************************************************* */
+__global__ void InverseDynamicsKernel(TreeView tree, const double *q,
+                                      const double *v, const double *qdd,
+                                      double *tau, long n, double *work) {
+  const long c = blockIdx.x * static_cast<long>(blockDim.x) + threadIdx.x;
+  if (c < n) {
+    InverseDynamics(tree, q + c, v + c, qdd + c, tau + c, n, work + c, n);
+  }
+}
+
+/* ************************************************************************* */
+void CudaForwardKinematics(const TreeView &tree, const double *q,
+                           long num_states, long num_joints,
+                           double *const *poses) {
+  const DeviceTree device_tree(tree);
+  const DeviceArray<double> d_q(q, num_states * num_joints);
+  const size_t block_size = 12 * num_states;
+  const DeviceArray<double> d_poses(tree.num_links * block_size);
+  std::vector<double *> pointers(tree.num_links);
+  for (int k = 0; k < tree.num_links; ++k) {
+    pointers[k] = d_poses.data() + k * block_size;
+  }
+  const DeviceArray<double *> d_pointers(pointers.data(), tree.num_links);
+
+  ForwardKinematicsKernel<<<NumBlocks(num_states), kBlockSize>>>(
+      device_tree.view, d_q.data(), num_states, d_pointers.data());
+  Check(cudaGetLastError(), "ForwardKinematicsKernel");
+  for (int k = 0; k < tree.num_links; ++k) {
+    d_poses.download(poses[k], block_size, k * block_size);
+  }
+}
+
+/* ************************************************************************* */
+void CudaInverseDynamics(const TreeView &tree, const double *q,
+                         const double *v, const double *qdd, long num_states,
+                         long num_joints, double *tau) {
+  const DeviceTree device_tree(tree);
+  const size_t size = num_states * num_joints;
+  const DeviceArray<double> d_q(q, size), d_v(v, size), d_qdd(qdd, size);
+  // The kernel only writes the torques of parent joints, so the others are
+  // cleared on the device instead of uploading tau.
+  const DeviceArray<double> d_tau(size);
+  Check(cudaMemset(d_tau.data(), 0, size * sizeof(double)), "cudaMemset");
+  const DeviceArray<double> d_work(tree.workSize() * num_states);
+
+  InverseDynamicsKernel<<<NumBlocks(num_states), kBlockSize>>>(
+      device_tree.view, d_q.data(), d_v.data(), d_qdd.data(), d_tau.data(),
+      num_states, d_work.data());
+  Check(cudaGetLastError(), "InverseDynamicsKernel");
+  d_tau.download(tau, size);
+}
+
+/* ************************************************************************* */
+int CudaDeviceCount() {
+  int count = 0;
+  if (cudaGetDeviceCount(&count) != cudaSuccess) return 0;
+  return count;
+}
+
+}  // namespace batch
+}  // namespace gtdynamics
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchDynamics.h
+ * @brief Forward kinematics and inverse dynamics for batches of states, on
+ * the CPU or on a CUDA device.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/BatchDynamicsKernels.h>
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Where BatchDynamics evaluates its kernels.
+enum BatchBackend { CpuBackend, CudaBackend };
+
+/**
+ * BatchDynamics evaluates forward kinematics and recursive Newton-Euler
+ * inverse dynamics of one robot for many states at once, e.g. for the
+ * 10^5 states of a training step of a learned controller.
+ *
+ * The spanning tree of RecursiveDynamics is flattened once into plain arrays
+ * (see batch::TreeView), and every state is then processed by the same
+ * kernels in BatchDynamicsKernels.h: on the CPU, in parallel chunks on the
+ * threads of an ExecutionContext, or, when GTDynamics is compiled with
+ * GTDYNAMICS_WITH_CUDA, with one CUDA thread per state. Both backends give
+ * the same results up to rounding.
+ *
+ * States are matrices with one row per state and one column per joint id,
+ * the layout of BatchForwardKinematics, so columns are contiguous across
+ * states and map directly to NumPy arrays in the wrapper. As in the flat API
+ * of RecursiveDynamics, fixed links are at their fixed pose and floating
+ * roots are held at the identity.
+ */
+class BatchDynamics {
+ private:
+  BatchBackend backend_;
+  ExecutionContext execution_;
+  size_t num_joints_ = 0, num_link_ids_ = 0;
+
+  /// Flattened tree, in traversal order.
+  std::vector<int> parent_, joint_, link_ids_;
+  std::vector<double> rest_, screw_, inertia_;
+  gtsam::Vector3 gravity_ = gtsam::Vector3::Zero();
+
+ public:
+  /**
+   * Constructor.
+   * @param robot    the robot, must have tree topology
+   * @param gravity  gravity in world frame
+   * @param backend  CpuBackend, or CudaBackend if CudaAvailable()
+   * @param execution threads that process chunks of states on the CPU
+   */
+  explicit BatchDynamics(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {},
+      BatchBackend backend = CpuBackend,
+      const ExecutionContext &execution = ExecutionContext::Default());
+
+  /// Whether GTDynamics was compiled with CUDA and a device is present.
+  static bool CudaAvailable();
+
+  /**
+   * Link CoM poses of a batch of configurations.
+   * @param q      joint angles, one row per configuration
+   * @param poses  link poses, by link id
+   */
+  void forwardKinematics(const gtsam::Matrix &q, BatchLinkPoses *poses) const;
+
+  /**
+   * Joint torques tau = M(q) * qdd + C(q, v) * v + g(q) of a batch of states.
+   * @param q    joint angles, one row per state
+   * @param v    joint velocities
+   * @param qdd  joint accelerations
+   * @param tau  joint torques, resized to the size of q; zero for fixed
+   * joints and unused joint ids
+   */
+  void inverseDynamics(const gtsam::Matrix &q, const gtsam::Matrix &v,
+                       const gtsam::Matrix &qdd, gtsam::Matrix *tau) const;
+
+  /// Joint torques of a batch of states, allocating the result.
+  gtsam::Matrix inverseDynamics(const gtsam::Matrix &q, const gtsam::Matrix &v,
+                                const gtsam::Matrix &qdd) const {
+    gtsam::Matrix tau;
+    inverseDynamics(q, v, qdd, &tau);
+    return tau;
+  }
+
+  /// Return the backend.
+  BatchBackend backend() const { return backend_; }
+
+  /// Return the size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return num_joints_; }
+
+ private:
+  /// View of the flattened tree, pointing into the arrays of this object.
+  batch::TreeView view() const;
+
+  /// Throw if a state matrix does not have one column per joint id.
+  void checkStates(const gtsam::Matrix &x, Eigen::Index num_states) const;
+};
+
+}  // namespace gtdynamics
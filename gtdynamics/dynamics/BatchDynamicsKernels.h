@@ -0,0 +1,316 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchDynamicsKernels.h
+ * @brief Per-configuration forward kinematics and Newton-Euler kernels on a
+ * flattened tree, shared by the CPU and CUDA backends of BatchDynamics.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <cmath>
+
+#ifdef __CUDACC__
+#define GTDYNAMICS_HOST_DEVICE __host__ __device__
+#else
+#define GTDYNAMICS_HOST_DEVICE
+#endif
+
+namespace gtdynamics {
+namespace batch {
+
+/**
+ * Spanning tree of a robot as plain arrays, in traversal order, so that the
+ * same kernels run on the host and on a GPU. Poses are 12 numbers, the
+ * rotation matrix in row-major order followed by the translation; twists,
+ * accelerations and wrenches are 6 numbers, angular part first.
+ */
+struct TreeView {
+  int num_links = 0;
+  const int *parent = nullptr;      ///< traversal index of parent, -1 if root
+  const int *joint = nullptr;       ///< id of the parent joint, -1 if root
+  const double *rest = nullptr;     ///< pose in parent at q = 0, root pose
+  const double *screw = nullptr;    ///< screw axis of parent joint, link frame
+  const double *inertia = nullptr;  ///< 6x6 row-major, zero if fixed
+  double gravity[3] = {0, 0, 0};    ///< gravity in world frame
+
+  /// Number of doubles of work space per configuration.
+  GTDYNAMICS_HOST_DEVICE int workSize() const { return 30 * num_links; }
+};
+
+/// Offsets of the quantities of one link in the work space.
+enum { kPose = 0, kTwist = 12, kAccel = 18, kWrench = 24, kLinkWork = 30 };
+
+/// a x b.
+GTDYNAMICS_HOST_DEVICE inline void Cross(const double *a, const double *b,
+                                         double *c) {
+  c[0] = a[1] * b[2] - a[2] * b[1];
+  c[1] = a[2] * b[0] - a[0] * b[2];
+  c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/// y = R * x, or R^T * x if transpose.
+GTDYNAMICS_HOST_DEVICE inline void Rotate(const double *R, const double *x,
+                                          double *y, bool transpose = false) {
+  for (int a = 0; a < 3; ++a) {
+    y[a] = transpose ? R[a] * x[0] + R[3 + a] * x[1] + R[6 + a] * x[2]
+                     : R[3 * a] * x[0] + R[3 * a + 1] * x[1] +
+                           R[3 * a + 2] * x[2];
+  }
+}
+
+/// Pose Expmap(S * q) of a screw axis S, as in gtsam::Pose3::Expmap.
+GTDYNAMICS_HOST_DEVICE inline void ExpScrew(const double *S, double q,
+                                            double *T) {
+  const double w[3] = {S[0] * q, S[1] * q, S[2] * q};
+  const double v[3] = {S[3] * q, S[4] * q, S[5] * q};
+  const double theta2 = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+  const double theta = std::sqrt(theta2);
+
+  // R = I + a * [w] + b * [w]^2, and for the translation
+  // (I - R) * (w x v) = -(a * [w] + b * [w]^2) * (w x v).
+  double a, b;
+  if (theta < 1e-9) {
+    a = 1.0;
+    b = 0.5;
+  } else {
+    a = std::sin(theta) / theta;
+    b = (1.0 - std::cos(theta)) / theta2;
+  }
+  const double K[9] = {0, -w[2], w[1], w[2], 0, -w[0], -w[1], w[0], 0};
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      const double K2 =
+          K[3 * i] * K[j] + K[3 * i + 1] * K[3 + j] + K[3 * i + 2] * K[6 + j];
+      T[3 * i + j] = (i == j ? 1.0 : 0.0) + a * K[3 * i + j] + b * K2;
+    }
+  }
+  if (theta < 1e-9) {
+    double wxv[3];
+    Cross(w, v, wxv);
+    for (int i = 0; i < 3; ++i) T[9 + i] = v[i] + 0.5 * wxv[i];
+    return;
+  }
+  double wxv[3], Kwxv[3], K2wxv[3];
+  Cross(w, v, wxv);
+  Cross(w, wxv, Kwxv);
+  Cross(w, Kwxv, K2wxv);
+  const double wv = w[0] * v[0] + w[1] * v[1] + w[2] * v[2];
+  for (int i = 0; i < 3; ++i) {
+    T[9 + i] = (-a * Kwxv[i] - b * K2wxv[i] + w[i] * wv) / theta2;
+  }
+}
+
+/// T = T1 * T2.
+GTDYNAMICS_HOST_DEVICE inline void Compose(const double *T1, const double *T2,
+                                           double *T) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      T[3 * i + j] = T1[3 * i] * T2[j] + T1[3 * i + 1] * T2[3 + j] +
+                     T1[3 * i + 2] * T2[6 + j];
+    }
+    T[9 + i] = T1[3 * i] * T2[9] + T1[3 * i + 1] * T2[10] +
+               T1[3 * i + 2] * T2[11] + T1[9 + i];
+  }
+}
+
+/// Twist of a child frame, y = Ad(T^-1) * x, for the pose T of the child.
+GTDYNAMICS_HOST_DEVICE inline void AdjointInverse(const double *T,
+                                                  const double *x, double *y) {
+  double txw[3], d[3];
+  Cross(T + 9, x, txw);
+  for (int i = 0; i < 3; ++i) d[i] = x[3 + i] - txw[i];
+  Rotate(T, x, y, true);
+  Rotate(T, d, y + 3, true);
+}
+
+/// Wrench in the parent frame, y = Ad(T^-1)^T * x, for the pose T of the
+/// child, i.e. the inverse of AdjointInverse on wrenches.
+GTDYNAMICS_HOST_DEVICE inline void AdjointInverseTranspose(const double *T,
+                                                           const double *x,
+                                                           double *y) {
+  double Rm[3], Rf[3], txRf[3];
+  Rotate(T, x, Rm);
+  Rotate(T, x + 3, Rf);
+  Cross(T + 9, Rf, txRf);
+  for (int i = 0; i < 3; ++i) {
+    y[i] = Rm[i] + txRf[i];
+    y[3 + i] = Rf[i];
+  }
+}
+
+/// Lie bracket y = ad(V) * x of twists.
+GTDYNAMICS_HOST_DEVICE inline void LieBracket(const double *V, const double *x,
+                                              double *y) {
+  double wxs[3], vxs[3], wxv[3];
+  Cross(V, x, wxs);
+  Cross(V + 3, x, vxs);
+  Cross(V, x + 3, wxv);
+  for (int i = 0; i < 3; ++i) {
+    y[i] = wxs[i];
+    y[3 + i] = vxs[i] + wxv[i];
+  }
+}
+
+/**
+ * Link CoM poses of one configuration, with fixed roots at their fixed pose
+ * and floating roots at the identity, as RecursiveDynamics does.
+ * @param tree    the flattened tree
+ * @param q       joint angles, joint id j at q[j * stride]
+ * @param stride  stride of q and of the poses
+ * @param poses   pose of the k-th link, number f at
+ * poses[k][offset + f * stride]
+ * @param offset  index of the configuration in the poses
+ */
+GTDYNAMICS_HOST_DEVICE inline void ForwardKinematics(
+    const TreeView &tree, const double *q, long stride, double *const *poses,
+    long offset) {
+  double T_k[12], T_p[12], T_pk[12], E[12];
+  for (int k = 0; k < tree.num_links; ++k) {
+    const int p = tree.parent[k];
+    const double *rest = tree.rest + 12 * k;
+    if (p < 0) {
+      for (int f = 0; f < 12; ++f) T_k[f] = rest[f];
+    } else {
+      for (int f = 0; f < 12; ++f) T_p[f] = poses[p][offset + f * stride];
+      ExpScrew(tree.screw + 6 * k, q[tree.joint[k] * stride], E);
+      Compose(rest, E, T_pk);
+      Compose(T_p, T_pk, T_k);
+    }
+    for (int f = 0; f < 12; ++f) poses[k][offset + f * stride] = T_k[f];
+  }
+}
+
+/**
+ * Recursive Newton-Euler torques of one configuration, with all roots held
+ * at rest, i.e. tau = M(q) * qdd + C(q, v) * v + g(q) of RecursiveDynamics.
+ * @param tree    the flattened tree
+ * @param q       joint angles, joint id j at q[j * stride]
+ * @param v       joint velocities
+ * @param qdd     joint accelerations
+ * @param tau     joint torques, only the parent joints of links are written
+ * @param stride  stride of q, v, qdd and tau
+ * @param work    work space, number i at work[i * work_stride]
+ */
+GTDYNAMICS_HOST_DEVICE inline void InverseDynamics(
+    const TreeView &tree, const double *q, const double *v, const double *qdd,
+    double *tau, long stride, double *work, long work_stride) {
+  double T_pk[12], E[12], V_p[6], V[6], A[6], x[6], y[6], z[6];
+  auto load = [&](int k, int offset, int size, double *dst) {
+    for (int f = 0; f < size; ++f) {
+      dst[f] = work[(kLinkWork * k + offset + f) * work_stride];
+    }
+  };
+  auto store = [&](int k, int offset, int size, const double *src) {
+    for (int f = 0; f < size; ++f) {
+      work[(kLinkWork * k + offset + f) * work_stride] = src[f];
+    }
+  };
+
+  // Outward pass: relative poses, twists and accelerations. The pose slot of
+  // a link holds its pose in its parent, the root pose for a root. Roots are
+  // accelerated against gravity instead of adding gravity wrenches, so all
+  // accelerations are offset by gravity.
+  for (int k = 0; k < tree.num_links; ++k) {
+    const int p = tree.parent[k];
+    const double *rest = tree.rest + 12 * k;
+    const double *S = tree.screw + 6 * k;
+    if (p < 0) {
+      for (int f = 0; f < 6; ++f) V[f] = A[f] = 0.0;
+      Rotate(rest, tree.gravity, A + 3, true);
+      for (int f = 3; f < 6; ++f) A[f] = -A[f];
+      store(k, kPose, 12, rest);
+    } else {
+      const int j = tree.joint[k];
+      ExpScrew(S, q[j * stride], E);
+      Compose(rest, E, T_pk);
+      store(k, kPose, 12, T_pk);
+
+      load(p, kTwist, 6, V_p);
+      AdjointInverse(T_pk, V_p, V);
+      for (int f = 0; f < 6; ++f) V[f] += S[f] * v[j * stride];
+
+      load(p, kAccel, 6, x);
+      AdjointInverse(T_pk, x, A);
+      LieBracket(V, S, y);
+      for (int f = 0; f < 6; ++f) {
+        A[f] += S[f] * qdd[j * stride] + y[f] * v[j * stride];
+      }
+    }
+    store(k, kTwist, 6, V);
+    store(k, kAccel, 6, A);
+  }
+
+  // Net wrench G * A - ad(V)^T * G * V of each link, where G * A includes
+  // the gravity wrench as the inertia is in the CoM frame.
+  for (int k = 0; k < tree.num_links; ++k) {
+    const double *G = tree.inertia + 36 * k;
+    load(k, kTwist, 6, V);
+    load(k, kAccel, 6, A);
+    for (int i = 0; i < 6; ++i) {
+      x[i] = y[i] = 0.0;
+      for (int j = 0; j < 6; ++j) {
+        x[i] += G[6 * i + j] * V[j];
+        y[i] += G[6 * i + j] * A[j];
+      }
+    }
+    // -ad(V)^T * h = [w x h_m + v x h_f; w x h_f] for h = G * V.
+    Cross(V, x, z);
+    Cross(V + 3, x + 3, z + 3);
+    for (int i = 0; i < 3; ++i) y[i] += z[i] + z[3 + i];
+    Cross(V, x + 3, z);
+    for (int i = 0; i < 3; ++i) y[3 + i] += z[i];
+
+    store(k, kWrench, 6, y);
+  }
+
+  // Inward pass: torques, and joint wrenches accumulated on the parents.
+  for (int k = tree.num_links - 1; k >= 0; --k) {
+    const int p = tree.parent[k];
+    if (p < 0) continue;
+    const double *S = tree.screw + 6 * k;
+    load(k, kWrench, 6, x);
+    double torque = 0.0;
+    for (int f = 0; f < 6; ++f) torque += S[f] * x[f];
+    tau[tree.joint[k] * stride] = torque;
+
+    load(k, kPose, 12, T_pk);
+    AdjointInverseTranspose(T_pk, x, y);
+    load(p, kWrench, 6, z);
+    for (int f = 0; f < 6; ++f) z[f] += y[f];
+    store(p, kWrench, 6, z);
+  }
+}
+
+/**
+ * @name CUDA backend
+ * Defined in BatchDynamics.cu, which is only compiled with
+ * GTDYNAMICS_WITH_CUDA. Arguments are host arrays with one column per joint
+ * id and num_states rows, column-major; errors throw std::runtime_error.
+ * @{
+ */
+
+/// Forward kinematics, poses[k] is the 12 x num_states row-major block of
+/// the k-th link in traversal order.
+void CudaForwardKinematics(const TreeView &tree, const double *q,
+                           long num_states, long num_joints,
+                           double *const *poses);
+
+/// Inverse dynamics, tau is zero where no link has the joint as parent.
+void CudaInverseDynamics(const TreeView &tree, const double *q,
+                         const double *v, const double *qdd, long num_states,
+                         long num_joints, double *tau);
+
+/// Number of CUDA devices, zero if there is no driver.
+int CudaDeviceCount();
+
+/// @}
+
+}  // namespace batch
+}  // namespace gtdynamics
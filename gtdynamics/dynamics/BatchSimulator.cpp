@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.cpp
+ * @brief Simulate many rollouts of the same robot in parallel.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::vector<BatchSimulator::Trajectory> BatchSimulator::simulate(
+    const std::vector<Vector> &q0, const std::vector<Vector> &v0,
+    const std::vector<Matrix> &torques, double dt) const {
+  const size_t num_rollouts = q0.size();
+  const Eigen::Index n = numJoints();
+  if (v0.size() != num_rollouts || torques.size() != num_rollouts) {
+    throw std::invalid_argument(
+        "BatchSimulator::simulate: need the same number of initial angles, "
+        "initial velocities and torque sequences.");
+  }
+  for (size_t r = 0; r < num_rollouts; ++r) {
+    if (q0[r].size() != n || v0[r].size() != n || torques[r].cols() != n) {
+      throw std::invalid_argument(
+          "BatchSimulator::simulate: joint vectors should have size " +
+          std::to_string(numJoints()) + ".");
+    }
+  }
+
+  std::vector<Trajectory> trajectories(num_rollouts);
+
+  // Simulate rollouts [begin, end) with a private copy of the solver, whose
+  // work buffers can then be reused across all steps and rollouts.
+  auto simulateRange = [&](size_t begin, size_t end) {
+    RecursiveDynamics solver = solver_;
+    Vector q(n), v(n), a(n), tau(n);
+    IntegrationWorkspace workspace;
+    workspace.resize(n);
+    auto accelerations = [&](const Vector &q_k, const Vector &v_k,
+                             Vector *a_k) {
+      solver.forwardDynamics(q_k, v_k, tau, a_k);
+    };
+    for (size_t r = begin; r < end; ++r) {
+      const Eigen::Index num_steps = torques[r].rows();
+      Trajectory &trajectory = trajectories[r];
+      trajectory.resize(num_steps, n);
+      q = q0[r];
+      v = v0[r];
+      trajectory.q.row(0) = q.transpose();
+      trajectory.v.row(0) = v.transpose();
+      for (Eigen::Index k = 0; k < num_steps; ++k) {
+        tau = torques[r].row(k).transpose();
+        solver.forwardDynamics(q, v, tau, &a);
+        IntegrateStep(scheme_, dt, accelerations, a, &q, &v, &workspace);
+        trajectory.a.row(k) = a.transpose();
+        trajectory.q.row(k + 1) = q.transpose();
+        trajectory.v.row(k + 1) = v.transpose();
+      }
+    }
+  };
+
+  // A few contiguous blocks of rollouts per thread, so that the solver is
+  // copied once per block and uneven rollouts still balance.
+  const size_t num_blocks =
+      std::min(num_rollouts, 4 * execution_.numThreads());
+  execution_.parallelFor(num_blocks, [&](size_t b) {
+    simulateRange(b * num_rollouts / num_blocks,
+                  (b + 1) * num_rollouts / num_blocks);
+  });
+
+  return trajectories;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.h
+ * @brief Simulate many rollouts of the same robot in parallel.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * BatchSimulator advances N rollouts of the same robot, each with its own
+ * initial state and torque sequence. The spanning tree of the robot is
+ * computed once and shared by all rollouts. Rollouts run in parallel on the
+ * threads of an ExecutionContext.
+ *
+ * Every step uses the same integration as the vector interface of Simulator.
+ * Since the rollouts are independent, the result does not depend on whether
+ * or how they are parallelized.
+ */
+class BatchSimulator {
+ private:
+  RecursiveDynamics solver_;
+  IntegrationScheme scheme_;
+  ExecutionContext execution_;
+
+ public:
+  /// Joint trajectory of one rollout, one row per time step.
+  using Trajectory = JointTrajectory;
+
+  /**
+   * Constructor.
+   * @param robot    the robot, must have tree topology
+   * @param gravity  gravity in world frame
+   * @param scheme   integration scheme
+   * @param execution threads that run the rollouts
+   */
+  explicit BatchSimulator(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {},
+      IntegrationScheme scheme = TaylorStep,
+      const ExecutionContext &execution = ExecutionContext::Default())
+      : solver_(robot, gravity), scheme_(scheme), execution_(execution) {}
+
+  /// Return the size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return solver_.numJoints(); }
+
+  /**
+   * Simulate all rollouts.
+   * @param q0       initial joint angles of each rollout, indexed by joint id
+   * @param v0       initial joint velocities of each rollout
+   * @param torques  torques of each rollout, one row per time step
+   * @param dt       duration of a time step
+   * @return the trajectory of each rollout
+   */
+  std::vector<Trajectory> simulate(const std::vector<gtsam::Vector> &q0,
+                                   const std::vector<gtsam::Vector> &v0,
+                                   const std::vector<gtsam::Matrix> &torques,
+                                   double dt) const;
+};
+
+}  // namespace gtdynamics
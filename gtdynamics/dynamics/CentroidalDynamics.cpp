@@ -0,0 +1,348 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalDynamics.cpp
+ * @brief Single rigid body model of a robot, for fast planning front ends.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/CentroidalDynamics.h>
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix3;
+using gtsam::Matrix6;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+CentroidalModel::CentroidalModel(const Robot &robot,
+                                 const std::string &base_name,
+                                 const Values &nominal, int k)
+    : base_name_(base_name) {
+  const LinkSharedPtr base = robot.link(base_name);
+  base_id_ = base->id();
+
+  // Link poses in the base frame, at the nominal joint angles.
+  const BatchForwardKinematics fk(robot, base_name);
+  gtsam::Matrix q = gtsam::Matrix::Zero(1, robot.topology().joints.size());
+  for (auto &&joint : robot.joints()) {
+    const gtsam::Key key = JointAngleKey(joint->id(), k);
+    if (nominal.exists(key)) q(0, joint->id()) = nominal.at<double>(key);
+  }
+  const BatchLinkPoses poses = fk.compute(q);
+  const Pose3 wTbase = poses.pose(base_id_, 0);
+
+  // Total mass and CoM, then inertia about the CoM by the parallel axis
+  // theorem.
+  mass_ = 0;
+  Point3 com = Point3::Zero();
+  for (auto &&link : robot.links()) {
+    mass_ += link->mass();
+    com += link->mass() * wTbase.transformTo(
+                              poses.pose(link->id(), 0).translation());
+  }
+  if (mass_ <= 0) {
+    throw std::invalid_argument("CentroidalModel: robot has no mass");
+  }
+  com /= mass_;
+
+  inertia_.setZero();
+  for (auto &&link : robot.links()) {
+    const Pose3 baseTlink = wTbase.between(poses.pose(link->id(), 0));
+    const Matrix3 R = baseTlink.rotation().matrix();
+    const Vector3 d = baseTlink.translation() - com;
+    inertia_ += R * link->inertia() * R.transpose() +
+                link->mass() * (d.dot(d) * gtsam::I_3x3 - d * d.transpose());
+  }
+  baseTcom_ = Pose3(gtsam::Rot3(), com);
+}
+
+/* ************************************************************************* */
+Matrix6 CentroidalModel::inertiaMatrix() const {
+  Matrix6 G = Matrix6::Zero();
+  G.topLeftCorner<3, 3>() = inertia_;
+  G.bottomRightCorner<3, 3>() = mass_ * gtsam::I_3x3;
+  return G;
+}
+
+/* ************************************************************************* */
+static gtsam::KeyVector CentroidalKeys(int k, const ContactGoals &contacts) {
+  gtsam::KeyVector keys{CentroidalPoseKey(k), CentroidalTwistKey(k),
+                        CentroidalAccelKey(k)};
+  for (const ContactGoal &contact : contacts) {
+    keys.push_back(CentroidalForceKey(contact.link()->id(), k));
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+CentroidalDynamicsFactor::CentroidalDynamicsFactor(
+    const gtsam::SharedNoiseModel &cost_model, const CentroidalModel &model,
+    int k, const ContactGoals &contacts, const Vector3 &gravity)
+    : Base(cost_model, CentroidalKeys(k, contacts)),
+      inertia_(model.inertiaMatrix()),
+      mass_(model.mass()),
+      gravity_(gravity) {
+  for (const ContactGoal &contact : contacts) {
+    footholds_.push_back(contact.goal_point);
+  }
+}
+
+/* ************************************************************************* */
+Vector6 CentroidalDynamicsFactor::ContactWrench(
+    const Pose3 &wTcom, const Vector3 &force, const Point3 &point,
+    gtsam::OptionalJacobian<6, 6> H_pose,
+    gtsam::OptionalJacobian<6, 3> H_force) {
+  // In the body frame, f = R^T force and m = R^T ((point - t) x force).
+  const Matrix3 Rt = wTcom.rotation().transpose();
+  const Vector3 r = point - wTcom.translation();
+  const Vector3 f = Rt * force, m = Rt * r.cross(force);
+  Vector6 wrench;
+  wrench << m, f;
+  if (H_pose) {
+    H_pose->setZero();
+    H_pose->block<3, 3>(0, 0) = gtsam::skewSymmetric(m);
+    H_pose->block<3, 3>(0, 3) = gtsam::skewSymmetric(f);
+    H_pose->block<3, 3>(3, 0) = gtsam::skewSymmetric(f);
+  }
+  if (H_force) {
+    H_force->topRows<3>() = Rt * gtsam::skewSymmetric(r);
+    H_force->bottomRows<3>() = Rt;
+  }
+  return wrench;
+}
+
+/* ************************************************************************* */
+gtsam::Vector CentroidalDynamicsFactor::unwhitenedError(
+    const Values &x, gtsam::OptionalMatrixVecType H) const {
+  const Pose3 &wTcom = x.at<Pose3>(keys_[0]);
+  Matrix6 H_twist, H_pose, H_gravity;
+  Vector6 error =
+      Coriolis(inertia_, x.at<Vector6>(keys_[1]), H ? &H_twist : nullptr) -
+      inertia_ * x.at<Vector6>(keys_[2]) +
+      GravityWrench(gravity_, mass_, wTcom, H ? &H_gravity : nullptr);
+  if (H) {
+    (*H)[0] = H_gravity;
+    (*H)[1] = H_twist;
+    (*H)[2] = -inertia_;
+  }
+  for (size_t c = 0; c < footholds_.size(); c++) {
+    Eigen::Matrix<double, 6, 3> H_force;
+    error += ContactWrench(wTcom, x.at<Vector3>(keys_[3 + c]), footholds_[c],
+                           H ? &H_pose : nullptr, H ? &H_force : nullptr);
+    if (H) {
+      (*H)[0] += H_pose;
+      (*H)[3 + c] = H_force;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+CentroidalFrictionConeFactor::CentroidalFrictionConeFactor(
+    gtsam::Key force_key, const gtsam::SharedNoiseModel &cost_model, double mu,
+    const Vector3 &gravity)
+    : Base(cost_model, force_key), mu_prime_(mu * mu) {
+  gravity.cwiseAbs().maxCoeff(&up_axis_);
+}
+
+/* ************************************************************************* */
+gtsam::Vector CentroidalFrictionConeFactor::evaluateError(
+    const Vector3 &force, gtsam::OptionalMatrixType H_force) const {
+  Vector3 weights = Vector3::Ones();
+  weights(up_axis_) = -mu_prime_;
+  const double resultant = weights.dot(force.cwiseProduct(force));
+
+  // Ramp function, with zero gradients if the constraint is inactive.
+  const bool active = resultant > 0;
+  if (H_force) {
+    *H_force = gtsam::Matrix::Zero(1, 3);
+    if (active) *H_force = 2 * weights.cwiseProduct(force).transpose();
+  }
+  return gtsam::Vector1(active ? resultant : 0);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph CentroidalPlanner::graph(const ContactSchedule &schedule,
+                                              double dt,
+                                              const Pose3 &wTcom_start,
+                                              const Pose3 &wTcom_goal) const {
+  if (schedule.empty()) {
+    throw std::invalid_argument("CentroidalPlanner: empty contact schedule");
+  }
+  NonlinearFactorGraph graph;
+  const int K = schedule.size() - 1;
+  const gtsam::Key dt_key = CentroidalTimeStepKey();
+  for (int k = 0; k <= K; k++) {
+    graph.emplace_shared<CentroidalDynamicsFactor>(
+        p_.dynamics_cost_model, model_, k, schedule[k], p_.gravity);
+    for (const ContactGoal &contact : schedule[k]) {
+      const gtsam::Key force_key = CentroidalForceKey(contact.link()->id(), k);
+      graph.emplace_shared<CentroidalFrictionConeFactor>(
+          force_key, p_.friction_cost_model, p_.mu, p_.gravity);
+      graph.addPrior<Vector3>(force_key, Vector3::Zero(), p_.force_cost_model);
+    }
+    if (k < K) {
+      graph.emplace_shared<EulerPoseCollocationFactor>(
+          CentroidalPoseKey(k), CentroidalPoseKey(k + 1),
+          CentroidalTwistKey(k), dt_key, p_.collocation_cost_model);
+      graph.emplace_shared<EulerTwistCollocationFactor>(
+          CentroidalTwistKey(k), CentroidalTwistKey(k + 1),
+          CentroidalAccelKey(k), dt_key, p_.collocation_cost_model);
+    }
+  }
+
+  // At rest at the start and goal poses, with a fixed time step.
+  graph.addPrior<Pose3>(CentroidalPoseKey(0), wTcom_start,
+                        p_.boundary_cost_model);
+  graph.addPrior<Pose3>(CentroidalPoseKey(K), wTcom_goal,
+                        p_.boundary_cost_model);
+  graph.addPrior<Vector6>(CentroidalTwistKey(0), Vector6::Zero(),
+                          p_.boundary_cost_model);
+  graph.addPrior<Vector6>(CentroidalTwistKey(K), Vector6::Zero(),
+                          p_.boundary_cost_model);
+  graph.addPrior<double>(dt_key, dt, p_.time_cost_model);
+  return graph;
+}
+
+/* ************************************************************************* */
+Values CentroidalPlanner::initialValues(const ContactSchedule &schedule,
+                                        double dt, const Pose3 &wTcom_start,
+                                        const Pose3 &wTcom_goal) const {
+  Values values;
+  const int K = schedule.size() - 1;
+  const Vector6 twist =
+      K > 0 ? Vector6(Pose3::Logmap(wTcom_start.between(wTcom_goal)) / (K * dt))
+            : Vector6::Zero();
+  for (int k = 0; k <= K; k++) {
+    const double s = K > 0 ? static_cast<double>(k) / K : 0.0;
+    values.insert(CentroidalPoseKey(k), wTcom_start.expmap(s * K * dt * twist));
+    values.insert(CentroidalTwistKey(k), twist);
+    values.insert(CentroidalAccelKey(k), Vector6::Zero());
+    for (const ContactGoal &contact : schedule[k]) {
+      values.insert(CentroidalForceKey(contact.link()->id(), k),
+                    Vector3(-model_.mass() * p_.gravity /
+                            schedule[k].size()));
+    }
+  }
+  values.insert(CentroidalTimeStepKey(), dt);
+  return values;
+}
+
+/* ************************************************************************* */
+Values CentroidalPlanner::plan(const ContactSchedule &schedule, double dt,
+                               const Pose3 &wTcom_start,
+                               const Pose3 &wTcom_goal) const {
+  gtsam::LevenbergMarquardtOptimizer optimizer(
+      graph(schedule, dt, wTcom_start, wTcom_goal),
+      initialValues(schedule, dt, wTcom_start, wTcom_goal), p_.lm_parameters);
+  return optimizer.optimize();
+}
+
+/* ************************************************************************* */
+CentroidalInitializer::CentroidalInitializer(
+    const Robot &robot, const CentroidalModel &model,
+    const ContactSchedule &schedule, const Values &plan, double dt,
+    const KinematicsParameters &parameters) {
+  const Kinematics kinematics(parameters);
+  const int K = schedule.size() - 1;
+  const int base = model.baseId();
+  const Pose3 comTbase = model.baseTcom().inverse();
+  const LinkSharedPtr base_link = robot.link(model.baseName());
+
+  // Inverse kinematics of each step, with the base at the planned pose,
+  // starting at the previous step.
+  Values previous;
+  for (int k = 0; k <= K; k++) {
+    const Slice slice(k);
+    const Pose3 wTbase = plan.at<Pose3>(CentroidalPoseKey(k)) * comTbase;
+    Values initial;
+    if (k == 0) {
+      initial = kinematics.initialValues(slice, robot, 0.0);
+      const Pose3 wTzero = wTbase * base_link->bMcom().inverse();
+      for (auto &&link : robot.links()) {
+        initial.update(PoseKey(link->id(), k), wTzero * link->bMcom());
+      }
+    } else {
+      for (auto &&link : robot.links()) {
+        InsertPose(&initial, link->id(), k, Pose(previous, link->id(), k - 1));
+      }
+      for (auto &&joint : robot.joints()) {
+        InsertJointAngle(&initial, joint->id(), k,
+                         JointAngle(previous, joint->id(), k - 1));
+      }
+    }
+
+    NonlinearFactorGraph graph = kinematics.graph(slice, robot);
+    graph.add(kinematics.pointGoalObjectives(slice, schedule[k]));
+    graph.add(kinematics.jointAngleObjectives(slice, robot));
+    graph.addPrior<Pose3>(PoseKey(base, k), wTbase, parameters.p_cost_model);
+    previous = gtsam::LevenbergMarquardtOptimizer(graph, initial,
+                                                  parameters.lm_parameters)
+                   .optimize();
+    warm_start_.insert(previous);
+  }
+
+  // Twists and joint velocities by finite differences, forward except at
+  // the last step.
+  for (int k = 0; k <= K; k++) {
+    const int k0 = k < K ? k : std::max(k - 1, 0), k1 = k0 + (K > 0);
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      const Vector6 twist =
+          Pose3::Logmap(Pose(warm_start_, i, k0).between(
+              Pose(warm_start_, i, k1))) / dt;
+      InsertTwist(&warm_start_, i, k, twist);
+    }
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointVel(&warm_start_, j, k,
+                     (JointAngle(warm_start_, j, k1) -
+                      JointAngle(warm_start_, j, k0)) / dt);
+    }
+
+    // Planned forces as wrenches at the CoM of the contact links.
+    for (const ContactGoal &contact : schedule[k]) {
+      const int i = contact.link()->id();
+      const Vector3 force = Pose(warm_start_, i, k).rotation().unrotate(
+          plan.at<Vector3>(CentroidalForceKey(i, k)));
+      Vector6 wrench;
+      wrench << contact.contactInCoM().cross(force), force;
+      warm_start_.insert(ContactWrenchKey(i, 0, k), wrench);
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values CentroidalInitializer::ZeroValues(
+    const Robot &robot, const int t, double gaussian_noise,
+    const std::optional<PointOnLinks> &contact_points) const {
+  Values values =
+      Initializer::ZeroValues(robot, t, gaussian_noise, contact_points);
+  for (gtsam::Key key : values.keys()) {
+    if (warm_start_.exists(key)) values.update(key, warm_start_.at(key));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,299 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalDynamics.h
+ * @brief Single rigid body model of a robot, for fast planning front ends.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Shorthand for cp_k, pose of the centroidal body at time step k.
+inline gtsam::Key CentroidalPoseKey(int k) {
+  return DynamicsSymbol::SimpleSymbol("cp", k);
+}
+
+/// Shorthand for cV_k, twist of the centroidal body, in its frame.
+inline gtsam::Key CentroidalTwistKey(int k) {
+  return DynamicsSymbol::SimpleSymbol("cV", k);
+}
+
+/// Shorthand for cA_k, twist acceleration of the centroidal body.
+inline gtsam::Key CentroidalAccelKey(int k) {
+  return DynamicsSymbol::SimpleSymbol("cA", k);
+}
+
+/// Shorthand for cf_i_k, world force at the contact on link i at step k.
+inline gtsam::Key CentroidalForceKey(int i, int k) {
+  return DynamicsSymbol::LinkSymbol("cf", i, k);
+}
+
+/// Shorthand for cd, the duration of the time steps of a centroidal plan.
+inline gtsam::Key CentroidalTimeStepKey() {
+  return DynamicsSymbol::SimpleSymbol("cd", 0);
+}
+
+/**
+ * Contacts in stance at each time step k = 0..K of a plan: the goal points are
+ * the footholds, in world frame, fixed while in stance. At most one contact
+ * per link.
+ */
+using ContactSchedule = std::vector<ContactGoals>;
+
+/**
+ * The robot as a single rigid body: its total mass, and the composite inertia
+ * of all links about the center of mass (CoM) at a nominal configuration. The
+ * body frame is at the CoM, with the axes of the base link's CoM frame.
+ */
+class CentroidalModel {
+ public:
+  /**
+   * Compute the model of a robot.
+   * @param robot     the robot
+   * @param base_name name of the base link, e.g. the torso of a legged robot
+   * @param nominal   nominal joint angles at time step k; joints without an
+   * angle in nominal are at zero
+   * @param k         time step of the joint angles in nominal
+   */
+  CentroidalModel(const Robot &robot, const std::string &base_name,
+                  const gtsam::Values &nominal = gtsam::Values(), int k = 0);
+
+  /// Total mass.
+  double mass() const { return mass_; }
+
+  /// Composite rotational inertia about the CoM, in the body frame.
+  const gtsam::Matrix3 &inertia() const { return inertia_; }
+
+  /// Spatial inertia matrix, as Link::inertiaMatrix.
+  gtsam::Matrix6 inertiaMatrix() const;
+
+  /// Pose of the body frame in the CoM frame of the base link.
+  const gtsam::Pose3 &baseTcom() const { return baseTcom_; }
+
+  /// Name of the base link.
+  const std::string &baseName() const { return base_name_; }
+
+  /// Id of the base link.
+  int baseId() const { return base_id_; }
+
+ private:
+  double mass_;
+  gtsam::Matrix3 inertia_;
+  gtsam::Pose3 baseTcom_;
+  std::string base_name_;
+  int base_id_;
+};
+
+/**
+ * Wrench balance of the centroidal body, as LinkWrenchFactor: coriolis -
+ * inertia * accel + contact wrenches + gravity. Each contact applies a world
+ * force at a fixed world foothold. Keys are the pose, twist and twist
+ * acceleration of the body, then the contact forces.
+ */
+class CentroidalDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CentroidalDynamicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix6 inertia_;
+  double mass_;
+  gtsam::Vector3 gravity_;
+  std::vector<gtsam::Point3> footholds_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model noise model of the wrench error
+   * @param model      the centroidal model
+   * @param k          time step
+   * @param contacts   contacts in stance, with their footholds
+   * @param gravity    gravity vector, in world frame
+   */
+  CentroidalDynamicsFactor(const gtsam::SharedNoiseModel &cost_model,
+                           const CentroidalModel &model, int k,
+                           const ContactGoals &contacts,
+                           const gtsam::Vector3 &gravity);
+
+  virtual ~CentroidalDynamicsFactor() {}
+
+  /**
+   * Wrench, in the body frame, of a world force at a world point.
+   * @param wTcom pose of the body
+   * @param force force, in world frame
+   * @param point point of application, in world frame
+   */
+  static gtsam::Vector6 ContactWrench(
+      const gtsam::Pose3 &wTcom, const gtsam::Vector3 &force,
+      const gtsam::Point3 &point, gtsam::OptionalJacobian<6, 6> H_pose = {},
+      gtsam::OptionalJacobian<6, 3> H_force = {});
+
+  /// Resultant wrench on the body, zero if the dynamics are satisfied.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override;
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "CentroidalDynamicsFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * Friction cone of a world contact force on flat ground, as
+ * ContactDynamicsFrictionConeFactor: the ramp of the squared tangential
+ * force minus mu^2 times the squared normal force.
+ */
+class CentroidalFrictionConeFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Vector3> {
+ private:
+  using This = CentroidalFrictionConeFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Vector3>;
+
+  int up_axis_;
+  double mu_prime_;
+
+ public:
+  CentroidalFrictionConeFactor(gtsam::Key force_key,
+                               const gtsam::SharedNoiseModel &cost_model,
+                               double mu, const gtsam::Vector3 &gravity);
+
+  virtual ~CentroidalFrictionConeFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &force,
+      gtsam::OptionalMatrixType H_force = nullptr) const override;
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/// Gravity, friction and noise models of centroidal planning.
+struct CentroidalParameters {
+  using Isotropic = gtsam::noiseModel::Isotropic;
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  double mu = 1.0;  ///< friction coefficient
+
+  gtsam::SharedNoiseModel dynamics_cost_model = Isotropic::Sigma(6, 1e-3),
+                          collocation_cost_model = Isotropic::Sigma(6, 1e-3),
+                          friction_cost_model = Isotropic::Sigma(1, 1e-2),
+                          force_cost_model = Isotropic::Sigma(3, 1e3),
+                          boundary_cost_model = Isotropic::Sigma(6, 1e-3),
+                          time_cost_model = Isotropic::Sigma(1, 1e-6);
+
+  gtsam::LevenbergMarquardtParams lm_parameters;
+};
+
+/**
+ * Plans the motion of the centroidal body and the contact forces for a
+ * contact schedule, between a start and a goal pose at rest. The graph has
+ * one wrench balance per step, Euler collocation between steps, friction
+ * cones and a weak prior on the forces; it is much smaller than the
+ * kinodynamic graph of DynamicsGraph and is used to initialize it, see
+ * CentroidalInitializer.
+ */
+class CentroidalPlanner {
+ public:
+  /// Constructor.
+  CentroidalPlanner(const CentroidalModel &model,
+                    const CentroidalParameters &parameters =
+                        CentroidalParameters())
+      : model_(model), p_(parameters) {}
+
+  /// Graph of the plan over steps 0..schedule.size()-1, of duration dt.
+  gtsam::NonlinearFactorGraph graph(const ContactSchedule &schedule,
+                                    double dt, const gtsam::Pose3 &wTcom_start,
+                                    const gtsam::Pose3 &wTcom_goal) const;
+
+  /**
+   * Initial values: poses interpolated from start to goal at constant twist,
+   * zero accelerations, and the weight shared by the contacts in stance.
+   */
+  gtsam::Values initialValues(const ContactSchedule &schedule, double dt,
+                              const gtsam::Pose3 &wTcom_start,
+                              const gtsam::Pose3 &wTcom_goal) const;
+
+  /// Optimize the plan from the initial values.
+  gtsam::Values plan(const ContactSchedule &schedule, double dt,
+                     const gtsam::Pose3 &wTcom_start,
+                     const gtsam::Pose3 &wTcom_goal) const;
+
+  /// The model being planned for.
+  const CentroidalModel &model() const { return model_; }
+
+ private:
+  CentroidalModel model_;
+  CentroidalParameters p_;
+};
+
+/**
+ * Initializer of the full kinodynamic problem from a centroidal plan: at each
+ * step, the base link follows the planned body, the joint angles solve
+ * inverse kinematics for the contacts in stance, twists and joint velocities
+ * are finite differences of the poses and joint angles, and the contact
+ * wrenches are the planned forces. Other variables, and steps beyond the
+ * plan, are initialized as in Initializer.
+ */
+class CentroidalInitializer : public Initializer {
+ private:
+  gtsam::Values warm_start_;
+
+ public:
+  /**
+   * Constructor, which solves the kinematics of all steps.
+   * @param robot      the robot
+   * @param model      the centroidal model of the plan
+   * @param schedule   contact schedule of the plan
+   * @param plan       result of CentroidalPlanner::plan
+   * @param dt         duration of the time steps
+   * @param parameters noise models of the inverse kinematics
+   */
+  CentroidalInitializer(
+      const Robot &robot, const CentroidalModel &model,
+      const ContactSchedule &schedule, const gtsam::Values &plan, double dt,
+      const KinematicsParameters &parameters = KinematicsParameters());
+
+  /// Values of all steps derived from the plan.
+  const gtsam::Values &warmStart() const { return warm_start_; }
+
+  gtsam::Values ZeroValues(
+      const Robot &robot, const int t, double gaussian_noise = 0.0,
+      const std::optional<PointOnLinks> &contact_points = {}) const override;
+};
+
+}  // namespace gtdynamics
@@ -13,6 +13,8 @@
 
 #include <gtdynamics/dynamics/Chain.h>
 
+#include <algorithm>
+
 namespace gtdynamics {
 
 Chain operator*(const Chain &chainA, const Chain &chainB) {
@@ -86,6 +88,64 @@ Pose3 Chain::poe(const Vector &q, std::optional<Pose3> fTe,
   return poe;
 }
 
+ChainEvaluation::ChainEvaluation(const Chain &chain,
+                                 const std::optional<Pose3> &fTe)
+    : fTe_(fTe ? *fTe : Pose3()),
+      axes_(chain.axes()),
+      q_(Vector::Zero(chain.length())),
+      exp_(chain.length()),
+      prefix_(chain.length() + 1, chain.sMb()),
+      spatial_axes_(6, chain.length()),
+      valid_(0) {}
+
+void ChainEvaluation::setAngle(size_t i, double q) {
+  if (i >= length()) {
+    throw std::runtime_error("joint index out of range of chain");
+  }
+  if (q == q_(i)) return;
+  q_(i) = q;
+  exp_[i] = Pose3::Expmap(axes_.col(i) * q);
+  // Prefix products after joint i, and spatial axes from i on, are stale.
+  valid_ = std::min(valid_, i);
+}
+
+void ChainEvaluation::setAngles(const Vector &q) {
+  if (static_cast<size_t>(q.size()) != length()) {
+    throw std::runtime_error(
+        "number of angles in q different from number of cols in axes");
+  }
+  for (size_t i = 0; i < length(); ++i) {
+    setAngle(i, q(i));
+  }
+}
+
+void ChainEvaluation::update() {
+  for (size_t i = valid_; i < length(); ++i) {
+    prefix_[i + 1] = prefix_[i].compose(exp_[i]);
+    spatial_axes_.col(i) = prefix_[i + 1].AdjointMap() * axes_.col(i);
+  }
+  valid_ = length();
+}
+
+Pose3 ChainEvaluation::pose() {
+  update();
+  return prefix_.back().compose(fTe_);
+}
+
+Matrix ChainEvaluation::jacobian() {
+  update();
+  return pose().inverse().AdjointMap() * spatial_axes_;
+}
+
+Pose3 ChainEvaluation::poe(const Vector &q,
+                           gtsam::OptionalJacobian<-1, -1> J) {
+  setAngles(q);
+  if (J) {
+    *J = jacobian();
+  }
+  return pose();
+}
+
 /**
  * Calculate AdjointMap jacobian w.r.t. joint coordinate q
  * @param q joint angle
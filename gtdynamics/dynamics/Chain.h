@@ -18,7 +18,10 @@
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 
+#include <array>
 #include <optional>
+#include <stdexcept>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/utils/utils.h"
@@ -134,6 +137,129 @@ class Chain {
                                    const gtsam::Key wrench_key, size_t k);
 };
 
+/**
+ * ChainEvaluation caches the product of exponentials of a chain between
+ * calls, for loops such as IK where consecutive angles differ in only a few
+ * joints. Changing the angle of joint i recomputes only its exponential and
+ * the prefix products from i on; the Jacobian is kept in the spatial frame,
+ * where column j depends only on the joints before j, and is then moved to
+ * the end-effector frame with a single adjoint.
+ */
+class ChainEvaluation {
+ private:
+  Pose3 fTe_;            // end-effector pose with respect to final link.
+  Matrix axes_;          // screw axes in body frame, as in Chain.
+  Vector q_;             // current joint angles.
+  std::vector<Pose3> exp_;     // exp_[i] = Expmap(axes_.col(i) * q_(i)).
+  std::vector<Pose3> prefix_;  // prefix_[i] = sMb * exp_[0] ... exp_[i-1].
+  Matrix spatial_axes_;  // column i is Ad(prefix_[i + 1]) * axes_.col(i).
+  size_t valid_;         // prefix_[0..valid_] and columns < valid_ are valid.
+
+  /// Recompute stale prefix products and spatial axes.
+  void update();
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor, with all angles at zero.
+   * @param chain ......... The chain to evaluate
+   * @param fTe ........... The end-effector pose with respect to final link
+   * (Optional)
+   */
+  explicit ChainEvaluation(const Chain &chain,
+                           const std::optional<Pose3> &fTe = {});
+
+  /// Return number of joints.
+  size_t length() const { return axes_.cols(); }
+
+  /// Return current joint angles.
+  const Vector &angles() const { return q_; }
+
+  /// Set the angle of joint i.
+  void setAngle(size_t i, double q);
+
+  /// Set all angles, recomputing only joints whose angle changed.
+  void setAngles(const Vector &q);
+
+  /// Return pose of the end-effector for the current angles.
+  Pose3 pose();
+
+  /// Return Jacobian for the current angles, as computed by Chain::poe.
+  Matrix jacobian();
+
+  /**
+   * Set all angles and return the same as Chain::poe.
+   * @param q ........... Input angles for all joints
+   * @param(out) J....... Jacobian in the end-effector frame (Optional)
+   * @return ............ Pose of the end-effector
+   */
+  Pose3 poe(const Vector &q, gtsam::OptionalJacobian<-1, -1> J = {});
+};
+
+/**
+ * Chain with a fixed number of joints N, so that its screw axes and Jacobian
+ * are fixed-size matrices and forward kinematics does not allocate.
+ */
+template <int N>
+class FixedChain {
+ public:
+  using Axes = Eigen::Matrix<double, 6, N>;
+  using Angles = Eigen::Matrix<double, N, 1>;
+
+ private:
+  Pose3 sMb_;  // rest pose of "body" with respect to "spatial" frame.
+  Axes axes_;  // screw axes of all joints in the chain expressed in body frame.
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Constructor
+  FixedChain(const Pose3 &sMb, const Axes &axes) : sMb_(sMb), axes_(axes) {}
+
+  /// Construct from a chain with N joints.
+  explicit FixedChain(const Chain &chain)
+      : sMb_(chain.sMb()),
+        axes_(chain.length() == N
+                  ? Axes(chain.axes())
+                  : throw std::runtime_error(
+                        "number of joints in chain different from N")) {}
+
+  // Return sMb.
+  const Pose3 &sMb() const { return sMb_; }
+
+  // Return screw axes.
+  const Axes &axes() const { return axes_; }
+
+  /**
+   * Perform forward kinematics given q, as Chain::poe.
+   * @param q ........... Input angles for all joints
+   * @param fTe ......... The end-effector pose with respect to final link
+   * (Optional)
+   * @param(out) J....... Jacobian in the end-effector frame (Optional)
+   * @return ............ Pose of the end-effector
+   */
+  Pose3 poe(const Angles &q, const std::optional<Pose3> &fTe = {},
+            gtsam::OptionalJacobian<6, N> J = {}) const {
+    std::array<Pose3, N> exp;
+    Pose3 poe = sMb_;
+    for (int i = 0; i < N; ++i) {
+      exp[i] = Pose3::Expmap(axes_.col(i) * q(i));
+      poe = poe.compose(exp[i]);
+    }
+    if (J) {
+      // Column i is axis i expressed in the end-effector frame, i.e.,
+      // adjointed by the inverse of the transforms that follow joint i.
+      Pose3 suffix = fTe ? *fTe : Pose3();
+      for (int i = N - 1; i >= 0; --i) {
+        J->col(i) = suffix.inverse().AdjointMap() * axes_.col(i);
+        suffix = exp[i].compose(suffix);
+      }
+    }
+    return fTe ? poe.compose(*fTe) : poe;
+  }
+};
+
 // Helper function to create expression with a vector, used in
 // ChainConstraint3.
 gtsam::Vector3 MakeVector3(const double &value0, const double &value1,
@@ -0,0 +1,384 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedChainDynamics.cpp
+ * @brief Kinematics and inverse dynamics of closed chains, on a spanning tree
+ * with cut joints.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/ClosedChainDynamics.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/values.h>
+
+#include <Eigen/QR>
+
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+/**
+ * Copy of the robot without the joints which close a loop, found with the
+ * breadth-first search of RecursiveDynamics. A joint reaching a second fixed
+ * link also closes a loop, through the ground.
+ */
+Robot SpanningTree(const Robot &robot) {
+  Robot tree = robot.clone();
+  std::set<std::string> visited, cut;
+  auto bfs = [&](const LinkSharedPtr &root) {
+    std::queue<std::pair<LinkSharedPtr, JointSharedPtr>> q;
+    visited.insert(root->name());
+    q.emplace(root, nullptr);
+    while (!q.empty()) {
+      const auto [link, parent_joint] = q.front();
+      q.pop();
+      for (auto &&joint : link->joints()) {
+        if (joint == parent_joint || cut.count(joint->name())) continue;
+        const LinkSharedPtr other = joint->otherLink(link);
+        if (visited.count(other->name()) || other->isFixed()) {
+          cut.insert(joint->name());
+          continue;
+        }
+        visited.insert(other->name());
+        q.emplace(other, joint);
+      }
+    }
+  };
+  for (auto &&link : tree.links()) {
+    if (link->isFixed() && !visited.count(link->name())) bfs(link);
+  }
+  for (auto &&link : tree.links()) {
+    if (!visited.count(link->name())) bfs(link);
+  }
+  for (auto &&name : cut) tree.removeJoint(tree.joint(name));
+  return tree;
+}
+}  // namespace
+
+/* ************************************************************************* */
+ClosedChainDynamics::ClosedChainDynamics(
+    const Robot &robot, const std::optional<gtsam::Vector3> &gravity,
+    size_t max_iterations, double tolerance)
+    : robot_(robot),
+      tree_(SpanningTree(robot)),
+      dynamics_(tree_, gravity),
+      max_iterations_(max_iterations),
+      tolerance_(tolerance) {
+  for (auto &&joint : robot_.joints()) {
+    num_joints_ = std::max<size_t>(num_joints_, joint->id() + 1);
+    const auto &tree_joints = tree_.joints();
+    const bool in_tree =
+        std::any_of(tree_joints.begin(), tree_joints.end(),
+                    [&](const JointSharedPtr &tree_joint) {
+                      return tree_joint->name() == joint->name();
+                    });
+    if (!in_tree) cut_joints_.push_back(joint);
+  }
+
+  const auto &links = dynamics_.links();
+  size_t num_link_ids = 0;
+  for (auto &&link : links) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  link_indices_.assign(num_link_ids, -1);
+  for (size_t k = 0; k < links.size(); ++k) link_indices_[links[k]->id()] = k;
+  poses_.resize(links.size());
+  twists_.resize(links.size());
+  accels_.resize(links.size());
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::computeKinematics(const Vector &q,
+                                            const Vector &v) const {
+  const auto &links = dynamics_.links();
+  for (size_t k = 0; k < links.size(); ++k) {
+    const int p = dynamics_.parentIndex(k);
+    if (p < 0) {
+      poses_[k] = links[k]->isFixed() ? links[k]->getFixedPose() : Pose3();
+      twists_[k].setZero();
+      continue;
+    }
+    const auto &joint = dynamics_.parentJoint(k);
+    const int j = joint->id();
+    std::tie(poses_[k], twists_[k]) =
+        joint->otherPoseTwist(links[p], poses_[p], twists_[p], q(j), v(j));
+  }
+}
+
+/* ************************************************************************* */
+Pose3 ClosedChainDynamics::closurePose(size_t i, const Vector &q) const {
+  const auto &joint = cut_joints_[i];
+  return poses_[link_indices_[joint->parent()->id()]] *
+         joint->parentTchild(q(joint->id()));
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::addBodyJacobian(size_t k, const Pose3 &wTf,
+                                          const Matrix6 &s,
+                                          Eigen::Ref<Matrix> dst) const {
+  // A joint of an ancestor c moves the frame by Ad(wTf^-1 * wTc) * S_c.
+  const auto &links = dynamics_.links();
+  for (int c = k; dynamics_.parentIndex(c) >= 0;
+       c = dynamics_.parentIndex(c)) {
+    const auto &joint = dynamics_.parentJoint(c);
+    dst.col(joint->id()) += s * wTf.between(poses_[c]).AdjointMap() *
+                            joint->screwAxis(links[c]);
+  }
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::loopConstraints(const Vector &q, Vector *error,
+                                          Matrix *J) const {
+  computeKinematics(q, Vector::Zero(num_joints_));
+  const size_t m = cut_joints_.size();
+  error->resize(6 * m);
+  J->setZero(6 * m, num_joints_);
+  for (size_t i = 0; i < m; ++i) {
+    const auto &joint = cut_joints_[i];
+    const size_t b = link_indices_[joint->child()->id()];
+    const size_t a = link_indices_[joint->parent()->id()];
+    const Pose3 &wTb = poses_[b];
+    const Pose3 wTc = closurePose(i, q);
+    error->segment<6>(6 * i) = Pose3::Logmap(wTc.between(wTb));
+
+    // d(error) = body twist of b - Ad(bTc) * body twist of the closure frame.
+    const Matrix6 Ad_bc = wTb.between(wTc).AdjointMap();
+    auto rows = J->middleRows<6>(6 * i);
+    addBodyJacobian(b, wTb, Matrix6::Identity(), rows);
+    addBodyJacobian(a, wTc, -Ad_bc, rows);
+    rows.col(joint->id()) -= Ad_bc * joint->cScrewAxis();
+  }
+}
+
+/* ************************************************************************* */
+Vector ClosedChainDynamics::accelerationBias(const Vector &q,
+                                             const Vector &v) const {
+  // Twist accelerations at zero joint accelerations.
+  const auto &links = dynamics_.links();
+  for (size_t k = 0; k < links.size(); ++k) {
+    const int p = dynamics_.parentIndex(k);
+    if (p < 0) {
+      accels_[k].setZero();
+      continue;
+    }
+    const auto &joint = dynamics_.parentJoint(k);
+    accels_[k] = poses_[k].between(poses_[p]).AdjointMap() * accels_[p] +
+                 Pose3::adjointMap(twists_[k]) * joint->screwAxis(links[k]) *
+                     v(joint->id());
+  }
+
+  // The same through each cut joint, in the closure frame.
+  const size_t m = cut_joints_.size();
+  Vector bias(6 * m);
+  for (size_t i = 0; i < m; ++i) {
+    const auto &joint = cut_joints_[i];
+    const size_t b = link_indices_[joint->child()->id()];
+    const size_t a = link_indices_[joint->parent()->id()];
+    const Pose3 wTc = closurePose(i, q);
+    const Matrix6 Ad_ca = wTc.between(poses_[a]).AdjointMap();
+    const Vector6 S_c = joint->cScrewAxis() * v(joint->id());
+    const Vector6 V_c = Ad_ca * twists_[a] + S_c;
+    const Vector6 A_c = Ad_ca * accels_[a] + Pose3::adjointMap(V_c) * S_c;
+    bias.segment<6>(6 * i) =
+        accels_[b] - poses_[b].between(wTc).AdjointMap() * A_c;
+  }
+  return bias;
+}
+
+/* ************************************************************************* */
+Values ClosedChainDynamics::forwardKinematics(int t,
+                                              const Values &known_values,
+                                              const Values &initial) const {
+  Vector q = Vector::Zero(num_joints_), v = Vector::Zero(num_joints_);
+  std::vector<int> unknown;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    if (known_values.exists(JointAngleKey(j, t))) {
+      q(j) = JointAngle(known_values, j, t);
+      if (known_values.exists(JointVelKey(j, t))) {
+        v(j) = JointVel(known_values, j, t);
+      }
+    } else {
+      unknown.push_back(j);
+      if (initial.exists(JointAngleKey(j, t))) {
+        q(j) = JointAngle(initial, j, t);
+      }
+    }
+  }
+
+  // Gauss-Newton on the loop closure errors, in the unknown angles.
+  Vector error;
+  Matrix J, J_u(6 * cut_joints_.size(), unknown.size());
+  auto selectUnknown = [&]() {
+    for (size_t u = 0; u < unknown.size(); ++u) J_u.col(u) = J.col(unknown[u]);
+  };
+  for (size_t iteration = 0;; ++iteration) {
+    loopConstraints(q, &error, &J);
+    if (error.norm() <= tolerance_) break;
+    if (iteration == max_iterations_ || unknown.empty()) {
+      throw std::runtime_error(
+          "ClosedChainDynamics::forwardKinematics: the loops do not close.");
+    }
+    selectUnknown();
+    const Vector delta = J_u.completeOrthogonalDecomposition().solve(error);
+    for (size_t u = 0; u < unknown.size(); ++u) q(unknown[u]) -= delta(u);
+  }
+
+  // Velocities, from J * v = 0.
+  if (!unknown.empty()) {
+    selectUnknown();
+    const Vector v_u =
+        J_u.completeOrthogonalDecomposition().solve(-(J * v).eval());
+    for (size_t u = 0; u < unknown.size(); ++u) v(unknown[u]) = v_u(u);
+  }
+  if ((J * v).norm() > tolerance_ * (1.0 + v.norm())) {
+    throw std::invalid_argument(
+        "ClosedChainDynamics::forwardKinematics: the known velocities violate "
+        "the loop closures.");
+  }
+  computeKinematics(q, v);
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      if (!values.exists(JointAngleKey(j, t))) {
+        InsertJointAngle(&values, j, t, q(j));
+      }
+      if (!values.exists(JointVelKey(j, t))) {
+        InsertJointVel(&values, j, t, v(j));
+      }
+    }
+    const auto &links = dynamics_.links();
+    for (size_t k = 0; k < links.size(); ++k) {
+      InsertPose(&values, links[k]->id(), t, poses_[k]);
+      InsertTwist(&values, links[k]->id(), t, twists_[k]);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "ClosedChainDynamics::forwardKinematics: known_values should contain "
+        "no poses or twists.");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values ClosedChainDynamics::inverseDynamics(
+    int t, const Values &known_values,
+    const std::optional<std::vector<int>> &actuated) const {
+  Vector q = Vector::Zero(num_joints_), v = Vector::Zero(num_joints_),
+         qdd = Vector::Zero(num_joints_);
+  std::vector<int> unknown;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    q(j) = JointAngle(known_values, j, t);
+    v(j) = JointVel(known_values, j, t);
+    if (known_values.exists(JointAccelKey(j, t))) {
+      qdd(j) = JointAccel(known_values, j, t);
+    } else {
+      unknown.push_back(j);
+    }
+  }
+
+  // Accelerations, from J * qdd + bias = 0.
+  Vector error;
+  Matrix J;
+  loopConstraints(q, &error, &J);
+  computeKinematics(q, v);
+  if (!unknown.empty()) {
+    Matrix J_u(J.rows(), unknown.size());
+    for (size_t u = 0; u < unknown.size(); ++u) J_u.col(u) = J.col(unknown[u]);
+    const Vector rhs = -(accelerationBias(q, v) + J * qdd);
+    const Vector qdd_u = J_u.completeOrthogonalDecomposition().solve(rhs);
+    for (size_t u = 0; u < unknown.size(); ++u) qdd(unknown[u]) = qdd_u(u);
+  }
+
+  // Torques of the tree, which has no torques for the cut joints.
+  const size_t n = dynamics_.numJoints();
+  Matrix M(n, n);
+  Vector h(n);
+  const Vector q_tree = q.head(n), v_tree = v.head(n);
+  dynamics_.massMatrix(q_tree, &M);
+  dynamics_.biasTorques(q_tree, v_tree, &h);
+  Vector tau = Vector::Zero(num_joints_);
+  tau.head(n) = M * qdd.head(n) + h;
+
+  // Constraint wrenches, tau = tau_tree - J^T * lambda, with zero torques
+  // for the joints which are not actuated, or else of minimum norm.
+  std::vector<int> passive;
+  if (actuated) {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      if (std::find(actuated->begin(), actuated->end(), j) == actuated->end()) {
+        passive.push_back(j);
+      }
+    }
+  }
+  Vector lambda;
+  if (passive.empty()) {
+    lambda = J.transpose().completeOrthogonalDecomposition().solve(tau);
+  } else {
+    Matrix Jt_p(passive.size(), J.rows());
+    Vector tau_p(passive.size());
+    for (size_t u = 0; u < passive.size(); ++u) {
+      Jt_p.row(u) = J.col(passive[u]).transpose();
+      tau_p(u) = tau(passive[u]);
+    }
+    lambda = Jt_p.completeOrthogonalDecomposition().solve(tau_p);
+    if ((Jt_p * lambda - tau_p).norm() > 1e-6 * (1.0 + tau.norm())) {
+      throw std::invalid_argument(
+          "ClosedChainDynamics::inverseDynamics: the motion needs torques on "
+          "joints which are not actuated.");
+    }
+  }
+  tau -= J.transpose() * lambda;
+  for (int j : passive) tau(j) = 0.0;
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (int j : unknown) InsertJointAccel(&values, j, t, qdd(j));
+    for (auto &&joint : robot_.joints()) {
+      InsertTorque(&values, joint->id(), t, tau(joint->id()));
+    }
+    for (size_t i = 0; i < cut_joints_.size(); ++i) {
+      const auto &joint = cut_joints_[i];
+      const int j = joint->id();
+      const int i1 = joint->parent()->id(), i2 = joint->child()->id();
+      const Vector6 F_2 = lambda.segment<6>(6 * i);
+      const Pose3 T_21 =
+          poses_[link_indices_[i2]].between(poses_[link_indices_[i1]]);
+      InsertWrench(&values, i2, j, t, F_2);
+      InsertWrench(&values, i1, j, t, -T_21.AdjointMap().transpose() * F_2);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "ClosedChainDynamics::inverseDynamics: known_values should contain no "
+        "torques or wrenches.");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
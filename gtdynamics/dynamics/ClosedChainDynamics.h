@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedChainDynamics.h
+ * @brief Kinematics and inverse dynamics of closed chains, on a spanning tree
+ * with cut joints.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ClosedChainDynamics handles mechanisms with kinematic loops, e.g. four-bar
+ * linkages, without optimizing a nonlinear factor graph.
+ *
+ * A spanning tree of the robot is found once, with the same breadth-first
+ * search as RecursiveDynamics: every joint that would close a loop is a cut
+ * joint, and the tree is the robot without its cut joints. Each cut joint
+ * then gives a 6-dimensional loop closure constraint, that the pose of its
+ * child link computed through the tree and the pose computed through the cut
+ * joint from its parent link agree.
+ *
+ * Forward kinematics solves the loop closure constraints for the joint angles
+ * which are not given with a small Gauss-Newton iteration, in the joint angles
+ * only, and the velocity and acceleration constraints are linear. Inverse
+ * dynamics computes the torques of the tree with RecursiveDynamics, and adds
+ * the constraint wrenches which the cut joints exert to close the loops.
+ *
+ * Joint vectors are indexed by joint id, and all loop constraint matrices have
+ * six rows per cut joint, in the order of cutJoints(). As in
+ * RecursiveDynamics, fixed links are at their fixed pose and floating roots at
+ * the identity, so a prior link of a floating base is not supported. Pose and
+ * velocity constraints of a planar mechanism have only three independent rows
+ * per loop; the solves are least-squares and minimum-norm, so this is handled
+ * without selecting coordinates.
+ */
+class ClosedChainDynamics {
+ private:
+  Robot robot_, tree_;
+  RecursiveDynamics dynamics_;
+
+  /// Joints of robot_ closing a loop, not in the tree.
+  std::vector<JointSharedPtr> cut_joints_;
+
+  /// Traversal index, in dynamics_.links(), of each link id.
+  std::vector<int> link_indices_;
+
+  /// Largest joint id of the robot plus one.
+  size_t num_joints_ = 0;
+
+  size_t max_iterations_;
+  double tolerance_;
+
+  /// Work buffers, in traversal order.
+  mutable std::vector<gtsam::Pose3> poses_;
+  mutable std::vector<gtsam::Vector6> twists_, accels_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot          the robot
+   * @param gravity        gravity in world frame
+   * @param max_iterations maximum number of Gauss-Newton iterations
+   * @param tolerance      largest loop closure error of a solution
+   */
+  explicit ClosedChainDynamics(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {},
+      size_t max_iterations = 20, double tolerance = 1e-9);
+
+  /**
+   * Solve the loop closures, and compute poses and twists.
+   *
+   * @param t            time step
+   * @param known_values joint angles and velocities of the independent joints
+   * at time t; missing velocities are zero
+   * @param initial      initial estimate of the other joint angles, which
+   * selects the assembly mode of a loop; missing angles start at zero
+   * @return known_values with the angles and velocities of all joints, and
+   * the poses and twists of all links added. Throws if the loops cannot be
+   * closed.
+   */
+  gtsam::Values forwardKinematics(
+      int t, const gtsam::Values &known_values,
+      const gtsam::Values &initial = gtsam::Values()) const;
+
+  /**
+   * Solve inverse dynamics with loop constraint wrenches.
+   *
+   * A mechanism with loops can have more actuated joints than degrees of
+   * freedom. If actuated joints are given, all other torques are zero;
+   * otherwise all joints are actuated and the torques of minimum norm are
+   * returned, as with a MinTorqueFactor on every joint.
+   *
+   * @param t            time step
+   * @param known_values joint angles and velocities of all joints, e.g. from
+   * forwardKinematics, and accelerations of the independent joints at time t
+   * @param actuated     ids of the actuated joints
+   * @return known_values with the accelerations of all joints, the torques of
+   * all joints, and the wrenches of the cut joints on both of their links
+   * added.
+   */
+  gtsam::Values inverseDynamics(
+      int t, const gtsam::Values &known_values,
+      const std::optional<std::vector<int>> &actuated = {}) const;
+
+  /**
+   * Residuals and Jacobian of the loop closure constraints at joint angles q.
+   * The residual of a cut joint is the logarithm of the pose of its child
+   * link, through the tree, in the frame of the child link through the cut
+   * joint. The Jacobian is exact where the loops are closed, and is then also
+   * the matrix of the velocity constraints J * v = 0.
+   */
+  void loopConstraints(const gtsam::Vector &q, gtsam::Vector *error,
+                       gtsam::Matrix *J) const;
+
+  /// Return the joints of the robot which are cut to make the tree.
+  const std::vector<JointSharedPtr> &cutJoints() const { return cut_joints_; }
+
+  /// Return the spanning tree, a copy of the robot without the cut joints.
+  const Robot &tree() const { return tree_; }
+
+  /// Return the size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return num_joints_; }
+
+ private:
+  /// Compute poses and twists in traversal order into the buffers.
+  void computeKinematics(const gtsam::Vector &q, const gtsam::Vector &v) const;
+
+  /// Pose of the child link of the i-th cut joint, through the cut joint.
+  gtsam::Pose3 closurePose(size_t i, const gtsam::Vector &q) const;
+
+  /**
+   * Add s times the body Jacobian of a frame with pose wTf, rigidly attached
+   * to the k-th link in traversal order, to the columns of dst.
+   */
+  void addBodyJacobian(size_t k, const gtsam::Pose3 &wTf,
+                       const gtsam::Matrix6 &s,
+                       Eigen::Ref<gtsam::Matrix> dst) const;
+
+  /**
+   * Loop constraint accelerations at zero joint accelerations, from the
+   * poses and twists in the buffers, such that J * qdd + bias = 0.
+   */
+  gtsam::Vector accelerationBias(const gtsam::Vector &q,
+                                 const gtsam::Vector &v) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.cpp
+ * @brief Simulate floating-base robots with contact-constrained dynamics.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/values.h>
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ContactSimulator::ContactSimulator(const Robot &robot,
+                                   const std::string &base_name,
+                                   const Values &initial_values,
+                                   const std::optional<gtsam::Vector3> &gravity)
+    : robot_(robot),
+      base_name_(base_name),
+      graph_builder_(gravity),
+      initial_values_(initial_values) {
+  reset();
+}
+
+/* ************************************************************************* */
+void ContactSimulator::reset() {
+  const auto base = robot_.link(base_name_);
+  const int i = base->id();
+  base_pose_ = initial_values_.exists(PoseKey(i))
+                   ? Pose(initial_values_, i)
+                   : base->bMcom();
+  base_twist_ = initial_values_.exists(TwistKey(i))
+                    ? Twist(initial_values_, i)
+                    : Vector6(Vector6::Zero());
+  joint_state_ = Values();
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&joint_state_, j,
+                     initial_values_.exists(JointAngleKey(j))
+                         ? JointAngle(initial_values_, j)
+                         : 0.0);
+    InsertJointVel(&joint_state_, j,
+                   initial_values_.exists(JointVelKey(j))
+                       ? JointVel(initial_values_, j)
+                       : 0.0);
+  }
+  current_values_ = Values();
+}
+
+/* ************************************************************************* */
+void ContactSimulator::setContacts(const FootContactConstraintSpec &contacts) {
+  contact_points_ = contacts.contactPoints();
+}
+
+/* ************************************************************************* */
+void ContactSimulator::step(const Values &torques, double dt) {
+  // Forward kinematics from the base.
+  const int base_id = robot_.link(base_name_)->id();
+  Values values = joint_state_;
+  InsertPose(&values, base_id, base_pose_);
+  InsertTwist(&values, base_id, base_twist_);
+  values = robot_.forwardKinematics(values, 0, base_name_);
+  for (auto &&joint : robot_.joints()) {
+    InsertTorque(&values, joint->id(), Torque(torques, joint->id()));
+  }
+
+  // Contact-constrained forward dynamics.
+  current_values_ =
+      graph_builder_.linearSolveFD(robot_, 0, values, contact_points_);
+
+  // Integrate joints and base with a Taylor step. Twists are expressed in the
+  // base CoM frame, so the base pose is updated on the right.
+  const double dt2 = dt * dt;
+  joint_state_ = Values();
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    const double q = JointAngle(current_values_, j);
+    const double v = JointVel(current_values_, j);
+    const double a = JointAccel(current_values_, j);
+    InsertJointAngle(&joint_state_, j, q + dt * v + 0.5 * a * dt2);
+    InsertJointVel(&joint_state_, j, v + dt * a);
+  }
+  const Vector6 A = TwistAccel(current_values_, base_id);
+  base_pose_ = base_pose_ * Pose3::Expmap(dt * base_twist_ + 0.5 * dt2 * A);
+  base_twist_ += dt * A;
+}
+
+/* ************************************************************************* */
+Values ContactSimulator::simulate(const std::vector<Values> &torques_seq,
+                                  double dt) {
+  for (const auto &torques : torques_seq) {
+    step(torques, dt);
+  }
+  return current_values_;
+}
+
+}  // namespace gtdynamics
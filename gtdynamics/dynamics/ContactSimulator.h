@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.h
+ * @brief Simulate floating-base robots with contact-constrained dynamics.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ContactSimulator simulates a floating-base robot, e.g. a legged robot,
+ * whose state is the pose and twist of a base link plus joint angles and
+ * velocities. Each step solves linear forward dynamics with the contacts of
+ * the current FootContactConstraintSpec: contact points have zero linear
+ * acceleration and exert a pure force on their link.
+ *
+ * The elimination ordering is cached per contact mode by DynamicsGraph, so
+ * switching contacts only costs a new ordering the first time a mode is seen.
+ * The contact constraints act on accelerations only, so initial contact point
+ * velocities should be zero. Friction cones are not checked.
+ */
+class ContactSimulator {
+ private:
+  Robot robot_;
+  std::string base_name_;
+  DynamicsGraph graph_builder_;
+  std::optional<PointOnLinks> contact_points_;
+
+  // State: base pose and twist, joint angles and velocities.
+  gtsam::Values initial_values_;
+  gtsam::Pose3 base_pose_;
+  gtsam::Vector6 base_twist_;
+  gtsam::Values joint_state_;
+
+  // Result of the last forward dynamics solve.
+  gtsam::Values current_values_;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param robot          the robot
+   * @param base_name      name of the floating base link
+   * @param initial_values initial joint angles and velocities, plus optionally
+   * the base pose and twist at time 0 (defaults: rest pose, zero twist)
+   * @param gravity        gravity in world frame
+   */
+  ContactSimulator(const Robot &robot, const std::string &base_name,
+                   const gtsam::Values &initial_values,
+                   const std::optional<gtsam::Vector3> &gravity = {});
+
+  /// Reset the state to the initial values.
+  void reset();
+
+  /// Set the contacts to use from the next step on.
+  void setContacts(const FootContactConstraintSpec &contacts);
+
+  /// Remove all contacts, e.g. for a flight phase.
+  void clearContacts() { contact_points_.reset(); }
+
+  /**
+   * Simulate for one time step, integrating with an explicit Taylor step.
+   * @param torques torques for all joints at time 0
+   * @param dt duration for the time step
+   */
+  void step(const gtsam::Values &torques, double dt);
+
+  /// Simulate for the specified sequence of torques.
+  gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
+                         double dt);
+
+  /// Return the values of the last dynamics solve, at time 0.
+  const gtsam::Values &getValues() const { return current_values_; }
+
+  /// Return the current base pose.
+  const gtsam::Pose3 &basePose() const { return base_pose_; }
+
+  /// Return the current base twist.
+  const gtsam::Vector6 &baseTwist() const { return base_twist_; }
+};
+
+}  // namespace gtdynamics
@@ -11,25 +11,43 @@
  * @author Yetong Zhang, Alejandro Escontrela
  */
 
+#include <gtdynamics/config.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/dynamics/SparseDynamics.h>
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
 #include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
 #include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
 #include <gtdynamics/factors/ContactHeightFactor.h>
 #include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
 #include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/factors/FrictionConesFactor.h>
+#include <gtdynamics/factors/JointFactors.h>
+#include <gtdynamics/factors/JointsCollocationFactor.h>
+#include <gtdynamics/factors/JointsObjectiveFactors.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/KeyEncoding.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/expressions.h>
 #include <gtsam/slam/PriorFactor.h>
 
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <string>
+#include <tuple>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -50,9 +68,11 @@ using gtsam::Z_6x1;
 namespace gtdynamics {
 
 GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
-    const Robot &robot, const int t, const gtsam::Values &known_values) {
+    const Robot &robot, const int t, const gtsam::Values &known_values,
+    const std::optional<PointOnLinks> &contact_points) const {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(6);
+  auto all_constrained = InternedConstrained(6);
+  auto constrained_3 = InternedConstrained(3);
   for (auto &&link : robot.links()) {
     int i = link->id();
     if (link->isFixed()) {
@@ -61,32 +81,41 @@ GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
       graph.add(TwistAccelKey(i, t), I_6x6, Z_6x1, all_constrained);
     } else {
       // wrench factor
-      // G_i * A_i - F_i_j1 - .. - F_i_jn  = ad(V_i)^T * G_i * V*i + m_i * R_i^T
-      // * g
+      // G_i * A_i - F_i_j1 - .. - F_i_jn - C_i_c1 - .. = ad(V_i)^T * G_i * V*i
+      // + m_i * R_i^T * g
       const auto &connected_joints = link->joints();
-      const gtsam::Matrix6 G_i = link->inertiaMatrix();
-      const double m_i = link->mass();
-      const Pose3 T_wi = Pose(known_values, i, t);
+      const gtsam::Matrix6 &G_i = link->inertiaMatrix();
       const Vector6 V_i = Twist(known_values, i, t);
       Vector6 rhs = Pose3::adjointMap(V_i).transpose() * G_i * V_i;
       if (gravity_) {
-        Vector gravitational_force =
-            T_wi.rotation().transpose() * (*gravity_) * m_i;
-        for (int i = 3; i < 6; ++i) {
-          rhs[i] += gravitational_force[i - 3];
-        }
+        rhs += link->gravityWrench(*gravity_, Pose(known_values, i, t));
       }
       auto accel_key = TwistAccelKey(i, t);
-      if (connected_joints.size() == 0) {
-        graph.add(accel_key, G_i, rhs, all_constrained);
-      } else if (connected_joints.size() == 1) {
-        graph.add(accel_key, G_i, WrenchKey(i, connected_joints[0]->id(), t),
-                  -I_6x6, rhs, all_constrained);
-      } else if (connected_joints.size() == 2) {
-        graph.add(accel_key, G_i, WrenchKey(i, connected_joints[0]->id(), t),
-                  -I_6x6, WrenchKey(i, connected_joints[1]->id(), t), -I_6x6,
-                  rhs, all_constrained);
+      std::vector<std::pair<Key, gtsam::Matrix>> terms;
+      terms.emplace_back(accel_key, G_i);
+      for (auto &&joint : connected_joints) {
+        terms.emplace_back(WrenchKey(i, joint->id(), t), -I_6x6);
+      }
+
+      // Contact points: zero linear acceleration at the contact, and a
+      // contact wrench without moment about the contact point.
+      if (contact_points) {
+        int c = 0;
+        for (auto &&cp : *contact_points) {
+          if (cp.link->id() != i) continue;
+          const auto wrench_key = ContactWrenchKey(i, c++, t);
+          terms.emplace_back(wrench_key, -I_6x6);
+          const Pose3 cTcom(gtsam::Rot3(), -cp.point);
+          const gtsam::Matrix6 Ad = cTcom.AdjointMap();
+          graph.add(accel_key, Ad.bottomRows<3>(), gtsam::Vector3::Zero(),
+                    constrained_3);
+          const gtsam::Matrix6 AdInvT =
+              cTcom.inverse().AdjointMap().transpose();
+          graph.add(wrench_key, AdInvT.topRows<3>(), gtsam::Vector3::Zero(),
+                    constrained_3);
+        }
       }
+      graph.add(terms, rhs, all_constrained);
     }
   }
 
@@ -102,17 +131,25 @@ GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
 
 GaussianFactorGraph DynamicsGraph::linearFDPriors(
     const Robot &robot, const int t, const gtsam::Values &torques) {
-  OptimizerSetting opt_ = OptimizerSetting();
+  static const OptimizerSetting opt_;
   GaussianFactorGraph graph;
-  for (auto &&joint : robot.joints())
-    graph.push_back(joint->linearFDPriors(t, torques, opt_));
+  auto all_constrained = InternedConstrained(1);
+  for (auto &&joint : robot.joints()) {
+    if (joint->type() == Joint::Type::Fixed) {
+      // A fixed joint transmits any torque, its acceleration is zero instead.
+      graph.add(JointAccelKey(joint->id(), t), I_1x1, gtsam::Vector1::Zero(),
+                all_constrained);
+    } else {
+      graph.push_back(joint->linearFDPriors(t, torques, opt_));
+    }
+  }
   return graph;
 }
 
 GaussianFactorGraph DynamicsGraph::linearIDPriors(
     const Robot &robot, const int t, const gtsam::Values &joint_accels) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(1);
+  auto all_constrained = InternedConstrained(1);
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     double accel = JointAccel(joint_accels, j, t);
@@ -122,13 +159,91 @@ GaussianFactorGraph DynamicsGraph::linearIDPriors(
   return graph;
 }
 
-Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
-                                    const gtsam::Values &known_values) {
+/// Return the same key at a different time step.
+static gtsam::Key KeyAtTime(gtsam::Key key, uint64_t t) {
+  return DynamicsKeyEncoding::WithTime(key, t);
+}
+
+/**
+ * Return whether key looks like a DynamicsSymbol at time step t: a label of
+ * one or two letters, where a plain gtsam::Symbol has its character in the
+ * first byte and zero or index bits in the second.
+ */
+static bool IsDynamicsKeyAt(gtsam::Key key, uint64_t t) {
+  const uint8_t c1 = DynamicsKeyEncoding::Char1(key);
+  const uint8_t c2 = DynamicsKeyEncoding::Char2(key);
+  return std::isalpha(c2) && (c1 == 0 || std::isalpha(c1)) &&
+         DynamicsKeyEncoding::Time(key) == t;
+}
+
+gtsam::VectorValues DynamicsGraph::optimizeCached(
+    const GaussianFactorGraph &graph, int t, OrderingCache *cache) {
+  // Orderings are shared between time steps by moving keys to time 0, which
+  // only works if all keys are DynamicsSymbols at time step t. Graphs with
+  // other keys, e.g. added by the caller, get a plain COLAMD ordering.
+  const gtsam::KeySet key_set = graph.keys();
+  for (auto &&key : key_set) {
+    if (!IsDynamicsKeyAt(key, t)) {
+      return graph.optimize(gtsam::Ordering::Colamd(graph));
+    }
+  }
+
+  // All keys are at the same time step, so the keys at time 0 are sorted the
+  // same way as the original keys.
+  gtsam::KeyVector keys;
+  keys.reserve(key_set.size());
+  for (auto &&key : key_set) keys.push_back(KeyAtTime(key, 0));
+
+  // Solve outside the lock, so threads only serialize on the lookups.
+  std::optional<gtsam::Ordering> cached;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto it = cache->orderings.find(keys);
+    if (it != cache->orderings.end()) cached = it->second;
+  }
+  if (!cached) {
+    const gtsam::Ordering ordering = gtsam::Ordering::Colamd(graph);
+    gtsam::Ordering at_zero;
+    for (auto &&key : ordering) at_zero.push_back(KeyAtTime(key, 0));
+    {
+      std::lock_guard<std::mutex> lock(cache->mutex);
+      cache->orderings.emplace(keys, std::move(at_zero));
+    }
+    return graph.optimize(ordering);
+  }
+
+  if (t == 0) return graph.optimize(*cached);
+  gtsam::Ordering ordering;
+  for (auto &&key : *cached) ordering.push_back(KeyAtTime(key, t));
+  return graph.optimize(ordering);
+}
+
+Values DynamicsGraph::linearSolveFD(
+    const Robot &robot, const int t, const gtsam::Values &known_values,
+    const std::optional<PointOnLinks> &contact_points) const {
+  if (linear_solver_ == Recursive && !contact_points) {
+    auto solver = recursive_solvers_.acquire(robot, [&] {
+      return std::make_shared<RecursiveDynamics>(robot, gravity_);
+    });
+    Values values = solver->forwardDynamics(t, known_values);
+    recursive_solvers_.release(std::move(solver));
+    return values;
+  }
+  if (linear_solver_ == Sparse && !contact_points) {
+    auto solver = sparse_solvers_.acquire(robot, [&] {
+      return std::make_shared<SparseDynamics>(robot, gravity_, planar_axis_);
+    });
+    Values values = solver->forwardDynamics(t, known_values);
+    sparse_solvers_.release(std::move(solver));
+    return values;
+  }
+
   // construct and solve linear graph
-  GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
+  GaussianFactorGraph graph =
+      linearDynamicsGraph(robot, t, known_values, contact_points);
   GaussianFactorGraph priors = linearFDPriors(robot, t, known_values);
   graph.push_back(priors);
-  gtsam::VectorValues results = graph.optimize();
+  gtsam::VectorValues results = optimizeCached(graph, t, &fd_ordering_cache_);
 
   // arrange values
   Values values = known_values;
@@ -146,6 +261,14 @@ Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
       int i = link->id();
       InsertTwistAccel(&values, i, t, TwistAccel(results, i, t));
     }
+    if (contact_points) {
+      std::map<int, int> num_contacts;
+      for (auto &&cp : *contact_points) {
+        const int i = cp.link->id();
+        const Key key = ContactWrenchKey(i, num_contacts[i]++, t);
+        values.insert<Vector6>(key, results.at(key));
+      }
+    }
   } catch (const gtsam::ValuesKeyAlreadyExists &e) {
     std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
     throw std::invalid_argument(
@@ -156,13 +279,30 @@ Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
 }
 
 Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
-                                    const gtsam::Values &known_values) {
+                                    const gtsam::Values &known_values) const {
+  if (linear_solver_ == Recursive) {
+    auto solver = recursive_solvers_.acquire(robot, [&] {
+      return std::make_shared<RecursiveDynamics>(robot, gravity_);
+    });
+    Values values = solver->inverseDynamics(t, known_values);
+    recursive_solvers_.release(std::move(solver));
+    return values;
+  }
+  if (linear_solver_ == Sparse) {
+    auto solver = sparse_solvers_.acquire(robot, [&] {
+      return std::make_shared<SparseDynamics>(robot, gravity_, planar_axis_);
+    });
+    Values values = solver->inverseDynamics(t, known_values);
+    sparse_solvers_.release(std::move(solver));
+    return values;
+  }
+
   // construct and solve linear graph
   GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
   GaussianFactorGraph priors = linearIDPriors(robot, t, known_values);
   graph.push_back(priors);
 
-  gtsam::VectorValues results = graph.optimize();
+  gtsam::VectorValues results = optimizeCached(graph, t, &id_ordering_cache_);
 
   // arrange values
   Values values = known_values;
@@ -194,17 +334,26 @@ Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
 gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
     const Robot &robot, const int k,
     const std::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::qFactors", "graph");
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior(PoseKey(link->id(), k), link->getFixedPose(),
-                     opt_.bp_cost_model);
+      emplace<PriorFactor<gtsam::Pose3>>(&graph, PoseKey(link->id(), k),
+                                         link->getFixedPose(),
+                                         opt_.bp_cost_model);
 
   // TODO(frank): call Kinematics::graph<Slice> instead
   for (auto &&joint : robot.joints()) {
-    graph.add(PoseFactor(
-        PoseKey(joint->parent()->id(), k), PoseKey(joint->child()->id(), k),
-        JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
+    if (opt_.robot_parameters) {
+      emplace<JointPoseFactor>(&graph, opt_.p_cost_model,
+                               opt_.robot_parameters, joint->id(), k);
+    } else if (opt_.closed_form_jacobians) {
+      emplace<JointPoseFactor>(&graph, opt_.p_cost_model, joint, k);
+    } else {
+      graph.add(PoseFactor(
+          PoseKey(joint->parent()->id(), k), PoseKey(joint->child()->id(), k),
+          JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
+    }
   }
 
   // TODO(frank): whoever write this should clean up this mess.
@@ -214,12 +363,18 @@ gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
   else
     gravity = gtsam::Vector3(0, 0, -9.8);
 
-  // Add contact factors.
-  if (contact_points) {
+  // Add contact factors. In contact-implicit mode, the complementarity
+  // factors in dynamicsFactors decide which points touch the ground instead.
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
-      ContactHeightFactor contact_pose_factor(
-          PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point, gravity);
-      graph.add(contact_pose_factor);
+      if (opt_.terrain) {
+        emplace<TerrainHeightFactor>(&graph, PoseKey(cp.link->id(), k),
+                                     opt_.cp_cost_model, cp.point,
+                                     opt_.terrain);
+      } else {
+        emplace<ContactHeightFactor>(&graph, PoseKey(cp.link->id(), k),
+                                     opt_.cp_cost_model, cp.point, gravity);
+      }
     }
   }
 
@@ -229,22 +384,29 @@ gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
     const Robot &robot, const int t,
     const std::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::vFactors", "graph");
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.bv_cost_model);
+      emplace<PriorFactor<gtsam::Vector6>>(&graph, TwistKey(link->id(), t),
+                                           gtsam::Z_6x1, opt_.bv_cost_model);
 
-  for (auto &&joint : robot.joints())
-    graph.add(TwistFactor(opt_.v_cost_model, joint, t));
+  for (auto &&joint : robot.joints()) {
+    if (opt_.robot_parameters)
+      emplace<JointTwistFactor>(&graph, opt_.v_cost_model,
+                                opt_.robot_parameters, joint->id(), t);
+    else if (opt_.closed_form_jacobians)
+      emplace<JointTwistFactor>(&graph, opt_.v_cost_model, joint, t);
+    else
+      graph.add(TwistFactor(opt_.v_cost_model, joint, t));
+  }
 
-  // Add contact factors.
-  if (contact_points) {
+  // Add contact factors, except in contact-implicit mode.
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsTwistFactor contact_twist_factor(
-          TwistKey(cp.link->id(), t), opt_.cv_cost_model,
+      emplace<ContactKinematicsTwistFactor>(
+          &graph, TwistKey(cp.link->id(), t), opt_.cv_cost_model,
           gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_twist_factor);
     }
   }
 
@@ -254,21 +416,29 @@ gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::aFactors(
     const Robot &robot, const int t,
     const std::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::aFactors", "graph");
   NonlinearFactorGraph graph;
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistAccelKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.ba_cost_model);
-  for (auto &&joint : robot.joints())
-    graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+      emplace<PriorFactor<gtsam::Vector6>>(&graph,
+                                           TwistAccelKey(link->id(), t),
+                                           gtsam::Z_6x1, opt_.ba_cost_model);
+  for (auto &&joint : robot.joints()) {
+    if (opt_.robot_parameters)
+      emplace<JointTwistAccelFactor>(&graph, opt_.a_cost_model,
+                                     opt_.robot_parameters, joint->id(), t);
+    else if (opt_.closed_form_jacobians)
+      emplace<JointTwistAccelFactor>(&graph, opt_.a_cost_model, joint, t);
+    else
+      graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+  }
 
-  // Add contact factors.
-  if (contact_points) {
+  // Add contact factors, except in contact-implicit mode.
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsAccelFactor contact_accel_factor(
-          TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model,
+      emplace<ContactKinematicsAccelFactor>(
+          &graph, TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model,
           gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_accel_factor);
     }
   }
 
@@ -280,6 +450,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
     const Robot &robot, const int k,
     const std::optional<PointOnLinks> &contact_points,
     const std::optional<double> &mu) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::dynamicsFactors", "graph");
   NonlinearFactorGraph graph;
 
   // TODO(frank): whoever write this should clean up this mess.
@@ -295,6 +466,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
   else
     mu_ = 1.0;
 
+  std::vector<std::pair<gtsam::Key, gtsam::Key>> friction_cone_keys;
   for (auto &&link : robot.links()) {
     int i = link->id();
     if (!link->isFixed()) {
@@ -314,29 +486,69 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
           wrench_keys.push_back(wrench_key);
 
           // Add contact dynamics constraints.
-          graph.emplace_shared<ContactDynamicsFrictionConeFactor>(
-              PoseKey(i, k), wrench_key, opt_.cfriction_cost_model, mu_,
-              gravity);
-
-          graph.emplace_shared<ContactDynamicsMomentFactor>(
-              wrench_key, opt_.cm_cost_model,
+          if (opt_.terrain) {
+            emplace<TerrainFrictionConeFactor>(
+                &graph, PoseKey(i, k), wrench_key, opt_.cfriction_cost_model,
+                mu_, cp.point, opt_.terrain);
+          } else if (opt_.batch_friction_cones) {
+            friction_cone_keys.emplace_back(PoseKey(i, k), wrench_key);
+          } else {
+            emplace<ContactDynamicsFrictionConeFactor>(
+                &graph, PoseKey(i, k), wrench_key, opt_.cfriction_cost_model,
+                mu_, gravity);
+          }
+
+          emplace<ContactDynamicsMomentFactor>(
+              &graph, wrench_key, opt_.cm_cost_model,
               gtsam::Pose3(gtsam::Rot3(), -cp.point));
+
+          if (opt_.contact_implicit) {
+            emplace<ContactComplementarityFactor>(
+                &graph, PoseKey(i, k), wrench_key, opt_.ccomp_cost_model,
+                cp.point, gravity, opt_.complementarity_relaxation);
+          }
         }
       }
 
       // add wrench factor for link
-      graph.add(
-          WrenchFactor(opt_.fa_cost_model, link, wrench_keys, k, gravity));
+      if (opt_.robot_parameters) {
+        emplace<LinkWrenchFactor>(&graph, opt_.fa_cost_model,
+                                  opt_.robot_parameters, link, wrench_keys, k,
+                                  gravity);
+      } else if (opt_.closed_form_jacobians) {
+        emplace<LinkWrenchFactor>(&graph, opt_.fa_cost_model, link,
+                                  wrench_keys, k, gravity);
+      } else {
+        graph.add(
+            WrenchFactor(opt_.fa_cost_model, link, wrench_keys, k, gravity));
+      }
     }
   }
+  if (!friction_cone_keys.empty()) {
+    emplace<FrictionConesFactor>(
+        &graph, friction_cone_keys, opt_.cfriction_cost_model, mu_, gravity,
+        opt_.friction_pyramid);
+  }
 
   // TODO(frank): use Statics<Slice> calls
   // TODO(frank): sort out const shared ptr mess
   for (auto &&joint : robot.joints()) {
     auto j = joint->id(), child_id = joint->child()->id();
     auto const_joint = joint;
-    graph.add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k));
-    graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k));
+    if (opt_.robot_parameters) {
+      emplace<JointWrenchEquivalenceFactor>(&graph, opt_.f_cost_model,
+                                            opt_.robot_parameters, j, k);
+      emplace<JointWrenchTorqueFactor>(&graph, opt_.t_cost_model,
+                                       opt_.robot_parameters, j, k);
+    } else if (opt_.closed_form_jacobians) {
+      emplace<JointWrenchEquivalenceFactor>(&graph, opt_.f_cost_model,
+                                            const_joint, k);
+      emplace<JointWrenchTorqueFactor>(&graph, opt_.t_cost_model, const_joint,
+                                       k);
+    } else {
+      graph.add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k));
+      graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k));
+    }
     if (planar_axis_)
       graph.add(WrenchPlanarFactor(opt_.planar_cost_model, *planar_axis_,
                                    const_joint, k));
@@ -348,6 +560,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactorGraph(
     const Robot &robot, const int t,
     const std::optional<PointOnLinks> &contact_points,
     const std::optional<double> &mu) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::dynamicsFactorGraph", "graph");
   NonlinearFactorGraph graph;
   graph.add(qFactors(robot, t, contact_points));
   graph.add(vFactors(robot, t, contact_points));
@@ -356,19 +569,40 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactorGraph(
   return graph;
 }
 
+/// Call build(i) for all i in [0, n), on the threads of the context.
+template <class BUILD>
+static void BuildInParallel(const ExecutionContext &execution, int n,
+                            const BUILD &build) {
+  execution.parallelFor(n, [&](size_t i) { build(static_cast<int>(i)); });
+}
+
+/// Concatenate graphs in order, with a single allocation.
+static NonlinearFactorGraph Concatenate(
+    const std::vector<NonlinearFactorGraph> &graphs) {
+  size_t num_factors = 0;
+  for (auto &&graph : graphs) num_factors += graph.size();
+  NonlinearFactorGraph result;
+  result.reserve(num_factors);
+  for (auto &&graph : graphs) result.add(graph);
+  return result;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFG(
     const Robot &robot, const int num_steps, const double dt,
     const CollocationScheme collocation,
     const std::optional<PointOnLinks> &contact_points,
     const std::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
-  for (int t = 0; t < num_steps + 1; t++) {
-    graph.add(dynamicsFactorGraph(robot, t, contact_points, mu));
+  GTD_TRACE_SCOPE("DynamicsGraph::trajectoryFG", "graph");
+  // Time steps are independent, so build one graph per step, in parallel on
+  // the threads of the settings, and concatenate them in time order.
+  std::vector<NonlinearFactorGraph> step_graphs(num_steps + 1);
+  BuildInParallel(opt_.execution, num_steps + 1, [&](int t) {
+    step_graphs[t] = dynamicsFactorGraph(robot, t, contact_points, mu);
     if (t < num_steps) {
-      graph.add(collocationFactors(robot, t, dt, collocation));
+      step_graphs[t].add(collocationFactors(robot, t, dt, collocation));
     }
-  }
-  return graph;
+  });
+  return Concatenate(step_graphs);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
@@ -377,7 +611,7 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     const CollocationScheme collocation,
     const std::optional<std::vector<PointOnLinks>> &phase_contact_points,
     const std::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
+  GTD_TRACE_SCOPE("DynamicsGraph::multiPhaseTrajectoryFG", "graph");
   int num_phases = phase_steps.size();
 
   // Return either PointOnLinks or None if none specified for phase p
@@ -387,34 +621,134 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     return {};
   };
 
-  // First slice, k==0
-  graph.add(dynamicsFactorGraph(robot, 0, contact_points(0), mu));
-
-  int k = 0;
+  // Phase of every time step k, from the first slice k==0 to the last slice
+  // k==K; the last step of every phase but the last is a transition.
+  std::vector<int> step_phases{0}, transitions{-1};
   for (int p = 0; p < num_phases; p++) {
-    // in-phase
-    // add dynamics for each step
-    for (int step = 0; step < phase_steps[p] - 1; step++) {
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
-    }
-    if (p == num_phases - 1) {
-      // Last slice, k==K-1
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
+    for (int step = 0; step < phase_steps[p]; step++) {
+      const bool transition = step == phase_steps[p] - 1 && p < num_phases - 1;
+      step_phases.push_back(p);
+      transitions.push_back(transition ? p : -1);
+    }
+  }
+  const int num_steps = step_phases.size() - 1;
+
+  // The dynamics of K+1 time steps, followed by the collocation factors of K
+  // intervals, all built in parallel on the threads of the settings.
+  std::vector<NonlinearFactorGraph> graphs(2 * num_steps + 1);
+  BuildInParallel(opt_.execution, 2 * num_steps + 1, [&](int i) {
+    if (i > num_steps) {
+      const int k = i - num_steps - 1;
+      graphs[i] = multiPhaseCollocationFactors(robot, k, step_phases[k + 1],
+                                               collocation);
+    } else if (transitions[i] >= 0) {
+      graphs[i] = transition_graphs[transitions[i]];
     } else {
-      // transition
-      graph.add(transition_graphs[p]);
-      k++;
+      graphs[i] =
+          dynamicsFactorGraph(robot, i, contact_points(step_phases[i]), mu);
+    }
+  });
+  return Concatenate(graphs);
+}
+
+namespace {
+// Contact points on each link, in order.
+std::map<int, std::vector<gtsam::Point3>> LinkContactPoints(
+    const std::optional<PointOnLinks> &contact_points) {
+  std::map<int, std::vector<gtsam::Point3>> points;
+  if (contact_points) {
+    for (auto &&cp : *contact_points) {
+      points[cp.link->id()].push_back(cp.point);
     }
   }
+  return points;
+}
+}  // namespace
+
+void DynamicsGraph::contactSwitchPatch(
+    const NonlinearFactorGraph &graph, const Robot &robot, int k,
+    const std::optional<PointOnLinks> &old_contact_points,
+    const std::optional<PointOnLinks> &new_contact_points,
+    const std::optional<double> &mu, GraphPatch *patch) const {
+  // Links whose contact points differ.
+  const auto old_points = LinkContactPoints(old_contact_points),
+             new_points = LinkContactPoints(new_contact_points);
+  std::set<int> affected;
+  for (auto &&[i, points] : old_points) {
+    auto it = new_points.find(i);
+    if (it == new_points.end() || !(it->second == points)) affected.insert(i);
+  }
+  for (auto &&entry : new_points) {
+    if (!old_points.count(entry.first)) affected.insert(entry.first);
+  }
+  if (affected.empty()) return;
+
+  // Whether a factor is on a link variable of an affected link at step k.
+  auto touches = [&](const gtsam::NonlinearFactor &factor) {
+    for (Key key : factor.keys()) {
+      const DynamicsSymbol symbol(key);
+      if (symbol.time() != static_cast<uint64_t>(k) ||
+          !affected.count(symbol.linkIdx())) {
+        continue;
+      }
+      const std::string label = symbol.label();
+      if (label == "p" || label == "V" || label == "A" || label == "C") {
+        return true;
+      }
+    }
+    return false;
+  };
 
-  // add collocation factors
-  k = 0;
-  for (int p = 0; p < num_phases; p++) {
-    for (int step = 0; step < phase_steps[p]; step++) {
-      graph.add(multiPhaseCollocationFactors(robot, k++, p, collocation));
+  // The factors to replace, by type and keys, to find them in graph.
+  using Signature = std::pair<std::string, gtsam::KeyVector>;
+  std::multimap<Signature, gtsam::NonlinearFactor::shared_ptr> old_factors;
+  for (auto &&factor :
+       dynamicsFactorGraph(robot, k, old_contact_points, mu)) {
+    if (!touches(*factor)) continue;
+    old_factors.emplace(Signature(typeid(*factor).name(), factor->keys()),
+                        factor);
+  }
+  for (size_t index = 0; index < graph.size() && !old_factors.empty();
+       index++) {
+    const auto &factor = graph.at(index);
+    if (!factor) continue;
+    auto range = old_factors.equal_range(
+        Signature(typeid(*factor).name(), factor->keys()));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->equals(*factor, 1e-9)) {
+        patch->remove.push_back(index);
+        old_factors.erase(it);
+        break;
+      }
     }
   }
-  return graph;
+
+  for (auto &&factor :
+       dynamicsFactorGraph(robot, k, new_contact_points, mu)) {
+    if (touches(*factor)) patch->add.push_back(factor);
+  }
+}
+
+gtsam::Values DynamicsGraph::optimizeContactImplicit(
+    const Robot &robot, const int num_steps, const double dt,
+    const PointOnLinks &contact_points, const NonlinearFactorGraph &objectives,
+    const Values &init_values, const std::vector<double> &relaxations,
+    const gtsam::LevenbergMarquardtParams &params,
+    const CollocationScheme collocation,
+    const std::optional<double> &mu) const {
+  Values values = init_values;
+  for (double relaxation : relaxations) {
+    OptimizerSetting opt = opt_;
+    opt.contact_implicit = true;
+    opt.complementarity_relaxation = relaxation;
+    DynamicsGraph stage_builder(opt, gravity_, planar_axis_);
+    NonlinearFactorGraph graph = stage_builder.trajectoryFG(
+        robot, num_steps, dt, collocation, contact_points, mu);
+    graph.add(objectives);
+    values = gtsam::LevenbergMarquardtOptimizer(graph, values, params)
+                 .optimize();
+  }
+  return values;
 }
 
 void DynamicsGraph::addCollocationFactorDouble(
@@ -435,7 +769,8 @@ void DynamicsGraph::addCollocationFactorDouble(
         x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr - x1_expr));
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, and hermite-simpson needs the "
+        "second derivatives");
   }
 }
 
@@ -468,10 +803,47 @@ void DynamicsGraph::addMultiPhaseCollocationFactorDouble(
                                 x0_expr + 0.5 * v0dt + 0.5 * v1dt - x1_expr));
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, and hermite-simpson needs the "
+        "second derivatives");
   }
 }
 
+void DynamicsGraph::addHermiteSimpsonCollocationFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const double dt, const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0_expr(v0_key);
+  Double_ v1_expr(v1_key);
+  Double_ a0_expr(a0_key);
+  Double_ a1_expr(a1_key);
+  const double dt2_12 = dt * dt / 12;
+  graph->add(ExpressionFactor(
+      cost_model, 0.0,
+      x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr + dt2_12 * a0_expr -
+          dt2_12 * a1_expr - x1_expr));
+}
+
+void DynamicsGraph::addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const Key phase_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ phase_expr(phase_key);
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0dt(multDouble, phase_expr, Double_(v0_key));
+  Double_ v1dt(multDouble, phase_expr, Double_(v1_key));
+  Double_ dt2(multDouble, phase_expr, phase_expr);
+  Double_ a0dt2(multDouble, dt2, Double_(a0_key));
+  Double_ a1dt2(multDouble, dt2, Double_(a1_key));
+  graph->add(ExpressionFactor(cost_model, 0.0,
+                              x0_expr + 0.5 * v0dt + 0.5 * v1dt +
+                                  (1.0 / 12) * a0dt2 - (1.0 / 12) * a1dt2 -
+                                  x1_expr));
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
     const int j, const int t, const double dt,
     const CollocationScheme collocation) const {
@@ -479,6 +851,16 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
   Key q0_key = JointAngleKey(j, t), q1_key = JointAngleKey(j, t + 1),
       v0_key = JointVelKey(j, t), v1_key = JointVelKey(j, t + 1),
       a0_key = JointAccelKey(j, t), a1_key = JointAccelKey(j, t + 1);
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    // Without jerk variables, the velocities use trapezoidal collocation,
+    // i.e. a linear acceleration over the step.
+    addHermiteSimpsonCollocationFactorDouble(&graph, q0_key, q1_key, v0_key,
+                                             v1_key, a0_key, a1_key, dt,
+                                             opt_.q_col_cost_model);
+    addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
+                               opt_.v_col_cost_model, Trapezoidal);
+    return graph;
+  }
   addCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key, dt,
                              opt_.q_col_cost_model, collocation);
   addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
@@ -486,10 +868,32 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
   return graph;
 }
 
+// Ids of all joints of the robot.
+static std::vector<int> JointIds(const Robot &robot) {
+  std::vector<int> joint_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+  return joint_ids;
+}
+
+// Whether JointsCollocationFactor should use trapezoidal collocation.
+static bool IsTrapezoidal(const CollocationScheme collocation) {
+  if (collocation == CollocationScheme::Euler) return false;
+  if (collocation == CollocationScheme::Trapezoidal) return true;
+  throw std::runtime_error(
+      "banded collocation is only implemented for euler and trapezoidal");
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::collocationFactors(
     const Robot &robot, const int t, const double dt,
     const CollocationScheme collocation) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::collocationFactors", "graph");
   NonlinearFactorGraph graph;
+  if (opt_.banded_collocation) {
+    emplace<JointsCollocationFactor>(
+        &graph, JointIds(robot), t, dt, opt_.q_col_cost_model,
+        opt_.v_col_cost_model, IsTrapezoidal(collocation));
+    return graph;
+  }
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     graph.add(jointCollocationFactors(j, t, dt, collocation));
@@ -497,6 +901,63 @@ gtsam::NonlinearFactorGraph DynamicsGraph::collocationFactors(
   return graph;
 }
 
+gtsam::Ordering DynamicsGraph::PhaseDurationsLastOrdering(
+    const NonlinearFactorGraph &graph) {
+  gtsam::KeyVector phase_keys;
+  for (Key key : graph.keys()) {
+    if (DynamicsSymbol(key).label() == "dt") phase_keys.push_back(key);
+  }
+  return gtsam::Ordering::ColamdConstrainedLast(graph, phase_keys);
+}
+
+gtsam::Ordering DynamicsGraph::TrajectoryOrdering(
+    const Robot &robot, const NonlinearFactorGraph &graph) {
+  // Depths of links and joints in the spanning forest of the robot.
+  const RobotTopology &topology = robot.topology();
+  std::vector<int> link_depth(topology.links.size(), 0),
+      joint_depth(topology.joints.size(), 0);
+  for (size_t k = 0; k < topology.traversal.size(); k++) {
+    const int j = topology.traversal[k], i1 = topology.traversal_from[k];
+    const int i2 = topology.parent_link[j] == i1 ? topology.child_link[j]
+                                                 : topology.parent_link[j];
+    link_depth[i2] = joint_depth[j] = link_depth[i1] + 1;
+  }
+
+  // Sort by time step, then deepest first; phase durations go last.
+  std::vector<std::tuple<size_t, int, Key>> sorted;
+  gtsam::KeyVector phase_keys;
+  for (Key key : graph.keys()) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.label() == "dt") {
+      phase_keys.push_back(key);
+      continue;
+    }
+    int depth = 0;
+    if (symbol.jointIdx() < joint_depth.size()) {
+      depth = joint_depth[symbol.jointIdx()];
+    } else if (symbol.linkIdx() < link_depth.size()) {
+      depth = link_depth[symbol.linkIdx()];
+    }
+    sorted.emplace_back(symbol.time(), -depth, key);
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  gtsam::Ordering ordering;
+  for (auto &&entry : sorted) ordering.push_back(std::get<2>(entry));
+  for (Key key : phase_keys) ordering.push_back(key);
+  return ordering;
+}
+
+gtsam::Ordering DynamicsGraph::CondensedOrdering(
+    const Robot &robot, const NonlinearFactorGraph &graph) {
+  gtsam::Ordering ordering;
+  for (Key key : TrajectoryOrdering(robot, graph)) {
+    const std::string label = DynamicsSymbol(key).label();
+    if (label == "F" || label == "A") ordering.push_back(key);
+  }
+  return ordering;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
     const int j, const int t, const int phase,
     const CollocationScheme collocation) const {
@@ -506,6 +967,15 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
       a1_key = JointAccelKey(j, t + 1);
 
   gtsam::NonlinearFactorGraph graph;
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+        &graph, q0_key, q1_key, v0_key, v1_key, a0_key, a1_key, phase_key,
+        opt_.q_col_cost_model);
+    addMultiPhaseCollocationFactorDouble(&graph, v0_key, v1_key, a0_key,
+                                         a1_key, phase_key,
+                                         opt_.v_col_cost_model, Trapezoidal);
+    return graph;
+  }
   addMultiPhaseCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key,
                                        phase_key, opt_.q_col_cost_model,
                                        collocation);
@@ -518,7 +988,14 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
 gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseCollocationFactors(
     const Robot &robot, const int t, const int phase,
     const CollocationScheme collocation) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::multiPhaseCollocationFactors", "graph");
   NonlinearFactorGraph graph;
+  if (opt_.banded_collocation) {
+    emplace<JointsCollocationFactor>(
+        &graph, JointIds(robot), t, PhaseKey(phase), opt_.q_col_cost_model,
+        opt_.v_col_cost_model, IsTrapezoidal(collocation));
+    return graph;
+  }
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     graph.add(jointMultiPhaseCollocationFactors(j, t, phase, collocation));
@@ -531,12 +1008,15 @@ gtsam::NonlinearFactorGraph DynamicsGraph::forwardDynamicsPriors(
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, t), JointAngle(known_values, j, t),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, t), JointVel(known_values, j, t),
-                   opt_.prior_qv_cost_model);
-    graph.addPrior(TorqueKey(j, t), Torque(known_values, j, t),
-                   opt_.prior_t_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointAngleKey(j, t),
+                                 JointAngle(known_values, j, t),
+                                 opt_.prior_q_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointVelKey(j, t),
+                                 JointVel(known_values, j, t),
+                                 opt_.prior_qv_cost_model);
+    emplace<PriorFactor<double>>(&graph, TorqueKey(j, t),
+                                 Torque(known_values, j, t),
+                                 opt_.prior_t_cost_model);
   }
   return graph;
 }
@@ -546,12 +1026,15 @@ gtsam::NonlinearFactorGraph DynamicsGraph::inverseDynamicsPriors(
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, t), JointAngle(known_values, j, t),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, t), JointVel(known_values, j, t),
-                   opt_.prior_qv_cost_model);
-    graph.addPrior(JointAccelKey(j, t), JointAccel(known_values, j, t),
-                   opt_.prior_qa_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointAngleKey(j, t),
+                                 JointAngle(known_values, j, t),
+                                 opt_.prior_q_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointVelKey(j, t),
+                                 JointVel(known_values, j, t),
+                                 opt_.prior_qv_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointAccelKey(j, t),
+                                 JointAccel(known_values, j, t),
+                                 opt_.prior_qa_cost_model);
   }
   return graph;
 }
@@ -562,13 +1045,16 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
   gtsam::NonlinearFactorGraph graph;
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
-    graph.addPrior(JointAngleKey(j, 0), JointAngle(known_values, j, 0),
-                   opt_.prior_q_cost_model);
-    graph.addPrior(JointVelKey(j, 0), JointVel(known_values, j, 0),
-                   opt_.prior_qv_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointAngleKey(j, 0),
+                                 JointAngle(known_values, j, 0),
+                                 opt_.prior_q_cost_model);
+    emplace<PriorFactor<double>>(&graph, JointVelKey(j, 0),
+                                 JointVel(known_values, j, 0),
+                                 opt_.prior_qv_cost_model);
     for (int t = 0; t <= num_steps; t++) {
-      graph.addPrior(TorqueKey(j, t), Torque(known_values, j, t),
-                     opt_.prior_t_cost_model);
+      emplace<PriorFactor<double>>(&graph, TorqueKey(j, t),
+                                   Torque(known_values, j, t),
+                                   opt_.prior_t_cost_model);
     }
   }
   return graph;
@@ -577,6 +1063,10 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
 gtsam::NonlinearFactorGraph DynamicsGraph::jointLimitFactors(
     const Robot &robot, const int t) const {
   NonlinearFactorGraph graph;
+  if (opt_.batch_joint_limits) {
+    emplace<JointsLimitFactor>(&graph, robot.joints(), t, opt_.jl_cost_model);
+    return graph;
+  }
   for (auto &&joint : robot.joints())
     graph.add(joint->jointLimitFactors(t, opt_));
   return graph;
@@ -587,7 +1077,8 @@ gtsam::NonlinearFactorGraph DynamicsGraph::targetAngleFactors(
     const double target_angle) const {
   NonlinearFactorGraph graph;
   int j = robot.joint(joint_name)->id();
-  graph.addPrior(JointAngleKey(j, t), target_angle, opt_.prior_q_cost_model);
+  emplace<PriorFactor<double>>(&graph, JointAngleKey(j, t), target_angle,
+                               opt_.prior_q_cost_model);
   return graph;
 }
 
@@ -596,7 +1087,8 @@ gtsam::NonlinearFactorGraph DynamicsGraph::targetPoseFactors(
     const gtsam::Pose3 &target_pose) const {
   NonlinearFactorGraph graph;
   int i = robot.link(link_name)->id();
-  graph.addPrior(PoseKey(i, t), target_pose, opt_.bp_cost_model);
+  emplace<PriorFactor<gtsam::Pose3>>(&graph, PoseKey(i, t), target_pose,
+                                     opt_.bp_cost_model);
   return graph;
 }
 
@@ -700,28 +1192,90 @@ JointValueMap DynamicsGraph::jointTorquesMap(const Robot &robot,
   return joint_torques;
 }
 
-void printKey(const gtsam::Key &key) {
-  auto symb = DynamicsSymbol(key);
-  std::cout << (std::string)(symb) << "\t";
+namespace {
+// Joint variables with the given label of time steps 0..num_steps-1, in one
+// pass over the keys of the values.
+gtsam::Matrix JointValuesMatrix(const Robot &robot, const gtsam::Values &result,
+                                const std::string &label, size_t num_steps) {
+  // Column of each joint id, -1 for ids of no joint.
+  const auto joints = robot.joints();
+  std::vector<int> columns;
+  for (size_t idx = 0; idx < joints.size(); idx++) {
+    const size_t j = joints[idx]->id();
+    if (j >= columns.size()) columns.resize(j + 1, -1);
+    columns[j] = idx;
+  }
+
+  gtsam::Matrix matrix(num_steps, joints.size());
+  size_t count = 0;
+  for (gtsam::Key key : result.keys()) {
+    const DynamicsSymbol symbol(key);
+    const size_t t = symbol.time(), j = symbol.jointIdx();
+    if (t >= num_steps || j >= columns.size() || columns[j] < 0 ||
+        symbol.label() != label) {
+      continue;
+    }
+    matrix(t, columns[j]) = result.at<double>(key);
+    ++count;
+  }
+
+  // Report the first missing variable, as the per-time-step accessors do.
+  if (count < size_t(matrix.size())) {
+    for (size_t t = 0; t < num_steps; t++) {
+      for (auto &&joint : joints) {
+        const Key key = DynamicsSymbol::JointSymbol(label, joint->id(), t);
+        if (!result.exists(key)) throw KeyDoesNotExist("at", key);
+      }
+    }
+  }
+  return matrix;
+}
+}  // namespace
+
+gtsam::Matrix DynamicsGraph::jointAccelsMatrix(const Robot &robot,
+                                               const gtsam::Values &result,
+                                               size_t num_steps) {
+  return JointValuesMatrix(robot, result, "a", num_steps);
+}
+
+gtsam::Matrix DynamicsGraph::jointVelsMatrix(const Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps) {
+  return JointValuesMatrix(robot, result, "v", num_steps);
+}
+
+gtsam::Matrix DynamicsGraph::jointAnglesMatrix(const Robot &robot,
+                                               const gtsam::Values &result,
+                                               size_t num_steps) {
+  return JointValuesMatrix(robot, result, "q", num_steps);
+}
+
+gtsam::Matrix DynamicsGraph::jointTorquesMatrix(const Robot &robot,
+                                                const gtsam::Values &result,
+                                                size_t num_steps) {
+  return JointValuesMatrix(robot, result, "T", num_steps);
 }
 
 // print the factors of the factor graph
 void DynamicsGraph::printValues(const gtsam::Values &values) {
+  const gtsam::KeyVector keys = values.keys();
+  const std::vector<std::string> names = GTDFormatKeys(keys);
   std::cout << "values:\n";
-  for (auto &key : values.keys()) {
-    printKey(key);
-    std::cout << "\n";
-    values.at(key).print();
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::cout << names[i] << "\t\n";
+    values.at(keys[i]).print();
     std::cout << "\n";
   }
 }
 
 // print the factors of the factor graph
 void DynamicsGraph::printGraph(const gtsam::NonlinearFactorGraph &graph) {
+  const gtsam::KeySet keys = graph.keys();
+  KeyNameCache names(gtsam::KeyVector(keys.begin(), keys.end()));
   std::cout << "graph:\n";
   for (auto &factor : graph) {
     for (auto &key : factor->keys()) {
-      printKey(key);
+      std::cout << names(key) << "\t";
     }
     std::cout << "\n";
   }
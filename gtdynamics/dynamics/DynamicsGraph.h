@@ -15,32 +15,164 @@
 
 #include <gtdynamics/dynamics/OptimizerSetting.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/inference/Factor.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/linear/NoiseModel.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
 #include <cmath>
 #include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace gtdynamics {
 
+class RecursiveDynamics;
+class SparseDynamics;
+
 using JointValueMap = std::map<std::string, double>;
 
 /** Collocation methods. */
 enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
 
+/**
+ * Solvers for the linear forward/inverse dynamics problems.
+ * Elimination: build a Gaussian factor graph and eliminate it.
+ * Recursive: walk the kinematic tree (see RecursiveDynamics), only valid for
+ * robots without kinematic loops.
+ * Sparse: assemble one sparse matrix and factorize it (see SparseDynamics).
+ */
+enum LinearDynamicsSolver { Elimination, Recursive, Sparse };
+
+/**
+ * Change to a factor graph, in the form taken by incremental solvers such as
+ * gtsam::ISAM2::update: the indices of factors to remove, and new factors.
+ */
+struct GraphPatch {
+  gtsam::FactorIndices remove;      ///< indices into the patched graph
+  gtsam::NonlinearFactorGraph add;  ///< factors to add
+
+  /// Whether the patch changes nothing.
+  bool empty() const { return remove.empty() && add.empty(); }
+
+  /// Apply to a graph: the removed factors become null, and new ones are
+  /// appended, so the indices of all other factors stay the same.
+  void apply(gtsam::NonlinearFactorGraph *graph) const {
+    for (size_t i : remove) graph->remove(i);
+    graph->push_back(add);
+  }
+};
+
 /**
  * DynamicsGraph is a class which builds a factor graph to do kinodynamic
- * motion planning
+ * motion planning.
+ *
+ * All const methods, including the graph builders and the linear solves, may
+ * be called concurrently from several threads on one instance, with a const
+ * Robot shared by all of them.
  */
 class DynamicsGraph {
  private:
   OptimizerSetting opt_;
   std::optional<gtsam::Vector3> gravity_, planar_axis_;
+  LinearDynamicsSolver linear_solver_ = Elimination;
+  std::optional<FactorArena> arena_;
+
+  /**
+   * Elimination orderings of linear dynamics graphs, cached across calls and
+   * indexed by the sorted keys of the graph. Keys are stored at time step 0
+   * so the same ordering can be reused for every time step of a robot with
+   * the same structure, e.g., the same contact mode. Graphs with keys that
+   * are not DynamicsSymbols are solved without the cache. The mutex lets a
+   * const DynamicsGraph solve from several threads; copies get their own
+   * mutex.
+   */
+  struct OrderingCache {
+    std::map<gtsam::KeyVector, gtsam::Ordering> orderings;
+    mutable std::mutex mutex;
+
+    OrderingCache() = default;
+    OrderingCache(const OrderingCache &other) {
+      std::lock_guard<std::mutex> lock(other.mutex);
+      orderings = other.orderings;
+    }
+    OrderingCache &operator=(const OrderingCache &other) {
+      if (this != &other) {
+        std::scoped_lock lock(mutex, other.mutex);
+        orderings = other.orderings;
+      }
+      return *this;
+    }
+  };
+  mutable OrderingCache fd_ordering_cache_, id_ordering_cache_;
+
+  /**
+   * Idle solvers kept across linearSolveFD/linearSolveID calls, so that their
+   * tree, buffers and factorizations are built once per robot. A call takes
+   * an idle solver built for its robot, or builds one, and returns it when
+   * done, so concurrent calls each get their own. Solvers of other robots
+   * are dropped. Copies of a DynamicsGraph start with no solvers.
+   */
+  template <class SOLVER>
+  struct SolverPool {
+    std::vector<std::shared_ptr<SOLVER>> idle;
+    mutable std::mutex mutex;
+
+    SolverPool() = default;
+    SolverPool(const SolverPool &) {}
+    SolverPool &operator=(const SolverPool &) { return *this; }
+
+    /// Take an idle solver built for robot, or make a new one.
+    template <class MAKE>
+    std::shared_ptr<SOLVER> acquire(const Robot &robot, MAKE &&make) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!idle.empty()) {
+          std::shared_ptr<SOLVER> solver = std::move(idle.back());
+          idle.pop_back();
+          if (solver->builtFor(robot)) return solver;
+        }
+      }
+      return make();
+    }
+
+    /// Return a solver taken with acquire.
+    void release(std::shared_ptr<SOLVER> solver) {
+      std::lock_guard<std::mutex> lock(mutex);
+      idle.push_back(std::move(solver));
+    }
+  };
+  mutable SolverPool<RecursiveDynamics> recursive_solvers_;
+  mutable SolverPool<SparseDynamics> sparse_solvers_;
+
+  /**
+   * Solve a linear dynamics graph for time step t, using the ordering in
+   * cache if a graph with the same keys was seen before, and computing and
+   * caching it otherwise.
+   */
+  static gtsam::VectorValues optimizeCached(
+      const gtsam::GaussianFactorGraph &graph, int t, OrderingCache *cache);
+
+  /// Add a FACTOR to graph, allocated from the arena if one is set.
+  template <class FACTOR, class... Args>
+  void emplace(gtsam::NonlinearFactorGraph *graph, Args &&...args) const {
+    if (arena_) {
+      graph->push_back(arena_->make<FACTOR>(std::forward<Args>(args)...));
+    } else {
+      graph->emplace_shared<FACTOR>(std::forward<Args>(args)...);
+    }
+  }
 
  public:
   /**
@@ -72,9 +204,13 @@ class DynamicsGraph {
    * @param robot        the robot
    * @param t            time step
    * @param known_values Values with kinematics, must include poses and twists
+   * @param contact_points optional contact points, each has zero linear
+   * acceleration and a contact wrench C_i_c without moment about the point,
+   * with c counting the contacts on link i. Friction cones are not enforced.
    */
   gtsam::GaussianFactorGraph linearDynamicsGraph(
-      const Robot &robot, const int t, const gtsam::Values &known_values);
+      const Robot &robot, const int t, const gtsam::Values &known_values,
+      const std::optional<PointOnLinks> &contact_points = {}) const;
 
   /// Return linear factor graph with priors on torques.
   static gtsam::GaussianFactorGraph linearFDPriors(
@@ -84,21 +220,67 @@ class DynamicsGraph {
   static gtsam::GaussianFactorGraph linearIDPriors(
       const Robot &robot, const int t, const gtsam::Values &joint_accels);
 
+  /// Select the solver used by linearSolveFD and linearSolveID.
+  void setLinearSolver(LinearDynamicsSolver solver) { linear_solver_ = solver; }
+
+  /// Return the solver used by linearSolveFD and linearSolveID.
+  LinearDynamicsSolver linearSolver() const { return linear_solver_; }
+
+  /**
+   * Forget the elimination orderings cached by linearSolveFD/linearSolveID.
+   * This is never needed for correctness: orderings are looked up by the
+   * keys of the graph, and any ordering of the same keys is valid, if not
+   * always as good. It frees memory when switching robots.
+   */
+  void clearOrderingCache() {
+    for (OrderingCache *cache : {&fd_ordering_cache_, &id_ordering_cache_}) {
+      std::lock_guard<std::mutex> lock(cache->mutex);
+      cache->orderings.clear();
+    }
+  }
+
+  /**
+   * Allocate the factors made by the graph builders below from arena, so that
+   * a large graph takes a few allocations instead of one per factor, and is
+   * released at once. Factors keep the arena alive, so it does not need to
+   * outlive the graphs. Factors made from expressions, with
+   * closed_form_jacobians off, are still allocated individually.
+   */
+  void setFactorArena(const FactorArena &arena) { arena_ = arena; }
+
+  /// Go back to allocating each factor on the heap.
+  void clearFactorArena() { arena_.reset(); }
+
+  /// Return the arena set by setFactorArena, if any.
+  const std::optional<FactorArena> &factorArena() const { return arena_; }
+
   /**
    * Solve forward kinodynamics using linear factor graph, Values version.
+   * If the Recursive solver is selected, the Articulated Body Algorithm is
+   * used instead, which ignores planar_axis (the planar constraints are
+   * satisfied automatically for planar motions). If the Sparse solver is
+   * selected, the same equations are solved as one sparse system.
+   *
+   * Contacts are always solved with elimination.
    *
    * @param robot           the robot
    * @param t               time step
    * @param known_values Values with kinematics + torques which includes joint
    * angles, joint velocities, and torques
+   * @param contact_points  optional contact points, see linearDynamicsGraph
    * @return values of joint angles, joint velocities, joint accelerations,
-   * joint torques, and link twist accelerations
+   * joint torques, and link twist accelerations, and contact wrenches
    */
-  gtsam::Values linearSolveFD(const Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+  gtsam::Values linearSolveFD(
+      const Robot &robot, const int t, const gtsam::Values &known_values,
+      const std::optional<PointOnLinks> &contact_points = {}) const;
 
   /**
    * Solve inverse kinodynamics using linear factor graph, Values version.
+   * If the Recursive solver is selected, the Recursive Newton-Euler Algorithm
+   * is used instead. If the Sparse solver is selected, the same equations are
+   * solved as one sparse system.
+   *
    * @param  robot        the robot
    * @param  t            time step
    * @param known_values  Values with kinematics + joint accelerations
@@ -106,7 +288,7 @@ class DynamicsGraph {
    * @return values of all variables, including computed torques
    */
   gtsam::Values linearSolveID(const Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+                              const gtsam::Values &known_values) const;
 
   /// Return q-level nonlinear factor graph (pose related factors)
   gtsam::NonlinearFactorGraph qFactors(
@@ -171,7 +353,9 @@ class DynamicsGraph {
       const gtsam::Values &known_values) const;
 
   /**
-   * Return nonlinear factor graph of the entire trajectory
+   * Return nonlinear factor graph of the entire trajectory. The factors of
+   * each time step are created in parallel, on the threads of the settings;
+   * the factor order does not depend on the number of threads.
    * @param robot       the robot
    * @param num_steps   total time steps
    * @param dt          duration of each time step
@@ -199,6 +383,64 @@ class DynamicsGraph {
       const std::optional<std::vector<PointOnLinks>> &phase_contact_points = {},
       const std::optional<double> &mu = {}) const;
 
+  /**
+   * Patch a graph, built with old_contact_points at time step k, for
+   * new_contact_points instead, e.g. when a foot lifts earlier in a replanned
+   * contact schedule, rather than rebuilding the whole trajectory graph.
+   *
+   * Only links whose contact points differ are affected: the factors of
+   * dynamicsFactorGraph(robot, k, old_contact_points, mu) on the pose, twist,
+   * twist acceleration or contact wrenches of an affected link at step k,
+   * i.e. contact kinematics, contact dynamics and their wrench factors, are
+   * found in graph and removed, and those for new_contact_points are added.
+   * Factors on these variables which do not depend on the contacts, e.g.
+   * joint kinematics, may be removed and added again. Other factors, such as
+   * collocation factors and objectives, are never removed. New variables, e.g.
+   * contact wrenches, then need initial values.
+   *
+   * @param graph               the graph to patch, e.g. multiPhaseTrajectoryFG
+   * @param robot               the robot
+   * @param k                   time step
+   * @param old_contact_points  contact points graph was built with at step k
+   * @param new_contact_points  contact points to patch it for
+   * @param mu                  optional coefficient of static friction
+   * @param patch               patch to which removals and additions are added
+   */
+  void contactSwitchPatch(const gtsam::NonlinearFactorGraph &graph,
+                          const Robot &robot, int k,
+                          const std::optional<PointOnLinks> &old_contact_points,
+                          const std::optional<PointOnLinks> &new_contact_points,
+                          const std::optional<double> &mu,
+                          GraphPatch *patch) const;
+
+  /**
+   * Contact-implicit trajectory optimization: the contact schedule is not
+   * given, but decided by the optimizer through ContactComplementarityFactor
+   * on every candidate contact point at every time step. The trajectory is
+   * optimized once per relaxation, each time from the previous result, so
+   * the complementarity is tightened gradually.
+   * @param robot          the robot
+   * @param num_steps      total time steps
+   * @param dt             duration of each time step
+   * @param contact_points candidate contact points
+   * @param objectives     additional factors, e.g. boundary conditions
+   * @param init_values    initial values of all variables
+   * @param relaxations    decreasing complementarity relaxations, one per
+   *                       optimization
+   * @param params         parameters of each optimization
+   * @param collocation    the collocation scheme
+   * @param mu             optional coefficient of static friction
+   */
+  gtsam::Values optimizeContactImplicit(
+      const Robot &robot, const int num_steps, const double dt,
+      const PointOnLinks &contact_points,
+      const gtsam::NonlinearFactorGraph &objectives,
+      const gtsam::Values &init_values, const std::vector<double> &relaxations,
+      const gtsam::LevenbergMarquardtParams &params =
+          gtsam::LevenbergMarquardtParams(),
+      const CollocationScheme collocation = Trapezoidal,
+      const std::optional<double> &mu = {}) const;
+
   /** Add collocation factor for doubles. */
   static void addCollocationFactorDouble(
       gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
@@ -214,6 +456,65 @@ class DynamicsGraph {
       const gtsam::noiseModel::Base::shared_ptr &cost_model,
       const CollocationScheme collocation = Trapezoidal);
 
+  /**
+   * Add Hermite-Simpson collocation factor for doubles, i.e.
+   * x1 = x0 + dt / 2 (v0 + v1) + dt^2 / 12 (a0 - a1), from the cubic Hermite
+   * spline through x and v, with the second derivative a.
+   */
+  static void addHermiteSimpsonCollocationFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key, const double dt,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /** Add Hermite-Simpson collocation factor for doubles, with dt as a
+   * variable. */
+  static void addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key,
+      const gtsam::Key phase_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /**
+   * COLAMD ordering of a multi-phase graph that eliminates the phase duration
+   * variables last. Each one is shared by the collocation factors of all the
+   * steps of its phase, so eliminating it early makes a dense column that
+   * fills in the whole phase; eliminated last, the durations form a small
+   * dense block and the banded structure of the time steps is preserved. Use
+   * e.g. as LevenbergMarquardtParams::ordering.
+   * @param graph a multi-phase factor graph
+   */
+  static gtsam::Ordering PhaseDurationsLastOrdering(
+      const gtsam::NonlinearFactorGraph &graph);
+
+  /**
+   * Ordering of a trajectory graph that follows its structure instead of
+   * COLAMD: by time step, and within a time step from the leaves of the
+   * kinematic tree of the robot to its root, since eliminating a tree from
+   * its leaves causes no fill-in. Joint variables, e.g. wrenches, come at the
+   * depth of the joint's link farthest from the root; phase durations last.
+   * Use e.g. with MutableLMOptimizer::setGraph or as
+   * LevenbergMarquardtParams::ordering.
+   * @param robot the robot of the graph
+   * @param graph a trajectory factor graph
+   */
+  static gtsam::Ordering TrajectoryOrdering(
+      const Robot &robot, const gtsam::NonlinearFactorGraph &graph);
+
+  /**
+   * Wrench and twist acceleration variables of a trajectory graph, in the
+   * order of TrajectoryOrdering, to condense them with
+   * MutableLMParams::condensed. Given the joint accelerations and torques of
+   * a time step, the link dynamics determine them, so they are eliminated
+   * within their time step and the global system has only the other
+   * variables.
+   * @param robot the robot of the graph
+   * @param graph a trajectory factor graph
+   */
+  static gtsam::Ordering CondensedOrdering(
+      const Robot &robot, const gtsam::NonlinearFactorGraph &graph);
+
   /**
    * Return collocation factors for the specified joint.
    * @param j           joint index
@@ -330,6 +631,33 @@ class DynamicsGraph {
                                        const gtsam::Values &result,
                                        const int t);
 
+  /**
+   * Return the joint accelerations of time steps 0..num_steps-1 as a
+   * (num_steps x numJoints) matrix, with columns in the order of joints(),
+   * extracted in one pass over the values.
+   * @param robot     the robot
+   * @param result    values of the trajectory
+   * @param num_steps number of time steps
+   */
+  static gtsam::Matrix jointAccelsMatrix(const Robot &robot,
+                                         const gtsam::Values &result,
+                                         size_t num_steps);
+
+  /// Return joint velocities of all time steps as a matrix.
+  static gtsam::Matrix jointVelsMatrix(const Robot &robot,
+                                       const gtsam::Values &result,
+                                       size_t num_steps);
+
+  /// Return joint angles of all time steps as a matrix.
+  static gtsam::Matrix jointAnglesMatrix(const Robot &robot,
+                                         const gtsam::Values &result,
+                                         size_t num_steps);
+
+  /// Return joint torques of all time steps as a matrix.
+  static gtsam::Matrix jointTorquesMatrix(const Robot &robot,
+                                          const gtsam::Values &result,
+                                          size_t num_steps);
+
   /// Print the factors of the factor graph
   static void printGraph(const gtsam::NonlinearFactorGraph &graph);
 
@@ -380,6 +708,9 @@ class DynamicsGraph {
 
   /// Return the optimizer setting.
   const OptimizerSetting &opt() const { return opt_; }
+
+  /// Return gravity in world frame, if any.
+  const std::optional<gtsam::Vector3> &gravity() const { return gravity_; }
 };
 
 }  // namespace gtdynamics
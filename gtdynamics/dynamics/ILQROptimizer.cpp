@@ -0,0 +1,383 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ILQROptimizer.cpp
+ * @brief Shooting trajectory optimization with iterative LQR.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/ILQROptimizer.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ILQROptimizer::ILQROptimizer(const Robot &robot,
+                             const DynamicsGraph &graph_builder, int num_steps,
+                             double dt, const ILQRParams &params,
+                             IntegrationScheme scheme)
+    : robot_(robot),
+      dynamics_(robot, graph_builder.gravity()),
+      num_steps_(num_steps),
+      dt_(dt),
+      scheme_(scheme),
+      params_(params),
+      n_(dynamics_.numJoints()) {
+  if (num_steps < 1) {
+    throw std::invalid_argument("ILQROptimizer: needs at least one step.");
+  }
+  if (scheme == RungeKutta4) {
+    throw std::invalid_argument(
+        "ILQROptimizer: only single-stage integration schemes are supported.");
+  }
+
+  const auto &links = dynamics_.links();
+  size_t num_link_ids = 0;
+  for (auto &&link : links) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  link_indices_.assign(num_link_ids, -1);
+  for (size_t k = 0; k < links.size(); ++k) link_indices_[links[k]->id()] = k;
+  poses_.resize(links.size());
+
+  k_.assign(num_steps, Vector::Zero(n_));
+  K_.assign(num_steps, Matrix::Zero(n_, 2 * n_));
+  A_.assign(num_steps, Matrix(2 * n_, 2 * n_));
+  B_.assign(num_steps, Matrix(2 * n_, n_));
+  a_H_q_.assign(num_steps, Matrix(n_, n_));
+  a_H_v_.assign(num_steps, Matrix(n_, n_));
+  a_H_tau_.assign(num_steps, Matrix(n_, n_));
+}
+
+/* ************************************************************************* */
+void ILQROptimizer::setObjectives(
+    const gtsam::NonlinearFactorGraph &objectives) {
+  costs_.assign(num_steps_ + 1, gtsam::NonlinearFactorGraph());
+  for (auto &&factor : objectives) {
+    if (!factor || factor->empty()) continue;
+    const int t = DynamicsSymbol(factor->front()).time();
+    for (gtsam::Key key : factor->keys()) {
+      const DynamicsSymbol symbol(key);
+      const std::string label = symbol.label();
+      bool valid = static_cast<int>(symbol.time()) == t && t <= num_steps_;
+      if (label == "q" || label == "v") {
+        valid &= symbol.jointIdx() < n_;
+      } else if (label == "a" || label == "T") {
+        valid &= symbol.jointIdx() < n_ && t < num_steps_;
+      } else if (label == "p") {
+        valid &= symbol.linkIdx() < link_indices_.size() &&
+                 link_indices_[symbol.linkIdx()] >= 0;
+      } else {
+        valid = false;
+      }
+      if (!valid) {
+        throw std::invalid_argument(
+            "ILQROptimizer: objectives can only have joint angles, "
+            "velocities, accelerations, torques and link poses of one time "
+            "step, got " +
+            _GTDKeyFormatter(key));
+      }
+    }
+    costs_[t].push_back(factor);
+  }
+}
+
+/* ************************************************************************* */
+void ILQROptimizer::computePoses(const Vector &q) const {
+  const auto &links = dynamics_.links();
+  for (size_t k = 0; k < links.size(); ++k) {
+    const int p = dynamics_.parentIndex(k);
+    if (p < 0) {
+      poses_[k] = links[k]->isFixed() ? links[k]->getFixedPose() : Pose3();
+      continue;
+    }
+    const auto &joint = dynamics_.parentJoint(k);
+    poses_[k] = joint->poseOf(links[k], poses_[p], q(joint->id()));
+  }
+}
+
+/* ************************************************************************* */
+Values ILQROptimizer::stepValues(int k, const JointTrajectory &trajectory,
+                                 const Matrix &torques) const {
+  computePoses(trajectory.q.row(k).transpose());
+  Values values;
+  for (gtsam::Key key : costs_[k].keys()) {
+    const DynamicsSymbol symbol(key);
+    const std::string label = symbol.label();
+    const int j = symbol.jointIdx();
+    if (label == "q") {
+      values.insert(key, trajectory.q(k, j));
+    } else if (label == "v") {
+      values.insert(key, trajectory.v(k, j));
+    } else if (label == "a") {
+      values.insert(key, trajectory.a(k, j));
+    } else if (label == "T") {
+      values.insert(key, torques(k, j));
+    } else {
+      values.insert(key, poses_[link_indices_[symbol.linkIdx()]]);
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+double ILQROptimizer::totalCost(const JointTrajectory &trajectory,
+                                const Matrix &torques) const {
+  double cost = 0.0;
+  for (int k = 0; k <= num_steps_; ++k) {
+    if (costs_[k].empty()) continue;
+    cost += costs_[k].error(stepValues(k, trajectory, torques));
+  }
+  return cost;
+}
+
+/* ************************************************************************* */
+void ILQROptimizer::rollout(double alpha, bool feedback,
+                            JointTrajectory *trajectory,
+                            Matrix *torques) const {
+  const double c = scheme_ == TaylorStep ? 0.5 : 1.0;
+  Vector q = trajectory_.q.row(0).transpose();
+  Vector v = trajectory_.v.row(0).transpose();
+  Vector a(n_), u(n_), dx(2 * n_);
+  trajectory->q.row(0) = q.transpose();
+  trajectory->v.row(0) = v.transpose();
+  for (int k = 0; k < num_steps_; ++k) {
+    u = torques_.row(k).transpose();
+    if (feedback) {
+      dx << q - trajectory_.q.row(k).transpose(),
+          v - trajectory_.v.row(k).transpose();
+      u += alpha * k_[k] + K_[k] * dx;
+    }
+    dynamics_.forwardDynamics(q, v, u, &a);
+    q += dt_ * v + c * dt_ * dt_ * a;
+    v += dt_ * a;
+    torques->row(k) = u.transpose();
+    trajectory->a.row(k) = a.transpose();
+    trajectory->q.row(k + 1) = q.transpose();
+    trajectory->v.row(k + 1) = v.transpose();
+  }
+}
+
+/* ************************************************************************* */
+void ILQROptimizer::linearizeDynamics() {
+  // q' = q + dt * v + c * dt^2 * a, v' = v + dt * a, with a(q, v, tau).
+  const double c = scheme_ == TaylorStep ? 0.5 : 1.0;
+  const double h = dt_, h2 = c * dt_ * dt_;
+  const Matrix I = Matrix::Identity(n_, n_);
+  Vector a(n_);
+  for (int k = 0; k < num_steps_; ++k) {
+    dynamics_.forwardDynamicsDerivatives(
+        trajectory_.q.row(k).transpose(), trajectory_.v.row(k).transpose(),
+        torques_.row(k).transpose(), &a, &a_H_q_[k], &a_H_v_[k],
+        &a_H_tau_[k]);
+    Matrix &A = A_[k], &B = B_[k];
+    A.topLeftCorner(n_, n_) = I + h2 * a_H_q_[k];
+    A.topRightCorner(n_, n_) = h * I + h2 * a_H_v_[k];
+    A.bottomLeftCorner(n_, n_) = h * a_H_q_[k];
+    A.bottomRightCorner(n_, n_) = I + h * a_H_v_[k];
+    B.topRows(n_) = h2 * a_H_tau_[k];
+    B.bottomRows(n_) = h * a_H_tau_[k];
+  }
+}
+
+/* ************************************************************************* */
+Matrix ILQROptimizer::keyJacobian(gtsam::Key key, int k) const {
+  const DynamicsSymbol symbol(key);
+  const std::string label = symbol.label();
+  const int j = symbol.jointIdx();
+  if (label == "q" || label == "v" || label == "T") {
+    Matrix J = Matrix::Zero(1, 3 * n_);
+    J(0, (label == "q" ? 0 : label == "v" ? n_ : 2 * n_) + j) = 1.0;
+    return J;
+  }
+  if (label == "a") {
+    Matrix J(1, 3 * n_);
+    J << a_H_q_[k].row(j), a_H_v_[k].row(j), a_H_tau_[k].row(j);
+    return J;
+  }
+
+  // Body Jacobian of the pose of link m: a joint of an ancestor link c moves
+  // it by Ad(T_m^-1 * T_c) * S_c.
+  Matrix J = Matrix::Zero(6, 3 * n_);
+  const int m = link_indices_[symbol.linkIdx()];
+  const auto &links = dynamics_.links();
+  for (int c = m; dynamics_.parentIndex(c) >= 0;
+       c = dynamics_.parentIndex(c)) {
+    const auto &joint = dynamics_.parentJoint(c);
+    J.col(joint->id()) = poses_[m].between(poses_[c]).AdjointMap() *
+                         joint->screwAxis(links[c]);
+  }
+  return J;
+}
+
+/* ************************************************************************* */
+void ILQROptimizer::quadratizeCost(int k, Vector *g, Matrix *H) const {
+  const size_t dim = k < num_steps_ ? 3 * n_ : 2 * n_;
+  g->setZero(dim);
+  H->setZero(dim, dim);
+  if (costs_[k].empty()) return;
+
+  // Gauss-Newton approximation from the whitened factor Jacobians, the poses
+  // of the step are left in poses_ by stepValues for keyJacobian.
+  const Values values = stepValues(k, trajectory_, torques_);
+  for (auto &&factor : costs_[k]) {
+    const auto jacobian_factor =
+        std::dynamic_pointer_cast<gtsam::JacobianFactor>(
+            factor->linearize(values));
+    if (!jacobian_factor) {
+      throw std::runtime_error(
+          "ILQROptimizer: objectives must linearize to Jacobian factors.");
+    }
+    const auto [Ab, b] = jacobian_factor->jacobian();
+    Matrix J(Ab.cols(), 3 * n_);
+    Eigen::Index row = 0;
+    for (gtsam::Key key : jacobian_factor->keys()) {
+      const Matrix J_key = keyJacobian(key, k);
+      J.middleRows(row, J_key.rows()) = J_key;
+      row += J_key.rows();
+    }
+    const Matrix AJ = Ab * J.leftCols(dim);
+    *g -= AJ.transpose() * b;
+    *H += AJ.transpose() * AJ;
+  }
+}
+
+/* ************************************************************************* */
+bool ILQROptimizer::backwardPass(double mu) {
+  const size_t nx = 2 * n_;
+  Vector g, Vx;
+  Matrix H, Vxx;
+  quadratizeCost(num_steps_, &Vx, &Vxx);
+  Eigen::LLT<Matrix> llt;
+  for (int k = num_steps_ - 1; k >= 0; --k) {
+    quadratizeCost(k, &g, &H);
+    const Matrix &A = A_[k], &B = B_[k];
+    const Vector Qx = g.head(nx) + A.transpose() * Vx;
+    const Vector Qu = g.tail(n_) + B.transpose() * Vx;
+    const Matrix VxxA = Vxx * A;
+    const Matrix Qxx = H.topLeftCorner(nx, nx) + A.transpose() * VxxA;
+    const Matrix Qux = H.bottomLeftCorner(n_, nx) + B.transpose() * VxxA;
+    Matrix Quu = H.bottomRightCorner(n_, n_) + B.transpose() * Vxx * B;
+    Quu.diagonal().array() += mu;
+
+    llt.compute(Quu);
+    if (llt.info() != Eigen::Success) return false;
+    k_[k] = -llt.solve(Qu);
+    K_[k] = -llt.solve(Qux);
+
+    const Matrix &K = K_[k];
+    Vx = Qx + K.transpose() * (Quu * k_[k] + Qu) + Qux.transpose() * k_[k];
+    Vxx = Qxx + K.transpose() * (Quu * K + Qux) + Qux.transpose() * K;
+    Vxx = 0.5 * (Vxx + Vxx.transpose()).eval();
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+Values ILQROptimizer::optimize(const Values &state,
+                               const gtsam::NonlinearFactorGraph &objectives,
+                               const Matrix &initial_torques) {
+  setObjectives(objectives);
+
+  // Initial torques, or the last solution shifted one step back in time.
+  if (initial_torques.size() > 0) {
+    if (initial_torques.rows() != num_steps_ ||
+        initial_torques.cols() != static_cast<Eigen::Index>(n_)) {
+      throw std::invalid_argument(
+          "ILQROptimizer: initial torques must be num_steps x numJoints().");
+    }
+    torques_ = initial_torques;
+  } else if (torques_.rows() == num_steps_) {
+    if (num_steps_ > 1) {
+      torques_.topRows(num_steps_ - 1) =
+          torques_.bottomRows(num_steps_ - 1).eval();
+    }
+  } else {
+    torques_ = Matrix::Zero(num_steps_, n_);
+  }
+
+  trajectory_.resize(num_steps_, n_);
+  trajectory_.q.row(0).setZero();
+  trajectory_.v.row(0).setZero();
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    if (state.exists(JointAngleKey(j))) {
+      trajectory_.q(0, j) = JointAngle(state, j);
+    }
+    if (state.exists(JointVelKey(j))) trajectory_.v(0, j) = JointVel(state, j);
+  }
+  rollout(0.0, false, &trajectory_, &torques_);
+  cost_ = totalCost(trajectory_, torques_);
+
+  JointTrajectory trajectory;
+  trajectory.resize(num_steps_, n_);
+  Matrix torques(num_steps_, n_);
+  double mu = params_.regularization;
+  for (iterations_ = 0; iterations_ < params_.max_iterations;) {
+    ++iterations_;
+    linearizeDynamics();
+    bool improved = false;
+    double decrease = 0.0;
+    if (backwardPass(mu)) {
+      double alpha = 1.0;
+      for (size_t s = 0; s < params_.line_search_steps; ++s, alpha *= 0.5) {
+        rollout(alpha, true, &trajectory, &torques);
+        const double cost = totalCost(trajectory, torques);
+        if (cost < cost_) {
+          decrease = cost_ - cost;
+          std::swap(trajectory_, trajectory);
+          torques_.swap(torques);
+          cost_ = cost;
+          improved = true;
+          break;
+        }
+      }
+    }
+    if (improved) {
+      mu = std::max(mu / 10.0, params_.regularization);
+      if (decrease <= params_.relative_tolerance * (cost_ + decrease)) break;
+    } else {
+      mu *= 10.0;
+      if (mu > params_.max_regularization) break;
+    }
+  }
+
+  // Gains around the solution, e.g. for feedback control.
+  linearizeDynamics();
+  while (!backwardPass(mu) && mu <= params_.max_regularization) mu *= 10.0;
+
+  Values values;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    for (int k = 0; k <= num_steps_; ++k) {
+      InsertJointAngle(&values, j, k, trajectory_.q(k, j));
+      InsertJointVel(&values, j, k, trajectory_.v(k, j));
+      if (k == num_steps_) continue;
+      InsertJointAccel(&values, j, k, trajectory_.a(k, j));
+      InsertTorque(&values, j, k, torques_(k, j));
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ILQROptimizer.h
+ * @brief Shooting trajectory optimization with iterative LQR.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ILQROptimizer.
+struct ILQRParams {
+  size_t max_iterations = 50;        ///< maximum number of iterations
+  double relative_tolerance = 1e-6;  ///< stop when the cost decreases less
+  double regularization = 1e-6;      ///< initial regularization of Quu
+  double max_regularization = 1e10;  ///< give up above this regularization
+  size_t line_search_steps = 10;     ///< number of step halvings to try
+};
+
+/**
+ * ILQROptimizer solves a trajectory optimization problem by shooting: the
+ * unknowns are the joint torques of steps 0 to num_steps-1, and the joint
+ * angles and velocities follow from the measured state at step 0 by
+ * simulation, as the vector interface of Simulator does (forward dynamics
+ * with RecursiveDynamics, then one integration step).
+ *
+ * Every iteration linearizes the simulation with the analytic forward
+ * dynamics derivatives of RecursiveDynamics, and the cost with the Jacobians
+ * of its factors, then solves the resulting LQR problem backwards in time and
+ * rolls out the new torques with a line search. Each such subproblem only has
+ * the torques of one time step as unknowns, instead of all variables of a
+ * collocation graph, and the feedback gains of the last iteration can be used
+ * directly as a controller around the optimized trajectory.
+ *
+ * The cost is a factor graph of objectives, e.g. MinTorqueFactor and
+ * DynamicsGraph::targetPoseFactors or targetAngleFactors, and is the sum of
+ * their errors. All keys of a factor must be at the same time step, and may be
+ * joint angles, velocities, accelerations or torques, or link poses.
+ * Accelerations and torques only exist for steps 0 to num_steps-1. Poses are
+ * the link CoM poses of forward kinematics with fixed links at their fixed
+ * pose, so the robot should be a fixed-base tree, e.g. an arm with fixed
+ * contacts.
+ */
+class ILQROptimizer {
+ private:
+  Robot robot_;
+  RecursiveDynamics dynamics_;
+  int num_steps_;
+  double dt_;
+  IntegrationScheme scheme_;
+  ILQRParams params_;
+  size_t n_;
+
+  /// Traversal index of each link id, -1 if unused.
+  std::vector<int> link_indices_;
+
+  /// Objectives of each time step.
+  std::vector<gtsam::NonlinearFactorGraph> costs_;
+
+  /// Nominal trajectory, torques and cost.
+  JointTrajectory trajectory_;
+  gtsam::Matrix torques_;
+  double cost_ = 0.0;
+  size_t iterations_ = 0;
+
+  /// Feedforward terms and feedback gains of each step.
+  std::vector<gtsam::Vector> k_;
+  std::vector<gtsam::Matrix> K_;
+
+  /// Linearized simulation of each step, x_{k+1} = A_k x_k + B_k u_k.
+  std::vector<gtsam::Matrix> A_, B_;
+
+  /// Derivatives of the accelerations of each step.
+  std::vector<gtsam::Matrix> a_H_q_, a_H_v_, a_H_tau_;
+
+  /// Link poses in traversal order, for the current step.
+  mutable std::vector<gtsam::Pose3> poses_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot         the robot, must have tree topology
+   * @param graph_builder provides gravity, and builds the objectives
+   * @param num_steps     number of time steps
+   * @param dt            duration of each time step
+   * @param params        optimizer parameters
+   * @param scheme        integration scheme, TaylorStep or SemiImplicitEuler
+   */
+  ILQROptimizer(const Robot &robot, const DynamicsGraph &graph_builder,
+                int num_steps, double dt,
+                const ILQRParams &params = ILQRParams(),
+                IntegrationScheme scheme = TaylorStep);
+
+  /**
+   * Optimize the torques.
+   * @param state      measured state at step 0, joint angles and velocities;
+   * missing joints are at zero
+   * @param objectives costs on steps 0 to num_steps
+   * @param initial_torques initial torques, num_steps x numJoints(). If
+   * empty, the torques of the last solution shifted one step back in time
+   * (the last step is repeated) are used, or zero torques at first.
+   * @return values with joint angles and velocities of steps 0 to num_steps,
+   * and joint accelerations and torques of steps 0 to num_steps-1
+   */
+  gtsam::Values optimize(
+      const gtsam::Values &state, const gtsam::NonlinearFactorGraph &objectives,
+      const gtsam::Matrix &initial_torques = gtsam::Matrix());
+
+  /// Forget the last solution, so the next call starts from zero torques.
+  void reset() { torques_.resize(0, 0); }
+
+  /// Joint trajectory of the last solution, indexed by joint id.
+  const JointTrajectory &trajectory() const { return trajectory_; }
+
+  /// Torques of the last solution, num_steps x numJoints().
+  const gtsam::Matrix &torques() const { return torques_; }
+
+  /**
+   * Feedback gain of step k, such that u = torques().row(k) + gain(k) * dx,
+   * where dx stacks the deviations of the joint angles and velocities from
+   * the trajectory at step k.
+   */
+  const gtsam::Matrix &gain(int k) const { return K_[k]; }
+
+  /// Cost of the last solution.
+  double cost() const { return cost_; }
+
+  /// Number of iterations of the last optimization.
+  size_t iterations() const { return iterations_; }
+
+  /// Number of time steps.
+  int numSteps() const { return num_steps_; }
+
+  /// Size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return n_; }
+
+ private:
+  /// Sort the objectives by time step, and check their keys.
+  void setObjectives(const gtsam::NonlinearFactorGraph &objectives);
+
+  /// Compute the link poses at joint angles q into poses_.
+  void computePoses(const gtsam::Vector &q) const;
+
+  /// Values of the keys of the objectives of step k, on trajectory at tau.
+  gtsam::Values stepValues(int k, const JointTrajectory &trajectory,
+                           const gtsam::Matrix &torques) const;
+
+  /// Total cost of a trajectory.
+  double totalCost(const JointTrajectory &trajectory,
+                   const gtsam::Matrix &torques) const;
+
+  /**
+   * Simulate from the state at step 0 of trajectory, with the torques of the
+   * nominal trajectory, the feedforward terms scaled by alpha, and feedback.
+   * With alpha = 0 and no gains, the nominal torques are simulated.
+   */
+  void rollout(double alpha, bool feedback, JointTrajectory *trajectory,
+               gtsam::Matrix *torques) const;
+
+  /// Linearize the simulation of all steps around the nominal trajectory.
+  void linearizeDynamics();
+
+  /**
+   * Gradient and Gauss-Newton Hessian of the cost of step k, with respect to
+   * the joint angles, velocities and, if k < num_steps, torques.
+   */
+  void quadratizeCost(int k, gtsam::Vector *g, gtsam::Matrix *H) const;
+
+  /// Derivative of a key of step k with respect to [q; v; tau].
+  gtsam::Matrix keyJacobian(gtsam::Key key, int k) const;
+
+  /// Compute the gains, return false if Quu is not positive definite.
+  bool backwardPass(double mu);
+};
+
+}  // namespace gtdynamics
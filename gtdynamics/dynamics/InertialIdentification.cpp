@@ -0,0 +1,257 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.cpp
+ * @brief Least-squares identification of link inertial parameters from
+ * logged joint trajectories.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/// Samples per chunk of addSamples, and the largest number of chunks, which
+/// each hold their own normal equations.
+static constexpr Eigen::Index kChunkSize = 256;
+static constexpr Eigen::Index kMaxChunks = 64;
+
+/**
+ * Matrix Y such that G * x = Y * pi for the spatial inertia G with
+ * parameters pi = [m, h, Ixx, Ixy, Ixz, Iyy, Iyz, Izz], or without the first
+ * moment h. With x = (w, a), G * x = (I * w + h x a, m * a + w x h).
+ */
+static Matrix InertiaRegressor(const Vector6 &x, bool first_moment) {
+  const Vector3 w = x.head<3>(), a = x.tail<3>();
+  Matrix Y = Matrix::Zero(6, first_moment ? 10 : 7);
+  Y.block<3, 1>(3, 0) = a;
+  int c = 1;
+  if (first_moment) {
+    Y.block<3, 3>(0, 1) = -gtsam::skewSymmetric(a);
+    Y.block<3, 3>(3, 1) = gtsam::skewSymmetric(w);
+    c = 4;
+  }
+  Y.block<3, 6>(0, c) << w(0), w(1), w(2), 0, 0, 0,  //
+      0, w(0), 0, w(1), w(2), 0,                     //
+      0, 0, w(0), 0, w(1), w(2);
+  return Y;
+}
+
+/* ************************************************************************* */
+InertialIdentification::InertialIdentification(
+    const Robot &robot, const std::optional<Vector3> &gravity,
+    const InertialIdentificationParams &params)
+    : robot_(robot), tree_(robot), params_(params), gravity_(gravity) {
+  const auto &links = tree_.links();
+  const size_t parameters_per_link = parametersPerLink();
+  columns_.assign(links.size(), -1);
+  for (size_t k = 0; k < links.size(); ++k) {
+    if (links[k]->isFixed()) continue;
+    columns_[k] = num_parameters_;
+    num_parameters_ += parameters_per_link;
+  }
+
+  // The model parameters, with the centers of mass at the CoM frames.
+  prior_ = Vector::Zero(num_parameters_);
+  for (size_t k = 0; k < links.size(); ++k) {
+    if (columns_[k] < 0) continue;
+    const Matrix3 &I = links[k]->inertia();
+    auto pi = prior_.segment(columns_[k], parameters_per_link);
+    pi(0) = links[k]->mass();
+    pi.tail<6>() << I(0, 0), I(0, 1), I(0, 2), I(1, 1), I(1, 2), I(2, 2);
+  }
+
+  for (size_t k = 0; k < links.size(); ++k) {
+    const auto &joint = tree_.parentJoint(k);
+    if (joint && joint->screwAxis(links[k]).norm() > 0) {
+      movable_joints_.push_back(joint->id());
+    }
+  }
+  std::sort(movable_joints_.begin(), movable_joints_.end());
+
+  information_ = Matrix::Zero(num_parameters_, num_parameters_);
+  information_vector_ = Vector::Zero(num_parameters_);
+}
+
+/* ************************************************************************* */
+Matrix InertialIdentification::regressor(const Vector &q, const Vector &v,
+                                         const Vector &qdd) const {
+  const auto &links = tree_.links();
+  const size_t n = links.size();
+  const size_t parameters_per_link = parametersPerLink();
+
+  // Outward pass for poses, twists and twist accelerations.
+  std::vector<Pose3> poses(n);
+  std::vector<Vector6> twists(n, Vector6::Zero()), accels(n, Vector6::Zero());
+  std::vector<Vector6> screw_axes(n, Vector6::Zero());
+  std::vector<Matrix6> Ad(n);
+  for (size_t k = 0; k < n; ++k) {
+    const int p = tree_.parentIndex(k);
+    if (p < 0) {
+      poses[k] = links[k]->isFixed() ? links[k]->getFixedPose() : Pose3();
+      continue;
+    }
+    const auto &joint = tree_.parentJoint(k);
+    const int j = joint->id();
+    std::tie(poses[k], twists[k]) =
+        joint->otherPoseTwist(links[p], poses[p], twists[p], q(j), v(j));
+    Ad[k] = poses[k].between(poses[p]).AdjointMap();
+    screw_axes[k] = joint->screwAxis(links[k]);
+    accels[k] = Ad[k] * accels[p] + screw_axes[k] * qdd(j) +
+                Pose3::adjointMap(twists[k]) * screw_axes[k] * v(j);
+  }
+
+  // Inward pass for the wrench of each joint as a function of the
+  // parameters, F = G * (A - g) - ad(V)^T * G * V summed over the subtree.
+  std::vector<Matrix> W(n, Matrix::Zero(6, num_parameters_));
+  for (size_t k = 0; k < n; ++k) {
+    if (columns_[k] < 0) continue;
+    Vector6 A = accels[k];
+    if (gravity_) {
+      A.tail<3>() -= poses[k].rotation().transpose() * (*gravity_);
+    }
+    const bool first_moment = params_.identify_center_of_mass;
+    W[k].middleCols(columns_[k], parameters_per_link) =
+        InertiaRegressor(A, first_moment) -
+        Pose3::adjointMap(twists[k]).transpose() *
+            InertiaRegressor(twists[k], first_moment);
+  }
+  Matrix Y = Matrix::Zero(tree_.numJoints(), num_parameters_);
+  for (int k = n - 1; k >= 0; --k) {
+    const int p = tree_.parentIndex(k);
+    if (p < 0) continue;
+    Y.row(tree_.parentJoint(k)->id()) = screw_axes[k].transpose() * W[k];
+    if (!links[p]->isFixed()) W[p] += Ad[k].transpose() * W[k];
+  }
+  return Y;
+}
+
+/* ************************************************************************* */
+void InertialIdentification::accumulate(const Matrix &q, const Matrix &v,
+                                        const Matrix &qdd, const Matrix &tau,
+                                        Eigen::Index begin, Eigen::Index end,
+                                        Matrix *information,
+                                        Vector *information_vector) const {
+  Matrix rows(movable_joints_.size(), num_parameters_);
+  Vector torques(movable_joints_.size());
+  for (Eigen::Index s = begin; s < end; ++s) {
+    const Matrix Y = regressor(q.row(s).transpose(), v.row(s).transpose(),
+                               qdd.row(s).transpose());
+    for (size_t r = 0; r < movable_joints_.size(); ++r) {
+      rows.row(r) = Y.row(movable_joints_[r]);
+      torques(r) = tau(s, movable_joints_[r]);
+    }
+    information->noalias() += rows.transpose() * rows;
+    information_vector->noalias() += rows.transpose() * torques;
+  }
+}
+
+/* ************************************************************************* */
+void InertialIdentification::addSamples(const Matrix &q, const Matrix &v,
+                                        const Matrix &qdd, const Matrix &tau) {
+  const Eigen::Index num_samples = q.rows();
+  const Eigen::Index num_joints = tree_.numJoints();
+  for (const Matrix *x : {&q, &v, &qdd, &tau}) {
+    if (x->rows() != num_samples || x->cols() != num_joints) {
+      throw std::invalid_argument(
+          "InertialIdentification::addSamples: expected " +
+          std::to_string(num_samples) + " rows and " +
+          std::to_string(num_joints) + " columns");
+    }
+  }
+  if (num_samples == 0) return;
+
+  // Chunks do not depend on the number of threads, so neither does the sum.
+  const Eigen::Index chunk_size = std::max(
+      kChunkSize, (num_samples + kMaxChunks - 1) / kMaxChunks);
+  const size_t num_chunks = (num_samples + chunk_size - 1) / chunk_size;
+  std::vector<Matrix> informations(num_chunks);
+  std::vector<Vector> information_vectors(num_chunks);
+  auto accumulateChunk = [&](size_t c) {
+    informations[c] = Matrix::Zero(num_parameters_, num_parameters_);
+    information_vectors[c] = Vector::Zero(num_parameters_);
+    const Eigen::Index begin = c * chunk_size;
+    accumulate(q, v, qdd, tau, begin,
+               std::min(begin + chunk_size, num_samples), &informations[c],
+               &information_vectors[c]);
+  };
+  params_.execution.parallelFor(num_chunks, accumulateChunk);
+  for (size_t c = 0; c < num_chunks; ++c) {
+    information_ += informations[c];
+    information_vector_ += information_vectors[c];
+  }
+  num_samples_ += num_samples;
+}
+
+/* ************************************************************************* */
+Vector InertialIdentification::solve() const {
+  const double w = params_.prior_weight;
+  const Matrix A =
+      information_ + w * Matrix::Identity(num_parameters_, num_parameters_);
+  return A.ldlt().solve(information_vector_ + w * prior_);
+}
+
+/* ************************************************************************* */
+InertialParameters InertialIdentification::linkParameters(
+    const Vector &parameters, int link_id) const {
+  const auto &links = tree_.links();
+  for (size_t k = 0; k < links.size(); ++k) {
+    if (links[k]->id() != link_id) continue;
+    if (columns_[k] < 0) {
+      return {links[k]->mass(), Vector3::Zero(), links[k]->inertia()};
+    }
+    const auto pi = parameters.segment(columns_[k], parametersPerLink());
+    InertialParameters result;
+    result.mass = pi(0);
+    result.first_moment = params_.identify_center_of_mass
+                              ? Vector3(pi.segment<3>(1))
+                              : Vector3::Zero();
+    const auto I = pi.tail<6>();
+    result.inertia << I(0), I(1), I(2), I(1), I(3), I(4), I(2), I(4), I(5);
+    return result;
+  }
+  throw std::invalid_argument(
+      "InertialIdentification::linkParameters: no link with id " +
+      std::to_string(link_id));
+}
+
+/* ************************************************************************* */
+Robot InertialIdentification::identifiedRobot() const {
+  const Vector parameters = solve();
+  Robot robot = robot_.clone();
+  for (auto &&link : robot.links()) {
+    if (link->isFixed()) continue;
+    const InertialParameters pi = linkParameters(parameters, link->id());
+    // Inertia about the identified center of mass, I_c = I_o + m [c]x [c]x.
+    Matrix3 inertia = pi.inertia;
+    if (pi.mass > 0) {
+      const Matrix3 C = gtsam::skewSymmetric(pi.first_moment / pi.mass);
+      inertia += pi.mass * C * C;
+    }
+    link->setInertialParameters(pi.mass, inertia);
+  }
+  return robot;
+}
+
+}  // namespace gtdynamics
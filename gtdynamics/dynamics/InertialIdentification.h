@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.h
+ * @brief Least-squares identification of link inertial parameters from
+ * logged joint trajectories.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Options of InertialIdentification.
+struct InertialIdentificationParams {
+  /// Also identify the first moments, i.e. the offsets of the centers of
+  /// mass from the CoM frames of the model; otherwise they stay at zero.
+  bool identify_center_of_mass = false;
+
+  /// Weight of a prior on the parameters of the model, which fixes the
+  /// combinations of parameters the joint torques do not depend on.
+  double prior_weight = 1e-6;
+
+  /// Threads that accumulate chunks of samples in addSamples.
+  ExecutionContext execution = ExecutionContext::Default();
+};
+
+/// Inertial parameters of a link, in the CoM frame of the model.
+struct InertialParameters {
+  double mass;
+  gtsam::Vector3 first_moment;  // mass times the center of mass
+  gtsam::Matrix3 inertia;       // about the origin of the frame
+};
+
+/**
+ * Identification of the link masses and inertias of a robot from logged
+ * joint angles, velocities, accelerations and torques. Inverse dynamics is
+ * linear in the inertial parameters of the links, tau = Y(q, v, qdd) * pi, so
+ * the regressor Y of each sample is computed with one Newton-Euler pass and
+ * the normal equations of all samples are accumulated, in parallel chunks
+ * on the threads of the parameters. Samples can be added in batches as the
+ * log is read, and the least-squares parameters solved for at any time.
+ *
+ * Each link has 10 parameters in its CoM frame of the model: mass, first
+ * moment, and the 6 entries of the inertia matrix, or 7 without the first
+ * moments. As in the joint-space dynamics of RecursiveDynamics, fixed links
+ * are at their fixed pose and floating roots are held at the identity; the
+ * parameters of links that move no joint, e.g. fixed links, keep their prior.
+ */
+class InertialIdentification {
+ private:
+  Robot robot_;
+  RecursiveDynamics tree_;
+  InertialIdentificationParams params_;
+  std::optional<gtsam::Vector3> gravity_;
+
+  /// Column of the first parameter of each link in traversal order, or -1.
+  std::vector<int> columns_;
+  size_t num_parameters_ = 0;
+
+  /// Ids of the joints with a degree of freedom.
+  std::vector<int> movable_joints_;
+
+  /// Prior parameters, and the accumulated normal equations.
+  gtsam::Vector prior_;
+  gtsam::Matrix information_;
+  gtsam::Vector information_vector_;
+  size_t num_samples_ = 0;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot    the robot, must have tree topology; its inertial
+   * parameters are the prior
+   * @param gravity  gravity in world frame
+   * @param params   options
+   */
+  explicit InertialIdentification(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {},
+      const InertialIdentificationParams &params =
+          InertialIdentificationParams());
+
+  /// Parameters per link: 10, or 7 without the first moments.
+  size_t parametersPerLink() const {
+    return params_.identify_center_of_mass ? 10 : 7;
+  }
+
+  /// Total number of parameters.
+  size_t numParameters() const { return num_parameters_; }
+
+  /// Number of samples added so far.
+  size_t numSamples() const { return num_samples_; }
+
+  /// Parameters of the robot given on construction, stacked by link.
+  const gtsam::Vector &priorParameters() const { return prior_; }
+
+  /**
+   * Regressor of one sample, vectors indexed by joint id.
+   * @return Y with one row per joint id and one column per parameter, such
+   * that the torques are Y * parameters; rows of fixed joints are zero.
+   */
+  gtsam::Matrix regressor(const gtsam::Vector &q, const gtsam::Vector &v,
+                          const gtsam::Vector &qdd) const;
+
+  /**
+   * Add a batch of samples, one row per sample and one column per joint id
+   * as in BatchDynamics.
+   * @param q    joint angles
+   * @param v    joint velocities
+   * @param qdd  joint accelerations
+   * @param tau  measured joint torques
+   */
+  void addSamples(const gtsam::Matrix &q, const gtsam::Matrix &v,
+                  const gtsam::Matrix &qdd, const gtsam::Matrix &tau);
+
+  /// Least-squares parameters of all samples so far, stacked by link.
+  gtsam::Vector solve() const;
+
+  /// Parameters of the link with the given id, from stacked parameters.
+  InertialParameters linkParameters(const gtsam::Vector &parameters,
+                                    int link_id) const;
+
+  /**
+   * A copy of the robot with the identified masses and inertias. A center of
+   * mass that moved is accounted for in the inertia, but the CoM frames, and
+   * so the joint frames, are not moved.
+   */
+  Robot identifiedRobot() const;
+
+ private:
+  /// Accumulate the samples in rows [begin, end) into the normal equations.
+  void accumulate(const gtsam::Matrix &q, const gtsam::Matrix &v,
+                  const gtsam::Matrix &qdd, const gtsam::Matrix &tau,
+                  Eigen::Index begin, Eigen::Index end,
+                  gtsam::Matrix *information,
+                  gtsam::Vector *information_vector) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,180 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Integration.h
+ * @brief Time integration of joint angles and velocities for simulation.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gtdynamics {
+
+/**
+ * Integration schemes for simulation, all holding torques constant over a
+ * time step.
+ * TaylorStep: q += dt * v + dt^2/2 * a, v += dt * a (explicit, second order).
+ * SemiImplicitEuler: v += dt * a, q += dt * v_new (symplectic, first order).
+ * RungeKutta4: classic 4th order Runge-Kutta, four dynamics solves per step.
+ */
+enum IntegrationScheme { TaylorStep, SemiImplicitEuler, RungeKutta4 };
+
+/// Joint trajectory of a simulation, one row per time step.
+struct JointTrajectory {
+  gtsam::Matrix q;  ///< joint angles, (num_steps + 1) x num_joints
+  gtsam::Matrix v;  ///< joint velocities, (num_steps + 1) x num_joints
+  gtsam::Matrix a;  ///< joint accelerations, num_steps x num_joints
+
+  /// Allocate storage for the given number of steps and joints.
+  void resize(Eigen::Index num_steps, Eigen::Index num_joints) {
+    q.resize(num_steps + 1, num_joints);
+    v.resize(num_steps + 1, num_joints);
+    a.resize(num_steps, num_joints);
+  }
+};
+
+/// Buffers for intermediate states, so integration does not allocate.
+struct IntegrationWorkspace {
+  gtsam::Vector q, v, v3, k2, k3, k4;
+
+  /// Allocate buffers for the given number of joints.
+  void resize(Eigen::Index num_joints) {
+    for (auto *buffer : {&q, &v, &v3, &k2, &k3, &k4}) {
+      buffer->resize(num_joints);
+    }
+  }
+};
+
+/// Tolerances and step size bounds of adaptive integration.
+struct AdaptiveStepParams {
+  double abs_tol = 1e-6;     ///< absolute tolerance on q and v per step
+  double rel_tol = 1e-6;     ///< relative tolerance on q and v per step
+  double initial_dt = 1e-3;  ///< first trial step
+  double min_dt = 1e-8;      ///< smallest step, accepted even if inaccurate
+  double max_dt = 0.1;       ///< largest step
+  double event_tol = 1e-9;   ///< time tolerance of event localization
+};
+
+/**
+ * Advance joint angles and velocities by one time step.
+ *
+ * @param scheme         integration scheme
+ * @param dt             duration of the time step
+ * @param accelerations  callable (q, v, a*) solving forward dynamics for the
+ * joint accelerations a at joint angles q and velocities v, only called by
+ * multi-stage schemes
+ * @param a              joint accelerations at the start of the step
+ * @param q              joint angles, updated in place
+ * @param v              joint velocities, updated in place
+ * @param workspace      buffers, resized to the number of joints if needed
+ */
+template <class ACCELERATIONS>
+void IntegrateStep(IntegrationScheme scheme, double dt,
+                   const ACCELERATIONS &accelerations, const gtsam::Vector &a,
+                   gtsam::Vector *q, gtsam::Vector *v,
+                   IntegrationWorkspace *workspace) {
+  switch (scheme) {
+    case TaylorStep:
+      *q += dt * *v + 0.5 * dt * dt * a;
+      *v += dt * a;
+      break;
+    case SemiImplicitEuler:
+      *v += dt * a;
+      *q += dt * *v;
+      break;
+    case RungeKutta4: {
+      IntegrationWorkspace &w = *workspace;
+      if (w.q.size() != q->size()) w.resize(q->size());
+      w.q = *q + 0.5 * dt * *v;
+      w.v = *v + 0.5 * dt * a;
+      accelerations(w.q, w.v, &w.k2);
+      w.q = *q + 0.5 * dt * *v + 0.25 * dt * dt * a;
+      w.v = *v + 0.5 * dt * w.k2;
+      accelerations(w.q, w.v, &w.k3);
+      w.q = *q + dt * *v + 0.5 * dt * dt * w.k2;
+      w.v = *v + dt * w.k3;
+      accelerations(w.q, w.v, &w.k4);
+      *q += dt * *v + dt * dt / 6.0 * (a + w.k2 + w.k3);
+      *v += dt / 6.0 * (a + 2.0 * w.k2 + 2.0 * w.k3 + w.k4);
+      break;
+    }
+  }
+}
+
+/**
+ * Advance joint angles and velocities by one Bogacki-Shampine 3(2) step,
+ * with the embedded second order solution as error estimate. The
+ * accelerations at the new state are computed as its last stage, so they can
+ * start the next step: three dynamics solves per step.
+ *
+ * @param dt             duration of the time step
+ * @param accelerations  callable (q, v, a*) solving forward dynamics
+ * @param q, v, a        state and joint accelerations at the start
+ * @param q1, v1, a1     state and joint accelerations at the end
+ * @param workspace      buffers, resized to the number of joints if needed
+ * @param params         tolerances
+ * @return the largest error relative to the tolerances, at most 1.0 if the
+ * step is accurate enough
+ */
+template <class ACCELERATIONS>
+double IntegrateEmbeddedStep(double dt, const ACCELERATIONS &accelerations,
+                             const gtsam::Vector &q, const gtsam::Vector &v,
+                             const gtsam::Vector &a, gtsam::Vector *q1,
+                             gtsam::Vector *v1, gtsam::Vector *a1,
+                             IntegrationWorkspace *workspace,
+                             const AdaptiveStepParams &params) {
+  IntegrationWorkspace &w = *workspace;
+  if (w.q.size() != q.size()) w.resize(q.size());
+  w.q = q + 0.5 * dt * v;
+  w.v = v + 0.5 * dt * a;
+  accelerations(w.q, w.v, &w.k2);
+  w.q = q + 0.75 * dt * w.v;
+  w.v3 = v + 0.75 * dt * w.k2;
+  accelerations(w.q, w.v3, &w.k3);
+  *q1 = q + dt * (2.0 / 9 * v + 1.0 / 3 * w.v + 4.0 / 9 * w.v3);
+  *v1 = v + dt * (2.0 / 9 * a + 1.0 / 3 * w.k2 + 4.0 / 9 * w.k3);
+  accelerations(*q1, *v1, a1);
+
+  // Difference with the second order solution, per coordinate.
+  double error = 0.0;
+  for (Eigen::Index j = 0; j < q.size(); ++j) {
+    const double e_q = dt * (-5.0 / 72 * v(j) + 1.0 / 12 * w.v(j) +
+                             1.0 / 9 * w.v3(j) - 1.0 / 8 * (*v1)(j));
+    const double e_v = dt * (-5.0 / 72 * a(j) + 1.0 / 12 * w.k2(j) +
+                             1.0 / 9 * w.k3(j) - 1.0 / 8 * (*a1)(j));
+    const double s_q = params.abs_tol +
+                       params.rel_tol * std::max(std::abs(q(j)),
+                                                 std::abs((*q1)(j)));
+    const double s_v = params.abs_tol +
+                       params.rel_tol * std::max(std::abs(v(j)),
+                                                 std::abs((*v1)(j)));
+    error = std::max({error, std::abs(e_q) / s_q, std::abs(e_v) / s_v});
+  }
+  return error;
+}
+
+/**
+ * Cubic Hermite interpolation of a step from (x0, xd0) to (x1, xd1), at the
+ * fraction s of its duration dt, e.g. of joint angles from their velocities.
+ */
+inline void HermiteInterpolate(double s, double dt, const gtsam::Vector &x0,
+                               const gtsam::Vector &xd0,
+                               const gtsam::Vector &x1,
+                               const gtsam::Vector &xd1, gtsam::Vector *x) {
+  const double s2 = s * s, s3 = s2 * s;
+  *x = (2 * s3 - 3 * s2 + 1) * x0 + (s3 - 2 * s2 + s) * dt * xd0 +
+       (3 * s2 - 2 * s3) * x1 + (s3 - s2) * dt * xd1;
+}
+
+}  // namespace gtdynamics
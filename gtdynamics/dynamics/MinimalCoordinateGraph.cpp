@@ -0,0 +1,343 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MinimalCoordinateGraph.cpp
+ * @brief Dynamics factor graphs on base and joint states only.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/dynamics/MinimalCoordinateGraph.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/Trace.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/slam/expressions.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Double_;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::OptionalJacobian;
+using gtsam::Pose3;
+using gtsam::Pose3_;
+using gtsam::Vector3;
+using gtsam::Vector3_;
+using gtsam::Vector6;
+using gtsam::Vector6_;
+
+namespace {
+/// Linear velocity, or acceleration, of a point on a link, in the link CoM
+/// frame, from the CoM twist, or twist acceleration, as in
+/// ContactKinematicsTwistConstraint.
+Vector3_ PointLinear(const Vector6_ &xi, const gtsam::Point3 &comPc) {
+  const gtsam::Matrix36 H =
+      Pose3(gtsam::Rot3(), -comPc).AdjointMap().bottomRows<3>();
+  const std::function<Vector3(Vector6)> f = [H](const Vector6 &V) {
+    return H * V;
+  };
+  return gtsam::linearExpression(f, xi, H);
+}
+}  // namespace
+
+/* ************************************************************************* */
+MinimalCoordinateGraph::MinimalCoordinateGraph(
+    const Robot &robot, const std::string &base_name,
+    const OptimizerSetting &opt, const std::optional<Vector3> &gravity)
+    : robot_(robot),
+      opt_(opt),
+      gravity_(gravity ? *gravity : Vector3(0, 0, -9.8)),
+      base_(robot.link(base_name)),
+      joint_graph_(opt, gravity_) {
+  const RobotTopology &topology = robot_.topology();
+  const RobotTopology::Tree &tree = topology.trees.at(base_->id());
+  if (static_cast<int>(tree.joints.size()) != robot_.numJoints()) {
+    throw std::invalid_argument(
+        "MinimalCoordinateGraph: the robot is not a tree connected to " +
+        base_name + ".");
+  }
+  for (size_t n = 0; n < tree.joints.size(); n++) {
+    const int j = tree.joints[n];
+    const JointSharedPtr &joint = topology.joints[j];
+    if (topology.parent_link[j] != tree.from[n]) {
+      throw std::invalid_argument("MinimalCoordinateGraph: joint " +
+                                  joint->name() + " points towards " +
+                                  base_name + ".");
+    }
+    if (joint->child()->isFixed()) {
+      throw std::invalid_argument("MinimalCoordinateGraph: only " + base_name +
+                                  " may be fixed.");
+    }
+    traversal_.push_back(j);
+    parent_joint_[joint->child()->id()] = joint;
+    child_joints_[tree.from[n]].push_back(joint);
+  }
+}
+
+/* ************************************************************************* */
+Pose3_ MinimalCoordinateGraph::pose(int link_id, int k) const {
+  if (link_id == base_->id()) {
+    if (!floatingBase()) return Pose3_(base_->getFixedPose());
+    return Pose3_(PoseKey(link_id, k));
+  }
+  const JointSharedPtr joint = parent_joint_.at(link_id);
+  Pose3_ pTc(
+      [joint](double q, OptionalJacobian<6, 1> H_q) {
+        return joint->parentTchild(q, H_q);
+      },
+      Double_(JointAngleKey(joint->id(), k)));
+  return pose(joint->parent()->id(), k) * pTc;
+}
+
+/* ************************************************************************* */
+Vector6_ MinimalCoordinateGraph::twist(int link_id, int k) const {
+  if (link_id == base_->id()) {
+    if (!floatingBase()) return Vector6_(gtsam::Z_6x1);
+    return Vector6_(TwistKey(link_id, k));
+  }
+  const JointSharedPtr joint = parent_joint_.at(link_id);
+  return Vector6_(
+      [joint](double q, double q_dot, const Vector6 &twist_p,
+              OptionalJacobian<6, 1> H_q, OptionalJacobian<6, 1> H_q_dot,
+              OptionalJacobian<6, 6> H_twist_p) {
+        return joint->transformTwistTo(joint->child(), q, q_dot, twist_p, H_q,
+                                       H_q_dot, H_twist_p);
+      },
+      Double_(JointAngleKey(joint->id(), k)),
+      Double_(JointVelKey(joint->id(), k)), twist(joint->parent()->id(), k));
+}
+
+/* ************************************************************************* */
+Vector6_ MinimalCoordinateGraph::twistAccel(int link_id, int k) const {
+  if (link_id == base_->id()) {
+    if (!floatingBase()) return Vector6_(gtsam::Z_6x1);
+    return Vector6_(TwistAccelKey(link_id, k));
+  }
+
+  // Split in two, as in Joint::twistAccelConstraint, as expressions take at
+  // most three arguments.
+  const JointSharedPtr joint = parent_joint_.at(link_id);
+  Vector6_ accel_p(
+      [joint](double q, const Vector6 &twist_accel_p,
+              OptionalJacobian<6, 1> H_q,
+              OptionalJacobian<6, 6> H_twist_accel_p) {
+        gtsam::Matrix61 cTp_H_q;
+        gtsam::Matrix6 H_cTp;
+        const Pose3 cTp =
+            joint->relativePoseOf(joint->parent(), q, H_q ? &cTp_H_q : nullptr);
+        const Vector6 accel = cTp.Adjoint(
+            twist_accel_p, H_q ? &H_cTp : nullptr, H_twist_accel_p);
+        if (H_q) *H_q = H_cTp * cTp_H_q;
+        return accel;
+      },
+      Double_(JointAngleKey(joint->id(), k)),
+      twistAccel(joint->parent()->id(), k));
+  Vector6_ accel_q(
+      [joint](double q_dot, double q_ddot, const Vector6 &twist_c,
+              OptionalJacobian<6, 1> H_q_dot, OptionalJacobian<6, 1> H_q_ddot,
+              OptionalJacobian<6, 6> H_twist_c) {
+        const Vector6 S = joint->screwAxis(joint->child());
+        if (H_q_dot) *H_q_dot = Pose3::adjointMap(twist_c) * S;
+        if (H_q_ddot) *H_q_ddot = S;
+        return Vector6(Pose3::adjoint(twist_c, S * q_dot, H_twist_c) +
+                       S * q_ddot);
+      },
+      Double_(JointVelKey(joint->id(), k)),
+      Double_(JointAccelKey(joint->id(), k)), twist(link_id, k));
+  return accel_p + accel_q;
+}
+
+/* ************************************************************************* */
+std::vector<gtsam::Key> MinimalCoordinateGraph::contactWrenchKeys(
+    int link_id, int k,
+    const std::optional<PointOnLinks> &contact_points) const {
+  std::vector<gtsam::Key> keys;
+  if (!contact_points) return keys;
+  for (auto &&cp : *contact_points) {
+    if (cp.link->id() != link_id) continue;
+    keys.push_back(ContactWrenchKey(link_id, 0, k));
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+Vector6_ MinimalCoordinateGraph::netWrench(
+    int link_id, int k,
+    const std::optional<PointOnLinks> &contact_points) const {
+  using std::placeholders::_1;
+  using std::placeholders::_2;
+  const LinkSharedPtr &link = robot_.topology().links[link_id];
+
+  // The link wrench balance of Link::wrenchConstraint, solved for the wrench
+  // of the parent joint.
+  const gtsam::Matrix6 &inertia = link->inertiaMatrix();
+  Vector6_ momentum(std::bind(MatVecMult<6, 6>, inertia, _1, _2),
+                    twistAccel(link_id, k));
+  Vector6_ coriolis(std::bind(Coriolis, inertia, _1, _2), twist(link_id, k));
+  Vector6_ gravity(std::bind(GravityWrench, gravity_, link->mass(), _1, _2),
+                   pose(link_id, k));
+  Vector6_ wrench = momentum - coriolis - gravity;
+  for (gtsam::Key key : contactWrenchKeys(link_id, k, contact_points)) {
+    wrench = wrench - Vector6_(key);
+  }
+
+  // Wrenches of the child joints, by wrench equivalence.
+  auto it = child_joints_.find(link_id);
+  if (it == child_joints_.end()) return wrench;
+  for (const JointSharedPtr &joint : it->second) {
+    Vector6_ wrench_c(
+        [joint](double q, const Vector6 &wrench,
+                OptionalJacobian<6, 1> H_q, OptionalJacobian<6, 6> H_wrench) {
+          return joint->transformWrenchCoordinate(joint->child(), q, wrench,
+                                                  H_q, H_wrench);
+        },
+        Double_(JointAngleKey(joint->id(), k)),
+        netWrench(joint->child()->id(), k, contact_points));
+    wrench = wrench + wrench_c;
+  }
+  return wrench;
+}
+
+/* ************************************************************************* */
+Vector6_ MinimalCoordinateGraph::wrench(
+    int joint_id, int k,
+    const std::optional<PointOnLinks> &contact_points) const {
+  const JointSharedPtr &joint = robot_.topology().joints[joint_id];
+  return netWrench(joint->child()->id(), k, contact_points);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MinimalCoordinateGraph::dynamicsFactorGraph(
+    int k, const std::optional<PointOnLinks> &contact_points,
+    const std::optional<double> &mu) const {
+  GTD_TRACE_SCOPE("MinimalCoordinateGraph::dynamicsFactorGraph", "graph");
+  NonlinearFactorGraph graph;
+
+  // Joint torques, and the wrench balance of a floating base.
+  for (int j : traversal_) {
+    const JointSharedPtr &joint = robot_.topology().joints[j];
+    Double_ torque(
+        [joint](const Vector6 &wrench, OptionalJacobian<1, 6> H_wrench) {
+          return joint->transformWrenchToTorque(joint->child(), wrench,
+                                                H_wrench);
+        },
+        wrench(j, k, contact_points));
+    graph.emplace_shared<gtsam::ExpressionFactor<double>>(
+        opt_.t_cost_model, 0.0, torque - Double_(TorqueKey(j, k)));
+  }
+  if (floatingBase()) {
+    graph.emplace_shared<gtsam::ExpressionFactor<Vector6>>(
+        opt_.fa_cost_model, gtsam::Z_6x1,
+        netWrench(base_->id(), k, contact_points));
+  }
+  if (!contact_points) return graph;
+
+  // Contact kinematics and dynamics, as in DynamicsGraph.
+  const gtsam::Point3 up = gravity_.normalized().cwiseAbs();
+  auto cone = std::make_shared<ContactDynamicsFrictionConeFactor>(
+      0, 0, opt_.cfriction_cost_model, mu ? *mu : 1.0, gravity_);
+  for (auto &&cp : *contact_points) {
+    const int i = cp.link->id();
+    const gtsam::Key wrench_key = ContactWrenchKey(i, 0, k);
+    const Pose3_ wTcom = pose(i, k);
+    Double_ height = gtsam::dot(
+        gtsam::transformFrom(wTcom, gtsam::Point3_(cp.point)),
+        gtsam::Point3_(up));
+    graph.emplace_shared<gtsam::ExpressionFactor<double>>(opt_.cp_cost_model,
+                                                          0.0, height);
+    graph.emplace_shared<gtsam::ExpressionFactor<Vector3>>(
+        opt_.cv_cost_model, Vector3::Zero(),
+        PointLinear(twist(i, k), cp.point));
+    graph.emplace_shared<gtsam::ExpressionFactor<Vector3>>(
+        opt_.ca_cost_model, Vector3::Zero(),
+        PointLinear(twistAccel(i, k), cp.point));
+
+    Double_ friction(
+        [cone](const Pose3 &pose, const Vector6 &wrench,
+               OptionalJacobian<1, 6> H_pose,
+               OptionalJacobian<1, 6> H_wrench) {
+          Matrix H1, H2;
+          const gtsam::Vector error = cone->evaluateError(
+              pose, wrench, H_pose ? &H1 : nullptr, H_wrench ? &H2 : nullptr);
+          if (H_pose) *H_pose = H1;
+          if (H_wrench) *H_wrench = H2;
+          return error(0);
+        },
+        wTcom, Vector6_(wrench_key));
+    graph.emplace_shared<gtsam::ExpressionFactor<double>>(
+        opt_.cfriction_cost_model, 0.0, friction);
+    graph.emplace_shared<ContactDynamicsMomentFactor>(
+        wrench_key, opt_.cm_cost_model, Pose3(gtsam::Rot3(), -cp.point));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MinimalCoordinateGraph::collocationFactors(
+    int k, double dt, const CollocationScheme collocation) const {
+  NonlinearFactorGraph graph =
+      joint_graph_.collocationFactors(robot_, k, dt, collocation);
+  if (floatingBase()) {
+    const int i = base_->id();
+    graph.emplace_shared<FixTimeTrapezoidalPoseCollocationFactor>(
+        PoseKey(i, k), PoseKey(i, k + 1), TwistKey(i, k), TwistKey(i, k + 1),
+        dt, opt_.pose_col_cost_model);
+    graph.emplace_shared<FixTimeTrapezoidalTwistCollocationFactor>(
+        TwistKey(i, k), TwistKey(i, k + 1), TwistAccelKey(i, k),
+        TwistAccelKey(i, k + 1), dt, opt_.twist_col_cost_model);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MinimalCoordinateGraph::trajectoryFG(
+    int num_steps, double dt, const CollocationScheme collocation,
+    const std::optional<PointOnLinks> &contact_points,
+    const std::optional<double> &mu) const {
+  GTD_TRACE_SCOPE("MinimalCoordinateGraph::trajectoryFG", "graph");
+  NonlinearFactorGraph graph;
+  for (int k = 0; k <= num_steps; k++) {
+    graph.add(dynamicsFactorGraph(k, contact_points, mu));
+    if (k < num_steps) graph.add(collocationFactors(k, dt, collocation));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values MinimalCoordinateGraph::linkValues(
+    const gtsam::Values &values, int k,
+    const std::optional<PointOnLinks> &contact_points) const {
+  gtsam::Values link_values;
+  auto insert_link = [&](int i) {
+    InsertPose(&link_values, i, k, pose(i, k).value(values));
+    InsertTwist(&link_values, i, k, twist(i, k).value(values));
+    InsertTwistAccel(&link_values, i, k, twistAccel(i, k).value(values));
+  };
+  if (!floatingBase()) insert_link(base_->id());
+  for (int j : traversal_) {
+    const JointSharedPtr &joint = robot_.topology().joints[j];
+    const int child_id = joint->child()->id();
+    insert_link(child_id);
+    const Vector6 wrench_c = wrench(j, k, contact_points).value(values);
+    InsertWrench(&link_values, child_id, j, k, wrench_c);
+    InsertWrench(&link_values, joint->parent()->id(), j, k,
+                 -joint->transformWrenchCoordinate(
+                     joint->child(), JointAngle(values, j, k), wrench_c));
+  }
+  return link_values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MinimalCoordinateGraph.h
+ * @brief Dynamics factor graphs on base and joint states only.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/expressions.h>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Builder of dynamics factor graphs in minimal coordinates. Where
+ * DynamicsGraph has a pose, twist and twist acceleration per link and two
+ * wrenches per joint, the only variables here are the pose, twist and twist
+ * acceleration of the base link, unless it is fixed, the angle, velocity,
+ * acceleration and torque of each joint, and the contact wrenches, with the
+ * same keys as in DynamicsGraph. Link quantities are expressions inside the
+ * factors: CoM poses, twists and twist accelerations are chain products from
+ * the base outwards, and joint wrenches are accumulated inwards from the
+ * leaves, recursive Newton-Euler style, so each factor is differentiated by
+ * the expression machinery. Per time step there is one torque factor per
+ * joint and, for a floating base, one wrench balance factor on the base.
+ *
+ * The robot must be a tree whose joints all point away from the base, i.e.
+ * the base is the parent of its joints, and each link the parent of the
+ * joints further out. Contact points are handled as in DynamicsGraph, at
+ * most one per link; contact-implicit settings and parameter blocks are not
+ * supported.
+ */
+class MinimalCoordinateGraph {
+ public:
+  /**
+   * Constructor.
+   * @param robot     the robot, a tree rooted at the base link
+   * @param base_name name of the base link, fixed or floating
+   * @param opt       settings, for the cost models
+   * @param gravity   gravity in world frame, defaults to (0, 0, -9.8) as in
+   * DynamicsGraph::dynamicsFactors
+   */
+  MinimalCoordinateGraph(const Robot &robot, const std::string &base_name,
+                         const OptimizerSetting &opt = OptimizerSetting(),
+                         const std::optional<gtsam::Vector3> &gravity = {});
+
+  /// Whether the base is floating, i.e. has pose and twist variables.
+  bool floatingBase() const { return !base_->isFixed(); }
+
+  /// CoM pose of a link at time step k, in terms of base and joint variables.
+  gtsam::Pose3_ pose(int link_id, int k) const;
+
+  /// CoM twist of a link at time step k, in its CoM frame.
+  gtsam::Vector6_ twist(int link_id, int k) const;
+
+  /// CoM twist acceleration of a link at time step k, in its CoM frame.
+  gtsam::Vector6_ twistAccel(int link_id, int k) const;
+
+  /**
+   * Wrench on the child link of a joint from the joint at time step k, in the
+   * child CoM frame, i.e. the value of WrenchKey(child, joint, k).
+   */
+  gtsam::Vector6_ wrench(int joint_id, int k,
+                         const std::optional<PointOnLinks> &contact_points =
+                             {}) const;
+
+  /**
+   * Dynamics factors of time step k: torque factors, the wrench balance of a
+   * floating base, and contact kinematics and dynamics.
+   * @param k              time step
+   * @param contact_points optional contact points, at most one per link
+   * @param mu             optional coefficient of static friction
+   */
+  gtsam::NonlinearFactorGraph dynamicsFactorGraph(
+      int k, const std::optional<PointOnLinks> &contact_points = {},
+      const std::optional<double> &mu = {}) const;
+
+  /**
+   * Collocation factors from time step k to k+1: joints as in
+   * DynamicsGraph::collocationFactors, and the base pose and twist, if
+   * floating, always with trapezoidal collocation.
+   */
+  gtsam::NonlinearFactorGraph collocationFactors(
+      int k, double dt,
+      const CollocationScheme collocation = Trapezoidal) const;
+
+  /**
+   * Trajectory factor graph of time steps 0..num_steps, as
+   * DynamicsGraph::trajectoryFG.
+   */
+  gtsam::NonlinearFactorGraph trajectoryFG(
+      int num_steps, double dt,
+      const CollocationScheme collocation = Trapezoidal,
+      const std::optional<PointOnLinks> &contact_points = {},
+      const std::optional<double> &mu = {}) const;
+
+  /**
+   * The link quantities of time step k in maximal coordinates, evaluated at
+   * values with the variables of this graph: link poses, twists, twist
+   * accelerations and both wrenches of each joint, with the keys of
+   * DynamicsGraph; base variables already in values are not repeated. The
+   * union with values is then a solution of DynamicsGraph.
+   */
+  gtsam::Values linkValues(
+      const gtsam::Values &values, int k,
+      const std::optional<PointOnLinks> &contact_points = {}) const;
+
+ private:
+  Robot robot_;
+  OptimizerSetting opt_;
+  gtsam::Vector3 gravity_;
+  LinkSharedPtr base_;
+  DynamicsGraph joint_graph_;  // for joint collocation
+
+  /// Joint ids in breadth-first order from the base.
+  std::vector<int> traversal_;
+  /// Joint from the parent, and joints to the children, by link id.
+  std::map<int, JointSharedPtr> parent_joint_;
+  std::map<int, std::vector<JointSharedPtr>> child_joints_;
+
+  /// Contact wrench keys on a link, DynamicsGraph style.
+  std::vector<gtsam::Key> contactWrenchKeys(
+      int link_id, int k,
+      const std::optional<PointOnLinks> &contact_points) const;
+
+  /// Wrench the parent joint exerts on a link, in its CoM frame, from its
+  /// motion, gravity, contacts and the joints to its children. For a
+  /// floating base, the wrench balance error.
+  gtsam::Vector6_ netWrench(
+      int link_id, int k,
+      const std::optional<PointOnLinks> &contact_points) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.cpp
+ * @brief Trajectory optimization on segment boundary states and torques.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/MultipleShooting.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+/// Keys of a ShootingFactor, see its documentation.
+gtsam::KeyVector ShootingKeys(const std::vector<int> &joints, int k_start,
+                              int k_end) {
+  gtsam::KeyVector keys;
+  for (int j : joints) keys.push_back(JointAngleKey(j, k_start));
+  for (int j : joints) keys.push_back(JointVelKey(j, k_start));
+  for (int k = k_start; k < k_end; k++) {
+    for (int j : joints) keys.push_back(TorqueKey(j, k));
+  }
+  for (int j : joints) keys.push_back(JointAngleKey(j, k_end));
+  for (int j : joints) keys.push_back(JointVelKey(j, k_end));
+  return keys;
+}
+
+void CheckScheme(IntegrationScheme scheme, const std::string &name) {
+  if (scheme == RungeKutta4) {
+    throw std::invalid_argument(
+        name + ": only single-stage integration schemes are supported.");
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+ShootingFactor::ShootingFactor(const RecursiveDynamics &dynamics,
+                               const std::vector<int> &joints, int k_start,
+                               int k_end, double dt,
+                               const gtsam::SharedNoiseModel &cost_model,
+                               IntegrationScheme scheme)
+    : Base(cost_model, ShootingKeys(joints, k_start, k_end)),
+      dynamics_(std::make_shared<RecursiveDynamics>(dynamics)),
+      joints_(joints),
+      k_start_(k_start),
+      k_end_(k_end),
+      dt_(dt),
+      scheme_(scheme) {
+  CheckScheme(scheme, "ShootingFactor");
+  if (k_end <= k_start) {
+    throw std::invalid_argument("ShootingFactor: needs at least one step.");
+  }
+  if (cost_model->dim() != 2 * joints.size()) {
+    throw std::invalid_argument(
+        "ShootingFactor: cost model must have dimension 2 * joints.");
+  }
+}
+
+/* ************************************************************************* */
+void ShootingFactor::simulate(const Values &values,
+                              JointTrajectory *trajectory,
+                              std::vector<Matrix> *A,
+                              std::vector<Matrix> *B) const {
+  const Eigen::Index n = dynamics_->numJoints();
+  const size_t m = joints_.size();
+  const int num_steps = k_end_ - k_start_;
+  Vector q = Vector::Zero(n), v = Vector::Zero(n), tau = Vector::Zero(n);
+  Vector a(n);
+  for (size_t i = 0; i < m; i++) {
+    q(joints_[i]) = values.at<double>(keys_[i]);
+    v(joints_[i]) = values.at<double>(keys_[m + i]);
+  }
+  trajectory->resize(num_steps, n);
+  trajectory->q.row(0) = q.transpose();
+  trajectory->v.row(0) = v.transpose();
+
+  // q' = q + dt * v + c * dt^2 * a, v' = v + dt * a, with a(q, v, tau).
+  const double c = scheme_ == TaylorStep ? 0.5 : 1.0;
+  const double h = dt_, h2 = c * dt_ * dt_;
+  const Matrix I = Matrix::Identity(n, n);
+  Matrix a_H_q(n, n), a_H_v(n, n), a_H_tau(n, n);
+  if (A) {
+    A->assign(num_steps, Matrix(2 * n, 2 * n));
+    B->assign(num_steps, Matrix(2 * n, n));
+  }
+  for (int k = 0; k < num_steps; k++) {
+    for (size_t i = 0; i < m; i++) {
+      tau(joints_[i]) = values.at<double>(keys_[2 * m + k * m + i]);
+    }
+    if (A) {
+      dynamics_->forwardDynamicsDerivatives(q, v, tau, &a, &a_H_q, &a_H_v,
+                                            &a_H_tau);
+      Matrix &A_k = (*A)[k], &B_k = (*B)[k];
+      A_k.topLeftCorner(n, n) = I + h2 * a_H_q;
+      A_k.topRightCorner(n, n) = h * I + h2 * a_H_v;
+      A_k.bottomLeftCorner(n, n) = h * a_H_q;
+      A_k.bottomRightCorner(n, n) = I + h * a_H_v;
+      B_k.topRows(n) = h2 * a_H_tau;
+      B_k.bottomRows(n) = h * a_H_tau;
+    } else {
+      dynamics_->forwardDynamics(q, v, tau, &a);
+    }
+    q += h * v + h2 * a;
+    v += h * a;
+    trajectory->a.row(k) = a.transpose();
+    trajectory->q.row(k + 1) = q.transpose();
+    trajectory->v.row(k + 1) = v.transpose();
+  }
+}
+
+/* ************************************************************************* */
+JointTrajectory ShootingFactor::rollout(const Values &values) const {
+  JointTrajectory trajectory;
+  simulate(values, &trajectory);
+  return trajectory;
+}
+
+/* ************************************************************************* */
+Vector ShootingFactor::unwhitenedError(const Values &x,
+                                       gtsam::OptionalMatrixVecType H) const {
+  const Eigen::Index n = dynamics_->numJoints();
+  const size_t m = joints_.size();
+  const int num_steps = k_end_ - k_start_;
+  const size_t end = 2 * m + num_steps * m;
+
+  JointTrajectory trajectory;
+  std::vector<Matrix> A, B;
+  simulate(x, &trajectory, H ? &A : nullptr, H ? &B : nullptr);
+  Vector error(2 * m);
+  for (size_t i = 0; i < m; i++) {
+    error(i) =
+        x.at<double>(keys_[end + i]) - trajectory.q(num_steps, joints_[i]);
+    error(m + i) =
+        x.at<double>(keys_[end + m + i]) - trajectory.v(num_steps, joints_[i]);
+  }
+
+  if (H) {
+    // Rows of the state [q; v] with variables, in the order of the error.
+    auto rows = [&](const Matrix &J, Eigen::Index col) {
+      Matrix column(2 * m, 1);
+      for (size_t i = 0; i < m; i++) {
+        column(i, 0) = -J(joints_[i], col);
+        column(m + i, 0) = -J(n + joints_[i], col);
+      }
+      return column;
+    };
+
+    // Sensitivities backwards in time: P is the derivative of the end state
+    // with respect to the state at step k.
+    Matrix P = Matrix::Identity(2 * n, 2 * n);
+    for (int k = num_steps - 1; k >= 0; k--) {
+      const Matrix P_B = P * B[k];
+      for (size_t i = 0; i < m; i++) {
+        (*H)[2 * m + k * m + i] = rows(P_B, joints_[i]);
+      }
+      P = P * A[k];
+    }
+    for (size_t i = 0; i < m; i++) {
+      (*H)[i] = rows(P, joints_[i]);
+      (*H)[m + i] = rows(P, n + joints_[i]);
+    }
+    for (size_t i = 0; i < 2 * m; i++) {
+      (*H)[end + i] = Matrix::Zero(2 * m, 1);
+      (*H)[end + i](i, 0) = 1.0;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+MultipleShooting::MultipleShooting(const Robot &robot,
+                                   const std::optional<gtsam::Vector3> &gravity,
+                                   double dt, size_t segment_steps,
+                                   IntegrationScheme scheme)
+    : dynamics_(robot, gravity),
+      dt_(dt),
+      segment_steps_(segment_steps),
+      scheme_(scheme) {
+  CheckScheme(scheme, "MultipleShooting");
+  if (segment_steps < 1) {
+    throw std::invalid_argument(
+        "MultipleShooting: segments need at least one step.");
+  }
+  for (auto &&joint : robot.joints()) joints_.push_back(joint->id());
+  std::sort(joints_.begin(), joints_.end());
+}
+
+/* ************************************************************************* */
+std::vector<int> MultipleShooting::boundarySteps(int num_steps) const {
+  std::vector<int> steps;
+  for (int k = 0; k < num_steps; k += segment_steps_) steps.push_back(k);
+  steps.push_back(num_steps);
+  return steps;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph MultipleShooting::shootingFactors(
+    int num_steps, const gtsam::SharedNoiseModel &cost_model) const {
+  const gtsam::SharedNoiseModel model =
+      cost_model ? cost_model
+                 : gtsam::noiseModel::Isotropic::Sigma(2 * joints_.size(),
+                                                       0.001);
+  const std::vector<int> steps = boundarySteps(num_steps);
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t s = 0; s + 1 < steps.size(); s++) {
+    graph.emplace_shared<ShootingFactor>(dynamics_, joints_, steps[s],
+                                         steps[s + 1], dt_, model, scheme_);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values MultipleShooting::initialValues(const Values &state,
+                                       const Matrix &torques) const {
+  const int num_steps = torques.rows();
+  if (torques.cols() != static_cast<Eigen::Index>(numJoints())) {
+    throw std::invalid_argument(
+        "MultipleShooting::initialValues: torques need a column per joint "
+        "id.");
+  }
+  Values values;
+  for (int j : joints_) {
+    InsertJointAngle(&values, j, 0,
+                     state.exists(JointAngleKey(j)) ? JointAngle(state, j)
+                                                    : 0.0);
+    InsertJointVel(&values, j, 0,
+                   state.exists(JointVelKey(j)) ? JointVel(state, j) : 0.0);
+    for (int k = 0; k < num_steps; k++) {
+      InsertTorque(&values, j, k, torques(k, j));
+    }
+  }
+
+  // Roll out the segments one after the other, each from the end of the
+  // last, so that all defects are zero.
+  const std::vector<int> steps = boundarySteps(num_steps);
+  const auto graph = shootingFactors(num_steps);
+  for (size_t s = 0; s < graph.size(); s++) {
+    const auto &factor = static_cast<const ShootingFactor &>(*graph.at(s));
+    const JointTrajectory segment = factor.rollout(values);
+    const int last = steps[s + 1] - steps[s];
+    for (int j : joints_) {
+      InsertJointAngle(&values, j, steps[s + 1], segment.q(last, j));
+      InsertJointVel(&values, j, steps[s + 1], segment.v(last, j));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+JointTrajectory MultipleShooting::trajectory(
+    const Values &values, int num_steps,
+    const ExecutionContext &execution) const {
+  const auto graph = shootingFactors(num_steps);
+  JointTrajectory trajectory;
+  trajectory.resize(num_steps, numJoints());
+
+  // Segments write disjoint rows: all but their last state, which is the
+  // first of the next segment, except for the last segment.
+  execution.parallelFor(graph.size(), [&](size_t s) {
+    const auto &factor = static_cast<const ShootingFactor &>(*graph.at(s));
+    const JointTrajectory segment = factor.rollout(values);
+    const int k_start = factor.kStart(), length = factor.kEnd() - k_start;
+    const int rows = s + 1 == graph.size() ? length + 1 : length;
+    trajectory.q.middleRows(k_start, rows) = segment.q.topRows(rows);
+    trajectory.v.middleRows(k_start, rows) = segment.v.topRows(rows);
+    trajectory.a.middleRows(k_start, length) = segment.a;
+  });
+  return trajectory;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,184 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.h
+ * @brief Trajectory optimization on segment boundary states and torques.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ShootingFactor constrains the joint angles and velocities at the end of a
+ * segment of time steps k_start..k_end to those simulated from its start,
+ * with the torques of steps k_start..k_end-1, as the vector interface of
+ * Simulator does: forward dynamics with RecursiveDynamics, then one
+ * integration step. The error is the end state minus the simulated one.
+ *
+ * The Jacobians are the sensitivities of the rollout, the products of the
+ * linearized steps from the analytic forward dynamics derivatives, as in
+ * ILQROptimizer, so only single-stage integration schemes are supported.
+ * Each factor has its own copy of the solver and its work buffers, so
+ * different factors can be linearized concurrently.
+ *
+ * Keys are, in order: the joint angles, then velocities, at k_start; the
+ * torques of each step; the joint angles, then velocities, at k_end; each in
+ * the order of the joint ids given.
+ */
+class ShootingFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = ShootingFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::shared_ptr<RecursiveDynamics> dynamics_;
+  std::vector<int> joints_;
+  int k_start_, k_end_;
+  double dt_;
+  IntegrationScheme scheme_;
+
+ public:
+  /**
+   * Constructor.
+   * @param dynamics   the solver of the robot, copied
+   * @param joints     ids of the joints with variables
+   * @param k_start    first time step of the segment
+   * @param k_end      last time step, after k_start
+   * @param dt         duration of each time step
+   * @param cost_model noise model of dimension 2 * joints.size()
+   * @param scheme     TaylorStep or SemiImplicitEuler
+   */
+  ShootingFactor(const RecursiveDynamics &dynamics,
+                 const std::vector<int> &joints, int k_start, int k_end,
+                 double dt, const gtsam::SharedNoiseModel &cost_model,
+                 IntegrationScheme scheme = TaylorStep);
+
+  virtual ~ShootingFactor() {}
+
+  /// Error of the end state, with the sensitivities of the rollout.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override;
+
+  /**
+   * Simulate the segment from the start state and torques in values.
+   * @return the joint trajectory of steps k_start..k_end, indexed by joint id
+   */
+  JointTrajectory rollout(const gtsam::Values &values) const;
+
+  /// First and last time steps of the segment.
+  int kStart() const { return k_start_; }
+  int kEnd() const { return k_end_; }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+ private:
+  /// Rollout from values, with the linearization of each step if A and B.
+  void simulate(const gtsam::Values &values, JointTrajectory *trajectory,
+                std::vector<gtsam::Matrix> *A = nullptr,
+                std::vector<gtsam::Matrix> *B = nullptr) const;
+};
+
+/**
+ * Multiple shooting: the trajectory of num_steps time steps is split into
+ * segments of segment_steps steps, the last possibly shorter, and only the
+ * joint angles and velocities at the segment boundaries, and the torques of
+ * all steps, are variables. Each segment is a ShootingFactor between its
+ * boundary states, so the graph has one factor per segment instead of the
+ * link and joint variables and factors of every step of a collocation graph
+ * such as DynamicsGraph::trajectoryFG. MutableLMOptimizer linearizes the
+ * factors, and with them the rollouts, in parallel.
+ *
+ * The robot should be a fixed-base tree, as for ILQROptimizer. Objectives on
+ * the boundary states and the torques, e.g. priors and MinTorqueFactor, can
+ * be added to the graph.
+ */
+class MultipleShooting {
+ private:
+  RecursiveDynamics dynamics_;
+  std::vector<int> joints_;
+  double dt_;
+  size_t segment_steps_;
+  IntegrationScheme scheme_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot         the robot, must have tree topology
+   * @param gravity       gravity in world frame
+   * @param dt            duration of each time step
+   * @param segment_steps time steps of each segment, at least 1
+   * @param scheme        TaylorStep or SemiImplicitEuler
+   */
+  MultipleShooting(const Robot &robot,
+                   const std::optional<gtsam::Vector3> &gravity, double dt,
+                   size_t segment_steps, IntegrationScheme scheme = TaylorStep);
+
+  /// Time steps of the segment boundaries, from 0 to num_steps.
+  std::vector<int> boundarySteps(int num_steps) const;
+
+  /**
+   * One ShootingFactor per segment.
+   * @param num_steps  total time steps
+   * @param cost_model noise model of the shooting defects, by default
+   *                   isotropic with sigma 0.001 as OptimizerSetting
+   */
+  gtsam::NonlinearFactorGraph shootingFactors(
+      int num_steps,
+      const gtsam::SharedNoiseModel &cost_model = nullptr) const;
+
+  /**
+   * Values of all variables from one rollout of the whole trajectory, e.g.
+   * with the torques of a guess: the simulated joint angles and velocities
+   * at the boundaries, and the torques. The defects are then zero.
+   * @param state   joint angles and velocities at step 0, missing joints
+   *                are at zero
+   * @param torques num_steps x numJoints() torques, columns by joint id
+   */
+  gtsam::Values initialValues(const gtsam::Values &state,
+                              const gtsam::Matrix &torques) const;
+
+  /**
+   * The joint trajectory of all steps, from rollouts of the segments in
+   * parallel, each from its boundary state in values. At a boundary with a
+   * defect, the state of the later segment is used.
+   * @param values    boundary states and torques, e.g. a solution
+   * @param num_steps total time steps
+   * @param execution threads running the rollouts
+   */
+  JointTrajectory trajectory(
+      const gtsam::Values &values, int num_steps,
+      const ExecutionContext &execution = ExecutionContext::Default()) const;
+
+  /// Ids of the joints with variables.
+  const std::vector<int> &joints() const { return joints_; }
+
+  /// Size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return dynamics_.numJoints(); }
+};
+
+}  // namespace gtdynamics
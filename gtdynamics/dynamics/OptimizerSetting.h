@@ -13,10 +13,17 @@
 
 #pragma once
 
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/NoiseModels.h>
 #include <gtsam/linear/NoiseModel.h>
 
+#include <memory>
+
 namespace gtdynamics {
 
+class HeightMap;        // see utils/HeightMap.h
+class RobotParameters;  // see universal_robot/RobotParameters.h
+
 /// OptimizerSetting is a class used to set parameters for motion planner
 class OptimizerSetting {
  public:
@@ -42,6 +49,7 @@ class OptimizerSetting {
       cv_cost_model,             // contact twist
       ca_cost_model,             // contact acceleration
       cm_cost_model,             // contact moment
+      ccomp_cost_model,          // contact complementarity
       planar_cost_model,         // planar factor
       linear_planar_cost_model,  // linear planar factor
       prior_q_cost_model,        // joint angle prior factor
@@ -62,6 +70,44 @@ class OptimizerSetting {
                       // optimization
   int max_iter;       // max iteration for stopping optimization
 
+  /// Use the closed-form Jacobian joint factors in JointFactors.h, and
+  /// LinkWrenchFactor, instead of expression factors, for cheaper
+  /// linearization.
+  bool closed_form_jacobians = false;
+
+  /// If given, the closed-form factors read the link inertias and the joints
+  /// from this block at every evaluation, so graphs are built once and its
+  /// parameters changed between solves; implies closed_form_jacobians.
+  std::shared_ptr<const RobotParameters> robot_parameters;
+
+  /// Enforce the friction cones of all contacts of a time step with one
+  /// FrictionConesFactor, optionally with the linear pyramid approximation.
+  bool batch_friction_cones = false;
+  bool friction_pyramid = false;
+
+  /// Impose the joint collocation of each time step with one
+  /// JointsCollocationFactor on all joints.
+  bool banded_collocation = false;
+
+  /// Enforce the joint limits of each time step with one JointsLimitFactor on
+  /// all joints, instead of four JointLimitFactors per joint.
+  bool batch_joint_limits = false;
+
+  /// If given, contacts are on this terrain instead of the flat ground, with
+  /// TerrainHeightFactor and TerrainFrictionConeFactor, which take
+  /// precedence over batch_friction_cones; gravity must then be along -z.
+  std::shared_ptr<const HeightMap> terrain;
+
+  /// Contact-implicit mode: instead of fixing the contact points to the
+  /// ground, add a ContactComplementarityFactor per contact point, with the
+  /// given relaxation, so that the optimizer decides which points touch.
+  bool contact_implicit = false;
+  double complementarity_relaxation = 0.0;
+
+  /// Threads of the graph builders, which build the time steps of trajectory
+  /// graphs in parallel.
+  ExecutionContext execution = ExecutionContext::Default();
+
   /// collision checking setting
   double epsilon;   // obstacle clearance
   double obsSigma;  // obstacle cost model covariance
@@ -104,6 +150,7 @@ class OptimizerSetting {
         cv_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
         ca_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
         cm_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
+        ccomp_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
         planar_cost_model(
             gtsam::noiseModel::Isotropic::Sigma(3, sigma_dynamics)),
         linear_planar_cost_model(
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonOptimizer.cpp
+ * @brief Model predictive control over a shifting trajectory horizon.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/RecedingHorizonOptimizer.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <chrono>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::PriorFactor;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RecedingHorizonOptimizer::RecedingHorizonOptimizer(
+    const Robot &robot, const DynamicsGraph &graph_builder, int num_steps,
+    double dt, const gtsam::LevenbergMarquardtParams &params,
+    const std::optional<double> &max_time, CollocationScheme collocation)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      num_steps_(num_steps),
+      dynamics_graph_(
+          graph_builder.trajectoryFG(robot, num_steps, dt, collocation)),
+      params_(params),
+      max_time_(max_time) {}
+
+/* ************************************************************************* */
+NonlinearFactorGraph RecedingHorizonOptimizer::statePriors(
+    const Values &state) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  NonlinearFactorGraph priors;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    if (state.exists(JointAngleKey(j))) {
+      priors.emplace_shared<PriorFactor<double>>(
+          JointAngleKey(j), JointAngle(state, j), opt.prior_q_cost_model);
+    }
+    if (state.exists(JointVelKey(j))) {
+      priors.emplace_shared<PriorFactor<double>>(
+          JointVelKey(j), JointVel(state, j), opt.prior_qv_cost_model);
+    }
+  }
+  for (auto &&link : robot_.links()) {
+    const int i = link->id();
+    if (state.exists(PoseKey(i))) {
+      priors.emplace_shared<PriorFactor<Pose3>>(PoseKey(i), Pose(state, i),
+                                                opt.bp_cost_model);
+    }
+    if (state.exists(TwistKey(i))) {
+      priors.emplace_shared<PriorFactor<Vector6>>(
+          TwistKey(i), Twist(state, i), opt.bv_cost_model);
+    }
+  }
+  return priors;
+}
+
+/* ************************************************************************* */
+const Values &RecedingHorizonOptimizer::update(
+    const Values &state, const NonlinearFactorGraph &objectives,
+    const Values &initial) {
+  const auto start = std::chrono::steady_clock::now();
+
+  // Warm start from the last solution moved one step back, repeating its last
+  // step; on the first tick, use the given or zero initial values.
+  Values init;
+  if (!solution_.empty()) {
+    init = ShiftTime(solution_, -1);
+    init.insert(
+        TimeSliceIndex(solution_).slice(solution_, num_steps_, num_steps_ + 1));
+  } else if (!initial.empty()) {
+    init = initial;
+  } else {
+    init = Initializer().ZeroValuesTrajectory(robot_, num_steps_);
+  }
+  for (const gtsam::Key &key : state.keys()) {
+    if (init.exists(key)) {
+      init.update(key, state.at(key));
+    } else {
+      init.insert(key, state.at(key));
+    }
+  }
+
+  NonlinearFactorGraph graph = dynamics_graph_;
+  graph.add(statePriors(state));
+  graph.add(objectives);
+
+  // Iterate until convergence, or until the iteration or time budget is spent.
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, init, params_);
+  double error = optimizer.error();
+  while (optimizer.iterations() < params_.maxIterations) {
+    optimizer.iterate();
+    const double new_error = optimizer.error();
+    const bool converged = gtsam::checkConvergence(
+        params_.relativeErrorTol, params_.absoluteErrorTol, params_.errorTol,
+        error, new_error);
+    error = new_error;
+    if (converged || optimizer.lambda() > params_.lambdaUpperBound) break;
+    if (max_time_) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (elapsed.count() > *max_time_) break;
+    }
+  }
+
+  iterations_ = optimizer.iterations();
+  solution_ = optimizer.values();
+  return solution_;
+}
+
+}  // namespace gtdynamics
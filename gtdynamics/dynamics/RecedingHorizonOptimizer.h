@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonOptimizer.h
+ * @brief Model predictive control over a shifting trajectory horizon.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <optional>
+
+namespace gtdynamics {
+
+/**
+ * RecedingHorizonOptimizer solves a trajectory optimization problem over a
+ * horizon of num_steps time steps at every control tick.
+ *
+ * Time steps are relative to the current tick: step 0 is the measured state,
+ * so the dynamics and collocation factors (DynamicsGraph::trajectoryFG) are
+ * built once, and only the state priors and objectives change per tick. After
+ * the first tick, the previous solution shifted one step back in time (the
+ * old step t becomes t-1, the old last step is repeated) warm-starts the
+ * optimizer. Iterations are capped by the Levenberg-Marquardt parameters and,
+ * optionally, by a wall-clock budget per tick.
+ */
+class RecedingHorizonOptimizer {
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  int num_steps_;
+  gtsam::NonlinearFactorGraph dynamics_graph_;
+  gtsam::LevenbergMarquardtParams params_;
+  std::optional<double> max_time_;
+
+  gtsam::Values solution_;
+  size_t iterations_ = 0;
+
+  /// Priors pinning step 0 to the measured state.
+  gtsam::NonlinearFactorGraph statePriors(const gtsam::Values &state) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot         the robot
+   * @param graph_builder builds the trajectory factors, and its settings
+   * provide the noise models of the state priors
+   * @param num_steps     number of time steps in the horizon
+   * @param dt            duration of each time step
+   * @param params        optimizer parameters, maxIterations caps each tick
+   * @param max_time      optional wall-clock budget per tick, in seconds
+   * @param collocation   the collocation scheme
+   */
+  RecedingHorizonOptimizer(
+      const Robot &robot, const DynamicsGraph &graph_builder, int num_steps,
+      double dt,
+      const gtsam::LevenbergMarquardtParams &params =
+          gtsam::LevenbergMarquardtParams(),
+      const std::optional<double> &max_time = {},
+      CollocationScheme collocation = Trapezoidal);
+
+  /**
+   * Optimize the horizon for one control tick.
+   * @param state      measured state at step 0: joint angles and velocities,
+   * and link poses and twists of a floating base if any
+   * @param objectives costs and constraints on steps 0 to num_steps
+   * @param initial    initial values for the first tick; defaults to zero
+   * values. Ignored on later ticks, which warm-start from the last solution.
+   * @return the solution, with step 0 at the current tick
+   */
+  const gtsam::Values &update(
+      const gtsam::Values &state, const gtsam::NonlinearFactorGraph &objectives,
+      const gtsam::Values &initial = gtsam::Values());
+
+  /// Forget the last solution, so the next tick starts from scratch.
+  void reset() { solution_.clear(); }
+
+  /// Solution of the last tick.
+  const gtsam::Values &solution() const { return solution_; }
+
+  /// Number of optimizer iterations in the last tick.
+  size_t iterations() const { return iterations_; }
+
+  /// Number of time steps in the horizon.
+  int numSteps() const { return num_steps_; }
+
+  /// The dynamics and collocation factors of the horizon.
+  const gtsam::NonlinearFactorGraph &dynamicsGraph() const {
+    return dynamics_graph_;
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,685 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecursiveDynamics.cpp
+ * @brief Recursive (tree-walking) solvers for the linear dynamics problems.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/// Joint dimensions below this threshold are treated as rigid.
+static constexpr double kRigidThreshold = 1e-12;
+
+/// Task inertias with a smaller reciprocal condition number are singular.
+static constexpr double kSingularThreshold = 1e-12;
+
+/* ************************************************************************* */
+RecursiveDynamics::RecursiveDynamics(
+    const Robot &robot, const std::optional<gtsam::Vector3> &gravity)
+    : gravity_(gravity),
+      robot_links_(robot.links()),
+      robot_joints_(robot.joints()) {
+  for (auto &&link : robot_links_) fixed_links_.push_back(link->isFixed());
+  buildTree(robot);
+}
+
+/* ************************************************************************* */
+bool RecursiveDynamics::builtFor(const Robot &robot) const {
+  if (robot.links() != robot_links_ || robot.joints() != robot_joints_) {
+    return false;
+  }
+  for (size_t i = 0; i < robot_links_.size(); ++i) {
+    if (robot_links_[i]->isFixed() != fixed_links_[i]) return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::buildTree(const Robot &robot) {
+  const auto &links = robot.links();
+  std::set<uint8_t> visited;
+
+  // Breadth-first search from a root, appending to the traversal order.
+  auto bfs = [&](const LinkSharedPtr &root) {
+    std::queue<int> q;
+    links_.push_back(root);
+    parent_joints_.push_back(nullptr);
+    parent_indices_.push_back(-1);
+    visited.insert(root->id());
+    q.push(links_.size() - 1);
+    while (!q.empty()) {
+      const int k = q.front();
+      q.pop();
+      const LinkSharedPtr link = links_[k];
+      for (auto &&joint : link->joints()) {
+        if (joint == parent_joints_[k]) continue;
+        const LinkSharedPtr other = joint->otherLink(link);
+        if (visited.count(other->id())) {
+          throw std::runtime_error(
+              "RecursiveDynamics: kinematic loop detected at joint " +
+              joint->name() + ", use the factor graph solver instead.");
+        }
+        if (other->isFixed()) {
+          throw std::runtime_error(
+              "RecursiveDynamics: more than one fixed link in the tree "
+              "containing " +
+              other->name() + ", use the factor graph solver instead.");
+        }
+        links_.push_back(other);
+        parent_joints_.push_back(joint);
+        parent_indices_.push_back(k);
+        visited.insert(other->id());
+        q.push(links_.size() - 1);
+      }
+    }
+  };
+
+  // Fixed links are roots of their component.
+  for (auto &&link : links) {
+    if (link->isFixed() && !visited.count(link->id())) bfs(link);
+  }
+
+  // Remaining components are floating, root them at any link.
+  for (auto &&link : links) {
+    if (!visited.count(link->id())) bfs(link);
+  }
+
+  // Constant quantities and work buffers.
+  const size_t n = links_.size();
+  inertias_.resize(n);
+  screw_axes_.resize(n);
+  for (size_t k = 0; k < n; ++k) {
+    inertias_[k] = links_[k]->isFixed() ? Matrix6(Matrix6::Zero())
+                                        : links_[k]->inertiaMatrix();
+    screw_axes_[k] = parent_joints_[k]
+                         ? parent_joints_[k]->screwAxis(links_[k])
+                         : Vector6(Vector6::Zero());
+  }
+  for (auto &&joint : robot.joints()) {
+    num_joints_ = std::max<size_t>(num_joints_, joint->id() + 1);
+  }
+  poses_.resize(n);
+  for (auto *buffer : {&twists_, &zeta_, &bias_, &pA_, &U_, &A_, &F_}) {
+    buffer->assign(n, Vector6::Zero());
+  }
+  for (auto *buffer : {&Ad_, &IA_}) buffer->assign(n, Matrix6::Zero());
+  for (auto *buffer : {&qd_, &qdd_, &tau_, &D_, &u_}) buffer->assign(n, 0.0);
+  zero_joints_ = gtsam::Vector::Zero(num_joints_);
+
+  rigid_joints_.assign(num_joints_, true);
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_joints_[k] && screw_axes_[k].norm() > kRigidThreshold) {
+      rigid_joints_[parent_joints_[k]->id()] = false;
+    }
+  }
+  for (auto *buffer : {&Ag_, &dV_, &dA_, &dF_}) {
+    buffer->assign(n, Vector6::Zero());
+  }
+  M_ = gtsam::Matrix::Zero(num_joints_, num_joints_);
+  h_ = gtsam::Vector::Zero(num_joints_);
+  ldlt_ = Eigen::LDLT<gtsam::Matrix>(num_joints_);
+
+  size_t num_link_ids = 0;
+  for (auto &&link : links_) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  link_indices_.assign(num_link_ids, -1);
+  for (size_t k = 0; k < n; ++k) link_indices_[links_[k]->id()] = k;
+  task_poses_.resize(n);
+  L_ = gtsam::Matrix::Zero(num_joints_, num_joints_);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::loadKinematics(int t,
+                                       const Values &known_values) const {
+  for (size_t k = 0; k < links_.size(); ++k) {
+    poses_[k] = Pose(known_values, links_[k]->id(), t);
+    twists_[k] = Twist(known_values, links_[k]->id(), t);
+    if (parent_joints_[k]) {
+      qd_[k] = JointVel(known_values, parent_joints_[k]->id(), t);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::computeKinematics(const gtsam::Vector &q,
+                                          const gtsam::Vector &v) const {
+  for (size_t k = 0; k < links_.size(); ++k) {
+    const int p = parent_indices_[k];
+    if (p < 0) {
+      poses_[k] = links_[k]->isFixed() ? links_[k]->getFixedPose() : Pose3();
+      twists_[k].setZero();
+      continue;
+    }
+    const auto &joint = parent_joints_[k];
+    const int j = joint->id();
+    qd_[k] = v(j);
+    std::tie(poses_[k], twists_[k]) =
+        joint->otherPoseTwist(links_[p], poses_[p], twists_[p], q(j), v(j));
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::velocityTerms(bool with_gravity) const {
+  for (size_t k = 0; k < links_.size(); ++k) {
+    const int p = parent_indices_[k];
+    if (p >= 0) {
+      Ad_[k] = poses_[k].between(poses_[p]).AdjointMap();
+      zeta_[k] = Pose3::adjointMap(twists_[k]) * screw_axes_[k] * qd_[k];
+    }
+
+    if (links_[k]->isFixed()) {
+      bias_[k].setZero();
+      continue;
+    }
+    // Same right-hand side as the wrench factor in linearDynamicsGraph.
+    const Vector6 &V_k = twists_[k];
+    bias_[k] = -Pose3::adjointMap(V_k).transpose() * inertias_[k] * V_k;
+    if (gravity_ && with_gravity) {
+      bias_[k].tail<3>() -=
+          poses_[k].rotation().transpose() * (*gravity_) * links_[k]->mass();
+    }
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::articulatedBody() const {
+  const size_t n = links_.size();
+
+  // Inward recursion for articulated inertias and bias wrenches.
+  for (size_t k = 0; k < n; ++k) {
+    IA_[k] = inertias_[k];
+    pA_[k] = bias_[k];
+  }
+  for (int k = n - 1; k >= 0; --k) {
+    const int p = parent_indices_[k];
+    if (p < 0) continue;
+    const Vector6 &S = screw_axes_[k];
+    U_[k] = IA_[k] * S;
+    D_[k] = S.dot(U_[k]);
+    u_[k] = tau_[k] - S.dot(pA_[k]);
+
+    Matrix6 Ia = IA_[k];
+    if (D_[k] > kRigidThreshold) Ia -= U_[k] * U_[k].transpose() / D_[k];
+    Vector6 pa = pA_[k] + Ia * zeta_[k];
+    if (D_[k] > kRigidThreshold) pa += U_[k] * u_[k] / D_[k];
+
+    if (!links_[p]->isFixed()) {
+      IA_[p] += Ad_[k].transpose() * Ia * Ad_[k];
+      pA_[p] += Ad_[k].transpose() * pa;
+    }
+  }
+
+  // Outward recursion for accelerations and joint wrenches.
+  for (size_t k = 0; k < n; ++k) {
+    const int p = parent_indices_[k];
+    if (p < 0) {
+      // A fixed root does not move, a floating root has no joint wrench.
+      if (links_[k]->isFixed()) {
+        A_[k].setZero();
+      } else {
+        A_[k] = IA_[k].ldlt().solve(-pA_[k]);
+      }
+      continue;
+    }
+    const Vector6 A_prime = Ad_[k] * A_[p] + zeta_[k];
+    qdd_[k] =
+        D_[k] > kRigidThreshold ? (u_[k] - U_[k].dot(A_prime)) / D_[k] : 0.0;
+    A_[k] = A_prime + screw_axes_[k] * qdd_[k];
+    F_[k] = IA_[k] * A_[k] + pA_[k];
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::newtonEuler(bool solve_roots) const {
+  const size_t n = links_.size();
+
+  // Outward pass for twist accelerations, followed by inward pass for the
+  // wrench exerted on each link by its parent joint. Root accelerations are
+  // taken as given in A_. For a root, F_ holds the residual wrench.
+  auto passes = [&]() {
+    for (size_t k = 0; k < n; ++k) {
+      const int p = parent_indices_[k];
+      if (p >= 0) {
+        A_[k] = Ad_[k] * A_[p] + screw_axes_[k] * qdd_[k] + zeta_[k];
+      }
+    }
+    for (size_t k = 0; k < n; ++k) F_[k] = inertias_[k] * A_[k] + bias_[k];
+    for (int k = n - 1; k >= 0; --k) {
+      const int p = parent_indices_[k];
+      if (p >= 0 && !links_[p]->isFixed()) {
+        F_[p] += Ad_[k].transpose() * F_[k];
+      }
+    }
+  };
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_indices_[k] < 0) A_[k].setZero();
+  }
+  passes();
+
+  // Floating roots: the residual wrench is linear in the root acceleration,
+  // with the composite inertia of the component as coefficient.
+  bool has_floating_root = false;
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_indices_[k] < 0 && !links_[k]->isFixed()) {
+      has_floating_root = solve_roots;
+    }
+  }
+  if (has_floating_root) {
+    for (size_t k = 0; k < n; ++k) IA_[k] = inertias_[k];
+    for (int k = n - 1; k >= 0; --k) {
+      const int p = parent_indices_[k];
+      if (p >= 0) IA_[p] += Ad_[k].transpose() * IA_[k] * Ad_[k];
+    }
+    for (size_t k = 0; k < n; ++k) {
+      if (parent_indices_[k] < 0 && !links_[k]->isFixed()) {
+        A_[k] = IA_[k].ldlt().solve(-F_[k]);
+      }
+    }
+    passes();
+  }
+
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_indices_[k] >= 0) tau_[k] = screw_axes_[k].dot(F_[k]);
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::insertWrenchesAndAccels(int t, Values *values) const {
+  for (size_t k = 0; k < links_.size(); ++k) {
+    const auto &joint = parent_joints_[k];
+    if (joint) {
+      const int j = joint->id();
+      const int i = links_[k]->id();
+      const int i_parent = links_[parent_indices_[k]]->id();
+      InsertWrench(values, i, j, t, F_[k]);
+      InsertWrench(values, i_parent, j, t, -Ad_[k].transpose() * F_[k]);
+    }
+    InsertTwistAccel(values, links_[k]->id(), t, A_[k]);
+  }
+}
+
+/* ************************************************************************* */
+Values RecursiveDynamics::forwardDynamics(int t,
+                                          const Values &known_values) const {
+  loadKinematics(t, known_values);
+  for (size_t k = 0; k < links_.size(); ++k) {
+    if (parent_joints_[k]) {
+      tau_[k] = Torque(known_values, parent_joints_[k]->id(), t);
+    }
+  }
+  velocityTerms();
+  articulatedBody();
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (size_t k = 0; k < links_.size(); ++k) {
+      if (parent_joints_[k]) {
+        InsertJointAccel(&values, parent_joints_[k]->id(), t, qdd_[k]);
+      }
+    }
+    insertWrenchesAndAccels(t, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "RecursiveDynamics::forwardDynamics: known_values should contain no "
+        "accelerations or wrenches");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values RecursiveDynamics::inverseDynamics(int t,
+                                          const Values &known_values) const {
+  loadKinematics(t, known_values);
+  for (size_t k = 0; k < links_.size(); ++k) {
+    if (parent_joints_[k]) {
+      qdd_[k] = JointAccel(known_values, parent_joints_[k]->id(), t);
+    }
+  }
+  velocityTerms();
+  newtonEuler();
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (size_t k = 0; k < links_.size(); ++k) {
+      if (parent_joints_[k]) {
+        InsertTorque(&values, parent_joints_[k]->id(), t, tau_[k]);
+      }
+    }
+    insertWrenchesAndAccels(t, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "RecursiveDynamics::inverseDynamics: known_values should contain no "
+        "torques, wrenches, or twist accelerations.");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::forwardDynamics(const gtsam::Vector &q,
+                                        const gtsam::Vector &v,
+                                        const gtsam::Vector &tau,
+                                        gtsam::Vector *qdd) const {
+  computeKinematics(q, v);
+  for (size_t k = 0; k < links_.size(); ++k) {
+    if (parent_joints_[k]) tau_[k] = tau(parent_joints_[k]->id());
+  }
+  velocityTerms();
+  articulatedBody();
+  for (size_t k = 0; k < links_.size(); ++k) {
+    if (parent_joints_[k]) (*qdd)(parent_joints_[k]->id()) = qdd_[k];
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::massMatrix(const gtsam::Vector &q,
+                                   gtsam::Matrix *M) const {
+  computeKinematics(q, zero_joints_);
+  const size_t n = links_.size();
+  for (size_t k = 0; k < n; ++k) {
+    const int p = parent_indices_[k];
+    if (p >= 0) Ad_[k] = poses_[k].between(poses_[p]).AdjointMap();
+  }
+
+  // Composite inertias, stored in IA_.
+  for (size_t k = 0; k < n; ++k) IA_[k] = inertias_[k];
+  for (int k = n - 1; k >= 0; --k) {
+    const int p = parent_indices_[k];
+    if (p >= 0) IA_[p] += Ad_[k].transpose() * IA_[k] * Ad_[k];
+  }
+
+  // Column of each joint: project the wrench needed to accelerate it on all
+  // joints between it and the root.
+  M->setZero();
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_indices_[k] < 0) continue;
+    const int j_k = parent_joints_[k]->id();
+    Vector6 F = IA_[k] * screw_axes_[k];
+    (*M)(j_k, j_k) = screw_axes_[k].dot(F);
+    for (int i = k; parent_indices_[parent_indices_[i]] >= 0;) {
+      F = Ad_[i].transpose() * F;
+      i = parent_indices_[i];
+      const int j_i = parent_joints_[i]->id();
+      (*M)(j_i, j_k) = (*M)(j_k, j_i) = screw_axes_[i].dot(F);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::factorize(const gtsam::Vector &q) const {
+  massMatrix(q, &L_);
+  task_poses_ = poses_;
+  for (size_t j = 0; j < num_joints_; ++j) {
+    if (rigid_joints_[j]) L_(j, j) = 1.0;
+  }
+
+  // In place, from the leaves to the roots: the entries of a joint and its
+  // ancestors are the only ones touched, in the rows of descendants.
+  auto joint = [this](int k) { return parent_joints_[k]->id(); };
+  for (int k = links_.size() - 1; k >= 0; --k) {
+    if (!parent_joints_[k]) continue;
+    const int j_k = joint(k);
+    if (L_(j_k, j_k) <= 0) {
+      throw std::runtime_error(
+          "RecursiveDynamics::factorize: mass matrix is not positive "
+          "definite");
+    }
+    const double a = std::sqrt(L_(j_k, j_k));
+    L_(j_k, j_k) = a;
+    for (int i = parent_indices_[k]; parent_joints_[i];
+         i = parent_indices_[i]) {
+      L_(j_k, joint(i)) /= a;
+    }
+    for (int i = parent_indices_[k]; parent_joints_[i];
+         i = parent_indices_[i]) {
+      for (int l = i; parent_joints_[l]; l = parent_indices_[l]) {
+        L_(joint(i), joint(l)) -= L_(j_k, joint(i)) * L_(j_k, joint(l));
+      }
+    }
+  }
+  factorized_ = true;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::taskJacobian(const PointOnLink &point,
+                                     gtsam::Matrix *J) const {
+  if (!factorized_) {
+    throw std::runtime_error(
+        "RecursiveDynamics::taskJacobian: call factorize first");
+  }
+  const int id = point.link->id();
+  if (id >= static_cast<int>(link_indices_.size()) || link_indices_[id] < 0) {
+    throw std::invalid_argument(
+        "RecursiveDynamics::taskJacobian: link not in the robot");
+  }
+
+  // The world velocity of the point is R_i * (v_i + w_i x p) for the twist
+  // V_i of its link, which each joint up the tree contributes
+  // Ad(T_ik) * S_k * v_j to.
+  const int i = link_indices_[id];
+  gtsam::Matrix36 H_twist;
+  H_twist << gtsam::skewSymmetric(-point.point), gtsam::I_3x3;
+  H_twist = task_poses_[i].rotation().matrix() * H_twist;
+  J->setZero(3, num_joints_);
+  for (int k = i; parent_joints_[k]; k = parent_indices_[k]) {
+    const Vector6 S_i = task_poses_[i].between(task_poses_[k]).Adjoint(
+        screw_axes_[k]);
+    J->col(parent_joints_[k]->id()) = H_twist * S_i;
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::taskInertia(const gtsam::Matrix &J,
+                                    gtsam::Matrix *Lambda) const {
+  if (!factorized_) {
+    throw std::runtime_error(
+        "RecursiveDynamics::taskInertia: call factorize first");
+  }
+  if (J.cols() != static_cast<int>(num_joints_)) {
+    throw std::invalid_argument(
+        "RecursiveDynamics::taskInertia: J should have numJoints() columns");
+  }
+
+  // Solve L^T * X = J^T from the leaves to the roots, one row of X per
+  // joint, and subtract each solved row from the rows of its ancestors.
+  gtsam::Matrix X = J.transpose();
+  for (int k = links_.size() - 1; k >= 0; --k) {
+    if (!parent_joints_[k]) continue;
+    const int j_k = parent_joints_[k]->id();
+    X.row(j_k) /= L_(j_k, j_k);
+    for (int i = parent_indices_[k]; parent_joints_[i];
+         i = parent_indices_[i]) {
+      const int j_i = parent_joints_[i]->id();
+      X.row(j_i) -= L_(j_k, j_i) * X.row(j_k);
+    }
+  }
+  for (size_t j = 0; j < num_joints_; ++j) {
+    if (rigid_joints_[j]) X.row(j).setZero();
+  }
+
+  const Eigen::LLT<gtsam::Matrix> llt(X.transpose() * X);
+  if (llt.info() != Eigen::Success || llt.rcond() < kSingularThreshold) {
+    throw std::runtime_error(
+        "RecursiveDynamics::taskInertia: task Jacobian is singular");
+  }
+  *Lambda = llt.solve(gtsam::Matrix::Identity(J.rows(), J.rows()));
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::zeroAccelTorques(const gtsam::Vector &q,
+                                         const gtsam::Vector &v,
+                                         gtsam::Vector *tau,
+                                         bool with_gravity) const {
+  computeKinematics(q, v);
+  std::fill(qdd_.begin(), qdd_.end(), 0.0);
+  velocityTerms(with_gravity);
+  newtonEuler(false);
+  tau->setZero();
+  for (size_t k = 0; k < links_.size(); ++k) {
+    if (parent_joints_[k]) (*tau)(parent_joints_[k]->id()) = tau_[k];
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::biasTorques(const gtsam::Vector &q,
+                                    const gtsam::Vector &v,
+                                    gtsam::Vector *h) const {
+  zeroAccelTorques(q, v, h);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::gravityTorques(const gtsam::Vector &q,
+                                       gtsam::Vector *g) const {
+  zeroAccelTorques(q, zero_joints_, g);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::coriolisTorques(const gtsam::Vector &q,
+                                        const gtsam::Vector &v,
+                                        gtsam::Vector *c) const {
+  zeroAccelTorques(q, v, c, false);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::forwardDynamicsDerivatives(
+    const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &tau,
+    gtsam::Vector *qdd, gtsam::Matrix *qdd_H_q, gtsam::Matrix *qdd_H_v,
+    gtsam::Matrix *qdd_H_tau) const {
+  const size_t n = links_.size();
+
+  // Factorize the mass matrix, with unit diagonal for rigid joints.
+  massMatrix(q, &M_);
+  for (size_t j = 0; j < num_joints_; ++j) {
+    if (rigid_joints_[j]) M_(j, j) = 1.0;
+  }
+  ldlt_.compute(M_);
+  biasTorques(q, v, &h_);
+  *qdd = tau - h_;
+  ldlt_.solveInPlace(*qdd);
+  for (size_t j = 0; j < num_joints_; ++j) {
+    if (rigid_joints_[j]) (*qdd)(j) = 0.0;
+  }
+
+  // Newton-Euler at the solution, with roots held, as in massMatrix.
+  computeKinematics(q, v);
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_joints_[k]) qdd_[k] = (*qdd)(parent_joints_[k]->id());
+  }
+  velocityTerms();
+  newtonEuler(false);
+
+  // Gravity acts as an upward acceleration of the roots, which makes the
+  // recursion linear in the accelerations.
+  for (size_t k = 0; k < n; ++k) {
+    Ag_[k] = A_[k];
+    if (gravity_) {
+      Ag_[k].tail<3>() -= poses_[k].rotation().transpose() * (*gravity_);
+    }
+  }
+
+  // Columns of the inverse dynamics derivatives, one tangent pass each.
+  qdd_H_q->setZero();
+  qdd_H_v->setZero();
+  for (size_t m = 0; m < n; ++m) {
+    if (!parent_joints_[m] || rigid_joints_[parent_joints_[m]->id()]) continue;
+    newtonEulerTangent(m, false, qdd_H_q);
+    newtonEulerTangent(m, true, qdd_H_v);
+  }
+  ldlt_.solveInPlace(*qdd_H_q);
+  ldlt_.solveInPlace(*qdd_H_v);
+  *qdd_H_q = -*qdd_H_q;
+  *qdd_H_v = -*qdd_H_v;
+
+  qdd_H_tau->setIdentity();
+  ldlt_.solveInPlace(*qdd_H_tau);
+  for (size_t j = 0; j < num_joints_; ++j) {
+    if (!rigid_joints_[j]) continue;
+    for (auto *H : {qdd_H_q, qdd_H_v, qdd_H_tau}) H->row(j).setZero();
+    qdd_H_tau->col(j).setZero();
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::newtonEulerTangent(size_t m, bool velocity,
+                                           gtsam::Matrix *dtau) const {
+  const size_t n = links_.size();
+  const Vector6 &S_m = screw_axes_[m];
+
+  // Outward pass: a change of q_m turns Ad_m into (I - ad(S_m)) * Ad_m, a
+  // change of v_m adds S_m to the twist.
+  for (size_t k = 0; k < n; ++k) {
+    const int p = parent_indices_[k];
+    if (p < 0) {
+      dV_[k].setZero();
+      dA_[k].setZero();
+      continue;
+    }
+    dV_[k] = Ad_[k] * dV_[p];
+    dA_[k] = Ad_[k] * dA_[p];
+    if (k == m) {
+      if (velocity) {
+        dV_[k] += S_m;
+        dA_[k] += Pose3::adjointMap(twists_[k]) * S_m;
+      } else {
+        dV_[k] -= Pose3::adjointMap(S_m) * (Ad_[k] * twists_[p]);
+        dA_[k] -= Pose3::adjointMap(S_m) * (Ad_[k] * Ag_[p]);
+      }
+    }
+    dA_[k] += Pose3::adjointMap(dV_[k]) * screw_axes_[k] * qd_[k];
+  }
+
+  // Inward pass for the wrenches, F_k = G_k * Ag_k - ad(V_k)^T * G_k * V_k
+  // plus the wrenches of the children.
+  for (size_t k = 0; k < n; ++k) {
+    const Matrix6 &G = inertias_[k];
+    dF_[k] = G * dA_[k] -
+             Pose3::adjointMap(dV_[k]).transpose() * (G * twists_[k]) -
+             Pose3::adjointMap(twists_[k]).transpose() * (G * dV_[k]);
+  }
+  for (int k = n - 1; k >= 0; --k) {
+    const int p = parent_indices_[k];
+    if (p < 0 || links_[p]->isFixed()) continue;
+    dF_[p] += Ad_[k].transpose() * dF_[k];
+    if (!velocity && k == static_cast<int>(m)) {
+      dF_[p] -= Ad_[k].transpose() * (Pose3::adjointMap(S_m).transpose() *
+                                      F_[k]);
+    }
+  }
+
+  const int j_m = parent_joints_[m]->id();
+  for (size_t k = 0; k < n; ++k) {
+    if (parent_joints_[k]) {
+      (*dtau)(parent_joints_[k]->id(), j_m) = screw_axes_[k].dot(dF_[k]);
+    }
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,294 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecursiveDynamics.h
+ * @brief Recursive (tree-walking) solvers for the linear dynamics problems.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Cholesky>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RecursiveDynamics solves the same linear forward and inverse dynamics
+ * problems as DynamicsGraph::linearSolveFD and linearSolveID, but by walking a
+ * spanning tree of the robot instead of eliminating a Gaussian factor graph.
+ * Conventions follow the factor graph exactly: twists and wrenches are
+ * expressed in link CoM frames, F_i_j is the wrench exerted by joint j on
+ * link i, and torques are the projection of the joint wrench onto the screw
+ * axis.
+ *
+ * The tree is rooted at the fixed link of each connected component, or at an
+ * arbitrary link if the component is floating. Kinematic loops and components
+ * with more than one fixed link are not supported and throw on construction;
+ * use the factor graph solver for those.
+ *
+ * The spanning tree and all work buffers are allocated once in the
+ * constructor, so the object should be kept around when solving many time
+ * steps for the same robot. It shares the robot's links and joints rather
+ * than copying the robot. Because the buffers are shared between calls, a
+ * RecursiveDynamics object must not be used from several threads at once;
+ * give each thread its own copy instead.
+ */
+class RecursiveDynamics {
+ private:
+  std::optional<gtsam::Vector3> gravity_;
+
+  /// Links and joints of the robot, sorted by name, and which links were
+  /// fixed, when the tree was built.
+  std::vector<LinkSharedPtr> robot_links_;
+  std::vector<JointSharedPtr> robot_joints_;
+  std::vector<bool> fixed_links_;
+
+  /// Links in breadth-first order, parents always precede children.
+  std::vector<LinkSharedPtr> links_;
+
+  /// Joint connecting each link to its parent in the tree (null for roots).
+  std::vector<JointSharedPtr> parent_joints_;
+
+  /// Index into links_ of the parent of each link (-1 for roots).
+  std::vector<int> parent_indices_;
+
+  /// Index into links_ of each link id (-1 for unused ids).
+  std::vector<int> link_indices_;
+
+  /// Largest joint id plus one.
+  size_t num_joints_ = 0;
+
+  /// Constant per-link quantities, in traversal order.
+  std::vector<gtsam::Matrix6> inertias_;
+  std::vector<gtsam::Vector6> screw_axes_;
+
+  /// Work buffers, in traversal order. Joint quantities refer to the joint
+  /// connecting each link to its parent.
+  mutable std::vector<gtsam::Pose3> poses_;
+  mutable std::vector<gtsam::Vector6> twists_, zeta_, bias_, pA_, U_, A_, F_;
+  mutable std::vector<gtsam::Matrix6> Ad_, IA_;
+  mutable std::vector<double> qd_, qdd_, tau_, D_, u_;
+  gtsam::Vector zero_joints_;
+
+  /// Joint ids without a degree of freedom: fixed joints, and unused ids.
+  std::vector<bool> rigid_joints_;
+
+  /// Work buffers of forwardDynamicsDerivatives: accelerations offset by
+  /// gravity, tangents of twists, accelerations and wrenches, and the mass
+  /// matrix with its factorization.
+  mutable std::vector<gtsam::Vector6> Ag_, dV_, dA_, dF_;
+  mutable gtsam::Matrix M_;
+  mutable gtsam::Vector h_;
+  mutable Eigen::LDLT<gtsam::Matrix> ldlt_;
+
+  /// Operational space: poses at the factorized configuration, and the
+  /// factor L of M = L^T * L, nonzero only where M is.
+  mutable std::vector<gtsam::Pose3> task_poses_;
+  mutable gtsam::Matrix L_;
+  mutable bool factorized_ = false;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot    the robot, must have tree topology
+   * @param gravity  gravity in world frame
+   */
+  explicit RecursiveDynamics(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {});
+
+  /**
+   * Solve forward dynamics with the Articulated Body Algorithm.
+   *
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint velocities and
+   * torques for all links/joints at time t.
+   * @return known_values with joint accelerations, twist accelerations and
+   * wrenches added, i.e., the same result as DynamicsGraph::linearSolveFD.
+   */
+  gtsam::Values forwardDynamics(int t, const gtsam::Values &known_values) const;
+
+  /**
+   * Solve inverse dynamics with the Recursive Newton-Euler Algorithm.
+   *
+   * For floating components the root acceleration is not given by the joint
+   * accelerations; it is solved for using the composite inertia of the
+   * component, such that the root link has no external wrench.
+   *
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint velocities and
+   * joint accelerations for all links/joints at time t.
+   * @return known_values with torques, twist accelerations and wrenches
+   * added, i.e., the same result as DynamicsGraph::linearSolveID.
+   */
+  gtsam::Values inverseDynamics(int t, const gtsam::Values &known_values) const;
+
+  /**
+   * Allocation-free forward dynamics on flat joint vectors, indexed by joint
+   * id. Forward kinematics is done internally, with fixed links at their fixed
+   * pose and floating roots at the identity with zero twist, as in
+   * Robot::forwardKinematics without a prior link.
+   *
+   * @param q    joint angles
+   * @param v    joint velocities
+   * @param tau  joint torques
+   * @param qdd  joint accelerations, must already have size numJoints()
+   */
+  void forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau, gtsam::Vector *qdd) const;
+
+  /**
+   * @name Joint-space dynamics
+   * Terms of tau = M(q) * qdd + C(q, v) * v + g(q), for the robot with all
+   * root links held at their fixed pose, or at the identity if floating.
+   * Vectors and matrices are indexed by joint id and must already have size
+   * numJoints(); rows and columns of fixed joints are zero.
+   * @{
+   */
+
+  /// Joint-space mass matrix M(q), with the Composite Rigid Body Algorithm.
+  void massMatrix(const gtsam::Vector &q, gtsam::Matrix *M) const;
+
+  /// Bias torques C(q, v) * v + g(q), with one Newton-Euler pass.
+  void biasTorques(const gtsam::Vector &q, const gtsam::Vector &v,
+                   gtsam::Vector *h) const;
+
+  /// Gravity torques g(q), with one Newton-Euler pass.
+  void gravityTorques(const gtsam::Vector &q, gtsam::Vector *g) const;
+
+  /// Coriolis and centrifugal torques C(q, v) * v, without gravity.
+  void coriolisTorques(const gtsam::Vector &q, const gtsam::Vector &v,
+                       gtsam::Vector *c) const;
+
+  /**
+   * Forward dynamics qdd = M(q)^-1 * (tau - h(q, v)) and its derivatives
+   * with respect to q, v and tau, e.g., for DDP/iLQR. The derivatives of the
+   * inverse dynamics are found by differentiating the Newton-Euler recursion
+   * in forward mode, one pass per joint, and then
+   *   dqdd/dq = -M^-1 * dtau/dq,  dqdd/dv = -M^-1 * dtau/dv,  dqdd/dtau = M^-1.
+   * No factor graph is built and nothing is finite-differenced.
+   */
+  void forwardDynamicsDerivatives(const gtsam::Vector &q,
+                                  const gtsam::Vector &v,
+                                  const gtsam::Vector &tau, gtsam::Vector *qdd,
+                                  gtsam::Matrix *qdd_H_q,
+                                  gtsam::Matrix *qdd_H_v,
+                                  gtsam::Matrix *qdd_H_tau) const;
+
+  /// @}
+
+  /**
+   * @name Operational space
+   * Task Jacobians and operational-space inertias at one configuration, with
+   * roots held as for the joint-space terms. factorize computes M(q) and its
+   * factorization once, the other methods then serve any number of tasks at
+   * that configuration. Matrices are indexed by joint id as above.
+   * @{
+   */
+
+  /**
+   * Compute M(q) with the Composite Rigid Body Algorithm and factorize it as
+   * M = L^T * L, where row j of L is nonzero only at j and its ancestors in
+   * the tree, so the factorization has no fill-in (Featherstone, RBDA 6.5).
+   */
+  void factorize(const gtsam::Vector &q) const;
+
+  /**
+   * Jacobian of the world-frame velocity of a point on a link with respect
+   * to the joint velocities, at the factorized configuration.
+   * @param point the point, in the CoM frame of its link
+   * @param J     3 x numJoints() Jacobian
+   */
+  void taskJacobian(const PointOnLink &point, gtsam::Matrix *J) const;
+
+  /**
+   * Operational-space inertia (J * M^-1 * J^T)^-1 of a task Jacobian at the
+   * factorized configuration, from X^T * X with X = L^-T * J^T solved along
+   * the tree. Tasks can be stacked as rows of J; throws if they are singular.
+   * @param J      m x numJoints() task Jacobian
+   * @param Lambda m x m operational-space inertia
+   */
+  void taskInertia(const gtsam::Matrix &J, gtsam::Matrix *Lambda) const;
+
+  /// @}
+
+  /// Return the size of joint vectors, i.e., the largest joint id plus one.
+  size_t numJoints() const { return num_joints_; }
+
+  /**
+   * Return whether this solver was built for robot: the same links and
+   * joints, with the same links fixed. Changes to the inertia or the screw
+   * axes of existing links and joints are not detected.
+   */
+  bool builtFor(const Robot &robot) const;
+
+  /// Return the links in traversal order.
+  const std::vector<LinkSharedPtr> &links() const { return links_; }
+
+  /// Return the joint connecting the k-th link in traversal order to its
+  /// parent, or a null pointer for a root link.
+  const JointSharedPtr &parentJoint(size_t k) const {
+    return parent_joints_[k];
+  }
+
+  /// Return the traversal index of the parent of the k-th link, -1 for roots.
+  int parentIndex(size_t k) const { return parent_indices_[k]; }
+
+ private:
+  /// Compute the spanning tree of the robot and allocate the buffers.
+  void buildTree(const Robot &robot);
+
+  /// Read poses, twists and joint velocities at time t into the buffers.
+  void loadKinematics(int t, const gtsam::Values &known_values) const;
+
+  /// Compute poses and twists from joint angles and velocities.
+  void computeKinematics(const gtsam::Vector &q, const gtsam::Vector &v) const;
+
+  /**
+   * From poses, twists and joint velocities, compute for every tree edge the
+   * Adjoint of the pose of the parent link in the link frame and the
+   * velocity-product acceleration ad(V_k) * S_k * v_j, and for every link the
+   * bias wrench, i.e. the negated sum of the Coriolis and gravity wrenches,
+   * such that G_i * A_i + bias_i is the net joint wrench acting on link i.
+   */
+  void velocityTerms(bool with_gravity = true) const;
+
+  /// Articulated Body Algorithm: torques to accelerations and wrenches.
+  void articulatedBody() const;
+
+  /**
+   * Recursive Newton-Euler: accelerations to torques and wrenches.
+   * @param solve_roots if true, solve for the accelerations of floating
+   * roots such that they have no residual wrench, otherwise hold them fixed
+   */
+  void newtonEuler(bool solve_roots = true) const;
+
+  /// Newton-Euler with zero joint accelerations and fixed roots, at q and v.
+  void zeroAccelTorques(const gtsam::Vector &q, const gtsam::Vector &v,
+                        gtsam::Vector *tau, bool with_gravity = true) const;
+
+  /// Insert the joint wrenches of both links and all twist accelerations.
+  void insertWrenchesAndAccels(int t, gtsam::Values *values) const;
+
+  /**
+   * Tangent of the Newton-Euler torques, at the state of the last newtonEuler,
+   * for a unit change of the angle (or velocity) of the parent joint of the
+   * m-th link, written in column of the joint in dtau.
+   */
+  void newtonEulerTangent(size_t m, bool velocity, gtsam::Matrix *dtau) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,29 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeExport.cpp
+ * @brief Export of a Robot to the GTSAM-independent deployment runtime.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/RuntimeExport.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+runtime::Model ToRuntimeModel(const Robot &robot,
+                              const std::optional<gtsam::Vector3> &gravity) {
+  runtime::Model model(ToRobotTable(robot));
+  if (gravity) {
+    for (int i = 0; i < 3; i++) model.gravity[i] = (*gravity)(i);
+  }
+  return model;
+}
+
+}  // namespace gtdynamics
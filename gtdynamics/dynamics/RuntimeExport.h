@@ -0,0 +1,34 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeExport.h
+ * @brief Export of a Robot to the GTSAM-independent deployment runtime.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/runtime/RuntimeModel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <optional>
+
+namespace gtdynamics {
+
+/**
+ * @fn Flatten a robot into a runtime::Model, as runtime::Model::Load does for
+ * a robot cache file written by SaveRobotCache. The robot must be a tree with
+ * at most one fixed link and joint ids 0..N-1, with all joints pointing away
+ * from the root, as for StaticRobot.
+ * @param robot   the robot
+ * @param gravity gravity in the world frame, none by default
+ */
+runtime::Model ToRuntimeModel(
+    const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {});
+
+}  // namespace gtdynamics
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ScenarioBatch.cpp
+ * @brief One trajectory optimization over sampled model variants.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/ScenarioBatch.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorGraphTemplate.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+ScenarioBatch::ScenarioBatch(size_t num_scenarios, uint64_t time_stride,
+                             const std::set<std::string> &shared_labels)
+    : num_scenarios_(num_scenarios),
+      time_stride_(time_stride),
+      shared_labels_(shared_labels) {
+  if (num_scenarios < 1 || time_stride < 1) {
+    throw std::invalid_argument(
+        "ScenarioBatch: needs a scenario and a positive time stride.");
+  }
+}
+
+/* ************************************************************************* */
+bool ScenarioBatch::isShared(Key key) const {
+  return shared_labels_.count(DynamicsSymbol(key).label()) > 0;
+}
+
+/* ************************************************************************* */
+Key ScenarioBatch::key(Key key, size_t scenario) const {
+  if (isShared(key)) return key;
+  const DynamicsSymbol symbol(key);
+  if (symbol.time() >= time_stride_) {
+    throw std::invalid_argument("ScenarioBatch: time step of " +
+                                std::string(symbol) +
+                                " is not below the time stride.");
+  }
+  return DynamicsSymbol::LinkJointSymbol(
+      symbol.label(), symbol.linkIdx(), symbol.jointIdx(),
+      symbol.time() + scenario * time_stride_);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ScenarioBatch::graph(
+    const ScenarioGraphFunction &scenario_graph,
+    const ExecutionContext &execution) const {
+  std::vector<NonlinearFactorGraph> graphs(num_scenarios_);
+  execution.parallelFor(num_scenarios_, [&](size_t s) {
+    const FactorGraphTemplate graph_template(scenario_graph(s));
+    graphs[s] = graph_template.instantiate([&](Key k) { return key(k, s); });
+  });
+
+  NonlinearFactorGraph graph;
+  size_t size = 0;
+  for (auto &&g : graphs) size += g.size();
+  graph.reserve(size);
+  for (auto &&g : graphs) graph.push_back(g);
+  return graph;
+}
+
+/* ************************************************************************* */
+Values ScenarioBatch::values(const ScenarioValuesFunction &scenario_values,
+                             const ExecutionContext &execution) const {
+  std::vector<Values> values(num_scenarios_);
+  execution.parallelFor(num_scenarios_,
+                        [&](size_t s) { values[s] = scenario_values(s); });
+
+  Values batch;
+  for (size_t s = 0; s < num_scenarios_; s++) {
+    for (Key k : values[s].keys()) {
+      const Key batch_key = key(k, s);
+      if (!batch.exists(batch_key)) batch.insert(batch_key, values[s].at(k));
+    }
+  }
+  return batch;
+}
+
+/* ************************************************************************* */
+Values ScenarioBatch::scenarioValues(const Values &values,
+                                     size_t scenario) const {
+  if (scenario >= num_scenarios_) {
+    throw std::out_of_range("ScenarioBatch: no scenario " +
+                            std::to_string(scenario));
+  }
+  const uint64_t first = scenario * time_stride_;
+  Values scenario_values;
+  for (Key k : values.keys()) {
+    if (isShared(k)) {
+      scenario_values.insert(k, values.at(k));
+      continue;
+    }
+    const DynamicsSymbol symbol(k);
+    if (symbol.time() < first || symbol.time() >= first + time_stride_) {
+      continue;
+    }
+    scenario_values.insert(
+        DynamicsSymbol::LinkJointSymbol(symbol.label(), symbol.linkIdx(),
+                                        symbol.jointIdx(),
+                                        symbol.time() - first),
+        values.at(k));
+  }
+  return scenario_values;
+}
+
+/* ************************************************************************* */
+gtsam::Ordering ScenarioBatch::ordering(
+    const NonlinearFactorGraph &graph) const {
+  gtsam::KeyVector shared_keys;
+  for (Key k : graph.keys()) {
+    if (isShared(k)) shared_keys.push_back(k);
+  }
+  return gtsam::Ordering::ColamdConstrainedLast(graph, shared_keys);
+}
+
+/* ************************************************************************* */
+ScenarioGraphFunction TrajectoryScenarios(
+    const DynamicsGraph &graph_builder, const std::vector<Robot> &robots,
+    int num_steps, double dt, CollocationScheme collocation,
+    const std::optional<PointOnLinks> &contact_points,
+    const std::vector<double> &mus) {
+  if (!mus.empty() && mus.size() != robots.size()) {
+    throw std::invalid_argument(
+        "TrajectoryScenarios: needs a coefficient of friction per robot.");
+  }
+  return [=](size_t s) {
+    return graph_builder.trajectoryFG(
+        robots.at(s), num_steps, dt, collocation, contact_points,
+        mus.empty() ? std::optional<double>() : mus[s]);
+  };
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ScenarioBatch.h
+ * @brief One trajectory optimization over sampled model variants.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Graph, or values, of one scenario, with the keys of a single trajectory.
+using ScenarioGraphFunction =
+    std::function<gtsam::NonlinearFactorGraph(size_t scenario)>;
+using ScenarioValuesFunction = std::function<gtsam::Values(size_t scenario)>;
+
+/**
+ * ScenarioBatch combines the graphs of several scenarios, e.g. a robot with
+ * sampled payloads or friction coefficients, into one graph with one control
+ * trajectory that should work for all of them. Each scenario graph is built
+ * with the usual keys, e.g. by DynamicsGraph::trajectoryFG, and then copied
+ * with FactorGraphTemplate onto its own state variables: scenario s has its
+ * time steps offset by s * time_stride, while the variables with a shared
+ * label, by default the torques, keep their keys and are shared by all
+ * scenarios. Scenario 0 so keeps all of its keys.
+ *
+ * The scenarios are only coupled through the shared variables, which
+ * ordering() eliminates last: each scenario is then eliminated as its own
+ * block, onto a dense block of the shared variables. Objectives on shared
+ * variables in every scenario graph, e.g. MinTorqueFactors, are counted once
+ * per scenario, as is the rest of the cost.
+ */
+class ScenarioBatch {
+ private:
+  size_t num_scenarios_;
+  uint64_t time_stride_;
+  std::set<std::string> shared_labels_;
+
+ public:
+  /**
+   * Constructor.
+   * @param num_scenarios number of scenarios
+   * @param time_stride   offset of time steps between scenarios, larger than
+   *                      any time step of a scenario graph
+   * @param shared_labels labels of the variables shared by all scenarios
+   */
+  ScenarioBatch(size_t num_scenarios, uint64_t time_stride,
+                const std::set<std::string> &shared_labels = {"T"});
+
+  size_t numScenarios() const { return num_scenarios_; }
+
+  /// Whether key is shared by all scenarios.
+  bool isShared(gtsam::Key key) const;
+
+  /// The key of a variable of a scenario graph in the batch graph.
+  gtsam::Key key(gtsam::Key key, size_t scenario) const;
+
+  /**
+   * The batch graph: the graphs of all scenarios on their own variables,
+   * built and rekeyed in parallel.
+   * @param scenario_graph graph of a scenario, with unshifted keys
+   * @param execution      threads building the scenario graphs
+   */
+  gtsam::NonlinearFactorGraph graph(
+      const ScenarioGraphFunction &scenario_graph,
+      const ExecutionContext &execution = ExecutionContext::Default()) const;
+
+  /**
+   * Values of the batch graph, e.g. initial values, from those of all
+   * scenarios. Shared variables take the values of scenario 0.
+   */
+  gtsam::Values values(
+      const ScenarioValuesFunction &scenario_values,
+      const ExecutionContext &execution = ExecutionContext::Default()) const;
+
+  /// The values of one scenario, with its keys unshifted, e.g. of a solution.
+  gtsam::Values scenarioValues(const gtsam::Values &values,
+                               size_t scenario) const;
+
+  /**
+   * COLAMD ordering of the batch graph with the shared variables last, e.g.
+   * as LevenbergMarquardtParams::ordering, see the class documentation.
+   */
+  gtsam::Ordering ordering(const gtsam::NonlinearFactorGraph &graph) const;
+};
+
+/**
+ * Scenario graphs from DynamicsGraph::trajectoryFG, one per robot, e.g. with
+ * sampled link masses, and per coefficient of friction if given.
+ * @param graph_builder  the builder, copied
+ * @param robots         the robot of each scenario
+ * @param num_steps      total time steps
+ * @param dt             duration of each time step
+ * @param collocation    the collocation scheme
+ * @param contact_points optional contact points
+ * @param mus            optional coefficient of friction of each scenario
+ */
+ScenarioGraphFunction TrajectoryScenarios(
+    const DynamicsGraph &graph_builder, const std::vector<Robot> &robots,
+    int num_steps, double dt, CollocationScheme collocation = Trapezoidal,
+    const std::optional<PointOnLinks> &contact_points = {},
+    const std::vector<double> &mus = {});
+
+}  // namespace gtdynamics
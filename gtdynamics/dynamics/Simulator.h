@@ -14,18 +14,43 @@
 #pragma once
 
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Integration.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <algorithm>
+#include <cmath>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace gtdynamics {
+
+/// Outcome of Simulator::simulateAdaptive.
+struct AdaptiveSimulationResult {
+  double time = 0.0;         ///< simulated time, up to the touchdown if any
+  size_t num_steps = 0;      ///< accepted steps
+  size_t num_rejected = 0;   ///< steps rejected by the error estimate
+  size_t num_solves = 0;     ///< forward dynamics solves
+  std::optional<size_t> contact;  ///< index of the point that touched down
+};
+
 /**
  * Simulator is a class which simulate robot arm motion using forward
  * dynamics.
+ *
+ * Two interfaces are provided. The Values interface (step/simulate with
+ * gtsam::Values torques) solves forward dynamics with the linear factor graph.
+ * The vector interface (step with a gtsam::Vector of torques) keeps q, v, a
+ * and torques in flat vectors indexed by joint id and uses the recursive
+ * solver, so that a step does not allocate on the heap. The two interfaces
+ * keep separate state, only reset() restarts both.
+ *
+ * Both interfaces integrate with the selected IntegrationScheme, by default
+ * an explicit Taylor step.
  */
 class Simulator {
  private:
@@ -37,6 +62,18 @@ class Simulator {
   std::optional<gtsam::Vector3> planar_axis_;
   gtsam::Values current_values_;
   gtsam::Values new_kinematics_;
+  gtsam::Values last_torques_;
+  IntegrationScheme scheme_ = TaylorStep;
+  IntegrationWorkspace workspace_;
+
+  // State of the vector interface, indexed by joint id.
+  std::optional<RecursiveDynamics> recursive_;
+  gtsam::Vector q_, v_, a_, tau_;
+
+  // Adaptive stepping: the next trial step (0 if none yet), and the state at
+  // the end of a trial step.
+  double adaptive_dt_ = 0.0;
+  gtsam::Vector q1_, v1_, a1_, heights_, heights1_;
 
  public:
   /**
@@ -54,7 +91,9 @@ class Simulator {
       : robot_(robot),
         t_(0),
         graph_builder_(DynamicsGraph(gravity, planar_axis)),
-        initial_values_(initial_values) {
+        initial_values_(initial_values),
+        gravity_(gravity),
+        planar_axis_(planar_axis) {
     reset();
   }
   ~Simulator() {}
@@ -63,46 +102,65 @@ class Simulator {
   void reset(const double t = 0) {
     t_ = t;
     new_kinematics_ = initial_values_;
+
+    size_t num_joints = 0;
+    for (auto &&joint : robot_.joints()) {
+      num_joints = std::max<size_t>(num_joints, joint->id() + 1);
+    }
+    q_ = v_ = a_ = tau_ = gtsam::Vector::Zero(num_joints);
+    q1_ = v1_ = a1_ = q_;
+    adaptive_dt_ = 0.0;
+    workspace_.resize(num_joints);
+    for (auto &&joint : robot_.joints()) {
+      const auto j = joint->id();
+      if (initial_values_.exists(JointAngleKey(j))) {
+        q_(j) = JointAngle(initial_values_, j);
+      }
+      if (initial_values_.exists(JointVelKey(j))) {
+        v_(j) = JointVel(initial_values_, j);
+      }
+    }
   }
 
+  /// Select the integration scheme used by both interfaces.
+  void setIntegrationScheme(IntegrationScheme scheme) { scheme_ = scheme; }
+
+  /// Return the integration scheme.
+  IntegrationScheme integrationScheme() const { return scheme_; }
+
   /**
    * Perform forward dynamics to calculate accelerations.
    * @param torques torques for the time step
    */
   void forwardDynamics(const gtsam::Values &torques) {
-    // Do FK to add poses
-    auto values = robot_.forwardKinematics(new_kinematics_);
-
-    // Add torques
-    for (auto &&joint : robot_.joints()) {
-      auto j = joint->id();
-      InsertTorque(&values, j, Torque(torques, j));
-    }
-
-    // Now compute accelerations with forward dynamics
-    current_values_ = graph_builder_.linearSolveFD(robot_, 0, values);
+    last_torques_ = torques;
+    current_values_ = solveFD(new_kinematics_);
   }
 
   /**
-   * Integrate to calculate new q, v for one time step, update q_, v_
-   * @param torques torques for the time step
+   * Integrate to calculate new q, v for one time step, using the
+   * accelerations from the last call to forwardDynamics.
    * @param dt duration for the time step
    */
   void integration(const double dt) {
-    new_kinematics_ = gtsam::Values();
-    const double dt2 = std::pow(dt, 2);
+    gtsam::Vector q = q_, v = v_, a = a_;
     for (auto &&joint : robot_.joints()) {
       auto j = joint->id();
-      const double q = JointAngle(current_values_, j);
-      const double v = JointVel(current_values_, j);
-      const double a = JointAccel(current_values_, j);
-
-      // TODO(frank): one could use t values and save entire simulation.
-      const double v_new = v + dt * a;
-      InsertJointVel(&new_kinematics_, j, v_new);
-      // TODO(frank): consider using v_new for symplectic integration.
-      InsertJointAngle(&new_kinematics_, j, q + dt * v + 0.5 * a * dt2);
+      q(j) = JointAngle(current_values_, j);
+      v(j) = JointVel(current_values_, j);
+      a(j) = JointAccel(current_values_, j);
     }
+
+    // Multi-stage schemes solve forward dynamics with the same torques.
+    auto accelerations = [&](const gtsam::Vector &q_k,
+                             const gtsam::Vector &v_k, gtsam::Vector *a_k) {
+      const gtsam::Values result = solveFD(kinematics(q_k, v_k));
+      for (auto &&joint : robot_.joints()) {
+        (*a_k)(joint->id()) = JointAccel(result, joint->id());
+      }
+    };
+    IntegrateStep(scheme_, dt, accelerations, a, &q, &v, &workspace_);
+    new_kinematics_ = kinematics(q, v);
   }
 
   /**
@@ -116,6 +174,136 @@ class Simulator {
     t_++;
   }
 
+  /**
+   * Simulate for one time step with the vector interface. The recursive
+   * solver is created on the first call; later calls do not allocate.
+   * Planar axis constraints are not enforced, see RecursiveDynamics.
+   * @param torques torques indexed by joint id
+   * @param dt duration for the time step
+   */
+  void step(const gtsam::Vector &torques, const double dt) {
+    if (!recursive_) recursive_.emplace(robot_, gravity_);
+    tau_ = torques;
+    recursive_->forwardDynamics(q_, v_, tau_, &a_);
+    auto accelerations = [this](const gtsam::Vector &q, const gtsam::Vector &v,
+                                gtsam::Vector *a) {
+      recursive_->forwardDynamics(q, v, tau_, a);
+    };
+    IntegrateStep(scheme_, dt, accelerations, a_, &q_, &v_, &workspace_);
+    t_++;
+  }
+
+  /**
+   * Simulate with the vector interface and record every time step.
+   * @param torques torques, one row per time step, columns by joint id
+   * @param dt duration for the time step
+   * @param trajectory output, resized once to hold all time steps
+   */
+  void simulate(const gtsam::Matrix &torques, const double dt,
+                JointTrajectory *trajectory) {
+    const Eigen::Index num_steps = torques.rows();
+    trajectory->resize(num_steps, q_.size());
+    trajectory->q.row(0) = q_.transpose();
+    trajectory->v.row(0) = v_.transpose();
+    gtsam::Vector tau(torques.cols());
+    for (Eigen::Index k = 0; k < num_steps; ++k) {
+      tau = torques.row(k).transpose();
+      step(tau, dt);
+      trajectory->a.row(k) = a_.transpose();
+      trajectory->q.row(k + 1) = q_.transpose();
+      trajectory->v.row(k + 1) = v_.transpose();
+    }
+  }
+
+  /**
+   * Simulate with the vector interface and constant torques, with steps
+   * sized by the error estimate of IntegrateEmbeddedStep, until the duration
+   * has passed or a contact point touches the ground. Heights are measured
+   * along gravity as in ContactHeightConstraint. In a step where a height
+   * turns non-positive, the touchdown is located on the HermiteInterpolate
+   * of the step with the Illinois method, which needs forward kinematics
+   * but no dynamics solves, and the state is set to it, so that the caller
+   * can switch to contact dynamics. The integration scheme is not used, and
+   * the step size is kept for the next call.
+   * @param torques             torques indexed by joint id
+   * @param duration            time to simulate
+   * @param contact_points      points whose touchdown stops the simulation
+   * @param params              tolerances and step size bounds
+   * @param ground_plane_height height of the ground plane in world frame
+   */
+  AdaptiveSimulationResult simulateAdaptive(
+      const gtsam::Vector &torques, double duration,
+      const PointOnLinks &contact_points = {},
+      const AdaptiveStepParams &params = AdaptiveStepParams(),
+      double ground_plane_height = 0.0) {
+    if (!recursive_) recursive_.emplace(robot_, gravity_);
+    tau_ = torques;
+    auto accelerations = [this](const gtsam::Vector &q, const gtsam::Vector &v,
+                                gtsam::Vector *a) {
+      recursive_->forwardDynamics(q, v, tau_, a);
+    };
+    AdaptiveSimulationResult result;
+    accelerations(q_, v_, &a_);
+    result.num_solves = 1;
+    contactHeights(q_, contact_points, ground_plane_height, &heights_);
+
+    double dt = adaptive_dt_ > 0 ? adaptive_dt_ : params.initial_dt;
+    while (result.time < duration) {
+      dt = std::clamp(dt, params.min_dt, params.max_dt);
+      const double h = std::min(dt, duration - result.time);
+      const double error =
+          IntegrateEmbeddedStep(h, accelerations, q_, v_, a_, &q1_, &v1_,
+                                &a1_, &workspace_, params);
+      result.num_solves += 3;
+
+      // Step size control of a third order method, within a factor of 5.
+      const double factor =
+          error > 0 ? std::clamp(0.9 * std::cbrt(1.0 / error), 0.2, 5.0)
+                    : 5.0;
+      if (error > 1.0 && h > params.min_dt) {
+        dt = h * factor;
+        ++result.num_rejected;
+        continue;
+      }
+
+      // Stop at the earliest touchdown within the step, if any.
+      contactHeights(q1_, contact_points, ground_plane_height, &heights1_);
+      std::optional<double> touchdown;
+      for (size_t c = 0; c < contact_points.size(); ++c) {
+        if (heights_(c) <= 0 || heights1_(c) > 0) continue;
+        const double s = locateTouchdown(h, c, contact_points,
+                                         ground_plane_height, params);
+        if (!touchdown || s < *touchdown) {
+          touchdown = s;
+          result.contact = c;
+        }
+      }
+      if (touchdown) {
+        HermiteInterpolate(*touchdown, h, q_, v_, q1_, v1_, &workspace_.q);
+        HermiteInterpolate(*touchdown, h, v_, a_, v1_, a1_, &workspace_.v);
+        q_ = workspace_.q;
+        v_ = workspace_.v;
+        accelerations(q_, v_, &a_);
+        result.num_solves += 1;
+        result.time += *touchdown * h;
+        ++result.num_steps;
+        t_++;
+        break;
+      }
+
+      q_.swap(q1_);
+      v_.swap(v1_);
+      a_.swap(a1_);
+      heights_.swap(heights1_);
+      result.time += h;
+      ++result.num_steps;
+      t_++;
+      if (h == dt) dt = h * factor;
+    }
+    adaptive_dt_ = dt;
+    return result;
+  }
+
   /// Simulation for the specified sequence of torques.
   gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
                          const double dt) {
@@ -127,6 +315,107 @@ class Simulator {
 
   /// Return all values during simulation.
   const gtsam::Values &getValues() const { return current_values_; }
+
+  /// Return joint angles of the vector interface, indexed by joint id.
+  const gtsam::Vector &jointAngles() const { return q_; }
+
+  /// Return joint velocities of the vector interface, indexed by joint id.
+  const gtsam::Vector &jointVels() const { return v_; }
+
+  /// Return joint accelerations of the last vector step, by joint id.
+  const gtsam::Vector &jointAccels() const { return a_; }
+
+  /// Return torques of the last vector step, indexed by joint id.
+  const gtsam::Vector &torques() const { return tau_; }
+
+  /**
+   * Return the state of the vector interface as Values: joint angles and
+   * velocities after the last step, and accelerations and torques of it.
+   */
+  gtsam::Values jointValues() const {
+    gtsam::Values values;
+    for (auto &&joint : robot_.joints()) {
+      const auto j = joint->id();
+      InsertJointAngle(&values, j, q_(j));
+      InsertJointVel(&values, j, v_(j));
+      InsertJointAccel(&values, j, a_(j));
+      InsertTorque(&values, j, tau_(j));
+    }
+    return values;
+  }
+
+ private:
+  /// Joint angles and velocities as Values, for the Values interface.
+  gtsam::Values kinematics(const gtsam::Vector &q,
+                           const gtsam::Vector &v) const {
+    gtsam::Values values;
+    for (auto &&joint : robot_.joints()) {
+      const auto j = joint->id();
+      InsertJointAngle(&values, j, q(j));
+      InsertJointVel(&values, j, v(j));
+    }
+    return values;
+  }
+
+  /// Heights of points above the ground, as in ContactHeightConstraint.
+  void contactHeights(const gtsam::Vector &q, const PointOnLinks &points,
+                      double ground_plane_height,
+                      gtsam::Vector *heights) const {
+    heights->resize(points.size());
+    if (points.empty()) return;
+    const gtsam::Vector3 up = gravity_ ? gravity_->normalized().cwiseAbs()
+                                       : gtsam::Vector3(0, 0, 1);
+    const gtsam::Values values = robot_.forwardKinematics(kinematics(q, v_));
+    for (size_t c = 0; c < points.size(); ++c) {
+      (*heights)(c) = up.dot(points[c].predict(values)) - ground_plane_height;
+    }
+  }
+
+  /**
+   * Fraction of the step from (q_, v_) to (q1_, v1_) at which point c
+   * reaches the ground, by the Illinois variant of regula falsi. The height
+   * at the returned fraction is at most zero.
+   */
+  double locateTouchdown(double dt, size_t c, const PointOnLinks &points,
+                         double ground_plane_height,
+                         const AdaptiveStepParams &params) {
+    double s0 = 0.0, s1 = 1.0, f0 = heights_(c), f1 = heights1_(c);
+    gtsam::Vector heights;
+    int retained = 0;
+    for (int i = 0; i < 100 && (s1 - s0) * dt > params.event_tol; ++i) {
+      const double s = (s0 * f1 - s1 * f0) / (f1 - f0);
+      HermiteInterpolate(s, dt, q_, v_, q1_, v1_, &workspace_.q);
+      contactHeights(workspace_.q, points, ground_plane_height, &heights);
+      const double f = heights(c);
+      if (f > 0) {
+        s0 = s;
+        f0 = f;
+        if (retained == 1) f1 *= 0.5;
+        retained = 1;
+      } else {
+        s1 = s;
+        f1 = f;
+        if (retained == -1) f0 *= 0.5;
+        retained = -1;
+      }
+    }
+    return s1;
+  }
+
+  /// Forward kinematics and dynamics with the last torques.
+  gtsam::Values solveFD(const gtsam::Values &kinematics) {
+    // Do FK to add poses
+    auto values = robot_.forwardKinematics(kinematics);
+
+    // Add torques
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      InsertTorque(&values, j, Torque(last_torques_, j));
+    }
+
+    // Now compute accelerations with forward dynamics
+    return graph_builder_.linearSolveFD(robot_, 0, values);
+  }
 };
 
 }  // namespace gtdynamics
@@ -0,0 +1,291 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseDynamics.cpp
+ * @brief Linear dynamics assembled directly into one sparse system.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/SparseDynamics.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+/// Column 0 of a vector, for the selections of AddBlock.
+const std::vector<int> kColumn{0};
+
+/**
+ * Append the entries of the dense block M(rows, cols) at (row, col), where
+ * rows and cols select the coordinates which are unknowns.
+ */
+template <typename Derived>
+void AddBlock(std::vector<Eigen::Triplet<double>> *triplets, int row, int col,
+              const Eigen::MatrixBase<Derived> &M,
+              const std::vector<int> &rows, const std::vector<int> &cols) {
+  for (size_t c = 0; c < cols.size(); ++c) {
+    for (size_t r = 0; r < rows.size(); ++r) {
+      triplets->emplace_back(row + r, col + c, M(rows[r], cols[c]));
+    }
+  }
+}
+
+/// Append the entries of an identity block, scaled by s, at (row, col).
+void AddIdentity(std::vector<Eigen::Triplet<double>> *triplets, int row,
+                 int col, int n, double s = 1.0) {
+  for (int k = 0; k < n; ++k) triplets->emplace_back(row + k, col + k, s);
+}
+}  // namespace
+
+/* ************************************************************************* */
+SparseDynamics::SparseDynamics(const Robot &robot,
+                               const std::optional<gtsam::Vector3> &gravity,
+                               const std::optional<gtsam::Vector3> &planar_axis)
+    : gravity_(gravity),
+      planar_axis_(planar_axis),
+      links_(robot.links()),
+      joints_(robot.joints()),
+      coords_(planar_axis ? getPlanarCoordinates(*planar_axis)
+                          : std::vector<int>{0, 1, 2, 3, 4, 5}) {
+  for (auto &&link : links_) fixed_links_.push_back(link->isFixed());
+  const int d = coords_.size();
+  size_t num_link_ids = 0, num_joint_ids = 0;
+  for (auto &&link : links_) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  for (auto &&joint : joints_) {
+    num_joint_ids = std::max<size_t>(num_joint_ids, joint->id() + 1);
+  }
+
+  accel_cols_.assign(num_link_ids, -1);
+  for (auto &&link : links_) {
+    accel_cols_[link->id()] = num_cols_;
+    num_cols_ += d;
+  }
+  parent_wrench_cols_.assign(num_joint_ids, -1);
+  child_wrench_cols_.assign(num_joint_ids, -1);
+  joint_accel_cols_.assign(num_joint_ids, -1);
+  torque_cols_.assign(num_joint_ids, -1);
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    parent_wrench_cols_[j] = num_cols_;
+    child_wrench_cols_[j] = num_cols_ + d;
+    joint_accel_cols_[j] = num_cols_ + 2 * d;
+    torque_cols_[j] = num_cols_ + 2 * d + 1;
+    num_cols_ += 2 * d + 2;
+  }
+
+  // Wrench balance of each link, twist acceleration, torque and wrench
+  // equivalence equations of each joint.
+  num_rows_ = d * links_.size() + (2 * d + 1) * joints_.size();
+
+  // Reserve the entries of the dense blocks.
+  size_t num_entries = 0;
+  for (auto &&link : links_) num_entries += d * (d + link->numJoints());
+  num_entries += (3 * d * d + 5 * d + 3) * joints_.size();
+  triplets_.reserve(num_entries);
+  rhs_.resize(num_rows_ + joints_.size());
+}
+
+/* ************************************************************************* */
+bool SparseDynamics::builtFor(const Robot &robot) const {
+  if (robot.links() != links_ || robot.joints() != joints_) return false;
+  for (size_t i = 0; i < links_.size(); ++i) {
+    if (links_[i]->isFixed() != fixed_links_[i]) return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+void SparseDynamics::assemble(int t, const Values &known_values) const {
+  const int d = coords_.size();
+  triplets_.clear();
+  rhs_.setZero();
+  int row = 0;
+
+  // Write the unknown coordinates of a 6-vector at row.
+  auto setRhs = [&](int row, const Vector6 &rhs) {
+    for (int r = 0; r < d; ++r) rhs_(row + r) = rhs(coords_[r]);
+  };
+
+  for (auto &&link : links_) {
+    const int i = link->id();
+    if (link->isFixed()) {
+      // A_i = 0
+      AddIdentity(&triplets_, row, accel_cols_[i], d);
+    } else {
+      // G_i * A_i - F_i_j1 - .. - F_i_jn = ad(V_i)^T * G_i * V_i
+      // + m_i * R_i^T * g
+      const Matrix6 &G_i = link->inertiaMatrix();
+      const Vector6 V_i = Twist(known_values, i, t);
+      Vector6 rhs = Pose3::adjointMap(V_i).transpose() * G_i * V_i;
+      if (gravity_) {
+        rhs += link->gravityWrench(*gravity_, Pose(known_values, i, t));
+      }
+      AddBlock(&triplets_, row, accel_cols_[i], G_i, coords_, coords_);
+      for (auto &&joint : link->joints()) {
+        const int j = joint->id();
+        const int col = joint->child() == link ? child_wrench_cols_[j]
+                                               : parent_wrench_cols_[j];
+        AddIdentity(&triplets_, row, col, d, -1.0);
+      }
+      setRhs(row, rhs);
+    }
+    row += d;
+  }
+
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    const int i1 = joint->parent()->id(), i2 = joint->child()->id();
+    const Pose3 T_i2i1 =
+        Pose(known_values, i2, t).inverse() * Pose(known_values, i1, t);
+    const Matrix6 Ad_i2i1 = T_i2i1.AdjointMap();
+    const Vector6 V_i2 = Twist(known_values, i2, t);
+    const Vector6 &S_i2_j = joint->cScrewAxis();
+    const double v_j = JointVel(known_values, j, t);
+
+    // A_i2 - Ad(T_21) * A_i1 - S_i2_j * a_j = ad(V_i2) * S_i2_j * v_j
+    AddIdentity(&triplets_, row, accel_cols_[i2], d);
+    AddBlock(&triplets_, row, accel_cols_[i1], -Ad_i2i1, coords_, coords_);
+    AddBlock(&triplets_, row, joint_accel_cols_[j], -S_i2_j, coords_,
+             kColumn);
+    setRhs(row, Pose3::adjointMap(V_i2) * S_i2_j * v_j);
+    row += d;
+
+    // S_i_j^T * F_i_j - tau = 0
+    AddBlock(&triplets_, row, child_wrench_cols_[j], S_i2_j.transpose(),
+             kColumn, coords_);
+    triplets_.emplace_back(row, torque_cols_[j], -1.0);
+    row += 1;
+
+    // F_i1_j + Ad(T_i2i1)^T F_i2_j = 0
+    AddIdentity(&triplets_, row, parent_wrench_cols_[j], d);
+    AddBlock(&triplets_, row, child_wrench_cols_[j], Ad_i2i1.transpose(),
+             coords_, coords_);
+    row += d;
+  }
+}
+
+/* ************************************************************************* */
+void SparseDynamics::solve(SparseQR *qr, bool *analyzed) const {
+  A_.resize(rhs_.size(), num_cols_);
+  A_.setFromTriplets(triplets_.begin(), triplets_.end());
+  A_.makeCompressed();
+  if (!*analyzed) {
+    qr->analyzePattern(A_);
+    *analyzed = true;
+  }
+  qr->factorize(A_);
+  if (qr->info() != Eigen::Success) {
+    throw std::runtime_error("SparseDynamics: factorization failed.");
+  }
+  x_ = qr->solve(rhs_);
+}
+
+/* ************************************************************************* */
+Vector6 SparseDynamics::expand(int col) const {
+  Vector6 v = Vector6::Zero();
+  for (size_t r = 0; r < coords_.size(); ++r) v(coords_[r]) = x_(col + r);
+  return v;
+}
+
+/* ************************************************************************* */
+void SparseDynamics::insertWrenchesAndAccels(int t, Values *values) const {
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    InsertWrench(values, joint->parent()->id(), j, t,
+                 expand(parent_wrench_cols_[j]));
+    InsertWrench(values, joint->child()->id(), j, t,
+                 expand(child_wrench_cols_[j]));
+  }
+  for (auto &&link : links_) {
+    const int i = link->id();
+    InsertTwistAccel(values, i, t, expand(accel_cols_[i]));
+  }
+}
+
+/* ************************************************************************* */
+Values SparseDynamics::forwardDynamics(int t,
+                                       const Values &known_values) const {
+  assemble(t, known_values);
+
+  // A fixed joint transmits any torque, its acceleration is zero instead.
+  int row = num_rows_;
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    if (joint->type() == Joint::Type::Fixed) {
+      triplets_.emplace_back(row, joint_accel_cols_[j], 1.0);
+    } else {
+      triplets_.emplace_back(row, torque_cols_[j], 1.0);
+      rhs_(row) = Torque(known_values, j, t);
+    }
+    row += 1;
+  }
+  solve(&fd_qr_, &fd_analyzed_);
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (auto &&joint : joints_) {
+      const int j = joint->id();
+      InsertJointAccel(&values, j, t, x_(joint_accel_cols_[j]));
+    }
+    insertWrenchesAndAccels(t, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "SparseDynamics::forwardDynamics: known_values should contain no "
+        "accelerations or wrenches");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values SparseDynamics::inverseDynamics(int t,
+                                       const Values &known_values) const {
+  assemble(t, known_values);
+
+  int row = num_rows_;
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    triplets_.emplace_back(row, joint_accel_cols_[j], 1.0);
+    rhs_(row) = JointAccel(known_values, j, t);
+    row += 1;
+  }
+  solve(&id_qr_, &id_analyzed_);
+
+  // Arrange values.
+  Values values = known_values;
+  try {
+    for (auto &&joint : joints_) {
+      const int j = joint->id();
+      InsertTorque(&values, j, t, x_(torque_cols_[j]));
+    }
+    insertWrenchesAndAccels(t, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "SparseDynamics::inverseDynamics: known_values should contain no "
+        "torques, wrenches, or twist accelerations.");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
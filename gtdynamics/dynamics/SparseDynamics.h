@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseDynamics.h
+ * @brief Linear dynamics assembled directly into one sparse system.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseQR>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SparseDynamics solves the same linear forward and inverse dynamics problems
+ * as DynamicsGraph::linearSolveFD and linearSolveID, with the same equations
+ * as DynamicsGraph::linearDynamicsGraph and the Joint linear factors, but
+ * writes them directly into one sparse matrix instead of building a Gaussian
+ * factor graph of small JacobianFactors.
+ *
+ * Every variable has a fixed column offset, computed once per robot: the
+ * twist acceleration of each link, then for each joint the wrenches on its
+ * parent and child links, its acceleration and its torque. The sparsity
+ * pattern is then the same at every time step, so the fill-reducing ordering
+ * of the sparse QR factorization is computed on the first solve and reused.
+ *
+ * If a planar axis is given, the motion is assumed to stay in the plane, and
+ * only the three in-plane coordinates of each twist acceleration and wrench
+ * are unknowns (see getPlanarCoordinates), instead of adding rows that
+ * suppress the out-of-plane components. This halves the size of the system.
+ *
+ * Unlike RecursiveDynamics, kinematic loops are supported. Contact points are
+ * not; use the factor graph solver for those. The solver shares the robot's
+ * links and joints rather than copying the robot. The matrix and the
+ * factorizations are shared between calls, so a SparseDynamics object must
+ * not be used from several threads at once.
+ */
+class SparseDynamics {
+ private:
+  using SpMatrix = Eigen::SparseMatrix<double>;
+  using Triplet = Eigen::Triplet<double>;
+  using SparseQR = Eigen::SparseQR<SpMatrix, Eigen::COLAMDOrdering<int>>;
+
+  std::optional<gtsam::Vector3> gravity_, planar_axis_;
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  std::vector<bool> fixed_links_;  // which links were fixed, by links_ index
+
+  /// Twist and wrench coordinates which are unknowns, all 6 unless planar.
+  std::vector<int> coords_;
+
+  /// Column offsets, indexed by link or joint id (-1 if unused).
+  std::vector<int> accel_cols_;
+  std::vector<int> parent_wrench_cols_, child_wrench_cols_;
+  std::vector<int> joint_accel_cols_, torque_cols_;
+
+  /// Number of rows without the priors, and number of columns.
+  int num_rows_ = 0, num_cols_ = 0;
+
+  /// Work buffers, and factorizations with their orderings.
+  mutable std::vector<Triplet> triplets_;
+  mutable gtsam::Vector rhs_, x_;
+  mutable SpMatrix A_;
+  mutable SparseQR fd_qr_, id_qr_;
+  mutable bool fd_analyzed_ = false, id_analyzed_ = false;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot        the robot
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  explicit SparseDynamics(
+      const Robot &robot, const std::optional<gtsam::Vector3> &gravity = {},
+      const std::optional<gtsam::Vector3> &planar_axis = {});
+
+  /**
+   * Solve forward dynamics.
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint velocities and
+   * torques for all links/joints at time t.
+   * @return known_values with joint accelerations, twist accelerations and
+   * wrenches added, i.e., the same result as DynamicsGraph::linearSolveFD.
+   */
+  gtsam::Values forwardDynamics(int t, const gtsam::Values &known_values) const;
+
+  /**
+   * Solve inverse dynamics.
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint velocities and
+   * joint accelerations for all links/joints at time t.
+   * @return known_values with torques, twist accelerations and wrenches
+   * added, i.e., the same result as DynamicsGraph::linearSolveID.
+   */
+  gtsam::Values inverseDynamics(int t, const gtsam::Values &known_values) const;
+
+  /**
+   * Return whether this solver was built for robot: the same links and
+   * joints, with the same links fixed, so that the sparsity pattern and the
+   * orderings of the factorizations still hold.
+   */
+  bool builtFor(const Robot &robot) const;
+
+  /// Return the number of unknowns of the linear system.
+  int dim() const { return num_cols_; }
+
+  /// Return the number of unknowns per twist acceleration or wrench.
+  int twistDim() const { return coords_.size(); }
+
+ private:
+  /// Write the rows of the wrench and joint equations into the buffers.
+  void assemble(int t, const gtsam::Values &known_values) const;
+
+  /// Build the matrix from the buffers and solve it with qr into x_.
+  void solve(SparseQR *qr, bool *analyzed) const;
+
+  /// Expand the unknowns at col to a full twist acceleration or wrench.
+  gtsam::Vector6 expand(int col) const;
+
+  /// Insert the joint wrenches of both links and all twist accelerations.
+  void insertWrenchesAndAccels(int t, gtsam::Values *values) const;
+};
+
+}  // namespace gtdynamics
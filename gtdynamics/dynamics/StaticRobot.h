@@ -0,0 +1,312 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticRobot.h
+ * @brief Robot with a compile-time number of joints, for fast kinematics and
+ * dynamics of fixed-topology arms.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * StaticRobot<N> is a snapshot of a tree-structured Robot with N movable
+ * joints, with ids 0..N-1, and a single root link, held at its fixed pose (or
+ * at the identity if it is not fixed). Screw axes, rest transforms and
+ * inertias are stored in fixed-size arrays, in a traversal order where
+ * parents precede children, so that the compiler can unroll the kinematics
+ * and dynamics loops.
+ *
+ * Joint vectors are indexed by joint id, and conventions follow
+ * RecursiveDynamics: twists and wrenches are expressed in link CoM frames.
+ *
+ * Example:
+ *   StaticRobot<6> arm(CreateRobotFromFile(path).fixLink("base_link"), g);
+ *   StaticRobot<6>::JointVector tau = arm.inverseDynamics(q, v, a);
+ */
+template <int N>
+class StaticRobot {
+ public:
+  using JointVector = Eigen::Matrix<double, N, 1>;
+  using JointMatrix = Eigen::Matrix<double, N, N>;
+  using LinkPoses = std::array<gtsam::Pose3, N>;
+
+ private:
+  using Matrix6 = gtsam::Matrix6;
+  using Pose3 = gtsam::Pose3;
+  using Vector6 = gtsam::Vector6;
+
+  // Per joint, in traversal order: the joint moves link k + 1 of the
+  // traversal, whose parent is moved by joint parent_[k] (-1 for the root).
+  std::array<int, N> parent_, joint_id_;
+  Eigen::Matrix<double, 6, N> screw_axes_;  // in child CoM frames
+  std::array<Pose3, N> pMc_;                // child in parent, at rest
+  std::array<Matrix6, N> inertias_;         // of child links
+  std::array<double, N> masses_;
+  Pose3 root_pose_;
+  gtsam::Vector3 gravity_;
+  Vector6 root_accel_;  // gravity as an acceleration of the root, in its frame
+
+  /// Poses, twists and parent Adjoints of all moving links.
+  struct Kinematics {
+    std::array<Pose3, N> poses;
+    std::array<Vector6, N> twists;
+    std::array<Matrix6, N> Ad;  // Adjoint of parent pose in child frame
+  };
+
+  /// Forward kinematics in traversal order, at joint angles/velocities q, v.
+  void kinematics(const JointVector &q, const JointVector &v,
+                  Kinematics *K) const {
+    for (int k = 0; k < N; ++k) {
+      const int j = joint_id_[k];
+      const Pose3 pTc = pMc_[k] * Pose3::Expmap(screw_axes_.col(k) * q(j));
+      const Pose3 &wTp = parent_[k] < 0 ? root_pose_ : K->poses[parent_[k]];
+      K->poses[k] = wTp * pTc;
+      K->Ad[k] = pTc.inverse().AdjointMap();
+      K->twists[k] = screw_axes_.col(k) * v(j);
+      if (parent_[k] >= 0) K->twists[k] += K->Ad[k] * K->twists[parent_[k]];
+    }
+  }
+
+  /// Accelerations and wrenches of all moving links, with the wrenches of
+  /// each link summed over its subtree, by the Recursive Newton-Euler
+  /// Algorithm, with gravity as an acceleration of the root.
+  void newtonEuler(const JointVector &q, const JointVector &v,
+                   const JointVector &a, Kinematics *K,
+                   std::array<Vector6, N> *A,
+                   std::array<Vector6, N> *F) const {
+    kinematics(q, v, K);
+    for (int k = 0; k < N; ++k) {
+      const int j = joint_id_[k];
+      const Vector6 &V = K->twists[k];
+      const auto S = screw_axes_.col(k);
+      (*A)[k] = S * a(j) + Pose3::adjointMap(V) * S * v(j) +
+                K->Ad[k] * (parent_[k] < 0 ? root_accel_ : (*A)[parent_[k]]);
+      (*F)[k] = inertias_[k] * (*A)[k] -
+                Pose3::adjointMap(V).transpose() * inertias_[k] * V;
+    }
+    for (int k = N - 1; k >= 0; --k) {
+      if (parent_[k] >= 0) (*F)[parent_[k]] += K->Ad[k].transpose() * (*F)[k];
+    }
+  }
+
+  /**
+   * Tangent of the torques, at the state of newtonEuler, for a unit change of
+   * the angle (or velocity) of the joint of link m of the traversal, written
+   * in the column of that joint of dtau.
+   */
+  void newtonEulerTangent(int m, bool velocity, const JointVector &v,
+                          const Kinematics &K,
+                          const std::array<Vector6, N> &A,
+                          const std::array<Vector6, N> &F,
+                          JointMatrix *dtau) const {
+    const Vector6 S_m = screw_axes_.col(m);
+
+    // Outward pass: a change of q_m turns Ad_m into (I - ad(S_m)) * Ad_m, a
+    // change of v_m adds S_m to the twist.
+    std::array<Vector6, N> dV, dA, dF;
+    for (int k = 0; k < N; ++k) {
+      const int p = parent_[k];
+      dV[k] = p < 0 ? Vector6::Zero().eval() : Vector6(K.Ad[k] * dV[p]);
+      dA[k] = p < 0 ? Vector6::Zero().eval() : Vector6(K.Ad[k] * dA[p]);
+      if (k == m) {
+        if (velocity) {
+          dV[k] += S_m;
+          dA[k] += Pose3::adjointMap(K.twists[k]) * S_m;
+        } else {
+          const Vector6 V_p = p < 0 ? Vector6::Zero().eval() : K.twists[p];
+          const Vector6 &A_p = p < 0 ? root_accel_ : A[p];
+          dV[k] -= Pose3::adjointMap(S_m) * (K.Ad[k] * V_p);
+          dA[k] -= Pose3::adjointMap(S_m) * (K.Ad[k] * A_p);
+        }
+      }
+      dA[k] += Pose3::adjointMap(dV[k]) * screw_axes_.col(k) * v(joint_id_[k]);
+    }
+
+    // Inward pass for the wrenches.
+    for (int k = 0; k < N; ++k) {
+      const Matrix6 &G = inertias_[k];
+      dF[k] = G * dA[k] -
+              Pose3::adjointMap(dV[k]).transpose() * (G * K.twists[k]) -
+              Pose3::adjointMap(K.twists[k]).transpose() * (G * dV[k]);
+    }
+    for (int k = N - 1; k >= 0; --k) {
+      const int p = parent_[k];
+      if (p < 0) continue;
+      dF[p] += K.Ad[k].transpose() * dF[k];
+      if (!velocity && k == m) {
+        dF[p] -= K.Ad[k].transpose() *
+                 (Pose3::adjointMap(S_m).transpose() * F[k]);
+      }
+    }
+    for (int k = 0; k < N; ++k) {
+      (*dtau)(joint_id_[k], joint_id_[m]) = screw_axes_.col(k).dot(dF[k]);
+    }
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param robot    the robot, with N joints with ids 0..N-1 forming a tree
+   * @param gravity  gravity in world frame
+   */
+  explicit StaticRobot(const Robot &robot,
+                       const std::optional<gtsam::Vector3> &gravity = {})
+      : gravity_(gravity ? *gravity : gtsam::Vector3::Zero()) {
+    const RecursiveDynamics tree(robot);
+    if (tree.links().size() != N + 1 || tree.numJoints() != N) {
+      throw std::invalid_argument(
+          "StaticRobot: expected a connected tree with " + std::to_string(N) +
+          " joints with ids 0.." + std::to_string(N - 1));
+    }
+    const LinkSharedPtr &root = tree.links()[0];
+    root_pose_ = root->isFixed() ? root->getFixedPose() : Pose3();
+    root_accel_ << gtsam::Vector3::Zero(),
+        -(root_pose_.rotation().transpose() * gravity_);
+    for (int k = 0; k < N; ++k) {
+      const JointSharedPtr &joint = tree.parentJoint(k + 1);
+      const LinkSharedPtr &link = tree.links()[k + 1];
+      if (!joint->isChildLink(link)) {
+        throw std::invalid_argument(
+            "StaticRobot: joint " + joint->name() +
+            " points towards the root link " + root->name());
+      }
+      parent_[k] = tree.parentIndex(k + 1) - 1;
+      joint_id_[k] = joint->id();
+      screw_axes_.col(k) = joint->cScrewAxis();
+      pMc_[k] = joint->pMc();
+      inertias_[k] = link->inertiaMatrix();
+      masses_[k] = link->mass();
+    }
+  }
+
+  /// Number of joints.
+  static constexpr int numJoints() { return N; }
+
+  /// Return world poses of the link CoM frames, indexed by the id of the
+  /// joint that moves them.
+  LinkPoses forwardKinematics(const JointVector &q) const {
+    Kinematics K;
+    kinematics(q, JointVector::Zero(), &K);
+    LinkPoses poses;
+    for (int k = 0; k < N; ++k) poses[joint_id_[k]] = K.poses[k];
+    return poses;
+  }
+
+  /**
+   * Forward kinematics of one link, with its body Jacobian: column j is the
+   * twist of the link, in its CoM frame, for a unit velocity of joint j.
+   * @param q        joint angles
+   * @param joint_id id of the joint that moves the link
+   * @param H        optional 6 x N Jacobian
+   */
+  Pose3 linkPose(const JointVector &q, int joint_id,
+                 gtsam::OptionalJacobian<6, N> H = {}) const {
+    Kinematics K;
+    kinematics(q, JointVector::Zero(), &K);
+    int k = 0;
+    while (k < N && joint_id_[k] != joint_id) ++k;
+    if (k == N) {
+      throw std::invalid_argument("StaticRobot: no joint with id " +
+                                  std::to_string(joint_id));
+    }
+    if (H) {
+      H->setZero();
+      const Pose3 wTk_inverse = K.poses[k].inverse();
+      for (int i = k; i >= 0; i = parent_[i]) {
+        H->col(joint_id_[i]) =
+            (wTk_inverse * K.poses[i]).AdjointMap() * screw_axes_.col(i);
+      }
+    }
+    return K.poses[k];
+  }
+
+  /// Torques for joint accelerations a at angles q and velocities v, with the
+  /// Recursive Newton-Euler Algorithm.
+  JointVector inverseDynamics(const JointVector &q, const JointVector &v,
+                              const JointVector &a) const {
+    Kinematics K;
+    std::array<Vector6, N> A, F;
+    newtonEuler(q, v, a, &K, &A, &F);
+    JointVector tau;
+    for (int k = 0; k < N; ++k) {
+      tau(joint_id_[k]) = screw_axes_.col(k).dot(F[k]);
+    }
+    return tau;
+  }
+
+  /**
+   * Inverse dynamics with the derivatives of the torques with respect to the
+   * angles and velocities, by tangents of the Newton-Euler passes as in
+   * RecursiveDynamics. The derivative with respect to a is massMatrix(q).
+   */
+  JointVector inverseDynamics(const JointVector &q, const JointVector &v,
+                              const JointVector &a, JointMatrix *tau_H_q,
+                              JointMatrix *tau_H_v) const {
+    Kinematics K;
+    std::array<Vector6, N> A, F;
+    newtonEuler(q, v, a, &K, &A, &F);
+    JointVector tau;
+    for (int k = 0; k < N; ++k) {
+      tau(joint_id_[k]) = screw_axes_.col(k).dot(F[k]);
+      if (tau_H_q) newtonEulerTangent(k, false, v, K, A, F, tau_H_q);
+      if (tau_H_v) newtonEulerTangent(k, true, v, K, A, F, tau_H_v);
+    }
+    return tau;
+  }
+
+  /// Joint-space mass matrix, with the Composite Rigid Body Algorithm.
+  JointMatrix massMatrix(const JointVector &q) const {
+    Kinematics K;
+    kinematics(q, JointVector::Zero(), &K);
+
+    std::array<Matrix6, N> Ic = inertias_;
+    for (int k = N - 1; k >= 0; --k) {
+      if (parent_[k] >= 0) {
+        Ic[parent_[k]] += K.Ad[k].transpose() * Ic[k] * K.Ad[k];
+      }
+    }
+    JointMatrix M = JointMatrix::Zero();
+    for (int k = 0; k < N; ++k) {
+      const int j_k = joint_id_[k];
+      Vector6 F = Ic[k] * screw_axes_.col(k);
+      M(j_k, j_k) = screw_axes_.col(k).dot(F);
+      for (int i = k; parent_[i] >= 0;) {
+        F = K.Ad[i].transpose() * F;
+        i = parent_[i];
+        const int j_i = joint_id_[i];
+        M(j_i, j_k) = M(j_k, j_i) = screw_axes_.col(i).dot(F);
+      }
+    }
+    return M;
+  }
+
+  /// Joint accelerations for torques tau at angles q and velocities v, by
+  /// solving M(q) * qdd = tau - h(q, v) with a fixed-size Cholesky.
+  JointVector forwardDynamics(const JointVector &q, const JointVector &v,
+                              const JointVector &tau) const {
+    const JointVector h = inverseDynamics(q, v, JointVector::Zero());
+    return massMatrix(q).llt().solve(tau - h);
+  }
+};
+
+}  // namespace gtdynamics
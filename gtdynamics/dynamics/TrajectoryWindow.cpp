@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryWindow.cpp
+ * @brief Incrementally built trajectory factor graph for receding horizons.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/dynamics/TrajectoryWindow.h>
+
+#include <stdexcept>
+
+using gtsam::FactorIndices;
+using gtsam::NonlinearFactorGraph;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+TrajectoryWindow::TrajectoryWindow(
+    const Robot &robot, const DynamicsGraph &graph_builder, double dt,
+    CollocationScheme collocation,
+    const std::optional<PointOnLinks> &contact_points,
+    const std::optional<double> &mu)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      dt_(dt),
+      collocation_(collocation),
+      contact_points_(contact_points),
+      mu_(mu) {}
+
+/* ************************************************************************* */
+void TrajectoryWindow::append(const NonlinearFactorGraph &factors, int t) {
+  FactorIndices &indices = step_factors_[t - first_step_];
+  for (auto &&factor : factors) {
+    indices.push_back(graph_.size());
+    graph_.push_back(factor);
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph TrajectoryWindow::initialize(int num_steps,
+                                                  int first_step) {
+  if (num_steps < 0) {
+    throw std::invalid_argument(
+        "TrajectoryWindow: num_steps must be non-negative");
+  }
+  first_step_ = first_step;
+  last_step_ = first_step + num_steps;
+  step_factors_.assign(num_steps + 1, FactorIndices());
+  graph_ = NonlinearFactorGraph();
+
+  for (int t = first_step_; t <= last_step_; t++) {
+    append(graph_builder_.dynamicsFactorGraph(robot_, t, contact_points_, mu_),
+           t);
+    if (t < last_step_) {
+      append(graph_builder_.collocationFactors(robot_, t, dt_, collocation_),
+             t);
+    }
+  }
+  return graph_;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph TrajectoryWindow::shift(
+    FactorIndices *removed,
+    const std::optional<PointOnLinks> &contact_points) {
+  if (step_factors_.empty()) {
+    throw std::runtime_error("TrajectoryWindow: shift before initialize");
+  }
+  const size_t begin = graph_.size();
+
+  // Append the new last step.
+  append(graph_builder_.collocationFactors(robot_, last_step_, dt_,
+                                           collocation_),
+         last_step_);
+  step_factors_.emplace_back();
+  ++last_step_;
+  append(graph_builder_.dynamicsFactorGraph(
+             robot_, last_step_,
+             contact_points ? contact_points : contact_points_, mu_),
+         last_step_);
+
+  // Drop the first step.
+  *removed = step_factors_.front();
+  for (size_t index : *removed) graph_[index].reset();
+  step_factors_.pop_front();
+  ++first_step_;
+
+  NonlinearFactorGraph new_factors;
+  for (size_t index = begin; index < graph_.size(); index++) {
+    new_factors.push_back(graph_[index]);
+  }
+  return new_factors;
+}
+
+/* ************************************************************************* */
+const FactorIndices &TrajectoryWindow::stepFactors(int t) const {
+  if (t < first_step_ || t > last_step_) {
+    throw std::out_of_range("TrajectoryWindow: step not in window");
+  }
+  return step_factors_[t - first_step_];
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph TrajectoryWindow::windowGraph() const {
+  NonlinearFactorGraph graph;
+  for (auto &&indices : step_factors_) {
+    for (size_t index : indices) graph.push_back(graph_[index]);
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryWindow.h
+ * @brief Incrementally built trajectory factor graph for receding horizons.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/inference/Factor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <deque>
+#include <optional>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryWindow maintains the factor graph of a trajectory over a sliding
+ * window of time steps [firstStep(), lastStep()], as a receding-horizon
+ * alternative to rebuilding DynamicsGraph::trajectoryFG at every tick.
+ *
+ * Factors are numbered in the order they were handed out, which is the
+ * numbering iSAM2 uses for new factors (with findUnusedFactorSlots off): the
+ * graphs returned by initialize() and shift() can be passed to iSAM2::update
+ * as new factors, together with the indices of the factors to remove. graph()
+ * mirrors that numbering, with removed factors set to null.
+ *
+ * Factors of step t are its dynamics factors followed by the collocation
+ * factors from t to t+1, as in trajectoryFG. Priors and objectives are left
+ * to the caller.
+ */
+class TrajectoryWindow {
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  double dt_;
+  CollocationScheme collocation_;
+  std::optional<PointOnLinks> contact_points_;
+  std::optional<double> mu_;
+
+  int first_step_ = 0, last_step_ = -1;
+  std::deque<gtsam::FactorIndices> step_factors_;  // first to last step
+  gtsam::NonlinearFactorGraph graph_;
+
+  /// Append factors to graph_, recording their indices for step t.
+  void append(const gtsam::NonlinearFactorGraph &factors, int t);
+
+ public:
+  /**
+   * Constructor.
+   * @param robot          the robot
+   * @param graph_builder  builds the per-step dynamics and collocation factors
+   * @param dt             duration of each time step
+   * @param collocation    the collocation scheme
+   * @param contact_points default contact points for every step
+   * @param mu             optional coefficient of static friction
+   */
+  TrajectoryWindow(const Robot &robot, const DynamicsGraph &graph_builder,
+                   double dt, CollocationScheme collocation = Trapezoidal,
+                   const std::optional<PointOnLinks> &contact_points = {},
+                   const std::optional<double> &mu = {});
+
+  /**
+   * Start a window of num_steps steps at time step first_step, discarding any
+   * previous state. The returned factors are equal, factor for factor, to
+   * trajectoryFG(robot, num_steps, dt, ...) with all keys at time steps
+   * shifted by first_step.
+   * @param num_steps  number of time steps in the window
+   * @param first_step time step of the start of the window
+   */
+  gtsam::NonlinearFactorGraph initialize(int num_steps, int first_step = 0);
+
+  /**
+   * Slide the window by one step: drop the factors of the first step and
+   * append the collocation factors into, and the dynamics factors of, a new
+   * last step.
+   * @param removed        set to the indices of the dropped factors
+   * @param contact_points contact points for the new step, defaults to the
+   * ones given at construction
+   * @return the new factors
+   */
+  gtsam::NonlinearFactorGraph shift(
+      gtsam::FactorIndices *removed,
+      const std::optional<PointOnLinks> &contact_points = {});
+
+  /// First time step in the window.
+  int firstStep() const { return first_step_; }
+
+  /// Last time step in the window.
+  int lastStep() const { return last_step_; }
+
+  /// Indices of the factors of step t, which must be in the window.
+  const gtsam::FactorIndices &stepFactors(int t) const;
+
+  /// All factors handed out so far, removed ones set to null.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// The factors of the current window only, in order.
+  gtsam::NonlinearFactorGraph windowGraph() const;
+};
+
+}  // namespace gtdynamics
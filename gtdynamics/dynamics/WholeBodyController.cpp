@@ -0,0 +1,433 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WholeBodyController.cpp
+ * @brief Whole-body inverse dynamics as a QP with a bounded solve time.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/WholeBodyController.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+/// Step size of equality rows, relative to inequality rows, as in OSQP.
+constexpr double kEqualityRhoScale = 1e3;
+
+/// Append all entries of the dense block M at (row, col), zeros included,
+/// so that the sparsity pattern does not depend on the values.
+template <typename Derived>
+void AddBlock(std::vector<Eigen::Triplet<double>> *triplets, int row, int col,
+              const Eigen::MatrixBase<Derived> &M) {
+  for (int c = 0; c < M.cols(); ++c) {
+    for (int r = 0; r < M.rows(); ++r) {
+      triplets->emplace_back(row + r, col + c, M(r, c));
+    }
+  }
+}
+
+/// Append the entries of an identity block, scaled by s, at (row, col).
+void AddIdentity(std::vector<Eigen::Triplet<double>> *triplets, int row,
+                 int col, int n, double s = 1.0) {
+  for (int k = 0; k < n; ++k) triplets->emplace_back(row + k, col + k, s);
+}
+}  // namespace
+
+/* ************************************************************************* */
+WholeBodyController::WholeBodyController(
+    const Robot &robot, const Vector3 &gravity,
+    const WholeBodyControllerParameters &parameters)
+    : robot_(robot),
+      gravity_(gravity),
+      p_(parameters),
+      links_(robot_.links()),
+      joints_(robot_.joints()) {
+  size_t num_link_ids = 0, num_joint_ids = 0;
+  for (auto &&link : links_) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  for (auto &&joint : joints_) {
+    num_joint_ids = std::max<size_t>(num_joint_ids, joint->id() + 1);
+  }
+
+  // Same layout as SparseDynamics, the contact wrenches come last.
+  accel_cols_.assign(num_link_ids, -1);
+  for (auto &&link : links_) {
+    accel_cols_[link->id()] = num_robot_cols_;
+    num_robot_cols_ += 6;
+  }
+  parent_wrench_cols_.assign(num_joint_ids, -1);
+  child_wrench_cols_.assign(num_joint_ids, -1);
+  joint_accel_cols_.assign(num_joint_ids, -1);
+  torque_cols_.assign(num_joint_ids, -1);
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    parent_wrench_cols_[j] = num_robot_cols_;
+    child_wrench_cols_[j] = num_robot_cols_ + 6;
+    joint_accel_cols_[j] = num_robot_cols_ + 12;
+    torque_cols_[j] = num_robot_cols_ + 13;
+    num_robot_cols_ += 14;
+  }
+
+  weights_ = Vector::Zero(num_robot_cols_);
+  linear_cost_ = Vector::Zero(num_robot_cols_);
+  clearTasks();
+  setContactMode({});
+}
+
+/* ************************************************************************* */
+void WholeBodyController::setContactMode(const PointOnLinks &contacts) {
+  for (auto &&contact : contacts) {
+    const int i = contact.link->id();
+    if (i >= static_cast<int>(accel_cols_.size()) || accel_cols_[i] < 0) {
+      throw std::invalid_argument(
+          "WholeBodyController: contact on a link not in the robot");
+    }
+  }
+  contacts_ = contacts;
+
+  num_cols_ = num_robot_cols_;
+  contact_cols_.clear();
+  for (size_t c = 0; c < contacts_.size(); ++c) {
+    contact_cols_.push_back(num_cols_);
+    num_cols_ += 6;
+  }
+
+  // Wrench balance of each link; twist acceleration, torque, wrench
+  // equivalence and limit of each joint; zero acceleration, zero moment and
+  // friction pyramid of each contact.
+  num_rows_ = 6 * links_.size() + 14 * joints_.size() + 11 * contacts_.size();
+
+  weights_.conservativeResize(num_cols_);
+  linear_cost_.conservativeResize(num_cols_);
+  weights_.tail(num_cols_ - num_robot_cols_).setConstant(
+      p_.contact_wrench_weight);
+  linear_cost_.tail(num_cols_ - num_robot_cols_).setZero();
+
+  size_t num_entries = 0;
+  for (auto &&link : links_) num_entries += 6 * (6 + 6 * link->numJoints());
+  num_entries += (3 * 36 + 6 + 6 + 1 + 6 + 1) * joints_.size();
+  num_entries += (36 + 18 + 18 + 15) * contacts_.size();
+  triplets_.reserve(num_entries + num_cols_ + num_rows_);
+  lower_.resize(num_rows_);
+  upper_.resize(num_rows_);
+  rho_.resize(num_rows_);
+
+  // A new structure, analyzed on the next solve, and no hot start.
+  analyzed_ = false;
+  x_ = Vector::Zero(num_cols_);
+  z_ = Vector::Zero(num_rows_);
+  y_ = Vector::Zero(num_rows_);
+}
+
+/* ************************************************************************* */
+void WholeBodyController::setLinkAccelTask(const LinkSharedPtr &link,
+                                           const Vector6 &accel,
+                                           const Vector6 &weights) {
+  const int i = link->id();
+  if (i >= static_cast<int>(accel_cols_.size()) || accel_cols_[i] < 0) {
+    throw std::invalid_argument(
+        "WholeBodyController: task on a link not in the robot");
+  }
+  weights_.segment<6>(accel_cols_[i]) = weights;
+  linear_cost_.segment<6>(accel_cols_[i]) = -weights.cwiseProduct(accel);
+}
+
+/* ************************************************************************* */
+void WholeBodyController::setJointAccelTask(int j, double accel,
+                                            double weight) {
+  if (j < 0 || j >= static_cast<int>(joint_accel_cols_.size()) ||
+      joint_accel_cols_[j] < 0) {
+    throw std::invalid_argument(
+        "WholeBodyController: task on a joint not in the robot");
+  }
+  weights_(joint_accel_cols_[j]) = weight;
+  linear_cost_(joint_accel_cols_[j]) = -weight * accel;
+}
+
+/* ************************************************************************* */
+void WholeBodyController::clearTasks() {
+  weights_.head(num_robot_cols_).setZero();
+  linear_cost_.head(num_robot_cols_).setZero();
+  for (auto &&joint : joints_) {
+    weights_(torque_cols_[joint->id()]) = p_.torque_weight;
+  }
+}
+
+/* ************************************************************************* */
+void WholeBodyController::assemble(int t, const Values &known_values) const {
+  triplets_.clear();
+  int row = 0;
+
+  // Equality rows C x = rhs, with the larger step size.
+  auto setEquality = [&](int row, const Vector &rhs) {
+    lower_.segment(row, rhs.size()) = rhs;
+    upper_.segment(row, rhs.size()) = rhs;
+    rho_.segment(row, rhs.size()).setConstant(kEqualityRhoScale * p_.rho);
+  };
+  auto setBounds = [&](int row, double lower, double upper) {
+    lower_(row) = lower;
+    upper_(row) = upper;
+    rho_(row) = lower == upper ? kEqualityRhoScale * p_.rho : p_.rho;
+  };
+
+  for (auto &&link : links_) {
+    const int i = link->id();
+    if (link->isFixed()) {
+      // A_i = 0
+      AddIdentity(&triplets_, row, accel_cols_[i], 6);
+      setEquality(row, Vector6::Zero());
+    } else {
+      // G_i * A_i - F_i_j1 - .. - F_i_jn - C_i_c1 - .. = ad(V_i)^T * G_i * V_i
+      // + m_i * R_i^T * g
+      const Matrix6 &G_i = link->inertiaMatrix();
+      const Vector6 V_i = Twist(known_values, i, t);
+      const Vector6 rhs =
+          Pose3::adjointMap(V_i).transpose() * G_i * V_i +
+          link->gravityWrench(gravity_, Pose(known_values, i, t));
+      AddBlock(&triplets_, row, accel_cols_[i], G_i);
+      for (auto &&joint : link->joints()) {
+        const int j = joint->id();
+        const int col = joint->child() == link ? child_wrench_cols_[j]
+                                               : parent_wrench_cols_[j];
+        AddIdentity(&triplets_, row, col, 6, -1.0);
+      }
+      for (size_t c = 0; c < contacts_.size(); ++c) {
+        if (contacts_[c].link->id() != i) continue;
+        AddIdentity(&triplets_, row, contact_cols_[c], 6, -1.0);
+      }
+      setEquality(row, rhs);
+    }
+    row += 6;
+  }
+
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    const int i1 = joint->parent()->id(), i2 = joint->child()->id();
+    const Pose3 T_i2i1 =
+        Pose(known_values, i2, t).inverse() * Pose(known_values, i1, t);
+    const Matrix6 Ad_i2i1 = T_i2i1.AdjointMap();
+    const Vector6 V_i2 = Twist(known_values, i2, t);
+    const Vector6 &S_i2_j = joint->cScrewAxis();
+    const double v_j = JointVel(known_values, j, t);
+
+    // A_i2 - Ad(T_21) * A_i1 - S_i2_j * a_j = ad(V_i2) * S_i2_j * v_j
+    AddIdentity(&triplets_, row, accel_cols_[i2], 6);
+    AddBlock(&triplets_, row, accel_cols_[i1], -Ad_i2i1);
+    AddBlock(&triplets_, row, joint_accel_cols_[j], -S_i2_j);
+    setEquality(row, Pose3::adjointMap(V_i2) * S_i2_j * v_j);
+    row += 6;
+
+    // S_i_j^T * F_i_j - tau = 0
+    AddBlock(&triplets_, row, child_wrench_cols_[j], S_i2_j.transpose());
+    triplets_.emplace_back(row, torque_cols_[j], -1.0);
+    setBounds(row, 0.0, 0.0);
+    row += 1;
+
+    // F_i1_j + Ad(T_i2i1)^T F_i2_j = 0
+    AddIdentity(&triplets_, row, parent_wrench_cols_[j], 6);
+    AddBlock(&triplets_, row, child_wrench_cols_[j], Ad_i2i1.transpose());
+    setEquality(row, Vector6::Zero());
+    row += 6;
+
+    // A fixed joint transmits any torque and does not move, an unactuated
+    // joint has no torque, and other joints are within the torque limit.
+    if (joint->type() == Joint::Type::Fixed) {
+      triplets_.emplace_back(row, joint_accel_cols_[j], 1.0);
+      setBounds(row, 0.0, 0.0);
+    } else {
+      triplets_.emplace_back(row, torque_cols_[j], 1.0);
+      const JointParams &params = joint->parameters();
+      const double limit = params.effort_type == JointEffortType::Unactuated
+                               ? 0.0
+                               : params.torque_limit;
+      setBounds(row, -limit, limit);
+    }
+    row += 1;
+  }
+
+  // Flat ground normal to gravity, with the other two axes as tangents.
+  int up_axis;
+  gravity_.cwiseAbs().maxCoeff(&up_axis);
+  const Vector3 normal =
+      Vector3::Unit(up_axis) * (gravity_(up_axis) > 0 ? -1.0 : 1.0);
+  const Vector3 tangent1 = Vector3::Unit((up_axis + 1) % 3),
+                tangent2 = Vector3::Unit((up_axis + 2) % 3);
+  const double mu = p_.mu / std::sqrt(2.0);
+
+  for (size_t c = 0; c < contacts_.size(); ++c) {
+    const PointOnLink &cp = contacts_[c];
+    const int i = cp.link->id(), col = contact_cols_[c];
+
+    // Zero linear acceleration at the contact, and a contact wrench without
+    // moment about the contact point, as in linearDynamicsGraph.
+    const Pose3 cTcom(gtsam::Rot3(), -cp.point);
+    const Matrix6 Ad = cTcom.AdjointMap();
+    AddBlock(&triplets_, row, accel_cols_[i], Ad.bottomRows<3>());
+    setEquality(row, Vector3::Zero());
+    row += 3;
+    const Matrix6 AdInvT = cTcom.inverse().AdjointMap().transpose();
+    AddBlock(&triplets_, row, col, AdInvT.topRows<3>());
+    setEquality(row, Vector3::Zero());
+    row += 3;
+
+    // Pushing force in world frame, within the pyramid
+    // |t_k^T f| <= mu / sqrt(2) * n^T f.
+    const gtsam::Matrix3 R = Pose(known_values, i, t).rotation().matrix();
+    AddBlock(&triplets_, row, col + 3,
+             Eigen::RowVector3d(normal.transpose() * R));
+    setBounds(row, 0.0, kInfinity);
+    row += 1;
+    for (const Vector3 &tangent : {tangent1, tangent2}) {
+      for (double sign : {1.0, -1.0}) {
+        AddBlock(&triplets_, row, col + 3,
+                 Eigen::RowVector3d((mu * normal + sign * tangent).transpose() *
+                                    R));
+        setBounds(row, 0.0, kInfinity);
+        row += 1;
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+void WholeBodyController::solve() const {
+  const auto start = std::chrono::steady_clock::now();
+  const int n = num_cols_, m = num_rows_;
+  C_.resize(m, n);
+  C_.setFromTriplets(triplets_.begin(), triplets_.end());
+
+  // Lower triangle of the quasi-definite KKT matrix
+  // [P + sigma * I, C^T; C, -diag(1 / rho)], with the same pattern at every
+  // solve of one contact mode.
+  for (Triplet &triplet : triplets_) {
+    triplet = Triplet(triplet.row() + n, triplet.col(), triplet.value());
+  }
+  for (int k = 0; k < n; ++k) {
+    triplets_.emplace_back(k, k, weights_(k) + p_.sigma);
+  }
+  for (int r = 0; r < m; ++r) {
+    triplets_.emplace_back(n + r, n + r, -1.0 / rho_(r));
+  }
+  SpMatrix K(n + m, n + m);
+  K.setFromTriplets(triplets_.begin(), triplets_.end());
+  if (!analyzed_) {
+    kkt_.analyzePattern(K);
+    analyzed_ = true;
+  }
+  kkt_.factorize(K);
+  if (kkt_.info() != Eigen::Success) {
+    throw std::runtime_error("WholeBodyController: factorization failed.");
+  }
+
+  // ADMM iterations from the last solution, clipped to the new bounds.
+  const Vector &q = linear_cost_;
+  const Vector rho_inv = rho_.cwiseInverse();
+  z_ = z_.cwiseMax(lower_).cwiseMin(upper_);
+  Vector rhs(n + m), Cx(m), Px(n), CTy(n);
+  converged_ = false;
+  for (iterations_ = 0; iterations_ < p_.max_iterations;) {
+    rhs.head(n) = p_.sigma * x_ - q;
+    rhs.tail(m) = z_ - rho_inv.cwiseProduct(y_);
+    const Vector solution = kkt_.solve(rhs);
+    const Vector x_tilde = solution.head(n);
+    const Vector z_tilde =
+        z_ + rho_inv.cwiseProduct(solution.tail(m) - y_);
+    x_ = p_.alpha * x_tilde + (1 - p_.alpha) * x_;
+    const Vector z_relaxed = p_.alpha * z_tilde + (1 - p_.alpha) * z_;
+    const Vector z_next = (z_relaxed + rho_inv.cwiseProduct(y_))
+                              .cwiseMax(lower_)
+                              .cwiseMin(upper_);
+    y_ += rho_.cwiseProduct(z_relaxed - z_next);
+    z_ = z_next;
+    ++iterations_;
+
+    // Stop at the tolerances of OSQP, or at the deadline.
+    Cx = C_ * x_;
+    Px = weights_.cwiseProduct(x_);
+    CTy = C_.transpose() * y_;
+    primal_residual_ = (Cx - z_).lpNorm<Eigen::Infinity>();
+    dual_residual_ = (Px + q + CTy).lpNorm<Eigen::Infinity>();
+    const double eps_primal =
+        p_.eps_abs + p_.eps_rel * std::max(Cx.lpNorm<Eigen::Infinity>(),
+                                           z_.lpNorm<Eigen::Infinity>());
+    const double eps_dual =
+        p_.eps_abs +
+        p_.eps_rel * std::max({Px.lpNorm<Eigen::Infinity>(),
+                               CTy.lpNorm<Eigen::Infinity>(),
+                               q.lpNorm<Eigen::Infinity>()});
+    if (primal_residual_ <= eps_primal && dual_residual_ <= eps_dual) {
+      converged_ = true;
+      break;
+    }
+    if (p_.max_solve_time > 0) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (elapsed.count() >= p_.max_solve_time) break;
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values WholeBodyController::compute(int t, const Values &known_values) const {
+  assemble(t, known_values);
+  solve();
+
+  // Arrange values.
+  auto expand = [&](int col) { return Vector6(x_.segment<6>(col)); };
+  Values values = known_values;
+  try {
+    for (auto &&joint : joints_) {
+      const int j = joint->id();
+      InsertJointAccel(&values, j, t, x_(joint_accel_cols_[j]));
+      InsertTorque(&values, j, t, x_(torque_cols_[j]));
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   expand(parent_wrench_cols_[j]));
+      InsertWrench(&values, joint->child()->id(), j, t,
+                   expand(child_wrench_cols_[j]));
+    }
+    for (auto &&link : links_) {
+      const int i = link->id();
+      InsertTwistAccel(&values, i, t, expand(accel_cols_[i]));
+    }
+    std::map<int, int> num_contacts;
+    for (size_t c = 0; c < contacts_.size(); ++c) {
+      const int i = contacts_[c].link->id();
+      values.insert(ContactWrenchKey(i, num_contacts[i]++, t),
+                    expand(contact_cols_[c]));
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "WholeBodyController::compute: known_values should contain no "
+        "torques, accelerations or wrenches.");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WholeBodyController.h
+ * @brief Whole-body inverse dynamics as a QP with a bounded solve time.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <optional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Friction, regularization and solver settings of WholeBodyController.
+struct WholeBodyControllerParameters {
+  double mu = 1.0;  ///< friction coefficient, as a pyramid inside the cone
+
+  /// Weights of the torques and contact wrenches, which regularize the QP.
+  double torque_weight = 1e-4, contact_wrench_weight = 1e-6;
+
+  size_t max_iterations = 200;  ///< iterations per solve
+  double max_solve_time = 0.0;  ///< seconds per solve, 0 for no deadline
+  double eps_abs = 1e-5, eps_rel = 1e-5;  ///< convergence tolerances
+
+  /// ADMM step size, proximal weight and relaxation, as in OSQP.
+  double rho = 0.1, sigma = 1e-6, alpha = 1.6;
+};
+
+/**
+ * WholeBodyController computes torques, accelerations and contact wrenches
+ * which best achieve weighted task accelerations, subject to the linear
+ * dynamics of DynamicsGraph::linearDynamicsGraph, contacts with zero linear
+ * acceleration and wrenches in friction cones, and the joint torque limits of
+ * JointParams.
+ *
+ * The QP has the same unknowns and equality rows as SparseDynamics, with a
+ * fixed column for each, plus the contact wrenches ContactWrenchKey(i, c, t)
+ * of the current contact mode. Its sparsity pattern only changes with the
+ * contact mode, so setContactMode analyzes the KKT matrix once, and each call
+ * to compute only refactorizes it numerically. The QP is solved by ADMM as in
+ * OSQP, hot-started from the previous solution, and stops after
+ * max_iterations or max_solve_time, returning the last iterate if it has not
+ * converged by then.
+ *
+ * Friction cones are inner pyramids on flat ground normal to gravity. The
+ * matrices, factorization and iterates are shared between calls, so a
+ * WholeBodyController must not be used from several threads at once.
+ */
+class WholeBodyController {
+ private:
+  using SpMatrix = Eigen::SparseMatrix<double>;
+  using Triplet = Eigen::Triplet<double>;
+  using LDLT = Eigen::SimplicialLDLT<SpMatrix>;
+
+  Robot robot_;
+  gtsam::Vector3 gravity_;
+  WholeBodyControllerParameters p_;
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  PointOnLinks contacts_;
+
+  /// Column offsets, indexed by link or joint id, and by contact.
+  std::vector<int> accel_cols_;
+  std::vector<int> parent_wrench_cols_, child_wrench_cols_;
+  std::vector<int> joint_accel_cols_, torque_cols_;
+  std::vector<int> contact_cols_;
+  int num_robot_cols_ = 0, num_rows_ = 0, num_cols_ = 0;
+
+  /// Cost: diagonal of P without sigma, and q, from the tasks.
+  gtsam::Vector weights_, linear_cost_;
+
+  /// Constraints lower <= C x <= upper, and ADMM step size per row.
+  mutable std::vector<Triplet> triplets_;
+  mutable SpMatrix C_;
+  mutable gtsam::Vector lower_, upper_, rho_;
+
+  /// KKT factorization, and iterates kept between solves.
+  mutable LDLT kkt_;
+  mutable bool analyzed_ = false;
+  mutable gtsam::Vector x_, z_, y_;
+  mutable size_t iterations_ = 0;
+  mutable bool converged_ = false;
+  mutable double primal_residual_ = 0, dual_residual_ = 0;
+
+ public:
+  /**
+   * Constructor, in the mode without contacts.
+   * @param robot      the robot
+   * @param gravity    gravity in world frame
+   * @param parameters friction, regularization and solver settings
+   */
+  WholeBodyController(const Robot &robot,
+                      const gtsam::Vector3 &gravity = gtsam::Vector3(0, 0,
+                                                                     -9.8),
+                      const WholeBodyControllerParameters &parameters =
+                          WholeBodyControllerParameters());
+
+  /**
+   * Change the contact mode, which resets the QP structure and the iterates.
+   * @param contacts contact points, at most a few per link
+   */
+  void setContactMode(const PointOnLinks &contacts);
+
+  /// Contact points of the current mode.
+  const PointOnLinks &contactMode() const { return contacts_; }
+
+  /**
+   * Ask for a twist acceleration of a link, in its CoM frame.
+   * @param link    the link
+   * @param accel   desired twist acceleration
+   * @param weights weight of each coordinate, zero to leave it free
+   */
+  void setLinkAccelTask(const LinkSharedPtr &link, const gtsam::Vector6 &accel,
+                        const gtsam::Vector6 &weights);
+
+  /// Ask for an acceleration of joint j, with the given weight.
+  void setJointAccelTask(int j, double accel, double weight);
+
+  /// Remove all tasks, keeping the regularization.
+  void clearTasks();
+
+  /**
+   * Solve the QP at time step t.
+   * @param t            time step
+   * @param known_values Values with poses, twists and joint velocities for
+   * all links/joints at time t.
+   * @return known_values with torques, joint and twist accelerations, joint
+   * wrenches and contact wrenches added.
+   */
+  gtsam::Values compute(int t, const gtsam::Values &known_values) const;
+
+  /// Number of ADMM iterations of the last solve.
+  size_t iterations() const { return iterations_; }
+
+  /// Whether the last solve met the tolerances.
+  bool converged() const { return converged_; }
+
+  /// Largest constraint violation of the last solution.
+  double primalResidual() const { return primal_residual_; }
+
+  /// Largest optimality violation of the last solution.
+  double dualResidual() const { return dual_residual_; }
+
+  /// Return the number of unknowns, and of constraint rows, of the QP.
+  int dim() const { return num_cols_; }
+  int numConstraints() const { return num_rows_; }
+
+ private:
+  /// Write the constraint rows and bounds at time t into the buffers.
+  void assemble(int t, const gtsam::Values &known_values) const;
+
+  /// Refactorize the KKT matrix, and run ADMM from the last iterates.
+  void solve() const;
+};
+
+}  // namespace gtdynamics
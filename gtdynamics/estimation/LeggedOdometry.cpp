@@ -0,0 +1,239 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedOdometry.cpp
+ * @brief Fixed-lag smoother for legged odometry from IMU, joint encoders and
+ * contact flags.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#include <gtdynamics/estimation/LeggedOdometry.h>
+#include <gtdynamics/factors/ForwardKinematicsFactor.h>
+#include <gtdynamics/factors/PreintegratedContactFactors.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::imuBias::ConstantBias;
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NavState;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+/* ************************************************************************* */
+LeggedOdometryParams::LeggedOdometryParams()
+    : imu_params(gtsam::PreintegrationParams::MakeSharedU(9.81)) {
+  imu_params->setAccelerometerCovariance(1e-4 * gtsam::I_3x3);
+  imu_params->setGyroscopeCovariance(1e-6 * gtsam::I_3x3);
+  imu_params->setIntegrationCovariance(1e-8 * gtsam::I_3x3);
+  lm_params.setMaxIterations(10);
+}
+
+/* ************************************************************************* */
+LeggedOdometry::LeggedOdometry(const Robot &robot,
+                               const std::string &base_name,
+                               const std::vector<std::string> &foot_names,
+                               const LeggedOdometryParams &params)
+    : robot_(robot),
+      base_name_(base_name),
+      base_id_(robot.link(base_name)->id()),
+      params_(params),
+      pim_(params.imu_params) {
+  for (auto &&name : foot_names) {
+    foot_ids_.push_back(robot.link(name)->id());
+  }
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::initialize(double t, const NavState &state,
+                                const Vector &q,
+                                const std::vector<bool> &contacts,
+                                const ConstantBias &bias) {
+  if (contacts.size() != foot_ids_.size()) {
+    throw std::invalid_argument(
+        "LeggedOdometry: expected one contact flag per foot.");
+  }
+  graph_ = gtsam::NonlinearFactorGraph();
+  values_.clear();
+  window_.clear();
+  k_ = 0;
+  imu_time_ = t;
+  state_ = state;
+  bias_ = bias;
+  pim_.resetIntegrationAndSetBias(bias_);
+
+  const Key pose_key = PoseKey(base_id_, 0), velocity_key = BaseVelocityKey(0),
+            bias_key = ImuBiasKey(0);
+  graph_.addPrior(pose_key, state.pose(), params_.prior_pose_model);
+  graph_.addPrior(velocity_key, state.velocity(),
+                  params_.prior_velocity_model);
+  graph_.addPrior(bias_key, bias, params_.prior_bias_model);
+  values_.insert(pose_key, state.pose());
+  values_.insert(velocity_key, state.velocity());
+  values_.insert(bias_key, bias);
+
+  Keyframe &keyframe = window_[0];
+  keyframe.time = t;
+  keyframe.keys = {pose_key, velocity_key, bias_key};
+  contacts_.assign(contacts.size(), false);
+  addContacts(q, contacts, 0.0, &keyframe.keys);
+  contacts_ = contacts;
+}
+
+/* ************************************************************************* */
+NavState LeggedOdometry::addImu(double t, const Vector3 &acceleration,
+                                const Vector3 &angular_velocity) {
+  if (k_ < 0) {
+    throw std::runtime_error(
+        "LeggedOdometry: initialize before adding measurements.");
+  }
+  if (t <= imu_time_) {
+    throw std::invalid_argument(
+        "LeggedOdometry: IMU samples must be added in time order.");
+  }
+  pim_.integrateMeasurement(acceleration, angular_velocity, t - imu_time_);
+  imu_time_ = t;
+  return pim_.predict(state_, bias_);
+}
+
+/* ************************************************************************* */
+NavState LeggedOdometry::addKinematics(const Vector &q,
+                                       const std::vector<bool> &contacts) {
+  if (k_ < 0) {
+    throw std::runtime_error(
+        "LeggedOdometry: initialize before adding measurements.");
+  }
+  if (contacts.size() != foot_ids_.size()) {
+    throw std::invalid_argument(
+        "LeggedOdometry: expected one contact flag per foot.");
+  }
+  const double dt = pim_.deltaTij();
+  if (dt <= 0) {
+    throw std::runtime_error(
+        "LeggedOdometry: no IMU samples since the last keyframe.");
+  }
+
+  // Connect the new keyframe to the previous one with the IMU.
+  const int i = k_++;
+  const Key pose_i = PoseKey(base_id_, i), pose_k = PoseKey(base_id_, k_);
+  const Key velocity_i = BaseVelocityKey(i), velocity_k = BaseVelocityKey(k_);
+  const Key bias_i = ImuBiasKey(i), bias_k = ImuBiasKey(k_);
+  graph_.emplace_shared<gtsam::ImuFactor>(pose_i, velocity_i, pose_k,
+                                          velocity_k, bias_i, pim_);
+  graph_.emplace_shared<gtsam::BetweenFactor<ConstantBias>>(
+      bias_i, bias_k, ConstantBias(),
+      gtsam::noiseModel::Isotropic::Sigma(
+          6, params_.bias_random_walk_sigma * std::sqrt(dt)));
+  const NavState predicted = pim_.predict(state_, bias_);
+  values_.insert(pose_k, predicted.pose());
+  values_.insert(velocity_k, predicted.velocity());
+  values_.insert(bias_k, bias_);
+
+  Keyframe &keyframe = window_[k_];
+  keyframe.time = imu_time_;
+  keyframe.keys = {pose_k, velocity_k, bias_k};
+  addContacts(q, contacts, dt, &keyframe.keys);
+  contacts_ = contacts;
+
+  optimize();
+  marginalize();
+  pim_.resetIntegrationAndSetBias(bias_);
+  return state_;
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::addContacts(const Vector &q,
+                                 const std::vector<bool> &contacts, double dt,
+                                 KeyVector *keys) {
+  robot_.forwardKinematics(q, Vector::Zero(q.size()), &fk_states_,
+                           base_name_);
+  const Key base_key = PoseKey(base_id_, k_);
+  const Pose3 wTb = values_.at<Pose3>(base_key);
+  const Pose3 &bTb = fk_states_.poses[base_id_];
+  for (size_t f = 0; f < foot_ids_.size(); f++) {
+    if (!contacts[f]) continue;
+    const Key contact_key = ContactPoseKey(foot_ids_[f], k_);
+    const Pose3 bTc = bTb.between(fk_states_.poses[foot_ids_[f]]);
+    graph_.emplace_shared<ForwardKinematicsFactor>(base_key, contact_key, bTc,
+                                                   params_.kinematics_model);
+
+    if (contacts_[f]) {
+      // The foot stays where it was at the previous keyframe.
+      const Key previous_key = ContactPoseKey(foot_ids_[f], k_ - 1);
+      PreintegratedRigidContactMeasurements pcm(
+          params_.contact_angular_velocity_covariance,
+          params_.contact_linear_velocity_covariance);
+      pcm.integrateMeasurement(dt);
+      graph_.emplace_shared<PreintegratedRigidContactFactor>(
+          previous_key, contact_key, pcm);
+      values_.insert(contact_key, values_.at<Pose3>(previous_key));
+    } else {
+      values_.insert(contact_key, wTb * bTc);
+    }
+    keys->push_back(contact_key);
+  }
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::optimize() {
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph_, values_,
+                                               params_.lm_params);
+  values_ = optimizer.optimize();
+  state_ = NavState(values_.at<Pose3>(PoseKey(base_id_, k_)),
+                    values_.at<Vector3>(BaseVelocityKey(k_)));
+  bias_ = values_.at<ConstantBias>(ImuBiasKey(k_));
+}
+
+/* ************************************************************************* */
+void LeggedOdometry::marginalize() {
+  // The latest keyframe is always kept, as the next one connects to it.
+  const double horizon = window_.at(k_).time - params_.lag;
+  KeyVector marginal_keys;
+  while (window_.size() > 1 && window_.begin()->second.time < horizon) {
+    const KeyVector &keys = window_.begin()->second.keys;
+    marginal_keys.insert(marginal_keys.end(), keys.begin(), keys.end());
+    window_.erase(window_.begin());
+  }
+  if (marginal_keys.empty()) return;
+
+  // Eliminate the old variables from the factors on them, linearized at the
+  // current estimate, and keep the marginal on the remaining variables.
+  const gtsam::KeySet marginal_set(marginal_keys.begin(), marginal_keys.end());
+  gtsam::NonlinearFactorGraph marginal_factors, kept;
+  for (const auto &factor : graph_) {
+    if (!factor) continue;
+    const bool involved =
+        std::any_of(factor->begin(), factor->end(),
+                    [&](Key key) { return marginal_set.count(key) > 0; });
+    (involved ? marginal_factors : kept).push_back(factor);
+  }
+  const auto linear = marginal_factors.linearize(values_);
+  const auto eliminated = linear->eliminatePartialSequential(
+      gtsam::Ordering(marginal_keys.begin(), marginal_keys.end()));
+  for (const auto &factor : *eliminated.second) {
+    if (factor && !factor->empty()) {
+      kept.emplace_shared<gtsam::LinearContainerFactor>(factor, values_);
+    }
+  }
+
+  graph_ = kept;
+  for (Key key : marginal_keys) values_.erase(key);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,205 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedOdometry.h
+ * @brief Fixed-lag smoother for legged odometry from IMU, joint encoders and
+ * contact flags.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/navigation/ImuFactor.h>
+#include <gtsam/navigation/NavState.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Shorthand for vb_k, the world frame velocity of the base at keyframe k.
+inline gtsam::Key BaseVelocityKey(int k) {
+  return DynamicsSymbol::SimpleSymbol("vb", k);
+}
+
+/// Shorthand for ib_k, the IMU bias at keyframe k.
+inline gtsam::Key ImuBiasKey(int k) {
+  return DynamicsSymbol::SimpleSymbol("ib", k);
+}
+
+/// Shorthand for pc_i_k, the contact frame pose of foot link i at keyframe k.
+inline gtsam::Key ContactPoseKey(int i, int k) {
+  return DynamicsSymbol::LinkSymbol("pc", i, k);
+}
+
+/// Parameters of LeggedOdometry.
+struct LeggedOdometryParams {
+  /// IMU noise and gravity. The IMU is at the base link CoM unless
+  /// imu_params->body_P_sensor says otherwise.
+  std::shared_ptr<gtsam::PreintegrationParams> imu_params;
+
+  /// Time in seconds covered by the smoother window; older keyframes are
+  /// marginalized out.
+  double lag = 1.0;
+
+  /// Priors on the initial state.
+  gtsam::SharedNoiseModel prior_pose_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+  gtsam::SharedNoiseModel prior_velocity_model =
+      gtsam::noiseModel::Isotropic::Sigma(3, 1e-2);
+  gtsam::SharedNoiseModel prior_bias_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-1);
+
+  /// Random walk of the IMU bias, per square root of a second.
+  double bias_random_walk_sigma = 1e-3;
+
+  /// Noise of the base to foot pose given by forward kinematics of the
+  /// encoder readings.
+  gtsam::SharedNoiseModel kinematics_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+
+  /// Covariances of the angular and linear velocity of a foot in contact, as
+  /// in PreintegratedRigidContactMeasurements. Point feet that roll on the
+  /// ground need a large angular velocity covariance.
+  gtsam::Matrix3 contact_angular_velocity_covariance = 1e-4 * gtsam::I_3x3;
+  gtsam::Matrix3 contact_linear_velocity_covariance = 1e-4 * gtsam::I_3x3;
+
+  /// Parameters of the optimization after each keyframe; the iterations
+  /// bound its latency.
+  gtsam::LevenbergMarquardtParams lm_params;
+
+  /// Default constructor, with gravity along -z and small IMU noise.
+  LeggedOdometryParams();
+};
+
+/**
+ * Legged odometry with a fixed-lag smoother. IMU samples are preintegrated
+ * between keyframes, and the state predicted from them is available at IMU
+ * rate. Each joint encoder reading, with the contact flags of the feet, adds a
+ * keyframe with the base pose, velocity and IMU bias, and the poses of the
+ * feet in contact, and re-optimizes the window:
+ *  - an ImuFactor and a bias random walk connect consecutive keyframes,
+ *  - a ForwardKinematicsFactor relates the base to each foot in contact,
+ *  - a PreintegratedRigidContactFactor keeps a foot that stays in contact in
+ *    place.
+ * Keyframes older than the lag are marginalized into linear factors, so the
+ * memory and the latency of an update are bounded by the window.
+ */
+class LeggedOdometry {
+ public:
+  /**
+   * Constructor.
+   * @param robot the robot model
+   * @param base_name name of the base link, which carries the IMU
+   * @param foot_names names of the foot links, in the order of the contact
+   * flags
+   * @param params smoother parameters
+   */
+  LeggedOdometry(const Robot &robot, const std::string &base_name,
+                 const std::vector<std::string> &foot_names,
+                 const LeggedOdometryParams &params = LeggedOdometryParams());
+
+  /**
+   * Start the estimate; must be called before any measurement.
+   * @param t time of the initial state
+   * @param state initial pose and velocity of the base
+   * @param q joint angles, indexed by joint id
+   * @param contacts whether each foot is in contact
+   * @param bias initial IMU bias
+   */
+  void initialize(double t, const gtsam::NavState &state,
+                  const gtsam::Vector &q, const std::vector<bool> &contacts,
+                  const gtsam::imuBias::ConstantBias &bias =
+                      gtsam::imuBias::ConstantBias());
+
+  /**
+   * Preintegrate an IMU sample.
+   * @param t time of the sample, after the previous one
+   * @param acceleration measured specific force
+   * @param angular_velocity measured angular velocity
+   * @return the base state at t predicted from the last keyframe
+   */
+  gtsam::NavState addImu(double t, const gtsam::Vector3 &acceleration,
+                         const gtsam::Vector3 &angular_velocity);
+
+  /**
+   * Add a keyframe at the last IMU sample, with the encoders and contact
+   * flags measured then, and re-optimize the window.
+   * @param q joint angles, indexed by joint id
+   * @param contacts whether each foot is in contact
+   * @return the smoothed base state at the new keyframe
+   */
+  gtsam::NavState addKinematics(const gtsam::Vector &q,
+                                const std::vector<bool> &contacts);
+
+  /// Smoothed base state at the latest keyframe.
+  const gtsam::NavState &state() const { return state_; }
+
+  /// IMU bias at the latest keyframe.
+  const gtsam::imuBias::ConstantBias &bias() const { return bias_; }
+
+  /// Index of the latest keyframe.
+  int keyframe() const { return k_; }
+
+  /// Number of keyframes in the window.
+  size_t numKeyframes() const { return window_.size(); }
+
+  /// Factors of the window, including the marginals of older keyframes.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// Estimates of the variables in the window.
+  const gtsam::Values &values() const { return values_; }
+
+ private:
+  /// Time and variables of a keyframe in the window.
+  struct Keyframe {
+    double time;
+    gtsam::KeyVector keys;
+  };
+
+  /// Add the contact factors and initial contact poses of keyframe k_, dt
+  /// after the previous one, and their keys to keys.
+  void addContacts(const gtsam::Vector &q, const std::vector<bool> &contacts,
+                   double dt, gtsam::KeyVector *keys);
+
+  /// Optimize the window and update the latest state.
+  void optimize();
+
+  /// Replace the factors of keyframes older than the lag by their marginal.
+  void marginalize();
+
+  const Robot robot_;
+  std::string base_name_;
+  int base_id_;
+  std::vector<int> foot_ids_;
+  LeggedOdometryParams params_;
+
+  gtsam::PreintegratedImuMeasurements pim_;
+  LinkStates fk_states_;  // forward kinematics buffer
+
+  int k_ = -1;
+  double imu_time_ = 0;
+  std::vector<bool> contacts_;
+  gtsam::NavState state_;
+  gtsam::imuBias::ConstantBias bias_;
+
+  std::map<int, Keyframe> window_;
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::Values values_;
+};
+
+}  // namespace gtdynamics
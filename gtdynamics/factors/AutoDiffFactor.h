@@ -0,0 +1,260 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AutoDiffFactor.h
+ * @brief Factor on scalar variables with forward-mode automatic
+ * differentiation of a templated residual functor.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Dual number for forward-mode automatic differentiation w.r.t. N scalar
+ * variables: a value and its fixed-size gradient, so that evaluating a
+ * residual with duals computes all its derivatives without allocation.
+ */
+template <int N>
+struct Dual {
+  using Gradient = Eigen::Matrix<double, N, 1>;
+
+  double a = 0;                   // value.
+  Gradient v = Gradient::Zero();  // derivatives w.r.t. the N variables.
+
+  Dual() {}
+
+  /// A constant.
+  Dual(double value) : a(value) {}  // NOLINT
+
+  /// Variable i of the N variables.
+  Dual(double value, int i) : a(value) { v(i) = 1; }
+
+  Dual(double value, const Gradient &gradient) : a(value), v(gradient) {}
+
+  Dual &operator+=(const Dual &y) { return *this = *this + y; }
+  Dual &operator-=(const Dual &y) { return *this = *this - y; }
+  Dual &operator*=(const Dual &y) { return *this = *this * y; }
+  Dual &operator/=(const Dual &y) { return *this = *this / y; }
+};
+
+/// Value of a double or a dual number, e.g. to print inside a functor.
+inline double DualValue(double x) { return x; }
+template <int N>
+double DualValue(const Dual<N> &x) {
+  return x.a;
+}
+
+/* ************************************************************************* */
+// Arithmetic.
+template <int N>
+Dual<N> operator-(const Dual<N> &x) {
+  return Dual<N>(-x.a, -x.v);
+}
+template <int N>
+Dual<N> operator+(const Dual<N> &x, const Dual<N> &y) {
+  return Dual<N>(x.a + y.a, x.v + y.v);
+}
+template <int N>
+Dual<N> operator-(const Dual<N> &x, const Dual<N> &y) {
+  return Dual<N>(x.a - y.a, x.v - y.v);
+}
+template <int N>
+Dual<N> operator*(const Dual<N> &x, const Dual<N> &y) {
+  return Dual<N>(x.a * y.a, y.a * x.v + x.a * y.v);
+}
+template <int N>
+Dual<N> operator/(const Dual<N> &x, const Dual<N> &y) {
+  return Dual<N>(x.a / y.a, (y.a * x.v - x.a * y.v) / (y.a * y.a));
+}
+
+// Arithmetic with constants, which template deduction does not convert.
+template <int N>
+Dual<N> operator+(const Dual<N> &x, double y) {
+  return Dual<N>(x.a + y, x.v);
+}
+template <int N>
+Dual<N> operator+(double x, const Dual<N> &y) {
+  return Dual<N>(x + y.a, y.v);
+}
+template <int N>
+Dual<N> operator-(const Dual<N> &x, double y) {
+  return Dual<N>(x.a - y, x.v);
+}
+template <int N>
+Dual<N> operator-(double x, const Dual<N> &y) {
+  return Dual<N>(x - y.a, -y.v);
+}
+template <int N>
+Dual<N> operator*(const Dual<N> &x, double y) {
+  return Dual<N>(x.a * y, y * x.v);
+}
+template <int N>
+Dual<N> operator*(double x, const Dual<N> &y) {
+  return Dual<N>(x * y.a, x * y.v);
+}
+template <int N>
+Dual<N> operator/(const Dual<N> &x, double y) {
+  return Dual<N>(x.a / y, x.v / y);
+}
+template <int N>
+Dual<N> operator/(double x, const Dual<N> &y) {
+  return Dual<N>(x / y.a, (-x / (y.a * y.a)) * y.v);
+}
+
+// Comparisons only involve the values, so functors can branch.
+#define GTD_DUAL_COMPARISON(OP)                          \
+  template <int N>                                       \
+  bool operator OP(const Dual<N> &x, const Dual<N> &y) { \
+    return x.a OP y.a;                                   \
+  }                                                      \
+  template <int N>                                       \
+  bool operator OP(const Dual<N> &x, double y) {         \
+    return x.a OP y;                                     \
+  }                                                      \
+  template <int N>                                       \
+  bool operator OP(double x, const Dual<N> &y) {         \
+    return x OP y.a;                                     \
+  }
+GTD_DUAL_COMPARISON(<)
+GTD_DUAL_COMPARISON(>)
+GTD_DUAL_COMPARISON(<=)
+GTD_DUAL_COMPARISON(>=)
+#undef GTD_DUAL_COMPARISON
+
+/* ************************************************************************* */
+// Elementary functions; functors should call them unqualified after
+// `using std::exp;` etc., so that the double overloads are found as well.
+template <int N>
+Dual<N> exp(const Dual<N> &x) {
+  const double e = std::exp(x.a);
+  return Dual<N>(e, e * x.v);
+}
+template <int N>
+Dual<N> log(const Dual<N> &x) {
+  return Dual<N>(std::log(x.a), x.v / x.a);
+}
+template <int N>
+Dual<N> sqrt(const Dual<N> &x) {
+  const double s = std::sqrt(x.a);
+  return Dual<N>(s, x.v / (2 * s));
+}
+template <int N>
+Dual<N> pow(const Dual<N> &x, double c) {
+  return Dual<N>(std::pow(x.a, c), c * std::pow(x.a, c - 1) * x.v);
+}
+template <int N>
+Dual<N> sin(const Dual<N> &x) {
+  return Dual<N>(std::sin(x.a), std::cos(x.a) * x.v);
+}
+template <int N>
+Dual<N> cos(const Dual<N> &x) {
+  return Dual<N>(std::cos(x.a), -std::sin(x.a) * x.v);
+}
+template <int N>
+Dual<N> tanh(const Dual<N> &x) {
+  const double t = std::tanh(x.a);
+  return Dual<N>(t, (1 - t * t) * x.v);
+}
+
+/**
+ * AutoDiffFactor is an N-way factor on scalar variables with an M-dimensional
+ * error given by a residual functor, whose Jacobians are computed by
+ * forward-mode automatic differentiation with fixed-size dual numbers. The
+ * functor is templated on the scalar type, which is double to evaluate the
+ * error and Dual<N> to evaluate it with its derivatives:
+ *
+ *   struct Residual {
+ *     template <typename T>
+ *     std::array<T, M> operator()(const std::array<T, N> &x) const;
+ *   };
+ *
+ * so that new models, e.g. of actuators, need no hand derivation.
+ */
+template <class FUNCTOR, int M, int N>
+class AutoDiffFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = AutoDiffFactor<FUNCTOR, M, N>;
+  using Base = gtsam::NoiseModelFactor;
+
+  FUNCTOR functor_;
+
+ public:
+  /**
+   * Constructor.
+   * @param keys The N keys of the scalar variables, in functor order.
+   * @param cost_model M-dimensional noise model.
+   * @param functor The residual functor.
+   */
+  AutoDiffFactor(const gtsam::KeyVector &keys,
+                 const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                 const FUNCTOR &functor = FUNCTOR())
+      : Base(cost_model, keys), functor_(functor) {
+    if (keys.size() != N) {
+      throw std::invalid_argument("AutoDiffFactor: expected " +
+                                  std::to_string(N) + " keys.");
+    }
+  }
+
+  virtual ~AutoDiffFactor() {}
+
+  /// The residual functor.
+  const FUNCTOR &functor() const { return functor_; }
+
+  /// Error of the functor, and its derivatives by dual numbers.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    Eigen::Matrix<double, M, 1> error;
+    if (!H) {
+      std::array<double, N> args;
+      for (int j = 0; j < N; j++) args[j] = x.at<double>(keys_[j]);
+      const std::array<double, M> residual = functor_(args);
+      for (int i = 0; i < M; i++) error(i) = residual[i];
+      return error;
+    }
+
+    std::array<Dual<N>, N> args;
+    for (int j = 0; j < N; j++) args[j] = Dual<N>(x.at<double>(keys_[j]), j);
+    const std::array<Dual<N>, M> residual = functor_(args);
+    Eigen::Matrix<double, M, N> jacobian;
+    for (int i = 0; i < M; i++) {
+      error(i) = residual[i].a;
+      jacobian.row(i) = residual[i].v.transpose();
+    }
+    for (int j = 0; j < N; j++) (*H)[j] = jacobian.col(j);
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "AutoDiffFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
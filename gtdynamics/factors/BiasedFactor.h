@@ -2,6 +2,8 @@
 
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
+#include <cmath>
+
 namespace gtsam {
 
 /** A factor that adds a constant bias term to the original factor.
@@ -77,4 +79,89 @@ class BiasedFactor : public NoiseModelFactor {
 
 };  // \class BiasedFactor
 
+/** A penalty factor mu/2 ||diag(1/tolerance) (g(x) + bias)||^2 whose penalty
+ * parameter and bias can be updated in place, so that penalty and augmented
+ * Lagrangian methods can keep the same factors (and graph structure) across
+ * outer iterations. The weights are folded into the error, which is whitened
+ * by a unit noise model. */
+class MutableBiasedFactor : public NoiseModelFactor {
+ protected:
+  typedef NoiseModelFactor Base;
+  typedef MutableBiasedFactor This;
+
+  // factor with error g(x), whose noise sigmas are the tolerance
+  Base::shared_ptr base_factor_;
+  Vector inv_tolerance_;
+  Vector bias_;
+  double sqrt_mu_;
+
+ public:
+  typedef std::shared_ptr<This> shared_ptr;
+
+  /** Default constructor for I/O only */
+  MutableBiasedFactor() {}
+
+  /** Destructor */
+  ~MutableBiasedFactor() override {}
+
+  /**
+   * Constructor
+   * @param base_factor   factor on X with error g(x); its noise sigmas are
+   * used as tolerance.
+   * @param mu  penalty parameter
+   */
+  MutableBiasedFactor(const Base::shared_ptr &base_factor, double mu = 1.0)
+      : Base(noiseModel::Unit::Create(base_factor->dim()), base_factor->keys()),
+        base_factor_(base_factor),
+        inv_tolerance_(base_factor->noiseModel()->sigmas().cwiseInverse()),
+        bias_(Vector::Zero(base_factor->dim())),
+        sqrt_mu_(std::sqrt(mu)) {}
+
+  /// Set the penalty parameter.
+  void setMu(double mu) { sqrt_mu_ = std::sqrt(mu); }
+
+  /// Set the bias term.
+  void setBias(const Vector &bias) { bias_ = bias; }
+
+  /// Return the penalty parameter.
+  double mu() const { return sqrt_mu_ * sqrt_mu_; }
+
+  /// Return the bias term.
+  const Vector &bias() const { return bias_; }
+
+  /** Error sqrt(mu) diag(1/tolerance) (g(x) + bias), and its Jacobians. */
+  Vector unwhitenedError(
+      const Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const Vector scale = sqrt_mu_ * inv_tolerance_;
+    const Vector error = base_factor_->unwhitenedError(x, H) + bias_;
+    if (H) {
+      for (auto &&Hj : *H) Hj = scale.asDiagonal() * Hj;
+    }
+    return scale.cwiseProduct(error);
+  }
+
+  /** Return a deep copy of this factor. */
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+ private:
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &boost::serialization::make_nvp(
+        "MutableBiasedFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(base_factor_);
+    ar &BOOST_SERIALIZATION_NVP(inv_tolerance_);
+    ar &BOOST_SERIALIZATION_NVP(bias_);
+    ar &BOOST_SERIALIZATION_NVP(sqrt_mu_);
+  }
+#endif
+
+};  // \class MutableBiasedFactor
+
 }  // namespace gtsam
@@ -206,6 +206,112 @@ class TrapezoidalPoseCollocationFactor
 #endif
 };
 
+/**
+ * HermiteSimpsonPoseCollocationFactor is a seven-way nonlinear factor between
+ * link pose of current and next time steps. It uses the compressed
+ * Hermite-Simpson rule, where the twist at the midpoint of the step is
+ * interpolated with a cubic Hermite spline from the twists and accelerations
+ * of both steps, so that the predicted twist * dt is
+ * dt / 2 (twist_t0 + twist_t1) + dt^2 / 12 (accel_t0 - accel_t1).
+ */
+class HermiteSimpsonPoseCollocationFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Pose3,
+                                      gtsam::Vector6, gtsam::Vector6,
+                                      gtsam::Vector6, gtsam::Vector6, double> {
+ private:
+  using This = HermiteSimpsonPoseCollocationFactor;
+  using Base =
+      gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Pose3, gtsam::Vector6,
+                               gtsam::Vector6, gtsam::Vector6, gtsam::Vector6,
+                               double>;
+
+ public:
+  HermiteSimpsonPoseCollocationFactor(
+      gtsam::Key pose_t0_key, gtsam::Key pose_t1_key, gtsam::Key twist_t0_key,
+      gtsam::Key twist_t1_key, gtsam::Key accel_t0_key,
+      gtsam::Key accel_t1_key, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, pose_t0_key, pose_t1_key, twist_t0_key, twist_t1_key,
+             accel_t0_key, accel_t1_key, dt_key) {}
+
+  virtual ~HermiteSimpsonPoseCollocationFactor() {}
+
+  /**
+   * Evaluate link pose errors
+
+   * @param pose_t0 link pose of current step
+   * @param pose_t1 link pose of next step
+   * @param twist_t0 link twist of current step
+   * @param twist_t1 link twist of next step
+   * @param accel_t0 link twist acceleration of current step
+   * @param accel_t1 link twist acceleration of next step
+   * @param dt duration of time step
+  */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose_t0, const gtsam::Pose3 &pose_t1,
+      const gtsam::Vector6 &twist_t0, const gtsam::Vector6 &twist_t1,
+      const gtsam::Vector6 &accel_t0, const gtsam::Vector6 &accel_t1,
+      const double &dt, gtsam::OptionalMatrixType H_pose_t0 = nullptr,
+      gtsam::OptionalMatrixType H_pose_t1 = nullptr,
+      gtsam::OptionalMatrixType H_twist_t0 = nullptr,
+      gtsam::OptionalMatrixType H_twist_t1 = nullptr,
+      gtsam::OptionalMatrixType H_accel_t0 = nullptr,
+      gtsam::OptionalMatrixType H_accel_t1 = nullptr,
+      gtsam::OptionalMatrixType H_dt = nullptr) const override {
+    const double dt2_12 = dt * dt / 12;
+    gtsam::Vector6 twistdt =
+        0.5 * dt * (twist_t0 + twist_t1) + dt2_12 * (accel_t0 - accel_t1);
+    gtsam::Matrix6 H_twistdt;
+    auto pose_t1_hat = predictPose(pose_t0, twistdt, H_pose_t0, H_twistdt);
+    gtsam::Vector6 error = pose_t1.logmap(pose_t1_hat);
+    if (H_pose_t1) {
+      *H_pose_t1 = -gtsam::I_6x6;
+    }
+    if (H_twist_t0) {
+      *H_twist_t0 = 0.5 * dt * H_twistdt;
+    }
+    if (H_twist_t1) {
+      *H_twist_t1 = 0.5 * dt * H_twistdt;
+    }
+    if (H_accel_t0) {
+      *H_accel_t0 = dt2_12 * H_twistdt;
+    }
+    if (H_accel_t1) {
+      *H_accel_t1 = -dt2_12 * H_twistdt;
+    }
+    if (H_dt) {
+      *H_dt = H_twistdt * (0.5 * (twist_t0 + twist_t1) +
+                           dt / 6 * (accel_t0 - accel_t1));
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "hermite-simpson collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactorN", boost::serialization::base_object<Base>(*this));
+  }
+#endif
+};
+
 /**
  * FixTimeTrapezoidalPoseCollocationFactor imposes collocation between link
  * poses of current and next time steps with fixed dt.
@@ -56,9 +56,11 @@ void ConstVarFactor::setFixedValues(const Values& values) {
 /* ************************************************************************* */
 Vector ConstVarFactor::unwhitenedError(const Values& x,
                                        gtsam::OptionalMatrixVecType H) const {
-  // Construct values for base factor.
-  Values base_x = x;
-  base_x.insert(fixed_values_);
+  // Construct values for base factor, from its own variables only.
+  Values base_x = fixed_values_;
+  for (const Key& key : keys()) {
+    base_x.insert(key, x.at(key));
+  }
 
   // compute jacobian
   if (H) {
@@ -90,6 +90,8 @@ class ConstVarFactor : public NoiseModelFactor {
 
 typedef std::vector<std::shared_ptr<ConstVarFactor>> ConstVarFactors;
 
+/// Wrap the factors on fixed keys in ConstVarFactors. To only keep variables
+/// fixed during an optimization, MutableLMParams::fixed avoids the rewrite.
 std::pair<NonlinearFactorGraph, ConstVarFactors> ConstVarGraph(
     const NonlinearFactorGraph& graph, const KeySet& fixed_keys);
 
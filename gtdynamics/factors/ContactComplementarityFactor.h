@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactComplementarityFactor.h
+ * @brief Complementarity between the height of a contact point and its normal
+ * contact force, for contact-implicit trajectory optimization.
+ * @author Alejandro Escontrela
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * ContactComplementarityFactor is a two-way nonlinear factor between a link
+ * CoM pose and a contact wrench, which lets the optimizer decide whether the
+ * contact point touches the ground, instead of the contact schedule. With h
+ * the height of the contact point above the flat ground and f_n the normal
+ * contact force, it has the three error rows
+ *
+ *   max(0, -h),              the point does not penetrate the ground,
+ *   max(0, -f_n),            the ground only pushes,
+ *   max(0, h f_n - epsilon), the force is zero unless the point touches,
+ *
+ * where epsilon >= 0 relaxes the complementarity; it is typically decreased
+ * over a sequence of optimizations, see
+ * DynamicsGraph::optimizeContactImplicit.
+ */
+class ContactComplementarityFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Vector6> {
+ private:
+  using This = ContactComplementarityFactor;
+  using Base = gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Vector6>;
+
+  gtsam::Point3 comPc_;         // contact point in the link CoM frame.
+  int up_axis_;                 // which axis is up (assuming flat ground)?
+  double up_sign_;              // +1 if up is along +up_axis_, else -1.
+  double ground_plane_height_;  // height of the ground plane.
+  double epsilon_;              // complementarity relaxation.
+
+ public:
+  /**
+   * Constructor.
+   * @param pose_key The key of the link's CoM pose.
+   * @param contact_wrench_key The key of the contact wrench, in the CoM frame.
+   * @param cost_model 3D noise model.
+   * @param comPc The contact point in the link CoM frame.
+   * @param gravity Gravity vector in the spatial frame, to find "up".
+   * @param epsilon Relaxation of the complementarity.
+   * @param ground_plane_height Height of the ground plane in the world frame.
+   */
+  ContactComplementarityFactor(
+      gtsam::Key pose_key, gtsam::Key contact_wrench_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const gtsam::Point3 &comPc, const gtsam::Vector3 &gravity,
+      double epsilon = 0.0, double ground_plane_height = 0.0)
+      : Base(cost_model, pose_key, contact_wrench_key),
+        comPc_(comPc),
+        ground_plane_height_(ground_plane_height),
+        epsilon_(epsilon) {
+    if (gravity[0] != 0)
+      up_axis_ = 0;  // x.
+    else if (gravity[1] != 0)
+      up_axis_ = 1;  // y.
+    else
+      up_axis_ = 2;  // z.
+    up_sign_ = gravity[up_axis_] > 0 ? -1 : 1;
+  }
+
+  virtual ~ContactComplementarityFactor() {}
+
+  /// Relaxation of the complementarity.
+  double epsilon() const { return epsilon_; }
+
+  /**
+   * Evaluate the contact complementarity errors.
+   * @param pose The link CoM pose.
+   * @param wrench The contact wrench, in the link CoM frame.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &wrench,
+      gtsam::OptionalMatrixType H_pose = nullptr,
+      gtsam::OptionalMatrixType H_wrench = nullptr) const override {
+    // Height of the contact point, and its derivative w.r.t. the pose.
+    gtsam::Matrix36 H_sPc;
+    const gtsam::Point3 sPc = pose.transformFrom(comPc_, H_sPc);
+    const double h = up_sign_ * (sPc(up_axis_) - ground_plane_height_);
+    const Eigen::Matrix<double, 1, 6> H_h_pose = up_sign_ * H_sPc.row(up_axis_);
+
+    // Normal force, and its derivatives w.r.t. the pose and the force.
+    const gtsam::Vector3 f_c = wrench.tail<3>();
+    const gtsam::Matrix3 R = pose.rotation().matrix();
+    const double f_n = up_sign_ * R.row(up_axis_).dot(f_c);
+    const Eigen::RowVector3d H_f_c = up_sign_ * R.row(up_axis_);
+
+    gtsam::Vector3 error = gtsam::Vector3::Zero();
+    Eigen::Matrix<double, 3, 6> Hp = Eigen::Matrix<double, 3, 6>::Zero(),
+                                Hw = Eigen::Matrix<double, 3, 6>::Zero();
+    Eigen::Matrix<double, 1, 6> H_fn_pose = Eigen::Matrix<double, 1, 6>::Zero();
+    H_fn_pose.leftCols<3>() =
+        H_f_c * gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
+
+    if (h < 0) {
+      error(0) = -h;
+      Hp.row(0) = -H_h_pose;
+    }
+    if (f_n < 0) {
+      error(1) = -f_n;
+      Hp.row(1) = -H_fn_pose;
+      Hw.block<1, 3>(1, 3) = -H_f_c;
+    }
+    if (h > 0 && f_n > 0 && h * f_n > epsilon_) {
+      error(2) = h * f_n - epsilon_;
+      Hp.row(2) = f_n * H_h_pose + h * H_fn_pose;
+      Hw.block<1, 3>(2, 3) = h * H_f_c;
+    }
+
+    if (H_pose) *H_pose = Hp;
+    if (H_wrench) *H_wrench = Hw;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "ContactComplementarityFactor"
+              << " (epsilon = " << epsilon_ << ")" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
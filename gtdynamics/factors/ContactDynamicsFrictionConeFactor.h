@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/HeightMap.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -38,15 +39,6 @@ class ContactDynamicsFrictionConeFactor
 
   int up_axis_;  // Which axis is up (assuming flat ground)? {0: x, 1: y, 2: z}.
   double mu_prime_;  // static friction coefficient squared.
-  const gtsam::Matrix36 H_wrench_ = (gtsam::Matrix(3, 6) << 0, 0, 0, 1, 0, 0, 0,
-                                     0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1)
-                                        .finished();
-  const gtsam::Matrix33 H_x_ =
-      (gtsam::Matrix(3, 3) << 1, 0, 0, 0, 0, 0, 0, 0, 0).finished();
-  const gtsam::Matrix33 H_y_ =
-      (gtsam::Matrix(3, 3) << 0, 0, 0, 0, 1, 0, 0, 0, 0).finished();
-  const gtsam::Matrix33 H_z_ =
-      (gtsam::Matrix(3, 3) << 0, 0, 0, 0, 0, 0, 0, 0, 1).finished();
 
  public:
   /**
@@ -80,60 +72,29 @@ class ContactDynamicsFrictionConeFactor
       const gtsam::Pose3 &pose, const gtsam::Vector6 &contact_wrench,
       gtsam::OptionalMatrixType H_pose = nullptr,
       gtsam::OptionalMatrixType H_contact_wrench = nullptr) const override {
-    // Linear component of the contact wrench.
-    gtsam::Vector3 f_c = H_wrench_ * contact_wrench;
-
-    // Rotate linear contact wrench force into the spatial frame.
-    gtsam::Matrix36 H_p;
-    gtsam::Vector3 f_s = pose.rotation(H_p) * f_c;
-
-    // Compute the squared force values.
-    gtsam::Matrix A = f_s.transpose() * H_x_;
-    gtsam::Matrix B = f_s.transpose() * H_y_;
-    gtsam::Matrix C = f_s.transpose() * H_z_;
-
-    if (up_axis_ == 0)
-      A *= -mu_prime_;
-    else if (up_axis_ == 1)
-      B *= -mu_prime_;
-    else
-      C *= -mu_prime_;
-
-    // a = f_x^2, b = f_z^2, c = f_z^2.
-    gtsam::Matrix a = A * f_s;
-    gtsam::Matrix b = B * f_s;
-    gtsam::Matrix c = C * f_s;
-
-    gtsam::Matrix resultant = a + b + c;
-    gtsam::Vector error;
-
-    // Ramp function.
-    if (resultant(0, 0) > 0)
-      error = resultant;
-    else
-      error = (gtsam::Vector(1) << 0).finished();
-
-    // Compute the gradients based on whether or not the inequality constraint
-    // is active.
-    gtsam::Matrix H_f_s = (2 * A + 2 * B + 2 * C);
+    // Linear component of the contact wrench, rotated into the spatial frame.
+    const gtsam::Vector3 f_c = contact_wrench.tail<3>();
+    const gtsam::Matrix3 R = pose.rotation().matrix();
+    const gtsam::Vector3 f_s = R * f_c;
+
+    // Squared tangential force minus mu^2 times squared normal force.
+    gtsam::Vector3 weights = gtsam::Vector3::Ones();
+    weights(up_axis_) = -mu_prime_;
+    const double resultant = weights.dot(f_s.cwiseProduct(f_s));
+
+    // Ramp function, with zero gradients if the constraint is inactive.
+    const bool active = resultant > 0;
+    gtsam::Vector error = gtsam::Vector1(active ? resultant : 0);
+    const Eigen::RowVector3d H_f_s = 2 * weights.cwiseProduct(f_s).transpose();
     if (H_contact_wrench) {
-      if (resultant(0, 0) > 0) {  // Active.
-        gtsam::Matrix H_f_c = H_f_s * pose.rotation().matrix();
-        *H_contact_wrench = H_f_c * H_wrench_;
-      } else {  // Inactive.
-        *H_contact_wrench =
-            (gtsam::Matrix(1, 6) << 0, 0, 0, 0, 0, 0).finished();
-      }
+      *H_contact_wrench = gtsam::Matrix::Zero(1, 6);
+      if (active) H_contact_wrench->rightCols<3>() = H_f_s * R;
     }
-
     if (H_pose) {
-      if (resultant(0, 0) > 0) {  // Active.
-        gtsam::Matrix33 H_r = pose.rotation().matrix() *
-                              gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
-        gtsam::Matrix H_rot = gtsam::Matrix(H_f_s * H_r);
-        *H_pose = H_rot * H_p;
-      } else {  // Inactive.
-        *H_pose = (gtsam::Matrix(1, 6) << 0, 0, 0, 0, 0, 0).finished();
+      *H_pose = gtsam::Matrix::Zero(1, 6);
+      if (active) {
+        H_pose->leftCols<3>() =
+            H_f_s * R * gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
       }
     }
 
@@ -166,4 +127,105 @@ class ContactDynamicsFrictionConeFactor
 #endif
 };
 
+/**
+ * TerrainFrictionConeFactor enforces that the linear contact force lies
+ * within the friction cone about the terrain normal at the contact point,
+ * the uneven counterpart of ContactDynamicsFrictionConeFactor.
+ */
+class TerrainFrictionConeFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6> {
+ private:
+  using This = TerrainFrictionConeFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6>;
+
+  gtsam::Point3 comPc_;             // contact point in the link CoM frame
+  HeightMapConstSharedPtr terrain_;
+  double mu_prime_;                 // static friction coefficient squared
+
+ public:
+  /**
+   * Friction cone factor about the terrain normal.
+   *
+   * @param pose_key Key corresponding to the link's CoM pose.
+   * @param contact_wrench_key Key corresponding to this link's contact wrench.
+   * @param cost_model Noise model for this factor.
+   * @param mu Static friction coefficient.
+   * @param comPc Contact point in the link CoM frame.
+   * @param terrain Height map of the terrain, in a z-up world frame.
+   */
+  TerrainFrictionConeFactor(
+      gtsam::Key pose_key, gtsam::Key contact_wrench_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model, double mu,
+      const gtsam::Point3 &comPc, const HeightMapConstSharedPtr &terrain)
+      : Base(cost_model, pose_key, contact_wrench_key),
+        comPc_(comPc),
+        terrain_(terrain),
+        mu_prime_(mu * mu) {}
+
+  virtual ~TerrainFrictionConeFactor() {}
+
+  /**
+   * Evaluate the friction cone error, |f|^2 - (1 + mu^2) (n.f)^2 for the
+   * force f and normal n in the spatial frame, if positive.
+   * @param pose Pose of the link CoM.
+   * @param contact_wrench Contact wrench on this link.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &contact_wrench,
+      gtsam::OptionalMatrixType H_pose = nullptr,
+      gtsam::OptionalMatrixType H_contact_wrench = nullptr) const override {
+    const gtsam::Vector3 f_c = contact_wrench.tail<3>();
+    const gtsam::Matrix3 R = pose.rotation().matrix();
+    const gtsam::Vector3 f_s = R * f_c;
+
+    // Terrain normal below the contact point.
+    gtsam::Matrix36 p_H_pose;
+    gtsam::Matrix32 n_H_xy;
+    const gtsam::Point3 p =
+        pose.transformFrom(comPc_, H_pose ? &p_H_pose : nullptr);
+    const gtsam::Vector3 n =
+        terrain_->normal(p.x(), p.y(), H_pose ? &n_H_xy : nullptr);
+
+    const double normal = n.dot(f_s);
+    const double resultant =
+        f_s.squaredNorm() - (1 + mu_prime_) * normal * normal;
+
+    // Ramp function, with zero gradients if the constraint is inactive.
+    const bool active = resultant > 0;
+    gtsam::Vector error = gtsam::Vector1(active ? resultant : 0);
+    const Eigen::RowVector3d H_f_s =
+        2 * (f_s - (1 + mu_prime_) * normal * n).transpose();
+    if (H_contact_wrench) {
+      *H_contact_wrench = gtsam::Matrix::Zero(1, 6);
+      if (active) H_contact_wrench->rightCols<3>() = H_f_s * R;
+    }
+    if (H_pose) {
+      *H_pose = gtsam::Matrix::Zero(1, 6);
+      if (active) {
+        const Eigen::RowVector3d H_n =
+            -2 * (1 + mu_prime_) * normal * f_s.transpose();
+        H_pose->leftCols<3>() =
+            H_f_s * R * gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
+        *H_pose += H_n * n_H_xy * p_H_pose.topRows<2>();
+      }
+    }
+
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Terrain Friction Cone Factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
 }  // namespace gtdynamics
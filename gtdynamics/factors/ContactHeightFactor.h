@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/HeightMap.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -20,6 +21,7 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/slam/expressions.h>
 
+#include <iostream>
 #include <string>
 
 namespace gtdynamics {
@@ -40,6 +42,26 @@ inline gtsam::Double_ ContactHeightConstraint(
   return error;
 }
 
+/**
+ * TerrainHeightConstraint is a constraint which enforces that the contact
+ * point lies on the terrain of a height map, in a z-up world: its error is
+ * the height of the point above the terrain.
+ */
+inline gtsam::Double_ TerrainHeightConstraint(
+    gtsam::Key pose_key, const gtsam::Point3 &comPc,
+    const HeightMapConstSharedPtr &terrain) {
+  gtsam::Pose3_ sTl(pose_key);
+  gtsam::Point3_ sPc = gtsam::transformFrom(sTl, gtsam::Point3_(comPc));
+  return gtsam::Double_(
+      [terrain](const gtsam::Point3 &p, gtsam::OptionalJacobian<1, 3> H_p) {
+        gtsam::Matrix12 H_xy;
+        const double h = terrain->height(p.x(), p.y(), H_p ? &H_xy : nullptr);
+        if (H_p) *H_p << -H_xy(0), -H_xy(1), 1.0;
+        return p.z() - h;
+      },
+      sPc);
+}
+
 /**
  * ContactHeightFactor is a one-way nonlinear factor which enforces a
  * known ground plane height for the contact point. This factor assumes that the
@@ -99,4 +121,48 @@ class ContactHeightFactor : public gtsam::ExpressionFactor<double> {
 #endif
 };
 
+/**
+ * TerrainHeightFactor is a one-way nonlinear factor which enforces that the
+ * contact point lies on mapped terrain, the uneven counterpart of
+ * ContactHeightFactor.
+ */
+class TerrainHeightFactor : public gtsam::ExpressionFactor<double> {
+ private:
+  using This = TerrainHeightFactor;
+  using Base = gtsam::ExpressionFactor<double>;
+
+ public:
+  /**
+   * Factor for link end to remain in contact with the terrain.
+   *
+   * @param pose_key The key corresponding to the link's CoM pose.
+   * @param cost_model Noise model associated with this factor.
+   * @param comPc Static transform from point of contact to link CoM.
+   * @param terrain Height map of the terrain, in a z-up world frame.
+   */
+  TerrainHeightFactor(gtsam::Key pose_key,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const gtsam::Point3 &comPc,
+                      const HeightMapConstSharedPtr &terrain)
+      : Base(cost_model, 0.0,
+             TerrainHeightConstraint(pose_key, comPc, terrain)) {}
+
+  virtual ~TerrainHeightFactor() {}
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "TerrainHeightFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
 }  // namespace gtdynamics
@@ -37,8 +37,9 @@ class ContactPointFactor
   using This = ContactPointFactor;
   using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Point3>;
 
-  // The contact point in the link's CoM frame.
+  // The contact point in the link's CoM frame, and its skew-symmetric matrix.
   gtsam::Point3 contact_in_com_;
+  gtsam::Matrix3 contact_in_com_skew_;
 
  public:
   /**
@@ -53,7 +54,8 @@ class ContactPointFactor
                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
                      const gtsam::Point3 &contact_in_com)
       : Base(cost_model, link_pose_key, point_key),
-        contact_in_com_(contact_in_com) {}
+        contact_in_com_(contact_in_com),
+        contact_in_com_skew_(gtsam::skewSymmetric(contact_in_com)) {}
 
   /**
    * Convenience constructor which uses PointOnLink.
@@ -81,10 +83,16 @@ class ContactPointFactor
       const gtsam::Pose3 &wTl, const gtsam::Point3 &wPc,
       gtsam::OptionalMatrixType H_pose = nullptr,
       gtsam::OptionalMatrixType H_point = nullptr) const override {
-    gtsam::Vector error = wPc - wTl.transformFrom(contact_in_com_, H_pose);
-    if (H_pose) *H_pose = -gtsam::Matrix3::Identity() * (*H_pose);
-    if (H_point) *H_point = gtsam::Matrix3::Identity();
-    return error;
+    // The Jacobian of wPc - (R p + t) is [R [p]x, -R], so write it directly
+    // instead of negating the dense Jacobian of Pose3::transformFrom.
+    const gtsam::Matrix3 R = wTl.rotation().matrix();
+    if (H_pose) {
+      gtsam::Matrix36 H;
+      H << R * contact_in_com_skew_, -R;
+      *H_pose = H;
+    }
+    if (H_point) *H_point = gtsam::I_3x3;
+    return wPc - (R * contact_in_com_ + wTl.translation());
   }
 
   //// @return a deep copy of this factor
@@ -127,8 +135,10 @@ class ContactPoseFactor
   using This = ContactPoseFactor;
   using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3>;
 
-  // The contact point reference frame in the link's CoM frame.
+  // The contact point reference frame in the link's CoM frame, and the
+  // adjoint of its inverse, which is the Jacobian of wTl * comTcontact.
   gtsam::Pose3 comTcontact_;
+  gtsam::Matrix6 contactAdcom_;
 
  public:
   /**
@@ -144,7 +154,8 @@ class ContactPoseFactor
                     const gtsam::noiseModel::Base::shared_ptr &cost_model,
                     const gtsam::Pose3 &comTcontact)
       : Base(cost_model, link_pose_key, contact_pose_key),
-        comTcontact_(comTcontact) {}
+        comTcontact_(comTcontact),
+        contactAdcom_(comTcontact.inverse().AdjointMap()) {}
 
   /**
    * Convenience constructor which uses PointOnLink.
@@ -177,11 +188,11 @@ class ContactPoseFactor
       const gtsam::Pose3 &wTl, const gtsam::Pose3 &wTcontact,
       gtsam::OptionalMatrixType H_link = nullptr,
       gtsam::OptionalMatrixType H_contact = nullptr) const override {
-    gtsam::Pose3 measured_wTcontact = wTl.compose(comTcontact_, H_link);
+    const gtsam::Pose3 measured_wTcontact = wTl * comTcontact_;
     gtsam::Matrix6 H1, H2;
-    gtsam::Vector error =
-        measured_wTcontact.localCoordinates(wTcontact, H1, H2);
-    if (H_link) *H_link = H1 * (*H_link);
+    const gtsam::Vector6 error = measured_wTcontact.localCoordinates(
+        wTcontact, H_link ? &H1 : nullptr, H_contact ? &H2 : nullptr);
+    if (H_link) *H_link = H1 * contactAdcom_;
     if (H_contact) *H_contact = H2;
     return error;
   }
@@ -221,6 +232,7 @@ class FixedContactPointFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
   // The contact point in the link's CoM frame.
   gtsam::Point3 contact_in_world_;
   gtsam::Point3 contact_in_com_;
+  gtsam::Matrix3 contact_in_com_skew_;
 
  public:
   /**
@@ -237,7 +249,8 @@ class FixedContactPointFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
                           const gtsam::Point3 &contact_in_com)
       : Base(cost_model, link_pose_key),
         contact_in_world_(contact_in_world),
-        contact_in_com_(contact_in_com) {}
+        contact_in_com_(contact_in_com),
+        contact_in_com_skew_(gtsam::skewSymmetric(contact_in_com)) {}
 
   virtual ~FixedContactPointFactor() {}
 
@@ -249,10 +262,14 @@ class FixedContactPointFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
   gtsam::Vector evaluateError(
       const gtsam::Pose3 &wTl,
       gtsam::OptionalMatrixType H_pose = nullptr) const override {
-    gtsam::Vector error =
-        contact_in_world_ - wTl.transformFrom(contact_in_com_, H_pose);
-    if (H_pose) *H_pose = -gtsam::Matrix3::Identity() * (*H_pose);
-    return error;
+    // Same Jacobian as in ContactPointFactor.
+    const gtsam::Matrix3 R = wTl.rotation().matrix();
+    if (H_pose) {
+      gtsam::Matrix36 H;
+      H << R * contact_in_com_skew_, -R;
+      *H_pose = H;
+    }
+    return contact_in_world_ - (R * contact_in_com_ + wTl.translation());
   }
 
   //// @return a deep copy of this factor
@@ -86,6 +86,20 @@ class ForwardKinematicsFactor : public gtsam::BetweenFactor<gtsam::Pose3> {
                                  joint_angles, k),
              model) {}
 
+  /**
+   * Construct from a relative pose already computed by forward kinematics,
+   * e.g. by the fast Robot::forwardKinematics at encoder rate.
+   *
+   * @param bTl1_key        Key for pose of start link in the kinematic chain.
+   * @param bTl2_key        Key for pose of end link in the kinematic chain.
+   * @param l1Tl2           Pose of the end link in the start link's frame.
+   * @param model           The noise model for this factor.
+   */
+  ForwardKinematicsFactor(gtsam::Key bTl1_key, gtsam::Key bTl2_key,
+                          const gtsam::Pose3 &l1Tl2,
+                          const gtsam::SharedNoiseModel &model)
+      : Base(bTl1_key, bTl2_key, l1Tl2, model) {}
+
   virtual ~ForwardKinematicsFactor() {}
 
   /**
@@ -0,0 +1,184 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FrictionConesFactor.h
+ * @brief Factor to enforce that the forces of several contacts lie within
+ * their friction cones.
+ * @author Alejandro Escontrela
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FrictionConesFactor enforces that the linear forces of several contacts,
+ * e.g. all contacts of a time step, lie within their friction cones. It has
+ * the keys of the link CoM pose and contact wrench of each contact, and
+ * evaluates all cones in one pass.
+ *
+ * With the quadratic cone, each contact has one error row, the same as
+ * ContactDynamicsFrictionConeFactor. With the pyramid approximation, each
+ * contact has four rows, +-f_t - mu f_n for both tangential axes, which are
+ * linear in the spatial contact force. All rows are ramped, i.e., zero when
+ * the constraint is satisfied.
+ */
+class FrictionConesFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = FrictionConesFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  int up_axis_;     // Which axis is up (assuming flat ground)?
+  double up_sign_;  // +1 if the normal force is along +up_axis_, else -1.
+  double mu_;       // static friction coefficient.
+  bool pyramid_;    // Use the pyramid approximation of the cone.
+
+  static gtsam::KeyVector Keys(
+      const std::vector<std::pair<gtsam::Key, gtsam::Key>> &contact_keys) {
+    gtsam::KeyVector keys;
+    for (auto &&[pose_key, wrench_key] : contact_keys) {
+      keys.push_back(pose_key);
+      keys.push_back(wrench_key);
+    }
+    return keys;
+  }
+
+  /// Noise model of all rows, from the noise model of one row.
+  static gtsam::SharedNoiseModel StackedModel(
+      const gtsam::noiseModel::Base::shared_ptr &row_model, size_t rows) {
+    auto diagonal =
+        std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(row_model);
+    if (!diagonal || diagonal->dim() != 1) {
+      throw std::invalid_argument(
+          "FrictionConesFactor: the row noise model must be 1D and diagonal.");
+    }
+    return gtsam::noiseModel::Isotropic::Sigma(rows, diagonal->sigma(0));
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param contact_keys Pose and contact wrench keys of each contact.
+   * @param row_model 1D diagonal noise model of each error row.
+   * @param mu Static friction coefficient.
+   * @param gravity Gravity, pointing against the normal of the ground.
+   * @param pyramid Use the linear pyramid approximation of the cone.
+   */
+  FrictionConesFactor(
+      const std::vector<std::pair<gtsam::Key, gtsam::Key>> &contact_keys,
+      const gtsam::noiseModel::Base::shared_ptr &row_model, double mu,
+      const gtsam::Vector3 &gravity, bool pyramid = false)
+      : Base(StackedModel(row_model,
+                          contact_keys.size() * (pyramid ? 4 : 1)),
+             Keys(contact_keys)),
+        mu_(mu),
+        pyramid_(pyramid) {
+    if (gravity[0] != 0)
+      up_axis_ = 0;  // x.
+    else if (gravity[1] != 0)
+      up_axis_ = 1;  // y.
+    else
+      up_axis_ = 2;  // z.
+    up_sign_ = gravity[up_axis_] > 0 ? -1 : 1;
+  }
+
+  virtual ~FrictionConesFactor() {}
+
+  /// Number of contacts.
+  size_t numContacts() const { return size() / 2; }
+
+  /// Number of error rows of each contact.
+  size_t rowsPerContact() const { return pyramid_ ? 4 : 1; }
+
+  /// Ramped friction cone errors of all contacts.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const size_t rows = rowsPerContact();
+    gtsam::Vector error = gtsam::Vector::Zero(dim());
+    if (H) {
+      for (auto &&H_key : *H) H_key = gtsam::Matrix::Zero(dim(), 6);
+    }
+
+    // The tangential axes, for the pyramid.
+    const int t1 = (up_axis_ + 1) % 3, t2 = (up_axis_ + 2) % 3;
+
+    for (size_t i = 0; i < numContacts(); i++) {
+      const gtsam::Pose3 &pose = x.at<gtsam::Pose3>(keys_[2 * i]);
+      const gtsam::Vector6 &wrench = x.at<gtsam::Vector6>(keys_[2 * i + 1]);
+      const gtsam::Vector3 f_c = wrench.tail<3>();
+      const gtsam::Matrix3 R = pose.rotation().matrix();
+      const gtsam::Vector3 f_s = R * f_c;
+
+      // Gradient of each row w.r.t. the spatial force.
+      Eigen::Matrix<double, 4, 3> G;
+      Eigen::Vector4d r;
+      if (pyramid_) {
+        G.setZero();
+        gtsam::Vector3 normal = gtsam::Vector3::Zero();
+        normal(up_axis_) = -mu_ * up_sign_;
+        G.row(0) = normal.transpose();
+        G.row(1) = normal.transpose();
+        G.row(2) = normal.transpose();
+        G.row(3) = normal.transpose();
+        G(0, t1) += 1;
+        G(1, t1) -= 1;
+        G(2, t2) += 1;
+        G(3, t2) -= 1;
+        r = G * f_s;
+      } else {
+        gtsam::Vector3 weights = gtsam::Vector3::Ones();
+        weights(up_axis_) = -mu_ * mu_;
+        r(0) = weights.dot(f_s.cwiseProduct(f_s));
+        G.row(0) = 2 * weights.cwiseProduct(f_s).transpose();
+      }
+
+      const size_t row_offset = i * rows;
+      for (size_t k = 0; k < rows; k++) {
+        if (r(k) <= 0) continue;  // Inactive.
+        error(row_offset + k) = r(k);
+        if (H) {
+          const Eigen::RowVector3d H_f_c = G.row(k) * R;
+          (*H)[2 * i].block<1, 3>(row_offset + k, 0) =
+              H_f_c * gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
+          (*H)[2 * i + 1].block<1, 3>(row_offset + k, 3) = H_f_c;
+        }
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Friction Cones Factor" << (pyramid_ ? " (pyramid)" : "")
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,466 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointFactors.h
+ * @brief Joint factors with closed-form Jacobians.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/RobotParameters.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * The factors in this file have the same keys and errors as the expression
+ * factors PoseFactor, TwistFactor, TwistAccelFactor, WrenchEquivalenceFactor
+ * and TorqueFactor, built from the Joint constraint expressions. They chain
+ * fixed-size Jacobians by hand instead of recording an expression trace, which
+ * makes linearization cheaper. DynamicsGraph uses them when
+ * OptimizerSetting::closed_form_jacobians is set.
+ *
+ * Each factor is built either with a joint, or with a RobotParameters block
+ * and a joint id, in which case it uses the joint of the block at every
+ * evaluation, so the joint can be replaced without rebuilding the graph.
+ */
+
+/**
+ * JointPoseFactor relates the CoM poses of the parent and child links of a
+ * joint and its angle: error = Logmap(wTc^-1 * wTp * pTc(q)).
+ */
+class JointPoseFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Pose3, double> {
+ private:
+  using This = JointPoseFactor;
+  using Base = gtsam::NoiseModelFactorN<gtsam::Pose3, gtsam::Pose3, double>;
+
+  internal::FactorJoint joint_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two poses.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointPoseFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                  const internal::FactorJoint &joint, int time)
+      : Base(cost_model, PoseKey(joint->parent()->id(), time),
+             PoseKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time)),
+        joint_(joint) {}
+
+  /**
+   * Constructor with the joint of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param j The id of the joint.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointPoseFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                  const RobotParametersConstSharedPtr &parameters, int j,
+                  int time)
+      : JointPoseFactor(cost_model, internal::FactorJoint(parameters, j),
+                        time) {}
+
+  virtual ~JointPoseFactor() {}
+
+  /**
+   * Evaluate error.
+   * @param wTp The parent link's CoM pose.
+   * @param wTc The child link's CoM pose.
+   * @param q The joint angle.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTp, const gtsam::Pose3 &wTc, const double &q,
+      gtsam::OptionalMatrixType H_wTp = nullptr,
+      gtsam::OptionalMatrixType H_wTc = nullptr,
+      gtsam::OptionalMatrixType H_q = nullptr) const override {
+    const bool H_hat = H_wTp || H_q;
+    gtsam::Matrix61 pTc_H_q;
+    gtsam::Matrix6 hat_H_wTp, hat_H_pTc, between_H_wTc, between_H_hat, H_log;
+    const gtsam::Pose3 pTc = joint_->parentTchild(q, H_q ? &pTc_H_q : nullptr);
+    const gtsam::Pose3 wTc_hat =
+        wTp.compose(pTc, H_wTp ? &hat_H_wTp : nullptr,
+                    H_q ? &hat_H_pTc : nullptr);
+    const gtsam::Pose3 cTc_hat =
+        wTc.between(wTc_hat, H_wTc ? &between_H_wTc : nullptr,
+                    H_hat ? &between_H_hat : nullptr);
+    const gtsam::Vector6 error = gtsam::Pose3::Logmap(
+        cTc_hat, (H_hat || H_wTc) ? &H_log : nullptr);
+    if (H_wTp) *H_wTp = H_log * between_H_hat * hat_H_wTp;
+    if (H_wTc) *H_wTc = H_log * between_H_wTc;
+    if (H_q) *H_q = H_log * between_H_hat * hat_H_pTc * pTc_H_q;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "JointPoseFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointTwistFactor relates the twists of the parent and child links of a
+ * joint: error = Ad(cTp(q)) Vp + S qdot - Vc.
+ */
+class JointTwistFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6, double,
+                                      double> {
+ private:
+  using This = JointTwistFactor;
+  using Base = gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6,
+                                        double, double>;
+
+  internal::FactorJoint joint_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two links.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointTwistFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                   const internal::FactorJoint &joint, int time)
+      : Base(cost_model, TwistKey(joint->parent()->id(), time),
+             TwistKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  /**
+   * Constructor with the joint of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param j The id of the joint.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointTwistFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                   const RobotParametersConstSharedPtr &parameters, int j,
+                   int time)
+      : JointTwistFactor(cost_model, internal::FactorJoint(parameters, j),
+                         time) {}
+
+  virtual ~JointTwistFactor() {}
+
+  /**
+   * Evaluate error.
+   * @param twist_p The parent link's twist.
+   * @param twist_c The child link's twist.
+   * @param q The joint angle.
+   * @param q_dot The joint velocity.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_p, const gtsam::Vector6 &twist_c,
+      const double &q, const double &q_dot,
+      gtsam::OptionalMatrixType H_twist_p = nullptr,
+      gtsam::OptionalMatrixType H_twist_c = nullptr,
+      gtsam::OptionalMatrixType H_q = nullptr,
+      gtsam::OptionalMatrixType H_q_dot = nullptr) const override {
+    gtsam::Matrix61 twist_H_q, twist_H_q_dot;
+    gtsam::Matrix6 twist_H_twist_p;
+    const gtsam::Vector6 twist_c_hat = joint_->transformTwistTo(
+        joint_->child(), q, q_dot, twist_p, H_q ? &twist_H_q : nullptr,
+        H_q_dot ? &twist_H_q_dot : nullptr,
+        H_twist_p ? &twist_H_twist_p : nullptr);
+    if (H_twist_p) *H_twist_p = twist_H_twist_p;
+    if (H_twist_c) *H_twist_c = -gtsam::I_6x6;
+    if (H_q) *H_q = twist_H_q;
+    if (H_q_dot) *H_q_dot = twist_H_q_dot;
+    return twist_c_hat - twist_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "JointTwistFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointTwistAccelFactor relates the twist accelerations of the parent and
+ * child links of a joint:
+ * error = Ad(cTp(q)) Ap + ad(Vc) S qdot + S qddot - Ac.
+ */
+class JointTwistAccelFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6,
+                                      gtsam::Vector6, double, double, double> {
+ private:
+  using This = JointTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6,
+                                        gtsam::Vector6, double, double, double>;
+
+  internal::FactorJoint joint_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two links.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointTwistAccelFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                        const internal::FactorJoint &joint, int time)
+      : Base(cost_model, TwistKey(joint->child()->id(), time),
+             TwistAccelKey(joint->parent()->id(), time),
+             TwistAccelKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time),
+             JointAccelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  /**
+   * Constructor with the joint of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param j The id of the joint.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointTwistAccelFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                        const RobotParametersConstSharedPtr &parameters, int j,
+                        int time)
+      : JointTwistAccelFactor(cost_model, internal::FactorJoint(parameters, j),
+                              time) {}
+
+  virtual ~JointTwistAccelFactor() {}
+
+  /**
+   * Evaluate error.
+   * @param twist_c The child link's twist.
+   * @param accel_p The parent link's twist acceleration.
+   * @param accel_c The child link's twist acceleration.
+   * @param q The joint angle.
+   * @param q_dot The joint velocity.
+   * @param q_ddot The joint acceleration.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_c, const gtsam::Vector6 &accel_p,
+      const gtsam::Vector6 &accel_c, const double &q, const double &q_dot,
+      const double &q_ddot, gtsam::OptionalMatrixType H_twist_c = nullptr,
+      gtsam::OptionalMatrixType H_accel_p = nullptr,
+      gtsam::OptionalMatrixType H_accel_c = nullptr,
+      gtsam::OptionalMatrixType H_q = nullptr,
+      gtsam::OptionalMatrixType H_q_dot = nullptr,
+      gtsam::OptionalMatrixType H_q_ddot = nullptr) const override {
+    const gtsam::Vector6 S = joint_->cScrewAxis();
+    gtsam::Matrix61 cTp_H_q;
+    gtsam::Matrix6 accel_H_cTp, accel_H_accel_p, ad_H_twist_c;
+    const gtsam::Pose3 cTp =
+        joint_->relativePoseOf(joint_->parent(), q, H_q ? &cTp_H_q : nullptr);
+    const gtsam::Vector6 accel_c_hat =
+        cTp.Adjoint(accel_p, H_q ? &accel_H_cTp : nullptr,
+                    H_accel_p ? &accel_H_accel_p : nullptr) +
+        gtsam::Pose3::adjoint(twist_c, S * q_dot,
+                              H_twist_c ? &ad_H_twist_c : nullptr) +
+        S * q_ddot;
+    if (H_twist_c) *H_twist_c = ad_H_twist_c;
+    if (H_accel_p) *H_accel_p = accel_H_accel_p;
+    if (H_accel_c) *H_accel_c = -gtsam::I_6x6;
+    if (H_q) *H_q = accel_H_cTp * cTp_H_q;
+    if (H_q_dot) *H_q_dot = gtsam::Pose3::adjointMap(twist_c) * S;
+    if (H_q_ddot) *H_q_ddot = S;
+    return accel_c_hat - accel_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "JointTwistAccelFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointWrenchEquivalenceFactor relates the wrenches a joint exerts on its
+ * parent and child links: error = Fp + Ad(cTp(q))^T Fc.
+ */
+class JointWrenchEquivalenceFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6, double> {
+ private:
+  using This = JointWrenchEquivalenceFactor;
+  using Base =
+      gtsam::NoiseModelFactorN<gtsam::Vector6, gtsam::Vector6, double>;
+
+  internal::FactorJoint joint_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two links.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointWrenchEquivalenceFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const internal::FactorJoint &joint, int time)
+      : Base(cost_model,
+             WrenchKey(joint->parent()->id(), joint->id(), time),
+             WrenchKey(joint->child()->id(), joint->id(), time),
+             JointAngleKey(joint->id(), time)),
+        joint_(joint) {}
+
+  /**
+   * Constructor with the joint of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param j The id of the joint.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointWrenchEquivalenceFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const RobotParametersConstSharedPtr &parameters, int j, int time)
+      : JointWrenchEquivalenceFactor(
+            cost_model, internal::FactorJoint(parameters, j), time) {}
+
+  virtual ~JointWrenchEquivalenceFactor() {}
+
+  /**
+   * Evaluate error.
+   * @param wrench_p The wrench on the parent link.
+   * @param wrench_c The wrench on the child link.
+   * @param q The joint angle.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench_p, const gtsam::Vector6 &wrench_c,
+      const double &q, gtsam::OptionalMatrixType H_wrench_p = nullptr,
+      gtsam::OptionalMatrixType H_wrench_c = nullptr,
+      gtsam::OptionalMatrixType H_q = nullptr) const override {
+    gtsam::Matrix61 wrench_H_q;
+    gtsam::Matrix6 wrench_H_wrench_c;
+    const gtsam::Vector6 wrench_c_hat = joint_->transformWrenchCoordinate(
+        joint_->child(), q, wrench_c, H_q ? &wrench_H_q : nullptr,
+        H_wrench_c ? &wrench_H_wrench_c : nullptr);
+    if (H_wrench_p) *H_wrench_p = gtsam::I_6x6;
+    if (H_wrench_c) *H_wrench_c = wrench_H_wrench_c;
+    if (H_q) *H_q = wrench_H_q;
+    return wrench_p + wrench_c_hat;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "JointWrenchEquivalenceFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointWrenchTorqueFactor relates the wrench a joint exerts on its child link
+ * to the joint torque: error = S^T Fc - tau.
+ */
+class JointWrenchTorqueFactor
+    : public gtsam::NoiseModelFactorN<gtsam::Vector6, double> {
+ private:
+  using This = JointWrenchTorqueFactor;
+  using Base = gtsam::NoiseModelFactorN<gtsam::Vector6, double>;
+
+  internal::FactorJoint joint_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint applying the torque.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointWrenchTorqueFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const internal::FactorJoint &joint, int time)
+      : Base(cost_model, WrenchKey(joint->child()->id(), joint->id(), time),
+             TorqueKey(joint->id(), time)),
+        joint_(joint) {}
+
+  /**
+   * Constructor with the joint of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param j The id of the joint.
+   * @param time The timestep at which this factor is defined.
+   */
+  JointWrenchTorqueFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const RobotParametersConstSharedPtr &parameters, int j, int time)
+      : JointWrenchTorqueFactor(
+            cost_model, internal::FactorJoint(parameters, j), time) {}
+
+  virtual ~JointWrenchTorqueFactor() {}
+
+  /**
+   * Evaluate error.
+   * @param wrench The wrench on the child link.
+   * @param torque The joint torque.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench, const double &torque,
+      gtsam::OptionalMatrixType H_wrench = nullptr,
+      gtsam::OptionalMatrixType H_torque = nullptr) const override {
+    const gtsam::Vector6 &screw_axis = joint_->cScrewAxis();
+    if (H_wrench) *H_wrench = screw_axis.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(screw_axis.dot(wrench) - torque);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "JointWrenchTorqueFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,218 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointsCollocationFactor.h
+ * @brief Collocation factor on the angles and velocities of several joints.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/factors/SecondOrderFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JointsCollocationFactor imposes Euler or trapezoidal collocation on the
+ * angles and velocities of several joints, e.g. all joints of a robot, from
+ * time step t to t+1, with either a fixed dt or the dt of a phase as a
+ * variable. It replaces two double collocation factors per joint with one
+ * factor, which linearizes into a single Jacobian factor.
+ *
+ * Each joint has two error rows, q0 + dt v - q1 and v0 + dt a - v1, where v
+ * and a are v0 and a0 for Euler, and the averages of both steps for
+ * trapezoidal collocation. The keys of joint j are q0, q1, v0, v1, a0, and a1
+ * for trapezoidal collocation, followed by the phase key if dt is a variable.
+ *
+ * With dt as a variable the errors are bilinear, and the factor provides
+ * their exact second derivatives through SecondOrderFactor.
+ */
+class JointsCollocationFactor : public gtsam::NoiseModelFactor,
+                                public SecondOrderFactor {
+ private:
+  using This = JointsCollocationFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  size_t num_joints_;
+  bool trapezoidal_;
+  std::optional<double> dt_;  // fixed dt, or none if the last key is dt.
+
+  size_t keysPerJoint() const { return trapezoidal_ ? 6 : 5; }
+
+  static gtsam::KeyVector Keys(const std::vector<int> &joint_ids, int t,
+                               bool trapezoidal,
+                               const std::optional<gtsam::Key> &phase_key) {
+    gtsam::KeyVector keys;
+    for (int j : joint_ids) {
+      keys.push_back(JointAngleKey(j, t));
+      keys.push_back(JointAngleKey(j, t + 1));
+      keys.push_back(JointVelKey(j, t));
+      keys.push_back(JointVelKey(j, t + 1));
+      keys.push_back(JointAccelKey(j, t));
+      if (trapezoidal) keys.push_back(JointAccelKey(j, t + 1));
+    }
+    if (phase_key) keys.push_back(*phase_key);
+    return keys;
+  }
+
+  /// Noise model of all rows, from the 1D models of angle and velocity rows.
+  static gtsam::SharedNoiseModel StackedModel(
+      size_t num_joints, const gtsam::noiseModel::Base::shared_ptr &q_model,
+      const gtsam::noiseModel::Base::shared_ptr &v_model) {
+    auto q_diagonal =
+        std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(q_model);
+    auto v_diagonal =
+        std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(v_model);
+    if (!q_diagonal || q_diagonal->dim() != 1 || !v_diagonal ||
+        v_diagonal->dim() != 1) {
+      throw std::invalid_argument(
+          "JointsCollocationFactor: the noise models must be 1D and "
+          "diagonal.");
+    }
+    gtsam::Vector sigmas(2 * num_joints);
+    for (size_t i = 0; i < num_joints; i++) {
+      sigmas(2 * i) = q_diagonal->sigma(0);
+      sigmas(2 * i + 1) = v_diagonal->sigma(0);
+    }
+    return gtsam::noiseModel::Diagonal::Sigmas(sigmas);
+  }
+
+ public:
+  /**
+   * Constructor with a fixed dt.
+   * @param joint_ids ids of the joints
+   * @param t index of the first time step
+   * @param dt duration of the time step
+   * @param q_cost_model 1D diagonal noise model of the angle rows
+   * @param v_cost_model 1D diagonal noise model of the velocity rows
+   * @param trapezoidal trapezoidal instead of Euler collocation
+   */
+  JointsCollocationFactor(
+      const std::vector<int> &joint_ids, int t, double dt,
+      const gtsam::noiseModel::Base::shared_ptr &q_cost_model,
+      const gtsam::noiseModel::Base::shared_ptr &v_cost_model,
+      bool trapezoidal)
+      : Base(StackedModel(joint_ids.size(), q_cost_model, v_cost_model),
+             Keys(joint_ids, t, trapezoidal, {})),
+        num_joints_(joint_ids.size()),
+        trapezoidal_(trapezoidal),
+        dt_(dt) {}
+
+  /**
+   * Constructor with dt as a variable, e.g. of a phase.
+   * @param joint_ids ids of the joints
+   * @param t index of the first time step
+   * @param dt_key key of the time step duration
+   * @param q_cost_model 1D diagonal noise model of the angle rows
+   * @param v_cost_model 1D diagonal noise model of the velocity rows
+   * @param trapezoidal trapezoidal instead of Euler collocation
+   */
+  JointsCollocationFactor(
+      const std::vector<int> &joint_ids, int t, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base::shared_ptr &q_cost_model,
+      const gtsam::noiseModel::Base::shared_ptr &v_cost_model,
+      bool trapezoidal)
+      : Base(StackedModel(joint_ids.size(), q_cost_model, v_cost_model),
+             Keys(joint_ids, t, trapezoidal, dt_key)),
+        num_joints_(joint_ids.size()),
+        trapezoidal_(trapezoidal) {}
+
+  virtual ~JointsCollocationFactor() {}
+
+  /// Number of joints.
+  size_t numJoints() const { return num_joints_; }
+
+  /// Collocation errors of all joints.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const size_t n = keysPerJoint();
+    const double dt = dt_ ? *dt_ : x.at<double>(keys_.back());
+    if (H) {
+      for (auto &&H_key : *H) H_key = gtsam::Matrix::Zero(dim(), 1);
+    }
+
+    // Weights of the derivatives of both steps.
+    const double w0 = trapezoidal_ ? 0.5 : 1.0, w1 = trapezoidal_ ? 0.5 : 0.0;
+
+    gtsam::Vector error(dim());
+    for (size_t i = 0; i < num_joints_; i++) {
+      const size_t k = i * n, r = 2 * i;
+      const double q0 = x.at<double>(keys_[k]), q1 = x.at<double>(keys_[k + 1]),
+                   v0 = x.at<double>(keys_[k + 2]),
+                   v1 = x.at<double>(keys_[k + 3]),
+                   a0 = x.at<double>(keys_[k + 4]),
+                   a1 = trapezoidal_ ? x.at<double>(keys_[k + 5]) : 0.0;
+      const double v = w0 * v0 + w1 * v1, a = w0 * a0 + w1 * a1;
+      error(r) = q0 + dt * v - q1;
+      error(r + 1) = v0 + dt * a - v1;
+      if (H) {
+        (*H)[k](r, 0) = 1;
+        (*H)[k + 1](r, 0) = -1;
+        (*H)[k + 2](r, 0) = w0 * dt;
+        (*H)[k + 3](r, 0) = w1 * dt;
+        (*H)[k + 2](r + 1, 0) = 1;
+        (*H)[k + 3](r + 1, 0) = -1;
+        (*H)[k + 4](r + 1, 0) = w0 * dt;
+        if (trapezoidal_) (*H)[k + 5](r + 1, 0) = w1 * dt;
+        if (!dt_) {
+          H->back()(r, 0) = v;
+          H->back()(r + 1, 0) = a;
+        }
+      }
+    }
+    return error;
+  }
+
+  /// Only the products of dt with velocities and accelerations are nonlinear.
+  gtsam::Matrix weightedErrorHessian(
+      const gtsam::Values &x, const gtsam::Vector &weights) const override {
+    gtsam::Matrix hessian = gtsam::Matrix::Zero(size(), size());
+    if (dt_) return hessian;
+
+    const size_t n = keysPerJoint(), t = size() - 1;
+    const double w0 = trapezoidal_ ? 0.5 : 1.0, w1 = trapezoidal_ ? 0.5 : 0.0;
+    for (size_t i = 0; i < num_joints_; i++) {
+      const size_t k = i * n, r = 2 * i;
+      hessian(t, k + 2) = w0 * weights(r);
+      hessian(t, k + 3) = w1 * weights(r);
+      hessian(t, k + 4) = w0 * weights(r + 1);
+      if (trapezoidal_) hessian(t, k + 5) = w1 * weights(r + 1);
+    }
+    hessian.col(t) = hessian.row(t).transpose();
+    return hessian;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << (trapezoidal_ ? "trapezoidal" : "euler")
+              << " joints collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
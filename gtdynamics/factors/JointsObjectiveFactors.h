@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointsObjectiveFactors.h
+ * @brief Minimum torque and joint limit factors on all joints of a time step.
+ * @author Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace internal {
+/// Noise model of n rows, each with the sigma of a 1D diagonal model.
+inline gtsam::SharedNoiseModel RepeatedModel(
+    size_t n, const gtsam::noiseModel::Base::shared_ptr &model,
+    const std::string &factor) {
+  auto diagonal = std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != 1) {
+    throw std::invalid_argument(factor +
+                                ": the noise model must be 1D and diagonal.");
+  }
+  return gtsam::noiseModel::Isotropic::Sigma(n, diagonal->sigma(0));
+}
+}  // namespace internal
+
+/**
+ * JointsMinTorqueFactor minimizes the torques of several joints, e.g. all
+ * joints of a robot at one time step. It replaces one MinTorqueFactor per
+ * joint, with the same errors e_j = tau_j, by one factor, which linearizes
+ * into a single Jacobian factor.
+ */
+class JointsMinTorqueFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = JointsMinTorqueFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  static gtsam::KeyVector Keys(const std::vector<int> &joint_ids, int t) {
+    gtsam::KeyVector keys;
+    for (int j : joint_ids) keys.push_back(TorqueKey(j, t));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param joint_ids ids of the joints
+   * @param t time step
+   * @param cost_model 1D diagonal noise model of each torque, as for
+   * MinTorqueFactor
+   */
+  JointsMinTorqueFactor(const std::vector<int> &joint_ids, int t,
+                        const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(internal::RepeatedModel(joint_ids.size(), cost_model,
+                                     "JointsMinTorqueFactor"),
+             Keys(joint_ids, t)) {}
+
+  virtual ~JointsMinTorqueFactor() {}
+
+  /// Torques of all joints.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    gtsam::Vector error(size());
+    for (size_t i = 0; i < size(); i++) {
+      error(i) = x.at<double>(keys_[i]);
+      if (H) {
+        (*H)[i] = gtsam::Matrix::Zero(size(), 1);
+        (*H)[i](i, 0) = 1;
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "joints min torque factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointsLimitFactor enforces limits on several scalar variables with the
+ * hinge loss of JointLimitFactor, one row per variable. Constructed from
+ * joints, it covers the angle, velocity, acceleration and torque limits of
+ * all of them at one time step, in place of Joint::jointLimitFactors for each
+ * joint.
+ */
+class JointsLimitFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = JointsLimitFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Vector low_, high_;
+
+ public:
+  /**
+   * Constructor from keys and limits.
+   * @param keys keys of the scalar variables
+   * @param low lower limits, including thresholds
+   * @param high upper limits, including thresholds
+   * @param cost_model 1D diagonal noise model of each row
+   */
+  JointsLimitFactor(const gtsam::KeyVector &keys, const gtsam::Vector &low,
+                    const gtsam::Vector &high,
+                    const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(internal::RepeatedModel(keys.size(), cost_model,
+                                     "JointsLimitFactor"),
+             keys),
+        low_(low),
+        high_(high) {
+    if (static_cast<size_t>(low.size()) != keys.size() ||
+        static_cast<size_t>(high.size()) != keys.size()) {
+      throw std::invalid_argument(
+          "JointsLimitFactor: need one lower and upper limit per key.");
+    }
+  }
+
+  /**
+   * Constructor from the joint parameters, as Joint::jointLimitFactors.
+   * @param joints the joints
+   * @param t time step
+   * @param cost_model 1D diagonal noise model of each row
+   */
+  JointsLimitFactor(const std::vector<JointSharedPtr> &joints, size_t t,
+                    const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : JointsLimitFactor(Keys(joints, t), Low(joints), High(joints),
+                          cost_model) {}
+
+  virtual ~JointsLimitFactor() {}
+
+  /// Angle, velocity, acceleration and torque keys of each joint.
+  static gtsam::KeyVector Keys(const std::vector<JointSharedPtr> &joints,
+                               size_t t) {
+    gtsam::KeyVector keys;
+    for (auto &&joint : joints) {
+      const int j = joint->id();
+      keys.insert(keys.end(), {JointAngleKey(j, t), JointVelKey(j, t),
+                               JointAccelKey(j, t), TorqueKey(j, t)});
+    }
+    return keys;
+  }
+
+  /// Lower limits of Keys, with thresholds.
+  static gtsam::Vector Low(const std::vector<JointSharedPtr> &joints) {
+    gtsam::Vector low(4 * joints.size());
+    for (size_t i = 0; i < joints.size(); i++) {
+      const JointParams &p = joints[i]->parameters();
+      low.segment<4>(4 * i) << p.scalar_limits.value_lower_limit +
+                                   p.scalar_limits.value_limit_threshold,
+          -p.velocity_limit + p.velocity_limit_threshold,
+          -p.acceleration_limit + p.acceleration_limit_threshold,
+          -p.torque_limit + p.torque_limit_threshold;
+    }
+    return low;
+  }
+
+  /// Upper limits of Keys, with thresholds.
+  static gtsam::Vector High(const std::vector<JointSharedPtr> &joints) {
+    gtsam::Vector high(4 * joints.size());
+    for (size_t i = 0; i < joints.size(); i++) {
+      const JointParams &p = joints[i]->parameters();
+      high.segment<4>(4 * i) << p.scalar_limits.value_upper_limit -
+                                    p.scalar_limits.value_limit_threshold,
+          p.velocity_limit - p.velocity_limit_threshold,
+          p.acceleration_limit - p.acceleration_limit_threshold,
+          p.torque_limit - p.torque_limit_threshold;
+    }
+    return high;
+  }
+
+  /// Hinge losses of all variables, zero within the limits.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    gtsam::Vector error(size());
+    for (size_t i = 0; i < size(); i++) {
+      const double q = x.at<double>(keys_[i]);
+      double slope = 0;
+      if (q < low_(i)) {
+        error(i) = low_(i) - q;
+        slope = -1;
+      } else if (q <= high_(i)) {
+        error(i) = 0;
+      } else {
+        error(i) = q - high_(i);
+        slope = 1;
+      }
+      if (H) {
+        (*H)[i] = gtsam::Matrix::Zero(size(), 1);
+        (*H)[i](i, 0) = slope;
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "joints limit factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
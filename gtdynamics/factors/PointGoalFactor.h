@@ -23,7 +23,10 @@
 #include <gtsam/nonlinear/expressions.h>
 #include <gtsam/slam/expressions.h>
 
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -106,4 +109,103 @@ inline gtsam::NonlinearFactorGraph PointGoalFactors(
   return factors;
 }
 
+/**
+ * PointGoalPathFactor makes a point on a link follow a goal path, e.g. a swing
+ * foot trajectory, over consecutive time steps. It has the errors of one
+ * PointGoalFactor per time step, wTcom_k * point_com - goal_k, with the goals
+ * stored as the columns of one matrix, and linearizes into a single Jacobian
+ * factor on the block of pose keys.
+ */
+class PointGoalPathFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = PointGoalPathFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Point3 point_com_;
+  gtsam::Matrix3X goals_;
+
+  static gtsam::KeyVector Keys(uint8_t i, size_t k, size_t num_steps) {
+    gtsam::KeyVector keys;
+    for (size_t n = 0; n < num_steps; n++) keys.push_back(PoseKey(i, k + n));
+    return keys;
+  }
+
+  /// Noise model of all goals, from the 3D diagonal model of one goal.
+  static gtsam::SharedNoiseModel StackedModel(
+      size_t num_steps, const gtsam::noiseModel::Base::shared_ptr &model) {
+    auto diagonal =
+        std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+    if (!diagonal || diagonal->dim() != 3) {
+      throw std::invalid_argument(
+          "PointGoalPathFactor: the noise model must be 3D and diagonal.");
+    }
+    return gtsam::noiseModel::Diagonal::Sigmas(
+        diagonal->sigmas().replicate(num_steps, 1));
+  }
+
+  static gtsam::Matrix3X Goals(const std::vector<gtsam::Point3> &path) {
+    gtsam::Matrix3X goals(3, path.size());
+    for (size_t n = 0; n < path.size(); n++) goals.col(n) = path[n];
+    return goals;
+  }
+
+ public:
+  /**
+   * Constructor from goal path.
+   * @param cost_model 3D diagonal noise model of each goal
+   * @param point_com point on link, in COM coordinate frame
+   * @param goal_trajectory goal points at time steps k, k+1, ..., in world
+   * coordinates
+   * @param i the link id
+   * @param k time step of the first goal
+   */
+  PointGoalPathFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const gtsam::Point3 &point_com,
+                      const std::vector<gtsam::Point3> &goal_trajectory,
+                      uint8_t i, size_t k = 0)
+      : Base(StackedModel(goal_trajectory.size(), cost_model),
+             Keys(i, k, goal_trajectory.size())),
+        point_com_(point_com),
+        goals_(Goals(goal_trajectory)) {}
+
+  virtual ~PointGoalPathFactor() {}
+
+  /// Return goal points, one per column.
+  const gtsam::Matrix3X &goalPoints() const { return goals_; }
+
+  /// Errors of the point at all time steps.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    gtsam::Vector error(dim());
+    gtsam::Matrix36 H_pose;
+    for (size_t n = 0; n < size(); n++) {
+      const gtsam::Pose3 &wTcom = x.at<gtsam::Pose3>(keys_[n]);
+      error.segment<3>(3 * n) =
+          wTcom.transformFrom(point_com_, H ? &H_pose : nullptr) -
+          goals_.col(n);
+      if (H) {
+        (*H)[n] = gtsam::Matrix::Zero(dim(), 6);
+        (*H)[n].middleRows<3>(3 * n) = H_pose;
+      }
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "point goal path factor over " << size() << " steps"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
 }  // namespace gtdynamics
@@ -24,7 +24,9 @@
 #include <gtsam/slam/BetweenFactor.h>
 
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -40,7 +42,8 @@ class PreintegratedPointContactMeasurements {
   gtsam::Matrix3 vdCov_;
 
  public:
-  PreintegratedPointContactMeasurements() {}
+  PreintegratedPointContactMeasurements()
+      : preintMeasCov_(gtsam::Z_3x3), vdCov_(gtsam::Z_3x3) {}
 
   /**
    * @brief Construct a new Preintegrated Point Contact Measurements object.
@@ -80,6 +83,47 @@ class PreintegratedPointContactMeasurements {
     preintMeasCov_ = preintMeasCov_ + (B * vdCov_ * B.transpose());
   }
 
+  /**
+   * @brief Add a batch of measurements with the same dt, e.g. all samples of
+   * a fixed rate IMU since the last call, in one pass. Equivalent to calling
+   * integrateMeasurement for each sample.
+   *
+   * @param deltaRiks The rotation deltas obtained from the IMU preintegration.
+   * @param contacts The poses of the contact frame at each sample.
+   * @param dt Time interval between consecutive IMU measurements.
+   */
+  void integrateMeasurements(const std::vector<gtsam::Rot3> &deltaRiks,
+                             const std::vector<gtsam::Pose3> &contacts,
+                             const double dt) {
+    if (deltaRiks.size() != contacts.size()) {
+      throw std::invalid_argument(
+          "PreintegratedPointContactMeasurements: the number of rotation "
+          "deltas and contact poses differ.");
+    }
+    gtsam::Matrix3 sum = gtsam::Z_3x3;
+    for (size_t k = 0; k < deltaRiks.size(); k++) {
+      const gtsam::Matrix3 R =
+          deltaRiks[k].matrix() * contacts[k].rotation().matrix();
+      sum.noalias() += R * vdCov_ * R.transpose();
+    }
+    preintMeasCov_ += (dt * dt) * sum;
+  }
+
+  /**
+   * @brief Restart the preintegration from a new first step, e.g. when a
+   * fixed-lag smoother starts a new contact factor, reusing this object.
+   *
+   * @param base_k The pose of the current base frame.
+   * @param contact_k The pose of the current contact frame.
+   * @param dt The time between the previous and current step.
+   */
+  void resetIntegration(const gtsam::Pose3 &base_k,
+                        const gtsam::Pose3 &contact_k, double dt) {
+    gtsam::Matrix3 B =
+        base_k.rotation().transpose() * contact_k.rotation().matrix() * dt;
+    preintMeasCov_ = B * vdCov_ * B.transpose();
+  }
+
   gtsam::Matrix3 preintMeasCov() const { return preintMeasCov_; }
 };
 
@@ -206,7 +250,10 @@ class PreintegratedRigidContactMeasurements {
   gtsam::Matrix3 wCov_, vCov_;
 
  public:
-  PreintegratedRigidContactMeasurements() {}
+  PreintegratedRigidContactMeasurements()
+      : preintMeasCov_(gtsam::Z_6x6),
+        wCov_(gtsam::Z_3x3),
+        vCov_(gtsam::Z_3x3) {}
 
   /**
    * @brief Construct a new Preintegrated Rigid Contact Measurements object.
@@ -244,6 +291,40 @@ class PreintegratedRigidContactMeasurements {
     preintMeasCov_ += (C * dt * dt);
   }
 
+  /**
+   * @brief Integrate a batch of measurements with time varying contact noise
+   * and the same dt, in one pass. Equivalent to calling integrateMeasurement
+   * for each sample.
+   *
+   * @param angularVelocityCovariances The discrete covariance matrices for
+   * the contact frame's angular velocity.
+   * @param linearVelocityCovariances The discrete covariance matrices for the
+   * contact frame's linear velocity.
+   * @param dt Time interval between consecutive IMU measurements.
+   */
+  void integrateMeasurements(
+      const std::vector<gtsam::Matrix3> &angularVelocityCovariances,
+      const std::vector<gtsam::Matrix3> &linearVelocityCovariances,
+      double dt) {
+    if (angularVelocityCovariances.size() !=
+        linearVelocityCovariances.size()) {
+      throw std::invalid_argument(
+          "PreintegratedRigidContactMeasurements: the number of angular and "
+          "linear velocity covariances differ.");
+    }
+    gtsam::Matrix3 wSum = gtsam::Z_3x3, vSum = gtsam::Z_3x3;
+    for (size_t k = 0; k < angularVelocityCovariances.size(); k++) {
+      wSum += angularVelocityCovariances[k];
+      vSum += linearVelocityCovariances[k];
+    }
+    preintMeasCov_.topLeftCorner<3, 3>() += (dt * dt) * wSum;
+    preintMeasCov_.bottomRightCorner<3, 3>() += (dt * dt) * vSum;
+  }
+
+  /// Restart the preintegration, e.g. for a new contact of a fixed-lag
+  /// smoother, reusing this object.
+  void resetIntegration() { preintMeasCov_.setZero(); }
+
   /**
    * @brief Integrate a new measurement with constant contact noise.
    *
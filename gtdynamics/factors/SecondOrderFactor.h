@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SecondOrderFactor.h
+ * @brief Optional second-order interface of factors, used by NewtonOptimizer.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SecondOrderFactor is an interface a NoiseModelFactor can implement to
+ * provide the second derivatives of its error, which Gauss-Newton and LM
+ * drop. With e(x) the unwhitened error and w a vector of weights, it returns
+ * the weighted sum of the Hessians of the error rows, sum_i w_i d2e_i/dx2,
+ * with x the local coordinates of the factor keys, stacked in key order.
+ *
+ * Factors which do not implement it can use NumericalWeightedErrorHessian.
+ */
+class SecondOrderFactor {
+ public:
+  virtual ~SecondOrderFactor() {}
+
+  /**
+   * Weighted sum of the Hessians of the unwhitened error rows.
+   * @param values Values of (at least) the factor keys.
+   * @param weights One weight per error row.
+   * @return Symmetric matrix of the dimension of all factor keys.
+   */
+  virtual gtsam::Matrix weightedErrorHessian(
+      const gtsam::Values &values, const gtsam::Vector &weights) const = 0;
+};
+
+/**
+ * Weighted sum of the Hessians of the unwhitened error rows of any
+ * NoiseModelFactor, by central differences of its Jacobians.
+ * @param factor The factor.
+ * @param values Values of (at least) the factor keys.
+ * @param weights One weight per error row.
+ * @param delta Step of the central differences.
+ */
+inline gtsam::Matrix NumericalWeightedErrorHessian(
+    const gtsam::NoiseModelFactor &factor, const gtsam::Values &values,
+    const gtsam::Vector &weights, double delta = 1e-5) {
+  // Only perturb the values of the factor keys.
+  gtsam::Values local;
+  std::vector<size_t> dims;
+  size_t total_dim = 0;
+  for (gtsam::Key key : factor.keys()) {
+    local.insert(key, values.at(key));
+    dims.push_back(values.at(key).dim());
+    total_dim += dims.back();
+  }
+
+  // Weighted sum of the stacked Jacobians, w' [H_1 ... H_n].
+  auto weighted_gradient = [&](const gtsam::Values &x) {
+    std::vector<gtsam::Matrix> H(factor.size());
+    factor.unwhitenedError(x, H);
+    gtsam::Vector gradient(total_dim);
+    size_t col = 0;
+    for (size_t j = 0; j < H.size(); j++) {
+      gradient.segment(col, dims[j]) = H[j].transpose() * weights;
+      col += dims[j];
+    }
+    return gradient;
+  };
+
+  gtsam::Matrix hessian(total_dim, total_dim);
+  size_t col = 0;
+  for (size_t j = 0; j < factor.size(); j++) {
+    for (size_t c = 0; c < dims[j]; c++, col++) {
+      gtsam::VectorValues step;
+      step.insert(factor.keys()[j], gtsam::Vector::Unit(dims[j], c) * delta);
+      hessian.col(col) = (weighted_gradient(local.retract(step)) -
+                          weighted_gradient(local.retract(-1.0 * step))) /
+                         (2 * delta);
+    }
+  }
+  return 0.5 * (hessian + hessian.transpose());
+}
+
+}  // namespace gtdynamics
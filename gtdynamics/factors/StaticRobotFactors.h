@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticRobotFactors.h
+ * @brief Factors on the joint variables of a StaticRobot arm.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/StaticRobot.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <memory>
+
+namespace gtdynamics {
+
+namespace internal {
+/// Keys of a joint quantity of joints 0..N-1 at time step k.
+template <int N>
+gtsam::KeyVector StaticRobotKeys(gtsam::Key (*key)(int, int), int k) {
+  gtsam::KeyVector keys;
+  for (int j = 0; j < N; ++j) keys.push_back(key(j, k));
+  return keys;
+}
+
+/// Joint vector from the values of N consecutive scalar keys.
+template <int N>
+typename StaticRobot<N>::JointVector StaticRobotJoints(
+    const gtsam::Values &x, const gtsam::KeyVector &keys, size_t offset) {
+  typename StaticRobot<N>::JointVector q;
+  for (int j = 0; j < N; ++j) q(j) = x.at<double>(keys[offset + j]);
+  return q;
+}
+}  // namespace internal
+
+/**
+ * StaticRobotPoseFactor constrains the pose variable of a link to the forward
+ * kinematics of a StaticRobot, with the fixed-size body Jacobian, in place
+ * of the pose and joint factors of every link of a generic Robot graph.
+ *
+ * Keys are the joint angles of joints 0..N-1, then the pose of the link.
+ */
+template <int N>
+class StaticRobotPoseFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = StaticRobotPoseFactor<N>;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::shared_ptr<const StaticRobot<N>> robot_;
+  int joint_id_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot      the arm
+   * @param link_id    id of the link, e.g. the end-effector
+   * @param joint_id   id of the joint that moves the link
+   * @param cost_model noise model of dimension 6
+   * @param k          time step
+   */
+  StaticRobotPoseFactor(const std::shared_ptr<const StaticRobot<N>> &robot,
+                        int link_id, int joint_id,
+                        const gtsam::SharedNoiseModel &cost_model, int k = 0)
+      : Base(cost_model, [&] {
+          gtsam::KeyVector keys =
+              internal::StaticRobotKeys<N>(&JointAngleKey, k);
+          keys.push_back(PoseKey(link_id, k));
+          return keys;
+        }()),
+        robot_(robot),
+        joint_id_(joint_id) {}
+
+  virtual ~StaticRobotPoseFactor() {}
+
+  /// Local coordinates of the forward kinematics at the pose variable.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const auto q = internal::StaticRobotJoints<N>(x, keys_, 0);
+    const gtsam::Pose3 &wTl = x.at<gtsam::Pose3>(keys_[N]);
+    Eigen::Matrix<double, 6, N> fk_H_q;
+    const gtsam::Pose3 fk = robot_->linkPose(q, joint_id_, H ? &fk_H_q : 0);
+    gtsam::Matrix6 H_wTl, H_fk;
+    const gtsam::Vector6 error = gtsam::traits<gtsam::Pose3>::Local(
+        wTl, fk, H ? &H_wTl : 0, H ? &H_fk : 0);
+    if (H) {
+      const Eigen::Matrix<double, 6, N> error_H_q = H_fk * fk_H_q;
+      for (int j = 0; j < N; ++j) (*H)[j] = error_H_q.col(j);
+      (*H)[N] = H_wTl;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/**
+ * StaticRobotDynamicsFactor constrains the torques of a StaticRobot to the
+ * inverse dynamics of its angles, velocities and accelerations: a single
+ * factor per time step in place of the link wrench, twist and acceleration
+ * variables and factors of a generic Robot graph. The error is the inverse
+ * dynamics torques minus the torque variables.
+ *
+ * Keys are, in order: the angles, velocities, accelerations and torques of
+ * joints 0..N-1 at time step k.
+ */
+template <int N>
+class StaticRobotDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = StaticRobotDynamicsFactor<N>;
+  using Base = gtsam::NoiseModelFactor;
+  using JointMatrix = typename StaticRobot<N>::JointMatrix;
+
+  std::shared_ptr<const StaticRobot<N>> robot_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot      the arm
+   * @param cost_model noise model of dimension N
+   * @param k          time step
+   */
+  StaticRobotDynamicsFactor(
+      const std::shared_ptr<const StaticRobot<N>> &robot,
+      const gtsam::SharedNoiseModel &cost_model, int k = 0)
+      : Base(cost_model, [&] {
+          gtsam::KeyVector keys;
+          for (auto key : {&JointAngleKey, &JointVelKey, &JointAccelKey,
+                           &TorqueKey}) {
+            const auto joint_keys = internal::StaticRobotKeys<N>(key, k);
+            keys.insert(keys.end(), joint_keys.begin(), joint_keys.end());
+          }
+          return keys;
+        }()),
+        robot_(robot) {}
+
+  virtual ~StaticRobotDynamicsFactor() {}
+
+  /// Inverse dynamics torques minus the torques, with analytic derivatives.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const auto q = internal::StaticRobotJoints<N>(x, keys_, 0);
+    const auto v = internal::StaticRobotJoints<N>(x, keys_, N);
+    const auto a = internal::StaticRobotJoints<N>(x, keys_, 2 * N);
+    const auto tau = internal::StaticRobotJoints<N>(x, keys_, 3 * N);
+    if (!H) return robot_->inverseDynamics(q, v, a) - tau;
+
+    JointMatrix tau_H_q, tau_H_v;
+    const auto id = robot_->inverseDynamics(q, v, a, &tau_H_q, &tau_H_v);
+    const JointMatrix M = robot_->massMatrix(q);
+    for (int j = 0; j < N; ++j) {
+      (*H)[j] = tau_H_q.col(j);
+      (*H)[N + j] = tau_H_v.col(j);
+      (*H)[2 * N + j] = M.col(j);
+      (*H)[3 * N + j] = -gtsam::Matrix::Identity(N, N).col(j);
+    }
+    return id - tau;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+}  // namespace gtdynamics
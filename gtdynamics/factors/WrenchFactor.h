@@ -13,9 +13,13 @@
 
 #pragma once
 
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/RobotParameters.h>
 #include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/linear/NoiseModel.h>
@@ -23,6 +27,7 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <iostream>
 #include <optional>
 #include <string>
 #include <vector>
@@ -49,4 +54,120 @@ inline gtsam::NoiseModelFactor::shared_ptr WrenchFactor(
       link->wrenchConstraint(wrench_keys, time, gravity));
 }
 
+/**
+ * LinkWrenchFactor has the same error as WrenchFactor, with hand-coded
+ * Jacobians instead of an expression, so linearizing it records no execution
+ * trace. Its keys are the twist and twist acceleration of the link, then the
+ * wrench keys in the given order, then the pose if gravity is given.
+ * DynamicsGraph uses it when OptimizerSetting::closed_form_jacobians is set.
+ * Built with a RobotParameters block, it reads the mass and inertia of the link
+ * from the block at every evaluation.
+ */
+class LinkWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = LinkWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix6 inertia_;
+  double mass_;
+  std::optional<gtsam::Vector3> gravity_;
+  size_t num_wrenches_;
+  RobotParametersConstSharedPtr parameters_;  // if given, overrides the above
+  int link_id_;
+
+  static gtsam::KeyVector Keys(const LinkConstSharedPtr &link,
+                               const std::vector<gtsam::Key> &wrench_keys,
+                               int time, bool has_gravity) {
+    gtsam::KeyVector keys{TwistKey(link->id(), time),
+                          TwistAccelKey(link->id(), time)};
+    keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+    if (has_gravity) keys.push_back(PoseKey(link->id(), time));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor, with the same arguments as WrenchFactor.
+   * @param cost_model The noise model for this factor.
+   * @param link The link whose wrenches are balanced.
+   * @param wrench_keys Keys of the external wrenches on the link.
+   * @param time The timestep at which this factor is defined.
+   * @param gravity (optional) Create gravity wrench in link COM frame.
+   */
+  LinkWrenchFactor(const gtsam::SharedNoiseModel &cost_model,
+                   const LinkConstSharedPtr &link,
+                   const std::vector<gtsam::Key> &wrench_keys, int time,
+                   const std::optional<gtsam::Vector3> &gravity = {})
+      : Base(cost_model, Keys(link, wrench_keys, time, gravity.has_value())),
+        inertia_(link->inertiaMatrix()),
+        mass_(link->mass()),
+        gravity_(gravity),
+        num_wrenches_(wrench_keys.size()),
+        link_id_(link->id()) {}
+
+  /**
+   * Constructor with the inertial parameters of a parameter block.
+   * @param cost_model The noise model for this factor.
+   * @param parameters The parameter block.
+   * @param link The link whose wrenches are balanced.
+   * @param wrench_keys Keys of the external wrenches on the link.
+   * @param time The timestep at which this factor is defined.
+   * @param gravity (optional) Create gravity wrench in link COM frame.
+   */
+  LinkWrenchFactor(const gtsam::SharedNoiseModel &cost_model,
+                   const RobotParametersConstSharedPtr &parameters,
+                   const LinkConstSharedPtr &link,
+                   const std::vector<gtsam::Key> &wrench_keys, int time,
+                   const std::optional<gtsam::Vector3> &gravity = {})
+      : LinkWrenchFactor(cost_model, link, wrench_keys, time, gravity) {
+    parameters_ = parameters;
+  }
+
+  virtual ~LinkWrenchFactor() {}
+
+  /// Resultant wrench: coriolis - inertia * accel + wrenches + gravity.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const gtsam::Matrix6 &inertia =
+        parameters_ ? parameters_->inertiaMatrix(link_id_) : inertia_;
+    const double mass = parameters_ ? parameters_->mass(link_id_) : mass_;
+    gtsam::Matrix6 H_twist, H_pose;
+    gtsam::Vector6 error =
+        Coriolis(inertia, x.at<gtsam::Vector6>(keys_[0]),
+                 H ? &H_twist : nullptr) -
+        inertia * x.at<gtsam::Vector6>(keys_[1]);
+    for (size_t i = 0; i < num_wrenches_; i++) {
+      error += x.at<gtsam::Vector6>(keys_[2 + i]);
+    }
+    if (gravity_) {
+      error += GravityWrench(*gravity_, mass, x.at<gtsam::Pose3>(keys_.back()),
+                             H ? &H_pose : nullptr);
+    }
+    if (H) {
+      (*H)[0] = H_twist;
+      (*H)[1] = -inertia;
+      for (size_t i = 0; i < num_wrenches_; i++) {
+        (*H)[2 + i] = gtsam::I_6x6;
+      }
+      if (gravity_) (*H)[2 + num_wrenches_] = H_pose;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "LinkWrenchFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
 }  // namespace gtdynamics
@@ -13,13 +13,18 @@
 
 #pragma once
 
+#include <gtdynamics/factors/AutoDiffFactor.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
+#include <array>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -211,14 +216,44 @@ class SmoothActuatorFactor
  private:
   typedef SmoothActuatorFactor This;
   typedef gtsam::NoiseModelFactor3<double, double, double> Base;
-  const gtsam::Vector5 x0_coeffs_ =
-      (gtsam::Vector(5) << 3.05583930e+00, 7.58361626e-02, -4.91579771e-04,
-       1.42792618e-06, -1.54817477e-09)
-          .finished();  // TODO(yetong): using static
-  const gtsam::Vector2 f0_coeffs_ = gtsam::Vector2(0, 1.966409);
-  const gtsam::Vector2 k_coeffs_ = gtsam::Vector2(0, 0.35541599);
 
  public:
+  /// Polynomial fit of the maximum contraction x0 in the gauge pressure.
+  static constexpr double kX0Coeffs[5] = {3.05583930e+00, 7.58361626e-02,
+                                          -4.91579771e-04, 1.42792618e-06,
+                                          -1.54817477e-09};
+  /// Linear fits of the stiffness k and the rest force f0.
+  static constexpr double kKSlope = 0.35541599, kF0Slope = 1.966409;
+
+  /** Maximum contraction and its derivative at gauge pressures g, in Horner
+   * form. T is double, or an Eigen array for many samples at once. */
+  template <typename T>
+  static T MaxContraction(const T &g, T *H_g) {
+    const double *c = kX0Coeffs;
+    *H_g = c[1] + g * (2 * c[2] + g * (3 * c[3] + g * (4 * c[4])));
+    return c[0] + g * (c[1] + g * (c[2] + g * (c[3] + g * c[4])));
+  }
+
+  /** Force of the normal condition, a cubic from (0, f0) with slope -k to
+   * (x0, 0), and its derivatives. T is double, or an Eigen array. */
+  template <typename T>
+  static T CubicForce(const T &delta_x, const T &g, const T &x0,
+                      const T &j_x0, T *H_delta_x, T *H_g) {
+    const T k = kKSlope * g, f0 = kF0Slope * g;
+    const T inv_x0 = 1.0 / x0;
+    const T inv_x0_2 = inv_x0 * inv_x0;
+    const T inv_x0_3 = inv_x0_2 * inv_x0;
+    const T c = (2 * k * x0 - 3 * f0) * inv_x0_2;
+    const T d = (2 * f0 - k * x0) * inv_x0_3;
+    const T j_c = (6 * f0 * inv_x0_3 - 2 * k * inv_x0_2) * j_x0 +
+                  2 * kKSlope * inv_x0 - 3 * kF0Slope * inv_x0_2;
+    const T j_d = (2 * k * inv_x0_3 - 6 * f0 * inv_x0_3 * inv_x0) * j_x0 -
+                  kKSlope * inv_x0_2 + 2 * kF0Slope * inv_x0_3;
+    *H_delta_x = (3 * d * delta_x + 2 * c) * delta_x - k;
+    *H_g = ((j_d * delta_x + j_c) * delta_x - kKSlope) * delta_x + kF0Slope;
+    return ((d * delta_x + c) * delta_x - k) * delta_x + f0;
+  }
+
   /** Create pneumatic actuator factor
    *  delta_x_key -- key for actuator contraction in cm
    */
@@ -228,8 +263,39 @@ class SmoothActuatorFactor
       : Base(cost_model, delta_x_key, p_key, f_key) {}
   virtual ~SmoothActuatorFactor() {}
 
- private:
- public:
+  /** Expected forces of many (delta_x, p) samples, e.g. all time steps of an
+   * actuator, with optional derivatives. The polynomials are evaluated on
+   * Eigen arrays, which vectorize across samples, and the regimes are chosen
+   * per sample without branches. */
+  static gtsam::Vector ExpectedForces(const gtsam::Vector &delta_x,
+                                      const gtsam::Vector &p,
+                                      gtsam::Vector *H_delta_x = nullptr,
+                                      gtsam::Vector *H_p = nullptr) {
+    const Eigen::ArrayXd x = delta_x.array(), g = p.array() - 101.325;
+    Eigen::ArrayXd j_x0, H_x, H_g;
+    const Eigen::ArrayXd x0 = MaxContraction(g, &j_x0);
+    const Eigen::ArrayXd cubic = CubicForce(x, g, x0, j_x0, &H_x, &H_g);
+
+    // over contraction: 0, over extension: spring, else the cubic.
+    using Mask = Eigen::Array<bool, Eigen::Dynamic, 1>;
+    const Mask over_contraction = (g <= 0.0) || (x > x0);
+    const Mask over_extension = x < 0.0;
+    const Eigen::ArrayXd k = kKSlope * g, f0 = kF0Slope * g;
+    if (H_delta_x) {
+      *H_delta_x = over_contraction.select(0.0, over_extension.select(-k, H_x))
+                       .matrix();
+    }
+    if (H_p) {
+      *H_p = over_contraction
+                 .select(0.0, over_extension.select(kF0Slope - kKSlope * x,
+                                                    H_g))
+                 .matrix();
+    }
+    return over_contraction.select(0.0, over_extension.select(f0 - k * x,
+                                                              cubic))
+        .matrix();
+  }
+
   /** evaluate errors
       Keyword argument:
           delta_x     -- contraction length
@@ -247,16 +313,8 @@ class SmoothActuatorFactor
       H_f->setConstant(1, 1, -1);
     }
 
-    gtsam::Vector5 gauge_p_powers5;
-    gtsam::Vector2 gauge_p_powers2(1, gauge_p);
-    // (1, gauge_p, gauge_p*gauge_p, pow(gauge_p,3), pow(gauge_p,4));
-
-    gauge_p_powers5(0) = 1;
-    for (size_t i = 1; i < 5; i++) {
-      gauge_p_powers5(i) = gauge_p_powers5(i - 1) * gauge_p;
-    }
-
-    double x0 = x0_coeffs_.dot(gauge_p_powers5);
+    double j_x0_p;
+    double x0 = MaxContraction(gauge_p, &j_x0_p);
 
     // over contraction: should return 0
     if (gauge_p <= 0 || delta_x > x0) {
@@ -265,47 +323,20 @@ class SmoothActuatorFactor
       return gtsam::Vector1(-f);
     }
 
-    double k = k_coeffs_.dot(gauge_p_powers2);
-    double f0 = f0_coeffs_.dot(gauge_p_powers2);
-    double j_k_p = 0, j_f0_p = 0;
-    if (H_p) {
-      for (size_t i = 1; i < 2; i++) {
-        j_k_p += i * k_coeffs_(i) * gauge_p_powers2(i - 1);
-        j_f0_p += i * f0_coeffs_(i) * gauge_p_powers2(i - 1);
-      }
-    }
-
     // over extension: should model as a spring
     if (delta_x < 0) {
+      double k = kKSlope * gauge_p, f0 = kF0Slope * gauge_p;
       if (H_delta_x) H_delta_x->setConstant(1, 1, -k);
-      if (H_p) H_p->setConstant(1, 1, j_f0_p - j_k_p * delta_x);
+      if (H_p) H_p->setConstant(1, 1, kF0Slope - kKSlope * delta_x);
       return gtsam::Vector1(f0 - k * delta_x - f);
     }
 
     // normal condition
-    double delta_x_2 = delta_x * delta_x;
-    double delta_x_3 = delta_x_2 * delta_x;
-    double c = (2 * k * x0 - 3 * f0) / (x0 * x0);
-    double d = (-k * x0 + 2 * f0) / (x0 * x0 * x0);
-    double x0_2 = x0 * x0;
-    double x0_3 = x0_2 * x0;
-    double x0_4 = x0_3 * x0;
-    if (H_delta_x)
-      H_delta_x->setConstant(1, 1, 3 * d * delta_x_2 + 2 * c * delta_x - k);
-    if (H_p) {
-      double j_x0_p = 0;
-      for (size_t i = 1; i < 5; i++) {
-        j_x0_p += i * x0_coeffs_(i) * gauge_p_powers5(i - 1);
-      }
-      double j_c_p = (-2 * k / x0_2 + 6 * f0 / x0_3) * j_x0_p +
-                     (2 / x0) * j_k_p + (-3 / x0_2) * j_f0_p;
-      double j_d_p = (2 * k / x0_3 - 6 * f0 / x0_4) * j_x0_p +
-                     (-1 / x0_2) * j_k_p + (2 / x0_3) * j_f0_p;
-      double j_p =
-          delta_x_3 * j_d_p + delta_x_2 * j_c_p + delta_x * (-j_k_p) + j_f0_p;
-      H_p->setConstant(1, 1, j_p);
-    }
-    double expected_f = d * delta_x_3 + c * delta_x_2 + (-k) * delta_x + f0;
+    double j_delta_x, j_p;
+    double expected_f =
+        CubicForce(delta_x, gauge_p, x0, j_x0_p, &j_delta_x, &j_p);
+    if (H_delta_x) H_delta_x->setConstant(1, 1, j_delta_x);
+    if (H_p) H_p->setConstant(1, 1, j_p);
     return gtsam::Vector1(expected_f - f);
   }
 
@@ -335,6 +366,141 @@ class SmoothActuatorFactor
 #endif
 };
 
+/** SmoothActuatorsFactor applies the model of SmoothActuatorFactor to many
+ * time steps of an actuator at once: it has the keys of (delta_x, p, f) of
+ * each step, and one error row per step, evaluated in one batch. */
+class SmoothActuatorsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = SmoothActuatorsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  static gtsam::KeyVector Keys(const gtsam::KeyVector &delta_x_keys,
+                               const gtsam::KeyVector &p_keys,
+                               const gtsam::KeyVector &f_keys) {
+    if (p_keys.size() != delta_x_keys.size() ||
+        f_keys.size() != delta_x_keys.size()) {
+      throw std::invalid_argument(
+          "SmoothActuatorsFactor: needs the same number of contraction, "
+          "pressure and force keys.");
+    }
+    gtsam::KeyVector keys;
+    for (size_t k = 0; k < delta_x_keys.size(); k++) {
+      keys.push_back(delta_x_keys[k]);
+      keys.push_back(p_keys[k]);
+      keys.push_back(f_keys[k]);
+    }
+    return keys;
+  }
+
+  /// Noise model of all rows, from the noise model of one row.
+  static gtsam::SharedNoiseModel StackedModel(
+      const gtsam::noiseModel::Base::shared_ptr &row_model, size_t rows) {
+    auto diagonal =
+        std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(row_model);
+    if (!diagonal || diagonal->dim() != 1) {
+      throw std::invalid_argument(
+          "SmoothActuatorsFactor: the row noise model must be 1D and "
+          "diagonal.");
+    }
+    return gtsam::noiseModel::Isotropic::Sigma(rows, diagonal->sigma(0));
+  }
+
+ public:
+  /**
+   * Constructor.
+   * @param delta_x_keys contraction keys of each time step, in cm
+   * @param p_keys pressure keys of each time step
+   * @param f_keys force keys of each time step
+   * @param row_model 1D diagonal noise model of each error row
+   */
+  SmoothActuatorsFactor(const gtsam::KeyVector &delta_x_keys,
+                        const gtsam::KeyVector &p_keys,
+                        const gtsam::KeyVector &f_keys,
+                        const gtsam::noiseModel::Base::shared_ptr &row_model)
+      : Base(StackedModel(row_model, delta_x_keys.size()),
+             Keys(delta_x_keys, p_keys, f_keys)) {}
+  virtual ~SmoothActuatorsFactor() {}
+
+  /// Number of time steps.
+  size_t numSteps() const { return size() / 3; }
+
+  /// Expected minus actual force of each time step.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override {
+    const size_t n = numSteps();
+    gtsam::Vector delta_x(n), p(n), f(n);
+    for (size_t k = 0; k < n; k++) {
+      delta_x(k) = x.at<double>(keys_[3 * k]);
+      p(k) = x.at<double>(keys_[3 * k + 1]);
+      f(k) = x.at<double>(keys_[3 * k + 2]);
+    }
+
+    if (!H) return SmoothActuatorFactor::ExpectedForces(delta_x, p) - f;
+    gtsam::Vector H_delta_x, H_p;
+    const gtsam::Vector error =
+        SmoothActuatorFactor::ExpectedForces(delta_x, p, &H_delta_x, &H_p) - f;
+    for (size_t k = 0; k < n; k++) {
+      for (size_t i = 0; i < 3; i++) {
+        (*H)[3 * k + i] = gtsam::Matrix::Zero(n, 1);
+      }
+      (*H)[3 * k](k, 0) = H_delta_x(k);
+      (*H)[3 * k + 1](k, 0) = H_p(k);
+      (*H)[3 * k + 2](k, 0) = -1;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /** print contents */
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "pneumatic actuators factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/** SmoothActuatorResidual is the model of SmoothActuatorFactor as a residual
+ * functor of (delta_x, p, f), for AutoDiffFactor. It is also the template for
+ * new actuator models, which then need no hand-derived Jacobians. */
+struct SmoothActuatorResidual {
+  template <typename T>
+  std::array<T, 1> operator()(const std::array<T, 3> &x) const {
+    const T &delta_x = x[0], &f = x[2];
+    const T gauge_p = x[1] - 101.325;
+
+    // Polynomial fits of the maximum contraction, stiffness and rest force.
+    const T x0 =
+        3.05583930e+00 +
+        gauge_p * (7.58361626e-02 +
+                   gauge_p * (-4.91579771e-04 +
+                              gauge_p * (1.42792618e-06 +
+                                         gauge_p * -1.54817477e-09)));
+    const T k = 0.35541599 * gauge_p, f0 = 1.966409 * gauge_p;
+
+    // over contraction: should return 0
+    if (gauge_p <= 0 || delta_x > x0) return {-f};
+
+    // over extension: should model as a spring
+    if (delta_x < 0) return {f0 - k * delta_x - f};
+
+    // normal condition: cubic from (0, f0) with slope -k to (x0, 0).
+    const T c = (2 * k * x0 - 3 * f0) / (x0 * x0);
+    const T d = (-k * x0 + 2 * f0) / (x0 * x0 * x0);
+    return {((d * delta_x + c) * delta_x - k) * delta_x + f0 - f};
+  }
+};
+
+/// SmoothActuatorFactor with Jacobians by automatic differentiation.
+using AutoDiffSmoothActuatorFactor =
+    AutoDiffFactor<SmoothActuatorResidual, 1, 3>;
+
 /** ClippingActuatorFactor (deprecated) fits a non-smooth relationship between
  * pressure, contraction length and force, and use clipping for force < 0 */
 class ClippingActuatorFactor
@@ -182,7 +182,7 @@ class MassFlowRateFactor
 
 /** Sigmoid function, 1/(1+e^-x), used to model the change of mass flow
  * rate when valve is open/closed. */
-double sigmoid(double x, gtsam::OptionalMatrixType H_x = nullptr) {
+inline double sigmoid(double x, gtsam::OptionalMatrixType H_x = nullptr) {
   double neg_exp = exp(-x);
   if (H_x) {
     H_x->setConstant(1, 1, neg_exp / pow(1.0 + neg_exp, 2));
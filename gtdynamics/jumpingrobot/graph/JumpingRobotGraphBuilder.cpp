@@ -0,0 +1,250 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.cpp
+ * @brief Factor graphs for trajectory optimization of the jumping robot.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/jumpingrobot/factors/JRCollocationFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/jumpingrobot/graph/JumpingRobotGraphBuilder.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using Keys = JumpingRobotSimulator;
+
+/* ************************************************************************* */
+ActuationCostModels::ActuationCostModels()
+    : force(InternedIsotropic(1, 0.01)),
+      balance(InternedIsotropic(1, 0.001)),
+      torque(InternedIsotropic(1, 0.01)),
+      gas_law(InternedIsotropic(1, 0.0001)),
+      mass_rate(InternedIsotropic(1, 1e-5)),
+      volume(InternedIsotropic(1, 1e-7)),
+      mass_collocation(InternedIsotropic(1, 1e-7)) {}
+
+/* ************************************************************************* */
+JumpingRobotGraphBuilder::JumpingRobotGraphBuilder(
+    const DynamicsGraph &graph_builder,
+    const std::vector<ActuatorParams> &actuators,
+    const PneumaticParams &pneumatic, const std::string &torso_name,
+    const ActuationCostModels &models)
+    : graph_builder_(graph_builder),
+      actuators_(actuators),
+      pneumatic_(pneumatic),
+      torso_name_(torso_name),
+      models_(models) {}
+
+/* ************************************************************************* */
+DynamicsGraph JumpingRobotGraphBuilder::DefaultGraphBuilder() {
+  OptimizerSetting opt(0.001, 0.001, 0.001, 0.001, 0.001, 0.0001);
+  opt.f_cost_model = InternedIsotropic(6, 0.01);
+  opt.fa_cost_model = InternedIsotropic(6, 0.01);
+  opt.t_cost_model = InternedIsotropic(1, 0.01);
+  opt.pose_col_cost_model = InternedIsotropic(6, 0.001);
+  opt.twist_col_cost_model = InternedIsotropic(6, 0.001);
+  return DynamicsGraph(opt, gtsam::Vector3(0, 0, -9.8),
+                       gtsam::Vector3(1, 0, 0));
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::sourceDynamicsGraph(
+    int k) const {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<GasLawFactor>(
+      Keys::SourcePressureKey(k), Keys::SourceVolumeKey(),
+      Keys::SourceMassKey(k), models_.gas_law, pneumatic_.gas_constant);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::actuatorDynamicsGraph(
+    size_t a, int k) const {
+  const ActuatorParams &actuator = actuators_.at(a);
+  const int j = actuator.j;
+  const gtsam::Key m_key = Keys::MassKey(j, k), P_key = Keys::PressureKey(j, k),
+                   V_key = Keys::VolumeKey(j, k),
+                   x_key = Keys::ContractionKey(j, k),
+                   f_key = Keys::ForceKey(j, k);
+
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<GasLawFactor>(P_key, V_key, m_key, models_.gas_law,
+                                     pneumatic_.gas_constant);
+  graph.emplace_shared<ActuatorVolumeFactor>(
+      V_key, x_key, models_.volume, pneumatic_.d_tube, pneumatic_.l_tube);
+  graph.emplace_shared<SmoothActuatorFactor>(x_key, P_key, f_key,
+                                             models_.force);
+  graph.emplace_shared<ForceBalanceFactor>(
+      x_key, JointAngleKey(j, k), f_key, models_.balance, actuator.k_tendon,
+      actuator.radius, actuator.q_rest, actuator.positive);
+  graph.emplace_shared<JointTorqueFactor>(
+      JointAngleKey(j, k), JointVelKey(j, k), f_key, TorqueKey(j, k),
+      models_.torque, actuator.q_anta_limit, actuator.k_anta, actuator.radius,
+      actuator.b, actuator.positive);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::massFlowGraph(size_t a,
+                                                             int k) const {
+  const int j = actuators_.at(a).j;
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<MassFlowRateFactor>(
+      Keys::PressureKey(j, k), Keys::SourcePressureKey(k),
+      Keys::MassRateOpenKey(j, k), models_.mass_rate, pneumatic_.d_tube,
+      pneumatic_.l_tube, pneumatic_.mu_tube, pneumatic_.eps_tube,
+      1.0 / pneumatic_.gas_constant);
+  graph.emplace_shared<ValveControlFactor>(
+      TimeKey(k), Keys::ValveOpenTimeKey(j), Keys::ValveCloseTimeKey(j),
+      Keys::MassRateOpenKey(j, k), Keys::MassRateActualKey(j, k),
+      models_.mass_rate, pneumatic_.time_constant_valve);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::actuationDynamicsGraph(
+    int k) const {
+  NonlinearFactorGraph graph = sourceDynamicsGraph(k);
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    graph.push_back(actuatorDynamicsGraph(a, k));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::robotDynamicsGraph(
+    const Robot &robot, int k) const {
+  NonlinearFactorGraph graph = graph_builder_.dynamicsFactorGraph(robot, k);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const bool actuated =
+        std::any_of(actuators_.begin(), actuators_.end(),
+                    [j](const ActuatorParams &a) { return a.j == j; });
+    if (!actuated) {
+      graph.emplace_shared<gtsam::PriorFactor<double>>(
+          TorqueKey(j, k), 0.0, graph_builder_.opt().t_cost_model);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::dynamicsGraph(const Robot &robot,
+                                                             int k) const {
+  NonlinearFactorGraph graph = actuationDynamicsGraph(k);
+  graph.push_back(robotDynamicsGraph(robot, k));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::actuationCollocationGraph(
+    const std::vector<int> &step_phases) const {
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k < step_phases.size(); k++) {
+    const gtsam::Key dt_key = PhaseKey(step_phases[k]);
+
+    // Collocation on the mass of air in each actuator.
+    gtsam::KeyVector mdot_prev_keys, mdot_curr_keys;
+    for (const ActuatorParams &actuator : actuators_) {
+      const int j = actuator.j;
+      mdot_prev_keys.push_back(Keys::MassRateActualKey(j, k));
+      mdot_curr_keys.push_back(Keys::MassRateActualKey(j, k + 1));
+      DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+          &graph, Keys::MassKey(j, k), Keys::MassKey(j, k + 1),
+          mdot_prev_keys.back(), mdot_curr_keys.back(), dt_key,
+          models_.mass_collocation, Trapezoidal);
+    }
+
+    // Collocation on the mass of air in the tank.
+    AddSourceMassCollocationFactor(&graph, mdot_prev_keys, mdot_curr_keys,
+                                   Keys::SourceMassKey(k),
+                                   Keys::SourceMassKey(k + 1), dt_key, false,
+                                   models_.mass_collocation);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::robotCollocationGraph(
+    const Robot &robot, const std::vector<int> &step_phases) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  const int i = robot.link(torso_name_)->id();
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k < step_phases.size(); k++) {
+    const int phase = step_phases[k];
+
+    // In the air, the actuated joints are integrated too.
+    if (phase == 3) {
+      for (const ActuatorParams &actuator : actuators_) {
+        graph.push_back(graph_builder_.jointMultiPhaseCollocationFactors(
+            actuator.j, k, phase, Trapezoidal));
+      }
+    }
+
+    graph.emplace_shared<TrapezoidalPoseCollocationFactor>(
+        PoseKey(i, k), PoseKey(i, k + 1), TwistKey(i, k), TwistKey(i, k + 1),
+        PhaseKey(phase), opt.pose_col_cost_model);
+    graph.emplace_shared<TrapezoidalTwistCollocationFactor>(
+        TwistKey(i, k), TwistKey(i, k + 1), TwistAccelKey(i, k),
+        TwistAccelKey(i, k + 1), PhaseKey(phase), opt.twist_col_cost_model);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::collocationGraph(
+    const Robot &robot, const std::vector<int> &step_phases) const {
+  NonlinearFactorGraph graph = actuationCollocationGraph(step_phases);
+  graph.push_back(robotCollocationGraph(robot, step_phases));
+  for (size_t k = 0; k < step_phases.size(); k++) {
+    AddTimeCollocationFactor(&graph, TimeKey(k), TimeKey(k + 1),
+                             PhaseKey(step_phases[k]),
+                             graph_builder_.opt().time_cost_model);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::trajectoryGraph(
+    const std::vector<int> &step_phases) const {
+  if (step_phases.empty()) {
+    throw std::invalid_argument(
+        "JumpingRobotGraphBuilder: trajectoryGraph needs at least one step.");
+  }
+  auto robot = [this](int phase) -> const Robot & {
+    auto it = phase_robots_.find(phase);
+    if (it == phase_robots_.end()) {
+      throw std::invalid_argument(
+          "JumpingRobotGraphBuilder: no robot for phase " +
+          std::to_string(phase) + ".");
+    }
+    return it->second;
+  };
+
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k <= step_phases.size(); k++) {
+    const int phase = step_phases[k > 0 ? k - 1 : 0];
+    graph.push_back(dynamicsGraph(robot(phase), k));
+  }
+  graph.push_back(collocationGraph(robot(step_phases[0]), step_phases));
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.h
+ * @brief Factor graphs for trajectory optimization of the jumping robot.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/jumpingrobot/simulator/PneumaticActuatorModel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Noise models of the actuation factors, as in actuation_graph_builder.py.
+struct ActuationCostModels {
+  gtsam::SharedNoiseModel force, balance, torque, gas_law, mass_rate, volume,
+      mass_collocation;
+
+  ActuationCostModels();
+};
+
+/**
+ * JumpingRobotGraphBuilder is the C++ counterpart of jr_graph_builder.py,
+ * actuation_graph_builder.py and robot_graph_builder.py: it creates the
+ * dynamics graph of the robot, actuators and source tank at each time step,
+ * and the collocation graph between time steps, with the keys of
+ * JumpingRobotSimulator. Python then only provides the parameters, instead of
+ * looping over the factors.
+ *
+ * Contact phases are numbered as in jumping_robot.py: 0 on the ground, 1 and
+ * 2 on the left or right foot, and 3 in the air. In the air, collocation
+ * also integrates the angles of the actuated joints; on the ground the torso
+ * alone determines the next step. Joints without an actuator, e.g. the feet,
+ * have zero torque.
+ */
+class JumpingRobotGraphBuilder {
+ private:
+  DynamicsGraph graph_builder_;
+  std::vector<ActuatorParams> actuators_;
+  PneumaticParams pneumatic_;
+  std::string torso_name_;
+  ActuationCostModels models_;
+  std::map<int, Robot> phase_robots_;
+
+ public:
+  /**
+   * Constructor.
+   * @param graph_builder  builder of the robot dynamics graph, e.g.
+   *                       DefaultGraphBuilder()
+   * @param actuators      actuators, by joint
+   * @param pneumatic      parameters of the pneumatic system
+   * @param torso_name     link whose pose and twist are collocated
+   * @param models         noise models of the actuation factors
+   */
+  JumpingRobotGraphBuilder(
+      const DynamicsGraph &graph_builder,
+      const std::vector<ActuatorParams> &actuators,
+      const PneumaticParams &pneumatic = PneumaticParams(),
+      const std::string &torso_name = "torso",
+      const ActuationCostModels &models = ActuationCostModels());
+
+  /// Builder with the noise models of robot_graph_builder.py.
+  static DynamicsGraph DefaultGraphBuilder();
+
+  /// Robot of a contact phase, used by trajectoryGraph.
+  void setPhaseRobot(int phase, const Robot &robot) {
+    phase_robots_.insert_or_assign(phase, robot);
+  }
+
+  /// @name Dynamics at one time step.
+  ///@{
+
+  /// Gas law of the source tank at step k.
+  gtsam::NonlinearFactorGraph sourceDynamicsGraph(int k) const;
+
+  /// Gas law, volume, force and torque of actuator a at step k.
+  gtsam::NonlinearFactorGraph actuatorDynamicsGraph(size_t a, int k) const;
+
+  /// Mass flow from the tank through the valve of actuator a at step k.
+  gtsam::NonlinearFactorGraph massFlowGraph(size_t a, int k) const;
+
+  /// Source and actuator dynamics at step k, as ActuationGraphBuilder.
+  gtsam::NonlinearFactorGraph actuationDynamicsGraph(int k) const;
+
+  /// Robot dynamics at step k, with zero torque on joints without actuator.
+  gtsam::NonlinearFactorGraph robotDynamicsGraph(const Robot &robot,
+                                                 int k) const;
+
+  /// Actuation and robot dynamics at step k.
+  gtsam::NonlinearFactorGraph dynamicsGraph(const Robot &robot, int k) const;
+  ///@}
+
+  /// @name Collocation between time steps k and k + 1, for step_phases[k].
+  ///@{
+
+  /// Collocation on the mass of air in the actuators and the tank.
+  gtsam::NonlinearFactorGraph actuationCollocationGraph(
+      const std::vector<int> &step_phases) const;
+
+  /// Collocation on the torso and, in the air, on the actuated joints.
+  gtsam::NonlinearFactorGraph robotCollocationGraph(
+      const Robot &robot, const std::vector<int> &step_phases) const;
+
+  /// Actuation, robot and time collocation.
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const Robot &robot, const std::vector<int> &step_phases) const;
+  ///@}
+
+  /**
+   * Dynamics at all steps 0 to N, and collocation between them, for N =
+   * step_phases.size(). Step 0 has the robot of step_phases[0], and step k > 0
+   * the robot of step_phases[k - 1], see setPhaseRobot; throws
+   * std::invalid_argument if a phase has no robot.
+   */
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+
+  /// Builder of the robot dynamics graph.
+  const DynamicsGraph &graphBuilder() const { return graph_builder_; }
+};
+
+}  // namespace gtdynamics
@@ -51,6 +51,14 @@ class SmoothActuatorFactor: gtsam::NonlinearFactor{
                           const gtsam::noiseModel::Base *cost_model);
 };
 
+class SmoothActuatorsFactor: gtsam::NonlinearFactor{
+  SmoothActuatorsFactor(const gtsam::KeyVector &delta_x_keys,
+                        const gtsam::KeyVector &p_keys,
+                        const gtsam::KeyVector &f_keys,
+                        const gtsam::noiseModel::Base *row_model);
+  size_t numSteps() const;
+};
+
 class ForceBalanceFactor: gtsam::NonlinearFactor{
   ForceBalanceFactor(gtsam::Key delta_x_key, gtsam::Key q_key, gtsam::Key f_key,
                      const gtsam::noiseModel::Base *cost_model,
@@ -87,4 +95,115 @@ void AddTimeCollocationFactor(
   gtsam::Key t_prev_key, gtsam::Key t_curr_key, gtsam::Key dt_key,
   const gtsam::noiseModel::Base *cost_model);
 
+/****************************************** Simulator ******************************************/
+
+#include <gtdynamics/jumpingrobot/simulator/PneumaticActuatorModel.h>
+class PneumaticParams {
+  PneumaticParams();
+  double gas_constant;
+  double d_tube;
+  double l_tube;
+  double mu_tube;
+  double eps_tube;
+  double time_constant_valve;
+  double source_volume;
+};
+
+class ActuatorParams {
+  ActuatorParams();
+  int j;
+  bool positive;
+  double k_tendon;
+  double k_anta;
+  double q_anta_limit;
+  double b;
+  double radius;
+  double q_rest;
+  double valve_open;
+  double valve_close;
+};
+
+class ActuatorState {
+  double pressure;
+  double volume;
+  double contraction;
+  double force;
+  double torque;
+};
+
+class PneumaticActuatorModel {
+  PneumaticActuatorModel(const gtdynamics::ActuatorParams &actuator,
+                         const gtdynamics::PneumaticParams &pneumatic);
+  double volume(double contraction) const;
+  double pressure(double mass, double volume) const;
+  gtdynamics::ActuatorState evaluate(double mass, double q, double v,
+                                     double contraction) const;
+  gtdynamics::ActuatorState evaluate(double mass, double q, double v) const;
+};
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+class JumpingRobotSimulator {
+  JumpingRobotSimulator(const gtdynamics::Robot &robot,
+                        const gtdynamics::DynamicsGraph &graph_builder,
+                        const std::vector<gtdynamics::ActuatorParams> &actuators,
+                        const gtdynamics::PneumaticParams &pneumatic,
+                        const string &torso_name);
+  void reset(const gtsam::Values &initial, double source_pressure,
+             double actuator_mass, size_t max_steps);
+  void setRobot(const gtdynamics::Robot &robot);
+  void step(double dt);
+  void simulate(const gtsam::Values &initial, double source_pressure,
+                double actuator_mass, size_t num_steps, double dt);
+  size_t numSteps() const;
+  const gtdynamics::TrajectoryValues &robotTrajectory() const;
+  gtsam::Values values() const;
+};
+
+/****************************************** Graphs ******************************************/
+
+#include <gtdynamics/jumpingrobot/graph/JumpingRobotGraphBuilder.h>
+class ActuationCostModels {
+  ActuationCostModels();
+  gtsam::noiseModel::Base* force;
+  gtsam::noiseModel::Base* balance;
+  gtsam::noiseModel::Base* torque;
+  gtsam::noiseModel::Base* gas_law;
+  gtsam::noiseModel::Base* mass_rate;
+  gtsam::noiseModel::Base* volume;
+  gtsam::noiseModel::Base* mass_collocation;
+};
+
+class JumpingRobotGraphBuilder {
+  JumpingRobotGraphBuilder(
+      const gtdynamics::DynamicsGraph &graph_builder,
+      const std::vector<gtdynamics::ActuatorParams> &actuators,
+      const gtdynamics::PneumaticParams &pneumatic, const string &torso_name,
+      const gtdynamics::ActuationCostModels &models);
+  JumpingRobotGraphBuilder(
+      const gtdynamics::DynamicsGraph &graph_builder,
+      const std::vector<gtdynamics::ActuatorParams> &actuators,
+      const gtdynamics::PneumaticParams &pneumatic, const string &torso_name);
+  static gtdynamics::DynamicsGraph DefaultGraphBuilder();
+  void setPhaseRobot(int phase, const gtdynamics::Robot &robot);
+  gtsam::NonlinearFactorGraph sourceDynamicsGraph(int k) const;
+  gtsam::NonlinearFactorGraph actuatorDynamicsGraph(size_t a, int k) const;
+  gtsam::NonlinearFactorGraph massFlowGraph(size_t a, int k) const;
+  gtsam::NonlinearFactorGraph actuationDynamicsGraph(int k) const;
+  gtsam::NonlinearFactorGraph robotDynamicsGraph(const gtdynamics::Robot &robot,
+                                                 int k) const;
+  gtsam::NonlinearFactorGraph dynamicsGraph(const gtdynamics::Robot &robot,
+                                            int k) const;
+  gtsam::NonlinearFactorGraph actuationCollocationGraph(
+      const std::vector<int> &step_phases) const;
+  gtsam::NonlinearFactorGraph robotCollocationGraph(
+      const gtdynamics::Robot &robot,
+      const std::vector<int> &step_phases) const;
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const gtdynamics::Robot &robot,
+      const std::vector<int> &step_phases) const;
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+  const gtdynamics::DynamicsGraph &graphBuilder() const;
+};
+
 }  // namespace gtdynamics
@@ -0,0 +1,401 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSimulator.cpp
+ * @brief Simulate the pneumatic jumping robot step by step.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::PriorFactor;
+using gtsam::Values;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Noise model of actuation_graph_builder.py.
+const auto kMassRateModel = Isotropic::Sigma(1, 1e-5);
+
+/// Largest error of a converged step solve, as in jr_simulator.py.
+constexpr double kErrorThreshold = 1e-5;
+
+/// Values of the keys of a graph, to warm-start it.
+Values GraphValues(const NonlinearFactorGraph &graph, const Values &values) {
+  Values extracted;
+  for (Key key : graph.keys()) extracted.insert(key, values.at(key));
+  return extracted;
+}
+
+/// Insert or update a value.
+template <typename T>
+void Set(Values *values, Key key, const T &value) {
+  values->insert_or_assign(key, value);
+}
+
+/// Solve a step graph, throwing if it does not converge.
+Values Solve(const NonlinearFactorGraph &graph, const Values &init,
+             const gtsam::LevenbergMarquardtParams &params,
+             const std::string &name) {
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(graph, init, params).optimize();
+  if (graph.error(result) > kErrorThreshold) {
+    throw std::runtime_error("JumpingRobotSimulator: " + name +
+                             " dynamics does not converge.");
+  }
+  return result;
+}
+
+/// Size of vectors indexed by joint id.
+size_t NumJointIds(const Robot &robot) {
+  size_t n = 0;
+  for (auto &&joint : robot.joints()) n = std::max<size_t>(n, joint->id() + 1);
+  return n;
+}
+
+/// Size of vectors indexed by link id.
+size_t NumLinkIds(const Robot &robot) {
+  size_t n = 0;
+  for (auto &&link : robot.links()) n = std::max<size_t>(n, link->id() + 1);
+  return n;
+}
+
+bool HasGround(const Robot &robot) {
+  for (auto &&link : robot.links()) {
+    if (link->name() == "ground") return true;
+  }
+  return false;
+}
+}  // namespace
+
+/* ************************************************************************* */
+JumpingRobotSimulator::JumpingRobotSimulator(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const std::vector<ActuatorParams> &actuators,
+    const PneumaticParams &pneumatic, const std::string &torso_name)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      actuators_(actuators),
+      pneumatic_(pneumatic),
+      torso_name_(torso_name),
+      robot_trajectory_(0, NumJointIds(robot), NumLinkIds(robot)) {
+  buildGraphs();
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::buildGraphs() {
+  actuator_models_.clear();
+  for (const ActuatorParams &actuator : actuators_) {
+    actuator_models_.emplace_back(actuator, pneumatic_);
+  }
+
+  // Joints without an actuator, e.g. the feet, apply no torque.
+  const OptimizerSetting &opt = graph_builder_.opt();
+  robot_graph_ = graph_builder_.dynamicsFactorGraph(robot_, 0);
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    const bool actuated =
+        std::any_of(actuators_.begin(), actuators_.end(),
+                    [j](const ActuatorParams &a) { return a.j == j; });
+    if (!actuated) {
+      robot_graph_.emplace_shared<PriorFactor<double>>(TorqueKey(j), 0.0,
+                                                       opt.t_cost_model);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::reset(const Values &initial,
+                                  double source_pressure, double actuator_mass,
+                                  size_t max_steps) {
+  k_ = 0;
+  robot_trajectory_ =
+      TrajectoryValues(max_steps, NumJointIds(robot_), NumLinkIds(robot_));
+
+  const size_t A = actuators_.size();
+  ActuatorTrajectory &at = actuator_trajectory_;
+  for (gtsam::Matrix *m : {&at.mass, &at.pressure, &at.volume,
+                           &at.contraction, &at.force, &at.torque,
+                           &at.mass_rate_open, &at.mass_rate}) {
+    m->setZero(max_steps, A);
+  }
+  for (gtsam::Vector *v : {&at.source_mass, &at.source_pressure, &at.time}) {
+    v->setZero(max_steps);
+  }
+  if (max_steps > 0) {
+    at.mass.row(0).setConstant(actuator_mass);
+    at.source_mass(0) = pneumatic_.source_volume * source_pressure * 1e3 /
+                        pneumatic_.gas_constant;
+  }
+
+  known_ = Values();
+  const int torso = robot_.link(torso_name_)->id();
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known_, j, JointAngle(initial, j));
+    InsertJointVel(&known_, j, JointVel(initial, j));
+  }
+  InsertPose(&known_, torso, Pose(initial, torso));
+  InsertTwist(&known_, torso, Twist(initial, torso));
+
+  robot_solution_ = Values();
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::setRobot(const Robot &robot) {
+  if (NumJointIds(robot) > robot_trajectory_.numJoints() ||
+      NumLinkIds(robot) > robot_trajectory_.numLinks()) {
+    throw std::invalid_argument(
+        "JumpingRobotSimulator: the robot has joint or link ids beyond those "
+        "of the robot at reset.");
+  }
+  robot_ = robot;
+  buildGraphs();
+
+  // Joints and links of the new robot start from the last step.
+  Values solution = robot_solution_;
+  robot_solution_ = Values();
+  for (Key key : robot_graph_.keys()) {
+    if (solution.exists(key)) robot_solution_.insert(key, solution.at(key));
+  }
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::step(double dt) {
+  if (k_ >= robot_trajectory_.numSteps()) {
+    throw std::out_of_range(
+        "JumpingRobotSimulator: all allocated time steps are simulated.");
+  }
+  if (k_ > 0) integrate(dt);
+  actuationDynamics();
+  robotDynamics();
+  k_++;
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::simulate(const Values &initial,
+                                     double source_pressure,
+                                     double actuator_mass, size_t num_steps,
+                                     double dt) {
+  reset(initial, source_pressure, actuator_mass, num_steps);
+  for (size_t k = 0; k < num_steps; k++) step(dt);
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::integrate(double dt) {
+  const size_t k = k_, p = k_ - 1;
+  const TrajectoryValues &trajectory = robot_trajectory_;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    const double q = trajectory.q(j, p), v = trajectory.v(j, p),
+                 a = trajectory.a(j, p);
+    Set(&known_, JointAngleKey(j), q + v * dt + 0.5 * a * dt * dt);
+    Set(&known_, JointVelKey(j), v + a * dt);
+  }
+
+  const int torso = robot_.link(torso_name_)->id();
+  const Pose3 &pose = trajectory.pose(torso, p);
+  const Vector6 &twist = trajectory.twist(torso, p);
+  const Vector6 &twist_accel = trajectory.twistAccel(torso, p);
+  Set(&known_, PoseKey(torso),
+      pose.compose(Pose3::Expmap(dt * twist + 0.5 * dt * dt * twist_accel)));
+  Set<Vector6>(&known_, TwistKey(torso), twist + dt * twist_accel);
+
+  ActuatorTrajectory &at = actuator_trajectory_;
+  at.mass.row(k) = at.mass.row(p) + dt * at.mass_rate.row(p);
+  at.source_mass(k) = at.source_mass(p) - dt * at.mass_rate.row(p).sum();
+  at.time(k) = at.time(p) + dt;
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::actuationDynamics() {
+  const size_t k = k_;
+  ActuatorTrajectory &at = actuator_trajectory_;
+  const double P_s = at.source_mass(k) * pneumatic_.gas_constant /
+                     pneumatic_.source_volume / 1e3;
+  at.source_pressure(k) = P_s;
+
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const ActuatorParams &actuator = actuators_[a];
+    const int j = actuator.j;
+    const double q = JointAngle(known_, j), v = JointVel(known_, j);
+
+    // Start from the contraction of the last step.
+    const double guess = k > 0 ? at.contraction(k - 1, a) : 0.0;
+    const ActuatorState state =
+        actuator_models_[a].evaluate(at.mass(k, a), q, v, guess);
+    at.pressure(k, a) = state.pressure;
+    at.volume(k, a) = state.volume;
+    at.contraction(k, a) = state.contraction;
+    at.force(k, a) = state.force;
+    at.torque(k, a) = state.torque;
+
+    // Air flows from the tank through the valve.
+    const ValveControlFactor valve(
+        TimeKey(0), ValveOpenTimeKey(j), ValveCloseTimeKey(j),
+        MassRateOpenKey(j, 0), MassRateActualKey(j, 0), kMassRateModel,
+        pneumatic_.time_constant_valve);
+    const double mdot = massFlow(at.pressure(k, a), P_s);
+    at.mass_rate_open(k, a) = mdot;
+    at.mass_rate(k, a) = valve.computeExpectedTrueMassFlow(
+        at.time(k), actuator.valve_open, actuator.valve_close, mdot);
+  }
+}
+
+/* ************************************************************************* */
+double JumpingRobotSimulator::massFlow(double p_actuator,
+                                       double p_source) const {
+  if (p_actuator == p_source) return 0.0;
+  const MassFlowRateFactor factor(
+      0, 1, 2, kMassRateModel, pneumatic_.d_tube, pneumatic_.l_tube,
+      pneumatic_.mu_tube, pneumatic_.eps_tube, 1.0 / pneumatic_.gas_constant);
+
+  // The flow is a fixed point of the model: Newton's method on its residual,
+  // from the initial estimate of jr_values.py.
+  double mdot = 0.007;
+  gtsam::Matrix H;
+  for (int i = 0; i < 50; i++) {
+    const double residual =
+        factor.computeExpectedMassFlow(p_actuator, p_source, mdot, nullptr,
+                                       nullptr, &H) -
+        mdot;
+    if (std::abs(residual) < 1e-12) break;
+    mdot -= residual / (H(0, 0) - 1.0);
+  }
+  return mdot;
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::robotDynamics() {
+  const size_t k = k_;
+  const OptimizerSetting &opt = graph_builder_.opt();
+  const int torso = robot_.link(torso_name_)->id();
+  const bool ground = HasGround(robot_);
+
+  // Priors on the actuator torques, and on the integrated states.
+  NonlinearFactorGraph graph = robot_graph_;
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const int j = actuators_[a].j;
+    graph.emplace_shared<PriorFactor<double>>(
+        TorqueKey(j), actuator_trajectory_.torque(k, a),
+        opt.prior_t_cost_model);
+  }
+  graph.emplace_shared<PriorFactor<Pose3>>(
+      PoseKey(torso), Pose(known_, torso), opt.p_cost_model);
+  graph.emplace_shared<PriorFactor<Vector6>>(
+      TwistKey(torso), Twist(known_, torso), opt.v_cost_model);
+  if (!ground) {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      graph.emplace_shared<PriorFactor<double>>(
+          JointAngleKey(j), JointAngle(known_, j), opt.prior_q_cost_model);
+      graph.emplace_shared<PriorFactor<double>>(
+          JointVelKey(j), JointVel(known_, j), opt.prior_v_cost_model);
+    }
+  }
+
+  // Start from forward kinematics, or from the last step.
+  Values init;
+  if (robot_solution_.empty()) {
+    std::optional<std::string> root;
+    if (!ground) root = torso_name_;
+    init = robot_.forwardKinematics(known_, 0, root);
+    for (auto &&link : robot_.links()) {
+      InsertTwistAccel(&init, link->id(), Vector6::Zero());
+    }
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertJointAccel(&init, j, 0.0);
+      InsertTorque(&init, j, 0.0);
+      InsertWrench(&init, joint->parent()->id(), j, Vector6::Zero());
+      InsertWrench(&init, joint->child()->id(), j, Vector6::Zero());
+    }
+  } else {
+    init = robot_solution_;
+  }
+  for (Key key : known_.keys()) init.insert_or_assign(key, known_.at(key));
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const int j = actuators_[a].j;
+    Set(&init, TorqueKey(j), actuator_trajectory_.torque(k, a));
+  }
+  robot_solution_ =
+      Solve(graph, GraphValues(graph, init), lm_params_, "robot");
+
+  // Record the step.
+  TrajectoryValues &trajectory = robot_trajectory_;
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    trajectory.q(j, k) = JointAngle(robot_solution_, j);
+    trajectory.v(j, k) = JointVel(robot_solution_, j);
+    trajectory.a(j, k) = JointAccel(robot_solution_, j);
+    trajectory.torque(j, k) = Torque(robot_solution_, j);
+  }
+  for (auto &&link : robot_.links()) {
+    const int i = link->id();
+    trajectory.pose(i, k) = Pose(robot_solution_, i);
+    trajectory.twist(i, k) = Twist(robot_solution_, i);
+    trajectory.twistAccel(i, k) = TwistAccel(robot_solution_, i);
+  }
+}
+
+/* ************************************************************************* */
+Values JumpingRobotSimulator::values() const {
+  Values values;
+  const TrajectoryValues &trajectory = robot_trajectory_;
+  const ActuatorTrajectory &at = actuator_trajectory_;
+  for (size_t k = 0; k < k_; k++) {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, k, trajectory.q(j, k));
+      InsertJointVel(&values, j, k, trajectory.v(j, k));
+      InsertJointAccel(&values, j, k, trajectory.a(j, k));
+      InsertTorque(&values, j, k, trajectory.torque(j, k));
+    }
+    for (auto &&link : robot_.links()) {
+      const int i = link->id();
+      InsertPose(&values, i, k, trajectory.pose(i, k));
+      InsertTwist(&values, i, k, trajectory.twist(i, k));
+      InsertTwistAccel(&values, i, k, trajectory.twistAccel(i, k));
+    }
+    for (size_t a = 0; a < actuators_.size(); a++) {
+      const int j = actuators_[a].j;
+      values.insert(MassKey(j, k), at.mass(k, a));
+      values.insert(PressureKey(j, k), at.pressure(k, a));
+      values.insert(VolumeKey(j, k), at.volume(k, a));
+      values.insert(ContractionKey(j, k), at.contraction(k, a));
+      values.insert(ForceKey(j, k), at.force(k, a));
+      values.insert(MassRateOpenKey(j, k), at.mass_rate_open(k, a));
+      values.insert(MassRateActualKey(j, k), at.mass_rate(k, a));
+    }
+    values.insert(SourceMassKey(k), at.source_mass(k));
+    values.insert(SourcePressureKey(k), at.source_pressure(k));
+    values.insert(TimeKey(k), at.time(k));
+  }
+  values.insert(SourceVolumeKey(), pneumatic_.source_volume);
+  for (const ActuatorParams &actuator : actuators_) {
+    values.insert(ValveOpenTimeKey(actuator.j), actuator.valve_open);
+    values.insert(ValveCloseTimeKey(actuator.j), actuator.valve_close);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSimulator.h
+ * @brief Simulate the pneumatic jumping robot step by step.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/jumpingrobot/simulator/PneumaticActuatorModel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryValues.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JumpingRobotSimulator is the C++ counterpart of jr_simulator.py, for one
+ * contact phase. Each step integrates the previous step, solves the dynamics
+ * of every actuator and then the dynamics of the robot, as the Python
+ * simulator does, but:
+ *  - the actuators are evaluated by PneumaticActuatorModel, in closed form;
+ *  - the robot graph is built once, with time step 0 keys, and only its
+ *    priors change from step to step;
+ *  - each solve is warm-started from the solution of the previous step;
+ *  - the states of all steps go into buffers allocated by reset(), instead of
+ *    a growing gtsam::Values.
+ *
+ * Joints without an actuator, e.g. the feet, have zero torque. On a change of
+ * contact phase, give the robot of the new phase to setRobot().
+ */
+class JumpingRobotSimulator {
+ public:
+  /// @name Keys of the pneumatic variables, as in jumping_robot.py.
+  ///@{
+  static gtsam::Key PressureKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("Pa", j, t);
+  }
+  static gtsam::Key SourcePressureKey(int t) {
+    return DynamicsSymbol::SimpleSymbol("Ps", t);
+  }
+  static gtsam::Key ContractionKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("dx", j, t);
+  }
+  static gtsam::Key ForceKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("fa", j, t);
+  }
+  static gtsam::Key MassKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("ma", j, t);
+  }
+  static gtsam::Key SourceMassKey(int t) {
+    return DynamicsSymbol::SimpleSymbol("ms", t);
+  }
+  static gtsam::Key MassRateOpenKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("mo", j, t);
+  }
+  static gtsam::Key MassRateActualKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("md", j, t);
+  }
+  static gtsam::Key VolumeKey(int j, int t) {
+    return DynamicsSymbol::JointSymbol("Va", j, t);
+  }
+  static gtsam::Key SourceVolumeKey() {
+    return DynamicsSymbol::SimpleSymbol("Vs", 0);
+  }
+  static gtsam::Key ValveOpenTimeKey(int j) {
+    return DynamicsSymbol::JointSymbol("To", j, 0);
+  }
+  static gtsam::Key ValveCloseTimeKey(int j) {
+    return DynamicsSymbol::JointSymbol("Tc", j, 0);
+  }
+  ///@}
+
+  /// States of the actuators, one row per time step, one column per actuator.
+  struct ActuatorTrajectory {
+    gtsam::Matrix mass, pressure, volume, contraction, force, torque,
+        mass_rate_open, mass_rate;
+    gtsam::Vector source_mass, source_pressure, time;
+  };
+
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  std::vector<ActuatorParams> actuators_;
+  PneumaticParams pneumatic_;
+  std::string torso_name_;
+  gtsam::LevenbergMarquardtParams lm_params_;
+
+  std::vector<PneumaticActuatorModel> actuator_models_;
+
+  // Graph without priors, with time step 0 keys.
+  gtsam::NonlinearFactorGraph robot_graph_;
+
+  // Known joint and torso states of the current step, with time step 0 keys.
+  gtsam::Values known_;
+
+  // Solution of the last step, also with time step 0 keys.
+  gtsam::Values robot_solution_;
+
+  size_t k_ = 0;
+  TrajectoryValues robot_trajectory_;
+  ActuatorTrajectory actuator_trajectory_;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot          robot of the first contact phase
+   * @param graph_builder  builder of the robot dynamics graph, whose
+   *                       settings, gravity and planar axis are used
+   * @param actuators      actuators, by joint
+   * @param pneumatic      parameters of the pneumatic system
+   * @param torso_name     link whose pose and twist are integrated
+   */
+  JumpingRobotSimulator(const Robot &robot, const DynamicsGraph &graph_builder,
+                        const std::vector<ActuatorParams> &actuators,
+                        const PneumaticParams &pneumatic = PneumaticParams(),
+                        const std::string &torso_name = "torso");
+
+  /**
+   * Restart from an initial state, and allocate the buffers.
+   * @param initial          joint angles and velocities, and the pose and
+   *                         twist of the torso, at time step 0
+   * @param source_pressure  initial tank pressure (kPa)
+   * @param actuator_mass    initial mass of air in each actuator (kg)
+   * @param max_steps        number of time steps to allocate
+   */
+  void reset(const gtsam::Values &initial, double source_pressure,
+             double actuator_mass, size_t max_steps);
+
+  /// Robot of a new contact phase, keeping the state.
+  void setRobot(const Robot &robot);
+
+  /// Simulate the next time step, integrating the last one over dt.
+  void step(double dt);
+
+  /// Reset, then simulate num_steps time steps of duration dt.
+  void simulate(const gtsam::Values &initial, double source_pressure,
+                double actuator_mass, size_t num_steps, double dt);
+
+  /// Number of simulated time steps.
+  size_t numSteps() const { return k_; }
+
+  /// Joint and link states, allocated for max_steps time steps.
+  const TrajectoryValues &robotTrajectory() const { return robot_trajectory_; }
+
+  /// Actuator states, allocated for max_steps time steps.
+  const ActuatorTrajectory &actuatorTrajectory() const {
+    return actuator_trajectory_;
+  }
+
+  /// All states of the simulated steps, with the keys of jr_values.py.
+  gtsam::Values values() const;
+
+ private:
+  void buildGraphs();
+  void integrate(double dt);
+  void actuationDynamics();
+  void robotDynamics();
+  double massFlow(double p_actuator, double p_source) const;
+};
+
+}  // namespace gtdynamics
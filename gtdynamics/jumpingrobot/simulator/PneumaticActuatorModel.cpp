@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PneumaticActuatorModel.cpp
+ * @brief Evaluate a pneumatic actuator without solving a factor graph.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/jumpingrobot/simulator/PneumaticActuatorModel.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+// The factors are only evaluated, so their keys and noise are arbitrary.
+const auto kUnit = gtsam::noiseModel::Unit::Create(1);
+}  // namespace
+
+/* ************************************************************************* */
+PneumaticActuatorModel::PneumaticActuatorModel(
+    const ActuatorParams &actuator, const PneumaticParams &pneumatic)
+    : gas_constant_(pneumatic.gas_constant),
+      volume_(0, 1, kUnit, pneumatic.d_tube, pneumatic.l_tube),
+      actuator_(0, 1, 2, kUnit),
+      balance_(0, 1, 2, kUnit, actuator.k_tendon, actuator.radius,
+               actuator.q_rest, actuator.positive),
+      torque_(0, 1, 2, 3, kUnit, actuator.q_anta_limit, actuator.k_anta,
+              actuator.radius, actuator.b, actuator.positive) {}
+
+/* ************************************************************************* */
+ActuatorState PneumaticActuatorModel::evaluate(double mass, double q, double v,
+                                               double contraction) const {
+  ActuatorState state;
+  gtsam::Matrix H_V_x, H_fa_x, H_fa_p, H_fb_x;
+
+  // Bracket of the root, once the residual has changed sign.
+  double lo = -std::numeric_limits<double>::infinity();
+  double hi = std::numeric_limits<double>::infinity();
+
+  double x = contraction;
+  for (int i = 0;; i++) {
+    // Force of the muscle at the pressure of x, minus that of the tendon.
+    const double V = volume_.computeVolume(x, &H_V_x);
+    const double p = pressure(mass, V);
+    const double f_actuator =
+        actuator_.evaluateError(x, p, 0.0, &H_fa_x, &H_fa_p)(0);
+    const double f_balance = balance_.evaluateError(x, q, 0.0, &H_fb_x)(0);
+    const double residual = f_actuator - f_balance;
+
+    state.contraction = x;
+    state.volume = V;
+    state.pressure = p;
+    state.force = f_balance;
+    if (std::abs(residual) < kTolerance) break;
+    if (i == kMaxIterations) {
+      throw std::runtime_error(
+          "PneumaticActuatorModel: contraction does not converge.");
+    }
+
+    // The residual decreases with x, as the tendon force increases with it.
+    if (residual > 0) {
+      lo = x;
+    } else {
+      hi = x;
+    }
+    const double dp_dx = -p / V * H_V_x(0, 0);
+    const double slope = H_fa_x(0, 0) + H_fa_p(0, 0) * dp_dx - H_fb_x(0, 0);
+    x -= residual / slope;
+
+    // Newton steps may cycle at the kinks of the force model: bisect.
+    if (!(x > lo && x < hi) && std::isfinite(lo) && std::isfinite(hi)) {
+      x = 0.5 * (lo + hi);
+    }
+  }
+
+  state.torque = torque_.evaluateError(q, v, state.force, 0.0)(0);
+  return state;
+}
+
+}  // namespace gtdynamics
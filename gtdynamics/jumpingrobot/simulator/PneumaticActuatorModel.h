@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PneumaticActuatorModel.h
+ * @brief Evaluate a pneumatic actuator without solving a factor graph.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+
+namespace gtdynamics {
+
+/// Parameters of the pneumatic system, see "pneumatic" in robot_config.yaml.
+struct PneumaticParams {
+  double gas_constant = 287.0550 * 296.15;  ///< Rs * T
+  double d_tube = 0.1575 * 0.0254;          ///< tube diameter (m)
+  double l_tube = 74 * 0.0254;              ///< tube length (m)
+  double mu_tube = 1.8377e-5;               ///< viscosity of air
+  double eps_tube = 1.0e-5;                 ///< tube roughness (m)
+  double time_constant_valve = 1.0e-3;      ///< valve time constant (s)
+  double source_volume = 1.475e-3;          ///< volume of the tank (m^3)
+};
+
+/// Parameters and valve controls of one actuator, see "knee" and "hip".
+struct ActuatorParams {
+  int j = 0;                ///< id of the actuated joint
+  bool positive = false;    ///< true for hips, false for knees
+  double k_tendon = 8200;   ///< tendon stiffness (N/m)
+  double k_anta = 2.5;      ///< stiffness of the antagonistic spring
+  double q_anta_limit = 0;  ///< engagement angle of the antagonistic spring
+  double b = 0.03;          ///< joint damping
+  double radius = 0.04;     ///< cam radius (m)
+  double q_rest = 0;        ///< joint angle at rest
+  double valve_open = 0;    ///< valve open time (s)
+  double valve_close = 1;   ///< valve close time (s)
+};
+
+/// State of an actuator, which satisfies all actuator factors.
+struct ActuatorState {
+  double pressure = 0;     ///< pressure in the actuator (kPa)
+  double volume = 0;       ///< volume of the actuator and its tube (m^3)
+  double contraction = 0;  ///< contraction (cm)
+  double force = 0;        ///< force on the tendon (N)
+  double torque = 0;       ///< torque on the joint (Nm)
+};
+
+/**
+ * PneumaticActuatorModel evaluates the actuator factors (GasLawFactor,
+ * ActuatorVolumeFactor, SmoothActuatorFactor, ForceBalanceFactor and
+ * JointTorqueFactor) as a forward computation: given the mass of air and the
+ * joint state, the contraction is the root of the difference between the
+ * force of the muscle and the force of the tendon, which Newton's method
+ * finds in a few iterations. Pressure, force and torque follow from it.
+ *
+ * The models of the factors are evaluated through the factors themselves,
+ * so their coefficients are not duplicated.
+ */
+class PneumaticActuatorModel {
+ private:
+  double gas_constant_;
+  ActuatorVolumeFactor volume_;
+  SmoothActuatorFactor actuator_;
+  ForceBalanceFactor balance_;
+  JointTorqueFactor torque_;
+
+ public:
+  /// Largest force residual (N) of a converged contraction.
+  static constexpr double kTolerance = 1e-9;
+
+  /// Largest number of Newton iterations.
+  static constexpr int kMaxIterations = 50;
+
+  /**
+   * Constructor.
+   * @param actuator   parameters of the actuator
+   * @param pneumatic  parameters of the pneumatic system
+   */
+  PneumaticActuatorModel(const ActuatorParams &actuator,
+                         const PneumaticParams &pneumatic);
+
+  /// Volume (m^3) at a contraction (cm).
+  double volume(double contraction) const {
+    return volume_.computeVolume(contraction);
+  }
+
+  /// Pressure (kPa) of a mass of air (kg) in a volume (m^3), by the gas law.
+  double pressure(double mass, double volume) const {
+    return gas_constant_ * mass / (1e3 * volume);
+  }
+
+  /**
+   * Find the state of the actuator, throwing if Newton's method does not
+   * converge.
+   * @param mass         mass of air in the actuator (kg)
+   * @param q            joint angle (rad)
+   * @param v            joint velocity (rad/s)
+   * @param contraction  initial estimate of the contraction (cm), e.g. that
+   *                     of the previous time step
+   */
+  ActuatorState evaluate(double mass, double q, double v,
+                         double contraction = 0) const;
+};
+
+}  // namespace gtdynamics
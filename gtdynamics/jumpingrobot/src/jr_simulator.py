@@ -408,6 +408,60 @@ class JRSimulator:
             step_phases.append(phase)
         return values, step_phases
 
+    def native_simulator(self, controls):
+        """ Create the C++ simulator of the ground phase, which solves the
+            same step graphs as `simulate`, for fast parameter sweeps.
+
+        Args:
+            controls (Dict): specify control variables
+
+        Returns:
+            gtd.JumpingRobotSimulator: simulator of the jumping robot
+        """
+        self.jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        pneumatic = gtd.PneumaticParams()
+        params = self.jr.params["pneumatic"]
+        pneumatic.gas_constant = self.jr.gas_constant
+        pneumatic.d_tube = params["d_tube_valve_musc"] * 0.0254
+        pneumatic.l_tube = params["l_tube_valve_musc"] * 0.0254
+        pneumatic.mu_tube = params["mu_tube"]
+        pneumatic.eps_tube = params["eps_tube"]
+        pneumatic.time_constant_valve = params["time_constant_valve"]
+        pneumatic.source_volume = params["v_source"]
+
+        actuators = []
+        for actuator in self.jr.actuators:
+            actuator_params = gtd.ActuatorParams()
+            actuator_params.j = actuator.j
+            actuator_params.positive = actuator.positive
+            actuator_params.k_tendon = actuator.config["k_tendon"]
+            actuator_params.k_anta = actuator.config["k_anta"]
+            actuator_params.q_anta_limit = actuator.config["q_anta_limit"]
+            actuator_params.b = actuator.config["b"]
+            actuator_params.radius = actuator.config["rad0"]
+            actuator_params.q_rest = self.init_config["qs_rest"][
+                actuator.name]
+            actuator_params.valve_open = controls["Tos"][actuator.name]
+            actuator_params.valve_close = controls["Tcs"][actuator.name]
+            actuators.append(actuator_params)
+
+        graph_builder = self.jr_graph_builder.robot_graph_builder.graph_builder
+        return gtd.JumpingRobotSimulator(self.jr.robot, graph_builder,
+                                         actuators, pneumatic, "torso")
+
+    def simulate_native(self, num_steps: int, dt: float, controls):
+        """ Simulate the ground phase with the C++ simulator.
+
+        Returns:
+            gtsam.Values: values for all steps, with the keys of `simulate`
+        """
+        simulator = self.native_simulator(controls)
+        values = JRValues.init_config_values(self.jr, controls)
+        simulator.simulate(values, controls["P_s_0"],
+                           self.jr.params["pneumatic"]["init_mass"],
+                           num_steps, dt)
+        return simulator.values()
+
 
 def example_simulate():
     """ Show an example robot jumping trajectory """
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJumpingRobotGraphBuilder.cpp
+ *  @brief Tests for the jumping robot graph builder.
+ *  @author Yetong Zhang
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/graph/JumpingRobotGraphBuilder.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+
+namespace {
+/// Two actuated joints of a fixed-base arm, with link_0 as torso.
+std::vector<ActuatorParams> Actuators() {
+  std::vector<ActuatorParams> actuators(2);
+  for (size_t a = 0; a < 2; a++) {
+    actuators[a].j = a;
+    actuators[a].positive = (a == 0);
+    actuators[a].valve_open = 1.0;
+    actuators[a].valve_close = 2.0;
+  }
+  return actuators;
+}
+}  // namespace
+
+/// Graph sizes, as in test_jr_graph_builder.py.
+TEST(JumpingRobotGraphBuilder, Sizes) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const DynamicsGraph graph_builder(simple_rr::gravity, simple_rr::planar_axis);
+  JumpingRobotGraphBuilder builder(graph_builder, Actuators(),
+                                   PneumaticParams(), "link_0");
+  const std::vector<int> step_phases{0, 0, 3, 3};
+
+  // Gas law of the tank, and 5 factors per actuator.
+  EXPECT_LONGS_EQUAL(1, builder.sourceDynamicsGraph(2).size());
+  EXPECT_LONGS_EQUAL(5, builder.actuatorDynamicsGraph(1, 2).size());
+  EXPECT_LONGS_EQUAL(2, builder.massFlowGraph(1, 2).size());
+  EXPECT_LONGS_EQUAL(11, builder.actuationDynamicsGraph(2).size());
+  THROWS_EXCEPTION(builder.actuatorDynamicsGraph(2, 2));
+
+  // Both joints are actuated, so no torque priors are added.
+  const NonlinearFactorGraph robot_graph = builder.robotDynamicsGraph(robot, 2);
+  EXPECT_LONGS_EQUAL(graph_builder.dynamicsFactorGraph(robot, 2).size(),
+                     robot_graph.size());
+  EXPECT_LONGS_EQUAL(11 + robot_graph.size(),
+                     builder.dynamicsGraph(robot, 2).size());
+
+  // Mass: (2 + 1) * 4, joints in the air: 2 * 2 * 2, torso: 2 * 4, time: 4.
+  EXPECT_LONGS_EQUAL(12, builder.actuationCollocationGraph(step_phases).size());
+  EXPECT_LONGS_EQUAL(16,
+                     builder.robotCollocationGraph(robot, step_phases).size());
+  const NonlinearFactorGraph collocation =
+      builder.collocationGraph(robot, step_phases);
+  EXPECT_LONGS_EQUAL(32, collocation.size());
+  const gtsam::KeySet keys = collocation.keys();
+  EXPECT(keys.count(JointAngleKey(1, 3)));
+  EXPECT(!keys.count(JointAngleKey(1, 1)));
+  EXPECT(keys.count(JumpingRobotSimulator::SourceMassKey(4)));
+
+  // Dynamics at the 5 steps, with the robot of each phase.
+  THROWS_EXCEPTION(builder.trajectoryGraph(step_phases));
+  builder.setPhaseRobot(0, robot);
+  builder.setPhaseRobot(3, robot);
+  EXPECT_LONGS_EQUAL(5 * (11 + robot_graph.size()) + 32,
+                     builder.trajectoryGraph(step_phases).size());
+}
+
+/// The simulated actuator states satisfy the actuation dynamics.
+TEST(JumpingRobotGraphBuilder, Simulation) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const DynamicsGraph graph_builder(simple_rr::gravity, simple_rr::planar_axis);
+  const JumpingRobotGraphBuilder builder(graph_builder, Actuators(),
+                                         PneumaticParams(), "link_0");
+  JumpingRobotSimulator simulator(robot, graph_builder, Actuators(),
+                                  PneumaticParams(), "link_0");
+
+  gtsam::Values initial;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&initial, joint->id(), 0.0);
+    InsertJointVel(&initial, joint->id(), 0.0);
+  }
+  InsertPose(&initial, 0, gtsam::Pose3());
+  InsertTwist(&initial, 0, gtsam::Vector6::Zero());
+  simulator.simulate(initial, 400.0, 7.873172488131229e-05, 3, 0.005);
+
+  const gtsam::Values values = simulator.values();
+  for (int k = 0; k < 3; k++) {
+    EXPECT_DOUBLES_EQUAL(0.0, builder.actuationDynamicsGraph(k).error(values),
+                         1e-4);
+    for (size_t a = 0; a < 2; a++) {
+      EXPECT_DOUBLES_EQUAL(0.0, builder.massFlowGraph(a, k).error(values),
+                           1e-4);
+    }
+  }
+}
+
+/* main function */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJumpingRobotSimulator.cpp
+ *  @brief Tests for the jumping robot simulator.
+ *  @author Yetong Zhang
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+
+/// Two actuated joints of a fixed-base arm, with closed valves.
+TEST(JumpingRobotSimulator, ClosedValves) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const DynamicsGraph graph_builder(simple_rr::gravity, simple_rr::planar_axis);
+
+  std::vector<ActuatorParams> actuators(2);
+  for (size_t a = 0; a < 2; a++) {
+    actuators[a].j = a;
+    actuators[a].positive = (a == 0);
+    actuators[a].valve_open = 1.0;
+    actuators[a].valve_close = 2.0;
+  }
+  JumpingRobotSimulator simulator(robot, graph_builder, actuators,
+                                  PneumaticParams(), "link_0");
+
+  gtsam::Values initial;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&initial, joint->id(), 0.0);
+    InsertJointVel(&initial, joint->id(), 0.0);
+  }
+  InsertPose(&initial, 0, gtsam::Pose3());
+  InsertTwist(&initial, 0, gtsam::Vector6::Zero());
+
+  const size_t num_steps = 3;
+  const double dt = 0.005;
+  simulator.simulate(initial, 400.0, 7.873172488131229e-05, num_steps, dt);
+  EXPECT_LONGS_EQUAL(num_steps, simulator.numSteps());
+  THROWS_EXCEPTION(simulator.step(dt));
+
+  // No air flows before the valves open.
+  const auto &at = simulator.actuatorTrajectory();
+  EXPECT_DOUBLES_EQUAL(2 * dt, at.time(2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(at.source_mass(0), at.source_mass(2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(at.mass(0, 1), at.mass(2, 1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(400.0, at.source_pressure(0), 1e-9);
+
+  // Joints integrate their accelerations, with the actuator torques.
+  const TrajectoryValues &trajectory = simulator.robotTrajectory();
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const double a = trajectory.a(j, 0);
+    EXPECT_DOUBLES_EQUAL(0.5 * a * dt * dt, trajectory.q(j, 1), 1e-6);
+    EXPECT_DOUBLES_EQUAL(a * dt, trajectory.v(j, 1), 1e-6);
+  }
+
+  const gtsam::Values values = simulator.values();
+  EXPECT(values.exists(JumpingRobotSimulator::PressureKey(0, 2)));
+  EXPECT(values.exists(JointAngleKey(1, 2)));
+  EXPECT(!values.exists(JointAngleKey(1, 3)));
+  EXPECT_DOUBLES_EQUAL(trajectory.torque(1, 2), Torque(values, 1, 2), 0);
+}
+
+/* main function */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -24,10 +24,14 @@
 #include <gtsam/slam/PriorFactor.h>
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 using gtdynamics::ForceBalanceFactor, gtdynamics::JointTorqueFactor,
     gtdynamics::ActuatorVolumeFactor, gtdynamics::SmoothActuatorFactor,
-    gtdynamics::ClippingActuatorFactor;
+    gtdynamics::ClippingActuatorFactor,
+    gtdynamics::AutoDiffSmoothActuatorFactor,
+    gtdynamics::SmoothActuatorsFactor;
 using gtsam::Symbol, gtsam::Vector1, gtsam::Values, gtsam::Key,
     gtsam::assert_equal, gtsam::noiseModel::Isotropic;
 
@@ -264,6 +268,60 @@ TEST(SmoothActuatorFactor, zero_force) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+/** The automatically differentiated model matches the hand-derived one in
+ * the over contraction, over extension, and normal regimes. */
+TEST(AutoDiffSmoothActuatorFactor, regimes) {
+  SmoothActuatorFactor expected(example::delta_x_key, example::p_key,
+                                example::f_key, example::cost_model);
+  AutoDiffSmoothActuatorFactor actual(
+      {example::delta_x_key, example::p_key, example::f_key},
+      example::cost_model);
+
+  for (double delta_x : {10.0, -0.5, 2.0}) {
+    Values values;
+    values.insert(example::delta_x_key, delta_x);
+    values.insert(example::p_key, 300.0);
+    values.insert(example::f_key, 3.0);
+    EXPECT(assert_equal(expected.unwhitenedError(values),
+                        actual.unwhitenedError(values), 1e-9));
+    EXPECT(actual.linearize(values)->equals(*expected.linearize(values),
+                                            1e-6));
+    EXPECT_CORRECT_FACTOR_JACOBIANS(actual, values, 1e-7, 1e-3);
+  }
+}
+
+/** The batch over time steps matches one SmoothActuatorFactor per step, in
+ * all regimes. */
+TEST(SmoothActuatorsFactor, steps) {
+  const std::vector<double> delta_xs{10.0, -0.5, 2.0, 1.0},
+      ps{300.0, 300.0, 300.0, 90.0};
+  gtsam::KeyVector delta_x_keys, p_keys, f_keys;
+  Values values;
+  for (size_t k = 0; k < delta_xs.size(); k++) {
+    delta_x_keys.push_back(Symbol('x', k));
+    p_keys.push_back(Symbol('p', k));
+    f_keys.push_back(Symbol('f', k));
+    values.insert(delta_x_keys[k], delta_xs[k]);
+    values.insert(p_keys[k], ps[k]);
+    values.insert(f_keys[k], 3.0);
+  }
+  SmoothActuatorsFactor factor(delta_x_keys, p_keys, f_keys,
+                               example::cost_model);
+  EXPECT_LONGS_EQUAL(4, factor.numSteps());
+
+  const gtsam::Vector errors = factor.unwhitenedError(values);
+  for (size_t k = 0; k < delta_xs.size(); k++) {
+    SmoothActuatorFactor expected(delta_x_keys[k], p_keys[k], f_keys[k],
+                                  example::cost_model);
+    EXPECT_DOUBLES_EQUAL(expected.unwhitenedError(values)(0), errors(k),
+                         1e-9);
+  }
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+
+  THROWS_EXCEPTION(std::make_shared<SmoothActuatorsFactor>(
+      delta_x_keys, p_keys, gtsam::KeyVector{}, example::cost_model));
+}
+
 //// following tests are deprecated
 TEST(ClippingActuatorFactor, Factor) {
   const double delta_x = 1;
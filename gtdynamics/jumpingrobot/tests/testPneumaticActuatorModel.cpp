@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testPneumaticActuatorModel.cpp
+ *  @brief Tests for the closed-form pneumatic actuator model.
+ *  @author Yetong Zhang
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/simulator/PneumaticActuatorModel.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/linear/NoiseModel.h>
+
+using namespace gtdynamics;
+
+/// The state satisfies all factors of the actuator graph.
+TEST(PneumaticActuatorModel, evaluate) {
+  ActuatorParams actuator;
+  actuator.j = 1;
+  actuator.positive = true;
+  actuator.q_rest = -0.2;
+  const PneumaticParams pneumatic;
+  const PneumaticActuatorModel model(actuator, pneumatic);
+
+  const auto cost_model = gtsam::noiseModel::Unit::Create(1);
+  const GasLawFactor gas_law(0, 1, 2, cost_model, pneumatic.gas_constant);
+  const ActuatorVolumeFactor volume(0, 1, cost_model, pneumatic.d_tube,
+                                    pneumatic.l_tube);
+  const SmoothActuatorFactor smooth(0, 1, 2, cost_model);
+  const ForceBalanceFactor balance(0, 1, 2, cost_model, actuator.k_tendon,
+                                   actuator.radius, actuator.q_rest,
+                                   actuator.positive);
+  const JointTorqueFactor torque(0, 1, 2, 3, cost_model,
+                                 actuator.q_anta_limit, actuator.k_anta,
+                                 actuator.radius, actuator.b,
+                                 actuator.positive);
+
+  const double q = 0.1, v = 0.5;
+  for (double mass : {7.873172488131229e-05, 2e-4, 4e-4}) {
+    const ActuatorState s = model.evaluate(mass, q, v);
+    EXPECT_DOUBLES_EQUAL(
+        0, gas_law.evaluateError(s.pressure, s.volume, mass)(0), 1e-9);
+    EXPECT_DOUBLES_EQUAL(
+        0, volume.evaluateError(s.volume, s.contraction)(0), 1e-12);
+    EXPECT_DOUBLES_EQUAL(
+        0, smooth.evaluateError(s.contraction, s.pressure, s.force)(0), 1e-6);
+    EXPECT_DOUBLES_EQUAL(
+        0, balance.evaluateError(s.contraction, q, s.force)(0), 1e-6);
+    EXPECT_DOUBLES_EQUAL(
+        0, torque.evaluateError(q, v, s.force, s.torque)(0), 1e-9);
+  }
+
+  // More air contracts the actuator further, from any initial estimate.
+  const ActuatorState low = model.evaluate(2e-4, q, v);
+  const ActuatorState high = model.evaluate(4e-4, q, v, -5.0);
+  EXPECT(high.pressure > low.pressure);
+  EXPECT(high.contraction > low.contraction);
+  EXPECT_DOUBLES_EQUAL(low.contraction,
+                       model.evaluate(2e-4, q, v, 5.0).contraction, 1e-9);
+}
+
+/* main function */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.cpp
+ * @brief Forward kinematics for many joint configurations at once.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix3;
+using gtsam::Pose3;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/// Number of configurations processed together.
+static constexpr Eigen::Index kChunkSize = 256;
+
+/* ************************************************************************* */
+template <typename Scalar>
+Pose3 BatchLinkPosesT<Scalar>::pose(int i, Eigen::Index k) const {
+  const Block &block = links[i];
+  Matrix3 R;
+  R << block(0, k), block(1, k), block(2, k), block(3, k), block(4, k),
+      block(5, k), block(6, k), block(7, k), block(8, k);
+  const Vector3 t(block(9, k), block(10, k), block(11, k));
+  return Pose3(gtsam::Rot3(R), t);
+}
+
+template struct BatchLinkPosesT<float>;
+template struct BatchLinkPosesT<double>;
+
+/* ************************************************************************* */
+BatchForwardKinematics::BatchForwardKinematics(
+    const Robot &robot, const std::optional<std::string> &prior_link_name,
+    const Pose3 &root_pose, const ExecutionContext &execution)
+    : execution_(execution) {
+  // Same root as Robot::forwardKinematics.
+  LinkSharedPtr root_link;
+  if (prior_link_name) {
+    root_link = robot.link(*prior_link_name);
+  } else {
+    const auto &links = robot.links();
+    auto it = std::find_if(links.rbegin(), links.rend(),
+                           [](const LinkSharedPtr &l) { return l->isFixed(); });
+    if (it == links.rend()) {
+      throw std::runtime_error(
+          "BatchForwardKinematics: no prior link given and cannot find a "
+          "fixed link.");
+    }
+    root_link = *it;
+  }
+  root_ = root_link->id();
+  root_pose_ = root_link->isFixed() ? root_link->getFixedPose() : root_pose;
+
+  const RobotTopology &topology = robot.topology();
+  num_link_ids_ = topology.links.size();
+  num_joint_ids_ = topology.joints.size();
+  const RobotTopology::Tree &tree = topology.trees[root_];
+  for (size_t k = 0; k < tree.joints.size(); ++k) {
+    JointTerms terms;
+    terms.joint = tree.joints[k];
+    terms.from = tree.from[k];
+    terms.towards_child = topology.parent_link[terms.joint] == terms.from;
+    terms.to = terms.towards_child ? topology.child_link[terms.joint]
+                                   : topology.parent_link[terms.joint];
+
+    const gtsam::Vector6 &S = topology.screw_axis[terms.joint];
+    const Vector3 w = S.head<3>(), v = S.tail<3>();
+    const double norm = w.norm();
+    if (norm > 1e-9 && std::abs(norm - 1.0) > 1e-9) {
+      throw std::invalid_argument(
+          "BatchForwardKinematics: screw axis of joint " +
+          topology.joints[terms.joint]->name() +
+          " has a rotation that is neither zero nor a unit vector.");
+    }
+    const Pose3 &pMc = topology.pMc[terms.joint];
+    const Matrix3 pR = pMc.rotation().matrix();
+    const Matrix3 K = gtsam::skewSymmetric(w), K2 = K * K;
+    const Vector3 wxv = w.cross(v);
+    terms.A = pR;
+    terms.B = pR * K;
+    terms.C = pR * K2;
+    terms.t0 = pMc.translation();
+    terms.b1 = -pR * K * wxv;
+    terms.b2 = -pR * K2 * wxv;
+    terms.b3 = norm > 1e-9 ? Vector3(pR * w * w.dot(v)) : Vector3(pR * v);
+    terms_.push_back(terms);
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void BatchForwardKinematics::computeRange(
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &q,
+    Eigen::Index begin, Eigen::Index end,
+    BatchLinkPosesT<Scalar> *poses) const {
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+  const Eigen::Index n = end - begin;
+  const Matrix3 R0 = root_pose_.rotation().matrix();
+  const Vector3 t0 = root_pose_.translation();
+  auto &root = poses->links[root_];
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      root.row(3 * a + b).segment(begin, n).setConstant(Scalar(R0(a, b)));
+    }
+    root.row(9 + a).segment(begin, n).setConstant(Scalar(t0(a)));
+  }
+
+  // The constant terms are rounded to Scalar once per joint.
+  Array theta(n), s(n), c(n), acc(n);
+  std::array<Array, 9> MR;
+  std::array<Array, 3> Mt;
+  for (const JointTerms &terms : terms_) {
+    const Eigen::Matrix<Scalar, 3, 3> A = terms.A.cast<Scalar>(),
+                                      B = terms.B.cast<Scalar>(),
+                                      C = terms.C.cast<Scalar>();
+    Eigen::Matrix<Scalar, 3, 4> t;
+    t << terms.t0.cast<Scalar>(), terms.b1.cast<Scalar>(),
+        terms.b2.cast<Scalar>(), terms.b3.cast<Scalar>();
+
+    // Relative transform across the joint, parent to child.
+    theta = q.col(terms.joint).segment(begin, n).array();
+    s = theta.sin();
+    c = Scalar(1) - theta.cos();
+    for (int a = 0; a < 3; ++a) {
+      for (int k = 0; k < 3; ++k) {
+        MR[3 * a + k] = A(a, k) + s * B(a, k) + c * C(a, k);
+      }
+      Mt[a] = t(a, 0) + s * t(a, 1) + c * t(a, 2) + theta * t(a, 3);
+    }
+
+    const auto &P = poses->links[terms.from];
+    auto &X = poses->links[terms.to];
+    auto P_R = [&](int a, int b) {
+      return P.row(3 * a + b).segment(begin, n).array();
+    };
+    auto X_R = [&](int a, int b) {
+      return X.row(3 * a + b).segment(begin, n).array();
+    };
+    for (int a = 0; a < 3; ++a) {
+      for (int b = 0; b < 3; ++b) {
+        // Towards the child X = P * M, otherwise X = P * M^-1.
+        if (terms.towards_child) {
+          acc = P_R(a, 0) * MR[b] + P_R(a, 1) * MR[3 + b] +
+                P_R(a, 2) * MR[6 + b];
+        } else {
+          acc = P_R(a, 0) * MR[3 * b] + P_R(a, 1) * MR[3 * b + 1] +
+                P_R(a, 2) * MR[3 * b + 2];
+        }
+        X_R(a, b) = acc;
+      }
+    }
+    for (int a = 0; a < 3; ++a) {
+      const auto P_t = P.row(9 + a).segment(begin, n).array();
+      if (terms.towards_child) {
+        acc = P_t + P_R(a, 0) * Mt[0] + P_R(a, 1) * Mt[1] + P_R(a, 2) * Mt[2];
+      } else {
+        acc = P_t - X_R(a, 0) * Mt[0] - X_R(a, 1) * Mt[1] - X_R(a, 2) * Mt[2];
+      }
+      X.row(9 + a).segment(begin, n).array() = acc;
+    }
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void BatchForwardKinematics::compute(
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &q,
+    BatchLinkPosesT<Scalar> *poses) const {
+  if (static_cast<size_t>(q.cols()) != num_joint_ids_) {
+    throw std::invalid_argument(
+        "BatchForwardKinematics: q should have one column per joint id");
+  }
+  const Eigen::Index num_configs = q.rows();
+  poses->links.resize(num_link_ids_);
+  for (auto &block : poses->links) {
+    if (block.cols() != num_configs) block.resize(12, num_configs);
+  }
+
+  // Chunks of configurations are independent.
+  const Eigen::Index num_chunks = (num_configs + kChunkSize - 1) / kChunkSize;
+  execution_.parallelFor(num_chunks, [&](size_t chunk) {
+    const Eigen::Index begin = static_cast<Eigen::Index>(chunk) * kChunkSize;
+    computeRange(q, begin, std::min(begin + kChunkSize, num_configs), poses);
+  });
+}
+
+template void BatchForwardKinematics::compute(const Eigen::MatrixXf &q,
+                                              BatchLinkPosesF *poses) const;
+template void BatchForwardKinematics::compute(const Eigen::MatrixXd &q,
+                                              BatchLinkPoses *poses) const;
+
+/* ************************************************************************* */
+void BatchForwardKinematics::refine(const gtsam::Matrix &q,
+                                    const std::vector<Eigen::Index> &configs,
+                                    BatchLinkPoses *poses) const {
+  gtsam::Matrix selected(configs.size(), q.cols());
+  for (size_t k = 0; k < configs.size(); ++k) {
+    if (configs[k] < 0 || configs[k] >= q.rows()) {
+      throw std::invalid_argument(
+          "BatchForwardKinematics: configuration index out of range");
+    }
+    selected.row(k) = q.row(configs[k]);
+  }
+  compute(selected, poses);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.h
+ * @brief Forward kinematics for many joint configurations at once.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Link CoM poses for a batch of configurations, in structure-of-arrays
+ * layout: for each link id, a 12 x num_configs row-major block whose rows are
+ * the rotation entries R00, R01, ..., R22 followed by the translation x, y, z,
+ * each contiguous across configurations. Scalar is float or double.
+ */
+template <typename Scalar>
+struct BatchLinkPosesT {
+  using Block = Eigen::Matrix<Scalar, 12, Eigen::Dynamic, Eigen::RowMajor>;
+  std::vector<Block> links;  ///< by link id
+
+  /// Number of configurations.
+  Eigen::Index numConfigs() const {
+    return links.empty() ? 0 : links.front().cols();
+  }
+
+  /// Pose of link i in configuration k.
+  gtsam::Pose3 pose(int i, Eigen::Index k) const;
+};
+
+using BatchLinkPoses = BatchLinkPosesT<double>;
+using BatchLinkPosesF = BatchLinkPosesT<float>;
+
+/**
+ * BatchForwardKinematics evaluates forward kinematics of one robot for many
+ * joint configurations, e.g. for collision checking or workspace sampling.
+ *
+ * The spanning tree of the root link is walked once per batch, and for every
+ * joint the poses of all configurations are updated with array expressions,
+ * which Eigen vectorizes. Each joint transform is pMc * Expmap(S * q), written
+ * in closed form as constant matrices times 1, sin(q), 1 - cos(q) and q.
+ * Chunks of configurations are processed in parallel.
+ *
+ * The kernels are instantiated for float and double. In float, twice as many
+ * configurations fit in a SIMD register, at an accuracy of about 1e-6 per
+ * joint, which is enough to screen samples in a planner. In mixed precision,
+ * all samples are computed in float and only the few that are kept, e.g. the
+ * final path, are recomputed in double with refine().
+ *
+ * Joints that close kinematic loops are not checked, and links outside the
+ * component of the root are left untouched.
+ */
+class BatchForwardKinematics {
+ public:
+  /**
+   * Constructor.
+   * @param robot           the robot; screw axes must have a unit or zero
+   * rotational part, which holds for all joint types
+   * @param prior_link_name name of the root link, defaults to the fixed link
+   * used by Robot::forwardKinematics
+   * @param root_pose       pose of the root link, ignored if it is fixed
+   * @param execution       threads that compute chunks of configurations
+   */
+  explicit BatchForwardKinematics(
+      const Robot &robot,
+      const std::optional<std::string> &prior_link_name = {},
+      const gtsam::Pose3 &root_pose = gtsam::Pose3(),
+      const ExecutionContext &execution = ExecutionContext::Default());
+
+  /**
+   * Compute link poses for a batch of joint configurations.
+   * @param q     joint angles, one row per configuration and one column per
+   * joint id
+   * @param poses link poses, resized if needed so a reused buffer is not
+   * reallocated
+   */
+  template <typename Scalar>
+  void compute(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &q,
+               BatchLinkPosesT<Scalar> *poses) const;
+
+  /// Compute link poses for a batch of joint configurations.
+  template <typename Scalar>
+  BatchLinkPosesT<Scalar> compute(
+      const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &q) const {
+    BatchLinkPosesT<Scalar> poses;
+    compute(q, &poses);
+    return poses;
+  }
+
+  /**
+   * Compute link poses in double of some configurations of a batch, e.g.
+   * after screening the batch in float.
+   * @param q       joint angles of the whole batch
+   * @param configs rows of q to compute
+   * @param poses   link poses, with one column per selected configuration
+   */
+  void refine(const gtsam::Matrix &q, const std::vector<Eigen::Index> &configs,
+              BatchLinkPoses *poses) const;
+
+ private:
+  /// Constant terms of the transform across one joint of the tree.
+  struct JointTerms {
+    int joint, from, to;
+    bool towards_child;  // whether to is the child link of the joint
+    // pMc * Expmap(S q) = [A + s B + c C, t0 + s b1 + c b2 + q b3],
+    // with s = sin(q) and c = 1 - cos(q).
+    gtsam::Matrix3 A, B, C;
+    gtsam::Vector3 t0, b1, b2, b3;
+  };
+
+  std::vector<JointTerms> terms_;
+  int root_;
+  gtsam::Pose3 root_pose_;
+  size_t num_link_ids_, num_joint_ids_;
+  ExecutionContext execution_;
+
+  /// Compute poses of configurations [begin, end).
+  template <typename Scalar>
+  void computeRange(
+      const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &q,
+      Eigen::Index begin, Eigen::Index end,
+      BatchLinkPosesT<Scalar> *poses) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,276 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionBVH.cpp
+ * @brief Bounding volume hierarchy of the collision geometry of a robot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/kinematics/CollisionBVH.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+double SegmentDistance(const Point3 &p0, const Point3 &p1, const Point3 &q0,
+                       const Point3 &q1, Point3 *cp, Point3 *cq) {
+  // Minimize |p0 + s * d1 - q0 - t * d2| over s, t in [0, 1], as in Ericson,
+  // Real-Time Collision Detection, Section 5.1.9.
+  const gtsam::Vector3 d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+  const double a = d1.dot(d1), e = d2.dot(d2), f = d2.dot(r);
+  constexpr double kEpsilon = 1e-12;
+  double s = 0.0, t = 0.0;
+  if (a <= kEpsilon && e <= kEpsilon) {
+    // Both segments are points.
+  } else if (a <= kEpsilon) {
+    t = std::clamp(f / e, 0.0, 1.0);
+  } else {
+    const double c = d1.dot(r);
+    if (e <= kEpsilon) {
+      s = std::clamp(-c / a, 0.0, 1.0);
+    } else {
+      const double b = d1.dot(d2), denominator = a * e - b * b;
+      s = denominator > kEpsilon ? std::clamp((b * f - c * e) / denominator,
+                                              0.0, 1.0)
+                                 : 0.0;
+      t = (b * s + f) / e;
+      if (t < 0.0) {
+        t = 0.0;
+        s = std::clamp(-c / a, 0.0, 1.0);
+      } else if (t > 1.0) {
+        t = 1.0;
+        s = std::clamp((b - c) / a, 0.0, 1.0);
+      }
+    }
+  }
+  const Point3 closest_p = p0 + s * d1, closest_q = q0 + t * d2;
+  if (cp) *cp = closest_p;
+  if (cq) *cq = closest_q;
+  return (closest_p - closest_q).norm();
+}
+
+/* ************************************************************************* */
+CollisionBVH::CollisionBVH(const Robot &robot, int leaf_size)
+    : leaf_size_(std::max(leaf_size, 1)) {
+  std::vector<Pose3> rest_poses;
+  for (auto &&link : robot.links()) {
+    rest_poses.resize(std::max<size_t>(rest_poses.size(), link->id() + 1));
+    rest_poses[link->id()] = link->bMcom();
+    for (auto &&collision : link->collisions()) {
+      if (!collision.hasBound()) continue;
+      Primitive primitive;
+      primitive.link_id = link->id();
+      primitive.geometry = collision;
+      collision.sweptSphere(&primitive.comTaxis, &primitive.half_length,
+                            &primitive.radius);
+      primitives_.push_back(primitive);
+    }
+  }
+  for (auto &&joint : robot.joints()) {
+    const int a = joint->parent()->id(), b = joint->child()->id();
+    adjacent_.emplace_back(std::min(a, b), std::max(a, b));
+  }
+  std::sort(adjacent_.begin(), adjacent_.end());
+
+  // Build the tree around the rest poses.
+  move(rest_poses);
+  order_.resize(primitives_.size());
+  for (size_t i = 0; i < order_.size(); ++i) order_[i] = i;
+  nodes_.reserve(2 * primitives_.size() + 1);
+  build(0, primitives_.size());
+}
+
+/* ************************************************************************* */
+int CollisionBVH::build(int begin, int end) {
+  const int index = nodes_.size();
+  nodes_.emplace_back();
+  nodes_[index].begin = begin;
+  nodes_[index].end = end;
+  for (int i = begin; i < end; ++i) {
+    nodes_[index].box.extend(box(primitives_[order_[i]]));
+  }
+  if (end - begin <= leaf_size_) return index;
+
+  // Split at the median of the centers along the longest side.
+  int axis;
+  nodes_[index].box.sizes().maxCoeff(&axis);
+  auto center = [&](int i) {
+    return primitives_[i].p0(axis) + primitives_[i].p1(axis);
+  };
+  const int middle = (begin + end) / 2;
+  std::nth_element(order_.begin() + begin, order_.begin() + middle,
+                   order_.begin() + end,
+                   [&](int i, int j) { return center(i) < center(j); });
+  const int left = build(begin, middle);
+  const int right = build(middle, end);
+  nodes_[index].left = left;
+  nodes_[index].right = right;
+  return index;
+}
+
+/* ************************************************************************* */
+Eigen::AlignedBox3d CollisionBVH::box(const Primitive &primitive,
+                                      double margin) const {
+  const double r = primitive.radius + margin;
+  Eigen::AlignedBox3d result(primitive.p0.cwiseMin(primitive.p1),
+                             primitive.p0.cwiseMax(primitive.p1));
+  result.min().array() -= r;
+  result.max().array() += r;
+  return result;
+}
+
+/* ************************************************************************* */
+void CollisionBVH::refit() {
+  // Children come after their parents, so refit in reverse order.
+  for (int k = nodes_.size() - 1; k >= 0; --k) {
+    Node &node = nodes_[k];
+    if (node.left < 0) {
+      node.box.setEmpty();
+      for (int i = node.begin; i < node.end; ++i) {
+        node.box.extend(box(primitives_[order_[i]]));
+      }
+    } else {
+      node.box = nodes_[node.left].box.merged(nodes_[node.right].box);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void CollisionBVH::move(const std::vector<Pose3> &poses) {
+  for (auto &primitive : primitives_) {
+    if (static_cast<size_t>(primitive.link_id) >= poses.size()) {
+      throw std::invalid_argument("CollisionBVH::update: no pose for link " +
+                                  std::to_string(primitive.link_id));
+    }
+    const Pose3 wTaxis = poses[primitive.link_id] * primitive.comTaxis;
+    primitive.p0 = wTaxis.transformFrom(Point3(0, 0, -primitive.half_length));
+    primitive.p1 = wTaxis.transformFrom(Point3(0, 0, primitive.half_length));
+  }
+}
+
+/* ************************************************************************* */
+void CollisionBVH::update(const std::vector<Pose3> &poses) {
+  move(poses);
+  refit();
+}
+
+/* ************************************************************************* */
+void CollisionBVH::update(const gtsam::Values &values, size_t t) {
+  std::vector<Pose3> poses;
+  for (const auto &primitive : primitives_) {
+    const int i = primitive.link_id;
+    poses.resize(std::max<size_t>(poses.size(), i + 1));
+    poses[i] = Pose(values, i, t);
+  }
+  update(poses);
+}
+
+/* ************************************************************************* */
+bool CollisionBVH::adjacent(int link_a, int link_b) const {
+  const std::pair<int, int> key(std::min(link_a, link_b),
+                                std::max(link_a, link_b));
+  return std::binary_search(adjacent_.begin(), adjacent_.end(), key);
+}
+
+/* ************************************************************************* */
+double CollisionBVH::distance(size_t a, size_t b) const {
+  const Primitive &A = primitives_.at(a), &B = primitives_.at(b);
+  return SegmentDistance(A.p0, A.p1, B.p0, B.p1) - A.radius - B.radius;
+}
+
+/* ************************************************************************* */
+std::vector<CollisionPair> CollisionBVH::selfCollisions(
+    double margin, bool skip_adjacent) const {
+  std::vector<CollisionPair> pairs;
+  if (primitives_.empty()) return pairs;
+
+  auto test = [&](int i, int j) {
+    const int link_i = primitives_[i].link_id, link_j = primitives_[j].link_id;
+    if (link_i == link_j) return;
+    if (skip_adjacent && adjacent(link_i, link_j)) return;
+    const double d = distance(i, j);
+    if (d < margin) {
+      pairs.push_back({std::min<size_t>(i, j), std::max<size_t>(i, j), d});
+    }
+  };
+
+  // Descend both trees at once, from the pair (root, root).
+  std::vector<std::pair<int, int>> stack = {{0, 0}};
+  while (!stack.empty()) {
+    const auto [m, n] = stack.back();
+    stack.pop_back();
+    const Node &M = nodes_[m], &N = nodes_[n];
+    Eigen::AlignedBox3d grown = M.box;
+    grown.min().array() -= margin;
+    grown.max().array() += margin;
+    if (!grown.intersects(N.box)) continue;
+
+    if (M.left < 0 && N.left < 0) {
+      for (int i = M.begin; i < M.end; ++i) {
+        // Within a leaf, each pair once.
+        for (int j = (m == n ? i + 1 : N.begin); j < N.end; ++j) {
+          test(order_[i], order_[j]);
+        }
+      }
+    } else if (m == n) {
+      stack.push_back({M.left, M.left});
+      stack.push_back({M.right, M.right});
+      stack.push_back({M.left, M.right});
+    } else if (N.left < 0 ||
+               (M.left >= 0 && M.box.volume() > N.box.volume())) {
+      stack.push_back({M.left, n});
+      stack.push_back({M.right, n});
+    } else {
+      stack.push_back({m, N.left});
+      stack.push_back({m, N.right});
+    }
+  }
+  std::sort(pairs.begin(), pairs.end(),
+            [](const CollisionPair &p, const CollisionPair &q) {
+              return std::make_pair(p.a, p.b) < std::make_pair(q.a, q.b);
+            });
+  return pairs;
+}
+
+/* ************************************************************************* */
+std::vector<std::pair<size_t, double>> CollisionBVH::sphereQuery(
+    const Point3 &center, double radius, double margin) const {
+  std::vector<std::pair<size_t, double>> result;
+  if (primitives_.empty()) return result;
+  const gtsam::Vector3 extent = gtsam::Vector3::Constant(radius + margin);
+  const Eigen::AlignedBox3d query(center - extent, center + extent);
+  std::vector<int> stack = {0};
+  while (!stack.empty()) {
+    const Node &node = nodes_[stack.back()];
+    stack.pop_back();
+    if (!node.box.intersects(query)) continue;
+    if (node.left >= 0) {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+      continue;
+    }
+    for (int i = node.begin; i < node.end; ++i) {
+      const Primitive &primitive = primitives_[order_[i]];
+      const double d = SegmentDistance(primitive.p0, primitive.p1, center,
+                                       center) -
+                       primitive.radius - radius;
+      if (d < margin) result.emplace_back(order_[i], d);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace gtdynamics
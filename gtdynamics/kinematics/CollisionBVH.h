@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionBVH.h
+ * @brief Bounding volume hierarchy of the collision geometry of a robot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Geometry>
+
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Closest points of two segments [p0, p1] and [q0, q1].
+ * @return the distance between the segments
+ */
+double SegmentDistance(const gtsam::Point3 &p0, const gtsam::Point3 &p1,
+                       const gtsam::Point3 &q0, const gtsam::Point3 &q1,
+                       gtsam::Point3 *cp = nullptr,
+                       gtsam::Point3 *cq = nullptr);
+
+/// Two primitives of a CollisionBVH closer than a margin.
+struct CollisionPair {
+  size_t a, b;      ///< indices into CollisionBVH::primitives(), a < b
+  double distance;  ///< between the swept-sphere bounds, negative if they
+                    ///< penetrate
+};
+
+/**
+ * CollisionBVH is a bounding volume hierarchy of axis-aligned boxes over the
+ * collision primitives of all links of a robot, for self-collision and
+ * distance queries after forward kinematics.
+ *
+ * Each primitive is bounded by its swept sphere, see CollisionGeometry, so
+ * distances are lower bounds of the distances between the primitives, exact
+ * for spheres and capsules. Meshes have no bound and are skipped.
+ *
+ * The hierarchy is built once, with the links at rest, by splitting the
+ * primitives at the median of the longest side of their bounding box. After
+ * forward kinematics, update() moves the primitives and refits the boxes
+ * bottom-up without changing the tree, which is linear in the number of
+ * primitives. Queries then only test the pairs of primitives whose boxes
+ * overlap.
+ */
+class CollisionBVH {
+ public:
+  /// A collision primitive, with its swept sphere in the world frame.
+  struct Primitive {
+    int link_id;                ///< link the primitive is attached to
+    CollisionGeometry geometry;
+    gtsam::Pose3 comTaxis;      ///< axis of the swept sphere in the CoM frame
+    double half_length, radius;
+    gtsam::Point3 p0, p1;       ///< ends of the segment in the world frame
+  };
+
+ private:
+  struct Node {
+    Eigen::AlignedBox3d box;
+    int left = -1, right = -1;  ///< children, -1 for leaves
+    int begin = 0, end = 0;     ///< range of order_ spanned by the node
+  };
+
+  std::vector<Primitive> primitives_;
+  std::vector<Node> nodes_;     ///< root first, children after parents
+  std::vector<int> order_;      ///< primitive indices, by leaf
+  std::vector<std::pair<int, int>> adjacent_;  ///< link ids joined by a joint
+  int leaf_size_;
+
+ public:
+  /**
+   * Constructor, which puts the links at rest.
+   * @param robot     the robot, with collision geometry from its SDF/URDF
+   * @param leaf_size largest number of primitives in a leaf
+   */
+  explicit CollisionBVH(const Robot &robot, int leaf_size = 2);
+
+  /// Move the primitives to link CoM poses indexed by link id, e.g.
+  /// LinkStates::poses from Robot::forwardKinematics.
+  void update(const std::vector<gtsam::Pose3> &poses);
+
+  /// Move the primitives to the link poses at time t in values.
+  void update(const gtsam::Values &values, size_t t = 0);
+
+  /**
+   * Pairs of primitives of different links which are closer than margin.
+   * @param margin         distance below which a pair is reported
+   * @param skip_adjacent  skip pairs of links connected by a joint, whose
+   * geometry usually overlaps at the joint
+   */
+  std::vector<CollisionPair> selfCollisions(double margin = 0.0,
+                                            bool skip_adjacent = true) const;
+
+  /**
+   * Primitives closer than margin to a sphere, e.g. an obstacle.
+   * @return pairs of primitive index and distance to the sphere
+   */
+  std::vector<std::pair<size_t, double>> sphereQuery(
+      const gtsam::Point3 &center, double radius, double margin = 0.0) const;
+
+  /// Distance between the swept-sphere bounds of primitives a and b.
+  double distance(size_t a, size_t b) const;
+
+  /// Return the primitives.
+  const std::vector<Primitive> &primitives() const { return primitives_; }
+
+  /// Return the bounding box of all primitives.
+  const Eigen::AlignedBox3d &bounds() const { return nodes_.front().box; }
+
+ private:
+  /// Build the subtree of order_[begin, end), return its node index.
+  int build(int begin, int end);
+
+  /// Bounding box of a primitive, grown by margin.
+  Eigen::AlignedBox3d box(const Primitive &primitive,
+                          double margin = 0.0) const;
+
+  /// Move the segments of the primitives to link poses, by link id.
+  void move(const std::vector<gtsam::Pose3> &poses);
+
+  /// Recompute the boxes of all nodes from the primitives.
+  void refit();
+
+  /// Whether two links are connected by a joint.
+  bool adjacent(int link_a, int link_b) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IKTracker.cpp
+ * @brief Inverse kinematics of moving contact goals, at high rates.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/kinematics/IKTracker.h>
+#include <gtdynamics/utils/values.h>
+
+#include <memory>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+/// Kinematics graph with the goals as objectives, goal factors after the
+/// pose factors, and priors on the fixed links.
+static NonlinearFactorGraph TrackingGraph(const Robot& robot,
+                                          const ContactGoals& contact_goals,
+                                          const IKTrackerParameters& p,
+                                          const Slice& slice) {
+  const Kinematics kinematics(p);
+  NonlinearFactorGraph graph = kinematics.graph(slice, robot);
+  graph.add(kinematics.pointGoalObjectives(slice, contact_goals));
+  graph.add(kinematics.jointAngleObjectives(slice, robot));
+  for (auto&& link : robot.links()) {
+    if (link->isFixed()) {
+      graph.addPrior<gtsam::Pose3>(PoseKey(link->id(), slice.k),
+                                   link->getFixedPose(), p.p_cost_model);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+/// LM parameters with the per-call budget and lambda carried over calls.
+static gtsam::MutableLMParams TrackingParams(const IKTrackerParameters& p) {
+  gtsam::MutableLMParams params(p.lm_parameters);
+  params.setMaxIterations(p.max_iterations);
+  params.setlambdaInitial(p.lambda_initial);
+  params.warmStartLambda = true;
+  return params;
+}
+
+/* ************************************************************************* */
+IKTracker::IKTracker(const Robot& robot, const ContactGoals& contact_goals,
+                     const IKTrackerParameters& parameters,
+                     const Slice& slice)
+    : IKTracker(robot, contact_goals,
+                Kinematics(parameters).initialValues(slice, robot, 0.0),
+                parameters, slice) {}
+
+/* ************************************************************************* */
+IKTracker::IKTracker(const Robot& robot, const ContactGoals& contact_goals,
+                     const Values& initial_values,
+                     const IKTrackerParameters& parameters,
+                     const Slice& slice)
+    : p_(parameters),
+      slice_(slice),
+      contact_goals_(contact_goals),
+      first_goal_factor_(robot.numJoints()),
+      optimizer_(TrackingGraph(robot, contact_goals, parameters, slice),
+                 initial_values, TrackingParams(parameters)) {}
+
+/* ************************************************************************* */
+const Values& IKTracker::track(const std::vector<gtsam::Point3>& goal_points) {
+  if (goal_points.size() != contact_goals_.size()) {
+    throw std::invalid_argument(
+        "IKTracker::track: expected one goal point per contact goal");
+  }
+
+  // Same keys in the same slots, so the ordering stays valid.
+  NonlinearFactorGraph& graph = optimizer_.mutableGraph();
+  for (size_t i = 0; i < goal_points.size(); ++i) {
+    ContactGoal& goal = contact_goals_[i];
+    goal.goal_point = goal_points[i];
+    graph[first_goal_factor_ + i] = std::make_shared<PointGoalFactor>(
+        PoseKey(goal.link()->id(), slice_.k), p_.g_cost_model,
+        goal.contactInCoM(), goal.goal_point);
+  }
+
+  // Restart at the previous solution, which recomputes the error.
+  optimizer_.setValues(Values(optimizer_.values()));
+  return optimizer_.optimize();
+}
+
+/* ************************************************************************* */
+void IKTracker::reset(const Values& values) { optimizer_.setValues(values); }
+
+}  // namespace gtdynamics
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IKTracker.h
+ * @brief Inverse kinematics of moving contact goals, at high rates.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of IKTracker: those of Kinematics, and a small LM budget.
+struct IKTrackerParameters : public KinematicsParameters {
+  /// LM iterations per call of IKTracker::track.
+  size_t max_iterations = 3;
+
+  /// Lambda of the first call; later calls start at the lambda the previous
+  /// one ended with.
+  double lambda_initial = 1e-3;
+};
+
+/**
+ * Inverse kinematics of contact goals whose goal points move from call to
+ * call, e.g. the target of a teleoperated arm at 1 kHz. The graph of
+ * Kinematics::inverse with the goals as objectives, its ordering and the
+ * optimizer are built once; every call of track only replaces the point goal
+ * factors, starts at the previous solution and runs a bounded number of LM
+ * iterations. Links fixed in the robot get a pose prior at their fixed pose;
+ * floating robots need goals that determine the base.
+ *
+ * Not safe to share between threads: each call updates the solution.
+ */
+class IKTracker {
+ public:
+  /**
+   * @fn Build the graph and optimizer.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals the tracked goals; only their goal points change.
+   * @param parameters noise models and LM budget.
+   * @param slice slice whose variables are solved for.
+   */
+  IKTracker(const Robot& robot, const ContactGoals& contact_goals,
+            const IKTrackerParameters& parameters = IKTrackerParameters(),
+            const Slice& slice = Slice(0));
+
+  /**
+   * @fn Same, starting at the given poses and joint angles instead of the
+   * rest configuration.
+   */
+  IKTracker(const Robot& robot, const ContactGoals& contact_goals,
+            const gtsam::Values& initial_values,
+            const IKTrackerParameters& parameters = IKTrackerParameters(),
+            const Slice& slice = Slice(0));
+
+  /**
+   * @fn Move the goal points and refine the solution towards them.
+   * @param goal_points new goal point of every contact goal, in order.
+   * @returns the refined poses and joint angles.
+   */
+  const gtsam::Values& track(const std::vector<gtsam::Point3>& goal_points);
+
+  /// Restart from the given values, e.g. after a jump of the targets.
+  void reset(const gtsam::Values& values);
+
+  /// Current solution.
+  const gtsam::Values& solution() const { return optimizer_.values(); }
+
+  /// Error of the current solution for the current goal points.
+  double error() const { return optimizer_.error(); }
+
+  /// LM iterations of the last call of track.
+  size_t iterations() const { return optimizer_.iterations(); }
+
+  /// The tracked contact goals, with the current goal points.
+  const ContactGoals& contactGoals() const { return contact_goals_; }
+
+ private:
+  const IKTrackerParameters p_;
+  const Slice slice_;
+  ContactGoals contact_goals_;
+  size_t first_goal_factor_;  // goal factors follow the pose factors
+  gtsam::MutableLMOptimizer optimizer_;
+};
+
+}  // namespace gtdynamics
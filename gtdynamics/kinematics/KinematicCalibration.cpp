@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicCalibration.cpp
+ * @brief Online calibration of encoder offsets and joint locations with
+ * iSAM2.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#include <gtdynamics/kinematics/KinematicCalibration.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+
+#include <map>
+#include <queue>
+#include <stdexcept>
+
+using gtsam::Double_;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Pose3_;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector3_;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+KinematicCalibration::KinematicCalibration(
+    const Robot &robot, const KinematicCalibrationParams &params)
+    : robot_(robot), params_(params), isam_(params.isam_params) {}
+
+/* ************************************************************************* */
+KinematicCalibration::Chain KinematicCalibration::chain(
+    const std::string &start_link_name,
+    const std::string &end_link_name) const {
+  const LinkSharedPtr start = robot_.link(start_link_name);
+  const LinkSharedPtr end = robot_.link(end_link_name);
+
+  // Breadth-first search from the start link, remembering how each link was
+  // reached.
+  std::map<LinkSharedPtr, JointSharedPtr> reached_by{{start, nullptr}};
+  std::queue<LinkSharedPtr> frontier;
+  frontier.push(start);
+  while (!frontier.empty() && !reached_by.count(end)) {
+    const LinkSharedPtr link = frontier.front();
+    frontier.pop();
+    for (auto &&joint : link->joints()) {
+      const LinkSharedPtr other = joint->otherLink(link);
+      if (reached_by.emplace(other, joint).second) frontier.push(other);
+    }
+  }
+  if (!reached_by.count(end)) {
+    throw std::invalid_argument("KinematicCalibration: no chain from " +
+                                start_link_name + " to " + end_link_name);
+  }
+
+  Chain joints;
+  for (LinkSharedPtr link = end; link != start;) {
+    const JointSharedPtr &joint = reached_by.at(link);
+    joints.emplace_back(joint, joint->child() == link);
+    link = joint->otherLink(link);
+  }
+  return Chain(joints.rbegin(), joints.rend());
+}
+
+/* ************************************************************************* */
+Pose3_ KinematicCalibration::chainExpression(const gtsam::Vector &q,
+                                             const Chain &chain) const {
+  std::optional<Pose3_> result;
+  for (auto &&[joint, forward] : chain) {
+    const int j = joint->id();
+    const double q_j = q(j);
+
+    // Relative pose of the next link, with the location correction applied
+    // as a translation of the child link in the parent CoM frame.
+    auto step = [joint = joint, forward = forward, q_j](
+                    const double &offset, const Vector3 &location,
+                    gtsam::OptionalJacobian<6, 1> H_offset,
+                    gtsam::OptionalJacobian<6, 3> H_location) -> Pose3 {
+      gtsam::Matrix61 pTc_H_q;
+      Matrix6 X_H_D, X_H_pTc;
+      const Pose3 D(Rot3(), location);
+      const Pose3 pTc =
+          joint->parentTchild(q_j + offset, H_offset ? &pTc_H_q : nullptr);
+      const Pose3 X = D.compose(pTc, X_H_D, X_H_pTc);
+      Matrix6 P_H_X = gtsam::I_6x6;
+      const Pose3 P = forward ? X : X.inverse(P_H_X);
+      if (H_offset) *H_offset = P_H_X * X_H_pTc * pTc_H_q;
+      if (H_location) *H_location = P_H_X * X_H_D.rightCols<3>();
+      return P;
+    };
+
+    const Double_ offset(EncoderOffsetKey(j));
+    const Vector3_ location = params_.calibrate_locations
+                                  ? Vector3_(JointLocationKey(j))
+                                  : Vector3_(Vector3::Zero());
+    const Pose3_ relative(step, offset, location);
+    result = result ? Pose3_(*result * relative) : relative;
+  }
+  return result ? *result : Pose3_(Pose3());
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::addObservation(const gtsam::Vector &q,
+                                          const std::string &start_link_name,
+                                          const std::string &end_link_name,
+                                          const Pose3 &measured) {
+  const Chain joints = chain(start_link_name, end_link_name);
+
+  // Calibration of joints not observed before, with priors at the model.
+  gtsam::NonlinearFactorGraph factors;
+  Values new_values;
+  for (auto &&[joint, forward] : joints) {
+    const int j = joint->id();
+    if (estimate_.exists(EncoderOffsetKey(j))) continue;
+    new_values.insert(EncoderOffsetKey(j), 0.0);
+    factors.addPrior(
+        EncoderOffsetKey(j), 0.0,
+        gtsam::noiseModel::Isotropic::Sigma(1, params_.offset_prior_sigma));
+    if (params_.calibrate_locations) {
+      new_values.insert(JointLocationKey(j), Vector3::Zero().eval());
+      factors.addPrior(
+          JointLocationKey(j), Vector3::Zero().eval(),
+          gtsam::noiseModel::Isotropic::Sigma(3,
+                                              params_.location_prior_sigma));
+    }
+  }
+  factors.emplace_shared<gtsam::ExpressionFactor<Pose3>>(
+      params_.measurement_model, measured, chainExpression(q, joints));
+
+  const gtsam::ISAM2Result result = isam_.update(factors, new_values);
+  observations_.push_back(result.newFactorsIndices.back());
+  num_observations_ += 1;
+  estimate_ = isam_.calculateEstimate();
+
+  if (observations_.size() > params_.max_observations) summarize();
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::summarize() {
+  const size_t n = observations_.size() / 2;
+  gtsam::FactorIndices removed(observations_.begin(),
+                               observations_.begin() + n);
+  if (summary_) removed.push_back(*summary_);
+
+  // The removed factors, linearized at the current estimate and combined.
+  gtsam::NonlinearFactorGraph old_factors;
+  for (gtsam::FactorIndex i : removed) {
+    old_factors.push_back(isam_.getFactorsUnsafe().at(i));
+  }
+  const auto linear = old_factors.linearize(estimate_);
+  gtsam::NonlinearFactorGraph summary;
+  summary.emplace_shared<gtsam::LinearContainerFactor>(
+      std::make_shared<gtsam::HessianFactor>(*linear), estimate_);
+
+  const gtsam::ISAM2Result result =
+      isam_.update(summary, Values(), removed);
+  observations_.erase(observations_.begin(), observations_.begin() + n);
+  summary_ = result.newFactorsIndices.back();
+  estimate_ = isam_.calculateEstimate();
+}
+
+/* ************************************************************************* */
+Pose3 KinematicCalibration::predict(const gtsam::Vector &q,
+                                    const std::string &start_link_name,
+                                    const std::string &end_link_name) const {
+  const Chain joints = chain(start_link_name, end_link_name);
+  Values values = estimate_;
+  for (auto &&[joint, forward] : joints) {
+    const int j = joint->id();
+    if (values.exists(EncoderOffsetKey(j))) continue;
+    values.insert(EncoderOffsetKey(j), 0.0);
+    if (params_.calibrate_locations) {
+      values.insert(JointLocationKey(j), Vector3::Zero().eval());
+    }
+  }
+  return chainExpression(q, joints).value(values);
+}
+
+/* ************************************************************************* */
+double KinematicCalibration::encoderOffset(int j) const {
+  const gtsam::Key key = EncoderOffsetKey(j);
+  return estimate_.exists(key) ? estimate_.at<double>(key) : 0.0;
+}
+
+/* ************************************************************************* */
+Vector3 KinematicCalibration::jointLocation(int j) const {
+  const gtsam::Key key = JointLocationKey(j);
+  return estimate_.exists(key) ? estimate_.at<Vector3>(key)
+                               : Vector3::Zero().eval();
+}
+
+}  // namespace gtdynamics
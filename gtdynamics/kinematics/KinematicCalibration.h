@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicCalibration.h
+ * @brief Online calibration of encoder offsets and joint locations with
+ * iSAM2.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/slam/expressions.h>
+
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Shorthand for qo_j, the offset added to the encoder reading of joint j.
+inline gtsam::Key EncoderOffsetKey(int j) {
+  return DynamicsSymbol::JointSymbol("qo", j, 0);
+}
+
+/// Shorthand for lo_j, the correction of the location of joint j, as a
+/// translation of its child link in the CoM frame of its parent link.
+inline gtsam::Key JointLocationKey(int j) {
+  return DynamicsSymbol::JointSymbol("lo", j, 0);
+}
+
+/// Parameters of KinematicCalibration.
+struct KinematicCalibrationParams {
+  /// Also calibrate the joint locations, i.e. the link lengths.
+  bool calibrate_locations = true;
+
+  /// Priors on the calibration, centered at the model.
+  double offset_prior_sigma = 0.1;
+  double location_prior_sigma = 0.01;
+
+  /// Noise of a measured relative pose of two links.
+  gtsam::SharedNoiseModel measurement_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+
+  /// Observations kept as nonlinear factors; when there are more, the older
+  /// half is summarized in one linear factor at the current estimate.
+  size_t max_observations = 100;
+
+  gtsam::ISAM2Params isam_params;
+};
+
+/**
+ * Online kinematic calibration. Each observation is the encoder readings of
+ * all joints with the pose of one link measured relative to another, e.g. by
+ * motion capture, and gives the factor of a ForwardKinematicsFactor with the
+ * encoder offsets, and optionally the joint locations, along the chain
+ * between the links as variables. Only calibration variables are estimated,
+ * and they are updated incrementally by iSAM2 after each observation.
+ *
+ * Since all observations involve the calibration, the cost of an iSAM2
+ * update grows with the number of factors. Observations beyond
+ * max_observations are therefore summarized, so each update takes bounded
+ * time and memory however long the data stream.
+ */
+class KinematicCalibration {
+ public:
+  /**
+   * Constructor.
+   * @param robot the robot model, with tree topology
+   * @param params calibration parameters
+   */
+  explicit KinematicCalibration(
+      const Robot &robot,
+      const KinematicCalibrationParams &params = KinematicCalibrationParams());
+
+  /**
+   * Add an observation and update the calibration.
+   * @param q encoder readings, indexed by joint id
+   * @param start_link_name link the pose is measured relative to
+   * @param end_link_name link whose pose is measured
+   * @param measured pose of the end link CoM in the start link CoM frame
+   */
+  void addObservation(const gtsam::Vector &q,
+                      const std::string &start_link_name,
+                      const std::string &end_link_name,
+                      const gtsam::Pose3 &measured);
+
+  /// Relative pose of two links by forward kinematics with the calibration.
+  gtsam::Pose3 predict(const gtsam::Vector &q,
+                       const std::string &start_link_name,
+                       const std::string &end_link_name) const;
+
+  /// Calibrated offset of the encoder of joint j, zero if not observed.
+  double encoderOffset(int j) const;
+
+  /// Calibrated correction of the location of joint j, zero if not observed.
+  gtsam::Vector3 jointLocation(int j) const;
+
+  /// Current estimate of all calibration variables.
+  const gtsam::Values &estimate() const { return estimate_; }
+
+  /// Number of observations added.
+  size_t numObservations() const { return num_observations_; }
+
+  /// The incremental solver.
+  const gtsam::ISAM2 &isam() const { return isam_; }
+
+ private:
+  /// Joints between two links, and whether each is traversed from parent to
+  /// child.
+  using Chain = std::vector<std::pair<JointSharedPtr, bool>>;
+  Chain chain(const std::string &start_link_name,
+              const std::string &end_link_name) const;
+
+  /// Relative pose of the end of a chain, with the calibration as expressions.
+  gtsam::Pose3_ chainExpression(const gtsam::Vector &q,
+                                const Chain &chain) const;
+
+  /// Replace the older half of the observations by a linear factor.
+  void summarize();
+
+  Robot robot_;
+  KinematicCalibrationParams params_;
+  gtsam::ISAM2 isam_;
+  gtsam::Values estimate_;
+
+  /// iSAM2 indices of the observation factors, oldest first, and of the
+  /// summary of earlier observations.
+  std::deque<gtsam::FactorIndex> observations_;
+  std::optional<gtsam::FactorIndex> summary_;
+  size_t num_observations_ = 0;
+};
+
+}  // namespace gtdynamics
@@ -15,12 +15,18 @@
 
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
 #include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/NoiseModels.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/Slice.h>
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <memory>
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -65,6 +71,38 @@ struct ContactGoal {
 ///< Map of link name to ContactGoal
 using ContactGoals = std::vector<ContactGoal>;
 
+/**
+ * Time interval of a densified trajectory where some contact point misses its
+ * goal. Times are continuous time steps, from the last satisfied sample
+ * before the violation to the first one after it, so that refining the
+ * interval covers the violation.
+ */
+struct ContactViolation {
+  double t_start, t_end;  ///< Bracketing samples, in time steps.
+  double max_error;       ///< Largest distance of a contact point to its goal.
+};
+
+/**
+ * Closed-form inverse kinematics on a slice, for robots with an analytic
+ * solver, e.g. IKFast. Kinematics::inverse uses its solution instead of, or
+ * as the initial values of, the nonlinear optimization.
+ */
+class AnalyticInverseKinematics {
+ public:
+  virtual ~AnalyticInverseKinematics() {}
+
+  /**
+   * @fn Solve for the joint angles and link poses at slice.k.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals goals for contact points
+   * @returns values with poses and joint angles, or empty values if the goals
+   * are not supported or cannot be reached.
+   */
+  virtual gtsam::Values solve(const Slice& slice, const Robot& robot,
+                              const ContactGoals& contact_goals) const = 0;
+};
+
 /// Noise models etc specific to Kinematics class
 struct KinematicsParameters : public OptimizationParameters {
   using Isotropic = gtsam::noiseModel::Isotropic;
@@ -72,11 +110,29 @@ struct KinematicsParameters : public OptimizationParameters {
       g_cost_model,                            // goal point
       prior_q_cost_model;                      // joint angle prior factor
 
+  // Inverse kinematics on an interval solves its slices independently, in
+  // parallel tasks of slices_per_task consecutive slices. With warm_start,
+  // every slice but the first of a task is initialized with the solution of
+  // the previous slice.
+  bool warm_start = false;
+  size_t slices_per_task = 4;
+
+  // Optional closed-form solver used by inverse kinematics on a slice; its
+  // solution is returned directly, or refined by the optimizer.
+  std::shared_ptr<const AnalyticInverseKinematics> analytic_ik;
+  bool refine_analytic_ik = false;
+
+  // Densification checks densify_samples samples per time step, in parallel
+  // on execution, against a tolerance of densify_tolerance in 3D.
+  size_t densify_samples = 10;
+  double densify_tolerance = 1e-3;
+  ExecutionContext execution = ExecutionContext::Default();
+
   // TODO(yetong): replace noise model with tolerance.
   KinematicsParameters()
-      : p_cost_model(Isotropic::Sigma(6, 1e-4)),
-        g_cost_model(Isotropic::Sigma(3, 0.01)),
-        prior_q_cost_model(Isotropic::Sigma(1, 0.5)) {}
+      : p_cost_model(InternedIsotropic(6, 1e-4)),
+        g_cost_model(InternedIsotropic(3, 0.01)),
+        prior_q_cost_model(InternedIsotropic(1, 0.5)) {}
 };
 
 /// All things kinematics, zero velocities/twists, and no forces.
@@ -169,6 +225,20 @@ class Kinematics : public Optimizer {
                         const ContactGoals& contact_goals,
                         bool contact_goals_as_constraints = true) const;
 
+  /**
+   * @fn Inverse kinematics on a slice, from given initial values.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals goals for contact points
+   * @param initial_values initial poses and joint angles at slice.k
+   * @param contact_goals_as_constraints treat contact goal as hard constraints
+   * @returns values with poses and joint angles.
+   */
+  gtsam::Values inverse(const Slice& slice, const Robot& robot,
+                        const ContactGoals& contact_goals,
+                        const gtsam::Values& initial_values,
+                        bool contact_goals_as_constraints = true) const;
+
   /**
    * Interpolate using inverse kinematics: the goals are linearly interpolated.
    * @param context Interval instance
@@ -181,5 +251,24 @@ class Kinematics : public Optimizer {
   gtsam::Values interpolate(const CONTEXT& context, const Robot& robot,
                             const ContactGoals& contact_goals1,
                             const ContactGoals& contact_goals2) const;
+
+  /**
+   * Check the contact goals in between the time steps of a trajectory, e.g.
+   * one returned by interpolate: joint angles are interpolated linearly
+   * between time steps, link poses follow from batch forward kinematics, and
+   * the goals are interpolated as in interpolate.
+   * @param context Interval instance
+   * @param robot Robot specification from URDF/SDF.
+   * @param values joint angles at all time steps of the interval, and poses of
+   * the root link if it is not fixed.
+   * @param contact_goals1 goals for contact points for context.k_start
+   * @param contact_goals2 goals for contact points for context.k_end
+   * @returns the intervals where a goal is violated, in time order.
+   */
+  template <class CONTEXT>
+  std::vector<ContactViolation> densify(
+      const CONTEXT& context, const Robot& robot, const gtsam::Values& values,
+      const ContactGoals& contact_goals1,
+      const ContactGoals& contact_goals2) const;
 };
 }  // namespace gtdynamics
@@ -11,12 +11,18 @@
  * @author: Frank Dellaert
  */
 
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/FactorGraphTemplate.h>
 #include <gtdynamics/utils/Interval.h>
 #include <gtdynamics/utils/Slice.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
@@ -90,23 +96,48 @@ Values Kinematics::inverse<Interval>(const Interval& interval,
                                      const Robot& robot,
                                      const ContactGoals& contact_goals,
                                      bool contact_goals_as_constraints) const {
+  // The slices are independent problems; tasks of consecutive slices are
+  // fixed, so that warm starts give the same result on any number of threads.
+  const size_t num_slices = interval.k_end - interval.k_start + 1;
+  const size_t slices_per_task = std::max<size_t>(1, p_.slices_per_task);
+  const size_t num_tasks = (num_slices + slices_per_task - 1) / slices_per_task;
+  vector<Values> slice_results(num_slices);
+  auto solveTask = [&](size_t task) {
+    const size_t begin = task * slices_per_task,
+                 end = std::min(begin + slices_per_task, num_slices);
+    for (size_t i = begin; i < end; i++) {
+      const Slice slice(interval.k_start + i);
+      const Values initial_values = p_.warm_start && i > begin
+                                        ? ShiftedValues(slice_results[i - 1], 1)
+                                        : initialValues(slice, robot);
+      slice_results[i] = inverse(slice, robot, contact_goals, initial_values,
+                                 contact_goals_as_constraints);
+    }
+  };
+  p_.execution.parallelFor(num_tasks, solveTask);
+
   Values results;
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    results.insert(
-        inverse(Slice(k), robot, contact_goals, contact_goals_as_constraints));
+  for (const Values& slice_result : slice_results) {
+    results.insert(slice_result);
   }
   return results;
 }
 
+/// Fraction of the interval elapsed at time step k, in [0, 1].
+static double InterpolationFraction(const Interval& interval, size_t k) {
+  if (interval.k_end == interval.k_start) return 0.0;
+  return static_cast<double>(k - interval.k_start) /
+         (interval.k_end - interval.k_start);
+}
+
 template <>
 Values Kinematics::interpolate<Interval>(
     const Interval& interval, const Robot& robot,
     const ContactGoals& contact_goals1,
     const ContactGoals& contact_goals2) const {
   Values result;
-  const double dt = 1.0 / (interval.k_start - interval.k_end);  // 5 6 7 8 9 [10
   for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    const double t = dt * (k - interval.k_start);
+    const double t = InterpolationFraction(interval, k);
     ContactGoals goals;
     transform(contact_goals1.begin(), contact_goals1.end(),
               contact_goals2.begin(), std::back_inserter(goals),
@@ -120,4 +151,96 @@ Values Kinematics::interpolate<Interval>(
   return result;
 }
 
+template <>
+vector<ContactViolation> Kinematics::densify<Interval>(
+    const Interval& interval, const Robot& robot, const Values& values,
+    const ContactGoals& contact_goals1,
+    const ContactGoals& contact_goals2) const {
+  if (contact_goals1.size() != contact_goals2.size()) {
+    throw std::invalid_argument(
+        "Kinematics::densify: goals at both ends should match");
+  }
+
+  // Dense samples s = 0..num_samples-1, at time k_start + s / samples.
+  const size_t samples = std::max<size_t>(1, p_.densify_samples);
+  const size_t num_samples = (interval.k_end - interval.k_start) * samples + 1;
+  auto time = [&](size_t s) {
+    return interval.k_start + static_cast<double>(s) / samples;
+  };
+
+  // The root is a fixed link, or else moves with its poses in values.
+  const auto& links = robot.links();
+  auto fixed =
+      std::find_if(links.begin(), links.end(),
+                   [](const LinkSharedPtr& l) { return l->isFixed(); });
+  const LinkSharedPtr root = fixed != links.end() ? *fixed : links.front();
+  const BatchForwardKinematics fk(robot, root->name(), gtsam::Pose3(),
+                                  p_.execution);
+
+  gtsam::Matrix q =
+      gtsam::Matrix::Zero(num_samples, robot.topology().joints.size());
+  for (size_t s = 0; s < num_samples; s++) {
+    const size_t k = interval.k_start + s / samples;
+    const double alpha = static_cast<double>(s % samples) / samples;
+    for (auto&& joint : robot.joints()) {
+      double q_s = JointAngle(values, joint->id(), k);
+      if (alpha > 0) {
+        q_s += alpha * (JointAngle(values, joint->id(), k + 1) - q_s);
+      }
+      q(s, joint->id()) = q_s;
+    }
+  }
+  const BatchLinkPoses poses = fk.compute(q);
+
+  // Largest goal error of every sample, in parallel chunks of samples.
+  const size_t chunk_size = 256;
+  vector<double> errors(num_samples, 0.0);
+  p_.execution.parallelFor(
+      (num_samples + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        const size_t end = std::min((chunk + 1) * chunk_size, num_samples);
+        for (size_t s = chunk * chunk_size; s < end; s++) {
+          const size_t k = interval.k_start + s / samples;
+          const double alpha = static_cast<double>(s % samples) / samples;
+          gtsam::Pose3 wTroot;
+          if (!root->isFixed()) {
+            wTroot = Pose(values, root->id(), k);
+            if (alpha > 0) {
+              wTroot = gtsam::interpolate<gtsam::Pose3>(
+                  wTroot, Pose(values, root->id(), k + 1), alpha);
+            }
+          }
+          const double t =
+              num_samples > 1 ? static_cast<double>(s) / (num_samples - 1)
+                              : 0.0;
+          for (size_t g = 0; g < contact_goals1.size(); g++) {
+            const ContactGoal& goal1 = contact_goals1[g];
+            const gtsam::Point3 goal_point =
+                (1.0 - t) * goal1.goal_point +
+                t * contact_goals2[g].goal_point;
+            const gtsam::Point3 point =
+                wTroot * poses.pose(goal1.link()->id(), s) *
+                goal1.contactInCoM();
+            errors[s] =
+                std::max(errors[s], gtsam::distance3(point, goal_point));
+          }
+        }
+      });
+
+  // Runs of violating samples, bracketed by their satisfied neighbors.
+  vector<ContactViolation> violations;
+  for (size_t s = 0; s < num_samples; s++) {
+    if (errors[s] <= p_.densify_tolerance) continue;
+    size_t end = s;
+    double max_error = errors[s];
+    while (end + 1 < num_samples && errors[end + 1] > p_.densify_tolerance) {
+      max_error = std::max(max_error, errors[++end]);
+    }
+    violations.push_back({time(s > 0 ? s - 1 : s),
+                          time(std::min(end + 1, num_samples - 1)),
+                          max_error});
+    s = end;
+  }
+  return violations;
+}
+
 }  // namespace gtdynamics
@@ -23,6 +23,12 @@ using gtsam::Values;
 using std::string;
 using std::vector;
 
-
+template <>
+Values Kinematics::inverse<Phase>(const Phase& phase, const Robot& robot,
+                                  const ContactGoals& contact_goals,
+                                  bool contact_goals_as_constraints) const {
+  return inverse(static_cast<const Interval&>(phase), robot, contact_goals,
+                 contact_goals_as_constraints);
+}
 
 }  // namespace gtdynamics
@@ -139,6 +139,22 @@ template <>
 Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
                                   const ContactGoals& contact_goals,
                                   bool contact_goals_as_constraints) const {
+  if (p_.analytic_ik) {
+    const Values solution = p_.analytic_ik->solve(slice, robot, contact_goals);
+    if (!solution.empty()) {
+      if (!p_.refine_analytic_ik) return solution;
+      return inverse(slice, robot, contact_goals, solution,
+                     contact_goals_as_constraints);
+    }
+  }
+  return inverse(slice, robot, contact_goals, initialValues(slice, robot),
+                 contact_goals_as_constraints);
+}
+
+Values Kinematics::inverse(const Slice& slice, const Robot& robot,
+                           const ContactGoals& contact_goals,
+                           const Values& initial_values,
+                           bool contact_goals_as_constraints) const {
   // Robot kinematics constraints
   auto constraints = this->constraints(slice, robot);
   NonlinearFactorGraph graph;
@@ -157,8 +173,6 @@ Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
   // graph.addPrior<gtsam::Pose3>(PoseKey(0, slice.k),
   // gtsam::Pose3(), nullptr);
 
-  auto initial_values = initialValues(slice, robot);
-
   return optimize(graph, constraints, initial_values);
 }
 }  // namespace gtdynamics
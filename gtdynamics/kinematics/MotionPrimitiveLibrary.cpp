@@ -0,0 +1,325 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MotionPrimitiveLibrary.cpp
+ * @brief Precomputed kinematic motion primitives of a legged robot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/kinematics/MotionPrimitiveLibrary.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+const char kMagic[] = "GTDMPLB1";
+const size_t kMagicSize = 8;
+
+// Points on the body, in its CoM frame, whose goals pin its pose.
+const Point3 kBodyPins[] = {Point3(0, 0, 0), Point3(0.1, 0, 0),
+                            Point3(0, 0.1, 0)};
+
+template <typename T>
+void WriteValue(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void ReadValue(std::istream &is, T *value) {
+  is.read(reinterpret_cast<char *>(value), sizeof(T));
+}
+
+/// Bytes left to read in a stream.
+uint64_t Remaining(std::istream &is) {
+  const std::streampos position = is.tellg();
+  is.seekg(0, std::ios::end);
+  const uint64_t remaining = uint64_t(is.tellg() - position);
+  is.seekg(position);
+  return remaining;
+}
+}  // namespace
+
+/* ************************************************************************* */
+ContactGoals MotionPrimitiveLibrary::SampleGoals(
+    const Robot &robot, const MotionPrimitiveLibraryParameters &parameters,
+    const MotionPrimitiveParameters &primitive, double s) {
+  if (primitive.gait >= parameters.gaits.size()) {
+    throw std::invalid_argument("MotionPrimitiveLibrary: no gait " +
+                                std::to_string(primitive.gait));
+  }
+  const Gait &gait = parameters.gaits[primitive.gait];
+  const LinkSharedPtr body = robot.link(parameters.body_name);
+  const Pose3 &wTb0 = body->bMcom();
+  const Point3 d = primitive.displacement();
+  const Point3 d_world = wTb0.rotation() * d;
+
+  ContactGoals goals;
+  const Pose3 wTb = wTb0 * Pose3(gtsam::Rot3(), s * d);
+  for (const Point3 &pin : kBodyPins) {
+    goals.emplace_back(PointOnLink(body, pin), wTb.transformFrom(pin));
+  }
+
+  // Every group of the gait swings in its share of the phase.
+  const double n = gait.size();
+  for (size_t g = 0; g < gait.size(); g++) {
+    const double u = std::clamp(s * n - g, 0.0, 1.0);
+    for (size_t f : gait[g]) {
+      const PointOnLink &foot = parameters.feet.at(f);
+      const Point3 rest = foot.link->bMcom().transformFrom(foot.point);
+      const double height = parameters.swing_height * std::sin(M_PI * u);
+      goals.emplace_back(foot, rest + u * d_world + Point3(0, 0, height));
+    }
+  }
+  return goals;
+}
+
+/* ************************************************************************* */
+MotionPrimitiveLibrary MotionPrimitiveLibrary::Generate(
+    const Robot &robot, const MotionPrimitiveLibraryParameters &parameters,
+    const Kinematics &kinematics) {
+  if (parameters.num_samples < 2) {
+    throw std::invalid_argument(
+        "MotionPrimitiveLibrary: need at least two samples per primitive.");
+  }
+  for (const Gait &gait : parameters.gaits) {
+    std::vector<size_t> swings(parameters.feet.size(), 0);
+    for (auto &&group : gait) {
+      for (size_t f : group) swings.at(f)++;
+    }
+    if (std::any_of(swings.begin(), swings.end(),
+                    [](size_t n) { return n != 1; })) {
+      throw std::invalid_argument(
+          "MotionPrimitiveLibrary: every foot must swing once in a gait.");
+    }
+  }
+
+  std::vector<int> joint_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+  MotionPrimitiveLibrary library(joint_ids,
+                                 robot.link(parameters.body_name)->id());
+
+  // The grid; a step of length zero has a single heading.
+  std::vector<MotionPrimitive> primitives;
+  for (size_t g = 0; g < parameters.gaits.size(); g++) {
+    for (double step_length : parameters.step_lengths) {
+      for (double heading : parameters.headings) {
+        MotionPrimitive primitive;
+        primitive.parameters = {g, step_length, step_length == 0 ? 0 : heading};
+        primitives.push_back(primitive);
+        if (step_length == 0) break;
+      }
+    }
+  }
+
+  // Solve the samples of each primitive, from the rest configuration.
+  Values rest;
+  for (auto &&link : robot.links()) {
+    InsertPose(&rest, link->id(), link->bMcom());
+  }
+  for (int j : joint_ids) InsertJointAngle(&rest, j, 0.0);
+  const Slice slice(0);
+  parameters.execution.parallelFor(primitives.size(), [&](size_t i) {
+    MotionPrimitive &primitive = primitives[i];
+    Values values = rest;
+    for (size_t n = 0; n < parameters.num_samples; n++) {
+      const double s = double(n) / (parameters.num_samples - 1);
+      const ContactGoals goals =
+          SampleGoals(robot, parameters, primitive.parameters, s);
+      values = kinematics.inverse(slice, robot, goals, values);
+      Vector q(joint_ids.size());
+      for (size_t j = 0; j < joint_ids.size(); j++) {
+        q(j) = JointAngle(values, joint_ids[j]);
+      }
+      primitive.joint_angles.push_back(q);
+    }
+  });
+
+  for (const MotionPrimitive &primitive : primitives) library.add(primitive);
+  return library;
+}
+
+/* ************************************************************************* */
+void MotionPrimitiveLibrary::add(const MotionPrimitive &primitive) {
+  if (primitive.joint_angles.empty()) {
+    throw std::invalid_argument("MotionPrimitiveLibrary: empty primitive.");
+  }
+  for (const Vector &q : primitive.joint_angles) {
+    if (size_t(q.size()) != joint_ids_.size()) {
+      throw std::invalid_argument(
+          "MotionPrimitiveLibrary: need one joint angle per joint.");
+    }
+  }
+  const size_t gait = primitive.parameters.gait;
+  if (by_gait_.size() <= gait) by_gait_.resize(gait + 1);
+  by_gait_[gait].push_back(primitives_.size());
+  primitives_.push_back(primitive);
+}
+
+/* ************************************************************************* */
+std::vector<size_t> MotionPrimitiveLibrary::nearest(
+    const MotionPrimitiveParameters &query, size_t num) const {
+  if (query.gait >= by_gait_.size()) return {};
+  const Point3 d = query.displacement();
+  std::vector<std::pair<double, size_t>> candidates;
+  for (size_t i : by_gait_[query.gait]) {
+    const double distance =
+        (primitives_[i].parameters.displacement() - d).norm();
+    candidates.emplace_back(distance, i);
+  }
+  num = std::min(num, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + num,
+                    candidates.end());
+
+  std::vector<size_t> indices;
+  for (size_t n = 0; n < num; n++) indices.push_back(candidates[n].second);
+  return indices;
+}
+
+/* ************************************************************************* */
+Vector MotionPrimitiveLibrary::jointAngles(size_t i, double s) const {
+  const std::vector<Vector> &samples = primitive(i).joint_angles;
+  if (samples.size() == 1) return samples[0];
+  const double x = std::clamp(s, 0.0, 1.0) * (samples.size() - 1);
+  const size_t n = std::min(size_t(x), samples.size() - 2);
+  const double t = x - n;
+  return (1 - t) * samples[n] + t * samples[n + 1];
+}
+
+/* ************************************************************************* */
+Vector MotionPrimitiveLibrary::jointAngles(
+    const MotionPrimitiveParameters &query, double s, size_t num_blend) const {
+  const std::vector<size_t> indices =
+      nearest(query, std::max<size_t>(num_blend, 1));
+  if (indices.empty()) {
+    throw std::invalid_argument(
+        "MotionPrimitiveLibrary: no primitives of gait " +
+        std::to_string(query.gait));
+  }
+
+  const Point3 d = query.displacement();
+  Vector q = Vector::Zero(joint_ids_.size());
+  double total = 0;
+  for (size_t i : indices) {
+    const double distance =
+        (primitives_[i].parameters.displacement() - d).norm();
+    if (distance < 1e-9) return jointAngles(i, s);
+    q += jointAngles(i, s) / distance;
+    total += 1 / distance;
+  }
+  return q / total;
+}
+
+/* ************************************************************************* */
+Values MotionPrimitiveLibrary::values(const MotionPrimitiveParameters &query,
+                                      double s, const Pose3 &wTb_start,
+                                      size_t k, size_t num_blend) const {
+  const Vector q = jointAngles(query, s, num_blend);
+  Values values;
+  for (size_t j = 0; j < joint_ids_.size(); j++) {
+    InsertJointAngle(&values, joint_ids_[j], k, q(j));
+  }
+  const double t = std::clamp(s, 0.0, 1.0);
+  InsertPose(&values, body_id_, k,
+             wTb_start * Pose3(gtsam::Rot3(), t * query.displacement()));
+  return values;
+}
+
+/* ************************************************************************* */
+void MotionPrimitiveLibrary::save(const std::string &path) const {
+  std::ofstream os(path, std::ios::binary);
+  if (!os.good()) {
+    throw std::runtime_error("MotionPrimitiveLibrary: cannot write " + path);
+  }
+  os.write(kMagic, kMagicSize);
+  WriteValue(os, int64_t(body_id_));
+  WriteValue(os, uint64_t(joint_ids_.size()));
+  for (int j : joint_ids_) WriteValue(os, int64_t(j));
+  WriteValue(os, uint64_t(primitives_.size()));
+  for (const MotionPrimitive &primitive : primitives_) {
+    WriteValue(os, uint64_t(primitive.parameters.gait));
+    WriteValue(os, primitive.parameters.step_length);
+    WriteValue(os, primitive.parameters.heading);
+    WriteValue(os, uint64_t(primitive.joint_angles.size()));
+    for (const Vector &q : primitive.joint_angles) {
+      os.write(reinterpret_cast<const char *>(q.data()),
+               q.size() * sizeof(double));
+    }
+  }
+  if (!os.good()) {
+    throw std::runtime_error("MotionPrimitiveLibrary: cannot write " + path);
+  }
+}
+
+/* ************************************************************************* */
+MotionPrimitiveLibrary MotionPrimitiveLibrary::Load(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good()) {
+    throw std::runtime_error("MotionPrimitiveLibrary: no file found at " +
+                             path);
+  }
+  char magic[kMagicSize];
+  is.read(magic, kMagicSize);
+  int64_t body_id = 0;
+  uint64_t num_joints = 0;
+  ReadValue(is, &body_id);
+  ReadValue(is, &num_joints);
+  if (!is.good() || std::memcmp(magic, kMagic, kMagicSize) != 0) {
+    throw std::runtime_error("MotionPrimitiveLibrary: not a library: " + path);
+  }
+
+  // Check the sizes before allocating, so corrupt counts do not.
+  const std::runtime_error truncated(
+      "MotionPrimitiveLibrary: truncated file: " + path);
+  if (Remaining(is) / sizeof(int64_t) < num_joints) throw truncated;
+  std::vector<int> joint_ids(num_joints);
+  for (int &j : joint_ids) {
+    int64_t id = 0;
+    ReadValue(is, &id);
+    j = int(id);
+  }
+  MotionPrimitiveLibrary library(joint_ids, int(body_id));
+
+  uint64_t num_primitives = 0;
+  ReadValue(is, &num_primitives);
+  for (uint64_t i = 0; i < num_primitives; i++) {
+    MotionPrimitive primitive;
+    uint64_t gait = 0, num_samples = 0;
+    ReadValue(is, &gait);
+    ReadValue(is, &primitive.parameters.step_length);
+    ReadValue(is, &primitive.parameters.heading);
+    ReadValue(is, &num_samples);
+    if (!is.good() || num_joints == 0 ||
+        Remaining(is) / (num_joints * sizeof(double)) < num_samples) {
+      throw truncated;
+    }
+    primitive.parameters.gait = gait;
+    for (uint64_t n = 0; n < num_samples; n++) {
+      Vector q(num_joints);
+      is.read(reinterpret_cast<char *>(q.data()), num_joints * sizeof(double));
+      primitive.joint_angles.push_back(q);
+    }
+    library.add(primitive);
+  }
+  if (!is.good()) throw truncated;
+  return library;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,189 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MotionPrimitiveLibrary.h
+ * @brief Precomputed kinematic motion primitives of a legged robot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Gait of a primitive: groups of feet, as indices into the feet of the
+/// library, which swing one after the other, all feet of a group together.
+using Gait = std::vector<std::vector<size_t>>;
+
+/// Parameters of a motion primitive.
+struct MotionPrimitiveParameters {
+  size_t gait = 0;           ///< Index of the gait.
+  double step_length = 0.0;  ///< Displacement of the body, in meters.
+  double heading = 0.0;      ///< Direction of the displacement, in radians
+                             ///< from the x axis of the body.
+
+  /// Displacement of the body in its start frame, where a primitive is
+  /// retargeted; primitives which displace it alike are alike.
+  gtsam::Point3 displacement() const {
+    return step_length * gtsam::Point3(std::cos(heading), std::sin(heading), 0);
+  }
+};
+
+/// Grid of primitives and the stride they are solved for.
+struct MotionPrimitiveLibraryParameters {
+  std::string body_name = "body";  ///< Link the displacement applies to.
+  PointOnLinks feet;               ///< Contact points of the feet.
+  std::vector<Gait> gaits;         ///< Gaits, indexed by parameters.gait.
+  std::vector<double> step_lengths = {0.0, 0.05, 0.1};
+  std::vector<double> headings = {0.0, M_PI_2, M_PI, -M_PI_2};
+
+  size_t num_samples = 21;     ///< Samples per primitive, including both ends.
+  double swing_height = 0.05;  ///< Peak height of a swinging foot.
+
+  /// Primitives are solved in parallel, each sample warm-started from the
+  /// previous one.
+  ExecutionContext execution = ExecutionContext::Default();
+};
+
+/**
+ * One stride of body motion and the joint angles that realize it. The body
+ * moves by a constant velocity displacement in its start frame, and every foot
+ * swings once, from its rest foothold to the foothold moved by the same
+ * displacement, with the groups of the gait in turn.
+ */
+struct MotionPrimitive {
+  MotionPrimitiveParameters parameters;
+
+  /// Joint angles at evenly spaced phases in [0, 1], in the order of
+  /// MotionPrimitiveLibrary::jointIds().
+  std::vector<gtsam::Vector> joint_angles;
+};
+
+/**
+ * A library of motion primitives for online footstep planning: the strides of
+ * a grid of gaits, step lengths and headings are solved once with Kinematics
+ * inverse kinematics, and retargeted at runtime without solving, by blending
+ * the joint angles of the nearest primitives of a gait.
+ *
+ * Primitives are indexed by gait, and looked up by the distance between the
+ * displacements of the body, so that headings wrap around and all headings of
+ * a step of length zero are alike. Libraries are saved as compact binary
+ * files.
+ */
+class MotionPrimitiveLibrary {
+ public:
+  /// Empty library for the given joints and body link.
+  MotionPrimitiveLibrary(const std::vector<int> &joint_ids = {},
+                         int body_id = 0)
+      : joint_ids_(joint_ids), body_id_(body_id) {}
+
+  /**
+   * Solve the primitives of all gaits, step lengths and headings of the
+   * parameters, from the rest configuration of the robot.
+   * @param robot       the robot, at rest with all feet on the ground
+   * @param parameters  grid of primitives, feet and gaits
+   * @param kinematics  inverse kinematics solver
+   */
+  static MotionPrimitiveLibrary Generate(
+      const Robot &robot, const MotionPrimitiveLibraryParameters &parameters,
+      const Kinematics &kinematics = Kinematics());
+
+  /**
+   * Contact goals of one sample of a primitive, in the frame where the robot
+   * is at rest: three points which pin the body, and the feet.
+   * @param robot       the robot, at rest with all feet on the ground
+   * @param parameters  feet, gaits and swing height
+   * @param primitive   gait and displacement
+   * @param s           phase in [0, 1]
+   */
+  static ContactGoals SampleGoals(
+      const Robot &robot, const MotionPrimitiveLibraryParameters &parameters,
+      const MotionPrimitiveParameters &primitive, double s);
+
+  /// Add a primitive; throws if its joint angles do not fit the library.
+  void add(const MotionPrimitive &primitive);
+
+  /// Number of primitives.
+  size_t size() const { return primitives_.size(); }
+
+  /// The i-th primitive, in the order of addition.
+  const MotionPrimitive &primitive(size_t i) const { return primitives_.at(i); }
+
+  /// Joint ids of the joint angle vectors.
+  const std::vector<int> &jointIds() const { return joint_ids_; }
+
+  /// Id of the body link.
+  int bodyId() const { return body_id_; }
+
+  /**
+   * Indices of the primitives of query.gait with the nearest displacements,
+   * closest first.
+   * @param query     gait and displacement to look up
+   * @param num       number of primitives to return, at most
+   */
+  std::vector<size_t> nearest(const MotionPrimitiveParameters &query,
+                              size_t num = 1) const;
+
+  /**
+   * Joint angles of a primitive at phase s, by linear interpolation between
+   * its samples.
+   */
+  gtsam::Vector jointAngles(size_t i, double s) const;
+
+  /**
+   * Joint angles for a query at phase s, retargeted from the nearest
+   * primitives of its gait: their joint angles are blended with inverse
+   * distance weights, and equal those of a primitive of the query.
+   * @param query     gait and displacement
+   * @param s         phase in [0, 1]
+   * @param num_blend number of primitives blended
+   */
+  gtsam::Vector jointAngles(const MotionPrimitiveParameters &query, double s,
+                            size_t num_blend = 3) const;
+
+  /**
+   * Retarget a query at phase s to a start pose: the joint angles and the pose
+   * of the body link at time step k, e.g. as initial values for Kinematics or
+   * as input of forward kinematics.
+   * @param query     gait and displacement
+   * @param s         phase in [0, 1]
+   * @param wTb_start pose of the body at the start of the primitive
+   * @param k         time step of the values
+   * @param num_blend number of primitives blended
+   */
+  gtsam::Values values(const MotionPrimitiveParameters &query, double s,
+                       const gtsam::Pose3 &wTb_start, size_t k = 0,
+                       size_t num_blend = 3) const;
+
+  /// Write the library to a binary file; throws if it cannot be written.
+  void save(const std::string &path) const;
+
+  /// Read a library written by save; throws if the file is missing or
+  /// corrupt.
+  static MotionPrimitiveLibrary Load(const std::string &path);
+
+ private:
+  std::vector<int> joint_ids_;
+  int body_id_;
+  std::vector<MotionPrimitive> primitives_;
+  std::vector<std::vector<size_t>> by_gait_;  // primitive indices per gait
+};
+
+}  // namespace gtdynamics
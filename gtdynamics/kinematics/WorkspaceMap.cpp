@@ -0,0 +1,369 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WorkspaceMap.cpp
+ * @brief Voxelized reachability and manipulability of an end-effector.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/kinematics/WorkspaceMap.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Vector3;
+
+namespace {
+const char kMagic[] = "GTDWMAP1";
+const size_t kMagicSize = 8;
+
+// Grid coordinates are packed in 21 bits each, offset to be non-negative.
+const int64_t kCoordinateBits = 21;
+const int64_t kCoordinateOffset = int64_t(1) << (kCoordinateBits - 1);
+const uint64_t kCoordinateMask = (uint64_t(1) << kCoordinateBits) - 1;
+
+// Joint angle step of the finite difference Jacobians.
+const double kJacobianStep = 1e-6;
+
+using VoxelTable = std::unordered_map<uint64_t, WorkspaceMap::Voxel>;
+
+/// Combine the samples of two voxels; the result does not depend on order.
+void Accumulate(const WorkspaceMap::Voxel &sample,
+                WorkspaceMap::Voxel *voxel) {
+  voxel->count += sample.count;
+  voxel->manipulability =
+      std::max(voxel->manipulability, sample.manipulability);
+  voxel->directions |= sample.directions;
+}
+
+template <typename T>
+void WriteValue(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void ReadValue(std::istream &is, T *value) {
+  is.read(reinterpret_cast<char *>(value), sizeof(T));
+}
+}  // namespace
+
+/* ************************************************************************* */
+double WorkspaceMap::Voxel::reachability() const {
+  return double(std::bitset<32>(directions).count()) / kNumDirections;
+}
+
+/* ************************************************************************* */
+Vector3 WorkspaceMap::BinDirection(size_t d) {
+  // Fibonacci lattice: equal-area bands in z, golden angle steps in azimuth.
+  const double z = 1.0 - (2.0 * d + 1.0) / kNumDirections;
+  const double r = std::sqrt(1.0 - z * z);
+  const double phi = d * M_PI * (3.0 - std::sqrt(5.0));
+  return Vector3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+/* ************************************************************************* */
+size_t WorkspaceMap::DirectionBin(const Vector3 &direction) {
+  size_t best = 0;
+  double best_dot = -2.0;
+  for (size_t d = 0; d < kNumDirections; ++d) {
+    const double dot = BinDirection(d).dot(direction);
+    if (dot > best_dot) {
+      best = d;
+      best_dot = dot;
+    }
+  }
+  return best;
+}
+
+/* ************************************************************************* */
+WorkspaceMap::WorkspaceMap(double voxel_size) : voxel_size_(voxel_size) {
+  if (!(voxel_size > 0)) {
+    throw std::invalid_argument("WorkspaceMap: voxel size must be positive");
+  }
+}
+
+/* ************************************************************************* */
+uint64_t WorkspaceMap::key(const Point3 &point) const {
+  uint64_t key = 0;
+  for (int a = 0; a < 3; ++a) {
+    const int64_t coordinate =
+        static_cast<int64_t>(std::floor(point(a) / voxel_size_));
+    const int64_t shifted = coordinate + kCoordinateOffset;
+    if (shifted < 0 || shifted > int64_t(kCoordinateMask)) {
+      throw std::out_of_range("WorkspaceMap: point outside of the grid");
+    }
+    key = (key << kCoordinateBits) | uint64_t(shifted);
+  }
+  return key;
+}
+
+/* ************************************************************************* */
+size_t WorkspaceMap::index(uint64_t key) const {
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key) return keys_.size();
+  return it - keys_.begin();
+}
+
+/* ************************************************************************* */
+void WorkspaceMap::add(const Point3 &point, const Vector3 &direction,
+                       double manipulability) {
+  Voxel sample;
+  sample.count = 1;
+  sample.manipulability = static_cast<float>(manipulability);
+  sample.directions = uint32_t(1) << DirectionBin(direction);
+
+  const uint64_t k = key(point);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), k);
+  const size_t i = it - keys_.begin();
+  if (it == keys_.end() || *it != k) {
+    keys_.insert(it, k);
+    voxels_.insert(voxels_.begin() + i, Voxel());
+  }
+  Accumulate(sample, &voxels_[i]);
+}
+
+/* ************************************************************************* */
+void WorkspaceMap::merge(const WorkspaceMap &other) {
+  if (other.voxel_size_ != voxel_size_) {
+    throw std::invalid_argument("WorkspaceMap::merge: different voxel sizes");
+  }
+
+  // Merge the two sorted key lists.
+  std::vector<uint64_t> keys;
+  std::vector<Voxel> voxels;
+  keys.reserve(keys_.size() + other.keys_.size());
+  voxels.reserve(keys.capacity());
+  size_t i = 0, j = 0;
+  while (i < keys_.size() || j < other.keys_.size()) {
+    const bool take_this =
+        j == other.keys_.size() ||
+        (i < keys_.size() && keys_[i] <= other.keys_[j]);
+    const bool take_other =
+        i == keys_.size() ||
+        (j < other.keys_.size() && other.keys_[j] <= keys_[i]);
+    keys.push_back(take_this ? keys_[i] : other.keys_[j]);
+    voxels.push_back(Voxel());
+    if (take_this) Accumulate(voxels_[i++], &voxels.back());
+    if (take_other) Accumulate(other.voxels_[j++], &voxels.back());
+  }
+  keys_ = std::move(keys);
+  voxels_ = std::move(voxels);
+}
+
+/* ************************************************************************* */
+const WorkspaceMap::Voxel *WorkspaceMap::find(const Point3 &point) const {
+  if (keys_.empty()) return nullptr;
+  uint64_t k;
+  try {
+    k = key(point);
+  } catch (const std::out_of_range &) {
+    return nullptr;
+  }
+  const size_t i = index(k);
+  return i < keys_.size() ? &voxels_[i] : nullptr;
+}
+
+/* ************************************************************************* */
+double WorkspaceMap::manipulability(const Point3 &point) const {
+  const Voxel *voxel = find(point);
+  return voxel ? voxel->manipulability : 0.0;
+}
+
+/* ************************************************************************* */
+double WorkspaceMap::reachability(const Point3 &point) const {
+  const Voxel *voxel = find(point);
+  return voxel ? voxel->reachability() : 0.0;
+}
+
+/* ************************************************************************* */
+Point3 WorkspaceMap::center(size_t i) const {
+  const uint64_t k = keys_.at(i);
+  Point3 center;
+  for (int a = 0; a < 3; ++a) {
+    const int64_t shifted =
+        (k >> ((2 - a) * kCoordinateBits)) & kCoordinateMask;
+    center(a) = (double(shifted - kCoordinateOffset) + 0.5) * voxel_size_;
+  }
+  return center;
+}
+
+/* ************************************************************************* */
+WorkspaceMap WorkspaceMap::Generate(
+    const Robot &robot, const PointOnLink &end_effector,
+    const WorkspaceMapParameters &parameters,
+    const std::optional<std::string> &root_link_name,
+    const gtsam::Pose3 &root_pose) {
+  if (parameters.batch_size == 0) {
+    throw std::invalid_argument("WorkspaceMap::Generate: empty batches");
+  }
+  const BatchForwardKinematics fk(robot, root_link_name, root_pose,
+                                  parameters.execution);
+  const WorkspaceMap empty(parameters.voxel_size);
+
+  // Sampled joint ids and their ranges; q has a column per joint id.
+  std::vector<int> ids;
+  std::vector<std::uniform_real_distribution<double>> ranges;
+  const Eigen::Index num_columns = robot.topology().joints.size();
+  for (auto &&joint : robot.joints()) {
+    const JointScalarLimit &limits = joint->parameters().scalar_limits;
+    const double range = parameters.max_joint_range;
+    const double lower = std::max(limits.value_lower_limit, -range);
+    const double upper = std::min(limits.value_upper_limit, range);
+    ids.push_back(joint->id());
+    ranges.emplace_back(lower, std::max(lower, upper));
+  }
+  const size_t n = ids.size();
+  const int ee = end_effector.link->id();
+  const Point3 &point = end_effector.point;
+  const Vector3 &axis = parameters.approach_axis;
+
+  // Each batch computes FK of its samples and of the samples with one joint
+  // perturbed, for the Jacobians, in a single call.
+  const size_t num_batches =
+      (parameters.num_samples + parameters.batch_size - 1) /
+      parameters.batch_size;
+  VoxelTable table;
+  std::mutex mutex;
+  parameters.execution.parallelFor(num_batches, [&](size_t b) {
+    const size_t begin = b * parameters.batch_size;
+    const Eigen::Index m =
+        std::min(parameters.batch_size, parameters.num_samples - begin);
+    std::mt19937_64 rng(parameters.seed * 0x9E3779B97F4A7C15ull + b);
+    auto distributions = ranges;
+    gtsam::Matrix q = gtsam::Matrix::Zero((n + 1) * m, num_columns);
+    for (Eigen::Index r = 0; r < m; ++r) {
+      for (size_t c = 0; c < n; ++c) q(r, ids[c]) = distributions[c](rng);
+    }
+    for (size_t c = 0; c < n; ++c) {
+      const Eigen::Index offset = (c + 1) * m;
+      q.middleRows(offset, m) = q.topRows(m);
+      q.col(ids[c]).segment(offset, m).array() += kJacobianStep;
+    }
+    const BatchLinkPoses poses = fk.compute(q);
+    const BatchLinkPoses::Block &P = poses.links[ee];
+    auto position = [&](Eigen::Index r) {
+      Point3 p;
+      for (int a = 0; a < 3; ++a) {
+        p(a) = P(3 * a, r) * point.x() + P(3 * a + 1, r) * point.y() +
+               P(3 * a + 2, r) * point.z() + P(9 + a, r);
+      }
+      return p;
+    };
+
+    VoxelTable local;
+    gtsam::Matrix J(3, n);
+    for (Eigen::Index r = 0; r < m; ++r) {
+      const Point3 p = position(r);
+      Vector3 direction;
+      for (int a = 0; a < 3; ++a) {
+        direction(a) = P(3 * a, r) * axis.x() + P(3 * a + 1, r) * axis.y() +
+                       P(3 * a + 2, r) * axis.z();
+      }
+      for (size_t c = 0; c < n; ++c) {
+        J.col(c) = (position((c + 1) * m + r) - p) / kJacobianStep;
+      }
+      const double det =
+          n >= 3 ? (J * J.transpose()).determinant()
+                 : (J.transpose() * J).determinant();
+
+      Voxel sample;
+      sample.count = 1;
+      sample.manipulability = static_cast<float>(std::sqrt(std::max(det, 0.0)));
+      sample.directions = uint32_t(1) << DirectionBin(direction.normalized());
+      Accumulate(sample, &local[empty.key(p)]);
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (auto &&entry : local) Accumulate(entry.second, &table[entry.first]);
+  });
+
+  // Sort the reached voxels by key.
+  WorkspaceMap map(parameters.voxel_size);
+  map.keys_.reserve(table.size());
+  for (auto &&entry : table) map.keys_.push_back(entry.first);
+  std::sort(map.keys_.begin(), map.keys_.end());
+  map.voxels_.reserve(table.size());
+  for (uint64_t k : map.keys_) map.voxels_.push_back(table[k]);
+  return map;
+}
+
+/* ************************************************************************* */
+void WorkspaceMap::save(const std::string &path) const {
+  std::ofstream os(path, std::ios::binary);
+  if (!os.good()) {
+    throw std::runtime_error("WorkspaceMap: cannot write " + path);
+  }
+  os.write(kMagic, kMagicSize);
+  WriteValue(os, voxel_size_);
+  WriteValue(os, uint64_t(keys_.size()));
+  os.write(reinterpret_cast<const char *>(keys_.data()),
+           keys_.size() * sizeof(uint64_t));
+  for (const Voxel &voxel : voxels_) {
+    WriteValue(os, voxel.count);
+    WriteValue(os, voxel.manipulability);
+    WriteValue(os, voxel.directions);
+  }
+  if (!os.good()) {
+    throw std::runtime_error("WorkspaceMap: cannot write " + path);
+  }
+}
+
+/* ************************************************************************* */
+WorkspaceMap WorkspaceMap::Load(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good()) {
+    throw std::runtime_error("WorkspaceMap: no file found at " + path);
+  }
+  char magic[kMagicSize];
+  is.read(magic, kMagicSize);
+  double voxel_size = 0;
+  uint64_t num_voxels = 0;
+  ReadValue(is, &voxel_size);
+  ReadValue(is, &num_voxels);
+  if (!is.good() || std::memcmp(magic, kMagic, kMagicSize) != 0 ||
+      !(voxel_size > 0)) {
+    throw std::runtime_error("WorkspaceMap: not a workspace map: " + path);
+  }
+
+  // Check the size before allocating, so corrupt counts do not.
+  const std::streampos start = is.tellg();
+  is.seekg(0, std::ios::end);
+  const uint64_t remaining = uint64_t(is.tellg() - start);
+  is.seekg(start);
+  if (remaining / (sizeof(uint64_t) + 3 * sizeof(uint32_t)) < num_voxels) {
+    throw std::runtime_error("WorkspaceMap: truncated file: " + path);
+  }
+
+  WorkspaceMap map(voxel_size);
+  map.keys_.resize(num_voxels);
+  map.voxels_.resize(num_voxels);
+  is.read(reinterpret_cast<char *>(map.keys_.data()),
+          num_voxels * sizeof(uint64_t));
+  for (Voxel &voxel : map.voxels_) {
+    ReadValue(is, &voxel.count);
+    ReadValue(is, &voxel.manipulability);
+    ReadValue(is, &voxel.directions);
+  }
+  if (!is.good() || !std::is_sorted(map.keys_.begin(), map.keys_.end())) {
+    throw std::runtime_error("WorkspaceMap: corrupt file: " + path);
+  }
+  return map;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WorkspaceMap.h
+ * @brief Voxelized reachability and manipulability of an end-effector.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Sampling of the joint space by WorkspaceMap::Generate.
+struct WorkspaceMapParameters {
+  double voxel_size = 0.05;      ///< Edge of the cubic voxels, in meters.
+  size_t num_samples = 1000000;  ///< Joint configurations sampled.
+  size_t batch_size = 4096;      ///< Configurations per batch FK call.
+  uint64_t seed = 0;             ///< Seed of the sampler, see below.
+
+  /// Axis of the end-effector link's CoM frame whose world direction is
+  /// recorded, e.g. the approach axis of a gripper.
+  gtsam::Vector3 approach_axis = gtsam::Vector3(0, 0, 1);
+
+  /// Joint angles are sampled uniformly between the joint limits, clamped to
+  /// [-max_joint_range, max_joint_range] for unlimited joints.
+  double max_joint_range = M_PI;
+
+  /// Threads running the batches. Each batch has its own sampler seeded with
+  /// seed and the batch index, so the map does not depend on the threads.
+  ExecutionContext execution = ExecutionContext::Default();
+};
+
+/**
+ * Workspace of a point on an end-effector link: the voxels of space the point
+ * reaches, each with the number of samples that reached it, the best
+ * manipulability sqrt(det(J J^T)) of the point's position Jacobian J among
+ * them, and the set of approach directions reached, binned on the sphere.
+ *
+ * Maps are generated once, e.g. for base placement, by sampling the joint
+ * space with BatchForwardKinematics, and queried at runtime in O(log n) per
+ * point. Only reached voxels are stored, sorted by their grid coordinates,
+ * and saved as such in a compact binary file.
+ */
+class WorkspaceMap {
+ public:
+  /// Statistics of one reached voxel.
+  struct Voxel {
+    uint32_t count = 0;           ///< Samples that reached the voxel.
+    float manipulability = 0.0f;  ///< Best manipulability of the samples.
+    uint32_t directions = 0;      ///< Bit d set if direction bin d reached.
+
+    /// Fraction of the direction bins reached, in [0, 1].
+    double reachability() const;
+  };
+
+  /// Number of approach direction bins, near-uniform on the sphere.
+  static constexpr size_t kNumDirections = 32;
+
+  /// Unit direction of bin d.
+  static gtsam::Vector3 BinDirection(size_t d);
+
+  /// Bin of the direction closest to a unit vector.
+  static size_t DirectionBin(const gtsam::Vector3 &direction);
+
+  /// Empty map with the given voxel size.
+  explicit WorkspaceMap(double voxel_size = 0.05);
+
+  /**
+   * Sample the joint space and voxelize the positions of the end-effector
+   * point, in the frame of the root link.
+   * @param robot          the robot, with joint limits
+   * @param end_effector   point on the end-effector link, in its CoM frame
+   * @param parameters     voxel size, samples and threads
+   * @param root_link_name root of the kinematic tree, as for
+   * BatchForwardKinematics
+   * @param root_pose      pose of the root link, ignored if it is fixed
+   */
+  static WorkspaceMap Generate(
+      const Robot &robot, const PointOnLink &end_effector,
+      const WorkspaceMapParameters &parameters = WorkspaceMapParameters(),
+      const std::optional<std::string> &root_link_name = {},
+      const gtsam::Pose3 &root_pose = gtsam::Pose3());
+
+  /// Add one sample of the end-effector.
+  void add(const gtsam::Point3 &point, const gtsam::Vector3 &direction,
+           double manipulability);
+
+  /// Add all samples of another map with the same voxel size.
+  void merge(const WorkspaceMap &other);
+
+  /// Voxel containing a point, or nullptr if no sample reached it.
+  const Voxel *find(const gtsam::Point3 &point) const;
+
+  /// Whether a sample reached the voxel of a point.
+  bool reachable(const gtsam::Point3 &point) const {
+    return find(point) != nullptr;
+  }
+
+  /// Best manipulability in the voxel of a point, 0 if not reached.
+  double manipulability(const gtsam::Point3 &point) const;
+
+  /// Fraction of approach directions reached in the voxel of a point.
+  double reachability(const gtsam::Point3 &point) const;
+
+  /// Edge of the voxels.
+  double voxelSize() const { return voxel_size_; }
+
+  /// Number of reached voxels.
+  size_t numVoxels() const { return keys_.size(); }
+
+  /// Center of the i-th reached voxel, in storage order.
+  gtsam::Point3 center(size_t i) const;
+
+  /// Statistics of the i-th reached voxel, in storage order.
+  const Voxel &voxel(size_t i) const { return voxels_.at(i); }
+
+  /// Write the map to a binary file; throws if it cannot be written.
+  void save(const std::string &path) const;
+
+  /// Read a map written by save; throws if the file is missing or corrupt.
+  static WorkspaceMap Load(const std::string &path);
+
+ private:
+  double voxel_size_;
+  std::vector<uint64_t> keys_;  // packed grid coordinates, sorted
+  std::vector<Voxel> voxels_;   // statistics, in the order of keys_
+
+  /// Packed grid coordinates of the voxel containing a point.
+  uint64_t key(const gtsam::Point3 &point) const;
+
+  /// Index of a key in keys_, or keys_.size() if absent.
+  size_t index(uint64_t key) const;
+};
+
+}  // namespace gtdynamics
@@ -12,6 +12,14 @@
  */
 
 #include <gtdynamics/manifold/ConnectedComponent.h>
+#include <gtdynamics/utils/KeyEncoding.h>
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
 
 namespace gtsam {
 
@@ -25,4 +33,58 @@ NonlinearFactorGraph ConnectedComponent::constructMeritGraph(
   return graph;
 }
 
+/* ************************************************************************* */
+ConnectedComponent::shared_ptr ComponentStructureCache::create(
+    const gtdynamics::EqualityConstraints &constraints) {
+  using Encoding = gtdynamics::DynamicsKeyEncoding;
+  uint64_t time = std::numeric_limits<uint64_t>::max();
+  std::vector<std::set<Key>> constraint_keys;
+  constraint_keys.reserve(constraints.size());
+  for (const auto &constraint : constraints) {
+    constraint_keys.push_back(constraint->keys());
+    for (const Key &key : constraint_keys.back()) {
+      time = std::min(time, Encoding::Time(key));
+    }
+  }
+
+  // Types, dimensions and keys at time steps relative to the earliest one.
+  std::ostringstream signature;
+  for (size_t i = 0; i < constraints.size(); i++) {
+    signature << typeid(*constraints[i]).name() << ':'
+              << constraints[i]->dim();
+    for (const Key &key : constraint_keys[i]) {
+      signature << ',' << Encoding::WithTime(key, Encoding::Time(key) - time);
+    }
+    signature << ';';
+  }
+
+  auto it = structures_.find(signature.str());
+  if (it == structures_.end()) {
+    auto component = std::make_shared<ConnectedComponent>(constraints);
+    structures_.emplace(signature.str(), Structure{component, time});
+    return component;
+  }
+
+  // Shift the ordering; keys that do not shift consistently, e.g. keys that
+  // are not DynamicsSymbols, get their own ordering.
+  const Structure &structure = it->second;
+  Ordering ordering;
+  KeySet keys;
+  for (const Key &key : structure.component->ordering_) {
+    const Key shifted =
+        Encoding::WithTime(key, Encoding::Time(key) - structure.time + time);
+    ordering.push_back(shifted);
+    keys.insert(shifted);
+  }
+  for (const auto &keys_i : constraint_keys) {
+    for (const Key &key : keys_i) {
+      if (!keys.count(key)) {
+        return std::make_shared<ConnectedComponent>(constraints);
+      }
+    }
+  }
+  num_shared_++;
+  return std::make_shared<ConnectedComponent>(constraints, ordering);
+}
+
 } // namespace gtsam
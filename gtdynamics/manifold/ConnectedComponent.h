@@ -14,15 +14,22 @@
 #pragma once
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/inference/VariableIndex.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <string>
+#include <unordered_map>
+
 namespace gtsam {
 
 // TODO(yetong): change the namespace to gtdynamics
 
 /** Constraint-connected component (CCC) in a constrained optimization problem.
  * The CCC includes the variables as well as the constraints connecting them.
- * Each CCC will be repaced by a manifold variable for manifold optimization. */
+ * Each CCC will be repaced by a manifold variable for manifold optimization.
+ * Everything here is built once and shared, immutable, by all manifold values
+ * of the component, their bases and their retractors. */
 class ConnectedComponent {
 public:
   const gtdynamics::EqualityConstraints
@@ -30,13 +37,26 @@ public:
   const gtsam::NonlinearFactorGraph
       merit_graph_; // factor graph representing merit function ||h(X)||^2
   const gtsam::KeySet keys_; // variables in CCC
+  const gtsam::VariableIndex variable_index_; // of the merit graph
+  const gtsam::Ordering ordering_; // COLAMD ordering of the merit graph
   using shared_ptr = std::shared_ptr<ConnectedComponent>;
 
   /// Constructor from constraints.
   ConnectedComponent(const gtdynamics::EqualityConstraints &constraints)
       : constraints_(constraints),
         merit_graph_(constructMeritGraph(constraints)),
-        keys_(merit_graph_.keys()) {}
+        keys_(merit_graph_.keys()),
+        variable_index_(merit_graph_),
+        ordering_(Ordering::Colamd(variable_index_)) {}
+
+  /// Constructor from constraints and an ordering of all their keys.
+  ConnectedComponent(const gtdynamics::EqualityConstraints &constraints,
+                     const Ordering &ordering)
+      : constraints_(constraints),
+        merit_graph_(constructMeritGraph(constraints)),
+        keys_(merit_graph_.keys()),
+        variable_index_(merit_graph_),
+        ordering_(ordering) {}
 
 protected:
   /// Create factor graph that represents merit function ||h(X)||^2.
@@ -44,4 +64,32 @@ protected:
   constructMeritGraph(const gtdynamics::EqualityConstraints &constraints);
 };
 
+/**
+ * Creates components, sharing the structure of components that are the same
+ * constraints at different time steps, e.g. at each step of a trajectory.
+ * Components match if their constraints have the same types, dimensions and
+ * keys up to a shift of the DynamicsSymbol time of all keys; the COLAMD
+ * ordering of the first one is then shifted in time for the others, instead
+ * of being computed again.
+ */
+class ComponentStructureCache {
+  struct Structure {
+    ConnectedComponent::shared_ptr component;  // first with the structure
+    uint64_t time;                             // its earliest time step
+  };
+  std::unordered_map<std::string, Structure> structures_;
+  size_t num_shared_ = 0;
+
+public:
+  /// Create a component, with the ordering of a matching one if any.
+  ConnectedComponent::shared_ptr
+  create(const gtdynamics::EqualityConstraints &constraints);
+
+  /// Number of distinct structures.
+  size_t numStructures() const { return structures_.size(); }
+
+  /// Number of components that reused the ordering of another.
+  size_t numShared() const { return num_shared_; }
+};
+
 } // namespace gtsam
@@ -11,11 +11,16 @@
  * @author: Yetong Zhang
  */
 
+#include <gtdynamics/config.h>
 #include <gtdynamics/manifold/ConstraintManifold.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <optional>
+#include <vector>
+
 namespace gtsam {
 
 /* ************************************************************************* */
@@ -27,6 +32,7 @@ Values ConstraintManifold::constructValues(
     cm_values.insert(key, values.at(key));
   }
   if (retract_init) {
+    GTD_TRACE_SCOPE("Retractor::retractConstraints", "manifold");
     return retractor->retractConstraints(std::move(cm_values));
   } else {
     return cm_values;
@@ -41,18 +47,30 @@ const gtsam::Value &ConstraintManifold::recover(const gtsam::Key key,
     makeSureBasisConstructed();
     *H = basis_->recoverJacobian(key);
   }
-  return values_.at(key);
+  return values_->at(key);
 }
 
 /* ************************************************************************* */
 ConstraintManifold ConstraintManifold::retract(const gtsam::Vector &xi,
                                                ChartJacobian H1,
                                                ChartJacobian H2) const {
+  // Components that the step leaves alone keep their feasible values.
+  if (xi.size() == 0 ||
+      xi.lpNorm<Eigen::Infinity>() <= params_->retract_params->skip_threshold) {
+    retractor_->countRetraction(true);
+    return *this;
+  }
+  retractor_->countRetraction(false);
+
   // Compute delta for each variable and perform update.
   makeSureBasisConstructed();
   // std::cout << "xi: " << xi.transpose() << "\n";
   VectorValues delta = basis_->computeTangentVector(xi);
-  Values new_values = retractor_->retract(values_, delta);
+  Values new_values;
+  {
+    GTD_TRACE_SCOPE("Retractor::retract", "manifold");
+    new_values = retractor_->retract(*values_, delta);
+  }
 
   // Set jacobian as 0 since they are not used for optimization.
   if (H1)
@@ -63,7 +81,7 @@ ConstraintManifold ConstraintManifold::retract(const gtsam::Vector &xi,
         "ConstraintManifold retract jacobian not implemented.");
 
   // Satisfy the constraints in the connected component.
-  return createWithNewValues(new_values);
+  return createWithNewValues(std::move(new_values));
 }
 
 /* ************************************************************************* */
@@ -71,7 +89,7 @@ gtsam::Vector ConstraintManifold::localCoordinates(const ConstraintManifold &g,
                                                    ChartJacobian H1,
                                                    ChartJacobian H2) const {
   makeSureBasisConstructed();
-  Vector xi = basis_->localCoordinates(values_, g.values_);
+  Vector xi = basis_->localCoordinates(*values_, *g.values_);
 
   // Set jacobian as 0 since they are not used for optimization.
   if (H1)
@@ -87,13 +105,13 @@ gtsam::Vector ConstraintManifold::localCoordinates(const ConstraintManifold &g,
 /* ************************************************************************* */
 void ConstraintManifold::print(const std::string &s) const {
   std::cout << (s.empty() ? s : s + " ") << "ConstraintManifold" << std::endl;
-  values_.print();
+  values_->print();
 }
 
 /* ************************************************************************* */
 bool ConstraintManifold::equals(const ConstraintManifold &other,
                                 double tol) const {
-  return values_.equals(other.values_, tol);
+  return values_ == other.values_ || values_->equals(*other.values_, tol);
 }
 
 /* ************************************************************************* */
@@ -129,8 +147,46 @@ TspaceBasis::shared_ptr ConstraintManifold::constructTspaceBasis(
 
 /* ************************************************************************* */
 const Values ConstraintManifold::feasibleValues() const {
-  LevenbergMarquardtOptimizer optimizer(cc_->merit_graph_, values_);
+  LevenbergMarquardtOptimizer optimizer(cc_->merit_graph_, *values_);
   return optimizer.optimize();
 }
 
+/* ************************************************************************* */
+Values RetractManifolds(const Values &values, const VectorValues &delta,
+                        bool construct_basis,
+                        const gtdynamics::ExecutionContext &execution) {
+  KeyVector manifold_keys;
+  VectorValues others_delta;
+  for (const Key &key : values.keys()) {
+    const Value &value = values.at(key);
+    if (dynamic_cast<const GenericValue<ConstraintManifold> *>(&value)) {
+      manifold_keys.push_back(key);
+    } else if (delta.exists(key)) {
+      others_delta.insert(key, delta.at(key));
+    }
+  }
+
+  // Each manifold has its own values, basis and retractor, so components can
+  // be retracted concurrently; results are stored by index and inserted in
+  // key order afterwards.
+  std::vector<std::optional<ConstraintManifold>> retracted(
+      manifold_keys.size());
+  auto retractComponent = [&](size_t i) {
+    const Key key = manifold_keys[i];
+    const auto &manifold = values.at<ConstraintManifold>(key);
+    retracted[i] =
+        delta.exists(key) ? manifold.retract(delta.at(key)) : manifold;
+    if (construct_basis) retracted[i]->constructBasis();
+  };
+  execution.parallelFor(manifold_keys.size(), retractComponent);
+
+  // The manifolds are copied by the retraction without a delta, which only
+  // shares their values, and then replaced by the retracted ones.
+  Values result = values.retract(others_delta);
+  for (size_t i = 0; i < manifold_keys.size(); i++) {
+    result.update(manifold_keys[i], *retracted[i]);
+  }
+  return result;
+}
+
 }  // namespace gtsam
@@ -16,8 +16,10 @@
 #include <gtdynamics/manifold/ConnectedComponent.h>
 #include <gtdynamics/manifold/Retractor.h>
 #include <gtdynamics/manifold/TspaceBasis.h>
+#include <gtdynamics/utils/ExecutionContext.h>
 
 #include <cstddef>
+#include <memory>
 
 namespace gtsam {
 
@@ -51,7 +53,10 @@ class ConstraintManifold {
   Params::shared_ptr params_;
   ConnectedComponent::shared_ptr cc_;
   Retractor::shared_ptr retractor_;  // retraction operation
-  gtsam::Values values_;             // values of variables in CCC
+  // Values of variables in CCC. They are never modified once constructed, so
+  // copies of the manifold, e.g. in each copy of the optimizer's Values,
+  // share them instead of copying every variable.
+  std::shared_ptr<const gtsam::Values> values_;
   size_t embedding_dim_;             // dimension of embedding space
   size_t constraint_dim_;            // dimension of constriants
   size_t dim_;                       // dimension of constraint manifold
@@ -75,35 +80,42 @@ class ConstraintManifold {
       : params_(params),
         cc_(cc),
         retractor_(constructRetractor(params, cc)),
-        values_(constructValues(cc, values, retractor_, retract_init)),
-        embedding_dim_(values_.dim()),
+        values_(std::make_shared<const Values>(
+            constructValues(cc, values, retractor_, retract_init))),
+        embedding_dim_(values_->dim()),
         constraint_dim_(cc->constraints_.dim()),
         dim_(embedding_dim_ > constraint_dim_ ? embedding_dim_ - constraint_dim_
                                               : 0),
-        basis_(constructTspaceBasis(params, cc, values_, dim_)) {}
+        basis_(constructTspaceBasis(params, cc, *values_, dim_)) {}
 
-  /** constructor from other manifold but update the values. */
-  ConstraintManifold(const ConstraintManifold &other, const Values &values)
+  /** constructor from other manifold but update the values. The basis at the
+   * new values is constructed on first use. */
+  ConstraintManifold(const ConstraintManifold &other, Values &&values)
       : params_(other.params_),
         cc_(other.cc_),
         retractor_(other.retractor_),
-        values_(values),
+        values_(std::make_shared<const Values>(std::move(values))),
         embedding_dim_(other.embedding_dim_),
         constraint_dim_(other.constraint_dim_),
         dim_(other.dim_),
-        basis_(other.basis_->createWithNewValues(cc_, values_)) {}
+        basis_(other.basis_->createWithNewValues(cc_, *values_)) {}
 
   /** Construct new ConstraintManifold with new values. Note: this function
    * indirectly calls retractConstraints. */
   ConstraintManifold createWithNewValues(const gtsam::Values &values) const {
-    return ConstraintManifold(*this, values);
+    return ConstraintManifold(*this, Values(values));
+  }
+
+  /// Same as above, taking ownership of the values instead of copying them.
+  ConstraintManifold createWithNewValues(gtsam::Values &&values) const {
+    return ConstraintManifold(*this, std::move(values));
   }
 
   /// Dimension of the constraint manifold.
   inline size_t dim() const { return dim_; }
 
   /// Base values of the CCC.
-  inline const Values &values() const { return values_; }
+  inline const Values &values() const { return *values_; }
 
   /// Get base value with optional Jacobian.
   const gtsam::Value &recover(const gtsam::Key key,
@@ -142,6 +154,9 @@ class ConstraintManifold {
 
   const Values feasibleValues() const;
 
+  /// Construct the tangent space basis now, rather than on first use.
+  void constructBasis() const { makeSureBasisConstructed(); }
+
  protected:
   /** Initialize the values_ of variables in CCC and compute dimension of the
    * constraint manifold and compute the dimension of the constraint manifold.
@@ -154,7 +169,7 @@ class ConstraintManifold {
   /// Make sure the tangent space basis is constructed.
   void makeSureBasisConstructed() const {
     if (!basis_->isConstructed()) {
-      basis_->construct(cc_, values_);
+      basis_->construct(cc_, *values_);
     }
   }
 
@@ -175,4 +190,18 @@ template <>
 struct traits<ConstraintManifold>
     : gtsam::internal::Manifold<ConstraintManifold> {};
 
+/**
+ * Same as values.retract(delta), but the ConstraintManifold values, which
+ * retract independently, are retracted in parallel on the threads of the
+ * execution context. The result does not depend on the number of threads.
+ * @param construct_basis also construct the tangent space bases of the
+ * retracted manifolds in parallel, instead of on first use; this pays for
+ * bases at trial points that may be rejected.
+ * @param execution threads of the retraction
+ */
+Values RetractManifolds(const Values &values, const VectorValues &delta,
+                        bool construct_basis = false,
+                        const gtdynamics::ExecutionContext &execution =
+                            gtdynamics::ExecutionContext::Default());
+
 }  // namespace gtsam
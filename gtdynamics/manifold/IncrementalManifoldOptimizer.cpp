@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalManifoldOptimizer.cpp
+ * @brief Incremental manifold optimizer implementations.
+ * @author: Yetong Zhang
+ */
+
+#include <gtdynamics/manifold/ConstraintManifold.h>
+#include <gtdynamics/manifold/IncrementalManifoldOptimizer.h>
+
+#include <stdexcept>
+
+namespace gtsam {
+
+/* ************************************************************************* */
+Values IncrementalManifoldOptimizer::update(
+    const NonlinearFactorGraph& new_costs,
+    const gtdynamics::EqualityConstraints& new_constraints,
+    const Values& new_values) {
+  for (const Key& key : new_values.keys()) {
+    if (base_keys_.exists(key)) {
+      throw std::invalid_argument(
+          "IncrementalManifoldOptimizer: variable " + DefaultKeyFormatter(key) +
+          " was already added.");
+    }
+  }
+  for (const auto& constraint : new_constraints) {
+    for (const Key& key : constraint->keys()) {
+      if (!new_values.exists(key)) {
+        throw std::invalid_argument(
+            "IncrementalManifoldOptimizer: constraints may only involve new "
+            "variables, but " +
+            DefaultKeyFormatter(key) + " is not one.");
+      }
+    }
+  }
+
+  // Create the manifolds of the new components, and collect the new
+  // unconstrained variables.
+  EqConsOptProblem ecopt_problem(new_costs, new_constraints, new_values);
+  ManifoldOptProblem step;
+  step.components_ = identifyConnectedComponents(new_constraints);
+  constructManifoldValues(ecopt_problem, step);
+  KeySet constrained_keys;
+  for (const auto& component : step.components_) {
+    constrained_keys.insert(component->keys_.begin(), component->keys_.end());
+  }
+  for (const Key& key : new_values.keys()) {
+    if (!constrained_keys.exists(key)) {
+      step.unconstrained_keys_.insert(key);
+      step.values_.insert(key, new_values.at(key));
+    }
+  }
+
+  // Merge into the accumulated problem, then substitute the new costs, which
+  // may involve manifolds of earlier updates.
+  problem_.components_.insert(problem_.components_.end(),
+                              step.components_.begin(), step.components_.end());
+  problem_.values_.insert(step.values_);
+  problem_.fixed_manifolds_.insert(step.fixed_manifolds_);
+  problem_.unconstrained_keys_.insert(step.unconstrained_keys_.begin(),
+                                      step.unconstrained_keys_.end());
+  problem_.manifold_keys_.insert(step.manifold_keys_.begin(),
+                                 step.manifold_keys_.end());
+  for (const Key& key : new_values.keys()) {
+    base_keys_.insert(key);
+  }
+  NonlinearFactorGraph new_factors;
+  substituteCosts(new_costs, problem_, new_factors);
+  problem_.graph_.add(new_factors);
+
+  isam_.update(new_factors, step.values_);
+  for (size_t i = 0; i < extra_updates_; i++) {
+    isam_.update();
+  }
+  return calculateEstimate();
+}
+
+/* ************************************************************************* */
+Values IncrementalManifoldOptimizer::calculateEstimate() const {
+  return baseValues(problem_, isam_.calculateEstimate());
+}
+
+}  // namespace gtsam
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalManifoldOptimizer.h
+ * @brief Manifold optimizer for problems that grow over time, using iSAM2.
+ * @author: Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/manifold/ManifoldOptimizerType1.h>
+#include <gtsam/nonlinear/ISAM2.h>
+
+namespace gtsam {
+
+/** Manifold optimizer for problems that grow over time, e.g., trajectories
+ * with appended time steps. Each update adds new constraint-connected
+ * components, unconstrained variables and cost factors, which are turned into
+ * constraint manifolds and substitute factors as in ManifoldOptimizerType1,
+ * and passed to iSAM2, which only re-solves the affected part of the Bayes
+ * tree.
+ * New constraints may only involve new variables, so the existing components
+ * are never merged or re-created. New cost factors may involve any variable,
+ * and each new variable must be involved in a new cost or constraint.
+ */
+class IncrementalManifoldOptimizer : public ManifoldOptimizerType1 {
+ public:
+  using shared_ptr = std::shared_ptr<IncrementalManifoldOptimizer>;
+
+ protected:
+  ISAM2 isam_;
+  size_t extra_updates_;
+  ManifoldOptProblem problem_;  // accumulated problem, with initial values
+  KeySet base_keys_;            // all original variables added so far
+
+ public:
+  /** Constructor.
+   * @param mopt_params parameters of the manifold transformation
+   * @param isam_params parameters of iSAM2
+   * @param extra_updates iSAM2 updates without new factors after each update,
+   * to relinearize and converge further
+   */
+  IncrementalManifoldOptimizer(
+      const ManifoldOptimizerParameters& mopt_params,
+      const ISAM2Params& isam_params = ISAM2Params(),
+      size_t extra_updates = 0)
+      : ManifoldOptimizerType1(mopt_params, LevenbergMarquardtParams()),
+        isam_(isam_params),
+        extra_updates_(extra_updates) {}
+
+  /** Add new costs, constraints and variables, and update the estimate.
+   * @param new_costs cost factors, on new or existing variables
+   * @param new_constraints constraints, on new variables only
+   * @param new_values initial values of all new variables
+   * @return estimate of all original variables added so far
+   */
+  Values update(const NonlinearFactorGraph& new_costs,
+                const gtdynamics::EqualityConstraints& new_constraints,
+                const Values& new_values);
+
+  /// Current estimate of all original variables.
+  Values calculateEstimate() const;
+
+  /// Accumulated manifold optimization problem.
+  const ManifoldOptProblem& problem() const { return problem_; }
+
+  /// Underlying iSAM2 instance.
+  const ISAM2& isam() const { return isam_; }
+};
+
+}  // namespace gtsam
@@ -19,7 +19,12 @@
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
-#include <stack>
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "manifold/Retractor.h"
 
@@ -31,64 +36,82 @@ ManifoldOptimizerParameters::ManifoldOptimizerParameters()
       cc_params(std::make_shared<ConstraintManifold::Params>()),
       retract_init(true) {}
 
-/* ************************************************************************* */
-ConnectedComponent::shared_ptr ManifoldOptimizer::findConnectedComponent(
-    const gtdynamics::EqualityConstraints& constraints,
-    const gtsam::Key start_key, gtsam::KeySet& keys,
-    const gtsam::VariableIndex& var_index) const {
-  std::set<size_t> constraint_indices;
+namespace {
+// Disjoint sets of indices, with union by size and path halving.
+class DisjointSets {
+  std::vector<size_t> parent_, size_;
 
-  std::stack<gtsam::Key> key_stack;
-  key_stack.push(start_key);
-  while (!key_stack.empty()) {
-    gtsam::Key key = key_stack.top();
-    key_stack.pop();
-    // find all constraints connected to key
-    for (const auto& constraint_index : var_index[key]) {
-      constraint_indices.insert(constraint_index);
-      // TODO: use keys() in constraint
-      auto constraint_factor =
-          constraints.at(constraint_index)->createFactor(1.0);
-      for (const auto& neighbor_key : constraint_factor->keys()) {
-        if (keys.find(neighbor_key) != keys.end()) {
-          keys.erase(neighbor_key);
-          key_stack.push(neighbor_key);
-        }
-      }
+ public:
+  /// Add a singleton set, and return its index.
+  size_t add() {
+    parent_.push_back(parent_.size());
+    size_.push_back(1);
+    return parent_.size() - 1;
+  }
+
+  /// Representative of the set of i.
+  size_t find(size_t i) {
+    while (parent_[i] != i) {
+      parent_[i] = parent_[parent_[i]];
+      i = parent_[i];
     }
+    return i;
   }
 
-  gtdynamics::EqualityConstraints cc_constraints;
-  for (const auto& constraint_index : constraint_indices) {
-    cc_constraints.emplace_back(constraints.at(constraint_index));
+  /// Merge the sets of i and j.
+  void merge(size_t i, size_t j) {
+    i = find(i);
+    j = find(j);
+    if (i == j) return;
+    if (size_[i] < size_[j]) std::swap(i, j);
+    parent_[j] = i;
+    size_[i] += size_[j];
   }
-  return std::make_shared<ConnectedComponent>(cc_constraints);
-}
+};
+}  // namespace
 
 /* ************************************************************************* */
 std::vector<ConnectedComponent::shared_ptr>
 ManifoldOptimizer::identifyConnectedComponents(
     const gtdynamics::EqualityConstraints& constraints) const {
-  // Get all the keys in constraints.
-  // TODO(yetong): create VariableIndex from EqualityConstraints
-  gtsam::NonlinearFactorGraph constraint_graph;
-  for (const auto& constraint : constraints) {
-    constraint_graph.add(constraint->createFactor(1.0));
+  // Merge the keys of each constraint, in one pass over the constraints.
+  DisjointSets sets;
+  std::unordered_map<Key, size_t> key_index;
+  std::vector<std::optional<size_t>> constraint_key(constraints.size());
+  for (size_t i = 0; i < constraints.size(); i++) {
+    for (const Key& key : constraints[i]->keys()) {
+      auto [it, inserted] = key_index.emplace(key, 0);
+      if (inserted) it->second = sets.add();
+      if (constraint_key[i]) {
+        sets.merge(*constraint_key[i], it->second);
+      } else {
+        constraint_key[i] = it->second;
+      }
+    }
+  }
+
+  // Components are ordered by their smallest key, and their constraints by
+  // index.
+  std::map<size_t, Key> smallest_key;
+  for (const auto& [key, index] : key_index) {
+    auto [it, inserted] = smallest_key.emplace(sets.find(index), key);
+    if (!inserted) it->second = std::min(it->second, key);
   }
-  gtsam::VariableIndex constraint_var_index =
-      gtsam::VariableIndex(constraint_graph);
-  gtsam::KeySet constraint_keys;
-  for (const auto& it : constraint_var_index) {
-    constraint_keys.insert(it.first);
+  std::map<Key, gtdynamics::EqualityConstraints> component_constraints;
+  for (size_t i = 0; i < constraints.size(); i++) {
+    if (!constraint_key[i]) continue;
+    const Key key = smallest_key.at(sets.find(*constraint_key[i]));
+    component_constraints[key].push_back(constraints[i]);
   }
 
-  // Find connected component using DFS algorithm.
+  ComponentStructureCache structures;
   std::vector<ConnectedComponent::shared_ptr> components;
-  while (!constraint_keys.empty()) {
-    Key key = *constraint_keys.begin();
-    constraint_keys.erase(key);
-    components.emplace_back(findConnectedComponent(
-        constraints, key, constraint_keys, constraint_var_index));
+  components.reserve(component_constraints.size());
+  for (const auto& [key, cc_constraints] : component_constraints) {
+    components.emplace_back(
+        p_.share_component_structure
+            ? structures.create(cc_constraints)
+            : std::make_shared<ConnectedComponent>(cc_constraints));
   }
   return components;
 }
@@ -15,6 +15,7 @@
 
 #include <gtdynamics/manifold/ConstraintManifold.h>
 #include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/utils/ExecutionContext.h>
 #include <gtsam/nonlinear/NonlinearOptimizerParams.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/internal/NonlinearOptimizerState.h>
@@ -33,6 +34,16 @@ struct ManifoldOptimizerParameters
                                // connected component.
   bool retract_final = false;  // Perform retraction on manifolds after
                                // optimization, used for infeasible methods.
+  bool parallel_retract = false;  // Retract the manifolds of all components
+                                  // in parallel, with the LM optimizer.
+  gtdynamics::ExecutionContext execution =
+      gtdynamics::ExecutionContext::Default();  // Threads of parallel_retract.
+  bool group_cost_factors = false;  // Substitute the Gaussian cost factors
+                                    // on a single manifold as one factor.
+  bool share_component_structure = true;  // Shift orderings among the same
+                                          // constraints at other time steps.
+  bool record_phase_times = false;  // Report the time of each phase of each
+                                    // iteration, with the LM optimizer.
   /// Default Constructor.
   ManifoldOptimizerParameters();
 };
@@ -54,15 +65,9 @@ class ManifoldOptimizer : public gtdynamics::ConstrainedOptimizer {
       : p_(parameters) {}
 
  protected:
-  /** Perform dfs to find the connected component that contains start_key. Will
-   * also erase all the keys in the connected component from keys.
-   */
-  ConnectedComponent::shared_ptr findConnectedComponent(
-      const gtdynamics::EqualityConstraints& constraints,
-      const gtsam::Key start_key, gtsam::KeySet& keys,
-      const gtsam::VariableIndex& var_index) const;
-
-  /// Identify the connected components by constraints.
+  /** Identify the connected components by constraints, with a union-find
+   * over the keys of the constraints, in near-linear time. Components are
+   * ordered by their smallest key. */
   std::vector<ConnectedComponent::shared_ptr> identifyConnectedComponents(
       const gtdynamics::EqualityConstraints& constraints) const;
 };
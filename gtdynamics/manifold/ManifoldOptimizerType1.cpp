@@ -16,6 +16,8 @@
 #include <gtdynamics/manifold/SubstituteFactor.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <optional>
+
 #include "manifold/Retractor.h"
 #include "manifold/TspaceBasis.h"
 
@@ -27,7 +29,9 @@ Values ManifoldOptimizerType1::optimize(
     const gtdynamics::EqualityConstraints& constraints,
     const Values& init_values,
     gtdynamics::ConstrainedOptResult* intermediate_result) const {
-  auto mopt_problem = initializeMoptProblem(costs, constraints, init_values);
+  auto mopt_problem = initializeMoptProblem(
+      costs, gtdynamics::ScaleConstraints(constraints, init_values, p_.scaling),
+      init_values, intermediate_result);
   return optimize(mopt_problem, intermediate_result);
 }
 
@@ -35,13 +39,61 @@ Values ManifoldOptimizerType1::optimize(
 Values ManifoldOptimizerType1::optimize(
     const ManifoldOptProblem& mopt_problem,
     gtdynamics::ConstrainedOptResult* intermediate_result) const {
+  // Retractions of all manifolds so far, and how many of them were skipped.
+  auto countRetractions = [&]() {
+    std::pair<size_t, size_t> counts(0, 0);
+    for (const Key& key : mopt_problem.manifold_keys_) {
+      const auto& retractor =
+          mopt_problem.values_.at<ConstraintManifold>(key).retractor();
+      counts.first += retractor->numRetractions();
+      counts.second += retractor->numSkipped();
+    }
+    return counts;
+  };
+  const auto counts_before = countRetractions();
+
   auto nonlinear_optimizer = constructNonlinearOptimizer(mopt_problem);
-  auto nopt_values = nonlinear_optimizer->optimize();
+  Values nopt_values;
+  if (p_.anytime.active()) {
+    // Iterates stay on the constraint manifolds, so they are all feasible and
+    // the optimizer's current values are the best ones.
+    const NonlinearOptimizerParams& nopt_params = std::visit(
+        [](const auto& params) -> const NonlinearOptimizerParams& {
+          return params;
+        },
+        nopt_params_);
+    nopt_values =
+        gtdynamics::OptimizeAnytime(*nonlinear_optimizer, nopt_params,
+                                    p_.anytime);
+  } else {
+    nopt_values = nonlinear_optimizer->optimize();
+  }
   if (intermediate_result) {
-    intermediate_result->num_iters.push_back(
-        std::dynamic_pointer_cast<LevenbergMarquardtOptimizer>(
-            nonlinear_optimizer)
-            ->getInnerIterations());
+    if (auto mutable_lm = std::dynamic_pointer_cast<MutableLMOptimizer>(
+            nonlinear_optimizer)) {
+      intermediate_result->num_iters.push_back(
+          mutable_lm->getInnerIterations());
+      for (const auto& phase_times : mutable_lm->iterationPhaseTimes()) {
+        intermediate_result->iteration_phase_times.push_back(phase_times);
+        for (const auto& [phase, seconds] : phase_times) {
+          intermediate_result->addPhaseTime(phase, seconds);
+        }
+      }
+    } else if (auto lm = std::dynamic_pointer_cast<LevenbergMarquardtOptimizer>(
+                   nonlinear_optimizer)) {
+      intermediate_result->num_iters.push_back(lm->getInnerIterations());
+    } else {
+      // Gauss-Newton and dogleg retract once per iteration.
+      intermediate_result->num_iters.push_back(
+          nonlinear_optimizer->iterations());
+    }
+    if (p_.record_phase_times) {
+      const auto counts = countRetractions();
+      intermediate_result->addCount("retractions",
+                                    counts.first - counts_before.first);
+      intermediate_result->addCount("skipped_retractions",
+                                    counts.second - counts_before.second);
+    }
   }
   return baseValues(mopt_problem, nopt_values);
 }
@@ -74,19 +126,31 @@ Values ManifoldOptimizerType1::baseValues(
 ManifoldOptProblem ManifoldOptimizerType1::initializeMoptProblem(
     const gtsam::NonlinearFactorGraph& costs,
     const gtdynamics::EqualityConstraints& constraints,
-    const gtsam::Values& init_values) const {
+    const gtsam::Values& init_values,
+    gtdynamics::ConstrainedOptResult* intermediate_result) const {
   EqConsOptProblem ecopt_problem(costs, constraints, init_values);
-  return problemTransform(ecopt_problem);
+  return problemTransform(ecopt_problem, intermediate_result);
 }
 
 /* ************************************************************************* */
 ManifoldOptProblem ManifoldOptimizerType1::problemTransform(
-    const EqConsOptProblem& ecopt_problem) const {
+    const EqConsOptProblem& ecopt_problem,
+    gtdynamics::ConstrainedOptResult* intermediate_result) const {
   ManifoldOptProblem mopt_problem;
+  gtdynamics::Deadline timer;
   mopt_problem.components_ =
       identifyConnectedComponents(ecopt_problem.constraints_);
+  const double identify_time = timer.elapsed();
   constructMoptValues(ecopt_problem, mopt_problem);
+  const double construct_time = timer.elapsed() - identify_time;
   constructMoptGraph(ecopt_problem, mopt_problem);
+  if (intermediate_result && p_.record_phase_times) {
+    intermediate_result->addPhaseTime("identify_components", identify_time);
+    // Includes the initial retraction and basis of each manifold.
+    intermediate_result->addPhaseTime("construct_manifolds", construct_time);
+    intermediate_result->addPhaseTime(
+        "substitute_costs", timer.elapsed() - identify_time - construct_time);
+  }
   return mopt_problem;
 }
 
@@ -143,10 +207,33 @@ void ManifoldOptimizerType1::constructUnconstrainedValues(
   }
 }
 
+/* ************************************************************************* */
+/// The manifold containing all variables of a factor, if there is one.
+static std::optional<Key> SingleManifoldKey(
+    const NonlinearFactor& factor,
+    const std::map<Key, Key>& key_component_map) {
+  std::optional<Key> cm_key;
+  for (const Key& key : factor.keys()) {
+    auto it = key_component_map.find(key);
+    if (it == key_component_map.end() || (cm_key && *cm_key != it->second)) {
+      return {};
+    }
+    cm_key = it->second;
+  }
+  return cm_key;
+}
+
 /* ************************************************************************* */
 void ManifoldOptimizerType1::constructMoptGraph(
     const EqConsOptProblem& ecopt_problem,
     ManifoldOptProblem& mopt_problem) const {
+  substituteCosts(ecopt_problem.costs_, mopt_problem, mopt_problem.graph_);
+}
+
+/* ************************************************************************* */
+void ManifoldOptimizerType1::substituteCosts(
+    const NonlinearFactorGraph& costs, const ManifoldOptProblem& mopt_problem,
+    NonlinearFactorGraph& graph) const {
   // Construct base key to component map.
   std::map<Key, Key> key_component_map;
   for (const Key& cm_key : mopt_problem.manifold_keys_) {
@@ -164,7 +251,23 @@ void ManifoldOptimizerType1::constructMoptGraph(
   }
 
   // Turn factors involved with constraint variables into SubstituteFactor.
-  for (const auto& factor : ecopt_problem.costs_) {
+  // Optionally, cost factors only on variables of the same manifold are
+  // stacked first, so the basis is multiplied once for the whole group.
+  std::map<Key, std::vector<NoiseModelFactor::shared_ptr>> manifold_costs;
+  std::map<Key, std::map<Key, Key>> manifold_replacements;
+  for (const auto& factor : costs) {
+    if (p_.group_cost_factors) {
+      auto noise_factor = std::dynamic_pointer_cast<NoiseModelFactor>(factor);
+      const auto cm_key = SingleManifoldKey(*factor, key_component_map);
+      if (noise_factor && cm_key && mopt_problem.values_.exists(*cm_key) &&
+          StackedFactor::IsStackable(noise_factor)) {
+        manifold_costs[*cm_key].push_back(noise_factor);
+        for (const Key& key : factor->keys()) {
+          manifold_replacements[*cm_key][key] = *cm_key;
+        }
+        continue;
+      }
+    }
     std::map<Key, Key> replacement_map;
     for (const Key& key : factor->keys()) {
       if (key_component_map.find(key) != key_component_map.end()) {
@@ -177,12 +280,21 @@ void ManifoldOptimizerType1::constructMoptGraph(
       auto subs_factor = std::make_shared<SubstituteFactor>(
           noise_factor, replacement_map, mopt_problem.fixed_manifolds_);
       if (subs_factor->checkActive()) {
-        mopt_problem.graph_.add(subs_factor);
+        graph.add(subs_factor);
       }
     } else {
-      mopt_problem.graph_.add(factor);
+      graph.add(factor);
     }
   }
+  for (const auto& [cm_key, factors] : manifold_costs) {
+    NoiseModelFactor::shared_ptr base_factor = factors.front();
+    if (factors.size() > 1) {
+      base_factor = std::make_shared<StackedFactor>(factors);
+    }
+    graph.emplace_shared<SubstituteFactor>(base_factor,
+                                           manifold_replacements.at(cm_key),
+                                           mopt_problem.fixed_manifolds_);
+  }
 }
 
 /* ************************************************************************* */
@@ -193,6 +305,19 @@ ManifoldOptimizerType1::constructNonlinearOptimizer(
     return std::make_shared<GaussNewtonOptimizer>(
         mopt_problem.graph_, mopt_problem.values_,
         std::get<GaussNewtonParams>(nopt_params_));
+  } else if (std::holds_alternative<LevenbergMarquardtParams>(nopt_params_) &&
+             (p_.parallel_retract || p_.record_phase_times)) {
+    MutableLMParams params(std::get<LevenbergMarquardtParams>(nopt_params_));
+    if (p_.parallel_retract) {
+      const gtdynamics::ExecutionContext execution = p_.execution;
+      params.retractFunction = [execution](const Values& values,
+                                           const VectorValues& delta) {
+        return RetractManifolds(values, delta, false, execution);
+      };
+    }
+    params.recordPhaseTimes = p_.record_phase_times;
+    return std::make_shared<MutableLMOptimizer>(
+        mopt_problem.graph_, mopt_problem.values_, params);
   } else if (std::holds_alternative<LevenbergMarquardtParams>(nopt_params_)) {
     return std::make_shared<LevenbergMarquardtOptimizer>(
         mopt_problem.graph_, mopt_problem.values_,
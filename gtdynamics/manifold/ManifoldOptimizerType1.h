@@ -15,6 +15,7 @@
 #pragma once
 
 #include <gtdynamics/manifold/ManifoldOptimizer.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
 #include <gtsam/nonlinear/DoglegOptimizer.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
@@ -86,9 +87,13 @@ class ManifoldOptimizerType1 : public ManifoldOptimizer {
   ManifoldOptProblem initializeMoptProblem(
       const gtsam::NonlinearFactorGraph& costs,
       const gtdynamics::EqualityConstraints& constraints,
-      const gtsam::Values& init_values) const;
+      const gtsam::Values& init_values,
+      gtdynamics::ConstrainedOptResult* intermediate_result = nullptr) const;
 
-  /// Create the underlying nonlinear optimizer for manifold optimization.
+  /** Create the underlying nonlinear optimizer for manifold optimization.
+   * With DoglegParams, steps are kept within a trust region, so fewer of them
+   * are rejected than with LM, and each rejected step costs a retraction of
+   * all manifolds. */
   std::shared_ptr<NonlinearOptimizer> constructNonlinearOptimizer(
       const ManifoldOptProblem& mopt_problem) const;
 
@@ -118,10 +123,17 @@ class ManifoldOptimizerType1 : public ManifoldOptimizer {
   void constructMoptGraph(const EqConsOptProblem& ecopt_problem,
                           ManifoldOptProblem& mopt_problem) const;
 
+  /** Add cost factors to a graph, substituting the variables of the
+   * components of mopt_problem with their constraint manifold variables. */
+  void substituteCosts(const NonlinearFactorGraph& costs,
+                       const ManifoldOptProblem& mopt_problem,
+                       NonlinearFactorGraph& graph) const;
+
   /** Transform an equality-constrained optimization problem into a manifold
    * optimization problem by creating constraint manifolds. */
   ManifoldOptProblem problemTransform(
-      const EqConsOptProblem& ecopt_problem) const;
+      const EqConsOptProblem& ecopt_problem,
+      gtdynamics::ConstrainedOptResult* intermediate_result = nullptr) const;
 };
 
 }  // namespace gtsam
@@ -13,6 +13,9 @@
 
 #include <gtdynamics/manifold/MultiJacobian.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace gtsam {
 
 /* ************************************************************************* */
@@ -147,4 +150,133 @@ void ComputeBayesNetJacobian(const GaussianBayesNet& bn,
   }
 }
 
+/* ************************************************************************* */
+FlatMultiJacobians::FlatMultiJacobians(const std::map<Key, size_t>& var_dim,
+                                       const KeyVector& basis_keys)
+    : basis_keys_(basis_keys) {
+  keys_.reserve(var_dim.size());
+  row_offsets_.reserve(var_dim.size() + 1);
+  size_t rows = 0;
+  for (const auto& it : var_dim) {
+    keys_.push_back(it.first);
+    row_offsets_.push_back(rows);
+    rows += it.second;
+  }
+  row_offsets_.push_back(rows);
+
+  col_offsets_.reserve(basis_keys_.size() + 1);
+  size_t cols = 0;
+  for (const Key& key : basis_keys_) {
+    col_offsets_.push_back(cols);
+    cols += var_dim.at(key);
+  }
+  col_offsets_.push_back(cols);
+  buffer_ = Matrix::Zero(rows, cols);
+}
+
+/* ************************************************************************* */
+size_t FlatMultiJacobians::rowIndex(const Key& key) const {
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key) {
+    throw std::out_of_range("FlatMultiJacobians: no jacobian for variable " +
+                            DefaultKeyFormatter(key));
+  }
+  return it - keys_.begin();
+}
+
+/* ************************************************************************* */
+size_t FlatMultiJacobians::colIndex(const Key& basis_key) const {
+  auto it = std::find(basis_keys_.begin(), basis_keys_.end(), basis_key);
+  if (it == basis_keys_.end()) {
+    throw std::out_of_range("FlatMultiJacobians: not a basis variable " +
+                            DefaultKeyFormatter(basis_key));
+  }
+  return it - basis_keys_.begin();
+}
+
+/* ************************************************************************* */
+bool FlatMultiJacobians::exists(const Key& key) const {
+  return std::binary_search(keys_.begin(), keys_.end(), key);
+}
+
+/* ************************************************************************* */
+Eigen::Block<const Matrix> FlatMultiJacobians::jacobian(const Key& key) const {
+  const size_t i = rowIndex(key);
+  return buffer_.block(row_offsets_[i], 0,
+                       row_offsets_[i + 1] - row_offsets_[i], buffer_.cols());
+}
+
+/* ************************************************************************* */
+Eigen::Block<Matrix> FlatMultiJacobians::jacobian(const Key& key) {
+  const size_t i = rowIndex(key);
+  return buffer_.block(row_offsets_[i], 0,
+                       row_offsets_[i + 1] - row_offsets_[i], buffer_.cols());
+}
+
+/* ************************************************************************* */
+Eigen::Block<const Matrix> FlatMultiJacobians::jacobian(
+    const Key& key, const Key& basis_key) const {
+  const size_t i = rowIndex(key), j = colIndex(basis_key);
+  return buffer_.block(row_offsets_[i], col_offsets_[j],
+                       row_offsets_[i + 1] - row_offsets_[i],
+                       col_offsets_[j + 1] - col_offsets_[j]);
+}
+
+/* ************************************************************************* */
+Eigen::Block<Matrix> FlatMultiJacobians::jacobian(const Key& key,
+                                                  const Key& basis_key) {
+  const size_t i = rowIndex(key), j = colIndex(basis_key);
+  return buffer_.block(row_offsets_[i], col_offsets_[j],
+                       row_offsets_[i + 1] - row_offsets_[i],
+                       col_offsets_[j + 1] - col_offsets_[j]);
+}
+
+/* ************************************************************************* */
+void FlatMultiJacobians::print(const std::string& s,
+                               const KeyFormatter& keyFormatter) const {
+  std::cout << s;
+  for (const Key& key : keys_) {
+    std::cout << keyFormatter(key) << ":\n";
+    std::cout << jacobian(key) << "\n";
+  }
+}
+
+/* ************************************************************************* */
+void ComputeBayesNetJacobian(const GaussianBayesNet& bn,
+                             const KeyVector& basis_keys,
+                             const std::map<Key, size_t>& var_dim,
+                             FlatMultiJacobians& jacobians) {
+  // One zero buffer for all jacobians, with identity for basis variables.
+  jacobians = FlatMultiJacobians(var_dim, basis_keys);
+  for (const Key& key : basis_keys) {
+    jacobians.jacobian(key, key).setIdentity();
+  }
+
+  // Conditionals are visited from the last one, so parents are always done
+  // before their frontals.
+  Matrix S_mat;
+  for (size_t i = bn.size(); i-- > 0;) {
+    const auto& conditional = *bn[i];
+    S_mat = -conditional.R().triangularView<Eigen::Upper>().solve(
+        conditional.S());
+    DenseIndex frontal_position = 0;
+    for (auto frontal = conditional.beginFrontals();
+         frontal != conditional.endFrontals(); ++frontal) {
+      const auto frontal_dim = conditional.getDim(frontal);
+      auto H_frontal = jacobians.jacobian(*frontal);
+      DenseIndex parent_position = 0;
+      for (auto parent = conditional.beginParents();
+           parent != conditional.endParents(); ++parent) {
+        const auto parent_dim = conditional.getDim(parent);
+        H_frontal.noalias() +=
+            S_mat.block(frontal_position, parent_position, frontal_dim,
+                        parent_dim) *
+            jacobians.jacobian(*parent);
+        parent_position += parent_dim;
+      }
+      frontal_position += frontal_dim;
+    }
+  }
+}
+
 }  // namespace gtsam
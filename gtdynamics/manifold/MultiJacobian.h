@@ -17,7 +17,9 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace gtsam {
 
@@ -71,4 +73,80 @@ void ComputeBayesNetJacobian(const GaussianBayesNet& bn,
                              const std::map<Key, size_t>& var_dim,
                              MultiJacobians& jacobians);
 
+/** Jacobians of multiple variables w.r.t. a fixed set of basis variables,
+ * stored in one contiguous matrix: each variable owns a block of rows and
+ * each basis variable a block of columns. Variables are kept as a sorted key
+ * vector with row offsets, so lookups need no hashing and chain-rule updates
+ * write into preallocated blocks instead of allocating a matrix per term. */
+class FlatMultiJacobians {
+ protected:
+  KeyVector keys_;                   // sorted variable keys
+  std::vector<size_t> row_offsets_;  // size keys_.size() + 1
+  KeyVector basis_keys_;
+  std::vector<size_t> col_offsets_;  // size basis_keys_.size() + 1
+  Matrix buffer_;
+
+ public:
+  /// Default constructor.
+  FlatMultiJacobians() {}
+
+  /** Constructor, with all jacobians set to zero.
+   * @param var_dim dimension of each variable
+   * @param basis_keys basis variables, in the order of the columns
+   */
+  FlatMultiJacobians(const std::map<Key, size_t>& var_dim,
+                     const KeyVector& basis_keys);
+
+  /// Variables, sorted.
+  const KeyVector& keys() const { return keys_; }
+
+  /// Basis variables, in the order of the columns.
+  const KeyVector& basisKeys() const { return basis_keys_; }
+
+  /// Total dimension of the variables.
+  size_t rows() const { return buffer_.rows(); }
+
+  /// Total dimension of the basis variables.
+  size_t cols() const { return buffer_.cols(); }
+
+  /// Check if a variable has a jacobian.
+  bool exists(const Key& key) const;
+
+  /// Jacobian of a variable w.r.t. all basis variables.
+  Eigen::Block<const Matrix> jacobian(const Key& key) const;
+  Eigen::Block<Matrix> jacobian(const Key& key);
+
+  /// Jacobian of a variable w.r.t. one basis variable.
+  Eigen::Block<const Matrix> jacobian(const Key& key,
+                                      const Key& basis_key) const;
+  Eigen::Block<Matrix> jacobian(const Key& key, const Key& basis_key);
+
+  /// The whole stacked jacobian, rows ordered by sorted variable keys.
+  const Matrix& matrix() const { return buffer_; }
+
+  /// Customizable print function.
+  void print(const std::string& s = "",
+             const KeyFormatter& keyFormatter = DefaultKeyFormatter) const;
+
+ protected:
+  /// Index of a variable in keys_, throws if missing.
+  size_t rowIndex(const Key& key) const;
+
+  /// Index of a basis variable in basis_keys_, throws if missing.
+  size_t colIndex(const Key& basis_key) const;
+};
+
+/** Given a bayes net, compute the jacobians of all variables w.r.t. basis
+ * variables into a flat representation. The jacobians of all variables are
+ * computed in place in a single buffer allocated up front.
+ * @param bn bayes net
+ * @param basis_keys basis variables
+ * @param var_dim dimension of all variables, basis and eliminated ones
+ * @param jacobians output, jacobians of all variables in var_dim
+ */
+void ComputeBayesNetJacobian(const GaussianBayesNet& bn,
+                             const KeyVector& basis_keys,
+                             const std::map<Key, size_t>& var_dim,
+                             FlatMultiJacobians& jacobians);
+
 }  // namespace gtsam
@@ -17,6 +17,7 @@
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
 #include <gtsam/inference/Key.h>
 #include <gtsam/linear/NoiseModel.h>
+#include <gtsam/linear/linearExceptions.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
@@ -58,16 +59,37 @@ Retractor::shared_ptr Retractor::create(
 void Retractor::checkFeasible(const NonlinearFactorGraph &graph,
                               const Values &values) const {
   if (params_->check_feasible) {
-    if (graph.error(values) > params_->feasible_threshold) {
-      std::cout << "fail: " << graph.error(values) << "\n";
+    const double error = graph.error(values);
+    if (error > params_->feasible_threshold) {
+      std::cout << "fail: " << error << "\n";
     }
   }
 }
 
+/* ************************************************************************* */
+// Parameters of the persistent solvers of a retractor.
+static MutableLMParams SolverParams(const RetractParams &params) {
+  MutableLMParams solver_params(params.lm_params);
+  solver_params.warmStartLambda = params.warm_start_lambda;
+  return solver_params;
+}
+
+// Parameters of a solver on the merit graph, using the component's cached
+// ordering instead of recomputing it for each solver.
+static MutableLMParams MeritGraphParams(const ConnectedComponent &cc,
+                                        MutableLMParams params) {
+  if (params.orderingType == Ordering::COLAMD && !params.ordering) {
+    params.ordering = cc.ordering_;
+  }
+  return params;
+}
+
 /* ************************************************************************* */
 UoptRetractor::UoptRetractor(const ConnectedComponent::shared_ptr &cc,
                              const RetractParams::shared_ptr &params)
-    : Retractor(cc, params), optimizer_(cc->merit_graph_, params->lm_params) {}
+    : Retractor(cc, params),
+      optimizer_(cc->merit_graph_,
+                 MeritGraphParams(*cc, SolverParams(*params))) {}
 
 /* ************************************************************************* */
 Values UoptRetractor::retractConstraints(const Values &values) {
@@ -89,7 +111,12 @@ Values UoptRetractor::retractConstraints(Values &&values) {
 ProjRetractor::ProjRetractor(const ConnectedComponent::shared_ptr &cc,
                              const RetractParams::shared_ptr &params,
                              std::optional<const KeyVector> basis_keys)
-    : Retractor(cc, params) {
+    : Retractor(cc, params),
+      optimizer_with_priors_(SolverParams(*params)),
+      optimizer_without_priors_(cc->merit_graph_,
+                                MeritGraphParams(*cc, SolverParams(*params))),
+      constraints_optimizer_(cc->merit_graph_,
+                             MeritGraphParams(*cc, MutableLMParams())) {
   if (params->use_basis_keys) {
     basis_keys_ = *basis_keys;
   }
@@ -97,8 +124,8 @@ ProjRetractor::ProjRetractor(const ConnectedComponent::shared_ptr &cc,
 
 /* ************************************************************************* */
 Values ProjRetractor::retractConstraints(const Values &values) {
-  LevenbergMarquardtOptimizer optimizer(cc_->merit_graph_, values);
-  return optimizer.optimize();
+  constraints_optimizer_.setValues(values);
+  return constraints_optimizer_.optimize();
 }
 
 /* ************************************************************************* */
@@ -113,18 +140,18 @@ Values ProjRetractor::retract(const Values &values, const VectorValues &delta) {
   }
   const Values &init_values =
       params_->apply_base_retraction ? values_retract_base : values;
-  LevenbergMarquardtOptimizer optimizer_with_priors(graph, init_values,
-                                                    params_->lm_params);
-  const Values &result = optimizer_with_priors.optimize();
+  // Only the prior means change, so the ordering is kept.
+  optimizer_with_priors_.setGraph(graph);
+  optimizer_with_priors_.setValues(init_values);
+  const Values result = optimizer_with_priors_.optimize();
   if (params_->use_basis_keys &&
-      optimizer_with_priors.error() < params_->feasible_threshold) {
+      optimizer_with_priors_.error() < params_->feasible_threshold) {
     return result;
   }
 
   // optimize without priors
-  LevenbergMarquardtOptimizer optimizer_without_priors(
-      cc_->merit_graph_, result, params_->lm_params);
-  const Values &final_result = optimizer_without_priors.optimize();
+  optimizer_without_priors_.setValues(result);
+  const Values final_result = optimizer_without_priors_.optimize();
   checkFeasible(cc_->merit_graph_, final_result);
   return final_result;
 }
@@ -135,7 +162,7 @@ BasisRetractor::BasisRetractor(const ConnectedComponent::shared_ptr &cc,
                                const KeyVector &basis_keys)
     : Retractor(cc, params),
       basis_keys_(basis_keys),
-      optimizer_(params->lm_params),
+      optimizer_(SolverParams(*params)),
       cc_(cc) {
   NonlinearFactorGraph graph;
   KeySet fixed_keys(basis_keys.begin(), basis_keys.end());
@@ -256,12 +283,12 @@ DynamicsRetractor::DynamicsRetractor(
     const RetractParams::shared_ptr &params,
     std::optional<const KeyVector> basis_keys)
     : Retractor(cc, params),
-      optimizer_wp_q_(params->lm_params),
-      optimizer_wp_v_(params->lm_params),
-      optimizer_wp_ad_(params->lm_params),
-      optimizer_np_q_(params->lm_params),
-      optimizer_np_v_(params->lm_params),
-      optimizer_np_ad_(params->lm_params) {
+      optimizer_wp_q_(SolverParams(*params)),
+      optimizer_wp_v_(SolverParams(*params)),
+      optimizer_wp_ad_(SolverParams(*params)),
+      optimizer_np_q_(SolverParams(*params)),
+      optimizer_np_v_(SolverParams(*params)),
+      optimizer_np_ad_(SolverParams(*params)) {
   /// classify keys
   KeySet q_keys, v_keys, ad_keys, qv_keys;
   classifyKeys(cc->merit_graph_.keys(), q_keys, v_keys, ad_keys);
@@ -319,6 +346,10 @@ DynamicsRetractor::DynamicsRetractor(
   optimizer_wp_q_.setGraph(graph_q);
   optimizer_wp_v_.setGraph(graph_v);
   optimizer_wp_ad_.setGraph(graph_ad);
+
+  // The structure of the linear levels is fixed, so order them once.
+  if (!graph_v.empty()) ordering_v_ = Ordering::Colamd(graph_v);
+  if (!graph_ad.empty()) ordering_ad_ = Ordering::Colamd(graph_ad);
 }
 
 /* ************************************************************************* */
@@ -338,6 +369,29 @@ void DynamicsRetractor::updatePriors(const Values &values, const KeySet &keys,
   AddGeneralPriors(values, keys, params_->sigma, graph);
 }
 
+/* ************************************************************************* */
+Values DynamicsRetractor::solveLinearLevel(const Values &values,
+                                           const Ordering &ordering,
+                                           MutableLMOptimizer &optimizer_wp,
+                                           MutableLMOptimizer &optimizer_np) {
+  const NonlinearFactorGraph &graph = optimizer_wp.graph();
+  if (params_->linear_dynamics_levels && !graph.empty()) {
+    try {
+      const Values result =
+          values.retract(graph.linearize(values)->optimize(ordering));
+      if (optimizer_np.graph().error(result) <= params_->feasible_threshold) {
+        return result;
+      }
+      optimizer_np.setValues(result);
+      return optimizer_np.optimize();
+    } catch (const IndeterminantLinearSystemException &) {
+    }
+  }
+  optimizer_wp.setValues(values);
+  optimizer_np.setValues(optimizer_wp.optimize());
+  return optimizer_np.optimize();
+}
+
 /* ************************************************************************* */
 Values DynamicsRetractor::retractConstraints(const Values &values) {
   Values known_values;
@@ -356,25 +410,18 @@ Values DynamicsRetractor::retractConstraints(const Values &values) {
   for (auto &factor : const_var_factors_v_) {
     factor->setFixedValues(known_values);
   }
-  optimizer_wp_v_.setValues(SubValues(values, optimizer_wp_v_.graph().keys()));
-  auto results_v = optimizer_wp_v_.optimize();
-
-  optimizer_np_v_.setValues(results_v);
-  results_v = optimizer_np_v_.optimize();
-  known_values.insert(results_v);
+  known_values.insert(solveLinearLevel(
+      SubValues(values, optimizer_wp_v_.graph().keys()), ordering_v_,
+      optimizer_wp_v_, optimizer_np_v_));
 
   // solve a and dynamics level
   updatePriors(values, basis_ad_keys_, optimizer_wp_ad_.mutableGraph());
   for (auto &factor : const_var_factors_ad_) {
     factor->setFixedValues(known_values);
   }
-  optimizer_wp_ad_.setValues(
-      SubValues(values, optimizer_wp_ad_.graph().keys()));
-  auto results_ad = optimizer_wp_ad_.optimize();
-
-  optimizer_np_ad_.setValues(results_ad);
-  results_ad = optimizer_np_ad_.optimize();
-  known_values.insert(results_ad);
+  known_values.insert(solveLinearLevel(
+      SubValues(values, optimizer_wp_ad_.graph().keys()), ordering_ad_,
+      optimizer_wp_ad_, optimizer_np_ad_));
   checkFeasible(cc_->merit_graph_, known_values);
 
   // NonlinearFactorGraph graph_wp_all = cc_->merit_graph_;
@@ -41,6 +41,14 @@ struct RetractParams {
   double sigma = 1.0;
   bool apply_base_retraction = false;
   bool recompute = false;
+  /// Start each retraction solve at the lambda the previous one ended with.
+  bool warm_start_lambda = false;
+  /// Reuse the value of a manifold whose tangent update has no entry above
+  /// this, instead of retracting it.
+  double skip_threshold = 0.0;
+  /// Solve the velocity and acceleration levels of DynamicsRetractor, which
+  /// are linear given the levels below, with one linear solve each.
+  bool linear_dynamics_levels = true;
 
   // Constructor
   RetractParams() = default;
@@ -77,6 +85,8 @@ class Retractor {
  protected:
   ConnectedComponent::shared_ptr cc_;
   RetractParams::shared_ptr params_;
+  size_t num_retractions_ = 0;  // retractions of the manifold
+  size_t num_skipped_ = 0;      // of which skipped for small tangent updates
 
  public:
   using shared_ptr = std::shared_ptr<Retractor>;
@@ -87,6 +97,18 @@ class Retractor {
                 std::make_shared<RetractParams>())
       : cc_(cc), params_(params) {}
 
+  /// Count a retraction of the manifold, and whether it was skipped.
+  void countRetraction(bool skipped) {
+    num_retractions_++;
+    if (skipped) num_skipped_++;
+  }
+
+  /// Number of retractions of the manifold.
+  size_t numRetractions() const { return num_retractions_; }
+
+  /// Number of retractions skipped for small tangent updates.
+  size_t numSkipped() const { return num_skipped_; }
+
   /// Convenient constructor.
   static shared_ptr create(const RetractParams::shared_ptr &params,
                            const ConnectedComponent::shared_ptr &cc,
@@ -149,10 +171,14 @@ class UoptRetractor : public Retractor {
   Values retractConstraints(Values &&values) override;
 };
 
-/** Retractor with metric projection. */
+/** Retractor with metric projection. The solvers persist across
+ * retractions: the graphs with priors only change in their measurements, so
+ * the ordering is computed once. */
 class ProjRetractor : public Retractor {
  protected:
   KeyVector basis_keys_;
+  MutableLMOptimizer optimizer_with_priors_, optimizer_without_priors_;
+  MutableLMOptimizer constraints_optimizer_;
 
  public:
   /// Constructor.
@@ -196,6 +222,7 @@ class DynamicsRetractor : public Retractor {
   KeySet basis_q_keys_, basis_v_keys_, basis_ad_keys_;
   std::vector<std::shared_ptr<ConstVarFactor>> const_var_factors_v_,
       const_var_factors_ad_;
+  Ordering ordering_v_, ordering_ad_;  // orderings of the linear levels
 
  public:
   /// Constructor.
@@ -213,6 +240,14 @@ class DynamicsRetractor : public Retractor {
 
   void updatePriors(const Values &values, const KeySet &keys,
                     NonlinearFactorGraph &graph);
+
+  /** Solve a level that is linear given the levels below: one Gauss-Newton
+   * step on the graph with priors exactly solves it, and LM without priors
+   * only runs if that leaves the constraints violated. Nonlinear or rank
+   * deficient levels fall back to LM with and without priors. */
+  Values solveLinearLevel(const Values &values, const Ordering &ordering,
+                          MutableLMOptimizer &optimizer_wp,
+                          MutableLMOptimizer &optimizer_np);
 };
 
 }  // namespace gtsam
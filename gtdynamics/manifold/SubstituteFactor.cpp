@@ -14,8 +14,91 @@
 #include <gtdynamics/manifold/ConstraintManifold.h>
 #include <gtdynamics/manifold/SubstituteFactor.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace gtsam {
 
+/* ************************************************************************* */
+KeyVector StackedFactor::StackedKeys(
+    const std::vector<Base::shared_ptr>& factors) {
+  KeyVector keys;
+  KeySet key_set;
+  for (const auto& factor : factors) {
+    for (const Key& key : factor->keys()) {
+      if (key_set.insert(key).second) keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+size_t StackedFactor::StackedDim(const std::vector<Base::shared_ptr>& factors) {
+  size_t dim = 0;
+  for (const auto& factor : factors) {
+    dim += factor->dim();
+  }
+  return dim;
+}
+
+/* ************************************************************************* */
+bool StackedFactor::IsStackable(const Base::shared_ptr& factor) {
+  const auto& model = factor->noiseModel();
+  return model && !model->isConstrained() &&
+         !std::dynamic_pointer_cast<noiseModel::Robust>(model);
+}
+
+/* ************************************************************************* */
+StackedFactor::StackedFactor(const std::vector<Base::shared_ptr>& factors)
+    : Base(noiseModel::Unit::Create(StackedDim(factors)),
+           StackedKeys(factors)),
+      factors_(factors) {
+  size_t row = 0;
+  for (const auto& factor : factors_) {
+    if (!IsStackable(factor)) {
+      throw std::invalid_argument(
+          "StackedFactor: factors must have Gaussian noise models.");
+    }
+    std::vector<size_t> indices;
+    for (const Key& key : factor->keys()) {
+      indices.push_back(std::find(keys().begin(), keys().end(), key) -
+                        keys().begin());
+    }
+    key_indices_.push_back(indices);
+    row_offsets_.push_back(row);
+    row += factor->dim();
+  }
+}
+
+/* ************************************************************************* */
+Vector StackedFactor::unwhitenedError(const Values& x,
+                                      gtsam::OptionalMatrixVecType H) const {
+  Vector error(dim());
+  if (H) {
+    for (size_t j = 0; j < size(); j++) {
+      (*H)[j] = Matrix::Zero(dim(), x.at(keys()[j]).dim());
+    }
+  }
+  for (size_t i = 0; i < factors_.size(); i++) {
+    const auto& factor = factors_[i];
+    const size_t factor_dim = factor->dim();
+    if (H) {
+      std::vector<Matrix> factor_H(factor->size());
+      Vector factor_error = factor->unwhitenedError(x, factor_H);
+      factor->noiseModel()->WhitenSystem(factor_H, factor_error);
+      error.segment(row_offsets_[i], factor_dim) = factor_error;
+      for (size_t k = 0; k < factor_H.size(); k++) {
+        (*H)[key_indices_[i][k]].middleRows(row_offsets_[i], factor_dim) =
+            factor_H[k];
+      }
+    } else {
+      error.segment(row_offsets_[i], factor_dim) =
+          factor->noiseModel()->whiten(factor->unwhitenedError(x));
+    }
+  }
+  return error;
+}
+
 /* ************************************************************************* */
 KeyVector SubstituteFactor::computeNewKeys(
     const Base::shared_ptr& base_factor,
@@ -19,6 +19,55 @@
 
 namespace gtsam {
 
+/** A factor that stacks the whitened errors of several Gaussian factors. Used
+ * to substitute a group of cost factors on the same constraint manifold at
+ * once, so the jacobian of the manifold's recover function is multiplied
+ * once with the stacked jacobian instead of once per factor. The factors must
+ * not have robust or constrained noise models. */
+class StackedFactor : public NoiseModelFactor {
+ protected:
+  typedef NoiseModelFactor Base;
+  typedef StackedFactor This;
+
+  std::vector<Base::shared_ptr> factors_;
+  // for each factor, the index in keys() of each of its keys
+  std::vector<std::vector<size_t>> key_indices_;
+  // for each factor, the first row of its error
+  std::vector<size_t> row_offsets_;
+
+ public:
+  typedef std::shared_ptr<This> shared_ptr;
+
+  /// Default constructor for I/O only.
+  StackedFactor() {}
+
+  /// Constructor from factors to stack.
+  StackedFactor(const std::vector<Base::shared_ptr>& factors);
+
+  /// Check if a factor can be stacked, i.e., has a plain Gaussian noise model.
+  static bool IsStackable(const Base::shared_ptr& factor);
+
+  /// Stacked whitened errors of the factors, and their jacobians.
+  Vector unwhitenedError(
+      const Values& x, gtsam::OptionalMatrixVecType H = nullptr) const override;
+
+  /// Return a deep copy of this factor.
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// Stacked factors.
+  const std::vector<Base::shared_ptr>& factors() const { return factors_; }
+
+ protected:
+  /// Keys of all factors, in order of first appearance.
+  static KeyVector StackedKeys(const std::vector<Base::shared_ptr>& factors);
+
+  /// Total dimension of the factors.
+  static size_t StackedDim(const std::vector<Base::shared_ptr>& factors);
+};  // \class StackedFactor
+
 /** A factor that substitute certain variables of a base factor with constraint
  * manifold variables.
  * It is used for constraint manifold optimization, since the variables
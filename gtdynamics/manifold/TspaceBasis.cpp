@@ -13,11 +13,15 @@
 
 #include <Eigen/SparseQR>
 #include <gtdynamics/manifold/TspaceBasis.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 
+#include <functional>
+#include <optional>
+
 namespace gtsam {
 
 /* ************************************************************************* */
@@ -78,6 +82,7 @@ MatrixBasis::MatrixBasis(const TspaceBasisParams::shared_ptr &params,
 /* ************************************************************************* */
 void MatrixBasis::construct(const ConnectedComponent::shared_ptr &cc,
                             const Values &values) {
+  GTD_TRACE_SCOPE("TspaceBasis::construct", "manifold");
   auto linear_graph = cc->merit_graph_.linearize(values);
   JacobianFactor combined(*linear_graph);
   auto augmented = combined.augmentedJacobian();
@@ -145,6 +150,7 @@ SparseMatrixBasis::SparseMatrixBasis(
 /* ************************************************************************* */
 void SparseMatrixBasis::construct(const ConnectedComponent::shared_ptr &cc,
                                   const Values &values) {
+  GTD_TRACE_SCOPE("TspaceBasis::construct", "manifold");
   auto linear_graph = cc->merit_graph_.linearize(values);
 
   std::vector<Triplet> triplet_list;
@@ -158,12 +164,17 @@ void SparseMatrixBasis::construct(const ConnectedComponent::shared_ptr &cc,
   A.setFromTriplets(triplet_list.begin(), triplet_list.end());
   is_constructed_ = true;
 
+  // The kernel of A is spanned by the last columns of Q in the rank-revealing
+  // QR A^T P = Q R. Only those columns are formed, by applying the Householder
+  // reflections to [0; I], instead of expanding the n x n matrix Q; they are
+  // then pruned back to sparse form.
   SpMatrix A_t = A.transpose();
-  SpMatrix Q;
-  auto qr = Eigen::SparseQR<SpMatrix, Eigen::COLAMDOrdering<int>>(A_t);
-  Q = qr.matrixQ();
-
-  basis_ = Q.rightCols(total_basis_dim_);
+  A_t.makeCompressed();
+  Eigen::SparseQR<SpMatrix, Eigen::COLAMDOrdering<int>> qr(A_t);
+  Matrix selection = Matrix::Zero(total_variable_dim_, total_basis_dim_);
+  selection.bottomRows(total_basis_dim_).setIdentity();
+  const Matrix kernel = qr.matrixQ() * selection;
+  basis_ = kernel.sparseView(1.0, 1e-12);
 }
 
 /* ************************************************************************* */
@@ -258,18 +269,19 @@ FixedVarBasis::FixedVarBasis(const ConnectedComponent::shared_ptr &cc,
                                    const FixedVarBasis &other)
     : TspaceBasis(other.params_), basis_keys_(other.basis_keys_),
       ordering_(other.ordering_), total_basis_dim_(other.total_basis_dim_),
-      basis_location_(other.basis_location_), var_dim_(other.var_dim_) {
-  if (params_->always_construct_basis) {
-    construct(cc, values);
-  }
-}
+      basis_location_(other.basis_location_), var_dim_(other.var_dim_) {}
 
 /* ************************************************************************* */
 void FixedVarBasis::construct(const ConnectedComponent::shared_ptr &cc,
                                  const Values &values) {
+  GTD_TRACE_SCOPE("TspaceBasis::construct", "manifold");
   auto linear_graph = cc->merit_graph_.linearize(values);
-  auto elim_result =
-      linear_graph->eliminatePartialSequential(ordering_, EliminateQR);
+  const auto variable_index =
+      params_->reuse_elimination_structure
+          ? std::optional(std::cref(cc->variable_index_))
+          : std::nullopt;
+  auto elim_result = linear_graph->eliminatePartialSequential(
+      ordering_, EliminateQR, variable_index);
   auto bayes_net = elim_result.first;
   ComputeBayesNetJacobian(*bayes_net, basis_keys_, var_dim_, jacobians_);
   is_constructed_ = true;
@@ -282,30 +294,23 @@ VectorValues FixedVarBasis::computeTangentVector(const Vector &xi) const {
   for (const Key &key : basis_keys_) {
     delta.insert(key, xi.segment(basis_location_.at(key), var_dim_.at(key)));
   }
-  // Compute tangent vector of non-basis variables
-  for (const auto &it : jacobians_) {
-    const Key &var_key = it.first;
-    if (delta.exists(var_key))
-      continue;
-    Vector v = Vector::Zero(var_dim_.at(var_key));
-    for (const auto &jac_it : it.second) {
-      const Key &basis_key = jac_it.first;
-      v += jac_it.second * delta.at(basis_key);
+  // Compute tangent vector of non-basis variables, with one product of the
+  // stacked jacobian, whose columns are ordered as xi.
+  const Vector v = jacobians_.matrix() * xi;
+  size_t row = 0;
+  for (const Key &var_key : jacobians_.keys()) {
+    const size_t dim = var_dim_.at(var_key);
+    if (!delta.exists(var_key)) {
+      delta.insert(var_key, v.segment(row, dim));
     }
-    delta.insert(var_key, v);
+    row += dim;
   }
   return delta;
 }
 
 /* ************************************************************************* */
 Matrix FixedVarBasis::recoverJacobian(const Key &key) const {
-  Matrix H = Matrix::Zero(var_dim_.at(key), total_basis_dim_);
-  for (const auto &it : jacobians_.at(key)) {
-    const Key &basis_key = it.first;
-    H.middleCols(basis_location_.at(basis_key), var_dim_.at(basis_key)) =
-        it.second;
-  }
-  return H;
+  return jacobians_.jacobian(key);
 }
 
 /* ************************************************************************* */
@@ -39,8 +39,14 @@ struct TspaceBasisParams {
 
   /// Member variables.
   BasisType basis_type = BasisType::MATRIX;
+  /// Construct the basis of the initial values right away. Bases created
+  /// with createWithNewValues, e.g. at LM trial points, are always
+  /// constructed on first use, so rejected steps cost no kernel computation.
   bool always_construct_basis = true;
   bool use_basis_keys = false;
+  /// FixedVarBasis: reuse the variable index of the component's constraint
+  /// graph, so each construction only redoes the numeric elimination.
+  bool reuse_elimination_structure = true;
 
   /// Constructors.
   TspaceBasisParams() = default;
@@ -90,7 +96,7 @@ class TspaceBasis {
   /// Default destructor.
   virtual ~TspaceBasis() {}
 
-  /// Construct new basis by using new values
+  /// Construct new basis by using new values; construct() is deferred.
   virtual shared_ptr createWithNewValues(
       const ConnectedComponent::shared_ptr &cc, const Values &values) const = 0;
 
@@ -189,17 +195,13 @@ class MatrixBasis : public TspaceBasis {
   MatrixBasis(const TspaceBasisParams::shared_ptr &params,
               const ConnectedComponent::shared_ptr &cc, const Values &values);
 
-  /// Constructor from other, avoids recomputation.
+  /// Constructor from other at new values, constructed on first use.
   MatrixBasis(const ConnectedComponent::shared_ptr &cc, const Values &values,
               const MatrixBasis &other)
       : TspaceBasis(other.params_),
         var_location_(other.var_location_),
         var_dim_(other.var_dim_),
-        total_basis_dim_(other.total_basis_dim_) {
-    if (params_->always_construct_basis) {
-      construct(cc, values);
-    }
-  }
+        total_basis_dim_(other.total_basis_dim_) {}
 
   /// Create basis with new values.
   TspaceBasis::shared_ptr createWithNewValues(
@@ -259,7 +261,7 @@ class SparseMatrixBasis : public TspaceBasis {
                     const ConnectedComponent::shared_ptr &cc,
                     const Values &values);
 
-  /// Constructor from other, avoids recomputation.
+  /// Constructor from other at new values, constructed on first use.
   SparseMatrixBasis(const ConnectedComponent::shared_ptr &cc,
                     const Values &values, const SparseMatrixBasis &other)
       : TspaceBasis(other.params_),
@@ -267,11 +269,7 @@ class SparseMatrixBasis : public TspaceBasis {
         var_dim_(other.var_dim_),
         total_variable_dim_(other.total_variable_dim_),
         total_constraint_dim_(other.total_constraint_dim_),
-        total_basis_dim_(other.total_basis_dim_) {
-    if (params_->always_construct_basis) {
-      construct(cc, values);
-    }
-  }
+        total_basis_dim_(other.total_basis_dim_) {}
 
   /// Create basis with new values.
   TspaceBasis::shared_ptr createWithNewValues(
@@ -326,7 +324,7 @@ class FixedVarBasis : public TspaceBasis {
   size_t total_basis_dim_;
   std::map<Key, size_t> basis_location_;
   std::map<Key, size_t> var_dim_;
-  MultiJacobians jacobians_;
+  FlatMultiJacobians jacobians_;
 
  public:
   /** Constructor
@@ -338,7 +336,7 @@ class FixedVarBasis : public TspaceBasis {
                 const ConnectedComponent::shared_ptr &cc, const Values &values,
                 std::optional<const KeyVector> basis_keys = {});
 
-  /// Constructor from other, avoids recomputation.
+  /// Constructor from other at new values, constructed on first use.
   FixedVarBasis(const ConnectedComponent::shared_ptr &cc, const Values &values,
                 const FixedVarBasis &other);
 
@@ -370,15 +368,11 @@ class FixedVarBasis : public TspaceBasis {
   void print(
       const gtsam::KeyFormatter &keyFormatter = DefaultKeyFormatter) override {
     std::cout << "Elimination basis\n";
-    for (const auto &it : jacobians_) {
-      std::cout << "\033[1;31mVariable: " << keyFormatter(it.first)
-                << "\033[0m\n";
-      it.second.print("", keyFormatter);
-    }
+    jacobians_.print("", keyFormatter);
   }
 
   /// Return a const reference to jacobians.
-  const MultiJacobians &jacobians() const { return jacobians_; }
+  const FlatMultiJacobians &jacobians() const { return jacobians_; }
 };
 
 }  // namespace gtsam
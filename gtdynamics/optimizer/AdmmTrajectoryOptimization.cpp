@@ -0,0 +1,310 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdmmTrajectoryOptimization.cpp
+ * @brief Trajectory optimization over overlapping time segments with ADMM.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/AdmmTrajectoryOptimization.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+#include <gtsam/base/serialization.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+/// Identifies messages; bump the version when the layout changes.
+static const std::string kAdmmMessageMagic = "gtdynamics-admm";
+static constexpr uint32_t kAdmmMessageVersion = 1;
+
+namespace {
+/**
+ * Penalty of a variable away from its target, in the local coordinates of
+ * the target, with the unit Jacobian PriorFactor uses, for any value type.
+ */
+class ConsensusFactor : public gtsam::NoiseModelFactor {
+  std::shared_ptr<gtsam::Value> target_;
+
+ public:
+  ConsensusFactor(Key key, const gtsam::Value &target, double rho)
+      : gtsam::NoiseModelFactor(
+            gtsam::noiseModel::Isotropic::Sigma(target.dim(),
+                                                1.0 / std::sqrt(rho)),
+            gtsam::KeyVector{key}),
+        target_(target.clone()) {}
+
+  Vector unwhitenedError(const Values &x,
+                         gtsam::OptionalMatrixVecType H = nullptr) const
+      override {
+    if (H) (*H)[0] = gtsam::Matrix::Identity(target_->dim(), target_->dim());
+    return target_->localCoordinates_(x.at(keys().front()));
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::make_shared<ConsensusFactor>(*this);
+  }
+};
+
+/// The values of keys.
+Values Subset(const Values &values, const gtsam::KeyVector &keys) {
+  Values subset;
+  for (Key key : keys) subset.insert(key, values.at(key));
+  return subset;
+}
+}  // namespace
+
+/* ************************************************************************* */
+std::vector<Interval> TimeSegments(size_t num_steps, size_t segment_steps,
+                                   size_t overlap) {
+  if (overlap < 1 || overlap > segment_steps) {
+    throw std::invalid_argument(
+        "TimeSegments: needs 1 <= overlap <= segment_steps");
+  }
+  std::vector<Interval> segments;
+  const size_t stride = segment_steps - overlap + 1;
+  for (size_t k = 0;; k += stride) {
+    const size_t k_end = std::min(k + segment_steps, num_steps);
+    segments.emplace_back(k, k_end);
+    if (k_end == num_steps) break;
+  }
+  return segments;
+}
+
+/* ************************************************************************* */
+AdmmSegment::AdmmSegment(const gtsam::NonlinearFactorGraph &graph,
+                         const Values &initial, const gtsam::KeyVector &shared,
+                         double rho, const gtsam::MutableLMParams &lm_params)
+    : graph_(graph),
+      values_(initial),
+      shared_(shared),
+      rho_(rho),
+      lm_params_(lm_params) {
+  for (Key key : shared_) {
+    if (!values_.exists(key)) {
+      throw std::invalid_argument(
+          "AdmmSegment: shared variable without initial value");
+    }
+  }
+  error_ = graph_.error(values_);
+}
+
+/* ************************************************************************* */
+Values AdmmSegment::solve(const Values &targets) {
+  gtsam::NonlinearFactorGraph graph = graph_;
+  for (Key key : shared_) {
+    graph.emplace_shared<ConsensusFactor>(key, targets.at(key), rho_);
+  }
+  gtsam::MutableLMOptimizer optimizer(graph, values_, lm_params_);
+  values_ = optimizer.optimize();
+  error_ = graph_.error(values_);
+  return sharedValues();
+}
+
+/* ************************************************************************* */
+Values AdmmSegment::sharedValues() const { return Subset(values_, shared_); }
+
+/* ************************************************************************* */
+AdmmConsensus::AdmmConsensus(const std::vector<Values> &shared, double rho)
+    : rho_(rho) {
+  for (auto &&values : shared) {
+    keys_.push_back(values.keys());
+    VectorValues duals;
+    for (Key key : keys_.back()) {
+      duals.insert(key, Vector::Zero(values.at(key).dim()));
+      if (!consensus_.exists(key)) consensus_.insert(key, values.at(key));
+    }
+    duals_.push_back(duals);
+  }
+  consensus_ = mean(shared);
+}
+
+/* ************************************************************************* */
+Values AdmmConsensus::mean(const std::vector<Values> &shared) const {
+  // Mean of values plus duals, in local coordinates at the consensus.
+  std::map<Key, std::pair<Vector, size_t>> sums;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    for (Key key : keys_[i]) {
+      const Vector d = consensus_.at(key).localCoordinates_(shared[i].at(key)) +
+                       duals_[i].at(key);
+      auto it = sums.find(key);
+      if (it == sums.end()) {
+        sums.emplace(key, std::make_pair(d, size_t(1)));
+      } else {
+        it->second.first += d;
+        it->second.second++;
+      }
+    }
+  }
+  VectorValues delta;
+  for (auto &&[key, sum] : sums) delta.insert(key, sum.first / sum.second);
+  return consensus_.retract(delta);
+}
+
+/* ************************************************************************* */
+Values AdmmConsensus::targets(size_t i) const {
+  VectorValues delta;
+  for (Key key : keys_.at(i)) delta.insert(key, -duals_[i].at(key));
+  return Subset(consensus_, keys_[i]).retract(delta);
+}
+
+/* ************************************************************************* */
+void AdmmConsensus::update(const std::vector<Values> &shared) {
+  if (shared.size() != keys_.size()) {
+    throw std::invalid_argument("AdmmConsensus: one values per segment");
+  }
+  const Values previous = consensus_;
+  consensus_ = mean(shared);
+
+  double primal = 0, dual = 0;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    for (Key key : keys_[i]) {
+      const Vector r = consensus_.at(key).localCoordinates_(shared[i].at(key));
+      duals_[i].at(key) += r;
+      primal += r.squaredNorm();
+      dual += previous.at(key).localCoordinates_(consensus_.at(key))
+                  .squaredNorm();
+    }
+  }
+  primal_residual_ = std::sqrt(primal);
+  dual_residual_ = rho_ * std::sqrt(dual);
+}
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+/* ************************************************************************* */
+// Values are serialized through base class pointers, so the value types are
+// registered per archive, in the same order for saving and loading.
+template <class ARCHIVE>
+static void RegisterAdmmMessageTypes(ARCHIVE &ar) {
+  using gtsam::GenericValue;
+  ar.template register_type<GenericValue<double>>();
+  ar.template register_type<GenericValue<gtsam::Vector3>>();
+  ar.template register_type<GenericValue<gtsam::Vector6>>();
+  ar.template register_type<GenericValue<Vector>>();
+  ar.template register_type<GenericValue<gtsam::Pose3>>();
+}
+#endif
+
+/* ************************************************************************* */
+void SaveAdmmMessage(const AdmmMessage &message, std::ostream &os) {
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  boost::archive::binary_oarchive ar(os);
+  RegisterAdmmMessageTypes(ar);
+  uint32_t version = kAdmmMessageVersion;
+  ar << kAdmmMessageMagic << version;
+  ar << message.segment << message.iteration << message.values;
+#else
+  throw std::runtime_error(
+      "SaveAdmmMessage: GTDynamics was built without Boost serialization.");
+#endif
+}
+
+/* ************************************************************************* */
+AdmmMessage LoadAdmmMessage(std::istream &is) {
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  boost::archive::binary_iarchive ar(is);
+  RegisterAdmmMessageTypes(ar);
+  std::string magic;
+  uint32_t version;
+  ar >> magic >> version;
+  if (magic != kAdmmMessageMagic || version != kAdmmMessageVersion) {
+    throw std::runtime_error("LoadAdmmMessage: not a message of version " +
+                             std::to_string(kAdmmMessageVersion));
+  }
+  AdmmMessage message;
+  ar >> message.segment >> message.iteration >> message.values;
+  return message;
+#else
+  throw std::runtime_error(
+      "LoadAdmmMessage: GTDynamics was built without Boost serialization.");
+#endif
+}
+
+/* ************************************************************************* */
+AdmmResult AdmmTrajectoryOptimize(size_t num_steps,
+                                  const SegmentGraphFunction &graph,
+                                  const SegmentValuesFunction &initial_values,
+                                  const gtsam::MutableLMParams &lm_params,
+                                  const AdmmParameters &parameters) {
+  AdmmResult result;
+  result.segments =
+      TimeSegments(num_steps, parameters.segment_steps, parameters.overlap);
+  const size_t n = result.segments.size();
+
+  // Graphs and initial values of the segments, built in parallel.
+  std::vector<gtsam::NonlinearFactorGraph> graphs(n);
+  std::vector<Values> values(n);
+  parameters.execution.parallelFor(n, [&](size_t i) {
+    graphs[i] = graph(result.segments[i]);
+    values[i] = initial_values(result.segments[i]);
+  });
+
+  // Variables in more than one segment are shared.
+  std::map<Key, size_t> num_segments;
+  for (auto &&segment_values : values) {
+    for (Key key : segment_values.keys()) num_segments[key]++;
+  }
+  std::vector<AdmmSegment> segments;
+  segments.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    gtsam::KeyVector shared;
+    for (Key key : values[i].keys()) {
+      if (num_segments[key] > 1) shared.push_back(key);
+    }
+    segments.emplace_back(graphs[i], values[i], shared, parameters.rho,
+                          lm_params);
+  }
+  graphs.clear();
+  values.clear();
+
+  std::vector<Values> shared(n);
+  for (size_t i = 0; i < n; i++) shared[i] = segments[i].sharedValues();
+  AdmmConsensus consensus(shared, parameters.rho);
+  while (result.iterations < parameters.max_iterations) {
+    parameters.execution.parallelFor(n, [&](size_t i) {
+      shared[i] = segments[i].solve(consensus.targets(i));
+    });
+    consensus.update(shared);
+    result.iterations++;
+    if (consensus.primalResidual() <= parameters.tolerance &&
+        consensus.dualResidual() <= parameters.tolerance) {
+      break;
+    }
+  }
+  result.primal_residual = consensus.primalResidual();
+  result.dual_residual = consensus.dualResidual();
+
+  result.values = consensus.consensus();
+  for (auto &&segment : segments) {
+    for (Key key : segment.values().keys()) {
+      if (!result.values.exists(key)) {
+        result.values.insert(key, segment.values().at(key));
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
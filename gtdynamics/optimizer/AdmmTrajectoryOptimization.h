@@ -0,0 +1,211 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdmmTrajectoryOptimization.h
+ * @brief Trajectory optimization over overlapping time segments with ADMM.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/Interval.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Time steps k_start..k_end of the segments of a trajectory of num_steps
+ * steps, both ends included. Each segment has segment_steps steps, the last
+ * one possibly fewer, and consecutive segments share `overlap` time steps.
+ * Throws std::invalid_argument unless 1 <= overlap <= segment_steps.
+ */
+std::vector<Interval> TimeSegments(size_t num_steps, size_t segment_steps,
+                                   size_t overlap = 1);
+
+/**
+ * One time segment of a trajectory in consensus ADMM, which can run on its
+ * own worker: it holds the factors and current values of the segment, and
+ * solves it with a quadratic penalty of weight rho pulling its shared
+ * variables, those other segments also have, towards targets from the
+ * AdmmConsensus. Penalties are on the local coordinates of the shared
+ * variables, so any value type can be shared.
+ */
+class AdmmSegment {
+ public:
+  /**
+   * Constructor.
+   * @param graph     factors of the segment
+   * @param initial   initial values of all its variables
+   * @param shared    keys of its shared variables, all in initial
+   * @param rho       weight of the consensus penalty
+   * @param lm_params parameters of each solve
+   */
+  AdmmSegment(const gtsam::NonlinearFactorGraph &graph,
+              const gtsam::Values &initial, const gtsam::KeyVector &shared,
+              double rho,
+              const gtsam::MutableLMParams &lm_params =
+                  gtsam::MutableLMParams());
+
+  /**
+   * Optimize the segment from its current values, with the penalty towards
+   * targets, which has a value per shared variable.
+   * @return the shared values of the solution
+   */
+  gtsam::Values solve(const gtsam::Values &targets);
+
+  /// Current values of all variables of the segment.
+  const gtsam::Values &values() const { return values_; }
+
+  /// Current values of the shared variables.
+  gtsam::Values sharedValues() const;
+
+  /// Keys of the shared variables.
+  const gtsam::KeyVector &shared() const { return shared_; }
+
+  /// Error of the segment factors, without the penalty, after the last solve.
+  double error() const { return error_; }
+
+ private:
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::Values values_;
+  gtsam::KeyVector shared_;
+  double rho_;
+  gtsam::MutableLMParams lm_params_;
+  double error_;
+};
+
+/**
+ * The coordinator of consensus ADMM: from the shared values each segment
+ * returns, it updates the consensus of every shared variable, the mean of
+ * the segment values and scaled duals in local coordinates, and the duals,
+ * and gives each segment its targets, the consensus offset by its duals.
+ */
+class AdmmConsensus {
+ public:
+  /**
+   * Constructor.
+   * @param shared  shared values of each segment, initially, e.g.
+   *                AdmmSegment::sharedValues
+   * @param rho     weight of the consensus penalty, for the dual residual
+   */
+  AdmmConsensus(const std::vector<gtsam::Values> &shared, double rho);
+
+  /// Targets of segment i, for AdmmSegment::solve.
+  gtsam::Values targets(size_t i) const;
+
+  /// Update consensus and duals from the shared values of all segments.
+  void update(const std::vector<gtsam::Values> &shared);
+
+  /// Current consensus of all shared variables.
+  const gtsam::Values &consensus() const { return consensus_; }
+
+  /// Norms of the primal and dual residuals of the last update.
+  double primalResidual() const { return primal_residual_; }
+  double dualResidual() const { return dual_residual_; }
+
+ private:
+  std::vector<gtsam::KeyVector> keys_;  // shared keys of each segment
+  std::vector<gtsam::VectorValues> duals_;
+  gtsam::Values consensus_;
+  double rho_;
+  double primal_residual_ = 0, dual_residual_ = 0;
+
+  /// Consensus of shared values plus duals.
+  gtsam::Values mean(const std::vector<gtsam::Values> &shared) const;
+};
+
+/// Shared values exchanged between segment workers and the coordinator.
+struct AdmmMessage {
+  size_t segment = 0;    ///< index of the segment
+  size_t iteration = 0;  ///< ADMM iteration
+  gtsam::Values values;  ///< shared values, or targets
+};
+
+/**
+ * Write a message in binary, after a magic string and a format version.
+ * Throws if GTDynamics is built without Boost serialization, or if a value
+ * type is not registered: double, Vector3, Vector6, Vector and Pose3 are.
+ */
+void SaveAdmmMessage(const AdmmMessage &message, std::ostream &os);
+
+/**
+ * Read a message written by SaveAdmmMessage. Throws std::runtime_error for
+ * data of another format or version, and if GTDynamics is built without
+ * Boost serialization.
+ */
+AdmmMessage LoadAdmmMessage(std::istream &is);
+
+/// Options of AdmmTrajectoryOptimize.
+struct AdmmParameters {
+  /// Time steps of each segment, and the steps consecutive segments share.
+  size_t segment_steps = 50;
+  size_t overlap = 1;
+
+  /// Weight of the consensus penalty.
+  double rho = 1.0;
+
+  /// Stop after this many iterations, or when both residuals are below
+  /// tolerance.
+  size_t max_iterations = 50;
+  double tolerance = 1e-5;
+
+  /// Threads solving the segments, by default one per hardware thread.
+  ExecutionContext execution = ExecutionContext::Threads(0);
+};
+
+/// Result of AdmmTrajectoryOptimize.
+struct AdmmResult {
+  gtsam::Values values;            // shared variables at their consensus
+  std::vector<Interval> segments;  // time steps of each segment
+  size_t iterations = 0;           // ADMM iterations run
+  double primal_residual = 0;      // residuals of the last iteration
+  double dual_residual = 0;
+};
+
+/// Factor graph of the time steps of a segment, both ends included.
+using SegmentGraphFunction =
+    std::function<gtsam::NonlinearFactorGraph(const Interval &)>;
+
+/// Initial values of the variables of a segment.
+using SegmentValuesFunction = std::function<gtsam::Values(const Interval &)>;
+
+/**
+ * Optimize a long trajectory as overlapping time segments, see TimeSegments,
+ * so that no graph of the whole horizon is ever built. The segments are
+ * solved in parallel, and agree on the variables they share, those in the
+ * values of more than one segment, through consensus ADMM: each iteration
+ * solves all segments with AdmmSegment, then updates their targets with
+ * AdmmConsensus. Factors on the overlap are in both segments, so the
+ * segment graphs should split costs on it, e.g. keep objectives on a time
+ * step in one segment only; dynamics constraints may be repeated.
+ *
+ * To run the segments on different nodes, use AdmmSegment and AdmmConsensus
+ * directly, and exchange AdmmMessages.
+ * @param num_steps      total time steps
+ * @param graph          builds the factor graph of each segment
+ * @param initial_values builds the initial values of each segment
+ * @param lm_params      parameters of each segment solve
+ * @param parameters     segments, penalty, stopping and threads
+ * @return values of all variables, with shared ones at their consensus
+ */
+AdmmResult AdmmTrajectoryOptimize(
+    size_t num_steps, const SegmentGraphFunction &graph,
+    const SegmentValuesFunction &initial_values,
+    const gtsam::MutableLMParams &lm_params = gtsam::MutableLMParams(),
+    const AdmmParameters &parameters = AdmmParameters());
+
+}  // namespace gtdynamics
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnytimeOptimization.cpp
+ * @brief Time budgets and per-iteration callbacks for optimizers.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+
+#include <cmath>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void BestIterate::update(const gtsam::Values& values, double cost,
+                         double violation, bool feasible) {
+  bool better;
+  if (empty_) {
+    better = true;
+  } else if (feasible != feasible_) {
+    better = feasible;
+  } else {
+    better = feasible ? cost < cost_ : violation < violation_;
+  }
+  if (!better) return;
+  empty_ = false;
+  feasible_ = feasible;
+  cost_ = cost;
+  violation_ = violation;
+  values_ = values;
+}
+
+/* ************************************************************************* */
+const gtsam::Values& OptimizeAnytime(
+    gtsam::NonlinearOptimizer& optimizer,
+    const gtsam::NonlinearOptimizerParams& params,
+    const AnytimeParameters& anytime,
+    const std::function<double(const gtsam::Values&)>& violation) {
+  const Deadline deadline(anytime.time_budget);
+
+  // Same stopping criteria as NonlinearOptimizer::defaultOptimize.
+  double current_error = optimizer.error();
+  if (current_error <= params.errorTol || params.maxIterations == 0) {
+    return optimizer.values();
+  }
+
+  while (true) {
+    optimizer.iterate();
+    const double new_error = optimizer.error();
+
+    if (anytime.callback) {
+      const IterationReport report{
+          optimizer.iterations(), deadline.elapsed(), new_error,
+          violation ? violation(optimizer.values()) : 0.0,
+          &optimizer.values()};
+      if (!anytime.callback(report)) break;
+    }
+
+    const bool converged = gtsam::checkConvergence(
+        params.relativeErrorTol, params.absoluteErrorTol, params.errorTol,
+        current_error, new_error, params.verbosity);
+    current_error = new_error;
+    if (converged || !std::isfinite(new_error) ||
+        optimizer.iterations() >= params.maxIterations || deadline.expired()) {
+      break;
+    }
+  }
+  return optimizer.values();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnytimeOptimization.h
+ * @brief Time budgets and per-iteration callbacks for optimizers.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+#include <gtsam/nonlinear/NonlinearOptimizerParams.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace gtdynamics {
+
+/// Progress of an optimizer after one (outer) iteration.
+struct IterationReport {
+  size_t iteration;             // number of iterations done
+  double elapsed;               // seconds since optimization started
+  double cost;                  // cost, or merit function error
+  double violation;             // constraint violation, 0 if unconstrained
+  const gtsam::Values* values;  // current iterate
+};
+
+/// Called after each iteration; return false to stop the optimizer.
+using IterationCallback = std::function<bool(const IterationReport&)>;
+
+/// Anytime options: stop on a wall-clock budget, report each iteration.
+struct AnytimeParameters {
+  double time_budget = 0.0;    // seconds, 0 means no budget
+  IterationCallback callback;  // optional
+
+  /// Whether any anytime option is set.
+  bool active() const { return time_budget > 0 || bool(callback); }
+};
+
+/// Wall-clock deadline, started on construction.
+class Deadline {
+ public:
+  explicit Deadline(double time_budget = 0.0)
+      : start_(std::chrono::steady_clock::now()), time_budget_(time_budget) {}
+
+  /// Seconds since construction.
+  double elapsed() const {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_;
+    return elapsed.count();
+  }
+
+  /// Seconds left, or 0 if there is no budget.
+  double remaining() const {
+    return time_budget_ > 0 ? std::max(time_budget_ - elapsed(), 1e-9) : 0.0;
+  }
+
+  /// Whether the budget, if any, is used up.
+  bool expired() const { return time_budget_ > 0 && elapsed() >= time_budget_; }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  double time_budget_;
+};
+
+/**
+ * Keep the best iterate seen so far: the feasible one with the lowest cost
+ * or, while none is feasible, the one with the lowest violation.
+ */
+class BestIterate {
+ public:
+  /// Offer an iterate.
+  void update(const gtsam::Values& values, double cost, double violation,
+              bool feasible);
+
+  /// Whether any iterate was offered.
+  bool empty() const { return empty_; }
+
+  /// The best iterate.
+  const gtsam::Values& values() const { return values_; }
+
+ private:
+  bool empty_ = true;
+  bool feasible_ = false;
+  double cost_ = 0.0, violation_ = 0.0;
+  gtsam::Values values_;
+};
+
+/**
+ * Run a nonlinear optimizer like NonlinearOptimizer::optimize, but also stop
+ * when the time budget is used up or the callback returns false. The time
+ * budget is checked after each iteration.
+ * @param optimizer the optimizer to run.
+ * @param params its parameters, for the convergence criteria.
+ * @param anytime time budget and callback.
+ * @param violation optional constraint violation reported to the callback.
+ * @return the values of the optimizer.
+ */
+const gtsam::Values& OptimizeAnytime(
+    gtsam::NonlinearOptimizer& optimizer,
+    const gtsam::NonlinearOptimizerParams& params,
+    const AnytimeParameters& anytime,
+    const std::function<double(const gtsam::Values&)>& violation = {});
+
+}  // namespace gtdynamics
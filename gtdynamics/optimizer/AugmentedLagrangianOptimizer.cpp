@@ -11,51 +11,183 @@
  * @author: Yetong Zhang, Frank Dellaert
  */
 
+#include <gtdynamics/factors/BiasedFactor.h>
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+
+#include <stdexcept>
+#include <utility>
 
 namespace gtdynamics {
 
-/** Update penalty parameter and Lagrangian multipliers from unconstrained
- * optimization result. */
-void update_parameters(const EqualityConstraints& constraints,
-                       const gtsam::Values& previous_values,
-                       const gtsam::Values& current_values, double& mu,
-                       std::vector<gtsam::Vector>& z) {
-  double previous_error = 0;
-  double current_error = 0;
-  for (size_t constraint_index = 0; constraint_index < constraints.size();
-       constraint_index++) {
-    auto constraint = constraints.at(constraint_index);
-
-    // Update Lagrangian multipliers.
-    auto violation = (*constraint)(current_values);
-    z[constraint_index] += mu * violation;
-
-    // Sum errors for updating penalty parameter.
-    previous_error +=
-        pow(constraint->toleranceScaledViolation(previous_values).norm(), 2);
-    current_error +=
-        pow(constraint->toleranceScaledViolation(current_values).norm(), 2);
+AugmentedLagrangianState AugmentedLagrangianState::reindexed(
+    const std::vector<int>& equality_map,
+    const std::vector<size_t>& equality_dims,
+    const std::vector<int>& inequality_map,
+    const std::vector<size_t>& inequality_dims) const {
+  auto reindex = [](const std::vector<gtsam::Vector>& old,
+                    const std::vector<int>& map,
+                    const std::vector<size_t>& dims) {
+    if (map.size() != dims.size()) {
+      throw std::invalid_argument(
+          "AugmentedLagrangianState::reindexed: need one index per dim.");
+    }
+    std::vector<gtsam::Vector> result;
+    for (size_t i = 0; i < map.size(); i++) {
+      const int j = map[i];
+      if (j >= 0 && static_cast<size_t>(j) < old.size() &&
+          static_cast<size_t>(old[j].size()) == dims[i]) {
+        result.push_back(old[j]);
+      } else {
+        result.push_back(gtsam::Vector::Zero(dims[i]));
+      }
+    }
+    return result;
+  };
+  AugmentedLagrangianState state;
+  state.mu = mu;
+  state.z = reindex(z, equality_map, equality_dims);
+  state.lambda = reindex(lambda, inequality_map, inequality_dims);
+  return state;
+}
+
+/** Start from the given state, or from mu = 1 and zero multipliers if it is
+ * null or empty. */
+static void InitialState(const AugmentedLagrangianState* state,
+                         const EqualityConstraints& constraints,
+                         const InequalityConstraints& inequality_constraints,
+                         double& mu, std::vector<gtsam::Vector>& z,
+                         std::vector<gtsam::Vector>& lambda) {
+  if (state == nullptr || state->empty()) {
+    mu = 1.0;
+    for (const auto& constraint : constraints) {
+      z.push_back(gtsam::Vector::Zero(constraint->dim()));
+    }
+    for (const auto& constraint : inequality_constraints) {
+      lambda.push_back(gtsam::Vector::Zero(constraint->dim()));
+    }
+    return;
+  }
+  bool consistent = state->z.size() == constraints.size() &&
+                    state->lambda.size() == inequality_constraints.size();
+  for (size_t i = 0; consistent && i < constraints.size(); i++) {
+    consistent = static_cast<size_t>(state->z[i].size()) ==
+                 constraints[i]->dim();
+  }
+  for (size_t i = 0; consistent && i < inequality_constraints.size(); i++) {
+    consistent = static_cast<size_t>(state->lambda[i].size()) ==
+                 inequality_constraints[i]->dim();
+  }
+  if (!consistent) {
+    throw std::invalid_argument(
+        "AugmentedLagrangianOptimizer: the warm-start state does not match "
+        "the constraints; see AugmentedLagrangianState::reindexed.");
+  }
+  mu = state->mu;
+  z = state->z;
+  lambda = state->lambda;
+}
+
+/// Write the final penalty parameter and multipliers, if state is given.
+static void StoreState(double mu, const std::vector<gtsam::Vector>& z,
+                       const std::vector<gtsam::Vector>& lambda,
+                       AugmentedLagrangianState* state) {
+  if (state == nullptr) return;
+  state->mu = mu;
+  state->z = z;
+  state->lambda = lambda;
+}
+
+/** Update penalty parameter and Lagrangian multipliers from the constraints
+ * evaluated before and after an unconstrained optimization. */
+void update_parameters(const ConstraintViolations& previous,
+                       const ConstraintViolations& current,
+                       const ConstraintViolations& previous_inequality,
+                       const ConstraintViolations& current_inequality,
+                       double& mu, std::vector<gtsam::Vector>& z,
+                       std::vector<gtsam::Vector>& lambda) {
+  // Update Lagrangian multipliers; those of inequalities stay nonnegative.
+  for (size_t i = 0; i < current.size(); i++) {
+    z[i] += mu * current[i].violation;
+  }
+  for (size_t i = 0; i < current_inequality.size(); i++) {
+    lambda[i] = (lambda[i] - mu * current_inequality[i].violation).cwiseMax(0);
   }
 
   // Update penalty parameter.
+  const double previous_error =
+      previous.squaredNorm() + previous_inequality.squaredNorm();
+  const double current_error =
+      current.squaredNorm() + current_inequality.squaredNorm();
   if (sqrt(current_error) >= 0.25 * sqrt(previous_error)) {
     mu *= 2;
   }
 }
 
+/** Report an outer iteration to the anytime callback and keep the best
+ * iterate; return true if the optimizer should stop. */
+static bool AnytimeStop(const AnytimeParameters& anytime,
+                        const Deadline& deadline, size_t iteration,
+                        const gtsam::NonlinearFactorGraph& graph,
+                        const ConstraintViolations& violations,
+                        const ConstraintViolations& inequality_violations,
+                        const gtsam::Values& values, BestIterate* best) {
+  const double violation = sqrt(violations.squaredNorm() +
+                                inequality_violations.squaredNorm());
+  const bool feasible =
+      violations.feasible() && inequality_violations.feasible();
+  const double cost = graph.error(values);
+  best->update(values, cost, violation, feasible);
+
+  bool stop = deadline.expired();
+  if (anytime.callback) {
+    stop = !anytime.callback(
+               {iteration, deadline.elapsed(), cost, violation, &values}) ||
+           stop;
+  }
+  return stop;
+}
+
 gtsam::Values AugmentedLagrangianOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
     const EqualityConstraints& constraints, const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
-  gtsam::Values values = initial_values;
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  intermediate_result, nullptr);
+}
 
-  // Set initial values for penalty parameter and Lagrangian multipliers.
-  double mu = 1.0;               // penalty parameter
-  std::vector<gtsam::Vector> z;  // Lagrangian multiplier
-  for (const auto& constraint : constraints) {
-    z.push_back(gtsam::Vector::Zero(constraint->dim()));
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& unscaled_constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result,
+    AugmentedLagrangianState* state) const {
+  if (p_.in_place_updates && inequality_constraints.empty()) {
+    return optimizeInPlace(graph, unscaled_constraints, initial_values,
+                           intermediate_result, state);
   }
+  const EqualityConstraints constraints =
+      ScaleConstraints(unscaled_constraints, initial_values, p_.scaling);
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      ScaleVariables(p_.lm_parameters, p_.scaling);
+  gtsam::Values values =
+      RestoreFeasibility(constraints, inequality_constraints, initial_values,
+                         p_.restoration, intermediate_result);
+
+  // Set initial values for penalty parameter and Lagrangian multipliers.
+  double mu;                          // penalty parameter
+  std::vector<gtsam::Vector> z;       // Lagrangian multiplier
+  std::vector<gtsam::Vector> lambda;  // inequality multiplier, nonnegative
+  InitialState(state, constraints, inequality_constraints, mu, z, lambda);
+
+  const Deadline deadline(p_.anytime.time_budget);
+  BestIterate best;
+  const size_t threads = p_.evaluation_threads;
+  ConstraintViolations previous(constraints, values, threads);
+  ConstraintViolations previous_inequality(inequality_constraints, values,
+                                           threads);
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
@@ -70,17 +202,34 @@ gtsam::Values AugmentedLagrangianOptimizer::optimize(
       gtsam::Vector bias = z[constraint_index] / mu;
       merit_graph.add(constraint->createFactor(mu, bias));
     }
+    for (size_t constraint_index = 0;
+         constraint_index < inequality_constraints.size();
+         constraint_index++) {
+      auto constraint = inequality_constraints.at(constraint_index);
+      gtsam::Vector bias = lambda[constraint_index] / mu;
+      merit_graph.add(constraint->createFactor(mu, bias));
+    }
 
-    // Run LM optimization.
+    // Run LM optimization, within the remaining time budget if any.
     gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
-    auto result = optimizer.optimize();
+                                                 lm_parameters);
+    AnytimeParameters inner;
+    inner.time_budget = deadline.remaining();
+    auto result = inner.active()
+                      ? OptimizeAnytime(optimizer, lm_parameters, inner)
+                      : optimizer.optimize();
 
-    // Update parameters.
-    update_parameters(constraints, values, result, mu, z);
+    // Update parameters, evaluating the constraints once at the result.
+    ConstraintViolations violations(constraints, result, threads);
+    ConstraintViolations inequality_violations(inequality_constraints, result,
+                                               threads);
+    update_parameters(previous, violations, previous_inequality,
+                      inequality_violations, mu, z, lambda);
 
     // Update values.
     values = result;
+    previous = std::move(violations);
+    previous_inequality = std::move(inequality_violations);
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
@@ -88,7 +237,93 @@ gtsam::Values AugmentedLagrangianOptimizer::optimize(
       intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
       intermediate_result->mu_values.push_back(mu);
     }
+
+    if (p_.anytime.active() &&
+        AnytimeStop(p_.anytime, deadline, i + 1, graph, previous,
+                    previous_inequality, values, &best)) {
+      StoreState(mu, z, lambda, state);
+      return best.values();
+    }
+  }
+  StoreState(mu, z, lambda, state);
+  return values;
+}
+
+gtsam::Values AugmentedLagrangianOptimizer::optimizeInPlace(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& unscaled_constraints,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result,
+    AugmentedLagrangianState* state) const {
+  const EqualityConstraints constraints =
+      ScaleConstraints(unscaled_constraints, initial_values, p_.scaling);
+  gtsam::Values values =
+      RestoreFeasibility(constraints, InequalityConstraints(), initial_values,
+                         p_.restoration, intermediate_result);
+
+  // Set initial values for penalty parameter and Lagrangian multipliers.
+  double mu;                     // penalty parameter
+  std::vector<gtsam::Vector> z;  // Lagrangian multiplier
+  std::vector<gtsam::Vector> lambda;
+  InitialState(state, constraints, InequalityConstraints(), mu, z, lambda);
+
+  // Create the merit graph once, with penalty factors updated in place.
+  gtsam::NonlinearFactorGraph merit_graph = graph;
+  std::vector<gtsam::MutableBiasedFactor::shared_ptr> penalty_factors;
+  for (const auto& constraint : constraints) {
+    auto factor = std::make_shared<gtsam::MutableBiasedFactor>(
+        constraint->createFactor(1.0), mu);
+    penalty_factors.push_back(factor);
+    merit_graph.add(factor);
+  }
+  gtsam::MutableLMOptimizer optimizer(
+      merit_graph, ScaleVariables(p_.lm_parameters, p_.scaling));
+  const Deadline deadline(p_.anytime.time_budget);
+  BestIterate best;
+  const size_t threads = p_.evaluation_threads;
+  ConstraintViolations previous(constraints, values, threads);
+
+  for (int i = 0; i < p_.num_iterations; i++) {
+    // Update the penalty terms of the merit function.
+    for (size_t constraint_index = 0; constraint_index < constraints.size();
+         constraint_index++) {
+      auto& factor = penalty_factors[constraint_index];
+      factor->setMu(mu);
+      factor->setBias(z[constraint_index] / mu);
+    }
+
+    // Run LM optimization, within the remaining time budget if any.
+    optimizer.setValues(values);
+    AnytimeParameters inner;
+    inner.time_budget = deadline.remaining();
+    auto result = inner.active()
+                      ? OptimizeAnytime(optimizer, optimizer.params(), inner)
+                      : optimizer.optimize();
+
+    // Update parameters, evaluating the constraints once at the result.
+    ConstraintViolations violations(constraints, result, threads);
+    update_parameters(previous, violations, ConstraintViolations(),
+                      ConstraintViolations(), mu, z, lambda);
+
+    // Update values.
+    values = result;
+    previous = std::move(violations);
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      intermediate_result->intermediate_values.push_back(values);
+      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->mu_values.push_back(mu);
+    }
+
+    if (p_.anytime.active() &&
+        AnytimeStop(p_.anytime, deadline, i + 1, graph, previous,
+                    ConstraintViolations(), values, &best)) {
+      StoreState(mu, z, lambda, state);
+      return best.values();
+    }
   }
+  StoreState(mu, z, lambda, state);
   return values;
 }
 
@@ -14,6 +14,13 @@
 #pragma once
 
 #include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -23,6 +30,12 @@ struct AugmentedLagrangianParameters
   using Base = ConstrainedOptimizationParameters;
   size_t num_iterations;
 
+  /// Create the penalty factors once and update their penalty parameter and
+  /// bias in place each outer iteration, instead of rebuilding the merit
+  /// graph. The merit graph then keeps its structure, and one
+  /// MutableLMOptimizer is reused across outer iterations.
+  bool in_place_updates = false;
+
   AugmentedLagrangianParameters()
       : Base(gtsam::LevenbergMarquardtParams()), num_iterations(12) {}
 
@@ -32,7 +45,83 @@ struct AugmentedLagrangianParameters
       : Base(_lm_parameters), num_iterations(_num_iterations) {}
 };
 
-/// Augmented Lagrangian method only considering equality constraints.
+/**
+ * Penalty parameter and Lagrangian multipliers of an Augmented Lagrangian
+ * solve, to warm-start the next solve of a similar problem, e.g. the next tick
+ * of a receding-horizon controller. Multipliers are those of the scaled
+ * constraints, one vector per constraint, in the order of the constraints.
+ * A default-constructed state is empty, and gives a cold start.
+ */
+struct AugmentedLagrangianState {
+  double mu = 1.0;                    ///< penalty parameter
+  std::vector<gtsam::Vector> z;       ///< equality multipliers
+  std::vector<gtsam::Vector> lambda;  ///< inequality multipliers, nonnegative
+
+  /// True if no solve has written the state yet.
+  bool empty() const { return z.empty() && lambda.empty(); }
+
+  /**
+   * Re-index the multipliers for a new problem, e.g. a shifted horizon.
+   * @param equality_map index of the old equality constraint of each new one,
+   * or -1 to start its multiplier at zero
+   * @param equality_dims dimension of each new equality constraint
+   * @param inequality_map, inequality_dims the same for inequalities
+   */
+  AugmentedLagrangianState reindexed(
+      const std::vector<int>& equality_map,
+      const std::vector<size_t>& equality_dims,
+      const std::vector<int>& inequality_map = {},
+      const std::vector<size_t>& inequality_dims = {}) const;
+};
+
+/**
+ * Index map from new to old constraints for AugmentedLagrangianState::
+ * reindexed: a new constraint matches the first unmatched old constraint of
+ * the same dimension whose keys, mapped with key_map, are its keys. E.g., for
+ * a horizon shifted by one step, key_map maps the keys of step k to step k-1.
+ * New constraints without a match, or without keys, map to -1.
+ */
+template <class CONSTRAINTS>
+std::vector<int> MatchConstraints(
+    const CONSTRAINTS& old_constraints, const CONSTRAINTS& new_constraints,
+    const std::function<gtsam::Key(gtsam::Key)>& key_map) {
+  using Signature = std::pair<std::set<gtsam::Key>, size_t>;
+  std::multimap<Signature, int> old_indices;
+  for (size_t i = 0; i < old_constraints.size(); i++) {
+    std::set<gtsam::Key> keys;
+    for (gtsam::Key key : old_constraints[i]->keys()) keys.insert(key_map(key));
+    if (keys.empty()) continue;
+    old_indices.emplace(Signature(keys, old_constraints[i]->dim()), i);
+  }
+  std::vector<int> map;
+  for (const auto& constraint : new_constraints) {
+    auto it =
+        old_indices.find(Signature(constraint->keys(), constraint->dim()));
+    if (it == old_indices.end()) {
+      map.push_back(-1);
+    } else {
+      map.push_back(it->second);
+      old_indices.erase(it);
+    }
+  }
+  return map;
+}
+
+/// Dimensions of the constraints, for AugmentedLagrangianState::reindexed.
+template <class CONSTRAINTS>
+std::vector<size_t> ConstraintDims(const CONSTRAINTS& constraints) {
+  std::vector<size_t> dims;
+  for (const auto& constraint : constraints) dims.push_back(constraint->dim());
+  return dims;
+}
+
+/**
+ * Augmented Lagrangian method for equality constraints h(x) = 0 and,
+ * optionally, inequality constraints g(x) >= 0. Inequalities use the
+ * shifted-penalty form mu/2 ||max(0, lambda/mu - g(x))||^2 with multiplier
+ * update lambda <- max(0, lambda - mu g(x)), so inactive constraints add no
+ * stiffness, unlike soft limit penalties.
+ */
 class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
  protected:
   const AugmentedLagrangianParameters p_;
@@ -51,6 +140,30 @@ class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
       const EqualityConstraints& constraints,
       const gtsam::Values& initial_values,
       ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /**
+   * Run optimization with equality and inequality constraints. If state is
+   * given and not empty, the penalty parameter and multipliers start from it
+   * rather than from 1 and zero; on return it holds the final ones. Without
+   * inequality constraints, in_place_updates is honored as for the equality
+   * only optimize.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequality_constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr,
+      AugmentedLagrangianState* state = nullptr) const;
+
+ protected:
+  /// Run optimization, updating the penalty factors in place.
+  gtsam::Values optimizeInPlace(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result,
+      AugmentedLagrangianState* state) const;
 };
 
 }  // namespace gtdynamics
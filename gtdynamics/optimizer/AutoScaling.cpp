@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AutoScaling.cpp
+ * @brief Automatic scaling of constraints and variables for conditioning.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/AutoScaling.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ScaledEqualityConstraint::ScaledEqualityConstraint(
+    const EqualityConstraint::shared_ptr& constraint,
+    const gtsam::Vector& weights)
+    : constraint_(constraint), weights_(weights) {
+  if (static_cast<size_t>(weights.size()) != constraint->dim()) {
+    throw std::invalid_argument(
+        "ScaledEqualityConstraint: one weight per row is needed");
+  }
+}
+
+/* ************************************************************************* */
+gtsam::NoiseModelFactor::shared_ptr ScaledEqualityConstraint::createFactor(
+    const double mu, std::optional<gtsam::Vector> bias) const {
+  auto factor = constraint_->createFactor(mu, bias);
+  const gtsam::Vector sigmas =
+      factor->noiseModel()->sigmas().cwiseQuotient(weights_);
+  return factor->cloneWithNewNoiseModel(
+      gtsam::noiseModel::Diagonal::Sigmas(sigmas));
+}
+
+/* ************************************************************************* */
+EqualityConstraints ScaleConstraints(const EqualityConstraints& constraints,
+                                     const gtsam::Values& values,
+                                     const AutoScalingParameters& parameters) {
+  if (!parameters.enabled) return constraints;
+  EqualityConstraints scaled;
+  for (const auto& constraint : constraints) {
+    const auto linear = std::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        constraint->createFactor(1.0)->linearize(values));
+    gtsam::Vector weights = gtsam::Vector::Ones(constraint->dim());
+    if (linear) {
+      const gtsam::Matrix A = linear->jacobian().first;
+      for (Eigen::Index i = 0; i < A.rows(); i++) {
+        const double norm = A.row(i).norm();
+        if (norm > 0) {
+          weights(i) = std::clamp(1.0 / norm, parameters.min_weight,
+                                  parameters.max_weight);
+        }
+      }
+    }
+    scaled.emplace_shared<ScaledEqualityConstraint>(constraint, weights);
+  }
+  return scaled;
+}
+
+/* ************************************************************************* */
+gtsam::LevenbergMarquardtParams ScaleVariables(
+    const gtsam::LevenbergMarquardtParams& lm_parameters,
+    const AutoScalingParameters& parameters) {
+  gtsam::LevenbergMarquardtParams scaled = lm_parameters;
+  if (parameters.enabled) scaled.setDiagonalDamping(true);
+  return scaled;
+}
+
+}  // namespace gtdynamics
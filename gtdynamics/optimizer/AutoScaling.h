@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AutoScaling.h
+ * @brief Automatic scaling of constraints and variables for conditioning.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/// Options of automatic scaling, see ScaleConstraints and ScaleVariables.
+struct AutoScalingParameters {
+  /// Scale constraints and variables, instead of using the tolerances as is.
+  bool enabled = false;
+
+  /// Range of the weight of each constraint row.
+  double min_weight = 1e-6, max_weight = 1e6;
+};
+
+/**
+ * Equality constraint whose merit factors are weighted per row, e.g. to
+ * equilibrate constraints with very different tolerances. Feasibility and
+ * violations are those of the wrapped constraint.
+ */
+class ScaledEqualityConstraint : public EqualityConstraint {
+ protected:
+  EqualityConstraint::shared_ptr constraint_;
+  gtsam::Vector weights_;
+
+ public:
+  /**
+   * Constructor.
+   * @param constraint the wrapped constraint
+   * @param weights    weight of each row of its merit factors
+   */
+  ScaledEqualityConstraint(const EqualityConstraint::shared_ptr& constraint,
+                           const gtsam::Vector& weights);
+
+  /// Merit factor of the wrapped constraint, with its sigmas / weights.
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu, std::optional<gtsam::Vector> bias = {}) const override;
+
+  bool feasible(const gtsam::Values& x) const override {
+    return constraint_->feasible(x);
+  }
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override {
+    return (*constraint_)(x);
+  }
+
+  gtsam::Vector toleranceScaledViolation(
+      const gtsam::Values& x) const override {
+    return constraint_->toleranceScaledViolation(x);
+  }
+
+  ConstraintEvaluation evaluate(const gtsam::Values& x) const override {
+    return constraint_->evaluate(x);
+  }
+
+  size_t dim() const override { return constraint_->dim(); }
+
+  std::set<gtsam::Key> keys() const override { return constraint_->keys(); }
+
+  /// The wrapped constraint.
+  const EqualityConstraint::shared_ptr& constraint() const {
+    return constraint_;
+  }
+
+  /// Weight of each row.
+  const gtsam::Vector& weights() const { return weights_; }
+};
+
+/**
+ * Weight the constraints so that, at the given values, each row of the
+ * Jacobian of their merit factors with mu = 1 has unit norm, within the
+ * range of weights. Rows with a zero Jacobian keep a unit weight. Returns
+ * the constraints unchanged if scaling is not enabled.
+ * @param constraints the constraints, e.g. with hand-tuned tolerances
+ * @param values where to linearize, e.g. the initial values
+ * @param parameters whether to scale, and the range of weights
+ */
+EqualityConstraints ScaleConstraints(const EqualityConstraints& constraints,
+                                     const gtsam::Values& values,
+                                     const AutoScalingParameters& parameters);
+
+/**
+ * Scale the variables of Levenberg-Marquardt: Gauss-Newton steps do not
+ * change under a diagonal scaling of the variables, but the damping does,
+ * so this damps each variable by the diagonal of the Hessian, i.e. the
+ * squared norm of its Jacobian columns at each iteration. Returns the
+ * parameters unchanged if scaling is not enabled.
+ */
+gtsam::LevenbergMarquardtParams ScaleVariables(
+    const gtsam::LevenbergMarquardtParams& lm_parameters,
+    const AutoScalingParameters& parameters);
+
+}  // namespace gtdynamics
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CoarseToFineOptimization.cpp
+ * @brief Trajectory optimization at increasing time resolutions.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/CoarseToFineOptimization.h>
+#include <gtdynamics/utils/WarmStartInitializer.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CoarseToFineResult CoarseToFineOptimize(
+    const Trajectory &trajectory, const TrajectoryGraphFunction &graph,
+    const TrajectoryValuesFunction &initial_values,
+    const gtsam::MutableLMParams &lm_params,
+    const CoarseToFineParameters &parameters) {
+  if (parameters.num_levels == 0 || parameters.factor < 1.0) {
+    throw std::invalid_argument(
+        "CoarseToFineOptimize: needs at least one level and a factor of at "
+        "least 1");
+  }
+
+  // Resolutions from the coarsest to the target, without repetitions.
+  std::vector<Trajectory> levels;
+  for (size_t l = parameters.num_levels; l-- > 0;) {
+    const Trajectory level =
+        l > 0 ? trajectory.coarsened(std::pow(parameters.factor, l))
+              : trajectory;
+    if (levels.empty() ||
+        level.phaseDurations() != levels.back().phaseDurations()) {
+      levels.push_back(level);
+    }
+  }
+
+  CoarseToFineResult result;
+  for (size_t l = 0; l < levels.size(); l++) {
+    const Trajectory &level = levels[l];
+    const bool target = l + 1 == levels.size();
+    gtsam::Values values = initial_values(level);
+    if (l > 0) {
+      const gtsam::Values upsampled =
+          InterpolateTrajectory(result.values, result.levels.back().phase_steps,
+                                level.phaseDurations());
+      for (gtsam::Key key : values.keys()) {
+        if (upsampled.exists(key)) values.update(key, upsampled.at(key));
+      }
+    }
+
+    gtsam::MutableLMParams params = lm_params;
+    if (!target) {
+      params.ordering.reset();
+      params.condensed = gtsam::Ordering();
+    }
+    gtsam::MutableLMOptimizer optimizer(graph(level), values, params);
+    result.values = optimizer.optimize();
+    result.levels.push_back(
+        {level.phaseDurations(), optimizer.error(), optimizer.iterations()});
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CoarseToFineOptimization.h
+ * @brief Trajectory optimization at increasing time resolutions.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Options of CoarseToFineOptimize.
+struct CoarseToFineParameters {
+  /// Number of time resolutions, including the target one.
+  size_t num_levels = 3;
+
+  /// Ratio of the numbers of time steps of successive resolutions.
+  double factor = 2.0;
+};
+
+/// How one resolution of CoarseToFineOptimize ended.
+struct ResolutionReport {
+  std::vector<int> phase_steps;  // number of steps of each phase
+  double error;                  // final error
+  size_t iterations;             // LM iterations run
+};
+
+/// Result of CoarseToFineOptimize.
+struct CoarseToFineResult {
+  gtsam::Values values;                  // solution at the target resolution
+  std::vector<ResolutionReport> levels;  // coarsest first
+};
+
+/// Factor graph of a trajectory at some time resolution.
+using TrajectoryGraphFunction =
+    std::function<gtsam::NonlinearFactorGraph(const Trajectory &)>;
+
+/// Initial values of a trajectory at some time resolution.
+using TrajectoryValuesFunction =
+    std::function<gtsam::Values(const Trajectory &)>;
+
+/**
+ * Optimize a trajectory first with `factor` times fewer steps per phase at
+ * each level, see Trajectory::coarsened. The solution of each resolution is
+ * interpolated to the next one, see InterpolateTrajectory, and replaces the
+ * initial values of the variables it has, so that long horizons start the
+ * target resolution close to a solution. Levels that coarsening leaves at
+ * the same steps as the previous level are skipped.
+ * @param trajectory the trajectory at the target resolution
+ * @param graph builds the factor graph of each resolution
+ * @param initial_values builds the initial values of each resolution, e.g.
+ * with Trajectory::multiPhaseInitialValues and a phase duration scaled by
+ * the ratio of the numbers of steps.
+ * @param lm_params parameters of each optimization; their ordering and
+ * condensed variables only apply to the target resolution.
+ * @param parameters levels and factor
+ * @return the solution, and how each resolution ended
+ */
+CoarseToFineResult CoarseToFineOptimize(
+    const Trajectory &trajectory, const TrajectoryGraphFunction &graph,
+    const TrajectoryValuesFunction &initial_values,
+    const gtsam::MutableLMParams &lm_params = gtsam::MutableLMParams(),
+    const CoarseToFineParameters &parameters = CoarseToFineParameters());
+
+}  // namespace gtdynamics
@@ -13,17 +13,36 @@
 
 #pragma once
 
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtdynamics/optimizer/AutoScaling.h>
+#include <gtdynamics/optimizer/ConstraintViolations.h>
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/FeasibilityRestoration.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <map>
+#include <string>
+
 namespace gtdynamics {
 
 /// Constrained optimization parameters shared between all solvers.
 struct ConstrainedOptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  /// Time budget and per-iteration callback. When the budget expires or the
+  /// callback stops the optimizer, it returns the best feasible iterate.
+  AnytimeParameters anytime;
+  /// Scale the constraints and the LM damping from the initial values,
+  /// instead of relying on hand-tuned tolerances.
+  AutoScalingParameters scaling;
+  /// Threads evaluating the constraints at each iterate, see
+  /// ConstraintViolations; they must then be safe to evaluate concurrently.
+  size_t evaluation_threads = 1;
+  /// Minimize the constraint violation alone before the first outer
+  /// iteration, see RestoreFeasibility.
+  FeasibilityRestorationParameters restoration;
 
   /// Constructor.
   ConstrainedOptimizationParameters() {}
@@ -40,6 +59,24 @@ struct ConstrainedOptResult {
       intermediate_values;        // values after each inner loop
   std::vector<int> num_iters;     // number of LM iterations for each inner loop
   std::vector<double> mu_values;  // penalty parameter for each inner loop
+  std::vector<double> times;      // wall time in seconds of each inner loop
+  std::map<std::string, double>
+      phase_times;  // accumulated wall time in seconds per phase, if reported
+  std::vector<std::map<std::string, double>>
+      iteration_phase_times;  // wall time per phase of each iteration, if
+                              // reported
+  std::map<std::string, size_t>
+      counts;  // accumulated number of events, if reported
+
+  /// Add time to a phase, e.g. "linearize", "solve" or "retract".
+  void addPhaseTime(const std::string& phase, double seconds) {
+    phase_times[phase] += seconds;
+  }
+
+  /// Count events, e.g. "retractions" or "skipped_retractions".
+  void addCount(const std::string& event, size_t count) {
+    counts[event] += count;
+  }
 };
 
 /// Base class for constrained optimizer.
@@ -117,11 +154,7 @@ struct EqConsOptProblem {
 
   /// Evaluate the constraint violation (as L2 norm).
   double evaluateConstraintViolationL2Norm(const gtsam::Values& values) const {
-    double violation = 0;
-    for (const auto& constraint: constraints_) {
-      violation += pow(constraint->toleranceScaledViolation(values).norm(), 2);
-    }
-    return sqrt(violation);
+    return ConstraintViolations(constraints_, values).norm();
   }
 
   /// Return a graph of merit factors of constraints.
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstraintViolations.cpp
+ * @brief Batched, parallel evaluation of all constraints at some values.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gtdynamics {
+
+namespace {
+// Evaluate each constraint, on contiguous blocks of constraints in parallel.
+// Exceptions are rethrown on the calling thread.
+template <class CONSTRAINTS>
+std::vector<ConstraintEvaluation> Evaluate(const CONSTRAINTS& constraints,
+                                           const gtsam::Values& values,
+                                           size_t num_threads) {
+  const size_t n = constraints.size();
+  std::vector<ConstraintEvaluation> evaluations(n);
+  num_threads = std::max<size_t>(1, std::min(num_threads, n / 2));
+  const size_t block_size = n > 0 ? (n + num_threads - 1) / num_threads : 1;
+  const size_t num_blocks = (n + block_size - 1) / block_size;
+  auto evaluateBlock = [&](size_t block) {
+    const size_t end = std::min((block + 1) * block_size, n);
+    for (size_t i = block * block_size; i < end; ++i) {
+      evaluations[i] = constraints[i]->evaluate(values);
+    }
+  };
+  ExecutionContext execution = ExecutionContext::Threads(num_threads);
+  execution.deterministic = true;
+  execution.parallelFor(num_blocks, evaluateBlock);
+  return evaluations;
+}
+}  // namespace
+
+/* ************************************************************************* */
+ConstraintViolations::ConstraintViolations(
+    const EqualityConstraints& constraints, const gtsam::Values& values,
+    size_t num_threads)
+    : evaluations_(Evaluate(constraints, values, num_threads)) {}
+
+/* ************************************************************************* */
+ConstraintViolations::ConstraintViolations(
+    const InequalityConstraints& constraints, const gtsam::Values& values,
+    size_t num_threads)
+    : evaluations_(Evaluate(constraints, values, num_threads)) {}
+
+/* ************************************************************************* */
+double ConstraintViolations::squaredNorm() const {
+  double sum = 0;
+  for (const auto& evaluation : evaluations_) {
+    sum += evaluation.scaled.squaredNorm();
+  }
+  return sum;
+}
+
+/* ************************************************************************* */
+double ConstraintViolations::norm() const { return std::sqrt(squaredNorm()); }
+
+/* ************************************************************************* */
+double ConstraintViolations::l1Norm() const {
+  double sum = 0;
+  for (const auto& evaluation : evaluations_) {
+    sum += evaluation.scaled.lpNorm<1>();
+  }
+  return sum;
+}
+
+/* ************************************************************************* */
+bool ConstraintViolations::feasible() const {
+  return std::all_of(evaluations_.begin(), evaluations_.end(),
+                     [](const ConstraintEvaluation& evaluation) {
+                       return evaluation.feasible;
+                     });
+}
+
+}  // namespace gtdynamics
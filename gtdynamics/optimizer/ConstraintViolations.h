@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstraintViolations.h
+ * @brief Batched, parallel evaluation of all constraints at some values.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * All constraints evaluated once at some values, to be shared by the
+ * feasibility checks, multiplier updates and logging of an iterate instead
+ * of evaluating each constraint again for each of them.
+ */
+class ConstraintViolations {
+ private:
+  std::vector<ConstraintEvaluation> evaluations_;
+
+ public:
+  /// No constraints.
+  ConstraintViolations() {}
+
+  /**
+   * Evaluate equality constraints, see EqualityConstraint::evaluate.
+   * @param num_threads threads evaluating contiguous blocks of constraints;
+   * the constraints must then be safe to evaluate concurrently.
+   */
+  ConstraintViolations(const EqualityConstraints& constraints,
+                       const gtsam::Values& values, size_t num_threads = 1);
+
+  /// Evaluate inequality constraints, see InequalityConstraint::evaluate.
+  ConstraintViolations(const InequalityConstraints& constraints,
+                       const gtsam::Values& values, size_t num_threads = 1);
+
+  /// Number of constraints.
+  size_t size() const { return evaluations_.size(); }
+
+  /// Evaluation of constraint i.
+  const ConstraintEvaluation& operator[](size_t i) const {
+    return evaluations_[i];
+  }
+
+  /// Sum of the squared tolerance-scaled violations.
+  double squaredNorm() const;
+
+  /// L2 norm of all tolerance-scaled violations.
+  double norm() const;
+
+  /// Sum of the L1 norms of the tolerance-scaled violations.
+  double l1Norm() const;
+
+  /// Whether all constraints are feasible.
+  bool feasible() const;
+};
+
+}  // namespace gtdynamics
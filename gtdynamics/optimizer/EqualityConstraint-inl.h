@@ -58,6 +58,12 @@ gtsam::Vector VectorExpressionEquality<P>::toleranceScaledViolation(
   return scaled_violation;
 }
 
+template <int P>
+ConstraintEvaluation VectorExpressionEquality<P>::evaluate(
+    const gtsam::Values& x) const {
+  return ConstraintEvaluation::Equality(expression_.value(x), tolerance_);
+}
+
 template <int P>
 size_t VectorExpressionEquality<P>::dim() const {
   return P;
@@ -44,6 +44,13 @@ gtsam::Vector DoubleExpressionEquality::toleranceScaledViolation(
   return (gtsam::Vector(1) << result / tolerance_).finished();
 }
 
+ConstraintEvaluation DoubleExpressionEquality::evaluate(
+    const gtsam::Values& x) const {
+  const double result = expression_.value(x);
+  return {gtsam::Vector1(result), gtsam::Vector1(result / tolerance_),
+          std::abs(result) <= tolerance_};
+}
+
 /* ************************************************************************* */
 gtsam::NoiseModelFactor::shared_ptr FactorZeroErrorConstraint::createFactor(
     const double mu, std::optional<gtsam::Vector> bias) const {
@@ -81,6 +88,13 @@ gtsam::Vector FactorZeroErrorConstraint::toleranceScaledViolation(
   return violation;
 }
 
+/* ************************************************************************* */
+ConstraintEvaluation FactorZeroErrorConstraint::evaluate(
+    const gtsam::Values& x) const {
+  return ConstraintEvaluation::Equality(factor_->unwhitenedError(x),
+                                        tolerance_);
+}
+
 /* ************************************************************************* */
 EqualityConstraints ConstraintsFromGraph(
     const gtsam::NonlinearFactorGraph& graph) {
@@ -93,6 +107,21 @@ EqualityConstraints ConstraintsFromGraph(
   return constraints;
 }
 
+/* ************************************************************************* */
+std::set<gtsam::Key> EqualityConstraint::keys() const {
+  const auto factor = createFactor(1.0);
+  return std::set<gtsam::Key>(factor->begin(), factor->end());
+}
+
+/* ************************************************************************* */
+gtsam::KeySet EqualityConstraints::keys() const {
+  gtsam::KeySet keys;
+  for (const auto& constraint : *this) {
+    for (const gtsam::Key& key : constraint->keys()) keys.insert(key);
+  }
+  return keys;
+}
+
 /* ************************************************************************* */
 size_t EqualityConstraints::dim() const {
   size_t dimension = 0;
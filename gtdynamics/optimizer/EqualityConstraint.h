@@ -19,6 +19,20 @@
 
 namespace gtdynamics {
 
+/// A constraint evaluated at some values, see EqualityConstraint::evaluate.
+struct ConstraintEvaluation {
+  gtsam::Vector violation;  ///< g(x)
+  gtsam::Vector scaled;     ///< the tolerance-scaled violation
+  bool feasible;            ///< whether g(x) is within tolerance
+
+  /// Evaluation of an equality constraint from g(x) and its tolerance.
+  static ConstraintEvaluation Equality(const gtsam::Vector& violation,
+                                       const gtsam::Vector& tolerance) {
+    return {violation, violation.cwiseQuotient(tolerance),
+            (violation.cwiseAbs().array() <= tolerance.array()).all()};
+  }
+};
+
 /**
  * Equality constraint base class.
  */
@@ -63,11 +77,21 @@ class EqualityConstraint {
   virtual gtsam::Vector toleranceScaledViolation(
       const gtsam::Values& x) const = 0;
 
+  /**
+   * @brief Evaluate g(x), its tolerance-scaled violation and feasibility at
+   * once. The default calls the three methods; constraints override it to
+   * evaluate g(x) only once.
+   */
+  virtual ConstraintEvaluation evaluate(const gtsam::Values& x) const {
+    return {(*this)(x), toleranceScaledViolation(x), feasible(x)};
+  }
+
   /** @brief return the dimension of the constraint. */
   virtual size_t dim() const = 0;
 
-  /// Return keys of variables involved in the constraint.
-  virtual std::set<gtsam::Key> keys() const { return std::set<gtsam::Key>(); }
+  /// Return keys of variables involved in the constraint; the default takes
+  /// them from the merit factor.
+  virtual std::set<gtsam::Key> keys() const;
 };
 
 /** Equality constraint that force g(x) = 0, where g(x) is a scalar-valued
@@ -102,6 +126,9 @@ class DoubleExpressionEquality : public EqualityConstraint {
   /** Constraint violation scaled by tolerance, e.g. g(x)/tolerance. */
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  /** Evaluate g(x) once for the violation and feasibility. */
+  ConstraintEvaluation evaluate(const gtsam::Values& x) const override;
+
   /** Return the dimension of the constraint. */
   size_t dim() const override { return 1; }
 
@@ -143,6 +170,9 @@ class VectorExpressionEquality : public EqualityConstraint {
   /** Constraint violation scaled by tolerance, e.g. g(x)/tolerance. */
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  /** Evaluate g(x) once for the violation and feasibility. */
+  ConstraintEvaluation evaluate(const gtsam::Values& x) const override;
+
   /** Return the dimension of the constraint. */
   size_t dim() const override;
 
@@ -183,8 +213,16 @@ class FactorZeroErrorConstraint : public EqualityConstraint {
   /** Constraint violation scaled by tolerance, e.g. g(x)/tolerance. */
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  /** Evaluate g(x) once for the violation and feasibility. */
+  ConstraintEvaluation evaluate(const gtsam::Values& x) const override;
+
   /** Return the dimension of the constraint. */
   size_t dim() const override { return factor_->dim(); }
+
+  /// Return keys of the factor.
+  std::set<gtsam::Key> keys() const override {
+    return std::set<gtsam::Key>(factor_->begin(), factor_->end());
+  }
 };
 
 /// Container of EqualityConstraint.
@@ -214,6 +252,9 @@ class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
 
   /// Return the total dimension of constraints.
   size_t dim() const;
+
+  /// Return the keys of all constraints.
+  gtsam::KeySet keys() const;
 };
 
 /// Create FactorZeroErrorConstraintConstraints from the factors of a graph.
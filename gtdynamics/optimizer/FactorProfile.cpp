@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorProfile.cpp
+ * @brief Time spent linearizing and evaluating factors, by type of factor.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/types.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+FactorProfile::FactorProfile(const gtsam::NonlinearFactorGraph &graph) {
+  std::map<std::string, int> index;
+  type_of_factor_.assign(graph.size(), -1);
+  for (size_t i = 0; i < graph.size(); ++i) {
+    if (!graph[i]) continue;
+    const std::string category = Category(*graph[i]);
+    auto it = index.emplace(category, types_.size()).first;
+    if (it->second == static_cast<int>(types_.size())) {
+      types_.emplace_back();
+      types_.back().category = category;
+    }
+    type_of_factor_[i] = it->second;
+    types_[it->second].num_factors += 1;
+  }
+}
+
+/* ************************************************************************* */
+std::string FactorProfile::Category(const gtsam::NonlinearFactor &factor) {
+  std::string category = gtsam::demangle(typeid(factor).name()) + "(";
+  for (size_t k = 0; k < factor.size(); ++k) {
+    if (k > 0) category += ",";
+    category += DynamicsSymbol(factor.keys()[k]).label();
+  }
+  return category + ")";
+}
+
+/* ************************************************************************* */
+static void CheckSize(const std::vector<double> &seconds, size_t num_factors) {
+  if (seconds.size() != num_factors) {
+    throw std::invalid_argument("FactorProfile: expected " +
+                                std::to_string(num_factors) + " times, got " +
+                                std::to_string(seconds.size()));
+  }
+}
+
+/* ************************************************************************* */
+void FactorProfile::addLinearizeTimes(const std::vector<double> &seconds) {
+  CheckSize(seconds, type_of_factor_.size());
+  for (size_t i = 0; i < seconds.size(); ++i) {
+    if (type_of_factor_[i] < 0) continue;
+    FactorTypeTimes &type = types_[type_of_factor_[i]];
+    type.linearize_calls += 1;
+    type.linearize_seconds += seconds[i];
+  }
+}
+
+/* ************************************************************************* */
+void FactorProfile::addErrorTimes(const std::vector<double> &seconds) {
+  CheckSize(seconds, type_of_factor_.size());
+  for (size_t i = 0; i < seconds.size(); ++i) {
+    if (type_of_factor_[i] < 0) continue;
+    FactorTypeTimes &type = types_[type_of_factor_[i]];
+    type.error_calls += 1;
+    type.error_seconds += seconds[i];
+  }
+}
+
+/* ************************************************************************* */
+std::vector<FactorTypeTimes> FactorProfile::sorted() const {
+  std::vector<FactorTypeTimes> result = types_;
+  std::stable_sort(result.begin(), result.end(),
+                   [](const FactorTypeTimes &a, const FactorTypeTimes &b) {
+                     return a.totalSeconds() > b.totalSeconds();
+                   });
+  return result;
+}
+
+/* ************************************************************************* */
+void FactorProfile::print(std::ostream &os) const {
+  const std::ios::fmtflags flags = os.flags();
+  os << std::setw(8) << "factors" << std::setw(12) << "lin [s]"
+     << std::setw(12) << "lin avg" << std::setw(12) << "err [s]"
+     << std::setw(12) << "err avg"
+     << "  category\n";
+  os << std::scientific << std::setprecision(3);
+  for (const FactorTypeTimes &type : sorted()) {
+    os << std::setw(8) << type.num_factors << std::setw(12)
+       << type.linearize_seconds << std::setw(12) << type.averageLinearize()
+       << std::setw(12) << type.error_seconds << std::setw(12)
+       << type.averageError() << "  " << type.category << "\n";
+  }
+  os.flags(flags);
+}
+
+/* ************************************************************************* */
+void FactorProfile::writeJson(std::ostream &os) const {
+  os << "[";
+  bool first = true;
+  for (const FactorTypeTimes &type : sorted()) {
+    std::string category;
+    for (char c : type.category) {
+      if (c == '"' || c == '\\') category += '\\';
+      category += c;
+    }
+    os << (first ? "\n" : ",\n") << "  {\"category\": \"" << category
+       << "\", \"num_factors\": " << type.num_factors
+       << ", \"linearize_calls\": " << type.linearize_calls
+       << ", \"linearize_seconds\": " << type.linearize_seconds
+       << ", \"error_calls\": " << type.error_calls
+       << ", \"error_seconds\": " << type.error_seconds << "}";
+    first = false;
+  }
+  os << "\n]\n";
+}
+
+/* ************************************************************************* */
+FactorProfile ProfileFactors(const gtsam::NonlinearFactorGraph &graph,
+                             const gtsam::Values &values,
+                             size_t repetitions) {
+  FactorProfile profile(graph);
+  std::vector<double> linearize_seconds(graph.size(), 0.0);
+  std::vector<double> error_seconds(graph.size(), 0.0);
+  for (size_t r = 0; r < repetitions; ++r) {
+    for (size_t i = 0; i < graph.size(); ++i) {
+      if (!graph[i]) continue;
+      const Deadline linearize_timer;
+      graph[i]->linearize(values);
+      linearize_seconds[i] = linearize_timer.elapsed();
+      const Deadline error_timer;
+      graph[i]->error(values);
+      error_seconds[i] = error_timer.elapsed();
+    }
+    profile.addLinearizeTimes(linearize_seconds);
+    profile.addErrorTimes(error_seconds);
+  }
+  return profile;
+}
+
+}  // namespace gtdynamics
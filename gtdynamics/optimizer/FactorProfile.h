@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorProfile.h
+ * @brief Time spent linearizing and evaluating factors, by type of factor.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Number and time of the linearize and error calls of one type of factor.
+struct FactorTypeTimes {
+  std::string category;
+  size_t num_factors = 0;
+  size_t linearize_calls = 0;
+  double linearize_seconds = 0.0;
+  size_t error_calls = 0;
+  double error_seconds = 0.0;
+
+  /// Average seconds per call, 0 without calls.
+  double averageLinearize() const {
+    return linearize_calls ? linearize_seconds / linearize_calls : 0.0;
+  }
+  double averageError() const {
+    return error_calls ? error_seconds / error_calls : 0.0;
+  }
+
+  /// Total seconds of both calls.
+  double totalSeconds() const { return linearize_seconds + error_seconds; }
+};
+
+/**
+ * Profile of the factors of a graph, by category. Times are added for all
+ * factors at once, as a vector indexed like the graph, so that threads can
+ * each time their own factors and the profile is updated once per call.
+ */
+class FactorProfile {
+ public:
+  FactorProfile() = default;
+
+  /// Profile with the categories of the factors of a graph, and no times.
+  explicit FactorProfile(const gtsam::NonlinearFactorGraph &graph);
+
+  /**
+   * Category of a factor: its class and the labels of its variables, e.g.
+   * "gtsam::ExpressionFactor<...>(T,F,F)", so that the expression factors of
+   * different families, such as wrench and contact factors, are told apart.
+   */
+  static std::string Category(const gtsam::NonlinearFactor &factor);
+
+  /// Number of factors of the profiled graph, including null factors.
+  size_t numFactors() const { return type_of_factor_.size(); }
+
+  /// Add one linearize time per factor of the graph; null factors are ignored.
+  void addLinearizeTimes(const std::vector<double> &seconds);
+
+  /// Add one error time per factor of the graph; null factors are ignored.
+  void addErrorTimes(const std::vector<double> &seconds);
+
+  /// All categories, in order of first appearance in the graph.
+  const std::vector<FactorTypeTimes> &types() const { return types_; }
+
+  /// Categories by decreasing total time.
+  std::vector<FactorTypeTimes> sorted() const;
+
+  /// Print a table of the categories by decreasing total time.
+  void print(std::ostream &os = std::cout) const;
+
+  /// Write the categories by decreasing total time as a JSON list.
+  void writeJson(std::ostream &os) const;
+
+ private:
+  /// Index in types_ of each factor, -1 for null factors.
+  std::vector<int> type_of_factor_;
+  std::vector<FactorTypeTimes> types_;
+};
+
+/**
+ * Time linearize and error of every factor of a graph at the given values.
+ * @param graph        the factors, e.g. from DynamicsGraph::trajectoryFG
+ * @param values       values of all variables of the graph
+ * @param repetitions  calls of each function per factor, for stable times
+ */
+FactorProfile ProfileFactors(const gtsam::NonlinearFactorGraph &graph,
+                             const gtsam::Values &values,
+                             size_t repetitions = 1);
+
+}  // namespace gtdynamics
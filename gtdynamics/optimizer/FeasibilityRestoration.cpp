@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FeasibilityRestoration.cpp
+ * @brief Move the initial values of a constrained problem towards feasibility.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtdynamics/optimizer/FeasibilityRestoration.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <chrono>
+#include <cmath>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::Values RestoreFeasibility(
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& values,
+    const FeasibilityRestorationParameters& params,
+    ConstrainedOptResult* intermediate_result) {
+  if (!params.enabled) return values;
+  const double violation =
+      std::sqrt(ConstraintViolations(constraints, values).squaredNorm() +
+                ConstraintViolations(inequality_constraints, values)
+                    .squaredNorm());
+  if (violation <= params.violation_threshold) return values;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // Merit graph of the constraints, with unit penalty and no bias.
+  gtsam::NonlinearFactorGraph merit_graph;
+  for (const auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(1.0));
+  }
+  for (const auto& constraint : inequality_constraints) {
+    merit_graph.add(constraint->createFactor(1.0));
+  }
+  if (merit_graph.empty()) return values;
+
+  gtsam::Values constrained_values;
+  for (gtsam::Key key : merit_graph.keys()) {
+    constrained_values.insert(key, values.at(key));
+  }
+  gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, constrained_values,
+                                               params.lm_parameters);
+  gtsam::Values restored = values;
+  restored.update(optimizer.optimize());
+
+  if (intermediate_result != nullptr) {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    intermediate_result->addPhaseTime("restoration", elapsed.count());
+    intermediate_result->addCount("restoration_iterations",
+                                  optimizer.iterations());
+  }
+  return restored;
+}
+
+}  // namespace gtdynamics
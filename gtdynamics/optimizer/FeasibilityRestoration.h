@@ -0,0 +1,56 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FeasibilityRestoration.h
+ * @brief Move the initial values of a constrained problem towards feasibility.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+struct ConstrainedOptResult;
+
+/// Parameters of the feasibility restoration phase of constrained optimizers.
+struct FeasibilityRestorationParameters {
+  bool enabled = false;
+  /// Only restore if the tolerance-scaled violation (L2 norm) of the initial
+  /// values is above this value.
+  double violation_threshold = 0.0;
+  /// Parameters of the LM solve on the merit graph of the constraints.
+  gtsam::LevenbergMarquardtParams lm_parameters;
+};
+
+/**
+ * Feasibility restoration: minimize only the constraint violation, i.e. the
+ * merit function ||h(X)||^2 of ConnectedComponent plus ||max(0, -g(X))||^2
+ * for inequalities, over the constrained variables, before the costs are
+ * switched on. Starting
+ * a penalty or Augmented Lagrangian solve from the restored values saves the
+ * outer iterations which would otherwise be spent getting close to the
+ * constraint manifold with a small penalty parameter.
+ *
+ * Variables of no constraint keep their values. Returns values unchanged if
+ * restoration is disabled or the initial violation is below the threshold;
+ * reports the time and LM iterations as phase "restoration" and count
+ * "restoration_iterations" of intermediate_result, if given.
+ */
+gtsam::Values RestoreFeasibility(
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& values,
+    const FeasibilityRestorationParameters& params,
+    ConstrainedOptResult* intermediate_result = nullptr);
+
+}  // namespace gtdynamics
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.cpp
+ * @brief Inequality constraints in constrained optimization.
+ * @author: Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+/// Ramp function max(0, x), with derivative.
+static double Ramp(const double& x, gtsam::OptionalJacobian<1, 1> H = {}) {
+  if (x <= 0) {
+    if (H) H->setZero();
+    return 0.0;
+  }
+  if (H) H->setOnes();
+  return x;
+}
+
+/* ************************************************************************* */
+gtsam::NoiseModelFactor::shared_ptr DoubleExpressionInequality::createFactor(
+    const double mu, std::optional<gtsam::Vector> bias) const {
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, tolerance_ / sqrt(mu));
+  const double b = bias ? (*bias)(0) : 0.0;
+  gtsam::Expression<double> violation(
+      Ramp, gtsam::Expression<double>(b) - expression_);
+  return gtsam::NoiseModelFactor::shared_ptr(
+      new gtsam::ExpressionFactor<double>(noise, 0.0, violation));
+}
+
+/* ************************************************************************* */
+gtsam::NoiseModelFactor::shared_ptr
+DoubleExpressionInequality::createValueFactor() const {
+  return gtsam::NoiseModelFactor::shared_ptr(
+      new gtsam::ExpressionFactor<double>(gtsam::noiseModel::Unit::Create(1),
+                                          0.0, expression_));
+}
+
+/* ************************************************************************* */
+bool DoubleExpressionInequality::feasible(const gtsam::Values& x) const {
+  return expression_.value(x) >= -tolerance_;
+}
+
+/* ************************************************************************* */
+gtsam::Vector DoubleExpressionInequality::operator()(
+    const gtsam::Values& x) const {
+  double result = expression_.value(x);
+  return (gtsam::Vector(1) << result).finished();
+}
+
+/* ************************************************************************* */
+gtsam::Vector DoubleExpressionInequality::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  double result = expression_.value(x);
+  return (gtsam::Vector(1) << std::max(0.0, -result) / tolerance_).finished();
+}
+
+/* ************************************************************************* */
+ConstraintEvaluation DoubleExpressionInequality::evaluate(
+    const gtsam::Values& x) const {
+  const double result = expression_.value(x);
+  return {gtsam::Vector1(result),
+          gtsam::Vector1(std::max(0.0, -result) / tolerance_),
+          result >= -tolerance_};
+}
+
+/* ************************************************************************* */
+size_t InequalityConstraints::dim() const {
+  size_t dimension = 0;
+  for (const auto& constraint : *this) {
+    dimension += constraint->dim();
+  }
+  return dimension;
+}
+
+/* ************************************************************************* */
+InequalityConstraints BoxConstraints(const gtsam::Expression<double>& q,
+                                     double low, double high,
+                                     double tolerance) {
+  InequalityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionInequality>(
+      q - gtsam::Expression<double>(low), tolerance);
+  constraints.emplace_shared<DoubleExpressionInequality>(
+      gtsam::Expression<double>(high) - q, tolerance);
+  return constraints;
+}
+
+}  // namespace gtdynamics
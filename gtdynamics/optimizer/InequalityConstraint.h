@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.h
+ * @brief Inequality constraints in constrained optimization.
+ * @author: Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+namespace gtdynamics {
+
+/**
+ * Inequality constraint base class, for constraints g(x) >= 0.
+ */
+class InequalityConstraint {
+ public:
+  typedef InequalityConstraint This;
+  typedef std::shared_ptr<This> shared_ptr;
+
+  /** Default constructor. */
+  InequalityConstraint() {}
+
+  /** Destructor. */
+  virtual ~InequalityConstraint() {}
+
+  /**
+   * @brief Create a factor representing the component in the merit function.
+   *
+   * @param mu penalty parameter.
+   * @param bias additional bias, e.g. multiplier/mu in augmented Lagrangian.
+   * @return a factor representing
+   * 1/2 mu||max(0, bias - g(x))||_Diag(tolerance^2)^2.
+   */
+  virtual gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu, std::optional<gtsam::Vector> bias = {}) const = 0;
+
+  /**
+   * @brief Create a factor whose unwhitened error is g(x), for solvers that
+   * take the inequality with its exact Jacobian, e.g. interior point methods.
+   */
+  virtual gtsam::NoiseModelFactor::shared_ptr createValueFactor() const = 0;
+
+  /**
+   * @brief Check if the constraint is satisfied within tolerance.
+   *
+   * @param x values to evalute constraint at.
+   * @return bool representing if is feasible.
+   */
+  virtual bool feasible(const gtsam::Values& x) const = 0;
+
+  /**
+   * @brief Evaluate the constraint function, g(x).
+   *
+   * @param x values to evalute constraint at.
+   * @return a vector of g(x), which is feasible where nonnegative.
+   */
+  virtual gtsam::Vector operator()(const gtsam::Values& x) const = 0;
+
+  /** @brief Violation max(0, -g(x)) scaled by tolerance. */
+  virtual gtsam::Vector toleranceScaledViolation(
+      const gtsam::Values& x) const = 0;
+
+  /**
+   * @brief Evaluate g(x), its tolerance-scaled violation and feasibility at
+   * once. The default calls the three methods.
+   */
+  virtual ConstraintEvaluation evaluate(const gtsam::Values& x) const {
+    return {(*this)(x), toleranceScaledViolation(x), feasible(x)};
+  }
+
+  /** @brief return the dimension of the constraint. */
+  virtual size_t dim() const = 0;
+
+  /// Return keys of variables involved in the constraint.
+  virtual std::set<gtsam::Key> keys() const { return std::set<gtsam::Key>(); }
+};
+
+/** Inequality constraint that forces g(x) >= 0, where g(x) is a scalar-valued
+ * function. */
+class DoubleExpressionInequality : public InequalityConstraint {
+ protected:
+  gtsam::Expression<double> expression_;
+  double tolerance_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param expression  expression representing g(x).
+   * @param tolerance   scalar representing tolerance.
+   */
+  DoubleExpressionInequality(const gtsam::Expression<double>& expression,
+                             const double& tolerance)
+      : expression_(expression), tolerance_(tolerance) {}
+
+  /** Create a factor representing the component in the merit function. */
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu, std::optional<gtsam::Vector> bias = {}) const override;
+
+  /** Create a factor whose unwhitened error is g(x). */
+  gtsam::NoiseModelFactor::shared_ptr createValueFactor() const override;
+
+  /** Check if the constraint is satisfied within tolerance. */
+  bool feasible(const gtsam::Values& x) const override;
+
+  /** Evaluate the constraint function, g(x). */
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  /** Violation max(0, -g(x)) scaled by tolerance. */
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  /** Evaluate g(x) once for the violation and feasibility. */
+  ConstraintEvaluation evaluate(const gtsam::Values& x) const override;
+
+  /** Return the dimension of the constraint. */
+  size_t dim() const override { return 1; }
+
+  std::set<gtsam::Key> keys() const override { return expression_.keys(); }
+};
+
+/// Container of InequalityConstraint.
+class InequalityConstraints
+    : public std::vector<InequalityConstraint::shared_ptr> {
+ private:
+  using Base = std::vector<InequalityConstraint::shared_ptr>;
+
+  template <typename DERIVEDCONSTRAINT>
+  using IsDerived = typename std::enable_if<
+      std::is_base_of<InequalityConstraint, DERIVEDCONSTRAINT>::value>::type;
+
+ public:
+  InequalityConstraints() : Base() {}
+
+  /// Add a set of inequality constraints.
+  void add(const InequalityConstraints& other) {
+    insert(end(), other.begin(), other.end());
+  }
+
+  /// Emplace a shared pointer to constraint of given type.
+  template <class DERIVEDCONSTRAINT, class... Args>
+  IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
+    push_back(std::allocate_shared<DERIVEDCONSTRAINT>(
+        Eigen::aligned_allocator<DERIVEDCONSTRAINT>(),
+        std::forward<Args>(args)...));
+  }
+
+  /// Return the total dimension of constraints.
+  size_t dim() const;
+};
+
+/**
+ * Inequality constraints low <= q <= high on a scalar expression, e.g. a joint
+ * angle or torque, as two DoubleExpressionInequality.
+ */
+InequalityConstraints BoxConstraints(const gtsam::Expression<double>& q,
+                                     double low, double high,
+                                     double tolerance);
+
+}  // namespace gtdynamics
@@ -0,0 +1,229 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IpoptOptimizer.cpp
+ * @brief Constrained optimization with the IPOPT interior point solver.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/IpoptOptimizer.h>
+#include <gtdynamics/optimizer/NlpProblem.h>
+
+#ifdef GTDYNAMICS_USE_IPOPT
+#include <IpIpoptApplication.hpp>
+#include <IpTNLP.hpp>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+#ifdef GTDYNAMICS_USE_IPOPT
+namespace {
+using Ipopt::Index;
+using Ipopt::Number;
+
+/// NlpProblem as an IPOPT TNLP, starting at x = 0, the initial values.
+class IpoptProblem : public Ipopt::TNLP {
+ public:
+  IpoptProblem(NlpProblem* nlp, const AnytimeParameters& anytime)
+      : nlp_(nlp), anytime_(anytime), deadline_(anytime.time_budget) {
+    row_pointers_.resize(nlp->numConstraints() + 1);
+    columns_.resize(nlp->numNonzeros());
+    nlp->jacobianStructure(row_pointers_.data(), columns_.data());
+    x_.assign(nlp->numVariables(), 0.0);
+  }
+
+  bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g, Index& nnz_h_lag,
+                    IndexStyleEnum& index_style) override {
+    n = static_cast<Index>(nlp_->numVariables());
+    m = static_cast<Index>(nlp_->numConstraints());
+    nnz_jac_g = static_cast<Index>(nlp_->numNonzeros());
+    nnz_h_lag = 0;  // limited-memory Hessian approximation
+    index_style = C_STYLE;
+    return true;
+  }
+
+  bool get_bounds_info(Index n, Number* x_l, Number* x_u, Index m,
+                       Number* g_l, Number* g_u) override {
+    // Bounds beyond IPOPT's nlp_upper_bound_inf, 1e19, are infinite.
+    std::fill(x_l, x_l + n, -1e20);
+    std::fill(x_u, x_u + n, 1e20);
+    nlp_->constraintBounds(g_l, g_u);
+    return true;
+  }
+
+  bool get_starting_point(Index n, bool init_x, Number* x, bool init_z,
+                          Number* z_L, Number* z_U, Index m, bool init_lambda,
+                          Number* lambda) override {
+    if (init_z || init_lambda) return false;
+    if (init_x) std::fill(x, x + n, 0.0);
+    return true;
+  }
+
+  // NlpProblem skips re-evaluation at the same x itself, so new_x is unused.
+  bool eval_f(Index n, const Number* x, bool new_x,
+              Number& obj_value) override {
+    obj_value = nlp_->objective(x);
+    return true;
+  }
+
+  bool eval_grad_f(Index n, const Number* x, bool new_x,
+                   Number* grad_f) override {
+    nlp_->gradient(x, grad_f);
+    return true;
+  }
+
+  bool eval_g(Index n, const Number* x, bool new_x, Index m,
+              Number* g) override {
+    nlp_->constraints(x, g);
+    return true;
+  }
+
+  bool eval_jac_g(Index n, const Number* x, bool new_x, Index m,
+                  Index nele_jac, Index* iRow, Index* jCol,
+                  Number* values) override {
+    if (values) {
+      nlp_->jacobianValues(x, values);
+      return true;
+    }
+    // IPOPT takes triplets: expand the CSR row pointers.
+    for (Index r = 0; r < m; r++) {
+      for (int p = row_pointers_[r]; p < row_pointers_[r + 1]; p++) {
+        iRow[p] = r;
+        jCol[p] = columns_[p];
+      }
+    }
+    return true;
+  }
+
+  bool intermediate_callback(Ipopt::AlgorithmMode mode, Index iter,
+                             Number obj_value, Number inf_pr, Number inf_du,
+                             Number mu, Number d_norm,
+                             Number regularization_size, Number alpha_du,
+                             Number alpha_pr, Index ls_trials,
+                             const Ipopt::IpoptData* ip_data,
+                             Ipopt::IpoptCalculatedQuantities* ip_cq) override {
+    num_iterations_ = iter;
+    if (deadline_.expired()) return false;
+    if (!anytime_.callback) return true;
+    // The unscaled iterate of the original problem, also in restoration.
+    const Index n = static_cast<Index>(x_.size());
+    if (!get_curr_iterate(ip_data, ip_cq, false, n, x_.data(), nullptr,
+                          nullptr, 0, nullptr, nullptr)) {
+      return true;
+    }
+    const gtsam::Values values = nlp_->values(x_.data());
+    IterationReport report{static_cast<size_t>(iter), deadline_.elapsed(),
+                           obj_value, inf_pr, &values};
+    return anytime_.callback(report);
+  }
+
+  void finalize_solution(Ipopt::SolverReturn status, Index n, const Number* x,
+                         const Number* z_L, const Number* z_U, Index m,
+                         const Number* g, const Number* lambda,
+                         Number obj_value, const Ipopt::IpoptData* ip_data,
+                         Ipopt::IpoptCalculatedQuantities* ip_cq) override {
+    std::copy(x, x + n, x_.begin());
+  }
+
+  /// Last iterate, and the number of iterations done.
+  const std::vector<double>& x() const { return x_; }
+  size_t numIterations() const { return num_iterations_; }
+
+  /// Seconds since construction.
+  double elapsed() const { return deadline_.elapsed(); }
+
+ private:
+  NlpProblem* nlp_;
+  const AnytimeParameters& anytime_;
+  Deadline deadline_;
+  std::vector<int> row_pointers_, columns_;
+  std::vector<double> x_;
+  size_t num_iterations_ = 0;
+};
+}  // namespace
+#endif
+
+/* ************************************************************************* */
+bool IpoptOptimizer::Available() {
+#ifdef GTDYNAMICS_USE_IPOPT
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* ************************************************************************* */
+gtsam::Values IpoptOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  intermediate_result);
+}
+
+/* ************************************************************************* */
+gtsam::Values IpoptOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+#ifdef GTDYNAMICS_USE_IPOPT
+  NlpProblem nlp(EqConsOptProblem(graph, constraints, initial_values),
+                 inequality_constraints);
+
+  Ipopt::SmartPtr<Ipopt::IpoptApplication> app = IpoptApplicationFactory();
+  Ipopt::SmartPtr<Ipopt::OptionsList> options = app->Options();
+  options->SetStringValue("sb", "yes");  // no banner
+  options->SetStringValue("hessian_approximation", "limited-memory");
+  options->SetIntegerValue("max_iter", static_cast<Index>(p_.max_iterations));
+  options->SetNumericValue("tol", p_.tolerance);
+  options->SetNumericValue("constr_viol_tol", p_.constraint_tolerance);
+  options->SetIntegerValue("print_level", p_.print_level);
+  for (auto&& [name, value] : p_.string_options) {
+    options->SetStringValue(name, value);
+  }
+  for (auto&& [name, value] : p_.numeric_options) {
+    options->SetNumericValue(name, value);
+  }
+  for (auto&& [name, value] : p_.integer_options) {
+    options->SetIntegerValue(name, value);
+  }
+  if (app->Initialize() != Ipopt::Solve_Succeeded) {
+    throw std::runtime_error("IpoptOptimizer: invalid IPOPT options.");
+  }
+
+  IpoptProblem* problem = new IpoptProblem(&nlp, p_.anytime);
+  Ipopt::SmartPtr<Ipopt::TNLP> tnlp = problem;  // owns problem
+  const Ipopt::ApplicationReturnStatus status = app->OptimizeTNLP(tnlp);
+  // Iteration limits and failed restoration still leave an iterate.
+  if (status <= Ipopt::Not_Enough_Degrees_Of_Freedom) {
+    throw std::runtime_error("IpoptOptimizer: IPOPT failed with status " +
+                             std::to_string(static_cast<int>(status)));
+  }
+
+  const gtsam::Values result = nlp.values(problem->x().data());
+  if (intermediate_result != nullptr) {
+    intermediate_result->intermediate_values.push_back(result);
+    intermediate_result->num_iters.push_back(problem->numIterations());
+    intermediate_result->times.push_back(problem->elapsed());
+  }
+  return result;
+#else
+  throw std::runtime_error(
+      "IpoptOptimizer: IPOPT was not compiled in, see GTDYNAMICS_WITH_IPOPT.");
+#endif
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IpoptOptimizer.h
+ * @brief Constrained optimization with the IPOPT interior point solver.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+#include <map>
+#include <string>
+
+namespace gtdynamics {
+
+/// Parameters for IpoptOptimizer; the LM parameters are not used.
+struct IpoptParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t max_iterations = 500;         // IPOPT max_iter
+  double tolerance = 1e-8;             // IPOPT tol, on the scaled KKT error
+  double constraint_tolerance = 1e-6;  // IPOPT constr_viol_tol
+  int print_level = 0;                 // IPOPT print_level, 0 is silent
+  /// Further IPOPT options by name, e.g. {"linear_solver", "ma57"}; they
+  /// override the ones above.
+  std::map<std::string, std::string> string_options;
+  std::map<std::string, double> numeric_options;
+  std::map<std::string, int> integer_options;
+
+  /** Constructor. */
+  IpoptParameters() : Base(gtsam::LevenbergMarquardtParams()) {}
+};
+
+/**
+ * Constrained optimization with IPOPT, a primal-dual interior point method,
+ * on the NLP of the problem in tangent coordinates, see NlpProblem. IPOPT
+ * gets the exact gradient and exact, sparse constraint Jacobians, and
+ * approximates the Hessian of the Lagrangian with limited-memory BFGS, as
+ * constraints do not provide second derivatives. Inequality constraints
+ * g(x) >= 0 are handled by IPOPT's barrier, not by penalties.
+ *
+ * IPOPT is optional: configure with GTDYNAMICS_WITH_IPOPT, and check
+ * Available() before use, as optimize throws otherwise.
+ */
+class IpoptOptimizer : public ConstrainedOptimizer {
+ protected:
+  const IpoptParameters p_;
+
+ public:
+  /** Default constructor. */
+  IpoptOptimizer() : p_(IpoptParameters()) {}
+
+  /** Construct from parameters. */
+  IpoptOptimizer(const IpoptParameters& parameters) : p_(parameters) {}
+
+  /// Whether GTDynamics was compiled with IPOPT.
+  static bool Available();
+
+  /// Run optimization.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /**
+   * Run optimization with equality and inequality constraints. The result
+   * holds one inner loop, with the number of IPOPT iterations. Throws
+   * std::runtime_error if IPOPT fails outright, e.g. on invalid options;
+   * otherwise the last iterate is returned, as for the other optimizers.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequality_constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,257 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryReport.cpp
+ * @brief Approximate memory of factor graphs, values and their
+ * linearization, by type.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
+#include <gtsam/base/types.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+using gtsam::Key;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/// Bytes of a node of the map in Values: three pointers and a color, the key
+/// and the pointer to the value.
+static constexpr size_t kValuesNodeBytes =
+    4 * sizeof(void *) + sizeof(Key) + sizeof(void *);
+
+/* ************************************************************************* */
+static size_t NoiseModelBytes(const gtsam::noiseModel::Base &model) {
+  namespace nm = gtsam::noiseModel;
+  const size_t vector_bytes = model.dim() * sizeof(double);
+  if (auto robust = dynamic_cast<const nm::Robust *>(&model)) {
+    return sizeof(nm::Robust) + NoiseModelBytes(*robust->noise());
+  }
+  // Sigmas, inverse sigmas and precisions, and the weights of constraints.
+  if (dynamic_cast<const nm::Constrained *>(&model)) {
+    return sizeof(nm::Constrained) + 4 * vector_bytes;
+  }
+  if (dynamic_cast<const nm::Diagonal *>(&model)) {
+    return sizeof(nm::Diagonal) + 3 * vector_bytes;
+  }
+  if (dynamic_cast<const nm::Gaussian *>(&model)) {
+    return sizeof(nm::Gaussian) + model.dim() * vector_bytes;
+  }
+  return sizeof(nm::Base);
+}
+
+/**
+ * ExpressionFactor keeps its expression protected; a pointer to the member,
+ * formed in a derived class, reads it from any ExpressionFactor.
+ */
+template <typename T>
+struct ExpressionAccess : public gtsam::ExpressionFactor<T> {
+  static const gtsam::Expression<T> &Of(
+      const gtsam::ExpressionFactor<T> &factor) {
+    return factor.*(&ExpressionAccess::expression_);
+  }
+};
+
+/// Add the measurement and the execution trace of an ExpressionFactor<T>.
+template <typename T>
+static bool AddExpressionBytes(const gtsam::NonlinearFactor &factor,
+                               size_t *bytes) {
+  auto expression_factor =
+      dynamic_cast<const gtsam::ExpressionFactor<T> *>(&factor);
+  if (!expression_factor) return false;
+  *bytes += sizeof(T) + factor.size() * sizeof(int) +
+            ExpressionAccess<T>::Of(*expression_factor).traceSize();
+  return true;
+}
+
+/// Bytes of an expression factor with a measurement of one of the types Ts.
+template <typename... Ts>
+static size_t ExpressionBytes(const gtsam::NonlinearFactor &factor) {
+  size_t bytes = 0;
+  (AddExpressionBytes<Ts>(factor, &bytes) || ...);
+  return bytes;
+}
+
+/* ************************************************************************* */
+static size_t GaussianFactorBytes(const gtsam::GaussianFactor &factor) {
+  size_t bytes = factor.size() * sizeof(Key);
+  if (auto jacobian = dynamic_cast<const gtsam::JacobianFactor *>(&factor)) {
+    // Also GaussianConditional, whose rows are the frontal variables.
+    bytes += sizeof(gtsam::JacobianFactor) +
+             jacobian->rows() * jacobian->cols() * sizeof(double);
+    if (jacobian->get_model()) {
+      bytes += NoiseModelBytes(*jacobian->get_model());
+    }
+  } else if (auto hessian =
+                 dynamic_cast<const gtsam::HessianFactor *>(&factor)) {
+    const size_t n = hessian->info().rows();
+    bytes += sizeof(gtsam::HessianFactor) + n * n * sizeof(double);
+  } else {
+    bytes += sizeof(gtsam::GaussianFactor);
+  }
+  return bytes;
+}
+
+/// Add the size of a GenericValue<T>.
+template <typename T>
+static bool AddValueBytes(const gtsam::Value &value, size_t *bytes) {
+  if (!dynamic_cast<const gtsam::GenericValue<T> *>(&value)) return false;
+  *bytes += sizeof(gtsam::GenericValue<T>);
+  return true;
+}
+
+/* ************************************************************************* */
+static size_t ValueBytes(const gtsam::Value &value) {
+  size_t bytes = kValuesNodeBytes;
+  if (auto vector =
+          dynamic_cast<const gtsam::GenericValue<Vector> *>(&value)) {
+    return bytes + sizeof(*vector) + vector->value().size() * sizeof(double);
+  }
+  if (AddValueBytes<double>(value, &bytes) ||
+      AddValueBytes<Vector3>(value, &bytes) ||
+      AddValueBytes<Vector6>(value, &bytes) ||
+      AddValueBytes<gtsam::Pose3>(value, &bytes) ||
+      AddValueBytes<gtsam::Rot3>(value, &bytes)) {
+    return bytes;
+  }
+  return bytes + sizeof(gtsam::Value) + value.dim() * sizeof(double);
+}
+
+/* ************************************************************************* */
+void MemoryReport::addGraph(const gtsam::NonlinearFactorGraph &graph) {
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    size_t bytes =
+        sizeof(gtsam::NoiseModelFactor) + factor->size() * sizeof(Key);
+    if (auto noise_factor =
+            dynamic_cast<const gtsam::NoiseModelFactor *>(factor.get())) {
+      const auto &model = noise_factor->noiseModel();
+      if (model && noise_models_.insert(model.get()).second) {
+        bytes += NoiseModelBytes(*model);
+      }
+    }
+    if (auto container =
+            dynamic_cast<const gtsam::LinearContainerFactor *>(
+                factor.get())) {
+      bytes += GaussianFactorBytes(*container->factor());
+    }
+    bytes += ExpressionBytes<double, Vector3, Vector6, gtsam::Pose3, Vector>(
+        *factor);
+
+    MemoryEntry &entry = factors_[FactorProfile::Category(*factor)];
+    entry.count += 1;
+    entry.bytes += bytes;
+  }
+}
+
+/* ************************************************************************* */
+void MemoryReport::addValues(const gtsam::Values &values) {
+  for (Key key : values.keys()) {
+    const gtsam::Value &value = values.at(key);
+    MemoryEntry &entry = values_[gtsam::demangle(typeid(value).name())];
+    entry.count += 1;
+    entry.bytes += ValueBytes(value);
+  }
+}
+
+/* ************************************************************************* */
+void MemoryReport::addLinearGraph(const gtsam::GaussianFactorGraph &graph) {
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    MemoryEntry &entry =
+        linear_factors_[gtsam::demangle(typeid(*factor).name())];
+    entry.count += 1;
+    entry.bytes += GaussianFactorBytes(*factor);
+  }
+}
+
+/* ************************************************************************* */
+void MemoryReport::addBayesTree(const gtsam::GaussianBayesTree &bayes_tree) {
+  // The nodes map each frontal key to its clique, so cliques repeat.
+  std::set<const void *> cliques;
+  for (const auto &node : bayes_tree.nodes()) {
+    const auto &clique = node.second;
+    if (!clique || !cliques.insert(clique.get()).second) continue;
+    MemoryEntry &entry = bayes_tree_["gtsam::GaussianBayesTreeClique"];
+    entry.count += 1;
+    entry.bytes += sizeof(gtsam::GaussianBayesTreeClique) +
+                   GaussianFactorBytes(*clique->conditional());
+  }
+}
+
+/* ************************************************************************* */
+size_t MemoryReport::TotalBytes(const Section &section) {
+  size_t bytes = 0;
+  for (const auto &category : section) bytes += category.second.bytes;
+  return bytes;
+}
+
+/* ************************************************************************* */
+size_t MemoryReport::totalBytes() const {
+  return TotalBytes(factors_) + TotalBytes(values_) +
+         TotalBytes(linear_factors_) + TotalBytes(bayes_tree_);
+}
+
+/* ************************************************************************* */
+void MemoryReport::print(std::ostream &os) const {
+  const std::ios::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(3);
+  const std::vector<std::pair<std::string, const Section *>> sections = {
+      {"factors", &factors_},
+      {"values", &values_},
+      {"linear factors", &linear_factors_},
+      {"Bayes tree", &bayes_tree_}};
+  for (const auto &[name, section] : sections) {
+    if (section->empty()) continue;
+    os << name << ": " << TotalBytes(*section) / 1e6 << " MB\n";
+    std::vector<std::pair<std::string, MemoryEntry>> sorted(section->begin(),
+                                                            section->end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.second.bytes > b.second.bytes;
+                     });
+    for (const auto &[category, entry] : sorted) {
+      os << std::setw(10) << entry.count << std::setw(12)
+         << entry.bytes / 1e6 << " MB  " << category << "\n";
+    }
+  }
+  os << "total: " << totalBytes() / 1e6 << " MB\n";
+  os.flags(flags);
+}
+
+/* ************************************************************************* */
+MemoryReport ReportMemory(const gtsam::NonlinearFactorGraph &graph,
+                          const gtsam::Values &values, bool linearize) {
+  MemoryReport report;
+  report.addGraph(graph);
+  report.addValues(values);
+  if (linearize) {
+    const auto linear = graph.linearize(values);
+    report.addLinearGraph(*linear);
+    report.addBayesTree(*linear->eliminateMultifrontal());
+  }
+  return report;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryReport.h
+ * @brief Approximate memory of factor graphs, values and their
+ * linearization, by type.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+namespace gtdynamics {
+
+/// Number of objects of one type and their approximate bytes.
+struct MemoryEntry {
+  size_t count = 0;
+  size_t bytes = 0;
+};
+
+/**
+ * Approximate memory of the parts of an optimization problem, to guide the
+ * choice of horizon. Bytes are estimated from the stored matrices and
+ * vectors and the sizes of the classes, not measured from the allocator:
+ * factors count their keys, noise models and, for expression factors, the
+ * execution trace of the expression; noise models shared by several factors
+ * are counted once, with the first factor that uses them.
+ */
+class MemoryReport {
+ public:
+  /// Objects by category, see FactorProfile::Category for factors.
+  using Section = std::map<std::string, MemoryEntry>;
+
+  /// Add the factors of a nonlinear graph.
+  void addGraph(const gtsam::NonlinearFactorGraph &graph);
+
+  /// Add the values, by value type.
+  void addValues(const gtsam::Values &values);
+
+  /// Add a linearized graph, by Gaussian factor type.
+  void addLinearGraph(const gtsam::GaussianFactorGraph &graph);
+
+  /// Add the cliques of a Bayes tree, e.g. of an eliminated linear graph.
+  void addBayesTree(const gtsam::GaussianBayesTree &bayes_tree);
+
+  const Section &factors() const { return factors_; }
+  const Section &values() const { return values_; }
+  const Section &linearFactors() const { return linear_factors_; }
+  const Section &bayesTree() const { return bayes_tree_; }
+
+  /// Bytes of all entries of a section.
+  static size_t TotalBytes(const Section &section);
+
+  /// Bytes of all sections.
+  size_t totalBytes() const;
+
+  /// Print each section, its categories by decreasing bytes, and the total.
+  void print(std::ostream &os = std::cout) const;
+
+ private:
+  Section factors_, values_, linear_factors_, bayes_tree_;
+
+  /// Noise models already counted.
+  std::set<const void *> noise_models_;
+};
+
+/**
+ * Memory report of a problem, and optionally of its linearization at the
+ * values and the Bayes tree of its multifrontal elimination, which are
+ * computed for the purpose.
+ */
+MemoryReport ReportMemory(const gtsam::NonlinearFactorGraph &graph,
+                          const gtsam::Values &values,
+                          bool linearize = true);
+
+}  // namespace gtdynamics
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimization.cpp
+ * @brief Parallel optimization from several initial values, abandoning the
+ * starts that fall behind.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/MultiStartOptimization.h>
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+MultiStartResult MultiStartOptimize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::vector<gtsam::Values> &initial_values,
+    const gtsam::MutableLMParams &lm_params,
+    const MultiStartParameters &parameters) {
+  const size_t num_starts = initial_values.size();
+  if (num_starts == 0) {
+    throw std::invalid_argument("MultiStartOptimize: no initial values");
+  }
+
+  // All starts share the graph, so they can share its ordering.
+  gtsam::MutableLMParams params = lm_params;
+  if (!params.ordering) {
+    params.ordering = gtsam::Ordering::Create(params.orderingType, graph);
+  }
+
+  // Lowest error reported by any start so far.
+  std::mutex mutex;
+  double best_error = std::numeric_limits<double>::infinity();
+
+  MultiStartResult result;
+  result.starts.resize(num_starts);
+  std::vector<gtsam::Values> values(num_starts);
+  std::vector<std::exception_ptr> errors(num_starts);
+  auto run = [&](size_t i) {
+    try {
+      StartReport &report = result.starts[i];
+      report.abandoned = false;
+      gtsam::MutableLMParams start_params = params;
+      const IterationCallback callback = params.anytime.callback;
+      start_params.anytime.callback = [&](const IterationReport &iteration) {
+        if (callback && !callback(iteration)) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        best_error = std::min(best_error, iteration.cost);
+        if (parameters.abandon_ratio > 0 &&
+            iteration.iteration >= parameters.grace_iterations &&
+            iteration.cost > parameters.abandon_ratio * best_error) {
+          report.abandoned = true;
+          return false;
+        }
+        return true;
+      };
+      gtsam::MutableLMOptimizer optimizer(graph, initial_values[i],
+                                          start_params);
+      values[i] = optimizer.optimize();
+      report.error = optimizer.error();
+      report.iterations = optimizer.iterations();
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+
+  // Each thread takes the next start until none is left.
+  parameters.execution.parallelFor(num_starts, run);
+  for (auto &error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  result.best = 0;
+  for (size_t i = 1; i < num_starts; ++i) {
+    if (result.starts[i].error < result.starts[result.best].error) {
+      result.best = i;
+    }
+  }
+  result.values = values[result.best];
+  result.error = result.starts[result.best].error;
+  return result;
+}
+
+}  // namespace gtdynamics
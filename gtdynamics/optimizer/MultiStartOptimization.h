@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimization.h
+ * @brief Parallel optimization from several initial values, abandoning the
+ * starts that fall behind.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Options of MultiStartOptimize.
+struct MultiStartParameters {
+  /// Threads running the starts, by default one per hardware thread. The
+  /// starts linearize serially on their thread.
+  ExecutionContext execution = ExecutionContext::Threads(0);
+
+  /// Iterations each start runs before it can be abandoned.
+  size_t grace_iterations = 3;
+
+  /// Abandon a start whose error is above this many times the lowest error
+  /// of any start so far; 0 never abandons.
+  double abandon_ratio = 10.0;
+};
+
+/// How one start of MultiStartOptimize ended.
+struct StartReport {
+  double error;       // final error
+  size_t iterations;  // LM iterations run
+  bool abandoned;     // stopped because other starts were far better
+};
+
+/// Result of MultiStartOptimize.
+struct MultiStartResult {
+  gtsam::Values values;             // values of the best start
+  double error;                     // their error
+  size_t best;                      // index of the best start
+  std::vector<StartReport> starts;  // one per initial values
+};
+
+/**
+ * Optimize a graph with Levenberg-Marquardt from each of several initial
+ * values, e.g. Initializer::InitializeSolutionInterpolation with different
+ * seeds, on a pool of threads. After each iteration a start reports its
+ * error; once past its grace iterations it is abandoned if that error is
+ * still abandon_ratio times the best error of any start, since LM only
+ * decreases the error and the start is unlikely to catch up.
+ *
+ * The graph is linearized concurrently by the starts, so its factors must be
+ * safe to linearize concurrently. A callback in lm_params.anytime is called
+ * from all threads.
+ * @param graph the factor graph
+ * @param initial_values one set of initial values per start
+ * @param lm_params parameters of each optimization; if they have no
+ * ordering, the one ordering of the graph is computed once for all starts.
+ * @param parameters threads and abandonment
+ * @return the best values, and how each start ended
+ */
+MultiStartResult MultiStartOptimize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::vector<gtsam::Values> &initial_values,
+    const gtsam::MutableLMParams &lm_params = gtsam::MutableLMParams(),
+    const MultiStartParameters &parameters = MultiStartParameters());
+
+}  // namespace gtdynamics
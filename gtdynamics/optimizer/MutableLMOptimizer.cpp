@@ -20,21 +20,30 @@
  */
 
 #include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/Trace.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/base/timing.h>
 #include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianEliminationTree.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianJunctionTree.h>
+#include <gtsam/linear/HessianFactor.h>
 #include <gtsam/linear/linearExceptions.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/internal/LevenbergMarquardtState.h>
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -45,22 +54,28 @@ typedef internal::LevenbergMarquardtState State;
 /* ************************************************************************* */
 MutableLMOptimizer::MutableLMOptimizer(const NonlinearFactorGraph& graph,
                                        const Values& initialValues,
-                                       const LevenbergMarquardtParams& params)
+                                       const MutableLMParams& params)
     : NonlinearOptimizer(
           graph, std::unique_ptr<State>(
                      new State(initialValues, graph.error(initialValues),
                                params.lambdaInitial, params.lambdaFactor))),
-      params_(LevenbergMarquardtParams::EnsureHasOrdering(params, graph)) {}
+      params_(params) {
+  if (!params_.ordering) {
+    params_.ordering = Ordering::Create(params_.orderingType, graph);
+  }
+}
 
 MutableLMOptimizer::MutableLMOptimizer(const NonlinearFactorGraph& graph,
                                        const Values& initialValues,
                                        const Ordering& ordering,
-                                       const LevenbergMarquardtParams& params)
+                                       const MutableLMParams& params)
     : NonlinearOptimizer(
           graph, std::unique_ptr<State>(
                      new State(initialValues, graph.error(initialValues),
                                params.lambdaInitial, params.lambdaFactor))),
-      params_(LevenbergMarquardtParams::ReplaceOrdering(params, ordering)) {}
+      params_(params) {
+  params_.ordering = ordering;
+}
 
 /* ************************************************************************* */
 void MutableLMOptimizer::initTime() {
@@ -79,9 +94,173 @@ int MutableLMOptimizer::getInnerIterations() const {
   return currentState->totalNumberInnerIterations;
 }
 
+/* ************************************************************************* */
+namespace {
+// A linear factor without the columns of the fixed variables, i.e. with
+// their updates set to zero, or nullptr if it only has fixed variables.
+GaussianFactor::shared_ptr DropFixed(const GaussianFactor::shared_ptr& factor,
+                                     const KeySet& fixed) {
+  if (!factor) return factor;
+  KeyVector keys;
+  std::vector<size_t> blocks;
+  for (auto it = factor->begin(); it != factor->end(); ++it) {
+    if (!fixed.count(*it)) {
+      keys.push_back(*it);
+      blocks.push_back(it - factor->begin());
+    }
+  }
+  if (keys.size() == factor->size()) return factor;
+  if (keys.empty()) return nullptr;
+
+  if (auto jacobian = std::dynamic_pointer_cast<JacobianFactor>(factor)) {
+    std::vector<std::pair<Key, Matrix>> terms;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      terms.emplace_back(keys[i],
+                         jacobian->getA(jacobian->begin() + blocks[i]));
+    }
+    return std::make_shared<JacobianFactor>(terms, jacobian->getb(),
+                                            jacobian->get_model());
+  }
+
+  // Otherwise keep the blocks of the other variables of the information.
+  const Matrix information = factor->augmentedInformation();
+  std::vector<size_t> offsets{0};
+  for (auto it = factor->begin(); it != factor->end(); ++it) {
+    offsets.push_back(offsets.back() + factor->getDim(it));
+  }
+  const size_t n = offsets.back();
+  std::vector<Matrix> Gs;
+  std::vector<Vector> gs;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    const size_t row = offsets[blocks[i]];
+    const size_t rows = offsets[blocks[i] + 1] - row;
+    for (size_t j = i; j < blocks.size(); ++j) {
+      const size_t col = offsets[blocks[j]];
+      Gs.push_back(information.block(row, col, rows,
+                                     offsets[blocks[j] + 1] - col));
+    }
+    gs.push_back(information.block(row, n, rows, 1));
+  }
+  return std::make_shared<HessianFactor>(keys, Gs, gs, information(n, n));
+}
+}  // namespace
+
 /* ************************************************************************* */
 GaussianFactorGraph::shared_ptr MutableLMOptimizer::linearize() const {
-  return graph_.linearize(state_->values);
+  GTD_TRACE_SCOPE("MutableLMOptimizer::linearize", "optimizer");
+  const size_t num_factors = graph_.size();
+  const size_t num_threads = std::max<size_t>(
+      1, std::min(params_.linearizationThreads, num_factors / 2));
+  const bool selective = params_.relinearizeThreshold > 0;
+  if (num_factors == 0 ||
+      (num_threads == 1 && params_.fixed.empty() && !params_.profileFactors &&
+       !selective)) {
+    numRelinearized_ = num_factors;
+    return graph_.linearize(state_->values);
+  }
+
+  // Find the variables that moved, before the factors are linearized.
+  std::optional<KeySet> relinearize;
+  if (selective) {
+    if (linearCache_.size() != num_factors) {
+      linearCache_.assign(num_factors, nullptr);
+    }
+    relinearize = markRelinearized();
+  }
+  const KeySet* marked = relinearize ? &*relinearize : nullptr;
+  std::vector<char> relinearized(num_factors, 0);
+
+  // Each thread fills its block of linear factors in place, so the assembled
+  // graph has the same order as the serial one. Exceptions are rethrown on the
+  // calling thread; inside another parallel loop, e.g. of MultiStartOptimize,
+  // the blocks are linearized serially.
+  gttic(linearize_parallel);
+  const Values& values = state_->values;
+  const size_t block_size = (num_factors + num_threads - 1) / num_threads;
+  const size_t num_blocks = (num_factors + block_size - 1) / block_size;
+  std::vector<GaussianFactor::shared_ptr> factors(num_factors);
+  if (params_.profileFactors) factorSeconds_.assign(num_factors, 0.0);
+  auto linearizeBlock = [&](size_t block) {
+    const size_t end = std::min((block + 1) * block_size, num_factors);
+    for (size_t i = block * block_size; i < end; ++i) {
+      if (!graph_[i]) continue;
+      bool relinearized_i = true;
+      if (params_.profileFactors) {
+        const gtdynamics::Deadline timer;
+        factors[i] = linearizeFactor(i, marked, &relinearized_i);
+        factorSeconds_[i] = timer.elapsed();
+      } else {
+        factors[i] = linearizeFactor(i, marked, &relinearized_i);
+      }
+      relinearized[i] = relinearized_i;
+      if (!params_.fixed.empty()) {
+        factors[i] = DropFixed(factors[i], params_.fixed);
+      }
+    }
+  };
+  gtdynamics::ExecutionContext execution =
+      gtdynamics::ExecutionContext::Threads(num_threads);
+  execution.deterministic = true;
+  execution.parallelFor(num_blocks, linearizeBlock);
+  if (params_.profileFactors) {
+    currentFactorProfile().addLinearizeTimes(factorSeconds_);
+  }
+  numRelinearized_ =
+      std::count(relinearized.begin(), relinearized.end(), char(1));
+
+  auto linear = std::make_shared<GaussianFactorGraph>();
+  linear->reserve(num_factors);
+  for (auto& factor : factors) {
+    if (factor) linear->push_back(factor);
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+GaussianFactor::shared_ptr MutableLMOptimizer::linearizeFactor(
+    size_t i, const KeySet* relinearize, bool* relinearized) const {
+  const Values& values = state_->values;
+  *relinearized = true;
+  if (!relinearize) return graph_[i]->linearize(values);
+
+  // With a Gaussian noise model the Jacobian is whitened by a constant, so
+  // only the right-hand side, the whitened error, has to be recomputed.
+  auto factor = std::dynamic_pointer_cast<NoiseModelFactor>(graph_[i]);
+  const bool reusable =
+      factor &&
+      !std::dynamic_pointer_cast<noiseModel::Robust>(factor->noiseModel());
+  auto cached = std::dynamic_pointer_cast<JacobianFactor>(linearCache_[i]);
+  if (reusable && cached &&
+      std::none_of(factor->begin(), factor->end(),
+                   [&](Key key) { return relinearize->count(key) > 0; })) {
+    *relinearized = false;
+    auto updated = std::make_shared<JacobianFactor>(*cached);
+    updated->getb() = -factor->whitenedError(values);
+    return updated;
+  }
+  GaussianFactor::shared_ptr linear = graph_[i]->linearize(values);
+  linearCache_[i] = reusable ? linear : nullptr;
+  return linear;
+}
+
+/* ************************************************************************* */
+KeySet MutableLMOptimizer::markRelinearized() const {
+  const Values& values = state_->values;
+  KeySet relinearize;
+  for (Key key : values.keys()) {
+    if (!linearizationPoint_.exists(key)) {
+      linearizationPoint_.insert(key, values.at(key));
+      relinearize.insert(key);
+      continue;
+    }
+    const Vector delta =
+        linearizationPoint_.at(key).localCoordinates_(values.at(key));
+    if (delta.lpNorm<Eigen::Infinity>() > params_.relinearizeThreshold) {
+      linearizationPoint_.update(key, values.at(key));
+      relinearize.insert(key);
+    }
+  }
+  return relinearize;
 }
 
 /* ************************************************************************* */
@@ -102,37 +281,152 @@ GaussianFactorGraph MutableLMOptimizer::buildDampedSystem(
 }
 
 /* ************************************************************************* */
-// Log current error/lambda to file
-inline void MutableLMOptimizer::writeLogFile(double currentError) {
+void MutableLMOptimizer::DampedSystem::setLambda(double lambda) {
+  const double sqrt_lambda = std::sqrt(lambda);
+  for (auto& factor_diagonal : damping) {
+    JacobianFactor& factor = *factor_diagonal.first;
+    auto A = factor.getA(factor.begin());
+    A.setZero();
+    A.diagonal() = sqrt_lambda * factor_diagonal.second;
+  }
+}
+
+/* ************************************************************************* */
+MutableLMOptimizer::DampedSystem MutableLMOptimizer::buildDampedSystemCached(
+    const GaussianFactorGraph& linear,
+    const VectorValues& sqrtHessianDiagonal) const {
+  GTD_TRACE_SCOPE("MutableLMOptimizer::buildDampedSystem", "optimizer");
+  gttic(damp);
   auto currentState = static_cast<const State*>(state_.get());
 
-  if (!params_.logFile.empty()) {
-    ofstream os(params_.logFile.c_str(), ios::app);
-    // use chrono to measure time in microseconds
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    // Get the time spent in seconds and print it
-    double timeSpent = std::chrono::duration_cast<std::chrono::microseconds>(
-                           currentTime - startTime_)
-                           .count() /
-                       1e6;
-    os << /*inner iterations*/ currentState->totalNumberInnerIterations << ","
-       << timeSpent << "," << /*current error*/ currentError << ","
-       << currentState->lambda << ","
-       << /*outer iterations*/ currentState->iterations << endl;
+  DampedSystem damped;
+  damped.graph = linear;
+  auto addPrior = [&damped](Key key, const Vector& diagonal) {
+    const size_t dim = diagonal.size();
+    auto factor = std::make_shared<JacobianFactor>(
+        key, Matrix::Zero(dim, dim), Vector::Zero(dim),
+        noiseModel::Unit::Create(dim));
+    damped.graph.push_back(factor);
+    damped.damping.emplace_back(factor, diagonal);
+  };
+  if (params_.diagonalDamping) {
+    damped.graph.reserve(linear.size() + sqrtHessianDiagonal.size());
+    for (const auto& key_vector : sqrtHessianDiagonal) {
+      addPrior(key_vector.first, key_vector.second);
+    }
+  } else {
+    damped.graph.reserve(linear.size() + currentState->values.size());
+    for (const auto& key_dim : currentState->values.dims()) {
+      if (params_.fixed.count(key_dim.first)) continue;
+      addPrior(key_dim.first, Vector::Ones(key_dim.second));
+    }
+  }
+  damped.setLambda(currentState->lambda);
+  return damped;
+}
+
+/* ************************************************************************* */
+VectorValues MutableLMOptimizer::solveDamped(
+    const GaussianFactorGraph& damped) const {
+  GTD_TRACE_SCOPE("MutableLMOptimizer::solve", "optimizer");
+  if (params_.condensed.empty() && params_.fixed.empty()) {
+    return solveSystem(damped, params_.ordering);
+  }
+  if (!reducedOrdering_ && params_.ordering) {
+    KeySet dropped = params_.fixed;
+    dropped.insert(params_.condensed.begin(), params_.condensed.end());
+    reducedOrdering_ = Ordering();
+    for (Key key : *params_.ordering) {
+      if (!dropped.count(key)) reducedOrdering_->push_back(key);
+    }
   }
+  if (params_.condensed.empty()) return solveSystem(damped, reducedOrdering_);
+
+  // Eliminating the condensed variables leaves their Schur complement on the
+  // other variables, whose solution then gives them by back-substitution.
+  gttic(condense);
+  const auto [conditionals, reduced] = damped.eliminatePartialSequential(
+      params_.condensed, params_.getEliminationFunction());
+  gttoc(condense);
+  return conditionals->optimize(solveSystem(*reduced, reducedOrdering_));
+}
+
+/* ************************************************************************* */
+VectorValues MutableLMOptimizer::solveSystem(
+    const GaussianFactorGraph& system,
+    const std::optional<Ordering>& ordering) const {
+  if (params_.linearSolverBackend != gtdynamics::EliminationBackend) {
+    if (!sparseSolver_ ||
+        sparseSolver_->backend() != params_.linearSolverBackend) {
+      sparseSolver_ = std::make_shared<gtdynamics::SparseLinearSolver>(
+          params_.linearSolverBackend, params_.pcg);
+    }
+    return sparseSolver_->solve(system);
+  }
+  if (!params_.isMultifrontal() || !ordering) {
+    NonlinearOptimizerParams params = params_;
+    params.ordering = ordering;
+    return solve(system, params);
+  }
+  if (!dampedIndex_ || dampedIndex_->nFactors() != system.size()) {
+    dampedIndex_ = std::make_shared<VariableIndex>(system);
+  }
+  GaussianEliminationTree etree(system, *dampedIndex_, *ordering);
+  GaussianJunctionTree junctionTree(etree);
+  auto bayesTree =
+      junctionTree.eliminate(params_.getEliminationFunction()).first;
+  return bayesTree->optimize();
+}
+
+/* ************************************************************************* */
+// Log current error/lambda to file
+void MutableLMOptimizer::writeLogFile(double currentError) {
+  if (params_.logFile.empty()) return;
+  auto currentState = static_cast<const State*>(state_.get());
+  if (!logWriter_ || logWriter_->path() != params_.logFile ||
+      logWriter_->format() != params_.logFormat) {
+    logWriter_ = std::make_shared<gtdynamics::OptimizerLogWriter>(
+        params_.logFile, params_.logFormat);
+    initTime();
+  }
+
+  // use chrono to measure time in microseconds
+  auto currentTime = std::chrono::high_resolution_clock::now();
+  gtdynamics::OptimizerLogRecord record;
+  record.inner_iterations = currentState->totalNumberInnerIterations;
+  record.seconds = std::chrono::duration_cast<std::chrono::microseconds>(
+                       currentTime - startTime_)
+                       .count() /
+                   1e6;
+  record.error = currentError;
+  record.lambda = currentState->lambda;
+  record.iterations = currentState->iterations;
+  logWriter_->write(record);
 }
 
 /* ************************************************************************* */
 bool MutableLMOptimizer::tryLambda(const GaussianFactorGraph& linear,
                                    const VectorValues& sqrtHessianDiagonal) {
+  DampedSystem damped = buildDampedSystemCached(linear, sqrtHessianDiagonal);
+  return tryLambda(linear, &damped);
+}
+
+/* ************************************************************************* */
+bool MutableLMOptimizer::tryLambda(const GaussianFactorGraph& linear,
+                                   DampedSystem* damped) {
+  GTD_TRACE_SCOPE("MutableLMOptimizer::tryLambda", "optimizer");
   auto currentState = static_cast<const State*>(state_.get());
   bool verbose = (params_.verbosityLM >= LevenbergMarquardtParams::TRYLAMBDA);
 
   if (verbose) cout << "trying lambda = " << currentState->lambda << endl;
 
-  // Build damped system for this lambda (adds prior factors that make it like
-  // gradient descent)
-  auto dampedSystem = buildDampedSystem(linear, sqrtHessianDiagonal);
+  // Update the damping priors for this lambda (they make it like gradient
+  // descent)
+  if (params_.verbosityLM >= LevenbergMarquardtParams::DAMPED)
+    std::cout << "updating damped system with lambda " << currentState->lambda
+              << std::endl;
+  damped->setLambda(currentState->lambda);
+  const GaussianFactorGraph& dampedSystem = damped->graph;
 
   // Try solving
   double modelFidelity = 0.0;
@@ -143,13 +437,15 @@ bool MutableLMOptimizer::tryLambda(const GaussianFactorGraph& linear,
   VectorValues delta;
 
   bool systemSolvedSuccessfully;
+  gtdynamics::Deadline timer;
   try {
     // ============ Solve is where most computation happens !! =================
-    delta = solve(dampedSystem, params_);
+    delta = solveDamped(dampedSystem);
     systemSolvedSuccessfully = true;
   } catch (const IndeterminantLinearSystemException&) {
     systemSolvedSuccessfully = false;
   }
+  addPhaseTime("solve", timer.elapsed());
 
   if (systemSolvedSuccessfully) {
     if (verbose) cout << "linear delta norm = " << delta.norm() << endl;
@@ -170,15 +466,27 @@ bool MutableLMOptimizer::tryLambda(const GaussianFactorGraph& linear,
     if (linearizedCostChange >= 0) {  // step is valid
       // update values
       gttic(retract);
-      // ============ This is where the solution is updated ====================
-      newValues = currentState->values.retract(delta);
-      // =======================================================================
+      gtdynamics::Deadline retract_timer;
+      {
+        GTD_TRACE_SCOPE("MutableLMOptimizer::retract", "optimizer");
+        // ============ This is where the solution is updated ==================
+        newValues = params_.retractFunction
+                        ? params_.retractFunction(currentState->values, delta)
+                        : currentState->values.retract(delta);
+        // =====================================================================
+      }
+      addPhaseTime("retract", retract_timer.elapsed());
       gttoc(retract);
 
       // compute new error
       gttic(compute_error);
+      gtdynamics::Deadline error_timer;
       if (verbose) cout << "calculating error:" << endl;
-      newError = graph_.error(newValues);
+      {
+        GTD_TRACE_SCOPE("MutableLMOptimizer::error", "optimizer");
+        newError = graphError(newValues);
+      }
+      addPhaseTime("error", error_timer.elapsed());
       gttoc(compute_error);
 
       if (verbose)
@@ -266,6 +574,7 @@ bool MutableLMOptimizer::tryLambda(const GaussianFactorGraph& linear,
 
 /* ************************************************************************* */
 GaussianFactorGraph::shared_ptr MutableLMOptimizer::iterate() {
+  GTD_TRACE_SCOPE("MutableLMOptimizer::iterate", "optimizer");
   auto currentState = static_cast<const State*>(state_.get());
 
   gttic(LM_iterate);
@@ -273,7 +582,10 @@ GaussianFactorGraph::shared_ptr MutableLMOptimizer::iterate() {
   // Linearize graph
   if (params_.verbosityLM >= LevenbergMarquardtParams::DAMPED)
     cout << "linearizing = " << endl;
+  if (params_.recordPhaseTimes) iterationPhaseTimes_.emplace_back();
+  gtdynamics::Deadline timer;
   GaussianFactorGraph::shared_ptr linear = linearize();
+  addPhaseTime("linearize", timer.elapsed());
 
   if (currentState->totalNumberInnerIterations == 0) {  // write initial error
     writeLogFile(currentState->error);
@@ -297,8 +609,10 @@ GaussianFactorGraph::shared_ptr MutableLMOptimizer::iterate() {
     }
   }
 
-  // Keep increasing lambda until we make make progress
-  while (!tryLambda(*linear, sqrtHessianDiagonal)) {
+  // Keep increasing lambda until we make make progress, building the damped
+  // system only once
+  DampedSystem damped = buildDampedSystemCached(*linear, sqrtHessianDiagonal);
+  while (!tryLambda(*linear, &damped)) {
     auto newState = static_cast<const State*>(state_.get());
     writeLogFile(newState->error);
   }
@@ -307,7 +621,48 @@ GaussianFactorGraph::shared_ptr MutableLMOptimizer::iterate() {
 }
 
 /* ************************************************************************* */
-MutableLMOptimizer::MutableLMOptimizer(const LevenbergMarquardtParams& params)
+void MutableLMOptimizer::addPhaseTime(const std::string& phase,
+                                      double seconds) {
+  if (params_.recordPhaseTimes && !iterationPhaseTimes_.empty()) {
+    iterationPhaseTimes_.back()[phase] += seconds;
+  }
+}
+
+/* ************************************************************************* */
+gtdynamics::FactorProfile& MutableLMOptimizer::currentFactorProfile() const {
+  if (factorProfile_.numFactors() != graph_.size()) {
+    factorProfile_ = gtdynamics::FactorProfile(graph_);
+  }
+  return factorProfile_;
+}
+
+/* ************************************************************************* */
+double MutableLMOptimizer::graphError(const Values& values) const {
+  if (!params_.profileFactors) return graph_.error(values);
+  factorSeconds_.assign(graph_.size(), 0.0);
+  double total = 0.0;
+  for (size_t i = 0; i < graph_.size(); ++i) {
+    if (!graph_[i]) continue;
+    const gtdynamics::Deadline timer;
+    total += graph_[i]->error(values);
+    factorSeconds_[i] = timer.elapsed();
+  }
+  currentFactorProfile().addErrorTimes(factorSeconds_);
+  return total;
+}
+
+/* ************************************************************************* */
+const Values& MutableLMOptimizer::optimize() {
+  const Values& values =
+      params_.anytime.active()
+          ? gtdynamics::OptimizeAnytime(*this, params_, params_.anytime)
+          : NonlinearOptimizer::optimize();
+  if (logWriter_) logWriter_->flush();
+  return values;
+}
+
+/* ************************************************************************* */
+MutableLMOptimizer::MutableLMOptimizer(const MutableLMParams& params)
     : NonlinearOptimizer(
           NonlinearFactorGraph(),
           std::unique_ptr<State>(new State(Values(), 0., params.lambdaInitial,
@@ -316,37 +671,101 @@ MutableLMOptimizer::MutableLMOptimizer(const LevenbergMarquardtParams& params)
 
 /* ************************************************************************* */
 MutableLMOptimizer::MutableLMOptimizer(const NonlinearFactorGraph& graph,
-                                       const LevenbergMarquardtParams& params)
+                                       const MutableLMParams& params)
     : NonlinearOptimizer(
           graph, std::unique_ptr<State>(new State(
                      Values(), 0., params.lambdaInitial, params.lambdaFactor))),
-      params_(LevenbergMarquardtParams::EnsureHasOrdering(params, graph)) {}
+      params_(params) {
+  if (!params_.ordering) {
+    params_.ordering = Ordering::Create(params_.orderingType, graph);
+  }
+}
+
+/* ************************************************************************* */
+bool MutableLMOptimizer::sameStructure(
+    const NonlinearFactorGraph& graph) const {
+  if (graph.size() != graph_.size()) return false;
+  for (size_t i = 0; i < graph.size(); ++i) {
+    if (!graph[i] || !graph_[i]) {
+      if (graph[i] || graph_[i]) return false;
+    } else if (graph[i]->keys() != graph_[i]->keys()) {
+      return false;
+    }
+  }
+  return true;
+}
 
 /* ************************************************************************* */
 void MutableLMOptimizer::setGraph(const NonlinearFactorGraph& graph) {
+  if (sameStructure(graph)) {
+    updateGraph(graph);
+    return;
+  }
+  graph_ = graph;
+  dampedIndex_.reset();
+  sparseSolver_.reset();
+  reducedOrdering_.reset();
+  factorProfile_ = gtdynamics::FactorProfile();
+  clearLinearCache();
+  if (params_.orderingType != Ordering::CUSTOM || !params_.ordering) {
+    params_.ordering = Ordering::Create(params_.orderingType, graph);
+  }
+}
+
+/* ************************************************************************* */
+void MutableLMOptimizer::updateGraph(const NonlinearFactorGraph& graph) {
   graph_ = graph;
-  params_ = LevenbergMarquardtParams::EnsureHasOrdering(params_, graph);
+  clearLinearCache();
+  if (!params_.ordering) {
+    params_.ordering = Ordering::Create(params_.orderingType, graph);
+  }
 }
 
 /* ************************************************************************* */
 void MutableLMOptimizer::setGraph(const NonlinearFactorGraph& graph,
                                   const Ordering& ordering) {
   graph_ = graph;
-  params_ = LevenbergMarquardtParams::ReplaceOrdering(params_, ordering);
+  dampedIndex_.reset();
+  sparseSolver_.reset();
+  reducedOrdering_.reset();
+  factorProfile_ = gtdynamics::FactorProfile();
+  clearLinearCache();
+  params_.ordering = ordering;
+}
+
+/* ************************************************************************* */
+void MutableLMOptimizer::clearLinearCache() {
+  linearCache_.clear();
+  linearizationPoint_.clear();
+}
+
+/* ************************************************************************* */
+void MutableLMOptimizer::setFixed(const KeySet& fixed) {
+  params_.fixed = fixed;
+  dampedIndex_.reset();
+  sparseSolver_.reset();
+  reducedOrdering_.reset();
+}
+
+/* ************************************************************************* */
+double MutableLMOptimizer::initialLambda() const {
+  if (!params_.warmStartLambda || !state_) return params_.lambdaInitial;
+  return std::min(params_.lambdaUpperBound,
+                  std::max(params_.lambdaLowerBound, lambda()));
 }
 
 /* ************************************************************************* */
 void MutableLMOptimizer::setValues(const Values& values) {
   state_ = std::unique_ptr<State>(new State((values), graph_.error(values),
-                                            params_.lambdaInitial,
+                                            initialLambda(),
                                             params_.lambdaFactor));
 }
 
 /* ************************************************************************* */
 void MutableLMOptimizer::setValues(Values&& values) {
-  state_ = std::unique_ptr<State>(
-      new State(std::move(values), graph_.error(values), params_.lambdaInitial,
-                params_.lambdaFactor));
+  const double lambda = initialLambda();
+  state_ = std::unique_ptr<State>(new State(
+      std::move(values), graph_.error(values), lambda, params_.lambdaFactor));
 }
 
 } /* namespace gtsam */
@@ -22,22 +22,97 @@
 
 #pragma once
 
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtdynamics/optimizer/FactorProfile.h>
+#include <gtdynamics/optimizer/OptimizerLog.h>
+#include <gtdynamics/optimizer/SparseLinearSolver.h>
+#include <gtsam/inference/VariableIndex.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 #include <gtsam/nonlinear/NonlinearOptimizer.h>
 
 #include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 class NonlinearOptimizerMoreOptimizationTest;
 
 namespace gtsam {
 
+/**
+ * Levenberg-Marquardt parameters, with options specific to
+ * MutableLMOptimizer.
+ */
+struct GTSAM_EXPORT MutableLMParams : public LevenbergMarquardtParams {
+  /// Number of threads used to linearize the graph; 1 linearizes serially.
+  /// Factors must then be safe to linearize concurrently.
+  size_t linearizationThreads = 1;
+
+  /// Time budget and per-iteration callback of optimize().
+  gtdynamics::AnytimeParameters anytime;
+
+  /// Retraction of the values by a linear update; Values::retract if empty.
+  std::function<Values(const Values&, const VectorValues&)> retractFunction;
+
+  /// Start setValues() at the lambda the previous solve ended with, instead
+  /// of lambdaInitial, for repeated solves of similar problems.
+  bool warmStartLambda = false;
+
+  /// Record the time of the linearize, solve, retract and error phases of
+  /// each iteration, see MutableLMOptimizer::iterationPhaseTimes().
+  bool recordPhaseTimes = false;
+
+  /// Time the linearize and error calls of each factor, accumulated by type
+  /// of factor in MutableLMOptimizer::factorProfile(). Linearization then
+  /// takes the blocked path even with one thread.
+  bool profileFactors = false;
+
+  /// Backend of the damped solves; with EliminationBackend, linearSolverType
+  /// and iterativeParams choose between elimination, SubgraphSolver and PCG.
+  gtdynamics::LinearSolverBackend linearSolverBackend =
+      gtdynamics::EliminationBackend;
+
+  /// Tolerance and iterations of gtdynamics::PcgBackend.
+  gtdynamics::PcgParameters pcg;
+
+  /// Variables eliminated first, in this order, before the global solve of
+  /// the others, e.g. DynamicsGraph::CondensedOrdering. The global system is
+  /// their Schur complement; they are then recovered by back-substitution.
+  Ordering condensed;
+
+  /// Variables kept at their initial values. Their columns are dropped from
+  /// each linearization, so the graph is not rewritten as with ConstVarGraph
+  /// and the values keep them. Factors on fixed variables only are dropped.
+  KeySet fixed;
+
+  /// Relinearize only the factors on a variable that moved by more than this
+  /// since its last linearization, in the infinity norm of the tangent
+  /// vector, as in iSAM2. The other factors keep their Jacobians, with the
+  /// right-hand side from their exact error. 0 relinearizes all factors.
+  double relinearizeThreshold = 0.0;
+
+  /// Format of logFile, which is written by a background thread.
+  gtdynamics::LogFormat logFormat = gtdynamics::CsvLog;
+
+  MutableLMParams(
+      const LevenbergMarquardtParams& params = LevenbergMarquardtParams(),
+      size_t linearizationThreads = 1)
+      : LevenbergMarquardtParams(params),
+        linearizationThreads(linearizationThreads) {}
+};
+
 /**
  * This class performs Levenberg-Marquardt nonlinear optimization
  */
 class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
  protected:
-  LevenbergMarquardtParams params_;  ///< LM parameters
+  MutableLMParams params_;  ///< LM parameters
 
   // startTime_ is a chrono time point
   std::chrono::time_point<std::chrono::high_resolution_clock>
@@ -54,11 +129,11 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
   /// @{
 
   MutableLMOptimizer(
-      const LevenbergMarquardtParams& params = LevenbergMarquardtParams());
+      const MutableLMParams& params = MutableLMParams());
 
   MutableLMOptimizer(
       const NonlinearFactorGraph& graph,
-      const LevenbergMarquardtParams& params = LevenbergMarquardtParams());
+      const MutableLMParams& params = MutableLMParams());
 
   /** Standard constructor, requires a nonlinear factor graph, initial
    * variable assignments, and optimization parameters.  For convenience this
@@ -70,7 +145,7 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
    */
   MutableLMOptimizer(
       const NonlinearFactorGraph& graph, const Values& initialValues,
-      const LevenbergMarquardtParams& params = LevenbergMarquardtParams());
+      const MutableLMParams& params = MutableLMParams());
 
   /** Standard constructor, requires a nonlinear factor graph, initial
    * variable assignments, and optimization parameters.  For convenience this
@@ -82,7 +157,7 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
   MutableLMOptimizer(
       const NonlinearFactorGraph& graph, const Values& initialValues,
       const Ordering& ordering,
-      const LevenbergMarquardtParams& params = LevenbergMarquardtParams());
+      const MutableLMParams& params = MutableLMParams());
 
   /** Virtual destructor */
   ~MutableLMOptimizer() override {}
@@ -98,6 +173,22 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
   /// Access the current number of inner iterations
   int getInnerIterations() const;
 
+  /// Wall time in seconds per phase of each iteration, if recorded.
+  const std::vector<std::map<std::string, double>>& iterationPhaseTimes()
+      const {
+    return iterationPhaseTimes_;
+  }
+
+  /// Linearize and error times by type of factor, if profiled. The profile
+  /// accumulates over solves until the structure of the graph changes.
+  const gtdynamics::FactorProfile& factorProfile() const {
+    return factorProfile_;
+  }
+
+  /// Number of factors relinearized by the last linearize(), all of them
+  /// unless params().relinearizeThreshold is set.
+  size_t numRelinearized() const { return numRelinearized_; }
+
   /// print
   void print(const std::string& str = "") const {
     std::cout << str << "MutableLMOptimizer" << std::endl;
@@ -106,10 +197,28 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
 
   /// @}
 
+  /**
+   * Replace the graph. If it has the same structure (the same keys, factor by
+   * factor) as the current one, e.g. when only noise models or measurements
+   * changed, the ordering and symbolic data are kept; otherwise a new ordering
+   * is computed, unless the ordering type is CUSTOM.
+   */
   void setGraph(const NonlinearFactorGraph& graph);
 
   void setGraph(const NonlinearFactorGraph& graph, const Ordering& ordering);
 
+  /**
+   * Replace the graph by one the caller knows has the same structure as the
+   * current one, keeping the ordering and symbolic data without checking.
+   */
+  void updateGraph(const NonlinearFactorGraph& graph);
+
+  /// Replace the fixed variables, see MutableLMParams::fixed.
+  void setFixed(const KeySet& fixed);
+
+  /// Whether graph has the same keys, factor by factor, as the current graph.
+  bool sameStructure(const NonlinearFactorGraph& graph) const;
+
   void setValues(Values&& values);
 
   void setValues(const Values& values);
@@ -123,12 +232,27 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
    */
   GaussianFactorGraph::shared_ptr iterate() override;
 
+  /**
+   * Optimize until convergence, or until params().anytime stops it. LM only
+   * accepts steps that decrease the error, so the values are the best iterate.
+   */
+  const Values& optimize() override;
+
   /** Read-only access the parameters */
-  const LevenbergMarquardtParams& params() const { return params_; }
+  const MutableLMParams& params() const { return params_; }
 
+  /// Queue a record of the current state for params().logFile, if set. The
+  /// file is complete when optimize() returns or the optimizer is destroyed.
   void writeLogFile(double currentError);
 
-  /** linearize, can be overwritten */
+  /**
+   * linearize, can be overwritten. Uses params().linearizationThreads threads,
+   * each linearizing a contiguous block of factors; the linear factors are in
+   * the same order as the nonlinear ones. The columns of params().fixed are
+   * dropped, and so are the factors that have no other columns. With
+   * params().relinearizeThreshold, factors whose variables barely moved reuse
+   * their last Jacobians.
+   */
   virtual GaussianFactorGraph::shared_ptr linearize() const;
 
   /** Build a damped system for a specific lambda -- for testing only */
@@ -143,6 +267,93 @@ class GTSAM_EXPORT MutableLMOptimizer : public NonlinearOptimizer {
   /// @}
 
  protected:
+  /**
+   * Damped system of one outer iteration: the linear factors plus one damping
+   * prior per variable. The priors have unit noise and A = sqrt(lambda) * D,
+   * so retrying with another lambda only rescales them in place instead of
+   * copying the linear graph again.
+   */
+  struct DampedSystem {
+    GaussianFactorGraph graph;
+    /// Damping priors and their diagonals D.
+    std::vector<std::pair<std::shared_ptr<JacobianFactor>, Vector>> damping;
+
+    /// Set the damping of all priors for a given lambda.
+    void setLambda(double lambda);
+  };
+
+  /** Build the damped system of an outer iteration, at the current lambda */
+  DampedSystem buildDampedSystemCached(
+      const GaussianFactorGraph& linear,
+      const VectorValues& sqrtHessianDiagonal) const;
+
+  /** Inner loop on a cached damped system, updated to the current lambda */
+  bool tryLambda(const GaussianFactorGraph& linear, DampedSystem* damped);
+
+  /**
+   * Solve a damped system. For multifrontal solvers the variable index of the
+   * damped system is computed once per graph structure, so each solve only
+   * redoes the elimination tree and the numeric factorization. Likewise the
+   * sparse backends keep their symbolic analysis.
+   */
+  VectorValues solveDamped(const GaussianFactorGraph& damped) const;
+
+  /// Solve a damped or condensed system with the backend and an ordering.
+  VectorValues solveSystem(const GaussianFactorGraph& system,
+                           const std::optional<Ordering>& ordering) const;
+
+  /// params_.ordering without the condensed and fixed variables.
+  mutable std::optional<Ordering> reducedOrdering_;
+
+  /// Variable index of the damped system, reset when the structure changes.
+  mutable std::shared_ptr<VariableIndex> dampedIndex_;
+
+  /// Solver of the sparse backends, reset when the structure changes.
+  mutable std::shared_ptr<gtdynamics::SparseLinearSolver> sparseSolver_;
+
+  /// Writer of params_.logFile, created on the first record.
+  std::shared_ptr<gtdynamics::OptimizerLogWriter> logWriter_;
+
+  /// Lambda to start a new solve with, see MutableLMParams::warmStartLambda.
+  double initialLambda() const;
+
+  /// Phase times of each iteration, see MutableLMParams::recordPhaseTimes.
+  std::vector<std::map<std::string, double>> iterationPhaseTimes_;
+
+  /// Add time to a phase of the current iteration, if recording.
+  void addPhaseTime(const std::string& phase, double seconds);
+
+  /// Factor times, see MutableLMParams::profileFactors, and a buffer of one
+  /// time per factor.
+  mutable gtdynamics::FactorProfile factorProfile_;
+  mutable std::vector<double> factorSeconds_;
+
+  /// Linear factors of the last linearizations, before dropping the fixed
+  /// columns, and the values they were computed at, see
+  /// MutableLMParams::relinearizeThreshold. Empty entries are relinearized.
+  mutable std::vector<GaussianFactor::shared_ptr> linearCache_;
+  mutable Values linearizationPoint_;
+  mutable size_t numRelinearized_ = 0;
+
+  /// Linearize factor i, or update its cached Jacobian with the exact
+  /// right-hand side if none of its variables are in relinearize.
+  GaussianFactor::shared_ptr linearizeFactor(size_t i,
+                                             const KeySet* relinearize,
+                                             bool* relinearized) const;
+
+  /// Variables that moved by more than the threshold, and update their
+  /// linearization point to the current values.
+  KeySet markRelinearized() const;
+
+  /// Forget the cached linearizations, e.g. when the factors change.
+  void clearLinearCache();
+
+  /// Profile for the current graph, created if the graph has changed.
+  gtdynamics::FactorProfile& currentFactorProfile() const;
+
+  /// Error of the graph, profiled by factor if params().profileFactors.
+  double graphError(const Values& values) const;
+
   /** Access the parameters (base class version) */
   const NonlinearOptimizerParams& _params() const override { return params_; }
 };
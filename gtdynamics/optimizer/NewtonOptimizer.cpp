@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NewtonOptimizer.cpp
+ * @brief Damped Newton optimization with the second-order terms of factors.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/factors/SecondOrderFactor.h>
+#include <gtdynamics/optimizer/NewtonOptimizer.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::GaussianFactor::shared_ptr LinearizeSecondOrder(
+    const gtsam::NonlinearFactor::shared_ptr &factor,
+    const gtsam::Values &values, const NewtonParameters &parameters) {
+  auto noise_factor =
+      std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+  auto gaussian =
+      noise_factor ? std::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(
+                         noise_factor->noiseModel())
+                   : nullptr;
+  auto second_order = std::dynamic_pointer_cast<SecondOrderFactor>(factor);
+  if (!gaussian || gaussian->isConstrained() ||
+      (!second_order && !parameters.numerical_second_order)) {
+    return factor->linearize(values);
+  }
+
+  // Whitened Jacobians and error.
+  const size_t n = factor->size();
+  std::vector<gtsam::Matrix> H(n);
+  const gtsam::Vector error = noise_factor->unwhitenedError(values, H);
+  const gtsam::Matrix R = gaussian->R();
+  std::vector<size_t> dims;
+  size_t total_dim = 0;
+  for (auto &&H_j : H) {
+    dims.push_back(H_j.cols());
+    total_dim += H_j.cols();
+  }
+  gtsam::Matrix A(error.size(), total_dim);
+  for (size_t j = 0, col = 0; j < n; col += dims[j], j++) {
+    A.middleCols(col, dims[j]) = R * H[j];
+  }
+  const gtsam::Vector b = -R * error;
+
+  // Full Hessian and gradient of 0.5 |R e(x)|^2.
+  const gtsam::Vector weights = R.transpose() * (R * error);
+  gtsam::Matrix G = A.transpose() * A;
+  G += second_order ? second_order->weightedErrorHessian(values, weights)
+                    : NumericalWeightedErrorHessian(
+                          *noise_factor, values, weights,
+                          parameters.second_order_delta);
+  const gtsam::Vector g = A.transpose() * b;
+
+  // Upper-triangular blocks in row order, as HessianFactor expects.
+  std::vector<gtsam::Matrix> Gs;
+  std::vector<gtsam::Vector> gs;
+  for (size_t i = 0, row = 0; i < n; row += dims[i], i++) {
+    for (size_t j = i, col = row; j < n; col += dims[j], j++) {
+      Gs.push_back(G.block(row, col, dims[i], dims[j]));
+    }
+    gs.push_back(g.segment(row, dims[i]));
+  }
+  return std::make_shared<gtsam::HessianFactor>(factor->keys(), Gs, gs,
+                                                b.squaredNorm());
+}
+
+/* ************************************************************************* */
+gtsam::GaussianFactorGraph NewtonOptimizer::linearize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::Values &values) const {
+  gtsam::GaussianFactorGraph linear;
+  for (const auto &factor : graph) {
+    if (factor) linear.push_back(LinearizeSecondOrder(factor, values, p_));
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+gtsam::Values NewtonOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::Values &initial_values) const {
+  gtsam::Values values = initial_values;
+  double error = graph.error(values);
+  double lambda = p_.lambdaInitial;
+  iterations_ = 0;
+
+  while (iterations_ < p_.maxIterations) {
+    const gtsam::GaussianFactorGraph linear = linearize(graph, values);
+
+    // Increase the damping until the step decreases the error; the damping
+    // also makes the system positive definite where the Hessian is not.
+    bool accepted = false;
+    double new_error = error;
+    while (lambda <= p_.lambdaUpperBound) {
+      gtsam::GaussianFactorGraph damped = linear;
+      const double sqrt_lambda = std::sqrt(lambda);
+      for (const auto &key_dim : values.dims()) {
+        const size_t dim = key_dim.second;
+        damped.emplace_shared<gtsam::JacobianFactor>(
+            key_dim.first, sqrt_lambda * gtsam::Matrix::Identity(dim, dim),
+            gtsam::Vector::Zero(dim));
+      }
+      try {
+        const gtsam::Values new_values = values.retract(damped.optimize());
+        new_error = graph.error(new_values);
+        if (new_error < error) {
+          values = new_values;
+          accepted = true;
+          lambda = std::max(lambda / p_.lambdaFactor, p_.lambdaLowerBound);
+          break;
+        }
+      } catch (const gtsam::IndeterminantLinearSystemException &) {
+      }
+      lambda *= p_.lambdaFactor;
+    }
+    if (!accepted) break;
+
+    iterations_++;
+    const bool converged = gtsam::checkConvergence(
+        p_.relativeErrorTol, p_.absoluteErrorTol, p_.errorTol, error,
+        new_error);
+    error = new_error;
+    if (converged) break;
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NewtonOptimizer.h
+ * @brief Damped Newton optimization with the second-order terms of factors.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/// Parameters of the Newton optimizer; the LM parameters set the iteration
+/// limits, tolerances, and the damping schedule.
+struct NewtonParameters : public gtsam::LevenbergMarquardtParams {
+  /// Use central differences of the Jacobians for the second-order terms of
+  /// factors which do not implement SecondOrderFactor. If false, those
+  /// factors are linearized as in Gauss-Newton.
+  bool numerical_second_order = true;
+
+  /// Step of the central differences.
+  double second_order_delta = 1e-5;
+
+  NewtonParameters(const gtsam::LevenbergMarquardtParams &lm_parameters =
+                       gtsam::LevenbergMarquardtParams())
+      : gtsam::LevenbergMarquardtParams(lm_parameters) {}
+};
+
+/**
+ * Quadratic approximation of a factor with the full Hessian of its error,
+ * G = J'R'RJ + sum_i w_i d2e_i/dx2 with w = R'R e, for the error e and the
+ * square root information R, instead of the Gauss-Newton approximation.
+ * Factors without a Gaussian noise model (robust or constrained) are
+ * linearized as in Gauss-Newton.
+ * @param factor The factor.
+ * @param values Linearization point.
+ * @param parameters Whether and how to compute numerical second-order terms.
+ */
+gtsam::GaussianFactor::shared_ptr LinearizeSecondOrder(
+    const gtsam::NonlinearFactor::shared_ptr &factor,
+    const gtsam::Values &values,
+    const NewtonParameters &parameters = NewtonParameters());
+
+/**
+ * Damped Newton optimizer: every iteration solves the quadratic
+ * approximations of LinearizeSecondOrder plus LM damping, and the damping is
+ * increased until the step decreases the error. On stiff problems the
+ * second-order terms typically need fewer iterations than LM, at the cost of
+ * dense factor Hessians.
+ */
+class NewtonOptimizer {
+ protected:
+  const NewtonParameters p_;
+  mutable size_t iterations_ = 0;
+
+ public:
+  /** Constructor. */
+  NewtonOptimizer(const NewtonParameters &parameters = NewtonParameters())
+      : p_(parameters) {}
+
+  /// Quadratic approximation of all factors, without damping.
+  gtsam::GaussianFactorGraph linearize(const gtsam::NonlinearFactorGraph &graph,
+                                       const gtsam::Values &values) const;
+
+  /// Run optimization.
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values) const;
+
+  /// Number of accepted iterations of the last optimize().
+  size_t iterations() const { return iterations_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,268 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NlpProblem.cpp
+ * @brief Constrained problems as generic NLPs for external solvers.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/optimizer/NlpProblem.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+/**
+ * Retract a Lie group variable of type T with the Jacobian of the retraction
+ * in the tangent vector; false if the reference is of another type.
+ */
+template <class T>
+bool RetractLie(const gtsam::Value &reference, const double *x, gtsam::Key key,
+                gtsam::Values *current, gtsam::Matrix *H) {
+  using Traits = gtsam::traits<T>;
+  auto p = dynamic_cast<const gtsam::GenericValue<T> *>(&reference);
+  if (!p) return false;
+  constexpr int N = Traits::dimension;
+  Eigen::Matrix<double, N, N> Hv;
+  const T value = Traits::Retract(
+      p->value(), Eigen::Map<const Eigen::Matrix<double, N, 1>>(x), {}, Hv);
+  current->update<T>(key, value);
+  *H = Hv;
+  return true;
+}
+
+/// Whether the retraction of a value has a Jacobian other than the identity.
+bool IsLie(const gtsam::Value &value) {
+  return dynamic_cast<const gtsam::GenericValue<gtsam::Pose3> *>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Rot3> *>(&value);
+}
+}  // namespace
+
+/* ************************************************************************* */
+NlpProblem::NlpProblem(const EqConsOptProblem &problem,
+                       const InequalityConstraints &inequalities)
+    : reference_(problem.initValues()), current_(problem.initValues()) {
+  // Variable layout, in key order.
+  keys_ = reference_.keys();
+  std::map<gtsam::Key, size_t> index;
+  for (size_t v = 0; v < keys_.size(); v++) {
+    const gtsam::Value &value = reference_.at(keys_[v]);
+    index[keys_[v]] = v;
+    offsets_[keys_[v]] = num_variables_;
+    variable_offsets_.push_back(num_variables_);
+    dims_.push_back(value.dim());
+    retract_jacobians_.push_back(IsLie(value)
+                                     ? gtsam::Matrix::Identity(value.dim(),
+                                                               value.dim())
+                                     : gtsam::Matrix());
+    num_variables_ += value.dim();
+  }
+  x_.assign(num_variables_, 0.0);
+
+  auto make_term = [&](const gtsam::NoiseModelFactor::shared_ptr &factor) {
+    Term term;
+    term.factor = factor;
+    for (gtsam::Key key : factor->keys()) {
+      auto it = index.find(key);
+      if (it == index.end()) {
+        throw std::invalid_argument(
+            "NlpProblem: a factor is on a variable without initial value.");
+      }
+      term.variables.push_back(it->second);
+    }
+    term.H.resize(factor->size());
+    return term;
+  };
+
+  for (const auto &factor : problem.costs()) {
+    auto noise_factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (!noise_factor ||
+        !std::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(
+            noise_factor->noiseModel())) {
+      throw std::invalid_argument(
+          "NlpProblem: costs must have Gaussian noise models.");
+    }
+    costs_.push_back(make_term(noise_factor));
+  }
+
+  // Constraint rows, with the columns of their variables in sorted order.
+  row_pointers_.push_back(0);
+  auto add_constraint = [&](const gtsam::NoiseModelFactor::shared_ptr &factor) {
+    Term term = make_term(factor);
+    term.row = row_pointers_.size() - 1;
+    std::vector<size_t> order(term.variables.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&term](size_t a, size_t b) {
+      return term.variables[a] < term.variables[b];
+    });
+    term.block_offsets.resize(order.size());
+    size_t row_size = 0;
+    for (size_t k : order) {
+      term.block_offsets[k] = row_size;
+      row_size += dims_[term.variables[k]];
+    }
+    for (size_t i = 0; i < term.factor->dim(); i++) {
+      for (size_t k : order) {
+        const size_t offset = variable_offsets_[term.variables[k]];
+        for (size_t j = 0; j < dims_[term.variables[k]]; j++) {
+          columns_.push_back(static_cast<int>(offset + j));
+        }
+      }
+      if (columns_.size() >
+          static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::length_error("NlpProblem: too many Jacobian nonzeros.");
+      }
+      row_pointers_.push_back(static_cast<int>(columns_.size()));
+    }
+    constraints_.push_back(std::move(term));
+  };
+  for (const auto &constraint : problem.constraints()) {
+    add_constraint(constraint->createFactor(1.0));
+  }
+  num_equalities_ = numConstraints();
+  for (const auto &constraint : inequalities) {
+    add_constraint(constraint->createValueFactor());
+  }
+}
+
+/* ************************************************************************* */
+void NlpProblem::update(const double *x) {
+  if (valid_ &&
+      std::memcmp(x, x_.data(), num_variables_ * sizeof(double)) == 0) {
+    return;
+  }
+  std::copy(x, x + num_variables_, x_.begin());
+  for (size_t v = 0; v < keys_.size(); v++) {
+    const gtsam::Key key = keys_[v];
+    const gtsam::Value &reference = reference_.at(key);
+    const double *xv = x + variable_offsets_[v];
+    if (RetractLie<gtsam::Pose3>(reference, xv, key, &current_,
+                                 &retract_jacobians_[v]) ||
+        RetractLie<gtsam::Rot3>(reference, xv, key, &current_,
+                                &retract_jacobians_[v])) {
+      continue;
+    }
+    const std::unique_ptr<gtsam::Value> value(
+        reference.retract_(Eigen::Map<const gtsam::Vector>(xv, dims_[v])));
+    current_.update(key, *value);
+  }
+  valid_ = true;
+  evaluated_ = linearized_ = false;
+}
+
+/* ************************************************************************* */
+void NlpProblem::evaluate(bool jacobians) {
+  if (linearized_ || (evaluated_ && !jacobians)) return;
+  for (Term &term : costs_) {
+    if (jacobians) {
+      term.error = term.factor->unwhitenedError(current_, &term.H);
+      term.factor->noiseModel()->WhitenSystem(term.H, term.error);
+    } else {
+      term.error = term.factor->whitenedError(current_);
+    }
+  }
+  for (Term &term : constraints_) {
+    term.error =
+        term.factor->unwhitenedError(current_, jacobians ? &term.H : nullptr);
+  }
+  evaluated_ = true;
+  linearized_ = jacobians;
+}
+
+/* ************************************************************************* */
+double NlpProblem::entry(const Term &term, size_t k, size_t i,
+                         size_t j) const {
+  const gtsam::Matrix &Hv = retract_jacobians_[term.variables[k]];
+  return Hv.size() == 0 ? term.H[k](i, j) : term.H[k].row(i).dot(Hv.col(j));
+}
+
+/* ************************************************************************* */
+gtsam::Values NlpProblem::values(const double *x) {
+  update(x);
+  return current_;
+}
+
+/* ************************************************************************* */
+double NlpProblem::objective(const double *x) {
+  update(x);
+  evaluate(false);
+  double f = 0.0;
+  for (const Term &term : costs_) f += 0.5 * term.error.squaredNorm();
+  return f;
+}
+
+/* ************************************************************************* */
+void NlpProblem::gradient(const double *x, double *grad) {
+  update(x);
+  evaluate(true);
+  std::fill(grad, grad + num_variables_, 0.0);
+  for (const Term &term : costs_) {
+    for (size_t k = 0; k < term.variables.size(); k++) {
+      double *g = grad + variable_offsets_[term.variables[k]];
+      for (size_t j = 0; j < dims_[term.variables[k]]; j++) {
+        for (int i = 0; i < term.error.size(); i++) {
+          g[j] += entry(term, k, i, j) * term.error(i);
+        }
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+void NlpProblem::constraints(const double *x, double *c) {
+  update(x);
+  evaluate(false);
+  for (const Term &term : constraints_) {
+    std::copy(term.error.data(), term.error.data() + term.error.size(),
+              c + term.row);
+  }
+}
+
+/* ************************************************************************* */
+void NlpProblem::constraintBounds(double *lower, double *upper) const {
+  const size_t m = numConstraints();
+  std::fill(lower, lower + m, 0.0);
+  std::fill(upper, upper + num_equalities_, 0.0);
+  std::fill(upper + num_equalities_, upper + m,
+            std::numeric_limits<double>::infinity());
+}
+
+/* ************************************************************************* */
+void NlpProblem::jacobianStructure(int *row_pointers, int *columns) const {
+  std::copy(row_pointers_.begin(), row_pointers_.end(), row_pointers);
+  std::copy(columns_.begin(), columns_.end(), columns);
+}
+
+/* ************************************************************************* */
+void NlpProblem::jacobianValues(const double *x, double *values) {
+  update(x);
+  evaluate(true);
+  for (const Term &term : constraints_) {
+    for (size_t i = 0; i < term.factor->dim(); i++) {
+      double *row = values + row_pointers_[term.row + i];
+      for (size_t k = 0; k < term.variables.size(); k++) {
+        double *block = row + term.block_offsets[k];
+        for (size_t j = 0; j < dims_[term.variables[k]]; j++) {
+          block[j] = entry(term, k, i, j);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NlpProblem.h
+ * @brief Constrained problems as generic NLPs for external solvers.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * An EqConsOptProblem, with optional inequality constraints, as the NLP
+ *   min_x f(x) s.t. h(x) = 0, g(x) >= 0,  x in R^n,
+ * for solvers such as IPOPT or SNOPT. The variables are the tangent vectors
+ * of the problem variables from their initial values, X(x) = retract(X0, x),
+ * stacked in key order, so x = 0 is the initial guess; f is the cost error,
+ * and the constraint vector c = [h; g] stacks the equality violations and
+ * then the inequality values. Derivatives are exact, also away
+ * from x = 0 for Pose3 and Rot3 variables, whose retraction Jacobian is
+ * applied; other manifold types use its value at x = 0, the identity.
+ *
+ * The sparsity of the constraint Jacobian is computed once, in compressed
+ * sparse row (CSR) form with sorted columns, and the Jacobian is written
+ * straight into the caller's value buffer through precomputed offsets, with
+ * no intermediate triplets or matrices. All evaluations at the same x share
+ * one retraction and one evaluation of each factor, as solvers evaluate f,
+ * grad f, h and its Jacobian at each new x in turn; factors themselves still
+ * use GTSAM's temporaries. Costs must be NoiseModelFactors with Gaussian
+ * noise models.
+ */
+class NlpProblem {
+ public:
+  /// NLP of problem and inequalities, expanded around problem.initValues().
+  explicit NlpProblem(const EqConsOptProblem &problem,
+                      const InequalityConstraints &inequalities = {});
+
+  /// Number of variables n, constraint rows m, and Jacobian nonzeros.
+  size_t numVariables() const { return num_variables_; }
+  size_t numConstraints() const { return row_pointers_.size() - 1; }
+  size_t numNonzeros() const { return columns_.size(); }
+
+  /// Number of equality rows, which come first in c.
+  size_t numEqualities() const { return num_equalities_; }
+
+  /// Problem variables in the order of x, and the offset of each in x.
+  const gtsam::KeyVector &keys() const { return keys_; }
+  size_t offset(gtsam::Key key) const { return offsets_.at(key); }
+
+  /// Problem values at x, which has numVariables() entries.
+  gtsam::Values values(const double *x);
+
+  /// Objective f(x).
+  double objective(const double *x);
+
+  /// Gradient of f at x, into grad with numVariables() entries.
+  void gradient(const double *x, double *grad);
+
+  /// Constraints c(x), into c with numConstraints() entries.
+  void constraints(const double *x, double *c);
+
+  /// Bounds of c: zero for equality rows, [0, inf) for inequality rows.
+  void constraintBounds(double *lower, double *upper) const;
+
+  /**
+   * Write the CSR structure of the constraint Jacobian: row_pointers has
+   * numConstraints() + 1 entries, columns has numNonzeros() entries.
+   */
+  void jacobianStructure(int *row_pointers, int *columns) const;
+
+  /// Write the Jacobian of c at x, in the order of jacobianStructure.
+  void jacobianValues(const double *x, double *values);
+
+ private:
+  /// A factor with the Jacobian blocks of its variables.
+  struct Term {
+    gtsam::NoiseModelFactor::shared_ptr factor;
+    std::vector<size_t> variables;      // indices into keys_
+    std::vector<size_t> block_offsets;  // in each row, constraints only
+    size_t row = 0;                     // first row, constraints only
+    gtsam::Vector error;                // error at x
+    std::vector<gtsam::Matrix> H;       // Jacobians at x
+  };
+
+  size_t num_variables_ = 0, num_equalities_ = 0;
+  gtsam::Values reference_, current_;
+  gtsam::KeyVector keys_;
+  std::vector<size_t> dims_, variable_offsets_;  // by variable index
+  std::map<gtsam::Key, size_t> offsets_;
+  std::vector<Term> costs_, constraints_;
+  std::vector<int> row_pointers_, columns_;
+
+  /// Retraction Jacobians at x, empty for variables that use the identity.
+  std::vector<gtsam::Matrix> retract_jacobians_;
+
+  /// Last x, and whether the errors and Jacobians of the terms are at it.
+  std::vector<double> x_;
+  bool valid_ = false, evaluated_ = false, linearized_ = false;
+
+  /// Retract to x, if it is a new point.
+  void update(const double *x);
+
+  /// Evaluate the errors of all terms at the current x, and their Jacobians
+  /// if asked. Cost errors and Jacobians are whitened.
+  void evaluate(bool jacobians);
+
+  /// Entry (i, j) of the Jacobian of term block k in x coordinates.
+  double entry(const Term &term, size_t k, size_t i, size_t j) const;
+};
+
+}  // namespace gtdynamics
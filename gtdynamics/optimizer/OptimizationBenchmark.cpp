@@ -14,6 +14,8 @@
 #include <gtdynamics/optimizer/OptimizationBenchmark.h>
 
 #include <iomanip>
+#include <numeric>
+#include <set>
 
 using gtsam::LevenbergMarquardtParams, gtsam::LevenbergMarquardtOptimizer;
 using gtsam::NonlinearFactorGraph, gtsam::Values;
@@ -77,9 +79,9 @@ gtsam::ManifoldOptimizerParameters DefaultMoptParamsSV() {
 Values OptimizeConstraintManifold(
     const EqConsOptProblem& problem, std::ostream& latex_os,
     gtsam::ManifoldOptimizerParameters mopt_params,
-    LevenbergMarquardtParams lm_params, std::string exp_name,
-    double constraint_unit_scale) {
-  gtsam::ManifoldOptimizerType1 optimizer(mopt_params, lm_params);
+    gtsam::ManifoldOptimizerType1::NonlinearOptParamsVariant nopt_params,
+    std::string exp_name, double constraint_unit_scale) {
+  gtsam::ManifoldOptimizerType1 optimizer(mopt_params, nopt_params);
   auto mopt_problem = optimizer.initializeMoptProblem(
       problem.costs(), problem.constraints(), problem.initValues());
   gtdynamics::ConstrainedOptResult intermediate_result;
@@ -161,4 +163,247 @@ Values OptimizeAugmentedLagrangian(const EqConsOptProblem& problem,
   return result;
 }
 
+/* ************************************************************************* */
+Values OptimizeSQP(const EqConsOptProblem& problem, std::ostream& latex_os,
+                   SQPParameters params, double constraint_unit_scale) {
+  SQPOptimizer optimizer(params);
+  gtdynamics::ConstrainedOptResult intermediate_result;
+
+  auto optimization_start = std::chrono::system_clock::now();
+  auto result = optimizer.optimize(problem.costs(), problem.constraints(),
+                                   problem.initValues(), &intermediate_result);
+  auto optimization_end = std::chrono::system_clock::now();
+  auto optimization_time_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(optimization_end -
+                                                            optimization_start);
+  double optimization_time = optimization_time_ms.count() * 1e-3;
+
+  PrintLatex(
+      latex_os, "SQP",
+      problem.costsDimension() + problem.constraintsDimension(),
+      problem.valuesDimension(), optimization_time,
+      std::accumulate(intermediate_result.num_iters.begin(),
+                      intermediate_result.num_iters.end(), 0),
+      problem.evaluateConstraintViolationL2Norm(result) * constraint_unit_scale,
+      problem.evaluateCost(result));
+
+  return result;
+}
+
+/* ************************************************************************* */
+Values OptimizeIpopt(const EqConsOptProblem& problem, std::ostream& latex_os,
+                     IpoptParameters params, double constraint_unit_scale) {
+  IpoptOptimizer optimizer(params);
+  gtdynamics::ConstrainedOptResult intermediate_result;
+
+  auto optimization_start = std::chrono::system_clock::now();
+  auto result = optimizer.optimize(problem.costs(), problem.constraints(),
+                                   problem.initValues(), &intermediate_result);
+  auto optimization_end = std::chrono::system_clock::now();
+  auto optimization_time_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(optimization_end -
+                                                            optimization_start);
+  double optimization_time = optimization_time_ms.count() * 1e-3;
+
+  PrintLatex(
+      latex_os, "IPOPT",
+      problem.costsDimension() + problem.constraintsDimension(),
+      problem.valuesDimension(), optimization_time,
+      std::accumulate(intermediate_result.num_iters.begin(),
+                      intermediate_result.num_iters.end(), 0),
+      problem.evaluateConstraintViolationL2Norm(result) * constraint_unit_scale,
+      problem.evaluateCost(result));
+
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::DoglegParams DoglegParamsFromLM(
+    const LevenbergMarquardtParams& lm_params) {
+  gtsam::DoglegParams params;
+  static_cast<gtsam::NonlinearOptimizerParams&>(params) = lm_params;
+  return params;
+}
+
+/* ************************************************************************* */
+BenchmarkMethods DefaultBenchmarkMethods(
+    const LevenbergMarquardtParams& lm_params, double soft_constraint_mu) {
+  // Report the time of the problem transformation, e.g. of identifying the
+  // connected components.
+  gtsam::ManifoldOptimizerParameters mopt_params = DefaultMoptParams();
+  mopt_params.record_phase_times = true;
+
+  BenchmarkMethods methods;
+  methods.emplace_back(
+      "soft_constraints",
+      [=](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        NonlinearFactorGraph graph = problem.costs_;
+        graph.add(problem.constraintsGraph(soft_constraint_mu));
+        LevenbergMarquardtOptimizer optimizer(graph, problem.initValues(),
+                                              lm_params);
+        Values values = optimizer.optimize();
+        result->num_iters.push_back(optimizer.getInnerIterations());
+        return values;
+      });
+  methods.emplace_back(
+      "penalty",
+      [=](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        PenaltyMethodParameters params(lm_params);
+        return PenaltyMethodOptimizer(params).optimize(
+            problem.costs(), problem.constraints(), problem.initValues(),
+            result);
+      });
+  methods.emplace_back(
+      "augmented_lagrangian",
+      [=](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        AugmentedLagrangianParameters params(lm_params);
+        return AugmentedLagrangianOptimizer(params).optimize(
+            problem.costs(), problem.constraints(), problem.initValues(),
+            result);
+      });
+  methods.emplace_back(
+      "sqp", [](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        return SQPOptimizer().optimize(problem.costs(), problem.constraints(),
+                                       problem.initValues(), result);
+      });
+  methods.emplace_back(
+      "constraint_manifold",
+      [=](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        gtsam::ManifoldOptimizerType1 optimizer(mopt_params, lm_params);
+        return optimizer.optimize(problem.costs(), problem.constraints(),
+                                  problem.initValues(), result);
+      });
+  methods.emplace_back(
+      "constraint_manifold_dogleg",
+      [=](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+        gtsam::ManifoldOptimizerType1 optimizer(mopt_params,
+                                                DoglegParamsFromLM(lm_params));
+        return optimizer.optimize(problem.costs(), problem.constraints(),
+                                  problem.initValues(), result);
+      });
+  if (IpoptOptimizer::Available()) {
+    methods.emplace_back(
+        "ipopt",
+        [](const EqConsOptProblem& problem, ConstrainedOptResult* result) {
+          return IpoptOptimizer().optimize(
+              problem.costs(), problem.constraints(), problem.initValues(),
+              result);
+        });
+  }
+  return methods;
+}
+
+/* ************************************************************************* */
+std::vector<BenchmarkResult> RunBenchmark(
+    const std::string& scenario,
+    const std::function<EqConsOptProblem()>& build_problem,
+    const BenchmarkMethods& methods, size_t repetitions,
+    double constraint_unit_scale) {
+  std::vector<BenchmarkResult> results;
+  for (size_t repetition = 0; repetition < repetitions; repetition++) {
+    Deadline build_timer;
+    const EqConsOptProblem problem = build_problem();
+    const double build_time = build_timer.elapsed();
+
+    for (const auto& name_method : methods) {
+      ConstrainedOptResult intermediate_result;
+      Deadline optimize_timer;
+      const Values values = name_method.second(problem, &intermediate_result);
+      const double optimize_time = optimize_timer.elapsed();
+
+      BenchmarkResult result;
+      result.scenario = scenario;
+      result.method = name_method.first;
+      result.repetition = repetition;
+      result.iterations =
+          std::accumulate(intermediate_result.num_iters.begin(),
+                          intermediate_result.num_iters.end(), 0);
+      result.cost = problem.evaluateCost(values);
+      result.violation = problem.evaluateConstraintViolationL2Norm(values) *
+                         constraint_unit_scale;
+      result.phase_times = intermediate_result.phase_times;
+      result.phase_times["build"] = build_time;
+      result.phase_times["optimize"] = optimize_time;
+      result.counts = intermediate_result.counts;
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+/* ************************************************************************* */
+// Quote a string for CSV or JSON output; names contain no control characters.
+static std::string Quoted(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+/* ************************************************************************* */
+void WriteBenchmarkCsv(const std::vector<BenchmarkResult>& results,
+                       std::ostream& os) {
+  std::set<std::string> phases, events;
+  for (const auto& result : results) {
+    for (const auto& phase_time : result.phase_times) {
+      phases.insert(phase_time.first);
+    }
+    for (const auto& count : result.counts) events.insert(count.first);
+  }
+
+  os << "scenario,method,repetition,iterations,cost,violation";
+  for (const auto& phase : phases) os << ",time_" << phase;
+  for (const auto& event : events) os << ",count_" << event;
+  os << "\n";
+  os << std::setprecision(10);
+  for (const auto& result : results) {
+    os << result.scenario << "," << result.method << "," << result.repetition
+       << "," << result.iterations << "," << result.cost << ","
+       << result.violation;
+    for (const auto& phase : phases) {
+      os << ",";
+      auto it = result.phase_times.find(phase);
+      if (it != result.phase_times.end()) os << it->second;
+    }
+    for (const auto& event : events) {
+      os << ",";
+      auto it = result.counts.find(event);
+      if (it != result.counts.end()) os << it->second;
+    }
+    os << "\n";
+  }
+}
+
+/* ************************************************************************* */
+void WriteBenchmarkJson(const std::vector<BenchmarkResult>& results,
+                        std::ostream& os) {
+  os << std::setprecision(10) << "[";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+    os << (i == 0 ? "\n" : ",\n") << "  {\"scenario\": "
+       << Quoted(result.scenario) << ", \"method\": " << Quoted(result.method)
+       << ", \"repetition\": " << result.repetition
+       << ", \"iterations\": " << result.iterations
+       << ", \"cost\": " << result.cost
+       << ", \"violation\": " << result.violation << ", \"phase_times\": {";
+    bool first = true;
+    for (const auto& phase_time : result.phase_times) {
+      os << (first ? "" : ", ") << Quoted(phase_time.first) << ": "
+         << phase_time.second;
+      first = false;
+    }
+    os << "}, \"counts\": {";
+    first = true;
+    for (const auto& count : result.counts) {
+      os << (first ? "" : ", ") << Quoted(count.first) << ": "
+         << count.second;
+      first = false;
+    }
+    os << "}}";
+  }
+  os << "\n]\n";
+}
+
 }  // namespace gtdynamics
@@ -15,14 +15,23 @@
 
 #include <gtdynamics/manifold/ManifoldOptimizer.h>
 #include <gtdynamics/manifold/ManifoldOptimizerType1.h>
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/IpoptOptimizer.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
 #include <gtsam/base/timing.h>
+#include <gtsam/nonlinear/DoglegOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <functional>
 #include <iostream>
+#include <map>
 #include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 using gtsam::LevenbergMarquardtParams;
 using gtsam::Values;
@@ -44,11 +53,13 @@ gtsam::ManifoldOptimizerParameters DefaultMoptParams();
 /// specifying variables.
 gtsam::ManifoldOptimizerParameters DefaultMoptParamsSV();
 
-/** Run optimization using constraint manifold. */
+/** Run optimization using constraint manifold, with LM or e.g. dogleg
+ * parameters for the manifold optimization problem. */
 Values OptimizeConstraintManifold(
     const EqConsOptProblem &problem, std::ostream &latex_os,
     gtsam::ManifoldOptimizerParameters mopt_params = DefaultMoptParams(),
-    LevenbergMarquardtParams lm_params = LevenbergMarquardtParams(),
+    gtsam::ManifoldOptimizerType1::NonlinearOptParamsVariant nopt_params =
+        LevenbergMarquardtParams(),
     std::string exp_name = "Constraint Manifold",
     double constraint_unit_scale = 1.0);
 
@@ -64,6 +75,70 @@ Values OptimizeAugmentedLagrangian(
     AugmentedLagrangianParameters params = AugmentedLagrangianParameters(),
     double constraint_unit_scale = 1.0);
 
+/** Run constrained optimization using Gauss-Newton SQP. */
+Values OptimizeSQP(const EqConsOptProblem &problem, std::ostream &latex_os,
+                   SQPParameters params = SQPParameters(),
+                   double constraint_unit_scale = 1.0);
+
+/** Run constrained optimization using IPOPT, if compiled in. */
+Values OptimizeIpopt(const EqConsOptProblem &problem, std::ostream &latex_os,
+                     IpoptParameters params = IpoptParameters(),
+                     double constraint_unit_scale = 1.0);
+
+/// Result of one run of a constrained optimization method on a scenario.
+struct BenchmarkResult {
+  std::string scenario, method;
+  size_t repetition = 0;
+  size_t iterations = 0;  // total inner iterations
+  double cost = 0.0, violation = 0.0;
+  /// Wall time in seconds per phase: always "build" (problem construction)
+  /// and "optimize", plus e.g. "linearize", "solve" and "retract" for methods
+  /// that report them.
+  std::map<std::string, double> phase_times;
+  /// Counts of events that methods report, e.g. "skipped_retractions".
+  std::map<std::string, size_t> counts;
+};
+
+/// A method to benchmark: optimize a problem, filling intermediate results.
+using BenchmarkMethod = std::function<Values(const EqConsOptProblem &,
+                                             ConstrainedOptResult *)>;
+using BenchmarkMethods = std::vector<std::pair<std::string, BenchmarkMethod>>;
+
+/// Dogleg parameters with the iterations, tolerances and linear solver of
+/// some LM parameters.
+gtsam::DoglegParams DoglegParamsFromLM(
+    const LevenbergMarquardtParams &lm_params);
+
+/// Soft constraint, penalty, augmented Lagrangian, SQP and constraint manifold
+/// methods, the latter with LM and with dogleg, with default parameters; and
+/// IPOPT, if IpoptOptimizer::Available().
+BenchmarkMethods DefaultBenchmarkMethods(
+    const LevenbergMarquardtParams &lm_params = LevenbergMarquardtParams(),
+    double soft_constraint_mu = 100);
+
+/**
+ * Run each method on a scenario, several times.
+ * @param scenario name of the scenario, copied to the results.
+ * @param build_problem builds the problem, once per repetition.
+ * @param methods named methods to run.
+ * @param repetitions number of runs of each method.
+ * @param constraint_unit_scale scale of the reported violation.
+ */
+std::vector<BenchmarkResult> RunBenchmark(
+    const std::string &scenario,
+    const std::function<EqConsOptProblem()> &build_problem,
+    const BenchmarkMethods &methods, size_t repetitions = 1,
+    double constraint_unit_scale = 1.0);
+
+/// Write results as CSV, with one "time_<phase>" column per phase and one
+/// "count_<event>" column per counted event.
+void WriteBenchmarkCsv(const std::vector<BenchmarkResult> &results,
+                       std::ostream &os);
+
+/// Write results as a JSON array of objects.
+void WriteBenchmarkJson(const std::vector<BenchmarkResult> &results,
+                        std::ostream &os);
+
 /** Functor version of JointLimitFactor, for creating expressions. Compute error
  * for joint limit error, to reproduce joint limit factor in expressions. */
 class JointLimitFunctor {
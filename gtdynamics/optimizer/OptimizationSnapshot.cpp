@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizationSnapshot.cpp
+ * @brief Versioned binary checkpoints of optimization problems.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/OptimizationSnapshot.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+#include <gtsam/base/serialization.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#endif
+
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/// Identifies snapshot files; bump the version when the layout changes.
+static const std::string kSnapshotMagic = "gtdynamics-snapshot";
+static constexpr uint32_t kSnapshotVersion = 1;
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+/* ************************************************************************* */
+// Values and factors are serialized through base class pointers. As for the
+// robot cache, the derived types are registered per archive, in the same
+// order for saving and loading.
+template <class ARCHIVE>
+static void RegisterSnapshotTypes(ARCHIVE &ar) {
+  using gtsam::GenericValue;
+  using gtsam::Pose3;
+  using gtsam::Vector;
+  using gtsam::Vector3;
+  using gtsam::Vector6;
+  ar.template register_type<GenericValue<double>>();
+  ar.template register_type<GenericValue<Vector3>>();
+  ar.template register_type<GenericValue<Vector6>>();
+  ar.template register_type<GenericValue<Vector>>();
+  ar.template register_type<GenericValue<Pose3>>();
+
+  ar.template register_type<gtsam::noiseModel::Gaussian>();
+  ar.template register_type<gtsam::noiseModel::Diagonal>();
+  ar.template register_type<gtsam::noiseModel::Constrained>();
+  ar.template register_type<gtsam::noiseModel::Isotropic>();
+  ar.template register_type<gtsam::noiseModel::Unit>();
+
+  ar.template register_type<gtsam::PriorFactor<double>>();
+  ar.template register_type<gtsam::PriorFactor<Vector3>>();
+  ar.template register_type<gtsam::PriorFactor<Vector6>>();
+  ar.template register_type<gtsam::PriorFactor<Vector>>();
+  ar.template register_type<gtsam::PriorFactor<Pose3>>();
+  ar.template register_type<gtsam::BetweenFactor<double>>();
+  ar.template register_type<gtsam::BetweenFactor<Pose3>>();
+}
+#endif
+
+/* ************************************************************************* */
+void SaveSnapshot(const OptimizationSnapshot &snapshot, std::ostream &os) {
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  boost::archive::binary_oarchive ar(os);
+  RegisterSnapshotTypes(ar);
+  uint32_t version = kSnapshotVersion;
+  ar << kSnapshotMagic << version;
+  ar << snapshot.iterations << snapshot.lambda << snapshot.error;
+  ar << snapshot.values << snapshot.graph;
+#else
+  throw std::runtime_error(
+      "SaveSnapshot: GTDynamics was built without Boost serialization.");
+#endif
+}
+
+/* ************************************************************************* */
+void SaveSnapshot(const OptimizationSnapshot &snapshot,
+                  const std::string &path) {
+  std::ofstream os(path, std::ios::binary);
+  if (!os.good()) {
+    throw std::runtime_error("SaveSnapshot: cannot write " + path);
+  }
+  SaveSnapshot(snapshot, os);
+}
+
+/* ************************************************************************* */
+OptimizationSnapshot LoadSnapshot(std::istream &is) {
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  boost::archive::binary_iarchive ar(is);
+  RegisterSnapshotTypes(ar);
+  std::string magic;
+  uint32_t version;
+  ar >> magic >> version;
+  if (magic != kSnapshotMagic || version != kSnapshotVersion) {
+    throw std::runtime_error("LoadSnapshot: not a snapshot of version " +
+                             std::to_string(kSnapshotVersion));
+  }
+  OptimizationSnapshot snapshot;
+  ar >> snapshot.iterations >> snapshot.lambda >> snapshot.error;
+  ar >> snapshot.values >> snapshot.graph;
+  return snapshot;
+#else
+  throw std::runtime_error(
+      "LoadSnapshot: GTDynamics was built without Boost serialization.");
+#endif
+}
+
+/* ************************************************************************* */
+OptimizationSnapshot LoadSnapshot(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good()) {
+    throw std::runtime_error("LoadSnapshot: no file found at " + path);
+  }
+  return LoadSnapshot(is);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizationSnapshot.h
+ * @brief Versioned binary checkpoints of optimization problems.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * A checkpoint of an optimization problem: the graph, the current values and
+ * the state to resume the optimizer from, e.g. as lambdaInitial and the
+ * remaining maxIterations of Levenberg-Marquardt.
+ *
+ * The graph is only stored if all its factors and noise models support Boost
+ * serialization and are among the registered GTSAM types (priors and between
+ * factors on the value types of dynamics graphs). Graphs of dynamics factors
+ * are cheaper to rebuild than to store, so they can be left empty.
+ */
+struct OptimizationSnapshot {
+  gtsam::NonlinearFactorGraph graph;  ///< factors, or empty to rebuild them
+  gtsam::Values values;               ///< current estimate
+  size_t iterations = 0;              ///< iterations done so far
+  double lambda = 0;                  ///< current damping
+  double error = 0;                   ///< error of the current estimate
+};
+
+/**
+ * Write a snapshot in binary, after a magic string and a format version.
+ * Throws if GTDynamics is built without Boost serialization, or if a factor
+ * or value type is not registered.
+ */
+void SaveSnapshot(const OptimizationSnapshot &snapshot, std::ostream &os);
+
+/// Write a snapshot to a binary file, see SaveSnapshot above.
+void SaveSnapshot(const OptimizationSnapshot &snapshot,
+                  const std::string &path);
+
+/**
+ * Read a snapshot written by SaveSnapshot. Throws std::runtime_error for
+ * files of another format or version, and if GTDynamics is built without
+ * Boost serialization.
+ */
+OptimizationSnapshot LoadSnapshot(std::istream &is);
+
+/// Read a snapshot from a binary file, see LoadSnapshot above.
+OptimizationSnapshot LoadSnapshot(const std::string &path);
+
+}  // namespace gtdynamics
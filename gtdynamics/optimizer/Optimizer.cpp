@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/NewtonOptimizer.h>
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
@@ -23,6 +24,10 @@ using gtsam::Values;
 
 Values Optimizer::optimize(const NonlinearFactorGraph& graph,
                            const Values& initial_values) const {
+  if (p_.second_order) {
+    NewtonOptimizer optimizer(NewtonParameters(p_.lm_parameters));
+    return optimizer.optimize(graph, initial_values);
+  }
   gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
                                                p_.lm_parameters);
   const Values result = optimizer.optimize();
@@ -31,6 +31,7 @@ struct OptimizationParameters {
 
   Method method = Method::SOFT_CONSTRAINTS;       // optimization method
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  bool second_order = false;  // damped Newton instead of LM, same parameters
   OptimizationParameters() {
     lm_parameters.setlambdaInitial(1e7);
     lm_parameters.setAbsoluteErrorTol(1e-3);
@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerLog.cpp
+ * @brief Optimizer log written by a background thread, as CSV or binary.
+ * @author Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/OptimizerLog.h>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+namespace {
+const char kBinaryHeader[8] = "GTDLOG1";
+static_assert(sizeof(OptimizerLogRecord) == 40,
+              "OptimizerLogRecord must be packed for the binary format");
+}  // namespace
+
+/* ************************************************************************* */
+OptimizerLogWriter::OptimizerLogWriter(const std::string &path,
+                                       LogFormat format)
+    : path_(path), format_(format) {
+  const auto mode = format == BinaryLog
+                        ? std::ios::app | std::ios::binary | std::ios::ate
+                        : std::ios::app | std::ios::ate;
+  os_.open(path, mode);
+  if (!os_) {
+    throw std::runtime_error("OptimizerLogWriter: cannot open " + path);
+  }
+  if (format == BinaryLog && os_.tellp() == 0) {
+    os_.write(kBinaryHeader, sizeof(kBinaryHeader));
+  }
+  thread_ = std::thread(&OptimizerLogWriter::run, this);
+}
+
+/* ************************************************************************* */
+OptimizerLogWriter::~OptimizerLogWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queued_cv_.notify_one();
+  thread_.join();
+}
+
+/* ************************************************************************* */
+void OptimizerLogWriter::write(const OptimizerLogRecord &record) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(record);
+    num_queued_++;
+  }
+  queued_cv_.notify_one();
+}
+
+/* ************************************************************************* */
+void OptimizerLogWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_cv_.wait(lock, [this] { return num_written_ == num_queued_; });
+}
+
+/* ************************************************************************* */
+void OptimizerLogWriter::run() {
+  std::vector<OptimizerLogRecord> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+    if (pending_.empty()) break;  // stopped, and all records written
+
+    // Swap the buffers, so write() can go on while this batch is written.
+    std::swap(batch, pending_);
+    lock.unlock();
+    if (format_ == BinaryLog) {
+      os_.write(reinterpret_cast<const char *>(batch.data()),
+                batch.size() * sizeof(OptimizerLogRecord));
+    } else {
+      for (const OptimizerLogRecord &r : batch) {
+        os_ << r.inner_iterations << "," << r.seconds << "," << r.error << ","
+            << r.lambda << "," << r.iterations << "\n";
+      }
+    }
+    os_.flush();
+    lock.lock();
+    num_written_ += batch.size();
+    batch.clear();
+    written_cv_.notify_all();
+  }
+}
+
+/* ************************************************************************* */
+std::vector<OptimizerLogRecord> ReadOptimizerLog(const std::string &path,
+                                                 LogFormat format) {
+  std::ifstream is(path, format == BinaryLog ? std::ios::binary
+                                             : std::ios::in);
+  if (!is) throw std::runtime_error("ReadOptimizerLog: cannot open " + path);
+  std::vector<OptimizerLogRecord> records;
+  if (format == BinaryLog) {
+    char header[sizeof(kBinaryHeader)];
+    if (!is.read(header, sizeof(header)) ||
+        std::memcmp(header, kBinaryHeader, sizeof(header)) != 0) {
+      throw std::runtime_error("ReadOptimizerLog: " + path +
+                               " is not a binary optimizer log");
+    }
+    OptimizerLogRecord record;
+    while (is.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+      records.push_back(record);
+    }
+    return records;
+  }
+
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty()) continue;
+    std::istringstream ss(line);
+    OptimizerLogRecord record;
+    char comma;
+    if (!(ss >> record.inner_iterations >> comma >> record.seconds >> comma >>
+          record.error >> comma >> record.lambda >> comma >>
+          record.iterations)) {
+      throw std::runtime_error("ReadOptimizerLog: bad line in " + path);
+    }
+    records.push_back(record);
+  }
+  return records;
+}
+
+}  // namespace gtdynamics
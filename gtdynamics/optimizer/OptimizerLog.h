@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerLog.h
+ * @brief Optimizer log written by a background thread, as CSV or binary.
+ * @author Frank Dellaert
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Format of an optimizer log file.
+enum LogFormat {
+  CsvLog,    ///< one text line per record, comma separated, as GTSAM's LM
+  BinaryLog  ///< a header, then fixed-size native-endian records
+};
+
+/// One record of the optimizer log, at one inner iteration.
+struct OptimizerLogRecord {
+  uint64_t inner_iterations = 0;
+  double seconds = 0.0;  ///< wall time since the start of the optimization
+  double error = 0.0;
+  double lambda = 0.0;
+  uint64_t iterations = 0;  ///< outer iterations
+};
+
+/**
+ * OptimizerLogWriter appends log records to a file from a background thread,
+ * so that the optimizer only copies each record into a buffer. Records are
+ * written in order, in batches; flush() waits until all records so far are
+ * in the file, and the destructor writes the remaining ones.
+ *
+ * CSV files have the columns of LevenbergMarquardtOptimizer's log file:
+ * inner iterations, seconds, error, lambda and outer iterations. Binary files
+ * start with the 8-byte header "GTDLOG1", and have one OptimizerLogRecord of
+ * 40 bytes per record after it; see ReadOptimizerLog.
+ */
+class OptimizerLogWriter {
+ public:
+  /// Open path for appending, and start the writer thread.
+  explicit OptimizerLogWriter(const std::string &path,
+                              LogFormat format = CsvLog);
+
+  /// Write the remaining records, and stop the thread.
+  ~OptimizerLogWriter();
+
+  OptimizerLogWriter(const OptimizerLogWriter &) = delete;
+  OptimizerLogWriter &operator=(const OptimizerLogWriter &) = delete;
+
+  /// Queue a record, without waiting for the file.
+  void write(const OptimizerLogRecord &record);
+
+  /// Wait until all queued records are written and flushed to the file.
+  void flush();
+
+  /// Return the path and format of the file.
+  const std::string &path() const { return path_; }
+  LogFormat format() const { return format_; }
+
+ private:
+  std::string path_;
+  LogFormat format_;
+  std::ofstream os_;
+
+  std::mutex mutex_;
+  std::condition_variable queued_cv_, written_cv_;
+  std::vector<OptimizerLogRecord> pending_;
+  size_t num_queued_ = 0, num_written_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
+
+  /// Writer thread: write batches of pending records until stopped.
+  void run();
+};
+
+/// Read the records of a CSV or binary log file, e.g. to plot convergence.
+std::vector<OptimizerLogRecord> ReadOptimizerLog(const std::string &path,
+                                                 LogFormat format = CsvLog);
+
+}  // namespace gtdynamics
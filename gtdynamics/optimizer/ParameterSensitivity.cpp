@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParameterSensitivity.cpp
+ * @brief Gradients of optimal costs with respect to model parameters.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/ParameterSensitivity.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace {
+/// Whitened errors of the NoiseModelFactors of graph, in order.
+std::vector<Vector> WhitenedErrors(const NonlinearFactorGraph &graph,
+                                   const gtsam::Values &values) {
+  std::vector<Vector> errors;
+  errors.reserve(graph.size());
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    auto noise_factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (!noise_factor) {
+      throw std::invalid_argument(
+          "CostGradient: all factors must be NoiseModelFactors.");
+    }
+    errors.push_back(noise_factor->whitenedError(values));
+  }
+  return errors;
+}
+}  // namespace
+
+/* ************************************************************************* */
+CostSensitivity CostGradient(const ParametricGraphFunction &graph,
+                             const Vector &params,
+                             const gtsam::Values &solution,
+                             const ParametricGraphFunction &cost,
+                             double step) {
+  const Eigen::Index num_params = params.size();
+  const NonlinearFactorGraph nominal = graph(params);
+  const NonlinearFactorGraph nominal_cost = cost ? cost(params) : nominal;
+
+  // Linearization at the solution, one whitened Jacobian factor per factor.
+  gtsam::GaussianFactorGraph linear;
+  std::vector<gtsam::JacobianFactor::shared_ptr> jacobians;
+  for (auto &&factor : nominal) {
+    if (!factor) continue;
+    auto jacobian = std::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        factor->linearize(solution));
+    if (!jacobian) {
+      throw std::invalid_argument(
+          "CostGradient: factors must linearize to Jacobian factors.");
+    }
+    jacobians.push_back(jacobian);
+    linear.push_back(jacobian);
+  }
+
+  // Adjoint lambda = (A^T A)^-1 dc/dx, from R^T R = A^T A of the Bayes net.
+  VectorValues dc_dx = linear.gradientAtZero();
+  dc_dx.setZero();
+  if (cost) {
+    const VectorValues g = nominal_cost.linearize(solution)->gradientAtZero();
+    for (auto &&[key, value] : g) {
+      if (!dc_dx.exists(key)) {
+        throw std::invalid_argument(
+            "CostGradient: the cost has a variable the graph does not have.");
+      }
+      dc_dx.at(key) = value;
+    }
+  }
+  const auto bayes_net = linear.eliminateSequential();
+  const VectorValues lambda =
+      bayes_net->backSubstitute(bayes_net->backSubstituteTranspose(dc_dx));
+  std::vector<Vector> A_lambda;
+  A_lambda.reserve(jacobians.size());
+  for (auto &&jacobian : jacobians) A_lambda.push_back(*jacobian * lambda);
+
+  CostSensitivity result;
+  result.cost = nominal_cost.error(solution);
+  result.gradient.resize(num_params);
+  result.direct.resize(num_params);
+  for (Eigen::Index i = 0; i < num_params; i++) {
+    Vector plus = params, minus = params;
+    plus(i) += step;
+    minus(i) -= step;
+    const NonlinearFactorGraph graph_plus = graph(plus),
+                               graph_minus = graph(minus);
+    const std::vector<Vector> r_plus = WhitenedErrors(graph_plus, solution),
+                              r_minus = WhitenedErrors(graph_minus, solution);
+    if (r_plus.size() != A_lambda.size() ||
+        r_minus.size() != A_lambda.size()) {
+      throw std::invalid_argument(
+          "CostGradient: the graph has other factors for other parameters.");
+    }
+
+    result.direct(i) =
+        cost ? (cost(plus).error(solution) - cost(minus).error(solution)) /
+                   (2 * step)
+             : (graph_plus.error(solution) - graph_minus.error(solution)) /
+                   (2 * step);
+    double adjoint = 0;
+    for (size_t f = 0; f < A_lambda.size(); f++) {
+      adjoint += A_lambda[f].dot(r_plus[f] - r_minus[f]) / (2 * step);
+    }
+    result.gradient(i) = result.direct(i) - adjoint;
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
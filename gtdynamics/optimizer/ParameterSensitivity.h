@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParameterSensitivity.h
+ * @brief Gradients of optimal costs with respect to model parameters.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+
+namespace gtdynamics {
+
+/// Factor graph for design parameters, e.g. link lengths or actuator sizes.
+using ParametricGraphFunction =
+    std::function<gtsam::NonlinearFactorGraph(const gtsam::Vector &)>;
+
+/// Result of CostGradient.
+struct CostSensitivity {
+  double cost = 0;         // cost at the solution
+  gtsam::Vector gradient;  // total derivative, the solution moving along
+  gtsam::Vector direct;    // partial derivative, at the fixed solution
+};
+
+/**
+ * Gradient of the cost of an optimal trajectory with respect to design
+ * parameters, from the converged linearization of its graph, instead of
+ * one optimization per parameter with finite differences.
+ *
+ * By the implicit function theorem on the Gauss-Newton optimality
+ * conditions A^T r = 0, the solution moves with the parameters as
+ * dx/dp = -(A^T A)^-1 A^T dr/dp, for the whitened Jacobian A and residuals r
+ * of the graph. The graph is eliminated into a Bayes net once, and the
+ * adjoint lambda = (A^T A)^-1 dc/dx of the cost c is found by one back
+ * substitution and one transposed back substitution, so that
+ *   dc/dp = partial c/partial p - (A lambda)^T dr/dp
+ * for all parameters at once. If the cost is the graph itself, dc/dx is
+ * zero at the solution and the gradient is the partial derivative. As the
+ * Gauss-Newton Hessian A^T A is used, the gradient is exact for residuals
+ * that are zero, or linear in the variables, at the solution.
+ *
+ * The derivatives of the residuals with respect to the parameters are
+ * central differences of the factor errors, which only needs the graph,
+ * e.g. with a RobotParameters block changed in place, but no optimization.
+ * The graphs must have the same NoiseModelFactors in the same order for all
+ * parameters.
+ * @param graph    the optimized graph, for given parameters
+ * @param params   the parameters graph was optimized with
+ * @param solution the converged solution
+ * @param cost     the cost of interest, e.g. objectives only, or empty for
+ *                 the error of graph
+ * @param step     step of the central differences in the parameters
+ */
+CostSensitivity CostGradient(const ParametricGraphFunction &graph,
+                             const gtsam::Vector &params,
+                             const gtsam::Values &solution,
+                             const ParametricGraphFunction &cost = {},
+                             double step = 1e-6);
+
+}  // namespace gtdynamics
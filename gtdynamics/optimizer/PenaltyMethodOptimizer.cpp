@@ -11,20 +11,35 @@
  * @author: Yetong Zhang
  */
 
+#include <gtdynamics/optimizer/ConstraintViolations.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 namespace gtdynamics {
 
 gtsam::Values PenaltyMethodOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
-    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    const EqualityConstraints& unscaled_constraints,
+    const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
-  gtsam::Values values = initial_values;
+  const EqualityConstraints constraints =
+      ScaleConstraints(unscaled_constraints, initial_values, p_.scaling);
+  gtsam::Values values =
+      RestoreFeasibility(constraints, InequalityConstraints(), initial_values,
+                         p_.restoration, intermediate_result);
   double mu = p_.initial_mu;
+  const size_t threads = p_.evaluation_threads;
+  double violation = ConstraintViolations(constraints, values, threads).norm();
+  gtsam::LevenbergMarquardtParams lm_parameters =
+      ScaleVariables(p_.lm_parameters, p_.scaling);
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
   for (int i = 0; i < p_.num_iterations; i++) {
+    const auto start = std::chrono::steady_clock::now();
     gtsam::NonlinearFactorGraph merit_graph = graph;
 
     // Create factors corresponding to penalty terms of constraints.
@@ -32,21 +47,40 @@ gtsam::Values PenaltyMethodOptimizer::optimize(
       merit_graph.add(constraint->createFactor(mu));
     }
 
-    // Run optimization.
+    // Loosen the inner solve while mu is small.
+    if (p_.inner_relative_tolerance > 0) {
+      lm_parameters.relativeErrorTol =
+          std::max(p_.lm_parameters.relativeErrorTol,
+                   p_.inner_relative_tolerance * p_.initial_mu / mu);
+    }
+
+    // Run optimization, warm-started from the previous result.
     gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
+                                                 lm_parameters);
     auto result = optimizer.optimize();
 
     // Save results and update parameters.
     values = result;
-    mu *= p_.mu_increase_rate;
+    const double new_violation =
+        ConstraintViolations(constraints, values, threads).norm();
+    if (p_.adaptive_mu && new_violation > p_.violation_reduction * violation) {
+      mu *= p_.max_mu_increase_rate;
+    } else {
+      mu *= p_.mu_increase_rate;
+    }
+    violation = new_violation;
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
       intermediate_result->intermediate_values.push_back(values);
       intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
       intermediate_result->mu_values.push_back(mu);
+      intermediate_result->times.push_back(elapsed.count());
     }
+
+    if (violation < p_.feasibility_tolerance) break;
   }
   return values;
 }
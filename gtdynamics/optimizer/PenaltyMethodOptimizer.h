@@ -24,6 +24,22 @@ struct PenaltyMethodParameters : public ConstrainedOptimizationParameters {
   double initial_mu;        // initial penalty parameter
   double mu_increase_rate;  // increase rate of penalty parameter
 
+  /// Adaptive schedule: mu grows by mu_increase_rate while the constraint
+  /// violation shrinks by violation_reduction per outer iteration, and by
+  /// max_mu_increase_rate when it does not.
+  bool adaptive_mu = false;
+  double violation_reduction = 0.25;
+  double max_mu_increase_rate = 10.0;
+
+  /// Stop once the tolerance-scaled constraint violation (L2 norm) is below
+  /// this value; 0 always runs num_iterations.
+  double feasibility_tolerance = 0.0;
+
+  /// If positive, inner LM solves stop at relative error tolerance
+  /// max(lm_parameters.relativeErrorTol, inner_relative_tolerance *
+  /// initial_mu / mu), so the early, low-mu solves are loose.
+  double inner_relative_tolerance = 0.0;
+
   /** Constructor. */
   PenaltyMethodParameters()
       : Base(gtsam::LevenbergMarquardtParams()),
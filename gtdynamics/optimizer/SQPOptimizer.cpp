@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.cpp
+ * @brief Gauss-Newton sequential quadratic programming routines.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::GaussianFactorGraph SQPOptimizer::linearizedSystem(
+    const gtsam::NonlinearFactorGraph& graph,
+    const gtsam::NonlinearFactorGraph& constraint_graph,
+    const gtsam::Values& values) const {
+  gtsam::GaussianFactorGraph linear = *graph.linearize(values);
+
+  if (p_.damping > 0) {
+    const double sqrt_lambda = std::sqrt(p_.damping);
+    for (const auto& key_dim : values.dims()) {
+      const size_t dim = key_dim.second;
+      linear.emplace_shared<gtsam::JacobianFactor>(
+          key_dim.first, sqrt_lambda * gtsam::Matrix::Identity(dim, dim),
+          gtsam::Vector::Zero(dim));
+    }
+  }
+
+  // The whitened linearized constraint J dx = -h(x)/tolerance is imposed
+  // exactly, by giving it a Constrained noise model.
+  for (const auto& factor : constraint_graph) {
+    auto jacobian = std::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        factor->linearize(values));
+    if (!jacobian) {
+      throw std::runtime_error("SQPOptimizer: constraint is not a Jacobian");
+    }
+    std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      terms.emplace_back(*it, jacobian->getA(it));
+    }
+    linear.emplace_shared<gtsam::JacobianFactor>(
+        terms, jacobian->getb(),
+        gtsam::noiseModel::Constrained::All(jacobian->rows()));
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+double SQPOptimizer::merit(const gtsam::NonlinearFactorGraph& graph,
+                           const EqualityConstraints& constraints,
+                           const gtsam::Values& values) const {
+  const double violation =
+      ConstraintViolations(constraints, values, p_.evaluation_threads)
+          .l1Norm();
+  return graph.error(values) + p_.merit_weight * violation;
+}
+
+/* ************************************************************************* */
+gtsam::Values SQPOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  gtsam::Values values = initial_values;
+
+  // Factors whose whitened errors are h(x)/tolerance, or equilibrated rows
+  // if scaling is enabled.
+  gtsam::NonlinearFactorGraph constraint_graph;
+  for (const auto& constraint :
+       ScaleConstraints(constraints, initial_values, p_.scaling)) {
+    constraint_graph.add(constraint->createFactor(1.0));
+  }
+
+  double current_merit = merit(graph, constraints, values);
+  for (size_t i = 0; i < p_.max_iterations; i++) {
+    // Solve the KKT system; QR elimination handles the hard constraint rows.
+    Deadline timer;
+    const gtsam::GaussianFactorGraph linear =
+        linearizedSystem(graph, constraint_graph, values);
+    const double linearize_time = timer.elapsed();
+    const gtsam::VectorValues delta = linear.optimize(gtsam::EliminateQR);
+    const double solve_time = timer.elapsed() - linearize_time;
+
+    // Backtracking line search on the merit function.
+    double alpha = 1.0;
+    gtsam::Values new_values = values.retract(delta);
+    double new_merit = merit(graph, constraints, new_values);
+    size_t num_steps = 1;
+    while (new_merit > current_merit && num_steps < p_.max_line_search_steps) {
+      alpha *= p_.line_search_decrease;
+      new_values = values.retract(alpha * delta);
+      new_merit = merit(graph, constraints, new_values);
+      num_steps++;
+    }
+    if (intermediate_result != nullptr) {
+      intermediate_result->addPhaseTime("linearize", linearize_time);
+      intermediate_result->addPhaseTime("solve", solve_time);
+      // The line search time: retractions and merit evaluations.
+      intermediate_result->addPhaseTime(
+          "retract", timer.elapsed() - linearize_time - solve_time);
+    }
+    if (new_merit > current_merit) break;  // No descent along the step.
+
+    values = new_values;
+    current_merit = new_merit;
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      intermediate_result->intermediate_values.push_back(values);
+      intermediate_result->num_iters.push_back(1);
+      intermediate_result->mu_values.push_back(p_.merit_weight);
+    }
+
+    if (alpha * delta.norm() < p_.step_tolerance) break;
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
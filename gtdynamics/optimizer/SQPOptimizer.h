@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.h
+ * @brief Gauss-Newton sequential quadratic programming for equality
+ * constrained optimization.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+namespace gtdynamics {
+
+/// Parameters for the SQP method.
+struct SQPParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t max_iterations = 50;  // maximum number of SQP iterations
+  /// Weight of the constraint violation (L1 norm, tolerance-scaled) in the
+  /// merit function used for line search.
+  double merit_weight = 100.0;
+  double step_tolerance = 1e-8;  // stop when the step norm is below this
+  double line_search_decrease = 0.5;  // step size reduction per trial
+  size_t max_line_search_steps = 20;
+  /// If positive, add Levenberg damping priors with this lambda to the costs,
+  /// for problems whose costs do not constrain all variables.
+  double damping = 0.0;
+
+  /** Constructor. */
+  SQPParameters() : Base(gtsam::LevenbergMarquardtParams()) {}
+};
+
+/**
+ * Gauss-Newton SQP for equality constraints. Each iteration solves the KKT
+ * system of the linearized costs and constraints by eliminating one Gaussian
+ * factor graph, in which the linearized constraints are hard (Constrained
+ * noise model) rows, and then does a backtracking line search on the merit
+ * function cost(x) + merit_weight * |h(x)|_1.
+ */
+class SQPOptimizer : public ConstrainedOptimizer {
+ protected:
+  const SQPParameters p_;
+
+ public:
+  /** Default constructor. */
+  SQPOptimizer() : p_(SQPParameters()) {}
+
+  /** Construct from parameters. */
+  SQPOptimizer(const SQPParameters& parameters) : p_(parameters) {}
+
+  /// Run optimization.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /// Linear system of one iteration: linearized costs and hard linearized
+  /// constraints, at values.
+  gtsam::GaussianFactorGraph linearizedSystem(
+      const gtsam::NonlinearFactorGraph& graph,
+      const gtsam::NonlinearFactorGraph& constraint_graph,
+      const gtsam::Values& values) const;
+
+  /// Merit function of the line search.
+  double merit(const gtsam::NonlinearFactorGraph& graph,
+               const EqualityConstraints& constraints,
+               const gtsam::Values& values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,265 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseLinearSolver.cpp
+ * @brief Sparse Cholesky backends for the linear systems of optimizers.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/SparseLinearSolver.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/SparseCholesky>
+#ifdef GTDYNAMICS_USE_CHOLMOD
+#include <Eigen/CholmodSupport>
+#endif
+#ifdef GTDYNAMICS_USE_PARDISO
+#include <Eigen/PardisoSupport>
+#endif
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace gtdynamics {
+
+using SpMatrix = Eigen::SparseMatrix<double>;
+
+/* ************************************************************************* */
+VectorValues SparseNormalEquations::unpack(const Vector &x) const {
+  VectorValues result;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    result.insert(keys[i], x.segment(offsets[i], offsets[i + 1] - offsets[i]));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+SparseNormalEquations AssembleNormalEquations(
+    const GaussianFactorGraph &graph) {
+  // Columns of the variables, in key order.
+  std::map<Key, size_t> dims;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      dims[*it] = factor->getDim(it);
+    }
+  }
+  SparseNormalEquations system;
+  std::map<Key, size_t> column;
+  system.offsets.push_back(0);
+  for (const auto &[key, dim] : dims) {
+    column[key] = system.offsets.back();
+    system.keys.push_back(key);
+    system.offsets.push_back(system.offsets.back() + dim);
+  }
+  const size_t n = system.offsets.back();
+
+  // Scatter the dense information of each factor; setFromTriplets sums the
+  // entries of variables shared by several factors. Zeros are kept, so the
+  // pattern only depends on the keys of the factors.
+  std::vector<Eigen::Triplet<double>> triplets;
+  system.g = Vector::Zero(n);
+  std::vector<size_t> columns;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    auto jacobian = std::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+    if (jacobian && jacobian->isConstrained()) {
+      throw std::invalid_argument(
+          "AssembleNormalEquations: constrained noise models need "
+          "elimination");
+    }
+    const gtsam::Matrix information = factor->augmentedInformation();
+    const size_t m = information.rows() - 1;
+
+    // Column of each row of the factor's information matrix.
+    columns.clear();
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      const size_t start = column.at(*it);
+      for (size_t c = 0; c < dims.at(*it); ++c) columns.push_back(start + c);
+    }
+    for (size_t r = 0; r < m; ++r) {
+      system.g(columns[r]) += information(r, m);
+      for (size_t c = 0; c < m; ++c) {
+        triplets.emplace_back(columns[r], columns[c], information(r, c));
+      }
+    }
+  }
+  system.H.resize(n, n);
+  system.H.setFromTriplets(triplets.begin(), triplets.end());
+  return system;
+}
+
+/* ************************************************************************* */
+struct SparseLinearSolver::Factorization {
+  virtual ~Factorization() = default;
+  virtual void analyzePattern(const SparseNormalEquations &system) = 0;
+  /// Return false if the system is not positive definite.
+  virtual bool factorize(const SparseNormalEquations &system) = 0;
+  virtual Vector solve(const SparseNormalEquations &system,
+                       size_t *iterations) = 0;
+};
+
+namespace {
+template <class SOLVER>
+struct EigenFactorization : public SparseLinearSolver::Factorization {
+  SOLVER solver;
+  void analyzePattern(const SparseNormalEquations &system) override {
+    solver.analyzePattern(system.H);
+  }
+  bool factorize(const SparseNormalEquations &system) override {
+    solver.factorize(system.H);
+    return solver.info() == Eigen::Success;
+  }
+  Vector solve(const SparseNormalEquations &system,
+               size_t *iterations) override {
+    *iterations = 0;
+    return solver.solve(system.g);
+  }
+};
+
+// Conjugate gradient preconditioned by the blocks of variables with the same
+// time step, which are factored together but do not fill in between steps.
+struct BlockJacobiPcg : public SparseLinearSolver::Factorization {
+  PcgParameters parameters;
+  std::vector<uint64_t> times;  ///< time step of each column
+  Eigen::SimplicialLDLT<SpMatrix> blocks;
+
+  explicit BlockJacobiPcg(const PcgParameters &parameters)
+      : parameters(parameters) {}
+
+  SpMatrix blockDiagonal(const SpMatrix &H) const {
+    SpMatrix B = H;
+    B.prune([this](Eigen::Index row, Eigen::Index col, double) {
+      return times[row] == times[col];
+    });
+    return B;
+  }
+
+  void analyzePattern(const SparseNormalEquations &system) override {
+    times.resize(system.offsets.back());
+    for (size_t i = 0; i < system.keys.size(); ++i) {
+      const uint64_t t = DynamicsSymbol(system.keys[i]).time();
+      for (size_t c = system.offsets[i]; c < system.offsets[i + 1]; ++c) {
+        times[c] = t;
+      }
+    }
+    blocks.analyzePattern(blockDiagonal(system.H));
+  }
+
+  bool factorize(const SparseNormalEquations &system) override {
+    blocks.factorize(blockDiagonal(system.H));
+    return blocks.info() == Eigen::Success;
+  }
+
+  Vector solve(const SparseNormalEquations &system,
+               size_t *iterations) override {
+    const SpMatrix &H = system.H;
+    const Vector &g = system.g;
+    const size_t max_iterations = parameters.max_iterations > 0
+                                      ? parameters.max_iterations
+                                      : static_cast<size_t>(g.size());
+    const double tolerance = parameters.relative_tolerance * g.norm();
+    Vector x = Vector::Zero(g.size()), r = g;
+    Vector z = blocks.solve(r), p = z;
+    double rz = r.dot(z);
+    *iterations = 0;
+    while (r.norm() > tolerance && *iterations < max_iterations) {
+      const Vector Hp = H * p;
+      const double pHp = p.dot(Hp);
+      if (pHp <= 0.0) {
+        throw gtsam::IndeterminantLinearSystemException(system.keys.front());
+      }
+      const double alpha = rz / pHp;
+      x += alpha * p;
+      r -= alpha * Hp;
+      z = blocks.solve(r);
+      const double rz_next = r.dot(z);
+      p = z + (rz_next / rz) * p;
+      rz = rz_next;
+      ++*iterations;
+    }
+    return x;
+  }
+};
+}  // namespace
+
+/* ************************************************************************* */
+bool SparseLinearSolver::Available(LinearSolverBackend backend) {
+  switch (backend) {
+    case SimplicialBackend:
+    case PcgBackend:
+      return true;
+#ifdef GTDYNAMICS_USE_CHOLMOD
+    case CholmodBackend:
+      return true;
+#endif
+#ifdef GTDYNAMICS_USE_PARDISO
+    case PardisoBackend:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+/* ************************************************************************* */
+SparseLinearSolver::SparseLinearSolver(LinearSolverBackend backend,
+                                       const PcgParameters &pcg)
+    : backend_(backend) {
+  switch (backend) {
+    case PcgBackend:
+      factorization_ = std::make_shared<BlockJacobiPcg>(pcg);
+      break;
+    case SimplicialBackend:
+      factorization_ = std::make_shared<
+          EigenFactorization<Eigen::SimplicialLDLT<SpMatrix>>>();
+      break;
+#ifdef GTDYNAMICS_USE_CHOLMOD
+    case CholmodBackend:
+      factorization_ = std::make_shared<
+          EigenFactorization<Eigen::CholmodSupernodalLLT<SpMatrix>>>();
+      break;
+#endif
+#ifdef GTDYNAMICS_USE_PARDISO
+    case PardisoBackend:
+      factorization_ = std::make_shared<
+          EigenFactorization<Eigen::PardisoLLT<SpMatrix>>>();
+      break;
+#endif
+    default:
+      throw std::invalid_argument(
+          "SparseLinearSolver: backend " + std::to_string(backend) +
+          " is not a sparse backend, or was not compiled in");
+  }
+}
+
+/* ************************************************************************* */
+VectorValues SparseLinearSolver::solve(const GaussianFactorGraph &graph) {
+  const SparseNormalEquations system = AssembleNormalEquations(graph);
+  if (system.keys.empty()) return VectorValues();
+  if (system.keys != keys_ || system.H.nonZeros() != non_zeros_) {
+    factorization_->analyzePattern(system);
+    keys_ = system.keys;
+    non_zeros_ = system.H.nonZeros();
+  }
+  if (!factorization_->factorize(system)) {
+    throw gtsam::IndeterminantLinearSystemException(system.keys.front());
+  }
+  return system.unpack(factorization_->solve(system, &iterations_));
+}
+
+}  // namespace gtdynamics
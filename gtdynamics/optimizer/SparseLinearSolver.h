@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SparseLinearSolver.h
+ * @brief Sparse Cholesky backends for the linear systems of optimizers.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <Eigen/Sparse>
+
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Backend solving the linear systems of MutableLMOptimizer.
+ *
+ * EliminationBackend is GTSAM's elimination, multifrontal or sequential as
+ * set by linearSolverType, or SubgraphSolver or PCGSolver if linearSolverType
+ * is Iterative with SubgraphSolverParameters or PCGSolverParameters as
+ * iterativeParams. The other backends factor the sparse normal equations with
+ * a fill-reducing ordering of their own. CholmodBackend needs
+ * GTDYNAMICS_WITH_CHOLMOD and PardisoBackend GTDYNAMICS_WITH_PARDISO.
+ * PcgBackend solves the normal equations iteratively, see PcgParameters.
+ */
+enum LinearSolverBackend {
+  EliminationBackend,  ///< GTSAM elimination or iterative solvers
+  SimplicialBackend,   ///< Eigen's simplicial LDLT
+  CholmodBackend,      ///< SuiteSparse CHOLMOD supernodal LLT
+  PardisoBackend,      ///< Intel MKL PARDISO LLT
+  PcgBackend           ///< conjugate gradient, block-Jacobi by time step
+};
+
+/**
+ * Parameters of PcgBackend: conjugate gradient on the normal equations,
+ * preconditioned by their block diagonal with one block per time step, i.e.
+ * the entries between variables with the same DynamicsSymbol::time(). Each
+ * block is factored on its own, so unlike elimination of the whole
+ * trajectory the memory is linear in the number of time steps.
+ */
+struct PcgParameters {
+  /// Stop when the residual norm is below this fraction of the norm of g.
+  double relative_tolerance = 1e-10;
+
+  /// Largest number of iterations, 0 for the number of unknowns.
+  size_t max_iterations = 0;
+};
+
+/// Normal equations H x = g of a Gaussian factor graph, by variable.
+struct SparseNormalEquations {
+  Eigen::SparseMatrix<double> H;  ///< symmetric, both triangles stored
+  gtsam::Vector g;
+  gtsam::KeyVector keys;        ///< variables, in column order
+  std::vector<size_t> offsets;  ///< first column of each variable, and size
+
+  /// Split a solution into the variables.
+  gtsam::VectorValues unpack(const gtsam::Vector &x) const;
+};
+
+/**
+ * Assemble the normal equations of a graph of Jacobian and Hessian factors,
+ * with the variables in key order.
+ * @throws std::invalid_argument for factors with constrained noise models,
+ * which only elimination handles.
+ */
+SparseNormalEquations AssembleNormalEquations(
+    const gtsam::GaussianFactorGraph &graph);
+
+/**
+ * Sparse Cholesky solve of a Gaussian factor graph with one of the sparse
+ * backends. The symbolic analysis is kept while the variables and the
+ * sparsity pattern stay the same, so damped systems which only differ in
+ * lambda are only factored numerically.
+ */
+class SparseLinearSolver {
+ public:
+  /// @throws std::invalid_argument if the backend is not available.
+  explicit SparseLinearSolver(LinearSolverBackend backend,
+                              const PcgParameters &pcg = PcgParameters());
+
+  /// Whether a sparse backend was compiled in.
+  static bool Available(LinearSolverBackend backend);
+
+  /**
+   * Solve the least-squares problem of a graph.
+   * @throws gtsam::IndeterminantLinearSystemException if the normal equations
+   * are not positive definite.
+   */
+  gtsam::VectorValues solve(const gtsam::GaussianFactorGraph &graph);
+
+  LinearSolverBackend backend() const { return backend_; }
+
+  /// Number of iterations of the last PcgBackend solve.
+  size_t iterations() const { return iterations_; }
+
+  /// Symbolic and numeric factorization of a backend.
+  struct Factorization;
+
+ private:
+  LinearSolverBackend backend_;
+  std::shared_ptr<Factorization> factorization_;
+  gtsam::KeyVector keys_;  ///< variables of the analyzed pattern
+  Eigen::Index non_zeros_ = -1;
+  size_t iterations_ = 0;
+};
+
+}  // namespace gtdynamics
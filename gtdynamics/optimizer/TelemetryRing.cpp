@@ -0,0 +1,396 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TelemetryRing.cpp
+ * @brief Lock-free shared-memory ring of optimizer iterations, for live
+ * monitoring from another process.
+ * @author Frank Dellaert
+ */
+
+#include <gtdynamics/optimizer/TelemetryRing.h>
+#include <gtdynamics/utils/JsonSaver.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+namespace {
+/*
+ * Layout of a ring: a header, the keys and tangent dimensions of the
+ * published variables as uint64, then capacity slots. A slot has a sequence
+ * number, the metrics and the values. Sample n goes to slot n % capacity;
+ * its sequence number is 2n + 1 while it is written and 2n + 2 once done, so
+ * a reader knows whether the copy it made is intact.
+ *
+ * The magic carries the layout version and is stored last, with release
+ * semantics, so a reader that loads it with acquire semantics sees the whole
+ * layout. The header also holds the process id of the publisher, or 0 once
+ * it is gone, so that a new publisher only replaces a stale ring.
+ */
+const uint64_t kMagic = 0x47544454454c0002;  // "GTDTEL", version 2
+const size_t kAlignment = 64;                // one cache line
+
+struct RingHeader {
+  std::atomic<uint64_t> magic;
+  std::atomic<uint64_t> pid;  // process of the publisher, 0 once destroyed
+  uint64_t capacity;
+  uint64_t num_keys;
+  uint64_t payload_size;  // doubles per slot
+  uint64_t slot_size;     // bytes per slot
+  std::atomic<uint64_t> head;  // number of published samples
+};
+
+struct SlotHeader {
+  std::atomic<uint64_t> sequence;
+  uint64_t iteration;
+  double seconds, cost, violation;
+  uint64_t has_values;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "TelemetryRing needs lock-free atomics in shared memory");
+
+size_t Aligned(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+size_t SlotsOffset(size_t num_keys) {
+  return Aligned(sizeof(RingHeader) + 2 * num_keys * sizeof(uint64_t));
+}
+
+std::string ShmName(const std::string &name) {
+  return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+#ifndef _WIN32
+/// Remove the ring of a publisher that crashed or was destroyed without
+/// unlinking; throw if the name is used by a running publisher, or by shared
+/// memory that is not a telemetry ring.
+void RemoveStaleRing(const std::string &name) {
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return;  // removed in the meantime
+  bool is_ring = false;
+  uint64_t pid = 0;
+  struct stat st;
+  if (::fstat(fd, &st) == 0 &&
+      static_cast<size_t>(st.st_size) >= sizeof(RingHeader)) {
+    void *mapping =
+        ::mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) {
+      auto header = static_cast<const RingHeader *>(mapping);
+      is_ring = header->magic.load(std::memory_order_acquire) == kMagic;
+      pid = header->pid.load(std::memory_order_relaxed);
+      ::munmap(mapping, sizeof(RingHeader));
+    }
+  }
+  ::close(fd);
+  if (!is_ring) {
+    throw std::runtime_error("TelemetryPublisher: " + name +
+                             " exists and is not a telemetry ring.");
+  }
+  if (pid != 0 &&
+      (::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM)) {
+    throw std::runtime_error("TelemetryPublisher: " + name +
+                             " is in use by process " + std::to_string(pid) +
+                             ".");
+  }
+  ::shm_unlink(name.c_str());
+}
+#endif
+}  // namespace
+
+/* ************************************************************************* */
+TelemetryPublisher::TelemetryPublisher(const std::string &name,
+                                       const TelemetryParameters &params,
+                                       const gtsam::Values &reference)
+    : name_(ShmName(name)), params_(params) {
+  if (params_.capacity == 0) {
+    throw std::invalid_argument("TelemetryPublisher: capacity is 0.");
+  }
+  if (params_.value_decimation > 0) {
+    if (params_.keys.empty()) params_.keys = reference.keys();
+    for (gtsam::Key key : params_.keys) {
+      reference_.insert(key, reference.at(key));
+      dims_.push_back(reference.at(key).dim());
+      payload_size_ += dims_.back();
+    }
+  } else {
+    params_.keys.clear();
+  }
+  payload_.resize(payload_size_);
+  slot_size_ = Aligned(sizeof(SlotHeader) + payload_size_ * sizeof(double));
+  const size_t slots_offset = SlotsOffset(params_.keys.size());
+  size_ = slots_offset + params_.capacity * slot_size_;
+
+#ifdef _WIN32
+  throw std::runtime_error(
+      "TelemetryPublisher: shared memory is not supported on Windows.");
+#else
+  // A stale ring of a crashed solve is replaced, not reused; a ring in use
+  // is left alone. Retry once, in case another publisher removed it first.
+  int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  for (int attempt = 0; fd < 0 && errno == EEXIST && attempt < 2; attempt++) {
+    RemoveStaleRing(name_);
+    fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  }
+  if (fd < 0) {
+    throw std::runtime_error("TelemetryPublisher: cannot create " + name_ +
+                             ": " + std::strerror(errno));
+  }
+  void *mapping = MAP_FAILED;
+  if (::ftruncate(fd, size_) == 0) {
+    mapping =
+        ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    ::shm_unlink(name_.c_str());
+    throw std::runtime_error("TelemetryPublisher: cannot map " + name_);
+  }
+  data_ = static_cast<char *>(mapping);
+#endif
+
+  auto header = new (data_) RingHeader;
+  header->magic.store(0, std::memory_order_relaxed);
+#ifndef _WIN32
+  header->pid.store(::getpid(), std::memory_order_relaxed);
+#endif
+  header->capacity = params_.capacity;
+  header->num_keys = params_.keys.size();
+  header->payload_size = payload_size_;
+  header->slot_size = slot_size_;
+  header->head.store(0, std::memory_order_relaxed);
+  uint64_t *keys = reinterpret_cast<uint64_t *>(header + 1);
+  for (size_t i = 0; i < params_.keys.size(); i++) {
+    keys[i] = params_.keys[i];
+    keys[params_.keys.size() + i] = dims_[i];
+  }
+  for (size_t s = 0; s < params_.capacity; s++) {
+    auto slot = new (data_ + slots_offset + s * slot_size_) SlotHeader;
+    slot->sequence.store(0, std::memory_order_relaxed);
+  }
+
+  // The magic goes last: readers that see it also see the layout.
+  header->magic.store(kMagic, std::memory_order_release);
+}
+
+/* ************************************************************************* */
+TelemetryPublisher::~TelemetryPublisher() {
+#ifndef _WIN32
+  if (data_) {
+    // A ring that is kept is marked stale, so the next publisher replaces it.
+    reinterpret_cast<RingHeader *>(data_)->pid.store(
+        0, std::memory_order_release);
+    ::munmap(data_, size_);
+  }
+  if (params_.unlink) ::shm_unlink(name_.c_str());
+#endif
+}
+
+/* ************************************************************************* */
+void TelemetryPublisher::publish(const IterationReport &report) {
+  const size_t n = num_published_++;
+  const bool with_values = report.values && params_.value_decimation > 0 &&
+                           n % params_.value_decimation == 0;
+
+  // Tangent vectors are computed before the slot is opened, so that the
+  // slot is inconsistent only during the copy.
+  if (with_values) {
+    double *p = payload_.data();
+    for (size_t i = 0; i < params_.keys.size(); i++) {
+      const gtsam::Key key = params_.keys[i];
+      if (report.values->exists(key)) {
+        const gtsam::Vector delta =
+            reference_.at(key).localCoordinates_(report.values->at(key));
+        std::copy(delta.data(), delta.data() + dims_[i], p);
+      } else {
+        std::fill(p, p + dims_[i], std::numeric_limits<double>::quiet_NaN());
+      }
+      p += dims_[i];
+    }
+  }
+
+  auto header = reinterpret_cast<RingHeader *>(data_);
+  char *slot_data = data_ + SlotsOffset(params_.keys.size()) +
+                    (n % params_.capacity) * slot_size_;
+  auto slot = reinterpret_cast<SlotHeader *>(slot_data);
+  slot->sequence.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->iteration = report.iteration;
+  slot->seconds = report.elapsed;
+  slot->cost = report.cost;
+  slot->violation = report.violation;
+  slot->has_values = with_values;
+  if (with_values) {
+    std::memcpy(slot + 1, payload_.data(), payload_size_ * sizeof(double));
+  }
+  slot->sequence.store(2 * n + 2, std::memory_order_release);
+  header->head.store(n + 1, std::memory_order_release);
+}
+
+/* ************************************************************************* */
+IterationCallback TelemetryPublisher::callback(IterationCallback next) {
+  return [this, next](const IterationReport &report) {
+    publish(report);
+    return next ? next(report) : true;
+  };
+}
+
+/* ************************************************************************* */
+TelemetryReader::TelemetryReader(const std::string &name) {
+#ifdef _WIN32
+  throw std::runtime_error(
+      "TelemetryReader: shared memory is not supported on Windows.");
+#else
+  const std::string shm_name = ShmName(name);
+  const int fd = ::shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::runtime_error("TelemetryReader: no ring named " + shm_name);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    size_ = st.st_size;
+    void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) data_ = static_cast<const char *>(mapping);
+  }
+  ::close(fd);
+  if (!data_) {
+    throw std::runtime_error("TelemetryReader: cannot map " + shm_name);
+  }
+
+  // The header, checking that all slots are inside the mapping. The keys
+  // are checked before the slots, so that a truncated segment or a corrupt
+  // number of keys cannot underflow the space left for the slots.
+  auto header = reinterpret_cast<const RingHeader *>(data_);
+  const bool complete =
+      size_ >= sizeof(RingHeader) &&
+      header->magic.load(std::memory_order_acquire) == kMagic;
+  if (!complete || header->num_keys > size_ / (2 * sizeof(uint64_t)) ||
+      SlotsOffset(header->num_keys) > size_ || header->slot_size == 0 ||
+      header->payload_size > header->slot_size / sizeof(double) ||
+      header->slot_size < sizeof(SlotHeader) +
+                              header->payload_size * sizeof(double) ||
+      (size_ - SlotsOffset(header->num_keys)) / header->slot_size <
+          header->capacity) {
+    ::munmap(const_cast<char *>(data_), size_);
+    throw std::runtime_error("TelemetryReader: not a telemetry ring: " +
+                             shm_name);
+  }
+  capacity_ = header->capacity;
+  slot_size_ = header->slot_size;
+  payload_size_ = header->payload_size;
+  const uint64_t *keys = reinterpret_cast<const uint64_t *>(header + 1);
+  keys_.assign(keys, keys + header->num_keys);
+  dims_.assign(keys + header->num_keys, keys + 2 * header->num_keys);
+#endif
+}
+
+/* ************************************************************************* */
+TelemetryReader::~TelemetryReader() {
+#ifndef _WIN32
+  if (data_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+}
+
+/* ************************************************************************* */
+std::vector<TelemetrySample> TelemetryReader::poll() {
+  auto header = reinterpret_cast<const RingHeader *>(data_);
+  const size_t head = header->head.load(std::memory_order_acquire);
+  const size_t first = std::max(next_, head > capacity_ ? head - capacity_ : 0);
+  num_dropped_ += first - next_;
+
+  std::vector<TelemetrySample> samples;
+  samples.reserve(head - first);
+  const char *slots = data_ + SlotsOffset(keys_.size());
+  for (size_t n = first; n < head; n++) {
+    auto slot = reinterpret_cast<const SlotHeader *>(
+        slots + (n % capacity_) * slot_size_);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * n + 2) {
+      num_dropped_++;
+      continue;
+    }
+    TelemetrySample sample;
+    sample.index = n;
+    sample.iteration = slot->iteration;
+    sample.seconds = slot->seconds;
+    sample.cost = slot->cost;
+    sample.violation = slot->violation;
+    if (slot->has_values) {
+      sample.values.resize(payload_size_);
+      std::memcpy(sample.values.data(), slot + 1,
+                  payload_size_ * sizeof(double));
+    }
+
+    // The publisher may have lapped the reader during the copy.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+      num_dropped_++;
+      continue;
+    }
+    samples.push_back(std::move(sample));
+  }
+  next_ = head;
+  return samples;
+}
+
+/* ************************************************************************* */
+gtsam::Values TelemetryReader::values(const TelemetrySample &sample,
+                                      const gtsam::Values &reference) const {
+  if (payload_size_ == 0 ||
+      static_cast<size_t>(sample.values.size()) != payload_size_) {
+    throw std::invalid_argument("TelemetryReader: the sample has no values.");
+  }
+  gtsam::Values values;
+  size_t offset = 0;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    const gtsam::Value &value = reference.at(keys_[i]);
+    if (value.dim() != dims_[i]) {
+      throw std::invalid_argument(
+          "TelemetryReader: the reference does not match the publisher.");
+    }
+    const gtsam::Vector delta = sample.values.segment(offset, dims_[i]);
+    if (!delta.hasNaN()) {
+      const std::unique_ptr<gtsam::Value> retracted(value.retract_(delta));
+      values.insert(keys_[i], *retracted);
+    }
+    offset += dims_[i];
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+size_t TelemetryReader::record(StorageManager *storage,
+                               const gtsam::Values &reference) {
+  size_t num_recorded = 0;
+  for (const TelemetrySample &sample : poll()) {
+    if (sample.values.size() == 0) continue;
+    storage->AddValues(values(sample, reference));
+    num_recorded++;
+  }
+  return num_recorded;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TelemetryRing.h
+ * @brief Lock-free shared-memory ring of optimizer iterations, for live
+ * monitoring from another process.
+ * @author Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+class StorageManager;
+
+/// Options of a TelemetryPublisher.
+struct TelemetryParameters {
+  size_t capacity = 1024;  ///< samples kept before the oldest is overwritten
+
+  /// Publish the values with every value_decimation-th sample, starting with
+  /// the first; 0 publishes metrics only.
+  size_t value_decimation = 0;
+
+  /// Variables whose values are published, all of the reference if empty.
+  gtsam::KeyVector keys;
+
+  /// Remove the shared memory name when the publisher is destroyed. Readers
+  /// that opened it keep their mapping.
+  bool unlink = true;
+};
+
+/// One iteration read from a telemetry ring.
+struct TelemetrySample {
+  size_t index = 0;      ///< position in the stream of published samples
+  size_t iteration = 0;  ///< iterations done by the optimizer
+  double seconds = 0.0;  ///< wall time since the start of the optimization
+  double cost = 0.0;
+  double violation = 0.0;
+
+  /// Tangent vectors of the published variables from their reference, in the
+  /// order of TelemetryReader::keys(); empty if values were not published.
+  gtsam::Vector values;
+};
+
+/**
+ * TelemetryPublisher writes optimizer iterations into a ring buffer in POSIX
+ * shared memory, so that a monitor in another process sees a running solve.
+ * Publishing never blocks and never waits for readers: it copies the sample
+ * into the next slot, guarded by a per-slot sequence number, and slow readers
+ * miss overwritten samples instead of slowing the optimizer. Values are
+ * optional and decimated, see TelemetryParameters; they are published as
+ * tangent vectors from a reference, e.g. the initial values, which readers
+ * need in order to rebuild them.
+ *
+ * A ring has a single publisher, called from one thread. To monitor an
+ * optimizer, set its AnytimeParameters::callback to callback().
+ */
+class TelemetryPublisher {
+ public:
+  /**
+   * Create the ring, replacing any stale ring of the same name, i.e. one
+   * whose publisher crashed or was destroyed. Throws if a running publisher
+   * uses the name, or if it names shared memory that is not a ring.
+   * @param name shared memory name, e.g. "/gtd_walk".
+   * @param params capacity and published values.
+   * @param reference values the published values are relative to.
+   */
+  explicit TelemetryPublisher(
+      const std::string &name,
+      const TelemetryParameters &params = TelemetryParameters(),
+      const gtsam::Values &reference = gtsam::Values());
+
+  /// Unmap the ring and, if params.unlink, remove its name.
+  ~TelemetryPublisher();
+
+  TelemetryPublisher(const TelemetryPublisher &) = delete;
+  TelemetryPublisher &operator=(const TelemetryPublisher &) = delete;
+
+  /**
+   * Publish an iteration, with report.values if they are due. Variables
+   * missing from them are published as NaN.
+   */
+  void publish(const IterationReport &report);
+
+  /**
+   * Iteration callback that publishes each report, then returns the result
+   * of next, if given, or true. The publisher must outlive the optimizer.
+   */
+  IterationCallback callback(IterationCallback next = IterationCallback());
+
+  /// Return the shared memory name, and the number of published samples.
+  const std::string &name() const { return name_; }
+  size_t numPublished() const { return num_published_; }
+
+ private:
+  std::string name_;
+  TelemetryParameters params_;
+  gtsam::Values reference_;
+  std::vector<size_t> dims_;
+  size_t payload_size_ = 0;
+  std::vector<double> payload_;  ///< values of a sample, before the copy
+  char *data_ = nullptr;
+  size_t size_ = 0, slot_size_ = 0;
+  size_t num_published_ = 0;
+};
+
+/**
+ * TelemetryReader follows a ring created by a TelemetryPublisher, possibly
+ * in another process. Each poll() returns the samples published since the
+ * last one; samples overwritten before they were read are counted as dropped.
+ */
+class TelemetryReader {
+ public:
+  /// Open the ring with the given name; throws if there is none.
+  explicit TelemetryReader(const std::string &name);
+
+  ~TelemetryReader();
+
+  TelemetryReader(const TelemetryReader &) = delete;
+  TelemetryReader &operator=(const TelemetryReader &) = delete;
+
+  /// Return the published variables, and the capacity of the ring.
+  const gtsam::KeyVector &keys() const { return keys_; }
+  size_t capacity() const { return capacity_; }
+
+  /// Samples published since the last poll, oldest first.
+  std::vector<TelemetrySample> poll();
+
+  /// Number of samples overwritten before they could be read.
+  size_t numDropped() const { return num_dropped_; }
+
+  /**
+   * Rebuild the values of a sample from the reference of the publisher;
+   * throws if the sample has no values.
+   */
+  gtsam::Values values(const TelemetrySample &sample,
+                       const gtsam::Values &reference) const;
+
+  /**
+   * Poll, and add the values of the new samples to storage, so that
+   * StorageManager::SaveFactorGraphSequence writes them for the factor graph
+   * visualization.
+   * @return the number of samples added.
+   */
+  size_t record(StorageManager *storage, const gtsam::Values &reference);
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0, slot_size_ = 0;
+  gtsam::KeyVector keys_;
+  std::vector<size_t> dims_;
+  size_t payload_size_ = 0;
+  size_t next_ = 0;  ///< index of the next sample to read
+  size_t num_dropped_ = 0;
+};
+
+}  // namespace gtdynamics
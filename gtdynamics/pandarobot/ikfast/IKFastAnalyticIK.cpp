@@ -0,0 +1,82 @@
+/**
+ * @file  IKFastAnalyticIK.cpp
+ * @brief Closed-form inverse kinematics backend for any registered IKFast
+ * solver.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include <gtdynamics/pandarobot/ikfast/IKFastAnalyticIK.h>
+#include <gtdynamics/utils/values.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+Values IKFastAnalyticIK::solve(const Slice& slice, const Robot& robot,
+                               const ContactGoals& contact_goals) const {
+  if (contact_goals.size() != 1 ||
+      contact_goals[0].link()->name() != link_name_) {
+    return Values();
+  }
+  const ContactGoal& goal = contact_goals[0];
+  const auto base = robot.link(base_name_);
+  const auto link = goal.link();
+
+  // End-effector frame such that the contact point is at the goal.
+  const Pose3 eMcom = lTe_.inverse() * link->bMlink().inverse() * link->bMcom();
+  const Point3 wte = goal.goal_point - bRe_ * (eMcom * goal.contactInCoM());
+  const Pose3 wTb = base->bMlink();
+  const Pose3 bTe = wTb.inverse() * Pose3(bRe_, wte);
+
+  // Solution closest to zero joint angles, within the joint limits.
+  std::vector<JointSharedPtr> joints;
+  for (const std::string& name : joint_names_) {
+    joints.push_back(robot.joint(name));
+  }
+  const Vector* best = nullptr;
+  double best_norm = std::numeric_limits<double>::infinity();
+  const std::vector<Vector> solutions =
+      IKFastRegistry::Get(solver_name_)->inverse(bTe, free_);
+  for (const Vector& q : solutions) {
+    bool within_limits = true;
+    for (size_t i = 0; i < joints.size(); i++) {
+      const auto& limits = joints[i]->parameters().scalar_limits;
+      within_limits &= q(i) >= limits.value_lower_limit &&
+                       q(i) <= limits.value_upper_limit;
+    }
+    if (within_limits && q.squaredNorm() < best_norm) {
+      best = &q;
+      best_norm = q.squaredNorm();
+    }
+  }
+  if (!best) return Values();
+
+  // Joint angles, zero for the joints IKFast does not solve, and link poses.
+  Values joint_angles;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&joint_angles, joint->id(), slice.k, 0.0);
+  }
+  for (size_t i = 0; i < joints.size(); i++) {
+    joint_angles.update(JointAngleKey(joints[i]->id(), slice.k), (*best)(i));
+  }
+  Values known_values = joint_angles;
+  InsertPose(&known_values, base->id(), slice.k, base->bMcom());
+  const Values fk =
+      robot.forwardKinematics(known_values, slice.k, base_name_);
+
+  Values values = joint_angles;
+  for (auto&& link : robot.links()) {
+    InsertPose(&values, link->id(), slice.k, Pose(fk, link->id(), slice.k));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
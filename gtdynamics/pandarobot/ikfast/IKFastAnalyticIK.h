@@ -0,0 +1,65 @@
+/**
+ * @file  IKFastAnalyticIK.h
+ * @brief Closed-form inverse kinematics backend for any registered IKFast
+ * solver.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/pandarobot/ikfast/IKFastSolver.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Inverse kinematics with the IKFast solver registered for a robot, for a
+ * single contact goal on the link carrying the IKFast end-effector frame. A
+ * point goal does not constrain the orientation, so the end-effector
+ * orientation and the values of the free joints are given. Of the solutions
+ * within the joint limits, the one closest to zero joint angles is returned.
+ */
+class IKFastAnalyticIK : public AnalyticInverseKinematics {
+ private:
+  std::string solver_name_;
+  std::vector<std::string> joint_names_;
+  gtsam::Vector free_;
+  gtsam::Rot3 bRe_;
+  std::string base_name_, link_name_;
+  gtsam::Pose3 lTe_;
+
+ public:
+  /**
+   * Constructor.
+   * @param solver_name -- name of the solver in the IKFastRegistry
+   * @param joint_names -- names of the joints solved for, in IKFast order
+   * @param free -- values of the free joints
+   * @param bRe -- end-effector orientation wrt the base frame
+   * @param base_name -- name of the base link, at its rest pose
+   * @param link_name -- name of the link carrying the end-effector
+   * @param lTe -- the end-effector pose in that link's frame
+   */
+  IKFastAnalyticIK(const std::string& solver_name,
+                   const std::vector<std::string>& joint_names,
+                   const gtsam::Vector& free, const gtsam::Rot3& bRe,
+                   const std::string& base_name, const std::string& link_name,
+                   const gtsam::Pose3& lTe = gtsam::Pose3())
+      : solver_name_(solver_name),
+        joint_names_(joint_names),
+        free_(free),
+        bRe_(bRe),
+        base_name_(base_name),
+        link_name_(link_name),
+        lTe_(lTe) {}
+
+  gtsam::Values solve(const Slice& slice, const Robot& robot,
+                      const ContactGoals& contact_goals) const override;
+};
+
+}  // namespace gtdynamics
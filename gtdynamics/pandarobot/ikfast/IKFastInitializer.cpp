@@ -0,0 +1,143 @@
+/**
+ * @file  IKFastInitializer.cpp
+ * @brief Initial trajectories for manipulators from analytic IK at keyframes.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include <gtdynamics/pandarobot/ikfast/IKFastInitializer.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+IKFastInitializer::IKFastInitializer(
+    const Robot& robot, const std::string& solver_name,
+    const std::vector<std::string>& joint_names, const std::string& base_name,
+    const std::vector<int>& keyframe_steps,
+    const std::vector<Pose3>& keyframe_poses,
+    const std::vector<Vector>& free_samples, const Vector& seed)
+    : base_name_(base_name) {
+  const size_t num_keyframes = keyframe_steps.size();
+  if (num_keyframes == 0 || keyframe_poses.size() != num_keyframes ||
+      static_cast<size_t>(seed.size()) != joint_names.size() ||
+      !std::is_sorted(keyframe_steps.begin(), keyframe_steps.end()) ||
+      keyframe_steps.front() < 0) {
+    throw std::invalid_argument(
+        "IKFastInitializer: needs increasing keyframe steps, one pose per "
+        "keyframe, and one seed angle per joint");
+  }
+  for (const std::string& name : joint_names) {
+    joints_.push_back(robot.joint(name));
+  }
+  const auto solver = IKFastRegistry::Get(solver_name);
+
+  // Solutions within the joint limits at each keyframe.
+  std::vector<std::vector<Vector>> candidates(num_keyframes);
+  for (size_t i = 0; i < num_keyframes; i++) {
+    for (const Vector& free : free_samples) {
+      for (const Vector& q : solver->inverse(keyframe_poses[i], free)) {
+        bool within_limits = true;
+        for (size_t j = 0; j < joints_.size(); j++) {
+          const auto& limits = joints_[j]->parameters().scalar_limits;
+          within_limits &= q(j) >= limits.value_lower_limit &&
+                           q(j) <= limits.value_upper_limit;
+        }
+        if (within_limits) candidates[i].push_back(q);
+      }
+    }
+    if (candidates[i].empty()) {
+      throw std::runtime_error("IKFastInitializer: keyframe " +
+                               std::to_string(i) +
+                               " has no solution within the joint limits");
+    }
+  }
+
+  // Branches with the smallest sum of squared jumps, by dynamic programming
+  // over the keyframes: cost[i][c] is that of the best path to candidate c.
+  std::vector<std::vector<double>> cost(num_keyframes);
+  std::vector<std::vector<size_t>> previous(num_keyframes);
+  for (const Vector& q : candidates[0]) {
+    cost[0].push_back((q - seed).squaredNorm());
+  }
+  for (size_t i = 1; i < num_keyframes; i++) {
+    for (const Vector& q : candidates[i]) {
+      double best = std::numeric_limits<double>::infinity();
+      size_t best_c = 0;
+      for (size_t c = 0; c < candidates[i - 1].size(); c++) {
+        const double path =
+            cost[i - 1][c] + (q - candidates[i - 1][c]).squaredNorm();
+        if (path < best) {
+          best = path;
+          best_c = c;
+        }
+      }
+      cost[i].push_back(best);
+      previous[i].push_back(best_c);
+    }
+  }
+  std::vector<Vector> keyframes(num_keyframes);
+  size_t c = std::min_element(cost.back().begin(), cost.back().end()) -
+             cost.back().begin();
+  for (size_t i = num_keyframes; i-- > 0;) {
+    keyframes[i] = candidates[i][c];
+    if (i > 0) c = previous[i][c];
+  }
+
+  // Linear interpolation, from the seed at step 0 through the keyframes.
+  trajectory_.resize(keyframe_steps.back() + 1);
+  int from_step = 0;
+  Vector from = seed;
+  for (size_t i = 0; i < num_keyframes; i++) {
+    const int to_step = keyframe_steps[i];
+    for (int k = from_step; k <= to_step; k++) {
+      const double s =
+          to_step == from_step ? 1.0
+                               : double(k - from_step) / (to_step - from_step);
+      trajectory_[k] = (1 - s) * from + s * keyframes[i];
+    }
+    from_step = to_step;
+    from = keyframes[i];
+  }
+}
+
+Values IKFastInitializer::ZeroValues(
+    const Robot& robot, const int t, double gaussian_noise,
+    const std::optional<PointOnLinks>& contact_points) const {
+  Values values =
+      Initializer::ZeroValues(robot, t, gaussian_noise, contact_points);
+  const Vector& q =
+      trajectory_[std::min<size_t>(std::max(t, 0), trajectory_.size() - 1)];
+
+  // Joint angles, zero for the joints IKFast does not solve, and link poses.
+  Values known_values;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), t, 0.0);
+  }
+  for (size_t j = 0; j < joints_.size(); j++) {
+    known_values.update(JointAngleKey(joints_[j]->id(), t), q(j));
+  }
+  const auto base = robot.link(base_name_);
+  InsertPose(&known_values, base->id(), t, base->bMcom());
+  const Values fk = robot.forwardKinematics(known_values, t, base_name_);
+
+  for (auto&& joint : robot.joints()) {
+    const gtsam::Key key = JointAngleKey(joint->id(), t);
+    values.update(key, known_values.at(key));
+  }
+  for (auto&& link : robot.links()) {
+    values.update(PoseKey(link->id(), t), fk.at(PoseKey(link->id(), t)));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,73 @@
+/**
+ * @file  IKFastInitializer.h
+ * @brief Initial trajectories for manipulators from analytic IK at keyframes.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#pragma once
+
+#include <gtdynamics/pandarobot/ikfast/IKFastSolver.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Initializer of manipulator trajectories with a registered IKFast solver.
+ * The end-effector poses of some keyframes are solved in closed form, for
+ * every sample of the free joints, and of the solutions within the joint
+ * limits, the sequence with the smallest sum of squared joint jumps from the
+ * seed through the keyframes is chosen, so that the trajectory stays on
+ * continuous branches. Joint angles are interpolated linearly between
+ * keyframes, and held after the last one; link poses follow by forward
+ * kinematics from the base at its rest pose. The constrained optimizer then
+ * starts from a nearly feasible trajectory.
+ */
+class IKFastInitializer : public Initializer {
+ private:
+  std::vector<JointSharedPtr> joints_;
+  std::string base_name_;
+  std::vector<gtsam::Vector> trajectory_;
+
+ public:
+  /**
+   * Constructor, which solves the keyframes and interpolates between them.
+   * Throws std::runtime_error if a keyframe has no solution within the joint
+   * limits.
+   * @param robot -- the manipulator
+   * @param solver_name -- name of the solver in the IKFastRegistry
+   * @param joint_names -- names of the joints solved for, in IKFast order
+   * @param base_name -- name of the base link, at its rest pose
+   * @param keyframe_steps -- increasing time steps of the keyframes
+   * @param keyframe_poses -- end-effector poses wrt the base at the keyframes
+   * @param free_samples -- samples of the values of the free joints
+   * @param seed -- joint angles at step 0, in IKFast order
+   */
+  IKFastInitializer(const Robot& robot, const std::string& solver_name,
+                    const std::vector<std::string>& joint_names,
+                    const std::string& base_name,
+                    const std::vector<int>& keyframe_steps,
+                    const std::vector<gtsam::Pose3>& keyframe_poses,
+                    const std::vector<gtsam::Vector>& free_samples,
+                    const gtsam::Vector& seed);
+
+  /// Joint angles of the IKFast joints at each step, up to the last keyframe.
+  const std::vector<gtsam::Vector>& jointTrajectory() const {
+    return trajectory_;
+  }
+
+  /// Joint angles and link poses of the trajectory at step t, completed by
+  /// Initializer::ZeroValues.
+  gtsam::Values ZeroValues(
+      const Robot& robot, const int t, double gaussian_noise = 0.0,
+      const std::optional<PointOnLinks>& contact_points = {}) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,101 @@
+/**
+ * @file  IKFastSolver.cpp
+ * @brief Generic interface and registry of generated IKFast solvers.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include "IKFastSolver.h"
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector;
+
+gtsam::Pose3 IKFastPlugin::forward(const Vector& q) const {
+  if (static_cast<size_t>(q.size()) != num_joints_) {
+    throw std::invalid_argument("IKFastPlugin: wrong number of joint angles");
+  }
+  // Arrays where solution for orientation and position will be stored
+  IkReal orientation[9], position[3];
+  compute_fk_(q.data(), position, orientation);
+
+  // ikfast is rowmajor, Eigen column major, so a transpose is necessary
+  Rot3 bRe(Matrix3::Map(&orientation[0]).transpose());
+  return Pose3(bRe, Point3::Map(&position[0]));
+}
+
+std::vector<Vector> IKFastPlugin::inverse(const Pose3& bTe,
+                                          const Vector& free) const {
+  if (static_cast<size_t>(free.size()) != num_free_) {
+    throw std::invalid_argument("IKFastPlugin: wrong number of free joints");
+  }
+  // rowmajor rotation, as in forward
+  const Matrix3 bRe = bTe.rotation().matrix().transpose();
+  ikfast::IkSolutionList<IkReal> solutions;
+  std::vector<Vector> joint_values;
+  if (!compute_ik_(bTe.translation().data(), bRe.data(), free.data(),
+                   solutions)) {
+    return joint_values;
+  }
+
+  for (size_t i = 0; i < solutions.GetNumSolutions(); ++i) {
+    const ikfast::IkSolutionBase<IkReal>& sol = solutions.GetSolution(i);
+    // Solutions in a singularity keep a degree of freedom, and are skipped.
+    if (sol.GetFree().size() != 0) continue;
+    joint_values.emplace_back(num_joints_);
+    sol.GetSolution(joint_values.back().data(), NULL);
+  }
+  return joint_values;
+}
+
+namespace {
+// Registered solvers, and the mutex guarding them.
+std::map<std::string, std::shared_ptr<const IKFastSolver>>& Solvers() {
+  static std::map<std::string, std::shared_ptr<const IKFastSolver>> solvers;
+  return solvers;
+}
+std::mutex& SolversMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+}  // namespace
+
+bool IKFastRegistry::Register(
+    const std::string& name,
+    const std::shared_ptr<const IKFastSolver>& solver) {
+  std::lock_guard<std::mutex> lock(SolversMutex());
+  Solvers()[name] = solver;
+  return true;
+}
+
+bool IKFastRegistry::Has(const std::string& name) {
+  std::lock_guard<std::mutex> lock(SolversMutex());
+  return Solvers().count(name) > 0;
+}
+
+std::shared_ptr<const IKFastSolver> IKFastRegistry::Get(
+    const std::string& name) {
+  std::lock_guard<std::mutex> lock(SolversMutex());
+  auto it = Solvers().find(name);
+  if (it == Solvers().end()) {
+    throw std::out_of_range("IKFastRegistry: no IKFast solver for " + name);
+  }
+  return it->second;
+}
+
+std::vector<std::string> IKFastRegistry::Names() {
+  std::lock_guard<std::mutex> lock(SolversMutex());
+  std::vector<std::string> names;
+  for (auto&& entry : Solvers()) names.push_back(entry.first);
+  return names;
+}
+
+}  // namespace gtdynamics
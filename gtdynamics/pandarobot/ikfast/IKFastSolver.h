@@ -0,0 +1,120 @@
+/**
+ * @file  IKFastSolver.h
+ * @brief Generic interface and registry of generated IKFast solvers.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#pragma once
+
+#include <gtdynamics/pandarobot/ikfast/ikfast.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Interface of an IKFast solver generated for one robot: forward kinematics
+ * to the end-effector, and the closed-form inverse kinematics given the
+ * values of the free joints.
+ */
+class IKFastSolver {
+ public:
+  virtual ~IKFastSolver() {}
+
+  /// Number of joints solved for.
+  virtual size_t numJoints() const = 0;
+
+  /// Number of free joints, whose values are given to inverse().
+  virtual size_t numFree() const = 0;
+
+  /**
+   * @brief End-effector pose wrt the base frame.
+   * @param q -- numJoints() joint angles
+   */
+  virtual gtsam::Pose3 forward(const gtsam::Vector& q) const = 0;
+
+  /**
+   * @brief Joint angles reaching the end-effector pose. Singularity
+   * solutions are not returned.
+   * @param bTe -- the desired end-effector pose wrt the base frame
+   * @param free -- numFree() values of the free joints
+   */
+  virtual std::vector<gtsam::Vector> inverse(
+      const gtsam::Pose3& bTe, const gtsam::Vector& free) const = 0;
+};
+
+/**
+ * IKFastSolver calling the API functions of one generated IKFast source,
+ * which are compiled in their own IKFAST_NAMESPACE.
+ */
+class IKFastPlugin : public IKFastSolver {
+ public:
+  using IkReal = double;
+  using ComputeIkFn = bool (*)(const IkReal*, const IkReal*, const IkReal*,
+                               ikfast::IkSolutionListBase<IkReal>&);
+  using ComputeFkFn = void (*)(const IkReal*, IkReal*, IkReal*);
+
+ private:
+  ComputeIkFn compute_ik_;
+  ComputeFkFn compute_fk_;
+  size_t num_joints_, num_free_;
+
+ public:
+  /**
+   * Constructor.
+   * @param compute_ik -- the ComputeIk function of the generated source
+   * @param compute_fk -- the ComputeFk function of the generated source
+   * @param num_joints -- its GetNumJoints()
+   * @param num_free -- its GetNumFreeParameters()
+   */
+  IKFastPlugin(ComputeIkFn compute_ik, ComputeFkFn compute_fk, int num_joints,
+               int num_free)
+      : compute_ik_(compute_ik),
+        compute_fk_(compute_fk),
+        num_joints_(num_joints),
+        num_free_(num_free) {}
+
+  size_t numJoints() const override { return num_joints_; }
+  size_t numFree() const override { return num_free_; }
+
+  gtsam::Pose3 forward(const gtsam::Vector& q) const override;
+
+  std::vector<gtsam::Vector> inverse(const gtsam::Pose3& bTe,
+                                     const gtsam::Vector& free) const override;
+};
+
+/**
+ * Registry of the IKFast solvers linked in, by robot name. Each generated
+ * source registers its solver when the library is loaded, in the translation
+ * unit which compiles it, e.g. for a UR5 solver generated in namespace
+ * ur5_internal:
+ *
+ *   static const bool kRegistered = IKFastRegistry::Register(
+ *       "ur5", std::make_shared<IKFastPlugin>(
+ *                  &ur5_internal::ComputeIk, &ur5_internal::ComputeFk,
+ *                  ur5_internal::GetNumJoints(),
+ *                  ur5_internal::GetNumFreeParameters()));
+ */
+class IKFastRegistry {
+ public:
+  /// Register a solver, replacing any solver of the same name.
+  static bool Register(const std::string& name,
+                       const std::shared_ptr<const IKFastSolver>& solver);
+
+  /// Whether a solver is registered for the robot.
+  static bool Has(const std::string& name);
+
+  /// The solver of the robot, throws std::out_of_range if there is none.
+  static std::shared_ptr<const IKFastSolver> Get(const std::string& name);
+
+  /// Names of the registered robots, in alphabetical order.
+  static std::vector<std::string> Names();
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,47 @@
+/**
+ * @file  PandaAnalyticIK.h
+ * @brief Closed-form inverse kinematics backend for the panda robot.
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#pragma once
+
+#include <gtdynamics/pandarobot/ikfast/IKFastAnalyticIK.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Inverse kinematics on the panda with IKFast, for a single contact goal on
+ * the link carrying the IKFast end-effector frame: link7, to which the fixed
+ * flange link8 is merged when loading the URDF. The 7th joint angle is the
+ * free parameter of IKFast, see IKFastAnalyticIK.
+ */
+class PandaAnalyticIK : public IKFastAnalyticIK {
+ public:
+  /**
+   * Constructor.
+   * @param bRe -- end-effector orientation wrt the base frame
+   * @param theta7 -- the value for the 7th joint angle
+   * @param base_name -- name of the base link, at its rest pose
+   * @param link_name -- name of the link carrying the end-effector
+   * @param lTe -- the end-effector pose in that link's frame
+   */
+  explicit PandaAnalyticIK(
+      const gtsam::Rot3& bRe, double theta7 = 0.0,
+      const std::string& base_name = "link0",
+      const std::string& link_name = "link7",
+      const gtsam::Pose3& lTe = gtsam::Pose3(gtsam::Rot3(),
+                                             gtsam::Point3(0, 0, 0.107)))
+      : IKFastAnalyticIK("panda",
+                         {"joint1", "joint2", "joint3", "joint4", "joint5",
+                          "joint6", "joint7"},
+                         gtsam::Vector1(theta7), bRe, base_name, link_name,
+                         lTe) {}
+};
+
+}  // namespace gtdynamics
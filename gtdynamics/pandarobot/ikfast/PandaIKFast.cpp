@@ -18,12 +18,17 @@
 
 //----------------------------------------------------------------------------//
 
+#include <gtdynamics/pandarobot/ikfast/IKFastSolver.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace gtdynamics {
@@ -36,6 +41,13 @@ using gtsam::Vector7;
 
 PandaIKFast::PandaIKFast() {}
 
+// The panda solver, in the IKFast registry.
+static const bool kPandaRegistered = IKFastRegistry::Register(
+    "panda", std::make_shared<IKFastPlugin>(
+                 &panda_internal::ComputeIk, &panda_internal::ComputeFk,
+                 panda_internal::GetNumJoints(),
+                 panda_internal::GetNumFreeParameters()));
+
 Pose3 PandaIKFast::forward(const Vector7& joint_values) {
   // Arrays where solution for orientation and position will be stored
   panda_internal::IkReal orientation[9], position[3];
@@ -89,4 +101,93 @@ std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
   return joint_values;
 }
 
+/// Number of poses solved together.
+static constexpr size_t kChunkSize = 64;
+
+const PandaIKFast::JointLimits& PandaIKFast::DefaultJointLimits() {
+  static const JointLimits limits = (JointLimits() << -2.9671, 2.9671,  //
+                                     -1.8326, 1.8326,                   //
+                                     -2.9671, 2.9671,                   //
+                                     -3.1416, -0.4,                     //
+                                     -2.9671, 2.9671,                   //
+                                     -0.0873, 3.8223,                   //
+                                     -2.9671, 2.9671)
+                                        .finished();
+  return limits;
+}
+
+// Solve poses [begin, end) of inverseBatch, reusing one solution list.
+static void InverseRange(const std::vector<Pose3>& bTes,
+                         const gtsam::Vector& theta7s,
+                         const gtsam::Matrix& seeds,
+                         const PandaIKFast::JointLimits& limits, size_t begin,
+                         size_t end, PandaIKBatch* batch) {
+  ikfast::IkSolutionList<panda_internal::IkReal> solutions;
+  Vector7 q;
+  for (size_t i = begin; i < end; i++) {
+    const Vector7 seed = seeds.col(seeds.cols() == 1 ? 0 : i);
+    const Matrix3 bRe = bTes[i].rotation().matrix().transpose();
+    double best = std::numeric_limits<double>::infinity();
+    for (Eigen::Index s = 0; s < theta7s.size(); s++) {
+      const double theta7 = theta7s(s);
+      if (!panda_internal::ComputeIk(bTes[i].translation().data(), bRe.data(),
+                                     &theta7, solutions)) {
+        continue;
+      }
+      for (size_t j = 0; j < solutions.GetNumSolutions(); j++) {
+        const auto& sol = solutions.GetSolution(j);
+        // Singularity solutions are skipped, as in inverse.
+        if (sol.GetFree().size() != 0) continue;
+        sol.GetSolution(q.data(), NULL);
+        if ((q.array() < limits.col(0).array()).any() ||
+            (q.array() > limits.col(1).array()).any()) {
+          continue;
+        }
+        const double distance = (q - seed).squaredNorm();
+        if (distance < best) {
+          best = distance;
+          batch->solutions.col(i) = q;
+        }
+      }
+    }
+    batch->distances(i) = best;
+  }
+}
+
+void PandaIKFast::inverseBatch(const std::vector<Pose3>& bTes,
+                               const gtsam::Vector& theta7s,
+                               const gtsam::Matrix& seeds, PandaIKBatch* batch,
+                               const JointLimits& limits,
+                               const ExecutionContext& execution) {
+  const size_t num_poses = bTes.size();
+  if (seeds.rows() != static_cast<Eigen::Index>(kNumJoints) ||
+      (seeds.cols() != 1 &&
+       seeds.cols() != static_cast<Eigen::Index>(num_poses))) {
+    throw std::invalid_argument(
+        "PandaIKFast::inverseBatch: seeds should be 7 x 1, or 7 x N for N "
+        "poses");
+  }
+  if (static_cast<size_t>(batch->solutions.cols()) != num_poses) {
+    batch->solutions.resize(kNumJoints, num_poses);
+    batch->distances.resize(num_poses);
+  }
+
+  execution.parallelFor(
+      (num_poses + kChunkSize - 1) / kChunkSize, [&](size_t chunk) {
+        const size_t begin = chunk * kChunkSize;
+        InverseRange(bTes, theta7s, seeds, limits, begin,
+                     std::min(begin + kChunkSize, num_poses), batch);
+      });
+}
+
+PandaIKBatch PandaIKFast::inverseBatch(const std::vector<Pose3>& bTes,
+                                       const gtsam::Vector& theta7s,
+                                       const gtsam::Matrix& seeds,
+                                       const JointLimits& limits,
+                                       const ExecutionContext& execution) {
+  PandaIKBatch batch;
+  inverseBatch(bTes, theta7s, seeds, &batch, limits, execution);
+  return batch;
+}
+
 }  // namespace gtdynamics
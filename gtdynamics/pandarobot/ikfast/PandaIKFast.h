@@ -9,15 +9,30 @@
 
 //----------------------------------------------------------------------------//
 
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <cmath>
 #include <vector>
 
 namespace gtdynamics {
 
+/**
+ * Solutions of PandaIKFast::inverseBatch, one column per pose: for each pose,
+ * the joint angles within the joint limits closest to its seed.
+ */
+struct PandaIKBatch {
+  gtsam::Matrix solutions;  ///< 7 x N joint angles
+  gtsam::Vector distances;  ///< squared distances to the seeds, inf if none
+
+  /// Whether pose i has a solution within the joint limits.
+  bool found(Eigen::Index i) const { return std::isfinite(distances(i)); }
+};
+
 // Wrapper of IKFast functions for panda robot.
 class PandaIKFast {
  public:
@@ -26,6 +41,12 @@ class PandaIKFast {
   // The robot's number of joints, for the panda it's 7
   static constexpr size_t kNumJoints = 7;
 
+  // Lower and upper joint limits, one row per joint
+  using JointLimits = Eigen::Matrix<double, 7, 2>;
+
+  /// The joint limits of the panda URDF.
+  static const JointLimits& DefaultJointLimits();
+
   /**
    * @brief Forward Kinematics on Panda robot using IKFast.
    *
@@ -46,6 +67,34 @@ class PandaIKFast {
    */
   static std::vector<gtsam::Vector7> inverse(const gtsam::Pose3& bRe,
                                              double theta7);
+
+  /**
+   * @brief Inverse Kinematics for many poses at once, e.g. for grasp
+   * sampling. For each pose, IKFast is run for every sample of the 7th joint
+   * angle, and of the solutions within the joint limits the one closest to
+   * the seed is kept. Chunks of poses are solved in parallel, on the threads
+   * of the execution context. The output is only resized when the number of
+   * poses changes, and no vector of solutions is returned per pose.
+   *
+   * @param bTes -- the desired end-effector poses wrt the base frame
+   * @param theta7s -- samples of the 7th joint angle, tried for every pose
+   * @param seeds -- 7 x N joint angles, one per pose, or 7 x 1 for all poses
+   * @param batch -- (output) the solutions closest to the seeds
+   * @param limits -- lower and upper joint limits
+   * @param execution -- threads that solve chunks of poses
+   */
+  static void inverseBatch(
+      const std::vector<gtsam::Pose3>& bTes, const gtsam::Vector& theta7s,
+      const gtsam::Matrix& seeds, PandaIKBatch* batch,
+      const JointLimits& limits = DefaultJointLimits(),
+      const ExecutionContext& execution = ExecutionContext::Default());
+
+  /// Version of inverseBatch which returns the solutions.
+  static PandaIKBatch inverseBatch(
+      const std::vector<gtsam::Pose3>& bTes, const gtsam::Vector& theta7s,
+      const gtsam::Matrix& seeds,
+      const JointLimits& limits = DefaultJointLimits(),
+      const ExecutionContext& execution = ExecutionContext::Default());
 };
 
 }  // namespace gtdynamics
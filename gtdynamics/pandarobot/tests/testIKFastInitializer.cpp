@@ -0,0 +1,78 @@
+/**
+ * @file  testIKFastInitializer.cpp
+ * @brief test initial trajectories from analytic IK at keyframes
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/pandarobot/ikfast/IKFastInitializer.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(IKFastInitializer, Panda) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  const std::vector<std::string> joint_names{
+      "joint1", "joint2", "joint3", "joint4", "joint5", "joint6", "joint7"};
+
+  // Two keyframes on one branch, reached from the seed. Free joint samples
+  // other than 0.3 move the 7th joint farther than the branch does.
+  const Vector7 q0 = (Vector7() << 0.1, -0.3, 0.2, -2.0, 0.1, 1.8, 0.3)
+                         .finished();
+  const Vector7 q1 = (Vector7() << 0.3, -0.4, 0.1, -1.8, 0.2, 1.6, 0.3)
+                         .finished();
+  const Vector7 q2 = (Vector7() << 0.5, -0.2, 0.0, -1.6, 0.3, 1.5, 0.3)
+                         .finished();
+  const std::vector<Pose3> poses{PandaIKFast::forward(q1),
+                                 PandaIKFast::forward(q2)};
+  const std::vector<Vector> free_samples{Vector1(0.3), Vector1(1.2)};
+  const IKFastInitializer initializer(robot, "panda", joint_names, "link0",
+                                      {4, 10}, poses, free_samples, q0);
+
+  // Closest branch at the keyframes, interpolated in between.
+  const std::vector<Vector>& trajectory = initializer.jointTrajectory();
+  EXPECT_LONGS_EQUAL(11, trajectory.size());
+  EXPECT(assert_equal(Vector(q0), trajectory[0], 1e-9));
+  EXPECT(assert_equal(Vector(q1), trajectory[4], 1e-5));
+  EXPECT(assert_equal(Vector(q2), trajectory[10], 1e-5));
+  EXPECT(assert_equal(Vector(0.5 * (q0 + q1)), trajectory[2], 1e-5));
+
+  // Values of all variables, with the joint angles of the trajectory.
+  const Values values = initializer.ZeroValues(robot, 4);
+  EXPECT(values.exists(TwistKey(robot.link("link7")->id(), 4)));
+  for (size_t j = 0; j < joint_names.size(); j++) {
+    EXPECT_DOUBLES_EQUAL(
+        q1(j), JointAngle(values, robot.joint(joint_names[j])->id(), 4), 1e-5);
+  }
+  // Held after the last keyframe.
+  const Values after = initializer.ZeroValues(robot, 12);
+  EXPECT_DOUBLES_EQUAL(q2(3),
+                       JointAngle(after, robot.joint("joint4")->id(), 12),
+                       1e-5);
+
+  // Unreachable keyframes, and mismatched arguments.
+  const std::vector<Pose3> far{Pose3(Rot3(), Point3(5, 0, 0))};
+  THROWS_EXCEPTION(std::make_shared<IKFastInitializer>(
+      robot, "panda", joint_names, "link0", std::vector<int>{4}, far,
+      free_samples, Vector(q0)));
+  THROWS_EXCEPTION(std::make_shared<IKFastInitializer>(
+      robot, "panda", joint_names, "link0", std::vector<int>{4}, poses,
+      free_samples, Vector(q0)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file  testIKFastSolver.cpp
+ * @brief test the registry of IKFast solvers
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/pandarobot/ikfast/IKFastSolver.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(IKFastRegistry, Panda) {
+  // The panda solver is registered when the library is loaded.
+  const std::vector<std::string> names = IKFastRegistry::Names();
+  EXPECT(std::find(names.begin(), names.end(), "panda") != names.end());
+  EXPECT(IKFastRegistry::Has("panda"));
+  EXPECT(!IKFastRegistry::Has("ur5"));
+  THROWS_EXCEPTION(IKFastRegistry::Get("ur5"));
+
+  const auto solver = IKFastRegistry::Get("panda");
+  EXPECT_LONGS_EQUAL(7, solver->numJoints());
+  EXPECT_LONGS_EQUAL(1, solver->numFree());
+
+  // Same solutions as PandaIKFast.
+  const Vector7 q = (Vector7() << 0.3, -0.4, 0.2, -2.0, 0.1, 1.8, 0.5)
+                        .finished();
+  const Pose3 bTe = PandaIKFast::forward(q);
+  EXPECT(assert_equal(bTe, solver->forward(q), 1e-9));
+
+  const std::vector<Vector7> expected = PandaIKFast::inverse(bTe, q(6));
+  const std::vector<Vector> actual = solver->inverse(bTe, Vector1(q(6)));
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+  for (size_t i = 0; i < std::min(expected.size(), actual.size()); ++i) {
+    EXPECT(assert_equal(Vector(expected[i]), actual[i], 1e-9));
+  }
+  THROWS_EXCEPTION(solver->inverse(bTe, Vector2(0.5, 0.5)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
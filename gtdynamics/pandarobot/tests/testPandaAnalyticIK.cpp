@@ -0,0 +1,63 @@
+/**
+ * @file  testPandaAnalyticIK.cpp
+ * @brief test closed-form inverse kinematics backend for the panda
+ * @author Frank Dellaert
+ * @author Antoni Jubes
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/pandarobot/ikfast/PandaAnalyticIK.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <memory>
+#include <string>
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(PandaAnalyticIK, Kinematics) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  const auto link7 = robot.link("link7");
+
+  // Goal for the end-effector origin, from joint angles within the limits.
+  const Vector7 q =
+      (Vector7() << 0.3, -0.4, 0.2, -2.0, 0.1, 1.8, 0.5).finished();
+  const Pose3 bTe = PandaIKFast::forward(q);
+  const Pose3 lTe(Rot3(), Point3(0, 0, 0.107));
+  const Pose3 comTe = link7->bMcom().inverse() * link7->bMlink() * lTe;
+  const ContactGoals contact_goals = {
+      {PointOnLink(link7, comTe.translation()), bTe.translation()}};
+
+  const size_t k = 3;
+  const PandaAnalyticIK analytic_ik(bTe.rotation(), q(6));
+  const Values solution = analytic_ik.solve(Slice(k), robot, contact_goals);
+  CHECK(!solution.empty());
+  EXPECT(contact_goals[0].satisfied(solution, k, 1e-6));
+  EXPECT(assert_equal(bTe, Pose(solution, link7->id(), k) * comTe, 1e-6));
+
+  // Kinematics returns the closed-form solution.
+  KinematicsParameters parameters;
+  parameters.analytic_ik = std::make_shared<PandaAnalyticIK>(analytic_ik);
+  Kinematics kinematics(parameters);
+  EXPECT(assert_equal(solution,
+                      kinematics.inverse(Slice(k), robot, contact_goals)));
+
+  // Goals on other links are left to the optimizer.
+  const ContactGoals other_goals = {
+      {PointOnLink(robot.link("link5"), Point3(0, 0, 0)), Point3(0, 0, 1)}};
+  EXPECT(analytic_ik.solve(Slice(k), robot, other_goals).empty());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
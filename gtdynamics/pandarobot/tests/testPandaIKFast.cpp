@@ -90,6 +90,43 @@ TEST(PandaIKFast, Inverse) {
   }
 }
 
+TEST(PandaIKFast, InverseBatch) {
+  // A pose reached within the joint limits, and the pose of the Inverse test,
+  // whose solutions are all outside of them (joint 4 is positive).
+  const Vector7 q = (Vector7() << 0.1, -0.3, 0.2, -2.0, 0.1, 1.8, 0.5)
+                        .finished();
+  const Pose3 reachable = PandaIKFast::forward(q);
+  const Pose3 outside(Rot3(), Point3(0, 0, 0.25));
+  const std::vector<Pose3> poses{reachable, outside, reachable};
+
+  // The sample of the 7th joint angle closest to the seed is selected.
+  const Vector theta7s = (Vector(3) << -0.5, 0.0, 0.5).finished();
+  PandaIKBatch batch = PandaIKFast::inverseBatch(poses, theta7s, q);
+  EXPECT_LONGS_EQUAL(7, batch.solutions.rows());
+  EXPECT_LONGS_EQUAL(3, batch.solutions.cols());
+  EXPECT(batch.found(0));
+  EXPECT(!batch.found(1));
+  EXPECT(batch.found(2));
+  EXPECT(assert_equal(q, Vector7(batch.solutions.col(0)), 1e-5));
+  EXPECT(assert_equal(reachable,
+                      PandaIKFast::forward(batch.solutions.col(2)), 1e-5));
+
+  // Without joint limits, the solution of inverse closest to its seed.
+  PandaIKFast::JointLimits no_limits;
+  no_limits.col(0).setConstant(-10);
+  no_limits.col(1).setConstant(10);
+  const std::vector<Vector7> solutions = PandaIKFast::inverse(outside, 0.3);
+  Matrix seeds(7, 3);
+  seeds << q, solutions[2], q;
+  PandaIKFast::inverseBatch(poses, Vector1(0.3), seeds, &batch, no_limits);
+  EXPECT(batch.found(1));
+  EXPECT(assert_equal(solutions[2], Vector7(batch.solutions.col(1)), 1e-9));
+
+  // Seeds should be given per pose, or once for all.
+  THROWS_EXCEPTION(
+      PandaIKFast::inverseBatch(poses, theta7s, Matrix::Zero(7, 2), &batch));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,238 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeModel.cpp
+ * @brief Kinematics and dynamics of a serialized robot, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/runtime/RuntimeModel.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace gtdynamics {
+namespace runtime {
+
+/* ************************************************************************* */
+Model::Model(const RobotTable &table) {
+  const size_t n = table.joints.size();
+  if (table.links.size() != n + 1) {
+    throw std::invalid_argument(
+        "runtime::Model: expected a connected tree with a single root.");
+  }
+  joint_names_.resize(n);
+  std::vector<bool> seen(n, false);
+  for (auto &&joint : table.joints) {
+    if (joint.id < 0 || static_cast<size_t>(joint.id) >= n || seen[joint.id]) {
+      throw std::invalid_argument("runtime::Model: expected joint ids 0.." +
+                                  std::to_string(n - 1));
+    }
+    seen[joint.id] = true;
+    joint_names_[joint.id] = joint.name;
+  }
+
+  // The root is the fixed link, or else the first link.
+  std::unordered_map<int, size_t> index;
+  size_t root = 0, num_fixed = 0;
+  for (size_t i = 0; i < table.links.size(); i++) {
+    index[table.links[i].id] = i;
+    if (table.links[i].fixed && num_fixed++ == 0) root = i;
+  }
+  if (num_fixed > 1) {
+    throw std::invalid_argument("runtime::Model: more than one fixed link.");
+  }
+
+  // Append a link to the traversal, with the joint that moves it.
+  auto append = [this](const RobotTable::Link &link, int parent,
+                       const RobotTable::Joint *joint) {
+    parent_.push_back(parent);
+    joint_.push_back(joint ? joint->id : -1);
+    const Transform rest =
+        joint ? joint->pMc : link.fixed ? link.fixed_pose : Transform();
+    const std::array<double, 12> pose = rest.pose();
+    rest_.insert(rest_.end(), pose.begin(), pose.end());
+    const Vector6 screw = joint ? joint->screw_axis : Vector6{};
+    screw_.insert(screw_.end(), screw.begin(), screw.end());
+
+    // Spatial inertia, diag(I, m * 1) in the CoM frame, zero if fixed.
+    std::array<double, 36> G{};
+    if (!link.fixed) {
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) G[6 * i + j] = link.inertia[3 * i + j];
+        G[6 * (3 + i) + 3 + i] = link.mass;
+      }
+    }
+    inertia_.insert(inertia_.end(), G.begin(), G.end());
+  };
+
+  // Breadth-first search from the root, from parent to child links.
+  std::vector<size_t> order{root};
+  std::vector<bool> visited(table.links.size(), false);
+  visited[root] = true;
+  append(table.links[root], -1, nullptr);
+  for (size_t k = 0; k < order.size(); k++) {
+    for (auto &&joint : table.joints) {
+      if (joint.parent != table.links[order[k]].id) continue;
+      const auto child = index.find(joint.child);
+      if (child == index.end()) {
+        throw std::invalid_argument("runtime::Model: joint " + joint.name +
+                                    " has no child link.");
+      }
+      if (visited[child->second]) {
+        throw std::invalid_argument(
+            "runtime::Model: kinematic loop detected at joint " + joint.name);
+      }
+      visited[child->second] = true;
+      order.push_back(child->second);
+      append(table.links[child->second], k, &joint);
+    }
+  }
+  if (order.size() != table.links.size()) {
+    for (auto &&joint : table.joints) {
+      const auto child = index.find(joint.child);
+      if (child != index.end() && visited[child->second]) {
+        throw std::invalid_argument("runtime::Model: joint " + joint.name +
+                                    " points towards the root link " +
+                                    table.links[root].name);
+      }
+    }
+    throw std::invalid_argument(
+        "runtime::Model: expected a connected tree with a single root.");
+  }
+}
+
+/* ************************************************************************* */
+Model Model::Load(std::istream &is) { return Model(ReadRobotTable(is)); }
+
+/* ************************************************************************* */
+int Model::jointId(const std::string &name) const {
+  for (size_t j = 0; j < joint_names_.size(); j++) {
+    if (joint_names_[j] == name) return j;
+  }
+  return -1;
+}
+
+/* ************************************************************************* */
+void Model::checkSize(const std::vector<double> &x, const char *name) const {
+  if (x.size() != numJoints()) {
+    throw std::invalid_argument(std::string("runtime::Model: ") + name +
+                                " needs one entry per joint.");
+  }
+}
+
+/* ************************************************************************* */
+batch::TreeView Model::view(bool with_gravity) const {
+  batch::TreeView tree;
+  tree.num_links = parent_.size();
+  tree.parent = parent_.data();
+  tree.joint = joint_.data();
+  tree.rest = rest_.data();
+  tree.screw = screw_.data();
+  tree.inertia = inertia_.data();
+  if (with_gravity) {
+    for (int i = 0; i < 3; i++) tree.gravity[i] = gravity[i];
+  }
+  return tree;
+}
+
+/* ************************************************************************* */
+std::vector<Transform> Model::forwardKinematics(
+    const std::vector<double> &q) const {
+  checkSize(q, "q");
+  const batch::TreeView tree = view(false);
+  std::vector<double> buffer(12 * tree.num_links);
+  std::vector<double *> poses(tree.num_links);
+  for (int k = 0; k < tree.num_links; k++) poses[k] = &buffer[12 * k];
+  batch::ForwardKinematics(tree, q.data(), 1, poses.data(), 0);
+
+  std::vector<Transform> result(numJoints());
+  for (int k = 1; k < tree.num_links; k++) {
+    result[joint_[k]] = Transform::FromPose(poses[k]);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+std::vector<double> Model::newtonEuler(const std::vector<double> &q,
+                                       const std::vector<double> &v,
+                                       const std::vector<double> &a,
+                                       bool with_gravity) const {
+  checkSize(q, "q");
+  checkSize(v, "v");
+  checkSize(a, "a");
+  const batch::TreeView tree = view(with_gravity);
+  std::vector<double> tau(numJoints(), 0.0), work(tree.workSize());
+  batch::InverseDynamics(tree, q.data(), v.data(), a.data(), tau.data(), 1,
+                         work.data(), 1);
+  return tau;
+}
+
+/* ************************************************************************* */
+std::vector<double> Model::inverseDynamics(const std::vector<double> &q,
+                                           const std::vector<double> &v,
+                                           const std::vector<double> &a) const {
+  return newtonEuler(q, v, a, true);
+}
+
+/* ************************************************************************* */
+std::vector<double> Model::massMatrix(const std::vector<double> &q) const {
+  // Column j is the torque for a unit acceleration of joint j, at rest and
+  // without gravity.
+  const size_t n = numJoints();
+  const std::vector<double> zero(n, 0.0);
+  std::vector<double> M(n * n), e(n, 0.0);
+  for (size_t j = 0; j < n; j++) {
+    e[j] = 1;
+    const std::vector<double> column = newtonEuler(q, zero, e, false);
+    for (size_t i = 0; i < n; i++) M[i * n + j] = column[i];
+    e[j] = 0;
+  }
+  return M;
+}
+
+/* ************************************************************************* */
+std::vector<double> Model::forwardDynamics(
+    const std::vector<double> &q, const std::vector<double> &v,
+    const std::vector<double> &tau) const {
+  checkSize(tau, "tau");
+  const size_t n = numJoints();
+  const std::vector<double> h =
+      newtonEuler(q, v, std::vector<double>(n, 0.0), true);
+  std::vector<double> L = massMatrix(q), x(n);
+  for (size_t i = 0; i < n; i++) x[i] = tau[i] - h[i];
+
+  // In-place Cholesky M = L L^T, then forward and back substitution.
+  for (size_t j = 0; j < n; j++) {
+    double d = L[j * n + j];
+    for (size_t k = 0; k < j; k++) d -= L[j * n + k] * L[j * n + k];
+    if (d <= 0) {
+      throw std::runtime_error(
+          "runtime::Model: mass matrix is not positive definite.");
+    }
+    L[j * n + j] = std::sqrt(d);
+    for (size_t i = j + 1; i < n; i++) {
+      double s = L[i * n + j];
+      for (size_t k = 0; k < j; k++) s -= L[i * n + k] * L[j * n + k];
+      L[i * n + j] = s / L[j * n + j];
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    for (size_t k = 0; k < i; k++) x[i] -= L[i * n + k] * x[k];
+    x[i] /= L[i * n + i];
+  }
+  for (size_t i = n; i-- > 0;) {
+    for (size_t k = i + 1; k < n; k++) x[i] -= L[k * n + i] * x[k];
+    x[i] /= L[i * n + i];
+  }
+  return x;
+}
+
+}  // namespace runtime
+}  // namespace gtdynamics
@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeModel.h
+ * @brief Kinematics and dynamics of a serialized robot, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/BatchDynamicsKernels.h>
+#include <gtdynamics/runtime/RuntimeRobotTable.h>
+
+#include <array>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace runtime {
+
+/**
+ * Model is a tree-structured robot loaded from a robot cache file, as written
+ * by SaveRobotCache, for deployment on controllers that only evaluate stored
+ * trajectories: forward kinematics, inverse dynamics with the Recursive
+ * Newton-Euler Algorithm, and forward dynamics, with plain arrays and without
+ * GTSAM, factor graphs or Values.
+ *
+ * The tree is flattened as a batch::TreeView and evaluated with the kernels
+ * of BatchDynamics, with the conventions of StaticRobot: twists and wrenches
+ * are in link CoM frames and joint vectors are indexed by joint id. The root
+ * is the fixed link, or else the first link held at the identity.
+ */
+class Model {
+ public:
+  std::array<double, 3> gravity{0, 0, 0};  // in world frame
+
+  /**
+   * Flatten the links and joints of a robot. Throws std::invalid_argument
+   * unless they form a tree with at most one fixed link, with joint ids
+   * 0..N-1 and all joints pointing away from the root.
+   */
+  explicit Model(const RobotTable &table);
+
+  /// Read the header of a robot cache file, see ReadRobotTable.
+  static Model Load(std::istream &is);
+
+  /// Number of joints.
+  size_t numJoints() const { return joint_names_.size(); }
+
+  /// Id of the joint with the given name, or -1.
+  int jointId(const std::string &name) const;
+
+  /// Name of the joint with id j.
+  const std::string &jointName(int j) const { return joint_names_.at(j); }
+
+  /// World poses of the link CoM frames, indexed by the joint that moves them.
+  std::vector<Transform> forwardKinematics(const std::vector<double> &q) const;
+
+  /// Torques for accelerations a at angles q and velocities v, with RNEA.
+  std::vector<double> inverseDynamics(const std::vector<double> &q,
+                                      const std::vector<double> &v,
+                                      const std::vector<double> &a) const;
+
+  /// Joint-space mass matrix, row-major, from inverse dynamics.
+  std::vector<double> massMatrix(const std::vector<double> &q) const;
+
+  /// Accelerations for torques tau, by a Cholesky solve with massMatrix.
+  std::vector<double> forwardDynamics(const std::vector<double> &q,
+                                      const std::vector<double> &v,
+                                      const std::vector<double> &tau) const;
+
+ private:
+  std::vector<std::string> joint_names_;  // by joint id
+  std::vector<int> parent_, joint_;       // of the TreeView, by link
+  std::vector<double> rest_, screw_, inertia_;
+
+  /// View of the flattened tree, with or without gravity.
+  batch::TreeView view(bool with_gravity) const;
+
+  /// Newton-Euler torques, with gravity if with_gravity.
+  std::vector<double> newtonEuler(const std::vector<double> &q,
+                                  const std::vector<double> &v,
+                                  const std::vector<double> &a,
+                                  bool with_gravity) const;
+
+  /// Throw std::invalid_argument unless x has one entry per joint.
+  void checkSize(const std::vector<double> &x, const char *name) const;
+};
+
+}  // namespace runtime
+}  // namespace gtdynamics
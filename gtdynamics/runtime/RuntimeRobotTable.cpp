@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeRobotTable.cpp
+ * @brief Links and joints of a robot cache file, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/BatchDynamicsKernels.h>
+#include <gtdynamics/runtime/RuntimeRobotTable.h>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace gtdynamics {
+namespace runtime {
+
+namespace {
+/// Identifies robot cache files; bump the version when the table or the
+/// serialized format of Robot, Link or Joint changes.
+const char kMagic[] = "gtdynamics-robot";
+const size_t kMagicSize = 16;  // without the terminating zero
+const uint32_t kVersion = 3;
+const uint64_t kMaxCount = 1u << 16;
+
+template <class T>
+void WritePlain(std::ostream &os, const T &x) {
+  os.write(reinterpret_cast<const char *>(&x), sizeof(x));
+}
+
+template <class T>
+T ReadPlain(std::istream &is) {
+  T x{};
+  is.read(reinterpret_cast<char *>(&x), sizeof(x));
+  return x;
+}
+
+void WriteString(std::ostream &os, const std::string &s) {
+  WritePlain<uint64_t>(os, s.size());
+  os.write(s.data(), s.size());
+}
+
+std::string ReadString(std::istream &is) {
+  const uint64_t size = ReadPlain<uint64_t>(is);
+  if (!is || size > kMaxCount) {
+    throw std::runtime_error("runtime::RobotTable: malformed name.");
+  }
+  std::string s(size, '\0');
+  is.read(&s[0], size);
+  return s;
+}
+
+uint64_t ReadCount(std::istream &is) {
+  const uint64_t n = ReadPlain<uint64_t>(is);
+  if (!is || n > kMaxCount) {
+    throw std::runtime_error("runtime::RobotTable: malformed table.");
+  }
+  return n;
+}
+
+int ReadId(std::istream &is) { return static_cast<int>(ReadCount(is)); }
+}  // namespace
+
+/* ************************************************************************* */
+Transform Transform::FromPose(const double *pose) {
+  Transform T;
+  std::memcpy(T.R.data(), pose, 9 * sizeof(double));
+  std::memcpy(T.t.data(), pose + 9, 3 * sizeof(double));
+  return T;
+}
+
+/* ************************************************************************* */
+std::array<double, 12> Transform::pose() const {
+  std::array<double, 12> pose;
+  std::memcpy(pose.data(), R.data(), 9 * sizeof(double));
+  std::memcpy(pose.data() + 9, t.data(), 3 * sizeof(double));
+  return pose;
+}
+
+/* ************************************************************************* */
+Transform Transform::compose(const Transform &other) const {
+  double T[12];
+  batch::Compose(pose().data(), other.pose().data(), T);
+  return FromPose(T);
+}
+
+/* ************************************************************************* */
+void WriteRobotTable(std::ostream &os, uint64_t hash,
+                     const RobotTable &table) {
+  os.write(kMagic, kMagicSize);
+  WritePlain(os, kVersion);
+  WritePlain(os, hash);
+  WritePlain<uint64_t>(os, table.links.size());
+  for (auto &&link : table.links) {
+    WriteString(os, link.name);
+    WritePlain<uint64_t>(os, link.id);
+    WritePlain<uint64_t>(os, link.fixed);
+    WritePlain(os, link.fixed_pose.pose());
+    WritePlain(os, link.mass);
+    WritePlain(os, link.inertia);
+  }
+  WritePlain<uint64_t>(os, table.joints.size());
+  for (auto &&joint : table.joints) {
+    WriteString(os, joint.name);
+    WritePlain<uint64_t>(os, joint.id);
+    WritePlain<uint64_t>(os, joint.parent);
+    WritePlain<uint64_t>(os, joint.child);
+    WritePlain(os, joint.screw_axis);
+    WritePlain(os, joint.pMc.pose());
+  }
+  if (!os) throw std::runtime_error("runtime::RobotTable: write failed.");
+}
+
+/* ************************************************************************* */
+RobotTable ReadRobotTable(std::istream &is, uint64_t *hash) {
+  char magic[kMagicSize];
+  is.read(magic, kMagicSize);
+  if (!is || std::memcmp(magic, kMagic, kMagicSize) != 0) {
+    throw std::runtime_error("runtime::RobotTable: not a robot cache file.");
+  }
+  if (ReadPlain<uint32_t>(is) != kVersion || !is) {
+    throw std::runtime_error("runtime::RobotTable: unsupported version.");
+  }
+  const uint64_t file_hash = ReadPlain<uint64_t>(is);
+  if (hash) *hash = file_hash;
+
+  RobotTable table;
+  table.links.resize(ReadCount(is));
+  for (auto &&link : table.links) {
+    link.name = ReadString(is);
+    link.id = ReadId(is);
+    link.fixed = ReadCount(is) != 0;
+    link.fixed_pose =
+        Transform::FromPose(ReadPlain<std::array<double, 12>>(is).data());
+    link.mass = ReadPlain<double>(is);
+    link.inertia = ReadPlain<std::array<double, 9>>(is);
+  }
+  table.joints.resize(ReadCount(is));
+  for (auto &&joint : table.joints) {
+    joint.name = ReadString(is);
+    joint.id = ReadId(is);
+    joint.parent = ReadId(is);
+    joint.child = ReadId(is);
+    joint.screw_axis = ReadPlain<Vector6>(is);
+    joint.pMc =
+        Transform::FromPose(ReadPlain<std::array<double, 12>>(is).data());
+  }
+  if (!is) throw std::runtime_error("runtime::RobotTable: truncated table.");
+  return table;
+}
+
+}  // namespace runtime
+}  // namespace gtdynamics
@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeRobotTable.h
+ * @brief Links and joints of a robot cache file, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace runtime {
+
+/// Rigid transform, with a row-major rotation matrix R and a translation t.
+struct Transform {
+  std::array<double, 9> R{1, 0, 0, 0, 1, 0, 0, 0, 1};
+  std::array<double, 3> t{0, 0, 0};
+
+  /// The transform from 12 numbers, R followed by t as in batch::TreeView.
+  static Transform FromPose(const double *pose);
+
+  /// The 12 numbers of this transform, R followed by t.
+  std::array<double, 12> pose() const;
+
+  /// This transform followed by other, i.e., this * other.
+  Transform compose(const Transform &other) const;
+};
+
+/// Twists, accelerations and wrenches, angular part first as in gtdynamics.
+using Vector6 = std::array<double, 6>;
+
+/**
+ * RobotTable holds the links and joints of a robot as plain numbers. It is
+ * the header of the robot cache files written by SaveRobotCache, so that
+ * the same files load into a gtdynamics::Robot and into a runtime::Model.
+ */
+struct RobotTable {
+  struct Link {
+    std::string name;
+    int id = 0;
+    bool fixed = false;
+    Transform fixed_pose;  // of the link CoM in the world, if fixed
+    double mass = 0;
+    std::array<double, 9> inertia{};  // rotational inertia, row-major
+  };
+
+  struct Joint {
+    std::string name;
+    int id = 0;
+    int parent = 0, child = 0;  // link ids
+    Vector6 screw_axis{};       // in the child link CoM frame
+    Transform pMc;              // child link CoM in parent CoM, at rest
+  };
+
+  std::vector<Link> links;
+  std::vector<Joint> joints;
+};
+
+/**
+ * Write the header of a robot cache file: the magic "gtdynamics-robot", the
+ * format version and the hash, then the links and joints of the table, with
+ * uint64 sizes, ids and lengths and float64 numbers, in native byte order.
+ */
+void WriteRobotTable(std::ostream &os, uint64_t hash, const RobotTable &table);
+
+/**
+ * Read the header of a robot cache file, leaving the stream at the Boost
+ * archive of the Robot that may follow it.
+ * @param hash if given, set to the hash of the model file.
+ * Throws std::runtime_error if the header is malformed or of another version.
+ */
+RobotTable ReadRobotTable(std::istream &is, uint64_t *hash = nullptr);
+
+}  // namespace runtime
+}  // namespace gtdynamics
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeTrajectory.cpp
+ * @brief Playback of solved trajectories, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/runtime/RuntimeTrajectory.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+
+namespace gtdynamics {
+namespace runtime {
+
+namespace {
+const char kMagic[] = "GTDTRAJ1";
+const size_t kMagicSize = 8;
+
+uint64_t ReadUint64(std::istream &is) {
+  uint64_t n = 0;
+  is.read(reinterpret_cast<char *>(&n), sizeof(n));
+  return n;
+}
+
+void Interpolate(const std::vector<double> &x0, const std::vector<double> &x1,
+                 double s, std::vector<double> *x) {
+  x->resize(x0.size());
+  for (size_t i = 0; i < x0.size(); i++) {
+    (*x)[i] = (1 - s) * x0[i] + s * x1[i];
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+Trajectory Trajectory::Load(std::istream &is, const Model &model) {
+  char magic[kMagicSize];
+  is.read(magic, kMagicSize);
+  if (!is || std::memcmp(magic, kMagic, kMagicSize) != 0) {
+    throw std::runtime_error("runtime::Trajectory: not a binary trajectory.");
+  }
+
+  // Columns are q, v, a and torque of every joint, and the step duration.
+  const uint64_t n = ReadUint64(is);
+  if (!is || n % 4 != 1 || n > (1u << 20)) {
+    throw std::runtime_error("runtime::Trajectory: malformed header.");
+  }
+  const size_t J = (n - 1) / 4;
+  std::vector<int> ids(J, -1);
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t size = ReadUint64(is);
+    if (!is || size > (1u << 16)) {
+      throw std::runtime_error("runtime::Trajectory: truncated header.");
+    }
+    std::string name(size, '\0');
+    is.read(&name[0], size);
+    if (i < J) ids[i] = model.jointId(name);
+  }
+  if (!is) throw std::runtime_error("runtime::Trajectory: truncated header.");
+  for (int j = 0; j < static_cast<int>(model.numJoints()); j++) {
+    if (std::find(ids.begin(), ids.end(), j) == ids.end()) {
+      throw std::runtime_error("runtime::Trajectory: joint " +
+                               model.jointName(j) + " is missing.");
+    }
+  }
+
+  Trajectory trajectory;
+  const size_t num_joints = model.numJoints();
+  std::vector<double> row(n);
+  const std::streamsize row_size = n * sizeof(double);
+  double t = 0;
+  while (is.read(reinterpret_cast<char *>(row.data()), row_size)) {
+    JointState state;
+    for (auto x : {&state.q, &state.v, &state.a, &state.tau}) {
+      x->assign(num_joints, 0.0);
+    }
+    for (size_t j = 0; j < J; j++) {
+      if (ids[j] < 0) continue;  // a joint the model does not have
+      state.q[ids[j]] = row[j + 0 * J];
+      state.v[ids[j]] = row[j + 1 * J];
+      state.a[ids[j]] = row[j + 2 * J];
+      state.tau[ids[j]] = row[j + 3 * J];
+    }
+    trajectory.times_.push_back(t);
+    trajectory.steps_.push_back(state);
+    t += row.back();
+  }
+  if (is.gcount() != 0) {
+    throw std::runtime_error("runtime::Trajectory: truncated row.");
+  }
+  return trajectory;
+}
+
+/* ************************************************************************* */
+JointState Trajectory::sample(double t) const {
+  if (steps_.empty()) {
+    throw std::runtime_error("runtime::Trajectory: no steps to sample.");
+  }
+  if (t <= times_.front()) return steps_.front();
+  if (t >= times_.back()) return steps_.back();
+
+  // The step k before t, with times_[k] <= t < times_[k + 1].
+  const size_t k =
+      std::upper_bound(times_.begin(), times_.end(), t) - times_.begin() - 1;
+  const double span = times_[k + 1] - times_[k];
+  const double s = span > 0 ? (t - times_[k]) / span : 0.0;
+  const JointState &x0 = steps_[k], &x1 = steps_[k + 1];
+  JointState x;
+  Interpolate(x0.q, x1.q, s, &x.q);
+  Interpolate(x0.v, x1.v, s, &x.v);
+  Interpolate(x0.a, x1.a, s, &x.a);
+  Interpolate(x0.tau, x1.tau, s, &x.tau);
+  return x;
+}
+
+}  // namespace runtime
+}  // namespace gtdynamics
@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RuntimeTrajectory.h
+ * @brief Playback of solved trajectories, without GTSAM.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/runtime/RuntimeModel.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+namespace runtime {
+
+/// Joint angles, velocities, accelerations and torques, indexed by joint id.
+struct JointState {
+  std::vector<double> q, v, a, tau;
+};
+
+/**
+ * Trajectory is a trajectory written by a BINARY TrajectoryWriter, with its
+ * columns matched by joint name to the joints of a Model, for playback on a
+ * controller: states are linearly interpolated in time between steps.
+ */
+class Trajectory {
+ public:
+  /**
+   * Read a trajectory in the binary format of TrajectoryWriter.
+   * @param is    stream written by a BINARY TrajectoryWriter
+   * @param model model whose joints are all in the trajectory
+   * Throws std::runtime_error if malformed or if a joint is missing.
+   */
+  static Trajectory Load(std::istream &is, const Model &model);
+
+  /// Number of time steps.
+  size_t numSteps() const { return times_.size(); }
+
+  /// Start time of step k, the sum of the durations of the previous steps.
+  double time(size_t k) const { return times_.at(k); }
+
+  /// Time of the last step.
+  double duration() const { return times_.empty() ? 0.0 : times_.back(); }
+
+  /// State of step k.
+  const JointState &step(size_t k) const { return steps_.at(k); }
+
+  /// State at time t, clamped to the first and the last step.
+  JointState sample(double t) const;
+
+ private:
+  std::vector<double> times_;
+  std::vector<JointState> steps_;
+};
+
+}  // namespace runtime
+}  // namespace gtdynamics
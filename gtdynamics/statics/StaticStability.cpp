@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticStability.cpp
+ * @brief Center of mass, support polygon and ZMP checks of postures.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/statics/StaticStability.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Point2;
+using gtsam::Point3;
+
+namespace gtdynamics {
+
+namespace {
+/// Cross product of b - a and c - a, positive if a, b, c turn left.
+double Cross(const Point2 &a, const Point2 &b, const Point2 &c) {
+  return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+/// Distance of p to the segment from a to b.
+double SegmentDistance(const Point2 &p, const Point2 &a, const Point2 &b) {
+  const Point2 ab = b - a;
+  const double length2 = ab.squaredNorm();
+  const double s =
+      length2 > 0 ? std::clamp((p - a).dot(ab) / length2, 0.0, 1.0) : 0.0;
+  return (p - (a + s * ab)).norm();
+}
+
+/// The total mass of the links of robot.
+double TotalMass(const Robot &robot) {
+  double mass = 0;
+  for (auto &&link : robot.links()) mass += link->mass();
+  if (mass <= 0) {
+    throw std::invalid_argument("CenterOfMass: the robot has no mass.");
+  }
+  return mass;
+}
+}  // namespace
+
+/* ************************************************************************* */
+Point3 CenterOfMass(const Robot &robot, const gtsam::Values &values,
+                    size_t k) {
+  Point3 com = Point3::Zero();
+  for (auto &&link : robot.links()) {
+    com += link->mass() * Pose(values, link->id(), k).translation();
+  }
+  return com / TotalMass(robot);
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+Eigen::Matrix<Scalar, 3, Eigen::Dynamic> BatchCenterOfMass(
+    const Robot &robot, const BatchLinkPosesT<Scalar> &poses) {
+  const Eigen::Index num_configs = poses.numConfigs();
+  Eigen::Matrix<Scalar, 3, Eigen::Dynamic> com =
+      Eigen::Matrix<Scalar, 3, Eigen::Dynamic>::Zero(3, num_configs);
+  for (auto &&link : robot.links()) {
+    com += Scalar(link->mass()) * poses.links.at(link->id()).bottomRows(3);
+  }
+  return com / Scalar(TotalMass(robot));
+}
+
+template Eigen::Matrix<float, 3, Eigen::Dynamic> BatchCenterOfMass(
+    const Robot &robot, const BatchLinkPosesF &poses);
+template Eigen::Matrix<double, 3, Eigen::Dynamic> BatchCenterOfMass(
+    const Robot &robot, const BatchLinkPoses &poses);
+
+/* ************************************************************************* */
+Point2 ZeroMomentPoint(const Point3 &com, const gtsam::Vector3 &com_accel,
+                       double ground_height, double g) {
+  const double denominator = com_accel.z() + g;
+  if (denominator <= 0) {
+    throw std::invalid_argument(
+        "ZeroMomentPoint: the robot is not pressed against the ground.");
+  }
+  const double s = (com.z() - ground_height) / denominator;
+  return Point2(com.x() - s * com_accel.x(), com.y() - s * com_accel.y());
+}
+
+/* ************************************************************************* */
+SupportPolygon::SupportPolygon(const std::vector<Point3> &points) {
+  // Andrew's monotone chain, on the points sorted by x and then y.
+  std::vector<Point2> sorted;
+  sorted.reserve(points.size());
+  for (auto &&p : points) sorted.emplace_back(p.x(), p.y());
+  std::sort(sorted.begin(), sorted.end(), [](const Point2 &a, const Point2 &b) {
+    return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+  });
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  if (sorted.size() < 3) {
+    vertices_ = sorted;
+    return;
+  }
+
+  std::vector<Point2> hull(2 * sorted.size());
+  size_t n = 0;
+  for (size_t i = 0; i < sorted.size(); i++) {  // lower hull
+    while (n >= 2 && Cross(hull[n - 2], hull[n - 1], sorted[i]) <= 0) n--;
+    hull[n++] = sorted[i];
+  }
+  for (size_t i = sorted.size() - 1, lower = n + 1; i-- > 0;) {  // upper hull
+    while (n >= lower && Cross(hull[n - 2], hull[n - 1], sorted[i]) <= 0) n--;
+    hull[n++] = sorted[i];
+  }
+  hull.resize(n - 1);  // the last point is the first one
+  vertices_ = hull;
+}
+
+/* ************************************************************************* */
+SupportPolygon SupportPolygon::FromContacts(const PointOnLinks &contact_points,
+                                            const gtsam::Values &values,
+                                            size_t k) {
+  std::vector<Point3> points;
+  points.reserve(contact_points.size());
+  for (auto &&cp : contact_points) points.push_back(cp.predict(values, k));
+  return SupportPolygon(points);
+}
+
+/* ************************************************************************* */
+double SupportPolygon::margin(const Point2 &p) const {
+  const size_t n = vertices_.size();
+  if (n == 0) return -std::numeric_limits<double>::infinity();
+  if (n == 1) return -(p - vertices_[0]).norm();
+  if (n == 2) return -SegmentDistance(p, vertices_[0], vertices_[1]);
+
+  // Inside, all edges have p on their left, at the distance to their line.
+  double inside = std::numeric_limits<double>::infinity();
+  double outside = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < n; i++) {
+    const Point2 &a = vertices_[i], &b = vertices_[(i + 1) % n];
+    inside = std::min(inside, Cross(a, b, p) / (b - a).norm());
+    outside = std::min(outside, SegmentDistance(p, a, b));
+  }
+  return inside >= 0 ? inside : -outside;
+}
+
+/* ************************************************************************* */
+double StaticStabilityMargin(const Robot &robot, const gtsam::Values &values,
+                             const PointOnLinks &contact_points, size_t k) {
+  const Point3 com = CenterOfMass(robot, values, k);
+  return SupportPolygon::FromContacts(contact_points, values, k)
+      .margin(Point2(com.x(), com.y()));
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+Eigen::Matrix<Scalar, Eigen::Dynamic, 1> BatchStaticStabilityMargins(
+    const Robot &robot, const BatchLinkPosesT<Scalar> &poses,
+    const PointOnLinks &contact_points) {
+  const Eigen::Index num_configs = poses.numConfigs();
+  const auto com = BatchCenterOfMass(robot, poses);
+
+  // World x, y of every contact point, in all configurations at once:
+  // rows 0..2 and 3..5 of a block are the first two rows of the rotation.
+  std::vector<Eigen::Matrix<Scalar, 2, Eigen::Dynamic>> contacts;
+  contacts.reserve(contact_points.size());
+  for (auto &&cp : contact_points) {
+    const auto &block = poses.links.at(cp.link->id());
+    const Eigen::Matrix<Scalar, 3, 1> p = cp.point.cast<Scalar>();
+    Eigen::Matrix<Scalar, 2, Eigen::Dynamic> xy(2, num_configs);
+    xy.row(0) = p(0) * block.row(0) + p(1) * block.row(1) +
+                p(2) * block.row(2) + block.row(9);
+    xy.row(1) = p(0) * block.row(3) + p(1) * block.row(4) +
+                p(2) * block.row(5) + block.row(10);
+    contacts.push_back(xy);
+  }
+
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> margins(num_configs);
+  std::vector<Point3> points(contacts.size());
+  for (Eigen::Index c = 0; c < num_configs; c++) {
+    for (size_t i = 0; i < contacts.size(); i++) {
+      points[i] = Point3(double(contacts[i](0, c)), double(contacts[i](1, c)),
+                         0.0);
+    }
+    const Point2 xy(double(com(0, c)), double(com(1, c)));
+    margins(c) = Scalar(SupportPolygon(points).margin(xy));
+  }
+  return margins;
+}
+
+template Eigen::Matrix<float, Eigen::Dynamic, 1> BatchStaticStabilityMargins(
+    const Robot &robot, const BatchLinkPosesF &poses,
+    const PointOnLinks &contact_points);
+template Eigen::Matrix<double, Eigen::Dynamic, 1> BatchStaticStabilityMargins(
+    const Robot &robot, const BatchLinkPoses &poses,
+    const PointOnLinks &contact_points);
+
+}  // namespace gtdynamics
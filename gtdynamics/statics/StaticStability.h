@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticStability.h
+ * @brief Center of mass, support polygon and ZMP checks of postures.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/*
+ * These checks reject candidate postures before Statics::solve, on flat ground
+ * with gravity along -z of the world frame: a posture whose center of mass is
+ * outside the support polygon of its contact points has no feasible contact
+ * wrenches without friction torques, whatever the solver finds.
+ */
+
+/**
+ * @fn Center of mass of a robot, the mass-weighted mean of the link CoMs.
+ * @param robot  the robot
+ * @param values link poses, e.g. from Robot::forwardKinematics
+ * @param k      time step
+ */
+gtsam::Point3 CenterOfMass(const Robot &robot, const gtsam::Values &values,
+                           size_t k = 0);
+
+/**
+ * @fn Centers of mass of a batch of configurations, e.g. from
+ * BatchForwardKinematics, with one column per configuration.
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar, 3, Eigen::Dynamic> BatchCenterOfMass(
+    const Robot &robot, const BatchLinkPosesT<Scalar> &poses);
+
+/**
+ * @fn Zero moment point of a point mass: where the line of action of gravity
+ * and inertial forces at the center of mass meets the ground.
+ * @param com           center of mass
+ * @param com_accel     acceleration of the center of mass
+ * @param ground_height height of the ground
+ * @param g             gravitational acceleration
+ */
+gtsam::Point2 ZeroMomentPoint(const gtsam::Point3 &com,
+                              const gtsam::Vector3 &com_accel,
+                              double ground_height = 0.0, double g = 9.81);
+
+/**
+ * SupportPolygon is the convex hull of contact points projected onto the
+ * ground, with counter-clockwise vertices.
+ */
+class SupportPolygon {
+ private:
+  std::vector<gtsam::Point2> vertices_;
+
+ public:
+  /// Empty polygon, which contains no points.
+  SupportPolygon() {}
+
+  /// Convex hull of the x, y coordinates of points.
+  explicit SupportPolygon(const std::vector<gtsam::Point3> &points);
+
+  /**
+   * Support polygon of contact points, e.g.
+   * FootContactConstraintSpec::contactPoints(), for the link poses in values.
+   */
+  static SupportPolygon FromContacts(const PointOnLinks &contact_points,
+                                     const gtsam::Values &values,
+                                     size_t k = 0);
+
+  /// Vertices, counter-clockwise.
+  const std::vector<gtsam::Point2> &vertices() const { return vertices_; }
+
+  /**
+   * Signed distance of p to the boundary: positive inside, negative outside,
+   * and never positive if the contacts are collinear. -infinity if empty.
+   */
+  double margin(const gtsam::Point2 &p) const;
+
+  /// Whether p is inside, at least min_margin away from the boundary.
+  bool contains(const gtsam::Point2 &p, double min_margin = 0.0) const {
+    return margin(p) >= min_margin;
+  }
+};
+
+/**
+ * @fn Static stability margin of a posture: the margin of the projection of
+ * its center of mass in its support polygon, negative if it would tip over.
+ */
+double StaticStabilityMargin(const Robot &robot, const gtsam::Values &values,
+                             const PointOnLinks &contact_points, size_t k = 0);
+
+/**
+ * @fn Static stability margins of a batch of configurations, e.g. from
+ * BatchForwardKinematics for sampled postures, with the same contact points.
+ * @return one margin per configuration
+ */
+template <typename Scalar>
+Eigen::Matrix<Scalar, Eigen::Dynamic, 1> BatchStaticStabilityMargins(
+    const Robot &robot, const BatchLinkPosesT<Scalar> &poses,
+    const PointOnLinks &contact_points);
+
+}  // namespace gtdynamics
@@ -19,6 +19,8 @@
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -71,7 +73,7 @@ struct StaticsParameters : public KinematicsParameters {
                     const std::optional<gtsam::Vector3>& planar_axis = {})
       : gravity(gravity),
         planar_axis(planar_axis),
-        fs_cost_model(Isotropic::Sigma(6, 1e-4)),
+        fs_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 1e-4)),
         f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
         t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)) {}
 };
@@ -127,6 +129,22 @@ class Statics : public Kinematics {
   gtsam::Values solve(const Slice& slice, const Robot& robot,
                       const gtsam::Values& configuration) const;
 
+  /**
+   * Solve for wrenches for many kinematics configurations, e.g. a grid of
+   * configurations for a payload capability map. Given the configuration, the
+   * statics factors are linear in the wrenches and torques, so every
+   * configuration is solved by a single linear least-squares solve, on the
+   * same graph and elimination ordering, instead of by the optimizer. The
+   * configurations are solved in parallel, on the threads of the parameters.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param configurations Known kinematics configurations.
+   * @returns for every configuration, the values returned by solve.
+   */
+  std::vector<gtsam::Values> solveBatch(
+      const Slice& slice, const Robot& robot,
+      const std::vector<gtsam::Values>& configurations) const;
+
   /**
    * Solve for wrenches and kinematics configuration.
    * @param slice Slice instance.
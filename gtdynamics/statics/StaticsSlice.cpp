@@ -16,11 +16,18 @@
 #include <gtdynamics/factors/WrenchPlanarFactor.h>       // TODO: move
 #include <gtdynamics/statics/StaticWrenchFactor.h>
 #include <gtdynamics/statics/Statics.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearEquality.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace gtdynamics {
 using gtsam::assert_equal;
 using gtsam::Point3;
@@ -139,6 +146,57 @@ gtsam::Values Statics::solve(const Slice& slice, const Robot& robot,
   return optimize(graph, initial_values);
 }
 
+std::vector<gtsam::Values> Statics::solveBatch(
+    const Slice& slice, const Robot& robot,
+    const std::vector<gtsam::Values>& configurations) const {
+  const auto graph = this->graph(slice, robot);
+  const gtsam::Values unknowns = initialValues(slice, robot);
+
+  // Known configuration and unknowns at zero, around which the graph is
+  // linearized with the Jacobians of the configuration dropped.
+  auto linearize = [&](const gtsam::Values& configuration,
+                       gtsam::Values* values) {
+    for (auto&& link : robot.links()) {
+      auto key = PoseKey(link->id(), slice.k);
+      values->insert(key, configuration.at<Pose3>(key));
+    }
+    for (auto&& joint : robot.joints()) {
+      auto key = JointAngleKey(joint->id(), slice.k);
+      values->insert(key, configuration.at<double>(key));
+    }
+    values->insert(unknowns);
+
+    gtsam::GaussianFactorGraph linear;
+    for (auto&& factor : graph) {
+      auto jacobian = std::dynamic_pointer_cast<gtsam::JacobianFactor>(
+          factor->linearize(*values));
+      std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+      for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+        if (unknowns.exists(*it)) terms.emplace_back(*it, jacobian->getA(it));
+      }
+      linear.emplace_shared<gtsam::JacobianFactor>(terms, jacobian->getb(),
+                                                   jacobian->get_model());
+    }
+    return linear;
+  };
+
+  std::vector<gtsam::Values> results(configurations.size());
+  if (configurations.empty()) return results;
+
+  // All configurations share the sparsity pattern, hence the ordering.
+  gtsam::Values values0;
+  const auto ordering =
+      gtsam::Ordering::Colamd(linearize(configurations[0], &values0));
+  auto solveConfiguration = [&](size_t i) {
+    gtsam::Values values;
+    const auto linear = linearize(configurations[i], &values);
+    values.update(unknowns.retract(linear.optimize(ordering)));
+    results[i] = values;
+  };
+  p_.execution.parallelFor(configurations.size(), solveConfiguration);
+  return results;
+}
+
 gtsam::Values Statics::minimizeTorques(const Slice& slice,
                                        const Robot& robot) const {
   auto graph = this->graph(slice, robot);
@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionGeometry.cpp
+ * @brief Collision primitives of a link, as read from SDF/URDF files.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/universal_robot/CollisionGeometry.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void CollisionGeometry::sweptSphere(Pose3 *comTaxis, double *half_length,
+                                    double *bound_radius) const {
+  switch (type) {
+    case Sphere:
+      *comTaxis = comTgeom;
+      *half_length = 0.0;
+      *bound_radius = radius;
+      return;
+    case Cylinder:
+    case Capsule:
+      *comTaxis = comTgeom;
+      *half_length = 0.5 * length;
+      *bound_radius = radius;
+      return;
+    case Box: {
+      // Rotate the longest side onto the z axis.
+      int axis;
+      const gtsam::Vector3 half = 0.5 * size;
+      half.maxCoeff(&axis);
+      const Rot3 geomRaxis =
+          axis == 0 ? Rot3::Ry(M_PI_2)
+                    : (axis == 1 ? Rot3::Rx(-M_PI_2) : Rot3());
+      *comTaxis = comTgeom * Pose3(geomRaxis, gtsam::Point3::Zero());
+      *half_length = half(axis);
+      *bound_radius =
+          std::sqrt(half.squaredNorm() - half(axis) * half(axis));
+      return;
+    }
+    default:
+      throw std::invalid_argument("CollisionGeometry: mesh " + name +
+                                  " has no swept-sphere bound");
+  }
+}
+
+/* ************************************************************************* */
+bool CollisionGeometry::equals(const CollisionGeometry &other,
+                               double tol) const {
+  return name == other.name && type == other.type &&
+         comTgeom.equals(other.comTgeom, tol) &&
+         std::abs(radius - other.radius) <= tol &&
+         std::abs(length - other.length) <= tol &&
+         gtsam::equal_with_abs_tol(size, other.size, tol) && uri == other.uri &&
+         gtsam::equal_with_abs_tol(scale, other.scale, tol);
+}
+
+/* ************************************************************************* */
+void CollisionGeometry::print(const std::string &s) const {
+  static const char *kTypes[] = {"sphere", "box", "cylinder", "capsule",
+                                 "mesh"};
+  std::cout << s << name << " (" << kTypes[type] << ")";
+  switch (type) {
+    case Sphere:
+      std::cout << ", radius " << radius;
+      break;
+    case Box:
+      std::cout << ", size " << size.transpose();
+      break;
+    case Mesh:
+      std::cout << ", " << uri << ", scale " << scale.transpose();
+      break;
+    default:
+      std::cout << ", radius " << radius << ", length " << length;
+  }
+  std::cout << "\n";
+  comTgeom.print("  comTgeom: ");
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionGeometry.h
+ * @brief Collision primitives of a link, as read from SDF/URDF files.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * A collision element of a link: a primitive shape, or a mesh file, with its
+ * pose in the CoM frame of the link.
+ *
+ * For distance queries every primitive is bounded by a swept sphere, i.e. the
+ * set of points within a radius of a segment: a sphere is a segment of length
+ * zero, a capsule is exact, a cylinder is bounded by the capsule with the
+ * same axis and radius, and a box by its longest axis with the radius of the
+ * diagonal of its other two sides. Meshes are not parsed, so they have no
+ * bound.
+ */
+struct CollisionGeometry {
+  enum Type { Sphere, Box, Cylinder, Capsule, Mesh };
+
+  std::string name;
+  Type type = Sphere;
+  gtsam::Pose3 comTgeom;  ///< pose of the geometry in the link CoM frame
+
+  double radius = 0.0;  ///< sphere, cylinder and capsule
+  double length = 0.0;  ///< cylinder and capsule, along the z axis
+  gtsam::Vector3 size = gtsam::Vector3::Zero();   ///< box side lengths
+  std::string uri;                                ///< mesh file
+  gtsam::Vector3 scale = gtsam::Vector3::Ones();  ///< mesh scale
+
+  /// Whether the geometry has a swept-sphere bound, i.e. is not a mesh.
+  bool hasBound() const { return type != Mesh; }
+
+  /**
+   * Swept-sphere bound of the geometry.
+   * @param comTaxis    pose in the link CoM frame of a frame whose z axis is
+   * the segment, centered at the origin
+   * @param half_length half the length of the segment
+   * @param bound_radius radius of the swept sphere
+   */
+  void sweptSphere(gtsam::Pose3 *comTaxis, double *half_length,
+                   double *bound_radius) const;
+
+  bool equals(const CollisionGeometry &other, double tol = 1e-9) const;
+
+  void print(const std::string &s = "") const;
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &BOOST_SERIALIZATION_NVP(name);
+    ar &BOOST_SERIALIZATION_NVP(type);
+    ar &BOOST_SERIALIZATION_NVP(comTgeom);
+    ar &BOOST_SERIALIZATION_NVP(radius);
+    ar &BOOST_SERIALIZATION_NVP(length);
+    ar &BOOST_SERIALIZATION_NVP(size);
+    ar &BOOST_SERIALIZATION_NVP(uri);
+    ar &BOOST_SERIALIZATION_NVP(scale);
+  }
+#endif
+};
+
+}  // namespace gtdynamics
+
+namespace gtsam {
+
+template <>
+struct traits<gtdynamics::CollisionGeometry>
+    : public Testable<gtdynamics::CollisionGeometry> {};
+
+}  // namespace gtsam
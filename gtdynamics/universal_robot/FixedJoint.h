@@ -53,6 +53,11 @@ class FixedJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const override { return Type::Fixed; }
 
+  /// Return a copy of this joint, connected to the same links.
+  JointSharedPtr clone() const override {
+    return std::make_shared<FixedJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
@@ -69,6 +69,11 @@ class HelicalJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Screw; }
 
+  /// Return a copy of this joint, connected to the same links.
+  JointSharedPtr clone() const override {
+    return std::make_shared<HelicalJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
@@ -38,8 +38,54 @@ Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
       jMc_(bTj.inverse() * child_link->bMcom()),
       pScrewAxis_(-jMp_.inverse().AdjointMap() * jScrewAxis),
       cScrewAxis_(jMc_.inverse().AdjointMap() * jScrewAxis),
+      motion_(MotionOf(jScrewAxis)),
+      jScrewAxis_(jScrewAxis),
+      pMj_(jMp_.inverse()),
+      cMj_(jMc_.inverse()),
       parameters_(parameters) {}
 
+/* ************************************************************************* */
+void Joint::setLinks(const LinkSharedPtr &parent_link,
+                     const LinkSharedPtr &child_link) {
+  const Pose3 bTj = parent_link_->bMcom() * pMj_;
+  parent_link_ = parent_link;
+  child_link_ = child_link;
+  jMp_ = bTj.inverse() * parent_link->bMcom();
+  jMc_ = bTj.inverse() * child_link->bMcom();
+  pScrewAxis_ = -jMp_.inverse().AdjointMap() * jScrewAxis_;
+  cScrewAxis_ = jMc_.inverse().AdjointMap() * jScrewAxis_;
+  pMj_ = jMp_.inverse();
+  cMj_ = jMc_.inverse();
+}
+
+/* ************************************************************************* */
+Joint::Motion Joint::MotionOf(const Vector6 &jScrewAxis) {
+  const gtsam::Vector3 w = jScrewAxis.head<3>(), v = jScrewAxis.tail<3>();
+  if (w.isZero(0)) return v.isZero(0) ? Motion::None : Motion::Translation;
+  if (v.isZero(0)) return Motion::Rotation;
+  // exp of a screw along its axis rotates about it and translates along it.
+  if (w.cross(v).norm() <= 1e-12 * w.norm() * v.norm()) return Motion::Helix;
+  return Motion::General;
+}
+
+/* ************************************************************************* */
+Pose3 Joint::jointMotion(double q) const {
+  switch (motion_) {
+    case Motion::Rotation:
+      return Pose3(gtsam::Rot3::Expmap(jScrewAxis_.head<3>() * q),
+                   gtsam::Point3::Zero());
+    case Motion::Translation:
+      return Pose3(gtsam::Rot3(), jScrewAxis_.tail<3>() * q);
+    case Motion::Helix:
+      return Pose3(gtsam::Rot3::Expmap(jScrewAxis_.head<3>() * q),
+                   jScrewAxis_.tail<3>() * q);
+    case Motion::None:
+      return Pose3();
+    default:
+      return Pose3::Expmap(jScrewAxis_ * q);
+  }
+}
+
 /* ************************************************************************* */
 bool Joint::isChildLink(const LinkSharedPtr &link) const {
   if (link != child_link_ && link != parent_link_)
@@ -51,31 +97,21 @@ bool Joint::isChildLink(const LinkSharedPtr &link) const {
 /* ************************************************************************* */
 Pose3 Joint::parentTchild(double q,
                           gtsam::OptionalJacobian<6, 1> pTc_H_q) const {
-  // Multiply screw axis with joint angle to get a finite 6D screw.
-  const Vector6 screw = cScrewAxis_ * q;
-
-  // Calculate the actual relative pose taking into account the joint angle.
-  // TODO(dellaert): use formula `pMj_ * screw_around_Z * jMc_`.
-  gtsam::Matrix6 exp_H_screw;
-  const Pose3 exp = Pose3::Expmap(screw, pTc_H_q ? &exp_H_screw : 0);
-  if (pTc_H_q) {
-    *pTc_H_q = exp_H_screw * cScrewAxis_;
-  }
-  return pMc() * exp;  // Note: derivative of compose in exp is identity.
+  // pTc = pMc * exp(cScrewAxis * q) = pMj * exp(jScrewAxis * q) * jMc.
+  // The derivative of exp(S * q) along S is S, in the child frame.
+  if (pTc_H_q) *pTc_H_q = cScrewAxis_;
+  if (motion_ == Motion::None) return pMj_ * jMc_;
+  return pMj_ * jointMotion(q) * jMc_;
 }
 
 /* ************************************************************************* */
 Pose3 Joint::childTparent(double q,
                           gtsam::OptionalJacobian<6, 1> cTp_H_q) const {
-  // TODO(frank): don't go via inverse, specialize in base class
-  Vector6 pTc_H_q;
-  Pose3 pTc = parentTchild(q, cTp_H_q ? &pTc_H_q : 0);  // pTc(q) ->  pTc_H_q
-  gtsam::Matrix6 cTp_H_pTc;
-  Pose3 cTp = pTc.inverse(cTp_H_q ? &cTp_H_pTc : 0);  // cTp(pTc) ->  cTp_H_pTc
-  if (cTp_H_q) {
-    *cTp_H_q = cTp_H_pTc * pTc_H_q;
-  }
-  return cTp;
+  // cTp = cMj * exp(-jScrewAxis * q) * jMp, whose derivative in the parent
+  // frame is -Ad(pMc) * cScrewAxis = pScrewAxis.
+  if (cTp_H_q) *cTp_H_q = pScrewAxis_;
+  if (motion_ == Motion::None) return cMj_ * jMp_;
+  return cMj_ * jointMotion(-q) * jMp_;
 }
 
 /* ************************************************************************* */
@@ -158,6 +158,18 @@ class Joint : public std::enable_shared_from_this<Joint> {
   Vector6 pScrewAxis_;
   Vector6 cScrewAxis_;
 
+  /**
+   * Closed form of the joint motion, picked from the screw axis in the joint
+   * frame, so parentTchild and childTparent need neither the virtual type()
+   * nor the generic screw exponential.
+   */
+  enum class Motion : char { Rotation, Translation, Helix, None, General };
+  Motion motion_ = Motion::General;
+
+  /// Screw axis in the joint frame, and inverse rest transforms.
+  Vector6 jScrewAxis_ = Vector6::Zero();
+  Pose3 pMj_, cMj_;
+
   /// Joint parameters struct.
   JointParams parameters_;
 
@@ -165,6 +177,17 @@ class Joint : public std::enable_shared_from_this<Joint> {
   /// connected to this joint.
   bool isChildLink(const LinkSharedPtr &link) const;
 
+  /// Classify the screw axis in the joint frame.
+  static Motion MotionOf(const Vector6 &jScrewAxis);
+
+  /// Closed form of exp(jScrewAxis_ * q), the motion in the joint frame.
+  Pose3 jointMotion(double q) const;
+
+  /// Connect to other links, e.g. composites of the original ones, keeping
+  /// the joint pose at rest, and update the rest transforms and screw axes.
+  void setLinks(const LinkSharedPtr &parent_link,
+                const LinkSharedPtr &child_link);
+
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -280,6 +303,9 @@ class Joint : public std::enable_shared_from_this<Joint> {
    */
   virtual Type type() const = 0;
 
+  /// Abstract method: Return a copy of this joint, connected to the same links.
+  virtual JointSharedPtr clone() const = 0;
+
   /**@}*/
 
   /**
@@ -469,6 +495,10 @@ class Joint : public std::enable_shared_from_this<Joint> {
     ar &BOOST_SERIALIZATION_NVP(child_link_);
     ar &BOOST_SERIALIZATION_NVP(pScrewAxis_);
     ar &BOOST_SERIALIZATION_NVP(cScrewAxis_);
+    ar &BOOST_SERIALIZATION_NVP(motion_);
+    ar &BOOST_SERIALIZATION_NVP(jScrewAxis_);
+    ar &BOOST_SERIALIZATION_NVP(pMj_);
+    ar &BOOST_SERIALIZATION_NVP(cMj_);
     ar &BOOST_SERIALIZATION_NVP(parameters_);
   }
 #endif
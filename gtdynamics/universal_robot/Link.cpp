@@ -34,13 +34,13 @@ gtsam::Vector6_ Link::wrenchConstraint(
   gtsam::Vector6_ twist(TwistKey(id(), t));
   // TODO(yetong): make Coriolis a functor and get rid of placeholders.
   gtsam::Vector6_ wrench_coriolis(
-      std::bind(Coriolis, inertiaMatrix(), std::placeholders::_1,
+      std::bind(Coriolis, inertia_matrix_, std::placeholders::_1,
                 std::placeholders::_2),
       twist);
   wrenches.push_back(wrench_coriolis);
 
   // Change in generalized momentum.
-  const gtsam::Matrix6 neg_inertia = -inertiaMatrix();
+  const gtsam::Matrix6 neg_inertia = -inertia_matrix_;
   gtsam::Vector6_ twistAccel(TwistAccelKey(id(), t));
   gtsam::Vector6_ wrench_momentum(
       std::bind(MatVecMult<6, 6>, neg_inertia, std::placeholders::_1,
@@ -72,11 +72,19 @@ gtsam::Vector6_ Link::wrenchConstraint(
 }
 
 /* ************************************************************************* */
-gtsam::Matrix6 Link::inertiaMatrix() const {
-  std::vector<gtsam::Matrix> gmm;
-  gmm.push_back(inertia_);
-  gmm.push_back(gtsam::I_3x3 * mass_);
-  return gtsam::diag(gmm);
+gtsam::Matrix6 Link::SpatialInertia(double mass,
+                                    const gtsam::Matrix3& inertia) {
+  gtsam::Matrix6 G = gtsam::Z_6x6;
+  G.topLeftCorner<3, 3>() = inertia;
+  G.bottomRightCorner<3, 3>() = gtsam::I_3x3 * mass;
+  return G;
+}
+
+/* ************************************************************************* */
+gtsam::Vector6 Link::gravityWrench(
+    const gtsam::Vector3& gravity, const gtsam::Pose3& wTcom,
+    gtsam::OptionalJacobian<6, 6> H_wTcom) const {
+  return GravityWrench(gravity, mass_, wTcom, H_wTcom);
 }
 
 /* ************************************************************************* */
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/CollisionGeometry.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
@@ -49,6 +50,9 @@ class Link : public std::enable_shared_from_this<Link> {
   gtsam::Pose3 centerOfMass_;
   gtsam::Matrix3 inertia_;
 
+  /// Spatial inertia, diag(inertia_, mass_ * I), which is constant.
+  gtsam::Matrix6 inertia_matrix_ = gtsam::Z_6x6;
+
   /// SDF Elements.
   gtsam::Pose3 bMcom_;   // CoM frame defined in the base frame at rest.
   gtsam::Pose3 bMlink_;  // link frame defined in the base frame at rest.
@@ -60,6 +64,9 @@ class Link : public std::enable_shared_from_this<Link> {
   /// Joints connected to the link
   std::vector<JointSharedPtr> joints_;
 
+  /// Collision elements, in the CoM frame.
+  std::vector<CollisionGeometry> collisions_;
+
   /// Robot class should have access to the internals of its links.
   friend class Robot;
 
@@ -87,6 +94,7 @@ class Link : public std::enable_shared_from_this<Link> {
         name_(name),
         mass_(mass),
         inertia_(inertia),
+        inertia_matrix_(SpatialInertia(mass, inertia)),
         bMcom_(bMcom),
         bMlink_(bMlink),
         is_fixed_(is_fixed) {}
@@ -135,6 +143,16 @@ class Link : public std::enable_shared_from_this<Link> {
   /// return the number of connected joints
   size_t numJoints() const { return joints_.size(); }
 
+  /// Return the collision elements of the link.
+  const std::vector<CollisionGeometry> &collisions() const {
+    return collisions_;
+  }
+
+  /// Add a collision element, with its pose in the CoM frame.
+  void addCollision(const CollisionGeometry &collision) {
+    collisions_.push_back(collision);
+  }
+
   /// Return link name.
   const std::string &name() const { return name_; }
 
@@ -147,8 +165,29 @@ class Link : public std::enable_shared_from_this<Link> {
   /// Return inertia.
   const gtsam::Matrix3 &inertia() const { return inertia_; }
 
-  /// Return general mass gtsam::Matrix
-  gtsam::Matrix6 inertiaMatrix() const;
+  /// Return general mass gtsam::Matrix, computed once at construction.
+  const gtsam::Matrix6 &inertiaMatrix() const { return inertia_matrix_; }
+
+  /// Spatial inertia diag(inertia, mass * I) of a rigid body.
+  static gtsam::Matrix6 SpatialInertia(double mass,
+                                       const gtsam::Matrix3 &inertia);
+
+  /// Set the mass and the inertia about the CoM, e.g. identified from data.
+  void setInertialParameters(double mass, const gtsam::Matrix3 &inertia) {
+    mass_ = mass;
+    inertia_ = inertia;
+    inertia_matrix_ = SpatialInertia(mass, inertia);
+  }
+
+  /**
+   * Gravity wrench on the link in its CoM frame, as GravityWrench.
+   * @param gravity Gravity vector in the world frame.
+   * @param wTcom Pose of the link CoM frame.
+   * @param H_wTcom Optional Jacobian of the wrench wrt the pose.
+   */
+  gtsam::Vector6 gravityWrench(
+      const gtsam::Vector3 &gravity, const gtsam::Pose3 &wTcom,
+      gtsam::OptionalJacobian<6, 6> H_wTcom = {}) const;
 
   /// Functional way to fix a link
   static Link fix(const Link &link,
@@ -208,10 +247,12 @@ class Link : public std::enable_shared_from_this<Link> {
     ar &BOOST_SERIALIZATION_NVP(mass_);
     ar &BOOST_SERIALIZATION_NVP(centerOfMass_);
     ar &BOOST_SERIALIZATION_NVP(inertia_);
+    ar &BOOST_SERIALIZATION_NVP(inertia_matrix_);
     ar &BOOST_SERIALIZATION_NVP(bMcom_);
     ar &BOOST_SERIALIZATION_NVP(bMlink_);
     ar &BOOST_SERIALIZATION_NVP(is_fixed_);
     ar &BOOST_SERIALIZATION_NVP(fixed_pose_);
+    ar &BOOST_SERIALIZATION_NVP(collisions_);
   }
 #endif
 
@@ -62,6 +62,11 @@ class PrismaticJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Prismatic; }
 
+  /// Return a copy of this joint, connected to the same links.
+  JointSharedPtr clone() const override {
+    return std::make_shared<PrismaticJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
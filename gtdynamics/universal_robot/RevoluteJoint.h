@@ -61,6 +61,11 @@ class RevoluteJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Revolute; }
 
+  /// Return a copy of this joint, connected to the same links.
+  JointSharedPtr clone() const override {
+    return std::make_shared<RevoluteJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
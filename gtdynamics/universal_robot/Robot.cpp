@@ -18,10 +18,13 @@
 #include <gtdynamics/utils/values.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <queue>
+#include <set>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
 
 using gtsam::Pose3;
 using gtsam::Vector3;
@@ -39,14 +42,92 @@ std::vector<V> getValues(std::map<K, V> m) {
 }
 
 Robot::Robot(const LinkMap &links, const JointMap &joints)
-    : name_to_link_(links), name_to_joint_(joints) {}
-
-std::vector<LinkSharedPtr> Robot::links() const {
-  return getValues<std::string, LinkSharedPtr>(name_to_link_);
+    : name_to_link_(links), name_to_joint_(joints) {
+  updateTopology();
 }
 
-std::vector<JointSharedPtr> Robot::joints() const {
-  return getValues<std::string, JointSharedPtr>(name_to_joint_);
+void Robot::updateTopology() {
+  links_ = getValues<std::string, LinkSharedPtr>(name_to_link_);
+  joints_ = getValues<std::string, JointSharedPtr>(name_to_joint_);
+
+  RobotTopology &topo = topology_;
+  topo = RobotTopology();
+  size_t num_link_ids = 0, num_joint_ids = 0;
+  for (auto &&link : links_) {
+    num_link_ids = std::max<size_t>(num_link_ids, link->id() + 1);
+  }
+  for (auto &&joint : joints_) {
+    num_joint_ids = std::max<size_t>(num_joint_ids, joint->id() + 1);
+  }
+
+  topo.links.resize(num_link_ids);
+  topo.inertia.assign(num_link_ids, gtsam::Matrix6::Zero());
+  for (auto &&link : links_) {
+    topo.links[link->id()] = link;
+    topo.inertia[link->id()] = link->inertiaMatrix();
+  }
+  topo.joints.resize(num_joint_ids);
+  topo.parent_link.assign(num_joint_ids, -1);
+  topo.child_link.assign(num_joint_ids, -1);
+  topo.screw_axis.assign(num_joint_ids, Vector6::Zero());
+  topo.pMc.resize(num_joint_ids);
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    topo.joints[j] = joint;
+    topo.parent_link[j] = joint->parent()->id();
+    topo.child_link[j] = joint->child()->id();
+    topo.screw_axis[j] = joint->cScrewAxis();
+    topo.pMc[j] = joint->pMc();
+  }
+
+  // Breadth-first spanning tree from every link.
+  topo.trees.resize(num_link_ids);
+  std::vector<bool> visited(num_link_ids);
+  for (auto &&root : topo.links) {
+    if (!root) continue;
+    RobotTopology::Tree &tree = topo.trees[root->id()];
+    std::fill(visited.begin(), visited.end(), false);
+    visited[root->id()] = true;
+    std::queue<LinkSharedPtr> q;
+    q.push(root);
+    while (!q.empty()) {
+      const LinkSharedPtr link1 = q.front();
+      q.pop();
+      for (auto &&joint : link1->joints()) {
+        const LinkSharedPtr link2 = joint->otherLink(link1);
+        if (link2->id() >= num_link_ids || topo.links[link2->id()] != link2 ||
+            visited[link2->id()]) {
+          continue;
+        }
+        visited[link2->id()] = true;
+        tree.joints.push_back(joint->id());
+        tree.from.push_back(link1->id());
+        q.push(link2);
+      }
+    }
+  }
+
+  // Spanning forest, fixed links first so they become roots.
+  std::fill(visited.begin(), visited.end(), false);
+  auto addTree = [&](const LinkSharedPtr &root) {
+    const RobotTopology::Tree &tree = topo.trees[root->id()];
+    topo.roots.push_back(root->id());
+    visited[root->id()] = true;
+    for (size_t k = 0; k < tree.joints.size(); ++k) {
+      const int j = tree.joints[k];
+      visited[topo.parent_link[j]] = visited[topo.child_link[j]] = true;
+    }
+    topo.traversal.insert(topo.traversal.end(), tree.joints.begin(),
+                          tree.joints.end());
+    topo.traversal_from.insert(topo.traversal_from.end(), tree.from.begin(),
+                               tree.from.end());
+  };
+  for (auto &&link : topo.links) {
+    if (link && link->isFixed() && !visited[link->id()]) addTree(link);
+  }
+  for (auto &&link : topo.links) {
+    if (link && !visited[link->id()]) addTree(link);
+  }
 }
 
 void Robot::removeLink(const LinkSharedPtr &link) {
@@ -58,6 +139,7 @@ void Robot::removeLink(const LinkSharedPtr &link) {
 
   // remove link from name_to_link_
   name_to_link_.erase(link->name());
+  updateTopology();
 }
 
 void Robot::removeJoint(const JointSharedPtr &joint) {
@@ -67,6 +149,7 @@ void Robot::removeJoint(const JointSharedPtr &joint) {
   }
   // Remove the joint from name_to_joint_
   name_to_joint_.erase(joint->name());
+  updateTopology();
 }
 
 LinkSharedPtr Robot::link(const std::string &name) const {
@@ -76,13 +159,17 @@ LinkSharedPtr Robot::link(const std::string &name) const {
   return name_to_link_.at(name);
 }
 
-Robot Robot::fixLink(const std::string &name) {
+Robot Robot::fixLink(const std::string &name,
+                     const std::optional<gtsam::Pose3> &fixed_pose) {
   if (name_to_link_.find(name) == name_to_link_.end()) {
     throw std::runtime_error("no link named " + name);
   }
 
+  // Links are shared with the copy, so both change roots.
   Robot fixed_robot = Robot(*this);
-  fixed_robot.name_to_link_.at(name)->fix();
+  fixed_robot.name_to_link_.at(name)->fix(fixed_pose);
+  updateTopology();
+  fixed_robot.updateTopology();
   return fixed_robot;
 }
 
@@ -93,6 +180,8 @@ Robot Robot::unfixLink(const std::string &name) {
 
   Robot unfixed_robot = Robot(*this);
   unfixed_robot.name_to_link_.at(name)->unfix();
+  updateTopology();
+  unfixed_robot.updateTopology();
   return unfixed_robot;
 }
 
@@ -103,6 +192,157 @@ JointSharedPtr Robot::joint(const std::string &name) const {
   return name_to_joint_.at(name);
 }
 
+Robot Robot::clone() const {
+  LinkMap links;
+  for (auto &&name_link : name_to_link_) {
+    auto link = std::make_shared<Link>(*name_link.second);
+    link->joints_.clear();
+    links.emplace(name_link.first, link);
+  }
+
+  JointMap joints;
+  for (auto &&name_joint : name_to_joint_) {
+    const JointSharedPtr &joint = name_joint.second;
+    JointSharedPtr copy = joint->clone();
+    copy->parent_link_ = links.at(joint->parent()->name());
+    copy->child_link_ = links.at(joint->child()->name());
+    joints.emplace(name_joint.first, copy);
+  }
+
+  // Reconnect links to the copied joints, in the same order.
+  for (auto &&name_link : name_to_link_) {
+    for (auto &&joint : name_link.second->joints()) {
+      auto it = joints.find(joint->name());
+      if (it != joints.end()) links.at(name_link.first)->addJoint(it->second);
+    }
+  }
+  return Robot(links, joints);
+}
+
+Robot Robot::mergeFixedJoints(MergedLinks *merged_links) const {
+  // Group links connected by fixed joints, with union-find on link names.
+  std::map<std::string, std::string> group_of;
+  for (auto &&name_link : name_to_link_) {
+    group_of[name_link.first] = name_link.first;
+  }
+  std::function<std::string(const std::string &)> find =
+      [&](const std::string &name) {
+        std::string &parent = group_of.at(name);
+        if (parent != name) parent = find(parent);
+        return parent;
+      };
+  std::set<std::string> fixed_children;
+  for (auto &&name_joint : name_to_joint_) {
+    const JointSharedPtr &joint = name_joint.second;
+    if (joint->type() != Joint::Type::Fixed) continue;
+    group_of[find(joint->parent()->name())] = find(joint->child()->name());
+    fixed_children.insert(joint->child()->name());
+  }
+  std::map<std::string, std::vector<LinkSharedPtr>> groups;
+  for (auto &&name_link : name_to_link_) {
+    groups[find(name_link.first)].push_back(name_link.second);
+  }
+
+  // The root of each group: its fixed link, else a link that is not the
+  // child of a fixed joint, else its first link.
+  std::vector<std::pair<LinkSharedPtr, std::vector<LinkSharedPtr>>> composites;
+  for (auto &&group : groups) {
+    const std::vector<LinkSharedPtr> &members = group.second;
+    auto root =
+        std::find_if(members.begin(), members.end(),
+                     [](const LinkSharedPtr &l) { return l->isFixed(); });
+    if (root == members.end()) {
+      root = std::find_if(members.begin(), members.end(),
+                          [&](const LinkSharedPtr &l) {
+                            return !fixed_children.count(l->name());
+                          });
+    }
+    if (root == members.end()) root = members.begin();
+    composites.emplace_back(*root, members);
+  }
+  std::sort(composites.begin(), composites.end(),
+            [](const auto &a, const auto &b) {
+              return a.first->id() < b.first->id();
+            });
+
+  // Combine mass, CoM and inertia, the latter with the parallel axis theorem.
+  LinkMap links;
+  std::map<std::string, LinkSharedPtr> composite_of;
+  MergedLinks merged;
+  uint8_t link_id = 0;
+  for (auto &&composite : composites) {
+    const LinkSharedPtr &root = composite.first;
+    double mass = 0.0;
+    gtsam::Point3 moment = gtsam::Point3::Zero();
+    for (auto &&link : composite.second) {
+      mass += link->mass();
+      moment += link->mass() * link->bMcom().translation();
+    }
+    const gtsam::Point3 com =
+        mass > 0 ? gtsam::Point3(moment / mass) : root->bMcom().translation();
+    const gtsam::Pose3 bMcom(root->bMcom().rotation(), com);
+
+    gtsam::Matrix3 inertia = gtsam::Z_3x3;
+    std::vector<CollisionGeometry> collisions;
+    for (auto &&link : composite.second) {
+      const gtsam::Pose3 cMlink = bMcom.between(link->bMcom());
+      const gtsam::Matrix3 R = cMlink.rotation().matrix();
+      const gtsam::Vector3 d = cMlink.translation();
+      inertia += R * link->inertia() * R.transpose() +
+                 link->mass() * (d.dot(d) * gtsam::I_3x3 - d * d.transpose());
+      for (CollisionGeometry collision : link->collisions()) {
+        collision.comTgeom = cMlink * collision.comTgeom;
+        collisions.push_back(collision);
+      }
+      merged[link->name()] = MergedLink{root->name(), cMlink};
+    }
+
+    auto link = std::make_shared<Link>(link_id++, root->name(), mass, inertia,
+                                       bMcom, root->bMlink());
+    if (root->isFixed()) {
+      const gtsam::Pose3 &cMroot = merged.at(root->name()).cMlink;
+      link->fix(root->getFixedPose() * cMroot.inverse());
+    }
+    link->collisions_ = collisions;
+    links.emplace(root->name(), link);
+    for (auto &&member : composite.second) composite_of[member->name()] = link;
+  }
+
+  // Reconnect the joints between groups, in their original id order.
+  std::vector<JointSharedPtr> kept;
+  for (auto &&name_joint : name_to_joint_) {
+    const JointSharedPtr &joint = name_joint.second;
+    if (composite_of.at(joint->parent()->name()) !=
+        composite_of.at(joint->child()->name())) {
+      kept.push_back(joint);
+    }
+  }
+  std::sort(kept.begin(), kept.end(),
+            [](const JointSharedPtr &a, const JointSharedPtr &b) {
+              return a->id() < b->id();
+            });
+  JointMap joints;
+  uint8_t joint_id = 0;
+  for (auto &&joint : kept) {
+    JointSharedPtr copy = joint->clone();
+    copy->id_ = joint_id++;
+    copy->setLinks(composite_of.at(joint->parent()->name()),
+                   composite_of.at(joint->child()->name()));
+    joints.emplace(joint->name(), copy);
+  }
+  for (auto &&name_link : name_to_link_) {
+    for (auto &&joint : name_link.second->joints()) {
+      auto it = joints.find(joint->name());
+      if (it != joints.end()) {
+        composite_of.at(name_link.first)->addJoint(it->second);
+      }
+    }
+  }
+
+  if (merged_links) *merged_links = merged;
+  return Robot(links, joints);
+}
+
 int Robot::numLinks() const { return name_to_link_.size(); }
 
 int Robot::numJoints() const { return name_to_joint_.size(); }
@@ -147,7 +387,6 @@ void Robot::print(const std::string &s) const {
 }
 
 LinkSharedPtr Robot::findRootLink(
-    const gtsam::Values &values,
     const std::optional<std::string> &prior_link_name) const {
   LinkSharedPtr root_link;
 
@@ -155,7 +394,7 @@ LinkSharedPtr Robot::findRootLink(
   if (prior_link_name) {
     root_link = link(*prior_link_name);
   } else {
-    auto links = this->links();
+    const auto &links = this->links();
     auto links_iter =
         std::find_if(links.rbegin(), links.rend(),
                      [](const LinkSharedPtr &link) { return link->isFixed(); });
@@ -226,7 +465,7 @@ gtsam::Values Robot::forwardKinematics(
   gtsam::Values values = known_values;
 
   // Set root link.
-  const auto root_link = findRootLink(values, prior_link_name);
+  const auto root_link = findRootLink(prior_link_name);
   InsertFixedLinks(links(), t, &values);
 
   if (!values.exists(PoseKey(root_link->id(), t))) {
@@ -265,4 +504,49 @@ gtsam::Values Robot::forwardKinematics(
   return values;
 }
 
+void Robot::forwardKinematics(
+    const gtsam::Vector &q, const gtsam::Vector &v, LinkStates *states,
+    const std::optional<std::string> &prior_link_name, const Pose3 &root_pose,
+    const Vector6 &root_twist) const {
+  const size_t num_link_ids = topology_.links.size();
+  if (states->poses.size() != num_link_ids) {
+    states->poses.resize(num_link_ids);
+    states->twists.resize(num_link_ids);
+  }
+
+  const auto root_link = findRootLink(prior_link_name);
+  const int root = root_link->id();
+  if (root_link->isFixed()) {
+    states->poses[root] = root_link->getFixedPose();
+    states->twists[root].setZero();
+  } else {
+    states->poses[root] = root_pose;
+    states->twists[root] = root_twist;
+  }
+
+  // Walk the cached spanning tree, parents are always reached first.
+  const RobotTopology::Tree &tree = topology_.trees[root];
+  for (size_t k = 0; k < tree.joints.size(); ++k) {
+    const int j = tree.joints[k], i1 = tree.from[k];
+    const auto &joint = topology_.joints[j];
+    const auto &link1 = topology_.links[i1];
+    const int i2 = topology_.parent_link[j] == i1 ? topology_.child_link[j]
+                                                  : topology_.parent_link[j];
+    std::tie(states->poses[i2], states->twists[i2]) = joint->otherPoseTwist(
+        link1, states->poses[i1], states->twists[i1], q(j), v(j));
+  }
+}
+
+PointOnLinks MergeContactPoints(const PointOnLinks &points,
+                                const Robot &merged_robot,
+                                const MergedLinks &merged_links) {
+  PointOnLinks merged_points;
+  for (auto &&point : points) {
+    const MergedLink &merged = merged_links.at(point.link->name());
+    merged_points.emplace_back(merged_robot.link(merged.name),
+                               merged.cMlink * point.point);
+  }
+  return merged_points;
+}
+
 }  // namespace gtdynamics.
@@ -17,6 +17,7 @@
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
+#include <gtdynamics/utils/PointOnLink.h>
 
 #include <map>
 #include <optional>
@@ -42,11 +43,60 @@ using LinkTwists = std::map<std::string, gtsam::Vector6>;
 // type for storing forward kinematics results
 using FKResults = std::pair<LinkPoses, LinkTwists>;
 
+/**
+ * Flat arrays describing a robot, indexed by link or joint id, so that hot
+ * loops need neither map lookups nor allocations. Entries for ids not used by
+ * any link or joint are null pointers and -1 indices.
+ */
+struct RobotTopology {
+  std::vector<LinkSharedPtr> links;          ///< by link id
+  std::vector<JointSharedPtr> joints;        ///< by joint id
+  std::vector<int> parent_link, child_link;  ///< link ids, by joint id
+  std::vector<gtsam::Vector6> screw_axis;    ///< in child frame, by joint id
+  std::vector<gtsam::Pose3> pMc;             ///< child in parent at rest
+  std::vector<gtsam::Matrix6> inertia;       ///< by link id
+
+  /// Joint ids of a spanning forest in breadth-first order, each tree rooted
+  /// at a fixed link if it has one, else at its lowest link id. Joints that
+  /// close kinematic loops are left out.
+  std::vector<int> traversal;
+  std::vector<int> traversal_from;  ///< link each traversal joint leaves from
+  std::vector<int> roots;           ///< root link id of each tree
+
+  /// Breadth-first spanning tree of the component containing a root link.
+  struct Tree {
+    std::vector<int> joints;  ///< joint ids, in traversal order
+    std::vector<int> from;    ///< link id each joint leaves from
+  };
+  std::vector<Tree> trees;  ///< spanning tree rooted at each link, by link id
+};
+
+/// Link CoM poses and twists, indexed by link id.
+struct LinkStates {
+  std::vector<gtsam::Pose3> poses;
+  std::vector<gtsam::Vector6> twists;
+};
+
+/// Where a link went in Robot::mergeFixedJoints.
+struct MergedLink {
+  std::string name;     ///< name of the composite link
+  gtsam::Pose3 cMlink;  ///< CoM of the link in the composite CoM frame
+};
+
+/// MergedLink of each link of the original robot, by link name.
+using MergedLinks = std::map<std::string, MergedLink>;
+
 /**
  * Robot is used to create a representation of a robot's
  * inertial/dynamic properties from a URDF/SDF file. The resulting object
  * provides getters for the robot's various joints and links, which can then
  * be fed into an optimization pipeline.
+ *
+ * Const methods may be called concurrently from several threads, and factors
+ * may share the robot's links and joints, as long as no thread modifies the
+ * robot or its links and joints at the same time, e.g., with removeLink,
+ * fixLink or Link::addJoint. Note that fixLink and unfixLink also modify the
+ * original's links; use clone() or SharedRobot for variants used concurrently.
  */
 class Robot {
  private:
@@ -54,6 +104,14 @@ class Robot {
   LinkMap name_to_link_;
   JointMap name_to_joint_;
 
+  // Caches rebuilt whenever links or joints are added or removed.
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  RobotTopology topology_;
+
+  /// Rebuild the cached link/joint vectors and the topology arrays.
+  void updateTopology();
+
  public:
   /** Default Constructor */
   Robot() {}
@@ -67,11 +125,18 @@ class Robot {
    */
   explicit Robot(const LinkMap &links, const JointMap &joints);
 
-  /// Return this robot's links.
-  std::vector<LinkSharedPtr> links() const;
+  /// Return this robot's links, sorted by name.
+  const std::vector<LinkSharedPtr> &links() const { return links_; }
 
-  /// Return this robot's joints.
-  std::vector<JointSharedPtr> joints() const;
+  /// Return this robot's joints, sorted by name.
+  const std::vector<JointSharedPtr> &joints() const { return joints_; }
+
+  /**
+   * Return id-indexed arrays of the robot's topology and constant properties.
+   * They are kept up to date by removeLink and removeJoint, but not when
+   * links or joints are modified directly.
+   */
+  const RobotTopology &topology() const { return topology_; }
 
   /// remove specified link from the robot
   void removeLink(const LinkSharedPtr &link);
@@ -87,9 +152,12 @@ class Robot {
    * string as a fixed link.
    *
    * @param name The name of the link to fix.
+   * @param fixed_pose The pose to fix the link at, defaults to its rest CoM
+   * pose.
    * @return Robot
    */
-  Robot fixLink(const std::string &name);
+  Robot fixLink(const std::string &name,
+                const std::optional<gtsam::Pose3> &fixed_pose = {});
 
   /**
    * @brief Return a copy of this robot after unfixing the link corresponding to
@@ -103,6 +171,34 @@ class Robot {
   /// Return the joint corresponding to the input string.
   JointSharedPtr joint(const std::string &name) const;
 
+  /**
+   * Return a deep copy of this robot, with new links and joints, so that
+   * fixing links of either robot does not affect the other. Note that
+   * fixLink and unfixLink copies share links with the original.
+   */
+  Robot clone() const;
+
+  /**
+   * Return a robot in which the links connected by fixed joints, e.g. sensor
+   * and mount links, are merged into composite rigid bodies, with the
+   * combined mass, CoM and inertia, and without the fixed joints. This
+   * removes the pose, twist, acceleration and wrench variables of the merged
+   * links and joints from the graphs of the robot.
+   *
+   * A composite takes the name, link frame and fixed pose of the fixed link
+   * of its group if there is one, else of the link that is not the child of
+   * a fixed joint in the group; its CoM frame is that link's, moved to the
+   * combined CoM. Collision geometries move to the composite; other joints
+   * are reconnected to it, with the same joint poses at rest, and joints
+   * within a group are dropped, as the group is rigid. Link and joint ids
+   * are renumbered from zero, in their original order.
+   *
+   * @param merged_links if given, where each link went, e.g. for
+   * MergeContactPoints
+   * @return a new robot, sharing no links or joints with this one.
+   */
+  Robot mergeFixedJoints(MergedLinks *merged_links = nullptr) const;
+
   /// Return number of *moving* links.
   int numLinks() const;
 
@@ -158,10 +254,30 @@ class Robot {
       const gtsam::Values &known_values, size_t t = 0,
       const std::optional<std::string> &prior_link_name = {}) const;
 
+  /**
+   * Fast forward kinematics along the cached spanning tree of the root link,
+   * for repeated calls, e.g. in sampling-based planning. Joints that close
+   * kinematic loops are not checked for consistency, and links outside the
+   * component of the root are left untouched.
+   *
+   * @param[in] q joint angles, indexed by joint id
+   * @param[in] v joint velocities, indexed by joint id
+   * @param[out] states CoM poses and twists, resized to the number of link
+   * ids if needed, so that a reused buffer is not reallocated
+   * @param[in] prior_link_name name of the root link, defaults to the fixed
+   * link used by forwardKinematics
+   * @param[in] root_pose pose of the root link, ignored if it is fixed
+   * @param[in] root_twist twist of the root link, ignored if it is fixed
+   */
+  void forwardKinematics(
+      const gtsam::Vector &q, const gtsam::Vector &v, LinkStates *states,
+      const std::optional<std::string> &prior_link_name = {},
+      const gtsam::Pose3 &root_pose = gtsam::Pose3(),
+      const gtsam::Vector6 &root_twist = gtsam::Vector6::Zero()) const;
+
  private:
   /// Find root link for forward kinematics
   LinkSharedPtr findRootLink(
-      const gtsam::Values &values,
       const std::optional<std::string> &prior_link_name) const;
 
   /// @name Advanced Interface
@@ -174,11 +290,36 @@ class Robot {
   void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
     ar &BOOST_SERIALIZATION_NVP(name_to_link_);
     ar &BOOST_SERIALIZATION_NVP(name_to_joint_);
+    if (ARCHIVE::is_loading::value) {
+      // Links do not serialize their joints: reconnect them in joint id
+      // order, which is the order in which the sdf parser adds them, before
+      // the topology walks them.
+      std::vector<JointSharedPtr> joints;
+      for (auto &&name_joint : name_to_joint_) {
+        joints.push_back(name_joint.second);
+      }
+      std::sort(joints.begin(), joints.end(),
+                [](const JointSharedPtr &a, const JointSharedPtr &b) {
+                  return a->id() < b->id();
+                });
+      for (auto &&joint : joints) {
+        joint->parent()->addJoint(joint);
+        joint->child()->addJoint(joint);
+      }
+      updateTopology();
+    }
   }
 #endif
 
   /// @}
 };
+
+/// Map contact points on links of a robot to the composite links of the
+/// robot that mergeFixedJoints returned, with its merged_links.
+PointOnLinks MergeContactPoints(const PointOnLinks &points,
+                                const Robot &merged_robot,
+                                const MergedLinks &merged_links);
+
 }  // namespace gtdynamics
 
 namespace gtsam {
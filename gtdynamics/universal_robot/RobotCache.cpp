@@ -0,0 +1,191 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file RobotCache.cpp
+ * @brief Binary cache of robots parsed from URDF/SDF files.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/runtime/RuntimeRobotTable.h>
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/universal_robot/sdf.h>
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+#include <gtsam/base/serialization.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+// 64-bit FNV-1a, so hashes are stable across platforms and standard libraries.
+static uint64_t Fnv1a(const std::string &bytes, uint64_t hash) {
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/* ************************************************************************* */
+uint64_t RobotModelHash(const std::string &file_path,
+                        const std::string &model_name,
+                        bool preserve_fixed_joint) {
+  std::ifstream is(file_path, std::ios::binary);
+  if (!is.good()) {
+    throw std::runtime_error("RobotModelHash: no file found at " + file_path);
+  }
+  const std::string contents((std::istreambuf_iterator<char>(is)),
+                             std::istreambuf_iterator<char>());
+  uint64_t hash = Fnv1a(contents, 0xcbf29ce484222325ULL);
+  hash = Fnv1a(model_name, hash);
+  return Fnv1a(preserve_fixed_joint ? "1" : "0", hash);
+}
+
+/* ************************************************************************* */
+static runtime::Transform ToTransform(const gtsam::Pose3 &pose) {
+  runtime::Transform T;
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) T.R[3 * i + j] = R(i, j);
+    T.t[i] = pose.translation()(i);
+  }
+  return T;
+}
+
+/* ************************************************************************* */
+runtime::RobotTable ToRobotTable(const Robot &robot) {
+  runtime::RobotTable table;
+  for (auto &&link : robot.links()) {
+    runtime::RobotTable::Link entry;
+    entry.name = link->name();
+    entry.id = link->id();
+    entry.fixed = link->isFixed();
+    entry.fixed_pose = ToTransform(link->getFixedPose());
+    entry.mass = link->mass();
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        entry.inertia[3 * i + j] = link->inertia()(i, j);
+      }
+    }
+    table.links.push_back(entry);
+  }
+  for (auto &&joint : robot.joints()) {
+    runtime::RobotTable::Joint entry;
+    entry.name = joint->name();
+    entry.id = joint->id();
+    entry.parent = joint->parent()->id();
+    entry.child = joint->child()->id();
+    for (int i = 0; i < 6; i++) entry.screw_axis[i] = joint->cScrewAxis()(i);
+    entry.pMc = ToTransform(joint->pMc());
+    table.joints.push_back(entry);
+  }
+  return table;
+}
+
+/* ************************************************************************* */
+std::string RobotCachePath(const std::string &cache_dir, uint64_t hash) {
+  std::stringstream name;
+  name << std::hex << hash << ".robot";
+  return (std::filesystem::path(cache_dir) / name.str()).string();
+}
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+/* ************************************************************************* */
+// Joints are serialized through base class pointers, so the archive needs to
+// know the derived types. Registering them per archive, in the same order for
+// saving and loading, avoids global BOOST_CLASS_EXPORT declarations.
+template <class ARCHIVE>
+static void RegisterJointTypes(ARCHIVE &ar) {
+  ar.template register_type<RevoluteJoint>();
+  ar.template register_type<PrismaticJoint>();
+  ar.template register_type<HelicalJoint>();
+  ar.template register_type<FixedJoint>();
+}
+#endif
+
+/* ************************************************************************* */
+void SaveRobotCache(const Robot &robot, uint64_t hash,
+                    const std::string &cache_path) {
+  // Write to a uniquely named temporary file and rename it, so that
+  // concurrent readers never see a partially written cache file.
+  const std::string tmp_path =
+      cache_path + ".tmp" + std::to_string(std::random_device()());
+  {
+    std::ofstream os(tmp_path, std::ios::binary);
+    if (!os.good()) {
+      throw std::runtime_error("SaveRobotCache: cannot write " + tmp_path);
+    }
+    runtime::WriteRobotTable(os, hash, ToRobotTable(robot));
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+    boost::archive::binary_oarchive ar(os);
+    RegisterJointTypes(ar);
+    ar << robot;
+#endif
+  }
+  std::filesystem::rename(tmp_path, cache_path);
+}
+
+/* ************************************************************************* */
+std::optional<Robot> LoadRobotCache(const std::string &cache_path,
+                                    uint64_t hash) {
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  std::ifstream is(cache_path, std::ios::binary);
+  if (!is.good()) return {};
+  try {
+    uint64_t cached_hash;
+    runtime::ReadRobotTable(is, &cached_hash);
+    if (cached_hash != hash) return {};
+    boost::archive::binary_iarchive ar(is);
+    RegisterJointTypes(ar);
+    Robot robot;
+    ar >> robot;
+    return robot;
+  } catch (const std::exception &) {
+    // Corrupt or incompatible file: treat as a cache miss.
+    return {};
+  }
+#else
+  return {};
+#endif
+}
+
+/* ************************************************************************* */
+Robot CreateRobotFromFileCached(const std::string &file_path,
+                                const std::string &cache_dir,
+                                const std::string &model_name,
+                                bool preserve_fixed_joint) {
+  const uint64_t hash =
+      RobotModelHash(file_path, model_name, preserve_fixed_joint);
+  const std::string cache_path = RobotCachePath(cache_dir, hash);
+  if (auto robot = LoadRobotCache(cache_path, hash)) return *robot;
+
+  Robot robot =
+      CreateRobotFromFile(file_path, model_name, preserve_fixed_joint);
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  std::filesystem::create_directories(cache_dir);
+  SaveRobotCache(robot, hash, cache_path);
+#endif
+  return robot;
+}
+
+}  // namespace gtdynamics
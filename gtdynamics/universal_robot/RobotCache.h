@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file RobotCache.h
+ * @brief Binary cache of robots parsed from URDF/SDF files.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/runtime/RuntimeRobotTable.h>
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Hash of a model file's contents and of the options it is parsed with, used
+ * to key the robot cache. Files included by the model, e.g. meshes, are not
+ * hashed.
+ * @param[in] file_path path to the urdf or sdf file.
+ * @param[in] model_name name of the model in the file, as for
+ *    CreateRobotFromFile.
+ * @param[in] preserve_fixed_joint as for CreateRobotFromFile.
+ */
+uint64_t RobotModelHash(const std::string &file_path,
+                        const std::string &model_name = "",
+                        bool preserve_fixed_joint = false);
+
+/// Links and joints of a robot as plain numbers, in the order of the robot.
+runtime::RobotTable ToRobotTable(const Robot &robot);
+
+/**
+ * Write a robot to a binary cache file, tagged with the hash of its source:
+ * the header of runtime::WriteRobotTable, which runtime::Model::Load reads
+ * without GTSAM, followed by the Boost archive of the robot if GTDynamics is
+ * built with Boost serialization. Throws if the file cannot be written.
+ */
+void SaveRobotCache(const Robot &robot, uint64_t hash,
+                    const std::string &cache_path);
+
+/**
+ * Read a robot from a binary cache file.
+ * @return the robot, or nothing if the file does not exist, is corrupt, was
+ * written for a different hash or cache format, or if GTDynamics is built
+ * without Boost serialization.
+ */
+std::optional<Robot> LoadRobotCache(const std::string &cache_path,
+                                    uint64_t hash);
+
+/// Path of the cache file for a given hash in a cache directory.
+std::string RobotCachePath(const std::string &cache_dir, uint64_t hash);
+
+/**
+ * @fn Construct Robot from a urdf or sdf file, through a binary cache: if
+ * cache_dir has an up to date entry for the file, it is loaded without parsing
+ * XML, otherwise the file is parsed and the entry is written.
+ * @param[in] file_path path to the file.
+ * @param[in] cache_dir directory of cache files, created if needed.
+ * @param[in] model_name name of the robot we care about. Must be specified in
+ *    case sdf_file_path points to a world file.
+ * @param[in] preserve_fixed_joint Flag indicating if the fixed joints in the
+ * URDF file should be preserved and not merged.
+ */
+Robot CreateRobotFromFileCached(const std::string &file_path,
+                                const std::string &cache_dir,
+                                const std::string &model_name = "",
+                                bool preserve_fixed_joint = false);
+
+}  // namespace gtdynamics
@@ -0,0 +1,157 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotGenerator.cpp
+ * @brief Synthetic serial, branched and legged robots of arbitrary size.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+
+#include <cmath>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/// Largest number of links and joints, with ids of type uint8_t.
+static constexpr size_t kMaxJoints = 255;
+
+/// Angle between sibling links of branched robots.
+static constexpr double kFanAngle = 0.4;
+
+/* ************************************************************************* */
+/// A uniform rod starting at `start`, along the z-axis of the rotation R.
+static LinkSharedPtr RodLink(uint8_t id, const std::string &name,
+                             const Rot3 &R, const Point3 &start,
+                             const SyntheticRobotParams &params) {
+  const double m = params.link_mass, l = params.link_length,
+               r = params.link_radius;
+  const double transverse = m * (3 * r * r + l * l) / 12;
+  const gtsam::Matrix3 inertia =
+      Vector3(transverse, transverse, m * r * r / 2).asDiagonal();
+  const Pose3 bMcom(R, start + R.rotate(Point3(0, 0, l / 2)));
+  return std::make_shared<Link>(id, name, m, inertia, bMcom, bMcom);
+}
+
+/* ************************************************************************* */
+/// Add a revolute joint between two links, with the child link.
+static void AddJoint(uint8_t id, const std::string &name, const Pose3 &bTj,
+                     const LinkSharedPtr &parent, const LinkSharedPtr &child,
+                     const Vector3 &axis, const SyntheticRobotParams &params,
+                     LinkMap *links, JointMap *joints) {
+  auto joint = std::make_shared<RevoluteJoint>(id, name, bTj, parent, child,
+                                               axis, params.joint_params);
+  parent->addJoint(joint);
+  child->addJoint(joint);
+  links->emplace(child->name(), child);
+  joints->emplace(name, joint);
+}
+
+/* ************************************************************************* */
+Robot SerialChainRobot(size_t num_joints, const SyntheticRobotParams &params) {
+  return BranchedRobot(num_joints, 1, params);
+}
+
+/* ************************************************************************* */
+Robot BranchedRobot(size_t num_joints, size_t branching,
+                    const SyntheticRobotParams &params) {
+  if (num_joints > kMaxJoints) {
+    throw std::invalid_argument("BranchedRobot: at most 255 joints");
+  }
+  if (branching == 0) {
+    throw std::invalid_argument("BranchedRobot: branching must be positive");
+  }
+
+  const double r = params.link_radius;
+  const gtsam::Matrix3 base_inertia =
+      gtsam::I_3x3 * 0.4 * params.link_mass * r * r;
+  auto base = std::make_shared<Link>(0, "base", params.link_mass,
+                                     base_inertia, Pose3(), Pose3(), true);
+  LinkMap links{{"base", base}};
+  JointMap joints;
+
+  // Links that still get children: the link, its tip, direction and depth.
+  struct Tip {
+    LinkSharedPtr link;
+    Point3 point;
+    double angle;
+    size_t depth;
+  };
+  std::queue<Tip> tips;
+  tips.push({base, Point3(0, 0, 0), 0.0, 0});
+  while (joints.size() < num_joints) {
+    const Tip parent = tips.front();
+    tips.pop();
+    for (size_t c = 0; c < branching && joints.size() < num_joints; ++c) {
+      const size_t i = joints.size() + 1;
+      const double angle =
+          parent.angle + (c - 0.5 * (branching - 1)) * kFanAngle;
+      const Rot3 R = Rot3::Ry(angle);
+      auto link =
+          RodLink(i, "link_" + std::to_string(i), R, parent.point, params);
+      const Vector3 axis =
+          parent.depth % 2 == 0 ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
+      AddJoint(i, "joint_" + std::to_string(i), Pose3(R, parent.point),
+               parent.link, link, axis, params, &links, &joints);
+      tips.push({link,
+                 parent.point + R.rotate(Point3(0, 0, params.link_length)),
+                 angle, parent.depth + 1});
+    }
+  }
+  return Robot(links, joints);
+}
+
+/* ************************************************************************* */
+Robot LeggedRobot(size_t num_legs, size_t joints_per_leg,
+                  const SyntheticRobotParams &params) {
+  if (num_legs == 0 || joints_per_leg == 0) {
+    throw std::invalid_argument("LeggedRobot: needs legs with joints");
+  }
+  if (num_legs * joints_per_leg > kMaxJoints) {
+    throw std::invalid_argument("LeggedRobot: at most 255 joints");
+  }
+
+  const double m = params.base_mass, r = params.base_radius;
+  const gtsam::Matrix3 base_inertia = gtsam::I_3x3 * 0.4 * m * r * r;
+  auto base =
+      std::make_shared<Link>(0, "base", m, base_inertia, Pose3(), Pose3());
+  LinkMap links{{"base", base}};
+  JointMap joints;
+
+  size_t id = 1;
+  for (size_t i = 1; i <= num_legs; ++i) {
+    // The leg frame has its x-axis pointing outwards from the base.
+    const Rot3 wRleg = Rot3::Rz(2 * M_PI * (i - 1) / num_legs);
+    Point3 point = wRleg.rotate(Point3(r, 0, 0));
+    LinkSharedPtr parent = base;
+    for (size_t j = 1; j <= joints_per_leg; ++j, ++id) {
+      const std::string leg = "leg" + std::to_string(i);
+      const Rot3 R = wRleg * Rot3::Ry(j == 1 ? M_PI_2 : M_PI);
+      auto link = RodLink(id, leg + "_link" + std::to_string(j), R, point,
+                          params);
+      const Vector3 axis = j == 1 && joints_per_leg >= 3 ? Vector3(0, 0, 1)
+                                                         : Vector3(0, 1, 0);
+      AddJoint(id, leg + "_joint" + std::to_string(j), Pose3(wRleg, point),
+               parent, link, axis, params, &links, &joints);
+      point = point + R.rotate(Point3(0, 0, params.link_length));
+      parent = link;
+    }
+  }
+  return Robot(links, joints);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotGenerator.h
+ * @brief Synthetic serial, branched and legged robots of arbitrary size, for
+ * measuring how algorithms scale with degrees of freedom and branching.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Robot.h>
+
+namespace gtdynamics {
+
+/// Dimensions of the links and joints of synthetic robots.
+struct SyntheticRobotParams {
+  double link_length = 0.2;  ///< Length of each link, a uniform rod.
+  double link_radius = 0.02;  ///< Radius of each link.
+  double link_mass = 1.0;     ///< Mass of each link.
+  double base_mass = 5.0;     ///< Mass of the base of legged robots.
+  double base_radius = 0.2;   ///< Distance of the hips from the base center.
+  JointParams joint_params;   ///< Parameters of all joints.
+};
+
+/**
+ * A serial chain of revolute joints on a fixed base. Link i, named "link_i",
+ * extends upwards from joint i, named "joint_i", for i = 1..num_joints; the
+ * axes alternate between the y and x axes, so that gravity loads every joint.
+ * @param num_joints number of joints, at most 255
+ * @param params     dimensions of links and joints
+ */
+Robot SerialChainRobot(size_t num_joints,
+                       const SyntheticRobotParams &params = {});
+
+/**
+ * A tree of revolute joints on a fixed base, grown breadth first: every link
+ * carries `branching` child links, fanned out in the x-z plane, until there
+ * are num_joints joints. Links and joints are named as in SerialChainRobot,
+ * numbered breadth first; with branching 1 the tree is the serial chain.
+ * @param num_joints number of joints, at most 255
+ * @param branching  number of children of each link, at least 1
+ * @param params     dimensions of links and joints
+ */
+Robot BranchedRobot(size_t num_joints, size_t branching,
+                    const SyntheticRobotParams &params = {});
+
+/**
+ * A floating base, named "base", with legs evenly spaced around it. Leg i has
+ * joints "leg<i>_joint<j>" and links "leg<i>_link<j>", for i = 1..num_legs
+ * and j = 1..joints_per_leg; the first link extends outwards and the others
+ * downwards, and the last link of each leg is its foot. With three or more
+ * joints per leg the first joint is a hip yaw, all others pitch about the
+ * axis tangent to the base.
+ * @param num_legs       number of legs, at least 1
+ * @param joints_per_leg number of joints of each leg, at least 1, with at
+ * most 255 joints in total
+ * @param params         dimensions of links and joints
+ */
+Robot LeggedRobot(size_t num_legs, size_t joints_per_leg,
+                  const SyntheticRobotParams &params = {});
+
+}  // namespace gtdynamics
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file RobotParameters.cpp
+ * @brief Inertial and geometric parameters of a robot, shared by factors.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/universal_robot/RobotParameters.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RobotParameters::RobotParameters(const Robot &robot) {
+  for (auto &&link : robot.links()) {
+    const size_t i = link->id();
+    if (masses_.size() <= i) {
+      masses_.resize(i + 1, 0.0);
+      inertia_matrices_.resize(i + 1, gtsam::Matrix6::Zero());
+    }
+    masses_[i] = link->mass();
+    inertia_matrices_[i] = link->inertiaMatrix();
+  }
+  for (auto &&joint : robot.joints()) {
+    const size_t j = joint->id();
+    if (joints_.size() <= j) joints_.resize(j + 1);
+    joints_[j] = joint;
+  }
+}
+
+/* ************************************************************************* */
+void RobotParameters::setInertialParameters(int i, double mass,
+                                            const gtsam::Matrix3 &inertia) {
+  masses_.at(i) = mass;
+  inertia_matrices_.at(i) = Link::SpatialInertia(mass, inertia);
+}
+
+/* ************************************************************************* */
+void RobotParameters::setJoint(const JointConstSharedPtr &joint) {
+  const size_t j = joint->id();
+  if (j >= joints_.size() || !joints_[j]) {
+    throw std::invalid_argument("RobotParameters: no joint with id " +
+                                std::to_string(j));
+  }
+  joints_[j] = joint;
+}
+
+/* ************************************************************************* */
+void RobotParameters::update(const Robot &robot) {
+  const RobotParameters other(robot);
+  if (other.masses_.size() != masses_.size() ||
+      other.joints_.size() != joints_.size()) {
+    throw std::invalid_argument(
+        "RobotParameters: the robot has other links or joints.");
+  }
+  for (size_t j = 0; j < joints_.size(); j++) {
+    if (bool(other.joints_[j]) != bool(joints_[j])) {
+      throw std::invalid_argument(
+          "RobotParameters: the robot has other links or joints.");
+    }
+  }
+  *this = other;
+}
+
+}  // namespace gtdynamics
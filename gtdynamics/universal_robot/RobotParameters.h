@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file RobotParameters.h
+ * @brief Inertial and geometric parameters of a robot, shared by factors.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Parameter block of a robot: the mass and inertia of every link, and every
+ * joint, with its rest transforms jMp and jMc and screw axes. Factors built
+ * with a block, see LinkWrenchFactor and JointFactors.h, read the parameters
+ * each time they are evaluated, so a graph is built once and its parameters
+ * changed in place between solves, e.g. to test a payload or to evaluate
+ * samples of the parameters in robust optimization.
+ *
+ * Parameters are indexed by link and joint id. The block is not locked: do
+ * not change it while a graph built with it is being optimized.
+ */
+class RobotParameters {
+ public:
+  /// Parameters of robot.
+  explicit RobotParameters(const Robot &robot);
+
+  /// Mass of link i.
+  double mass(int i) const { return masses_.at(i); }
+
+  /// Spatial inertia of link i, see Link::SpatialInertia.
+  const gtsam::Matrix6 &inertiaMatrix(int i) const {
+    return inertia_matrices_.at(i);
+  }
+
+  /// Joint j, with its current rest transforms.
+  const Joint &joint(int j) const {
+    const JointConstSharedPtr &joint = joints_.at(j);
+    if (!joint) {
+      throw std::out_of_range("RobotParameters: no joint with id " +
+                              std::to_string(j));
+    }
+    return *joint;
+  }
+
+  /// Set the mass and the inertia about the CoM of link i.
+  void setInertialParameters(int i, double mass, const gtsam::Matrix3 &inertia);
+
+  /**
+   * Replace the joint with the same id, e.g. one with another rest transform
+   * from a variant of the robot model.
+   */
+  void setJoint(const JointConstSharedPtr &joint);
+
+  /**
+   * Take all parameters of another model of the robot, e.g. one with a
+   * payload; throws if its links and joints have other ids.
+   */
+  void update(const Robot &robot);
+
+ private:
+  std::vector<double> masses_;
+  std::vector<gtsam::Matrix6> inertia_matrices_;
+  std::vector<JointConstSharedPtr> joints_;
+};
+
+using RobotParametersSharedPtr = std::shared_ptr<RobotParameters>;
+using RobotParametersConstSharedPtr = std::shared_ptr<const RobotParameters>;
+
+namespace internal {
+/**
+ * Joint of a factor: either fixed at construction, or read from a parameter
+ * block whenever the factor is evaluated.
+ */
+class FactorJoint {
+ public:
+  /// Fixed joint, from any shared pointer to a joint.
+  template <class JOINT_PTR,
+            typename = std::enable_if_t<
+                std::is_convertible_v<JOINT_PTR, JointConstSharedPtr>>>
+  FactorJoint(const JOINT_PTR &joint) : joint_(joint), id_(joint->id()) {}
+
+  /// Joint j of a parameter block.
+  FactorJoint(const RobotParametersConstSharedPtr &parameters, int j)
+      : parameters_(parameters), id_(j) {}
+
+  const Joint &operator*() const {
+    return parameters_ ? parameters_->joint(id_) : *joint_;
+  }
+  const Joint *operator->() const { return &**this; }
+
+ private:
+  JointConstSharedPtr joint_;
+  RobotParametersConstSharedPtr parameters_;
+  int id_ = 0;
+};
+}  // namespace internal
+
+}  // namespace gtdynamics
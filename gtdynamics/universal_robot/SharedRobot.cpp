@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SharedRobot.cpp
+ * @brief Immutable robot shared between threads, with cheap variants.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/universal_robot/SharedRobot.h>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SharedRobot::SharedRobot(const Robot &robot)
+    : base_(std::make_shared<const Robot>(robot.clone())),
+      variant_(std::make_shared<Variant>()) {}
+
+/* ************************************************************************* */
+SharedRobot::SharedRobot(
+    const std::shared_ptr<const Robot> &base,
+    const std::map<std::string, std::optional<gtsam::Pose3>> &fixed,
+    const std::set<std::string> &unfixed)
+    : base_(base),
+      fixed_(fixed),
+      unfixed_(unfixed),
+      variant_(std::make_shared<Variant>()) {}
+
+/* ************************************************************************* */
+SharedRobot SharedRobot::fixLink(
+    const std::string &name,
+    const std::optional<gtsam::Pose3> &fixed_pose) const {
+  base_->link(name);  // Throws if there is no such link.
+  auto fixed = fixed_;
+  fixed[name] = fixed_pose;
+  auto unfixed = unfixed_;
+  unfixed.erase(name);
+  return SharedRobot(base_, fixed, unfixed);
+}
+
+/* ************************************************************************* */
+SharedRobot SharedRobot::unfixLink(const std::string &name) const {
+  auto fixed = fixed_;
+  fixed.erase(name);
+  auto unfixed = unfixed_;
+  if (base_->link(name)->isFixed()) unfixed.insert(name);
+  return SharedRobot(base_, fixed, unfixed);
+}
+
+/* ************************************************************************* */
+bool SharedRobot::isFixed(const std::string &name) const {
+  if (fixed_.count(name)) return true;
+  if (unfixed_.count(name)) return false;
+  return base_->link(name)->isFixed();
+}
+
+/* ************************************************************************* */
+const Robot &SharedRobot::robot() const {
+  std::call_once(variant_->once, [this]() {
+    if (fixed_.empty() && unfixed_.empty()) {
+      variant_->robot = base_;
+      return;
+    }
+    // The clone is private to this variant, so fixing its links in place
+    // does not affect the base or other variants.
+    Robot robot = base_->clone();
+    for (auto &&name : unfixed_) robot = robot.unfixLink(name);
+    for (auto &&name_pose : fixed_) {
+      robot = robot.fixLink(name_pose.first, name_pose.second);
+    }
+    variant_->robot = std::make_shared<const Robot>(robot);
+  });
+  return *variant_->robot;
+}
+
+}  // namespace gtdynamics
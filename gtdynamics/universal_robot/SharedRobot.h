@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SharedRobot.h
+ * @brief Immutable robot shared between threads, with cheap variants.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * An immutable robot that can be shared between threads and copied cheaply.
+ *
+ * Robot::fixLink returns copies that share, and modify, the links of the
+ * original. SharedRobot instead keeps a private deep copy of the robot, and
+ * fixLink/unfixLink return variants that only record which links are fixed.
+ * The variant's robot is built, copy-on-write, the first time robot() is
+ * called, and is shared by all copies of that variant.
+ */
+class SharedRobot {
+ public:
+  /// Share a deep copy of robot, so later changes to robot are not seen.
+  explicit SharedRobot(const Robot &robot);
+
+  /**
+   * Return a variant with a link fixed.
+   * @param name The name of the link to fix.
+   * @param fixed_pose The pose to fix the link at, defaults to its rest CoM
+   * pose.
+   */
+  SharedRobot fixLink(const std::string &name,
+                      const std::optional<gtsam::Pose3> &fixed_pose = {}) const;
+
+  /// Return a variant with a link unfixed.
+  SharedRobot unfixLink(const std::string &name) const;
+
+  /// Whether the link is fixed in this variant.
+  bool isFixed(const std::string &name) const;
+
+  /// The robot all variants are derived from.
+  const Robot &base() const { return *base_; }
+
+  /**
+   * The robot with this variant's links fixed. It is built on first use,
+   * thread-safely, and must be treated as read-only.
+   */
+  const Robot &robot() const;
+
+ private:
+  /// Robot of a variant, built at most once and shared by its copies.
+  struct Variant {
+    std::once_flag once;
+    std::shared_ptr<const Robot> robot;
+  };
+
+  SharedRobot(const std::shared_ptr<const Robot> &base,
+              const std::map<std::string, std::optional<gtsam::Pose3>> &fixed,
+              const std::set<std::string> &unfixed);
+
+  std::shared_ptr<const Robot> base_;
+  /// Links fixed in this variant, with their optional fixed poses.
+  std::map<std::string, std::optional<gtsam::Pose3>> fixed_;
+  /// Links fixed in the base but unfixed in this variant.
+  std::set<std::string> unfixed_;
+  std::shared_ptr<Variant> variant_;
+};
+
+}  // namespace gtdynamics
@@ -16,12 +16,16 @@
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/universal_robot/PrismaticJoint.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/universal_robot/sdf_internal.h>
 
+#include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <sdf/parser.hh>
 #include <sdf/sdf.hh>
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -166,6 +170,59 @@ gtsam::Vector3 GetSdfAxis(const sdf::Joint &sdf_joint) {
   return gtsam::Vector3(axis[0], axis[1], axis[2]);
 }
 
+std::vector<CollisionGeometry> CollisionsFromSdf(const sdf::Link &sdf_link,
+                                                 const Pose3 &lMcom) {
+  std::vector<CollisionGeometry> collisions;
+  for (uint64_t i = 0; i < sdf_link.CollisionCount(); i++) {
+    const sdf::Collision *sdf_collision = sdf_link.CollisionByIndex(i);
+    const sdf::Geometry *geometry = sdf_collision->Geom();
+    CollisionGeometry collision;
+    collision.name = sdf_collision->Name();
+    switch (geometry->Type()) {
+      case sdf::GeometryType::SPHERE:
+        collision.type = CollisionGeometry::Sphere;
+        collision.radius = geometry->SphereShape()->Radius();
+        break;
+      case sdf::GeometryType::BOX: {
+        const auto &size = geometry->BoxShape()->Size();
+        collision.type = CollisionGeometry::Box;
+        collision.size = gtsam::Vector3(size[0], size[1], size[2]);
+        break;
+      }
+      case sdf::GeometryType::CYLINDER:
+        collision.type = CollisionGeometry::Cylinder;
+        collision.radius = geometry->CylinderShape()->Radius();
+        collision.length = geometry->CylinderShape()->Length();
+        break;
+      case sdf::GeometryType::CAPSULE:
+        collision.type = CollisionGeometry::Capsule;
+        collision.radius = geometry->CapsuleShape()->Radius();
+        collision.length = geometry->CapsuleShape()->Length();
+        break;
+      case sdf::GeometryType::MESH: {
+        const auto &scale = geometry->MeshShape()->Scale();
+        collision.type = CollisionGeometry::Mesh;
+        collision.uri = geometry->MeshShape()->Uri();
+        collision.scale = gtsam::Vector3(scale[0], scale[1], scale[2]);
+        break;
+      }
+      default:
+        continue;
+    }
+
+    // Resolve the pose of the collision to the link frame.
+    auto raw_pose = sdf_collision->RawPose();
+    auto errors =
+        sdf_collision->SemanticPose().Resolve(raw_pose, sdf_link.Name());
+    if (errors.size() > 0) {
+      throw std::runtime_error(errors[0].Message());
+    }
+    collision.comTgeom = lMcom.inverse() * Pose3FromIgnition(raw_pose);
+    collisions.push_back(collision);
+  }
+  return collisions;
+}
+
 LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
   gtsam::Matrix3 inertia;
   const auto &I = sdf_link.Inertial().Moi();
@@ -178,9 +235,13 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
   const Pose3 lMcom = Pose3FromIgnition(sdf_link.Inertial().Pose());
   const Pose3 bMcom = bMl * lMcom;
 
-  return std::make_shared<Link>(id, sdf_link.Name(),
-                                  sdf_link.Inertial().MassMatrix().Mass(),
-                                  inertia, bMcom, bMl);
+  auto link = std::make_shared<Link>(id, sdf_link.Name(),
+                                     sdf_link.Inertial().MassMatrix().Mass(),
+                                     inertia, bMcom, bMl);
+  for (auto &&collision : CollisionsFromSdf(sdf_link, lMcom)) {
+    link->addCollision(collision);
+  }
+  return link;
 }
 
 LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &link_name,
@@ -325,4 +386,65 @@ Robot CreateRobotFromFile(const std::string &file_path,
   return Robot(links_joints_pair.first, links_joints_pair.second);
 }
 
+std::map<std::string, Robot> CreateRobotsFromFiles(
+    const std::vector<RobotFile> &files,
+    const std::optional<std::string> &cache_dir,
+    const ExecutionContext &execution) {
+  // Check keys before doing any work.
+  std::vector<std::string> names;
+  std::map<std::string, Robot> robots;
+  for (auto &&file : files) {
+    names.push_back(
+        file.model_name.empty()
+            ? std::filesystem::path(file.file_path).stem().string()
+            : file.model_name);
+    if (!robots.emplace(names.back(), Robot()).second) {
+      throw std::invalid_argument("CreateRobotsFromFiles: duplicate model " +
+                                  names.back());
+    }
+  }
+
+  // sdformat keeps process-global parser state, so parsing and cache files
+  // are serialized, and only the Robot construction runs in parallel. Map
+  // nodes are stable, so each load writes its own entry.
+  static std::mutex parser_mutex;
+  auto load = [&](size_t i) {
+    const RobotFile &file = files[i];
+    uint64_t hash = 0;
+    std::string cache_path;
+    if (cache_dir) {
+      hash = RobotModelHash(file.file_path, file.model_name,
+                            file.preserve_fixed_joint);
+      cache_path = RobotCachePath(*cache_dir, hash);
+      std::optional<Robot> cached;
+      {
+        std::lock_guard<std::mutex> lock(parser_mutex);
+        cached = LoadRobotCache(cache_path, hash);
+      }
+      if (cached) {
+        robots.at(names[i]) = std::move(*cached);
+        return;
+      }
+    }
+
+    LinkJointPair links_joints;
+    {
+      std::lock_guard<std::mutex> lock(parser_mutex);
+      links_joints = ExtractRobotFromFile(file.file_path, file.model_name,
+                                          file.preserve_fixed_joint);
+    }
+    Robot robot(links_joints.first, links_joints.second);
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+    if (cache_dir) {
+      std::lock_guard<std::mutex> lock(parser_mutex);
+      std::filesystem::create_directories(*cache_dir);
+      SaveRobotCache(robot, hash, cache_path);
+    }
+#endif
+    robots.at(names[i]) = std::move(robot);
+  };
+  execution.parallelFor(files.size(), load);
+  return robots;
+}
+
 }  // namespace gtdynamics
@@ -14,8 +14,12 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
 
+#include <map>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -31,4 +35,30 @@ Robot CreateRobotFromFile(const std::string &file_path,
                           const std::string &model_name = "",
                           bool preserve_fixed_joint = false);
 
+/// A model file to load with CreateRobotsFromFiles.
+struct RobotFile {
+  std::string file_path;
+  std::string model_name = "";  ///< needed for world files
+  bool preserve_fixed_joint = false;
+};
+
+/**
+ * @fn Construct robots from several urdf or sdf files, on the threads of the
+ * execution context. sdformat keeps process-global parser state, so files
+ * are parsed and cache files are read and written one at a time; the
+ * construction of the robots from the parsed links and joints runs in
+ * parallel.
+ * @param[in] files the model files.
+ * @param[in] cache_dir if given, load through the binary robot cache, see
+ *    CreateRobotFromFileCached.
+ * @param[in] execution threads that load the files.
+ * @return robots keyed by model name, or by file name without extension if
+ *    no model name is given. Throws if two files yield the same key, or
+ *    rethrows the error of a file that fails to load.
+ */
+std::map<std::string, Robot> CreateRobotsFromFiles(
+    const std::vector<RobotFile> &files,
+    const std::optional<std::string> &cache_dir = {},
+    const ExecutionContext &execution = ExecutionContext::Default());
+
 }  // namespace gtdynamics
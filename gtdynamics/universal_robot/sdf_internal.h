@@ -18,6 +18,7 @@
 #include <ignition/math/Pose3.hh>
 #include <sdf/sdf.hh>
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -100,4 +101,14 @@ gtsam::Pose3 GetJointFrame(const sdf::Joint &sdf_joint,
  */
 gtsam::Vector3 GetSdfAxis(const sdf::Joint &sdf_joint);
 
+/**
+ * @fn Extract the collision elements of an sdf::Link.
+ * @param[in] sdf_link the link
+ * @param[in] lMcom    pose of the link CoM in the link frame
+ * @return collision primitives with their poses in the CoM frame; planes,
+ * ellipsoids and other unsupported shapes are skipped
+ */
+std::vector<CollisionGeometry> CollisionsFromSdf(const sdf::Link &sdf_link,
+                                                 const gtsam::Pose3 &lMcom);
+
 }  // namespace gtdynamics
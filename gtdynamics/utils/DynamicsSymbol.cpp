@@ -13,6 +13,7 @@
 
 #include <gtdynamics/utils/DynamicsSymbol.h>
 
+#include <algorithm>
 #include <iostream>
 
 using gtsam::Key;
@@ -77,21 +78,18 @@ DynamicsSymbol DynamicsSymbol::SimpleSymbol(const std::string& s, uint64_t t) {
 
 /* ************************************************************************* */
 DynamicsSymbol::DynamicsSymbol(const Key& key) {
-  c1_ = (uint8_t)((key & ch1_mask) >> (key_bits - ch1_bits));
-  c2_ = (uint8_t)((key & ch2_mask) >> (key_bits - ch1_bits - ch2_bits));
-  link_idx_ = (uint8_t)((key & link_mask) >> (time_bits + joint_bits));
-  joint_idx_ = (uint8_t)((key & joint_mask) >> time_bits);
-  t_ = key & time_mask;
+  using Encoding = DynamicsKeyEncoding;
+  c1_ = Encoding::Char1(key);
+  c2_ = Encoding::Char2(key);
+  link_idx_ = uint8_t(Encoding::Link(key));
+  joint_idx_ = uint8_t(Encoding::Joint(key));
+  t_ = Encoding::Time(key);
 }
 
 /* ************************************************************************* */
 DynamicsSymbol::operator Key() const {
-  Key ch1_comp = Key(c1_) << (key_bits - ch1_bits);
-  Key ch2_comp = Key(c2_) << (key_bits - ch1_bits - ch2_bits);
-  Key link_comp = Key(link_idx_) << (time_bits + joint_bits);
-  Key joint_comp = Key(joint_idx_) << time_bits;
-  Key key = ch1_comp | ch2_comp | link_comp | joint_comp | t_;
-  return key;
+  return DynamicsKeyEncoding::Encode(c1_, c2_, DynamicsKeyEncoding::kNoRobot,
+                                     link_idx_, joint_idx_, t_);
 }
 
 /* ************************************************************************* */
@@ -116,12 +114,20 @@ void DynamicsSymbol::print(const std::string& s) const {
 
 /* ************************************************************************* */
 DynamicsSymbol::operator std::string() const {
-  std::string s = label();
+  // Appends to one buffer, instead of concatenating temporary strings.
+  std::string s;
+  s.reserve(32);
+  if (c1_ != 0) s += c1_;
+  if (c2_ != 0) s += c2_;
   if (link_idx_ != kMax_uchar_) {
-    s += "[" + std::to_string((int)(link_idx_)) + "]";
+    s += '[';
+    s += std::to_string(link_idx_);
+    s += ']';
   }
   if (joint_idx_ != kMax_uchar_) {
-    s += "(" + std::to_string((int)(joint_idx_)) + ")";
+    s += '(';
+    s += std::to_string(joint_idx_);
+    s += ')';
   }
   s += std::to_string(t_);
   return s;
@@ -131,6 +137,44 @@ std::string _GTDKeyFormatter(Key key) {
   return std::string(DynamicsSymbol(key));
 }
 
+/* ************************************************************************* */
+std::vector<std::string> GTDFormatKeys(const gtsam::KeyVector& keys,
+                                       const ExecutionContext& execution) {
+  // Chunks of keys, so that a task formats more than a single short name.
+  const size_t chunk_size = 1024;
+  std::vector<std::string> names(keys.size());
+  execution.parallelFor(
+      (keys.size() + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        const size_t end = std::min((chunk + 1) * chunk_size, keys.size());
+        for (size_t i = chunk * chunk_size; i < end; i++) {
+          names[i] = _GTDKeyFormatter(keys[i]);
+        }
+      });
+  return names;
+}
+
+/* ************************************************************************* */
+void KeyNameCache::insert(const gtsam::KeyVector& keys) {
+  gtsam::KeyVector missing;
+  for (Key key : keys) {
+    if (!names_.count(key)) missing.push_back(key);
+  }
+  auto names = GTDFormatKeys(missing);
+  names_.reserve(names_.size() + missing.size());
+  for (size_t i = 0; i < missing.size(); i++) {
+    names_.emplace(missing[i], std::move(names[i]));
+  }
+}
+
+/* ************************************************************************* */
+const std::string& KeyNameCache::operator()(Key key) {
+  auto it = names_.find(key);
+  if (it == names_.end()) {
+    it = names_.emplace(key, _GTDKeyFormatter(key)).first;
+  }
+  return it->second;
+}
+
 /* ************************************************************************* */
 
 }  // namespace gtdynamics
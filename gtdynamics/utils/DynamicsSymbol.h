@@ -13,9 +13,15 @@
 
 #pragma once
 
+#include <gtdynamics/utils/ExecutionContext.h>
+#include <gtdynamics/utils/KeyEncoding.h>
 #include <gtsam/inference/Key.h>
 #include <gtsam/inference/Symbol.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace gtdynamics {
 
 class DynamicsSymbol {
@@ -125,30 +131,8 @@ class DynamicsSymbol {
   }
 #endif
 
-  /**
-   * \defgroup Bitfield bit field constants
-   * @{
-   */
-  static constexpr size_t kMax_uchar_ = std::numeric_limits<uint8_t>::max();
-  // bit counts
-  static constexpr size_t key_bits = sizeof(gtsam::Key) * 8;
-  static constexpr size_t ch1_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t ch2_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t link_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t joint_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t time_bits =
-      key_bits - ch1_bits - ch2_bits - link_bits - joint_bits;
-  // masks
-  static constexpr gtsam::Key ch1_mask = gtsam::Key(kMax_uchar_)
-                                         << (key_bits - ch1_bits);
-  static constexpr gtsam::Key ch2_mask = gtsam::Key(kMax_uchar_)
-                                         << (key_bits - ch1_bits - ch2_bits);
-  static constexpr gtsam::Key link_mask = gtsam::Key(kMax_uchar_)
-                                          << (time_bits + joint_bits);
-  static constexpr gtsam::Key joint_mask = gtsam::Key(kMax_uchar_) << time_bits;
-  static constexpr gtsam::Key time_mask =
-      ~(ch1_mask | ch2_mask | link_mask | joint_mask);
-  /**@}*/
+  /// Link or joint index of symbols without a link or joint.
+  static constexpr size_t kMax_uchar_ = DynamicsKeyEncoding::kNoLink;
 };
 
 /// key formatter function
@@ -156,4 +140,35 @@ std::string _GTDKeyFormatter(gtsam::Key key);
 
 static const gtsam::KeyFormatter GTDKeyFormatter = &_GTDKeyFormatter;
 
+/// Names of many keys at once, formatted in parallel on the given threads.
+std::vector<std::string> GTDFormatKeys(
+    const gtsam::KeyVector& keys,
+    const ExecutionContext& execution = ExecutionContext::Default());
+
+/**
+ * Cache of key names for one dump, e.g. of a graph, where every key appears
+ * in several factors: each key is formatted once, lazily or in bulk.
+ */
+class KeyNameCache {
+  std::unordered_map<gtsam::Key, std::string> names_;
+
+ public:
+  /// Constructor, which formats the given keys in bulk.
+  explicit KeyNameCache(const gtsam::KeyVector& keys = {}) { insert(keys); }
+
+  /// Format keys in bulk, see GTDFormatKeys.
+  void insert(const gtsam::KeyVector& keys);
+
+  /// Name of a key, formatted on first use.
+  const std::string& operator()(gtsam::Key key);
+
+  /// Number of cached names.
+  size_t size() const { return names_.size(); }
+
+  /// A KeyFormatter that uses this cache, which must outlive it.
+  gtsam::KeyFormatter formatter() {
+    return [this](gtsam::Key key) { return (*this)(key); };
+  }
+};
+
 }  // namespace gtdynamics
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ExecutionContext.cpp
+ * @brief How parallel loops of GTDynamics are run.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+
+#ifdef GTDYNAMICS_USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace {
+/// Whether this thread runs iterations of a parallelFor.
+thread_local bool in_parallel = false;
+
+/// Marks the current thread as a worker for its lifetime.
+class WorkerScope {
+ public:
+  WorkerScope() : previous_(in_parallel) { in_parallel = true; }
+  ~WorkerScope() { in_parallel = previous_; }
+
+ private:
+  bool previous_;
+};
+
+/// Pin a thread to a core, wrapping around the hardware threads.
+void Pin(std::thread *thread, size_t core) {
+#ifdef __linux__
+  const size_t num_cores = std::max(1u, std::thread::hardware_concurrency());
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core % num_cores, &cpu_set);
+  pthread_setaffinity_np(thread->native_handle(), sizeof(cpu_set_t),
+                         &cpu_set);
+#endif
+}
+}  // namespace
+
+/* ************************************************************************* */
+ExecutionContext ExecutionContext::Default() {
+#ifdef GTDYNAMICS_USE_TBB
+  return Threads(0);
+#else
+  return Threads(1);
+#endif
+}
+
+/* ************************************************************************* */
+size_t ExecutionContext::numThreads() const {
+  if (num_threads > 0) return num_threads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/* ************************************************************************* */
+bool ExecutionContext::InParallel() { return in_parallel; }
+
+/* ************************************************************************* */
+void ExecutionContext::parallelFor(
+    size_t n, const std::function<void(size_t)> &body) const {
+  const size_t threads = std::min(numThreads(), n);
+  if (threads <= 1 || in_parallel) {
+    for (size_t i = 0; i < n; ++i) body(i);
+    return;
+  }
+
+#ifdef GTDYNAMICS_USE_TBB
+  if (!pin_threads && !deterministic) {
+    tbb::task_arena arena(static_cast<int>(threads));
+    arena.execute([&]() {
+      tbb::parallel_for(size_t(0), n, [&](size_t i) {
+        const WorkerScope scope;
+        body(i);
+      });
+    });
+    return;
+  }
+#endif
+
+  // Exceptions are stored per thread and the first is rethrown after all
+  // threads joined.
+  const size_t block_size = (n + threads - 1) / threads;
+  std::atomic<size_t> next(0);
+  std::vector<std::exception_ptr> errors(threads);
+  auto worker = [&](size_t k) {
+    const WorkerScope scope;
+    try {
+      if (deterministic) {
+        const size_t end = std::min((k + 1) * block_size, n);
+        for (size_t i = k * block_size; i < end; ++i) body(i);
+      } else {
+        for (size_t i = next++; i < n; i = next++) body(i);
+      }
+    } catch (...) {
+      errors[k] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (size_t k = 1; k < threads; ++k) {
+    workers.emplace_back(worker, k);
+    if (pin_threads) Pin(&workers.back(), k);
+  }
+  worker(0);
+  for (auto &thread : workers) thread.join();
+  for (auto &error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ExecutionContext.h
+ * @brief How parallel loops of GTDynamics are run: thread count, pinning and
+ * deterministic scheduling.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace gtdynamics {
+
+/**
+ * Parallelism of one GTDynamics call, passed in parameter structs such as
+ * OptimizerSetting and ManifoldOptimizerParameters. Loops run by parallelFor
+ * inside another parallelFor run serially on the calling worker, so nested
+ * parallel paths, e.g. linearization inside a multi-start optimization, do
+ * not multiply the number of threads. To run many planners per node, give
+ * each planner a share of the cores.
+ *
+ * With TBB, the default scheduling runs on a task arena limited to the
+ * thread count, which also composes with other TBB users; pinned or
+ * deterministic contexts always use std::thread.
+ */
+struct ExecutionContext {
+  /// Number of threads, including the calling one; 0 for one per hardware
+  /// thread.
+  size_t num_threads = 1;
+
+  /// Pin the worker threads to cores 1, 2, ..., wrapping around; the calling
+  /// thread is left as is. Only supported on Linux, ignored elsewhere.
+  bool pin_threads = false;
+
+  /// Give each thread one contiguous block of the loop, in order, instead of
+  /// handing out iterations as threads become free. Results combined by block
+  /// then do not depend on timing.
+  bool deterministic = false;
+
+  /**
+   * Default of the parameter structs: one thread per hardware thread if
+   * GTDynamics is built with TBB, as its parallel paths were before, and a
+   * single thread otherwise.
+   */
+  static ExecutionContext Default();
+
+  /// Context with the given number of threads.
+  static ExecutionContext Threads(size_t num_threads) {
+    ExecutionContext context;
+    context.num_threads = num_threads;
+    return context;
+  }
+
+  /// Number of threads used, resolving 0 to the hardware concurrency.
+  size_t numThreads() const;
+
+  /**
+   * Call body(i) for all i in [0, n), on up to numThreads() threads, at most
+   * one thread per iteration. Returns when all calls returned; the first
+   * exception thrown by a call is rethrown on the calling thread.
+   */
+  void parallelFor(size_t n, const std::function<void(size_t)> &body) const;
+
+  /// Whether the calling thread is a worker of a parallelFor.
+  static bool InParallel();
+};
+
+}  // namespace gtdynamics
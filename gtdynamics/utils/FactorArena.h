@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorArena.h
+ * @brief Arena from which the factors of one graph are allocated together.
+ * @author Frank Dellaert
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+
+namespace gtdynamics {
+
+/**
+ * FactorArena allocates objects, with their shared_ptr control blocks, from
+ * large blocks of memory instead of one heap allocation each. Memory of
+ * destroyed objects is not reused: it is all released at once when the last
+ * copy of the arena and the last object made from it are gone, so a graph may
+ * safely outlive the FactorArena that built it. Use one arena per batch of
+ * factors which is built and discarded together, e.g., a trajectory graph.
+ *
+ * Copies share the same arena, and make may be called from several threads.
+ */
+class FactorArena {
+ private:
+  struct Resource {
+    std::mutex mutex;
+    std::pmr::monotonic_buffer_resource buffer;
+    size_t bytes = 0;
+
+    explicit Resource(size_t block_size) : buffer(block_size) {}
+  };
+  std::shared_ptr<Resource> resource_;
+
+  /// Allocator for std::allocate_shared, which keeps the arena alive.
+  template <class T>
+  struct Allocator {
+    using value_type = T;
+    std::shared_ptr<Resource> resource;
+
+    explicit Allocator(std::shared_ptr<Resource> r) : resource(std::move(r)) {}
+    template <class U>
+    Allocator(const Allocator<U> &other) : resource(other.resource) {}
+
+    T *allocate(size_t n) {
+      std::lock_guard<std::mutex> lock(resource->mutex);
+      resource->bytes += n * sizeof(T);
+      return static_cast<T *>(
+          resource->buffer.allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *, size_t) {}
+
+    template <class U>
+    bool operator==(const Allocator<U> &other) const {
+      return resource == other.resource;
+    }
+    template <class U>
+    bool operator!=(const Allocator<U> &other) const {
+      return resource != other.resource;
+    }
+  };
+
+ public:
+  /**
+   * Constructor.
+   * @param block_size size in bytes of the first block, later blocks grow
+   */
+  explicit FactorArena(size_t block_size = 1 << 20)
+      : resource_(std::make_shared<Resource>(block_size)) {}
+
+  /// Construct a T in the arena, as std::make_shared<T>(args...).
+  template <class T, class... Args>
+  std::shared_ptr<T> make(Args &&...args) const {
+    return std::allocate_shared<T>(Allocator<T>(resource_),
+                                   std::forward<Args>(args)...);
+  }
+
+  /// Number of bytes handed out so far, including control blocks.
+  size_t bytesAllocated() const {
+    std::lock_guard<std::mutex> lock(resource_->mutex);
+    return resource_->bytes;
+  }
+};
+
+}  // namespace gtdynamics
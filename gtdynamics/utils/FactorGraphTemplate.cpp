@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorGraphTemplate.cpp
+ * @brief Build a factor graph once, and instantiate it at other time steps.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorGraphTemplate.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::Key ShiftedKey(gtsam::Key key, int time_offset, int phase_offset) {
+  const DynamicsSymbol symbol(key);
+  const std::string label = symbol.label();
+  const int offset = label == "dt" ? phase_offset : time_offset;
+  return DynamicsSymbol::LinkJointSymbol(label, symbol.linkIdx(),
+                                         symbol.jointIdx(),
+                                         symbol.time() + offset);
+}
+
+/* ************************************************************************* */
+gtsam::Values ShiftedValues(const gtsam::Values &values, int time_offset,
+                            int phase_offset) {
+  gtsam::Values shifted;
+  for (gtsam::Key key : values.keys()) {
+    shifted.insert(ShiftedKey(key, time_offset, phase_offset), values.at(key));
+  }
+  return shifted;
+}
+
+/* ************************************************************************* */
+gtsam::Vector KeyMappedFactor::unwhitenedError(
+    const gtsam::Values &x, gtsam::OptionalMatrixVecType H) const {
+  gtsam::Values values;
+  for (size_t j = 0; j < keys_.size(); j++) {
+    values.insert(factor_->keys()[j], x.at(keys_[j]));
+  }
+  return factor_->unwhitenedError(values, H);
+}
+
+/* ************************************************************************* */
+bool FactorGraphTemplate::IsRekeyable(
+    const gtsam::NonlinearFactor::shared_ptr &factor) {
+  if (factor->empty()) return true;
+
+  // New keys, at later time steps and phases than all current keys.
+  int offset = 1;
+  for (gtsam::Key key : factor->keys()) {
+    offset = std::max(offset, int(DynamicsSymbol(key).time()) + 1);
+  }
+  gtsam::KeyVector new_keys;
+  for (gtsam::Key key : factor->keys()) {
+    new_keys.push_back(ShiftedKey(key, offset, offset));
+  }
+
+  const auto rekeyed = factor->rekey(new_keys);
+  try {
+    rekeyed->error(gtsam::Values());
+  } catch (const gtsam::ValuesKeyDoesNotExist &e) {
+    return std::find(new_keys.begin(), new_keys.end(), e.key()) !=
+           new_keys.end();
+  } catch (...) {
+    return false;
+  }
+  return true;  // it does not read any values.
+}
+
+/* ************************************************************************* */
+FactorGraphTemplate::FactorGraphTemplate(
+    const gtsam::NonlinearFactorGraph &graph)
+    : graph_(graph) {
+  rekeyable_.reserve(graph.size());
+  for (const auto &factor : graph) {
+    const bool rekeyable = IsRekeyable(factor);
+    if (!rekeyable &&
+        !std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor)) {
+      throw std::invalid_argument(
+          "FactorGraphTemplate: factors that cannot be rekeyed must be "
+          "NoiseModelFactors.");
+    }
+    rekeyable_.push_back(rekeyable);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph FactorGraphTemplate::instantiate(
+    int time_offset, int phase_offset) const {
+  return instantiate([&](gtsam::Key key) {
+    return ShiftedKey(key, time_offset, phase_offset);
+  });
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph FactorGraphTemplate::instantiate(
+    const std::function<gtsam::Key(gtsam::Key)> &key_map) const {
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(graph_.size());
+  for (size_t i = 0; i < graph_.size(); i++) {
+    const auto &factor = graph_[i];
+    gtsam::KeyVector keys;
+    keys.reserve(factor->size());
+    for (gtsam::Key key : factor->keys()) {
+      keys.push_back(key_map(key));
+    }
+    if (rekeyable_[i]) {
+      graph.push_back(factor->rekey(keys));
+    } else {
+      graph.emplace_shared<KeyMappedFactor>(
+          std::static_pointer_cast<gtsam::NoiseModelFactor>(factor), keys);
+    }
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorGraphTemplate.h
+ * @brief Build a factor graph once, and instantiate it at other time steps.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Return the key at time step t + time_offset, for a DynamicsSymbol at time
+ * step t, or at phase p + phase_offset, for the PhaseKey of phase p.
+ */
+gtsam::Key ShiftedKey(gtsam::Key key, int time_offset, int phase_offset = 0);
+
+/// Return values with all keys shifted, see ShiftedKey.
+gtsam::Values ShiftedValues(const gtsam::Values &values, int time_offset,
+                            int phase_offset = 0);
+
+/**
+ * KeyMappedFactor evaluates a factor on other keys, with the values of its
+ * keys in place of the values of the keys of the factor. It is used for
+ * factors that cannot be rekeyed, e.g. expression factors, whose expressions
+ * hold their keys.
+ */
+class KeyMappedFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = KeyMappedFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+
+ public:
+  /**
+   * Constructor.
+   * @param factor The factor to evaluate.
+   * @param keys   The keys in place of the keys of the factor, in order.
+   */
+  KeyMappedFactor(const gtsam::NoiseModelFactor::shared_ptr &factor,
+                  const gtsam::KeyVector &keys)
+      : Base(factor->noiseModel(), keys), factor_(factor) {}
+
+  virtual ~KeyMappedFactor() {}
+
+  /// The factor that is evaluated.
+  const gtsam::NoiseModelFactor::shared_ptr &factor() const { return factor_; }
+
+  /// Error of the factor on the values of the mapped keys.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      gtsam::OptionalMatrixVecType H = nullptr) const override;
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return std::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "KeyMappedFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * FactorGraphTemplate stores a factor graph whose keys are DynamicsSymbols,
+ * e.g. the graph of one walk cycle, and instantiates copies with all time
+ * steps and phases shifted, without running the code that built the factors
+ * again. Factors are cloned and rekeyed where rekeying is correct, and
+ * wrapped in a KeyMappedFactor otherwise.
+ */
+class FactorGraphTemplate {
+ private:
+  gtsam::NonlinearFactorGraph graph_;
+  std::vector<bool> rekeyable_;
+
+ public:
+  /**
+   * Constructor, which checks how to shift every factor.
+   * @param graph Factors to instantiate; all but the rekeyable ones must be
+   * NoiseModelFactors.
+   */
+  explicit FactorGraphTemplate(const gtsam::NonlinearFactorGraph &graph);
+
+  /// The template graph.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /**
+   * The template graph with shifted keys, see ShiftedKey.
+   * @param time_offset Offset of all time steps.
+   * @param phase_offset Offset of all phases.
+   */
+  gtsam::NonlinearFactorGraph instantiate(int time_offset,
+                                          int phase_offset = 0) const;
+
+  /**
+   * The template graph with every key replaced by key_map(key), e.g. to
+   * give the copies of a graph their own variables but some shared ones.
+   */
+  gtsam::NonlinearFactorGraph instantiate(
+      const std::function<gtsam::Key(gtsam::Key)> &key_map) const;
+
+  /**
+   * Whether NonlinearFactor::rekey gives a factor which is evaluated on its
+   * new keys. It does not for factors which read values through other keys
+   * than keys(), which is checked by evaluating the rekeyed factor on empty
+   * values and looking at the key that is missing.
+   */
+  static bool IsRekeyable(const gtsam::NonlinearFactor::shared_ptr &factor);
+};
+
+}  // namespace gtdynamics
@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/utils/FootContactConstraintSpec.h>
 
 #include <iostream>
@@ -86,7 +87,8 @@ const gtsam::Point3 &pointGoal(const ContactGoals &cp_goals,
 NonlinearFactorGraph FootContactConstraintSpec::contactPointObjectives(
     const PointOnLinks &all_contact_points, const Point3 &step,
     const gtsam::SharedNoiseModel &cost_model, size_t k_start,
-    const ContactPointGoals &cp_goals, const size_t ts) const {
+    const ContactPointGoals &cp_goals, const size_t ts,
+    bool path_factors) const {
   NonlinearFactorGraph factors;
 
   for (auto &&cp : all_contact_points) {
@@ -97,8 +99,15 @@ NonlinearFactorGraph FootContactConstraintSpec::contactPointObjectives(
         stance ? StanceTrajectory(cp_goal, ts)
                : SimpleSwingTrajectory(cp_goal, step, ts);
 
-    factors.push_back(PointGoalFactors(cost_model, cp.point, goal_trajectory,
-                                       cp.link->id(), k_start));
+    if (path_factors) {
+      if (ts == 0) continue;
+      factors.emplace_shared<PointGoalPathFactor>(
+          cost_model, cp.point, goal_trajectory, cp.link->id(), k_start);
+    } else {
+      factors.push_back(PointGoalFactors(cost_model, cp.point,
+                                         goal_trajectory, cp.link->id(),
+                                         k_start));
+    }
   }
   return factors;
 }
@@ -76,11 +76,14 @@ class FootContactConstraintSpec : public ConstraintSpec {
    * @param[in] k_start Factors are added at this time step
    * @param[in] cp_goals either stance goal or start of swing (updated)
    * @param[in] ts number of time steps
+   * @param[in] path_factors one PointGoalPathFactor per foot, instead of one
+   * PointGoalFactor per foot and time step; cost_model must then be diagonal.
    */
   gtsam::NonlinearFactorGraph contactPointObjectives(
       const PointOnLinks &all_contact_points, const gtsam::Point3 &step,
       const gtsam::SharedNoiseModel &cost_model, size_t k_start,
-      const ContactPointGoals &cp_goals, const size_t ts) const;
+      const ContactPointGoals &cp_goals, const size_t ts,
+      bool path_factors = false) const;
 
   /**
    * @fn Returns the swing links during this FootContact
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphPruning.cpp
+ * @brief Substitute known variables out of factor graphs before optimization.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/factors/ConstVarFactor.h>
+#include <gtdynamics/utils/GraphPruning.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <memory>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactor;
+using gtsam::NoiseModelFactor;
+
+namespace {
+/// If factor is a PriorFactor<T> that pins its variable, add its value.
+template <typename T>
+void AddPinned(const NonlinearFactor::shared_ptr &factor, double max_sigma,
+               gtsam::Values *pinned) {
+  auto prior = std::dynamic_pointer_cast<gtsam::PriorFactor<T>>(factor);
+  if (!prior) return;
+  auto diagonal = std::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+      prior->noiseModel());
+  const Key key = prior->keys().front();
+  if (diagonal && diagonal->sigmas().maxCoeff() <= max_sigma &&
+      !pinned->exists(key)) {
+    pinned->insert(key, prior->prior());
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+PrunedGraph PruneKnownVariables(const gtsam::NonlinearFactorGraph &graph,
+                                const gtsam::Values &known_values,
+                                double max_sigma) {
+  // Candidates in order of precedence, and variables that must stay.
+  gtsam::Values candidates = known_values;
+  gtsam::KeySet kept;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    if (!std::dynamic_pointer_cast<NoiseModelFactor>(factor)) {
+      for (Key key : factor->keys()) kept.insert(key);
+      continue;
+    }
+    AddPinned<double>(factor, max_sigma, &candidates);
+    AddPinned<gtsam::Vector3>(factor, max_sigma, &candidates);
+    AddPinned<gtsam::Vector6>(factor, max_sigma, &candidates);
+    AddPinned<gtsam::Pose3>(factor, max_sigma, &candidates);
+  }
+
+  PrunedGraph result;
+  for (Key key : candidates.keys()) {
+    if (!kept.exists(key)) result.known.insert(key, candidates.at(key));
+  }
+
+  result.graph.reserve(graph.size());
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    gtsam::KeySet fixed;
+    for (Key key : factor->keys()) {
+      if (result.known.exists(key)) fixed.insert(key);
+    }
+    if (fixed.empty()) {
+      result.graph.add(factor);
+    } else if (fixed.size() == factor->size()) {
+      result.num_dropped++;
+    } else {
+      // Only the values of its own known variables go into the factor.
+      gtsam::Values fixed_values;
+      for (Key key : fixed) fixed_values.insert(key, result.known.at(key));
+      auto substituted = std::make_shared<gtsam::ConstVarFactor>(
+          std::static_pointer_cast<NoiseModelFactor>(factor), fixed);
+      substituted->setFixedValues(fixed_values);
+      result.graph.add(substituted);
+    }
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
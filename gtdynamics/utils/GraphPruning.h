@@ -0,0 +1,56 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphPruning.h
+ * @brief Substitute known variables out of factor graphs before optimization.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/// A factor graph with its known variables substituted out.
+struct PrunedGraph {
+  gtsam::NonlinearFactorGraph graph;  // factors on the remaining variables
+  gtsam::Values known;                // values of the substituted variables
+  size_t num_dropped = 0;             // factors on known variables only
+};
+
+/**
+ * Substitute the known variables of a graph out of it, so that the
+ * optimizer solves a smaller system. Trajectory graphs pin many variables,
+ * e.g. the pose, twist and twist acceleration of fixed links at every time
+ * step, or the contact wrenches and states an application already knows,
+ * and their values then only need to be found again.
+ *
+ * A variable is known if it is in known_values, or pinned by a PriorFactor
+ * on a double, Vector3, Vector6 or Pose3 with a diagonal noise model of
+ * sigmas at most max_sigma, at the value of the prior; the first such prior
+ * wins. Factors only on known variables, such as these priors, have a
+ * constant error and are dropped. Factors on some known variables become
+ * ConstVarFactors on the others, and the remaining factors are kept as they
+ * are. Variables in factors which are not NoiseModelFactors are never
+ * substituted.
+ *
+ * A solution of the pruned graph, together with known, is a solution of the
+ * original graph.
+ * @param graph        the graph, e.g. from multiPhaseTrajectoryFG
+ * @param known_values values of variables known in advance
+ * @param max_sigma    largest sigma of a prior that pins its variable, the
+ *                     fixed-link priors of OptimizerSetting have 1e-5
+ */
+PrunedGraph PruneKnownVariables(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::Values &known_values = gtsam::Values(),
+    double max_sigma = 1e-4);
+
+}  // namespace gtdynamics
@@ -0,0 +1,204 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphSummary.cpp
+ * @brief Level-of-detail export of large factor graphs for the viewer.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/GraphSummary.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtsam/base/types.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace gtdynamics {
+
+namespace {
+/// Make a string usable in a node name, which the viewer uses as an HTML id.
+std::string Sanitized(const std::string &s) {
+  std::string result = s;
+  for (char &c : result) {
+    if (!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+  }
+  return result;
+}
+
+/// Class name of a factor without namespaces and template arguments.
+std::string FactorType(const gtsam::NonlinearFactor &factor) {
+  std::string name = gtsam::demangle(typeid(factor).name());
+  name = name.substr(0, name.find('<'));
+  const size_t colon = name.rfind("::");
+  return colon == std::string::npos ? name : name.substr(colon + 2);
+}
+}  // namespace
+
+/* ************************************************************************* */
+GraphSummary::GraphSummary(const gtsam::NonlinearFactorGraph &graph)
+    : graph_(graph) {
+  for (size_t i = 0; i < graph.size(); i++) {
+    const auto &factor = graph.at(i);
+    if (!factor) continue;
+
+    // Variables, the first time a key is seen.
+    std::string labels;
+    int time = std::numeric_limits<int>::max();
+    for (gtsam::Key key : factor->keys()) {
+      const DynamicsSymbol symbol(key);
+      const int t = static_cast<int>(symbol.time());
+      time = std::min(time, t);
+      labels += "_" + symbol.label();
+      auto it = cluster_of_key_.find(key);
+      if (it == cluster_of_key_.end()) {
+        const std::string name =
+            Sanitized(symbol.label()) + "_" + std::to_string(t);
+        it = cluster_of_key_.emplace(key, name).first;
+        Cluster &cluster = variable_clusters_[name];
+        cluster.label = symbol.label();
+        cluster.time = t;
+        cluster.keys.push_back(key);
+      }
+      std::vector<size_t> &factors = variable_clusters_[it->second].factors;
+      if (factors.empty() || factors.back() != i) factors.push_back(i);
+    }
+    if (factor->keys().empty()) time = 0;
+
+    // The factor, in the cluster of its type and first time step.
+    const std::string type = FactorType(*factor);
+    Cluster &cluster = factor_clusters_[Sanitized(type + labels) + "_" +
+                                        std::to_string(time)];
+    cluster.label = type;
+    cluster.time = time;
+    cluster.factors.push_back(i);
+    for (gtsam::Key key : factor->keys()) {
+      cluster.variables.insert(cluster_of_key_.at(key));
+    }
+  }
+}
+
+/* ************************************************************************* */
+std::vector<std::string> GraphSummary::variableClusters() const {
+  std::vector<std::string> names;
+  for (auto &&[name, cluster] : variable_clusters_) names.push_back(name);
+  return names;
+}
+
+/* ************************************************************************* */
+std::vector<std::string> GraphSummary::factorClusters() const {
+  std::vector<std::string> names;
+  for (auto &&[name, cluster] : factor_clusters_) names.push_back(name);
+  return names;
+}
+
+/* ************************************************************************* */
+std::string GraphSummary::DrillDownFile(const std::string &cluster) {
+  return cluster + ".json";
+}
+
+/* ************************************************************************* */
+void GraphSummary::writeSummary(std::ostream &stm,
+                                const gtsam::Values &values) const {
+  // One row per variable label, in alphabetical order.
+  std::map<std::string, int> rows;
+  for (auto &&[name, cluster] : variable_clusters_) rows[cluster.label] = 0;
+  int row = 0;
+  for (auto &&[label, r] : rows) r = row++;
+
+  const auto quoted = &JsonSaver::Quoted;
+  JsonSaver::ListWriter all(stm);
+  JsonSaver::ListWriter variables(all.next());
+  for (auto &&[name, cluster] : variable_clusters_) {
+    const gtsam::Vector3 location(cluster.time, rows.at(cluster.label), 0);
+    JsonSaver::DictWriter dict(variables.next());
+    dict.add(quoted("name"), quoted(name));
+    dict.add(quoted("value"),
+             quoted(std::to_string(cluster.keys.size()) + " variables"));
+    dict.add(quoted("location"), JsonSaver::GetVector(location));
+    dict.add(quoted("drill_down"), quoted(DrillDownFile(name)));
+    dict.close();
+  }
+  variables.close();
+
+  JsonSaver::ListWriter factors(all.next());
+  for (auto &&[name, cluster] : factor_clusters_) {
+    double error = 0.0;
+    if (!values.empty()) {
+      for (size_t i : cluster.factors) error += graph_.at(i)->error(values);
+    }
+    std::vector<std::string> variable_names;
+    for (auto &&variable : cluster.variables) {
+      variable_names.push_back(quoted(variable));
+    }
+    JsonSaver::DictWriter dict(factors.next());
+    dict.add(quoted("name"), quoted(name));
+    dict.add(quoted("type"), quoted(cluster.label));
+    dict.add(quoted("variables"), JsonSaver::JsonList(variable_names, -1));
+    dict.add(quoted("measurement"),
+             quoted(std::to_string(cluster.factors.size()) + " factors"));
+    dict.add(quoted("noise"), quoted(""));
+    dict.add(quoted("whitened error"), quoted(""));
+    dict.add(quoted("error"), std::to_string(error));
+    dict.add(quoted("drill_down"), quoted(DrillDownFile(name)));
+    dict.close();
+  }
+  factors.close();
+  all.close();
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph GraphSummary::subgraph(
+    const std::string &cluster) const {
+  auto it = factor_clusters_.find(cluster);
+  if (it == factor_clusters_.end()) {
+    it = variable_clusters_.find(cluster);
+    if (it == variable_clusters_.end()) {
+      throw std::out_of_range("GraphSummary: no cluster named " + cluster);
+    }
+  }
+  gtsam::NonlinearFactorGraph subgraph;
+  subgraph.reserve(it->second.factors.size());
+  for (size_t i : it->second.factors) subgraph.push_back(graph_.at(i));
+  return subgraph;
+}
+
+/* ************************************************************************* */
+void GraphSummary::writeCluster(const std::string &cluster, std::ostream &stm,
+                                const gtsam::Values &values) const {
+  const gtsam::NonlinearFactorGraph factors = subgraph(cluster);
+  gtsam::Values factor_values;
+  for (gtsam::Key key : factors.keys()) {
+    if (values.exists(key)) factor_values.insert(key, values.at(key));
+  }
+  JsonSaver::SaveFactorGraph(factors, stm, factor_values);
+}
+
+/* ************************************************************************* */
+void GraphSummary::save(const std::string &directory,
+                        const gtsam::Values &values,
+                        const std::vector<std::string> &drill_down) const {
+  auto open = [&directory](const std::string &file) {
+    const std::string path = directory + "/" + file;
+    std::ofstream stm(path);
+    if (!stm) throw std::runtime_error("GraphSummary: cannot write " + path);
+    return stm;
+  };
+  std::ofstream summary = open("factor_graph.json");
+  writeSummary(summary, values);
+  for (const std::string &cluster : drill_down) {
+    std::ofstream stm = open(DrillDownFile(cluster));
+    writeCluster(cluster, stm, values);
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphSummary.h
+ * @brief Level-of-detail export of large factor graphs for the viewer.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Summary of a factor graph for visualization/factor_graph.html, which cannot
+ * lay out graphs beyond a few thousand nodes. Variables are grouped by the
+ * label and time step of their DynamicsSymbol, e.g. all joint angles of step
+ * 3 form the cluster "q_3"; factors are grouped by type, the labels of their
+ * variables, and their first time step. The summary file has one node per
+ * cluster, with its size and total error, and each cluster can be written as
+ * a drill-down file with its factors and variables in full.
+ *
+ * Only the grouping, one index per variable and factor, is computed up
+ * front; files cost time and space in proportion to what they show.
+ */
+class GraphSummary {
+ public:
+  /// Group the variables and factors of graph, which must outlive this.
+  explicit GraphSummary(const gtsam::NonlinearFactorGraph &graph);
+
+  /// Names of the variable and factor clusters, in order.
+  std::vector<std::string> variableClusters() const;
+  std::vector<std::string> factorClusters() const;
+
+  /// Name of the drill-down file of a cluster, e.g. "q_3.json".
+  static std::string DrillDownFile(const std::string &cluster);
+
+  /**
+   * Write the summary in the format of JsonSaver::SaveFactorGraph, with one
+   * variable and one factor node per cluster. Variable clusters are placed by
+   * time step and label; factor clusters have the total error of their
+   * factors at values, if given. Nodes name their drill-down file.
+   */
+  void writeSummary(std::ostream &stm,
+                    const gtsam::Values &values = gtsam::Values()) const;
+
+  /**
+   * Write the drill-down file of a cluster, in the format of
+   * JsonSaver::SaveFactorGraph: the factors of a factor cluster, or all
+   * factors on a variable of a variable cluster. Throws if there is no such
+   * cluster.
+   */
+  void writeCluster(const std::string &cluster, std::ostream &stm,
+                    const gtsam::Values &values = gtsam::Values()) const;
+
+  /**
+   * Write factor_graph.json with the summary, and the drill-down files of
+   * the given clusters, into directory.
+   */
+  void save(const std::string &directory, const gtsam::Values &values,
+            const std::vector<std::string> &drill_down = {}) const;
+
+ private:
+  /// Members of a cluster, by key or factor index.
+  struct Cluster {
+    std::string label;  // variable label, or factor type
+    int time = 0;
+    std::vector<gtsam::Key> keys;
+    std::vector<size_t> factors;
+    std::set<std::string> variables;  // variable clusters of the factors
+  };
+
+  const gtsam::NonlinearFactorGraph &graph_;
+  std::map<std::string, Cluster> variable_clusters_, factor_clusters_;
+  std::map<gtsam::Key, std::string> cluster_of_key_;
+
+  /// Factors in a cluster, or on its variables.
+  gtsam::NonlinearFactorGraph subgraph(const std::string &cluster) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.cpp
+ * @brief Terrain as a regular grid of heights, with interpolated queries.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/utils/HeightMap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+HeightMap::HeightMap(const gtsam::Matrix &heights, const gtsam::Point2 &origin,
+                     double resolution)
+    : rows_(heights.rows()),
+      cols_(heights.cols()),
+      origin_(origin),
+      resolution_(resolution) {
+  if (rows_ < 2 || cols_ < 2) {
+    throw std::invalid_argument("HeightMap: the grid must be at least 2 x 2.");
+  }
+  if (!(resolution > 0)) {
+    throw std::invalid_argument("HeightMap: the resolution must be positive.");
+  }
+  heights_.resize(rows_ * cols_);
+  for (size_t i = 0; i < rows_; i++) {
+    for (size_t j = 0; j < cols_; j++) heights_[i * cols_ + j] = heights(i, j);
+  }
+}
+
+/* ************************************************************************* */
+HeightMap::Cell HeightMap::cell(double x, double y) const {
+  // Grid coordinates, clamped onto the grid.
+  auto clamp = [this](double s, size_t n, double *ds) {
+    *ds = 1.0 / resolution_;
+    if (s < 0.0 || s > n - 1.0) {
+      *ds = 0.0;
+      s = std::min(std::max(s, 0.0), n - 1.0);
+    }
+    return s;
+  };
+  Cell c;
+  const double s = clamp((x - origin_.x()) / resolution_, rows_, &c.du);
+  const double t = clamp((y - origin_.y()) / resolution_, cols_, &c.dv);
+  const size_t i = std::min(static_cast<size_t>(s), rows_ - 2);
+  const size_t j = std::min(static_cast<size_t>(t), cols_ - 2);
+  c.h = heights_.data() + i * cols_ + j;
+  c.u = s - i;
+  c.v = t - j;
+  return c;
+}
+
+/* ************************************************************************* */
+double HeightMap::height(double x, double y,
+                         gtsam::OptionalJacobian<1, 2> H_xy) const {
+  const Cell c = cell(x, y);
+  const double h00 = c.h[0], h01 = c.h[1], h10 = c.h[cols_],
+               h11 = c.h[cols_ + 1];
+  if (H_xy) {
+    *H_xy << ((1 - c.v) * (h10 - h00) + c.v * (h11 - h01)) * c.du,
+        ((1 - c.u) * (h01 - h00) + c.u * (h11 - h10)) * c.dv;
+  }
+  return (1 - c.u) * ((1 - c.v) * h00 + c.v * h01) +
+         c.u * ((1 - c.v) * h10 + c.v * h11);
+}
+
+/* ************************************************************************* */
+gtsam::Vector2 HeightMap::gradient(double x, double y,
+                                   gtsam::OptionalJacobian<2, 2> H_xy) const {
+  const Cell c = cell(x, y);
+  const double h00 = c.h[0], h01 = c.h[1], h10 = c.h[cols_],
+               h11 = c.h[cols_ + 1];
+  if (H_xy) {
+    // Bilinear interpolation has no curvature along x or y.
+    const double cross = (h11 - h10 - h01 + h00) * c.du * c.dv;
+    *H_xy << 0, cross, cross, 0;
+  }
+  return gtsam::Vector2(((1 - c.v) * (h10 - h00) + c.v * (h11 - h01)) * c.du,
+                        ((1 - c.u) * (h01 - h00) + c.u * (h11 - h10)) * c.dv);
+}
+
+/* ************************************************************************* */
+gtsam::Vector3 HeightMap::normal(double x, double y,
+                                 gtsam::OptionalJacobian<3, 2> H_xy) const {
+  gtsam::Matrix2 H_gradient;
+  const gtsam::Vector2 g = gradient(x, y, H_xy ? &H_gradient : nullptr);
+  const gtsam::Vector3 m(-g.x(), -g.y(), 1.0);
+  const double norm = m.norm();
+  const gtsam::Vector3 n = m / norm;
+  if (H_xy) {
+    // dn/dm = (I - n n^T) / |m|, and dm/dg = -[I; 0].
+    const gtsam::Matrix3 H_m = (gtsam::I_3x3 - n * n.transpose()) / norm;
+    *H_xy = -H_m.leftCols<2>() * H_gradient;
+  }
+  return n;
+}
+
+/* ************************************************************************* */
+void HeightMap::heights(const gtsam::Matrix &points, gtsam::Vector *heights,
+                        gtsam::Matrix *gradients) const {
+  if (points.rows() < 2) {
+    throw std::invalid_argument("HeightMap: points need x and y rows.");
+  }
+  const Eigen::Index n = points.cols();
+  heights->resize(n);
+  if (gradients) gradients->resize(2, n);
+  gtsam::Matrix12 H;
+  for (Eigen::Index p = 0; p < n; p++) {
+    (*heights)(p) =
+        height(points(0, p), points(1, p), gradients ? &H : nullptr);
+    if (gradients) gradients->col(p) = H.transpose();
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Matrix ContactClearances(const HeightMap &terrain,
+                                const PointOnLinks &contact_points,
+                                const gtsam::Values &values, int num_steps) {
+  const Eigen::Index num_contacts = contact_points.size();
+  gtsam::Matrix points(3, (num_steps + 1) * num_contacts);
+  for (int k = 0; k <= num_steps; k++) {
+    for (Eigen::Index c = 0; c < num_contacts; c++) {
+      points.col(k * num_contacts + c) = contact_points[c].predict(values, k);
+    }
+  }
+  gtsam::Vector heights;
+  terrain.heights(points, &heights);
+
+  gtsam::Matrix clearances(num_steps + 1, num_contacts);
+  for (int k = 0; k <= num_steps; k++) {
+    for (Eigen::Index c = 0; c < num_contacts; c++) {
+      const Eigen::Index p = k * num_contacts + c;
+      clearances(k, c) = points(2, p) - heights(p);
+    }
+  }
+  return clearances;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.h
+ * @brief Terrain as a regular grid of heights, with interpolated queries.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Terrain in a z-up world, as heights on a regular grid in x and y, with
+ * bilinear interpolation between the grid points. Heights, gradients and
+ * upward normals come with Jacobians for the contact factors; outside the
+ * grid the border heights extend outwards, with zero slope across the
+ * border. Heights are stored contiguously, and each query reads one cell of
+ * four heights, so batched queries of nearby points stay in cache.
+ */
+class HeightMap {
+ public:
+  /**
+   * Constructor.
+   * @param heights    heights(i, j) is the height at origin + (i, j) *
+   * resolution, at least 2 x 2
+   * @param origin     x and y of the first grid point
+   * @param resolution spacing of the grid points, positive
+   */
+  HeightMap(const gtsam::Matrix &heights, const gtsam::Point2 &origin,
+            double resolution);
+
+  /// Height at (x, y), with its gradient as the Jacobian.
+  double height(double x, double y,
+                gtsam::OptionalJacobian<1, 2> H_xy = {}) const;
+
+  /// Gradient (dh/dx, dh/dy) at (x, y), with its Jacobian, the Hessian.
+  gtsam::Vector2 gradient(double x, double y,
+                          gtsam::OptionalJacobian<2, 2> H_xy = {}) const;
+
+  /// Unit upward normal at (x, y), with its Jacobian in (x, y).
+  gtsam::Vector3 normal(double x, double y,
+                        gtsam::OptionalJacobian<3, 2> H_xy = {}) const;
+
+  /**
+   * Batched heights of the points in the columns of a 2 x N or 3 x N matrix,
+   * at their first two rows.
+   * @param points    the points
+   * @param heights   resized to N
+   * @param gradients if given, resized to 2 x N, the gradients
+   */
+  void heights(const gtsam::Matrix &points, gtsam::Vector *heights,
+               gtsam::Matrix *gradients = nullptr) const;
+
+  /// Grid size, spacing and first grid point.
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  double resolution() const { return resolution_; }
+  const gtsam::Point2 &origin() const { return origin_; }
+
+ private:
+  size_t rows_, cols_;
+  gtsam::Point2 origin_;
+  double resolution_;
+  std::vector<double> heights_;  // row-major, heights(i, j) at i * cols_ + j
+
+  /// A grid cell and the coordinates in it of a query.
+  struct Cell {
+    const double *h;   // heights of the corner with the lowest indices
+    double u, v;       // in [0, 1], along i and j
+    double du, dv;     // du/dx and dv/dy, zero where clamped
+  };
+  Cell cell(double x, double y) const;
+};
+
+using HeightMapConstSharedPtr = std::shared_ptr<const HeightMap>;
+
+/**
+ * Clearance of contact points above the terrain, for all contacts in a
+ * trajectory in one batched query: entry (k, c) is the height of contact c
+ * above the terrain at time step k, from the link poses in values.
+ * @param terrain        the terrain
+ * @param contact_points the contact points
+ * @param values         link poses of time steps 0..num_steps
+ * @param num_steps      last time step
+ */
+gtsam::Matrix ContactClearances(const HeightMap &terrain,
+                                const PointOnLinks &contact_points,
+                                const gtsam::Values &values, int num_steps);
+
+}  // namespace gtdynamics
@@ -22,6 +22,9 @@
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -103,81 +106,134 @@ Values Initializer::InitializePosesAndJoints(
   return values;
 }
 
-Values Initializer::InitializeSolutionInterpolation(
-    const Robot& robot, const std::string& link_name, const Pose3& wTl_i,
-    const Pose3& wTl_f, double T_s, double T_f, double dt,
-    double gaussian_noise, const std::optional<PointOnLinks>& contact_points) {
+namespace {
+/// Noisy interpolated link pose and sampled joint state at one time step.
+struct InterpolationStep {
+  int t;
+  Pose3 wTl;
+  Vector q, v;  // indexed by joint id
+};
+
+/// Append the steps interpolating from T_s to T_f; a step shared with the
+/// previous interpolation keeps the previous one.
+void AppendInterpolationSteps(const Robot& robot, const Pose3& wTl_i,
+                              const Pose3& wTl_f, double T_s, double T_f,
+                              double dt, double gaussian_noise, uint64_t seed,
+                              std::vector<InterpolationStep>* steps) {
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed);
 
   // Initial and final discretized timesteps.
   int n_steps_init = std::lround(T_s / dt);
   int n_steps_final = std::lround(T_f / dt);
+  const size_t num_joint_ids = robot.topology().joints.size();
 
   double t_elapsed = T_s;
-
-  Values init_vals;
-
-  // Initialize joint angles and velocities to 0.
   for (int t = n_steps_init; t <= n_steps_final; t++) {
     double s = (t_elapsed - T_s) / (T_f - T_s);
 
-    // Compute interpolated pose for link.
-    Pose3 wTl_t = AddGaussianNoiseToPose(
-        gtsam::interpolate<Pose3>(wTl_i, wTl_f, s), sampler);
-
-    // Compute forward dynamics to obtain remaining link poses.
-    // TODO(Alejandro): forwardKinematics needs to get passed prev link twist
+    // Compute interpolated pose for link, and sample joint angles and
+    // velocities, in the same order as the samples were always drawn.
+    InterpolationStep step{
+        t, gtsam::interpolate<Pose3>(wTl_i, wTl_f, s).expmap(sampler.sample()),
+        Vector::Zero(num_joint_ids), Vector::Zero(num_joint_ids)};
     for (auto&& joint : robot.joints()) {
-      InsertJointAngle(&init_vals, joint->id(), t, sampler.sample()[0]);
-      InsertJointVel(&init_vals, joint->id(), t, sampler.sample()[0]);
-    }
-
-    auto link = robot.link(link_name);
-    if (link->isFixed()) {
-      throw std::invalid_argument("InitializeSolutionInterpolation: Link " +
-                                  link_name + " is fixed.");
-    }
-    InsertPose(&init_vals, link->id(), t, wTl_t);
-    InsertTwist(&init_vals, link->id(), t, gtsam::Z_6x1);
-    init_vals = robot.forwardKinematics(init_vals, t, link_name);
-
-    const Values zero_values =
-        ZeroValues(robot, t, gaussian_noise, contact_points);
-    for (auto&& key : zero_values.keys()) {
-      if (!init_vals.exists(key)) {
-        init_vals.insert(key, zero_values.at(key));
-      }
+      step.q(joint->id()) = sampler.sample()[0];
+      step.v(joint->id()) = sampler.sample()[0];
     }
+    if (steps->empty() || steps->back().t < t) steps->push_back(step);
 
     t_elapsed += dt;
   }
+}
 
+/// Values for all steps: forward kinematics from the interpolated link along
+/// the cached spanning tree, and zero values for everything else. Steps are
+/// independent, so they are initialized in parallel and merged once.
+Values InterpolationValues(const Initializer& initializer, const Robot& robot,
+                           const std::string& link_name,
+                           const std::vector<InterpolationStep>& steps,
+                           double gaussian_noise,
+                           const std::optional<PointOnLinks>& contact_points) {
+  auto link = robot.link(link_name);
+  if (link->isFixed()) {
+    throw std::invalid_argument("InitializeSolutionInterpolation: Link " +
+                                link_name + " is fixed.");
+  }
+
+  // Links reached by forward kinematics from the interpolated link.
+  const RobotTopology& topology = robot.topology();
+  const RobotTopology::Tree& tree = topology.trees[link->id()];
+  std::vector<int> tree_links{int(link->id())};
+  for (size_t k = 0; k < tree.joints.size(); k++) {
+    const int j = tree.joints[k];
+    tree_links.push_back(topology.parent_link[j] == tree.from[k]
+                             ? topology.child_link[j]
+                             : topology.parent_link[j]);
+  }
+
+  // Tasks of consecutive steps, each reusing one buffer of link states.
+  const size_t steps_per_task = 16;
+  const size_t num_tasks = (steps.size() + steps_per_task - 1) / steps_per_task;
+  std::vector<Values> step_values(steps.size());
+  auto initializeSteps = [&](size_t task) {
+    const size_t begin = task * steps_per_task,
+                 end = std::min(begin + steps_per_task, steps.size());
+    LinkStates states;  // reused across steps.
+    for (size_t n = begin; n < end; n++) {
+      const InterpolationStep& step = steps[n];
+      const int t = step.t;
+      robot.forwardKinematics(step.q, step.v, &states, link_name, step.wTl);
+
+      Values values =
+          initializer.ZeroValues(robot, t, gaussian_noise, contact_points);
+      for (auto&& joint : robot.joints()) {
+        const int j = joint->id();
+        values.update(JointAngleKey(j, t), step.q(j));
+        values.update(JointVelKey(j, t), step.v(j));
+      }
+      for (int i : tree_links) {
+        values.update(PoseKey(i, t), states.poses[i]);
+        values.update(TwistKey(i, t), states.twists[i]);
+      }
+      step_values[n] = std::move(values);
+    }
+  };
+  initializer.execution().parallelFor(num_tasks, initializeSteps);
+
+  Values init_vals;
+  for (const Values& values : step_values) init_vals.insert(values);
   return init_vals;
 }
+}  // namespace
+
+Values Initializer::InitializeSolutionInterpolation(
+    const Robot& robot, const std::string& link_name, const Pose3& wTl_i,
+    const Pose3& wTl_f, double T_s, double T_f, double dt,
+    double gaussian_noise, const std::optional<PointOnLinks>& contact_points) {
+  std::vector<InterpolationStep> steps;
+  AppendInterpolationSteps(robot, wTl_i, wTl_f, T_s, T_f, dt, gaussian_noise,
+                           seed_, &steps);
+  return InterpolationValues(*this, robot, link_name, steps, gaussian_noise,
+                             contact_points);
+}
 
 Values Initializer::InitializeSolutionInterpolationMultiPhase(
     const Robot& robot, const std::string& link_name, const Pose3& wTl_i,
     const std::vector<Pose3>& wTl_t, const std::vector<double>& ts, double dt,
     double gaussian_noise, const std::optional<PointOnLinks>& contact_points) {
-  Values init_vals;
+  std::vector<InterpolationStep> steps;
   Pose3 pose = wTl_i;
   double curr_t = 0.0;
   for (size_t i = 0; i < wTl_t.size(); i++) {
-    Values phase_vals = InitializeSolutionInterpolation(
-        robot, link_name, pose, wTl_t[i], curr_t, ts[i], dt, gaussian_noise,
-        contact_points);
-
-    for (auto&& key : phase_vals.keys()) {
-      if (!init_vals.exists(key)) {
-        init_vals.insert(key, phase_vals.at(key));
-      }
-    }
+    AppendInterpolationSteps(robot, pose, wTl_t[i], curr_t, ts[i], dt,
+                             gaussian_noise, seed_, &steps);
     pose = wTl_t[i];
     curr_t = ts[i];
   }
-  return init_vals;
+  return InterpolationValues(*this, robot, link_name, steps, gaussian_noise,
+                             contact_points);
 }
 
 Values Initializer::InitializeSolutionInverseKinematics(
@@ -191,7 +247,7 @@ Values Initializer::InitializeSolutionInverseKinematics(
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   // Link pose at each step
   std::vector<Pose3> wTl_dt;
@@ -284,7 +340,7 @@ Values Initializer::MultiPhaseInverseKinematicsTrajectory(
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   std::vector<Pose3> wTl_dt;
 
@@ -350,7 +406,7 @@ Values Initializer::ZeroValues(
 
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  Sampler sampler(sampler_noise_model, seed_);
 
   // Initialize link dynamics to 0.
   for (auto&& link : robot.links()) {
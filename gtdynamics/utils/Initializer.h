@@ -15,6 +15,7 @@
 
 #include <gtdynamics/dynamics/DynamicsGraph.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ExecutionContext.h>
 #include <gtsam/base/Value.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -32,8 +33,22 @@ class Initializer {
 
  public:
     
-    // Default Constructor
-    Initializer() {}
+    /**
+     * Constructor.
+     * @param seed Seed of the gaussian noise added to initial values, e.g.
+     * different for each start of MultiStartOptimize.
+     * @param execution Threads that initialize time steps.
+     */
+    explicit Initializer(
+        uint64_t seed = 42,
+        const ExecutionContext& execution = ExecutionContext::Default())
+        : seed_(seed), execution_(execution) {}
+
+    /// Seed of the gaussian noise.
+    uint64_t seed() const { return seed_; }
+
+    /// Threads that initialize time steps.
+    const ExecutionContext& execution() const { return execution_; }
 
     /**
      * Add zero-mean gaussian noise to a Pose3.
@@ -218,6 +233,9 @@ class Initializer {
         double gaussian_noise = 0.0,
         const std::optional<PointOnLinks>& contact_points = {});
 
+ protected:
+    uint64_t seed_;
+    ExecutionContext execution_;
 };
 
 }  // namespace gtdynamics
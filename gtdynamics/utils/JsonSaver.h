@@ -26,11 +26,15 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <optional>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <typeinfo>
 #include <utility>
@@ -95,9 +99,18 @@ class JsonSaver {
    * @return                  a string representing vector in json format
    */
   static inline std::string GetName(const gtsam::Key& key) {
-    std::stringstream ss;
-    auto symb = DynamicsSymbol(key);
-    return (std::string)(symb);
+    return _GTDKeyFormatter(key);
+  }
+
+  /**
+   * @brief get the name of a key through a cache of names
+   * @param[in] key           key of the variable
+   * @param[in] names         cache of the names of the dump, or nullptr
+   * @return                  a string with the name of the variable
+   */
+  static inline std::string GetName(const gtsam::Key& key,
+                                    KeyNameCache* names) {
+    return names ? (*names)(key) : GetName(key);
   }
 
   /**
@@ -152,6 +165,49 @@ class JsonSaver {
     return s;
   }
 
+  /**
+   * @brief write the items of a list to a stream as they are produced, in
+   * the format of JsonList with no indent
+   */
+  class ListWriter {
+    std::ostream& stm_;
+    bool empty_ = true;
+
+   public:
+    explicit ListWriter(std::ostream& stm) : stm_(stm) {}
+
+    /// start the next item, which the caller writes to the returned stream
+    std::ostream& next() {
+      stm_ << (empty_ ? "[" : ",") << "\n";
+      empty_ = false;
+      return stm_;
+    }
+
+    /// end the list
+    void close() { stm_ << "\n]"; }
+  };
+
+  /**
+   * @brief write the items of a dict to a stream as they are produced, in
+   * the format of JsonDict with no indent
+   */
+  class DictWriter {
+    std::ostream& stm_;
+    bool empty_ = true;
+
+   public:
+    explicit DictWriter(std::ostream& stm) : stm_(stm) {}
+
+    /// write the next key value pair
+    void add(const std::string& key, const std::string& value) {
+      stm_ << (empty_ ? "{" : ",") << "\n" << key << ":" << value;
+      empty_ = false;
+    }
+
+    /// end the dict
+    void close() { stm_ << "\n}"; }
+  };
+
   /**
    * @brief get the gtsam variable value as a string
    * @param[in] value         gtsam variable value
@@ -345,82 +401,109 @@ class JsonSaver {
   }
 
   /**
-   * @brief get the variable in json format as a string
+   * @brief write the variable in json format to a stream
+   * @param[in] stm           output stream
    * @param[in] key           corresponding key of variable
    * @param[in] values        values
    * @param[in] locations     locations
-   * @return                  a string displaying the variable in json
+   * @param[in] names         cache of the names of the dump, or nullptr
    */
-  static inline std::string GetVariable(const gtsam::Key& key,
-                                        const gtsam::Values& values,
-                                        const LocationType& locations) {
-    std::vector<AttributeType> attributes;
+  static inline void WriteVariable(std::ostream& stm, const gtsam::Key& key,
+                                   const gtsam::Values& values,
+                                   const LocationType& locations,
+                                   KeyNameCache* names = nullptr) {
+    DictWriter dict(stm);
 
     // name;
-    std::string name = GetName(key);
-    attributes.emplace_back(Quoted("name"), Quoted(name));
+    dict.add(Quoted("name"), Quoted(GetName(key, names)));
 
     if (values.exists(key)) {
       // value
-      std::optional<gtsam::Vector3> location;
-      attributes.emplace_back(Quoted("value"),
-                              Quoted(GetValue(values.at(key))));
+      dict.add(Quoted("value"), Quoted(GetValue(values.at(key))));
 
       // location
       const auto loc_str = GetLocation(locations, key, values.at(key));
       if (loc_str != "") {
-        attributes.emplace_back(Quoted("location"), loc_str);
+        dict.add(Quoted("location"), loc_str);
       }
     }
-    return JsonDict(attributes);
+    dict.close();
   }
 
   /**
-   * @brief get the factor in json format as a string
+   * @brief get the variable in json format as a string
+   * @param[in] key           corresponding key of variable
+   * @param[in] values        values
+   * @param[in] locations     locations
+   * @return                  a string displaying the variable in json
+   */
+  static inline std::string GetVariable(const gtsam::Key& key,
+                                        const gtsam::Values& values,
+                                        const LocationType& locations) {
+    std::stringstream ss;
+    WriteVariable(ss, key, values, locations);
+    return ss.str();
+  }
+
+  /**
+   * @brief write the factor in json format to a stream
+   * @param[in] stm           output stream
    * @param[in] idx           index of factor
    * @param[in] graph         factor graph
    * @param[in] values        values
-   * @return                  a string displaying the factor in json
+   * @param[in] names         cache of the names of the dump, or nullptr
    */
-  static inline std::string GetFactor(const size_t idx,
-                                      const gtsam::NonlinearFactorGraph& graph,
-                                      const gtsam::Values& values) {
+  static inline void WriteFactor(std::ostream& stm, const size_t idx,
+                                 const gtsam::NonlinearFactorGraph& graph,
+                                 const gtsam::Values& values,
+                                 KeyNameCache* names = nullptr) {
     const gtsam::NonlinearFactor::shared_ptr& factor = graph.at(idx);
 
-    std::vector<AttributeType> attributes;
+    DictWriter dict(stm);
 
     // name
-    attributes.emplace_back(Quoted("name"),
-                            Quoted("Factor" + std::to_string(idx)));
+    dict.add(Quoted("name"), Quoted("Factor" + std::to_string(idx)));
 
     // type
-    attributes.emplace_back(Quoted("type"), Quoted(GetType(factor)));
+    dict.add(Quoted("type"), Quoted(GetType(factor)));
 
     // variables
     const gtsam::KeyVector& keys = factor->keys();
     std::vector<std::string> variable_names;
     for (gtsam::Key key : keys) {
-      std::stringstream ss;
-      ss << Quoted(GetName(key));
-      variable_names.push_back(ss.str());
+      variable_names.push_back(Quoted(GetName(key, names)));
     }
-    attributes.emplace_back(Quoted("variables"), JsonList(variable_names, -1));
+    dict.add(Quoted("variables"), JsonList(variable_names, -1));
 
     // measurement
-    attributes.emplace_back(Quoted("measurement"),
-                            Quoted(GetMeasurement(factor)));
+    dict.add(Quoted("measurement"), Quoted(GetMeasurement(factor)));
 
     // noise model
-    attributes.emplace_back(Quoted("noise"), Quoted(GetNoiseModel(factor)));
+    dict.add(Quoted("noise"), Quoted(GetNoiseModel(factor)));
 
     // whitened noise model
-    attributes.emplace_back(Quoted("whitened error"),
-                            Quoted(GetWhitenedError(factor, values)));
+    dict.add(Quoted("whitened error"),
+             Quoted(GetWhitenedError(factor, values)));
 
     // error
-    attributes.emplace_back(Quoted("error"), GetError(factor, values));
+    dict.add(Quoted("error"), GetError(factor, values));
+
+    dict.close();
+  }
 
-    return JsonDict(attributes);
+  /**
+   * @brief get the factor in json format as a string
+   * @param[in] idx           index of factor
+   * @param[in] graph         factor graph
+   * @param[in] values        values
+   * @return                  a string displaying the factor in json
+   */
+  static inline std::string GetFactor(const size_t idx,
+                                      const gtsam::NonlinearFactorGraph& graph,
+                                      const gtsam::Values& values) {
+    std::stringstream ss;
+    WriteFactor(ss, idx, graph, values);
+    return ss.str();
   }
 
   /**
@@ -435,24 +518,25 @@ class JsonSaver {
       const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
       const gtsam::Values& values = gtsam::Values(),
       const LocationType& locations = LocationType()) {
-    std::vector<std::string> variable_strings;
-    std::vector<std::string> factor_strings;
+    const gtsam::KeySet keys = graph.keys();
+    KeyNameCache names(gtsam::KeyVector(keys.begin(), keys.end()));
+    ListWriter all(stm);
 
     // add variables
-    for (gtsam::Key key : graph.keys()) {
-      variable_strings.push_back(GetVariable(key, values, locations));
+    ListWriter variables(all.next());
+    for (gtsam::Key key : keys) {
+      WriteVariable(variables.next(), key, values, locations, &names);
     }
+    variables.close();
 
     // add factors
+    ListWriter factors(all.next());
     for (size_t i = 0; i < graph.size(); ++i) {
-      factor_strings.push_back(GetFactor(i, graph, values));
+      WriteFactor(factors.next(), i, graph, values, &names);
     }
+    factors.close();
 
-    std::string s_variables = JsonList(variable_strings);
-    std::string s_factors = JsonList(factor_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
+    all.close();
   }
 
   /**
@@ -513,22 +597,21 @@ class JsonSaver {
       }
     }
 
-    std::vector<std::string> values_strings;
-    std::vector<std::string> graphs_strings;
+    ListWriter all(stm);
 
     // add clustered values
+    ListWriter values_list(all.next());
     for (const auto& it : clustered_values) {
       std::string cluster_name = it.first;
       const gtsam::Values& values = it.second;
 
-      std::vector<AttributeType> attributes;
+      DictWriter dict(values_list.next());
       // name
-      attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+      dict.add(Quoted("name"), Quoted(cluster_name));
 
       // location
       if (locations.find(cluster_name) != locations.end()) {
-        const auto loc_str = GetVector(locations.at(cluster_name));
-        attributes.emplace_back(Quoted("location"), loc_str);
+        dict.add(Quoted("location"), GetVector(locations.at(cluster_name)));
       }
 
       // values
@@ -536,22 +619,21 @@ class JsonSaver {
       for (const gtsam::Key& key : values.keys()) {
         varaible_names.emplace_back(GetName(key));
       }
-      attributes.emplace_back(JsonSaver::Quoted("value"),
-                              Quoted(JsonList(varaible_names, -1)));
-      values_strings.emplace_back(JsonDict(attributes));
+      dict.add(JsonSaver::Quoted("value"),
+               Quoted(JsonList(varaible_names, -1)));
+      dict.close();
     }
+    values_list.close();
 
     // add clustered graphs
+    ListWriter graphs_list(all.next());
     for (const auto& it : clustered_graphs) {
       std::string cluster_name = it.first;
       const gtsam::NonlinearFactorGraph& graph = it.second;
 
-      // std::cout << "graph cluster: " << cluster_name << "\tsize:" <<
-      // graph.size() << "\n";
-
-      std::vector<AttributeType> attributes;
+      DictWriter dict(graphs_list.next());
       // name
-      attributes.emplace_back(Quoted("name"), Quoted(cluster_name));
+      dict.add(Quoted("name"), Quoted(cluster_name));
 
       // varaible clusters
       std::set<std::string> values_cluster_names;
@@ -562,46 +644,71 @@ class JsonSaver {
       }
       std::vector<std::string> vec_cluster_names(values_cluster_names.begin(),
                                                  values_cluster_names.end());
-      attributes.emplace_back(Quoted("variables"),
-                              JsonList(vec_cluster_names, -1));
+      dict.add(Quoted("variables"), JsonList(vec_cluster_names, -1));
 
       // calculate errors
       double error = 0;
       for (const auto& factor : graph) {
         error += factor->error(values);
       }
-      attributes.emplace_back(Quoted("error"), std::to_string(error));
+      dict.add(Quoted("error"), std::to_string(error));
 
       // location
       if (locations.find(cluster_name) != locations.end()) {
-        const auto loc_str = GetVector(locations.at(cluster_name));
-        attributes.emplace_back(Quoted("location"), loc_str);
+        dict.add(Quoted("location"), GetVector(locations.at(cluster_name)));
       }
-
-      graphs_strings.emplace_back(JsonDict(attributes));
+      dict.close();
     }
+    graphs_list.close();
 
-    std::string s_variables = JsonList(values_strings);
-    std::string s_factors = JsonList(graphs_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
+    all.close();
   }
 };
 
+/**
+ * @brief
+ * Store the history of values over optimizer iterations. Each variable keeps
+ * its first value and, for every recorded iteration, the tangent vector from
+ * it in one contiguous buffer, so that recording does not clone values.
+ */
 class StorageManager {
  private:
   typedef JsonSaver::AttributeType AttributeType;
   typedef std::shared_ptr<gtsam::Value> ValuePtr;
-  typedef std::map<gtsam::Key, std::vector<ValuePtr>> StorageMap;
-  typedef std::pair<gtsam::Key, std::vector<ValuePtr>> StorageEntry;
+
+  /// history of one variable
+  struct History {
+    ValuePtr reference;         // value of the first recorded iteration
+    size_t dim;                 // dimension of the tangent space
+    std::vector<double> data;   // tangent vectors, one per iteration
+    size_t size() const { return dim == 0 ? 0 : data.size() / dim; }
+  };
+  typedef std::map<gtsam::Key, History> StorageMap;
   StorageMap storage_;
+  size_t decimation_;
+  size_t num_calls_ = 0;
+
+  /// value of a variable at recorded iteration i
+  static ValuePtr ValueAt(const History& history, size_t i) {
+    const gtsam::Vector delta = Eigen::Map<const gtsam::Vector>(
+        history.data.data() + i * history.dim, history.dim);
+    return ValuePtr(history.reference->retract_(delta));
+  }
 
  public:
   /**
    * @brief constructor
+   * @param[in] decimation    record only every decimation-th call to
+   * AddValues, starting with the first
    */
-  StorageManager() {}
+  explicit StorageManager(size_t decimation = 1)
+      : decimation_(decimation == 0 ? 1 : decimation) {}
+
+  /// number of recorded iterations of a variable
+  size_t NumRecorded(const gtsam::Key& key) const {
+    auto it = storage_.find(key);
+    return it == storage_.end() ? 0 : it->second.size();
+  }
 
   /**
    * @brief get the history of values e.g. [[x_t0, y_t0, z_t0], [x_t1, y_t1,
@@ -610,9 +717,10 @@ class StorageManager {
    * return           the history values of the variable
    */
   std::string GetValueHistory(const gtsam::Key& key) {
+    const History& history = storage_.at(key);
     std::vector<std::string> value_sequence;
-    for (const auto value_ptr : storage_.at(key)) {
-      value_sequence.push_back(JsonSaver::GetValueList(*value_ptr));
+    for (size_t i = 0; i < history.size(); i++) {
+      value_sequence.push_back(JsonSaver::GetValueList(*ValueAt(history, i)));
     }
     return JsonSaver::JsonList(value_sequence, -1);
   }
@@ -632,23 +740,23 @@ class StorageManager {
     attributes.emplace_back(JsonSaver::Quoted("name"), JsonSaver::Quoted(name));
 
     if (storage_.find(key) != storage_.end()) {
+      const History& history = storage_.at(key);
+      const ValuePtr last = ValueAt(history, history.size() - 1);
+
       // value
-      attributes.emplace_back(
-          JsonSaver::Quoted("value"),
-          JsonSaver::Quoted(JsonSaver::GetValue(*(storage_.at(key).back()))));
+      attributes.emplace_back(JsonSaver::Quoted("value"),
+                              JsonSaver::Quoted(JsonSaver::GetValue(*last)));
 
       // value history
       attributes.emplace_back(JsonSaver::Quoted("value_history"),
                               GetValueHistory(key));
 
       // value type
-      attributes.emplace_back(
-          JsonSaver::Quoted("value_types"),
-          JsonSaver::GetValueTypes(*(storage_.at(key).back())));
+      attributes.emplace_back(JsonSaver::Quoted("value_types"),
+                              JsonSaver::GetValueTypes(*last));
 
       // location
-      const auto loc_str =
-          JsonSaver::GetLocation(locations, key, *(storage_.at(key).back()));
+      const auto loc_str = JsonSaver::GetLocation(locations, key, *last);
       if (loc_str != "") {
         attributes.emplace_back(JsonSaver::Quoted("location"), loc_str);
       }
@@ -667,24 +775,25 @@ class StorageManager {
       const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
       const gtsam::Values& values = gtsam::Values(),
       const JsonSaver::LocationType& locations = JsonSaver::LocationType()) {
-    std::vector<std::string> variable_strings;
-    std::vector<std::string> factor_strings;
+    const gtsam::KeySet keys = graph.keys();
+    KeyNameCache names(gtsam::KeyVector(keys.begin(), keys.end()));
+    JsonSaver::ListWriter all(stm);
 
     // add variables
-    for (gtsam::Key key : graph.keys()) {
-      variable_strings.push_back(GetVariableSequence(key, locations));
+    JsonSaver::ListWriter variables(all.next());
+    for (gtsam::Key key : keys) {
+      variables.next() << GetVariableSequence(key, locations);
     }
+    variables.close();
 
     // add factors
+    JsonSaver::ListWriter factors(all.next());
     for (size_t i = 0; i < graph.size(); ++i) {
-      factor_strings.push_back(JsonSaver::GetFactor(i, graph, values));
+      JsonSaver::WriteFactor(factors.next(), i, graph, values, &names);
     }
+    factors.close();
 
-    std::string s_variables = JsonSaver::JsonList(variable_strings);
-    std::string s_factors = JsonSaver::JsonList(factor_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonSaver::JsonList(all_strings);
-    stm << s_all;
+    all.close();
   }
 
   /**
@@ -692,23 +801,83 @@ class StorageManager {
    * @param[in] values        gtsam values of variables in the current step
    */
   void AddValues(const gtsam::Values& values) {
+    if (num_calls_++ % decimation_ != 0) return;
+
     // remove absent variables
-    for (auto key_value : storage_) {
-      if (!values.exists(key_value.first)) {
-        storage_.erase(key_value.first);
-      }
+    for (auto it = storage_.begin(); it != storage_.end();) {
+      it = values.exists(it->first) ? std::next(it) : storage_.erase(it);
     }
 
     // update existing variables
     for (auto key : values.keys()) {
+      const gtsam::Value& value = values.at(key);
       auto it = storage_.find(key);
       if (it == storage_.end()) {
-        storage_.emplace(key, std::vector<ValuePtr>{values.at(key).clone()});
+        History history{value.clone(), value.dim(), {}};
+        history.data.resize(history.dim, 0.0);
+        storage_.emplace(key, std::move(history));
       } else {
-        it->second.push_back(values.at(key).clone());
+        const gtsam::Vector delta =
+            it->second.reference->localCoordinates_(value);
+        it->second.data.insert(it->second.data.end(), delta.data(),
+                               delta.data() + delta.size());
       }
     }
   }
+
+  /**
+   * @brief write the histories in binary: the magic "GTDHIST1" and the
+   * number of variables as uint64, then for each variable its key, tangent
+   * dimension and number of iterations as uint64, followed by the tangent
+   * vectors as float64
+   * @param[in] stm           output stream, opened in binary mode
+   */
+  void SaveHistoryBinary(std::ostream& stm) const {
+    auto write_uint64 = [&stm](uint64_t n) {
+      stm.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    };
+    stm.write("GTDHIST1", 8);
+    write_uint64(storage_.size());
+    for (const auto& [key, history] : storage_) {
+      write_uint64(key);
+      write_uint64(history.dim);
+      write_uint64(history.size());
+      stm.write(reinterpret_cast<const char*>(history.data.data()),
+                history.data.size() * sizeof(double));
+    }
+  }
+
+  /**
+   * @brief read histories written by SaveHistoryBinary
+   * @param[in] stm           input stream
+   * @return                  for each variable, one tangent vector per row
+   */
+  static std::map<gtsam::Key, gtsam::Matrix> LoadHistoryBinary(
+      std::istream& stm) {
+    auto read_uint64 = [&stm]() {
+      uint64_t n = 0;
+      stm.read(reinterpret_cast<char*>(&n), sizeof(n));
+      return n;
+    };
+    char magic[8];
+    stm.read(magic, 8);
+    if (!stm || std::string(magic, 8) != "GTDHIST1") {
+      throw std::runtime_error("StorageManager: not a history file.");
+    }
+    std::map<gtsam::Key, gtsam::Matrix> histories;
+    const uint64_t num_keys = read_uint64();
+    for (uint64_t k = 0; k < num_keys; k++) {
+      const gtsam::Key key = read_uint64();
+      const uint64_t dim = read_uint64(), num_samples = read_uint64();
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+          samples(num_samples, dim);
+      stm.read(reinterpret_cast<char*>(samples.data()),
+               samples.size() * sizeof(double));
+      if (!stm) throw std::runtime_error("StorageManager: truncated file.");
+      histories.emplace(key, samples);
+    }
+    return histories;
+  }
 };
 
 // const std::string JsonSaver::kQuote_ = "\"";
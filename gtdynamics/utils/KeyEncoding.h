@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KeyEncoding.h
+ * @brief Compile-time layouts of the fields of dynamics variable keys.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+
+#include <cstdint>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Layout of a 64-bit key as, from the highest bits: two label characters,
+ * then a robot id, a link id, a joint id and the time step, with the given
+ * numbers of bits. A field whose bits are all set means "none", e.g. the
+ * link of a joint angle. Encoding and decoding are constexpr shifts and
+ * masks, without branches; out of range ids are truncated to their field.
+ *
+ * DynamicsSymbol uses DynamicsKeyEncoding. WideKeyEncoding fits robots with
+ * up to 1023 links and joints, and scenes of up to 63 robots, in one graph.
+ */
+template <unsigned ROBOT_BITS, unsigned LINK_BITS, unsigned JOINT_BITS>
+struct KeyEncoding {
+  static constexpr unsigned kCharBits = 8;
+  static constexpr unsigned kRobotBits = ROBOT_BITS;
+  static constexpr unsigned kLinkBits = LINK_BITS;
+  static constexpr unsigned kJointBits = JOINT_BITS;
+  static constexpr unsigned kTimeBits =
+      64 - 2 * kCharBits - kRobotBits - kLinkBits - kJointBits;
+  static_assert(kLinkBits > 0 && kJointBits > 0 && kTimeBits >= 16,
+                "KeyEncoding: needs link and joint bits, and 16 time bits.");
+
+  // Shifts of the fields.
+  static constexpr unsigned kJointShift = kTimeBits;
+  static constexpr unsigned kLinkShift = kJointShift + kJointBits;
+  static constexpr unsigned kRobotShift = kLinkShift + kLinkBits;
+  static constexpr unsigned kChar2Shift = kRobotShift + kRobotBits;
+  static constexpr unsigned kChar1Shift = kChar2Shift + kCharBits;
+
+  /// Mask of the lowest `bits` bits, which is also the "none" value.
+  static constexpr uint64_t Ones(unsigned bits) {
+    return bits == 0 ? 0 : ~uint64_t(0) >> (64 - bits);
+  }
+  static constexpr uint64_t kNoRobot = Ones(kRobotBits);
+  static constexpr uint64_t kNoLink = Ones(kLinkBits);
+  static constexpr uint64_t kNoJoint = Ones(kJointBits);
+
+  /// Decoded fields of a key.
+  struct Fields {
+    uint8_t c1, c2;
+    uint64_t robot, link, joint, t;
+  };
+
+  /// Pack fields into a key.
+  static constexpr gtsam::Key Encode(uint8_t c1, uint8_t c2, uint64_t robot,
+                                     uint64_t link, uint64_t joint,
+                                     uint64_t t) {
+    return (gtsam::Key(c1) << kChar1Shift) |
+           (gtsam::Key(c2) << kChar2Shift) |
+           ((robot & Ones(kRobotBits)) << kRobotShift) |
+           ((link & Ones(kLinkBits)) << kLinkShift) |
+           ((joint & Ones(kJointBits)) << kJointShift) |
+           (t & Ones(kTimeBits));
+  }
+
+  /// Pack the fields of a 1 or 2 character label, as in DynamicsSymbol.
+  static constexpr gtsam::Key Encode(const char* label, uint64_t robot,
+                                     uint64_t link, uint64_t joint,
+                                     uint64_t t) {
+    return label[0] == 0 ? Encode(0, 0, robot, link, joint, t)
+           : label[1] == 0
+               ? Encode(0, label[0], robot, link, joint, t)
+               : Encode(label[0], label[1], robot, link, joint, t);
+  }
+
+  static constexpr uint8_t Char1(gtsam::Key key) {
+    return uint8_t(key >> kChar1Shift);
+  }
+  static constexpr uint8_t Char2(gtsam::Key key) {
+    return uint8_t(key >> kChar2Shift);
+  }
+  static constexpr uint64_t Robot(gtsam::Key key) {
+    return (key >> kRobotShift) & Ones(kRobotBits);
+  }
+  static constexpr uint64_t Link(gtsam::Key key) {
+    return (key >> kLinkShift) & Ones(kLinkBits);
+  }
+  static constexpr uint64_t Joint(gtsam::Key key) {
+    return (key >> kJointShift) & Ones(kJointBits);
+  }
+  static constexpr uint64_t Time(gtsam::Key key) {
+    return key & Ones(kTimeBits);
+  }
+
+  /// Unpack all fields of a key.
+  static constexpr Fields Decode(gtsam::Key key) {
+    return Fields{Char1(key), Char2(key), Robot(key),
+                  Link(key),  Joint(key), Time(key)};
+  }
+
+  /// Key with another time step, e.g. to step through a trajectory.
+  static constexpr gtsam::Key WithTime(gtsam::Key key, uint64_t t) {
+    return (key & ~Ones(kTimeBits)) | (t & Ones(kTimeBits));
+  }
+
+  /**
+   * Name of a key, as DynamicsSymbol names them with the robot prefixed,
+   * e.g. "q<1>(2)10" for the angle of joint 2 of robot 1 at step 10.
+   */
+  static std::string Format(gtsam::Key key) {
+    const Fields f = Decode(key);
+    std::string s;
+    if (f.c1 != 0) s += char(f.c1);
+    if (f.c2 != 0) s += char(f.c2);
+    if (kRobotBits > 0 && f.robot != kNoRobot) {
+      s += '<' + std::to_string(f.robot) + '>';
+    }
+    if (f.link != kNoLink) s += '[' + std::to_string(f.link) + ']';
+    if (f.joint != kNoJoint) s += '(' + std::to_string(f.joint) + ')';
+    return s + std::to_string(f.t);
+  }
+};
+
+/// The encoding of DynamicsSymbol: no robot id, 255 links and joints.
+using DynamicsKeyEncoding = KeyEncoding<0, 8, 8>;
+
+/// 63 robots with up to 1023 links and joints, and 4M time steps.
+using WideKeyEncoding = KeyEncoding<6, 10, 10>;
+
+}  // namespace gtdynamics
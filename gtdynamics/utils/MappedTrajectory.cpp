@@ -0,0 +1,184 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MappedTrajectory.cpp
+ * @brief Columnar trajectory files, read through memory mapping.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/utils/MappedTrajectory.h>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+const char kMagic[] = "GTDCOLS1";
+const size_t kMagicSize = 8;
+const size_t kNumQuantities = 4;
+
+void WriteUint64(std::ostream &os, uint64_t n) {
+  os.write(reinterpret_cast<const char *>(&n), sizeof(n));
+}
+
+void WriteColumn(std::ostream &os, const gtsam::Vector &column) {
+  os.write(reinterpret_cast<const char *>(column.data()),
+           column.size() * sizeof(double));
+}
+}  // namespace
+
+/* ************************************************************************* */
+void MappedTrajectory::Write(std::ostream &os, const Robot &robot,
+                             const gtsam::Values &results,
+                             const gtsam::Vector &dts) {
+  const size_t K = dts.size();
+  const std::vector<gtsam::Matrix> quantities{
+      DynamicsGraph::jointAnglesMatrix(robot, results, K),
+      DynamicsGraph::jointVelsMatrix(robot, results, K),
+      DynamicsGraph::jointAccelsMatrix(robot, results, K),
+      DynamicsGraph::jointTorquesMatrix(robot, results, K)};
+
+  os.write(kMagic, kMagicSize);
+  WriteUint64(os, K);
+  WriteUint64(os, robot.numJoints());
+  for (auto &&joint : robot.joints()) WriteUint64(os, joint->id());
+  for (auto &&matrix : quantities) {
+    for (int j = 0; j < matrix.cols(); j++) WriteColumn(os, matrix.col(j));
+  }
+  WriteColumn(os, dts);
+}
+
+/* ************************************************************************* */
+MappedTrajectory::MappedTrajectory(const std::string &path) {
+#ifdef _WIN32
+  // No mapping: read the file into a buffer that is owned like a mapping.
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good()) {
+    throw std::runtime_error("MappedTrajectory: no file found at " + path);
+  }
+  const std::vector<char> contents((std::istreambuf_iterator<char>(is)),
+                                   std::istreambuf_iterator<char>());
+  size_ = contents.size();
+  char *buffer = reinterpret_cast<char *>(new double[size_ / 8 + 1]);
+  std::copy(contents.begin(), contents.end(), buffer);
+  data_ = buffer;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("MappedTrajectory: no file found at " + path);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("MappedTrajectory: cannot read " + path);
+  }
+  size_ = st.st_size;
+  if (size_ > 0) {
+    void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) data_ = static_cast<const char *>(mapping);
+  }
+  ::close(fd);
+  if (!data_) {
+    throw std::runtime_error("MappedTrajectory: cannot map " + path);
+  }
+#endif
+
+  // Header, checking that all columns are inside the file.
+  const uint64_t *header = reinterpret_cast<const uint64_t *>(data_);
+  const size_t header_size = kMagicSize + 2 * sizeof(uint64_t);
+  if (size_ < header_size || std::memcmp(data_, kMagic, kMagicSize) != 0) {
+    unmap();
+    throw std::runtime_error("MappedTrajectory: not a trajectory: " + path);
+  }
+  num_steps_ = header[1];
+  const size_t J = header[2];
+  const size_t num_doubles = (kNumQuantities * J + 1) * num_steps_;
+  if ((size_ - header_size) / sizeof(uint64_t) < J ||
+      (size_ - header_size - J * sizeof(uint64_t)) / sizeof(double) <
+          num_doubles) {
+    unmap();
+    throw std::runtime_error("MappedTrajectory: truncated file: " + path);
+  }
+  joint_ids_.assign(header + 3, header + 3 + J);
+  for (size_t c = 0; c < J; c++) joint_columns_[joint_ids_[c]] = c;
+  columns_ = reinterpret_cast<const double *>(header + 3 + J);
+}
+
+/* ************************************************************************* */
+MappedTrajectory::~MappedTrajectory() { unmap(); }
+
+/* ************************************************************************* */
+void MappedTrajectory::unmap() {
+  if (!data_) return;
+#ifdef _WIN32
+  delete[] reinterpret_cast<const double *>(data_);
+#else
+  ::munmap(const_cast<char *>(data_), size_);
+#endif
+  data_ = nullptr;
+}
+
+/* ************************************************************************* */
+const double *MappedTrajectory::columnData(Quantity quantity, int j) const {
+  auto it = joint_columns_.find(j);
+  if (it == joint_columns_.end()) {
+    throw std::out_of_range("MappedTrajectory: no joint with id " +
+                            std::to_string(j));
+  }
+  const size_t column = quantity * numJoints() + it->second;
+  return columns_ + column * num_steps_;
+}
+
+/* ************************************************************************* */
+size_t MappedTrajectory::checkedStep(size_t k) const {
+  if (k >= num_steps_) {
+    throw std::out_of_range("MappedTrajectory: no time step " +
+                            std::to_string(k));
+  }
+  return k;
+}
+
+/* ************************************************************************* */
+MappedTrajectory::Column MappedTrajectory::slice(const double *column,
+                                                 size_t k_begin,
+                                                 size_t k_end) const {
+  k_end = std::min(k_end, num_steps_);
+  if (k_begin > k_end) {
+    throw std::out_of_range("MappedTrajectory: empty time step range.");
+  }
+  return Column(column + k_begin, k_end - k_begin);
+}
+
+/* ************************************************************************* */
+MappedTrajectory::Column MappedTrajectory::column(Quantity quantity, int j,
+                                                  size_t k_begin,
+                                                  size_t k_end) const {
+  return slice(columnData(quantity, j), k_begin, k_end);
+}
+
+/* ************************************************************************* */
+MappedTrajectory::Column MappedTrajectory::dts(size_t k_begin,
+                                               size_t k_end) const {
+  return slice(columns_ + kNumQuantities * numJoints() * num_steps_, k_begin,
+               k_end);
+}
+
+}  // namespace gtdynamics
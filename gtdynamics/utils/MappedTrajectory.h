@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MappedTrajectory.h
+ * @brief Columnar trajectory files, read through memory mapping.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * MappedTrajectory gives read-only access to a columnar trajectory file
+ * without loading it: the file is memory mapped, and the columns are
+ * returned as views into the mapping, so that only the pages of the queried
+ * time steps and joints are read from disk.
+ *
+ * The file has all 64-bit fields: the magic "GTDCOLS1", the number of time
+ * steps K and of joints J, the J joint ids, then for the angles, velocities,
+ * accelerations and torques one column of K float64 per joint, in the order
+ * of the ids, and last the column of the K time step durations.
+ */
+class MappedTrajectory {
+ public:
+  enum Quantity { ANGLE = 0, VELOCITY, ACCELERATION, TORQUE };
+  using Column = Eigen::Map<const gtsam::Vector>;
+  static constexpr size_t kEnd = std::numeric_limits<size_t>::max();
+
+  /**
+   * Write a trajectory in the columnar format.
+   * @param os        Stream, opened in binary mode.
+   * @param robot     Robot whose joints are written, in the order of joints().
+   * @param results   Values of the trajectory.
+   * @param dts       Durations of time steps 0..K-1.
+   */
+  static void Write(std::ostream &os, const Robot &robot,
+                    const gtsam::Values &results, const gtsam::Vector &dts);
+
+  /// Map a file; throws std::runtime_error if it is not a trajectory file.
+  explicit MappedTrajectory(const std::string &path);
+
+  ~MappedTrajectory();
+
+  MappedTrajectory(const MappedTrajectory &) = delete;
+  MappedTrajectory &operator=(const MappedTrajectory &) = delete;
+
+  size_t numSteps() const { return num_steps_; }
+  size_t numJoints() const { return joint_ids_.size(); }
+
+  /// Ids of the joints, in the order of the columns.
+  const std::vector<uint64_t> &jointIds() const { return joint_ids_; }
+
+  /**
+   * View of a quantity of one joint over time steps [k_begin, k_end).
+   * @param quantity  Angle, velocity, acceleration or torque.
+   * @param j         Joint id.
+   */
+  Column column(Quantity quantity, int j, size_t k_begin = 0,
+                size_t k_end = kEnd) const;
+
+  /// Value of a quantity of joint j at time step k.
+  double at(Quantity quantity, int j, size_t k) const {
+    return columnData(quantity, j)[checkedStep(k)];
+  }
+
+  /// View of the durations of time steps [k_begin, k_end).
+  Column dts(size_t k_begin = 0, size_t k_end = kEnd) const;
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  size_t num_steps_ = 0;
+  std::vector<uint64_t> joint_ids_;
+  std::map<uint64_t, size_t> joint_columns_;
+  const double *columns_ = nullptr;
+
+  void unmap();
+  const double *columnData(Quantity quantity, int j) const;
+  size_t checkedStep(size_t k) const;
+  Column slice(const double *column, size_t k_begin, size_t k_end) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.cpp
+ * @brief Interned noise models, shared by all factors that use them.
+ * @author Frank Dellaert
+ */
+
+#include <gtdynamics/utils/NoiseModels.h>
+
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::noiseModel::Constrained;
+using gtsam::noiseModel::Diagonal;
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+namespace {
+enum class ModelType { Isotropic, Diagonal, Constrained, Unit };
+
+// Models by type and parameters, i.e. dimension and sigmas.
+using ModelKey = std::pair<ModelType, std::vector<double>>;
+
+std::mutex &CacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// The cache only holds weak references, so a model is released once no
+// factor or setting uses it, and a later call creates it again.
+using Cache = std::map<ModelKey, std::weak_ptr<gtsam::noiseModel::Base>>;
+
+Cache &TheCache() {
+  static Cache cache;
+  return cache;
+}
+
+// Erase the entries of released models. Called when the cache has doubled
+// since the last call, so that the cost per new model is constant.
+void Prune(Cache *cache) {
+  static size_t pruned_size = 0;
+  if (cache->size() < 2 * pruned_size + 16) return;
+  for (auto it = cache->begin(); it != cache->end();) {
+    it = it->second.expired() ? cache->erase(it) : std::next(it);
+  }
+  pruned_size = cache->size();
+}
+
+// Return the cached model, or create it with `create` if it is not in use.
+template <class MODEL>
+std::shared_ptr<MODEL> Intern(
+    const ModelKey &key,
+    const std::function<std::shared_ptr<MODEL>()> &create) {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  Cache &cache = TheCache();
+  auto &entry = cache[key];
+  std::shared_ptr<gtsam::noiseModel::Base> model = entry.lock();
+  if (!model) {
+    model = create();
+    entry = model;
+    Prune(&cache);
+  }
+  return std::static_pointer_cast<MODEL>(model);
+}
+}  // namespace
+
+/* ************************************************************************* */
+Isotropic::shared_ptr InternedIsotropic(size_t dim, double sigma) {
+  return Intern<Isotropic>({ModelType::Isotropic, {double(dim), sigma}},
+                           [&]() { return Isotropic::Sigma(dim, sigma); });
+}
+
+/* ************************************************************************* */
+Diagonal::shared_ptr InternedDiagonal(const gtsam::Vector &sigmas) {
+  return Intern<Diagonal>(
+      {ModelType::Diagonal,
+       std::vector<double>(sigmas.data(), sigmas.data() + sigmas.size())},
+      [&]() { return Diagonal::Sigmas(sigmas); });
+}
+
+/* ************************************************************************* */
+Constrained::shared_ptr InternedConstrained(size_t dim) {
+  return Intern<Constrained>({ModelType::Constrained, {double(dim)}},
+                             [&]() { return Constrained::All(dim); });
+}
+
+/* ************************************************************************* */
+Unit::shared_ptr InternedUnit(size_t dim) {
+  return Intern<Unit>({ModelType::Unit, {double(dim)}},
+                      [&]() { return Unit::Create(dim); });
+}
+
+/* ************************************************************************* */
+size_t NumInternedNoiseModels() {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  size_t num_models = 0;
+  for (auto &&entry : TheCache()) num_models += !entry.second.expired();
+  return num_models;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.h
+ * @brief Interned noise models, shared by all factors that use them.
+ * @author Frank Dellaert
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <cstddef>
+
+namespace gtdynamics {
+
+/**
+ * The functions below return one shared instance per distinct noise model
+ * that is in use, so that settings built separately share their models. They
+ * are thread-safe, but take a lock: call them once per setting or graph, not
+ * once per factor. Models are released when no one uses them any more. Models
+ * with per-call sigmas, e.g. from a parameter sweep, gain nothing from being
+ * shared; create them with gtsam::noiseModel directly.
+ */
+
+/// Shared isotropic noise model, as gtsam::noiseModel::Isotropic::Sigma.
+gtsam::noiseModel::Isotropic::shared_ptr InternedIsotropic(size_t dim,
+                                                           double sigma);
+
+/// Shared diagonal noise model, as gtsam::noiseModel::Diagonal::Sigmas.
+gtsam::noiseModel::Diagonal::shared_ptr InternedDiagonal(
+    const gtsam::Vector &sigmas);
+
+/// Shared constrained noise model, as gtsam::noiseModel::Constrained::All.
+gtsam::noiseModel::Constrained::shared_ptr InternedConstrained(size_t dim);
+
+/// Shared unit noise model, as gtsam::noiseModel::Unit::Create.
+gtsam::noiseModel::Unit::shared_ptr InternedUnit(size_t dim);
+
+/// Number of distinct noise models from the functions above still in use.
+size_t NumInternedNoiseModels();
+
+}  // namespace gtdynamics
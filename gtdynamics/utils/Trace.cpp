@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.cpp
+ * @brief Scoped trace events, written in the Chrome trace format for
+ * chrome://tracing and Perfetto.
+ * @author Varun Agrawal
+ */
+
+#include <gtdynamics/utils/Trace.h>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+TraceRecorder &TraceRecorder::Instance() {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+/* ************************************************************************* */
+void TraceRecorder::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  threads_.clear();
+  origin_ = Clock::now();
+  active_ = true;
+}
+
+/* ************************************************************************* */
+void TraceRecorder::record(const char *name, const char *category,
+                           Clock::time_point begin, Clock::time_point end) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  const std::thread::id id = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!active_) return;
+
+  // Threads are numbered in order of their first event.
+  auto it = std::find(threads_.begin(), threads_.end(), id);
+  const size_t thread = it - threads_.begin();
+  if (it == threads_.end()) threads_.push_back(id);
+
+  events_.push_back({name, category,
+                     duration_cast<microseconds>(begin - origin_).count(),
+                     duration_cast<microseconds>(end - begin).count(),
+                     thread});
+}
+
+/* ************************************************************************* */
+std::vector<TraceEvent> TraceRecorder::events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_;
+}
+
+/* ************************************************************************* */
+void TraceRecorder::writeJson(std::ostream &os) const {
+  const std::vector<TraceEvent> events = this->events();
+  os << "{\"traceEvents\": [";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent &event = events[i];
+    os << (i ? ",\n" : "\n") << "  {\"name\": \"" << event.name
+       << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"ts\": "
+       << event.begin_us << ", \"dur\": " << event.duration_us
+       << ", \"pid\": 1, \"tid\": " << event.thread << "}";
+  }
+  os << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+/* ************************************************************************* */
+void TraceRecorder::save(const std::string &file_path) const {
+  std::ofstream file(file_path);
+  if (!file) {
+    throw std::runtime_error("TraceRecorder: cannot write " + file_path);
+  }
+  writeJson(file);
+}
+
+}  // namespace gtdynamics
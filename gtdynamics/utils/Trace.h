@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.h
+ * @brief Scoped trace events, written in the Chrome trace format for
+ * chrome://tracing and Perfetto.
+ * @author Varun Agrawal
+ */
+
+#pragma once
+
+#include <gtdynamics/config.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/// One complete event: a named span of time on one thread.
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  int64_t begin_us;
+  int64_t duration_us;
+  size_t thread;
+};
+
+/**
+ * Process-wide recorder of trace events. Events are only recorded between
+ * start() and stop(), and only by the GTD_TRACE_SCOPE macros when GTDynamics
+ * is built with GTDYNAMICS_WITH_TRACING; otherwise the macros compile to
+ * nothing. Names and categories must outlive the recorder, e.g. literals.
+ */
+class TraceRecorder {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// The recorder of the process.
+  static TraceRecorder &Instance();
+
+  /// Clear the events and start recording; times are relative to now.
+  void start();
+
+  /// Stop recording, keeping the events.
+  void stop() { active_ = false; }
+
+  /// Whether events are recorded.
+  bool active() const { return active_; }
+
+  /// Record an event that began and ended at the given times.
+  void record(const char *name, const char *category, Clock::time_point begin,
+              Clock::time_point end);
+
+  /// Copy of the events recorded so far.
+  std::vector<TraceEvent> events() const;
+
+  /// Write the events as a Chrome trace JSON object.
+  void writeJson(std::ostream &os) const;
+
+  /// Write the events to a file, throws if it cannot be written.
+  void save(const std::string &file_path) const;
+
+ private:
+  TraceRecorder() = default;
+
+  std::atomic<bool> active_{false};
+  Clock::time_point origin_;
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_;
+  std::vector<std::thread::id> threads_;
+};
+
+/// Records an event from construction to destruction, if recording.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char *name, const char *category = "gtdynamics")
+      : name_(name), category_(category) {
+    if (TraceRecorder::Instance().active()) {
+      begin_ = TraceRecorder::Clock::now();
+      recording_ = true;
+    }
+  }
+
+  ~ScopedTrace() {
+    if (recording_) {
+      TraceRecorder::Instance().record(name_, category_, begin_,
+                                       TraceRecorder::Clock::now());
+    }
+  }
+
+  ScopedTrace(const ScopedTrace &) = delete;
+  ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+ private:
+  const char *name_;
+  const char *category_;
+  TraceRecorder::Clock::time_point begin_;
+  bool recording_ = false;
+};
+
+}  // namespace gtdynamics
+
+#define GTD_TRACE_CONCAT_(a, b) a##b
+#define GTD_TRACE_CONCAT(a, b) GTD_TRACE_CONCAT_(a, b)
+
+#ifdef GTDYNAMICS_USE_TRACING
+/// Trace the rest of the enclosing scope, optionally with a category.
+#define GTD_TRACE_SCOPE(...)                                     \
+  const ::gtdynamics::ScopedTrace GTD_TRACE_CONCAT(gtd_trace_, \
+                                                   __LINE__)(__VA_ARGS__)
+#else
+#define GTD_TRACE_SCOPE(...) static_cast<void>(0)
+#endif
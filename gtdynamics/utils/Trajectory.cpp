@@ -12,14 +12,23 @@
  * @author: Frank Dellaert, Gerry Chen, Frank Dellaert
  */
 
+#include <gtdynamics/factors/JointsObjectiveFactors.h>
 #include <gtdynamics/factors/ObjectiveFactors.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorGraphTemplate.h>
+#include <gtdynamics/utils/MappedTrajectory.h>
 #include <gtdynamics/utils/Trajectory.h>
 #include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/expressions.h>
 
 #include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -37,16 +46,48 @@ namespace gtdynamics {
 
 vector<NonlinearFactorGraph> Trajectory::getTransitionGraphs(
     const Robot &robot, const DynamicsGraph &graph_builder, double mu) const {
-  vector<NonlinearFactorGraph> transition_graphs;
-  const vector<int> final_timesteps = finalTimeSteps();
-  const vector<PointOnLinks> trans_cps = transitionContactPoints();
-  for (int p = 1; p < numPhases(); p++) {
-    transition_graphs.push_back(graph_builder.dynamicsFactorGraph(
-        robot, final_timesteps[p - 1], trans_cps[p - 1], mu));
-  }
+  // Transitions are independent, so build them in parallel, on the threads
+  // of the graph builder's settings.
+  const int num_transitions = numPhases() > 0 ? numPhases() - 1 : 0;
+  vector<NonlinearFactorGraph> transition_graphs(num_transitions);
+  graph_builder.opt().execution.parallelFor(num_transitions, [&](size_t p) {
+    transition_graphs[p] = graph_builder.dynamicsFactorGraph(
+        robot, final_timesteps_[p], transition_contact_points_[p], mu);
+  });
   return transition_graphs;
 }
 
+Trajectory Trajectory::withPhaseDurations(
+    const vector<int> &phase_steps) const {
+  if (phase_steps.size() != phases_.size()) {
+    throw std::invalid_argument(
+        "Trajectory::withPhaseDurations: expected " +
+        to_string(phases_.size()) + " phase durations.");
+  }
+  Trajectory trajectory = *this;
+  size_t k = phases_.empty() ? 0 : phases_.front().k_start;
+  for (size_t p = 0; p < phases_.size(); p++) {
+    if (phase_steps[p] < 1) {
+      throw std::invalid_argument(
+          "Trajectory::withPhaseDurations: phases need at least one step.");
+    }
+    trajectory.phases_[p].k_start = k;
+    k += phase_steps[p];
+    trajectory.phases_[p].k_end = k;
+  }
+  trajectory.cachePhaseData();
+  return trajectory;
+}
+
+Trajectory Trajectory::coarsened(double factor) const {
+  vector<int> phase_steps;
+  for (auto &&phase : phases_) {
+    phase_steps.push_back(
+        std::max<int>(1, std::lround(phase.numTimeSteps() / factor)));
+  }
+  return withPhaseDurations(phase_steps);
+}
+
 NonlinearFactorGraph Trajectory::multiPhaseFactorGraph(
     const Robot &robot, const DynamicsGraph &graph_builder,
     const CollocationScheme collocation, double mu) const {
@@ -57,15 +98,87 @@ NonlinearFactorGraph Trajectory::multiPhaseFactorGraph(
                                               phaseContactPoints(), mu);
 }
 
+const PointOnLinks &Trajectory::stepContactPoints(int k) const {
+  const size_t P = numPhases();
+  if (k < 0 || P == 0 || k > final_timesteps_.back()) {
+    throw std::out_of_range("Trajectory::stepContactPoints: no time step " +
+                            std::to_string(k));
+  }
+  for (size_t p = 0; p + 1 < P; p++) {
+    if (k < final_timesteps_[p]) return phase_contact_points_[p];
+    if (k == final_timesteps_[p]) return transition_contact_points_[p];
+  }
+  return phase_contact_points_[P - 1];
+}
+
+GraphPatch Trajectory::contactSwitchPatch(
+    const NonlinearFactorGraph &graph, const Robot &robot,
+    const DynamicsGraph &graph_builder, int k_start, int k_end,
+    const FootContactConstraintSpec &spec, double mu) const {
+  GraphPatch patch;
+  for (int k = k_start; k <= k_end; k++) {
+    graph_builder.contactSwitchPatch(graph, robot, k, stepContactPoints(k),
+                                     spec.contactPoints(), mu, &patch);
+  }
+  return patch;
+}
+
+NonlinearFactorGraph Trajectory::repeatedMultiPhaseFactorGraph(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const CollocationScheme collocation, double mu) const {
+  const int P = cycle_num_phases_, repeat = repeat_;
+  if (P == 0 || repeat < 2) {
+    return multiPhaseFactorGraph(robot, graph_builder, collocation, mu);
+  }
+  const int cycle_steps = final_timesteps_[P - 1];
+
+  // The dynamics of steps 1 to cycle_steps - 1 and the collocation factors
+  // of the first cycle; the first and last steps differ between cycles.
+  NonlinearFactorGraph dynamics, collocation_factors;
+  int k = 0;
+  for (int p = 0; p < P; p++) {
+    const int num_steps = phase(p).numTimeSteps();
+    for (int step = 0; step < num_steps; step++) {
+      collocation_factors.add(
+          graph_builder.multiPhaseCollocationFactors(robot, k, p, collocation));
+      if (++k == cycle_steps) break;
+      const bool transition = step == num_steps - 1;
+      dynamics.add(graph_builder.dynamicsFactorGraph(
+          robot, k,
+          transition ? transition_contact_points_[p] : phase_contact_points_[p],
+          mu));
+    }
+  }
+  const FactorGraphTemplate dynamics_template(dynamics),
+      collocation_template(collocation_factors);
+
+  NonlinearFactorGraph graph =
+      graph_builder.dynamicsFactorGraph(robot, 0, phase_contact_points_[0], mu);
+  for (int r = 0; r < repeat; r++) {
+    graph.add(dynamics_template.instantiate(r * cycle_steps, r * P));
+
+    // Last step of the cycle: a transition, or the last slice.
+    const int p_end = (r + 1) * P - 1;
+    graph.add(graph_builder.dynamicsFactorGraph(
+        robot, final_timesteps_[p_end],
+        r + 1 < repeat ? transition_contact_points_[p_end]
+                        : phase_contact_points_[p_end],
+        mu));
+  }
+  for (int r = 0; r < repeat; r++) {
+    graph.add(collocation_template.instantiate(r * cycle_steps, r * P));
+  }
+  return graph;
+}
+
 vector<Values> Trajectory::transitionPhaseInitialValues(
     const Robot &robot, const Initializer &initializer,
     double gaussian_noise) const {
-  vector<PointOnLinks> trans_cps = transitionContactPoints();
   vector<Values> transition_graph_init;
-  vector<int> final_timesteps = finalTimeSteps();
   for (int p = 1; p < numPhases(); p++) {
-    transition_graph_init.push_back(initializer.ZeroValues(
-        robot, final_timesteps[p - 1], gaussian_noise, trans_cps[p - 1]));
+    transition_graph_init.push_back(
+        initializer.ZeroValues(robot, final_timesteps_[p - 1], gaussian_noise,
+                               transition_contact_points_[p - 1]));
   }
   return transition_graph_init;
 }
@@ -83,7 +196,7 @@ Values Trajectory::multiPhaseInitialValues(const Robot &robot,
 
 NonlinearFactorGraph Trajectory::contactPointObjectives(
     const Robot &robot, const SharedNoiseModel &cost_model, const Point3 &step,
-    double ground_height) const {
+    double ground_height, bool path_factors) const {
   NonlinearFactorGraph factors;
 
   // Create a walk cycle using all phases of trajectory
@@ -95,7 +208,8 @@ NonlinearFactorGraph Trajectory::contactPointObjectives(
 
   size_t k_start = 0;
   factors =
-      walk_cycle.contactPointObjectives(step, cost_model, k_start, &cp_goals);
+      walk_cycle.contactPointObjectives(step, cost_model, k_start, &cp_goals,
+                                        path_factors);
 
   return factors;
 }
@@ -129,10 +243,87 @@ void Trajectory::addBoundaryConditions(
                                     joint_acceleration_model, K));
 }
 
+void Trajectory::addPeriodicBoundaryConditions(
+    gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+    const SharedNoiseModel &pose_model, const SharedNoiseModel &twist_model,
+    const SharedNoiseModel &twist_acceleration_model,
+    const SharedNoiseModel &joint_angle_model,
+    const SharedNoiseModel &joint_velocity_model,
+    const SharedNoiseModel &joint_acceleration_model,
+    gtsam::Key stride_key) const {
+  using gtsam::BetweenFactor;
+  const int K = getEndTimeStep(numPhases() - 1);
+
+  // Poses at K are the poses at 0 moved by the stride, and twists repeat.
+  const gtsam::Pose3_ stride(stride_key);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    const gtsam::Pose3_ shifted = stride * gtsam::Pose3_(PoseKey(i, 0));
+    graph->emplace_shared<gtsam::ExpressionFactor<gtsam::Pose3>>(
+        pose_model, gtsam::Pose3(),
+        gtsam::between(shifted, gtsam::Pose3_(PoseKey(i, K))));
+    graph->emplace_shared<BetweenFactor<gtsam::Vector6>>(
+        TwistKey(i, 0), TwistKey(i, K), Z_6x1, twist_model);
+    graph->emplace_shared<BetweenFactor<gtsam::Vector6>>(
+        TwistAccelKey(i, 0), TwistAccelKey(i, K), Z_6x1,
+        twist_acceleration_model);
+  }
+
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph->emplace_shared<BetweenFactor<double>>(
+        JointAngleKey(j, 0), JointAngleKey(j, K), 0.0, joint_angle_model);
+    graph->emplace_shared<BetweenFactor<double>>(
+        JointVelKey(j, 0), JointVelKey(j, K), 0.0, joint_velocity_model);
+    graph->emplace_shared<BetweenFactor<double>>(
+        JointAccelKey(j, 0), JointAccelKey(j, K), 0.0,
+        joint_acceleration_model);
+  }
+}
+
+Values Trajectory::periodicValues(const Values &values, size_t repeat,
+                                  gtsam::Key stride_key) const {
+  const int K = getEndTimeStep(numPhases() - 1);
+  const gtsam::Pose3 stride = values.at<gtsam::Pose3>(stride_key);
+  Values result;
+  gtsam::Pose3 shift;
+  for (size_t c = 0; c < repeat; c++) {
+    for (const gtsam::Key &key : values.keys()) {
+      if (key == stride_key) continue;
+      const DynamicsSymbol symbol(key);
+      const std::string label = symbol.label();
+      if (label == "dt") {
+        result.insert(PhaseKey(symbol.time() + c * numPhases()),
+                      values.at(key));
+        continue;
+      }
+      // Time step 0 of a cycle is the last time step of the previous one.
+      if (c > 0 && symbol.time() == 0) continue;
+      const gtsam::Key shifted = DynamicsSymbol::LinkJointSymbol(
+          label, symbol.linkIdx(), symbol.jointIdx(), symbol.time() + c * K);
+      if (label == "p") {
+        result.insert(shifted, shift * values.at<gtsam::Pose3>(key));
+      } else {
+        result.insert(shifted, values.at(key));
+      }
+    }
+    shift = stride * shift;
+  }
+  return result;
+}
+
 void Trajectory::addMinimumTorqueFactors(
     gtsam::NonlinearFactorGraph *graph, const Robot &robot,
-    const SharedNoiseModel &cost_model) const {
+    const SharedNoiseModel &cost_model, bool per_time_step) const {
   int K = getEndTimeStep(numPhases() - 1);
+  if (per_time_step) {
+    std::vector<int> joint_ids;
+    for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+    for (int k = 0; k <= K; k++) {
+      graph->emplace_shared<JointsMinTorqueFactor>(joint_ids, k, cost_model);
+    }
+    return;
+  }
   for (auto &&joint : robot.joints()) {
     auto j = joint->id();
     for (int k = 0; k <= K; k++) {
@@ -141,46 +332,66 @@ void Trajectory::addMinimumTorqueFactors(
   }
 }
 
-void Trajectory::writePhaseToFile(const Robot &robot, std::ofstream &file,
+void Trajectory::writePhaseToFile(const Robot &robot, std::ostream &file,
                                   const gtsam::Values &results, int p) const {
-  using gtsam::Matrix;
-
-  // Extract joint values.
-  int k = getStartTimeStep(p);
-  Matrix mat =
-      phase(p).jointMatrix(robot, results, k, results.atDouble(PhaseKey(p)));
+  TrajectoryWriter writer(robot, file);
+  writePhaseToFile(&writer, results, p);
+}
 
-  // Write to file.
-  const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
-                                         Eigen::DontAlignCols, ", ", "\n");
-  file << mat.format(CSVFormat) << std::endl;
+void Trajectory::writePhaseToFile(TrajectoryWriter *writer,
+                                  const gtsam::Values &results, int p) const {
+  // Stream one row per time step, without building the joint matrix.
+  const double dt = results.atDouble(PhaseKey(p));
+  size_t k = getStartTimeStep(p);
+  for (size_t i = 0; i < phase(p).numTimeSteps(); i++, k++) {
+    writer->writeStep(results, k, dt);
+  }
 }
 
 // Write results to traj file
 void Trajectory::writeToFile(const Robot &robot, const std::string &name,
-                             const gtsam::Values &results) const {
-  vector<string> jnames;
-  for (auto &&joint : robot.joints()) {
-    jnames.push_back(joint->name());
-  }
-  string jnames_str = "";
-  for (size_t j = 0; j < jnames.size(); j++) {
-    jnames_str += jnames[j] + (j != jnames.size() - 1 ? "," : "");
-  }
-
-  std::ofstream file(name);
+                             const gtsam::Values &results,
+                             TrajectoryWriter::Format format) const {
+  // Write through a larger buffer than the default one.
+  std::vector<char> buffer(1 << 16);
+  std::ofstream file;
+  file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  file.open(name, format == TrajectoryWriter::BINARY
+                      ? std::ios::out | std::ios::binary
+                      : std::ios::out);
 
   // angles, vels, accels, torques, time.
-  file << jnames_str << "," << jnames_str << "," << jnames_str << ","
-       << jnames_str << ",t\n";
+  TrajectoryWriter writer(robot, file, format);
+  writer.writeHeader();
   for (int p = 0; p < numPhases(); p++) {
-    writePhaseToFile(robot, file, results, p);
+    writePhaseToFile(&writer, results, p);
   }
   // Write the last 4 phases to disk n times
   for (int i = 0; i < 10; i++) {
     for (int p = 4; p < numPhases(); p++) {
-      writePhaseToFile(robot, file, results, p);
+      writePhaseToFile(&writer, results, p);
     }
   }
+  file.close();
+}
+
+void Trajectory::writeColumnarToFile(const Robot &robot,
+                                     const std::string &name,
+                                     const gtsam::Values &results) const {
+  // Duration of every time step, the last one in the final phase.
+  const int K = getEndTimeStep(numPhases() - 1);
+  gtsam::Vector dts(K + 1);
+  for (int p = 0; p < numPhases(); p++) {
+    const double dt = results.atDouble(PhaseKey(p));
+    const int k_start = getStartTimeStep(p);
+    const int k_end = p + 1 < numPhases() ? getStartTimeStep(p + 1) : K + 1;
+    dts.segment(k_start, k_end - k_start).setConstant(dt);
+  }
+
+  std::ofstream file(name, std::ios::out | std::ios::binary);
+  if (!file.good()) {
+    throw std::runtime_error("writeColumnarToFile: cannot write " + name);
+  }
+  MappedTrajectory::Write(file, robot, results, dts);
 }
 }  // namespace gtdynamics
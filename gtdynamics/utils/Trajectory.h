@@ -18,6 +18,7 @@
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/Phase.h>
+#include <gtdynamics/utils/TrajectoryWriter.h>
 #include <gtdynamics/utils/WalkCycle.h>
 #include <gtdynamics/utils/Initializer.h>
 
@@ -30,6 +31,27 @@ namespace gtdynamics {
 class Trajectory {
  protected:
   std::vector<Phase> phases_;  ///< All phases in the trajectory
+  size_t cycle_num_phases_ = 0;  ///< Number of phases of the walk cycle
+  size_t repeat_ = 0;            ///< Number of repetitions of the walk cycle
+
+  // Derived from phases_ once, at construction.
+  std::vector<PointOnLinks> phase_contact_points_;
+  std::vector<PointOnLinks> transition_contact_points_;
+  std::vector<int> final_timesteps_;
+
+  /// Compute the contact points and final time steps of all phases.
+  void cachePhaseData() {
+    final_timesteps_.clear();
+    if (phases_.empty()) return;
+    const WalkCycle wc(phases_);
+    phase_contact_points_ = wc.allPhasesContactPoints();
+    transition_contact_points_ = wc.transitionContactPoints();
+    int final_timestep = 0;
+    for (auto &&phase : phases_) {
+      final_timestep += phase.numTimeSteps();
+      final_timesteps_.push_back(final_timestep);
+    }
+  }
 
  public:
   /// Default Constructor (for serialization)
@@ -44,7 +66,8 @@ class Trajectory {
    * @param walk_cycle  The Walk Cycle for the robot.
    * @param repeat      The number of repetitions for each phase of the gait.
    */
-  Trajectory(const WalkCycle &walk_cycle, size_t repeat) {
+  Trajectory(const WalkCycle &walk_cycle, size_t repeat)
+      : cycle_num_phases_(walk_cycle.numPhases()), repeat_(repeat) {
     // Get phases of walk_cycle.
     auto phases_i = walk_cycle.phases();
     // Loop over `repeat` walk cycles W_i
@@ -52,6 +75,7 @@ class Trajectory {
       // Append phases_i of walk_cycle to phases_ vector member.
       phases_.insert(phases_.end(), phases_i.begin(), phases_i.end());
     }
+    cachePhaseData();
   }
 
   /// Returns vector of phases in the trajectory
@@ -64,9 +88,8 @@ class Trajectory {
    * and may have repetitions, as opposed to contact_points_.
    * @return Phase CPs.
    */
-  std::vector<PointOnLinks> phaseContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.allPhasesContactPoints();
+  const std::vector<PointOnLinks> &phaseContactPoints() const {
+    return phase_contact_points_;
   }
 
   /**
@@ -74,9 +97,8 @@ class Trajectory {
    * phases after applying repetition on the original sequence.
    * @return Transition CPs.
    */
-  std::vector<PointOnLinks> transitionContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.transitionContactPoints();
+  const std::vector<PointOnLinks> &transitionContactPoints() const {
+    return transition_contact_points_;
   }
 
   /**
@@ -92,6 +114,19 @@ class Trajectory {
     return phase_durations;
   }
 
+  /**
+   * The same phases with other numbers of time steps, e.g. a coarser time
+   * resolution for coarse-to-fine optimization.
+   * @param phase_steps Number of steps of each phase, see phaseDurations.
+   */
+  Trajectory withPhaseDurations(const std::vector<int> &phase_steps) const;
+
+  /**
+   * The same phases with `factor` times fewer time steps, rounded, and at
+   * least one step per phase.
+   */
+  Trajectory coarsened(double factor) const;
+
   /**
    * @fn Returns the number of phases.
    * @return Number of phases.
@@ -99,7 +134,8 @@ class Trajectory {
   size_t numPhases() const { return phases_.size(); }
 
   /**
-   * @fn Builds vector of Transition Graphs.
+   * @fn Builds vector of Transition Graphs, in parallel on the threads of
+   * the graph builder's settings.
    * @param[in] robot            Robot specification from URDF/SDF.
    * @param[in] graph_builder    Dynamics Graph
    * @param[in] mu               Coefficient of static friction
@@ -109,7 +145,8 @@ class Trajectory {
       const Robot &robot, const DynamicsGraph &graph_builder, double mu) const;
 
   /**
-   * @fn Builds multi-phase factor graph.
+   * @fn Builds multi-phase factor graph; the graphs of all time steps and
+   * transitions are built in parallel, on the threads of the settings.
    * @param[in] robot            Robot specification from URDF/SDF.
    * @param[in] graph_builder    GraphBuilder instance.
    * @param[in] collocation      Which collocation scheme to use.
@@ -120,6 +157,22 @@ class Trajectory {
       const Robot &robot, const DynamicsGraph &graph_builder,
       const CollocationScheme collocation, double mu) const;
 
+  /**
+   * @fn Builds the same multi-phase factor graph as multiPhaseFactorGraph, in
+   * the same order, but only builds the factors of the first walk cycle. The
+   * other repetitions are instantiated from them by shifting time steps and
+   * phases, see FactorGraphTemplate; only the first and the last time step of
+   * every cycle are built.
+   * @param[in] robot            Robot specification from URDF/SDF.
+   * @param[in] graph_builder    GraphBuilder instance.
+   * @param[in] collocation      Which collocation scheme to use.
+   * @param[in] mu               Coefficient of static friction.
+   * @return Multi-phase factor graph
+   */
+  gtsam::NonlinearFactorGraph repeatedMultiPhaseFactorGraph(
+      const Robot &robot, const DynamicsGraph &graph_builder,
+      const CollocationScheme collocation, double mu) const;
+
   /**
    * @fn Returns Initial values for transition graphs.
    * @param[in] robot             Robot specification from URDF/SDF.
@@ -146,16 +199,7 @@ class Trajectory {
    * @fn Returns a vector of final time step for every phase.
    * @return Vector of final time steps.
    */
-  std::vector<int> finalTimeSteps() const {
-    int final_timestep = 0;
-    std::vector<int> final_timesteps;
-    for (size_t i = 0; i < phases_.size(); i++) {
-      int phase_timestep = phases_[i].numTimeSteps();
-      final_timestep += phase_timestep;
-      final_timesteps.push_back(final_timestep);
-    }
-    return final_timesteps;
-  }
+  const std::vector<int> &finalTimeSteps() const { return final_timesteps_; }
 
   /**
    * @fn Return phase for given phase number p.
@@ -170,8 +214,7 @@ class Trajectory {
    * @return Initial time step.
    */
   int getStartTimeStep(size_t p) const {
-    std::vector<int> final_timesteps = finalTimeSteps();
-    int k_start = final_timesteps[p] - phase(p).numTimeSteps();
+    int k_start = final_timesteps_[p] - phase(p).numTimeSteps();
     if (p != 0) k_start += 1;
     return k_start;
   }
@@ -181,7 +224,35 @@ class Trajectory {
    * @param[in] p    Phase number.
    * @return Final time step.
    */
-  int getEndTimeStep(size_t p) const { return finalTimeSteps()[p]; }
+  int getEndTimeStep(size_t p) const { return final_timesteps_[p]; }
+
+  /**
+   * @fn Returns the contact points of the dynamics at a time step: those of
+   * its phase, or those of the transition at the last step of a phase.
+   * @param[in] k    Time step \in [0..getEndTimeStep(numPhases() - 1)].
+   * @return Contact points used at step k by multiPhaseFactorGraph.
+   */
+  const PointOnLinks &stepContactPoints(int k) const;
+
+  /**
+   * @fn Patch a multi-phase factor graph for a new stance on the time steps
+   * k_start to k_end, e.g. to replan the contact schedule online with an
+   * incremental solver; see DynamicsGraph::contactSwitchPatch.
+   * @param[in] graph            Graph built by multiPhaseFactorGraph.
+   * @param[in] robot            Robot specification from URDF/SDF.
+   * @param[in] graph_builder    GraphBuilder instance graph was built with.
+   * @param[in] k_start          First time step of the new stance.
+   * @param[in] k_end            Last time step of the new stance.
+   * @param[in] spec             New stance.
+   * @param[in] mu               Coefficient of static friction.
+   * @return Indices of factors to remove from graph, and factors to add.
+   */
+  GraphPatch contactSwitchPatch(const gtsam::NonlinearFactorGraph &graph,
+                                const Robot &robot,
+                                const DynamicsGraph &graph_builder, int k_start,
+                                int k_end,
+                                const FootContactConstraintSpec &spec,
+                                double mu) const;
 
   /**
    * @fn Generates a PointGoalFactor object
@@ -210,22 +281,28 @@ class Trajectory {
    * @param[in] cost_model Noise model
    * @param[in] step The 3D vector the foot moves in a step.
    * @param[in] ground_height z-coordinate of ground in URDF/SDF rest config.
+   * @param[in] path_factors one PointGoalPathFactor per foot and phase, instead
+   * of one PointGoalFactor per foot and time step.
    * @return All objective factors as a NonlinearFactorGraph
    */
   gtsam::NonlinearFactorGraph contactPointObjectives(
       const Robot &robot, const gtsam::SharedNoiseModel &cost_model,
-      const gtsam::Point3 &step, double ground_height = {}) const;
+      const gtsam::Point3 &step, double ground_height = {},
+      bool path_factors = false) const;
 
   /**
    * @fn Add minimum torque objectives.
    * @param[in,out] graph nonlinear factor graph to add to.
    * @param[in] robot Robot specification from URDF/SDF.
    * @param[in] cost_model Noise model
-   * @return All MinTorqueFactor factors as a NonlinearFactorGraph
+   * @param[in] per_time_step add one JointsMinTorqueFactor on all joints per
+   * time step, instead of one MinTorqueFactor per joint and time step; the
+   * cost_model must then be 1D and diagonal.
    */
   void addMinimumTorqueFactors(gtsam::NonlinearFactorGraph *graph,
                                const Robot &robot,
-                               const gtsam::SharedNoiseModel &cost_model) const;
+                               const gtsam::SharedNoiseModel &cost_model,
+                               bool per_time_step = false) const;
 
   /**
    * @fn Create objective factors for slice 0 and slice K.
@@ -247,6 +324,44 @@ class Trajectory {
       const gtsam::SharedNoiseModel &joint_velocity_model,
       const gtsam::SharedNoiseModel &joint_acceleration_model) const;
 
+  /**
+   * @fn Create periodic boundary conditions, to optimize a single walk cycle
+   * of a steady-state gait instead of many repetitions of it.
+   *
+   * The link poses at the last time step K are the poses at time step 0
+   * moved by the Pose3 stride variable, in the world frame.  Link twists and
+   * twist accelerations are in the link frames, so they repeat unchanged, as
+   * do the joint angles, velocities and accelerations. Add a prior on the
+   * stride to set the step length, and one on a link pose at time step 0 to
+   * anchor the gait.
+   *
+   * @param[in,out] graph nonlinear factor graph to add to.
+   * @param[in] robot Robot specification from URDF/SDF.
+   * @param[in] stride_key Key of the stride variable.
+   */
+  void addPeriodicBoundaryConditions(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const gtsam::SharedNoiseModel &pose_model,
+      const gtsam::SharedNoiseModel &twist_model,
+      const gtsam::SharedNoiseModel &twist_acceleration_model,
+      const gtsam::SharedNoiseModel &joint_angle_model,
+      const gtsam::SharedNoiseModel &joint_velocity_model,
+      const gtsam::SharedNoiseModel &joint_acceleration_model,
+      gtsam::Key stride_key = StrideKey()) const;
+
+  /**
+   * @fn Repeat the solution of a periodic trajectory, see
+   * addPeriodicBoundaryConditions, as values of the trajectory of repeat
+   * cycles: time steps and phases are shifted by those of a cycle, and the
+   * link poses of cycle c are moved by c strides.
+   * @param[in] values Values of this trajectory, including the stride.
+   * @param[in] repeat Number of cycles.
+   * @param[in] stride_key Key of the stride variable.
+   * @return Values without the stride.
+   */
+  gtsam::Values periodicValues(const gtsam::Values &values, size_t repeat,
+                               gtsam::Key stride_key = StrideKey()) const;
+
   /**
    * @fn Add priors on all variable time steps.
    * @param[in, out] graph NonlinearFactorGraph to add to
@@ -268,16 +383,37 @@ class Trajectory {
    * @param[in] results      Results of Optimization.
    * @param[in] phase        Phase number.
    */
-  void writePhaseToFile(const Robot &robot, std::ofstream &traj_file,
+  void writePhaseToFile(const Robot &robot, std::ostream &traj_file,
                         const gtsam::Values &results, int phase) const;
 
+  /**
+   * @fn Writes the rows of a single phase with a TrajectoryWriter.
+   * @param[in] writer       Writer of the trajectory file.
+   * @param[in] results      Results of Optimization.
+   * @param[in] phase        Phase number.
+   */
+  void writePhaseToFile(TrajectoryWriter *writer, const gtsam::Values &results,
+                        int phase) const;
+
   /**
    * @fn Writes the angles, vels, accels, torques and time values to disk.
    * @param[in] robot     Robot specification from URDF/SDF.
    * @param[in] name      Trajectory File name.
    * @param[in] results   Results of Optimization.
+   * @param[in] format    CSV, or binary, see TrajectoryWriter.
+   */
+  void writeToFile(
+      const Robot &robot, const std::string &name, const gtsam::Values &results,
+      TrajectoryWriter::Format format = TrajectoryWriter::CSV) const;
+
+  /**
+   * @fn Writes time steps 0..K of all phases in the columnar format of
+   * MappedTrajectory, so that analysis tools can map the file.
+   * @param[in] robot     Robot specification from URDF/SDF.
+   * @param[in] name      Trajectory File name.
+   * @param[in] results   Results of Optimization.
    */
-  void writeToFile(const Robot &robot, const std::string &name,
-                   const gtsam::Values &results) const;
+  void writeColumnarToFile(const Robot &robot, const std::string &name,
+                           const gtsam::Values &results) const;
 };
 }  // namespace gtdynamics
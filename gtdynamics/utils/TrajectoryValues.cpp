@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryValues.cpp
+ * @brief Dense storage of the joint and link states of a trajectory.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/TrajectoryValues.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+TrajectoryValues::TrajectoryValues(size_t num_steps, size_t num_joints,
+                                   size_t num_links)
+    : num_steps_(num_steps),
+      num_joints_(num_joints),
+      num_links_(num_links),
+      q_(JointMatrix::Zero(num_steps, num_joints)),
+      v_(JointMatrix::Zero(num_steps, num_joints)),
+      a_(JointMatrix::Zero(num_steps, num_joints)),
+      torque_(JointMatrix::Zero(num_steps, num_joints)),
+      poses_(num_steps * num_links),
+      twists_(num_steps * num_links, gtsam::Vector6::Zero()),
+      twist_accels_(num_steps * num_links, gtsam::Vector6::Zero()) {}
+
+/* ************************************************************************* */
+TrajectoryValues TrajectoryValues::FromValues(const Robot &robot,
+                                              const gtsam::Values &values,
+                                              size_t num_steps) {
+  TrajectoryValues trajectory(robot, num_steps);
+  const size_t J = trajectory.numJoints(), L = trajectory.numLinks();
+  for (gtsam::Key key : values.keys()) {
+    const DynamicsSymbol symbol(key);
+    const size_t t = symbol.time();
+    if (t >= num_steps) continue;
+    const std::string label = symbol.label();
+    if (label.size() != 1) continue;
+
+    const size_t j = symbol.jointIdx(), i = symbol.linkIdx();
+    switch (label[0]) {
+      case 'q':
+        if (j < J) trajectory.q(j, t) = values.at<double>(key);
+        break;
+      case 'v':
+        if (j < J) trajectory.v(j, t) = values.at<double>(key);
+        break;
+      case 'a':
+        if (j < J) trajectory.a(j, t) = values.at<double>(key);
+        break;
+      case 'T':
+        if (j < J) trajectory.torque(j, t) = values.at<double>(key);
+        break;
+      case 'p':
+        if (i < L) trajectory.pose(i, t) = values.at<gtsam::Pose3>(key);
+        break;
+      case 'V':
+        if (i < L) trajectory.twist(i, t) = values.at<gtsam::Vector6>(key);
+        break;
+      case 'A':
+        if (i < L) {
+          trajectory.twistAccel(i, t) = values.at<gtsam::Vector6>(key);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return trajectory;
+}
+
+/* ************************************************************************* */
+gtsam::Values TrajectoryValues::toValues() const {
+  gtsam::Values values;
+  for (size_t t = 0; t < num_steps_; t++) {
+    for (size_t j = 0; j < num_joints_; j++) {
+      InsertJointAngle(&values, j, t, q(j, t));
+      InsertJointVel(&values, j, t, v(j, t));
+      InsertJointAccel(&values, j, t, a(j, t));
+      InsertTorque(&values, j, t, torque(j, t));
+    }
+    for (size_t i = 0; i < num_links_; i++) {
+      InsertPose(&values, i, t, pose(i, t));
+      InsertTwist(&values, i, t, twist(i, t));
+      InsertTwistAccel(&values, i, t, twistAccel(i, t));
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,180 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryValues.h
+ * @brief Dense storage of the joint and link states of a trajectory.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryValues stores the joint angles, velocities, accelerations and
+ * torques, and the link poses, twists and twist accelerations of time steps
+ * 0..num_steps-1 in contiguous arrays indexed by [t][joint] and [t][link],
+ * so that post-processing and controllers read them without the lookups of
+ * gtsam::Values. Joint quantities are row-major (num_steps x num_joints)
+ * matrices, whose rows are the states of one time step.
+ */
+class TrajectoryValues {
+ public:
+  using JointMatrix =
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+ private:
+  size_t num_steps_, num_joints_, num_links_;
+  JointMatrix q_, v_, a_, torque_;
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_, twist_accels_;
+
+ public:
+  /// Constructor with zero joint states and identity link poses.
+  TrajectoryValues(size_t num_steps, size_t num_joints, size_t num_links);
+
+  /// Constructor for all joints and links of a robot.
+  TrajectoryValues(const Robot &robot, size_t num_steps)
+      : TrajectoryValues(num_steps, robot.numJoints(), robot.numLinks()) {}
+
+  /**
+   * Copy the states of time steps 0..num_steps-1 from values, in one pass
+   * over the keys; states that are not in values remain zero, or identity.
+   * @param robot     Robot whose joints and links are stored.
+   * @param values    Values with DynamicsSymbol keys.
+   * @param num_steps Number of time steps.
+   */
+  static TrajectoryValues FromValues(const Robot &robot,
+                                     const gtsam::Values &values,
+                                     size_t num_steps);
+
+  /// All states as gtsam::Values.
+  gtsam::Values toValues() const;
+
+  size_t numSteps() const { return num_steps_; }
+  size_t numJoints() const { return num_joints_; }
+  size_t numLinks() const { return num_links_; }
+
+  /// @name Joint states of all time steps, as (num_steps x num_joints) views.
+  ///@{
+  const JointMatrix &jointAngles() const { return q_; }
+  const JointMatrix &jointVels() const { return v_; }
+  const JointMatrix &jointAccels() const { return a_; }
+  const JointMatrix &torques() const { return torque_; }
+  JointMatrix &jointAngles() { return q_; }
+  JointMatrix &jointVels() { return v_; }
+  JointMatrix &jointAccels() { return a_; }
+  JointMatrix &torques() { return torque_; }
+  ///@}
+
+  /// @name States of joint j and link i at time step t.
+  ///@{
+  double &q(int j, int t) { return q_(t, j); }
+  double &v(int j, int t) { return v_(t, j); }
+  double &a(int j, int t) { return a_(t, j); }
+  double &torque(int j, int t) { return torque_(t, j); }
+  double q(int j, int t) const { return q_(t, j); }
+  double v(int j, int t) const { return v_(t, j); }
+  double a(int j, int t) const { return a_(t, j); }
+  double torque(int j, int t) const { return torque_(t, j); }
+
+  gtsam::Pose3 &pose(int i, int t) { return poses_[t * num_links_ + i]; }
+  gtsam::Vector6 &twist(int i, int t) { return twists_[t * num_links_ + i]; }
+  gtsam::Vector6 &twistAccel(int i, int t) {
+    return twist_accels_[t * num_links_ + i];
+  }
+  const gtsam::Pose3 &pose(int i, int t) const {
+    return poses_[t * num_links_ + i];
+  }
+  const gtsam::Vector6 &twist(int i, int t) const {
+    return twists_[t * num_links_ + i];
+  }
+  const gtsam::Vector6 &twistAccel(int i, int t) const {
+    return twist_accels_[t * num_links_ + i];
+  }
+  ///@}
+};
+
+/* *************************************************************************
+  Accessors of values.h for TrajectoryValues.
+ ************************************************************************* */
+
+inline void InsertJointAngle(TrajectoryValues *values, int j, int t,
+                             double value) {
+  values->q(j, t) = value;
+}
+
+inline void InsertJointVel(TrajectoryValues *values, int j, int t,
+                           double value) {
+  values->v(j, t) = value;
+}
+
+inline void InsertJointAccel(TrajectoryValues *values, int j, int t,
+                             double value) {
+  values->a(j, t) = value;
+}
+
+inline void InsertTorque(TrajectoryValues *values, int j, int t,
+                         double value) {
+  values->torque(j, t) = value;
+}
+
+inline void InsertPose(TrajectoryValues *values, int i, int t,
+                       const gtsam::Pose3 &value) {
+  values->pose(i, t) = value;
+}
+
+inline void InsertTwist(TrajectoryValues *values, int i, int t,
+                        const gtsam::Vector6 &value) {
+  values->twist(i, t) = value;
+}
+
+inline void InsertTwistAccel(TrajectoryValues *values, int i, int t,
+                             const gtsam::Vector6 &value) {
+  values->twistAccel(i, t) = value;
+}
+
+inline double JointAngle(const TrajectoryValues &values, int j, int t = 0) {
+  return values.q(j, t);
+}
+
+inline double JointVel(const TrajectoryValues &values, int j, int t = 0) {
+  return values.v(j, t);
+}
+
+inline double JointAccel(const TrajectoryValues &values, int j, int t = 0) {
+  return values.a(j, t);
+}
+
+inline double Torque(const TrajectoryValues &values, int j, int t = 0) {
+  return values.torque(j, t);
+}
+
+inline gtsam::Pose3 Pose(const TrajectoryValues &values, int i, int t = 0) {
+  return values.pose(i, t);
+}
+
+inline gtsam::Vector6 Twist(const TrajectoryValues &values, int i,
+                            int t = 0) {
+  return values.twist(i, t);
+}
+
+inline gtsam::Vector6 TwistAccel(const TrajectoryValues &values, int i,
+                                 int t = 0) {
+  return values.twistAccel(i, t);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryWriter.cpp
+ * @brief Write joint trajectories to a stream, one time step at a time.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/utils/TrajectoryWriter.h>
+#include <gtdynamics/utils/values.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+const char kMagic[] = "GTDTRAJ1";
+const size_t kMagicSize = 8;
+
+void WriteUint64(std::ostream &os, uint64_t n) {
+  os.write(reinterpret_cast<const char *>(&n), sizeof(n));
+}
+
+uint64_t ReadUint64(std::istream &is) {
+  uint64_t n = 0;
+  is.read(reinterpret_cast<char *>(&n), sizeof(n));
+  return n;
+}
+}  // namespace
+
+/* ************************************************************************* */
+TrajectoryWriter::TrajectoryWriter(const Robot &robot, std::ostream &os,
+                                   Format format)
+    : os_(&os), format_(format) {
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  for (int i = 0; i < 4; i++) {
+    for (auto &&joint : robot.joints()) columns_.push_back(joint->name());
+  }
+  columns_.push_back("t");
+  row_.resize(columns_.size());
+}
+
+/* ************************************************************************* */
+void TrajectoryWriter::writeHeader() {
+  if (format_ == CSV) {
+    for (size_t i = 0; i < columns_.size(); i++) {
+      *os_ << (i > 0 ? "," : "") << columns_[i];
+    }
+    *os_ << "\n";
+    return;
+  }
+
+  os_->write(kMagic, kMagicSize);
+  WriteUint64(*os_, columns_.size());
+  for (auto &&name : columns_) {
+    WriteUint64(*os_, name.size());
+    os_->write(name.data(), name.size());
+  }
+}
+
+/* ************************************************************************* */
+void TrajectoryWriter::writeStep(const gtsam::Values &results, size_t k,
+                                 double dt) {
+  const size_t J = joint_ids_.size();
+  for (size_t j = 0; j < J; j++) {
+    const auto id = joint_ids_[j];
+    row_[j + 0 * J] = JointAngle(results, id, k);
+    row_[j + 1 * J] = JointVel(results, id, k);
+    row_[j + 2 * J] = JointAccel(results, id, k);
+    row_[j + 3 * J] = Torque(results, id, k);
+  }
+  row_.back() = dt;
+
+  if (format_ == CSV) {
+    for (size_t i = 0; i < row_.size(); i++) {
+      if (i > 0) *os_ << ", ";
+      *os_ << row_[i];
+    }
+    *os_ << "\n";
+  } else {
+    os_->write(reinterpret_cast<const char *>(row_.data()),
+               row_.size() * sizeof(double));
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Matrix TrajectoryWriter::ReadBinary(std::istream &is,
+                                           std::vector<std::string> *columns) {
+  char magic[kMagicSize];
+  is.read(magic, kMagicSize);
+  if (!is || std::memcmp(magic, kMagic, kMagicSize) != 0) {
+    throw std::runtime_error("TrajectoryWriter: not a binary trajectory.");
+  }
+
+  const uint64_t n = ReadUint64(is);
+  std::vector<std::string> names(n);
+  for (auto &&name : names) {
+    name.resize(ReadUint64(is));
+    is.read(&name[0], name.size());
+  }
+  if (!is) throw std::runtime_error("TrajectoryWriter: truncated header.");
+  if (columns) *columns = names;
+  if (n == 0) return gtsam::Matrix();
+
+  std::vector<double> data;
+  std::vector<double> row(n);
+  const std::streamsize row_size = n * sizeof(double);
+  while (is.read(reinterpret_cast<char *>(row.data()), row_size)) {
+    data.insert(data.end(), row.begin(), row.end());
+  }
+  if (is.gcount() != 0) {
+    throw std::runtime_error("TrajectoryWriter: truncated row.");
+  }
+
+  // The rows are stored contiguously, as in a row-major matrix.
+  const size_t m = n == 0 ? 0 : data.size() / n;
+  return Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                                        Eigen::RowMajor>>(data.data(), m, n);
+}
+
+}  // namespace gtdynamics
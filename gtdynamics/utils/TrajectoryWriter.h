@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryWriter.h
+ * @brief Write joint trajectories to a stream, one time step at a time.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryWriter writes the angles, velocities, accelerations and torques
+ * of all joints and the time step duration, one row per time step, directly
+ * to an output stream, so that no matrix of the whole trajectory is built.
+ *
+ * The CSV format is the one of Trajectory::writeToFile. The binary format is
+ * the magic "GTDTRAJ1", the number of columns as a uint64, each column name
+ * as a uint64 length and its characters, and then all rows as float64, so
+ * that it can be loaded without parsing, e.g. with numpy.fromfile.
+ */
+class TrajectoryWriter {
+ public:
+  enum Format { CSV, BINARY };
+
+  /**
+   * Constructor.
+   * @param robot  Robot whose joints are written, in the order of joints().
+   * @param os     Stream to write to, opened in binary mode for BINARY.
+   * @param format Output format.
+   */
+  TrajectoryWriter(const Robot &robot, std::ostream &os, Format format = CSV);
+
+  /// Names of the columns: q, v, a and torque of all joints, and t.
+  const std::vector<std::string> &columns() const { return columns_; }
+
+  /// Write the column names.
+  void writeHeader();
+
+  /**
+   * Write the row of one time step.
+   * @param results Values of the trajectory.
+   * @param k       Time step.
+   * @param dt      Duration of the time step.
+   */
+  void writeStep(const gtsam::Values &results, size_t k, double dt);
+
+  /// Flush the stream.
+  void flush() { os_->flush(); }
+
+  /**
+   * Read a trajectory in the binary format.
+   * @param is      Stream written by a BINARY TrajectoryWriter.
+   * @param columns If given, the column names are returned in it.
+   * @return one row per time step.
+   */
+  static gtsam::Matrix ReadBinary(std::istream &is,
+                                  std::vector<std::string> *columns = nullptr);
+
+ private:
+  std::vector<uint8_t> joint_ids_;
+  std::vector<std::string> columns_;
+  std::ostream *os_;
+  Format format_;
+  std::vector<double> row_;
+};
+
+}  // namespace gtdynamics
@@ -85,7 +85,7 @@ ContactPointGoals WalkCycle::initContactPointGoal(const Robot &robot,
 
 NonlinearFactorGraph WalkCycle::contactPointObjectives(
     const Point3 &step, const SharedNoiseModel &cost_model, size_t k_start,
-    ContactPointGoals *cp_goals) const {
+    ContactPointGoals *cp_goals, bool path_factors) const {
   NonlinearFactorGraph factors;
 
   for (const Phase &phase : phases_) {
@@ -95,7 +95,7 @@ NonlinearFactorGraph WalkCycle::contactPointObjectives(
       // Ask the Phase instance to anchor the stance legs
       factors.add(foot_contact_spec->contactPointObjectives(
           contact_points_, step, cost_model, k_start, *cp_goals,
-          phase.numTimeSteps()));
+          phase.numTimeSteps(), path_factors));
 
       // Update goals for swing legs
       *cp_goals = foot_contact_spec->updateContactPointGoals(contact_points_,
@@ -149,11 +149,13 @@ class WalkCycle {
    * @param[in] cost_model Noise model
    * @param[in] step The 3D vector the foot moves in a step.
    * @param[in] ground_height z-coordinate of ground in URDF/SDF rest config.
+   * @param[in] path_factors one PointGoalPathFactor per foot and phase.
    * @return All objective factors as a NonlinearFactorGraph
    */
   gtsam::NonlinearFactorGraph contactPointObjectives(
       const gtsam::Point3 &step, const gtsam::SharedNoiseModel &cost_model,
-      size_t k_start, ContactPointGoals *cp_goals) const;
+      size_t k_start, ContactPointGoals *cp_goals,
+      bool path_factors = false) const;
 
   /**
    * @fn Returns the swing links for a given phase.
@@ -0,0 +1,202 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartInitializer.cpp
+ * @brief Initialize trajectory optimization from stored solutions of similar
+ * problems.
+ * @author Yetong Zhang
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/WarmStartInitializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Key;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void TrajectorySolutionCache::insert(const std::string &spec,
+                                     const Vector &parameters,
+                                     const std::vector<int> &phase_steps,
+                                     const Values &solution) {
+  entries_.push_back({spec, parameters, phase_steps, solution});
+}
+
+/* ************************************************************************* */
+const TrajectorySolutionCache::Entry *TrajectorySolutionCache::nearest(
+    const std::string &spec, const Vector &parameters) const {
+  const Entry *nearest = nullptr;
+  double min_distance = std::numeric_limits<double>::infinity();
+  for (const Entry &entry : entries_) {
+    if (entry.spec != spec || entry.parameters.size() != parameters.size()) {
+      continue;
+    }
+    const double distance = (entry.parameters - parameters).squaredNorm();
+    if (distance < min_distance) {
+      nearest = &entry;
+      min_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+namespace {
+// Insert into `values` under `key` the value at position alpha between the
+// values of k0 and k1 of the solution, if they have type T.
+template <typename T>
+bool InsertInterpolated(Values *values, Key key, const Values &solution,
+                        Key k0, Key k1, double alpha) {
+  const auto v0 =
+      dynamic_cast<const gtsam::GenericValue<T> *>(&solution.at(k0));
+  if (!v0) return false;
+  values->insert(key, gtsam::interpolate<T>(v0->value(), solution.at<T>(k1),
+                                            alpha));
+  return true;
+}
+
+template <>
+bool InsertInterpolated<Vector>(Values *values, Key key,
+                                const Values &solution, Key k0, Key k1,
+                                double alpha) {
+  const auto v0 =
+      dynamic_cast<const gtsam::GenericValue<Vector> *>(&solution.at(k0));
+  if (!v0) return false;
+  const Vector &v1 = solution.at<Vector>(k1);
+  if (v1.size() != v0->value().size()) return false;
+  values->insert(key, Vector((1 - alpha) * v0->value() + alpha * v1));
+  return true;
+}
+
+// Resample the steps of each phase, either at the nearest step of the
+// solution, or interpolating between the two steps around it.
+Values ResampleTrajectory(const Values &solution,
+                          const std::vector<int> &from_steps,
+                          const std::vector<int> &to_steps, bool interpolate,
+                          const char *caller) {
+  if (from_steps.size() != to_steps.size()) {
+    throw std::invalid_argument(std::string(caller) +
+                                ": the number of phases differs.");
+  }
+
+  // Time-indexed keys of the solution, by time step.
+  std::vector<std::vector<Key>> keys_at;
+  std::vector<Key> phase_keys;
+  for (Key key : solution.keys()) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.label() == "dt") {
+      phase_keys.push_back(key);
+      continue;
+    }
+    if (symbol.time() >= keys_at.size()) keys_at.resize(symbol.time() + 1);
+    keys_at[symbol.time()].push_back(key);
+  }
+  auto at_time = [](const DynamicsSymbol &symbol, size_t t) -> Key {
+    return DynamicsSymbol::LinkJointSymbol(symbol.label(), symbol.linkIdx(),
+                                           symbol.jointIdx(), t);
+  };
+
+  // Step j of m in a phase is at position j * n / m of its n steps in the
+  // solution.
+  Values resampled;
+  int from_start = 0, to_start = 0;
+  for (size_t p = 0; p < to_steps.size(); p++) {
+    const int n = from_steps[p], m = to_steps[p];
+    for (int j = p == 0 ? 0 : 1; j <= m; j++) {
+      const double s = from_start + (m > 0 ? double(j) * n / m : 0.0);
+      const size_t s0 = interpolate ? std::floor(s) : std::lround(s);
+      if (s0 >= keys_at.size()) continue;
+      const double alpha = s - s0;
+      for (Key key : keys_at[s0]) {
+        const DynamicsSymbol symbol(key);
+        const Key to_key = at_time(symbol, to_start + j);
+        if (interpolate && alpha > 1e-9) {
+          const Key k1 = at_time(symbol, s0 + 1);
+          if (solution.exists(k1) &&
+              (InsertInterpolated<double>(&resampled, to_key, solution, key,
+                                          k1, alpha) ||
+               InsertInterpolated<gtsam::Vector3>(&resampled, to_key,
+                                                  solution, key, k1, alpha) ||
+               InsertInterpolated<gtsam::Vector6>(&resampled, to_key,
+                                                  solution, key, k1, alpha) ||
+               InsertInterpolated<Vector>(&resampled, to_key, solution, key,
+                                          k1, alpha) ||
+               InsertInterpolated<gtsam::Pose3>(&resampled, to_key, solution,
+                                                key, k1, alpha))) {
+            continue;
+          }
+        }
+        resampled.insert(to_key, solution.at(key));
+      }
+    }
+    from_start += n;
+    to_start += m;
+  }
+
+  // Phases keep their durations.
+  for (Key key : phase_keys) {
+    const size_t p = DynamicsSymbol(key).time();
+    if (p >= to_steps.size()) continue;
+    const double scale = to_steps[p] > 0 ? double(from_steps[p]) / to_steps[p]
+                                         : 1.0;
+    resampled.insert(key, solution.at<double>(key) * scale);
+  }
+  return resampled;
+}
+}  // namespace
+
+/* ************************************************************************* */
+Values TimeWarpTrajectory(const Values &solution,
+                          const std::vector<int> &from_steps,
+                          const std::vector<int> &to_steps) {
+  return ResampleTrajectory(solution, from_steps, to_steps, false,
+                            "TimeWarpTrajectory");
+}
+
+/* ************************************************************************* */
+Values InterpolateTrajectory(const Values &solution,
+                             const std::vector<int> &from_steps,
+                             const std::vector<int> &to_steps) {
+  return ResampleTrajectory(solution, from_steps, to_steps, true,
+                            "InterpolateTrajectory");
+}
+
+/* ************************************************************************* */
+WarmStartInitializer::WarmStartInitializer(
+    const TrajectorySolutionCache &cache, const std::string &spec,
+    const Vector &parameters, const std::vector<int> &phase_steps) {
+  const auto entry = cache.nearest(spec, parameters);
+  if (entry && entry->phase_steps.size() == phase_steps.size()) {
+    warm_start_ =
+        TimeWarpTrajectory(entry->solution, entry->phase_steps, phase_steps);
+  }
+}
+
+/* ************************************************************************* */
+Values WarmStartInitializer::ZeroValues(
+    const Robot &robot, const int t, double gaussian_noise,
+    const std::optional<PointOnLinks> &contact_points) const {
+  Values values =
+      Initializer::ZeroValues(robot, t, gaussian_noise, contact_points);
+  if (warm_start_.empty()) return values;
+  for (Key key : values.keys()) {
+    if (warm_start_.exists(key)) values.update(key, warm_start_.at(key));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
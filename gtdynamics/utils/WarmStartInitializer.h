@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartInitializer.h
+ * @brief Initialize trajectory optimization from stored solutions of similar
+ * problems.
+ * @author Yetong Zhang
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Database of optimized trajectories, keyed by a trajectory specification,
+ * e.g. the name of the WalkCycle, and by a vector of task parameters, e.g.
+ * the goal, so that near-identical problems can start from a stored solution.
+ */
+class TrajectorySolutionCache {
+ public:
+  /// A stored solution.
+  struct Entry {
+    std::string spec;             ///< trajectory specification
+    gtsam::Vector parameters;     ///< task parameters
+    std::vector<int> phase_steps;  ///< number of steps of each phase
+    gtsam::Values solution;       ///< optimized trajectory
+  };
+
+ private:
+  std::vector<Entry> entries_;
+
+ public:
+  TrajectorySolutionCache() {}
+
+  /**
+   * Store an optimized trajectory.
+   * @param spec Trajectory specification.
+   * @param parameters Task parameters.
+   * @param phase_steps Number of steps of each phase, see
+   * Trajectory::phaseDurations.
+   * @param solution The optimized trajectory.
+   */
+  void insert(const std::string &spec, const gtsam::Vector &parameters,
+              const std::vector<int> &phase_steps,
+              const gtsam::Values &solution);
+
+  /**
+   * The solution with the same specification whose parameters are nearest,
+   * in Euclidean distance, or nullptr if there is none.
+   */
+  const Entry *nearest(const std::string &spec,
+                       const gtsam::Vector &parameters) const;
+
+  /// Number of stored solutions.
+  size_t size() const { return entries_.size(); }
+
+  /// Stored solutions, in insertion order.
+  const std::vector<Entry> &entries() const { return entries_; }
+};
+
+/**
+ * Time-warp a multi-phase trajectory to other numbers of steps per phase:
+ * step j of m in phase p takes the values of the nearest step of the
+ * solution in its phase, and the phase duration variables are scaled so that
+ * every phase lasts as long as before.
+ * @param solution Trajectory with DynamicsSymbol keys.
+ * @param from_steps Number of steps of each phase of the solution.
+ * @param to_steps Number of steps of each phase of the warped trajectory.
+ */
+gtsam::Values TimeWarpTrajectory(const gtsam::Values &solution,
+                                 const std::vector<int> &from_steps,
+                                 const std::vector<int> &to_steps);
+
+/**
+ * Upsample or downsample a multi-phase trajectory like TimeWarpTrajectory,
+ * but interpolating between the two steps of the solution around each step:
+ * linearly for scalars and vectors, and along the geodesic for poses. Values
+ * of other types are taken from the earlier step.
+ * @param solution Trajectory with DynamicsSymbol keys.
+ * @param from_steps Number of steps of each phase of the solution.
+ * @param to_steps Number of steps of each phase of the resampled trajectory.
+ */
+gtsam::Values InterpolateTrajectory(const gtsam::Values &solution,
+                                    const std::vector<int> &from_steps,
+                                    const std::vector<int> &to_steps);
+
+/**
+ * Initializer that starts from the stored solution nearest to a task,
+ * time-warped to the phase durations of the trajectory, instead of zero
+ * values. Variables the stored solution does not have, e.g. contact wrenches
+ * of other contacts, and all variables if the cache has no solution, are
+ * initialized as in Initializer.
+ */
+class WarmStartInitializer : public Initializer {
+ private:
+  gtsam::Values warm_start_;
+
+ public:
+  /**
+   * Constructor.
+   * @param cache Stored solutions.
+   * @param spec Trajectory specification of the task.
+   * @param parameters Task parameters.
+   * @param phase_steps Number of steps of each phase, see
+   * Trajectory::phaseDurations.
+   */
+  WarmStartInitializer(const TrajectorySolutionCache &cache,
+                       const std::string &spec,
+                       const gtsam::Vector &parameters,
+                       const std::vector<int> &phase_steps);
+
+  /// Whether a stored solution was found.
+  bool hasWarmStart() const { return !warm_start_.empty(); }
+
+  /// The time-warped solution, including the phase durations.
+  const gtsam::Values &warmStart() const { return warm_start_; }
+
+  /// Values of the warm start at step t, completed by Initializer::ZeroValues.
+  gtsam::Values ZeroValues(
+      const Robot &robot, const int t, double gaussian_noise = 0.0,
+      const std::optional<PointOnLinks> &contact_points = {}) const override;
+};
+
+}  // namespace gtdynamics
@@ -157,4 +157,12 @@ gtsam::Matrix36 getPlanarJacobian(const gtsam::Vector3 &planar_axis) {
   return H_wrench;
 }
 
+std::vector<int> getPlanarCoordinates(const gtsam::Vector3 &planar_axis) {
+  if (planar_axis[0] == 1) return {0, 4, 5};  // x axis
+  if (planar_axis[1] == 1) return {1, 3, 5};  // y axis
+  if (planar_axis[2] == 1) return {2, 3, 4};  // z axis
+  throw std::invalid_argument(
+      "getPlanarCoordinates: planar axis must be a coordinate axis");
+}
+
 }  // namespace gtdynamics
@@ -127,4 +127,12 @@ std::vector<gtsam::Matrix> readFromTxt(std::string mat_dir,
  */
 gtsam::Matrix36 getPlanarJacobian(const gtsam::Vector3 &planar_axis);
 
+/**
+ * Obtain the indices of the in-plane twist and wrench coordinates, i.e., the
+ * ones left free by getPlanarJacobian for the given planar axis.
+ *
+ * @param planar_axis The planar axis, one of the coordinate axes.
+ */
+std::vector<int> getPlanarCoordinates(const gtsam::Vector3 &planar_axis);
+
 }  // namespace gtdynamics
@@ -14,6 +14,10 @@
 
 #include <gtdynamics/utils/values.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace gtdynamics {
 
 using gtsam::Pose3;
@@ -166,4 +170,144 @@ Vector6 Wrench(const Values &values, int i, int j, int t) {
   return at<Vector6>(values, WrenchKey(i, j, t));
 }
 
+namespace {
+/// Insert entries in ascending key order, or none if any key exists.
+template <class T>
+void InsertInKeyOrder(Values *values,
+                      std::vector<std::pair<gtsam::Key, T>> *entries) {
+  std::sort(entries->begin(), entries->end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  for (auto &&entry : *entries) {
+    if (values->exists(entry.first)) {
+      throw gtsam::ValuesKeyAlreadyExists(entry.first);
+    }
+  }
+  for (auto &&entry : *entries) values->insert(entry.first, entry.second);
+}
+
+/// Insert x(k, j) with keys key(j, t0 + k).
+template <class KEY>
+void InsertJointMatrix(Values *values, const gtsam::Matrix &x, int t0,
+                       KEY key) {
+  std::vector<std::pair<gtsam::Key, double>> entries;
+  entries.reserve(x.size());
+  for (int k = 0; k < x.rows(); k++) {
+    for (int j = 0; j < x.cols(); j++) {
+      entries.emplace_back(key(j, t0 + k), x(k, j));
+    }
+  }
+  InsertInKeyOrder(values, &entries);
+}
+}  // namespace
+
+/* ************************************************************************* */
+void InsertJointAngles(Values *values, int t, const Vector &q) {
+  InsertJointMatrix(values, q.transpose(), t, JointAngleKey);
+}
+
+void InsertJointAngles(Values *values, const gtsam::Matrix &q, int t0) {
+  InsertJointMatrix(values, q, t0, JointAngleKey);
+}
+
+void InsertJointVels(Values *values, int t, const Vector &v) {
+  InsertJointMatrix(values, v.transpose(), t, JointVelKey);
+}
+
+void InsertJointVels(Values *values, const gtsam::Matrix &v, int t0) {
+  InsertJointMatrix(values, v, t0, JointVelKey);
+}
+
+void InsertJointAccels(Values *values, int t, const Vector &a) {
+  InsertJointMatrix(values, a.transpose(), t, JointAccelKey);
+}
+
+void InsertJointAccels(Values *values, const gtsam::Matrix &a, int t0) {
+  InsertJointMatrix(values, a, t0, JointAccelKey);
+}
+
+void InsertTorques(Values *values, int t, const Vector &tau) {
+  InsertJointMatrix(values, tau.transpose(), t, TorqueKey);
+}
+
+void InsertTorques(Values *values, const gtsam::Matrix &tau, int t0) {
+  InsertJointMatrix(values, tau, t0, TorqueKey);
+}
+
+/* ************************************************************************* */
+void InsertPoses(Values *values, int t, const std::vector<Pose3> &poses) {
+  std::vector<std::pair<gtsam::Key, Pose3>> entries;
+  entries.reserve(poses.size());
+  for (size_t i = 0; i < poses.size(); i++) {
+    entries.emplace_back(PoseKey(i, t), poses[i]);
+  }
+  InsertInKeyOrder(values, &entries);
+}
+
+void InsertTwists(Values *values, int t, const std::vector<Vector6> &twists) {
+  std::vector<std::pair<gtsam::Key, Vector6>> entries;
+  entries.reserve(twists.size());
+  for (size_t i = 0; i < twists.size(); i++) {
+    entries.emplace_back(TwistKey(i, t), twists[i]);
+  }
+  InsertInKeyOrder(values, &entries);
+}
+
+/* ************************************************************************* */
+Values ShiftTime(const Values &values, int offset) {
+  Values shifted;
+  for (const gtsam::Key &key : values.keys()) {
+    const DynamicsSymbol symbol(key);
+    const int64_t t = static_cast<int64_t>(symbol.time()) + offset;
+    if (t < 0) continue;
+    shifted.insert(DynamicsSymbol::LinkJointSymbol(symbol.label(),
+                                                   symbol.linkIdx(),
+                                                   symbol.jointIdx(), t),
+                   values.at(key));
+  }
+  return shifted;
+}
+
+/* ************************************************************************* */
+TimeSliceIndex::TimeSliceIndex(const gtsam::KeyVector &keys) : keys_(keys) {
+  if (!std::is_sorted(keys_.begin(), keys_.end())) {
+    std::sort(keys_.begin(), keys_.end());
+  }
+  using Encoding = DynamicsKeyEncoding;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    if (i == 0 || Encoding::WithTime(keys_[i], 0) !=
+                      Encoding::WithTime(keys_[i - 1], 0)) {
+      run_starts_.push_back(i);
+    }
+  }
+  run_starts_.push_back(keys_.size());
+}
+
+/* ************************************************************************* */
+gtsam::KeyVector TimeSliceIndex::keys(size_t t_begin, size_t t_end) const {
+  using Encoding = DynamicsKeyEncoding;
+  gtsam::KeyVector slice;
+  if (t_begin >= t_end || t_begin > Encoding::Ones(Encoding::kTimeBits)) {
+    return slice;
+  }
+  for (size_t r = 0; r + 1 < run_starts_.size(); r++) {
+    auto begin = keys_.begin() + run_starts_[r];
+    auto end = keys_.begin() + run_starts_[r + 1];
+    auto it = std::lower_bound(begin, end, Encoding::WithTime(*begin, t_begin));
+    for (; it != end && Encoding::Time(*it) < t_end; ++it) {
+      slice.push_back(*it);
+    }
+  }
+  return slice;
+}
+
+/* ************************************************************************* */
+Values TimeSliceIndex::slice(const Values &values, size_t t_begin,
+                             size_t t_end) const {
+  Values sliced;
+  for (gtsam::Key key : keys(t_begin, t_end)) {
+    sliced.insert(key, values.at(key));
+  }
+  return sliced;
+}
+
 }  // namespace gtdynamics
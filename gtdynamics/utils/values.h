@@ -19,6 +19,8 @@
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <vector>
+
 #define GTD_PRINT(x) ((x).print(#x, gtdynamics::_GTDKeyFormatter))
 
 namespace gtdynamics {
@@ -93,6 +95,11 @@ inline gtsam::Key TimeKey(int k) {
   return DynamicsSymbol::SimpleSymbol("t", k);
 }
 
+/// Shorthand for st_c, the Pose3 stride of walk cycle c of a periodic gait.
+inline gtsam::Key StrideKey(int c = 0) {
+  return DynamicsSymbol::SimpleSymbol("st", c);
+}
+
 /// Custom retrieval that throws KeyDoesNotExist
 template <typename T>
 T at(const gtsam::Values &values, size_t key) {
@@ -451,4 +458,93 @@ gtsam::Vector Wrench(const gtsam::VectorValues &values, int i, int j,
  */
 gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t = 0);
 
+/* *************************************************************************
+  Bulk insertion, e.g. of a whole initial trajectory.
+ ************************************************************************* */
+
+/**
+ * The functions below insert the quantities of all joints or links at once,
+ * indexed by id, at one time step or, for matrices with one row per time
+ * step, at time steps t0, t0 + 1, .... The entries are built in one pass and
+ * inserted in ascending key order, so the tree walks of consecutive inserts
+ * share their path; all keys are checked first, and nothing is inserted if
+ * any exists already (gtsam::ValuesKeyAlreadyExists).
+ */
+
+/// Insert joint angles q(j) of all joints at time t.
+void InsertJointAngles(gtsam::Values *values, int t, const gtsam::Vector &q);
+
+/// Insert joint angles q(k, j) of all joints at time steps t0 + k.
+void InsertJointAngles(gtsam::Values *values, const gtsam::Matrix &q,
+                       int t0 = 0);
+
+/// Insert joint velocities v(j) of all joints at time t.
+void InsertJointVels(gtsam::Values *values, int t, const gtsam::Vector &v);
+
+/// Insert joint velocities v(k, j) of all joints at time steps t0 + k.
+void InsertJointVels(gtsam::Values *values, const gtsam::Matrix &v,
+                     int t0 = 0);
+
+/// Insert joint accelerations a(j) of all joints at time t.
+void InsertJointAccels(gtsam::Values *values, int t, const gtsam::Vector &a);
+
+/// Insert joint accelerations a(k, j) of all joints at time steps t0 + k.
+void InsertJointAccels(gtsam::Values *values, const gtsam::Matrix &a,
+                       int t0 = 0);
+
+/// Insert torques tau(j) of all joints at time t.
+void InsertTorques(gtsam::Values *values, int t, const gtsam::Vector &tau);
+
+/// Insert torques tau(k, j) of all joints at time steps t0 + k.
+void InsertTorques(gtsam::Values *values, const gtsam::Matrix &tau,
+                   int t0 = 0);
+
+/// Insert CoM poses of all links at time t, e.g. LinkStates::poses.
+void InsertPoses(gtsam::Values *values, int t,
+                 const std::vector<gtsam::Pose3> &poses);
+
+/// Insert twists of all links at time t, e.g. LinkStates::twists.
+void InsertTwists(gtsam::Values *values, int t,
+                  const std::vector<gtsam::Vector6> &twists);
+
+/**
+ * @brief Move all variables by a number of time steps, e.g. to warm-start a
+ * receding-horizon problem from the previous solution.
+ *
+ * @param values Values dictionary, with DynamicsSymbol keys only.
+ * @param offset Number of time steps to add to each key.
+ * @return gtsam::Values with re-keyed variables; variables that would end up
+ * before time step 0 are dropped.
+ */
+gtsam::Values ShiftTime(const gtsam::Values &values, int offset);
+
+/**
+ * Index of time slices of a set of keys. Keys with the same label, link and
+ * joint differ only in their lowest, time bits, so each such variable spans
+ * a sorted run of keys over its time steps; a slice takes one binary search
+ * per variable, instead of decoding every key.
+ */
+class TimeSliceIndex {
+  gtsam::KeyVector keys_;           // sorted
+  std::vector<size_t> run_starts_;  // first key of each variable, and end
+
+ public:
+  /// Index keys, in any order.
+  explicit TimeSliceIndex(const gtsam::KeyVector &keys);
+
+  /// Index the keys of a Values.
+  explicit TimeSliceIndex(const gtsam::Values &values)
+      : TimeSliceIndex(values.keys()) {}
+
+  /// Number of indexed keys.
+  size_t size() const { return keys_.size(); }
+
+  /// Keys at time steps [t_begin, t_end), sorted.
+  gtsam::KeyVector keys(size_t t_begin, size_t t_end) const;
+
+  /// Variables of `values` at time steps [t_begin, t_end).
+  gtsam::Values slice(const gtsam::Values &values, size_t t_begin,
+                      size_t t_end) const;
+};
+
 }  // namespace gtdynamics
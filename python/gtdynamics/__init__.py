@@ -4,7 +4,7 @@ import gtsam
 
 from gtdynamics.gtdynamics import *
 
-from . import sim
+from . import futures, sim
 
 
 class _GtdKeyFormatter(object):
@@ -0,0 +1,69 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  futures.py
+ * @brief Asynchronous variants of long-running solves, returning futures.
+ * @author Frank Dellaert, Yetong Zhang, and Varun Agrawal
+"""
+
+# pylint: disable=no-name-in-module, import-error
+
+import os
+import threading
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Optional
+
+from gtdynamics.gtdynamics import ILQROptimizer, Kinematics, Simulator
+
+_lock = threading.Lock()
+_executor: Optional[ThreadPoolExecutor] = None
+_max_workers: Optional[int] = None
+
+
+def set_max_workers(max_workers: Optional[int]) -> None:
+    """Set the number of threads running asynchronous solves, by default one
+    per CPU. Solves already submitted finish on the previous threads."""
+    global _executor, _max_workers  # pylint: disable=global-statement
+    with _lock:
+        old, _executor, _max_workers = _executor, None, max_workers
+    if old is not None:
+        old.shutdown(wait=False)
+
+
+def executor() -> ThreadPoolExecutor:
+    """The thread pool running asynchronous solves."""
+    global _executor  # pylint: disable=global-statement
+    with _lock:
+        if _executor is None:
+            _executor = ThreadPoolExecutor(
+                max_workers=_max_workers or os.cpu_count(),
+                thread_name_prefix="gtdynamics")
+        return _executor
+
+
+def submit(function, *args, **kwargs) -> Future:
+    """Run function(*args, **kwargs) on the thread pool. Only solves that
+    release the GIL run concurrently with Python threads and each other."""
+    return executor().submit(function, *args, **kwargs)
+
+
+def _async(name: str):
+    """Asynchronous variant of the method `name`. The object and arguments
+    are kept alive until the solve is done, and must not be used by other
+    threads meanwhile."""
+
+    def method(self, *args, **kwargs) -> Future:
+        return submit(getattr(self, name), *args, **kwargs)
+
+    method.__name__ = name + "Async"
+    method.__doc__ = "Like {}, but returns a concurrent.futures.Future.".format(
+        name)
+    return method
+
+
+Simulator.simulateAsync = _async("simulate")
+Kinematics.inverseAsync = _async("inverse")
+ILQROptimizer.optimizeAsync = _async("optimize")
@@ -2,3 +2,93 @@
 // These are required to save one copy operation on Python calls
 py::bind_vector<gtdynamics::PointOnLinks>(m_, "PointOnLinks");
 py::bind_map<gtdynamics::ContactPointGoals>(m_, "ContactPointGoals");
+
+// Whole trajectories as NumPy arrays that view the C++ buffers, without
+// copies; the arrays keep the TrajectoryValues alive.
+{
+  using gtdynamics::TrajectoryValues;
+  using JointMatrix = TrajectoryValues::JointMatrix;
+  // (num_steps x num_links x 6) view of the twists or twist accelerations.
+  using LinkState = gtsam::Vector6 &(TrajectoryValues::*)(int, int);
+  auto link_states = [](py::object self, LinkState state) {
+    auto &values = self.cast<TrajectoryValues &>();
+    const size_t T = values.numSteps(), L = values.numLinks();
+    if (T * L == 0) return py::array_t<double>({T, L, size_t(6)});
+    return py::array_t<double>(
+        {T, L, size_t(6)},
+        {L * 6 * sizeof(double), 6 * sizeof(double), sizeof(double)},
+        (values.*state)(0, 0).data(), self);
+  };
+  auto trajectory_values =
+      py::reinterpret_borrow<py::class_<TrajectoryValues>>(
+          m_.attr("TrajectoryValues"));
+  trajectory_values
+      .def(
+          "jointAngles",
+          [](TrajectoryValues &self) -> JointMatrix & {
+            return self.jointAngles();
+          },
+          py::return_value_policy::reference_internal)
+      .def(
+          "jointVels",
+          [](TrajectoryValues &self) -> JointMatrix & {
+            return self.jointVels();
+          },
+          py::return_value_policy::reference_internal)
+      .def(
+          "jointAccels",
+          [](TrajectoryValues &self) -> JointMatrix & {
+            return self.jointAccels();
+          },
+          py::return_value_policy::reference_internal)
+      .def(
+          "torques",
+          [](TrajectoryValues &self) -> JointMatrix & {
+            return self.torques();
+          },
+          py::return_value_policy::reference_internal)
+      .def("twists",
+           [link_states](py::object self) {
+             return link_states(self, &TrajectoryValues::twist);
+           })
+      .def("twistAccels", [link_states](py::object self) {
+        return link_states(self, &TrajectoryValues::twistAccel);
+      });
+}
+
+// Long-running solves release the GIL, so that other Python threads, e.g. the
+// workers of gtdynamics.futures, run meanwhile. They replace the generated
+// methods; an object must still not be used by two threads at once.
+{
+  using gtdynamics::ILQROptimizer;
+  using gtdynamics::Kinematics;
+  using gtdynamics::Simulator;
+  const auto release = py::call_guard<py::gil_scoped_release>();
+
+  auto simulator =
+      py::reinterpret_borrow<py::class_<Simulator>>(m_.attr("Simulator"));
+  py::delattr(simulator, "simulate");
+  simulator.def("simulate",
+                static_cast<gtsam::Values (Simulator::*)(
+                    const std::vector<gtsam::Values> &, const double)>(
+                    &Simulator::simulate),
+                py::arg("torques_seq"), py::arg("dt"), release);
+
+  auto kinematics =
+      py::reinterpret_borrow<py::class_<Kinematics>>(m_.attr("Kinematics"));
+  py::delattr(kinematics, "inverse");
+  kinematics
+      .def("inverse", &Kinematics::inverse<gtdynamics::Slice>,
+           py::arg("slice"), py::arg("robot"), py::arg("contact_goals"),
+           py::arg("contact_goals_as_constraints") = true, release)
+      .def("inverse", &Kinematics::inverse<gtdynamics::Interval>,
+           py::arg("interval"), py::arg("robot"), py::arg("contact_goals"),
+           py::arg("contact_goals_as_constraints") = true, release);
+
+  auto ilqr = py::reinterpret_borrow<py::class_<ILQROptimizer>>(
+      m_.attr("ILQROptimizer"));
+  py::delattr(ilqr, "optimize");
+  ilqr.def("optimize", &ILQROptimizer::optimize, py::arg("state"),
+           py::arg("objectives"), py::arg("initial_torques") = gtsam::Matrix(),
+           release);
+}
@@ -0,0 +1,61 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_futures.py
+ * @brief Test asynchronous solves.
+ * @author Frank Dellaert, Yetong Zhang, and Varun Agrawal
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import gtdynamics as gtd
+import numpy as np
+from gtsam import Values
+from gtsam.utils.test_case import GtsamTestCase
+
+
+class TestFutures(GtsamTestCase):
+    """Test asynchronous variants of long-running solves."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def simulator(self):
+        """A simulator of a simple one-link robot."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        robot = robot.fixLink("l1")
+        return gtd.Simulator(robot, Values(), np.zeros(3),
+                             np.asarray([1, 0, 0]))
+
+    def test_simulate_async(self):
+        """Simulations dispatched concurrently give the serial results."""
+        torques = Values()
+        gtd.InsertTorque(torques, 0, 1.0)
+        torques_seq = [torques for _ in range(100)]
+        expected = self.simulator().simulate(torques_seq, 0.01)
+
+        gtd.futures.set_max_workers(4)
+        futures = [
+            self.simulator().simulateAsync(torques_seq, 0.01)
+            for _ in range(8)
+        ]
+        for future in futures:
+            self.gtsamAssertEquals(future.result(), expected)
+        gtd.futures.set_max_workers(None)
+
+    def test_exceptions(self):
+        """Exceptions of a solve are raised by its future."""
+        future = gtd.futures.submit(lambda: 1 / 0)
+        with self.assertRaises(ZeroDivisionError):
+            future.result()
+
+
+if __name__ == "__main__":
+    unittest.main()
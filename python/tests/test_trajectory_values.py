@@ -0,0 +1,62 @@
+"""
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_trajectory_values.py
+ * @brief Test NumPy views of TrajectoryValues.
+ * @author Yetong Zhang
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+import os.path as osp
+import unittest
+
+import gtdynamics as gtd
+import gtsam
+import numpy as np
+
+
+class TestTrajectoryValues(unittest.TestCase):
+    """Tests for the NumPy views of TrajectoryValues."""
+    def setUp(self):
+        """Set up the fixtures."""
+        SDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                            "models", "sdfs")
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(SDF_PATH, "test", "simple_rr.sdf"), "simple_rr_sdf")
+
+    def test_views(self):
+        """Joint states of all time steps are arrays without copies."""
+        num_steps = 5
+        values = gtsam.Values()
+        for k in range(num_steps):
+            for joint in self.robot.joints():
+                j = joint.id()
+                gtd.InsertJointAngle(values, j, k, j + 0.1 * k)
+                gtd.InsertTorque(values, j, k, j - 0.1 * k)
+
+        trajectory = gtd.TrajectoryValues.FromValues(self.robot, values,
+                                                     num_steps)
+        q = trajectory.jointAngles()
+        self.assertEqual(q.shape, (num_steps, self.robot.numJoints()))
+        for joint in self.robot.joints():
+            j = joint.id()
+            np.testing.assert_allclose(q[:, j], j + 0.1 * np.arange(5))
+            np.testing.assert_allclose(trajectory.torques()[:, j],
+                                       j - 0.1 * np.arange(5))
+
+        # Writes through a view are seen by the C++ object.
+        q[2, 0] = 7.0
+        self.assertEqual(trajectory.jointAngles()[2, 0], 7.0)
+        self.assertEqual(gtd.JointAngle(trajectory.toValues(), 0, 2), 7.0)
+
+        twists = trajectory.twists()
+        self.assertEqual(twists.shape,
+                         (num_steps, self.robot.numLinks(), 6))
+        np.testing.assert_allclose(twists, 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  linear_dynamics_benchmark.cpp
+ * @brief Compare timing of the elimination, recursive and sparse solvers for
+ * linear forward and inverse dynamics on a few robot models.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+/// Kinematics, joint accelerations and torques at time t.
+Values KnownValues(const Robot& robot, int t,
+                   const std::optional<std::string>& prior_link) {
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, 0.1 * (j % 5));
+    InsertJointVel(&values, j, t, 0.2);
+    InsertJointAccel(&values, j, t, 0.3);
+    InsertTorque(&values, j, t, 1.0);
+  }
+  if (prior_link) {
+    const auto link = robot.link(*prior_link);
+    InsertPose(&values, link->id(), t, link->bMcom());
+    InsertTwist(&values, link->id(), t, gtsam::Vector6::Zero());
+  }
+  return robot.forwardKinematics(values, t, prior_link);
+}
+
+/// Average time in microseconds of one call to f, after a first call that
+/// builds the solver or ordering DynamicsGraph keeps for later calls.
+template <typename F>
+double Time(F&& f, size_t num_runs) {
+  f();
+  const auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < num_runs; ++i) f();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         num_runs;
+}
+
+/// Time linearSolveID (and linearSolveFD for robots without fixed joints).
+void Benchmark(const std::string& name, const Robot& robot,
+               const std::optional<std::string>& prior_link, bool run_fd,
+               size_t num_runs) {
+  const int t = 0;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  Values known_values = KnownValues(robot, t, prior_link);
+
+  // Each solver needs its own inputs without the solved-for quantities.
+  Values id_values = known_values;
+  for (auto&& joint : robot.joints()) {
+    id_values.erase(TorqueKey(joint->id(), t));
+  }
+  Values fd_values = known_values;
+  for (auto&& joint : robot.joints()) {
+    fd_values.erase(JointAccelKey(joint->id(), t));
+  }
+
+  std::cout << std::setw(8) << name << std::setw(8) << robot.numJoints();
+  auto solve_id = [&]() { graph_builder.linearSolveID(robot, t, id_values); };
+  auto solve_fd = [&]() { graph_builder.linearSolveFD(robot, t, fd_values); };
+  std::cout << std::fixed << std::setprecision(1);
+  for (auto solver : {Elimination, Recursive, Sparse}) {
+    graph_builder.setLinearSolver(solver);
+    std::cout << std::setw(14) << Time(solve_id, num_runs);
+  }
+  for (auto solver : {Elimination, Recursive, Sparse}) {
+    graph_builder.setLinearSolver(solver);
+    if (run_fd) {
+      std::cout << std::setw(14) << Time(solve_fd, num_runs);
+    } else {
+      std::cout << std::setw(14) << "-";
+    }
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+  const size_t num_runs = argc > 1 ? std::stoul(argv[1]) : 100;
+
+  std::cout << "Steady-state time per solve (us) over " << num_runs
+            << " runs\n";
+  std::cout << std::setw(8) << "robot" << std::setw(8) << "joints"
+            << std::setw(14) << "ID elim" << std::setw(14) << "ID rnea"
+            << std::setw(14) << "ID sparse" << std::setw(14) << "FD elim"
+            << std::setw(14) << "FD aba" << std::setw(14) << "FD sparse"
+            << std::endl;
+
+  // Fixed joints leave the elimination FD problem under-determined, so FD is
+  // only timed for robots made of revolute joints.
+  Robot ur5 = CreateRobotFromFile(kUrdfPath + std::string("ur5/ur5.urdf"))
+                  .fixLink("base_link");
+  Benchmark("ur5", ur5, {}, false, num_runs);
+
+  Robot panda =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+          .fixLink("link0");
+  Benchmark("panda", panda, {}, false, num_runs);
+
+  Robot a1 = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  Benchmark("a1", a1, std::string("trunk"), false, num_runs);
+
+  Robot rrr = CreateRobotFromFile(kSdfPath + std::string("test/simple_rrr.sdf"),
+                                  "simple_rrr_sdf")
+                  .fixLink("link_0");
+  Benchmark("rrr", rrr, {}, true, num_runs);
+
+  return 0;
+}
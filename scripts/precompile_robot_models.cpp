@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  precompile_robot_models.cpp
+ * @brief Fill the binary robot cache for all URDF/SDF files in a directory.
+ * @author Frank Dellaert, Yetong Zhang
+ *
+ * Usage: precompile_robot_models <model_dir> <cache_dir>
+ * Files that cannot be loaded without a model name, e.g. world files, are
+ * reported and skipped.
+ */
+
+#include <gtdynamics/universal_robot/RobotCache.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace gtdynamics;
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <model_dir> <cache_dir>"
+              << std::endl;
+    return 1;
+  }
+  const std::string model_dir = argv[1], cache_dir = argv[2];
+
+  size_t num_cached = 0, num_failed = 0;
+  for (auto&& entry :
+       std::filesystem::recursive_directory_iterator(model_dir)) {
+    if (!entry.is_regular_file()) continue;
+    std::string ext = entry.path().extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext != ".urdf" && ext != ".sdf") continue;
+
+    const std::string file_path = entry.path().string();
+    try {
+      const Robot robot = CreateRobotFromFileCached(file_path, cache_dir);
+      std::cout << file_path << ": " << robot.numLinks() << " links, "
+                << robot.numJoints() << " joints" << std::endl;
+      num_cached++;
+    } catch (const std::exception& e) {
+      std::cerr << file_path << ": skipped, " << e.what() << std::endl;
+      num_failed++;
+    }
+  }
+  std::cout << num_cached << " models cached in " << cache_dir << ", "
+            << num_failed << " skipped." << std::endl;
+  return 0;
+}
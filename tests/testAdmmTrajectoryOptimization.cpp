@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAdmmTrajectoryOptimization.cpp
+ * @brief Test trajectory optimization over time segments with ADMM.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/AdmmTrajectoryOptimization.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <sstream>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+const size_t kNumSteps = 20;
+auto kModel = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+
+// A joint that should move by 1 per step, start at 0 and end at 0: on the
+// time steps of a segment, every step is in one segment only.
+NonlinearFactorGraph SegmentGraph(const Interval &segment) {
+  NonlinearFactorGraph graph;
+  for (size_t k = segment.k_start; k < segment.k_end; k++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, k), JointAngleKey(0, k + 1), 1.0, kModel);
+  }
+  if (segment.k_start == 0) {
+    graph.addPrior(JointAngleKey(0, 0), 0.0, kModel);
+  }
+  if (segment.k_end == kNumSteps) {
+    graph.addPrior(JointAngleKey(0, kNumSteps), 0.0, kModel);
+  }
+  return graph;
+}
+
+Values SegmentValues(const Interval &segment) {
+  Values values;
+  for (size_t k = segment.k_start; k <= segment.k_end; k++) {
+    InsertJointAngle(&values, 0, k, 0.0);
+  }
+  return values;
+}
+}  // namespace
+
+// Segments cover the time steps, sharing overlap steps.
+TEST(TimeSegments, overlap) {
+  const auto segments = TimeSegments(10, 4, 2);
+  EXPECT_LONGS_EQUAL(3, segments.size());
+  EXPECT_LONGS_EQUAL(3, segments[1].k_start);
+  EXPECT_LONGS_EQUAL(7, segments[1].k_end);
+  EXPECT_LONGS_EQUAL(6, segments[2].k_start);
+  EXPECT_LONGS_EQUAL(10, segments[2].k_end);
+  EXPECT_LONGS_EQUAL(1, TimeSegments(3, 5).size());
+  THROWS_EXCEPTION(TimeSegments(10, 4, 0));
+  THROWS_EXCEPTION(TimeSegments(10, 4, 5));
+}
+
+// The segments agree on the solution of the whole trajectory.
+TEST(AdmmTrajectoryOptimize, chain) {
+  AdmmParameters parameters;
+  parameters.segment_steps = 6;
+  parameters.max_iterations = 200;
+  parameters.tolerance = 1e-7;
+  parameters.execution = ExecutionContext::Threads(2);
+  const AdmmResult result = AdmmTrajectoryOptimize(
+      kNumSteps, SegmentGraph, SegmentValues, gtsam::MutableLMParams(),
+      parameters);
+  EXPECT_LONGS_EQUAL(4, result.segments.size());
+  EXPECT(result.iterations < parameters.max_iterations);
+  EXPECT_LONGS_EQUAL(kNumSteps + 1, result.values.size());
+
+  const Interval whole(0, kNumSteps);
+  const Values expected = gtsam::MutableLMOptimizer(SegmentGraph(whole),
+                                                    SegmentValues(whole))
+                              .optimize();
+  EXPECT(assert_equal(expected, result.values, 1e-5));
+}
+
+// Manifold values reach consensus in local coordinates.
+TEST(AdmmConsensus, pose) {
+  const gtsam::Key key = PoseKey(0, 0);
+  const gtsam::Pose3 a(gtsam::Rot3::Rz(0.2), gtsam::Point3(1, 0, 0)),
+      b(gtsam::Rot3::Rz(-0.2), gtsam::Point3(-1, 0, 0));
+  std::vector<Values> shared(2);
+  shared[0].insert(key, a);
+  shared[1].insert(key, b);
+  AdmmConsensus consensus(shared, 1.0);
+  EXPECT(assert_equal(a.retract(0.5 * a.localCoordinates(b)),
+                      consensus.consensus().at<gtsam::Pose3>(key), 1e-9));
+  EXPECT(assert_equal(consensus.consensus(), consensus.targets(0)));
+
+  // The dual of each segment moves its target away from the other segment.
+  consensus.update(shared);
+  EXPECT(consensus.primalResidual() > 0);
+  const gtsam::Pose3 target = consensus.targets(0).at<gtsam::Pose3>(key);
+  EXPECT(target.translation().x() < 0);
+}
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+// Messages round-trip through their binary format.
+TEST(AdmmMessage, roundTrip) {
+  AdmmMessage message;
+  message.segment = 2;
+  message.iteration = 7;
+  InsertJointAngle(&message.values, 3, 10, 0.5);
+  InsertPose(&message.values, 1, 10, gtsam::Pose3(gtsam::Rot3::Rx(0.1),
+                                                   gtsam::Point3(1, 2, 3)));
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  SaveAdmmMessage(message, ss);
+  const AdmmMessage loaded = LoadAdmmMessage(ss);
+  EXPECT_LONGS_EQUAL(2, loaded.segment);
+  EXPECT_LONGS_EQUAL(7, loaded.iteration);
+  EXPECT(assert_equal(message.values, loaded.values));
+
+  std::stringstream other("not a message");
+  THROWS_EXCEPTION(LoadAdmmMessage(other));
+}
+#endif
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
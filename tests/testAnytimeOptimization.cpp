@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAnytimeOptimization.cpp
+ * @brief Test time budgets and per-iteration callbacks of optimizers.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AnytimeOptimization.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+TEST(AnytimeOptimization, BestIterate) {
+  Values a, b, c;
+  a.insert(0, 1.0);
+  b.insert(0, 2.0);
+  c.insert(0, 3.0);
+
+  BestIterate best;
+  EXPECT(best.empty());
+  best.update(a, 1.0, 5.0, false);
+  best.update(b, 9.0, 1.0, false);  // less violation wins while infeasible
+  EXPECT(assert_equal(b, best.values()));
+  best.update(c, 20.0, 0.0, true);  // any feasible iterate wins
+  EXPECT(assert_equal(c, best.values()));
+  best.update(a, 0.0, 1.0, false);  // infeasible never replaces feasible
+  EXPECT(assert_equal(c, best.values()));
+}
+
+/** The callback sees each LM iteration and can stop the optimizer. */
+TEST(AnytimeOptimization, MutableLMCallback) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 5; k++) {
+    graph.emplace_shared<BetweenFactor<Pose3>>(
+        k - 1, k, Pose3(Rot3::Rz(0.5), Point3(1, 0, 0)), noise);
+    values.insert(k, Pose3(Rot3::Rx(1.0 * k), Point3(0, k, 0)));
+  }
+
+  std::vector<double> errors;
+  MutableLMParams params;
+  params.anytime.callback = [&](const IterationReport& report) {
+    errors.push_back(report.values ? report.cost : -1.0);
+    return report.iteration < 2;
+  };
+  MutableLMOptimizer optimizer(graph, values, params);
+  optimizer.optimize();
+  EXPECT_LONGS_EQUAL(2, errors.size());
+  EXPECT_LONGS_EQUAL(2, optimizer.iterations());
+  EXPECT(errors[0] >= 0 && errors[1] >= 0 && errors[1] <= errors[0]);
+}
+
+/** A stopped augmented Lagrangian run returns the best feasible iterate. */
+TEST(AnytimeOptimization, AugmentedLagrangian) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1e-2);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  for (bool in_place : {false, true}) {
+    std::vector<Values> reported;
+    AugmentedLagrangianParameters params;
+    params.in_place_updates = in_place;
+    params.anytime.time_budget = 60.0;
+    params.anytime.callback = [&](const IterationReport& report) {
+      reported.push_back(*report.values);
+      return report.iteration < 5;
+    };
+    AugmentedLagrangianOptimizer optimizer(params);
+    Values result = optimizer.optimize(graph, constraints, init_values);
+    EXPECT_LONGS_EQUAL(5, reported.size());
+
+    // The result is one of the reported iterates, and the most feasible
+    // one if none is feasible yet.
+    bool found = false;
+    for (auto&& values : reported) found = found || result.equals(values);
+    EXPECT(found);
+    if (!constraints[0]->feasible(result)) {
+      for (auto&& values : reported) {
+        EXPECT(std::abs(g1.value(result)) <= std::abs(g1.value(values)));
+      }
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
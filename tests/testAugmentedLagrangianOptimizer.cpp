@@ -59,6 +59,140 @@ TEST(AugmentedLagrangianOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+/// Updating the penalty factors in place gives the same solution.
+TEST(AugmentedLagrangianOptimizer, InPlaceUpdates) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  AugmentedLagrangianParameters params;
+  params.in_place_updates = true;
+  gtdynamics::AugmentedLagrangianOptimizer optimizer(params);
+  ConstrainedOptResult intermediate;
+  Values results = optimizer.optimize(graph, constraints, init_values,
+                                      &intermediate);
+  EXPECT_LONGS_EQUAL(params.num_iterations, intermediate.mu_values.size());
+
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  EXPECT(assert_equal(gt_results, results, 1e-4));
+}
+
+/// Re-solving from the returned state continues from the converged dual.
+TEST(AugmentedLagrangianOptimizer, WarmStart) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+
+  for (bool in_place : {false, true}) {
+    AugmentedLagrangianParameters params;
+    params.in_place_updates = in_place;
+    gtdynamics::AugmentedLagrangianOptimizer optimizer(params);
+
+    AugmentedLagrangianState state;
+    Values first = optimizer.optimize(graph, constraints,
+                                      InequalityConstraints(), init_values,
+                                      nullptr, &state);
+    EXPECT(assert_equal(gt_results, first, 1e-4));
+    EXPECT_LONGS_EQUAL(1, state.z.size());
+    EXPECT_LONGS_EQUAL(1, state.z[0].size());
+    EXPECT(state.mu > 1.0);
+
+    // A cold re-solve from the solution starts at the wrong dual and
+    // moves away; the warm one stays.
+    ConstrainedOptResult cold, warm;
+    optimizer.optimize(graph, constraints, InequalityConstraints(), first,
+                       &cold);
+    const double mu = state.mu;
+    Values second = optimizer.optimize(graph, constraints,
+                                       InequalityConstraints(), first, &warm,
+                                       &state);
+    EXPECT(assert_equal(gt_results, second, 1e-4));
+    EXPECT(state.mu >= mu);
+    int cold_iters = 0, warm_iters = 0;
+    for (int n : cold.num_iters) cold_iters += n;
+    for (int n : warm.num_iters) warm_iters += n;
+    EXPECT(warm_iters <= cold_iters);
+  }
+
+  // A state for other constraints is rejected.
+  AugmentedLagrangianState wrong;
+  wrong.z = {gtsam::Vector::Zero(2)};
+  gtdynamics::AugmentedLagrangianOptimizer optimizer;
+  THROWS_EXCEPTION(optimizer.optimize(graph, constraints,
+                                      InequalityConstraints(), init_values,
+                                      nullptr, &wrong));
+}
+
+/// Multipliers follow their constraints to a shifted horizon.
+TEST(AugmentedLagrangianOptimizer, ReindexedState) {
+  using namespace constrained_example;
+
+  // Constraints on x1 and x2, shifted to x2 and x3, and a new one on x1.
+  gtsam::Symbol x3_key = gtsam::Symbol('x', 3);
+  gtsam::Double_ x3(x3_key);
+  EqualityConstraints old_constraints, new_constraints;
+  old_constraints.emplace_shared<DoubleExpressionEquality>(x1, 1.0);
+  old_constraints.emplace_shared<DoubleExpressionEquality>(x2, 1.0);
+  new_constraints.emplace_shared<DoubleExpressionEquality>(x2, 1.0);
+  new_constraints.emplace_shared<DoubleExpressionEquality>(x3, 1.0);
+  new_constraints.emplace_shared<DoubleExpressionEquality>(x1, 1.0);
+
+  auto shift = [](gtsam::Key key) {
+    const gtsam::Symbol symbol(key);
+    return gtsam::Symbol(symbol.chr(), symbol.index() + 1).key();
+  };
+  const std::vector<int> map =
+      MatchConstraints(old_constraints, new_constraints, shift);
+  EXPECT_LONGS_EQUAL(3, map.size());
+  EXPECT_LONGS_EQUAL(0, map[0]);
+  EXPECT_LONGS_EQUAL(1, map[1]);
+  EXPECT_LONGS_EQUAL(-1, map[2]);
+
+  AugmentedLagrangianState state;
+  state.mu = 8.0;
+  state.z = {gtsam::Vector1(1.0), gtsam::Vector1(2.0)};
+  const AugmentedLagrangianState shifted =
+      state.reindexed(map, ConstraintDims(new_constraints));
+  EXPECT_DOUBLES_EQUAL(8.0, shifted.mu, 1e-9);
+  EXPECT_LONGS_EQUAL(3, shifted.z.size());
+  EXPECT(assert_equal(gtsam::Vector1(1.0), shifted.z[0]));
+  EXPECT(assert_equal(gtsam::Vector1(2.0), shifted.z[1]));
+  EXPECT(assert_equal(gtsam::Vector1(0.0), shifted.z[2]));
+  EXPECT(shifted.lambda.empty());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAutoDiffFactor.cpp
+ * @brief Test the factor with automatically differentiated residuals.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/AutoDiffFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <array>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+// A residual with all elementary functions and a branch.
+struct Residual {
+  template <typename T>
+  std::array<T, 2> operator()(const std::array<T, 3> &x) const {
+    using std::cos, std::exp, std::log, std::pow, std::sin, std::sqrt,
+        std::tanh;
+    const T r0 = x[0] * exp(x[1]) / (1 + x[2] * x[2]) - sqrt(x[0]);
+    const T r1 = x[1] > 0 ? sin(x[0]) * pow(x[2], 3.0) - log(x[0])
+                          : cos(x[1]) + tanh(x[2]) - 2 / x[0];
+    return {r0, r1};
+  }
+};
+
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(2, 0.1);
+const gtsam::KeyVector keys{gtsam::Symbol('x', 0), gtsam::Symbol('x', 1),
+                            gtsam::Symbol('x', 2)};
+
+gtsam::Values values(double x0, double x1, double x2) {
+  gtsam::Values values;
+  values.insert(keys[0], x0);
+  values.insert(keys[1], x1);
+  values.insert(keys[2], x2);
+  return values;
+}
+}  // namespace example
+
+/// Derivatives of the dual number arithmetic.
+TEST(Dual, Arithmetic) {
+  const Dual<2> x(3.0, 0), y(2.0, 1);
+  const Dual<2> z = (x * y - 1) / (y + x * 2.0);
+  EXPECT_DOUBLES_EQUAL(5.0 / 8.0, z.a, 1e-9);
+  // dz/dx = (y (y + 2x) - 2 (xy - 1)) / (y + 2x)^2, and dz/dy alike.
+  EXPECT_DOUBLES_EQUAL((2.0 * 8.0 - 2.0 * 5.0) / 64.0, z.v(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL((3.0 * 8.0 - 5.0) / 64.0, z.v(1), 1e-9);
+  EXPECT(x > y);
+  EXPECT(x < 4.0);
+  EXPECT_DOUBLES_EQUAL(3.0, DualValue(x), 1e-9);
+}
+
+/// Errors and Jacobians in both branches of the residual.
+TEST(AutoDiffFactor, Jacobians) {
+  AutoDiffFactor<example::Residual, 2, 3> factor(example::keys,
+                                                 example::cost_model);
+  EXPECT_LONGS_EQUAL(2, factor.dim());
+
+  const auto values = example::values(1.5, 0.3, -0.7);
+  const std::array<double, 3> x{1.5, 0.3, -0.7};
+  const auto residual = example::Residual()(x);
+  EXPECT(assert_equal(gtsam::Vector2(residual[0], residual[1]),
+                      factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, example::values(0.8, -0.3, 0.4),
+                                  1e-7, 1e-5);
+}
+
+/// The number of keys must match the functor.
+TEST(AutoDiffFactor, Keys) {
+  const gtsam::KeyVector keys{example::keys[0], example::keys[1]};
+  using Factor = AutoDiffFactor<example::Residual, 2, 3>;
+  THROWS_EXCEPTION(std::make_shared<Factor>(keys, example::cost_model));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
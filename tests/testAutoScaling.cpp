@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAutoScaling.cpp
+ * @brief Test automatic scaling of constraints and variables.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AutoScaling.h>
+#include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+TEST(ScaleConstraints, unitRows) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1e-3);
+
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+
+  // Disabled scaling keeps the constraints.
+  AutoScalingParameters parameters;
+  EXPECT(constraints.front() ==
+         ScaleConstraints(constraints, values, parameters).front());
+
+  // The gradient of g1 is (1 + 3 x1^2, 1 + 2 x2) = (1.12, 0.6).
+  parameters.enabled = true;
+  const auto scaled = ScaleConstraints(constraints, values, parameters);
+  auto constraint =
+      std::dynamic_pointer_cast<ScaledEqualityConstraint>(scaled.front());
+  CHECK(constraint);
+  const double norm = std::sqrt(1.12 * 1.12 + 0.6 * 0.6);
+  EXPECT_DOUBLES_EQUAL(1e-3 / norm, constraint->weights()(0), 1e-9);
+  auto linear = std::dynamic_pointer_cast<JacobianFactor>(
+      constraint->createFactor(1.0)->linearize(values));
+  CHECK(linear);
+  EXPECT_DOUBLES_EQUAL(1.0, linear->jacobian().first.norm(), 1e-9);
+
+  // Violations still use the tolerance.
+  EXPECT(assert_equal(constraints.front()->toleranceScaledViolation(values),
+                      constraint->toleranceScaledViolation(values)));
+  EXPECT(!constraint->feasible(values));
+
+  // Weights are clamped.
+  parameters.min_weight = 1e-2;
+  const auto clamped = std::dynamic_pointer_cast<ScaledEqualityConstraint>(
+      ScaleConstraints(constraints, values, parameters).front());
+  EXPECT_DOUBLES_EQUAL(1e-2, clamped->weights()(0), 1e-12);
+
+  EXPECT(ScaleVariables(LevenbergMarquardtParams(), parameters)
+             .getDiagonalDamping());
+}
+
+TEST(PenaltyMethodOptimizer, AutoScaling) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  // A tight tolerance that would make the first penalty very stiff.
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1e-4);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  PenaltyMethodParameters params;
+  params.scaling.enabled = true;
+  PenaltyMethodOptimizer optimizer(params);
+  const Values results = optimizer.optimize(graph, constraints, init_values);
+
+  Values expected;
+  expected.insert(x1_key, 0.0);
+  expected.insert(x2_key, 0.0);
+  EXPECT(assert_equal(expected, results, 1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchDynamics.cpp
+ * @brief Test BatchDynamics against Robot and RecursiveDynamics.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/BatchDynamics.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+// A batch of states, one row per state.
+Matrix States(Eigen::Index num_states, size_t n, double phase) {
+  Matrix x(num_states, n);
+  for (Eigen::Index k = 0; k < num_states; ++k) {
+    for (size_t j = 0; j < n; ++j) {
+      x(k, j) = std::sin(0.37 * k + 1.3 * j + phase);
+    }
+  }
+  return x;
+}
+
+// Compare batch torques with M * qdd + h of RecursiveDynamics.
+bool SameAsRecursiveDynamics(const Robot& robot, const gtsam::Vector3& gravity,
+                             BatchBackend backend) {
+  const BatchDynamics batch(robot, gravity, backend);
+  const RecursiveDynamics dynamics(robot, gravity);
+  const size_t n = dynamics.numJoints();
+  const Eigen::Index num_states = 300;
+  const Matrix q = States(num_states, n, 0.0), v = States(num_states, n, 1.0),
+               qdd = States(num_states, n, 2.0);
+  const Matrix tau = batch.inverseDynamics(q, v, qdd);
+
+  bool same = tau.rows() == num_states;
+  Matrix M(n, n);
+  Vector h(n);
+  for (Eigen::Index k = 0; k < num_states; ++k) {
+    const Vector q_k = q.row(k).transpose(), v_k = v.row(k).transpose();
+    dynamics.massMatrix(q_k, &M);
+    dynamics.biasTorques(q_k, v_k, &h);
+    const Vector expected = M * qdd.row(k).transpose() + h;
+    same &= assert_equal(expected, Vector(tau.row(k).transpose()), 1e-9);
+  }
+  return same;
+}
+
+TEST(BatchDynamics, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const BatchDynamics batch(robot, gravity);
+  EXPECT_LONGS_EQUAL(3, batch.numJoints());
+  EXPECT(SameAsRecursiveDynamics(robot, gravity, CpuBackend));
+
+  // Forward kinematics, with the fixed link at its fixed pose.
+  const Matrix q = States(10, 3, 0.5);
+  BatchLinkPoses poses;
+  batch.forwardKinematics(q, &poses);
+  EXPECT_LONGS_EQUAL(10, poses.numConfigs());
+  for (Eigen::Index k = 0; k < q.rows(); ++k) {
+    gtsam::Values angles;
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&angles, joint->id(), q(k, joint->id()));
+    }
+    const gtsam::Values fk = robot.forwardKinematics(angles);
+    for (auto&& link : robot.links()) {
+      EXPECT(assert_equal(Pose(fk, link->id()), poses.pose(link->id(), k),
+                          1e-9));
+    }
+  }
+
+  // States need one column per joint id.
+  THROWS_EXCEPTION(batch.inverseDynamics(Matrix::Zero(2, 2),
+                                         Matrix::Zero(2, 2),
+                                         Matrix::Zero(2, 2)));
+}
+
+TEST(BatchDynamics, a1) {
+  // A floating base, held at the identity.
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  EXPECT(SameAsRecursiveDynamics(robot, gtsam::Vector3(0, 0, -9.8),
+                                 CpuBackend));
+}
+
+// Chunks of states are independent, so the thread count does not matter.
+TEST(BatchDynamics, threads) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const BatchDynamics serial(robot, gravity, CpuBackend,
+                             ExecutionContext::Threads(1));
+  const BatchDynamics parallel(robot, gravity, CpuBackend,
+                               ExecutionContext::Threads(4));
+  const size_t n = serial.numJoints();
+  const Matrix q = States(1000, n, 0.0), v = States(1000, n, 1.0),
+               qdd = States(1000, n, 2.0);
+  EXPECT(assert_equal(serial.inverseDynamics(q, v, qdd),
+                      parallel.inverseDynamics(q, v, qdd), 0.0));
+}
+
+TEST(BatchDynamics, cuda) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  if (!BatchDynamics::CudaAvailable()) {
+    THROWS_EXCEPTION(BatchDynamics(robot, {}, CudaBackend));
+    return;
+  }
+  EXPECT(SameAsRecursiveDynamics(robot, gtsam::Vector3(0, 0, -9.8),
+                                 CudaBackend));
+
+  // Both backends compute the same poses.
+  const BatchDynamics cpu(robot), cuda(robot, {}, CudaBackend);
+  const Matrix q = States(1000, cpu.numJoints(), 0.5);
+  BatchLinkPoses cpu_poses, cuda_poses;
+  cpu.forwardKinematics(q, &cpu_poses);
+  cuda.forwardKinematics(q, &cuda_poses);
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Matrix(cpu_poses.links[i]),
+                        Matrix(cuda_poses.links[i]), 1e-12));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
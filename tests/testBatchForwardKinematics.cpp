@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchForwardKinematics.cpp
+ * @brief Test forward kinematics for batches of configurations.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+// Compare batch poses with Robot::forwardKinematics, one config at a time.
+bool SameAsRobotFK(const Robot& robot,
+                   const std::optional<std::string>& root,
+                   const gtsam::Pose3& root_pose, size_t num_configs) {
+  const size_t n = robot.topology().joints.size();
+  gtsam::Matrix q(num_configs, n);
+  for (size_t k = 0; k < num_configs; ++k) {
+    for (size_t j = 0; j < n; ++j) q(k, j) = std::sin(0.37 * k + 1.3 * j);
+  }
+
+  BatchForwardKinematics batch_fk(robot, root, root_pose);
+  const BatchLinkPoses poses = batch_fk.compute(q);
+  bool same = static_cast<size_t>(poses.numConfigs()) == num_configs;
+
+  LinkStates states;
+  const gtsam::Vector v = gtsam::Vector::Zero(n);
+  for (size_t k = 0; k < num_configs; ++k) {
+    robot.forwardKinematics(gtsam::Vector(q.row(k).transpose()), v, &states,
+                            root, root_pose);
+    for (auto&& link : robot.links()) {
+      const int i = link->id();
+      same &= assert_equal(states.poses[i], poses.pose(i, k), 1e-9);
+    }
+  }
+  return same;
+}
+
+TEST(BatchForwardKinematics, a1) {
+  // Keep fixed joints, which have zero screw axes.
+  Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"), "", true);
+  const gtsam::Pose3 wTb(gtsam::Rot3::Ry(0.2), gtsam::Point3(0.1, 0, 0.4));
+  // More configurations than one chunk, and not a multiple of it.
+  EXPECT(SameAsRobotFK(robot, std::string("trunk"), wTb, 300));
+  // Rooted at a foot, joints are traversed from child to parent.
+  EXPECT(SameAsRobotFK(robot, std::string("FR_lower"), wTb, 5));
+}
+
+TEST(BatchForwardKinematics, prismatic) {
+  const Robot robot = simple_urdf_prismatic::getRobot();
+  EXPECT(SameAsRobotFK(robot, {}, gtsam::Pose3(), 10));
+}
+
+TEST(BatchForwardKinematics, float) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const size_t n = robot.topology().joints.size();
+  gtsam::Matrix q(20, n);
+  for (Eigen::Index k = 0; k < q.rows(); ++k) {
+    for (size_t j = 0; j < n; ++j) q(k, j) = std::sin(0.37 * k + 1.3 * j);
+  }
+  const BatchForwardKinematics batch_fk(robot, std::string("trunk"));
+  const BatchLinkPoses poses = batch_fk.compute(q);
+  const Eigen::MatrixXf qf = q.cast<float>();
+  const BatchLinkPosesF poses_f = batch_fk.compute(qf);
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    for (Eigen::Index k = 0; k < q.rows(); ++k) {
+      EXPECT(assert_equal(poses.pose(i, k), poses_f.pose(i, k), 1e-5));
+    }
+  }
+
+  // Refining some configurations gives the double precision poses.
+  BatchLinkPoses refined;
+  batch_fk.refine(q, {3, 17}, &refined);
+  EXPECT_LONGS_EQUAL(2, refined.numConfigs());
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(poses.pose(i, 3), refined.pose(i, 0), 1e-12));
+    EXPECT(assert_equal(poses.pose(i, 17), refined.pose(i, 1), 1e-12));
+  }
+  THROWS_EXCEPTION(batch_fk.refine(q, {20}, &refined));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
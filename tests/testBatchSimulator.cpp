@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchSimulator.cpp
+ * @brief Test BatchSimulator against Simulator.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+TEST(BatchSimulator, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  BatchSimulator batch(robot, gravity);
+  const size_t n = batch.numJoints();
+  EXPECT_LONGS_EQUAL(3, n);
+
+  // A few rollouts with different initial states and torques.
+  const size_t num_rollouts = 5, num_steps = 10;
+  const double dt = 0.01;
+  std::vector<Vector> q0, v0;
+  std::vector<Matrix> torques;
+  for (size_t r = 0; r < num_rollouts; ++r) {
+    q0.push_back(Vector::Constant(n, 0.1 * r));
+    v0.push_back(Vector::Constant(n, -0.2 * r));
+    torques.push_back(Matrix::Constant(num_steps, n, 0.5 * r));
+  }
+  const auto trajectories = batch.simulate(q0, v0, torques, dt);
+  EXPECT_LONGS_EQUAL(num_rollouts, trajectories.size());
+
+  // Each rollout should match a serial run of the vector Simulator.
+  for (size_t r = 0; r < num_rollouts; ++r) {
+    gtsam::Values initial_values;
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&initial_values, joint->id(), q0[r](joint->id()));
+      InsertJointVel(&initial_values, joint->id(), v0[r](joint->id()));
+    }
+    Simulator simulator(robot, initial_values, gravity);
+    const auto& trajectory = trajectories[r];
+    EXPECT(assert_equal(q0[r], Vector(trajectory.q.row(0).transpose())));
+    for (size_t k = 0; k < num_steps; ++k) {
+      simulator.step(Vector(torques[r].row(k).transpose()), dt);
+      EXPECT(assert_equal(simulator.jointAccels(),
+                          Vector(trajectory.a.row(k).transpose()), 1e-9));
+      EXPECT(assert_equal(simulator.jointAngles(),
+                          Vector(trajectory.q.row(k + 1).transpose()), 1e-9));
+      EXPECT(assert_equal(simulator.jointVels(),
+                          Vector(trajectory.v.row(k + 1).transpose()), 1e-9));
+    }
+  }
+}
+
+TEST(BatchSimulator, wrong_sizes) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  BatchSimulator batch(robot);
+  std::vector<Vector> q0{Vector::Zero(2)}, v0{Vector::Zero(3)};
+  std::vector<Matrix> torques{Matrix::Zero(4, 3)};
+  CHECK_EXCEPTION(batch.simulate(q0, v0, torques, 0.1), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCentroidalDynamics.cpp
+ * @brief Test the single rigid body model and planner.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CentroidalDynamics.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+// A one-link arm: a small base and a rod above it.
+TEST(CentroidalModel, composite) {
+  const Robot robot = SerialChainRobot(1);
+  const CentroidalModel model(robot, "base");
+  EXPECT_DOUBLES_EQUAL(2.0, model.mass(), 1e-9);
+  EXPECT(assert_equal(Point3(0, 0, 0.05), model.baseTcom().translation()));
+
+  // Both links are 0.05 from the CoM; the rod is transverse about x and y.
+  const double base = 0.4 * 0.02 * 0.02,
+               rod = (3 * 0.02 * 0.02 + 0.2 * 0.2) / 12;
+  EXPECT_DOUBLES_EQUAL(base + rod + 2 * 0.05 * 0.05, model.inertia()(0, 0),
+                       1e-9);
+  EXPECT_DOUBLES_EQUAL(base + 0.02 * 0.02 / 2, model.inertia()(2, 2), 1e-9);
+
+  // Bending the joint moves the CoM.
+  gtsam::Values nominal;
+  InsertJointAngle(&nominal, 1, 0, M_PI_2);
+  const CentroidalModel bent(robot, "base", nominal);
+  EXPECT(assert_equal(Point3(0.05, 0, 0), bent.baseTcom().translation(),
+                      1e-9));
+}
+
+TEST(CentroidalDynamicsFactor, Jacobians) {
+  const Pose3 wTcom(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.1, 0.2, 0.4));
+  const Vector3 force(1, -2, 30);
+  const Point3 point(0.3, -0.2, 0);
+  gtsam::Matrix66 H_pose;
+  gtsam::Matrix63 H_force;
+  const Vector6 wrench = CentroidalDynamicsFactor::ContactWrench(
+      wTcom, force, point, H_pose, H_force);
+  EXPECT(assert_equal(Vector3(wTcom.rotation().unrotate(force)),
+                      Vector3(wrench.tail<3>())));
+  auto f = [&](const Pose3 &pose, const Vector3 &force) {
+    return CentroidalDynamicsFactor::ContactWrench(pose, force, point);
+  };
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative21<Vector6, Pose3, Vector3>(f, wTcom, force),
+      gtsam::Matrix(H_pose), 1e-6));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative22<Vector6, Pose3, Vector3>(f, wTcom, force),
+      gtsam::Matrix(H_force), 1e-6));
+
+  const Robot robot = LeggedRobot(4, 3);
+  const CentroidalModel model(robot, "base");
+  const ContactGoals contacts{
+      {{robot.link("leg1_link3"), Point3(0, 0, 0.1)}, Point3(0.4, 0, 0)},
+      {{robot.link("leg3_link3"), Point3(0, 0, 0.1)}, Point3(-0.4, 0, 0)}};
+  const CentroidalDynamicsFactor factor(
+      gtsam::noiseModel::Unit::Create(6), model, 3, contacts,
+      Vector3(0, 0, -9.8));
+  EXPECT_LONGS_EQUAL(5, factor.size());
+
+  gtsam::Values values;
+  values.insert(CentroidalPoseKey(3), wTcom);
+  values.insert(CentroidalTwistKey(3), Vector6(0.1, 0.2, -0.3, 0.4, 0, 1));
+  values.insert(CentroidalAccelKey(3), Vector6(1, 0, 0, 0, 2, 0));
+  values.insert(CentroidalForceKey(robot.link("leg1_link3")->id(), 3), force);
+  values.insert(CentroidalForceKey(robot.link("leg3_link3")->id(), 3),
+                Vector3(-1, 0, 50));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  const CentroidalFrictionConeFactor cone(
+      CentroidalForceKey(1, 3), gtsam::noiseModel::Unit::Create(1), 0.5,
+      Vector3(0, 0, -9.8));
+  EXPECT(assert_equal(gtsam::Vector1(0), cone.evaluateError(force)));
+  const Vector3 slipping(20, 0, 30);
+  EXPECT(assert_equal(gtsam::Vector1(400 - 0.25 * 900),
+                      cone.evaluateError(slipping)));
+}
+
+/// Quadruped standing on footholds under its knees, for K + 1 steps.
+static ContactSchedule Standing(const Robot &robot, int K) {
+  ContactGoals stance;
+  for (int i = 1; i <= 4; i++) {
+    const LinkSharedPtr foot =
+        robot.link("leg" + std::to_string(i) + "_link3");
+    const double angle = M_PI_2 * (i - 1);
+    stance.push_back({{foot, Point3(0, 0, 0.1)},
+                      Point3(0.4 * std::cos(angle), 0.4 * std::sin(angle), 0)});
+  }
+  return ContactSchedule(K + 1, stance);
+}
+
+// The body shifts forward while the feet support its weight.
+TEST(CentroidalPlanner, plan) {
+  const Robot robot = LeggedRobot(4, 3);
+  const CentroidalModel model(robot, "base");
+  const int K = 10;
+  const double dt = 0.05;
+  const ContactSchedule schedule = Standing(robot, K);
+  const Pose3 start = Pose3(Rot3(), Point3(0, 0, 0.35)) * model.baseTcom(),
+              goal(Rot3(), start.translation() + Point3(0.05, 0, 0));
+
+  const CentroidalPlanner planner(model);
+  const gtsam::Values plan = planner.plan(schedule, dt, start, goal);
+  EXPECT(assert_equal(start, plan.at<Pose3>(CentroidalPoseKey(0)), 1e-3));
+  EXPECT(assert_equal(goal, plan.at<Pose3>(CentroidalPoseKey(K)), 1e-3));
+
+  // At rest at both ends, the vertical impulse cancels gravity.
+  double impulse = 0;
+  for (int k = 0; k < K; k++) {
+    for (const ContactGoal &contact : schedule[k]) {
+      impulse +=
+          plan.at<Vector3>(CentroidalForceKey(contact.link()->id(), k)).z();
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(K * model.mass() * 9.8, impulse, 0.01 * impulse);
+
+  // The full problem starts with the base on the plan and feet on the goals.
+  const CentroidalInitializer initializer(robot, model, schedule, plan, dt);
+  const gtsam::Pose3 comTbase = model.baseTcom().inverse();
+  for (int k = 0; k <= K; k += 5) {
+    const gtsam::Values values =
+        initializer.ZeroValues(robot, k, 0.0, PointOnLinks{});
+    EXPECT(assert_equal(plan.at<Pose3>(CentroidalPoseKey(k)) * comTbase,
+                        Pose(values, model.baseId(), k), 1e-3));
+    for (const ContactGoal &contact : schedule[k]) {
+      EXPECT(contact.satisfied(initializer.warmStart(), k, 1e-2));
+      EXPECT(initializer.warmStart().exists(
+          ContactWrenchKey(contact.link()->id(), 0, k)));
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -117,6 +117,56 @@ TEST(Chain, ThreeLinksPoeNotRest) {
   EXPECT(assert_equal(J1, expected_J1, 1e-6));
 }
 
+// A three-joint chain with rotated links, for the cached evaluations below.
+Chain RotatedThreeLinks() {
+  Pose3 sMb(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0.5, 0));
+  Matrix screwAxis(6, 1);
+  screwAxis << 0.0, 0.6, 0.8, 0.0, 1.0, 0.5;
+  std::vector<Chain> chains(3, Chain(sMb, screwAxis));
+  return Chain::compose(chains);
+}
+
+// Cached evaluation matches poe after every partial update.
+TEST(Chain, ChainEvaluation) {
+  Chain composed = RotatedThreeLinks();
+  const Pose3 fTe(Rot3::Rx(0.4), Point3(0, 0, 0.2));
+  ChainEvaluation evaluation(composed, fTe);
+
+  Vector q = Vector::Zero(3);
+  Matrix expected_J, J;
+  for (size_t i : {2, 0, 1, 1}) {
+    q(i) += 0.3 + 0.1 * i;
+    evaluation.setAngle(i, q(i));
+    Pose3 expected = composed.poe(q, fTe, expected_J);
+    EXPECT(assert_equal(expected, evaluation.pose(), 1e-9));
+    EXPECT(assert_equal(expected_J, evaluation.jacobian(), 1e-9));
+  }
+
+  q << -0.2, 0.7, 1.1;
+  Pose3 expected = composed.poe(q, fTe, expected_J);
+  EXPECT(assert_equal(expected, evaluation.poe(q, J), 1e-9));
+  EXPECT(assert_equal(expected_J, J, 1e-9));
+  THROWS_EXCEPTION(evaluation.setAngle(3, 0.0));
+}
+
+// Fixed-size chain matches poe of the dynamic chain.
+TEST(Chain, FixedChain) {
+  Chain composed = RotatedThreeLinks();
+  FixedChain<3> fixed(composed);
+  const Pose3 fTe(Rot3::Rx(0.4), Point3(0, 0, 0.2));
+
+  Vector q(3);
+  q << -0.2, 0.7, 1.1;
+  Matrix expected_J;
+  Pose3 expected = composed.poe(q, fTe, expected_J);
+  Eigen::Matrix<double, 6, 3> J;
+  EXPECT(assert_equal(expected, fixed.poe(q, fTe, J), 1e-9));
+  EXPECT(assert_equal(expected_J, Matrix(J), 1e-9));
+  EXPECT(assert_equal(composed.poe(q), fixed.poe(q), 1e-9));
+
+  THROWS_EXCEPTION(FixedChain<2>{composed});
+}
+
 // Test Chain class functionality with no joints
 TEST(Chain, ZeroLinks) {
   std::vector<Chain> chains;
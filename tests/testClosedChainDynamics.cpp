@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testClosedChainDynamics.cpp
+ * @brief Test loop closure kinematics and dynamics on a four-bar linkage.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ClosedChainDynamics.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Four-bar linkage with links of equal length, i.e., a parallelogram.
+TEST(ClosedChainDynamics, four_bar_kinematics) {
+  Robot robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+  ClosedChainDynamics solver(robot, four_bar_linkage_pure::gravity);
+  EXPECT_LONGS_EQUAL(1, solver.cutJoints().size());
+  EXPECT_LONGS_EQUAL(3, solver.tree().numJoints());
+  EXPECT_LONGS_EQUAL(4, solver.numJoints());
+
+  // Driving joint 0 moves the opposite joints the same way.
+  Values known_values;
+  InsertJointAngle(&known_values, 0, 0, 0.3);
+  InsertJointVel(&known_values, 0, 0, 1.0);
+  const Values result = solver.forwardKinematics(0, known_values);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    const double sign = j % 2 == 0 ? 1.0 : -1.0;
+    EXPECT_DOUBLES_EQUAL(sign * 0.3, JointAngle(result, j), 1e-9);
+    EXPECT_DOUBLES_EQUAL(sign * 1.0, JointVel(result, j), 1e-9);
+  }
+
+  // The loop is closed: forward kinematics over all joints is consistent.
+  Values joint_values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&joint_values, j, JointAngle(result, j));
+    InsertJointVel(&joint_values, j, JointVel(result, j));
+  }
+  const Values expected = robot.forwardKinematics(joint_values);
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Pose(expected, i), Pose(result, i), 1e-9));
+    EXPECT(assert_equal(Twist(expected, i), Twist(result, i), 1e-9));
+  }
+  gtsam::Vector error;
+  gtsam::Matrix J;
+  const gtsam::Vector q = DynamicsGraph::jointAngles(robot, result, 0);
+  solver.loopConstraints(q, &error, &J);
+  EXPECT(assert_equal(gtsam::Vector(gtsam::Vector6::Zero()), error, 1e-9));
+
+  // Angles of all joints which do not close the loop.
+  Values inconsistent;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&inconsistent, joint->id(), 0.3);
+  }
+  THROWS_EXCEPTION(solver.forwardKinematics(0, inconsistent));
+}
+
+// Inverse dynamics at rest, against the forward dynamics result of the
+// factor graph: torques (1, 0, 1, 0) give accelerations of 0.25.
+TEST(ClosedChainDynamics, four_bar_inverse_dynamics) {
+  Robot robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+  ClosedChainDynamics solver(robot, four_bar_linkage_pure::gravity);
+  Values known_values;
+  InsertJointAngle(&known_values, 0, 0, 0.0);
+  const Values kinematics = solver.forwardKinematics(0, known_values);
+  Values values = kinematics;
+  InsertJointAccel(&values, 0, 0, 0.25);
+
+  // The accelerations of the other joints follow from the loop closure.
+  const Values result = solver.inverseDynamics(0, values);
+  const gtsam::Vector expected_qAccel =
+      (gtsam::Vector(4) << 0.25, -0.25, 0.25, -0.25).finished();
+  EXPECT(assert_equal(expected_qAccel,
+                      DynamicsGraph::jointAccels(robot, result, 0), 1e-9));
+
+  // All joints actuated: the minimum norm torques, with the same power.
+  const gtsam::Vector expected_torques =
+      (gtsam::Vector(4) << 0.5, -0.5, 0.5, -0.5).finished();
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(expected_torques(j), Torque(result, j), 1e-9);
+  }
+  const auto& cut = solver.cutJoints()[0];
+  EXPECT(result.exists(WrenchKey(cut->child()->id(), cut->id(), 0)));
+  EXPECT(result.exists(WrenchKey(cut->parent()->id(), cut->id(), 0)));
+
+  // Only joint 0 actuated: it provides all of the power.
+  const Values actuated =
+      solver.inverseDynamics(0, values, std::vector<int>{0});
+  EXPECT_DOUBLES_EQUAL(2.0, Torque(actuated, 0), 1e-9);
+  for (int j = 1; j < 4; j++) {
+    EXPECT_DOUBLES_EQUAL(0.0, Torque(actuated, j), 1e-9);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCoarseToFineOptimization.cpp
+ * @brief Test trajectory optimization at increasing time resolutions.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/CoarseToFineOptimization.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <vector>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// A joint moving from 0 to 1 with equal steps over the trajectory.
+NonlinearFactorGraph Ramp(const Trajectory &trajectory) {
+  const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, 0), 0.0,
+                                                   model);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, K), 1.0,
+                                                   model);
+  for (int k = 0; k < K; k++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, k), JointAngleKey(0, k + 1), 1.0 / K, model);
+  }
+  return graph;
+}
+
+Values Zeros(const Trajectory &trajectory) {
+  const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+  Values values;
+  for (int k = 0; k <= K; k++) InsertJointAngle(&values, 0, k, 0.0);
+  return values;
+}
+
+TEST(CoarseToFineOptimize, ramp) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 2);
+
+  // Coarsening by 8 and 16 gives one step per phase, as by 4.
+  CoarseToFineParameters parameters;
+  parameters.num_levels = 5;
+  const CoarseToFineResult result = CoarseToFineOptimize(
+      trajectory, Ramp, Zeros, gtsam::MutableLMParams(), parameters);
+  CHECK(result.levels.size() == 3);
+  EXPECT(std::vector<int>({1, 1, 1, 1}) == result.levels[0].phase_steps);
+  EXPECT(std::vector<int>({1, 2, 1, 2}) == result.levels[1].phase_steps);
+  EXPECT(trajectory.phaseDurations() == result.levels[2].phase_steps);
+
+  EXPECT_LONGS_EQUAL(11, result.values.size());
+  for (int k = 0; k <= 10; k++) {
+    EXPECT_DOUBLES_EQUAL(k / 10.0, JointAngle(result.values, 0, k), 1e-6);
+  }
+  EXPECT_DOUBLES_EQUAL(0.0, result.levels.back().error, 1e-9);
+
+  parameters.num_levels = 0;
+  THROWS_EXCEPTION(
+      CoarseToFineOptimize(trajectory, Ramp, Zeros, {}, parameters));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCollisionBVH.cpp
+ * @brief Test collision geometry from SDF/URDF files and CollisionBVH.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/CollisionBVH.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+// Link id of every primitive pair.
+std::vector<std::pair<int, int>> LinkPairs(
+    const CollisionBVH& bvh, const std::vector<CollisionPair>& pairs) {
+  std::vector<std::pair<int, int>> links;
+  for (auto&& pair : pairs) {
+    const int a = bvh.primitives()[pair.a].link_id,
+              b = bvh.primitives()[pair.b].link_id;
+    links.emplace_back(std::min(a, b), std::max(a, b));
+  }
+  std::sort(links.begin(), links.end());
+  return links;
+}
+
+// Compare selfCollisions against testing all pairs of primitives.
+bool SameAsBruteForce(const CollisionBVH& bvh, double margin) {
+  size_t expected = 0;
+  const auto& primitives = bvh.primitives();
+  for (size_t i = 0; i < primitives.size(); ++i) {
+    for (size_t j = i + 1; j < primitives.size(); ++j) {
+      if (primitives[i].link_id == primitives[j].link_id) continue;
+      if (bvh.distance(i, j) < margin) ++expected;
+    }
+  }
+  return bvh.selfCollisions(margin, false).size() == expected;
+}
+
+TEST(CollisionBVH, SegmentDistance) {
+  Point3 cp, cq;
+  EXPECT_DOUBLES_EQUAL(
+      1.0,
+      SegmentDistance(Point3(0, 0, 0), Point3(2, 0, 0), Point3(1, -1, 1),
+                      Point3(1, 1, 1), &cp, &cq),
+      1e-12);
+  EXPECT(assert_equal(Point3(1, 0, 0), cp));
+  EXPECT(assert_equal(Point3(1, 0, 1), cq));
+
+  // Parallel segments, and a point.
+  EXPECT_DOUBLES_EQUAL(
+      1.0,
+      SegmentDistance(Point3(0, 0, 0), Point3(1, 0, 0), Point3(0.5, 1, 0),
+                      Point3(3, 1, 0)),
+      1e-12);
+  EXPECT_DOUBLES_EQUAL(
+      std::sqrt(2.0),
+      SegmentDistance(Point3(0, 0, 0), Point3(1, 0, 0), Point3(2, 1, 0),
+                      Point3(2, 1, 0)),
+      1e-12);
+}
+
+TEST(CollisionGeometry, sdf) {
+  const Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  const auto& collisions = robot.link("link_1")->collisions();
+  EXPECT_LONGS_EQUAL(1, collisions.size());
+  EXPECT(collisions[0].type == CollisionGeometry::Cylinder);
+  EXPECT("link_1_collision" == collisions[0].name);
+  EXPECT_DOUBLES_EQUAL(0.1, collisions[0].radius, 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.6, collisions[0].length, 1e-9);
+
+  // The CoM and the cylinder are both at z = 0.5.
+  EXPECT(assert_equal(Pose3(), collisions[0].comTgeom, 1e-9));
+}
+
+TEST(CollisionGeometry, urdf) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const auto& collisions = robot.link("trunk")->collisions();
+  EXPECT_LONGS_EQUAL(1, collisions.size());
+  EXPECT(collisions[0].type == CollisionGeometry::Box);
+  EXPECT(assert_equal(gtsam::Vector3(0.267, 0.194, 0.114), collisions[0].size,
+                      1e-9));
+
+  // The box is bounded along its longest side, the x axis.
+  Pose3 comTaxis;
+  double half_length, radius;
+  collisions[0].sweptSphere(&comTaxis, &half_length, &radius);
+  EXPECT_DOUBLES_EQUAL(0.1335, half_length, 1e-9);
+  EXPECT_DOUBLES_EQUAL(std::hypot(0.097, 0.057), radius, 1e-9);
+  EXPECT(assert_equal(gtsam::Vector3(1, 0, 0),
+                      gtsam::Vector3(comTaxis.rotation().r3()), 1e-9));
+}
+
+TEST(CollisionBVH, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  CollisionBVH bvh(robot);
+  EXPECT_LONGS_EQUAL(4, bvh.primitives().size());
+
+  // At rest the cylinders are stacked along z, with gaps of 0.6 between
+  // links two apart.
+  std::vector<size_t> index(4);
+  for (size_t i = 0; i < 4; ++i) index[bvh.primitives()[i].link_id] = i;
+  EXPECT_DOUBLES_EQUAL(0.3, bvh.distance(index[0], index[2]), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.4, bvh.distance(index[1], index[3]), 1e-9);
+
+  using Pairs = std::vector<std::pair<int, int>>;
+  EXPECT(Pairs({{0, 2}}) == LinkPairs(bvh, bvh.selfCollisions(0.35)));
+  EXPECT(Pairs({{0, 2}, {1, 3}}) == LinkPairs(bvh, bvh.selfCollisions(0.5)));
+  EXPECT_LONGS_EQUAL(6, bvh.selfCollisions(10.0, false).size());
+
+  // An obstacle next to the top of link_3.
+  const auto near = bvh.sphereQuery(Point3(0.3, 0, 1.9), 0.1);
+  EXPECT_LONGS_EQUAL(0, near.size());
+  const auto touching = bvh.sphereQuery(Point3(0.3, 0, 1.9), 0.1, 0.2);
+  EXPECT_LONGS_EQUAL(1, touching.size());
+  EXPECT_LONGS_EQUAL(index[3], touching[0].first);
+  EXPECT_DOUBLES_EQUAL(0.1, touching[0].second, 1e-9);
+
+  // Fold the arm back onto itself and compare with testing all pairs.
+  for (double q : {0.5, 1.5, 2.5, 3.0}) {
+    gtsam::Values angles;
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&angles, joint->id(), q);
+    }
+    bvh.update(robot.forwardKinematics(angles));
+    for (double margin : {0.0, 0.2, 0.5, 1.0}) {
+      EXPECT(SameAsBruteForce(bvh, margin));
+    }
+  }
+}
+
+TEST(CollisionBVH, a1) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  CollisionBVH bvh(robot, 1);
+  EXPECT(bvh.primitives().size() > 10);
+  EXPECT(!bvh.bounds().isEmpty());
+  for (double margin : {0.0, 0.05, 0.2}) {
+    EXPECT(SameAsBruteForce(bvh, margin));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
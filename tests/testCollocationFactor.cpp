@@ -199,6 +199,40 @@ TEST(RandomData, TrapezoidalTwist) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+TEST(HermiteSimpsonPoseCollocationFactor, error) {
+  Pose3 pose_p = Pose3(Rot3(), gtsam::Point3(0, 0, 1));
+  Vector6 twist;
+  twist << 1, 0, 0, 0, 0, 1;
+  Vector6 accel = Vector6::Zero();
+  double dt = M_PI_2;
+  Pose3 pose_c(Rot3::Rx(M_PI_2), gtsam::Point3(0, -1, 2));
+
+  HermiteSimpsonPoseCollocationFactor factor(
+      example::pose_p_key, example::pose_c_key, example::twist_p_key,
+      example::twist_c_key, example::accel_p_key, example::accel_c_key,
+      example::dt_key, example::cost_model);
+
+  // With a constant twist, the pose is predicted exactly.
+  auto actual_errors =
+      factor.evaluateError(pose_p, pose_c, twist, twist, accel, accel, dt);
+  EXPECT(assert_equal(Vector6::Zero().eval(), actual_errors, 1e-6));
+
+  // Make sure linearization is correct
+  Vector6 accel_p, accel_c;
+  accel_p << 0.1, -0.2, 0.3, 0.4, 0.5, -0.6;
+  accel_c << -0.3, 0.2, 0.1, 0.0, 0.7, 0.2;
+  gtsam::Values values;
+  values.insert(example::pose_p_key, pose_p);
+  values.insert(example::pose_c_key, pose_c);
+  values.insert(example::twist_p_key, twist);
+  values.insert(example::twist_c_key, Vector6(2 * twist));
+  values.insert(example::accel_p_key, accel_p);
+  values.insert(example::accel_c_key, accel_c);
+  values.insert(example::dt_key, dt);
+  double diffDelta = 1e-7;
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -52,6 +52,29 @@ TEST(BiasedFactor, pose) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(const_bias_factor, values, 1e-7, 1e-5);
 }
 
+TEST(MutableBiasedFactor, pose) {
+  Key x1_key = 1;
+  Key x2_key = 2;
+
+  // Base factor, with noise sigmas as tolerance.
+  auto noise = noiseModel::Diagonal::Sigmas(Vector3(1, 2, 0.5));
+  auto base_factor = std::make_shared<BetweenFactor<Point3>>(
+      x1_key, x2_key, Point3(0, 0, 1), noise);
+
+  Values values;
+  values.insert(x1_key, Point3(0, 0, 0));
+  values.insert(x2_key, Point3(1, 0, 1));
+
+  // Same error and Jacobians, after updating mu and bias in place.
+  MutableBiasedFactor factor(base_factor);
+  factor.setMu(4);
+  factor.setBias((Vector(3) << 1, 1, 0.1).finished());
+  EXPECT_DOUBLES_EQUAL(4, factor.mu(), 1e-9);
+  Vector expected_error = (Vector(3) << 4, 1, 0.4).finished();
+  EXPECT(assert_equal(expected_error, factor.unwhitenedError(values)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -46,6 +46,10 @@ TEST_UNSAFE(ConstraintManifold, connected_poses) {
   constraints.emplace_shared<gtdynamics::FactorZeroErrorConstraint>(factor23);
   auto component = std::make_shared<ConnectedComponent>(constraints);
 
+  // The elimination structure of the merit graph is cached in the component.
+  EXPECT_LONGS_EQUAL(3, component->variable_index_.size());
+  EXPECT_LONGS_EQUAL(3, component->ordering_.size());
+
   // Create manifold values for testing.
   Values cm_base_values;
   cm_base_values.insert(x1_key, Pose3(Rot3(), Point3(0, 0, 0)));
@@ -104,6 +108,24 @@ TEST_UNSAFE(ConstraintManifold, connected_poses) {
       // check retract
       Vector xi = (Vector(6) << 0, 0, 0, 0, 0, 1).finished();
       auto new_cm = manifold.retract(xi);
+
+      // The basis at the retracted point is only constructed when used.
+      EXPECT(!new_cm.basis()->isConstructed());
+      new_cm.recover<Pose3>(x2_key, H_recover_x2);
+      EXPECT(new_cm.basis()->isConstructed());
+
+      // Copies, and manifolds the step leaves alone, share their values.
+      const ConstraintManifold copy = manifold;
+      EXPECT(&copy.values() == &manifold.values());
+      Values manifold_values;
+      manifold_values.insert(0, manifold);
+      manifold_values.insert(4, 1.0);
+      VectorValues delta;
+      delta.insert(4, Vector1(0.5));
+      const Values retracted = RetractManifolds(manifold_values, delta);
+      EXPECT(&retracted.at<ConstraintManifold>(0).values() ==
+             &manifold.values());
+      EXPECT_DOUBLES_EQUAL(1.5, retracted.at<double>(4), 1e-9);
     }
   }
 }
@@ -176,6 +198,77 @@ TEST(ConstraintManifold_retract, cart_pole_dynamics) {
   EXPECT(assert_equal(0., cc->merit_graph_.error(new_cm.values())));
 }
 
+/** Components that are the same constraints at other time steps share the
+ * structure of the first one. */
+TEST(ComponentStructureCache, time_shifted) {
+  auto component_at = [](int t) {
+    EqualityConstraints constraints;
+    Double_ q(JointAngleKey(0, t)), v(JointVelKey(0, t));
+    Double_ a(JointAccelKey(0, t));
+    constraints.emplace_shared<DoubleExpressionEquality>(q - v, 1e-3);
+    constraints.emplace_shared<DoubleExpressionEquality>(v - a, 1e-3);
+    return constraints;
+  };
+
+  ComponentStructureCache cache;
+  auto first = cache.create(component_at(0));
+  auto shifted = cache.create(component_at(5));
+  EXPECT_LONGS_EQUAL(1, cache.numStructures());
+  EXPECT_LONGS_EQUAL(1, cache.numShared());
+
+  // The ordering is the first one's, five steps later.
+  Ordering expected;
+  for (const Key& key : first->ordering_) {
+    expected.push_back(DynamicsKeyEncoding::WithTime(key, 5));
+  }
+  EXPECT(assert_equal(expected, shifted->ordering_));
+  EXPECT(shifted->keys_ == KeySet(component_at(5).keys()));
+
+  // Other constraints have their own structure.
+  EqualityConstraints other;
+  other.emplace_shared<DoubleExpressionEquality>(
+      Double_(JointAngleKey(0, 1)) - Double_(JointAngleKey(1, 1)), 1e-3);
+  cache.create(other);
+  EXPECT_LONGS_EQUAL(2, cache.numStructures());
+  EXPECT_LONGS_EQUAL(1, cache.numShared());
+}
+
+/** Dynamics retraction with linear solves of the velocity and acceleration
+ * levels agrees with LM at every level. */
+TEST(DynamicsRetractor, linear_levels) {
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("cart_pole.urdf"))
+                   .fixLink("l0");
+  auto graph_builder =
+      DynamicsGraph(OptimizerSetting(), gtsam::Vector3(0, 0, -10));
+  auto constraints =
+      ConstraintsFromGraph(graph_builder.dynamicsFactorGraph(robot, 0));
+  auto cc = std::make_shared<ConnectedComponent>(constraints);
+
+  // Values off the manifold at every level.
+  Values values = Initializer().ZeroValues(robot, 0, 0.0);
+  KeyVector basis_keys;
+  for (const auto& joint : robot.joints()) {
+    const int j = joint->id();
+    values.update(JointAngleKey(j, 0), 0.3);
+    values.update(JointVelKey(j, 0), 0.5);
+    values.update(TorqueKey(j, 0), 1.0);
+    basis_keys.push_back(JointAngleKey(j, 0));
+    basis_keys.push_back(JointVelKey(j, 0));
+    basis_keys.push_back(JointAccelKey(j, 0));
+  }
+
+  auto params = std::make_shared<RetractParams>();
+  params->setDynamics();
+  auto lm_params = std::make_shared<RetractParams>(*params);
+  lm_params->linear_dynamics_levels = false;
+  DynamicsRetractor retractor(cc, params, basis_keys);
+  DynamicsRetractor lm_retractor(cc, lm_params, basis_keys);
+
+  const Values actual = retractor.retractConstraints(values);
+  EXPECT(assert_equal(lm_retractor.retractConstraints(values), actual, 1e-3));
+  EXPECT_DOUBLES_EQUAL(0.0, cc->merit_graph_.error(actual), 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
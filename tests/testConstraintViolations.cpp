@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testConstraintViolations.cpp
+ * @brief Test batched evaluation of constraints.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::pow;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::x1_key, constrained_example::x2_key;
+
+// Check that evaluate agrees with the separate calls.
+template <class CONSTRAINT>
+bool EvaluationAgrees(const CONSTRAINT &constraint, const Values &values) {
+  const ConstraintEvaluation evaluation = constraint.evaluate(values);
+  return assert_equal(constraint(values), evaluation.violation) &&
+         assert_equal(constraint.toleranceScaledViolation(values),
+                      evaluation.scaled) &&
+         constraint.feasible(values) == evaluation.feasible;
+}
+
+TEST(ConstraintViolations, evaluate) {
+  Values feasible_values, infeasible_values;
+  feasible_values.insert(x1_key, 0.0);
+  feasible_values.insert(x2_key, 0.0);
+  infeasible_values.insert(x1_key, 1.0);
+  infeasible_values.insert(x2_key, -0.5);
+
+  const DoubleExpressionEquality equality(x1 + pow(x2, 2), 0.1);
+  const DoubleExpressionInequality inequality(x1 + x2, 0.1);
+  for (const Values *values : {&feasible_values, &infeasible_values}) {
+    EXPECT(EvaluationAgrees(equality, *values));
+    EXPECT(EvaluationAgrees(inequality, *values));
+  }
+
+  Values vector_values;
+  vector_values.insert(x1_key, Vector2(1, 1));
+  vector_values.insert(x2_key, Vector2(1, 2));
+  const VectorExpressionEquality<2> vector_equality(
+      Vector2_(x1_key) + Vector2_(x2_key), Vector2(0.1, 0.5));
+  EXPECT(EvaluationAgrees(vector_equality, vector_values));
+
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<BetweenFactor<Vector2>>(
+      x1_key, x2_key, Vector2(1, 1), noiseModel::Diagonal::Sigmas(
+                                         Vector2(0.5, 0.1)));
+  const auto factor_constraint = ConstraintsFromGraph(graph).at(0);
+  EXPECT(EvaluationAgrees(*factor_constraint, vector_values));
+}
+
+TEST(ConstraintViolations, norms) {
+  EqualityConstraints constraints;
+  for (size_t i = 0; i < 10; ++i) {
+    constraints.emplace_shared<DoubleExpressionEquality>(x1 + double(i), 0.5);
+  }
+  Values values;
+  values.insert(x1_key, 0.0);
+
+  // Constraint i is violated by i / 0.5.
+  const ConstraintViolations violations(constraints, values);
+  EXPECT_LONGS_EQUAL(10, violations.size());
+  EXPECT(violations[0].feasible);
+  EXPECT(!violations.feasible());
+  EXPECT_DOUBLES_EQUAL(4.0 * 285, violations.squaredNorm(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(std::sqrt(4.0 * 285), violations.norm(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(2.0 * 45, violations.l1Norm(), 1e-9);
+
+  // Evaluating blocks of constraints in parallel gives the same results.
+  for (size_t num_threads : {2, 3, 16}) {
+    const ConstraintViolations parallel(constraints, values, num_threads);
+    EXPECT_LONGS_EQUAL(10, parallel.size());
+    for (size_t i = 0; i < 10; ++i) {
+      EXPECT(assert_equal(violations[i].scaled, parallel[i].scaled));
+    }
+  }
+
+  EXPECT(ConstraintViolations().feasible());
+  EXPECT_DOUBLES_EQUAL(0.0, ConstraintViolations().norm(), 1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
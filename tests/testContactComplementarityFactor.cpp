@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactComplementarityFactor.cpp
+ * @brief Test the contact complementarity factor.
+ * @author Alejandro Escontrela
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Vector3, gtsam::Vector6, gtsam::Rot3, gtsam::Pose3, gtsam::Point3;
+
+namespace example {
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(3, 1.0);
+gtsam::LabeledSymbol pose_key('p', 0, 0), wrench_key('C', 0, 0);
+// The contact point is 1m below the CoM of a link pointing down.
+const Point3 comPc(0, 0, -1);
+const Vector3 gravity(0, 0, -9.8);
+
+gtsam::Values values(double height, double normal_force) {
+  gtsam::Values values;
+  values.insert(pose_key,
+                Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0, 0, 1 + height)));
+  // The force of the contact frame, so rotate the normal force into it.
+  const Vector3 f_s(0.2, -0.1, normal_force);
+  const Vector3 f_c = Rot3::RzRyRx(0.1, -0.2, 0.3).transpose() * f_s;
+  values.insert(wrench_key, (Vector6() << 0, 0, 0, f_c).finished());
+  return values;
+}
+}  // namespace example
+
+/// Errors in the different regimes of the complementarity.
+TEST(ContactComplementarityFactor, Error) {
+  using example::values;
+  ContactComplementarityFactor factor(example::pose_key, example::wrench_key,
+                                      example::cost_model, example::comPc,
+                                      example::gravity, 0.01);
+
+  // Height of the contact point for the test pose.
+  const Pose3 pose = values(0, 0).at<Pose3>(example::pose_key);
+  const double h0 = pose.transformFrom(example::comPc).z();
+
+  // In contact with a positive normal force, or in the air without force.
+  const double dh = -h0;  // shift so that the contact point is at the ground
+  EXPECT(assert_equal(Vector3::Zero().eval(),
+                      factor.unwhitenedError(values(dh, 10)), 1e-9));
+  EXPECT(assert_equal(Vector3::Zero().eval(),
+                      factor.unwhitenedError(values(dh + 0.5, 0)), 1e-9));
+
+  // In the air with a force: only the complementarity row is active.
+  EXPECT(assert_equal(Vector3(0, 0, 0.5 * 10 - 0.01),
+                      factor.unwhitenedError(values(dh + 0.5, 10)), 1e-9));
+
+  // Penetrating the ground, and pulling.
+  EXPECT(assert_equal(Vector3(0.1, 0, 0),
+                      factor.unwhitenedError(values(dh - 0.1, 10)), 1e-9));
+  EXPECT(assert_equal(Vector3(0, 2, 0),
+                      factor.unwhitenedError(values(dh + 0.5, -2)), 1e-9));
+}
+
+/// Jacobians in the regimes with active rows.
+TEST(ContactComplementarityFactor, Jacobians) {
+  using example::values;
+  ContactComplementarityFactor factor(example::pose_key, example::wrench_key,
+                                      example::cost_model, example::comPc,
+                                      example::gravity, 0.01);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(0.5, 10), 1e-7, 1e-3);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(-2.0, 10), 1e-7, 1e-3);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(0.5, -2), 1e-7, 1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
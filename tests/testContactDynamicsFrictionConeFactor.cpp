@@ -175,6 +175,61 @@ TEST(ContactDynamicsFrictionConeFactor, optimization) {
       (gtsam::Vector(1) << 0).finished(), 1e-3));
 }
 
+// On the flat ground, the terrain factor is the flat one; on a slope, the
+// cone tilts with the normal.
+TEST(TerrainFrictionConeFactor, error) {
+  auto cost_model = gtsam::noiseModel::Gaussian::Covariance(gtsam::I_1x1);
+  LabeledSymbol pose_key = LabeledSymbol('p', 0, 0);
+  LabeledSymbol contact_wrench_key = LabeledSymbol('C', 0, 0);
+  const double mu = 0.5;
+  const Point3 comPc(0, 0, -0.2);
+
+  auto flat = std::make_shared<HeightMap>(gtsam::Matrix::Zero(2, 2),
+                                          gtsam::Point2(-5, -5), 10.0);
+  TerrainFrictionConeFactor flat_factor(pose_key, contact_wrench_key,
+                                        cost_model, mu, comPc, flat);
+  ContactDynamicsFrictionConeFactor expected(pose_key, contact_wrench_key,
+                                             cost_model, mu,
+                                             Vector3(0, 0, -9.8));
+  const Pose3 pose(Rot3::RzRyRx(0.3, -0.2, 0.1), Point3(0.1, 0.3, 0.5));
+  const gtsam::Vector6 wrench =
+      (gtsam::Vector(6) << 0, 0, 0, 1, 2, 1).finished();
+  EXPECT(assert_equal(expected.evaluateError(pose, wrench),
+                      flat_factor.evaluateError(pose, wrench), 1e-9));
+
+  // A 45 degree slope along x: a force along its normal is inside the cone,
+  // a vertical one outside it.
+  gtsam::Matrix heights(2, 2);
+  heights << 0, 0, 10, 10;
+  auto slope =
+      std::make_shared<HeightMap>(heights, gtsam::Point2(-5, -5), 10.0);
+  TerrainFrictionConeFactor factor(pose_key, contact_wrench_key, cost_model,
+                                   mu, comPc, slope);
+  const Pose3 upright(Rot3(), Point3(0, 0, 1));
+  EXPECT(assert_equal(
+      gtsam::Vector1(0),
+      factor.evaluateError(
+          upright, (gtsam::Vector(6) << 0, 0, 0, -1, 0, 1).finished()),
+      1e-9));
+  EXPECT(assert_equal(
+      gtsam::Vector1(1.0 - (1 + mu * mu) * 0.5),
+      factor.evaluateError(
+          upright, (gtsam::Vector(6) << 0, 0, 0, 0, 0, 1).finished()),
+      1e-9));
+
+  // Jacobians, on a curved terrain where the normal depends on the pose.
+  gtsam::Matrix bump(3, 3);
+  bump << 0, 0.1, 0, 0.2, 0.5, 0.1, 0, 0.3, 0.1;
+  auto curved =
+      std::make_shared<HeightMap>(bump, gtsam::Point2(-1, -1), 1.0);
+  TerrainFrictionConeFactor curved_factor(pose_key, contact_wrench_key,
+                                          cost_model, mu, comPc, curved);
+  gtsam::Values values;
+  values.insert(pose_key, pose);
+  values.insert(contact_wrench_key, wrench);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(curved_factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
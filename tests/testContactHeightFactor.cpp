@@ -185,6 +185,31 @@ TEST(ContactHeightFactor, Optimization) {
       assert_equal(factor.unwhitenedError(results), gtsam::Vector1(0), 1e-3));
 }
 
+// On a sloped terrain, the error is the height above it.
+TEST(TerrainHeightFactor, Error) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  gtsam::LabeledSymbol pose_key = gtsam::LabeledSymbol('p', 0, 0);
+
+  // The plane z = 0.1 + 0.2 x - 0.3 y.
+  gtsam::Matrix heights(2, 2);
+  heights << 0.1, 0.1 - 3.0, 0.1 + 2.0, 0.1 + 2.0 - 3.0;
+  auto terrain = std::make_shared<HeightMap>(heights, gtsam::Point2(0, 0),
+                                             10.0);
+  const Point3 comPc(0, 0, -0.5);
+  TerrainHeightFactor factor(pose_key, cost_model, comPc, terrain);
+
+  gtsam::Values values;
+  values.insert(pose_key, Pose3(Rot3(), Point3(1., 2., 1.)));
+  EXPECT(assert_equal(Vector1(0.5 - (0.1 + 0.2 - 0.6)),
+                      factor.unwhitenedError(values), 1e-9));
+
+  gtsam::Values values_a;
+  values_a.insert(pose_key,
+                  Pose3(Rot3::RzRyRx(M_PI / 8.0, M_PI / 12.0, 5 * M_PI / 6.0),
+                        Point3(4., 3., 3.)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values_a, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
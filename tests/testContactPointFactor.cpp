@@ -183,6 +183,21 @@ TEST(ContactPoseFactor, Jacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
 }
 
+// The precomputed adjoint must also hold for a rotated contact frame.
+TEST(ContactPoseFactor, JacobiansRotatedContact) {
+  Key link_pose_key = gtdynamics::PoseKey(0, 0),
+      point_key = gtdynamics::PoseKey(1, 0);
+  Pose3 comTcontact(Rot3::RzRyRx(0.3, -0.5, 0.7), Point3(0.1, -0.2, 0.3));
+  ContactPoseFactor factor(link_pose_key, point_key, kPoseModel, comTcontact);
+
+  Values values;
+  values.insert<Pose3>(link_pose_key,
+                       Pose3(Rot3::RzRyRx(-0.4, 0.2, 0.1), Point3(1, 2, 3)));
+  values.insert<Pose3>(point_key,
+                       Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 2)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
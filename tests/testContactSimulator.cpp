@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactSimulator.cpp
+ * @brief Test contact-constrained simulation of a quadruped.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <map>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+const Point3 kContactInCom(0, 0, -0.07);
+
+// Zero torques for all joints.
+Values ZeroTorques(const Robot& robot) {
+  Values torques;
+  for (auto&& joint : robot.joints()) InsertTorque(&torques, joint->id(), 0.0);
+  return torques;
+}
+
+// Return whether contact points in spec have zero linear acceleration.
+bool ContactsHold(const FootContactConstraintSpec& spec,
+                  const Values& values) {
+  bool hold = true;
+  std::map<int, int> num_contacts;
+  for (auto&& cp : spec.contactPoints()) {
+    const int i = cp.link->id();
+    const Pose3 cTcom(gtsam::Rot3(), -cp.point);
+    const gtsam::Vector3 accel =
+        (cTcom.AdjointMap() * TwistAccel(values, i)).tail<3>();
+    hold &= assert_equal(gtsam::Vector3::Zero(), accel, 1e-6);
+    hold &= values.exists(ContactWrenchKey(i, num_contacts[i]++));
+  }
+  return hold;
+}
+
+TEST(ContactSimulator, a1) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const std::vector<LinkSharedPtr> all_feet = {
+      robot.link("FR_lower"), robot.link("FL_lower"), robot.link("RR_lower"),
+      robot.link("RL_lower")};
+  FootContactConstraintSpec stance(all_feet, kContactInCom);
+  const std::vector<LinkSharedPtr> diagonal = {robot.link("FR_lower"),
+                                               robot.link("RL_lower")};
+  FootContactConstraintSpec trot(diagonal, kContactInCom);
+
+  ContactSimulator simulator(robot, "trunk", Values(), kGravity);
+  const Values torques = ZeroTorques(robot);
+  const double dt = 0.001;
+
+  // All feet on the ground.
+  simulator.setContacts(stance);
+  simulator.step(torques, dt);
+  EXPECT(ContactsHold(stance, simulator.getValues()));
+
+  // Switch contact mode, and back.
+  simulator.setContacts(trot);
+  simulator.step(torques, dt);
+  EXPECT(ContactsHold(trot, simulator.getValues()));
+  simulator.setContacts(stance);
+  simulator.step(torques, dt);
+  EXPECT(ContactsHold(stance, simulator.getValues()));
+
+  // In flight, from rest with zero torques, everything falls with gravity.
+  simulator.reset();
+  simulator.clearContacts();
+  simulator.step(torques, dt);
+  const auto trunk = robot.link("trunk");
+  const Pose3 wTb = trunk->bMcom();
+  Vector6 expected_accel;
+  expected_accel << 0, 0, 0, wTb.rotation().transpose() * kGravity;
+  EXPECT(assert_equal(expected_accel,
+                      TwistAccel(simulator.getValues(), trunk->id()), 1e-6));
+  for (auto&& joint : robot.joints()) {
+    EXPECT_DOUBLES_EQUAL(0.0, JointAccel(simulator.getValues(), joint->id()),
+                         1e-6);
+  }
+  EXPECT(assert_equal(Vector6(dt * expected_accel), simulator.baseTwist(),
+                      1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -13,10 +13,13 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/Initializer.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
@@ -29,9 +32,11 @@
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
 #include <gtsam/slam/PriorFactor.h>
 
 #include <iostream>
+#include <map>
 
 using namespace gtdynamics;
 
@@ -81,6 +86,32 @@ TEST(linearDynamicsFactorGraph, simple_urdf_eq_mass_values) {
   EXPECT(assert_equal(1.0, Torque(result_id, j, t), 1e-3));
 }
 
+// Test that the elimination ordering cached at one time step gives the same
+// result at another time step.
+TEST(linearDynamicsFactorGraph, cached_ordering) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  auto j = robot.joint("j1")->id();
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+
+  for (int t : {3, 5, 0}) {
+    Values values;
+    InsertPose(&values, l1->id(), t, l1->bMcom());
+    InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+    InsertJointAngle(&values, j, t, 0.1 * t);
+    InsertJointVel(&values, j, t, 0.2);
+    Values known_torques = robot.forwardKinematics(values, t, l1->name());
+    InsertTorque(&known_torques, j, t, 1.0);
+
+    DynamicsGraph fresh_builder(simple_urdf_eq_mass::gravity,
+                                simple_urdf_eq_mass::planar_axis);
+    Values expected = fresh_builder.linearSolveFD(robot, t, known_torques);
+    Values actual = graph_builder.linearSolveFD(robot, t, known_torques);
+    EXPECT(assert_equal(expected, actual, 1e-9));
+  }
+}
+
 Values zero_values(const Robot& robot, size_t t, bool insert_accels = false) {
   Values values;
   for (auto&& joint : robot.joints()) {
@@ -309,6 +340,208 @@ TEST(collocationFactors, simple_urdf) {
   EXPECT(assert_equal(2.5, JointVel(mp_trapezoidal_result, j, t + 1)));
 }
 
+// Hermite-Simpson collocation is exact for a linear acceleration.
+TEST(collocationFactors, hermite_simpson) {
+  DynamicsGraph graph_builder;
+  auto robot = simple_urdf::getRobot();
+  double dt = 1;
+  int t = 0, phase = 0;
+  int j = robot.joints()[0]->id();
+
+  NonlinearFactorGraph prior_factors;
+  prior_factors.addPrior(JointAngleKey(j, t), 1.0,
+                         graph_builder.opt().prior_q_cost_model);
+  prior_factors.addPrior(JointVelKey(j, t), 1.0,
+                         graph_builder.opt().prior_qv_cost_model);
+  prior_factors.addPrior(JointAccelKey(j, t), 1.0,
+                         graph_builder.opt().prior_qa_cost_model);
+  prior_factors.addPrior(JointAccelKey(j, t + 1), 2.0,
+                         graph_builder.opt().prior_qa_cost_model);
+
+  Values init_values;
+  for (int k = t; k <= t + 1; k++) {
+    InsertJointAngle(&init_values, j, k, 0.0);
+    InsertJointVel(&init_values, j, k, 0.0);
+    InsertJointAccel(&init_values, j, k, 0.0);
+  }
+
+  // a(t) = 1 + t, v(t) = 1 + t + t^2 / 2, q(t) = 1 + t + t^2 / 2 + t^3 / 6.
+  NonlinearFactorGraph graph = graph_builder.collocationFactors(
+      robot, t, dt, CollocationScheme::HermiteSimpson);
+  graph.add(prior_factors);
+  Values result = gtsam::GaussNewtonOptimizer(graph, init_values).optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(result, j, t + 1), 1e-6));
+  EXPECT(assert_equal(2.5, JointVel(result, j, t + 1), 1e-6));
+
+  // The same with dt as a variable.
+  init_values.insert(PhaseKey(phase), 0.5);
+  prior_factors.addPrior(PhaseKey(phase), dt,
+                         graph_builder.opt().time_cost_model);
+  NonlinearFactorGraph mp_graph = graph_builder.multiPhaseCollocationFactors(
+      robot, t, phase, CollocationScheme::HermiteSimpson);
+  mp_graph.add(prior_factors);
+  Values mp_result =
+      gtsam::GaussNewtonOptimizer(mp_graph, init_values).optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(mp_result, j, t + 1), 1e-6));
+  EXPECT(assert_equal(2.5, JointVel(mp_result, j, t + 1), 1e-6));
+}
+
+// The banded collocation factor has the errors of the per-joint factors.
+TEST(collocationFactors, banded) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  const int t = 2, phase = 1;
+  OptimizerSetting opt;
+  DynamicsGraph graph_builder(opt);
+  opt.banded_collocation = true;
+  DynamicsGraph banded_builder(opt);
+
+  Values values;
+  double x = 0.1;
+  for (auto &&joint : robot.joints()) {
+    int j = joint->id();
+    for (int k = t; k <= t + 1; k++) {
+      InsertJointAngle(&values, j, k, x += 0.3);
+      InsertJointVel(&values, j, k, x -= 0.7);
+      InsertJointAccel(&values, j, k, x += 0.2);
+    }
+  }
+  values.insert(PhaseKey(phase), 0.05);
+
+  for (auto collocation :
+       {CollocationScheme::Euler, CollocationScheme::Trapezoidal}) {
+    auto expected = graph_builder.collocationFactors(robot, t, 0.05,
+                                                     collocation);
+    auto actual = banded_builder.collocationFactors(robot, t, 0.05,
+                                                    collocation);
+    EXPECT_LONGS_EQUAL(1, actual.size());
+    EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+    auto factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(actual.at(0));
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+
+    auto mp_expected = graph_builder.multiPhaseCollocationFactors(
+        robot, t, phase, collocation);
+    auto mp_actual = banded_builder.multiPhaseCollocationFactors(
+        robot, t, phase, collocation);
+    EXPECT_LONGS_EQUAL(1, mp_actual.size());
+    EXPECT_DOUBLES_EQUAL(mp_expected.error(values), mp_actual.error(values),
+                         1e-9);
+    factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(mp_actual.at(0));
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-3);
+  }
+}
+
+// Phase durations are eliminated after all time-step variables.
+TEST(collocationFactors, PhaseDurationsLastOrdering) {
+  DynamicsGraph graph_builder(OptimizerSetting{});
+  NonlinearFactorGraph graph;
+  for (int t = 0; t < 10; t++) {
+    graph.add(graph_builder.jointMultiPhaseCollocationFactors(
+        0, t, t < 5 ? 0 : 1, CollocationScheme::Trapezoidal));
+  }
+
+  const auto ordering = DynamicsGraph::PhaseDurationsLastOrdering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  const gtsam::KeySet last(ordering.end() - 2, ordering.end());
+  EXPECT(gtsam::KeySet({PhaseKey(0), PhaseKey(1)}) == last);
+}
+
+// Keys are ordered by time step, and from the leaves to the root.
+TEST(dynamicsTrajectoryFG, TrajectoryOrdering) {
+  auto robot = simple_rr::getRobot();
+  DynamicsGraph graph_builder(OptimizerSetting{});
+  auto graph = graph_builder.trajectoryFG(robot, 3, 0.1);
+
+  const auto ordering = DynamicsGraph::TrajectoryOrdering(robot, graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  std::map<gtsam::Key, size_t> position;
+  for (size_t n = 0; n < ordering.size(); n++) {
+    position[ordering[n]] = n;
+    if (n > 0) {
+      EXPECT(DynamicsSymbol(ordering[n - 1]).time() <=
+             DynamicsSymbol(ordering[n]).time());
+    }
+  }
+  const int root = robot.link("link_0")->id();
+  const int leaf = robot.link("link_2")->id();
+  for (int t = 0; t <= 3; t++) {
+    EXPECT(position.at(PoseKey(leaf, t)) < position.at(PoseKey(root, t)));
+  }
+}
+
+// Joint values of all time steps, as the rows of a matrix.
+TEST(DynamicsGraph, jointValuesMatrices) {
+  auto robot = simple_rr::getRobot();
+  const size_t num_steps = 3;
+  Values values;
+  for (size_t t = 0; t < num_steps; t++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, j + 0.1 * t);
+      InsertJointVel(&values, j, t, j + 0.2 * t);
+      InsertJointAccel(&values, j, t, j + 0.3 * t);
+      InsertTorque(&values, j, t, j + 0.4 * t);
+    }
+  }
+
+  const auto q = DynamicsGraph::jointAnglesMatrix(robot, values, num_steps);
+  const auto v = DynamicsGraph::jointVelsMatrix(robot, values, num_steps);
+  const auto a = DynamicsGraph::jointAccelsMatrix(robot, values, num_steps);
+  const auto T = DynamicsGraph::jointTorquesMatrix(robot, values, num_steps);
+  EXPECT_LONGS_EQUAL(num_steps, q.rows());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), q.cols());
+  for (size_t t = 0; t < num_steps; t++) {
+    EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, values, t),
+                        Vector(q.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointVels(robot, values, t),
+                        Vector(v.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointAccels(robot, values, t),
+                        Vector(a.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointTorques(robot, values, t),
+                        Vector(T.row(t).transpose())));
+  }
+
+  // A missing variable is reported.
+  THROWS_EXCEPTION(
+      DynamicsGraph::jointAnglesMatrix(robot, values, num_steps + 1));
+}
+
+// Condensing wrenches and twist accelerations gives the same LM iterates.
+TEST(dynamicsTrajectoryFG, CondensedOrdering) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 3;
+  Values known_values = zero_values(robot, 0);
+  for (int k = 0; k <= num_steps; k++) {
+    for (auto&& joint : robot.joints()) {
+      InsertTorque(&known_values, joint->id(), k, 1.0 + k);
+    }
+  }
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+
+  const gtsam::Ordering condensed =
+      DynamicsGraph::CondensedOrdering(robot, graph);
+  EXPECT(!condensed.empty());
+  for (gtsam::Key key : condensed) {
+    const std::string label = DynamicsSymbol(key).label();
+    EXPECT(label == "F" || label == "A");
+  }
+
+  const Values init_values =
+      Initializer().ZeroValuesTrajectory(robot, num_steps);
+  gtsam::MutableLMParams params;
+  gtsam::MutableLMOptimizer expected(graph, init_values, params);
+  params.condensed = condensed;
+  gtsam::MutableLMOptimizer actual(graph, init_values, params);
+  expected.iterate();
+  actual.iterate();
+  EXPECT(assert_equal(expected.values(), actual.values(), 1e-6));
+  EXPECT(assert_equal(expected.optimize(), actual.optimize(), 1e-6));
+}
+
 // test forward dynamics of a trajectory
 TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   auto robot = simple_urdf_eq_mass::getRobot();
@@ -420,6 +653,30 @@ TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   EXPECT(assert_equal(3.0, JointAccel(mp_trapezoidal_result, j, 2)));
 }
 
+// The trajectory graph has the factors of each step in time order, whether or
+// not they were created in parallel.
+TEST(dynamicsTrajectoryFG, factor_order) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 20;
+  const double dt = 0.1;
+
+  NonlinearFactorGraph expected;
+  for (int t = 0; t <= num_steps; t++) {
+    expected.add(graph_builder.dynamicsFactorGraph(robot, t));
+    if (t < num_steps) {
+      expected.add(graph_builder.collocationFactors(robot, t, dt));
+    }
+  }
+  auto actual = graph_builder.trajectoryFG(robot, num_steps, dt);
+  CHECK(expected.size() == actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT(expected.at(i)->keys() == actual.at(i)->keys());
+  }
+  EXPECT(assert_equal(expected, actual));
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rr) {
   // Load the robot from urdf file
@@ -475,6 +732,34 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rr) {
     EXPECT(assert_equal(0, Torque(results, joint->id())));
 }
 
+// In contact-implicit mode, complementarity replaces the contact constraints.
+TEST(dynamicsFactorGraph_Contacts, contact_implicit) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+
+  OptimizerSetting opt;
+  auto graph =
+      DynamicsGraph(opt, gravity).dynamicsFactorGraph(robot, 0, contact_points);
+  opt.contact_implicit = true;
+  opt.complementarity_relaxation = 0.1;
+  auto implicit_graph =
+      DynamicsGraph(opt, gravity).dynamicsFactorGraph(robot, 0, contact_points);
+
+  // The height, twist and acceleration factors are replaced by one factor.
+  EXPECT_LONGS_EQUAL(graph.size() - 2, implicit_graph.size());
+  size_t num_complementarity = 0;
+  for (auto &&factor : implicit_graph) {
+    if (auto complementarity =
+            std::dynamic_pointer_cast<ContactComplementarityFactor>(factor)) {
+      EXPECT_DOUBLES_EQUAL(0.1, complementarity->epsilon(), 1e-12);
+      num_complementarity++;
+    }
+  }
+  EXPECT_LONGS_EQUAL(1, num_complementarity);
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_biped) {
   // Load the robot from urdf file
@@ -539,6 +824,52 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_biped) {
   EXPECT(assert_equal(187.8615, normal_force, 1e-2));
 }
 
+// Patching one step of a trajectory graph for new contacts gives the errors of
+// the graph built with them.
+TEST(dynamicsFactorGraph_Contacts, contact_switch_patch) {
+  Robot biped = CreateRobotFromFile(kUrdfPath + std::string("biped.urdf"));
+  PointOnLinks both, lower0;
+  both.emplace_back(biped.link("lower0"), gtsam::Point3(0.14, 0, 0));
+  both.emplace_back(biped.link("lower2"), gtsam::Point3(0.14, 0, 0));
+  lower0.push_back(both[0]);
+
+  gtsam::Vector3 gravity(0, 0, -9.81);
+  DynamicsGraph graph_builder(gravity);
+  const double mu = 1.0, dt = 0.1;
+  auto build = [&](const PointOnLinks &contacts_1) {
+    NonlinearFactorGraph graph;
+    graph.add(graph_builder.dynamicsFactorGraph(biped, 0, both, mu));
+    graph.add(graph_builder.dynamicsFactorGraph(biped, 1, contacts_1, mu));
+    graph.add(graph_builder.dynamicsFactorGraph(biped, 2, both, mu));
+    return graph;
+  };
+  NonlinearFactorGraph graph = build(both), expected = build(lower0);
+  const size_t num_dynamics = graph.size();
+  for (int k = 0; k < 2; k++) {
+    graph.add(graph_builder.collocationFactors(biped, k, dt));
+    expected.add(graph_builder.collocationFactors(biped, k, dt));
+  }
+
+  Initializer initializer;
+  Values values;
+  for (int k = 0; k < 3; k++) {
+    values.insert(initializer.ZeroValues(biped, k, 0.1, both));
+  }
+
+  GraphPatch patch;
+  graph_builder.contactSwitchPatch(graph, biped, 1, both, lower0, mu, &patch);
+  EXPECT(!patch.remove.empty());
+  for (size_t i : patch.remove) EXPECT(i < num_dynamics);
+  patch.apply(&graph);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), graph.error(values), 1e-6);
+
+  // Nothing changes if the contacts stay the same.
+  GraphPatch unchanged;
+  graph_builder.contactSwitchPatch(graph, biped, 0, both, both, mu,
+                                   &unchanged);
+  EXPECT(unchanged.empty());
+}
+
 // check joint limit factors
 TEST(jointlimitFactors, simple_urdf) {
   auto robot = simple_urdf::getRobot();
@@ -607,6 +938,33 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
     EXPECT(assert_equal(0, Torque(results, joint->id())));
 }
 
+// Factors made from an arena are the same, and outlive the arena handle.
+TEST(DynamicsGraph, factor_arena) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  OptimizerSetting opt;
+  opt.closed_form_jacobians = true;
+  DynamicsGraph graph_builder(opt, gtsam::Vector3(0, 0, -9.8));
+  const NonlinearFactorGraph expected =
+      graph_builder.dynamicsFactorGraph(robot, 0, contact_points, 1.0);
+
+  NonlinearFactorGraph graph;
+  {
+    FactorArena arena;
+    graph_builder.setFactorArena(arena);
+    graph = graph_builder.dynamicsFactorGraph(robot, 0, contact_points, 1.0);
+    EXPECT(arena.bytesAllocated() > 0);
+    graph_builder.clearFactorArena();
+  }
+  EXPECT(!graph_builder.factorArena());
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+
+  Values values = Initializer().ZeroValues(robot, 0, 0.1, contact_points);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), graph.error(values), 1e-9);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
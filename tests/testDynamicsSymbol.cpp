@@ -84,6 +84,53 @@ TEST(DynamicsSymbol, SimpleSymbol) {
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)DynamicsSymbol(key));
 }
 
+TEST(DynamicsSymbol, KeyNameCache) {
+  const KeyVector keys{DynamicsSymbol::JointSymbol("q", 1, 10),
+                       DynamicsSymbol::LinkSymbol("p", 2, 3),
+                       DynamicsSymbol::LinkJointSymbol("F", 1, 2, 10),
+                       DynamicsSymbol::SimpleSymbol("ti", 10)};
+  const std::vector<std::string> names = GTDFormatKeys(keys);
+  EXPECT_LONGS_EQUAL(keys.size(), names.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT(assert_equal(GTDKeyFormatter(keys[i]), names[i]));
+  }
+
+  KeyNameCache cache({keys[0], keys[1]});
+  EXPECT_LONGS_EQUAL(2, cache.size());
+  cache.insert(keys);
+  EXPECT_LONGS_EQUAL(4, cache.size());
+  const Key other = DynamicsSymbol::JointSymbol("v", 3, 0);
+  EXPECT(assert_equal(std::string("v(3)0"), cache(other)));
+  EXPECT_LONGS_EQUAL(5, cache.size());
+  EXPECT(assert_equal(names[2], cache.formatter()(keys[2])));
+}
+
+TEST(DynamicsSymbol, KeyEncoding) {
+  // DynamicsSymbol keys are the keys of the default encoding.
+  using Default = DynamicsKeyEncoding;
+  static_assert(Default::Encode("q", Default::kNoRobot, Default::kNoLink, 1,
+                                10) == 0x0071FF010000000A,
+                "default encoding differs from DynamicsSymbol");
+  const Key key = DynamicsSymbol::LinkJointSymbol("F", 1, 2, 10);
+  EXPECT_LONGS_EQUAL((long)key, (long)Default::Encode("F", 0, 1, 2, 10));
+  EXPECT(assert_equal(GTDKeyFormatter(key), Default::Format(key)));
+
+  // The wide encoding has a robot id, and more links and joints.
+  using Wide = WideKeyEncoding;
+  constexpr Key wide = Wide::Encode("F", 3, 300, 1000, 12);
+  static_assert(Wide::Robot(wide) == 3 && Wide::Link(wide) == 300 &&
+                    Wide::Joint(wide) == 1000 && Wide::Time(wide) == 12,
+                "wide encoding does not round trip");
+  const Wide::Fields fields = Wide::Decode(wide);
+  EXPECT_LONGS_EQUAL('F', fields.c2);
+  EXPECT_LONGS_EQUAL(0, fields.c1);
+  EXPECT_LONGS_EQUAL(13, Wide::Time(Wide::WithTime(wide, 13)));
+  EXPECT_LONGS_EQUAL(1000, Wide::Joint(Wide::WithTime(wide, 13)));
+  EXPECT(assert_equal(std::string("F<3>[300](1000)12"), Wide::Format(wide)));
+  EXPECT(assert_equal(std::string("q<0>(2)5"),
+                      Wide::Format(Wide::Encode("q", 0, Wide::kNoLink, 2, 5))));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testExecutionContext.cpp
+ * @brief Test parallel loops of an execution context.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/ExecutionContext.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+
+// Every iteration runs exactly once, for any number of threads.
+TEST(ExecutionContext, parallelFor) {
+  for (bool deterministic : {false, true}) {
+    for (size_t num_threads : {0, 1, 3, 8}) {
+      ExecutionContext execution = ExecutionContext::Threads(num_threads);
+      execution.deterministic = deterministic;
+      std::vector<std::atomic<int>> calls(100);
+      execution.parallelFor(calls.size(), [&](size_t i) { calls[i]++; });
+      for (auto &&count : calls) EXPECT_LONGS_EQUAL(1, count);
+    }
+  }
+  EXPECT(ExecutionContext::Threads(0).numThreads() >= 1);
+  EXPECT(!ExecutionContext::InParallel());
+}
+
+// Deterministic loops give each thread one contiguous block, in order.
+TEST(ExecutionContext, deterministic) {
+  ExecutionContext execution = ExecutionContext::Threads(4);
+  execution.deterministic = true;
+  std::vector<std::thread::id> ids(10);
+  execution.parallelFor(ids.size(),
+                        [&](size_t i) { ids[i] = std::this_thread::get_id(); });
+  EXPECT(ids[0] == std::this_thread::get_id());
+  size_t num_blocks = 1;
+  for (size_t i = 1; i < ids.size(); i++) num_blocks += ids[i] != ids[i - 1];
+  EXPECT_LONGS_EQUAL(4, num_blocks);
+}
+
+// Nested loops run serially on the worker, without more threads.
+TEST(ExecutionContext, nested) {
+  const ExecutionContext execution = ExecutionContext::Threads(4);
+  std::vector<int> serial(4, 0);
+  execution.parallelFor(4, [&](size_t i) {
+    const std::thread::id outer = std::this_thread::get_id();
+    bool same_thread = ExecutionContext::InParallel();
+    execution.parallelFor(8, [&](size_t) {
+      same_thread = same_thread && std::this_thread::get_id() == outer;
+    });
+    serial[i] = same_thread;
+  });
+  for (int nested_serial : serial) EXPECT_LONGS_EQUAL(1, nested_serial);
+}
+
+TEST(ExecutionContext, exceptions) {
+  const ExecutionContext execution = ExecutionContext::Threads(4);
+  THROWS_EXCEPTION(execution.parallelFor(20, [](size_t i) {
+    if (i == 13) throw std::runtime_error("thirteen");
+  }));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
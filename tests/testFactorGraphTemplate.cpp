@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorGraphTemplate.cpp
+ * @brief Test instantiating factor graphs at other time steps.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorGraphTemplate.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/expressions.h>
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+/// Time steps and phases are shifted separately.
+TEST(FactorGraphTemplate, ShiftedKey) {
+  EXPECT_LONGS_EQUAL(JointAngleKey(2, 7), ShiftedKey(JointAngleKey(2, 3), 4));
+  EXPECT_LONGS_EQUAL(PoseKey(1, 5), ShiftedKey(PoseKey(1, 0), 5, 2));
+  EXPECT_LONGS_EQUAL(PhaseKey(3), ShiftedKey(PhaseKey(1), 5, 2));
+}
+
+/// Expression factors are mapped, other factors are rekeyed.
+TEST(FactorGraphTemplate, instantiate) {
+  auto model = noiseModel::Isotropic::Sigma(1, 0.1);
+  const Key q0 = JointAngleKey(0, 0), q1 = JointAngleKey(0, 1);
+  Double_ q0_expr(q0), dt_expr(PhaseKey(0));
+
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<PriorFactor<double>>(q0, 1.0, model);
+  graph.emplace_shared<ExpressionFactor<double>>(model, 0.0,
+                                                 q0_expr * dt_expr);
+  EXPECT(FactorGraphTemplate::IsRekeyable(graph.at(0)));
+  EXPECT(!FactorGraphTemplate::IsRekeyable(graph.at(1)));
+
+  FactorGraphTemplate graph_template(graph);
+  auto shifted = graph_template.instantiate(1, 1);
+  EXPECT_LONGS_EQUAL(2, shifted.size());
+  EXPECT(KeyVector{q1} == shifted.at(0)->keys());
+  EXPECT(std::dynamic_pointer_cast<KeyMappedFactor>(shifted.at(1)));
+
+  Values values, shifted_values;
+  values.insert(q0, 2.0);
+  values.insert(PhaseKey(0), 0.5);
+  shifted_values.insert(q1, 2.0);
+  shifted_values.insert(PhaseKey(1), 0.5);
+  EXPECT_DOUBLES_EQUAL(graph.error(values), shifted.error(shifted_values),
+                       1e-9);
+  auto linear = shifted.linearize(shifted_values);
+  auto expected = graph.linearize(values);
+  EXPECT(assert_equal(expected->jacobian().first, linear->jacobian().first,
+                      1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFeasibilityRestoration.cpp
+ * @brief Test the feasibility restoration phase of constrained optimizers.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/ConstraintViolations.h>
+#include <gtdynamics/optimizer/FeasibilityRestoration.h>
+#include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(FeasibilityRestoration, RestoreFeasibility) {
+  using namespace constrained_example;
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+  InequalityConstraints inequality_constraints;
+  inequality_constraints.emplace_shared<DoubleExpressionInequality>(
+      x1 + 1.0, 1.0);  // x1 >= -1
+
+  const Symbol x3_key('x', 3);
+  Values values;
+  values.insert(x1_key, -2.0);
+  values.insert(x2_key, 2.0);
+  values.insert(x3_key, 5.0);
+  EXPECT(ConstraintViolations(constraints, values).norm() > 1.0);
+
+  // Disabled, or below the threshold: unchanged.
+  FeasibilityRestorationParameters params;
+  EXPECT(assert_equal(values, RestoreFeasibility(constraints,
+                                                 inequality_constraints,
+                                                 values, params)));
+  params.enabled = true;
+  params.violation_threshold = 100.0;
+  EXPECT(assert_equal(values, RestoreFeasibility(constraints,
+                                                 inequality_constraints,
+                                                 values, params)));
+
+  params.violation_threshold = 0.0;
+  ConstrainedOptResult intermediate;
+  const Values restored = RestoreFeasibility(
+      constraints, inequality_constraints, values, params, &intermediate);
+  EXPECT(ConstraintViolations(constraints, restored).norm() < 1e-4);
+  EXPECT(ConstraintViolations(inequality_constraints, restored).norm() <
+         1e-4);
+  EXPECT_DOUBLES_EQUAL(5.0, restored.at<double>(x3_key), 1e-9);
+  EXPECT(intermediate.counts.at("restoration_iterations") > 0);
+  EXPECT(intermediate.phase_times.count("restoration"));
+}
+
+// Restoring first still converges to the constrained optimum.
+TEST(FeasibilityRestoration, Optimizers) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+
+  PenaltyMethodParameters penalty_params;
+  penalty_params.restoration.enabled = true;
+  ConstrainedOptResult penalty_intermediate;
+  const Values penalty_results = PenaltyMethodOptimizer(penalty_params)
+      .optimize(graph, constraints, init_values, &penalty_intermediate);
+  EXPECT(assert_equal(gt_results, penalty_results, 1e-3));
+  EXPECT(penalty_intermediate.counts.count("restoration_iterations"));
+
+  AugmentedLagrangianParameters augl_params;
+  augl_params.restoration.enabled = true;
+  const Values augl_results = AugmentedLagrangianOptimizer(augl_params)
+      .optimize(graph, constraints, init_values);
+  EXPECT(assert_equal(gt_results, augl_results, 1e-4));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
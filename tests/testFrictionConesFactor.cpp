@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFrictionConesFactor.cpp
+ * @brief Test the batched friction cone factor.
+ * @author Alejandro Escontrela
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/FrictionConesFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using gtsam::LabeledSymbol;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+const Vector3 gravity(0, 0, -9.8);
+const double mu = 0.8;
+
+// Three contacts: sticking, slipping, and slipping on a rotated link.
+const std::vector<std::pair<gtsam::Key, gtsam::Key>> contact_keys{
+    {LabeledSymbol('p', 0, 0), LabeledSymbol('C', 0, 0)},
+    {LabeledSymbol('p', 1, 0), LabeledSymbol('C', 1, 0)},
+    {LabeledSymbol('p', 2, 0), LabeledSymbol('C', 2, 0)}};
+
+gtsam::Values values() {
+  gtsam::Values values;
+  values.insert(contact_keys[0].first, Pose3(Rot3(), Point3(0, 0, 1)));
+  values.insert(contact_keys[0].second,
+                (gtsam::Vector(6) << 0, 0, 0, 0.1, 0.2, 1).finished());
+  values.insert(contact_keys[1].first, Pose3(Rot3(), Point3(1, 0, 1)));
+  values.insert(contact_keys[1].second,
+                (gtsam::Vector(6) << 0, 0, 0, 4, -2, 3).finished());
+  values.insert(contact_keys[2].first,
+                Pose3(Rot3::RzRyRx(0.3, 0.2, 1.2), Point3(2, 0, 1)));
+  values.insert(contact_keys[2].second,
+                (gtsam::Vector(6) << 0, 0, 0, 1, 0.5, 1).finished());
+  return values;
+}
+}  // namespace example
+
+/// The quadratic cones have the errors of the single-contact factors.
+TEST(FrictionConesFactor, quadratic) {
+  FrictionConesFactor factor(example::contact_keys, example::cost_model,
+                             example::mu, example::gravity);
+  EXPECT_LONGS_EQUAL(3, factor.numContacts());
+  EXPECT_LONGS_EQUAL(3, factor.dim());
+
+  const auto values = example::values();
+  const gtsam::Vector error = factor.unwhitenedError(values);
+  for (size_t i = 0; i < 3; i++) {
+    ContactDynamicsFrictionConeFactor single(
+        example::contact_keys[i].first, example::contact_keys[i].second,
+        example::cost_model, example::mu, example::gravity);
+    EXPECT(assert_equal(single.unwhitenedError(values), error.segment(i, 1),
+                        1e-9));
+  }
+  EXPECT_DOUBLES_EQUAL(0, error(0), 1e-9);
+  EXPECT(error(1) > 0);
+  EXPECT(error(2) > 0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+}
+
+/// The pyramid has four linear rows per contact.
+TEST(FrictionConesFactor, pyramid) {
+  FrictionConesFactor factor(example::contact_keys, example::cost_model,
+                             example::mu, example::gravity, true);
+  EXPECT_LONGS_EQUAL(4, factor.rowsPerContact());
+  EXPECT_LONGS_EQUAL(12, factor.dim());
+
+  const auto values = example::values();
+  const gtsam::Vector error = factor.unwhitenedError(values);
+  // The first contact is inside the pyramid, the second one is only outside
+  // of the +x face: 4 - 0.8 * 3 = 1.6.
+  EXPECT(assert_equal(gtsam::Vector4::Zero().eval(),
+                      gtsam::Vector(error.segment(0, 4)), 1e-9));
+  EXPECT(assert_equal((gtsam::Vector(4) << 1.6, 0, 0, 0).finished(),
+                      gtsam::Vector(error.segment(4, 4)), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+}
+
+/// The row noise model must be one-dimensional and diagonal.
+TEST(FrictionConesFactor, noiseModel) {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(2, 1.0);
+  THROWS_EXCEPTION(std::make_shared<FrictionConesFactor>(
+      example::contact_keys, model, example::mu, example::gravity));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
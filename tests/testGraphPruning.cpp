@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphPruning.cpp
+ * @brief Test substituting known variables out of factor graphs.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/GraphPruning.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::BetweenFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::PriorFactor;
+using gtsam::Values;
+
+// Pinned variables are substituted out, and the solution is unchanged.
+TEST(PruneKnownVariables, priors) {
+  const gtsam::Key x = 1, y = 2, z = 3;
+  auto tight = gtsam::noiseModel::Isotropic::Sigma(1, 1e-6);
+  auto loose = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<PriorFactor<double>>(x, 1.0, tight);
+  graph.emplace_shared<BetweenFactor<double>>(x, y, 2.0, loose);
+  graph.emplace_shared<PriorFactor<double>>(y, 0.0, loose);
+  graph.emplace_shared<BetweenFactor<double>>(y, z, 1.0, loose);
+
+  const PrunedGraph pruned = PruneKnownVariables(graph);
+  EXPECT_LONGS_EQUAL(1, pruned.known.size());
+  EXPECT_DOUBLES_EQUAL(1.0, pruned.known.at<double>(x), 1e-12);
+  EXPECT_LONGS_EQUAL(1, pruned.num_dropped);
+  EXPECT_LONGS_EQUAL(3, pruned.graph.size());
+  EXPECT_LONGS_EQUAL(2, pruned.graph.keys().size());
+
+  Values init;
+  init.insert(y, 0.0);
+  init.insert(z, 0.0);
+  Values result =
+      gtsam::LevenbergMarquardtOptimizer(pruned.graph, init).optimize();
+  EXPECT_DOUBLES_EQUAL(1.5, result.at<double>(y), 1e-6);
+  EXPECT_DOUBLES_EQUAL(2.5, result.at<double>(z), 1e-6);
+
+  // With known, the result is the optimum of the original graph.
+  result.insert(pruned.known);
+  init.insert(x, 0.0);
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+  EXPECT(assert_equal(expected, result, 1e-5));
+}
+
+// Known values take precedence, and factors on known variables only go.
+TEST(PruneKnownVariables, knownValues) {
+  const gtsam::Key x = 1, y = 2;
+  auto tight = gtsam::noiseModel::Isotropic::Sigma(1, 1e-6);
+  auto loose = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<PriorFactor<double>>(x, 1.0, tight);
+  graph.emplace_shared<BetweenFactor<double>>(x, y, 2.0, loose);
+
+  Values known;
+  known.insert(x, 0.5);
+  known.insert(y, 3.0);
+  const PrunedGraph pruned = PruneKnownVariables(graph, known);
+  EXPECT(assert_equal(known, pruned.known));
+  EXPECT_LONGS_EQUAL(2, pruned.num_dropped);
+  EXPECT_LONGS_EQUAL(0, pruned.graph.size());
+
+  // A loose prior does not pin its variable.
+  EXPECT_LONGS_EQUAL(0,
+                    PruneKnownVariables(graph, Values(), 1e-7).known.size());
+}
+
+// The fixed base of a trajectory is substituted out at every time step.
+TEST(PruneKnownVariables, fixedBase) {
+  const Robot robot = BranchedRobot(4, 2);
+  const int num_steps = 3;
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const NonlinearFactorGraph graph =
+      graph_builder.trajectoryFG(robot, num_steps, 0.1);
+
+  const PrunedGraph pruned = PruneKnownVariables(graph);
+  const int base = robot.link("base")->id();
+  EXPECT_LONGS_EQUAL(3 * (num_steps + 1), pruned.known.size());
+  EXPECT_LONGS_EQUAL(3 * (num_steps + 1), pruned.num_dropped);
+  EXPECT_LONGS_EQUAL(graph.keys().size() - 3 * (num_steps + 1),
+                     pruned.graph.keys().size());
+  for (int k = 0; k <= num_steps; k++) {
+    EXPECT(assert_equal(robot.link("base")->getFixedPose(),
+                        Pose(pruned.known, base, k)));
+    EXPECT(assert_equal(gtsam::Vector6::Zero().eval(),
+                        Twist(pruned.known, base, k)));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
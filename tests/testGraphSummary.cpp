@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphSummary.cpp
+ * @brief Test the level-of-detail export of factor graphs.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/GraphSummary.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+size_t Count(const std::string &s, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = s.find(pattern); pos != std::string::npos;
+       pos = s.find(pattern, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+}  // namespace
+
+// The summary of a trajectory has one node per cluster, and each cluster has
+// a drill-down with its factors in full.
+TEST(GraphSummary, trajectory) {
+  const Robot robot = SerialChainRobot(6);
+  const int num_steps = 4;
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const NonlinearFactorGraph graph =
+      graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  const Values values =
+      Initializer().ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+
+  const GraphSummary summary(graph);
+  const auto variable_clusters = summary.variableClusters();
+  const auto factor_clusters = summary.factorClusters();
+  for (int k = 0; k <= num_steps; k++) {
+    const std::string q = "q_" + std::to_string(k);
+    EXPECT(std::count(variable_clusters.begin(), variable_clusters.end(), q));
+  }
+  const size_t num_clusters = variable_clusters.size() + factor_clusters.size();
+  EXPECT(2 * num_clusters < graph.size());
+  EXPECT(std::string("q_2.json") == GraphSummary::DrillDownFile("q_2"));
+
+  // One node per cluster, each naming its drill-down file.
+  std::stringstream ss;
+  summary.writeSummary(ss, values);
+  const std::string json = ss.str();
+  EXPECT_LONGS_EQUAL(num_clusters, Count(json, "\"name\""));
+  EXPECT_LONGS_EQUAL(num_clusters, Count(json, "\"drill_down\""));
+  EXPECT(json.find("\"q_2.json\"") != std::string::npos);
+
+  // A variable cluster opens to all factors on its variables.
+  NonlinearFactorGraph expected;
+  Values expected_values;
+  for (auto &&factor : graph) {
+    for (gtsam::Key key : factor->keys()) {
+      if (DynamicsSymbol(key).label() == "q" &&
+          DynamicsSymbol(key).time() == 2) {
+        expected.push_back(factor);
+        break;
+      }
+    }
+  }
+  for (gtsam::Key key : expected.keys()) {
+    expected_values.insert(key, values.at(key));
+  }
+  std::stringstream expected_ss, actual_ss;
+  JsonSaver::SaveFactorGraph(expected, expected_ss, expected_values);
+  summary.writeCluster("q_2", actual_ss, values);
+  EXPECT(expected_ss.str() == actual_ss.str());
+
+  // Factor clusters cover all factors, once.
+  size_t num_factors = 0;
+  for (auto &&cluster : factor_clusters) {
+    std::stringstream cluster_ss;
+    summary.writeCluster(cluster, cluster_ss);
+    num_factors += Count(cluster_ss.str(), "\"type\"");
+  }
+  EXPECT_LONGS_EQUAL(graph.size(), num_factors);
+
+  THROWS_EXCEPTION(summary.writeCluster("no_such_cluster", actual_ss));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
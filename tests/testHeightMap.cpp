@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testHeightMap.cpp
+ * @brief Test terrain height maps.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+
+#include <cmath>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point2;
+
+namespace {
+// A 5 x 4 grid with spacing 0.5 from (-1, -1), of a smooth bump.
+HeightMap Bump() {
+  gtsam::Matrix heights(5, 4);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 4; j++) {
+      heights(i, j) = std::sin(0.7 * i) * std::cos(0.4 * j);
+    }
+  }
+  return HeightMap(heights, Point2(-1, -1), 0.5);
+}
+}  // namespace
+
+// Planes are interpolated exactly, also with the border extension.
+TEST(HeightMap, plane) {
+  gtsam::Matrix heights(3, 3);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) heights(i, j) = 1.0 + 0.2 * i - 0.1 * j;
+  }
+  const HeightMap terrain(heights, Point2(0, 0), 1.0);
+  gtsam::Matrix12 H;
+  EXPECT_DOUBLES_EQUAL(1.0 + 0.2 * 0.3 - 0.1 * 1.7,
+                       terrain.height(0.3, 1.7, H), 1e-12);
+  EXPECT(assert_equal(gtsam::Matrix12(0.2, -0.1), H, 1e-12));
+  const gtsam::Vector3 n = gtsam::Vector3(-0.2, 0.1, 1).normalized();
+  EXPECT(assert_equal(n, terrain.normal(1.5, 0.5), 1e-12));
+
+  // Beyond x = 2 the height stays at the border, and so has no x slope.
+  EXPECT_DOUBLES_EQUAL(1.4 - 0.05, terrain.height(3.0, 0.5, H), 1e-12);
+  EXPECT(assert_equal(gtsam::Matrix12(0, -0.1), H, 1e-12));
+}
+
+// Grid points are matched, and the Jacobians are exact inside cells.
+TEST(HeightMap, derivatives) {
+  const HeightMap terrain = Bump();
+  EXPECT_DOUBLES_EQUAL(std::sin(1.4) * std::cos(0.4), terrain.height(0, -0.5),
+                       1e-12);
+
+  const gtsam::Vector2 xy(0.2, -0.35);
+  auto height = [&](const gtsam::Vector2 &p) {
+    return terrain.height(p.x(), p.y());
+  };
+  auto gradient = [&](const gtsam::Vector2 &p) {
+    return terrain.gradient(p.x(), p.y());
+  };
+  auto normal = [&](const gtsam::Vector2 &p) {
+    return terrain.normal(p.x(), p.y());
+  };
+  gtsam::Matrix12 H_height;
+  gtsam::Matrix2 H_gradient;
+  gtsam::Matrix32 H_normal;
+  const gtsam::Vector2 g = terrain.gradient(xy.x(), xy.y(), H_gradient);
+  terrain.height(xy.x(), xy.y(), H_height);
+  terrain.normal(xy.x(), xy.y(), H_normal);
+  EXPECT(assert_equal(gtsam::Matrix(g.transpose()), gtsam::Matrix(H_height),
+                      1e-12));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative11<double, gtsam::Vector2>(height, xy),
+      gtsam::Matrix(H_height), 1e-7));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative11<gtsam::Vector2, gtsam::Vector2>(gradient,
+                                                                   xy),
+      gtsam::Matrix(H_gradient), 1e-7));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative11<gtsam::Vector3, gtsam::Vector2>(normal, xy),
+      gtsam::Matrix(H_normal), 1e-7));
+}
+
+// Batched queries match single ones.
+TEST(HeightMap, batch) {
+  const HeightMap terrain = Bump();
+  gtsam::Matrix points(3, 4);
+  points << -1.2, 0.1, 0.7, 2.0,  //
+      -0.3, 0.4, 0.45, 1.0,       //
+      0, 0, 0, 0;
+  gtsam::Vector heights;
+  gtsam::Matrix gradients;
+  terrain.heights(points, &heights, &gradients);
+  EXPECT_LONGS_EQUAL(4, heights.size());
+  for (int p = 0; p < 4; p++) {
+    gtsam::Matrix12 H;
+    EXPECT_DOUBLES_EQUAL(terrain.height(points(0, p), points(1, p), H),
+                         heights(p), 1e-12);
+    EXPECT(assert_equal(gtsam::Vector(H.transpose()),
+                        gtsam::Vector(gradients.col(p)), 1e-12));
+  }
+  THROWS_EXCEPTION(terrain.heights(gtsam::Matrix(1, 2), &heights));
+}
+
+// Clearances of the contacts of all time steps.
+TEST(HeightMap, ContactClearances) {
+  const HeightMap terrain = Bump();
+  auto link = std::make_shared<Link>(
+      0, "foot", 1.0, gtsam::I_3x3, gtsam::Pose3(), gtsam::Pose3());
+  const PointOnLinks contact_points{{link, gtsam::Point3(0, 0, -0.1)}};
+  gtsam::Values values;
+  InsertPose(&values, 0, 0, gtsam::Pose3(gtsam::Rot3(), {0.1, 0.2, 1.0}));
+  InsertPose(&values, 0, 1, gtsam::Pose3(gtsam::Rot3(), {0.3, -0.2, 0.5}));
+  const gtsam::Matrix clearances =
+      ContactClearances(terrain, contact_points, values, 1);
+  EXPECT_LONGS_EQUAL(2, clearances.rows());
+  EXPECT_LONGS_EQUAL(1, clearances.cols());
+  EXPECT_DOUBLES_EQUAL(0.9 - terrain.height(0.1, 0.2), clearances(0, 0),
+                       1e-12);
+  EXPECT_DOUBLES_EQUAL(0.4 - terrain.height(0.3, -0.2), clearances(1, 0),
+                       1e-12);
+}
+
+// Grids must have at least one cell, and a positive resolution.
+TEST(HeightMap, invalid) {
+  THROWS_EXCEPTION(HeightMap(gtsam::Matrix::Zero(1, 3), Point2(0, 0), 1.0));
+  THROWS_EXCEPTION(HeightMap(gtsam::Matrix::Zero(2, 2), Point2(0, 0), 0.0));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
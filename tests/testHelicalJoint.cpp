@@ -12,14 +12,17 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/FixedJoint.h>
 #include <gtdynamics/universal_robot/HelicalJoint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
 #include <gtsam/base/serializationTestHelpers.h>
 
 using namespace gtdynamics;
@@ -97,6 +100,44 @@ TEST(Joint, params_constructor) {
                       j1->parameters().scalar_limits.value_limit_threshold));
 }
 
+/**
+ * Check that the closed forms of each joint type agree with the generic screw
+ * exponential, pMc * exp(cScrewAxis * q), and with numerical derivatives.
+ */
+TEST(Joint, ClosedForms) {
+  auto robot = simple_urdf::getRobot();
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+
+  const Pose3 bTj(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.1, 0.2, 2));
+  const gtsam::Vector3 axis = gtsam::Vector3(1, 2, 3).normalized();
+  gtsam::Vector6 general;
+  general << 0.3, -0.1, 0.2, 0.5, 0.4, -0.6;
+  const std::vector<JointSharedPtr> joints{
+      std::make_shared<RevoluteJoint>(1, "r", bTj, l1, l2, axis),
+      std::make_shared<PrismaticJoint>(2, "p", bTj, l1, l2, axis),
+      std::make_shared<HelicalJoint>(3, "h", bTj, l1, l2, axis, 0.5),
+      std::make_shared<FixedJoint>(4, "f", bTj, l1, l2),
+      std::make_shared<HelicalJoint>(5, "g", bTj, l1, l2, general)};
+
+  const double q = 0.7;
+  for (auto &&joint : joints) {
+    const Pose3 expected =
+        joint->pMc() * Pose3::Expmap(joint->cScrewAxis() * q);
+    gtsam::Matrix61 H_pTc, H_cTp;
+    EXPECT(assert_equal(expected, joint->parentTchild(q, H_pTc), 1e-9));
+    EXPECT(assert_equal(expected.inverse(), joint->childTparent(q, H_cTp),
+                        1e-9));
+
+    auto pTc = [&](double q) { return joint->parentTchild(q); };
+    auto cTp = [&](double q) { return joint->childTparent(q); };
+    EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(pTc, q),
+                        H_pTc, 1e-7));
+    EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(cTp, q),
+                        H_cTp, 1e-7));
+  }
+}
+
 #ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
 BOOST_CLASS_EXPORT(gtdynamics::HelicalJoint)
 
@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIKTracker.cpp
+ * @brief Test inverse kinematics of moving contact goals.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/IKTracker.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+// The tip of a three-joint arm follows a circle, a few iterations per target.
+TEST(IKTracker, circle) {
+  const Robot robot = SerialChainRobot(3);
+  const PointOnLink tip(robot.link("link_3"), Point3(0, 0, 0.1));
+  const ContactGoals contact_goals{{tip, Point3(0, 0, 0.6)}};
+
+  IKTrackerParameters parameters;
+  parameters.max_iterations = 5;
+  IKTracker tracker(robot, contact_goals, parameters);
+
+  for (size_t i = 0; i <= 100; ++i) {
+    const double t = 0.02 * M_PI * i;
+    const Point3 goal(0.2 * std::sin(t), 0.1 - 0.1 * std::cos(t), 0.5);
+    const gtsam::Values& solution = tracker.track({goal});
+    EXPECT(tracker.iterations() <= 5);
+    if (i > 2) EXPECT(tracker.contactGoals()[0].satisfied(solution, 0, 1e-2));
+  }
+
+  // The wrong number of goal points is rejected.
+  THROWS_EXCEPTION(tracker.track({}));
+}
+
+// Warm starts reach the goal of a single jump after enough calls.
+TEST(IKTracker, convergence) {
+  const Robot robot = SerialChainRobot(3);
+  const PointOnLink tip(robot.link("link_3"), Point3(0, 0, 0.1));
+  const Point3 goal(0.2, 0.1, 0.45);
+  const ContactGoals contact_goals{{tip, Point3(0, 0, 0.6)}};
+
+  IKTracker tracker(robot, contact_goals);
+  for (size_t i = 0; i < 10; ++i) tracker.track({goal});
+  EXPECT(gtsam::distance3(tip.predict(tracker.solution(), 0), goal) < 1e-2);
+
+  // The fixed base stays put.
+  EXPECT(gtsam::assert_equal(robot.link("base")->getFixedPose(),
+                             Pose(tracker.solution(), 0, 0), 1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testILQROptimizer.cpp
+ * @brief Test shooting trajectory optimization with iterative LQR.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ILQROptimizer.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(ILQROptimizer, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  DynamicsGraph graph_builder(gravity);
+  const int num_steps = 20;
+  const double dt = 0.05;
+
+  // Reach the pose of the last link at a goal configuration, with small
+  // torques.
+  Values goal;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&goal, joint->id(), 0.3 - 0.2 * joint->id());
+  }
+  const gtsam::Pose3 target = Pose(robot.forwardKinematics(goal), 3);
+  auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 10.0);
+  NonlinearFactorGraph objectives;
+  for (int t = 0; t < num_steps; t++) {
+    for (auto&& joint : robot.joints()) {
+      objectives.emplace_shared<MinTorqueFactor>(TorqueKey(joint->id(), t),
+                                                 torque_model);
+    }
+  }
+  objectives.add(
+      graph_builder.targetPoseFactors(robot, num_steps, "link_3", target));
+
+  ILQROptimizer ilqr(robot, graph_builder, num_steps, dt);
+  Values state;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&state, joint->id(), 0.0);
+    InsertJointVel(&state, joint->id(), 0.0);
+  }
+  const Values solution = ilqr.optimize(state, objectives);
+  EXPECT(ilqr.iterations() > 0);
+  EXPECT(ilqr.iterations() <= ILQRParams().max_iterations);
+
+  // The final pose is reached, using the forward kinematics of the solution.
+  auto finalPose = [&](const Values& values) {
+    Values angles;
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&angles, j, JointAngle(values, j, num_steps));
+    }
+    return Pose(robot.forwardKinematics(angles), 3);
+  };
+  EXPECT(assert_equal(target, finalPose(solution), 1e-3));
+
+  // The solution is a simulation of its torques.
+  Simulator simulator(robot, state, gravity);
+  for (int t = 0; t < num_steps; t++) {
+    simulator.step(gtsam::Vector(ilqr.torques().row(t).transpose()), dt);
+  }
+  EXPECT(assert_equal(gtsam::Vector(ilqr.trajectory().q.row(num_steps)),
+                      simulator.jointAngles(), 1e-9));
+  EXPECT_LONGS_EQUAL(3, ilqr.gain(0).rows());
+  EXPECT_LONGS_EQUAL(6, ilqr.gain(0).cols());
+
+  // The next tick warm-starts from the shifted solution, at its next state.
+  Values next_state;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&next_state, j, JointAngle(solution, j, 1));
+    InsertJointVel(&next_state, j, JointVel(solution, j, 1));
+  }
+  const Values next = ilqr.optimize(next_state, objectives);
+  EXPECT_DOUBLES_EQUAL(JointAngle(solution, 0, 1), JointAngle(next, 0, 0),
+                       1e-12);
+  EXPECT(assert_equal(target, finalPose(next), 1e-3));
+
+  // Objectives on twists are not supported.
+  NonlinearFactorGraph twist_objectives;
+  twist_objectives.addPrior(TwistKey(3, 0), gtsam::Vector6::Zero().eval(),
+                            graph_builder.opt().bv_cost_model);
+  THROWS_EXCEPTION(ilqr.optimize(state, twist_objectives));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
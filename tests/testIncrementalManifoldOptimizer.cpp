@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIncrementalManifoldOptimizer.cpp
+ * @brief Test incremental manifold optimizer.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/manifold/IncrementalManifoldOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include "ManifoldOptScenarios.h"
+
+using namespace gtsam;
+
+/** Appending a variable bound to an existing manifold gives the same result
+ * as solving the whole problem in batch. */
+TEST(IncrementalManifoldOptimizer, SO2) {
+  using namespace so2_scenario;
+  const Key x3_key = 3;
+  auto model = noiseModel::Isotropic::Sigma(1, 1.0);
+
+  ManifoldOptimizerParameters mopt_params;
+  IncrementalManifoldOptimizer optimizer(mopt_params, ISAM2Params(), 10);
+
+  // First step: the unit circle constraint with priors.
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+  auto result = optimizer.update(*get_graph(-2, 0), *get_constraints(),
+                                 init_values);
+  EXPECT_LONGS_EQUAL(1, optimizer.problem().manifold_keys_.size());
+  EXPECT(assert_equal(-1.0, result.atDouble(x1_key), 1e-3));
+  EXPECT(assert_equal(0.0, result.atDouble(x2_key), 1e-3));
+
+  // Second step: an unconstrained variable with a cost on the manifold.
+  NonlinearFactorGraph new_costs;
+  new_costs.addPrior(x3_key, 2.0, model);
+  new_costs.emplace_shared<BetweenFactor<double>>(x1_key, x3_key, 1.0, model);
+  Values new_values;
+  new_values.insert(x3_key, 0.0);
+  result = optimizer.update(new_costs, gtdynamics::EqualityConstraints(),
+                            new_values);
+  EXPECT_LONGS_EQUAL(1, optimizer.problem().unconstrained_keys_.size());
+
+  // Batch solution of the whole problem.
+  auto costs = get_graph(-2, 0);
+  costs->add(new_costs);
+  init_values.insert(new_values);
+  LevenbergMarquardtParams nopt_params;
+  ManifoldOptimizerType1 batch_optimizer(mopt_params, nopt_params);
+  auto expected = batch_optimizer.optimize(*costs, *get_constraints(),
+                                           init_values);
+  EXPECT(assert_equal(expected, result, 1e-3));
+
+  // Variables cannot be added twice, and constraints only on new variables.
+  THROWS_EXCEPTION(optimizer.update(new_costs,
+                                    gtdynamics::EqualityConstraints(),
+                                    new_values));
+  Values x4_values;
+  x4_values.insert(4, 0.0);
+  THROWS_EXCEPTION(optimizer.update(NonlinearFactorGraph(),
+                                    *get_constraints(), x4_values));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
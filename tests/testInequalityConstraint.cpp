@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInequalityConstraint.cpp
+ * @brief Test inequality constraints and their augmented Lagrangian solution.
+ * @author: Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::x1_key, constrained_example::x2_key;
+
+// Test methods of DoubleExpressionInequality.
+TEST(InequalityConstraint, DoubleExpressionInequality) {
+  // g(x1, x2) = x1 - x2 >= 0
+  double tolerance = 0.1;
+  auto constraint = DoubleExpressionInequality(x1 - x2, tolerance);
+  EXPECT_LONGS_EQUAL(1, constraint.dim());
+  EXPECT(constraint.keys() == std::set<Key>({x1_key, x2_key}));
+
+  Values feasible_values, infeasible_values;
+  feasible_values.insert(x1_key, 1.0);
+  feasible_values.insert(x2_key, 0.0);
+  infeasible_values.insert(x1_key, 0.0);
+  infeasible_values.insert(x2_key, 0.5);
+
+  // Satisfied constraints have no violation, and a zero merit factor.
+  EXPECT(constraint.feasible(feasible_values));
+  EXPECT(assert_equal(Vector::Ones(1), constraint(feasible_values)));
+  EXPECT(assert_equal(Vector::Zero(1),
+                      constraint.toleranceScaledViolation(feasible_values)));
+  auto factor = constraint.createFactor(1.0);
+  EXPECT(assert_equal(Vector::Zero(1),
+                      factor->unwhitenedError(feasible_values)));
+
+  // Violated constraints have error max(0, bias - g(x)).
+  EXPECT(!constraint.feasible(infeasible_values));
+  EXPECT(assert_equal(Vector::Constant(1, 5.0),
+                      constraint.toleranceScaledViolation(infeasible_values)));
+  auto biased_factor = constraint.createFactor(4.0, Vector::Constant(1, 0.5));
+  EXPECT(assert_equal(Vector::Constant(1, 1.0),
+                      biased_factor->unwhitenedError(infeasible_values)));
+  EXPECT_DOUBLES_EQUAL(0.5 * 4.0 * 1.0 / (tolerance * tolerance),
+                       biased_factor->error(infeasible_values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*biased_factor, infeasible_values, 1e-7,
+                                  1e-5);
+}
+
+// Test the box constraints helper.
+TEST(InequalityConstraint, BoxConstraints) {
+  auto constraints = BoxConstraints(x1, -1.0, 1.0, 1e-3);
+  EXPECT_LONGS_EQUAL(2, constraints.size());
+  EXPECT_LONGS_EQUAL(2, constraints.dim());
+
+  Values values;
+  values.insert(x1_key, 2.0);
+  EXPECT(constraints[0]->feasible(values));
+  EXPECT(!constraints[1]->feasible(values));
+}
+
+// Minimize (x1 - 2)^2 + (x2 - 1)^2 with x1 <= 0.5 and x1 + x2 = 1.
+TEST(InequalityConstraint, AugmentedLagrangian) {
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 2.0, x1));
+  graph.add(ExpressionFactor<double>(cost_noise, 1.0, x2));
+
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + x2 - Double_(1.0), 1e-3);
+  InequalityConstraints inequality_constraints =
+      BoxConstraints(x1, -10.0, 0.5, 1e-3);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.0);
+  init_values.insert(x2_key, 0.0);
+
+  // The optimum on the line x1 + x2 = 1 is (1, 0), so the bound is active.
+  AugmentedLagrangianParameters params;
+  params.num_iterations = 20;
+  AugmentedLagrangianOptimizer optimizer(params);
+  Values results = optimizer.optimize(graph, constraints,
+                                      inequality_constraints, init_values);
+  EXPECT_DOUBLES_EQUAL(0.5, results.at<double>(x1_key), 1e-3);
+  EXPECT_DOUBLES_EQUAL(0.5, results.at<double>(x2_key), 1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
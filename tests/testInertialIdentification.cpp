@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInertialIdentification.cpp
+ * @brief Test identification of inertial parameters from joint samples.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+
+Robot SimpleRRR() {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  return robot.fixLink("link_0");
+}
+
+// Deterministic samples of a smooth trajectory, and their torques.
+struct Samples {
+  Matrix q, v, qdd, tau;
+};
+
+Samples MakeSamples(const Robot &robot, size_t num_samples, double phase) {
+  const RecursiveDynamics dynamics(robot, gravity);
+  const size_t n = dynamics.numJoints();
+  Samples samples{Matrix(num_samples, n), Matrix(num_samples, n),
+                  Matrix(num_samples, n), Matrix(num_samples, n)};
+  Matrix M(n, n);
+  Vector h(n);
+  for (size_t s = 0; s < num_samples; ++s) {
+    for (size_t j = 0; j < n; ++j) {
+      const double t = 0.01 * s + phase, w = 1.0 + 0.7 * j;
+      samples.q(s, j) = std::sin(w * t + j);
+      samples.v(s, j) = w * std::cos(w * t + j);
+      samples.qdd(s, j) = -w * w * std::sin(w * t + j) + 0.3 * j;
+    }
+    const Vector q = samples.q.row(s).transpose();
+    const Vector v = samples.v.row(s).transpose();
+    dynamics.massMatrix(q, &M);
+    dynamics.biasTorques(q, v, &h);
+    samples.tau.row(s) = (M * samples.qdd.row(s).transpose() + h).transpose();
+  }
+  return samples;
+}
+}  // namespace
+
+// The regressor with the model parameters gives the inverse dynamics.
+TEST(InertialIdentification, regressor) {
+  const Robot robot = SimpleRRR();
+  const Samples samples = MakeSamples(robot, 5, 0.0);
+  for (bool identify_center_of_mass : {false, true}) {
+    InertialIdentificationParams params;
+    params.identify_center_of_mass = identify_center_of_mass;
+    const InertialIdentification identification(robot, gravity, params);
+    EXPECT_LONGS_EQUAL(3 * identification.parametersPerLink(),
+                       identification.numParameters());
+    for (size_t s = 0; s < 5; ++s) {
+      const Matrix Y = identification.regressor(
+          samples.q.row(s).transpose(), samples.v.row(s).transpose(),
+          samples.qdd.row(s).transpose());
+      EXPECT(assert_equal(Vector(samples.tau.row(s).transpose()),
+                          Vector(Y * identification.priorParameters()),
+                          1e-9));
+    }
+  }
+}
+
+// Identified parameters predict the torques of the true robot.
+TEST(InertialIdentification, identify) {
+  const Robot robot = SimpleRRR();
+  Robot truth = robot.clone();
+  for (auto &&link : truth.links()) {
+    if (link->isFixed()) continue;
+    link->setInertialParameters(1.5 * link->mass(), 2.0 * link->inertia());
+  }
+
+  InertialIdentification identification(robot, gravity);
+  for (double phase : {0.0, 3.0}) {
+    const Samples samples = MakeSamples(truth, 300, phase);
+    identification.addSamples(samples.q, samples.v, samples.qdd, samples.tau);
+  }
+  EXPECT_LONGS_EQUAL(600, identification.numSamples());
+
+  const Robot identified = identification.identifiedRobot();
+  const Samples expected = MakeSamples(truth, 20, 7.0);
+  const Samples actual = MakeSamples(identified, 20, 7.0);
+  EXPECT(assert_equal(expected.tau, actual.tau, 1e-4));
+
+  // The masses of the model are not changed.
+  EXPECT_DOUBLES_EQUAL(robot.link("link_1")->mass(),
+                       SimpleRRR().link("link_1")->mass(), 1e-12);
+
+  THROWS_EXCEPTION(identification.addSamples(Matrix(2, 1), Matrix(2, 1),
+                                             Matrix(2, 1), Matrix(2, 1)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
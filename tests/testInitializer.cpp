@@ -104,6 +104,30 @@ TEST(InitializeSolutionUtils, InitializeSolutionInterpolationMultiPhase) {
   EXPECT(assert_equal(wTb_t[1], pose));
 }
 
+// Every time step is initialized once, with the keys of the zero values.
+TEST(InitializeSolutionUtils, InterpolationMultiPhaseKeys) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  std::vector<Pose3> wTb_t = {Pose3(Rot3(), Point3(1, 1, 1)),
+                              Pose3(Rot3(), Point3(2, 1, 1)),
+                              Pose3(Rot3(), Point3(2, 2, 1))};
+  std::vector<double> ts = {5, 10, 12};
+
+  Initializer initializer;
+  gtsam::Values init_vals =
+      initializer.InitializeSolutionInterpolationMultiPhase(
+          robot, "l1", Pose3(), wTb_t, ts, 1.0, kNoiseSigma);
+  gtsam::Values zero_vals = initializer.ZeroValuesTrajectory(robot, 12, 0);
+  EXPECT_LONGS_EQUAL(zero_vals.size(), init_vals.size());
+  EXPECT(zero_vals.keys() == init_vals.keys());
+
+  // The twist of the interpolated link is zero, other links follow from
+  // forward kinematics.
+  EXPECT(assert_equal(gtsam::Vector6::Zero(),
+                      Twist(init_vals, robot.link("l1")->id(), 7)));
+  EXPECT(assert_equal(wTb_t[1], Pose(init_vals, robot.link("l1")->id(), 10),
+                      1e-6));
+}
+
 TEST(InitializeSolutionUtils, InitializePosesAndJoints) {
   auto robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
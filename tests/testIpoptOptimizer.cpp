@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIpoptOptimizer.cpp
+ * @brief Test constrained optimization with IPOPT.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+#include <gtdynamics/optimizer/IpoptOptimizer.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(IpoptOptimizer, ConstrainedExample) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  IpoptOptimizer optimizer;
+  if (!IpoptOptimizer::Available()) {
+    THROWS_EXCEPTION(optimizer.optimize(graph, constraints, init_values));
+    return;
+  }
+  ConstrainedOptResult intermediate;
+  Values results =
+      optimizer.optimize(graph, constraints, init_values, &intermediate);
+  EXPECT_LONGS_EQUAL(1, intermediate.num_iters.size());
+
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  EXPECT(assert_equal(gt_results, results, 1e-4));
+}
+
+// An active inequality is met with equality, an inactive one is ignored.
+TEST(IpoptOptimizer, Inequalities) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.addPrior<double>(x1_key, 2.0, cost_noise);
+  graph.addPrior<double>(x2_key, 2.0, cost_noise);
+
+  // x1 <= 1 is active at the solution, x2 <= 3 is not.
+  InequalityConstraints inequalities;
+  inequalities.emplace_shared<DoubleExpressionInequality>(
+      Double_(1.0) - x1, 1e-3);
+  inequalities.emplace_shared<DoubleExpressionInequality>(
+      Double_(3.0) - x2, 1e-3);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.0);
+  init_values.insert(x2_key, 0.0);
+
+  IpoptOptimizer optimizer;
+  if (!IpoptOptimizer::Available()) {
+    THROWS_EXCEPTION(optimizer.optimize(graph, EqualityConstraints(),
+                                        inequalities, init_values));
+    return;
+  }
+  Values results = optimizer.optimize(graph, EqualityConstraints(),
+                                      inequalities, init_values);
+
+  Values gt_results;
+  gt_results.insert(x1_key, 1.0);
+  gt_results.insert(x2_key, 2.0);
+  EXPECT(assert_equal(gt_results, results, 1e-4));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointFactors.cpp
+ * @brief Test closed-form joint factors against the expression factors.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/JointFactors.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TorqueFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchEquivalenceFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "make_joint.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+auto cost_model6 = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+auto cost_model1 = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// A helical joint with a rotated rest transform.
+JointConstSharedPtr joint() {
+  Vector6 screw_axis;
+  screw_axis << 0, 0.6, 0.8, 0.3, 1, 0;
+  const Pose3 cMp(Rot3::RzRyRx(0.1, -0.2, 0.3), gtsam::Point3(-1, 0, 0.5));
+  return make_joint(cMp, screw_axis);
+}
+
+// Arbitrary values for all variables of the joint at time 0.
+gtsam::Values values(const JointConstSharedPtr &joint) {
+  const int p = joint->parent()->id(), c = joint->child()->id(),
+            j = joint->id();
+  gtsam::Values values;
+  InsertPose(&values, p, Pose3(Rot3::Ry(0.4), gtsam::Point3(1, 2, 3)));
+  InsertPose(&values, c, Pose3(Rot3::Rx(-0.7), gtsam::Point3(0, 1, 2)));
+  InsertJointAngle(&values, j, 0.3);
+  InsertJointVel(&values, j, -1.2);
+  InsertJointAccel(&values, j, 2.1);
+  InsertTorque(&values, j, 0.8);
+  Vector6 a, b;
+  a << 0.1, -0.2, 0.3, 1, -2, 0.5;
+  b << -0.3, 0.2, 0.4, -1, 0.7, 2;
+  InsertTwist(&values, p, a);
+  InsertTwist(&values, c, b);
+  InsertTwistAccel(&values, p, 2 * b);
+  InsertTwistAccel(&values, c, -a);
+  InsertWrench(&values, p, j, 3 * a);
+  InsertWrench(&values, c, j, b - a);
+  return values;
+}
+
+// Check that a closed-form factor has the same keys and error as the
+// expression factor it replaces.
+bool SameError(const gtsam::NoiseModelFactor::shared_ptr &expected,
+               const gtsam::NoiseModelFactor &actual,
+               const gtsam::Values &values) {
+  return expected->keys() == actual.keys() &&
+         assert_equal(expected->unwhitenedError(values),
+                      actual.unwhitenedError(values), 1e-9);
+}
+}  // namespace example
+
+TEST(JointFactors, pose) {
+  auto joint = example::joint();
+  const auto values = example::values(joint);
+  JointPoseFactor factor(example::cost_model6, joint, 0);
+  EXPECT(example::SameError(PoseFactor(example::cost_model6, joint, 0),
+                            factor, values));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(JointFactors, twist) {
+  auto joint = example::joint();
+  const auto values = example::values(joint);
+  JointTwistFactor factor(example::cost_model6, joint, 0);
+  EXPECT(example::SameError(TwistFactor(example::cost_model6, joint, 0),
+                            factor, values));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(JointFactors, twistAccel) {
+  auto joint = example::joint();
+  const auto values = example::values(joint);
+  JointTwistAccelFactor factor(example::cost_model6, joint, 0);
+  EXPECT(example::SameError(TwistAccelFactor(example::cost_model6, joint, 0),
+                            factor, values));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(JointFactors, wrenchEquivalence) {
+  auto joint = example::joint();
+  const auto values = example::values(joint);
+  JointWrenchEquivalenceFactor factor(example::cost_model6, joint, 0);
+  EXPECT(example::SameError(
+      WrenchEquivalenceFactor(example::cost_model6, joint, 0), factor,
+      values));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(JointFactors, torque) {
+  auto joint = example::joint();
+  const auto values = example::values(joint);
+  JointWrenchTorqueFactor factor(example::cost_model1, joint, 0);
+  EXPECT(example::SameError(TorqueFactor(example::cost_model1, joint, 0),
+                            factor, values));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// The option gives a dynamics graph with the same error.
+TEST(JointFactors, DynamicsGraph) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  OptimizerSetting opt;
+  DynamicsGraph expression_builder(opt, gravity);
+  opt.closed_form_jacobians = true;
+  DynamicsGraph closed_form_builder(opt, gravity);
+
+  const auto expected = expression_builder.dynamicsFactorGraph(robot, 0);
+  const auto actual = closed_form_builder.dynamicsFactorGraph(robot, 0);
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+
+  const gtsam::Values values = example::values(robot.joints()[0]);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointsObjectiveFactors.cpp
+ * @brief Test the minimum torque and joint limit factors on several joints.
+ * @author Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/JointsObjectiveFactors.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(JointsMinTorqueFactor, error) {
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  const std::vector<int> joint_ids{1, 2, 4};
+  const JointsMinTorqueFactor factor(joint_ids, 3, model);
+  EXPECT_LONGS_EQUAL(3, factor.dim());
+
+  NonlinearFactorGraph expected;
+  Values values;
+  for (int j : joint_ids) {
+    expected.emplace_shared<MinTorqueFactor>(TorqueKey(j, 3), model);
+    InsertTorque(&values, j, 3, 0.3 * j - 0.5);
+  }
+  EXPECT_DOUBLES_EQUAL(expected.error(values), factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  THROWS_EXCEPTION(JointsMinTorqueFactor(
+      joint_ids, 3, gtsam::noiseModel::Isotropic::Sigma(2, 0.5)));
+}
+
+// The batched joint limits have the errors of Joint::jointLimitFactors.
+TEST(JointsLimitFactor, jointLimitFactors) {
+  SyntheticRobotParams params;
+  params.joint_params.velocity_limit = 1.0;
+  params.joint_params.acceleration_limit = 2.0;
+  params.joint_params.torque_limit = 3.0;
+  const Robot robot = SerialChainRobot(3, params);
+  OptimizerSetting opt;
+  const DynamicsGraph graph_builder(opt);
+  opt.batch_joint_limits = true;
+  const DynamicsGraph batch_builder(opt);
+
+  const NonlinearFactorGraph expected =
+      graph_builder.jointLimitFactors(robot, 2);
+  const NonlinearFactorGraph actual = batch_builder.jointLimitFactors(robot, 2);
+  EXPECT_LONGS_EQUAL(4 * 3, expected.size());
+  EXPECT_LONGS_EQUAL(1, actual.size());
+
+  // Values below, within and above the limits, away from the kinks.
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const double s = j - 2.0;
+    InsertJointAngle(&values, j, 2, 10.0 * s + 0.1);
+    InsertJointVel(&values, j, 2, 1.5 * s + 0.1);
+    InsertJointAccel(&values, j, 2, -2.5 * s + 0.1);
+    InsertTorque(&values, j, 2, 3.5 * s - 0.1);
+  }
+  EXPECT(expected.error(values) > 0);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+  auto factor =
+      std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(actual.at(0));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
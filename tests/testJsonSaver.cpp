@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJsonSaver.cpp
+ * @brief Test streaming json output of factor graphs.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+
+namespace example {
+gtsam::NonlinearFactorGraph graph() {
+  gtsam::NonlinearFactorGraph graph;
+  graph.addPrior(JointAngleKey(0, 0), 0.5,
+                 gtsam::noiseModel::Isotropic::Sigma(1, 0.1));
+  graph.addPrior(PoseKey(1, 0), Pose3(),
+                 gtsam::noiseModel::Isotropic::Sigma(6, 0.2));
+  return graph;
+}
+
+gtsam::Values values() {
+  gtsam::Values values;
+  InsertJointAngle(&values, 0, 0, 0.3);
+  InsertPose(&values, 1, 0, Pose3(gtsam::Rot3(), gtsam::Point3(1, 2, 3)));
+  return values;
+}
+}  // namespace example
+
+/// The streamed json is the composition of JsonList and JsonDict strings.
+TEST(JsonSaver, SaveFactorGraph) {
+  const auto graph = example::graph();
+  const auto values = example::values();
+
+  std::vector<std::string> variables, factors;
+  for (gtsam::Key key : graph.keys()) {
+    JsonSaver::LocationType locations;
+    const std::string name = JsonSaver::GetName(key);
+    std::vector<JsonSaver::AttributeType> attributes{
+        {JsonSaver::Quoted("name"), JsonSaver::Quoted(name)},
+        {JsonSaver::Quoted("value"),
+         JsonSaver::Quoted(JsonSaver::GetValue(values.at(key)))}};
+    const auto location =
+        JsonSaver::GetLocation(locations, key, values.at(key));
+    if (location != "") {
+      attributes.emplace_back(JsonSaver::Quoted("location"), location);
+    }
+    variables.push_back(JsonSaver::JsonDict(attributes));
+  }
+  for (size_t i = 0; i < graph.size(); i++) {
+    factors.push_back(JsonSaver::GetFactor(i, graph, values));
+  }
+  const std::string expected = JsonSaver::JsonList(
+      {JsonSaver::JsonList(variables), JsonSaver::JsonList(factors)});
+
+  std::stringstream ss;
+  JsonSaver::SaveFactorGraph(graph, ss, values);
+  EXPECT(expected == ss.str());
+}
+
+/// Clustered graphs are streamed in the same format.
+TEST(JsonSaver, SaveClusteredGraph) {
+  const auto graph = example::graph();
+  const auto values = example::values();
+  const std::map<std::string, gtsam::NonlinearFactorGraph> clustered_graphs{
+      {"priors", graph}};
+  const std::map<std::string, gtsam::Values> clustered_values{
+      {"states", values}};
+
+  std::vector<std::string> names;
+  for (gtsam::Key key : values.keys()) {
+    names.push_back(JsonSaver::GetName(key));
+  }
+  const std::string value_cluster = JsonSaver::JsonDict(
+      {{JsonSaver::Quoted("name"), JsonSaver::Quoted("states")},
+       {JsonSaver::Quoted("value"),
+        JsonSaver::Quoted(JsonSaver::JsonList(names, -1))}});
+  const std::string graph_cluster = JsonSaver::JsonDict(
+      {{JsonSaver::Quoted("name"), JsonSaver::Quoted("priors")},
+       {JsonSaver::Quoted("variables"),
+        JsonSaver::JsonList({JsonSaver::Quoted("states")}, -1)},
+       {JsonSaver::Quoted("error"), std::to_string(graph.error(values))}});
+  const std::string expected =
+      JsonSaver::JsonList({JsonSaver::JsonList({value_cluster}),
+                           JsonSaver::JsonList({graph_cluster})});
+
+  std::stringstream ss;
+  JsonSaver::SaveClusteredGraph(ss, clustered_graphs, clustered_values,
+                                values);
+  EXPECT(expected == ss.str());
+}
+
+/// Histories are recorded as tangent vectors, with decimation.
+TEST(StorageManager, History) {
+  StorageManager storage(2);
+  const gtsam::Key q = JointAngleKey(0, 0), p = PoseKey(1, 0);
+  for (int i = 0; i < 5; i++) {
+    gtsam::Values values;
+    InsertJointAngle(&values, 0, 0, 0.1 * i);
+    InsertPose(&values, 1, 0, Pose3(gtsam::Rot3(), gtsam::Point3(i, 0, 0)));
+    storage.AddValues(values);
+  }
+  EXPECT_LONGS_EQUAL(3, storage.NumRecorded(q));
+  EXPECT_LONGS_EQUAL(3, storage.NumRecorded(p));
+
+  // The poses of iterations 0, 2 and 4.
+  EXPECT(std::string("[[0, 0, 0, 0, 0, 0],[2, 0, 0, 0, 0, 0],"
+                     "[4, 0, 0, 0, 0, 0]]") == storage.GetValueHistory(p));
+
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  storage.SaveHistoryBinary(ss);
+  const auto histories = StorageManager::LoadHistoryBinary(ss);
+  EXPECT_LONGS_EQUAL(2, histories.size());
+  const gtsam::Matrix expected_q =
+      (gtsam::Matrix(3, 1) << 0, 0.2, 0.4).finished();
+  EXPECT(gtsam::assert_equal(expected_q, histories.at(q), 1e-12));
+  EXPECT_LONGS_EQUAL(6, histories.at(p).cols());
+
+  // Variables that are no longer optimized are dropped, at the next
+  // recorded iteration.
+  gtsam::Values values;
+  InsertJointAngle(&values, 0, 0, 1.0);
+  storage.AddValues(values);
+  EXPECT_LONGS_EQUAL(3, storage.NumRecorded(p));
+  storage.AddValues(values);
+  EXPECT_LONGS_EQUAL(4, storage.NumRecorded(q));
+  EXPECT_LONGS_EQUAL(0, storage.NumRecorded(p));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicCalibration.cpp
+ * @brief Test online calibration of encoder offsets and joint locations.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/KinematicCalibration.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace {
+Robot SimpleRRR() {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  return robot.fixLink("link_0");
+}
+
+// Pose of link_3 in link_0 by forward kinematics of the model.
+Pose3 EndPose(const Robot &robot, const Vector &q) {
+  LinkStates states;
+  robot.forwardKinematics(q, Vector::Zero(q.size()), &states);
+  return states.poses[robot.link("link_0")->id()].between(
+      states.poses[robot.link("link_3")->id()]);
+}
+}  // namespace
+
+// Encoder offsets are recovered from a stream of end poses, also after the
+// older observations are summarized.
+TEST(KinematicCalibration, offsets) {
+  const Robot robot = SimpleRRR();
+  const size_t n = robot.numJoints();
+  const Vector offsets = (Vector(3) << 0.05, -0.03, 0.02).finished();
+
+  KinematicCalibrationParams params;
+  params.max_observations = 10;
+  KinematicCalibration calibration(robot, params);
+  for (size_t k = 0; k < 50; ++k) {
+    Vector q_true(n);
+    for (size_t j = 0; j < n; ++j) q_true(j) = std::sin(0.3 * k + 2.0 * j);
+    calibration.addObservation(q_true - offsets, "link_0", "link_3",
+                               EndPose(robot, q_true));
+  }
+  EXPECT_LONGS_EQUAL(50, calibration.numObservations());
+  EXPECT(calibration.isam().getFactorsUnsafe().nrFactors() <= 2 * n + 11);
+
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(offsets(j), calibration.encoderOffset(j), 1e-4);
+    EXPECT(assert_equal(Vector3::Zero().eval(), calibration.jointLocation(j),
+                        1e-4));
+  }
+
+  const Vector q = (Vector(3) << 0.1, 0.2, 0.3).finished();
+  EXPECT(assert_equal(EndPose(robot, q + offsets),
+                      calibration.predict(q, "link_0", "link_3"), 1e-4));
+  THROWS_EXCEPTION(calibration.predict(q, "link_0", "no_such_link"));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -60,6 +60,31 @@ TEST(Interval, InverseKinematics) {
   }
 }
 
+// Slices solved in tasks, with warm starts, reach the goals at all slices.
+TEST(Interval, InverseKinematicsWarmStart) {
+  using namespace contact_goals_example;
+  const Interval interval(0, 4);
+
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.warm_start = true;
+  parameters.slices_per_task = 2;
+  Kinematics kinematics(parameters);
+
+  auto result = kinematics.inverse(interval, robot, contact_goals);
+  EXPECT_LONGS_EQUAL(robot.numLinks() + robot.numJoints(),
+                     result.size() / 5);
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = 0; k <= 4; k++) {
+      EXPECT(goal.satisfied(result, k, 1e-5));
+    }
+  }
+
+  // The first slice of every task is solved from its usual initial values.
+  auto expected = kinematics.inverse(Slice(2), robot, contact_goals);
+  EXPECT(assert_equal(Pose(expected, 0, 2), Pose(result, 0, 2)));
+}
+
 TEST(Interval, Interpolate) {
   // Load robot and establish contact/goal pairs
   using namespace contact_goals_example;
@@ -73,7 +98,7 @@ TEST(Interval, Interpolate) {
   parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
   Kinematics kinematics(parameters);
   auto result1 = kinematics.inverse(Slice(5), robot, contact_goals);
-  auto result2 = kinematics.inverse(Slice(9), robot, contact_goals);
+  auto result2 = kinematics.inverse(Slice(9), robot, contact_goals2);
 
   // Create a kinematic trajectory over timesteps 5, 6, 7, 8, 9 that
   // interpolates between goal configurations at timesteps 5 and 9.
@@ -85,6 +110,31 @@ TEST(Interval, Interpolate) {
   EXPECT(assert_equal(Pose(result2, 0, 9), Pose(result, 0, 9)));
 }
 
+// Densification flags the samples around a corrupted time step only.
+TEST(Interval, Densify) {
+  using namespace contact_goals_example;
+  const Interval interval(0, 4);
+
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.densify_samples = 8;
+  parameters.execution = ExecutionContext::Threads(4);
+  Kinematics kinematics(parameters);
+  gtsam::Values values = kinematics.inverse(interval, robot, contact_goals);
+  EXPECT(kinematics.densify(interval, robot, values, contact_goals,
+                            contact_goals)
+             .empty());
+
+  const int j = robot.joints()[0]->id();
+  values.update(JointAngleKey(j, 2), JointAngle(values, j, 2) + 0.3);
+  auto violations =
+      kinematics.densify(interval, robot, values, contact_goals, contact_goals);
+  LONGS_EQUAL(1, violations.size());
+  EXPECT_DOUBLES_EQUAL(1.0, violations[0].t_start, 1e-9);
+  EXPECT_DOUBLES_EQUAL(3.0, violations[0].t_end, 1e-9);
+  EXPECT(violations[0].max_error > 0.01);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
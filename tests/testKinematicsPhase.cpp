@@ -36,6 +36,17 @@ TEST(Phase, InverseKinematics) {
 
   Phase phase0(0, num_time_steps, constraint);
   // TODO(frank): test methods producing constraints.
+
+  // Inverse kinematics on a phase solves the slices of its interval.
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  Kinematics kinematics(parameters);
+  auto result = kinematics.inverse(phase0, robot, contact_goals);
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = 0; k <= num_time_steps; k++) {
+      EXPECT(goal.satisfied(result, k, 1e-5));
+    }
+  }
 }
 
 int main() {
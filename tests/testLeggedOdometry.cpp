@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLeggedOdometry.cpp
+ * @brief Test the fixed-lag legged odometry smoother.
+ * @author Varun Agrawal, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/estimation/LeggedOdometry.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::NavState, gtsam::Pose3, gtsam::Vector3;
+
+namespace {
+const Robot robot =
+    CreateRobotFromFile(kSdfPath + std::string("spider_alt.sdf"), "spider");
+const std::vector<std::string> feet = {
+    "tarsus_1_L1", "tarsus_2_L2", "tarsus_3_L3", "tarsus_4_L4",
+    "tarsus_5_R4", "tarsus_6_R3", "tarsus_7_R2", "tarsus_8_R1"};
+}  // namespace
+
+TEST(LeggedOdometry, standing) {
+  LeggedOdometryParams params;
+  params.lag = 0.25;
+  LeggedOdometry odometry(robot, "body", feet, params);
+  const gtsam::Vector q = gtsam::Vector::Zero(robot.numJoints());
+  const std::vector<bool> contacts(feet.size(), true);
+  const Pose3 wTb(gtsam::Rot3(), gtsam::Point3(1, 2, 0.5));
+  odometry.initialize(0.0, NavState(wTb, Vector3::Zero()), q, contacts);
+
+  // Two seconds of a 200 Hz IMU that feels gravity, and encoders at 50 Hz.
+  const Vector3 specific_force(0, 0, 9.81), angular_velocity(0, 0, 0);
+  const double dt = 1.0 / 200;
+  size_t max_keyframes = 0;
+  for (size_t n = 1; n <= 400; n++) {
+    const NavState predicted =
+        odometry.addImu(n * dt, specific_force, angular_velocity);
+    EXPECT(assert_equal(wTb, predicted.pose(), 1e-3));
+    if (n % 4 == 0) {
+      odometry.addKinematics(q, contacts);
+      max_keyframes = std::max(max_keyframes, odometry.numKeyframes());
+    }
+  }
+  EXPECT_LONGS_EQUAL(100, odometry.keyframe());
+  EXPECT(assert_equal(wTb, odometry.state().pose(), 1e-3));
+  EXPECT(assert_equal(Vector3::Zero(), odometry.state().velocity(), 1e-3));
+
+  // The window covers the lag, keyframes 20 ms apart.
+  EXPECT(max_keyframes <= 14);
+  EXPECT(odometry.values().size() <= 14 * (3 + feet.size()));
+}
+
+TEST(LeggedOdometry, errors) {
+  LeggedOdometry odometry(robot, "body", feet);
+  const gtsam::Vector q = gtsam::Vector::Zero(robot.numJoints());
+  const std::vector<bool> contacts(feet.size(), true);
+  THROWS_EXCEPTION(odometry.addImu(0.1, Vector3::Zero(), Vector3::Zero()));
+
+  odometry.initialize(0.0, NavState(), q, contacts);
+  THROWS_EXCEPTION(odometry.addKinematics(q, contacts));
+  THROWS_EXCEPTION(odometry.addKinematics(q, {true}));
+  odometry.addImu(0.1, Vector3(0, 0, 9.81), Vector3::Zero());
+  THROWS_EXCEPTION(odometry.addImu(0.05, Vector3::Zero(), Vector3::Zero()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -12,6 +12,7 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
@@ -62,6 +63,22 @@ TEST(Link, params_constructor) {
   EXPECT(assert_equal(0, l1.joints().size()));
 }
 
+// The cached gravity wrench agrees with GravityWrench.
+TEST(Link, GravityWrench) {
+  Link l1(1, "l1", 2.0, gtsam::Vector3(3, 2, 1).asDiagonal(),
+          Pose3(Rot3(), Point3(0, 0, 1)), Pose3());
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const Pose3 wTcom(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 3));
+
+  gtsam::Matrix6 H, expected_H;
+  const gtsam::Vector6 expected =
+      GravityWrench(gravity, 2.0, wTcom, expected_H);
+  EXPECT(assert_equal(expected, l1.gravityWrench(gravity, wTcom, H)));
+  EXPECT(assert_equal(expected_H, H));
+  EXPECT(assert_equal(Link::SpatialInertia(2.0, l1.inertia()),
+                      l1.inertiaMatrix()));
+}
+
 TEST(Link, NumJoints) {
   auto robot = simple_urdf::getRobot();
   auto l1 = robot.link("l1");
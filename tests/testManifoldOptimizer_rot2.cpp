@@ -186,6 +186,34 @@ TEST(ManifoldOptProblem, SO2) {
   EXPECT_LONGS_EQUAL(1, mopt_problem.problemDimension().second);
 }
 
+/** Constraints sharing variables, directly or through others, form one
+ * component; components are ordered by their smallest key. */
+TEST(ManifoldOptProblem, components) {
+  gtdynamics::EqualityConstraints constraints;
+  auto equal = [&](Key a, Key b) {
+    constraints.emplace_shared<gtdynamics::DoubleExpressionEquality>(
+        Double_(a) - Double_(b), 1e-3);
+  };
+  equal(5, 6);
+  equal(1, 2);
+  equal(4, 5);
+  equal(3, 2);
+
+  Values init_values;
+  for (Key key = 1; key <= 6; key++) init_values.insert(key, 0.0);
+
+  ManifoldOptimizerType1 optimizer(ManifoldOptimizerParameters(),
+                                   LevenbergMarquardtParams());
+  auto mopt_problem = optimizer.initializeMoptProblem(NonlinearFactorGraph(),
+                                                      constraints, init_values);
+  EXPECT_LONGS_EQUAL(2, mopt_problem.components_.size());
+  const auto& first = *mopt_problem.components_[0];
+  EXPECT(first.keys_ == KeySet({1, 2, 3}));
+  EXPECT(first.constraints_[0] == constraints[1]);
+  EXPECT(first.constraints_[1] == constraints[3]);
+  EXPECT(mopt_problem.components_[1]->keys_ == KeySet({4, 5, 6}));
+}
+
 /** Optimization using Rot2 manifold. */
 TEST(ManifoldOptimization, SO2) {
   Key rot_key = 1;
@@ -234,6 +262,150 @@ TEST(ManifoldOptimizerType1, SO2) {
   EXPECT(assert_equal(0.0, result.atDouble(x2_key), 1e-5));
 }
 
+/** Parallel retraction gives the same result as the serial one. */
+TEST(ManifoldOptimizerType1, ParallelRetract) {
+  using namespace so2_scenario;
+  auto costs = get_graph(-2, 0);
+  auto constraints = get_constraints();
+
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+
+  LevenbergMarquardtParams nopt_params;
+  nopt_params.minModelFidelity = 0.5;
+  ManifoldOptimizerParameters mopt_params;
+  ManifoldOptimizerType1 serial_optimizer(mopt_params, nopt_params);
+  mopt_params.parallel_retract = true;
+  ManifoldOptimizerType1 parallel_optimizer(mopt_params, nopt_params);
+
+  gtdynamics::ConstrainedOptResult serial_result, parallel_result;
+  auto expected = serial_optimizer.optimize(*costs, *constraints, init_values,
+                                            &serial_result);
+  auto actual = parallel_optimizer.optimize(*costs, *constraints, init_values,
+                                            &parallel_result);
+  EXPECT(assert_equal(expected, actual, 1e-6));
+  LONGS_EQUAL(1, parallel_result.num_iters.size());
+}
+
+/** The dogleg trust-region variant converges to the same solution. */
+TEST(ManifoldOptimizerType1, Dogleg) {
+  using namespace so2_scenario;
+  auto costs = get_graph(-2, 0);
+  auto constraints = get_constraints();
+
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+
+  ManifoldOptimizerParameters mopt_params;
+  ManifoldOptimizerType1 optimizer(mopt_params, DoglegParams());
+  gtdynamics::ConstrainedOptResult intermediate_result;
+  auto result = optimizer.optimize(*costs, *constraints, init_values,
+                                   &intermediate_result);
+  EXPECT(assert_equal(-1.0, result.atDouble(x1_key), 1e-5));
+  EXPECT(assert_equal(0.0, result.atDouble(x2_key), 1e-5));
+  LONGS_EQUAL(1, intermediate_result.num_iters.size());
+  EXPECT(intermediate_result.num_iters.front() > 0);
+}
+
+/** Phase times are reported for the transformation and for each iteration. */
+TEST(ManifoldOptimizerType1, RecordPhaseTimes) {
+  using namespace so2_scenario;
+  auto costs = get_graph(-2, 0);
+  auto constraints = get_constraints();
+
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+
+  LevenbergMarquardtParams nopt_params;
+  nopt_params.minModelFidelity = 0.5;
+  ManifoldOptimizerParameters mopt_params;
+  mopt_params.record_phase_times = true;
+  ManifoldOptimizerType1 optimizer(mopt_params, nopt_params);
+  gtdynamics::ConstrainedOptResult intermediate_result;
+  auto result = optimizer.optimize(*costs, *constraints, init_values,
+                                   &intermediate_result);
+  EXPECT(assert_equal(-1.0, result.atDouble(x1_key), 1e-5));
+
+  for (const std::string phase :
+       {"identify_components", "construct_manifolds", "substitute_costs",
+        "linearize", "solve", "retract"}) {
+    EXPECT(intermediate_result.phase_times.count(phase) == 1);
+  }
+  EXPECT(!intermediate_result.iteration_phase_times.empty());
+  for (const auto& phase_times : intermediate_result.iteration_phase_times) {
+    EXPECT(phase_times.count("linearize") == 1);
+  }
+}
+
+/** A manifold that the steps leave alone is not retracted. */
+TEST(ManifoldOptimizerType1, SkipRetraction) {
+  using namespace so2_scenario;
+  auto costs = get_graph(-2, 0);
+  auto constraints = get_constraints();
+
+  // A second circle, already at the minimum of its costs.
+  Key x3_key = 3, x4_key = 4;
+  Double_ x3(x3_key), x4(x4_key);
+  constraints->emplace_shared<gtdynamics::DoubleExpressionEquality>(
+      Double_(dist_square_func, x3, x4) - Double_(1.0), 1e-3);
+  auto model = noiseModel::Isotropic::Sigma(1, 1.0);
+  costs->addPrior(x3_key, 1.0, model);
+  costs->addPrior(x4_key, 0.0, model);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+  init_values.insert(x3_key, 1.0);
+  init_values.insert(x4_key, 0.0);
+
+  LevenbergMarquardtParams nopt_params;
+  nopt_params.minModelFidelity = 0.5;
+  ManifoldOptimizerParameters mopt_params;
+  mopt_params.record_phase_times = true;
+  ManifoldOptimizerType1 optimizer(mopt_params, nopt_params);
+  gtdynamics::ConstrainedOptResult intermediate_result;
+  auto result = optimizer.optimize(*costs, *constraints, init_values,
+                                   &intermediate_result);
+  EXPECT(assert_equal(-1.0, result.atDouble(x1_key), 1e-5));
+  EXPECT(assert_equal(1.0, result.atDouble(x3_key), 1e-9));
+
+  // Every step retracts both manifolds, and skips the second one.
+  const size_t retractions = intermediate_result.counts.at("retractions");
+  const size_t skipped = intermediate_result.counts.at("skipped_retractions");
+  EXPECT(retractions > 0);
+  EXPECT_LONGS_EQUAL(retractions / 2, skipped);
+}
+
+/** Cost factors on the same manifold are substituted as one stacked factor,
+ * which gives the same result. */
+TEST(ManifoldOptimizerType1, GroupCostFactors) {
+  using namespace so2_scenario;
+  auto costs = get_graph(-2, 0);
+  auto constraints = get_constraints();
+
+  Values init_values;
+  init_values.insert(x1_key, 0.8);
+  init_values.insert(x2_key, 0.6);
+
+  LevenbergMarquardtParams nopt_params;
+  nopt_params.minModelFidelity = 0.5;
+  ManifoldOptimizerParameters mopt_params;
+  ManifoldOptimizerType1 optimizer(mopt_params, nopt_params);
+  mopt_params.group_cost_factors = true;
+  ManifoldOptimizerType1 grouped_optimizer(mopt_params, nopt_params);
+
+  auto mopt_problem = grouped_optimizer.initializeMoptProblem(
+      *costs, *constraints, init_values);
+  EXPECT_LONGS_EQUAL(1, mopt_problem.graph_.size());
+
+  auto expected = optimizer.optimize(*costs, *constraints, init_values);
+  auto actual = grouped_optimizer.optimize(*costs, *constraints, init_values);
+  EXPECT(assert_equal(expected, actual, 1e-6));
+}
+
 /** Optimization using Type1 manifold optimizer, infeasible. */
 TEST(ManifoldOptimizerType1_infeasible, SO2) {
   using namespace so2_scenario;
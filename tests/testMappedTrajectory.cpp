@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMappedTrajectory.cpp
+ * @brief Test memory mapped columnar trajectory files.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/MappedTrajectory.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+/// Columns are views of the values that were written.
+TEST(MappedTrajectory, WriteAndMap) {
+  const Robot robot = simple_rr::getRobot();
+  const size_t num_steps = 4;
+  gtsam::Values values;
+  for (size_t k = 0; k < num_steps; k++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, k, j + 0.1 * k);
+      InsertJointVel(&values, j, k, j + 0.2 * k);
+      InsertJointAccel(&values, j, k, j + 0.3 * k);
+      InsertTorque(&values, j, k, j + 0.4 * k);
+    }
+  }
+  const gtsam::Vector dts =
+      (gtsam::Vector(4) << 0.1, 0.1, 0.2, 0.2).finished();
+
+  const auto path = std::filesystem::temp_directory_path() /
+                    "gtdynamics_test_mapped_trajectory.bin";
+  {
+    std::ofstream os(path, std::ios::binary);
+    MappedTrajectory::Write(os, robot, values, dts);
+  }
+
+  const MappedTrajectory trajectory(path.string());
+  EXPECT_LONGS_EQUAL(num_steps, trajectory.numSteps());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), trajectory.numJoints());
+  EXPECT(assert_equal(dts, gtsam::Vector(trajectory.dts())));
+  EXPECT(assert_equal(gtsam::Vector2(0.1, 0.2),
+                      gtsam::Vector(trajectory.dts(1, 3))));
+
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (size_t k = 0; k < num_steps; k++) {
+      EXPECT_DOUBLES_EQUAL(JointAngle(values, j, k),
+                           trajectory.at(MappedTrajectory::ANGLE, j, k), 0);
+      EXPECT_DOUBLES_EQUAL(Torque(values, j, k),
+                           trajectory.at(MappedTrajectory::TORQUE, j, k), 0);
+    }
+    const auto accels =
+        trajectory.column(MappedTrajectory::ACCELERATION, j, 2);
+    EXPECT_LONGS_EQUAL(2, accels.size());
+    EXPECT_DOUBLES_EQUAL(JointAccel(values, j, 3), accels(1), 0);
+  }
+  THROWS_EXCEPTION(trajectory.at(MappedTrajectory::VELOCITY, 99, 0));
+  THROWS_EXCEPTION(trajectory.at(MappedTrajectory::VELOCITY, 0, num_steps));
+
+  // A file of another format is rejected.
+  {
+    std::ofstream os(path, std::ios::binary);
+    os << "not a trajectory file";
+  }
+  THROWS_EXCEPTION(std::make_shared<MappedTrajectory>(path.string()));
+  std::filesystem::remove(path);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
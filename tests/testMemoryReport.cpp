@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMemoryReport.cpp
+ * @brief Test the approximate memory of graphs and values.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MemoryReport.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/expressions.h>
+
+#include <sstream>
+
+using namespace gtsam;
+using namespace gtdynamics;
+
+TEST(MemoryReport, report) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 10; k++) {
+    graph.emplace_shared<BetweenFactor<Pose3>>(
+        k - 1, k, Pose3(Rot3(), Point3(1, 0, 0)), noise);
+    values.insert(k, Pose3(Rot3(), Point3(k, 0, 0)));
+  }
+  const Pose3_ first(Key(0)), last(Key(9));
+  graph.emplace_shared<ExpressionFactor<Pose3>>(
+      noiseModel::Isotropic::Sigma(6, 0.1), Pose3(Rot3(), Point3(9, 0, 0)),
+      between(first, last));
+  values.insert(10, 1.0);
+
+  const MemoryReport report = ReportMemory(graph, values);
+
+  // One prior, the between factors and the expression factor.
+  size_t num_factors = 0;
+  for (const auto &category : report.factors()) {
+    num_factors += category.second.count;
+    EXPECT(category.second.bytes > 0);
+  }
+  EXPECT_LONGS_EQUAL(11, num_factors);
+  EXPECT_LONGS_EQUAL(3, report.factors().size());
+
+  // Poses and the double, by value type.
+  EXPECT_LONGS_EQUAL(2, report.values().size());
+  size_t num_values = 0;
+  for (const auto &category : report.values()) {
+    num_values += category.second.count;
+  }
+  EXPECT_LONGS_EQUAL(11, num_values);
+
+  // All factors linearize to Jacobians, of 6 rows and up to 13 columns.
+  EXPECT_LONGS_EQUAL(1, report.linearFactors().size());
+  const MemoryEntry &jacobians = report.linearFactors().begin()->second;
+  EXPECT_LONGS_EQUAL(11, jacobians.count);
+  EXPECT(jacobians.bytes > 11 * 6 * 7 * sizeof(double));
+  EXPECT(!report.bayesTree().empty());
+
+  EXPECT_LONGS_EQUAL(MemoryReport::TotalBytes(report.factors()) +
+                         MemoryReport::TotalBytes(report.values()) +
+                         MemoryReport::TotalBytes(report.linearFactors()) +
+                         MemoryReport::TotalBytes(report.bayesTree()),
+                     report.totalBytes());
+
+  std::stringstream ss;
+  report.print(ss);
+  EXPECT(ss.str().find("total") != std::string::npos);
+
+  // Without linearizing, only the graph and values are reported.
+  const MemoryReport unlinearized = ReportMemory(graph, values, false);
+  EXPECT(unlinearized.linearFactors().empty());
+  EXPECT(unlinearized.bayesTree().empty());
+}
+
+// A noise model shared among factors is counted once.
+TEST(MemoryReport, sharedNoiseModel) {
+  auto noise = noiseModel::Diagonal::Sigmas(Vector6::Constant(0.1));
+  NonlinearFactorGraph shared, separate;
+  for (Key k = 0; k < 4; k++) {
+    shared.addPrior<Pose3>(k, Pose3(), noise);
+    separate.addPrior<Pose3>(
+        k, Pose3(), noiseModel::Diagonal::Sigmas(Vector6::Constant(0.1)));
+  }
+  MemoryReport shared_report, separate_report;
+  shared_report.addGraph(shared);
+  separate_report.addGraph(separate);
+  EXPECT(shared_report.totalBytes() < separate_report.totalBytes());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
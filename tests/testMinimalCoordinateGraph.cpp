@@ -0,0 +1,213 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMinimalCoordinateGraph.cpp
+ * @brief Test dynamics graphs on base and joint states only.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/MinimalCoordinateGraph.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Whether all factors of graph have an unwhitened error below tol at values.
+bool Satisfied(const NonlinearFactorGraph& graph, const Values& values,
+               double tol) {
+  for (auto&& factor : graph) {
+    auto noise_factor =
+        std::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (noise_factor && noise_factor->unwhitenedError(values).norm() > tol) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Solve graph from values, and add the link quantities of time step 0.
+Values SolveAndExpand(const MinimalCoordinateGraph& builder,
+                      const NonlinearFactorGraph& graph, const Values& values,
+                      const std::optional<PointOnLinks>& contact_points = {}) {
+  Values result = gtsam::LevenbergMarquardtOptimizer(graph, values).optimize();
+  result.insert(builder.linkValues(result, 0, contact_points));
+  return result;
+}
+}  // namespace
+
+// Inverse dynamics of a fixed-base tree satisfy the maximal-coordinate graph.
+TEST(MinimalCoordinateGraph, inverseDynamics) {
+  const Robot robot = BranchedRobot(6, 2);
+  const OptimizerSetting opt;
+  MinimalCoordinateGraph builder(robot, "base", opt, kGravity);
+  EXPECT(!builder.floatingBase());
+
+  NonlinearFactorGraph graph = builder.dynamicsFactorGraph(0);
+  EXPECT_LONGS_EQUAL(robot.numJoints(), graph.size());
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior(JointAngleKey(j), 0.1 * j, opt.prior_q_cost_model);
+    graph.addPrior(JointVelKey(j), 0.3 - 0.1 * j, opt.prior_qv_cost_model);
+    graph.addPrior(JointAccelKey(j), 0.5 * j - 1.0, opt.prior_qa_cost_model);
+    InsertJointAngle(&values, j, 0.1 * j);
+    InsertJointVel(&values, j, 0.3 - 0.1 * j);
+    InsertJointAccel(&values, j, 0.5 * j - 1.0);
+    InsertTorque(&values, j, 0.0);
+  }
+  EXPECT_LONGS_EQUAL(4 * robot.numJoints(), graph.keys().size());
+
+  const Values result = SolveAndExpand(builder, graph, values);
+  const DynamicsGraph maximal(opt, kGravity);
+  EXPECT(Satisfied(maximal.dynamicsFactorGraph(robot, 0), result, 1e-6));
+}
+
+// Forward dynamics of a floating legged robot in flight.
+TEST(MinimalCoordinateGraph, floatingBase) {
+  const Robot robot = LeggedRobot(4, 3);
+  const OptimizerSetting opt;
+  MinimalCoordinateGraph builder(robot, "base", opt, kGravity);
+  EXPECT(builder.floatingBase());
+
+  NonlinearFactorGraph graph = builder.dynamicsFactorGraph(0);
+  EXPECT_LONGS_EQUAL(robot.numJoints() + 1, graph.size());
+  const int b = robot.link("base")->id();
+  const Pose3 wTb(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.2, 0, 1));
+  const Vector6 twist_b =
+      (Vector6() << 0.1, 0.2, -0.1, 0.5, 0, -0.3).finished();
+  graph.addPrior(PoseKey(b), wTb, opt.bp_cost_model);
+  graph.addPrior(TwistKey(b), twist_b, opt.bv_cost_model);
+  Values values;
+  InsertPose(&values, b, wTb);
+  InsertTwist(&values, b, twist_b);
+  InsertTwistAccel(&values, b, Vector6::Zero());
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior(JointAngleKey(j), 0.1 * j, opt.prior_q_cost_model);
+    graph.addPrior(JointVelKey(j), 0.2 - 0.05 * j, opt.prior_qv_cost_model);
+    graph.addPrior(TorqueKey(j), 0.4 - 0.1 * j, opt.prior_t_cost_model);
+    InsertJointAngle(&values, j, 0.1 * j);
+    InsertJointVel(&values, j, 0.2 - 0.05 * j);
+    InsertJointAccel(&values, j, 0.0);
+    InsertTorque(&values, j, 0.4 - 0.1 * j);
+  }
+
+  const Values result = SolveAndExpand(builder, graph, values);
+  const DynamicsGraph maximal(opt, kGravity);
+  EXPECT(Satisfied(maximal.dynamicsFactorGraph(robot, 0), result, 1e-6));
+}
+
+// A1 standing on four feet, with contact kinematics and dynamics.
+TEST(MinimalCoordinateGraph, contacts) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const Point3 contact_in_com(0, 0, -0.07);
+  PointOnLinks contact_points;
+  for (auto&& name : {"FR_lower", "FL_lower", "RR_lower", "RL_lower"}) {
+    contact_points.emplace_back(robot.link(name), contact_in_com);
+  }
+
+  // Raise the trunk so that the feet touch the ground with straight legs.
+  Values zero;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&zero, joint->id(), 0.0);
+    InsertJointVel(&zero, joint->id(), 0.0);
+  }
+  const Values fk = robot.forwardKinematics(zero, 0, std::string("trunk"));
+  const double foot_z =
+      Pose(fk, robot.link("FR_lower")->id()).transformFrom(contact_in_com).z();
+  const Pose3 wTb(Rot3(), Point3(0, 0, -foot_z));
+
+  const OptimizerSetting opt;
+  MinimalCoordinateGraph builder(robot, "trunk", opt, kGravity);
+  NonlinearFactorGraph graph = builder.dynamicsFactorGraph(0, contact_points);
+  const int b = robot.link("trunk")->id();
+  graph.addPrior(PoseKey(b), wTb, opt.bp_cost_model);
+  graph.addPrior(TwistKey(b), Vector6::Zero().eval(), opt.bv_cost_model);
+  Values values;
+  InsertPose(&values, b, wTb);
+  InsertTwist(&values, b, Vector6::Zero());
+  InsertTwistAccel(&values, b, Vector6::Zero());
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior(JointAngleKey(j), 0.0, opt.prior_q_cost_model);
+    graph.addPrior(JointVelKey(j), 0.0, opt.prior_qv_cost_model);
+    graph.addPrior(JointAccelKey(j), 0.0, opt.prior_qa_cost_model);
+    InsertJointAngle(&values, j, 0.0);
+    InsertJointVel(&values, j, 0.0);
+    InsertJointAccel(&values, j, 0.0);
+    InsertTorque(&values, j, 0.0);
+  }
+  // The contact wrenches are statically indeterminate: prefer small ones.
+  for (auto&& cp : contact_points) {
+    const gtsam::Key key = ContactWrenchKey(cp.link->id(), 0, 0);
+    graph.addPrior(key, Vector6::Zero().eval(),
+                   gtsam::noiseModel::Isotropic::Sigma(6, 100.0));
+    values.insert(key, Vector6::Zero().eval());
+  }
+
+  const Values result = SolveAndExpand(builder, graph, values, contact_points);
+  const DynamicsGraph maximal(opt, kGravity);
+  EXPECT(Satisfied(maximal.dynamicsFactorGraph(robot, 0, contact_points),
+                   result, 1e-4));
+
+  // The feet carry the weight of the robot.
+  double mass = 0.0;
+  for (auto&& link : robot.links()) mass += link->mass();
+  double normal = 0.0;
+  for (auto&& cp : contact_points) {
+    const int i = cp.link->id();
+    const gtsam::Vector3 force =
+        result.at<Vector6>(ContactWrenchKey(i, 0, 0)).tail<3>();
+    normal += Pose(result, i).rotation().rotate(force).z();
+  }
+  EXPECT_DOUBLES_EQUAL(9.8 * mass, normal, 1e-3);
+}
+
+// Variables of a trajectory, compared to DynamicsGraph.
+TEST(MinimalCoordinateGraph, trajectoryFG) {
+  const Robot robot = LeggedRobot(4, 3);
+  const int num_steps = 3;
+  MinimalCoordinateGraph builder(robot, "base", OptimizerSetting(), kGravity);
+  const auto graph = builder.trajectoryFG(num_steps, 0.1);
+  const size_t per_step = 3 + 4 * robot.numJoints();
+  EXPECT_LONGS_EQUAL(per_step * (num_steps + 1), graph.keys().size());
+
+  const DynamicsGraph maximal(OptimizerSetting(), kGravity);
+  const auto maximal_graph = maximal.trajectoryFG(robot, num_steps, 0.1);
+  const size_t maximal_per_step = 3 * robot.numLinks() + 6 * robot.numJoints();
+  EXPECT_LONGS_EQUAL(maximal_per_step * (num_steps + 1),
+                     maximal_graph.keys().size());
+}
+
+// Joints must point away from the base.
+TEST(MinimalCoordinateGraph, invalidBase) {
+  const Robot robot = LeggedRobot(4, 3);
+  THROWS_EXCEPTION(MinimalCoordinateGraph(robot, "leg1_link3"));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMotionPrimitiveLibrary.cpp
+ * @brief Test precomputed motion primitives of the Vision60 quadruped.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/MotionPrimitiveLibrary.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+
+MotionPrimitiveLibraryParameters Parameters() {
+  MotionPrimitiveLibraryParameters parameters;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"}) {
+    parameters.feet.emplace_back(robot.link(name), Point3(0.14, 0, 0));
+  }
+  parameters.gaits = {Gait{{0, 3}, {1, 2}}};  // trot: diagonal pairs
+  parameters.step_lengths = {0.0, 0.05};
+  parameters.headings = {0.0, M_PI_2};
+  parameters.num_samples = 5;
+  parameters.execution = ExecutionContext::Threads(1);
+  return parameters;
+}
+
+MotionPrimitive Primitive(size_t gait, double step_length, double heading,
+                          double q) {
+  MotionPrimitive primitive;
+  primitive.parameters = {gait, step_length, heading};
+  primitive.joint_angles = {Vector::Constant(2, 0), Vector::Constant(2, q)};
+  return primitive;
+}
+}  // namespace
+
+// Lookup is by displacement, and blends the nearest primitives.
+TEST(MotionPrimitiveLibrary, nearest) {
+  MotionPrimitiveLibrary library({1, 2}, 0);
+  library.add(Primitive(0, 0.1, 0.0, 1.0));
+  library.add(Primitive(0, 0.1, M_PI_2, 2.0));
+  library.add(Primitive(1, 0.1, 0.0, 3.0));
+  THROWS_EXCEPTION(library.add(MotionPrimitive()));
+
+  // Headings wrap around, and other gaits are not considered.
+  MotionPrimitiveParameters query{0, 0.1, 2 * M_PI - 0.01};
+  EXPECT(std::vector<size_t>({0, 1}) == library.nearest(query, 3));
+  EXPECT(library.nearest({2, 0.1, 0.0}).empty());
+  THROWS_EXCEPTION(library.jointAngles(MotionPrimitiveParameters{2}, 0.5));
+
+  // Samples are interpolated, primitives of the query are returned as is.
+  EXPECT(assert_equal(Vector::Constant(2, 0.5), library.jointAngles(0, 0.5)));
+  EXPECT(assert_equal(Vector::Constant(2, 2.0),
+                      library.jointAngles({0, 0.1, M_PI_2}, 1.0)));
+
+  // Halfway, both neighbors have the same weight.
+  const Vector q = library.jointAngles({0, 0.1, M_PI_4}, 1.0, 2);
+  EXPECT(assert_equal(Vector::Constant(2, 1.5), q, 1e-9));
+
+  // Retargeting moves the body along the displacement from the start.
+  const Pose3 wTb_start(gtsam::Rot3::Yaw(M_PI_2), Point3(1, 2, 0.3));
+  const gtsam::Values values =
+      library.values({0, 0.1, 0.0}, 0.5, wTb_start, 7);
+  EXPECT(assert_equal(Point3(1, 2.05, 0.3), Pose(values, 0, 7).translation(),
+                      1e-9));
+  EXPECT_DOUBLES_EQUAL(0.5, JointAngle(values, 2, 7), 1e-9);
+}
+
+// The goals start at rest, and end with the feet moved like the body.
+TEST(MotionPrimitiveLibrary, SampleGoals) {
+  const auto parameters = Parameters();
+  const MotionPrimitiveParameters primitive{0, 0.1, M_PI_2};
+  const ContactGoals start =
+      MotionPrimitiveLibrary::SampleGoals(robot, parameters, primitive, 0.0);
+  const ContactGoals end =
+      MotionPrimitiveLibrary::SampleGoals(robot, parameters, primitive, 1.0);
+  EXPECT_LONGS_EQUAL(3 + 4, start.size());
+  gtsam::Values rest;
+  for (auto &&link : robot.links()) {
+    InsertPose(&rest, link->id(), link->bMcom());
+  }
+  const Point3 d = robot.link("body")->bMcom().rotation() * Point3(0, 0.1, 0);
+  for (size_t i = 0; i < start.size(); i++) {
+    EXPECT(start[i].satisfied(rest, 0, 1e-9));
+    EXPECT(assert_equal(Point3(start[i].goal_point + d), end[i].goal_point,
+                        1e-9));
+  }
+
+  // Halfway, the first pair, goals 3 and 4, has landed and the second lifts
+  // off.
+  const ContactGoals half =
+      MotionPrimitiveLibrary::SampleGoals(robot, parameters, primitive, 0.5);
+  EXPECT(assert_equal(end[4].goal_point, half[4].goal_point, 1e-9));
+  EXPECT(assert_equal(start[5].goal_point, half[5].goal_point, 1e-9));
+
+  auto bad = primitive;
+  bad.gait = 1;
+  THROWS_EXCEPTION(
+      MotionPrimitiveLibrary::SampleGoals(robot, parameters, bad, 0.5));
+}
+
+// Retargeted primitives place the feet on their goals, and survive a file.
+TEST(MotionPrimitiveLibrary, Generate) {
+  const auto parameters = Parameters();
+  const MotionPrimitiveLibrary library =
+      MotionPrimitiveLibrary::Generate(robot, parameters);
+  EXPECT_LONGS_EQUAL(1 + 2, library.size());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), library.jointIds().size());
+  EXPECT_LONGS_EQUAL(robot.link("body")->id(), library.bodyId());
+
+  const MotionPrimitiveParameters query{0, 0.05, M_PI_2};
+  const double s = 0.75;
+  gtsam::Values values = library.values(query, s, robot.link("body")->bMcom());
+  for (auto &&link : robot.links()) {
+    InsertTwist(&values, link->id(), 0, gtsam::Z_6x1);
+  }
+  const gtsam::Values fk =
+      robot.forwardKinematics(values, 0, std::string("body"));
+  const ContactGoals goals =
+      MotionPrimitiveLibrary::SampleGoals(robot, parameters, query, s);
+  for (size_t i = 3; i < goals.size(); i++) {
+    EXPECT(goals[i].satisfied(fk, 0, 0.02));
+  }
+
+  const std::string path = "motion_primitives.bin";
+  library.save(path);
+  const MotionPrimitiveLibrary loaded = MotionPrimitiveLibrary::Load(path);
+  std::remove(path.c_str());
+  EXPECT_LONGS_EQUAL(library.size(), loaded.size());
+  EXPECT(library.jointIds() == loaded.jointIds());
+  EXPECT(assert_equal(library.jointAngles(query, s),
+                      loaded.jointAngles(query, s)));
+  THROWS_EXCEPTION(MotionPrimitiveLibrary::Load("no_such_library.bin"));
+
+  auto bad_gait = parameters;
+  bad_gait.gaits = {Gait{{0, 1}, {1, 2}}};
+  THROWS_EXCEPTION(MotionPrimitiveLibrary::Generate(robot, bad_gait));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -68,6 +68,43 @@ TEST(MultiJacobian, ComputeBayesNetJacobian) {
   EXPECT(jacobians.at(x5).equals(jacobian_x5));
 }
 
+/// Test the flat jacobians against the map-based ones.
+TEST(MultiJacobian, ComputeBayesNetJacobianFlat) {
+  Key x1 = 1, x2 = 2, x3 = 3, x4 = 4, x5 = 5;
+  GaussianFactorGraph graph;
+  auto model1 = noiseModel::Isotropic::Sigma(1, 1.0);
+  auto model2 = noiseModel::Isotropic::Sigma(2, 1.0);
+  graph.add(
+      JacobianFactor(x1, I_1x1, x2, I_1x1, x3, -I_1x1, Vector1(0), model1));
+  Matrix21 H_3, H_4;
+  H_3 << 1, 0;
+  H_4 << 0, 1;
+  graph.add(
+      JacobianFactor(x3, H_3, x4, H_4, x5, -I_2x2, Vector2(0, 0), model2));
+
+  Ordering ordering;
+  ordering.push_back(x5);
+  ordering.push_back(x3);
+  auto bayes_net = graph.eliminatePartialSequential(ordering).first;
+
+  KeyVector basis_keys{x4, x1, x2};
+  std::map<Key, size_t> var_dim{{x1, 1}, {x2, 1}, {x3, 1}, {x4, 1}, {x5, 2}};
+  FlatMultiJacobians jacobians;
+  ComputeBayesNetJacobian(*bayes_net, basis_keys, var_dim, jacobians);
+  EXPECT_LONGS_EQUAL(6, jacobians.rows());
+  EXPECT_LONGS_EQUAL(3, jacobians.cols());
+
+  // Columns follow the order of the basis keys.
+  EXPECT(assert_equal(Matrix13(0, 1, 0), Matrix(jacobians.jacobian(x1))));
+  EXPECT(assert_equal(Matrix13(1, 0, 0), Matrix(jacobians.jacobian(x4))));
+  EXPECT(assert_equal(Matrix13(0, 1, 1), Matrix(jacobians.jacobian(x3))));
+  EXPECT(assert_equal(Matrix(H_4), Matrix(jacobians.jacobian(x5, x4))));
+  EXPECT(assert_equal(Matrix(H_3), Matrix(jacobians.jacobian(x5, x2))));
+  EXPECT(jacobians.exists(x5));
+  EXPECT(!jacobians.exists(6));
+  THROWS_EXCEPTION(jacobians.jacobian(6));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
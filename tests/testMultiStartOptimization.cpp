@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiStartOptimization.cpp
+ * @brief Test multi-start optimization with early abandonment.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MultiStartOptimization.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+// Residuals x (x - 3) and 0.1 x: a global minimum at x = 0 with zero error,
+// and a local one near x = 3 with an error of about 0.045.
+gtsam::NonlinearFactorGraph TwoWells() {
+  using namespace constrained_example;
+  gtsam::NonlinearFactorGraph graph;
+  auto model = gtsam::noiseModel::Unit::Create(1);
+  graph.add(gtsam::ExpressionFactor<double>(model, 0.,
+                                            pow(x1, 2.0) + (-3.0) * x1));
+  graph.add(gtsam::ExpressionFactor<double>(model, 0., 0.1 * x1));
+  return graph;
+}
+
+std::vector<Values> Starts(const std::vector<double> &xs) {
+  std::vector<Values> starts;
+  for (double x : xs) {
+    Values values;
+    values.insert(constrained_example::x1_key, x);
+    starts.push_back(values);
+  }
+  return starts;
+}
+
+TEST(MultiStartOptimize, best) {
+  const auto graph = TwoWells();
+  const auto starts = Starts({2.5, 4.0, -1.0, 3.5});
+  MultiStartParameters parameters;
+  parameters.execution.num_threads = 4;
+  const MultiStartResult result =
+      MultiStartOptimize(graph, starts, gtsam::MutableLMParams(), parameters);
+  EXPECT_LONGS_EQUAL(2, result.best);
+  EXPECT_LONGS_EQUAL(4, result.starts.size());
+  EXPECT_DOUBLES_EQUAL(
+      0.0, result.values.at<double>(constrained_example::x1_key), 1e-6);
+  EXPECT_DOUBLES_EQUAL(graph.error(result.values), result.error, 1e-12);
+}
+
+TEST(MultiStartOptimize, abandonment) {
+  // On one thread the good start runs first, and the others are abandoned
+  // at the end of their grace iterations.
+  const auto graph = TwoWells();
+  const auto starts = Starts({-1.0, 2.5, 4.0});
+  MultiStartParameters parameters;
+  parameters.execution.num_threads = 1;
+  parameters.grace_iterations = 2;
+  const MultiStartResult result =
+      MultiStartOptimize(graph, starts, gtsam::MutableLMParams(), parameters);
+  EXPECT_LONGS_EQUAL(0, result.best);
+  EXPECT(!result.starts[0].abandoned);
+  for (size_t i = 1; i < 3; ++i) {
+    EXPECT(result.starts[i].abandoned);
+    EXPECT_LONGS_EQUAL(2, result.starts[i].iterations);
+  }
+
+  // Without abandonment they converge to the local minimum.
+  parameters.abandon_ratio = 0.0;
+  const MultiStartResult all =
+      MultiStartOptimize(graph, starts, gtsam::MutableLMParams(), parameters);
+  for (size_t i = 1; i < 3; ++i) {
+    EXPECT(!all.starts[i].abandoned);
+    EXPECT_DOUBLES_EQUAL(0.045, all.starts[i].error, 1e-3);
+  }
+
+  THROWS_EXCEPTION(MultiStartOptimize(graph, {}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultipleShooting.cpp
+ * @brief Test trajectory optimization by multiple shooting.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/MultipleShooting.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+const double kDt = 0.01;
+}  // namespace
+
+// The Jacobians are the sensitivities of the rollout.
+TEST(ShootingFactor, Jacobians) {
+  const Robot robot = SerialChainRobot(3);
+  const RecursiveDynamics dynamics(robot, kGravity);
+  const std::vector<int> joints{0, 1, 2};
+  for (auto scheme : {TaylorStep, SemiImplicitEuler}) {
+    const ShootingFactor factor(
+        dynamics, joints, 2, 5, 0.05,
+        gtsam::noiseModel::Isotropic::Sigma(6, 1.0), scheme);
+    EXPECT_LONGS_EQUAL(6 + 3 * 3 + 6, factor.size());
+    Values values;
+    for (int j : joints) {
+      InsertJointAngle(&values, j, 2, 0.3 * j - 0.2);
+      InsertJointVel(&values, j, 2, 0.5 - 0.4 * j);
+      InsertJointAngle(&values, j, 5, 0.1 * j);
+      InsertJointVel(&values, j, 5, -0.2);
+      for (int k = 2; k < 5; k++) InsertTorque(&values, j, k, 0.5 * k - j);
+    }
+    EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-6, 1e-5);
+  }
+  THROWS_EXCEPTION(ShootingFactor(dynamics, joints, 0, 1, kDt,
+                                  gtsam::noiseModel::Isotropic::Sigma(6, 1.0),
+                                  RungeKutta4));
+}
+
+// Rollouts of the segments make up the simulation of the whole trajectory.
+TEST(MultipleShooting, simulation) {
+  const Robot robot = SerialChainRobot(3);
+  const MultipleShooting shooting(robot, kGravity, kDt, 4);
+  const int num_steps = 10;
+  EXPECT(std::vector<int>({0, 4, 8, 10}) == shooting.boundarySteps(num_steps));
+
+  Matrix torques(num_steps, shooting.numJoints());
+  for (int k = 0; k < num_steps; k++) {
+    torques.row(k) << 1.0, -0.5 + 0.1 * k, 0.2;
+  }
+  Values state;
+  InsertJointAngle(&state, 1, 0.3);
+  InsertJointVel(&state, 2, -0.4);
+  const Values values = shooting.initialValues(state, torques);
+  const auto graph = shooting.shootingFactors(num_steps);
+  EXPECT_LONGS_EQUAL(3, graph.size());
+  EXPECT_DOUBLES_EQUAL(0.0, graph.error(values), 1e-12);
+
+  Simulator simulator(robot, state, kGravity);
+  JointTrajectory expected;
+  simulator.simulate(torques, kDt, &expected);
+  const JointTrajectory actual =
+      shooting.trajectory(values, num_steps, ExecutionContext::Threads(2));
+  EXPECT(assert_equal(expected.q, actual.q, 1e-9));
+  EXPECT(assert_equal(expected.v, actual.v, 1e-9));
+  EXPECT(assert_equal(expected.a, actual.a, 1e-9));
+}
+
+// Optimize torques to reach a target, on boundary states only.
+TEST(MultipleShooting, optimize) {
+  const Robot robot = SerialChainRobot(2);
+  const MultipleShooting shooting(robot, kGravity, kDt, 5);
+  const int num_steps = 20;
+  NonlinearFactorGraph graph = shooting.shootingFactors(num_steps);
+  auto tight = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  auto loose = gtsam::noiseModel::Isotropic::Sigma(1, 10.0);
+  for (int j : shooting.joints()) {
+    graph.addPrior(JointAngleKey(j, 0), 0.0, tight);
+    graph.addPrior(JointVelKey(j, 0), 0.0, tight);
+    graph.addPrior(JointAngleKey(j, num_steps), 0.1, tight);
+    graph.addPrior(JointVelKey(j, num_steps), 0.0, tight);
+    for (int k = 0; k < num_steps; k++) {
+      graph.addPrior(TorqueKey(j, k), 0.0, loose);
+    }
+  }
+  const Values init = shooting.initialValues(
+      Values(), Matrix::Zero(num_steps, shooting.numJoints()));
+  EXPECT_LONGS_EQUAL(4 * 5 + num_steps * 2, init.size());
+
+  const Values result = gtsam::MutableLMOptimizer(graph, init).optimize();
+  const JointTrajectory trajectory = shooting.trajectory(result, num_steps);
+  for (int j : shooting.joints()) {
+    EXPECT_DOUBLES_EQUAL(0.1, trajectory.q(num_steps, j), 1e-3);
+    EXPECT_DOUBLES_EQUAL(0.0, trajectory.v(num_steps, j), 1e-3);
+  }
+  for (int k : shooting.boundarySteps(num_steps)) {
+    for (int j : shooting.joints()) {
+      EXPECT_DOUBLES_EQUAL(JointAngle(result, j, k), trajectory.q(k, j), 1e-3);
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -13,16 +13,26 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ConstVarFactor.h>
 #include <gtdynamics/manifold/ConstraintManifold.h>
 #include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/optimizer/OptimizerLog.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/utils/Initializer.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/base/numericalDerivative.h>
 #include <gtsam/nonlinear/Expression.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/SubgraphSolver.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/LinearContainerFactor.h>
 #include <gtsam/slam/BetweenFactor.h>
 
+#include <cstdio>
+#include <sstream>
+#include <string>
+
 using namespace gtsam;
 using namespace gtdynamics;
 
@@ -52,6 +62,325 @@ TEST(MutableLMOptimizer, optimize) {
   EXPECT(assert_equal(expected_result, result));
 }
 
+/** Parallel linearization gives the same linear graph, in the same order. */
+TEST(MutableLMOptimizer, parallelLinearize) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 20; k++) {
+    const Pose3 step(Rot3::Rz(0.1 * k), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(0.2 * k), Point3(k, 0, 0)));
+  }
+
+  MutableLMOptimizer serial(graph, values);
+  MutableLMParams params;
+  params.linearizationThreads = 4;
+  MutableLMOptimizer parallel(graph, values, params);
+  EXPECT(assert_equal(*serial.linearize(), *parallel.linearize()));
+  EXPECT(assert_equal(serial.optimize(), parallel.optimize()));
+}
+
+/** Profiling times every linearize and error call, by type of factor. */
+TEST(MutableLMOptimizer, profileFactors) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 20; k++) {
+    const Pose3 step(Rot3::Rz(0.1 * k), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(0.2 * k), Point3(k, 0, 0)));
+  }
+
+  const FactorProfile profile = ProfileFactors(graph, values, 3);
+  EXPECT_LONGS_EQUAL(2, profile.types().size());
+  EXPECT_LONGS_EQUAL(1, profile.types()[0].num_factors);
+  EXPECT_LONGS_EQUAL(19, profile.types()[1].num_factors);
+  EXPECT_LONGS_EQUAL(57, profile.types()[1].linearize_calls);
+  EXPECT_LONGS_EQUAL(57, profile.types()[1].error_calls);
+  EXPECT(profile.types()[1].category.find("BetweenFactor") !=
+         std::string::npos);
+  std::stringstream json;
+  profile.writeJson(json);
+  EXPECT(json.str().find("\"num_factors\": 19") != std::string::npos);
+
+  MutableLMParams params;
+  params.profileFactors = true;
+  MutableLMOptimizer expected(graph, values);
+  MutableLMOptimizer profiled(graph, values, params);
+  EXPECT(assert_equal(expected.optimize(), profiled.optimize()));
+  const auto &types = profiled.factorProfile().types();
+  EXPECT_LONGS_EQUAL(2, types.size());
+  EXPECT(types[0].linearize_calls >= 1);
+  EXPECT_LONGS_EQUAL(19 * types[0].linearize_calls, types[1].linearize_calls);
+  EXPECT(types[1].error_calls >= types[1].linearize_calls);
+}
+
+/** Factors whose variables barely moved keep their Jacobians, not errors. */
+TEST(MutableLMOptimizer, relinearizeThreshold) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 20; k++) {
+    const Pose3 step(Rot3::Rz(0.1 * k), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(0.2 * k), Point3(k, 0, 0)));
+  }
+
+  MutableLMParams params;
+  params.relinearizeThreshold = 1e-3;
+  MutableLMOptimizer selective(graph, values, params);
+  EXPECT(assert_equal(*MutableLMOptimizer(graph, values).linearize(),
+                      *selective.linearize()));
+  EXPECT_LONGS_EQUAL(20, selective.numRelinearized());
+
+  // A small move of one pose relinearizes nothing, but the errors are exact.
+  Values moved = values;
+  moved.update(5, values.at<Pose3>(5).retract(Vector6::Constant(1e-4)));
+  selective.setValues(moved);
+  auto linear = selective.linearize();
+  EXPECT_LONGS_EQUAL(0, selective.numRelinearized());
+  EXPECT_DOUBLES_EQUAL(graph.error(moved), linear->error(moved.zeroVectors()),
+                       1e-9);
+
+  // A larger move relinearizes the two factors on the pose.
+  moved.update(5, values.at<Pose3>(5).retract(Vector6::Constant(0.1)));
+  selective.setValues(moved);
+  linear = selective.linearize();
+  EXPECT_LONGS_EQUAL(2, selective.numRelinearized());
+  EXPECT(assert_equal(*MutableLMOptimizer(graph, moved).linearize(), *linear,
+                      1e-9));
+
+  MutableLMOptimizer expected(graph, values);
+  selective.setValues(values);
+  EXPECT(assert_equal(expected.optimize(), selective.optimize(), 1e-4));
+}
+
+/** The log is complete when optimize returns, in either format. */
+TEST(MutableLMOptimizer, logFile) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 20; k++) {
+    const Pose3 step(Rot3::Rz(0.1 * k), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(0.2 * k), Point3(k, 0, 0)));
+  }
+
+  for (LogFormat format : {CsvLog, BinaryLog}) {
+    MutableLMParams params;
+    params.logFile =
+        format == CsvLog ? "testMutableLM.csv" : "testMutableLM.log";
+    params.logFormat = format;
+    std::remove(params.logFile.c_str());
+    MutableLMOptimizer optimizer(graph, values, params);
+    optimizer.optimize();
+    const std::vector<OptimizerLogRecord> records =
+        ReadOptimizerLog(params.logFile, format);
+    EXPECT(!records.empty());
+    EXPECT_LONGS_EQUAL(0, records.front().inner_iterations);
+    EXPECT_DOUBLES_EQUAL(graph.error(values), records.front().error,
+                         1e-4 * graph.error(values));
+    EXPECT(records.back().error <= records.front().error);
+    std::remove(params.logFile.c_str());
+  }
+}
+
+/** Reusing the damped system across lambda retries follows GTSAM's LM. */
+TEST(MutableLMOptimizer, lambdaRetries) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 10; k++) {
+    const Pose3 step(Rot3::Rz(0.5), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(1.0 * k), Point3(0, k, 0)));
+  }
+
+  // A tiny initial lambda makes the first steps fail and be retried.
+  for (bool diagonalDamping : {false, true}) {
+    LevenbergMarquardtParams params;
+    params.lambdaInitial = 1e-8;
+    params.diagonalDamping = diagonalDamping;
+    LevenbergMarquardtOptimizer expected(graph, values, params);
+    MutableLMOptimizer actual(graph, values, params);
+    EXPECT(assert_equal(expected.optimize(), actual.optimize(), 1e-6));
+    EXPECT_LONGS_EQUAL(expected.getInnerIterations(),
+                       actual.getInnerIterations());
+  }
+}
+
+/** Graphs with the same structure keep the ordering, others get a new one. */
+TEST(MutableLMOptimizer, setGraphStructure) {
+  auto noise = noiseModel::Unit::Create(6);
+  auto chain = [&](size_t n, double scale) {
+    NonlinearFactorGraph graph;
+    graph.addPrior<Pose3>(0, Pose3(), noise);
+    for (Key k = 1; k < n; k++) {
+      graph.emplace_shared<BetweenFactor<Pose3>>(
+          k - 1, k, Pose3(Rot3(), Point3(0, 0, 1)),
+          noiseModel::Isotropic::Sigma(6, scale));
+    }
+    return graph;
+  };
+  auto zeros = [](size_t n) {
+    Values values;
+    for (Key k = 0; k < n; k++) values.insert(k, Pose3());
+    return values;
+  };
+
+  MutableLMOptimizer optimizer;
+  optimizer.setGraph(chain(3, 1.0));
+  const Ordering ordering = *optimizer.params().ordering;
+
+  // Reweighting keeps the structure and the ordering.
+  const NonlinearFactorGraph reweighted = chain(3, 0.1);
+  EXPECT(optimizer.sameStructure(reweighted));
+  optimizer.setGraph(reweighted);
+  EXPECT(assert_equal(ordering, *optimizer.params().ordering));
+  optimizer.setValues(zeros(3));
+  EXPECT(assert_equal(Pose3(Rot3(), Point3(0, 0, 2)),
+                      optimizer.optimize().at<Pose3>(2)));
+
+  // A longer chain gets an ordering with all of its keys.
+  const NonlinearFactorGraph longer = chain(5, 1.0);
+  EXPECT(!optimizer.sameStructure(longer));
+  optimizer.setGraph(longer);
+  EXPECT_LONGS_EQUAL(5, optimizer.params().ordering->size());
+  optimizer.setValues(zeros(5));
+  EXPECT(assert_equal(Pose3(Rot3(), Point3(0, 0, 4)),
+                      optimizer.optimize().at<Pose3>(4)));
+}
+
+/** The sparse backends assemble the normal equations of the damped system. */
+TEST(MutableLMOptimizer, linearSolverBackends) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 10; k++) {
+    const Pose3 step(Rot3::Rz(0.5), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    if (k > 2) {
+      graph.emplace_shared<BetweenFactor<Pose3>>(k - 3, k, step * step * step,
+                                                 noise);
+    }
+    values.insert(k, Pose3(Rot3::Rx(0.3 * k), Point3(0, k, 0)));
+  }
+
+  // Same normal equations as GTSAM's dense Hessian, in key order.
+  const auto linear = graph.linearize(values);
+  const SparseNormalEquations system = AssembleNormalEquations(*linear);
+  const auto [H, g] = linear->hessian(Ordering(system.keys));
+  EXPECT(assert_equal(H, Matrix(system.H), 1e-9));
+  EXPECT(assert_equal(g, system.g, 1e-9));
+
+  MutableLMParams params;
+  const Values expected = MutableLMOptimizer(graph, values, params).optimize();
+  for (auto backend :
+       {SimplicialBackend, CholmodBackend, PardisoBackend, PcgBackend}) {
+    params.linearSolverBackend = backend;
+    if (!SparseLinearSolver::Available(backend)) {
+      THROWS_EXCEPTION(SparseLinearSolver solver(backend));
+      continue;
+    }
+    MutableLMOptimizer optimizer(graph, values, params);
+    EXPECT(assert_equal(expected, optimizer.optimize(), 1e-6));
+  }
+
+  // GTSAM's subgraph preconditioned CG, through the elimination backend.
+  params.linearSolverBackend = EliminationBackend;
+  params.linearSolverType = NonlinearOptimizerParams::Iterative;
+  params.iterativeParams = std::make_shared<SubgraphSolverParameters>();
+  MutableLMOptimizer subgraph(graph, values, params);
+  EXPECT(assert_equal(expected, subgraph.optimize(), 1e-4));
+}
+
+/** With one time step, the block-Jacobi preconditioner of PCG is exact. */
+TEST(MutableLMOptimizer, pcgTimeStepBlocks) {
+  auto noise = noiseModel::Unit::Create(6);
+  auto chain = [&](bool same_time) {
+    GaussianFactorGraph graph;
+    for (size_t i = 0; i < 10; i++) {
+      const Key key = PoseKey(i, same_time ? 0 : i);
+      graph.add(key, Matrix::Identity(6, 6), Vector::Ones(6), noise);
+      if (i > 0) {
+        const Key previous = PoseKey(i - 1, same_time ? 0 : i - 1);
+        graph.add(previous, -Matrix::Identity(6, 6), key,
+                  Matrix::Identity(6, 6), Vector::Zero(6), noise);
+      }
+    }
+    return graph;
+  };
+
+  SparseLinearSolver pcg(PcgBackend), cholesky(SimplicialBackend);
+  const GaussianFactorGraph one_step = chain(true);
+  EXPECT(assert_equal(cholesky.solve(one_step), pcg.solve(one_step), 1e-9));
+  EXPECT_LONGS_EQUAL(1, pcg.iterations());
+
+  // One block per variable takes more iterations to the same solution.
+  const GaussianFactorGraph steps = chain(false);
+  EXPECT(assert_equal(cholesky.solve(steps), pcg.solve(steps), 1e-8));
+  EXPECT(pcg.iterations() > 1);
+}
+
+/** Fixed variables give the solution of the ConstVarGraph rewrite. */
+TEST(MutableLMOptimizer, fixedVariables) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values values, fixed_values;
+  values.insert(0, Pose3());
+  for (Key k = 1; k < 20; k++) {
+    const Pose3 step(Rot3::Rz(0.1 * k), Point3(1, 0, 0.1));
+    graph.emplace_shared<BetweenFactor<Pose3>>(k - 1, k, step, noise);
+    values.insert(k, Pose3(Rot3::Rx(0.2 * k), Point3(k, 0, 0)));
+  }
+  for (Key k : {0, 10}) fixed_values.insert(k, values.at(k));
+  Values free_values = values;
+  for (Key k : {0, 10}) free_values.erase(k);
+
+  LevenbergMarquardtOptimizer rewritten(ConstVarGraph(graph, fixed_values),
+                                        free_values);
+  Values expected = rewritten.optimize();
+  expected.insert(fixed_values);
+
+  MutableLMParams params;
+  params.fixed = {0, 10};
+  MutableLMOptimizer optimizer(graph, values, params);
+  EXPECT_LONGS_EQUAL(graph.size() - 1, optimizer.linearize()->size());
+  EXPECT(assert_equal(expected, optimizer.optimize(), 1e-6));
+
+  // Linear factors that are not Jacobians keep the blocks of the others.
+  const Matrix A1 = (Matrix(2, 2) << 1, 2, 3, 4).finished();
+  const Matrix A2 = (Matrix(2, 2) << 5, 6, 7, 8).finished();
+  const Vector b = Vector2(1, -1);
+  Values point;
+  point.insert(100, Vector2(0, 0));
+  point.insert(101, Vector2(0, 0));
+  NonlinearFactorGraph linear_graph;
+  linear_graph.emplace_shared<LinearContainerFactor>(
+      std::make_shared<HessianFactor>(JacobianFactor(100, A1, 101, A2, b)),
+      point);
+  params.fixed = {101};
+  MutableLMOptimizer hessian(linear_graph, point, params);
+  const auto linear = hessian.linearize();
+  CHECK(linear->size() == 1);
+  EXPECT(assert_equal(JacobianFactor(100, A1, b).augmentedInformation(),
+                      linear->at(0)->augmentedInformation()));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNewtonOptimizer.cpp
+ * @brief Test the second-order factor interface and the Newton optimizer.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/JointsCollocationFactor.h>
+#include <gtdynamics/factors/SecondOrderFactor.h>
+#include <gtdynamics/optimizer/NewtonOptimizer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+/// The exact second derivatives of the joints collocation factor.
+TEST(SecondOrderFactor, JointsCollocationFactor) {
+  auto model = noiseModel::Isotropic::Sigma(1, 0.1);
+  const Key dt_key = PhaseKey(0);
+  JointsCollocationFactor factor({0, 1}, 0, dt_key, model, model, true);
+
+  Values values;
+  for (int j = 0; j < 2; j++) {
+    for (int t = 0; t < 2; t++) {
+      InsertJointAngle(&values, j, t, 0.1 * (j + t));
+      InsertJointVel(&values, j, t, 0.2 * (j - t));
+      InsertJointAccel(&values, j, t, 0.3 * (j + 2 * t));
+    }
+  }
+  values.insert(dt_key, 0.05);
+
+  const Vector weights = (Vector(4) << 1, -2, 3, 0.5).finished();
+  EXPECT(assert_equal(NumericalWeightedErrorHessian(factor, values, weights),
+                      factor.weightedErrorHessian(values, weights), 1e-6));
+}
+
+/// A linear factor has the same quadratic approximation as in Gauss-Newton.
+TEST(NewtonOptimizer, LinearFactor) {
+  using namespace constrained_example;
+  auto factor = std::make_shared<ExpressionFactor<double>>(
+      noiseModel::Isotropic::Sigma(1, 0.5), 1.0, x1 + 2.0 * x2);
+  Values values;
+  values.insert(x1_key, 0.3);
+  values.insert(x2_key, -0.4);
+
+  auto linear = LinearizeSecondOrder(factor, values);
+  auto hessian = std::dynamic_pointer_cast<HessianFactor>(linear);
+  CHECK(hessian);
+  HessianFactor expected(*factor->linearize(values));
+  EXPECT(assert_equal(expected.augmentedInformation(),
+                      hessian->augmentedInformation(), 1e-9));
+}
+
+/// Newton converges to the same minimum as LM on a nonzero-residual problem.
+TEST(NewtonOptimizer, ConstrainedExampleCosts) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  LevenbergMarquardtParams lm_params;
+  lm_params.setRelativeErrorTol(1e-12);
+  lm_params.setAbsoluteErrorTol(1e-12);
+  const Values expected =
+      LevenbergMarquardtOptimizer(graph, init_values, lm_params).optimize();
+
+  NewtonOptimizer optimizer(lm_params);
+  const Values result = optimizer.optimize(graph, init_values);
+  EXPECT(assert_equal(expected, result, 1e-4));
+  EXPECT(optimizer.iterations() > 0);
+  EXPECT(optimizer.iterations() < lm_params.maxIterations);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNlpProblem.cpp
+ * @brief Test the NLP interface of equality-constrained problems.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/NlpProblem.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cmath>
+#include <vector>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace {
+EqConsOptProblem Problem() {
+  using namespace constrained_example;
+  NonlinearFactorGraph costs;
+  auto pose_noise = noiseModel::Isotropic::Sigma(6, 0.1);
+  costs.addPrior<Pose3>(0, Pose3(), pose_noise);
+  costs.emplace_shared<BetweenFactor<Pose3>>(
+      0, 1, Pose3(Rot3::Rz(0.5), Point3(1, 0, 0)), pose_noise);
+  costs.addPrior<double>(x1_key, 1.0, noiseModel::Isotropic::Sigma(1, 0.5));
+
+  EqualityConstraints constraints;
+  auto target = std::make_shared<PriorFactor<Pose3>>(
+      1, Pose3(Rot3::Ry(0.3), Point3(1, 1, 0)),
+      noiseModel::Isotropic::Sigma(6, 1e-2));
+  constraints.emplace_shared<FactorZeroErrorConstraint>(target);
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1e-2);
+
+  Values values;
+  values.insert(0, Pose3(Rot3::Rx(0.2), Point3(0.1, 0, 0)));
+  values.insert(1, Pose3(Rot3::Rz(0.4), Point3(1, 0.2, 0)));
+  values.insert(x1_key, 0.5);
+  values.insert(x2_key, -0.3);
+  return EqConsOptProblem(costs, constraints, values);
+}
+}  // namespace
+
+// The NLP at x = 0 is the problem at its initial values.
+TEST(NlpProblem, layout) {
+  const EqConsOptProblem problem = Problem();
+  NlpProblem nlp(problem);
+  EXPECT_LONGS_EQUAL(6 + 6 + 1 + 1, nlp.numVariables());
+  EXPECT_LONGS_EQUAL(6 + 1, nlp.numConstraints());
+  EXPECT_LONGS_EQUAL(6 * 6 + 2, nlp.numNonzeros());
+  EXPECT_LONGS_EQUAL(6, nlp.offset(1));
+
+  const std::vector<double> x(nlp.numVariables(), 0.0);
+  EXPECT(assert_equal(problem.initValues(), nlp.values(x.data())));
+  EXPECT_DOUBLES_EQUAL(problem.evaluateCost(problem.initValues()),
+                       nlp.objective(x.data()), 1e-9);
+  std::vector<double> h(nlp.numConstraints());
+  nlp.constraints(x.data(), h.data());
+  const ConstraintViolations violations(problem.constraints(),
+                                        problem.initValues());
+  EXPECT(assert_equal(violations[0].violation,
+                      Vector(Eigen::Map<Vector>(h.data(), 6))));
+  EXPECT_DOUBLES_EQUAL(violations[1].violation(0), h[6], 1e-12);
+
+  // Rows have sorted columns.
+  std::vector<int> row_pointers(nlp.numConstraints() + 1);
+  std::vector<int> columns(nlp.numNonzeros());
+  nlp.jacobianStructure(row_pointers.data(), columns.data());
+  EXPECT_LONGS_EQUAL(nlp.numNonzeros(), row_pointers.back());
+  for (size_t r = 0; r < nlp.numConstraints(); r++) {
+    for (int p = row_pointers[r] + 1; p < row_pointers[r + 1]; p++) {
+      EXPECT(columns[p - 1] < columns[p]);
+    }
+  }
+  EXPECT_LONGS_EQUAL(6, columns[row_pointers[0]]);
+  EXPECT_LONGS_EQUAL(12, columns[row_pointers[6]]);
+}
+
+// Gradient and Jacobian match central differences, away from x = 0 too.
+TEST(NlpProblem, derivatives) {
+  NlpProblem nlp(Problem());
+  const size_t n = nlp.numVariables(), m = nlp.numConstraints();
+  std::vector<double> x(n);
+  for (size_t i = 0; i < n; i++) x[i] = 0.05 * std::sin(1.0 + i);
+
+  std::vector<double> grad(n), values(nlp.numNonzeros());
+  std::vector<int> row_pointers(m + 1), columns(nlp.numNonzeros());
+  nlp.gradient(x.data(), grad.data());
+  nlp.jacobianStructure(row_pointers.data(), columns.data());
+  nlp.jacobianValues(x.data(), values.data());
+  Matrix J = Matrix::Zero(m, n);
+  for (size_t r = 0; r < m; r++) {
+    for (int p = row_pointers[r]; p < row_pointers[r + 1]; p++) {
+      J(r, columns[p]) = values[p];
+    }
+  }
+
+  const double delta = 1e-6;
+  std::vector<double> h_plus(m), h_minus(m);
+  for (size_t i = 0; i < n; i++) {
+    std::vector<double> plus = x, minus = x;
+    plus[i] += delta;
+    minus[i] -= delta;
+    const double df =
+        (nlp.objective(plus.data()) - nlp.objective(minus.data())) /
+        (2 * delta);
+    EXPECT_DOUBLES_EQUAL(df, grad[i], 1e-4);
+    nlp.constraints(plus.data(), h_plus.data());
+    nlp.constraints(minus.data(), h_minus.data());
+    for (size_t r = 0; r < m; r++) {
+      EXPECT_DOUBLES_EQUAL((h_plus[r] - h_minus[r]) / (2 * delta), J(r, i),
+                           1e-5);
+    }
+  }
+}
+
+// Inequality rows follow the equality rows, with values g(x) and bound
+// [0, inf).
+TEST(NlpProblem, inequalities) {
+  using namespace constrained_example;
+  const EqConsOptProblem problem = Problem();
+  InequalityConstraints inequalities;
+  inequalities.emplace_shared<DoubleExpressionInequality>(
+      Double_(1.0) - x1 - 2.0 * x2, 1e-2);
+  NlpProblem nlp(problem, inequalities);
+  EXPECT_LONGS_EQUAL(6 + 1, nlp.numEqualities());
+  EXPECT_LONGS_EQUAL(6 + 1 + 1, nlp.numConstraints());
+  EXPECT_LONGS_EQUAL(6 * 6 + 2 + 2, nlp.numNonzeros());
+
+  const size_t m = nlp.numConstraints();
+  std::vector<double> lower(m), upper(m);
+  nlp.constraintBounds(lower.data(), upper.data());
+  EXPECT_DOUBLES_EQUAL(0.0, lower[6], 0.0);
+  EXPECT_DOUBLES_EQUAL(0.0, upper[6], 0.0);
+  EXPECT_DOUBLES_EQUAL(0.0, lower[7], 0.0);
+  EXPECT(std::isinf(upper[7]));
+
+  // g = 1 - x1 - 2 x2, at x1 = 0.5 and x2 = -0.3.
+  const std::vector<double> x(nlp.numVariables(), 0.0);
+  std::vector<double> c(m), values(nlp.numNonzeros());
+  nlp.constraints(x.data(), c.data());
+  EXPECT_DOUBLES_EQUAL(1.1, c[7], 1e-12);
+  nlp.jacobianValues(x.data(), values.data());
+  EXPECT_DOUBLES_EQUAL(-1.0, values[values.size() - 2], 1e-12);
+  EXPECT_DOUBLES_EQUAL(-2.0, values[values.size() - 1], 1e-12);
+}
+
+// Costs without a Gaussian noise model are rejected.
+TEST(NlpProblem, robust) {
+  NonlinearFactorGraph costs;
+  costs.addPrior<double>(0, 1.0,
+                         noiseModel::Robust::Create(
+                             noiseModel::mEstimator::Huber::Create(1.0),
+                             noiseModel::Unit::Create(1)));
+  Values values;
+  values.insert(0, 0.0);
+  THROWS_EXCEPTION(NlpProblem(EqConsOptProblem(costs, {}, values)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNoiseModels.cpp
+ * @brief Test interned noise models.
+ * @author Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/utils/NoiseModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+TEST(NoiseModels, Interned) {
+  auto model = InternedIsotropic(6, 0.123);
+  EXPECT(model == InternedIsotropic(6, 0.123));
+  EXPECT(model != InternedIsotropic(6, 0.124));
+  EXPECT(model != InternedIsotropic(3, 0.123));
+  EXPECT(assert_equal(*gtsam::noiseModel::Isotropic::Sigma(6, 0.123), *model));
+
+  const size_t num_models = NumInternedNoiseModels();
+  InternedIsotropic(6, 0.123);
+  EXPECT_LONGS_EQUAL(num_models, NumInternedNoiseModels());
+
+  const gtsam::Vector3 sigmas(0.1, 0.2, 0.3);
+  EXPECT(InternedDiagonal(sigmas) == InternedDiagonal(sigmas));
+  EXPECT(InternedConstrained(3) == InternedConstrained(3));
+  EXPECT(InternedUnit(3) == InternedUnit(3));
+}
+
+// Separately constructed settings share their noise models.
+TEST(NoiseModels, OptimizerSetting) {
+  OptimizerSetting opt1, opt2;
+  EXPECT(opt1.f_cost_model == opt2.f_cost_model);
+  EXPECT(opt1.t_cost_model == opt2.t_cost_model);
+  EXPECT(opt1.f_cost_model == opt1.p_cost_model);
+}
+
+// Models nobody uses any more are dropped from the table.
+TEST(NoiseModels, Released) {
+  const size_t num_models = NumInternedNoiseModels();
+  auto model = InternedIsotropic(2, 0.987);
+  EXPECT_LONGS_EQUAL(num_models + 1, NumInternedNoiseModels());
+  model.reset();
+  EXPECT_LONGS_EQUAL(num_models, NumInternedNoiseModels());
+}
+
+// Settings built from user sigmas do not grow the table.
+TEST(NoiseModels, UserSigmas) {
+  const size_t num_models = NumInternedNoiseModels();
+  OptimizerSetting opt(0.0123, 0.0456);
+  EXPECT_LONGS_EQUAL(num_models, NumInternedNoiseModels());
+  EXPECT(assert_equal(*gtsam::noiseModel::Isotropic::Sigma(6, 0.0123),
+                      *opt.f_cost_model));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
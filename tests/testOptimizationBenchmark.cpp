@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOptimizationBenchmark.cpp
+ * @brief Test machine-readable benchmark results.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/OptimizationBenchmark.h>
+
+#include <sstream>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+EqConsOptProblem problem() {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+  return EqConsOptProblem(graph, constraints, init_values);
+}
+}  // namespace example
+
+TEST(OptimizationBenchmark, RunAndWrite) {
+  BenchmarkMethods methods;
+  for (auto&& method : DefaultBenchmarkMethods()) {
+    if (method.first == "penalty" || method.first == "sqp") {
+      methods.push_back(method);
+    }
+  }
+  LONGS_EQUAL(2, methods.size());
+
+  auto results = RunBenchmark("example", &example::problem, methods, 2);
+  LONGS_EQUAL(4, results.size());
+  for (auto&& result : results) {
+    EXPECT(result.scenario == "example");
+    EXPECT(result.iterations > 0);
+    EXPECT_DOUBLES_EQUAL(0.0, result.violation, 1e-3);
+    EXPECT(result.phase_times.count("build"));
+    EXPECT(result.phase_times.count("optimize"));
+  }
+  // SQP reports where its time goes.
+  EXPECT(results[1].method == "sqp");
+  EXPECT(results[1].phase_times.count("linearize"));
+  EXPECT(results[1].phase_times.count("solve"));
+
+  std::stringstream csv;
+  WriteBenchmarkCsv(results, csv);
+  std::string header;
+  std::getline(csv, header);
+  EXPECT(header ==
+         "scenario,method,repetition,iterations,cost,violation,time_build,"
+         "time_linearize,time_optimize,time_retract,time_solve");
+  size_t rows = 0;
+  for (std::string line; std::getline(csv, line);) rows++;
+  LONGS_EQUAL(4, rows);
+
+  std::stringstream json;
+  WriteBenchmarkJson(results, json);
+  EXPECT(json.str().front() == '[');
+  EXPECT(json.str().find("\"method\": \"penalty\"") != std::string::npos);
+}
+
+TEST(OptimizationBenchmark, ConstraintManifoldDogleg) {
+  BenchmarkMethods methods;
+  for (auto&& method : DefaultBenchmarkMethods()) {
+    if (method.first.rfind("constraint_manifold", 0) == 0) {
+      methods.push_back(method);
+    }
+  }
+  LONGS_EQUAL(2, methods.size());
+
+  // Both variants stay on the constraint manifold and find the same costs.
+  auto results = RunBenchmark("example", &example::problem, methods);
+  LONGS_EQUAL(2, results.size());
+  EXPECT(results[1].method == "constraint_manifold_dogleg");
+  EXPECT(results[1].iterations > 0);
+  EXPECT_DOUBLES_EQUAL(0.0, results[1].violation, 1e-3);
+  EXPECT_DOUBLES_EQUAL(results[0].cost, results[1].cost, 1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOptimizationSnapshot.cpp
+ * @brief Test binary checkpoints of optimization problems.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/OptimizationSnapshot.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <sstream>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+/// A snapshot is restored exactly.
+TEST(OptimizationSnapshot, SaveLoad) {
+  OptimizationSnapshot snapshot;
+  snapshot.graph.addPrior(JointAngleKey(0, 0), 0.5,
+                          gtsam::noiseModel::Isotropic::Sigma(1, 0.1));
+  snapshot.graph.addPrior(
+      PoseKey(1, 0), gtsam::Pose3(),
+      gtsam::noiseModel::Diagonal::Sigmas(gtsam::Vector6::Constant(0.2)));
+  InsertJointAngle(&snapshot.values, 0, 0, 0.3);
+  InsertPose(&snapshot.values, 1, 0, gtsam::Pose3());
+  InsertTwist(&snapshot.values, 1, 0, gtsam::Vector6::Constant(1.0));
+  snapshot.iterations = 12;
+  snapshot.lambda = 1e-3;
+  snapshot.error = snapshot.graph.error(snapshot.values);
+
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  SaveSnapshot(snapshot, ss);
+  const OptimizationSnapshot loaded = LoadSnapshot(ss);
+
+  EXPECT(assert_equal(snapshot.graph, loaded.graph));
+  EXPECT(assert_equal(snapshot.values, loaded.values));
+  EXPECT_LONGS_EQUAL(12, loaded.iterations);
+  EXPECT_DOUBLES_EQUAL(1e-3, loaded.lambda, 0);
+  EXPECT_DOUBLES_EQUAL(snapshot.error, loaded.error, 0);
+}
+
+/// Other data is rejected.
+TEST(OptimizationSnapshot, Corrupt) {
+  std::stringstream ss("not a snapshot");
+  THROWS_EXCEPTION(LoadSnapshot(ss));
+}
+#endif
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testParameterSensitivity.cpp
+ * @brief Test gradients of optimal costs with respect to parameters.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/ParameterSensitivity.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose2;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector2;
+
+namespace {
+auto kModel = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+auto kPoseModel = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+
+// A variable pulled towards both parameters.
+NonlinearFactorGraph MeanGraph(const Vector &p) {
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(0, p(0), kModel);
+  graph.addPrior<double>(0, p(1), kModel);
+  return graph;
+}
+
+// A two-link chain with link lengths p, whose end should reach a target it
+// nearly reaches, so that the Gauss-Newton sensitivity is accurate.
+NonlinearFactorGraph ChainGraph(const Vector &p) {
+  NonlinearFactorGraph graph;
+  graph.addPrior<Pose2>(0, Pose2(), kPoseModel);
+  graph.emplace_shared<gtsam::BetweenFactor<Pose2>>(0, 1, Pose2(p(0), 0, 0.3),
+                                                    kPoseModel);
+  graph.emplace_shared<gtsam::BetweenFactor<Pose2>>(1, 2, Pose2(p(1), 0, 0.3),
+                                                    kPoseModel);
+  graph.addPrior<Pose2>(2, Pose2(1.68, 0.22, 0.61), kPoseModel);
+  return graph;
+}
+
+// Cost of interest: the distance of the middle pose from the origin.
+NonlinearFactorGraph ChainCost(const Vector &) {
+  NonlinearFactorGraph cost;
+  cost.addPrior<Pose2>(1, Pose2(), kPoseModel);
+  return cost;
+}
+
+Values Solve(const Vector &p) {
+  Values initial;
+  for (size_t i = 0; i < 3; i++) initial.insert(i, Pose2(i, 0, 0));
+  gtsam::LevenbergMarquardtParams params;
+  params.setRelativeErrorTol(1e-15);
+  params.setAbsoluteErrorTol(1e-15);
+  return gtsam::LevenbergMarquardtOptimizer(ChainGraph(p), initial, params)
+      .optimize();
+}
+}  // namespace
+
+// Cost x^2 / 2 of the mean x = (p0 + p1) / 2.
+TEST(CostGradient, mean) {
+  const Vector p = Vector2(1, 3);
+  Values solution;
+  solution.insert<double>(0, 2.0);
+  auto cost = [](const Vector &) {
+    NonlinearFactorGraph cost;
+    cost.addPrior<double>(0, 0.0, kModel);
+    return cost;
+  };
+  const CostSensitivity sensitivity =
+      CostGradient(MeanGraph, p, solution, cost);
+  EXPECT_DOUBLES_EQUAL(2.0, sensitivity.cost, 1e-9);
+  EXPECT(assert_equal(Vector2(0, 0), sensitivity.direct, 1e-6));
+  EXPECT(assert_equal(Vector2(1, 1), sensitivity.gradient, 1e-6));
+
+  // The error of the graph itself only changes with the parameters directly.
+  const CostSensitivity envelope = CostGradient(MeanGraph, p, solution);
+  EXPECT(assert_equal(Vector2(-1, 1), envelope.gradient, 1e-6));
+  EXPECT(assert_equal(envelope.direct, envelope.gradient, 1e-9));
+}
+
+// Agrees with finite differences of full optimizations.
+TEST(CostGradient, chain) {
+  const Vector p = Vector2(1.0, 0.7);
+  const CostSensitivity sensitivity =
+      CostGradient(ChainGraph, p, Solve(p), ChainCost);
+
+  const double h = 1e-5;
+  Vector expected(2);
+  for (size_t i = 0; i < 2; i++) {
+    Vector plus = p, minus = p;
+    plus(i) += h;
+    minus(i) -= h;
+    expected(i) = (ChainCost(plus).error(Solve(plus)) -
+                   ChainCost(minus).error(Solve(minus))) /
+                  (2 * h);
+  }
+  EXPECT(assert_equal(expected, sensitivity.gradient, 1e-2 * expected.norm()));
+  EXPECT(assert_equal(Vector2(0, 0), sensitivity.direct, 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
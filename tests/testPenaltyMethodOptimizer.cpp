@@ -57,6 +57,48 @@ TEST(PenaltyMethodOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+/// Adaptive schedule with loose early inner solves and early termination.
+TEST(PenaltyMethodOptimizer, AdaptiveSchedule) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  PenaltyMethodParameters params;
+  params.num_iterations = 30;
+  params.adaptive_mu = true;
+  params.feasibility_tolerance = 1e-4;
+  params.inner_relative_tolerance = 1e-2;
+  gtdynamics::PenaltyMethodOptimizer optimizer(params);
+  ConstrainedOptResult intermediate;
+  Values results =
+      optimizer.optimize(graph, constraints, init_values, &intermediate);
+
+  // Stopped once feasible, with one timing per outer iteration.
+  const size_t num_outer = intermediate.mu_values.size();
+  EXPECT(num_outer < params.num_iterations);
+  EXPECT_LONGS_EQUAL(num_outer, intermediate.times.size());
+  EXPECT(std::abs(g1.value(results)) < params.feasibility_tolerance);
+  for (double time : intermediate.times) EXPECT(time >= 0);
+
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  EXPECT(assert_equal(gt_results, results, 1e-3));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
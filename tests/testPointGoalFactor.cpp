@@ -23,6 +23,8 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/factorTesting.h>
 
+#include <vector>
+
 using namespace gtdynamics;
 using gtsam::assert_equal;
 using gtsam::LabeledSymbol;
@@ -96,6 +98,32 @@ TEST(PointGoalFactor, optimization) {
   EXPECT(assert_equal(factor.unwhitenedError(results), Vector3::Zero(), 1e-4));
 }
 
+// The path factor has the errors of one PointGoalFactor per time step.
+TEST(PointGoalPathFactor, error) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+  const Point3 point_com(0, 0, 1);
+  const std::vector<Point3> path{Point3(0, 0, 2), Point3(0.1, 0, 2.1),
+                                 Point3(0.2, 0, 2)};
+  const PointGoalPathFactor factor(cost_model, point_com, path, 3, 5);
+  EXPECT_LONGS_EQUAL(3, factor.size());
+  EXPECT_LONGS_EQUAL(9, factor.dim());
+  EXPECT(assert_equal(path[1], Point3(factor.goalPoints().col(1))));
+
+  const gtsam::NonlinearFactorGraph expected =
+      PointGoalFactors(PoseKey(3, 5), cost_model, point_com, path);
+  Values values;
+  for (size_t n = 0; n < path.size(); n++) {
+    values.insert(PoseKey(3, 5 + n),
+                  Pose3(Rot3::RzRyRx(0.1 * n, 0.4932, -0.3), Point3(n, 5, 1)));
+  }
+  EXPECT_DOUBLES_EQUAL(expected.error(values), factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+
+  THROWS_EXCEPTION(PointGoalPathFactor(gtsam::noiseModel::Isotropic::Sigma(
+                                           1, 0.1),
+                                       point_com, path, 3, 5));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
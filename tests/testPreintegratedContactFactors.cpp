@@ -58,6 +58,39 @@ TEST(PreintegratedPointContactMeasurements, IntegrateMeasurement) {
   EXPECT(assert_equal<Matrix3>(I_3x3 * 3e-4, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Batch integration is equivalent to integrating one sample at a time.
+TEST(PreintegratedPointContactMeasurements, IntegrateMeasurements) {
+  double dt = 0.001;
+  Matrix3 vdCov = (Matrix3() << 2, 0.1, 0, 0.1, 1, 0.2, 0, 0.2, 3).finished();
+  const Pose3 base_i, contact_i(Rot3::Rz(0.1), Vector3(0, 0, 1));
+  PreintegratedPointContactMeasurements sequential(base_i, contact_i, dt,
+                                                   vdCov);
+  PreintegratedPointContactMeasurements batch(base_i, contact_i, dt, vdCov);
+
+  std::vector<Rot3> deltaRiks;
+  std::vector<Pose3> contacts;
+  for (size_t k = 0; k < 10; k++) {
+    deltaRiks.push_back(Rot3::RzRyRx(0.01 * k, -0.02 * k, 0.03 * k));
+    contacts.emplace_back(Rot3::Ry(0.05 * k), Vector3(0, 0.01 * k, 1));
+    sequential.integrateMeasurement(deltaRiks.back(), contacts.back(), dt);
+  }
+  batch.integrateMeasurements(deltaRiks, contacts, dt);
+  EXPECT(assert_equal<Matrix3>(sequential.preintMeasCov(),
+                               batch.preintMeasCov(), 1e-15));
+
+  // Mismatched sizes throw.
+  contacts.pop_back();
+  THROWS_EXCEPTION(batch.integrateMeasurements(deltaRiks, contacts, dt));
+
+  // Resetting starts a new preintegration.
+  batch.resetIntegration(base_i, contact_i, dt);
+  EXPECT(assert_equal<Matrix3>(
+      PreintegratedPointContactMeasurements(base_i, contact_i, dt, vdCov)
+          .preintMeasCov(),
+      batch.preintMeasCov()));
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Point Contact Factor.
 TEST(PreintegratedPointContactFactor, Constructor) {
@@ -160,6 +193,26 @@ TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurementVarying) {
   EXPECT(assert_equal<Matrix6>(expected * dt * dt, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Batch integration is equivalent to integrating one sample at a time.
+TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurements) {
+  double dt = 0.001;
+  PreintegratedRigidContactMeasurements sequential(I_3x3, I_3x3),
+      batch(I_3x3, I_3x3);
+  std::vector<Matrix3> wCovs, vCovs;
+  for (size_t k = 0; k < 10; k++) {
+    wCovs.push_back(I_3x3 * (0.05 + 0.01 * k));
+    vCovs.push_back(I_3x3 * (0.01 + 0.02 * k));
+    sequential.integrateMeasurement(wCovs.back(), vCovs.back(), dt);
+  }
+  batch.integrateMeasurements(wCovs, vCovs, dt);
+  EXPECT(assert_equal<Matrix6>(sequential.preintMeasCov(),
+                               batch.preintMeasCov(), 1e-15));
+
+  batch.resetIntegration();
+  EXPECT(assert_equal<Matrix6>(Z_6x6, batch.preintMeasCov()));
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Rigid Contact Factor.
 TEST(PreintegratedRigidContactFactor, Constructor) {
@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRecedingHorizonOptimizer.cpp
+ * @brief Test receding-horizon trajectory optimization with warm starting.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/RecedingHorizonOptimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::PriorFactor;
+using gtsam::Values;
+
+TEST(ShiftTime, values) {
+  Values values;
+  InsertJointAngle(&values, 0, 0, 1.0);
+  InsertJointAngle(&values, 0, 1, 2.0);
+  InsertPose(&values, 3, 2, gtsam::Pose3());
+
+  Values expected;
+  InsertJointAngle(&expected, 0, 0, 2.0);
+  InsertPose(&expected, 3, 1, gtsam::Pose3());
+  EXPECT(assert_equal(expected, ShiftTime(values, -1)));
+
+  Values later;
+  InsertJointAngle(&later, 0, 3, 1.0);
+  InsertJointAngle(&later, 0, 4, 2.0);
+  InsertPose(&later, 3, 5, gtsam::Pose3());
+  EXPECT(assert_equal(later, ShiftTime(values, 3)));
+}
+
+TEST(RecedingHorizonOptimizer, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  const int j = robot.joints()[0]->id();
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 5;
+  const double dt = 0.1;
+
+  // Reach angle 1 at the end of the horizon with small torques.
+  auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 10.0);
+  auto goal_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  NonlinearFactorGraph objectives;
+  for (int t = 0; t <= num_steps; t++) {
+    objectives.emplace_shared<PriorFactor<double>>(TorqueKey(j, t), 0.0,
+                                                   torque_model);
+  }
+  objectives.emplace_shared<PriorFactor<double>>(JointAngleKey(j, num_steps),
+                                                 1.0, goal_model);
+
+  gtsam::LevenbergMarquardtParams params;
+  params.setMaxIterations(50);
+  RecedingHorizonOptimizer mpc(robot, graph_builder, num_steps, dt, params);
+
+  Values state;
+  InsertJointAngle(&state, j, 0.0);
+  InsertJointVel(&state, j, 0.0);
+  Values solution = mpc.update(state, objectives);
+  EXPECT_DOUBLES_EQUAL(0.0, JointAngle(solution, j, 0), 1e-4);
+  EXPECT_DOUBLES_EQUAL(1.0, JointAngle(solution, j, num_steps), 1e-3);
+  EXPECT(mpc.iterations() > 0);
+
+  // Next tick, from the planned state at step 1: the shifted solution is a
+  // good warm start, and step 0 is pinned to the new state.
+  Values next_state;
+  InsertJointAngle(&next_state, j, JointAngle(solution, j, 1));
+  InsertJointVel(&next_state, j, JointVel(solution, j, 1));
+  solution = mpc.update(next_state, objectives);
+  EXPECT_DOUBLES_EQUAL(JointAngle(next_state, j), JointAngle(solution, j, 0),
+                       1e-4);
+  EXPECT_DOUBLES_EQUAL(1.0, JointAngle(solution, j, num_steps), 1e-3);
+
+  // The iteration cap is respected.
+  params.setMaxIterations(1);
+  RecedingHorizonOptimizer capped(robot, graph_builder, num_steps, dt, params);
+  capped.update(state, objectives);
+  EXPECT_LONGS_EQUAL(1, capped.iterations());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
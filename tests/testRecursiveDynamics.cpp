@@ -0,0 +1,319 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRecursiveDynamics.cpp
+ * @brief Test recursive dynamics solvers against the factor graph solvers.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Build known values with kinematics and torques for the given robot.
+Values KnownValues(const Robot& robot, int t,
+                   const std::optional<std::string>& prior_link = {}) {
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, 0.1 * j + 0.2);
+    InsertJointVel(&values, j, t, 0.5 - 0.3 * j);
+    InsertTorque(&values, j, t, 1.0 + 0.2 * j);
+  }
+  if (prior_link) {
+    const auto link = robot.link(*prior_link);
+    InsertPose(&values, link->id(), t, link->bMcom());
+    InsertTwist(&values, link->id(), t,
+                (gtsam::Vector6() << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6).finished());
+  }
+  return robot.forwardKinematics(values, t, prior_link);
+}
+
+// Check that recursive and elimination forward dynamics agree.
+bool SameFD(const Robot& robot, const DynamicsGraph& graph_builder,
+             const Values& known_values, int t) {
+  DynamicsGraph elimination = graph_builder;
+  DynamicsGraph recursive = graph_builder;
+  recursive.setLinearSolver(Recursive);
+  const Values expected = elimination.linearSolveFD(robot, t, known_values);
+  const Values actual = recursive.linearSolveFD(robot, t, known_values);
+  bool same = true;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    same &= assert_equal(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                         1e-6);
+    for (auto&& link : joint->links()) {
+      const int i = link->id();
+      same &= assert_equal(Wrench(expected, i, j, t), Wrench(actual, i, j, t),
+                           1e-6);
+    }
+  }
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    same &= assert_equal(TwistAccel(expected, i, t), TwistAccel(actual, i, t),
+                         1e-6);
+  }
+  return same;
+}
+
+// Check that recursive and elimination inverse dynamics agree.
+bool SameID(const Robot& robot, const DynamicsGraph& graph_builder,
+             const Values& kinematics, int t) {
+  Values known_values = kinematics;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    known_values.erase(TorqueKey(j, t));
+    InsertJointAccel(&known_values, j, t, 0.4 - 0.1 * j);
+  }
+  DynamicsGraph elimination = graph_builder;
+  DynamicsGraph recursive = graph_builder;
+  recursive.setLinearSolver(Recursive);
+  const Values expected = elimination.linearSolveID(robot, t, known_values);
+  const Values actual = recursive.linearSolveID(robot, t, known_values);
+  bool same = true;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    same &= assert_equal(Torque(expected, j, t), Torque(actual, j, t), 1e-6);
+    for (auto&& link : joint->links()) {
+      const int i = link->id();
+      same &= assert_equal(Wrench(expected, i, j, t), Wrench(actual, i, j, t),
+                           1e-6);
+    }
+  }
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    same &= assert_equal(TwistAccel(expected, i, t), TwistAccel(actual, i, t),
+                         1e-6);
+  }
+  return same;
+}
+
+// Fixed-base serial chain with gravity.
+TEST(RecursiveDynamics, FD_simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const int t = 3;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  EXPECT(SameFD(robot, graph_builder, KnownValues(robot, t), t));
+}
+
+TEST(RecursiveDynamics, ID_simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const int t = 3;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  EXPECT(SameID(robot, graph_builder, KnownValues(robot, t), t));
+}
+
+// Two free bodies connected by a joint, no fixed link.
+TEST(RecursiveDynamics, FD_floating) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const int t = 0;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const Values known_values = KnownValues(robot, t, std::string("l1"));
+  EXPECT(SameFD(robot, graph_builder, known_values, t));
+}
+
+TEST(RecursiveDynamics, ID_floating) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const int t = 0;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const Values known_values = KnownValues(robot, t, std::string("l1"));
+  EXPECT(SameID(robot, graph_builder, known_values, t));
+}
+
+// Floating-base quadruped with fixed joints.
+TEST(RecursiveDynamics, ID_a1) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const int t = 0;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const Values known_values = KnownValues(robot, t, std::string("trunk"));
+  EXPECT(SameID(robot, graph_builder, known_values, t));
+}
+
+// Simple planar robot used by the simulator.
+TEST(RecursiveDynamics, FD_simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  const int t = 0;
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  // Torques only, at rest, so the motion stays planar.
+  Values values;
+  InsertJointAngle(&values, 0, t, 0.0);
+  InsertJointVel(&values, 0, t, 0.0);
+  InsertTorque(&values, 0, t, 1.0);
+  Values known_values = robot.forwardKinematics(values, t);
+  EXPECT(SameFD(robot, graph_builder, known_values, t));
+
+  RecursiveDynamics solver(robot, simple_urdf::gravity);
+  Values result = solver.forwardDynamics(t, known_values);
+  EXPECT_DOUBLES_EQUAL(0.0625, JointAccel(result, 0, t), 1e-9);
+}
+
+// A DynamicsGraph keeps its solver across calls, and rebuilds it when the
+// robot changes.
+TEST(RecursiveDynamics, solver_reuse) {
+  Robot rrr = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  rrr = rrr.fixLink("link_0");
+  auto floating = simple_urdf_eq_mass::getRobot();
+  DynamicsGraph recursive(gtsam::Vector3(0, 0, -9.8));
+  recursive.setLinearSolver(Recursive);
+
+  const Values rrr_values = KnownValues(rrr, 0);
+  const Values floating_values = KnownValues(floating, 0, std::string("l1"));
+  const Values rrr_first = recursive.linearSolveFD(rrr, 0, rrr_values);
+  const Values floating_result =
+      recursive.linearSolveFD(floating, 0, floating_values);
+  const Values rrr_again = recursive.linearSolveFD(rrr, 0, rrr_values);
+  EXPECT(assert_equal(rrr_first, rrr_again, 1e-12));
+
+  const RecursiveDynamics fresh(floating, gtsam::Vector3(0, 0, -9.8));
+  const Values expected = fresh.forwardDynamics(0, floating_values);
+  EXPECT(assert_equal(expected, floating_result, 1e-12));
+
+  const RecursiveDynamics solver(rrr);
+  EXPECT(solver.builtFor(rrr));
+  EXPECT(!solver.builtFor(floating));
+}
+
+// Mass matrix, bias and gravity torques should be consistent with FD.
+TEST(RecursiveDynamics, joint_space_terms) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  RecursiveDynamics solver(robot, gtsam::Vector3(0, 0, -9.8));
+  const size_t n = solver.numJoints();
+  const gtsam::Vector q = gtsam::Vector3(0.1, -0.4, 0.7);
+  const gtsam::Vector v = gtsam::Vector3(0.5, 0.2, -0.3);
+  const gtsam::Vector tau = gtsam::Vector3(1.0, -2.0, 0.5);
+
+  gtsam::Matrix M(n, n);
+  gtsam::Vector h(n), g(n), c(n), qdd(n);
+  solver.massMatrix(q, &M);
+  solver.biasTorques(q, v, &h);
+  solver.gravityTorques(q, &g);
+  solver.coriolisTorques(q, v, &c);
+  solver.forwardDynamics(q, v, tau, &qdd);
+
+  EXPECT(assert_equal(gtsam::Matrix(M.transpose()), M, 1e-9));
+  EXPECT(assert_equal(h, gtsam::Vector(g + c), 1e-9));
+  EXPECT(assert_equal(tau, gtsam::Vector(M * qdd + h), 1e-6));
+
+  // Without velocities there are no Coriolis terms.
+  solver.coriolisTorques(q, gtsam::Vector::Zero(n), &c);
+  EXPECT(assert_equal(gtsam::Vector(gtsam::Vector::Zero(n)), c, 1e-9));
+}
+
+// Analytic forward dynamics derivatives agree with central differences.
+TEST(RecursiveDynamics, forward_dynamics_derivatives) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  RecursiveDynamics solver(robot, gtsam::Vector3(0, 0, -9.8));
+  const size_t n = solver.numJoints();
+  const gtsam::Vector q = gtsam::Vector3(0.1, -0.4, 0.7);
+  const gtsam::Vector v = gtsam::Vector3(0.5, 0.2, -0.3);
+  const gtsam::Vector tau = gtsam::Vector3(1.0, -2.0, 0.5);
+
+  gtsam::Vector qdd(n), expected_qdd(n);
+  gtsam::Matrix H_q(n, n), H_v(n, n), H_tau(n, n);
+  solver.forwardDynamicsDerivatives(q, v, tau, &qdd, &H_q, &H_v, &H_tau);
+  solver.forwardDynamics(q, v, tau, &expected_qdd);
+  EXPECT(assert_equal(expected_qdd, qdd, 1e-9));
+
+  // Central differences of forward dynamics in each joint.
+  const double delta = 1e-6;
+  gtsam::Matrix N_q(n, n), N_v(n, n), N_tau(n, n);
+  gtsam::Vector plus(n), minus(n);
+  for (size_t j = 0; j < n; ++j) {
+    const gtsam::Vector e = delta * gtsam::Vector::Unit(n, j);
+    solver.forwardDynamics(q + e, v, tau, &plus);
+    solver.forwardDynamics(q - e, v, tau, &minus);
+    N_q.col(j) = (plus - minus) / (2 * delta);
+    solver.forwardDynamics(q, v + e, tau, &plus);
+    solver.forwardDynamics(q, v - e, tau, &minus);
+    N_v.col(j) = (plus - minus) / (2 * delta);
+    solver.forwardDynamics(q, v, tau + e, &plus);
+    solver.forwardDynamics(q, v, tau - e, &minus);
+    N_tau.col(j) = (plus - minus) / (2 * delta);
+  }
+  EXPECT(assert_equal(N_q, H_q, 1e-5));
+  EXPECT(assert_equal(N_v, H_v, 1e-5));
+  EXPECT(assert_equal(N_tau, H_tau, 1e-5));
+}
+
+// Task Jacobians agree with forward kinematics, and task inertias with the
+// dense mass matrix, on a branched tree.
+TEST(RecursiveDynamics, operational_space) {
+  const Robot robot = BranchedRobot(5, 2);
+  RecursiveDynamics solver(robot);
+  const size_t n = solver.numJoints();
+  gtsam::Vector q(n);
+  q << 0, 0.3, -0.5, 0.2, 0.8, -0.1;
+  solver.factorize(q);
+
+  // Central differences of the positions of the tips.
+  const PointOnLink tip4(robot.link("link_4"), gtsam::Point3(0, 0, 0.1)),
+      tip5(robot.link("link_5"), gtsam::Point3(0, 0, 0.1));
+  auto position = [&](const PointOnLink &tip, const gtsam::Vector &q) {
+    Values values;
+    for (auto &&joint : robot.joints()) {
+      InsertJointAngle(&values, joint->id(), q(joint->id()));
+      InsertJointVel(&values, joint->id(), 0.0);
+    }
+    return tip.predict(robot.forwardKinematics(values), 0);
+  };
+  const double delta = 1e-6;
+  gtsam::Matrix J4, J5, N4(3, n);
+  solver.taskJacobian(tip4, &J4);
+  solver.taskJacobian(tip5, &J5);
+  for (size_t j = 0; j < n; ++j) {
+    const gtsam::Vector e = delta * gtsam::Vector::Unit(n, j);
+    N4.col(j) = (position(tip4, q + e) - position(tip4, q - e)) / (2 * delta);
+  }
+  EXPECT(assert_equal(N4, J4, 1e-6));
+
+  // Joint id 0 is unused, so compare with the dense inverse without it.
+  gtsam::Matrix M(n, n), J(6, n), Lambda;
+  solver.massMatrix(q, &M);
+  J << J4, J5;
+  solver.taskInertia(J, &Lambda);
+  const gtsam::Matrix Minv = M.bottomRightCorner(n - 1, n - 1).inverse();
+  const gtsam::Matrix Jr = J.rightCols(n - 1);
+  EXPECT(assert_equal(gtsam::Matrix((Jr * Minv * Jr.transpose()).inverse()),
+                      Lambda, 1e-6));
+
+  // The same task twice is singular.
+  gtsam::Matrix twice(6, n);
+  twice << J4, J4;
+  CHECK_EXCEPTION(solver.taskInertia(twice, &Lambda), std::runtime_error);
+}
+
+// Closed kinematic chains are not supported.
+TEST(RecursiveDynamics, loop_throws) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  CHECK_EXCEPTION(RecursiveDynamics solver(robot), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
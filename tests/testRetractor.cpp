@@ -88,6 +88,42 @@ TEST(TspaceBasis, connected_poses) {
   EXPECT(assert_equal(expected_basis, values_basis));
 }
 
+/** Retractors reuse their solvers; results match fresh retractors. */
+TEST(Retractor, reuse_solvers) {
+  Key x1_key = 1;
+  Key x2_key = 2;
+
+  gtdynamics::EqualityConstraints constraints;
+  auto noise = noiseModel::Unit::Create(6);
+  auto factor12 = std::make_shared<BetweenFactor<Pose3>>(
+      x1_key, x2_key, Pose3(Rot3(), Point3(0, 0, 1)), noise);
+  constraints.emplace_shared<gtdynamics::FactorZeroErrorConstraint>(factor12);
+  auto component = std::make_shared<ConnectedComponent>(constraints);
+
+  Values values;
+  values.insert(x1_key, Pose3(Rot3(), Point3(0, 0, 0)));
+  values.insert(x2_key, Pose3(Rot3(), Point3(0, 0, 1)));
+  VectorValues delta1, delta2;
+  delta1.insert(x1_key, (Vector(6) << 0, 0, 0.1, 0, 0, 1).finished());
+  delta1.insert(x2_key, Vector6::Zero());
+  delta2.insert(x1_key, Vector6::Zero());
+  delta2.insert(x2_key, (Vector(6) << 0.2, 0, 0, 1, 0, 0).finished());
+
+  for (bool warm_start : {false, true}) {
+    auto params = std::make_shared<RetractParams>();
+    params->setProjection();
+    params->warm_start_lambda = warm_start;
+    ProjRetractor retractor(component, params);
+    retractor.retract(values, delta1);
+    Values actual = retractor.retract(values, delta2);
+
+    ProjRetractor fresh_retractor(component, params);
+    Values expected = fresh_retractor.retract(values, delta2);
+    EXPECT(assert_equal(expected, actual, 1e-4));
+    EXPECT_DOUBLES_EQUAL(0.0, component->merit_graph_.error(actual), 1e-8);
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
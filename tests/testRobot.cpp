@@ -86,6 +86,32 @@ TEST(Robot, removeLink) {
   EXPECT(robot.link("l3")->joints().size() == 1);
 }
 
+TEST(Robot, topology) {
+  auto robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+  const RobotTopology& topology = robot.topology();
+  EXPECT_LONGS_EQUAL(4, topology.links.size());
+  EXPECT_LONGS_EQUAL(4, topology.joints.size());
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT(topology.joints[j] == joint);
+    EXPECT_LONGS_EQUAL(joint->parent()->id(), topology.parent_link[j]);
+    EXPECT_LONGS_EQUAL(joint->child()->id(), topology.child_link[j]);
+    EXPECT(assert_equal(joint->pMc(), topology.pMc[j]));
+  }
+
+  // One tree rooted at the fixed link, the loop-closing joint is left out.
+  EXPECT_LONGS_EQUAL(1, topology.roots.size());
+  EXPECT_LONGS_EQUAL(robot.link("l1")->id(), topology.roots[0]);
+  EXPECT_LONGS_EQUAL(3, topology.traversal.size());
+  EXPECT_LONGS_EQUAL(robot.link("l1")->id(), topology.traversal_from[0]);
+
+  // Removing a link updates the arrays.
+  const int l2 = robot.link("l2")->id();
+  robot.removeLink(robot.link("l2"));
+  EXPECT(!robot.topology().links[l2]);
+  EXPECT_LONGS_EQUAL(2, robot.topology().traversal.size());
+}
+
 TEST(Robot, ForwardKinematics) {
   Robot robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
@@ -282,6 +308,45 @@ TEST(ForwardKinematics, A1) {
       Pose(fk_results, 20, 0), 1e-6));
 }
 
+// Fast forward kinematics agrees with the Values version on a tree.
+TEST(ForwardKinematics, A1Fast) {
+  Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"), "", true);
+  robot = robot.fixLink("trunk");
+
+  const size_t n = robot.topology().joints.size();
+  gtsam::Vector q(n), v(n);
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    q(j) = 0.1 * (j % 4) - 0.15;
+    v(j) = 0.05 * j;
+    InsertJointAngle(&known, j, q(j));
+    InsertJointVel(&known, j, v(j));
+  }
+  const Values fk_results = robot.forwardKinematics(known);
+
+  LinkStates states;
+  robot.forwardKinematics(q, v, &states);
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Pose(fk_results, i), states.poses[i], 1e-9));
+    EXPECT(assert_equal(Twist(fk_results, i), states.twists[i], 1e-9));
+  }
+
+  // A floating root at a given pose.
+  robot = robot.unfixLink("trunk");
+  const Pose3 wTb(Rot3::Rz(0.3), Point3(1, 2, 0.5));
+  Values floating = known;
+  InsertPose(&floating, robot.link("trunk")->id(), wTb);
+  InsertTwist(&floating, robot.link("trunk")->id(), Vector6::Zero());
+  const Values floating_fk =
+      robot.forwardKinematics(floating, 0, std::string("trunk"));
+  robot.forwardKinematics(q, v, &states, std::string("trunk"), wTb);
+  const int i = robot.link("FR_lower")->id();
+  EXPECT(assert_equal(Pose(floating_fk, i), states.poses[i], 1e-9));
+}
+
 TEST(Robot, Equality) {
   Robot robot1 = CreateRobotFromFile(
       kSdfPath + std::string("test/four_bar_linkage_pure.sdf"));
@@ -300,6 +365,82 @@ TEST(Robot, Equality) {
   EXPECT(!robot1.equals(robot2));
 }
 
+TEST(Robot, clone) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/four_bar_linkage_pure.sdf"));
+  Robot copy = robot.clone();
+  EXPECT(robot.equals(copy));
+
+  // Links and joints are new, and connected to each other.
+  const auto link = copy.link("l1");
+  EXPECT(link != robot.link("l1"));
+  EXPECT_LONGS_EQUAL(robot.link("l1")->joints().size(), link->joints().size());
+  for (auto&& joint : link->joints()) {
+    EXPECT(joint == copy.joint(joint->name()));
+    EXPECT(joint->parent() == link || joint->child() == link);
+  }
+
+  // Fixing a link of the clone does not fix it in the original.
+  copy = copy.fixLink("l1");
+  EXPECT(copy.link("l1")->isFixed());
+  EXPECT(!robot.link("l1")->isFixed());
+}
+
+// Merging the fixed joints of A1 matches the links lumped by the URDF parser,
+// and keeps contact points in place.
+TEST(Robot, mergeFixedJoints) {
+  const std::string file = kUrdfPath + std::string("a1/a1.urdf");
+  const Robot robot = CreateRobotFromFile(file, "", true);
+  MergedLinks merged_links;
+  const Robot merged = robot.mergeFixedJoints(&merged_links);
+
+  // 9 fixed joints: imu, and hip and toe on each leg.
+  EXPECT_LONGS_EQUAL(robot.numLinks() - 9, merged.numLinks());
+  EXPECT_LONGS_EQUAL(robot.numJoints() - 9, merged.numJoints());
+  EXPECT_LONGS_EQUAL(merged.numLinks(), merged.topology().links.size());
+  EXPECT(merged_links.at("FR_toe").name == "FR_lower");
+  for (auto&& joint : merged.joints()) {
+    EXPECT(joint->type() != Joint::Type::Fixed);
+    EXPECT(joint->parent() == merged.link(joint->parent()->name()));
+  }
+
+  // Mass, CoM and inertia in the base frame, as lumped by the parser.
+  const Robot lumped = CreateRobotFromFile(file);
+  EXPECT_LONGS_EQUAL(lumped.numLinks(), merged.numLinks());
+  for (auto&& link : lumped.links()) {
+    const auto composite = merged.link(link->name());
+    EXPECT_DOUBLES_EQUAL(link->mass(), composite->mass(), 1e-9);
+    EXPECT(assert_equal(link->bMcom().translation(),
+                        composite->bMcom().translation(), 1e-6));
+    const gtsam::Matrix3 R = link->bMcom().rotation().matrix(),
+                         Rc = composite->bMcom().rotation().matrix();
+    EXPECT(assert_equal(gtsam::Matrix(R * link->inertia() * R.transpose()),
+                        Rc * composite->inertia() * Rc.transpose(), 1e-6));
+  }
+
+  // A toe contact point is at the same place after merging.
+  const PointOnLinks points{{robot.link("FR_toe"), Point3(0, 0, -0.02)}};
+  const PointOnLinks merged_points =
+      MergeContactPoints(points, merged, merged_links);
+  EXPECT(merged_points[0].link == merged.link("FR_lower"));
+  Values joint_angles, merged_joint_angles;
+  for (auto&& joint : merged.joints()) {
+    InsertJointAngle(&merged_joint_angles, joint->id(), 0, 0.3);
+    InsertJointAngle(&joint_angles, robot.joint(joint->name())->id(), 0, 0.3);
+  }
+  for (auto&& joint : robot.joints()) {
+    if (!joint_angles.exists(JointAngleKey(joint->id(), 0))) {
+      InsertJointAngle(&joint_angles, joint->id(), 0, 0.0);
+    }
+  }
+  const std::string root = "trunk";
+  const Values fk = robot.forwardKinematics(joint_angles, 0, root);
+  const Values merged_fk =
+      merged.forwardKinematics(merged_joint_angles, 0, root);
+  EXPECT(assert_equal(points[0].predict(fk),
+                      merged_points[0].predict(merged_fk), 1e-9));
+}
+
 #ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
 
 // Declaration needed for serialization of derived class.
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotCache.cpp
+ * @brief Test the binary robot cache.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+const std::string kA1 = kUrdfPath + std::string("a1/a1.urdf");
+
+TEST(RobotCache, Hash) {
+  const uint64_t hash = RobotModelHash(kA1);
+  EXPECT(hash == RobotModelHash(kA1));
+  EXPECT(hash != RobotModelHash(kA1, "", true));
+  EXPECT(hash != RobotModelHash(kA1, "a1"));
+  const std::string simple = kUrdfPath + std::string("test/simple_urdf.urdf");
+  EXPECT(hash != RobotModelHash(simple));
+  THROWS_EXCEPTION(RobotModelHash(kUrdfPath + std::string("missing.urdf")));
+}
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+TEST(RobotCache, CreateRobotFromFileCached) {
+  const auto cache_dir =
+      std::filesystem::temp_directory_path() / "gtdynamics_test_robot_cache";
+  std::filesystem::remove_all(cache_dir);
+
+  const Robot expected = CreateRobotFromFile(kA1);
+  const uint64_t hash = RobotModelHash(kA1);
+  const std::string cache_path = RobotCachePath(cache_dir.string(), hash);
+
+  // The first call parses the file and writes the cache.
+  EXPECT(!LoadRobotCache(cache_path, hash));
+  const Robot parsed = CreateRobotFromFileCached(kA1, cache_dir.string());
+  EXPECT(assert_equal(expected, parsed));
+  EXPECT(std::filesystem::exists(cache_path));
+
+  // The second call loads the cache, with links reconnected to their joints.
+  const Robot cached = CreateRobotFromFileCached(kA1, cache_dir.string());
+  EXPECT(assert_equal(expected, cached));
+  for (auto&& link : expected.links()) {
+    const auto& expected_joints = link->joints();
+    const auto& joints = cached.link(link->name())->joints();
+    EXPECT_LONGS_EQUAL(expected_joints.size(), joints.size());
+    for (size_t k = 0; k < joints.size(); k++) {
+      EXPECT(expected_joints[k]->name() == joints[k]->name());
+    }
+  }
+  EXPECT(expected.topology().traversal == cached.topology().traversal);
+  EXPECT(expected.topology().roots == cached.topology().roots);
+
+  // Forward kinematics of the cached robot matches the parsed one.
+  const size_t n = expected.topology().joints.size();
+  gtsam::Vector q(n), v(n);
+  for (size_t j = 0; j < n; j++) {
+    q(j) = 0.1 * (j % 4) - 0.15;
+    v(j) = 0.05 * j;
+  }
+  const gtsam::Pose3 wTb(gtsam::Rot3::Rz(0.3), gtsam::Point3(1, 2, 0.5));
+  LinkStates expected_states, cached_states;
+  expected.forwardKinematics(q, v, &expected_states, std::string("trunk"), wTb);
+  cached.forwardKinematics(q, v, &cached_states, std::string("trunk"), wTb);
+  for (auto&& link : expected.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(expected_states.poses[i], cached_states.poses[i]));
+    EXPECT(assert_equal(expected_states.twists[i], cached_states.twists[i]));
+  }
+
+  // Cache entries for another hash, or corrupt files, are misses.
+  EXPECT(!LoadRobotCache(cache_path, hash + 1));
+  const std::string corrupt_path = (cache_dir / "corrupt.robot").string();
+  std::ofstream(corrupt_path) << "not a robot";
+  EXPECT(!LoadRobotCache(corrupt_path, hash));
+
+  std::filesystem::remove_all(cache_dir);
+}
+#endif
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotGenerator.cpp
+ * @brief Test synthetic serial, branched and legged robots.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Values;
+
+TEST(RobotGenerator, serialChain) {
+  const SyntheticRobotParams params;
+  const Robot robot = SerialChainRobot(5, params);
+  EXPECT_LONGS_EQUAL(6, robot.numLinks());
+  EXPECT_LONGS_EQUAL(5, robot.numJoints());
+  EXPECT(robot.link("base")->isFixed());
+  EXPECT(robot.joint("joint_3")->parent() == robot.link("link_2"));
+
+  // At rest the chain stands upright, the last CoM half a link below the top.
+  Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), 0.0);
+  }
+  const Values fk = robot.forwardKinematics(known);
+  const double l = params.link_length;
+  EXPECT(assert_equal(Point3(0, 0, 4.5 * l),
+                      Pose(fk, robot.link("link_5")->id()).translation()));
+
+  THROWS_EXCEPTION(SerialChainRobot(256));
+}
+
+TEST(RobotGenerator, branched) {
+  const Robot robot = BranchedRobot(10, 3);
+  EXPECT_LONGS_EQUAL(11, robot.numLinks());
+  EXPECT_LONGS_EQUAL(10, robot.numJoints());
+
+  // Breadth first: the base carries links 1-3, link 1 carries links 4-6.
+  EXPECT_LONGS_EQUAL(3, robot.link("base")->numJoints());
+  EXPECT(robot.joint("joint_3")->parent() == robot.link("base"));
+  EXPECT(robot.joint("joint_4")->parent() == robot.link("link_1"));
+  EXPECT(robot.joint("joint_10")->parent() == robot.link("link_3"));
+
+  THROWS_EXCEPTION(BranchedRobot(10, 0));
+}
+
+TEST(RobotGenerator, legged) {
+  const Robot robot = LeggedRobot(6, 3);
+  EXPECT_LONGS_EQUAL(19, robot.numLinks());
+  EXPECT_LONGS_EQUAL(18, robot.numJoints());
+  EXPECT(!robot.link("base")->isFixed());
+  EXPECT(robot.joint("leg4_joint1")->parent() == robot.link("base"));
+  EXPECT(robot.joint("leg4_joint3")->parent() == robot.link("leg4_link2"));
+
+  // Feet hang below the base at rest.
+  Values known;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), 0.0);
+  }
+  const Values fk = robot.forwardKinematics(known, 0, std::string("base"));
+  for (size_t i = 1; i <= 6; i++) {
+    const auto foot = robot.link("leg" + std::to_string(i) + "_link3");
+    EXPECT(Pose(fk, foot->id()).z() < 0);
+  }
+}
+
+// The generated robots are trees the recursive algorithms accept.
+TEST(RobotGenerator, recursiveDynamics) {
+  for (const Robot &robot :
+       {SerialChainRobot(20), BranchedRobot(20, 2), LeggedRobot(4, 3)}) {
+    const RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+    const size_t n = dynamics.numJoints();
+    const gtsam::Vector q = gtsam::Vector::Constant(n, 0.1),
+                        v = gtsam::Vector::Constant(n, 0.2),
+                        tau = gtsam::Vector::Zero(n);
+    gtsam::Matrix M(n, n);
+    dynamics.massMatrix(q, &M);
+    EXPECT(M.isApprox(M.transpose()));
+    gtsam::Vector qdd(n);
+    dynamics.forwardDynamics(q, v, tau, &qdd);
+    EXPECT(qdd.allFinite());
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotParameters.cpp
+ * @brief Test factors reading the parameters of a robot from a shared block.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/JointFactors.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/universal_robot/RobotParameters.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+SyntheticRobotParams HeavyParams() {
+  SyntheticRobotParams params;
+  params.link_length = 0.3;
+  params.link_mass = 1.5;
+  return params;
+}
+}  // namespace
+
+// Factors built with a block follow changes of the block.
+TEST(RobotParameters, factors) {
+  const Robot robot = SerialChainRobot(2);
+  const Robot heavy = SerialChainRobot(2, HeavyParams());
+  auto parameters = std::make_shared<RobotParameters>(robot);
+  const auto link = robot.link("link_1");
+  const auto joint = robot.joint("joint_1");
+  EXPECT_DOUBLES_EQUAL(link->mass(), parameters->mass(link->id()), 1e-12);
+  THROWS_EXCEPTION(parameters->joint(7));
+
+  const auto model = gtsam::noiseModel::Unit::Create(6);
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const std::vector<gtsam::Key> wrench_keys{
+      WrenchKey(link->id(), joint->id(), 0)};
+  const LinkWrenchFactor wrench(model, parameters, link, wrench_keys, 0,
+                                gravity);
+  const JointPoseFactor pose(model, parameters, joint->id(), 0);
+
+  const Values values = Initializer().ZeroValues(robot, 0, 0.3);
+  EXPECT_DOUBLES_EQUAL(
+      LinkWrenchFactor(model, link, wrench_keys, 0, gravity).error(values),
+      wrench.error(values), 1e-9);
+  EXPECT_DOUBLES_EQUAL(JointPoseFactor(model, joint, 0).error(values),
+                       pose.error(values), 1e-9);
+
+  parameters->update(heavy);
+  const auto heavy_link = heavy.link("link_1");
+  EXPECT_DOUBLES_EQUAL(
+      LinkWrenchFactor(model, heavy_link, wrench_keys, 0, gravity)
+          .error(values),
+      wrench.error(values), 1e-9);
+  EXPECT_DOUBLES_EQUAL(
+      JointPoseFactor(model, heavy.joint("joint_1"), 0).error(values),
+      pose.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(wrench, values, 1e-7, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(pose, values, 1e-7, 1e-5);
+
+  // Single parameters can be set too.
+  parameters->setInertialParameters(link->id(), 2.0, gtsam::I_3x3);
+  EXPECT_DOUBLES_EQUAL(2.0, parameters->mass(link->id()), 1e-12);
+  THROWS_EXCEPTION(parameters->update(SerialChainRobot(3)));
+}
+
+// A dynamics graph built once gives the errors of a graph built for a variant
+// of the robot, after the block is updated to it.
+TEST(RobotParameters, dynamicsFactorGraph) {
+  const Robot robot = SerialChainRobot(3);
+  const Robot heavy = SerialChainRobot(3, HeavyParams());
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+
+  OptimizerSetting opt;
+  auto parameters = std::make_shared<RobotParameters>(robot);
+  opt.robot_parameters = parameters;
+  const NonlinearFactorGraph graph =
+      DynamicsGraph(opt, gravity).dynamicsFactorGraph(robot, 0);
+
+  OptimizerSetting closed;
+  closed.closed_form_jacobians = true;
+  const DynamicsGraph closed_builder(closed, gravity);
+  const NonlinearFactorGraph expected = closed_builder.dynamicsFactorGraph(
+      robot, 0);
+  const NonlinearFactorGraph expected_heavy =
+      closed_builder.dynamicsFactorGraph(heavy, 0);
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+
+  const Values values = Initializer().ZeroValues(robot, 0, 0.3);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), graph.error(values), 1e-9);
+  parameters->update(heavy);
+  EXPECT(std::abs(expected.error(values) - graph.error(values)) > 1e-6);
+  EXPECT_DOUBLES_EQUAL(expected_heavy.error(values), graph.error(values),
+                       1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRuntime.cpp
+ * @brief Test the GTSAM-independent runtime against StaticRobot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/RuntimeExport.h>
+#include <gtdynamics/dynamics/StaticRobot.h>
+#include <gtdynamics/runtime/RuntimeTrajectory.h>
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/TrajectoryWriter.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace {
+gtsam::Vector ToVector(const std::vector<double> &x) {
+  return Eigen::Map<const gtsam::Vector>(x.data(), x.size());
+}
+
+gtsam::Pose3 ToPose(const runtime::Transform &T) {
+  gtsam::Matrix3 R;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) R(i, j) = T.R[3 * i + j];
+  }
+  return gtsam::Pose3(gtsam::Rot3(R), gtsam::Point3(T.t[0], T.t[1], T.t[2]));
+}
+}  // namespace
+
+/// Kinematics and dynamics of a robot cache file match StaticRobot, both in
+/// the runtime and in the Robot loaded back from the same file.
+TEST(Runtime, model) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const StaticRobot<3> arm(robot, gravity);
+
+  const auto cache_path =
+      std::filesystem::temp_directory_path() / "gtdynamics_test_runtime.robot";
+  SaveRobotCache(robot, 42, cache_path.string());
+  std::ifstream is(cache_path, std::ios::binary);
+  runtime::Model model = runtime::Model::Load(is);
+  for (int i = 0; i < 3; i++) model.gravity[i] = gravity(i);
+  EXPECT_LONGS_EQUAL(3, model.numJoints());
+
+  using JointVector = StaticRobot<3>::JointVector;
+  const JointVector q(0.1, -0.4, 0.7), v(0.5, 0.2, -0.3), a(1.0, 0.3, -2.0);
+  const std::vector<double> qs(q.data(), q.data() + 3),
+      vs(v.data(), v.data() + 3), as(a.data(), a.data() + 3);
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  // The same file loads back into a Robot with the topology and dynamics of
+  // the original.
+  const std::optional<Robot> cached = LoadRobotCache(cache_path.string(), 42);
+  CHECK(cached);
+  EXPECT(assert_equal(robot, *cached));
+  EXPECT(robot.topology().traversal == cached->topology().traversal);
+  EXPECT(robot.topology().roots == cached->topology().roots);
+  LinkStates expected_states, cached_states;
+  robot.forwardKinematics(q, v, &expected_states);
+  cached->forwardKinematics(q, v, &cached_states);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(expected_states.poses[i], cached_states.poses[i]));
+    EXPECT(assert_equal(expected_states.twists[i], cached_states.twists[i]));
+  }
+  const StaticRobot<3> cached_arm(*cached, gravity);
+  EXPECT(assert_equal(gtsam::Vector(arm.inverseDynamics(q, v, a)),
+                      gtsam::Vector(cached_arm.inverseDynamics(q, v, a)),
+                      1e-9));
+#endif
+  std::filesystem::remove(cache_path);
+
+  const auto expected_poses = arm.forwardKinematics(q);
+  const auto poses = model.forwardKinematics(qs);
+  for (int j = 0; j < 3; j++) {
+    EXPECT(assert_equal(expected_poses[j], ToPose(poses[j]), 1e-9));
+  }
+
+  const JointVector tau = arm.inverseDynamics(q, v, a);
+  EXPECT(assert_equal(gtsam::Vector(tau),
+                      ToVector(model.inverseDynamics(qs, vs, as)), 1e-9));
+
+  const gtsam::Matrix M = arm.massMatrix(q);
+  const std::vector<double> Ms = model.massMatrix(qs);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) DOUBLES_EQUAL(M(i, j), Ms[3 * i + j], 1e-9);
+  }
+
+  const std::vector<double> taus(tau.data(), tau.data() + 3);
+  EXPECT(assert_equal(gtsam::Vector(a),
+                      ToVector(model.forwardDynamics(qs, vs, taus)), 1e-9));
+}
+
+/// A file without the magic of robot cache files is rejected.
+TEST(Runtime, loadMalformed) {
+  std::stringstream ss("GTDTRAJ1");
+  THROWS_EXCEPTION(runtime::Model::Load(ss));
+}
+
+/// Trajectories written by TrajectoryWriter are played back by joint name.
+TEST(Runtime, trajectory) {
+  const Robot robot = simple_rr::getRobot();
+  const size_t num_steps = 3;
+  const double dt = 0.1;
+  gtsam::Values values;
+  for (size_t k = 0; k < num_steps; k++) {
+    for (auto &&joint : robot.joints()) {
+      const double x = joint->id() + 0.25 * k;
+      InsertJointAngle(&values, joint->id(), k, x);
+      InsertJointVel(&values, joint->id(), k, 2 * x);
+      InsertJointAccel(&values, joint->id(), k, 3 * x);
+      InsertTorque(&values, joint->id(), k, -x);
+    }
+  }
+
+  std::stringstream ss;
+  TrajectoryWriter writer(robot, ss, TrajectoryWriter::BINARY);
+  writer.writeHeader();
+  for (size_t k = 0; k < num_steps; k++) writer.writeStep(values, k, dt);
+
+  const runtime::Model model = ToRuntimeModel(robot);
+  const auto trajectory = runtime::Trajectory::Load(ss, model);
+  EXPECT_LONGS_EQUAL(num_steps, trajectory.numSteps());
+  DOUBLES_EQUAL(0.2, trajectory.duration(), 1e-12);
+  for (auto &&joint : robot.joints()) {
+    const int j = model.jointId(joint->name());
+    EXPECT_LONGS_EQUAL(joint->id(), j);
+    DOUBLES_EQUAL(JointAngle(values, j, 1), trajectory.step(1).q[j], 1e-12);
+    DOUBLES_EQUAL(Torque(values, j, 2), trajectory.step(2).tau[j], 1e-12);
+
+    // Halfway between steps 1 and 2, and clamped after the last step.
+    const auto state = trajectory.sample(0.15);
+    DOUBLES_EQUAL(2 * (joint->id() + 0.375), state.v[j], 1e-12);
+    DOUBLES_EQUAL(JointAccel(values, j, 2), trajectory.sample(1.0).a[j],
+                  1e-12);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
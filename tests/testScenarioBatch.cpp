@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testScenarioBatch.cpp
+ * @brief Test trajectory graphs over several scenarios.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/ScenarioBatch.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::Key;
+using gtsam::Values;
+
+// Torques keep their keys, other variables move to their scenario.
+TEST(ScenarioBatch, key) {
+  const ScenarioBatch batch(3, 10);
+  EXPECT(batch.isShared(TorqueKey(1, 4)));
+  EXPECT(!batch.isShared(JointAngleKey(1, 4)));
+  EXPECT_LONGS_EQUAL(TorqueKey(1, 4), batch.key(TorqueKey(1, 4), 2));
+  EXPECT_LONGS_EQUAL(JointAngleKey(1, 24), batch.key(JointAngleKey(1, 4), 2));
+  EXPECT_LONGS_EQUAL(PoseKey(0, 4), batch.key(PoseKey(0, 4), 0));
+  THROWS_EXCEPTION(batch.key(JointAngleKey(1, 10), 0));
+}
+
+// Trajectory graphs of two robots share their torques.
+TEST(ScenarioBatch, trajectory) {
+  const auto robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(simple_rr::gravity, simple_rr::planar_axis);
+  const int num_steps = 3;
+  const ScenarioBatch batch(2, num_steps + 1);
+  const auto scenario_graph = TrajectoryScenarios(
+      graph_builder, {robot, robot}, num_steps, 0.1);
+  const auto single = scenario_graph(0);
+  const auto graph = batch.graph(scenario_graph);
+  EXPECT_LONGS_EQUAL(2 * single.size(), graph.size());
+
+  size_t num_torques = 0;
+  for (Key key : single.keys()) num_torques += batch.isShared(key);
+  EXPECT_LONGS_EQUAL(robot.numJoints() * (num_steps + 1), num_torques);
+  EXPECT_LONGS_EQUAL(2 * single.keys().size() - num_torques,
+                     graph.keys().size());
+
+  // Shared torques are eliminated last.
+  const gtsam::Ordering ordering = batch.ordering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  for (size_t i = ordering.size() - num_torques; i < ordering.size(); i++) {
+    EXPECT(batch.isShared(ordering[i]));
+  }
+
+  // Values of the batch split back into those of the scenarios.
+  Initializer initializer;
+  auto scenario_values = [&](size_t s) {
+    Values values = initializer.ZeroValuesTrajectory(robot, num_steps);
+    for (int k = 0; k <= num_steps; k++) {
+      values.update(JointAngleKey(0, k), double(s));
+    }
+    return values;
+  };
+  const Values values = batch.values(scenario_values);
+  for (size_t s = 0; s < 2; s++) {
+    EXPECT(assert_equal(scenario_values(s), batch.scenarioValues(values, s)));
+  }
+  EXPECT_DOUBLES_EQUAL(2 * single.error(scenario_values(0)),
+                       graph.error(batch.values([&](size_t) {
+                         return scenario_values(0);
+                       })),
+                       1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
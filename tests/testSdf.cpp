@@ -24,6 +24,8 @@
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 
+#include <filesystem>
+
 using namespace gtdynamics;
 using gtsam::assert_equal;
 using gtsam::Point3;
@@ -658,6 +660,68 @@ TEST(Sdf, PreserveFixedJoint) {
   EXPECT_LONGS_EQUAL(21, a1_fixed_joints.numJoints());
 }
 
+TEST(Sdf, CreateRobotsFromFiles) {
+  const std::string a1_path = kUrdfPath + std::string("a1/a1.urdf");
+  const std::string rrr_path = kSdfPath + std::string("test/simple_rrr.sdf");
+  const std::vector<RobotFile> files{{a1_path},
+                                     {a1_path, "a1_fixed", true},
+                                     {rrr_path, "simple_rrr_sdf"}};
+  const auto robots = CreateRobotsFromFiles(files);
+  EXPECT_LONGS_EQUAL(3, robots.size());
+  EXPECT(assert_equal(CreateRobotFromFile(a1_path), robots.at("a1")));
+  EXPECT_LONGS_EQUAL(21, robots.at("a1_fixed").numJoints());
+  EXPECT(assert_equal(CreateRobotFromFile(rrr_path, "simple_rrr_sdf"),
+                      robots.at("simple_rrr_sdf")));
+
+  // Two files with the same key are rejected.
+  const std::vector<RobotFile> duplicates{{a1_path}, {a1_path}};
+  THROWS_EXCEPTION(CreateRobotsFromFiles(duplicates));
+}
+
+/// Several URDF and SDF files loaded on several threads, with and without
+/// the robot cache, match the robots loaded one at a time.
+TEST(Sdf, CreateRobotsFromFilesThreaded) {
+  const std::vector<RobotFile> files{
+      {kUrdfPath + std::string("a1/a1.urdf")},
+      {kUrdfPath + std::string("biped.urdf")},
+      {kUrdfPath + std::string("cart_pole.urdf")},
+      {kUrdfPath + std::string("test/simple_urdf.urdf")},
+      {kSdfPath + std::string("spider.sdf"), "spider"},
+      {kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf"},
+      {kSdfPath + std::string("test/four_bar_linkage.sdf")}};
+  const std::vector<std::string> keys{
+      "a1",     "biped",          "cart_pole",       "simple_urdf",
+      "spider", "simple_rrr_sdf", "four_bar_linkage"};
+  std::vector<Robot> expected;
+  for (auto &&file : files) {
+    expected.push_back(CreateRobotFromFile(file.file_path, file.model_name));
+  }
+
+  const auto execution = ExecutionContext::Threads(4);
+  const auto robots = CreateRobotsFromFiles(files, {}, execution);
+  EXPECT_LONGS_EQUAL(files.size(), robots.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    EXPECT(assert_equal(expected[i], robots.at(keys[i])));
+  }
+
+#ifdef GTDYNAMICS_ENABLE_BOOST_SERIALIZATION
+  // The first pass writes the cache files, the second one reads them.
+  const auto cache_dir =
+      std::filesystem::temp_directory_path() / "gtdynamics_test_sdf_cache";
+  std::filesystem::remove_all(cache_dir);
+  for (int pass = 0; pass < 2; pass++) {
+    const auto cached =
+        CreateRobotsFromFiles(files, cache_dir.string(), execution);
+    for (size_t i = 0; i < files.size(); i++) {
+      const Robot &robot = cached.at(keys[i]);
+      EXPECT(assert_equal(expected[i], robot));
+      EXPECT(expected[i].topology().traversal == robot.topology().traversal);
+    }
+  }
+  std::filesystem::remove_all(cache_dir);
+#endif
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
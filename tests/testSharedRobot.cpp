@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSharedRobot.cpp
+ * @brief Test immutable shared robots and their variants.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/SharedRobot.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+const std::string kFourBar =
+    kSdfPath + std::string("test/four_bar_linkage_pure.sdf");
+
+TEST(SharedRobot, base) {
+  Robot robot = CreateRobotFromFile(kFourBar);
+  const SharedRobot shared(robot);
+  EXPECT(shared.base().equals(robot));
+
+  // Without changes, the robot is the base itself.
+  EXPECT(&shared.robot() == &shared.base());
+
+  // Later changes to the original robot are not seen.
+  robot.fixLink("l1");
+  EXPECT(!shared.base().link("l1")->isFixed());
+}
+
+TEST(SharedRobot, fixLink) {
+  const SharedRobot shared(CreateRobotFromFile(kFourBar));
+  const Pose3 wTl1(gtsam::Rot3(), gtsam::Point3(1, 2, 3));
+  const SharedRobot fixed = shared.fixLink("l1", wTl1);
+  EXPECT(fixed.isFixed("l1"));
+  EXPECT(!shared.isFixed("l1"));
+  EXPECT(&fixed.base() == &shared.base());
+
+  const Robot &robot = fixed.robot();
+  EXPECT(robot.link("l1")->isFixed());
+  EXPECT(assert_equal(wTl1, robot.link("l1")->getFixedPose()));
+  EXPECT(!robot.link("l2")->isFixed());
+  EXPECT(!shared.base().link("l1")->isFixed());
+
+  // Copies share the variant's robot.
+  const SharedRobot copy = fixed;
+  EXPECT(&copy.robot() == &robot);
+
+  // Unfixing gives back the base links.
+  const SharedRobot unfixed = fixed.unfixLink("l1");
+  EXPECT(!unfixed.isFixed("l1"));
+  EXPECT(&unfixed.robot() == &shared.base());
+
+  THROWS_EXCEPTION(shared.fixLink("no_such_link"));
+}
+
+TEST(SharedRobot, threads) {
+  const SharedRobot fixed =
+      SharedRobot(CreateRobotFromFile(kFourBar)).fixLink("l1");
+  std::vector<const Robot *> robots(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < robots.size(); i++) {
+    threads.emplace_back([&, i]() { robots[i] = &fixed.robot(); });
+  }
+  for (auto &&thread : threads) thread.join();
+  for (auto &&robot : robots) EXPECT(robot == robots[0]);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -14,13 +14,16 @@
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/Simulator.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <cmath>
 #include <iostream>
 
 using namespace gtdynamics;
@@ -52,6 +55,172 @@ TEST(Simulate, simple_urdf) {
   EXPECT(assert_equal(expected_qAccel, JointAccel(results, 0)));
 }
 
+// The vector interface should match the Values interface.
+TEST(Simulate, simple_urdf_vector) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values;
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+
+  const double dt = 1;
+  const gtsam::Vector torques = gtsam::Vector1(1.0);
+  simulator.step(torques, dt);
+  simulator.step(torques, dt);
+
+  double acceleration = 0.0625;
+  EXPECT(assert_equal(acceleration * 2 * dt * dt, simulator.jointAngles()(0),
+                      1e-9));
+  EXPECT(assert_equal(acceleration * 2 * dt, simulator.jointVels()(0), 1e-9));
+  EXPECT(assert_equal(acceleration, simulator.jointAccels()(0), 1e-9));
+  EXPECT(assert_equal(1.0, Torque(simulator.jointValues(), 0), 1e-9));
+
+  // Restart and check a single step against the Values interface.
+  simulator.reset();
+  EXPECT(assert_equal(0.0, simulator.jointAngles()(0)));
+  gtsam::Values torque_values;
+  InsertTorque(&torque_values, 0, 1.0);
+  simulator.step(torque_values, dt);
+  simulator.step(torques, dt);
+  EXPECT(assert_equal(JointAccel(simulator.getValues(), 0),
+                      simulator.jointAccels()(0), 1e-9));
+}
+
+// Fixed-base arm under gravity, where accelerations depend on the state.
+Robot SimpleRRR() {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  return robot.fixLink("link_0");
+}
+
+// Semi-implicit Euler uses the new velocity to update the angle.
+TEST(Simulate, semi_implicit_euler) {
+  using gtsam::assert_equal;
+  auto robot = SimpleRRR();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  Simulator simulator(robot, gtsam::Values(), gravity);
+  simulator.setIntegrationScheme(SemiImplicitEuler);
+  const double dt = 0.01;
+  const gtsam::Vector torques = gtsam::Vector3(0.1, 0.2, 0.3);
+  simulator.step(torques, dt);
+  const gtsam::Vector expected_v = dt * simulator.jointAccels();
+  EXPECT(assert_equal(expected_v, simulator.jointVels(), 1e-9));
+  EXPECT(assert_equal(gtsam::Vector(dt * expected_v), simulator.jointAngles(),
+                      1e-9));
+}
+
+// RK4 with a coarse time step should match a fine Taylor simulation.
+TEST(Simulate, runge_kutta_4) {
+  using gtsam::assert_equal;
+  auto robot = SimpleRRR();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const gtsam::Vector torques = gtsam::Vector3(0.1, 0.2, 0.3);
+  const double T = 0.1;
+
+  Simulator fine(robot, gtsam::Values(), gravity);
+  const int num_fine_steps = 10000;
+  for (int k = 0; k < num_fine_steps; ++k) {
+    fine.step(torques, T / num_fine_steps);
+  }
+
+  Simulator coarse(robot, gtsam::Values(), gravity);
+  coarse.setIntegrationScheme(RungeKutta4);
+  const int num_coarse_steps = 10;
+  for (int k = 0; k < num_coarse_steps; ++k) {
+    coarse.step(torques, T / num_coarse_steps);
+  }
+  EXPECT(assert_equal(fine.jointAngles(), coarse.jointAngles(), 1e-5));
+  EXPECT(assert_equal(fine.jointVels(), coarse.jointVels(), 1e-4));
+
+  // The Values interface should integrate the same way.
+  Simulator values_simulator(robot, gtsam::Values(), gravity);
+  values_simulator.setIntegrationScheme(RungeKutta4);
+  gtsam::Values torque_values;
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&torque_values, joint->id(), torques(joint->id()));
+  }
+  std::vector<gtsam::Values> torques_seq(num_coarse_steps + 1, torque_values);
+  const gtsam::Values results =
+      values_simulator.simulate(torques_seq, T / num_coarse_steps);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(coarse.jointAngles()(j), JointAngle(results, j),
+                         1e-6);
+  }
+}
+
+// Recording a trajectory should give the same states as stepping.
+TEST(Simulate, record_trajectory) {
+  using gtsam::assert_equal;
+  auto robot = SimpleRRR();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const double dt = 0.01;
+  const gtsam::Matrix torques = gtsam::Matrix::Constant(5, 3, 0.2);
+
+  Simulator recorder(robot, gtsam::Values(), gravity);
+  JointTrajectory trajectory;
+  recorder.simulate(torques, dt, &trajectory);
+  EXPECT_LONGS_EQUAL(6, trajectory.q.rows());
+  EXPECT_LONGS_EQUAL(5, trajectory.a.rows());
+
+  Simulator simulator(robot, gtsam::Values(), gravity);
+  EXPECT(assert_equal(simulator.jointAngles(),
+                      gtsam::Vector(trajectory.q.row(0).transpose())));
+  for (int k = 0; k < 5; ++k) {
+    simulator.step(gtsam::Vector(torques.row(k).transpose()), dt);
+    EXPECT(assert_equal(simulator.jointAccels(),
+                        gtsam::Vector(trajectory.a.row(k).transpose())));
+    EXPECT(assert_equal(simulator.jointAngles(),
+                        gtsam::Vector(trajectory.q.row(k + 1).transpose())));
+    EXPECT(assert_equal(simulator.jointVels(),
+                        gtsam::Vector(trajectory.v.row(k + 1).transpose())));
+  }
+}
+
+// Adaptive steps match a fine simulation with far fewer dynamics solves.
+TEST(Simulate, adaptive) {
+  using gtsam::assert_equal;
+  auto robot = SimpleRRR();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const gtsam::Vector torques = gtsam::Vector3(0.1, 0.2, 0.3);
+  const double T = 0.1;
+
+  Simulator fine(robot, gtsam::Values(), gravity);
+  fine.setIntegrationScheme(RungeKutta4);
+  for (int k = 0; k < 1000; ++k) fine.step(torques, T / 1000);
+
+  Simulator adaptive(robot, gtsam::Values(), gravity);
+  const AdaptiveSimulationResult result = adaptive.simulateAdaptive(torques, T);
+  EXPECT_DOUBLES_EQUAL(T, result.time, 1e-12);
+  EXPECT(!result.contact);
+  EXPECT(result.num_solves < 400);
+  EXPECT(assert_equal(fine.jointAngles(), adaptive.jointAngles(), 1e-4));
+  EXPECT(assert_equal(fine.jointVels(), adaptive.jointVels(), 1e-3));
+}
+
+// A falling pendulum stops where its tip reaches the ground.
+TEST(Simulate, adaptive_touchdown) {
+  const Robot robot = SerialChainRobot(1);
+  gtsam::Values initial_values;
+  InsertJointAngle(&initial_values, 1, 0.1);
+  Simulator simulator(robot, initial_values, gtsam::Vector3(0, 0, -9.8));
+
+  // The tip starts at height 0.2 cos(0.1) and hits the ground at 0.1.
+  const PointOnLinks tips{{robot.link("link_1"), gtsam::Point3(0, 0, 0.1)}};
+  const AdaptiveSimulationResult result =
+      simulator.simulateAdaptive(gtsam::Vector::Zero(2), 5.0, tips, {}, 0.1);
+  CHECK(result.contact);
+  EXPECT_LONGS_EQUAL(0, *result.contact);
+  EXPECT(result.time < 5.0);
+  EXPECT_DOUBLES_EQUAL(M_PI / 3, simulator.jointAngles()(1), 1e-5);
+
+  // Energy is conserved up to the touchdown.
+  const double lost = 0.2 * 9.8 * 0.5 * (std::cos(0.1) - 0.5) -
+                      0.5 * (1.0 / 300 + 0.02 * 0.02 / 4 + 0.01) *
+                          std::pow(simulator.jointVels()(1), 2);
+  EXPECT_DOUBLES_EQUAL(0.0, lost, 1e-4);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,192 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSparseDynamics.cpp
+ * @brief Test the sparse linear dynamics solver against the factor graph.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/SparseDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Build known values with kinematics and torques for the given robot.
+Values KnownValues(const Robot& robot, int t,
+                   const std::optional<std::string>& prior_link = {}) {
+  Values values;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, 0.1 * j + 0.2);
+    InsertJointVel(&values, j, t, 0.5 - 0.3 * j);
+    InsertTorque(&values, j, t, 1.0 + 0.2 * j);
+  }
+  if (prior_link) {
+    const auto link = robot.link(*prior_link);
+    InsertPose(&values, link->id(), t, link->bMcom());
+    InsertTwist(&values, link->id(), t,
+                (gtsam::Vector6() << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6).finished());
+  }
+  return robot.forwardKinematics(values, t, prior_link);
+}
+
+// Check that the accelerations, torques and wrenches of two results agree.
+bool SameResults(const Robot& robot, const Values& expected,
+                 const Values& actual, int t) {
+  bool same = true;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    same &= assert_equal(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                         1e-6);
+    same &= assert_equal(Torque(expected, j, t), Torque(actual, j, t), 1e-6);
+    for (auto&& link : joint->links()) {
+      const int i = link->id();
+      same &= assert_equal(Wrench(expected, i, j, t), Wrench(actual, i, j, t),
+                           1e-6);
+    }
+  }
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    same &= assert_equal(TwistAccel(expected, i, t), TwistAccel(actual, i, t),
+                         1e-6);
+  }
+  return same;
+}
+
+// Check that sparse and elimination forward dynamics agree.
+bool SameFD(const Robot& robot, const DynamicsGraph& graph_builder,
+            const Values& known_values, int t) {
+  DynamicsGraph elimination = graph_builder;
+  DynamicsGraph sparse = graph_builder;
+  sparse.setLinearSolver(Sparse);
+  return SameResults(robot, elimination.linearSolveFD(robot, t, known_values),
+                     sparse.linearSolveFD(robot, t, known_values), t);
+}
+
+// Check that sparse and elimination inverse dynamics agree.
+bool SameID(const Robot& robot, const DynamicsGraph& graph_builder,
+            const Values& kinematics, int t) {
+  Values known_values = kinematics;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    known_values.erase(TorqueKey(j, t));
+    InsertJointAccel(&known_values, j, t, 0.4 - 0.1 * j);
+  }
+  DynamicsGraph elimination = graph_builder;
+  DynamicsGraph sparse = graph_builder;
+  sparse.setLinearSolver(Sparse);
+  return SameResults(robot, elimination.linearSolveID(robot, t, known_values),
+                     sparse.linearSolveID(robot, t, known_values), t);
+}
+
+// Fixed-base serial chain with gravity.
+TEST(SparseDynamics, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const int t = 3;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  EXPECT(SameFD(robot, graph_builder, KnownValues(robot, t), t));
+  EXPECT(SameID(robot, graph_builder, KnownValues(robot, t), t));
+
+  // The same solver, with its ordering, is reused for other time steps.
+  SparseDynamics solver(robot, gtsam::Vector3(0, 0, -9.8));
+  EXPECT_LONGS_EQUAL(4 * 6 + 3 * 14, solver.dim());
+  for (int k = 0; k < 3; ++k) {
+    const Values known_values = KnownValues(robot, k);
+    EXPECT(SameResults(robot,
+                       graph_builder.linearSolveFD(robot, k, known_values),
+                       solver.forwardDynamics(k, known_values), k));
+  }
+}
+
+// A DynamicsGraph keeps its sparse solver across time steps, and rebuilds it
+// when a link is fixed, which changes the sparsity pattern.
+TEST(SparseDynamics, solver_reuse) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  const SparseDynamics solver(robot, gtsam::Vector3(0, 0, -9.8));
+  EXPECT(solver.builtFor(robot));
+
+  robot = robot.fixLink("link_0");
+  EXPECT(!solver.builtFor(robot));
+  DynamicsGraph elimination(gtsam::Vector3(0, 0, -9.8));
+  DynamicsGraph sparse = elimination;
+  sparse.setLinearSolver(Sparse);
+  for (int k = 0; k < 3; ++k) {
+    const Values known_values = KnownValues(robot, k);
+    EXPECT(SameResults(robot, elimination.linearSolveFD(robot, k, known_values),
+                       sparse.linearSolveFD(robot, k, known_values), k));
+  }
+}
+
+// Floating-base quadruped with fixed joints.
+TEST(SparseDynamics, a1) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const int t = 0;
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const Values known_values = KnownValues(robot, t, std::string("trunk"));
+  EXPECT(SameID(robot, graph_builder, known_values, t));
+}
+
+// Planar robot, solved with three coordinates per twist and wrench.
+TEST(SparseDynamics, planar) {
+  auto robot = simple_urdf::getRobot();
+  const int t = 0;
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  Values values;
+  InsertJointAngle(&values, 0, t, 0.3);
+  InsertJointVel(&values, 0, t, 0.5);
+  InsertTorque(&values, 0, t, 1.0);
+  const Values known_values = robot.forwardKinematics(values, t);
+  EXPECT(SameFD(robot, graph_builder, known_values, t));
+  EXPECT(SameID(robot, graph_builder, known_values, t));
+
+  SparseDynamics solver(robot, simple_urdf::gravity, simple_urdf::planar_axis);
+  EXPECT_LONGS_EQUAL(3, solver.twistDim());
+  EXPECT_LONGS_EQUAL(2 * 3 + 1 * 8, solver.dim());
+}
+
+// Closed kinematic chain in a plane, which the recursive solvers reject.
+TEST(SparseDynamics, four_bar_linkage) {
+  Robot robot = four_bar_linkage_pure::getRobot().fixLink("l1");
+  Values known_values;
+  const gtsam::Vector torques = (gtsam::Vector(4) << 1, 0, 1, 0).finished();
+  for (auto&& link : robot.links()) {
+    InsertPose(&known_values, link->id(), 0, link->bMcom());
+    InsertTwist(&known_values, link->id(), 0, gtsam::Z_6x1);
+  }
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known_values, j, 0, 0.0);
+    InsertJointVel(&known_values, j, 0, 0.0);
+    InsertTorque(&known_values, j, 0, torques[j]);
+  }
+
+  SparseDynamics solver(robot, four_bar_linkage_pure::gravity,
+                        four_bar_linkage_pure::planar_axis);
+  const Values result = solver.forwardDynamics(0, known_values);
+  const gtsam::Vector expected_qAccel =
+      (gtsam::Vector(4) << 0.25, -0.25, 0.25, -0.25).finished();
+  EXPECT(assert_equal(expected_qAccel,
+                      DynamicsGraph::jointAccels(robot, result, 0), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStaticRobot.cpp
+ * @brief Test fixed-size kinematics and dynamics against the dynamic Robot.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/dynamics/StaticRobot.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+TEST(StaticRobot, simple_rrr) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const StaticRobot<3> arm(robot, kGravity);
+  const RecursiveDynamics solver(robot, kGravity);
+
+  using JointVector = StaticRobot<3>::JointVector;
+  const JointVector q(0.1, -0.4, 0.7), v(0.5, 0.2, -0.3), a(1.0, 0.3, -2.0);
+
+  // Forward kinematics matches Robot::forwardKinematics.
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), q(joint->id()));
+  }
+  const Values fk = robot.forwardKinematics(known);
+  const auto poses = arm.forwardKinematics(q);
+  for (auto&& joint : robot.joints()) {
+    EXPECT(assert_equal(Pose(fk, joint->child()->id()), poses[joint->id()],
+                        1e-9));
+  }
+
+  // Joint-space dynamics match RecursiveDynamics.
+  gtsam::Matrix M(3, 3);
+  gtsam::Vector h(3), qdd(3);
+  solver.massMatrix(q, &M);
+  solver.biasTorques(q, v, &h);
+  EXPECT(assert_equal(M, gtsam::Matrix(arm.massMatrix(q)), 1e-9));
+  const JointVector tau = arm.inverseDynamics(q, v, a);
+  EXPECT(assert_equal(gtsam::Vector(M * a + h), gtsam::Vector(tau), 1e-9));
+
+  solver.forwardDynamics(q, v, tau, &qdd);
+  EXPECT(assert_equal(qdd, gtsam::Vector(arm.forwardDynamics(q, v, tau)),
+                      1e-6));
+  EXPECT(assert_equal(gtsam::Vector(a),
+                      gtsam::Vector(arm.forwardDynamics(q, v, tau)), 1e-6));
+}
+
+// Link Jacobians and inverse dynamics derivatives match numerical ones.
+TEST(StaticRobot, derivatives) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  const StaticRobot<3> arm(robot, kGravity);
+
+  using JointVector = StaticRobot<3>::JointVector;
+  const JointVector q(0.1, -0.4, 0.7), v(0.5, 0.2, -0.3), a(1.0, 0.3, -2.0);
+
+  for (int j = 0; j < 3; j++) {
+    Eigen::Matrix<double, 6, 3> H;
+    const gtsam::Pose3 pose = arm.linkPose(q, j, H);
+    EXPECT(assert_equal(arm.forwardKinematics(q)[j], pose));
+    const auto expected_H = gtsam::numericalDerivative11<gtsam::Pose3,
+                                                         gtsam::Vector3>(
+        [&](const gtsam::Vector3& x) { return arm.linkPose(x, j); }, q);
+    EXPECT(assert_equal(expected_H, gtsam::Matrix(H), 1e-7));
+  }
+  THROWS_EXCEPTION(arm.linkPose(q, 3));
+
+  StaticRobot<3>::JointMatrix tau_H_q, tau_H_v;
+  const JointVector tau = arm.inverseDynamics(q, v, a, &tau_H_q, &tau_H_v);
+  EXPECT(assert_equal(gtsam::Vector(arm.inverseDynamics(q, v, a)),
+                      gtsam::Vector(tau), 1e-12));
+  const auto expected_H_q =
+      gtsam::numericalDerivative11<gtsam::Vector3, gtsam::Vector3>(
+          [&](const gtsam::Vector3& x) { return arm.inverseDynamics(x, v, a); },
+          q);
+  const auto expected_H_v =
+      gtsam::numericalDerivative11<gtsam::Vector3, gtsam::Vector3>(
+          [&](const gtsam::Vector3& x) { return arm.inverseDynamics(q, x, a); },
+          v);
+  EXPECT(assert_equal(expected_H_q, gtsam::Matrix(tau_H_q), 1e-6));
+  EXPECT(assert_equal(expected_H_v, gtsam::Matrix(tau_H_v), 1e-6));
+}
+
+// The number of joints must match the template argument.
+TEST(StaticRobot, wrong_size_throws) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  robot = robot.fixLink("link_0");
+  CHECK_EXCEPTION(StaticRobot<2> arm(robot), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
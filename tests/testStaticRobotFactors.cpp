@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStaticRobotFactors.cpp
+ * @brief Test factors on the joint variables of a StaticRobot arm.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+#include <gtdynamics/factors/StaticRobotFactors.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+Robot Arm() {
+  return CreateRobotFromFile(kSdfPath + std::string("test/simple_rrr.sdf"),
+                             "simple_rrr_sdf")
+      .fixLink("link_0");
+}
+}  // namespace
+
+// Zero error at the forward kinematics of the generic Robot.
+TEST(StaticRobotPoseFactor, error) {
+  const Robot robot = Arm();
+  const auto arm = std::make_shared<const StaticRobot<3>>(robot, kGravity);
+  const auto joint = robot.joints().back();
+  const StaticRobotPoseFactor<3> factor(
+      arm, joint->child()->id(), joint->id(),
+      gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+
+  Values known;
+  for (int j = 0; j < 3; j++) InsertJointAngle(&known, j, 0.3 * j - 0.2);
+  const Values fk = robot.forwardKinematics(known);
+  Values values = known;
+  InsertPose(&values, joint->child()->id(), Pose(fk, joint->child()->id()));
+  EXPECT(assert_equal(gtsam::Vector6::Zero(), factor.unwhitenedError(values),
+                      1e-9));
+
+  values.update(PoseKey(joint->child()->id()),
+                Pose(fk, joint->child()->id()) *
+                    gtsam::Pose3::Expmap(gtsam::Vector6::Constant(0.1)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// Zero error at the torques of RecursiveDynamics.
+TEST(StaticRobotDynamicsFactor, error) {
+  const Robot robot = Arm();
+  const auto arm = std::make_shared<const StaticRobot<3>>(robot, kGravity);
+  const RecursiveDynamics solver(robot, kGravity);
+  const StaticRobotDynamicsFactor<3> factor(
+      arm, gtsam::noiseModel::Isotropic::Sigma(3, 0.1), 2);
+
+  const gtsam::Vector3 q(0.1, -0.4, 0.7), v(0.5, 0.2, -0.3), a(1, 0.3, -2);
+  gtsam::Matrix M(3, 3);
+  gtsam::Vector h(3);
+  solver.massMatrix(q, &M);
+  solver.biasTorques(q, v, &h);
+  const gtsam::Vector tau = M * a + h;
+
+  Values values;
+  for (int j = 0; j < 3; j++) {
+    InsertJointAngle(&values, j, 2, q(j));
+    InsertJointVel(&values, j, 2, v(j));
+    InsertJointAccel(&values, j, 2, a(j));
+    InsertTorque(&values, j, 2, tau(j));
+  }
+  EXPECT(assert_equal(gtsam::Vector3::Zero(), factor.unwhitenedError(values),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
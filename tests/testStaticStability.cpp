@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStaticStability.cpp
+ * @brief Test center of mass, support polygon and ZMP checks.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/BatchForwardKinematics.h>
+#include <gtdynamics/statics/StaticStability.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point2;
+using gtsam::Point3;
+
+TEST(SupportPolygon, margin) {
+  // A 2 x 2 square, with a point inside and a repeated corner.
+  const SupportPolygon square({Point3(-1, -1, 0), Point3(1, -1, 0),
+                               Point3(1, 1, 0), Point3(-1, 1, 0),
+                               Point3(0.2, 0.1, 0), Point3(1, 1, 0.5)});
+  EXPECT_LONGS_EQUAL(4, square.vertices().size());
+  EXPECT_DOUBLES_EQUAL(1.0, square.margin(Point2(0, 0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5, square.margin(Point2(0.5, 0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-2.0, square.margin(Point2(3, 0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-std::sqrt(2.0), square.margin(Point2(2, 2)), 1e-9);
+  EXPECT(square.contains(Point2(0.9, 0.9)));
+  EXPECT(!square.contains(Point2(0.9, 0.9), 0.2));
+
+  // Collinear contacts, e.g. two feet, support no point strictly.
+  const SupportPolygon line({Point3(0, 0, 0), Point3(1, 0, 0)});
+  EXPECT_DOUBLES_EQUAL(0.0, line.margin(Point2(0.5, 0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-1.0, line.margin(Point2(0.5, 1)), 1e-9);
+  EXPECT(!SupportPolygon().contains(Point2(0, 0)));
+}
+
+TEST(StaticStability, ZeroMomentPoint) {
+  const Point3 com(0.1, 0.2, 1.0);
+  EXPECT(assert_equal(Point2(0.1, 0.2),
+                      ZeroMomentPoint(com, gtsam::Vector3::Zero())));
+  EXPECT(assert_equal(Point2(-0.9, 0.2),
+                      ZeroMomentPoint(com, gtsam::Vector3(9.81, 0, 0))));
+  THROWS_EXCEPTION(ZeroMomentPoint(com, gtsam::Vector3(0, 0, -9.81)));
+}
+
+// Batch centers of mass and margins agree with those of single postures.
+TEST(StaticStability, batch) {
+  const Robot robot = simple_rr::getRobot();
+  const size_t n = robot.topology().joints.size();
+  gtsam::Matrix q(5, n);
+  for (Eigen::Index k = 0; k < q.rows(); k++) {
+    for (size_t j = 0; j < n; j++) q(k, j) = std::sin(0.7 * k + 1.3 * j);
+  }
+  const auto base = robot.links().front();
+  const BatchLinkPoses poses =
+      BatchForwardKinematics(robot, base->name()).compute(q);
+
+  const PointOnLinks contacts{{base, Point3(0.5, 0.5, 0)},
+                              {base, Point3(-0.5, 0.5, 0)},
+                              {base, Point3(0, -0.5, 0.5)}};
+  const gtsam::Matrix com = BatchCenterOfMass(robot, poses);
+  const gtsam::Vector margins =
+      BatchStaticStabilityMargins(robot, poses, contacts);
+  for (Eigen::Index k = 0; k < q.rows(); k++) {
+    gtsam::Values values;
+    for (auto&& link : robot.links()) {
+      InsertPose(&values, link->id(), poses.pose(link->id(), k));
+    }
+    EXPECT(assert_equal(CenterOfMass(robot, values), Point3(com.col(k)),
+                        1e-9));
+    EXPECT_DOUBLES_EQUAL(StaticStabilityMargin(robot, values, contacts),
+                         margins(k), 1e-9);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -97,6 +97,44 @@ TEST(Statics, OneMovingLink) {
   EXPECT_DOUBLES_EQUAL(expected_tau, Torque(result, joint->id(), k), 1e-5);
 }
 
+// Batch statics for the base+link example, at many joint angles.
+TEST(Statics, SolveBatch) {
+  constexpr double g = 10, L = 2;
+  const auto I3 = Matrix3::Identity();
+  auto base =
+      std::make_shared<Link>(0, "base", 1e10, I3, Pose3(), Pose3(), true);
+  const Pose3 bMcom(Rot3(), Point3(L / 2, 0, 0));
+  auto link = std::make_shared<Link>(1, "link", 1.0, I3, bMcom, Pose3());
+  auto joint = std::make_shared<RevoluteJoint>(22, "joint1", Pose3(), base,
+                                               link, Vector3(0, 0, 1));
+  const Robot robot({{"base", base}, {"link", link}}, {{"joint1", joint}});
+  base->addJoint(joint);
+  link->addJoint(joint);
+
+  Statics statics(StaticsParameters(kSigmaDynamics, Vector3(0, -g, 0)));
+  const size_t k = 7;
+  const Slice slice(k);
+  std::vector<Values> configurations;
+  for (double theta : {0.0, 0.5, M_PI / 3, 2.0}) {
+    Values values;
+    InsertJointAngle(&values, joint->id(), k, theta);
+    configurations.push_back(robot.forwardKinematics(values, k));
+  }
+
+  const auto results = statics.solveBatch(slice, robot, configurations);
+  EXPECT_LONGS_EQUAL(configurations.size(), results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    const double theta = JointAngle(configurations[i], joint->id(), k);
+    // Gravity torque of the link, m g L/2 cos(theta).
+    EXPECT_DOUBLES_EQUAL(g * L / 2 * std::cos(theta),
+                         Torque(results[i], joint->id(), k), 1e-6);
+    const auto expected = statics.solve(slice, robot, configurations[i]);
+    EXPECT_LONGS_EQUAL(expected.size(), results[i].size());
+    EXPECT(assert_equal(Wrench(expected, link->id(), joint->id(), k),
+                        Wrench(results[i], link->id(), joint->id(), k), 1e-5));
+  }
+}
+
 // Do test with Quadruped and desired contact goals.
 TEST(Statics, Quadruped) {
   // Load robot and establish contact/goal pairs
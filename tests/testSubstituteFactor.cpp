@@ -90,6 +90,30 @@ TEST(SubstituteFactor, pose) {
   // Check jacobian computation is correct.
   EXPECT_CORRECT_FACTOR_JACOBIANS(subs_factor1, values, 1e-7, 1e-5);
   EXPECT_CORRECT_FACTOR_JACOBIANS(subs_factor2, values, 1e-7, 1e-5);
+
+  // Stack cost factors on the manifold, and substitute them at once.
+  auto cost_factor3 = std::make_shared<BetweenFactor<Point3>>(
+      x1_key, x2_key, Point3(0, 1, 0), noiseModel::Isotropic::Sigma(3, 0.5));
+  auto stacked_factor = std::make_shared<StackedFactor>(
+      std::vector<NoiseModelFactor::shared_ptr>{cost_factor2, cost_factor3});
+  EXPECT_LONGS_EQUAL(6, stacked_factor->dim());
+  EXPECT(KeyVector({x1_key, x3_key, x2_key}) == stacked_factor->keys());
+  SubstituteFactor subs_stacked(stacked_factor, replacement_map);
+  EXPECT_DOUBLES_EQUAL(subs_factor2.error(values) +
+                           SubstituteFactor(cost_factor3, replacement_map)
+                               .error(values),
+                       subs_stacked.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(subs_stacked, values, 1e-7, 1e-5);
+
+  // Robust factors cannot be stacked.
+  auto robust_factor = std::make_shared<BetweenFactor<Point3>>(
+      x1_key, x3_key, Point3(1, 0, 0),
+      noiseModel::Robust::Create(noiseModel::mEstimator::Huber::Create(1.0),
+                                 noise));
+  EXPECT(!StackedFactor::IsStackable(robust_factor));
+  std::vector<NoiseModelFactor::shared_ptr> robust_factors{cost_factor2,
+                                                           robust_factor};
+  THROWS_EXCEPTION(std::make_shared<StackedFactor>(robust_factors));
 }
 
 TEST(SubstituteFactor, fully_constrained_manifold) {
@@ -0,0 +1,194 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTelemetryRing.cpp
+ * @brief Test the shared-memory ring of optimizer iterations.
+ * @author Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MutableLMOptimizer.h>
+#include <gtdynamics/optimizer/TelemetryRing.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace {
+IterationReport Report(size_t iteration, const Values *values = nullptr) {
+  return {iteration, 0.1 * iteration, 10.0 - iteration, 0.0, values};
+}
+}  // namespace
+
+// Readers see the samples in order, and count the overwritten ones.
+TEST(TelemetryRing, metrics) {
+  TelemetryParameters params;
+  params.capacity = 4;
+  TelemetryPublisher publisher("gtd_test_metrics", params);
+  TelemetryReader reader("gtd_test_metrics");
+  EXPECT_LONGS_EQUAL(4, reader.capacity());
+  EXPECT(reader.keys().empty());
+  EXPECT(reader.poll().empty());
+
+  publisher.publish(Report(1));
+  publisher.publish(Report(2));
+  std::vector<TelemetrySample> samples = reader.poll();
+  EXPECT_LONGS_EQUAL(2, samples.size());
+  EXPECT_LONGS_EQUAL(1, samples[1].index);
+  EXPECT_LONGS_EQUAL(2, samples[1].iteration);
+  EXPECT_DOUBLES_EQUAL(0.2, samples[1].seconds, 1e-12);
+  EXPECT_DOUBLES_EQUAL(8.0, samples[1].cost, 1e-12);
+  EXPECT_LONGS_EQUAL(0, samples[1].values.size());
+
+  // A slow reader loses the oldest samples, not the newest.
+  for (size_t i = 3; i <= 9; i++) publisher.publish(Report(i));
+  samples = reader.poll();
+  EXPECT_LONGS_EQUAL(4, samples.size());
+  EXPECT_LONGS_EQUAL(6, samples.front().iteration);
+  EXPECT_LONGS_EQUAL(9, samples.back().iteration);
+  EXPECT_LONGS_EQUAL(3, reader.numDropped());
+  EXPECT_LONGS_EQUAL(9, publisher.numPublished());
+
+  THROWS_EXCEPTION(TelemetryReader("gtd_test_no_such_ring"));
+}
+
+// A ring in use is not replaced; one whose publisher is gone is.
+TEST(TelemetryRing, stale) {
+  TelemetryParameters params;
+  params.unlink = false;
+  {
+    TelemetryPublisher publisher("gtd_test_stale", params);
+    THROWS_EXCEPTION(TelemetryPublisher("gtd_test_stale", params));
+    publisher.publish(Report(1));
+  }
+  TelemetryReader old_reader("gtd_test_stale");
+  EXPECT_LONGS_EQUAL(1, old_reader.poll().size());
+
+  params.unlink = true;
+  params.capacity = 8;
+  TelemetryPublisher publisher("gtd_test_stale", params);
+  TelemetryReader reader("gtd_test_stale");
+  EXPECT_LONGS_EQUAL(8, reader.capacity());
+  EXPECT(reader.poll().empty());
+}
+
+#ifndef _WIN32
+// Segments that are too short for their slots, or are not rings, are
+// rejected rather than mapped past their end.
+TEST(TelemetryRing, malformed) {
+  TelemetryParameters params;
+  params.unlink = false;
+  { TelemetryPublisher publisher("gtd_test_malformed", params); }
+
+  // A ring truncated before its first slot, with an intact header.
+  int fd = ::shm_open("/gtd_test_malformed", O_RDWR, 0);
+  CHECK(fd >= 0);
+  EXPECT(::ftruncate(fd, 60) == 0);
+  ::close(fd);
+  THROWS_EXCEPTION(TelemetryReader("gtd_test_malformed"));
+
+  // A segment of garbage.
+  fd = ::shm_open("/gtd_test_malformed", O_RDWR | O_TRUNC, 0);
+  CHECK(fd >= 0);
+  const std::vector<char> garbage(4096, '\xff');
+  EXPECT(::write(fd, garbage.data(), garbage.size()) ==
+         static_cast<ssize_t>(garbage.size()));
+  ::close(fd);
+  THROWS_EXCEPTION(TelemetryReader("gtd_test_malformed"));
+
+  // A segment that is too short for a header.
+  fd = ::shm_open("/gtd_test_malformed", O_RDWR | O_TRUNC, 0);
+  CHECK(fd >= 0);
+  EXPECT(::write(fd, garbage.data(), 8) == 8);
+  ::close(fd);
+  THROWS_EXCEPTION(TelemetryReader("gtd_test_malformed"));
+  ::shm_unlink("/gtd_test_malformed");
+}
+#endif
+
+// Decimated values are rebuilt from the reference, and fed to a storage for
+// the factor graph visualization.
+TEST(TelemetryRing, values) {
+  Values reference;
+  reference.insert(0, Pose3());
+  reference.insert(1, 2.0);
+  reference.insert(2, Point3(1, 2, 3));
+
+  TelemetryParameters params;
+  params.value_decimation = 2;
+  params.keys = {0, 1};
+  TelemetryPublisher publisher("/gtd_test_values", params, reference);
+  TelemetryReader reader("/gtd_test_values");
+  EXPECT(reader.keys() == params.keys);
+
+  Values values;
+  values.insert(0, Pose3(Rot3::Rz(0.3), Point3(1, 0, 0)));
+  values.insert(1, 2.5);
+  for (size_t i = 0; i < 3; i++) publisher.publish(Report(i, &values));
+  const std::vector<TelemetrySample> samples = reader.poll();
+  EXPECT_LONGS_EQUAL(3, samples.size());
+  EXPECT_LONGS_EQUAL(6 + 1, samples[0].values.size());
+  EXPECT_LONGS_EQUAL(0, samples[1].values.size());
+  EXPECT(assert_equal(values, reader.values(samples[2], reference), 1e-9));
+  THROWS_EXCEPTION(reader.values(samples[1], reference));
+
+  StorageManager storage;
+  publisher.publish(Report(3, &values));
+  publisher.publish(Report(4, &values));
+  EXPECT_LONGS_EQUAL(1, reader.record(&storage, reference));
+  EXPECT_LONGS_EQUAL(1, storage.NumRecorded(1));
+}
+
+// The callback publishes every iteration of an optimizer.
+TEST(TelemetryRing, callback) {
+  NonlinearFactorGraph graph;
+  auto noise = noiseModel::Unit::Create(6);
+  graph.addPrior<Pose3>(0, Pose3(), noise);
+  Values initial;
+  initial.insert(0, Pose3());
+  for (Key k = 1; k < 5; k++) {
+    graph.emplace_shared<BetweenFactor<Pose3>>(
+        k - 1, k, Pose3(Rot3::Rz(0.5), Point3(1, 0, 0)), noise);
+    initial.insert(k, Pose3(Rot3::Rx(1.0 * k), Point3(0, k, 0)));
+  }
+
+  TelemetryParameters params;
+  params.value_decimation = 1;
+  TelemetryPublisher publisher("gtd_test_callback", params, initial);
+  TelemetryReader reader("gtd_test_callback");
+  size_t num_calls = 0;
+  MutableLMParams lm_params;
+  lm_params.anytime.callback =
+      publisher.callback([&](const IterationReport &) {
+        num_calls++;
+        return true;
+      });
+  MutableLMOptimizer optimizer(graph, initial, lm_params);
+  const Values result = optimizer.optimize();
+
+  const std::vector<TelemetrySample> samples = reader.poll();
+  EXPECT_LONGS_EQUAL(num_calls, samples.size());
+  EXPECT_LONGS_EQUAL(optimizer.iterations(), samples.size());
+  EXPECT_DOUBLES_EQUAL(graph.error(result), samples.back().cost, 1e-9);
+  EXPECT(assert_equal(result, reader.values(samples.back(), initial), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
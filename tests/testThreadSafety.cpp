@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testThreadSafety.cpp
+ * @brief Test concurrent use of one const Robot and DynamicsGraph.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+const size_t kNumThreads = 8, kRepetitions = 20;
+
+// Joint angles and velocities of time step t, and torques or accelerations.
+Values Known(const Robot &robot, int t, bool torques) {
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, 0.1 * (j % 3));
+    InsertJointVel(&values, j, t, 0.2);
+  }
+  Values known = robot.forwardKinematics(values, t, std::string("trunk"));
+  for (auto &&joint : robot.joints()) {
+    if (torques) {
+      InsertTorque(&known, joint->id(), t, 1.0);
+    } else {
+      InsertJointAccel(&known, joint->id(), t, 0.5);
+    }
+  }
+  if (!torques) {
+    InsertTwistAccel(&known, robot.link("trunk")->id(), t, gtsam::Z_6x1);
+  }
+  return known;
+}
+
+// What each thread computes with the shared robot and graph builder.
+struct Result {
+  NonlinearFactorGraph graph;
+  Values fk, fd, id;
+};
+
+Result Compute(const Robot &robot, const DynamicsGraph &graph_builder,
+               int t) {
+  Result result;
+  result.graph = graph_builder.dynamicsFactorGraph(robot, t);
+  result.fk = Known(robot, t, true);
+  result.fd = graph_builder.linearSolveFD(robot, t, result.fk);
+  result.id = graph_builder.linearSolveID(robot, t, Known(robot, t, false));
+  return result;
+}
+}  // namespace
+
+// Threads building graphs and solving dynamics with one robot and one graph
+// builder, whose ordering cache they share, get the same results as serially.
+TEST(ThreadSafety, robotAndDynamicsGraph) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+
+  std::vector<Result> expected;
+  for (size_t i = 0; i < kNumThreads; i++) {
+    expected.push_back(Compute(robot, DynamicsGraph(gtsam::Vector3(0, 0, -9.8)),
+                               static_cast<int>(i)));
+  }
+
+  std::vector<std::vector<Result>> actual(kNumThreads);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      for (size_t r = 0; r < kRepetitions; r++) {
+        actual[i].push_back(
+            Compute(robot, graph_builder, static_cast<int>(i)));
+      }
+    });
+  }
+  for (auto &&thread : threads) thread.join();
+
+  for (size_t i = 0; i < kNumThreads; i++) {
+    for (const Result &result : actual[i]) {
+      EXPECT_LONGS_EQUAL(expected[i].graph.size(), result.graph.size());
+      EXPECT(assert_equal(expected[i].graph, result.graph));
+      EXPECT(assert_equal(expected[i].fk, result.fk));
+      EXPECT(assert_equal(expected[i].fd, result.fd));
+      EXPECT(assert_equal(expected[i].id, result.id));
+    }
+  }
+}
+
+// A copy of a graph builder keeps the orderings cached so far.
+TEST(ThreadSafety, copyOrderingCache) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const Values known = Known(robot, 0, true);
+  const Values expected = graph_builder.linearSolveFD(robot, 0, known);
+  const DynamicsGraph copy = graph_builder;
+  EXPECT(assert_equal(expected, copy.linearSolveFD(robot, 0, known)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrace.cpp
+ * @brief Test recording of trace events.
+ * @author Varun Agrawal
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/Trace.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace gtdynamics;
+
+TEST(Trace, record) {
+  TraceRecorder &recorder = TraceRecorder::Instance();
+  { ScopedTrace ignored("ignored"); }
+  EXPECT_LONGS_EQUAL(0, recorder.events().size());
+
+  recorder.start();
+  {
+    ScopedTrace outer("outer", "test");
+    { ScopedTrace inner("inner", "test"); }
+    std::thread worker([] { ScopedTrace event("worker", "test"); });
+    worker.join();
+  }
+  recorder.stop();
+  { ScopedTrace ignored("ignored"); }
+
+  // Events are recorded when they end, inner ones first.
+  const auto events = recorder.events();
+  EXPECT_LONGS_EQUAL(3, events.size());
+  EXPECT(std::string(events[0].name) == "inner");
+  EXPECT(std::string(events[1].name) == "worker");
+  EXPECT(std::string(events[2].name) == "outer");
+  EXPECT_LONGS_EQUAL(0, events[0].thread);
+  EXPECT_LONGS_EQUAL(1, events[1].thread);
+  EXPECT(events[2].duration_us >= events[0].duration_us);
+  EXPECT(events[2].begin_us <= events[0].begin_us);
+
+  std::stringstream json;
+  recorder.writeJson(json);
+  EXPECT(json.str().find("\"traceEvents\"") != std::string::npos);
+  EXPECT(json.str().find("\"name\": \"outer\", \"cat\": \"test\"") !=
+         std::string::npos);
+
+  // Starting again clears the events.
+  recorder.start();
+  recorder.stop();
+  EXPECT_LONGS_EQUAL(0, recorder.events().size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
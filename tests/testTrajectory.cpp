@@ -106,6 +106,14 @@ TEST(Trajectory, error) {
   // steps = 2+3 per walk cycle, 5 legs involved
   const size_t expected = repeat * ((2 + 3) * 5);
   EXPECT_LONGS_EQUAL(expected, contact_link_objectives.size());
+
+  // With one path factor per foot and phase, the errors are the same.
+  auto path_objectives = trajectory.contactPointObjectives(
+      robot, noiseModel::Isotropic::Sigma(3, 1e-7), step, 0, true);
+  EXPECT_LONGS_EQUAL(repeat * 2 * 5, path_objectives.size());
+  EXPECT_DOUBLES_EQUAL(contact_link_objectives.error(init_vals),
+                       path_objectives.error(init_vals),
+                       1e-9 * contact_link_objectives.error(init_vals));
   // // regression
   // auto last_factor = std::dynamic_pointer_cast<PointGoalFactor>(
   //     contact_link_objectives.back());
@@ -121,6 +129,199 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(260, boundary_conditions.size());
 }
 
+// The graph built in parallel has the factors of a serial build, in order.
+TEST(Trajectory, multiPhaseFactorGraphOrder) {
+  using namespace walk_cycle_example;
+  Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  Trajectory trajectory(walk_cycle, 2);
+
+  // Phase data is computed once.
+  EXPECT(&trajectory.phaseContactPoints() == &trajectory.phaseContactPoints());
+  EXPECT(&trajectory.finalTimeSteps() == &trajectory.finalTimeSteps());
+
+  const double mu = 1.0;
+  auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), Vector3(0, 0, -9.8));
+  auto graph = trajectory.multiPhaseFactorGraph(robot, graph_builder,
+                                                CollocationScheme::Euler, mu);
+
+  // Serial reference.
+  const auto phase_cps = trajectory.phaseContactPoints();
+  const auto transition_graphs =
+      trajectory.getTransitionGraphs(robot, graph_builder, mu);
+  NonlinearFactorGraph expected =
+      graph_builder.dynamicsFactorGraph(robot, 0, phase_cps[0], mu);
+  int k = 0;
+  const int num_phases = trajectory.numPhases();
+  for (int p = 0; p < num_phases; p++) {
+    for (int step = 0; step < trajectory.phase(p).numTimeSteps(); step++) {
+      if (step == trajectory.phase(p).numTimeSteps() - 1 &&
+          p < num_phases - 1) {
+        expected.add(transition_graphs[p]);
+        k++;
+      } else {
+        expected.add(
+            graph_builder.dynamicsFactorGraph(robot, ++k, phase_cps[p], mu));
+      }
+    }
+  }
+  k = 0;
+  for (int p = 0; p < num_phases; p++) {
+    for (int step = 0; step < trajectory.phase(p).numTimeSteps(); step++) {
+      expected.add(graph_builder.multiPhaseCollocationFactors(
+          robot, k++, p, CollocationScheme::Euler));
+    }
+  }
+
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+  for (size_t i = 0; i < graph.size(); i++) {
+    EXPECT(expected.at(i)->keys() == graph.at(i)->keys());
+  }
+}
+
+// Instantiating the first walk cycle gives the graph of all the cycles.
+TEST(Trajectory, repeatedMultiPhaseFactorGraph) {
+  using namespace walk_cycle_example;
+  Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  Trajectory trajectory(walk_cycle, 3);
+
+  const double mu = 1.0;
+  auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), Vector3(0, 0, -9.8));
+  auto expected = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Trapezoidal, mu);
+  auto graph = trajectory.repeatedMultiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Trapezoidal, mu);
+
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+  for (size_t i = 0; i < graph.size(); i++) {
+    EXPECT(expected.at(i)->keys() == graph.at(i)->keys());
+  }
+
+  Initializer initializer;
+  Values values =
+      trajectory.multiPhaseInitialValues(robot, initializer, 1e-5, 1. / 240);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), graph.error(values),
+                       1e-9 * expected.error(values));
+}
+
+TEST(Trajectory, coarsened) {
+  using namespace walk_cycle_example;
+  Trajectory trajectory(walk_cycle, 2);
+
+  const Trajectory fine = trajectory.withPhaseDurations({4, 6, 4, 6});
+  EXPECT(vector<int>({4, 6, 4, 6}) == fine.phaseDurations());
+  EXPECT_LONGS_EQUAL(11, fine.getStartTimeStep(2));
+  EXPECT_LONGS_EQUAL(20, fine.getEndTimeStep(3));
+  EXPECT_LONGS_EQUAL(3, fine.transitionContactPoints().size());
+  THROWS_EXCEPTION(trajectory.withPhaseDurations({4, 6}));
+  THROWS_EXCEPTION(trajectory.withPhaseDurations({4, 0, 4, 6}));
+
+  // Phases keep at least one step.
+  EXPECT(vector<int>({2, 3, 2, 3}) == fine.coarsened(2).phaseDurations());
+  EXPECT(vector<int>({1, 2, 1, 2}) == trajectory.coarsened(2).phaseDurations());
+  EXPECT(vector<int>({1, 1, 1, 1}) == trajectory.coarsened(8).phaseDurations());
+}
+
+TEST(Trajectory, contactSwitchPatch) {
+  using namespace walk_cycle_example;
+  Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  Trajectory trajectory(walk_cycle, 2);
+
+  // Final time steps are 2, 5, 7 and 10.
+  const auto &phase_cps = trajectory.phaseContactPoints();
+  const auto &trans_cps = trajectory.transitionContactPoints();
+  EXPECT(&phase_cps[0] == &trajectory.stepContactPoints(0));
+  EXPECT(&phase_cps[0] == &trajectory.stepContactPoints(1));
+  EXPECT(&trans_cps[0] == &trajectory.stepContactPoints(2));
+  EXPECT(&phase_cps[1] == &trajectory.stepContactPoints(3));
+  EXPECT(&trans_cps[1] == &trajectory.stepContactPoints(5));
+  EXPECT(&phase_cps[3] == &trajectory.stepContactPoints(10));
+  THROWS_EXCEPTION(trajectory.stepContactPoints(11));
+
+  const double mu = 1.0;
+  auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), Vector3(0, 0, -9.8));
+  auto graph = trajectory.multiPhaseFactorGraph(robot, graph_builder,
+                                                CollocationScheme::Euler, mu);
+  auto spec = [&](size_t p) {
+    return *std::dynamic_pointer_cast<const FootContactConstraintSpec>(
+        trajectory.phase(p).constraintSpec());
+  };
+
+  // The stance of phase 1 on its own steps changes nothing.
+  EXPECT(trajectory
+             .contactSwitchPatch(graph, robot, graph_builder, 3, 4, spec(1), mu)
+             .empty());
+
+  // The stance of phase 0 replaces the contact factors of the switched feet.
+  GraphPatch patch =
+      trajectory.contactSwitchPatch(graph, robot, graph_builder, 3, 4, spec(0),
+                                    mu);
+  EXPECT(!patch.remove.empty());
+  EXPECT(!patch.add.empty());
+  for (size_t i : patch.remove) EXPECT(graph.at(i) != nullptr);
+}
+
+TEST(Trajectory, periodicBoundaryConditions) {
+  using namespace walk_cycle_example;
+  Trajectory trajectory(walk_cycle, 1);
+  const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+  EXPECT_LONGS_EQUAL(5, K);
+
+  NonlinearFactorGraph graph;
+  trajectory.addPeriodicBoundaryConditions(&graph, robot, kModel6, kModel6,
+                                           kModel6, kModel1, kModel1,
+                                           kModel1);
+  EXPECT_LONGS_EQUAL(3 * (robot.numLinks() + robot.numJoints()),
+                     graph.size());
+
+  // A motion that repeats, one stride further, satisfies the conditions.
+  const Pose3 stride(Rot3::Yaw(0.1), Point3(0, 0.4, 0));
+  Values values;
+  values.insert(StrideKey(), stride);
+  values.insert(PhaseKey(0), 1. / 240);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    InsertPose(&values, i, 0, link->bMcom());
+    InsertPose(&values, i, K, stride * link->bMcom());
+    for (int k : {0, K}) {
+      InsertTwist(&values, i, k, Vector6::Constant(0.1));
+      InsertTwistAccel(&values, i, k, Vector6::Constant(0.2));
+    }
+  }
+  for (auto &&joint : robot.joints()) {
+    for (int k : {0, K}) {
+      InsertJointAngle(&values, joint->id(), k, 0.3);
+      InsertJointVel(&values, joint->id(), k, 0.4);
+      InsertJointAccel(&values, joint->id(), k, 0.5);
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(0.0, graph.error(values), 1e-9);
+
+  Values moved = values;
+  const int id = robot.links()[0]->id();
+  moved.update(PoseKey(id, K), Pose(values, id, K).retract(Vector6::Ones()));
+  EXPECT(graph.error(moved) > 0.1);
+
+  // Unrolled over three cycles, the poses move by one stride per cycle.
+  const Values unrolled = trajectory.periodicValues(values, 3);
+  EXPECT(!unrolled.exists(StrideKey()));
+  EXPECT(unrolled.exists(PhaseKey(2)));
+  const Pose3 bMcom = robot.links()[0]->bMcom();
+  EXPECT(assert_equal(stride * stride * bMcom,
+                      Pose(unrolled, id, 2 * K), 1e-9));
+  EXPECT(assert_equal(stride * stride * stride * bMcom,
+                      Pose(unrolled, id, 3 * K), 1e-9));
+  EXPECT_DOUBLES_EQUAL(0.4, JointVel(unrolled, robot.joints()[0]->id(), 3 * K),
+                       1e-12);
+  EXPECT_LONGS_EQUAL(3 + 12 * (robot.numLinks() + robot.numJoints()),
+                     unrolled.size());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
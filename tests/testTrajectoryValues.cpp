@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryValues.cpp
+ * @brief Test dense storage of trajectory states.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectoryValues.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+/// Conversion from and to Values, and the accessors of values.h.
+TEST(TrajectoryValues, Values) {
+  const Robot robot = simple_rr::getRobot();
+  const size_t num_steps = 3;
+
+  gtsam::Values values;
+  for (size_t t = 0; t < num_steps; t++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, 0.1 * j + t);
+      InsertJointVel(&values, j, t, 0.2 * j + t);
+      InsertJointAccel(&values, j, t, 0.3 * j + t);
+      InsertTorque(&values, j, t, 0.4 * j + t);
+    }
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      InsertPose(&values, i, t,
+                 Pose3(Rot3::Rz(0.1 * t), gtsam::Point3(i, 0, t)));
+      InsertTwist(&values, i, t, Vector6::Constant(i + t));
+      InsertTwistAccel(&values, i, t, Vector6::Constant(i - 0.5 * t));
+    }
+  }
+  // Other variables and time steps are not stored.
+  values.insert(PhaseKey(0), 0.1);
+  InsertJointAngle(&values, 0, num_steps, 1.0);
+
+  const auto trajectory =
+      TrajectoryValues::FromValues(robot, values, num_steps);
+  EXPECT_LONGS_EQUAL(num_steps, trajectory.numSteps());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), trajectory.numJoints());
+  EXPECT_LONGS_EQUAL(robot.numLinks(), trajectory.numLinks());
+
+  for (size_t t = 0; t < num_steps; t++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      EXPECT_DOUBLES_EQUAL(JointAngle(values, j, t),
+                           JointAngle(trajectory, j, t), 1e-12);
+      EXPECT_DOUBLES_EQUAL(JointVel(values, j, t), JointVel(trajectory, j, t),
+                           1e-12);
+      EXPECT_DOUBLES_EQUAL(JointAccel(values, j, t),
+                           JointAccel(trajectory, j, t), 1e-12);
+      EXPECT_DOUBLES_EQUAL(Torque(values, j, t), Torque(trajectory, j, t),
+                           1e-12);
+      EXPECT_DOUBLES_EQUAL(JointAngle(values, j, t),
+                           trajectory.jointAngles()(t, j), 1e-12);
+    }
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      EXPECT(assert_equal(Pose(values, i, t), Pose(trajectory, i, t)));
+      EXPECT(assert_equal(Twist(values, i, t), Twist(trajectory, i, t)));
+      EXPECT(assert_equal(TwistAccel(values, i, t),
+                          TwistAccel(trajectory, i, t)));
+    }
+  }
+
+  // Back to Values, without the variables that are not stored.
+  gtsam::Values expected = values;
+  expected.erase(PhaseKey(0));
+  expected.erase(JointAngleKey(0, num_steps));
+  EXPECT(assert_equal(expected, trajectory.toValues()));
+}
+
+/// Writing through the accessors.
+TEST(TrajectoryValues, Insert) {
+  TrajectoryValues trajectory(2, 3, 1);
+  InsertJointAngle(&trajectory, 2, 1, 0.5);
+  InsertTorque(&trajectory, 0, 0, -1.0);
+  InsertPose(&trajectory, 0, 1, Pose3(Rot3(), gtsam::Point3(1, 2, 3)));
+
+  EXPECT_DOUBLES_EQUAL(0.5, trajectory.jointAngles()(1, 2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(-1.0, Torque(trajectory, 0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.0, JointVel(trajectory, 2, 1), 1e-12);
+  EXPECT(assert_equal(Pose3(), Pose(trajectory, 0, 0)));
+  EXPECT(assert_equal(gtsam::Point3(1, 2, 3),
+                      Pose(trajectory, 0, 1).translation()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
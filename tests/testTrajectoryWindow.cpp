@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryWindow.cpp
+ * @brief Test incremental construction of trajectory factor graphs.
+ * @author Yetong Zhang, Frank Dellaert
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/TrajectoryWindow.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::FactorIndices;
+using gtsam::NonlinearFactorGraph;
+
+// Return whether two graphs have the same factors, key for key.
+bool SameKeys(const NonlinearFactorGraph& expected,
+              const NonlinearFactorGraph& actual) {
+  if (expected.size() != actual.size()) return false;
+  for (size_t i = 0; i < expected.size(); i++) {
+    if (expected.at(i)->keys() != actual.at(i)->keys()) return false;
+  }
+  return true;
+}
+
+TEST(TrajectoryWindow, shift) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 3;
+  const double dt = 0.1;
+
+  TrajectoryWindow window(robot, graph_builder, dt);
+  const NonlinearFactorGraph initial = window.initialize(num_steps);
+  EXPECT(SameKeys(graph_builder.trajectoryFG(robot, num_steps, dt), initial));
+  EXPECT_LONGS_EQUAL(0, window.firstStep());
+  EXPECT_LONGS_EQUAL(num_steps, window.lastStep());
+
+  // Slide by one step: the factors of step 0 are removed.
+  const FactorIndices step0 = window.stepFactors(0);
+  FactorIndices removed;
+  const NonlinearFactorGraph new_factors = window.shift(&removed);
+  EXPECT(removed == step0);
+  EXPECT_LONGS_EQUAL(1, window.firstStep());
+  EXPECT_LONGS_EQUAL(num_steps + 1, window.lastStep());
+  for (size_t index : removed) {
+    EXPECT(!window.graph().at(index));
+  }
+
+  // New factors are numbered after the initial ones, and touch the last two
+  // time steps only.
+  EXPECT_LONGS_EQUAL(initial.size() + new_factors.size(),
+                     window.graph().size());
+  for (auto&& factor : new_factors) {
+    for (auto&& key : factor->keys()) {
+      EXPECT(DynamicsSymbol(key).time() >= num_steps);
+    }
+  }
+
+  // The window now matches a freshly built window starting at step 1.
+  TrajectoryWindow fresh(robot, graph_builder, dt);
+  fresh.initialize(num_steps, 1);
+  EXPECT(SameKeys(fresh.windowGraph(), window.windowGraph()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
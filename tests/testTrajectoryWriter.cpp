@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryWriter.cpp
+ * @brief Test streaming trajectory output.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Phase.h>
+#include <gtdynamics/utils/TrajectoryWriter.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+const size_t num_steps = 3;
+const double dt = 0.1;
+
+// Joint values of all time steps of the simple RR robot.
+gtsam::Values values(const Robot &robot) {
+  gtsam::Values values;
+  for (size_t k = 0; k < num_steps; k++) {
+    for (auto &&joint : robot.joints()) {
+      const double x = joint->id() + 0.25 * k;
+      InsertJointAngle(&values, joint->id(), k, x);
+      InsertJointVel(&values, joint->id(), k, 2 * x);
+      InsertJointAccel(&values, joint->id(), k, 3 * x);
+      InsertTorque(&values, joint->id(), k, -x);
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+/// The CSV rows are the rows of the joint matrix of a phase.
+TEST(TrajectoryWriter, CSV) {
+  const Robot robot = simple_rr::getRobot();
+  const auto values = example::values(robot);
+  const Phase phase(0, example::num_steps, nullptr);
+  const gtsam::Matrix expected =
+      phase.jointMatrix(robot, values, 0, example::dt);
+
+  std::stringstream ss;
+  TrajectoryWriter writer(robot, ss);
+  for (size_t k = 0; k < example::num_steps; k++) {
+    writer.writeStep(values, k, example::dt);
+  }
+
+  const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
+                                         Eigen::DontAlignCols, ", ", "\n");
+  std::stringstream expected_ss;
+  expected_ss << expected.format(CSVFormat) << "\n";
+  EXPECT(expected_ss.str() == ss.str());
+
+  std::stringstream header;
+  TrajectoryWriter(robot, header).writeHeader();
+  EXPECT(std::string("joint_1,joint_2,joint_1,joint_2,joint_1,joint_2,"
+                     "joint_1,joint_2,t\n") == header.str());
+}
+
+/// The binary format is read back exactly.
+TEST(TrajectoryWriter, Binary) {
+  const Robot robot = simple_rr::getRobot();
+  const auto values = example::values(robot);
+  const Phase phase(0, example::num_steps, nullptr);
+
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  TrajectoryWriter writer(robot, ss, TrajectoryWriter::BINARY);
+  writer.writeHeader();
+  for (size_t k = 0; k < example::num_steps; k++) {
+    writer.writeStep(values, k, example::dt);
+  }
+
+  std::vector<std::string> columns;
+  const gtsam::Matrix actual = TrajectoryWriter::ReadBinary(ss, &columns);
+  EXPECT(writer.columns() == columns);
+  EXPECT(assert_equal(phase.jointMatrix(robot, values, 0, example::dt),
+                      actual));
+
+  std::stringstream text("not a trajectory");
+  THROWS_EXCEPTION(TrajectoryWriter::ReadBinary(text));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
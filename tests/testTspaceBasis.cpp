@@ -121,6 +121,73 @@ TEST(TspaceBasis, connected_poses) {
   }
 }
 
+/** The sparse basis of a longer chain has orthonormal columns in the kernel. */
+TEST(SparseMatrixBasis, chain) {
+  const size_t num_poses = 20;
+  gtdynamics::EqualityConstraints constraints;
+  auto noise = noiseModel::Unit::Create(6);
+  Values values;
+  for (size_t k = 0; k < num_poses; k++) {
+    values.insert(k, Pose3(Rot3::Rz(0.1 * k), Point3(k, 0, 0.2 * k)));
+    if (k > 0) {
+      auto factor = std::make_shared<BetweenFactor<Pose3>>(
+          k - 1, k, Pose3(Rot3::Rz(0.1), Point3(1, 0, 0.2)), noise);
+      constraints.emplace_shared<gtdynamics::FactorZeroErrorConstraint>(
+          factor);
+    }
+  }
+  auto component = std::make_shared<ConnectedComponent>(constraints);
+  auto basis_params = std::make_shared<TspaceBasisParams>();
+  SparseMatrixBasis basis(basis_params, component, values);
+  EXPECT_LONGS_EQUAL(6, basis.dim());
+
+  const Matrix B = basis.matrix();
+  EXPECT(assert_equal(Matrix(I_6x6), Matrix(B.transpose() * B), 1e-9));
+  auto linear_graph = component->merit_graph_.linearize(values);
+  for (int i = 0; i < 6; i++) {
+    Vector xi = Vector::Zero(6);
+    xi(i) = 1;
+    EXPECT_DOUBLES_EQUAL(
+        0.0, linear_graph->error(basis.computeTangentVector(xi)), 1e-9);
+  }
+}
+
+/** Reusing the elimination structure gives the same basis at new values. */
+TEST(FixedVarBasis, reuse_elimination_structure) {
+  gtdynamics::EqualityConstraints constraints;
+  auto noise = noiseModel::Unit::Create(6);
+  Values values, new_values;
+  for (size_t k = 0; k < 4; k++) {
+    values.insert(k, Pose3(Rot3::Rz(0.1 * k), Point3(k, 0, 0)));
+    new_values.insert(k, Pose3(Rot3::Ry(0.2 * k), Point3(k, 1, 0.5 * k)));
+    if (k > 0) {
+      auto factor = std::make_shared<BetweenFactor<Pose3>>(
+          k - 1, k, Pose3(Rot3::Rz(0.1), Point3(1, 0, 0)), noise);
+      constraints.emplace_shared<gtdynamics::FactorZeroErrorConstraint>(
+          factor);
+    }
+  }
+  auto component = std::make_shared<ConnectedComponent>(constraints);
+  KeyVector basis_keys{3};
+
+  auto fresh_params = std::make_shared<TspaceBasisParams>();
+  fresh_params->reuse_elimination_structure = false;
+  auto reuse_params = std::make_shared<TspaceBasisParams>();
+  FixedVarBasis fresh(fresh_params, component, values, basis_keys);
+  FixedVarBasis reuse(reuse_params, component, values, basis_keys);
+
+  auto expected = fresh.createWithNewValues(component, new_values);
+  auto actual = reuse.createWithNewValues(component, new_values);
+  expected->construct(component, new_values);
+  actual->construct(component, new_values);
+  for (int i = 0; i < 6; i++) {
+    Vector xi = Vector::Zero(6);
+    xi(i) = 1;
+    EXPECT(assert_equal(expected->computeTangentVector(xi),
+                        actual->computeTangentVector(xi), 1e-9));
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
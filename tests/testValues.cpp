@@ -34,6 +34,70 @@ TEST(Values, at) {
   CHECK_EXCEPTION(TwistAccel(values, 7), KeyDoesNotExist);
 }
 
+// A time slice has the variables of its time steps only.
+TEST(Values, TimeSliceIndex) {
+  gtsam::Values values;
+  for (int t = 0; t < 10; t++) {
+    InsertJointAngle(&values, 1, t, 0.1 * t);
+    InsertJointVel(&values, 2, t, 0.2 * t);
+    InsertPose(&values, 3, t, gtsam::Pose3());
+  }
+  values.insert(TimeKey(4), 0.5);
+
+  const TimeSliceIndex index(values);
+  EXPECT_LONGS_EQUAL(values.size(), index.size());
+
+  const gtsam::Values slice = index.slice(values, 4, 6);
+  gtsam::Values expected;
+  for (int t = 4; t < 6; t++) {
+    InsertJointAngle(&expected, 1, t, 0.1 * t);
+    InsertJointVel(&expected, 2, t, 0.2 * t);
+    InsertPose(&expected, 3, t, gtsam::Pose3());
+  }
+  expected.insert(TimeKey(4), 0.5);
+  EXPECT(assert_equal(expected, slice));
+
+  EXPECT_LONGS_EQUAL(3, index.keys(9, 20).size());
+  EXPECT_LONGS_EQUAL(0, index.keys(10, 20).size());
+  EXPECT_LONGS_EQUAL(0, index.keys(5, 5).size());
+}
+
+// Bulk insertion matches inserting one key at a time.
+TEST(Values, BulkInsert) {
+  gtsam::Matrix q(3, 2);
+  q << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6;
+  const gtsam::Vector tau = (gtsam::Vector(2) << 1.0, 2.0).finished();
+  const std::vector<gtsam::Pose3> poses{gtsam::Pose3(),
+                                        gtsam::Pose3(gtsam::Rot3::Rz(0.3),
+                                                     gtsam::Point3(1, 2, 3))};
+  const std::vector<gtsam::Vector6> twists{gtsam::Vector6::Zero(),
+                                           gtsam::Vector6::Ones()};
+
+  gtsam::Values values;
+  InsertJointAngles(&values, q, 2);
+  InsertTorques(&values, 4, tau);
+  InsertPoses(&values, 1, poses);
+  InsertTwists(&values, 1, twists);
+
+  gtsam::Values expected;
+  for (int k = 0; k < 3; k++) {
+    for (int j = 0; j < 2; j++) InsertJointAngle(&expected, j, 2 + k, q(k, j));
+  }
+  for (int j = 0; j < 2; j++) InsertTorque(&expected, j, 4, tau(j));
+  for (int i = 0; i < 2; i++) {
+    InsertPose(&expected, i, 1, poses[i]);
+    InsertTwist(&expected, i, 1, twists[i]);
+  }
+  EXPECT(assert_equal(expected, values));
+
+  // Nothing is inserted if any key exists.
+  gtsam::Values partial;
+  InsertJointAngle(&partial, 1, 0, 0.0);
+  CHECK_EXCEPTION(InsertJointAngles(&partial, 0, tau),
+                  gtsam::ValuesKeyAlreadyExists);
+  EXPECT_LONGS_EQUAL(1, partial.size());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWarmStartInitializer.cpp
+ * @brief Test initialization from stored trajectory solutions.
+ * @author Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/WarmStartInitializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Values;
+using gtsam::Vector;
+
+TEST(TrajectorySolutionCache, nearest) {
+  TrajectorySolutionCache cache;
+  cache.insert("walk", (Vector(1) << 0.0).finished(), {2}, Values());
+  cache.insert("walk", (Vector(1) << 1.0).finished(), {3}, Values());
+  cache.insert("jump", (Vector(1) << 0.9).finished(), {4}, Values());
+  EXPECT_LONGS_EQUAL(3, cache.size());
+
+  auto entry = cache.nearest("walk", (Vector(1) << 0.8).finished());
+  CHECK(entry);
+  EXPECT(std::vector<int>{3} == entry->phase_steps);
+  EXPECT(!cache.nearest("run", (Vector(1) << 0.8).finished()));
+}
+
+TEST(TimeWarpTrajectory, phases) {
+  // Phases of 2 and 3 steps, with q = t.
+  Values solution;
+  for (int t = 0; t <= 5; t++) InsertJointAngle(&solution, 0, t, double(t));
+  solution.insert(PhaseKey(0), 0.1);
+  solution.insert(PhaseKey(1), 0.2);
+
+  const Values warped = TimeWarpTrajectory(solution, {2, 3}, {4, 3});
+  EXPECT_LONGS_EQUAL(8 + 2, warped.size());
+  const std::vector<double> expected{0, 1, 1, 2, 2, 3, 4, 5};
+  for (int t = 0; t <= 7; t++) {
+    EXPECT_DOUBLES_EQUAL(expected[t], JointAngle(warped, 0, t), 1e-9);
+  }
+  // Phase durations are kept.
+  EXPECT_DOUBLES_EQUAL(0.05, warped.at<double>(PhaseKey(0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.2, warped.at<double>(PhaseKey(1)), 1e-9);
+}
+
+TEST(InterpolateTrajectory, phases) {
+  // Phases of 2 and 3 steps, with q = t and poses translated by t.
+  Values solution;
+  for (int t = 0; t <= 5; t++) {
+    InsertJointAngle(&solution, 0, t, double(t));
+    InsertPose(&solution, 0, t,
+               gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(t, 0, 0)));
+  }
+  solution.insert(PhaseKey(0), 0.1);
+  solution.insert(PhaseKey(1), 0.2);
+
+  const Values upsampled = InterpolateTrajectory(solution, {2, 3}, {4, 3});
+  EXPECT_LONGS_EQUAL(2 * 8 + 2, upsampled.size());
+  const std::vector<double> expected{0, 0.5, 1, 1.5, 2, 3, 4, 5};
+  for (int t = 0; t <= 7; t++) {
+    EXPECT_DOUBLES_EQUAL(expected[t], JointAngle(upsampled, 0, t), 1e-9);
+    const gtsam::Pose3 pose(gtsam::Rot3(), gtsam::Point3(expected[t], 0, 0));
+    EXPECT(assert_equal(pose, Pose(upsampled, 0, t), 1e-9));
+  }
+  EXPECT_DOUBLES_EQUAL(0.05, upsampled.at<double>(PhaseKey(0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.2, upsampled.at<double>(PhaseKey(1)), 1e-9);
+
+  // Downsampling takes every other step.
+  const Values downsampled = InterpolateTrajectory(upsampled, {4, 3}, {2, 3});
+  EXPECT(assert_equal(solution, downsampled, 1e-9));
+}
+
+TEST(WarmStartInitializer, ZeroValues) {
+  auto robot = simple_rr::getRobot();
+  Initializer initializer;
+  Values solution = initializer.ZeroValuesTrajectory(robot, 2, 0);
+  for (int t = 0; t <= 2; t++) {
+    solution.update(JointAngleKey(0, t), 0.5);
+  }
+  TrajectorySolutionCache cache;
+  cache.insert("swing", (Vector(1) << 0.0).finished(), {2}, solution);
+
+  // The solution is warped to 4 steps.
+  WarmStartInitializer warm_start(cache, "swing",
+                                  (Vector(1) << 0.1).finished(), {4});
+  CHECK(warm_start.hasWarmStart());
+  const Values values = warm_start.ZeroValues(robot, 3);
+  EXPECT_LONGS_EQUAL(initializer.ZeroValues(robot, 3).size(), values.size());
+  EXPECT_DOUBLES_EQUAL(0.5, JointAngle(values, 0, 3), 1e-9);
+
+  // Without a stored solution, values are initialized as usual.
+  WarmStartInitializer cold_start(cache, "jump",
+                                  (Vector(1) << 0.1).finished(), {4});
+  EXPECT(!cold_start.hasWarmStart());
+  EXPECT(assert_equal(initializer.ZeroValues(robot, 3),
+                      cold_start.ZeroValues(robot, 3)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
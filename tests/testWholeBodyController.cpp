@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWholeBodyController.cpp
+ * @brief Test the whole-body inverse dynamics QP.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/SparseDynamics.h>
+#include <gtdynamics/dynamics/WholeBodyController.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+const Vector3 kGravity(0, 0, -9.8);
+
+// Without contacts or limits, joint acceleration tasks give inverse dynamics.
+TEST(WholeBodyController, InverseDynamics) {
+  const Robot robot = SerialChainRobot(3);
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known, j, 0, 0.3 * j - 0.4);
+    InsertJointVel(&known, j, 0, 0.5 - 0.2 * j);
+  }
+  known = robot.forwardKinematics(known, 0);
+
+  WholeBodyControllerParameters parameters;
+  parameters.torque_weight = 0;
+  parameters.max_iterations = 5000;
+  const WholeBodyController controller(robot, kGravity, parameters);
+  WholeBodyController tracking = controller;
+  Values accels = known;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    tracking.setJointAccelTask(j, 1.0 - j, 1.0);
+    InsertJointAccel(&accels, j, 0, 1.0 - j);
+  }
+  const Values result = tracking.compute(0, known);
+  EXPECT(tracking.converged());
+  const Values expected =
+      SparseDynamics(robot, kGravity).inverseDynamics(0, accels);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(1.0 - j, JointAccel(result, j, 0), 1e-3);
+    EXPECT_DOUBLES_EQUAL(Torque(expected, j, 0), Torque(result, j, 0), 1e-3);
+  }
+
+  // Hot-started at the same state, the solve converges right away.
+  const size_t cold = tracking.iterations();
+  tracking.compute(0, known);
+  EXPECT(tracking.converged());
+  EXPECT(tracking.iterations() < cold);
+
+  // A bounded solve stops early and reports it.
+  parameters.max_iterations = 1;
+  WholeBodyController bounded(robot, kGravity, parameters);
+  bounded.setJointAccelTask(1, 1.0, 1.0);
+  bounded.compute(0, known);
+  EXPECT_LONGS_EQUAL(1, bounded.iterations());
+  EXPECT(!bounded.converged());
+}
+
+// Torque limits bound the torques, at the expense of the task.
+TEST(WholeBodyController, TorqueLimits) {
+  SyntheticRobotParams params;
+  params.joint_params.torque_limit = 0.5;
+  const Robot robot = SerialChainRobot(2, params);
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), 0, M_PI_2);
+    InsertJointVel(&known, joint->id(), 0, 0.0);
+  }
+  known = robot.forwardKinematics(known, 0);
+
+  WholeBodyControllerParameters parameters;
+  parameters.max_iterations = 5000;
+  WholeBodyController controller(robot, kGravity, parameters);
+  for (auto&& joint : robot.joints()) {
+    controller.setJointAccelTask(joint->id(), 0.0, 1.0);
+  }
+  const Values result = controller.compute(0, known);
+  EXPECT(controller.converged());
+  for (auto&& joint : robot.joints()) {
+    EXPECT(std::abs(Torque(result, joint->id(), 0)) <= 0.5 + 1e-3);
+  }
+  // Holding the horizontal arm against gravity needs more than the limit.
+  EXPECT(std::abs(JointAccel(result, 1, 0)) > 1.0);
+}
+
+// A quadruped standing on its feet carries its weight within the cones.
+TEST(WholeBodyController, Contacts) {
+  const Robot robot = LeggedRobot(4, 3);
+  const auto base = robot.link("base");
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known, joint->id(), 0, 0.0);
+    InsertJointVel(&known, joint->id(), 0, 0.0);
+  }
+  InsertPose(&known, base->id(), 0,
+             gtsam::Pose3(gtsam::Rot3(), Point3(0, 0, 0.4)));
+  InsertTwist(&known, base->id(), 0, Vector6::Zero());
+  known = robot.forwardKinematics(known, 0, std::string("base"));
+
+  PointOnLinks feet;
+  for (int i = 1; i <= 4; i++) {
+    feet.emplace_back(robot.link("leg" + std::to_string(i) + "_link3"),
+                      Point3(0, 0, 0.1));
+  }
+  WholeBodyControllerParameters parameters;
+  parameters.mu = 0.5;
+  parameters.max_iterations = 5000;
+  WholeBodyController controller(robot, kGravity, parameters);
+  controller.setContactMode(feet);
+  controller.setLinkAccelTask(base, Vector6::Zero(), Vector6::Ones());
+  EXPECT_LONGS_EQUAL(13 * 6 + 12 * 14 + 4 * 6, controller.dim());
+  const Values result = controller.compute(0, known);
+  EXPECT(controller.converged());
+  EXPECT(assert_equal(Vector6::Zero(), TwistAccel(result, base->id(), 0),
+                      1e-3));
+
+  Vector3 total = Vector3::Zero();
+  for (auto&& foot : feet) {
+    const Vector6 wrench = result.at<Vector6>(ContactWrenchKey(foot.link->id(),
+                                                               0, 0));
+    const Vector3 force =
+        Pose(result, foot.link->id(), 0).rotation() * Vector3(wrench.tail<3>());
+    EXPECT(force.z() > 0);
+    EXPECT(force.head<2>().norm() <= 0.5 * force.z() + 1e-3);
+    total += force;
+  }
+  EXPECT(assert_equal(Vector3(0, 0, 17 * 9.8), total, 1e-2));
+
+  // The structure follows the contact mode.
+  controller.setContactMode({feet[0], feet[2]});
+  EXPECT_LONGS_EQUAL(13 * 6 + 12 * 14 + 2 * 6, controller.dim());
+  const Robot other = SerialChainRobot(20);
+  THROWS_EXCEPTION(controller.setContactMode(
+      {PointOnLink(other.link("link_20"), Point3())}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
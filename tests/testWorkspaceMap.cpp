@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWorkspaceMap.cpp
+ * @brief Test voxelized workspaces of end-effectors.
+ * @author Frank Dellaert, Yetong Zhang
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/WorkspaceMap.h>
+#include <gtdynamics/universal_robot/RobotGenerator.h>
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Vector3;
+
+TEST(WorkspaceMap, add) {
+  WorkspaceMap map(0.1);
+  map.add(Point3(0.05, 0.05, 0.05), Vector3(0, 0, 1), 0.5);
+  map.add(Point3(0.01, 0.02, 0.03), Vector3(0, 0, -1), 0.7);
+  map.add(Point3(-0.05, 0.05, 0.05), Vector3(1, 0, 0), 0.1);
+  EXPECT_LONGS_EQUAL(2, map.numVoxels());
+
+  const WorkspaceMap::Voxel* voxel = map.find(Point3(0.09, 0.0, 0.0));
+  CHECK(voxel);
+  EXPECT_LONGS_EQUAL(2, voxel->count);
+  EXPECT_DOUBLES_EQUAL(0.7, voxel->manipulability, 1e-6);
+  EXPECT_DOUBLES_EQUAL(2.0 / 32, voxel->reachability(), 1e-9);
+  EXPECT(!map.reachable(Point3(0.15, 0.0, 0.0)));
+  EXPECT_DOUBLES_EQUAL(0.0, map.manipulability(Point3(0.15, 0.0, 0.0)), 0);
+  EXPECT(gtsam::assert_equal(Point3(-0.05, 0.05, 0.05), map.center(0)));
+
+  // Merging counts the samples of both maps.
+  map.merge(map);
+  EXPECT_LONGS_EQUAL(4, map.find(Point3(0.09, 0.0, 0.0))->count);
+  THROWS_EXCEPTION(map.merge(WorkspaceMap(0.2)));
+}
+
+// The tip of a two-link arm reaches voxels on a surface within its length.
+TEST(WorkspaceMap, Generate) {
+  const Robot robot = SerialChainRobot(2);
+  const PointOnLink tip(robot.link("link_2"), Point3(0, 0, 0.1));
+  WorkspaceMapParameters parameters;
+  parameters.num_samples = 20000;
+  parameters.batch_size = 1000;
+  parameters.execution = ExecutionContext::Threads(1);
+  const WorkspaceMap map = WorkspaceMap::Generate(robot, tip, parameters);
+
+  EXPECT(map.numVoxels() > 10);
+  size_t count = 0;
+  const double half_diagonal = 0.5 * std::sqrt(3.0) * map.voxelSize();
+  for (size_t i = 0; i < map.numVoxels(); ++i) {
+    EXPECT(map.center(i).norm() < 0.4 + half_diagonal);
+    EXPECT(map.voxel(i).manipulability <= 0.4 * 0.2 + 1e-6);
+    count += map.voxel(i).count;
+  }
+  EXPECT_LONGS_EQUAL(20000, count);
+  // The tip at joint angles pi/4 and asin(-0.55) is reached.
+  EXPECT(map.manipulability(Point3(0.2595, 0.11, 0.2595)) > 0);
+  EXPECT(!map.reachable(Point3(1, 1, 1)));
+
+  // The map does not depend on the number of threads.
+  parameters.execution = ExecutionContext::Threads(4);
+  const WorkspaceMap parallel = WorkspaceMap::Generate(robot, tip, parameters);
+  EXPECT_LONGS_EQUAL(map.numVoxels(), parallel.numVoxels());
+  for (size_t i = 0; i < map.numVoxels(); ++i) {
+    EXPECT(gtsam::assert_equal(map.center(i), parallel.center(i)));
+    EXPECT_LONGS_EQUAL(map.voxel(i).count, parallel.voxel(i).count);
+    EXPECT_LONGS_EQUAL(map.voxel(i).directions, parallel.voxel(i).directions);
+  }
+
+  // Save and load.
+  const std::string path = "testWorkspaceMap.bin";
+  map.save(path);
+  const WorkspaceMap loaded = WorkspaceMap::Load(path);
+  std::remove(path.c_str());
+  EXPECT_DOUBLES_EQUAL(map.voxelSize(), loaded.voxelSize(), 0);
+  EXPECT_LONGS_EQUAL(map.numVoxels(), loaded.numVoxels());
+  for (size_t i = 0; i < map.numVoxels(); ++i) {
+    EXPECT(gtsam::assert_equal(map.center(i), loaded.center(i)));
+    EXPECT_DOUBLES_EQUAL(map.voxel(i).manipulability,
+                         loaded.voxel(i).manipulability, 0);
+  }
+  THROWS_EXCEPTION(WorkspaceMap::Load("no_such_map.bin"));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
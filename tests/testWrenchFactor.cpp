@@ -115,6 +115,33 @@ TEST(WrenchFactor, NonzeroTwistCase) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, x, diffDelta, tol);
 }
 
+// The closed-form factor has the same error as the expression factor, with
+// and without gravity.
+TEST(LinkWrenchFactor, SameError) {
+  int id = 0;
+  const std::vector<Key> wrench_keys{WrenchKey(id, 1), WrenchKey(id, 2),
+                                     WrenchKey(id, 3)};
+  Values x;
+  InsertTwist(&x, id, (Vector(6) << 0.1, -0.2, 1, 0.3, 1, -0.5).finished());
+  InsertTwistAccel(&x, id, (Vector(6) << 0.4, 0, 1, -1, 1, 2).finished());
+  InsertWrench(&x, id, 1, (Vector(6) << 0, 0, 4, -1, 2, 0).finished());
+  InsertWrench(&x, id, 2, (Vector(6) << 1, 0, -3, 0, -1, 0).finished());
+  InsertWrench(&x, id, 3, (Vector(6) << 0, 2, 0, 1, 0, 3).finished());
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0, 0)));
+
+  for (const std::optional<Vector3> &gravity :
+       {std::optional<Vector3>(), std::optional<Vector3>(example::gravity)}) {
+    auto expected = WrenchFactor(example::cost_model, example::link,
+                                 wrench_keys, 0, gravity);
+    LinkWrenchFactor factor(example::cost_model, example::link, wrench_keys, 0,
+                            gravity);
+    EXPECT_LONGS_EQUAL(expected->size(), factor.size());
+    EXPECT(assert_equal(expected->unwhitenedError(x),
+                        factor.unwhitenedError(x), 1e-9));
+    EXPECT_CORRECT_FACTOR_JACOBIANS(factor, x, diffDelta, tol);
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -11,7 +11,9 @@ var line_chart = svg.append("g")
                     .attr('class', 'line_chart');
 
 // =================== load data =================== //
-var file = "factor_graph.json";
+// A drill-down file of a summary, see GraphSummary, is given as ?file=...
+var file = new URLSearchParams(window.location.search).get("file")
+           || "factor_graph.json";
 Promise.all([d3.json(file)])
         .then(function(data) 
         {
@@ -63,12 +65,33 @@ function draw_factor_graph(data) {
 
     factor_nodes.on("dblclick", pin);
 
+    // nodes of a summary open the drill-down file of their cluster
+    function drill_down(d) {
+        window.location.search = "?file=" + encodeURIComponent(d.drill_down);
+    }
+
     var timeout = null;
+    factor_nodes.filter(function(d) { return d.drill_down; })
+    .on("click", function(d) {
+        clearTimeout(timeout);
+        timeout = setTimeout(function() {
+          drill_down(d);
+        }, 200)
+      })
+      .on("dblclick", function(d) {
+        clearTimeout(timeout);
+        pin(d);
+      });
+
     variable_nodes//.on("click", make_plot);
     .on("click", function(d) {
         clearTimeout(timeout);
         timeout = setTimeout(function() {
-          make_plot(d);
+          if (d.drill_down) {
+            drill_down(d);
+          } else {
+            make_plot(d);
+          }
         }, 200)
       })
       .on("dblclick", function(d) {
@@ -56,6 +56,15 @@ function write_text(svg)
         .attr("fill", "green")
         .text("- click to show detailed info");
 
+    svg.append("text")
+        .attr("x", margin)
+        .attr("y", margin+60)
+        .attr("text-anchor", "front")
+        .attr("font-family", "sans-serif")
+        .attr("font-size", "16px")
+        .attr("fill", "green")
+        .text("- click a cluster of a summary to open it, go back to return");
+
     svg.append("svg:image")
         .attr('x', 200)
         .attr('y', height-100)